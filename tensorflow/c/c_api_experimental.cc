@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/c/c_api_experimental.h"
 
+#include <cstring>
+#include <vector>
+
 #include "absl/strings/substitute.h"
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow/c/eager/tfe_op_internal.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_buffer_internal.h"
+#include "tensorflow/c/tf_tensor_helper.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/core/common_runtime/eager/attr_builder.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
@@ -47,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
 
 using tensorflow::FunctionDef;
 using tensorflow::Node;
@@ -764,3 +769,109 @@ void TF_GraphRemoveFunction(TF_Graph* g, const char* func_name,
   tensorflow::mutex_lock l(g->mu);
   status->status = g->graph.mutable_flib_def()->RemoveFunction(func_name);
 }
+
+struct TF_SessionCallable {
+  tensorflow::Session::CallableHandle handle;
+  int ninputs;
+  int noutputs;
+};
+
+TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    int ninputs, const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status) {
+  if (session->extend_before_run &&
+      !tensorflow::ExtendSessionGraphHelper(session, status)) {
+    return nullptr;
+  }
+
+  tensorflow::CallableOptions callable_options;
+  if (run_options != nullptr &&
+      !callable_options.mutable_run_options()->ParseFromArray(
+          run_options->data, run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return nullptr;
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    callable_options.add_feed(
+        tensorflow::strings::StrCat(inputs[i].oper->node.name(), ":",
+                                    inputs[i].index));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    callable_options.add_fetch(
+        tensorflow::strings::StrCat(outputs[i].oper->node.name(), ":",
+                                    outputs[i].index));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    callable_options.add_target(target_opers[i]->node.name());
+  }
+
+  tensorflow::Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(callable_options, &handle);
+  if (!status->status.ok()) return nullptr;
+  return new TF_SessionCallable{handle, ninputs, noutputs};
+}
+
+void TF_SessionRunCallable(TF_Session* session, TF_SessionCallable* callable,
+                           TF_Tensor* const* input_values,
+                           TF_Tensor** output_values, TF_Status* status) {
+  std::vector<tensorflow::Tensor> feeds(callable->ninputs);
+  for (int i = 0; i < callable->ninputs; ++i) {
+    status->status = tensorflow::TF_TensorToTensor(input_values[i], &feeds[i]);
+    if (!status->status.ok()) return;
+  }
+
+  std::vector<tensorflow::Tensor> fetches;
+  status->status = session->session->RunCallable(callable->handle, feeds,
+                                                 &fetches, nullptr);
+  if (!status->status.ok()) return;
+
+  // The preallocated outputs are checked before any new tensor is returned,
+  // so that those are only created on success.
+  for (int i = 0; i < callable->noutputs; ++i) {
+    if (output_values[i] == nullptr) continue;
+    tensorflow::Tensor dst;
+    status->status = tensorflow::TF_TensorToTensor(output_values[i], &dst);
+    if (!status->status.ok()) return;
+    const tensorflow::Tensor& src = fetches[i];
+    if (src.dtype() != dst.dtype() || src.shape() != dst.shape()) {
+      status->status = InvalidArgument(
+          "Output ", i, " is a ", src.DebugString(0),
+          " but the preallocated tensor for it is a ", dst.DebugString(0));
+      return;
+    }
+    if (!tensorflow::DataTypeCanUseMemcpy(src.dtype())) {
+      status->status = InvalidArgument(
+          "Output ", i, " of type ", tensorflow::DataTypeString(src.dtype()),
+          " can't be fetched into a preallocated tensor");
+      return;
+    }
+  }
+  std::vector<TF_Tensor*> new_outputs(callable->noutputs, nullptr);
+  for (int i = 0; i < callable->noutputs; ++i) {
+    if (output_values[i] != nullptr) continue;
+    new_outputs[i] =
+        tensorflow::TF_TensorFromTensorShallow(fetches[i], &status->status);
+    if (!status->status.ok()) {
+      for (TF_Tensor* new_output : new_outputs) {
+        if (new_output != nullptr) TF_DeleteTensor(new_output);
+      }
+      return;
+    }
+  }
+  for (int i = 0; i < callable->noutputs; ++i) {
+    if (new_outputs[i] != nullptr) {
+      output_values[i] = new_outputs[i];
+    } else if (fetches[i].TotalBytes() > 0) {
+      std::memcpy(TF_TensorData(output_values[i]),
+                  fetches[i].tensor_data().data(), fetches[i].TotalBytes());
+    }
+  }
+}
+
+void TF_SessionReleaseCallable(TF_Session* session,
+                               TF_SessionCallable* callable,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(callable->handle);
+  delete callable;
+}
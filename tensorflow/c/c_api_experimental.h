@@ -317,6 +317,46 @@ TF_CAPI_EXPORT extern void TF_GraphRemoveFunction(TF_Graph* g,
                                                   const char* func_name,
                                                   TF_Status* status);
 
+// A subgraph of a session with fixed feeds, fetches and targets, looked up in
+// the graph once by TF_SessionMakeCallable instead of on every run.
+typedef struct TF_SessionCallable TF_SessionCallable;
+
+// Creates a callable that feeds inputs[0,ninputs-1], fetches
+// outputs[0,noutputs-1] and runs target_opers[0,ntargets-1] of the graph of
+// `session`. `run_options` may be NULL, or point to a serialized `RunOptions`
+// protocol buffer used for every run of the callable.
+//
+// The caller owns the returned callable and must release it with
+// TF_SessionReleaseCallable before deleting `session`. On failure, returns
+// NULL and places an error in `status`.
+TF_CAPI_EXPORT extern TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    int ninputs, const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status);
+
+// Runs `callable` with `input_values`, in the order of the inputs it was made
+// with. Unlike TF_SessionRun, callables can be run concurrently, and the
+// buffers of the input tensors are fed without copies, so that the caller can
+// refill and feed the same tensors for every run.
+//
+// For each output, a NULL element of `output_values` is set to a new tensor
+// that the caller owns and holds the result without a copy. A non-NULL element
+// must be a tensor, still owned by the caller, of the type and shape of the
+// result, into whose buffer the result is copied. This lets the caller fetch
+// into memory of its own, e.g. shared with another process or reused across
+// runs. Such tensors must be created by the caller (e.g. with TF_NewTensor),
+// since the tensors returned by runs may share buffers with the session.
+//
+// On failure, the NULL elements of `output_values` remain NULL.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session* session, TF_SessionCallable* callable,
+    TF_Tensor* const* input_values, TF_Tensor** output_values,
+    TF_Status* status);
+
+// Releases `callable` and the resources that `session` holds for it.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(
+    TF_Session* session, TF_SessionCallable* callable, TF_Status* status);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
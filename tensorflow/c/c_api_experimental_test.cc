@@ -361,5 +361,60 @@ TEST_F(CApiExperimentalFunctionTest, GraphRemoveNonExistentFunction) {
   TF_DeleteFunction(funcs[0]);
 }
 
+TEST(CAPI_EXPERIMENTAL, SessionRunCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Output inputs[] = {{feed, 0}};
+  TF_Output outputs[] = {{add, 0}};
+  TF_SessionCallable* callable = TF_SessionMakeCallable(
+      session, /*run_options=*/nullptr, inputs, 1, outputs, 1,
+      /*target_opers=*/nullptr, 0, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The same input tensor is refilled and fed for every run.
+  TF_Tensor* input = Int32Tensor(3);
+  TF_Tensor* output = nullptr;
+  TF_SessionRunCallable(session, callable, &input, &output, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  ASSERT_NE(output, nullptr);
+  EXPECT_EQ(5, *static_cast<int32_t*>(TF_TensorData(output)));
+
+  TF_DeleteTensor(output);
+
+  // Results are copied into preallocated outputs.
+  *static_cast<int32_t*>(TF_TensorData(input)) = 4;
+  TF_Tensor* preallocated = Int32Tensor(0);
+  output = preallocated;
+  TF_SessionRunCallable(session, callable, &input, &output, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(preallocated, output);
+  EXPECT_EQ(6, *static_cast<int32_t*>(TF_TensorData(output)));
+  TF_DeleteTensor(output);
+
+  TF_Tensor* mismatched = FloatTensor(0.0f);
+  TF_SessionRunCallable(session, callable, &input, &mismatched, s);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(s));
+  TF_DeleteTensor(mismatched);
+  TF_DeleteTensor(input);
+
+  TF_SessionReleaseCallable(session, callable, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -286,6 +286,16 @@ void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
   }
 }
 
+void TFE_HandleDLPackDevice(TFE_TensorHandle* h, int* device_type,
+                            int* device_id, TF_Status* status) {
+  DLDevice device = GetDlContext(h, status);
+  if (!status->status.ok()) {
+    return;
+  }
+  *device_type = device.device_type;
+  *device_id = device.device_id;
+}
+
 void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   auto tf_dlm_context = GetDlContext(h, status);
   if (!status->status.ok()) {
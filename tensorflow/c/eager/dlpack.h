@@ -33,6 +33,13 @@ TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
                                                              TFE_Context* ctx);
 
+// Gets the DLPack device type and id of the memory backing the eager tensor
+// handle, as for the `__dlpack_device__` protocol method.
+TF_CAPI_EXPORT extern void TFE_HandleDLPackDevice(TFE_TensorHandle* h,
+                                                  int* device_type,
+                                                  int* device_id,
+                                                  TF_Status* status);
+
 // Calls the destructor of DLManagedTensor, used in the destructor of PyCapsule.
 TF_CAPI_EXPORT extern void TFE_CallDLManagedTensorDeleter(void* dlm_ptr);
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_status.h"
 #include "tensorflow/c/tf_status_internal.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -293,6 +294,10 @@ ParallelDevice::ParallelDevice(const std::vector<std::string>& devices,
     device_threads_.emplace_back(new DeviceThread(
         devices[device_index].c_str(), is_async, in_flight_nodes_limit));
   }
+  if (devices.size() > 1) {
+    copy_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "parallel_device_copy", devices.size());
+  }
 }
 
 // Necessary for a unique_ptr to a forward-declared type.
@@ -302,11 +307,46 @@ std::unique_ptr<ParallelTensor> ParallelDevice::CopyToParallelDevice(
     TFE_Context* context, TFE_TensorHandle* tensor, TF_Status* status) const {
   std::vector<TensorHandlePtr> components;
   components.reserve(underlying_devices_.size());
-  for (const std::string& underlying_device_name : underlying_devices_) {
-    TFE_TensorHandle* t = TFE_TensorHandleCopyToDevice(
-        tensor, context, underlying_device_name.c_str(), status);
-    if (TF_GetCode(status) != TF_OK) return nullptr;
-    components.emplace_back(t);
+  if (copy_thread_pool_ == nullptr) {
+    for (const std::string& underlying_device_name : underlying_devices_) {
+      TFE_TensorHandle* t = TFE_TensorHandleCopyToDevice(
+          tensor, context, underlying_device_name.c_str(), status);
+      if (TF_GetCode(status) != TF_OK) return nullptr;
+      components.emplace_back(t);
+    }
+    return ParallelTensor::FromTensorHandles(*this, std::move(components),
+                                             status);
+  }
+
+  // Copies to all the devices concurrently, as host-to-device copies of small
+  // inputs are mostly dispatch overhead. The copies are added to the executor
+  // of the calling thread, as they would be when run on it.
+  ExecutorPtr executor(TFE_ContextGetExecutorForThread(context));
+  const int num_devices = underlying_devices_.size();
+  std::vector<TFE_TensorHandle*> copies(num_devices, nullptr);
+  std::vector<StatusPtr> copy_statuses;
+  copy_statuses.reserve(num_devices);
+  BlockingCounter counter(num_devices);
+  for (int device_index = 0; device_index < num_devices; ++device_index) {
+    copy_statuses.emplace_back(TF_NewStatus());
+    copy_thread_pool_->Schedule([&, device_index]() {
+      TFE_ContextSetExecutorForThread(context, executor.get());
+      copies[device_index] = TFE_TensorHandleCopyToDevice(
+          tensor, context, underlying_devices_[device_index].c_str(),
+          copy_statuses[device_index].get());
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (int device_index = 0; device_index < num_devices; ++device_index) {
+    components.emplace_back(copies[device_index]);
+  }
+  for (const StatusPtr& copy_status : copy_statuses) {
+    if (TF_GetCode(copy_status.get()) != TF_OK) {
+      TF_SetStatus(status, TF_GetCode(copy_status.get()),
+                   TF_Message(copy_status.get()));
+      return nullptr;
+    }
   }
   return ParallelTensor::FromTensorHandles(*this, std::move(components),
                                            status);
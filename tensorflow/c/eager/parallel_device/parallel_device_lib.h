@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace parallel_device {
@@ -168,6 +169,9 @@ class ParallelDevice {
   // are executed asynchronously this must outlive the queued op, so it can't be
   // function-local to Execute.
   mutable std::unique_ptr<CancellationManager> default_cancellation_manager_;
+  // Copies tensors to the underlying devices concurrently. Null if there is a
+  // single underlying device.
+  std::unique_ptr<thread::ThreadPool> copy_thread_pool_;
 };
 
 // Contains a tuple of tensors, one on each of the `underlying_devices_` of the
@@ -0,0 +1,484 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/lazy_restore.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+constexpr char kLazyRestorePrefix[] = "saved_model_lazy_restore";
+
+// How one saved variable is restored by the saver.
+struct RestoredVariable {
+  const NodeDef* restore;  // The RestoreV2 node.
+  int output;              // The output of "restore" holding the value.
+  const NodeDef* assign;   // The Assign or AssignVariableOp node.
+};
+
+// Appends the names of the tensors described by "info" to "names".
+void AppendTensorNames(const TensorInfo& info,
+                       std::vector<std::string>* names) {
+  switch (info.encoding_case()) {
+    case TensorInfo::kName:
+      names->push_back(info.name());
+      break;
+    case TensorInfo::kCooSparse:
+      names->push_back(info.coo_sparse().values_tensor_name());
+      names->push_back(info.coo_sparse().indices_tensor_name());
+      names->push_back(info.coo_sparse().dense_shape_tensor_name());
+      break;
+    case TensorInfo::kCompositeTensor:
+      for (const TensorInfo& component : info.composite_tensor().components()) {
+        AppendTensorNames(component, names);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Sets "out" to the string values of the Const node "node".
+Status GetStringConstant(const NodeDef* node, std::vector<std::string>* out) {
+  if (node == nullptr || node->op() != "Const") {
+    return absl::UnimplementedError(
+        "Lazy restore needs RestoreV2 tensor names and slices to be Const");
+  }
+  const TensorProto& value = node->attr().at("value").tensor();
+  out->assign(value.string_val().begin(), value.string_val().end());
+  return absl::OkStatus();
+}
+
+class GraphIndex {
+ public:
+  explicit GraphIndex(const GraphDef& graph_def) {
+    for (const NodeDef& node : graph_def.node()) nodes_[node.name()] = &node;
+  }
+
+  const NodeDef* Find(absl::string_view name) const {
+    auto it = nodes_.find(name);
+    return it == nodes_.end() ? nullptr : it->second;
+  }
+
+  // Returns the names of all nodes that the tensors or nodes "roots"
+  // transitively depend on, through data or control inputs.
+  absl::flat_hash_set<std::string> Ancestors(
+      const std::vector<std::string>& roots) const {
+    absl::flat_hash_set<std::string> visited;
+    std::vector<const NodeDef*> stack;
+    auto visit = [&](absl::string_view input) {
+      const std::string name(ParseTensorName(input).node());
+      if (!visited.insert(name).second) return;
+      if (const NodeDef* node = Find(name)) stack.push_back(node);
+    };
+    for (const std::string& root : roots) visit(root);
+    while (!stack.empty()) {
+      const NodeDef* node = stack.back();
+      stack.pop_back();
+      for (const std::string& input : node->input()) visit(input);
+    }
+    return visited;
+  }
+
+ private:
+  absl::flat_hash_map<std::string, const NodeDef*> nodes_;
+};
+
+// Finds, for each variable node restored by a RestoreV2 node, how it is
+// restored.
+Status FindRestoredVariables(
+    const GraphDef& graph_def, const GraphIndex& index,
+    std::map<std::string, RestoredVariable>* variables) {
+  for (const NodeDef& node : graph_def.node()) {
+    if ((node.op() != "Assign" && node.op() != "AssignVariableOp") ||
+        node.input_size() < 2) {
+      continue;
+    }
+    const TensorId value = ParseTensorName(node.input(1));
+    const NodeDef* restore = index.Find(value.node());
+    if (restore == nullptr || restore->op() != "RestoreV2") continue;
+    const std::string variable(ParseTensorName(node.input(0)).node());
+    if (!variables->insert({variable, {restore, value.index(), &node}})
+             .second) {
+      return absl::UnimplementedError(
+          absl::StrCat("Variable ", variable, " is restored more than once"));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Appends to "nodes" a target named "name" restoring "variables" and sets
+// "target" to "name", or clears "target" if "variables" is empty.
+Status AddRestoreTarget(const std::string& name,
+                        const std::vector<const RestoredVariable*>& variables,
+                        const GraphIndex& index, std::vector<NodeDef>* nodes,
+                        std::string* target) {
+  target->clear();
+  if (variables.empty()) return absl::OkStatus();
+
+  // Restores the variables of each original RestoreV2 node with one new
+  // RestoreV2 node, so that they keep reading from the same shard and device.
+  std::map<const NodeDef*, std::vector<const RestoredVariable*>> by_restore;
+  for (const RestoredVariable* variable : variables) {
+    by_restore[variable->restore].push_back(variable);
+  }
+  NodeDef group;
+  group.set_name(name);
+  group.set_op("NoOp");
+  int restore_index = 0;
+  for (const auto& [restore, restored] : by_restore) {
+    std::vector<std::string> tensor_names, shape_and_slices;
+    TF_RETURN_IF_ERROR(GetStringConstant(
+        index.Find(ParseTensorName(restore->input(1)).node()), &tensor_names));
+    TF_RETURN_IF_ERROR(GetStringConstant(
+        index.Find(ParseTensorName(restore->input(2)).node()),
+        &shape_and_slices));
+    const auto& dtypes = restore->attr().at("dtypes").list().type();
+
+    const std::string prefix = absl::StrCat(name, "/", restore_index++);
+    NodeDef names_node, slices_node, restore_node;
+    names_node.set_name(absl::StrCat(prefix, "/tensor_names"));
+    slices_node.set_name(absl::StrCat(prefix, "/shape_and_slices"));
+    restore_node.set_name(absl::StrCat(prefix, "/restore"));
+    restore_node.set_op("RestoreV2");
+    restore_node.set_device(restore->device());
+    restore_node.add_input(restore->input(0));
+    restore_node.add_input(names_node.name());
+    restore_node.add_input(slices_node.name());
+    TensorProto names_value, slices_value;
+    names_value.set_dtype(DT_STRING);
+    slices_value.set_dtype(DT_STRING);
+    auto* dtypes_attr =
+        (*restore_node.mutable_attr())["dtypes"].mutable_list();
+    for (int i = 0; i < restored.size(); ++i) {
+      const RestoredVariable& variable = *restored[i];
+      if (variable.output >= tensor_names.size() ||
+          variable.output >= shape_and_slices.size() ||
+          variable.output >= dtypes.size()) {
+        return absl::UnimplementedError(absl::StrCat(
+            "Unexpected RestoreV2 node ", variable.restore->name()));
+      }
+      names_value.add_string_val(tensor_names[variable.output]);
+      slices_value.add_string_val(shape_and_slices[variable.output]);
+      dtypes_attr->add_type(static_cast<DataType>(dtypes[variable.output]));
+
+      NodeDef assign = *variable.assign;
+      assign.set_name(absl::StrCat(prefix, "/assign_", i));
+      assign.mutable_input()->DeleteSubrange(2, assign.input_size() - 2);
+      assign.set_input(1, absl::StrCat(restore_node.name(), ":", i));
+      group.add_input(absl::StrCat("^", assign.name()));
+      nodes->push_back(std::move(assign));
+    }
+    names_value.mutable_tensor_shape()->add_dim()->set_size(restored.size());
+    slices_value.mutable_tensor_shape()->add_dim()->set_size(restored.size());
+    for (auto [node, value] : {std::make_pair(&names_node, &names_value),
+                               std::make_pair(&slices_node, &slices_value)}) {
+      node->set_op("Const");
+      node->set_device(restore->device());
+      (*node->mutable_attr())["dtype"].set_type(DT_STRING);
+      *(*node->mutable_attr())["value"].mutable_tensor() = std::move(*value);
+      nodes->push_back(std::move(*node));
+    }
+    nodes->push_back(std::move(restore_node));
+  }
+  nodes->push_back(std::move(group));
+  *target = name;
+  return absl::OkStatus();
+}
+
+class LazyRestoreSession : public Session {
+ public:
+  LazyRestoreSession(
+      std::unique_ptr<Session> wrapped, LazyRestorePlan plan,
+      std::function<Status(Session*, const std::string&)> restore,
+      bool restore_in_background)
+      : wrapped_(std::move(wrapped)),
+        plan_(std::move(plan)),
+        restore_(std::move(restore)) {
+    for (const auto& [signature, target] : plan_.signature_restore_ops) {
+      if (!target.empty()) targets_[target] = std::make_unique<Target>();
+    }
+    if (restore_in_background) {
+      background_.reset(Env::Default()->StartThread(
+          {}, "saved_model_lazy_restore", [this] {
+            for (const auto& [signature, target] :
+                 plan_.signature_restore_ops) {
+              if (stop_ || fully_restored_) break;
+              if (target.empty()) continue;
+              Status s = RunTarget(target);
+              if (!s.ok()) {
+                LOG(WARNING) << "Background restore for signature "
+                             << signature << " failed: " << s;
+              }
+            }
+          }));
+    }
+  }
+
+  ~LazyRestoreSession() override {
+    stop_ = true;
+    background_ = nullptr;  // Waits for the background thread.
+  }
+
+  Status Create(const GraphDef& graph) override {
+    return wrapped_->Create(graph);
+  }
+  Status Create(GraphDef&& graph) override {
+    return wrapped_->Create(std::move(graph));
+  }
+  Status Extend(const GraphDef& graph) override {
+    return wrapped_->Extend(graph);
+  }
+  Status Extend(GraphDef&& graph) override {
+    return wrapped_->Extend(std::move(graph));
+  }
+  Status Create(const RunOptions& run_options, const GraphDef& graph) override {
+    return wrapped_->Create(run_options, graph);
+  }
+  Status Extend(const RunOptions& run_options, const GraphDef& graph) override {
+    return wrapped_->Extend(run_options, graph);
+  }
+  Status Create(const RunOptions& run_options, GraphDef&& graph) override {
+    return wrapped_->Create(run_options, std::move(graph));
+  }
+  Status Extend(const RunOptions& run_options, GraphDef&& graph) override {
+    return wrapped_->Extend(run_options, std::move(graph));
+  }
+
+  Status Run(const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs) override {
+    TF_RETURN_IF_ERROR(EnsureRestored(output_tensor_names, target_node_names));
+    return wrapped_->Run(inputs, output_tensor_names, target_node_names,
+                         outputs);
+  }
+
+  Status Run(const RunOptions& run_options,
+             const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs, RunMetadata* run_metadata) override {
+    TF_RETURN_IF_ERROR(EnsureRestored(output_tensor_names, target_node_names));
+    return wrapped_->Run(run_options, inputs, output_tensor_names,
+                         target_node_names, outputs, run_metadata);
+  }
+
+  Status PRunSetup(const std::vector<string>& input_names,
+                   const std::vector<string>& output_names,
+                   const std::vector<string>& target_nodes,
+                   string* handle) override {
+    TF_RETURN_IF_ERROR(EnsureRestored(output_names, target_nodes));
+    return wrapped_->PRunSetup(input_names, output_names, target_nodes,
+                               handle);
+  }
+
+  Status PRun(const string& handle,
+              const std::vector<std::pair<string, Tensor>>& inputs,
+              const std::vector<string>& output_names,
+              std::vector<Tensor>* outputs) override {
+    return wrapped_->PRun(handle, inputs, output_names, outputs);
+  }
+
+  Status ListDevices(std::vector<DeviceAttributes>* response) override {
+    return wrapped_->ListDevices(response);
+  }
+
+  Status Close() override { return wrapped_->Close(); }
+  Status Close(const RunOptions& run_options) override {
+    return wrapped_->Close(run_options);
+  }
+
+  Status LocalDeviceManager(const DeviceMgr** output) override {
+    return wrapped_->LocalDeviceManager(output);
+  }
+
+  // Restores at MakeCallable() time, so that RunCallable() does not need to.
+  Status MakeCallable(const CallableOptions& callable_options,
+                      CallableHandle* out_handle) override {
+    TF_RETURN_IF_ERROR(EnsureRestored(
+        {callable_options.fetch().begin(), callable_options.fetch().end()},
+        {callable_options.target().begin(), callable_options.target().end()}));
+    return wrapped_->MakeCallable(callable_options, out_handle);
+  }
+
+  Status RunCallable(CallableHandle handle,
+                     const std::vector<Tensor>& feed_tensors,
+                     std::vector<Tensor>* fetch_tensors,
+                     RunMetadata* run_metadata) override {
+    return wrapped_->RunCallable(handle, feed_tensors, fetch_tensors,
+                                 run_metadata);
+  }
+
+  Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) override {
+    return wrapped_->RunCallable(handle, feed_tensors, fetch_tensors,
+                                 run_metadata, threadpool_options);
+  }
+
+  Status ReleaseCallable(CallableHandle handle) override {
+    return wrapped_->ReleaseCallable(handle);
+  }
+
+  Status Finalize() override { return wrapped_->Finalize(); }
+
+ private:
+  // A restore target that runs at most once.
+  struct Target {
+    absl::once_flag once;
+    Status status;
+  };
+
+  Status EnsureRestored(const std::vector<string>& fetches,
+                        const std::vector<string>& targets) {
+    if (fully_restored_) return absl::OkStatus();
+    if (!targets.empty()) return RestoreAll();
+    std::vector<const std::string*> needed;
+    for (const std::string& fetch : fetches) {
+      auto it = plan_.output_node_restore_ops.find(
+          ParseTensorName(fetch).node());
+      if (it == plan_.output_node_restore_ops.end()) return RestoreAll();
+      if (!it->second.empty()) needed.push_back(&it->second);
+    }
+    for (const std::string* target : needed) {
+      TF_RETURN_IF_ERROR(RunTarget(*target));
+    }
+    return absl::OkStatus();
+  }
+
+  Status RunTarget(const std::string& name) {
+    Target* target = targets_.at(name).get();
+    absl::call_once(target->once, [&] {
+      VLOG(1) << "Lazily restoring " << name;
+      target->status = restore_(wrapped_.get(), name);
+    });
+    return target->status;
+  }
+
+  Status RestoreAll() {
+    absl::call_once(full_restore_.once, [&] {
+      full_restore_.status = restore_(wrapped_.get(), plan_.full_restore_op);
+      fully_restored_ = full_restore_.status.ok();
+    });
+    return full_restore_.status;
+  }
+
+  const std::unique_ptr<Session> wrapped_;
+  const LazyRestorePlan plan_;
+  const std::function<Status(Session*, const std::string&)> restore_;
+  // Not modified after construction.
+  absl::flat_hash_map<std::string, std::unique_ptr<Target>> targets_;
+  Target full_restore_;
+  std::atomic<bool> fully_restored_{false};
+  std::atomic<bool> stop_{false};
+  // Declared last so that it is joined before the members it uses go away.
+  std::unique_ptr<Thread> background_;
+};
+
+}  // namespace
+
+Status AddLazyRestoreOps(const MetaGraphDef& meta_graph,
+                         const std::string& init_op_name, GraphDef* graph_def,
+                         LazyRestorePlan* plan) {
+  const GraphIndex index(*graph_def);
+  std::map<std::string, RestoredVariable> variables;
+  TF_RETURN_IF_ERROR(FindRestoredVariables(*graph_def, index, &variables));
+  if (variables.empty()) {
+    // E.g. TF2 graphs, which restore through a function call.
+    return absl::UnimplementedError(
+        "Lazy restore found no variables restored by RestoreV2 nodes");
+  }
+
+  // Returns the restored variables that "roots" depend on.
+  auto variables_read_by = [&](const std::vector<std::string>& roots) {
+    std::vector<const RestoredVariable*> read;
+    const absl::flat_hash_set<std::string> ancestors = index.Ancestors(roots);
+    for (const auto& [name, variable] : variables) {
+      if (ancestors.contains(name)) read.push_back(&variable);
+    }
+    return read;
+  };
+
+  LazyRestorePlan new_plan;
+  new_plan.full_restore_op = meta_graph.saver_def().restore_op_name();
+  std::vector<NodeDef> new_nodes;
+  if (!init_op_name.empty()) {
+    TF_RETURN_IF_ERROR(AddRestoreTarget(
+        absl::StrCat(kLazyRestorePrefix, "/init"),
+        variables_read_by({init_op_name}), index, &new_nodes,
+        &new_plan.init_restore_op));
+  }
+  int signature_index = 0;
+  for (const auto& [key, signature] : meta_graph.signature_def()) {
+    std::vector<std::string> tensors;
+    for (const auto& [unused, info] : signature.inputs()) {
+      AppendTensorNames(info, &tensors);
+    }
+    std::vector<std::string> outputs;
+    for (const auto& [unused, info] : signature.outputs()) {
+      AppendTensorNames(info, &outputs);
+    }
+    tensors.insert(tensors.end(), outputs.begin(), outputs.end());
+    std::string target;
+    TF_RETURN_IF_ERROR(AddRestoreTarget(
+        absl::StrCat(kLazyRestorePrefix, "/signature_", signature_index++),
+        variables_read_by(tensors), index, &new_nodes, &target));
+    for (const std::string& output : outputs) {
+      new_plan.output_node_restore_ops.try_emplace(
+          ParseTensorName(output).node(), target);
+    }
+    new_plan.signature_restore_ops.emplace_back(key, std::move(target));
+  }
+
+  for (NodeDef& node : new_nodes) *graph_def->add_node() = std::move(node);
+  *plan = std::move(new_plan);
+  return absl::OkStatus();
+}
+
+std::unique_ptr<Session> NewLazyRestoreSession(
+    std::unique_ptr<Session> wrapped, LazyRestorePlan plan,
+    std::function<Status(Session*, const std::string&)> restore,
+    bool restore_in_background) {
+  return std::make_unique<LazyRestoreSession>(
+      std::move(wrapped), std::move(plan), std::move(restore),
+      restore_in_background);
+}
+
+}  // namespace internal
+}  // namespace tensorflow
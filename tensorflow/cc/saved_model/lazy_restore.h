@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
+#define TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace internal {
+
+// Restore targets added to a SavedModel graph so that variables can be
+// restored in parts, as the signatures reading them are first run.
+struct LazyRestorePlan {
+  // Target restoring every saved variable, i.e. the saver's restore op.
+  std::string full_restore_op;
+  // Target restoring the saved variables the init op reads, or empty if none.
+  std::string init_restore_op;
+  // The signatures in the order they should be restored in the background,
+  // each with the target restoring the saved variables it reads, or an empty
+  // target if it reads none.
+  std::vector<std::pair<std::string, std::string>> signature_restore_ops;
+  // Maps each node producing a signature output to the restore target of the
+  // first signature declaring it.
+  absl::flat_hash_map<std::string, std::string> output_node_restore_ops;
+};
+
+// Adds to "graph_def", the graph of "meta_graph", one restore target per
+// signature of "meta_graph" and one for the init op named "init_op_name" (if
+// any), each restoring only the saved variables that the signature or init op
+// reads, and describes them in "plan".  Returns an Unimplemented error, leaving
+// "graph_def" unchanged, if the saver's restore ops have an unexpected form.
+Status AddLazyRestoreOps(const MetaGraphDef& meta_graph,
+                         const std::string& init_op_name, GraphDef* graph_def,
+                         LazyRestorePlan* plan);
+
+// Returns a session that forwards to "wrapped" but first uses "restore" to run
+// each restore target in "plan" that a step needs and that has not run yet.
+// Steps that are not made of signature outputs restore every variable.  If
+// "restore_in_background" is true, the signatures' restore targets are also
+// run, in order, on a background thread.
+std::unique_ptr<Session> NewLazyRestoreSession(
+    std::unique_ptr<Session> wrapped, LazyRestorePlan plan,
+    std::function<Status(Session*, const std::string&)> restore,
+    bool restore_in_background);
+
+}  // namespace internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_LAZY_RESTORE_H_
@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/lazy_restore.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+// Loads half_plus_two, whose signatures compute y = 0.5 * x + 2 from the
+// variables "a" and "b", and y2 = 0.5 * x + 3 from "a" and "c", into a lazily
+// restored session that records the restore targets it runs.
+class LazyRestoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+    MetaGraphDef meta_graph;
+    TF_ASSERT_OK(ReadMetaGraphDefFromSavedModel(
+        export_dir, {kSavedModelTagServe}, &meta_graph));
+    signatures_ = meta_graph.signature_def();
+
+    GraphDef graph_def = meta_graph.graph_def();
+    TF_ASSERT_OK(AddLazyRestoreOps(meta_graph, /*init_op_name=*/"",
+                                   &graph_def, &plan_));
+    std::unique_ptr<Session> session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session->Create(graph_def));
+    wrapped_ = session.get();
+
+    const Tensor variables_path = test::AsScalar<tstring>(
+        io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                     kSavedModelVariablesFilename));
+    auto restore = [this, variables_path,
+                    filename_tensor_name =
+                        meta_graph.saver_def().filename_tensor_name()](
+                       Session* session, const std::string& restore_op_name) {
+      restored_.push_back(restore_op_name);
+      return session->Run({{filename_tensor_name, variables_path}}, {},
+                          {restore_op_name}, nullptr);
+    };
+    session_ = NewLazyRestoreSession(std::move(session), plan_,
+                                     std::move(restore),
+                                     /*restore_in_background=*/false);
+  }
+
+  // The restore target run for fetching the output node "node". Several
+  // signatures may declare the same output, so this is the target of whichever
+  // one the plan picked.
+  std::string RestoreOpFor(const std::string& node) {
+    auto it = plan_.output_node_restore_ops.find(node);
+    if (it == plan_.output_node_restore_ops.end()) {
+      ADD_FAILURE() << "No restore target for " << node;
+      return "";
+    }
+    return it->second;
+  }
+
+  // Whether "variable" holds a value in the wrapped session. Reading it goes
+  // around the lazy restore, so that it doesn't trigger a restore itself.
+  bool IsRestored(const std::string& variable) {
+    std::vector<Tensor> outputs;
+    const Status status = wrapped_->Run({}, {variable}, {}, &outputs);
+    EXPECT_TRUE(status.ok() || errors::IsFailedPrecondition(status))
+        << status;
+    return status.ok();
+  }
+
+  // Runs the regression signature "key" on x = 2 and returns its output.
+  Tensor Regress(const std::string& key) {
+    const SignatureDef& signature = signatures_.at(key);
+    tensorflow::Example example;
+    (*example.mutable_features()->mutable_feature())["x"]
+        .mutable_float_list()
+        ->add_value(2);
+    Tensor input = test::AsTensor<tstring>({example.SerializeAsString()},
+                                           TensorShape({1}));
+    std::vector<Tensor> outputs;
+    TF_EXPECT_OK(session_->Run(
+        {{signature.inputs().at(kRegressInputs).name(), input}},
+        {signature.outputs().at(kRegressOutputs).name()}, {}, &outputs));
+    return outputs.empty() ? Tensor() : outputs[0];
+  }
+
+  google::protobuf::Map<std::string, SignatureDef> signatures_;
+  LazyRestorePlan plan_;
+  std::vector<std::string> restored_;
+  Session* wrapped_ = nullptr;
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(LazyRestoreTest, RestoresVariablesOfSignatureOnFirstRun) {
+  // Nothing is restored before a signature runs.
+  EXPECT_THAT(restored_, IsEmpty());
+  EXPECT_FALSE(IsRestored("a:0"));
+  EXPECT_FALSE(IsRestored("b:0"));
+  EXPECT_FALSE(IsRestored("c:0"));
+
+  // Running regress_x_to_y2 restores only "a" and "c".
+  test::ExpectTensorEqual<float>(
+      Regress("regress_x_to_y2"),
+      test::AsTensor<float>({4}, TensorShape({1, 1})));
+  EXPECT_THAT(restored_, ElementsAre(RestoreOpFor("y2")));
+  EXPECT_TRUE(IsRestored("a:0"));
+  EXPECT_FALSE(IsRestored("b:0"));
+  EXPECT_TRUE(IsRestored("c:0"));
+
+  // Running it again restores nothing.
+  Regress("regress_x_to_y2");
+  EXPECT_EQ(restored_.size(), 1);
+
+  // regress_x_to_y then restores the variables it reads.
+  test::ExpectTensorEqual<float>(
+      Regress("regress_x_to_y"),
+      test::AsTensor<float>({3}, TensorShape({1, 1})));
+  EXPECT_THAT(restored_, ElementsAre(RestoreOpFor("y2"), RestoreOpFor("y")));
+  EXPECT_TRUE(IsRestored("b:0"));
+}
+
+TEST_F(LazyRestoreTest, OtherFetchesRestoreAllVariables) {
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session_->Run({}, {"b:0"}, {}, &outputs));
+  test::ExpectTensorEqual<float>(outputs[0], test::AsScalar<float>(2));
+  EXPECT_THAT(restored_, ElementsAre(plan_.full_restore_op));
+  EXPECT_TRUE(IsRestored("a:0"));
+  EXPECT_TRUE(IsRestored("c:0"));
+
+  // Signatures need no further restore.
+  Regress("regress_x_to_y2");
+  EXPECT_EQ(restored_.size(), 1);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
+#include "tensorflow/cc/saved_model/lazy_restore.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/reader.h"
@@ -296,7 +297,9 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              const SavedModelLoadOptions& /*load_options*/,
                               SavedModelBundle* const bundle) {
+  // Lazy restore is only offered for SavedModelBundleLite.
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
@@ -419,20 +422,75 @@ class LiteSessionWrapper : public Session {
 };
 }  // namespace
 
+// Creates a session for "meta_graph_def" that restores variables lazily.
+// Leaves "session" and "meta_graph_def" unchanged if the graph does not
+// support that.
+Status LoadLazilyRestoredSession(const SessionOptions& session_options,
+                                 const RunOptions& run_options,
+                                 const string& export_dir,
+                                 const SavedModelLoadOptions& load_options,
+                                 MetaGraphDef* meta_graph_def,
+                                 std::unique_ptr<Session>* session) {
+  string init_op_name;
+  TF_RETURN_IF_ERROR(
+      internal::GetInitOp(export_dir, *meta_graph_def, &init_op_name));
+  GraphDef graph_def = meta_graph_def->graph_def();
+  internal::LazyRestorePlan plan;
+  const Status plan_status = internal::AddLazyRestoreOps(
+      *meta_graph_def, init_op_name, &graph_def, &plan);
+  if (absl::IsUnimplemented(plan_status)) {
+    LOG(INFO) << "Restoring all variables of SavedModel at " << export_dir
+              << " eagerly: " << plan_status;
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(plan_status);
+  meta_graph_def->clear_graph_def();
+  TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(session_options,
+                                             std::move(graph_def), session));
+
+  std::vector<AssetFileDef> asset_file_defs;
+  TF_RETURN_IF_ERROR(
+      internal::GetAssetFileDefs(*meta_graph_def, &asset_file_defs));
+  auto restore = [run_options, export_dir, asset_file_defs,
+                  filename_tensor_name =
+                      meta_graph_def->saver_def().filename_tensor_name()](
+                     Session* session, const string& restore_op_name) {
+    return RunRestore(run_options, export_dir, restore_op_name,
+                      filename_tensor_name, asset_file_defs, session);
+  };
+  if (!plan.init_restore_op.empty()) {
+    TF_RETURN_IF_ERROR(restore(session->get(), plan.init_restore_op));
+  }
+  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, *meta_graph_def,
+                               asset_file_defs, session->get(), init_op_name));
+  *session = internal::NewLazyRestoreSession(
+      std::move(*session), std::move(plan), std::move(restore),
+      load_options.restore_in_background);
+  return absl::OkStatus();
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              const SavedModelLoadOptions& load_options,
                               SavedModelBundleLite* const bundle) {
   MetaGraphDef meta_graph_def;
   TF_RETURN_IF_ERROR(
       ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
   std::unique_ptr<Session> session;
-  TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
-      session_options, std::move(*meta_graph_def.mutable_graph_def()),
-      &session));
-  TF_RETURN_IF_ERROR(
-      RestoreSession(run_options, meta_graph_def, export_dir, &session));
+  if (load_options.lazy_restore && meta_graph_def.has_saver_def()) {
+    TF_RETURN_IF_ERROR(LoadLazilyRestoredSession(session_options, run_options,
+                                                 export_dir, load_options,
+                                                 &meta_graph_def, &session));
+  }
+  if (session == nullptr) {
+    TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
+        session_options, std::move(*meta_graph_def.mutable_graph_def()),
+        &session));
+    TF_RETURN_IF_ERROR(
+        RestoreSession(run_options, meta_graph_def, export_dir, &session));
+  }
   *bundle = SavedModelBundleLite(
       std::make_unique<LiteSessionWrapper>(std::move(session)),
       std::move(*meta_graph_def.mutable_signature_def()));
@@ -444,6 +502,7 @@ Status LoadSavedModelGeneric(const SessionOptions& session_options,
                              const RunOptions& run_options,
                              const string& export_dir,
                              const std::unordered_set<string>& tags,
+                             const SavedModelLoadOptions& load_options,
                              BundleType* const bundle) {
   metrics::SavedModelReadApi(kCCLoadLabel).IncrementBy(1);
   auto fingerprint_proto =
@@ -456,8 +515,8 @@ Status LoadSavedModelGeneric(const SessionOptions& session_options,
 
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status = LoadSavedModelInternal(
+      session_options, run_options, export_dir, tags, load_options, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -479,8 +538,9 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle) {
-  return LoadSavedModelGeneric<SavedModelBundle>(session_options, run_options,
-                                                 export_dir, tags, bundle);
+  return LoadSavedModelGeneric<SavedModelBundle>(
+      session_options, run_options, export_dir, tags, SavedModelLoadOptions(),
+      bundle);
 }
 
 Status RestoreSession(const RunOptions& run_options,
@@ -518,6 +578,15 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        SavedModelLoadOptions(), bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
+                      SavedModelBundleLite* const bundle) {
   SessionOptions rewritten_options(session_options);
   // We disallow calls to Session::Extend() on the returned session, so we can
   // reduce memory consumption by not storing the original GraphDef.
@@ -531,7 +600,8 @@ Status LoadSavedModel(const SessionOptions& session_options,
   // TODO(mrry): Consider specializing the session creation to reduce peak
   // RAM consumption by using `Session::Create(GraphDef&&)`.
   TF_RETURN_IF_ERROR(LoadSavedModelGeneric(rewritten_options, run_options,
-                                           export_dir, tags, bundle));
+                                           export_dir, tags, load_options,
+                                           bundle));
   return absl::OkStatus();
 }
 
@@ -135,6 +135,30 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* bundle);
 
+/// Options for LoadSavedModel() beyond those of the session.
+struct SavedModelLoadOptions {
+  /// If true, variables are not restored at load time.  Instead, the first
+  /// step fetching the outputs of a signature restores the variables that the
+  /// signature reads, so that variables only read by signatures that are never
+  /// run take no memory.  Steps that fetch anything else, or run targets,
+  /// restore all variables.  The init op still runs at load time, after the
+  /// variables it reads are restored.  Falls back to restoring all variables
+  /// at load time for graphs whose saver cannot be split this way.
+  bool lazy_restore = false;
+
+  /// With lazy_restore, also restores the variables of all signatures, one
+  /// signature at a time, on a background thread after loading, so that the
+  /// first steps can be served before the whole model is restored.
+  bool restore_in_background = false;
+};
+
+/// Like the SavedModelBundleLite overload above, with "load_options".
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
+                      SavedModelBundleLite* bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
@@ -123,6 +123,37 @@ TEST_F(LoaderTest, ResourceLeakTest) {
   }
 }
 
+TEST_F(LoaderTest, LazyRestore) {
+  SessionOptions session_options;
+  RunOptions run_options;
+  SavedModelLoadOptions load_options;
+  load_options.lazy_restore = true;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  for (bool restore_in_background : {false, true}) {
+    load_options.restore_in_background = restore_in_background;
+    SavedModelBundleLite bundle;
+    TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                                {kSavedModelTagServe}, load_options, &bundle));
+
+    // Running a signature restores the variables it reads.
+    const auto& signature_def = bundle.GetSignatures().at("regress_x_to_y2");
+    Tensor input = test::AsTensor<tstring>({MakeSerializedExample(2)},
+                                           TensorShape({1}));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(bundle.GetSession()->Run(
+        {{signature_def.inputs().at(kRegressInputs).name(), input}},
+        {signature_def.outputs().at(kRegressOutputs).name()}, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    // y2 = 0.5 * x + 3.
+    test::ExpectTensorEqual<float>(
+        outputs[0], test::AsTensor<float>({4}, TensorShape({1, 1})));
+
+    CheckSavedModelBundle(export_dir, bundle);
+  }
+}
+
 TEST_F(LoaderTest, ExtendFailsTest) {
   SavedModelBundleLite bundle;
   SessionOptions session_options;
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/build_xla_ops_pass.h"
 
+#include <map>
+#include <optional>
+#include <vector>
+
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/cc/framework/ops.h"
@@ -29,6 +34,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_jit_ops.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -464,11 +470,61 @@ Status PredicateInt32Inputs(const Scope& root, Node* n,
   return absl::OkStatus();
 }
 
+// Returns the shapes of the arguments of `graph`, as recorded by the
+// "_output_shapes" attributes of its _Arg nodes.
+std::map<int, InferredShape> GetArgShapes(const Graph& graph) {
+  std::map<int, InferredShape> arg_shapes;
+  for (const Node* n : graph.op_nodes()) {
+    if (!n->IsArg()) continue;
+    int index;
+    std::vector<PartialTensorShape> shapes;
+    if (GetNodeAttr(n->attrs(), "index", &index).ok() &&
+        GetNodeAttr(n->attrs(), "_output_shapes", &shapes).ok() &&
+        shapes.size() == 1) {
+      arg_shapes[index].shape = shapes[0];
+    }
+  }
+  return arg_shapes;
+}
+
+// Returns the static shapes of the inputs of cluster `n`, or nullopt if some
+// of them are only known when `n` runs. The values of constant inputs and the
+// shapes of resource inputs are always only known then.
+std::optional<std::vector<TensorShape>> GetPrecompileShapes(
+    const Node& n, const GraphShapeInfo& shape_info) {
+  int num_constant_inputs, num_resource_inputs;
+  if (!GetNodeAttr(n.attrs(), kXlaNumConstantArgsAttr, &num_constant_inputs)
+           .ok() ||
+      !GetNodeAttr(n.attrs(), kXlaNumResourceArgsAttr, &num_resource_inputs)
+           .ok() ||
+      num_constant_inputs != 0 || num_resource_inputs != 0) {
+    return std::nullopt;
+  }
+  std::vector<const Edge*> input_edges;
+  if (!n.input_edges(&input_edges).ok()) return std::nullopt;
+
+  std::vector<TensorShape> shapes;
+  for (const Edge* e : input_edges) {
+    auto it = shape_info.find(e->src()->name());
+    if (it == shape_info.end() ||
+        e->src_output() >= static_cast<int>(it->second.size())) {
+      return std::nullopt;
+    }
+    TensorShape shape;
+    if (!it->second[e->src_output()].shape.AsTensorShape(&shape)) {
+      return std::nullopt;
+    }
+    shapes.push_back(shape);
+  }
+  return shapes;
+}
+
 Status ReplaceNodeWithXlaCompileAndXlaRun(
     jit::DeviceInfoCache* device_info_cache,
     const GraphOptimizationPassOptions& options,
     const FunctionLibraryDefinition& flib_def, bool lazy_compilation_enabled,
-    const DebuggingOpts& debugging_opts, Graph* g, Node* n) {
+    const DebuggingOpts& debugging_opts,
+    const std::vector<TensorShape>* precompile_shapes, Graph* g, Node* n) {
   XlaClusterInfo cluster_info;
   TF_RETURN_IF_ERROR(GetXlaClusterInfo(n, &cluster_info));
 
@@ -503,6 +559,11 @@ Status ReplaceNodeWithXlaCompileAndXlaRun(
   TF_RETURN_IF_ERROR(
       GetNodeAttr(n->attrs(), kXlaHasReferenceVarsAttr, &has_ref_attr));
   xla_compile.operation.node()->AddAttr(kXlaHasReferenceVarsAttr, has_ref_attr);
+  // Only lazily compiled clusters can run before their compilation finishes.
+  if (precompile_shapes != nullptr && !requires_compilation) {
+    xla_compile.operation.node()->AddAttr(kXlaPrecompileShapesAttr,
+                                          *precompile_shapes);
+  }
   TF_RETURN_IF_ERROR(
       CopyIncomingControlEdges(g, /*from=*/n, /*to=*/xla_compile.key.node()));
 
@@ -605,10 +666,30 @@ Status BuildXlaOpsPass::Run(const GraphOptimizationPassOptions& options) {
   VLOG(1) << "check_input_numerics = " << debugging_opts.check_input_numerics;
   VLOG(1) << "check_output_numerics = " << debugging_opts.check_output_numerics;
 
+  // The shapes are inferred before any cluster is rewritten, since the
+  // rewrites replace the producers of the inputs of the next clusters.
+  absl::flat_hash_map<const Node*, std::vector<TensorShape>> precompile_shapes;
+  if (flags.tf_xla_precompile_clusters && lazy_compilation_enabled) {
+    GraphShapeInfo shape_info;
+    Status status = InferShapes(graph, GetArgShapes(*graph), options.flib_def,
+                                &shape_info);
+    if (status.ok()) {
+      for (const Node* n : xla_compiled_kernels) {
+        std::optional<std::vector<TensorShape>> shapes =
+            GetPrecompileShapes(*n, shape_info);
+        if (shapes) precompile_shapes[n] = *std::move(shapes);
+      }
+    } else {
+      VLOG(1) << "Not precompiling clusters: " << status;
+    }
+  }
+
   for (Node* n : xla_compiled_kernels) {
+    auto it = precompile_shapes.find(n);
     TF_RETURN_IF_ERROR(ReplaceNodeWithXlaCompileAndXlaRun(
         &device_info_cache, options, *options.flib_def,
-        lazy_compilation_enabled, debugging_opts, graph, n));
+        lazy_compilation_enabled, debugging_opts,
+        it != precompile_shapes.end() ? &it->second : nullptr, graph, n));
   }
 
   if (VLOG_IS_ON(1)) {
@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_profile.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+// The suffix of the name of the node running a cluster, see
+// build_xla_ops_pass.cc.
+constexpr absl::string_view kXlaRunSuffix = "/xla_run";
+
+int64_t NodeMicros(const NodeExecStats& node_stats) {
+  return node_stats.all_end_rel_micros();
+}
+
+}  // namespace
+
+void ClusteringProfile::AddTfStepStats(const StepStats& step_stats) {
+  for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      Cost& cost = node_costs_[node_stats.node_name()];
+      cost.total_micros += NodeMicros(node_stats);
+      ++cost.count;
+    }
+  }
+}
+
+void ClusteringProfile::AddXlaStepStats(const StepStats& step_stats) {
+  for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      absl::string_view cluster = node_stats.node_name();
+      if (!absl::ConsumeSuffix(&cluster, kXlaRunSuffix)) continue;
+      auto it = cluster_nodes_.find(cluster);
+      if (it == cluster_nodes_.end()) continue;
+      Cost& cost = cluster_costs_[NodesKey(it->second)];
+      cost.total_micros += NodeMicros(node_stats);
+      ++cost.count;
+    }
+  }
+}
+
+void ClusteringProfile::SetClusterNodes(absl::string_view cluster,
+                                        std::vector<std::string> nodes) {
+  cluster_nodes_[cluster] = std::move(nodes);
+}
+
+bool ClusteringProfile::ShouldVeto(std::vector<std::string> nodes) const {
+  auto it = cluster_costs_.find(NodesKey(nodes));
+  if (it == cluster_costs_.end()) return false;
+  double tf_micros = 0;
+  for (const std::string& node : nodes) {
+    auto node_it = node_costs_.find(node);
+    // Nodes that were not measured may make up for the cluster.
+    if (node_it == node_costs_.end()) return false;
+    tf_micros += node_it->second.mean_micros();
+  }
+  return it->second.mean_micros() > tf_micros;
+}
+
+std::string ClusteringProfile::NodesKey(std::vector<std::string> nodes) {
+  std::sort(nodes.begin(), nodes.end());
+  return absl::StrJoin(nodes, ",");
+}
+
+// Each line of the file is one of:
+//   node <node name> <total micros> <count>
+//   cluster <nodes key> <total micros> <count>
+//   members <cluster name> <nodes key>
+// TF node names contain neither spaces nor commas.
+Status ClusteringProfile::Save(Env* env, const std::string& path) const {
+  std::string contents;
+  for (const auto& [node, cost] : node_costs_) {
+    absl::StrAppend(&contents, "node ", node, " ", cost.total_micros, " ",
+                    cost.count, "\n");
+  }
+  for (const auto& [key, cost] : cluster_costs_) {
+    absl::StrAppend(&contents, "cluster ", key, " ", cost.total_micros, " ",
+                    cost.count, "\n");
+  }
+  for (const auto& [cluster, nodes] : cluster_nodes_) {
+    absl::StrAppend(&contents, "members ", cluster, " ", NodesKey(nodes),
+                    "\n");
+  }
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, contents));
+  return env->RenameFile(tmp_path, path);
+}
+
+Status ClusteringProfile::Load(Env* env, const std::string& path,
+                               ClusteringProfile* profile) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &contents));
+  *profile = ClusteringProfile();
+  for (absl::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    std::vector<std::string> fields = absl::StrSplit(line, ' ');
+    if (fields.size() == 3 && fields[0] == "members") {
+      std::vector<std::string> nodes = absl::StrSplit(fields[2], ',');
+      profile->cluster_nodes_[fields[1]] = std::move(nodes);
+      continue;
+    }
+    Cost cost;
+    if (fields.size() != 4 ||
+        !absl::SimpleAtoi(fields[2], &cost.total_micros) ||
+        !absl::SimpleAtoi(fields[3], &cost.count) || cost.count <= 0) {
+      return errors::DataLoss("Invalid line in clustering profile ", path,
+                              ": ", line);
+    }
+    if (fields[0] == "node") {
+      profile->node_costs_[fields[1]] = cost;
+    } else if (fields[0] == "cluster") {
+      profile->cluster_costs_[fields[1]] = cost;
+    } else {
+      return errors::DataLoss("Invalid line in clustering profile ", path,
+                              ": ", line);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Measured costs of the nodes of a model, which auto-clustering uses to veto
+// the clusters that run slower compiled by XLA than run by the TF executor.
+//
+// A profile is built in three steps, and is meant to be kept per model:
+//  * Auto-clustering records the nodes of the clusters it forms, with
+//    SetClusterNodes().
+//  * AddXlaStepStats() records the costs of these clusters, from the step
+//    stats of steps run with them.
+//  * AddTfStepStats() records the costs of the nodes, from the step stats of
+//    steps run without XLA.
+// A cluster is then vetoed once the measured cost of its nodes run by XLA
+// exceeds the sum of their measured costs run by the TF executor.
+class ClusteringProfile {
+ public:
+  // Records the mean cost of each node of the steps, run without XLA.
+  void AddTfStepStats(const StepStats& step_stats);
+
+  // Records the mean cost of each cluster of the steps, run with the clusters
+  // recorded by SetClusterNodes().
+  void AddXlaStepStats(const StepStats& step_stats);
+
+  // Records the nodes of `cluster`, as formed by auto-clustering.
+  void SetClusterNodes(absl::string_view cluster,
+                       std::vector<std::string> nodes);
+
+  // Returns true if `nodes` were measured to run slower as a cluster than
+  // individually.
+  bool ShouldVeto(std::vector<std::string> nodes) const;
+
+  // Saves the profile to, or loads it from, a text file.
+  Status Save(Env* env, const std::string& path) const;
+  static Status Load(Env* env, const std::string& path,
+                     ClusteringProfile* profile);
+
+ private:
+  struct Cost {
+    int64_t total_micros = 0;
+    int64_t count = 0;
+
+    double mean_micros() const {
+      return static_cast<double>(total_micros) / count;
+    }
+  };
+
+  // Returns the key of a set of nodes.
+  static std::string NodesKey(std::vector<std::string> nodes);
+
+  // The costs of the nodes run by the TF executor.
+  absl::flat_hash_map<std::string, Cost> node_costs_;
+  // The costs of sets of nodes run as clusters, by NodesKey().
+  absl::flat_hash_map<std::string, Cost> cluster_costs_;
+  // The nodes of the clusters formed by auto-clustering, by cluster name.
+  absl::flat_hash_map<std::string, std::vector<std::string>> cluster_nodes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTERING_PROFILE_H_
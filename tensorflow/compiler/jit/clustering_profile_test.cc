@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_profile.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void AddNodeStats(const std::string& name, int64_t micros,
+                  StepStats* step_stats) {
+  if (step_stats->dev_stats_size() == 0) step_stats->add_dev_stats();
+  NodeExecStats* node_stats =
+      step_stats->mutable_dev_stats(0)->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_end_rel_micros(micros);
+}
+
+TEST(ClusteringProfileTest, VetoesSlowerClusters) {
+  ClusteringProfile profile;
+  profile.SetClusterNodes("cluster_0", {"a", "b"});
+  profile.SetClusterNodes("cluster_1", {"c", "d"});
+
+  StepStats tf_stats;
+  AddNodeStats("a", 10, &tf_stats);
+  AddNodeStats("b", 10, &tf_stats);
+  AddNodeStats("c", 10, &tf_stats);
+  AddNodeStats("d", 10, &tf_stats);
+  profile.AddTfStepStats(tf_stats);
+
+  StepStats xla_stats;
+  AddNodeStats("cluster_0/xla_compile", 1000, &xla_stats);
+  AddNodeStats("cluster_0/xla_run", 30, &xla_stats);
+  AddNodeStats("cluster_1/xla_run", 5, &xla_stats);
+  profile.AddXlaStepStats(xla_stats);
+
+  EXPECT_TRUE(profile.ShouldVeto({"b", "a"}));
+  EXPECT_FALSE(profile.ShouldVeto({"c", "d"}));
+  // Clusters of other nodes were not measured.
+  EXPECT_FALSE(profile.ShouldVeto({"a"}));
+  EXPECT_FALSE(profile.ShouldVeto({"a", "b", "c"}));
+}
+
+TEST(ClusteringProfileTest, DoesNotVetoUnmeasuredNodes) {
+  ClusteringProfile profile;
+  profile.SetClusterNodes("cluster_0", {"a", "b"});
+  StepStats tf_stats;
+  AddNodeStats("a", 10, &tf_stats);
+  profile.AddTfStepStats(tf_stats);
+  StepStats xla_stats;
+  AddNodeStats("cluster_0/xla_run", 30, &xla_stats);
+  profile.AddXlaStepStats(xla_stats);
+
+  EXPECT_FALSE(profile.ShouldVeto({"a", "b"}));
+}
+
+TEST(ClusteringProfileTest, SavesAndLoads) {
+  ClusteringProfile profile;
+  profile.SetClusterNodes("cluster_0", {"a", "b"});
+  StepStats tf_stats;
+  AddNodeStats("a", 10, &tf_stats);
+  AddNodeStats("b", 10, &tf_stats);
+  profile.AddTfStepStats(tf_stats);
+
+  Env* env = Env::Default();
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "clustering_profile_test");
+  TF_ASSERT_OK(profile.Save(env, path));
+
+  // The clusters recorded by the previous session are measured in this one.
+  ClusteringProfile loaded;
+  TF_ASSERT_OK(ClusteringProfile::Load(env, path, &loaded));
+  StepStats xla_stats;
+  AddNodeStats("cluster_0/xla_run", 30, &xla_stats);
+  loaded.AddXlaStepStats(xla_stats);
+  EXPECT_TRUE(loaded.ShouldVeto({"a", "b"}));
+}
+
+TEST(ClusteringProfileTest, RejectsInvalidFile) {
+  Env* env = Env::Default();
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "invalid_clustering_profile");
+  TF_ASSERT_OK(WriteStringToFile(env, path, "node a ten 1\n"));
+  ClusteringProfile profile;
+  EXPECT_TRUE(
+      errors::IsDataLoss(ClusteringProfile::Load(env, path, &profile)));
+}
+
+}  // namespace
+}  // namespace tensorflow
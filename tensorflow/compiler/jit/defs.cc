@@ -21,6 +21,10 @@ namespace tensorflow {
 
 const char* const kXlaMustCompileAttr = "_XlaMustCompile";
 
+const char* const kXlaBatchBucketsAttr = "_XlaBatchBuckets";
+
+const char* const kXlaPrecompileShapesAttr = "_XlaPrecompileShapes";
+
 const char* const kXlaCompileAttr = "_XlaCompile";
 
 // User-provided through jit_scope APIs. Effective only when auto_jit is OFF.
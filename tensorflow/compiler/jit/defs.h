@@ -27,6 +27,21 @@ namespace tensorflow {
 // with XLA, or an error will be thrown.
 extern const char* const kXlaMustCompileAttr;  // "_XlaMustCompile"
 
+// The batch sizes that an XlaLaunch of the function pads the batch dimension
+// of its inputs to, which bounds its number of compilations. An empty list
+// stands for the powers of two. Only valid for functions whose results and
+// updates only depend row by row on the rows of their inputs along their first
+// dimension. XLA does not tell which outputs are batched, so every output
+// whose first dimension is the bucket is sliced back to the batch size: the
+// function must not return unbatched tensors whose first dimension may equal a
+// bucket.
+extern const char* const kXlaBatchBucketsAttr;  // "_XlaBatchBuckets"
+
+// The static shapes of the inputs of an _XlaCompile node, which are known when
+// the graph is built, so that the cluster can be compiled before its first
+// execution.
+extern const char* const kXlaPrecompileShapesAttr;  // "_XlaPrecompileShapes"
+
 // Implies auto-clustering: tagged nodes will be clustered and compiled with XLA
 // on a best-effort basis.
 extern const char* const kXlaCompileAttr;  // "_XlaCompile"
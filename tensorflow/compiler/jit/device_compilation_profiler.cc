@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -62,9 +63,6 @@ void RegisterExecutionForCluster(
 // signature before  we attempt to compile it.
 constexpr int64_t kDefaultCompilationThreshold = 2;
 
-// Maximum number of ongoing compilations.
-constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
-
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -181,7 +179,8 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
 
   if (compile_mode == DeviceCompileMode::kAsync) {
     // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
+    if (num_ongoing_compilations_ >=
+        GetXlaOpsCommonFlags()->tf_xla_async_compilation_max_pending) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
               << " because of too many ongoing compilations.";
       return false;
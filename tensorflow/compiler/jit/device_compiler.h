@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -169,6 +171,21 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  // Runs the most requested of the pending asynchronous compilations.
+  void RunHottestPendingCompilation();
+
+  // An asynchronous compilation waiting for a compiler thread.
+  struct PendingCompilation {
+    std::function<void()> compile;
+    // The number of times the signature was requested since it was queued.
+    int64_t request_count;
+  };
+
+  mutex pending_compilations_mu_;
+  absl::flat_hash_map<DeviceCompilationClusterSignature, PendingCompilation,
+                      DeviceCompilationClusterSignature::Hash>
+      pending_compilations_ TF_GUARDED_BY(pending_compilations_mu_);
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -216,7 +233,7 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+      std::max(GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads, 1));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -372,7 +389,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -390,10 +407,39 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    pending_compilations_[signature] = {std::move(compile),
+                                        /*request_count=*/1};
+  }
+  // Each scheduled closure runs one pending compilation, so that all of them
+  // have run once the thread pool is destroyed.
+  async_compiler_threads_->Schedule([this] { RunHottestPendingCompilation(); });
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType,
+                    ClientType>::RunHottestPendingCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    auto hottest = pending_compilations_.end();
+    for (auto it = pending_compilations_.begin();
+         it != pending_compilations_.end(); ++it) {
+      if (hottest == pending_compilations_.end() ||
+          it->second.request_count > hottest->second.request_count) {
+        hottest = it;
+      }
+    }
+    if (hottest == pending_compilations_.end()) return;
+    compile = std::move(hottest->second.compile);
+    pending_compilations_.erase(hottest);
+  }
+  compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -487,6 +533,9 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    mutex_lock lock(pending_compilations_mu_);
+    auto it = pending_compilations_.find(signature);
+    if (it != pending_compilations_.end()) ++it->second.request_count;
     return absl::OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "xla/client/client_library.h"
@@ -39,7 +40,9 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -103,6 +106,14 @@ std::vector<XlaCompiler::Argument> SampleArgsForAddXY() {
   return args;
 }
 
+// Returns the arguments of AddXY for vectors of `size` elements, so that
+// each size is a different signature.
+std::vector<XlaCompiler::Argument> ArgsForAddXY(int64_t size) {
+  std::vector<XlaCompiler::Argument> args = SampleArgsForAddXY();
+  for (XlaCompiler::Argument& arg : args) arg.shape = TensorShape({size});
+  return args;
+}
+
 class MockXlaDeviceExecutablePersistor
     : public DeviceExecutablePersistor<xla::LocalExecutable, xla::LocalClient> {
  public:
@@ -130,6 +141,58 @@ class MockDeviceCompilationProfiler : public DeviceCompilationProfiler {
               (override));
 };
 
+// Records the clusters whose compilations finish, in order. The first
+// compilation is held until Release() is called, so that the asynchronous
+// compilations requested meanwhile queue up behind it.
+class BlockingDeviceCompilationProfiler : public DeviceCompilationProfiler {
+ public:
+  Status RegisterCompilation(const NameAttrList& function,
+                             int64_t compile_time_us,
+                             bool used_persistent_cache) override {
+    TF_RETURN_IF_ERROR(DeviceCompilationProfiler::RegisterCompilation(
+        function, compile_time_us, used_persistent_cache));
+    bool first;
+    {
+      mutex_lock lock(compiled_mu_);
+      first = compiled_.empty();
+      compiled_.push_back(function.name());
+      compiled_cv_.notify_all();
+    }
+    if (first) {
+      first_compilation_started_.Notify();
+      release_.WaitForNotification();
+    }
+    return absl::OkStatus();
+  }
+
+  void WaitForFirstCompilation() {
+    first_compilation_started_.WaitForNotification();
+  }
+
+  void Release() { release_.Notify(); }
+
+  // Returns the clusters compiled, once `n` compilations have finished.
+  std::vector<std::string> WaitForCompilations(int n) {
+    mutex_lock lock(compiled_mu_);
+    while (static_cast<int>(compiled_.size()) < n) compiled_cv_.wait(lock);
+    return compiled_;
+  }
+
+  // Waits until no asynchronous compilation is counted as ongoing any more.
+  void WaitForNoOngoingCompilations() {
+    while (GetNumOngoingAsyncCompilations() > 0) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+ private:
+  Notification first_compilation_started_;
+  Notification release_;
+  mutex compiled_mu_;
+  condition_variable compiled_cv_;
+  std::vector<std::string> compiled_ TF_GUARDED_BY(compiled_mu_);
+};
+
 class DeviceCompilerTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -318,6 +381,118 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+// Sets the asynchronous compilation flags for the duration of a test.
+class AsyncCompilationFlagsSetter {
+ public:
+  AsyncCompilationFlagsSetter(int32 threads, int64_t max_pending)
+      : flags_(GetXlaOpsCommonFlags()),
+        saved_threads_(flags_->tf_xla_async_compilation_threads),
+        saved_max_pending_(flags_->tf_xla_async_compilation_max_pending) {
+    flags_->tf_xla_async_compilation_threads = threads;
+    flags_->tf_xla_async_compilation_max_pending = max_pending;
+  }
+
+  ~AsyncCompilationFlagsSetter() {
+    flags_->tf_xla_async_compilation_threads = saved_threads_;
+    flags_->tf_xla_async_compilation_max_pending = saved_max_pending_;
+  }
+
+ private:
+  XlaOpsCommonFlags* flags_;
+  const int32 saved_threads_;
+  const int64_t saved_max_pending_;
+};
+
+TEST_F(DeviceCompilerTest, CompileAsyncMostRequestedFirst) {
+  for (const char* name : {"bar", "baz"}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto fdef, SampleFuntionAddXY(name));
+    TF_ASSERT_OK(flib_def_->AddFunctionDef(fdef));
+  }
+  // A single compiler thread, so that compilations run one at a time.
+  AsyncCompilationFlagsSetter flags(/*threads=*/1, /*max_pending=*/10);
+  auto* profiler = new BlockingDeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  XlaDeviceCompiler* xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+  options.client = xla_device_compiler->client();
+  auto request = [&](const std::string& name) {
+    NameAttrList fn;
+    fn.set_name(name);
+    const XlaCompiler::CompilationResult* compilation_result = nullptr;
+    xla::LocalExecutable* xla_executable = nullptr;
+    TF_EXPECT_OK(xla_device_compiler->CompileIfNeeded(
+        options, fn, SampleArgsForAddXY(), XlaCompiler::CompileOptions{},
+        DeviceCompileMode::kAsync, profiler, &compilation_result,
+        &xla_executable));
+    EXPECT_TRUE(compilation_result == nullptr);
+    EXPECT_TRUE(xla_executable == nullptr);
+  };
+
+  // "foo" occupies the compiler thread while the others queue up.
+  request("foo");
+  profiler->WaitForFirstCompilation();
+  request("bar");
+  request("baz");
+  request("baz");
+  request("baz");
+  profiler->Release();
+
+  EXPECT_EQ(profiler->WaitForCompilations(3),
+            std::vector<std::string>({"foo", "baz", "bar"}));
+}
+
+TEST_F(DeviceCompilerTest, CompileAsyncBeyondMaxPendingRunsFallback) {
+  AsyncCompilationFlagsSetter flags(/*threads=*/1, /*max_pending=*/1);
+  auto* profiler = new BlockingDeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  XlaDeviceCompiler* xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+  options.client = xla_device_compiler->client();
+  NameAttrList fn;
+  fn.set_name("foo");
+  const XlaCompiler::CompilationResult* compilation_result = nullptr;
+  xla::LocalExecutable* xla_executable = nullptr;
+
+  // The first execution of a cluster is always compiled.
+  TF_ASSERT_OK(xla_device_compiler->CompileIfNeeded(
+      options, fn, ArgsForAddXY(2), XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, profiler, &compilation_result,
+      &xla_executable));
+  profiler->WaitForFirstCompilation();
+
+  // Another signature of the cluster is past the cap, so it is not queued and
+  // the caller runs the fallback path.
+  TF_ASSERT_OK(xla_device_compiler->CompileIfNeeded(
+      options, fn, ArgsForAddXY(3), XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, profiler, &compilation_result,
+      &xla_executable));
+  EXPECT_TRUE(compilation_result == nullptr);
+  EXPECT_TRUE(xla_executable == nullptr);
+  TF_ASSERT_OK_AND_ASSIGN(auto signature,
+                          Signature::Build(fn, ArgsForAddXY(3)));
+  auto cache_value = xla_device_compiler->cache()->Lookup(signature);
+  ASSERT_TRUE(cache_value);
+  EXPECT_EQ(cache_value->compile_state, DeviceCompileState::kUncompiled);
+
+  // Once the first compilation is done, the signature is queued on its next
+  // request.
+  profiler->Release();
+  profiler->WaitForNoOngoingCompilations();
+  TF_ASSERT_OK(xla_device_compiler->CompileIfNeeded(
+      options, fn, ArgsForAddXY(3), XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, profiler, &compilation_result,
+      &xla_executable));
+  EXPECT_EQ(profiler->WaitForCompilations(2),
+            std::vector<std::string>({"foo", "foo"}));
+  cache_value = xla_device_compiler->cache()->Lookup(signature);
+  ASSERT_TRUE(cache_value);
+  EXPECT_EQ(cache_value->compile_state, DeviceCompileState::kCompiled);
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_executable_persistor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace device_executable_persistor_internal {
+namespace {
+
+constexpr char kEntrySuffix[] = ".pb";
+constexpr char kUseMarkerSuffix[] = ".used";
+
+}  // namespace
+
+uint64 CompilerFingerprint() {
+  static const uint64 fingerprint = [] {
+    const char* xla_flags = std::getenv("XLA_FLAGS");
+    return Fingerprint64(absl::StrCat(TF_VERSION_STRING, "/",
+                                      xla_flags == nullptr ? "" : xla_flags));
+  }();
+  return fingerprint;
+}
+
+Status SaveSerializedEntry(const std::string& directory,
+                           const std::string& file_path,
+                           const XlaSerializedCacheEntry& entry) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+
+  // The cache on the filesystem can be read while we're writing out the proto.
+  // To prevent reads of partially-written files, we write the proto to a temp
+  // file, then move it into place once we're done writing.  And we warn the
+  // user if these moves are not known to be atomic.
+  bool has_atomic_move = false;
+  env->HasAtomicMove(directory, &has_atomic_move).IgnoreError();
+  if (!has_atomic_move) {
+    LOG_EVERY_POW_2(WARNING)
+        << "Filesystem for XLA persistent cache at " << directory
+        << " does not support atomic moves.  Therefore the persistent cache is "
+           "racy if you have multiple XLA compilations occurring "
+           "simultaneously!  You have been warned. :)";
+  }
+
+  // Write to temp location, then when that completes, atomically move into the
+  // final location.
+  std::string temp_path(absl::StripSuffix(file_path, kEntrySuffix));
+  if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", directory));
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
+  return env->RenameFile(temp_path, file_path);
+}
+
+void MarkEntryUsed(const std::string& file_path) {
+  Status s = WriteStringToFile(Env::Default(),
+                               absl::StrCat(file_path, kUseMarkerSuffix), "");
+  if (!s.ok()) {
+    VLOG(1) << "Could not mark XLA persistent cache entry " << file_path
+            << " as used: " << s;
+  }
+}
+
+Status EvictLeastRecentlyUsedEntries(const std::string& directory,
+                                     int64_t max_bytes,
+                                     const std::string& keep_path) {
+  Env* env = Env::Default();
+  std::vector<std::string> paths;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+      io::JoinPath(directory, absl::StrCat("*", kEntrySuffix)), &paths));
+
+  struct Entry {
+    std::string path;
+    int64_t bytes;
+    int64_t last_use_nsec;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(paths.size());
+  int64_t total_bytes = 0;
+  for (std::string& path : paths) {
+    FileStatistics stat;
+    // Entries may be deleted concurrently by other processes.
+    if (!env->Stat(path, &stat).ok()) continue;
+    int64_t last_use_nsec = stat.mtime_nsec;
+    FileStatistics marker_stat;
+    if (env->Stat(absl::StrCat(path, kUseMarkerSuffix), &marker_stat).ok()) {
+      last_use_nsec = std::max(last_use_nsec, marker_stat.mtime_nsec);
+    }
+    total_bytes += stat.length;
+    entries.push_back({std::move(path), stat.length, last_use_nsec});
+  }
+  if (total_bytes <= max_bytes) return absl::OkStatus();
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_use_nsec < b.last_use_nsec;
+            });
+  for (const Entry& entry : entries) {
+    if (total_bytes <= max_bytes) break;
+    if (entry.path == keep_path) continue;
+    VLOG(1) << "Evicting XLA persistent cache entry " << entry.path;
+    Status s = env->DeleteFile(entry.path);
+    if (!s.ok() && !absl::IsNotFound(s)) return s;
+    env->DeleteFile(absl::StrCat(entry.path, kUseMarkerSuffix)).IgnoreError();
+    total_bytes -= entry.bytes;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace device_executable_persistor_internal
+}  // namespace tensorflow
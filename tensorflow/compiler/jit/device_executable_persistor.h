@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/log/log.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
@@ -28,12 +30,37 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
+namespace device_executable_persistor_internal {
+
+// Returns a fingerprint of the TensorFlow version and XLA flags, which
+// determine how executables are compiled, so that a cache directory shared
+// across binaries never serves executables built by a different compiler.
+uint64 CompilerFingerprint();
+
+// Writes `entry` to `file_path` in `directory` through a temporary file that
+// is moved into place, so that concurrent readers and writers of the same
+// entry never see a partially written file on file systems with atomic moves.
+Status SaveSerializedEntry(const std::string& directory,
+                           const std::string& file_path,
+                           const XlaSerializedCacheEntry& entry);
+
+// Records a use of the entry at `file_path`, for eviction.
+void MarkEntryUsed(const std::string& file_path);
+
+// Deletes the least recently written or used entries in `directory`, other
+// than the one at `keep_path`, until they take at most `max_bytes` in total.
+Status EvictLeastRecentlyUsedEntries(const std::string& directory,
+                                     int64_t max_bytes,
+                                     const std::string& keep_path);
+
+}  // namespace device_executable_persistor_internal
 
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
@@ -74,6 +101,15 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If positive, the least recently used entries in
+    // `persistent_cache_directory` are deleted after an entry is persisted,
+    // until the directory holds at most this many bytes of entries.
+    int64_t persistent_cache_max_bytes = 0;
+
+    // If true, `TryToPersistExecutable` serializes the executable and returns,
+    // and the entry is written to the directory in the background.
+    bool persist_asynchronously = false;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -128,12 +164,14 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class, then evicts entries over the size limit.
+  // Overwrites existing entries.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
   // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
+  // cache entry is found, or if it cannot be read, e.g. because another
+  // process is evicting it.
   absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
   TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
 
@@ -157,6 +195,9 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const int64_t persistent_cache_max_bytes_;
+  const bool persist_asynchronously_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +211,9 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      persistent_cache_max_bytes_(config.persistent_cache_max_bytes),
+      persist_asynchronously_(config.persist_asynchronously) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -180,7 +223,8 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type(),
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compiler_fingerprint(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "");
@@ -205,6 +249,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_fingerprint(
+      device_executable_persistor_internal::CompilerFingerprint());
   return key;
 }
 
@@ -236,8 +282,20 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
-  return std::optional<XlaSerializedCacheEntry>(entry);
+  Status s = ReadTextOrBinaryProto(env, file_path, &entry);
+  if (!s.ok()) {
+    // The directory may be shared with other processes, which can delete the
+    // entry while evicting, or, on file systems without atomic moves, be
+    // writing it.
+    LOG(WARNING) << "Ignoring unreadable XLA persistent cache entry "
+                 << file_path << ": " << s;
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  if (persistent_cache_max_bytes_ > 0 &&
+      !persistent_cache_directory_read_only_) {
+    device_executable_persistor_internal::MarkEntryUsed(file_path);
+  }
+  return std::optional<XlaSerializedCacheEntry>(std::move(entry));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -278,35 +336,14 @@ template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
     const XlaSerializedCacheEntry& entry) const {
-  Env* env = Env::Default();
-  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
-
-  // The cache on the filesystem can be read while we're writing out the proto.
-  // To prevent reads of partially-written files, we write the proto to a temp
-  // file, then move it into place once we're done writing.  And we warn the
-  // user if these moves are not known to be atomic.
-  bool has_atomic_move = false;
-  env->HasAtomicMove(persistent_cache_directory_, &has_atomic_move)
-      .IgnoreError();
-  if (!has_atomic_move) {
-    LOG_EVERY_POW_2(WARNING)
-        << "Filesystem for XLA persistent cache at "
-        << persistent_cache_directory_
-        << " does not support atomic moves.  Therefore the persistent cache is "
-           "racy if you have multiple XLA compilations occurring "
-           "simultaneously!  You have been warned. :)";
+  const std::string file_path = GetFilePath(entry.key());
+  TF_RETURN_IF_ERROR(device_executable_persistor_internal::SaveSerializedEntry(
+      persistent_cache_directory_, file_path, entry));
+  if (persistent_cache_max_bytes_ > 0) {
+    return device_executable_persistor_internal::EvictLeastRecentlyUsedEntries(
+        persistent_cache_directory_, persistent_cache_max_bytes_, file_path);
   }
-
-  // Write to temp location, then when that completes, atomically move into the
-  // final location.
-  std::string temp_path = io::JoinPath(
-      persistent_cache_directory_, XlaSerializedCacheKeyToString(entry.key()));
-  if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
-    return absl::UnavailableError(absl::StrCat(
-        "Could not create a unique file inside ", persistent_cache_directory_));
-  }
-  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  return absl::OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -400,7 +437,26 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
-  TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  if (!persist_asynchronously_) {
+    return SaveSerializedEntry(serialized_entry);
+  }
+  // Only copies are captured, so that the write may outlive this persistor.
+  Env::Default()->SchedClosure(
+      [directory = persistent_cache_directory_,
+       file_path = GetFilePath(serialized_entry.key()),
+       max_bytes = persistent_cache_max_bytes_,
+       entry = std::move(serialized_entry)]() {
+        Status s = device_executable_persistor_internal::SaveSerializedEntry(
+            directory, file_path, entry);
+        if (s.ok() && max_bytes > 0) {
+          s = device_executable_persistor_internal::
+              EvictLeastRecentlyUsedEntries(directory, max_bytes, file_path);
+        }
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to persist XLA cache entry " << file_path
+                       << ": " << s;
+        }
+      });
   return absl::OkStatus();
 }
 
@@ -202,7 +202,8 @@ std::string GetFilePath(XlaSerializedCacheKey key,
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
-      key.device_type(),
+      key.device_type(), kXlaSerializedCacheKeySeparator,
+      key.compiler_fingerprint(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "",
@@ -231,6 +232,8 @@ XlaSerializedCacheKey CreateCacheKey(
   key.set_device_type(device_type.type_string());
   key.set_prefix(persistence_prefix);
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_fingerprint(
+      device_executable_persistor_internal::CompilerFingerprint());
   return key;
 }
 
@@ -428,6 +431,31 @@ TEST_F(DeviceExecutionPersistorTest, LoadFileDoesntExist) {
   EXPECT_FALSE(loaded_executable.has_value());
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadUnreadableEntry) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  // A partially written entry, e.g. one that is being copied into place by
+  // another process, is treated as missing.
+  auto key =
+      CreateCacheKey(/*signature_hash=*/789, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), GetFilePath(key, persistor.persistent_cache_directory()),
+      "\x0a\xff"));
+
+  MockXlaCompilerClient mock_client;
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+
+  EXPECT_FALSE(loaded_executable.has_value());
+}
+
 TEST_F(DeviceExecutionPersistorTest, LoadSerializedKeyMismatch) {
   XlaDeviceExecutablePersistor::Config config(
       /*persistent_cache_directory=*/cache_dir_,
@@ -631,5 +659,44 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistEvictsLeastRecentlyUsedEntries) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "lru");
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillRepeatedly(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor unbounded_persistor(
+      config, DefaultXlaOptions().device_type);
+  TF_ASSERT_OK(unbounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/1, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto key1 = CreateCacheKey(/*signature_hash=*/1, compilation_result_add_,
+                             unbounded_persistor.device_type(),
+                             unbounded_persistor.persistence_prefix());
+  uint64 entry_bytes = 0;
+  TF_ASSERT_OK(
+      Env::Default()->GetFileSize(GetFilePath(key1, cache_dir), &entry_bytes));
+
+  // Only one entry fits, so persisting a second one evicts the first.
+  config.persistent_cache_max_bytes = entry_bytes + entry_bytes / 2;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/2, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto key2 =
+      CreateCacheKey(/*signature_hash=*/2, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+
+  EXPECT_TRUE(errors::IsNotFound(
+      Env::Default()->FileExists(GetFilePath(key1, cache_dir))));
+  TF_EXPECT_OK(Env::Default()->FileExists(GetFilePath(key2, cache_dir)));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -167,6 +167,16 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_max_size_bytes",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_max_size_bytes,
+           "If positive, the least recently used entries of the persistent "
+           "cache are deleted to keep its directory under this size. "
+           "Unbounded by default."),
+      Flag("tf_xla_persistent_cache_async_writes",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_async_writes,
+           "If true, entries are written to the persistent cache in the "
+           "background instead of delaying the first run of a compiled "
+           "cluster."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -175,6 +185,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_clustering_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_profile,
+           "If non-empty, the path of a profile of the measured costs of the "
+           "model, used to veto the clusters that run slower under XLA. The "
+           "clusters formed by auto-clustering are recorded in it."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -222,6 +237,7 @@ void AllocateAndParseFlags() {
   build_ops_flags->tf_xla_disable_constant_folding = false;
   build_ops_flags->tf_xla_disable_full_embedding_pipelining = false;
   build_ops_flags->tf_xla_embedding_parallel_iterations = 0;
+  build_ops_flags->tf_xla_precompile_clusters = false;
 
   mark_for_compilation_flags = new MarkForCompilationPassFlags;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_single_gpu =
@@ -242,9 +258,12 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
+  mark_for_compilation_flags->tf_xla_persistent_cache_max_size_bytes = 0;
+  mark_for_compilation_flags->tf_xla_persistent_cache_async_writes = false;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_clustering_profile = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +282,9 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_threads = 10;
+  ops_flags->tf_xla_async_compilation_max_pending = 10;
+  ops_flags->tf_xla_donate_variable_snapshots = false;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -317,6 +339,12 @@ void AllocateAndParseFlags() {
             "If >0 then use this many parallel iterations in "
             "embedding_pipelining and embedding_sequency. By default, use the "
             "parallel_iterations on the original model WhileOp."),
+       Flag("tf_xla_precompile_clusters",
+            &build_ops_flags->tf_xla_precompile_clusters,
+            "If true then lazily compiled clusters whose inputs have static "
+            "shapes are compiled in parallel in the background when their "
+            "function is instantiated, instead of one by one when they are "
+            "first executed."),
 
        Flag("tf_xla_compile_on_demand", &device_flags->tf_xla_compile_on_demand,
             "Switch a device into 'on-demand' mode, where instead of "
@@ -334,6 +362,21 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_threads",
+            &ops_flags->tf_xla_async_compilation_threads,
+            "The number of threads compiling clusters asynchronously."),
+       Flag("tf_xla_async_compilation_max_pending",
+            &ops_flags->tf_xla_async_compilation_max_pending,
+            "The maximum number of asynchronous compilations queued or "
+            "running at once. Queued compilations are run in order of the "
+            "number of times they were requested, and clusters beyond this "
+            "limit keep running the fallback path."),
+       Flag("tf_xla_donate_variable_snapshots",
+            &ops_flags->tf_xla_donate_variable_snapshots,
+            "If true, _XlaRun locks the resource variables it updates for the "
+            "whole execution, and donates their buffers to the executable "
+            "instead of copying them when only the snapshot taken by "
+            "_XlaCompile shares them."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
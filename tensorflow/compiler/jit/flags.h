@@ -104,6 +104,14 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // If positive, the least recently used entries of the persistent cache are
+  // evicted to keep its directory under this size.
+  int64_t tf_xla_persistent_cache_max_size_bytes;
+
+  // If true, entries are written to the persistent cache in the background
+  // rather than before the compiled executable is first run.
+  bool tf_xla_persistent_cache_async_writes;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -111,6 +119,11 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, the path of the clustering profile of the model (see
+  // ClusteringProfile), which vetoes the clusters measured to run slower under
+  // XLA, and in which the clusters that are formed are recorded.
+  string tf_xla_clustering_profile;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -151,6 +164,15 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // The number of threads compiling clusters asynchronously.
+  int32 tf_xla_async_compilation_threads;
+  // The maximum number of asynchronous compilations queued or running at once.
+  // Queued compilations are run most requested first.
+  int64_t tf_xla_async_compilation_max_pending;
+  // If true, _XlaRun locks the resource variables it updates for the whole
+  // execution, so that it can donate their buffers to the executable rather
+  // than keep the snapshots taken by _XlaCompile alive. Defaults to false.
+  bool tf_xla_donate_variable_snapshots;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -280,6 +302,11 @@ struct BuildXlaOpsPassFlags {
   // Force the WhileOps in embedding_pipelining and embedding_sequencing to use
   // this many parallel_iterations
   int tf_xla_embedding_parallel_iterations;
+
+  // If true, lazily compiled clusters whose inputs all have static shapes are
+  // compiled asynchronously as soon as their _XlaCompile kernels are created,
+  // rather than one by one as they are first executed.
+  bool tf_xla_precompile_clusters;
 };
 
 // Flags for common MLIR configurations.
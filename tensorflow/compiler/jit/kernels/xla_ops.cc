@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
@@ -26,11 +29,14 @@ limitations under the License.
 #include <utility>
 #include <variant>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -54,6 +60,7 @@ limitations under the License.
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/statusor.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -123,6 +130,9 @@ class ExecutableClosure {
   const ResourceVarsSnapshot& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  ResourceVarsSnapshot* mutable_resource_var_snapshots() {
+    return &resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
 
  private:
@@ -370,8 +380,11 @@ GetXlaCompilerArgsAndSnapshotVariables(
   return result;
 }
 
+// As below, but from the resources of a device rather than of an
+// OpKernelContext, which are also known when a kernel is created.
 Status CompileToLocalExecutable(
-    OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
+    ResourceMgr* rm, DeviceBase* device, FunctionLibraryRuntime* flr,
+    se::Stream* stream, const NameAttrList& function, bool has_ref_vars,
     const XlaPlatformInfo& platform_info,
     const std::vector<XlaCompiler::Argument>& args,
     DeviceCompileMode compile_mode, bool may_alias_resource_update,
@@ -380,7 +393,6 @@ Status CompileToLocalExecutable(
     xla::LocalExecutable** executable) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
-  ResourceMgr* rm = ctx->resource_manager();
   if (!rm) {
     return absl::InternalError("No resource manager.");
   }
@@ -392,8 +404,8 @@ Status CompileToLocalExecutable(
   TF_RETURN_IF_ERROR(rm->LookupOrCreate<XlaDeviceCompiler>(
       rm->default_container(), "xla_device_compiler", &xla_device_compiler,
       [&](XlaDeviceCompiler** xla_device_compiler) {
-        return BuildXlaDeviceCompiler(ctx->device(), ctx->function_library(),
-                                      platform_info, compilation_device_type,
+        return BuildXlaDeviceCompiler(device, flr, platform_info,
+                                      compilation_device_type,
                                       xla_device_compiler);
       }));
   DeviceCompilationProfiler* profiler;
@@ -411,9 +423,9 @@ Status CompileToLocalExecutable(
 
   *client = static_cast<xla::LocalClient*>(xla_device_compiler->client());
 
-  XlaCompiler::Options options = GenerateCompilerOptions(
-      *xla_device_compiler, *ctx->function_library(), ctx->device(),
-      GetStream(ctx), platform_info, has_ref_vars);
+  XlaCompiler::Options options =
+      GenerateCompilerOptions(*xla_device_compiler, *flr, device, stream,
+                              platform_info, has_ref_vars);
 
   XlaCompiler::CompileOptions compile_options =
       GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
@@ -423,6 +435,21 @@ Status CompileToLocalExecutable(
       compilation_result, executable);
 }
 
+Status CompileToLocalExecutable(
+    OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
+    const XlaPlatformInfo& platform_info,
+    const std::vector<XlaCompiler::Argument>& args,
+    DeviceCompileMode compile_mode, bool may_alias_resource_update,
+    xla::LocalClient** client,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable) {
+  return CompileToLocalExecutable(
+      ctx->resource_manager(), ctx->device(), ctx->function_library(),
+      GetStream(ctx), function, has_ref_vars, platform_info, args,
+      compile_mode, may_alias_resource_update, client, compilation_result,
+      executable);
+}
+
 Status GetUpdatedVariables(
     const OpKernelContext* ctx, absl::Span<const Tensor* const> inputs,
     absl::Span<const int> variable_indices,
@@ -472,6 +499,97 @@ void RunInThreadPoolIfCollectivesPresent(
   }
 }
 
+// Returns the smallest of the sorted `buckets` not less than `batch_size`, or
+// the smallest power of two if `buckets` is empty. Returns `batch_size` if it
+// exceeds all the buckets.
+int64_t BatchBucket(absl::Span<const int64_t> buckets, int64_t batch_size) {
+  if (buckets.empty()) {
+    int64_t bucket = 1;
+    while (bucket < batch_size) bucket <<= 1;
+    return bucket;
+  }
+  auto it = std::lower_bound(buckets.begin(), buckets.end(), batch_size);
+  return it == buckets.end() ? batch_size : *it;
+}
+
+// Pads the batch dimension, i.e. the first one, of the `inputs` that are not
+// constants or resources to the bucket of their batch size with zeros. Sets
+// `batch_size` and `batch_bucket`, or leaves them and `inputs` unchanged if
+// the inputs don't share their batch size or are already of a bucket size. The
+// padded inputs are owned by `padded_inputs`.
+Status PadInputsToBatchBucket(OpKernelContext* ctx,
+                              absl::Span<const int64_t> buckets,
+                              const std::vector<int>& constants,
+                              const std::vector<int>& resources,
+                              std::vector<const Tensor*>* inputs,
+                              std::vector<Tensor>* padded_inputs,
+                              int64_t* batch_size, int64_t* batch_bucket) {
+  std::vector<int> batched_inputs;
+  for (int i = 0; i < inputs->size(); ++i) {
+    if (absl::c_linear_search(constants, i) ||
+        absl::c_linear_search(resources, i)) {
+      continue;
+    }
+    const Tensor& input = *(*inputs)[i];
+    if (input.dims() == 0 || !DataTypeCanUseMemcpy(input.dtype()) ||
+        (!batched_inputs.empty() &&
+         input.dim_size(0) != (*inputs)[batched_inputs[0]]->dim_size(0))) {
+      return absl::OkStatus();
+    }
+    batched_inputs.push_back(i);
+  }
+  if (batched_inputs.empty()) return absl::OkStatus();
+  const int64_t size = (*inputs)[batched_inputs[0]]->dim_size(0);
+  const int64_t bucket = BatchBucket(buckets, size);
+  if (bucket == size) return absl::OkStatus();
+
+  VLOG(2) << "Padding batch of size " << size << " to " << bucket;
+  se::Stream* stream = GetStream(ctx);
+  // The inputs point into `padded_inputs`, which must not reallocate.
+  padded_inputs->reserve(batched_inputs.size());
+  for (int i : batched_inputs) {
+    const Tensor& input = *(*inputs)[i];
+    TensorShape shape = input.shape();
+    shape.set_dim(0, bucket);
+    Tensor padded;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), shape, &padded));
+    const uint64_t input_bytes = input.TotalBytes();
+    const uint64_t padding_bytes = padded.TotalBytes() - input_bytes;
+    if (stream == nullptr) {
+      std::memcpy(padded.data(), input.data(), input_bytes);
+      std::memset(static_cast<char*>(padded.data()) + input_bytes, 0,
+                  padding_bytes);
+    } else {
+      se::DeviceMemoryBase dst(padded.data(), padded.TotalBytes());
+      se::DeviceMemoryBase src(input.data(), input_bytes);
+      TF_RETURN_IF_ERROR(stream->Memcpy(&dst, src, input_bytes));
+      se::DeviceMemoryBase padding =
+          dst.GetByteSlice(input_bytes, padding_bytes);
+      TF_RETURN_IF_ERROR(stream->MemZero(&padding, padding_bytes));
+    }
+    padded_inputs->push_back(std::move(padded));
+    (*inputs)[i] = &padded_inputs->back();
+  }
+  *batch_size = size;
+  *batch_bucket = bucket;
+  return absl::OkStatus();
+}
+
+// Slices the outputs of `ctx` whose batch dimension is `batch_bucket` back to
+// `batch_size`, after their inputs were padded by PadInputsToBatchBucket. Any
+// output of that size is taken to be batched, see kXlaBatchBucketsAttr.
+void SliceOutputsToBatchSize(OpKernelContext* ctx, int64_t batch_bucket,
+                             int64_t batch_size) {
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    Tensor* output = ctx->mutable_output(i);
+    if (output == nullptr || output->dims() == 0 ||
+        output->dim_size(0) != batch_bucket) {
+      continue;
+    }
+    *output = output->Slice(0, batch_size);
+  }
+}
+
 }  // namespace
 
 XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
@@ -484,7 +602,21 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       resources_(resources),
       function_(function),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
-      has_ref_vars_(has_ref_vars) {}
+      has_ref_vars_(has_ref_vars) {
+  const FunctionLibraryDefinition* flib_def =
+      ctx->function_library() != nullptr
+          ? ctx->function_library()->GetFunctionLibraryDefinition()
+          : nullptr;
+  const FunctionDef* fdef =
+      flib_def != nullptr ? flib_def->Find(function.name()) : nullptr;
+  if (fdef == nullptr) return;
+  auto it = fdef->attr().find(kXlaBatchBucketsAttr);
+  if (it == fdef->attr().end()) return;
+  pad_batches_ = true;
+  batch_buckets_.assign(it->second.list().i().begin(),
+                        it->second.list().i().end());
+  std::sort(batch_buckets_.begin(), batch_buckets_.end());
+}
 
 void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
@@ -496,6 +628,25 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   std::vector<XlaCompiler::Argument> xla_compiler_args;
   const XlaCompiler::CompilationResult* compilation_result;
 
+  bool use_pjrt = GetXlaOpsCommonFlags()
+                      ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
+                          platform_info_.device_type());
+
+  // The padded inputs outlive this call when the cluster runs in another
+  // thread.
+  auto padded_inputs = std::make_shared<std::vector<Tensor>>();
+  int64_t batch_size = -1;
+  int64_t batch_bucket = -1;
+  if (pad_batches_ && !use_pjrt &&
+      platform_info_.xla_device_metadata() == nullptr) {
+    OP_REQUIRES_OK_ASYNC(
+        ctx,
+        PadInputsToBatchBucket(ctx, batch_buckets_, constants_, resources_,
+                               &inputs, padded_inputs.get(), &batch_size,
+                               &batch_bucket),
+        done);
+  }
+
   xla::LocalClient* client;          // Not owned.
   xla::LocalExecutable* executable;  // Not owned.
 
@@ -527,9 +678,6 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     xla_compiler_args = std::move(status_or_xla_compiler_args.value());
   }
 
-  bool use_pjrt = GetXlaOpsCommonFlags()
-                      ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
-                          platform_info_.device_type());
   if (use_pjrt) {
     VLOG(2) << "Compiling using PJRT";
     Status status = CompileToPjRtLoadedExecutable(
@@ -582,7 +730,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_, padded_inputs,
+                          batch_size, batch_bucket]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -610,7 +759,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
           launch_context.PopulateInputs(
               ctx, compilation_result, resource_var_ptrs,
-              /*missing_ctx_input_prefix=*/0, input_output_alias);
+              /*missing_ctx_input_prefix=*/0, input_output_alias, inputs);
       OP_REQUIRES_OK_ASYNC(ctx, execution_inputs.status(), done);
 
       xla::gpu::GpuExecutableRunOptions gpu_options;
@@ -644,6 +793,9 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
               /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
               input_output_alias, resource_var_ptrs),
           done);
+      if (batch_size >= 0) {
+        SliceOutputsToBatchSize(ctx, batch_bucket, batch_size);
+      }
       VLOG(1) << "Done";
     }
     done();
@@ -710,6 +862,66 @@ bool HasRefVars(OpKernelConstruction* ctx) {
   return has_ref_vars;
 }
 
+// Returns whether the executables compiled for _XlaRun may alias updated
+// resource variables to their new values, so that their buffers can be
+// donated. _XlaRun then keeps the variables locked while it runs them.
+bool XlaRunMayAliasResourceUpdates() {
+  return GetXlaOpsCommonFlags()->tf_xla_donate_variable_snapshots;
+}
+
+// Queues the asynchronous compilation of the cluster of the _XlaCompile kernel
+// being created, if BuildXlaOpsPass recorded the static shapes of its inputs.
+// The executions of the kernel then find the cluster compiled, or being
+// compiled, rather than compiling the clusters of a graph one by one.
+void PrecompileCluster(OpKernelConstruction* ctx, const NameAttrList& function,
+                       bool has_ref_vars,
+                       const XlaPlatformInfo& platform_info) {
+  if (!ctx->HasAttr(kXlaPrecompileShapesAttr) ||
+      GetXlaOpsCommonFlags()->tf_xla_always_defer_compilation ||
+      GetXlaOpsCommonFlags()
+          ->tf_xla_use_device_api.IsEnabledInXlaCompileAndRunForDevice(
+              platform_info.device_type())) {
+    return;
+  }
+  std::vector<TensorShape> shapes;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kXlaPrecompileShapesAttr, &shapes));
+  const int num_args = shapes.size();
+  OP_REQUIRES(ctx, num_args == ctx->num_inputs(),
+              errors::InvalidArgument("Expected ", ctx->num_inputs(),
+                                      " precompile shapes, got ", num_args));
+
+  // The arguments that BuildXlaCompilerArguments builds from inputs of these
+  // shapes, so that the executions hit the same cache entry.
+  std::vector<XlaCompiler::Argument> args(num_args);
+  for (int i = 0; i < num_args; ++i) {
+    XlaCompiler::Argument& arg = args[i];
+    arg.type = ctx->input_type(i);
+    arg.shape = shapes[i];
+    if (shapes[i].num_elements() > 0) {
+      arg.kind = XlaCompiler::Argument::kParameter;
+    } else {
+      arg.kind = XlaCompiler::Argument::kConstant;
+      arg.constant_value = Tensor(arg.type, shapes[i]);
+    }
+  }
+
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      ctx->device()->tensorflow_accelerator_device_info();
+  xla::LocalClient* client;
+  const XlaCompiler::CompilationResult* compilation_result;
+  xla::LocalExecutable* executable;
+  Status status = CompileToLocalExecutable(
+      ctx->resource_manager(), ctx->device(), ctx->function_library(),
+      device_info ? device_info->stream : nullptr, function, has_ref_vars,
+      platform_info, args, DeviceCompileMode::kAsync,
+      XlaRunMayAliasResourceUpdates(), &client, &compilation_result,
+      &executable);
+  // The executions report compilation errors, as without precompilation.
+  if (!status.ok()) {
+    VLOG(1) << "Failed to precompile " << function.name() << ": " << status;
+  }
+}
+
 class XlaLaunchV2Op : public XlaLocalLaunchBase {
  public:
   explicit XlaLaunchV2Op(OpKernelConstruction* ctx)
@@ -735,7 +947,9 @@ XlaCompileOp::XlaCompileOp(OpKernelConstruction* ctx)
       function_(FunctionAttr(ctx)),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
       must_compile_(MustCompileAttr(ctx)),
-      has_ref_vars_(HasRefVars(ctx)) {}
+      has_ref_vars_(HasRefVars(ctx)) {
+  PrecompileCluster(ctx, function_, has_ref_vars_, platform_info_);
+}
 
 void XlaCompileOp::Compute(OpKernelContext* ctx) {
   VLOG(3) << "XlaCompileOp " << def().name()
@@ -778,7 +992,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
         args_and_variables_snapshot->first;
     variables_snapshot = std::move(args_and_variables_snapshot->second);
 
-    // Do not alias resource updates as locking variables in XlaCompile and
+    // Do not alias resource updates unless XlaRun holds the variable locks
+    // for the whole execution, as locking variables in XlaCompile and
     // unlocking them in XlaRun may lead to deadlocks.
     Status status;
     if (use_pjrt) {
@@ -791,7 +1006,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          XlaRunMayAliasResourceUpdates(), &client, &kernel, &executable);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -856,6 +1071,37 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   ctx->set_output(1, compilation_successful);
 }
 
+namespace {
+
+// Releases the snapshots of the locked `variables` that still hold the
+// snapshotted buffer, and reads them from the variables instead. The buffers
+// of the variables can then be donated to the executable if nothing else
+// references them, since the variables stay locked until they are updated.
+// The snapshots of variables assigned since they were taken are still read,
+// and are added to `kept_snapshots` so that they are not donated either.
+void ReleaseSnapshotsOfLockedVariables(
+    int num_constant_args, const std::vector<VariableInfo>& variables,
+    ResourceVarsSnapshot* snapshots,
+    std::map<int, const Tensor*>* snapshot_ptrs,
+    std::vector<Tensor>* kept_snapshots) {
+  for (const VariableInfo& variable : variables) {
+    const int variable_index = variable.index() + num_constant_args;
+    auto it = snapshots->find(variable_index);
+    if (it == snapshots->end() || !it->second.has_value()) continue;
+    const Tensor* tensor = variable.var()->tensor();
+    if (!tensor->SharesBufferWith(*it->second) ||
+        tensor->dtype() != it->second->dtype() ||
+        tensor->shape() != it->second->shape()) {
+      kept_snapshots->push_back(*it->second);
+      continue;
+    }
+    it->second.reset();
+    (*snapshot_ptrs)[variable_index] = tensor;
+  }
+}
+
+}  // namespace
+
 XlaRunOp::XlaRunOp(OpKernelConstruction* ctx)
     : OpKernel(ctx), platform_info_(XlaPlatformInfoFromDevice(ctx->device())) {}
 
@@ -920,6 +1166,12 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+  // The updated variables, locked here for the whole execution if donating
+  // them, or only to update them otherwise.
+  std::vector<VariableInfo> variable_infos;
+  std::vector<Tensor> kept_snapshots;
+  const bool donate_variables =
+      GetXlaOpsCommonFlags()->tf_xla_donate_variable_snapshots;
   {
     tsl::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -929,12 +1181,26 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
         },
         tsl::profiler::TraceMeLevel::kInfo);
 
+    if (donate_variables) {
+      absl::StatusOr<std::vector<VariableInfo>> updated_variables =
+          GatherVariableInfo(ctx, *closure.compilation_result(),
+                             closure.num_constant_args());
+      OP_REQUIRES_OK(ctx, updated_variables.status());
+      variable_infos = *std::move(updated_variables);
+      OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+    }
     for (const auto& [variable_index, variable_tensor] :
          closure.resource_var_snapshots()) {
       snapshot_ptrs.emplace(variable_index, variable_tensor.has_value()
                                                 ? &variable_tensor.value()
                                                 : nullptr);
     }
+    if (donate_variables) {
+      ReleaseSnapshotsOfLockedVariables(
+          closure.num_constant_args(), variable_infos,
+          closure.mutable_resource_var_snapshots(), &snapshot_ptrs,
+          &kept_snapshots);
+    }
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
@@ -963,16 +1229,20 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       },
       tsl::profiler::TraceMeLevel::kInfo);
 
-  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
-      ctx, *closure.compilation_result(), closure.num_constant_args());
-  OP_REQUIRES_OK(ctx, variable_infos.status());
-  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
+  if (!donate_variables) {
+    absl::StatusOr<std::vector<VariableInfo>> updated_variables =
+        GatherVariableInfo(ctx, *closure.compilation_result(),
+                           closure.num_constant_args());
+    OP_REQUIRES_OK(ctx, updated_variables.status());
+    variable_infos = *std::move(updated_variables);
+    OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+  }
   OP_REQUIRES_OK(
       ctx,
       launch_context.PopulateOutputs(
           ctx, closure.compilation_result(), execution_output->ConsumeResult(),
           /*missing_ctx_input_prefix=*/closure.num_constant_args(),
-          absl::MakeSpan(*variable_infos), input_output_alias, snapshot_ptrs));
+          absl::MakeSpan(variable_infos), input_output_alias, snapshot_ptrs));
 }
 
 XlaMergeOp::XlaMergeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -66,6 +66,11 @@ class XlaLocalLaunchBase : public AsyncOpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // Whether to pad the batch of the inputs to one of `batch_buckets_`, see
+  // kXlaBatchBucketsAttr.
+  bool pad_batches_ = false;
+  std::vector<int64_t> batch_buckets_;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
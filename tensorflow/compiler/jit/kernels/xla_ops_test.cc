@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/kernels/xla_ops.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
+#include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/tf2xla/cc/ops/xla_jit_ops.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+using monitoring::testing::CellReader;
+
+constexpr char kDonatedBufferCount[] =
+    "/tensorflow/core/xla_donated_variable_buffer_count";
+
+// Returns a function that adds one to the float variable `v`.
+FunctionDef AddOneToVariable() {
+  return FunctionDefHelper::Define(
+      "AddOneToVariable", {"v:resource"}, {}, {},
+      {{{"value"}, "ReadVariableOp", {"v"}, {{"dtype", DT_FLOAT}}},
+       FunctionDefHelper::Const("one", 1.0f),
+       {{"sum"}, "Add", {"value", "one"}, {{"T", DT_FLOAT}}},
+       {{"assign"},
+        "AssignVariableOp",
+        {"v", "sum"},
+        {{"dtype", DT_FLOAT}}}});
+}
+
+// Runs AddOneToVariable on a variable through _XlaCompile and _XlaRun, with
+// --tf_xla_donate_variable_snapshots set for the duration of the test.
+class XlaRunDonationTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    flags_ = GetXlaOpsCommonFlags();
+    saved_donate_variable_snapshots_ = flags_->tf_xla_donate_variable_snapshots;
+    flags_->tf_xla_donate_variable_snapshots = GetParam();
+  }
+
+  void TearDown() override {
+    flags_->tf_xla_donate_variable_snapshots = saved_donate_variable_snapshots_;
+  }
+
+  // Creates a session whose graph has a float variable `v` set by `init` to
+  // `init_value`, an `xla_run` that adds one to `v`, and `read` to read `v`.
+  // If `reassign`, `v` is set to `new_value` after _XlaCompile has taken its
+  // snapshot and before `xla_run` runs.
+  void CreateSession(bool reassign) {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    auto v = ops::VarHandleOp(root.WithOpName("v"), DT_FLOAT, TensorShape({4}));
+    auto init_value = ops::Placeholder(root.WithOpName("init_value"), DT_FLOAT);
+    ops::AssignVariableOp(root.WithOpName("init"), v, init_value);
+
+    NameAttrList function;
+    function.set_name("AddOneToVariable");
+    ops::_XlaCompile xla_compile(root.WithOpName("xla_compile"),
+                                 /*constants=*/OutputList(),
+                                 /*args=*/OutputList(),
+                                 /*resources=*/OutputList({v}),
+                                 /*must_compile=*/true, function);
+    xla_compile.operation.node()->AddAttr(kXlaHasReferenceVarsAttr, false);
+
+    Scope xla_run_scope = root;
+    if (reassign) {
+      auto new_value = ops::Placeholder(root.WithOpName("new_value"), DT_FLOAT);
+      auto reassign_op = ops::AssignVariableOp(
+          root.WithOpName("reassign").WithControlDependencies(xla_compile.key),
+          v, new_value);
+      xla_run_scope = root.WithControlDependencies({reassign_op.operation});
+    }
+    ops::_XlaRun(xla_run_scope.WithOpName("xla_run"), OutputList({v}),
+                 xla_compile.key, DataTypeVector());
+    ops::ReadVariableOp(root.WithOpName("read"), v, DT_FLOAT);
+
+    FunctionDefLibrary library;
+    *library.add_function() = AddOneToVariable();
+    TF_ASSERT_OK(root.graph()->AddFunctionLibrary(library));
+    GraphDef graph;
+    TF_ASSERT_OK(root.ToGraphDef(&graph));
+
+    session_.reset(NewSession(SessionOptions()));
+    TF_ASSERT_OK(session_->Create(graph));
+  }
+
+  // The feeds are only referenced while running, so that the variables hold
+  // the only references to their buffers once assigned.
+  Status Run(std::vector<std::pair<std::string, Tensor>> feeds,
+             const std::string& target) {
+    return session_->Run(feeds, {}, {target}, nullptr);
+  }
+
+  Tensor Read() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session_->Run({}, {"read"}, {}, &outputs));
+    return outputs[0];
+  }
+
+  std::unique_ptr<Session> session_;
+
+ private:
+  XlaOpsCommonFlags* flags_;
+  bool saved_donate_variable_snapshots_;
+};
+
+TEST_P(XlaRunDonationTest, UpdatesVariable) {
+  const bool donate_variable_snapshots = GetParam();
+  CellReader<int64_t> donated_buffers(kDonatedBufferCount);
+  CreateSession(/*reassign=*/false);
+  TF_ASSERT_OK(Run({{"init_value", test::AsTensor<float>({1, 2, 3, 4})}},
+                   "init"));
+
+  TF_ASSERT_OK(Run({}, "xla_run"));
+  TF_ASSERT_OK(Run({}, "xla_run"));
+  // The variable is not read in between, so that it is the only reference to
+  // its buffer when the second step runs.
+  EXPECT_EQ(donated_buffers.Delta(), donate_variable_snapshots ? 2 : 0);
+  test::ExpectTensorEqual<float>(Read(), test::AsTensor<float>({3, 4, 5, 6}));
+}
+
+TEST_P(XlaRunDonationTest, DoesNotDonateVariableReassignedAfterCompile) {
+  CellReader<int64_t> donated_buffers(kDonatedBufferCount);
+  CreateSession(/*reassign=*/true);
+  TF_ASSERT_OK(Run({{"init_value", test::AsTensor<float>({1, 2, 3, 4})}},
+                   "init"));
+
+  TF_ASSERT_OK(Run({{"new_value", test::AsTensor<float>({10, 20, 30, 40})}},
+                   "xla_run"));
+  EXPECT_EQ(donated_buffers.Delta(), 0);
+  // _XlaRun reads the snapshot taken by _XlaCompile, not the new value.
+  test::ExpectTensorEqual<float>(Read(), test::AsTensor<float>({2, 3, 4, 5}));
+}
+
+INSTANTIATE_TEST_SUITE_P(DonateVariableSnapshots, XlaRunDonationTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/clustering_profile.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -123,6 +124,10 @@ class MarkForCompilationPassImpl {
     std::atomic<int64_t>* fuel;
 
     bool dump_graphs;
+
+    // If not null, the measured costs used to veto clusters, in which the
+    // clusters that are formed are recorded.
+    ClusteringProfile* clustering_profile = nullptr;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -303,7 +308,8 @@ class MarkForCompilationPassImpl {
   // constants (or large broadcasts of constants) can increase the live range
   // of those constants, and increase overall memory usage.
   //
-  // This function removes "obviously bad" cases like these.
+  // This function removes "obviously bad" cases like these, as well as the
+  // clusters that the clustering profile measured to run slower under XLA.
   Status DeclusterNodes();
 
   // Manifests the clustering decisions into the TF graph by tagging nodes with
@@ -925,6 +931,26 @@ Status MarkForCompilationPassImpl::DeclusterNodes() {
     }
   }
 
+  ClusteringProfile* profile = debug_options_.clustering_profile;
+  if (profile == nullptr) return absl::OkStatus();
+  absl::flat_hash_map<Cluster*, std::vector<Node*>> cluster_nodes;
+  for (Node* n : compilation_candidates_) {
+    Cluster* cluster = GetClusterForNode(n);
+    if (cluster != nullptr && !declustered_nodes_.contains(n)) {
+      cluster_nodes[cluster].push_back(n);
+    }
+  }
+  for (const auto& [cluster, nodes] : cluster_nodes) {
+    std::vector<string> names;
+    names.reserve(nodes.size());
+    for (Node* n : nodes) names.push_back(n->name());
+    if (!profile->ShouldVeto(std::move(names))) continue;
+    VLOG(2) << "Declustering " << nodes.size()
+            << " nodes measured to run slower under XLA, starting with "
+            << nodes.front()->name();
+    declustered_nodes_.insert(nodes.begin(), nodes.end());
+  }
+
   return absl::OkStatus();
 }
 
@@ -965,6 +991,8 @@ Status MarkForCompilationPassImpl::CreateClusters() {
 
   // Names for each cluster.
   std::unordered_map<int, string> cluster_names;
+  // The nodes of each cluster, by name, to record in the clustering profile.
+  std::map<string, std::vector<string>> cluster_nodes;
 
   if (debug_options_.dump_graphs) {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
@@ -1010,9 +1038,16 @@ Status MarkForCompilationPassImpl::CreateClusters() {
       n->AddAttr(kXlaClusterAttr, name);
       n->AddAttr(kXlaAlreadyClustered, true);
       VLOG(3) << "Assigning node " << n->name() << " to cluster " << name;
+      if (debug_options_.clustering_profile != nullptr) {
+        cluster_nodes[name].push_back(n->name());
+      }
     }
   }
 
+  for (auto& [name, nodes] : cluster_nodes) {
+    debug_options_.clustering_profile->SetClusterNodes(name, std::move(nodes));
+  }
+
   return absl::OkStatus();
 }
 
@@ -1896,6 +1931,25 @@ Status MarkForCompilation(
       .Run();
 }
 
+// Runs MarkForCompilation with the clustering profile at `profile_path`, which
+// may not exist yet, and saves the clusters that are formed to it.
+Status MarkForCompilationWithProfile(
+    const GraphOptimizationPassOptions& options,
+    MarkForCompilationPassImpl::DebugOptions debug_options,
+    const string& profile_path) {
+  // Serializes the updates of the profile by concurrent graphs.
+  static mutex* mu = new mutex;
+  mutex_lock lock(*mu);
+  Env* env = options.session_options != nullptr ? options.session_options->env
+                                                : Env::Default();
+  ClusteringProfile profile;
+  Status s = ClusteringProfile::Load(env, profile_path, &profile);
+  if (!s.ok() && !errors::IsNotFound(s)) return s;
+  debug_options.clustering_profile = &profile;
+  TF_RETURN_IF_ERROR(MarkForCompilation(options, debug_options));
+  return profile.Save(env, profile_path);
+}
+
 std::atomic<int64_t>* GetPointerToFuel(int64_t initial_value) {
   static std::atomic<int64_t>* fuel = [&]() {
     std::atomic<int64_t>* fuel = new std::atomic<int64_t>;
@@ -1925,7 +1979,11 @@ Status MarkForCompilationPass::Run(
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
-  return MarkForCompilation(options, debug_options);
+  if (flags->tf_xla_clustering_profile.empty()) {
+    return MarkForCompilation(options, debug_options);
+  }
+  return MarkForCompilationWithProfile(options, debug_options,
+                                       flags->tf_xla_clustering_profile);
 }
 
 Status MarkForCompilationPass::RunForTest(
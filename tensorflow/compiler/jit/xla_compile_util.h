@@ -23,9 +23,6 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 
 namespace tensorflow {
-// The number of compiler threads to use for asynchronous device compilation.
-inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
-
 enum class DeviceCompileMode {
   kLazy,
   kStrict,
@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_serving_device_selector.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -152,7 +153,8 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    absl::Span<const Tensor* const> inputs) {
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -175,9 +177,14 @@ XlaComputationLaunchContext::PopulateInputs(
                                 update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_var_it->second
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+    const Tensor* t;
+    if (is_resource_variable) {
+      t = resource_var_it->second;
+    } else if (!inputs.empty()) {
+      t = inputs[arg_num - missing_ctx_input_prefix];
+    } else {
+      t = &(ctx->input(arg_num - missing_ctx_input_prefix));
+    }
     CHECK(t);
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
@@ -186,6 +193,7 @@ XlaComputationLaunchContext::PopulateInputs(
             << "; is_resource_variable=" << is_resource_variable
             << "; is_updated_resource_variable=" << is_updated_resource_variable
             << "; donate_buffer=" << donate_buffer;
+    if (donate_buffer) metrics::UpdateXlaDonatedVariableBufferCount();
 
     if (use_multiple_streams_) {
       CHECK(ctx->op_device_context() && ctx->op_device_context()->stream())
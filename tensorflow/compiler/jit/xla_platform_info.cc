@@ -78,6 +78,10 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.persistent_cache_max_bytes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_max_size_bytes;
+  persistor_config.persist_asynchronously =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_async_writes;
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -225,6 +229,10 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.persistent_cache_max_bytes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_max_size_bytes;
+  persistor_config.persist_asynchronously =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_async_writes;
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
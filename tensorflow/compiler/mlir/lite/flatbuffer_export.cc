@@ -517,6 +517,34 @@ static std::optional<TfLitePoolParams> GetTflitePoolParams(Operation* inst,
   return std::nullopt;
 }
 
+// Returns the data of `attr` if it is stored in the layout of a TFLite buffer,
+// so that it can be exported without first converting it to a tensor.
+static std::optional<absl::string_view> GetRawBufferData(ElementsAttr attr) {
+  auto dense_attr = mlir::dyn_cast<mlir::DenseIntOrFPElementsAttr>(attr);
+  // Splats only store one element.
+  if (!dense_attr || dense_attr.isSplat()) return std::nullopt;
+  Type element_type = dense_attr.getElementType();
+  bool is_byte_int = false;
+  if (auto int_type = mlir::dyn_cast<mlir::IntegerType>(element_type)) {
+    const unsigned width = int_type.getWidth();
+    is_byte_int = width == 8 || width == 16 || width == 32 || width == 64;
+  }
+  if (!is_byte_int && !element_type.isF16() && !element_type.isBF16() &&
+      !element_type.isF32() && !element_type.isF64()) {
+    return std::nullopt;
+  }
+  llvm::ArrayRef<char> data = dense_attr.getRawData();
+  return absl::string_view(data.data(), data.size());
+}
+
+// Returns a cord of the data of `buffer`, which it takes ownership of.
+static absl::Cord CordFromBuffer(std::vector<uint8_t> buffer) {
+  absl::string_view data(reinterpret_cast<const char*>(buffer.data()),
+                         buffer.size());
+  // Moving the vector into the releaser keeps its data in place.
+  return absl::MakeCordFromExternal(data, [buffer = std::move(buffer)] {});
+}
+
 namespace {
 
 using ::mlir::tf_saved_model::kTfSavedModelExportedNamesAttr;
@@ -602,6 +630,12 @@ class Translator {
   std::optional<BufferOffset<tflite::Buffer>> BuildBuffer(
       Value value, bool can_be_deduplicated, int& index);
 
+  // Returns a TFLite buffer of `data`, which is either stored in the
+  // flatbuffer or, when buffer offsets are used, appended after it without
+  // being copied until then.
+  std::optional<BufferOffset<tflite::Buffer>> BuildBufferFromData(
+      absl::Cord data, int index);
+
   // Build TFLite tensor from the given type. This function is for tfl.lstm
   // intermediates, which should have UniformQuantizedType.
   std::optional<BufferOffset<tflite::Tensor>> BuildTensorFromType(
@@ -828,7 +862,7 @@ class Translator {
   // Maps buffer data to corresponding buffer index
   // in the idx map, the value is a pair of offset and size
   absl::flat_hash_map<int, std::pair<uint64_t, uint64_t>> buffer_idx_map_;
-  absl::flat_hash_map<int, std::string> buffer_data_map_;
+  absl::flat_hash_map<int, absl::Cord> buffer_data_map_;
   bool buffer_data_exported_ = false;
 
   // Maps custom options data to corresponding node
@@ -966,20 +1000,15 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     for (mlir::APInt v : attr.getValues<mlir::APInt>()) {
       data.emplace_back(static_cast<uint8_t>(*(v.getRawData())));
     }
-    auto packed_buffer = tflite::PackInt4ValuesDensely(data);
-    if (use_buffer_offset_) {
-      buffer_data_map_[index] =
-          std::string(packed_buffer.begin(), packed_buffer.end());
-      return tflite::CreateBuffer(builder_, 0, 1, 1);
-    } else {
-      if (IsModelBiggerThan2GB(packed_buffer.size())) {
-        require_use_buffer_offset_ = true;
-        return empty_buffer_;
-      }
-      auto buffer_data =
-          builder_.CreateVector(packed_buffer.data(), packed_buffer.size());
-      return tflite::CreateBuffer(builder_, buffer_data);
-    }
+    return BuildBufferFromData(
+        CordFromBuffer(tflite::PackInt4ValuesDensely(data)), index);
+  }
+
+  // Constant attributes outlive the translation, so their data is used in
+  // place.
+  if (std::optional<absl::string_view> raw_data = GetRawBufferData(attr)) {
+    return BuildBufferFromData(absl::MakeCordFromExternal(*raw_data, [] {}),
+                               index);
   }
 
   tensorflow::Tensor tensor;
@@ -1002,38 +1031,31 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
     char* tensor_buffer;
     int bytes = dynamic_buffer.WriteToBuffer(&tensor_buffer);
-    if (use_buffer_offset_) {
-      std::vector<uint8_t> buffer_data(tensor_buffer, tensor_buffer + bytes);
-      free(tensor_buffer);
-      buffer_data_map_[index] =
-          std::string(buffer_data.begin(), buffer_data.end());
-      return tflite::CreateBuffer(builder_, 0, 1, 1);
-    } else {
-      if (IsModelBiggerThan2GB(bytes)) {
-        require_use_buffer_offset_ = true;
-        return empty_buffer_;
-      }
-      auto buffer_data = builder_.CreateVector(
-          reinterpret_cast<uint8_t*>(tensor_buffer), bytes);
-      free(tensor_buffer);
-      return tflite::CreateBuffer(builder_, buffer_data);
-    }
+    return BuildBufferFromData(
+        absl::MakeCordFromExternal(absl::string_view(tensor_buffer, bytes),
+                                   [tensor_buffer] { free(tensor_buffer); }),
+        index);
   }
 
-  absl::string_view tensor_data = tensor.tensor_data();
+  // The cord keeps the tensor, and thus its data, alive.
+  return BuildBufferFromData(
+      absl::MakeCordFromExternal(tensor.tensor_data(), [tensor] {}), index);
+}
+
+std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBufferFromData(
+    absl::Cord data, int index) {
   if (use_buffer_offset_) {
-    buffer_data_map_[index] = std::string(tensor_data);
+    buffer_data_map_[index] = std::move(data);
     return tflite::CreateBuffer(builder_, 0, 1, 1);
-  } else {
-    if (IsModelBiggerThan2GB(tensor_data.size())) {
-      require_use_buffer_offset_ = true;
-      return empty_buffer_;
-    }
-    auto buffer_data = builder_.CreateVector(
-        reinterpret_cast<const uint8_t*>(tensor_data.data()),
-        tensor_data.size());
-    return tflite::CreateBuffer(builder_, buffer_data);
   }
+  if (IsModelBiggerThan2GB(data.size())) {
+    require_use_buffer_offset_ = true;
+    return empty_buffer_;
+  }
+  absl::string_view flat_data = data.Flatten();
+  auto buffer_data = builder_.CreateVector(
+      reinterpret_cast<const uint8_t*>(flat_data.data()), flat_data.size());
+  return tflite::CreateBuffer(builder_, buffer_data);
 }
 
 int32_t Translator::UnnamedRegionToSubgraph(
@@ -3587,14 +3609,15 @@ std::optional<std::string> Translator::TranslateInternal() {
     }
   }
 
-  absl::Cord result;
   auto fbs = absl::string_view(
       reinterpret_cast<const char*>(builder_.GetBufferPointer()),
       builder_.GetSize());
-  result.Append(fbs);
 
   // Return serialized string for the built FlatBuffer.
   if (use_buffer_offset_) {
+    // The buffer data is only copied once, when the result is flattened.
+    absl::Cord result;
+    result.Append(fbs);
     // Pad to be 16 bytes aligned
     {
       std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
@@ -3609,7 +3632,7 @@ std::optional<std::string> Translator::TranslateInternal() {
     }
     return result_str;
   }
-  return std::string(result);
+  return std::string(fbs);
 }
 
 void Translator::AppendBufferData(absl::Cord& result) {
@@ -3617,13 +3640,11 @@ void Translator::AppendBufferData(absl::Cord& result) {
   // Buffer data should be exported only once.
   assert(!buffer_data_exported_);
 
-  auto it = buffer_data_map_.begin();
-  while (it != buffer_data_map_.end()) {
-    std::string buffer = it->second;
-    int64_t index = it->first;
+  // The buffers are moved into the result, which only refers to their data.
+  for (auto& [index, buffer] : buffer_data_map_) {
     int64_t offset = result.size();
     int64_t size = buffer.size();
-    uint64_t hash = tsl::Fingerprint64(buffer);
+    uint64_t hash = tsl::Fingerprint64(buffer.Flatten());
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
       hashcode_to_pos[hash] = std::make_pair(offset, size);
       buffer_idx_map_[index] = std::make_pair(offset, size);
@@ -3637,10 +3658,9 @@ void Translator::AppendBufferData(absl::Cord& result) {
       // only update offset/index.
       buffer_idx_map_[index] = hashcode_to_pos[hash];
     }
-    buffer_data_map_.erase(it);
-    it = buffer_data_map_.begin();
     buffer_data_exported_ = true;
   }
+  buffer_data_map_.clear();
   // pad 16 bytes for the last buffer for XNNPack
   result.Append("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0");
   // pad to be 16 bytes aligned
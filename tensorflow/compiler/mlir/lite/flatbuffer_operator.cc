@@ -237,7 +237,9 @@ ConvertTFL_FullyConnectedOptionsWeightFormatAttrForOptionWriter(
   return llvm::StringSwitch<tflite::FullyConnectedOptionsWeightsFormat>(str)
       .Case("DEFAULT", tflite::FullyConnectedOptionsWeightsFormat_DEFAULT)
       .Case("SHUFFLED4x16INT8",
-            tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8);
+            tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8)
+      .Case("PACKED4x32INT4",
+            tflite::FullyConnectedOptionsWeightsFormat_PACKED4x32INT4);
 }
 
 static tflite::LSTMKernelType ConvertTFL_LSTMKernelTypeAttrForOptionWriter(
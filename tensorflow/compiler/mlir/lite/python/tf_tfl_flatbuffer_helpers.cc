@@ -324,6 +324,7 @@ absl::Status PopulateQuantizationSpecs(
       toco_flags.enable_mlir_variable_quantization();
   quant_specs->disable_per_channel_for_dense_layers =
       toco_flags.disable_per_channel_quantization_for_dense_layers();
+  quant_specs->int4_weight_block_size = toco_flags.int4_weight_block_size();
   return absl::OkStatus();
 }
 
@@ -0,0 +1,32 @@
+// RUN: tf-opt %s -tfl-blockwise-quantize-weights="block-size=32 min-elements=256" | FileCheck %s
+
+// CHECK-LABEL: QuantizesPerBlock
+func.func @QuantizesPerBlock(%arg0: tensor<1x64xf32>) -> tensor<1x4xf32> {
+  %w = arith.constant dense<0.7> : tensor<4x64xf32>
+  %b = "tfl.no_value"() {value} : () -> none
+  %0 = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x64xf32>, tensor<4x64xf32>, none) -> tensor<1x4xf32>
+  func.return %0 : tensor<1x4xf32>
+
+// CHECK: %[[W:.*]] = "tfl.pseudo_qconst"() {qtype = tensor<4x64x!quant.uniform<i4<-7:7>:f32:0, {{.*}}>>, value = dense<7> : tensor<4x64xi4>}
+// CHECK: "tfl.fully_connected"(%arg0, %[[W]], %{{.*}})
+}
+
+// CHECK-LABEL: KeepsUnalignedBlocks
+func.func @KeepsUnalignedBlocks(%arg0: tensor<1x80xf32>) -> tensor<1x4xf32> {
+  %w = arith.constant dense<0.7> : tensor<4x80xf32>
+  %b = "tfl.no_value"() {value} : () -> none
+  %0 = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x80xf32>, tensor<4x80xf32>, none) -> tensor<1x4xf32>
+  func.return %0 : tensor<1x4xf32>
+
+// CHECK-NOT: tfl.pseudo_qconst
+}
+
+// CHECK-LABEL: KeepsSmallWeights
+func.func @KeepsSmallWeights(%arg0: tensor<1x32xf32>) -> tensor<1x4xf32> {
+  %w = arith.constant dense<0.7> : tensor<4x32xf32>
+  %b = "tfl.no_value"() {value} : () -> none
+  %0 = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x32xf32>, tensor<4x32xf32>, none) -> tensor<1x4xf32>
+  func.return %0 : tensor<1x4xf32>
+
+// CHECK-NOT: tfl.pseudo_qconst
+}
@@ -0,0 +1,85 @@
+// RUN: tf-opt %s -tfl-fuse-transformer-ops | FileCheck %s
+
+// CHECK-LABEL: LayerNorm
+func.func @LayerNorm(%arg0: tensor<2x8x16xf32>, %arg1: tensor<16xf32>, %arg2: tensor<16xf32>) -> tensor<2x8x16xf32> {
+  %axis = arith.constant dense<-1> : tensor<1xi32>
+  %eps = arith.constant dense<1.0e-05> : tensor<f32>
+  %0 = "tfl.mean"(%arg0, %axis) {keep_dims = true} : (tensor<2x8x16xf32>, tensor<1xi32>) -> tensor<2x8x1xf32>
+  %1 = tfl.sub(%arg0, %0) {fused_activation_function = "NONE"} : (tensor<2x8x16xf32>, tensor<2x8x1xf32>) -> tensor<2x8x16xf32>
+  %2 = "tfl.squared_difference"(%arg0, %0) : (tensor<2x8x16xf32>, tensor<2x8x1xf32>) -> tensor<2x8x16xf32>
+  %3 = "tfl.mean"(%2, %axis) {keep_dims = true} : (tensor<2x8x16xf32>, tensor<1xi32>) -> tensor<2x8x1xf32>
+  %4 = tfl.add(%3, %eps) {fused_activation_function = "NONE"} : (tensor<2x8x1xf32>, tensor<f32>) -> tensor<2x8x1xf32>
+  %5 = "tfl.rsqrt"(%4) : (tensor<2x8x1xf32>) -> tensor<2x8x1xf32>
+  %6 = tfl.mul(%1, %5) {fused_activation_function = "NONE"} : (tensor<2x8x16xf32>, tensor<2x8x1xf32>) -> tensor<2x8x16xf32>
+  %7 = tfl.mul(%6, %arg1) {fused_activation_function = "NONE"} : (tensor<2x8x16xf32>, tensor<16xf32>) -> tensor<2x8x16xf32>
+  %8 = tfl.add(%7, %arg2) {fused_activation_function = "NONE"} : (tensor<2x8x16xf32>, tensor<16xf32>) -> tensor<2x8x16xf32>
+  func.return %8 : tensor<2x8x16xf32>
+
+// CHECK: %[[LN:.*]] = "tfl.custom"(%arg0, %arg1, %arg2) {custom_code = "odml.layer_norm", custom_option = #tfl<const_bytes : "{{.*}}">} : (tensor<2x8x16xf32>, tensor<16xf32>, tensor<16xf32>) -> tensor<2x8x16xf32>
+// CHECK: return %[[LN]]
+}
+
+// CHECK-LABEL: LayerNormWithoutScaleAndOffset
+func.func @LayerNormWithoutScaleAndOffset(%arg0: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %axis = arith.constant dense<1> : tensor<1xi32>
+  %eps = arith.constant dense<1.0e-03> : tensor<f32>
+  %0 = "tfl.mean"(%arg0, %axis) {keep_dims = true} : (tensor<4x16xf32>, tensor<1xi32>) -> tensor<4x1xf32>
+  %1 = tfl.sub(%arg0, %0) {fused_activation_function = "NONE"} : (tensor<4x16xf32>, tensor<4x1xf32>) -> tensor<4x16xf32>
+  %2 = tfl.mul(%1, %1) {fused_activation_function = "NONE"} : (tensor<4x16xf32>, tensor<4x16xf32>) -> tensor<4x16xf32>
+  %3 = "tfl.mean"(%2, %axis) {keep_dims = true} : (tensor<4x16xf32>, tensor<1xi32>) -> tensor<4x1xf32>
+  %4 = tfl.add(%3, %eps) {fused_activation_function = "NONE"} : (tensor<4x1xf32>, tensor<f32>) -> tensor<4x1xf32>
+  %5 = "tfl.sqrt"(%4) : (tensor<4x1xf32>) -> tensor<4x1xf32>
+  %6 = tfl.div(%1, %5) {fused_activation_function = "NONE"} : (tensor<4x16xf32>, tensor<4x1xf32>) -> tensor<4x16xf32>
+  func.return %6 : tensor<4x16xf32>
+
+// CHECK-DAG: %[[ONES:.*]] = arith.constant dense<1.000000e+00> : tensor<16xf32>
+// CHECK-DAG: %[[ZEROS:.*]] = arith.constant dense<0.000000e+00> : tensor<16xf32>
+// CHECK: "tfl.custom"(%arg0, %[[ONES]], %[[ZEROS]]) {custom_code = "odml.layer_norm"
+}
+
+// CHECK-LABEL: NotLayerNormOverOtherDim
+func.func @NotLayerNormOverOtherDim(%arg0: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %axis = arith.constant dense<0> : tensor<1xi32>
+  %eps = arith.constant dense<1.0e-03> : tensor<f32>
+  %0 = "tfl.mean"(%arg0, %axis) {keep_dims = true} : (tensor<4x16xf32>, tensor<1xi32>) -> tensor<1x16xf32>
+  %1 = tfl.sub(%arg0, %0) {fused_activation_function = "NONE"} : (tensor<4x16xf32>, tensor<1x16xf32>) -> tensor<4x16xf32>
+  %2 = "tfl.squared_difference"(%arg0, %0) : (tensor<4x16xf32>, tensor<1x16xf32>) -> tensor<4x16xf32>
+  %3 = "tfl.mean"(%2, %axis) {keep_dims = true} : (tensor<4x16xf32>, tensor<1xi32>) -> tensor<1x16xf32>
+  %4 = tfl.add(%3, %eps) {fused_activation_function = "NONE"} : (tensor<1x16xf32>, tensor<f32>) -> tensor<1x16xf32>
+  %5 = "tfl.rsqrt"(%4) : (tensor<1x16xf32>) -> tensor<1x16xf32>
+  %6 = tfl.mul(%1, %5) {fused_activation_function = "NONE"} : (tensor<4x16xf32>, tensor<1x16xf32>) -> tensor<4x16xf32>
+  func.return %6 : tensor<4x16xf32>
+
+// CHECK-NOT: tfl.custom
+}
+
+// CHECK-LABEL: Attention
+func.func @Attention(%arg0: tensor<1x8x2x16xf32>, %arg1: tensor<1x8x2x16xf32>, %arg2: tensor<1x8x2x16xf32>, %arg3: tensor<1x1x8x8xf32>) -> tensor<1x8x2x16xf32> {
+  %perm = arith.constant dense<[0, 2, 1, 3]> : tensor<4xi32>
+  %scale = arith.constant dense<2.500000e-01> : tensor<f32>
+  %q = "tfl.transpose"(%arg0, %perm) : (tensor<1x8x2x16xf32>, tensor<4xi32>) -> tensor<1x2x8x16xf32>
+  %k = "tfl.transpose"(%arg1, %perm) : (tensor<1x8x2x16xf32>, tensor<4xi32>) -> tensor<1x2x8x16xf32>
+  %v = "tfl.transpose"(%arg2, %perm) : (tensor<1x8x2x16xf32>, tensor<4xi32>) -> tensor<1x2x8x16xf32>
+  %0 = "tfl.batch_matmul"(%q, %k) {adj_x = false, adj_y = true} : (tensor<1x2x8x16xf32>, tensor<1x2x8x16xf32>) -> tensor<1x2x8x8xf32>
+  %1 = tfl.mul(%0, %scale) {fused_activation_function = "NONE"} : (tensor<1x2x8x8xf32>, tensor<f32>) -> tensor<1x2x8x8xf32>
+  %2 = tfl.add(%1, %arg3) {fused_activation_function = "NONE"} : (tensor<1x2x8x8xf32>, tensor<1x1x8x8xf32>) -> tensor<1x2x8x8xf32>
+  %3 = "tfl.softmax"(%2) {beta = 1.000000e+00 : f32} : (tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  %4 = "tfl.batch_matmul"(%3, %v) {adj_x = false, adj_y = false} : (tensor<1x2x8x8xf32>, tensor<1x2x8x16xf32>) -> tensor<1x2x8x16xf32>
+  %5 = "tfl.transpose"(%4, %perm) : (tensor<1x2x8x16xf32>, tensor<4xi32>) -> tensor<1x8x2x16xf32>
+  func.return %5 : tensor<1x8x2x16xf32>
+
+// CHECK: %[[ATTENTION:.*]] = "tfl.custom"(%arg0, %arg1, %arg2, %arg3) {custom_code = "odml.scaled_dot_product_attention", custom_option = #tfl<const_bytes : "{{.*}}">} : (tensor<1x8x2x16xf32>, tensor<1x8x2x16xf32>, tensor<1x8x2x16xf32>, tensor<1x1x8x8xf32>) -> tensor<1x8x2x16xf32>
+// CHECK: %[[HEADS:.*]] = "tfl.transpose"(%[[ATTENTION]], %{{.*}}) : (tensor<1x8x2x16xf32>, tensor<4xi32>) -> tensor<1x2x8x16xf32>
+// CHECK: "tfl.transpose"(%[[HEADS]], %{{.*}}) : (tensor<1x2x8x16xf32>, tensor<4xi32>) -> tensor<1x8x2x16xf32>
+}
+
+// CHECK-LABEL: AttentionWithoutMask
+func.func @AttentionWithoutMask(%arg0: tensor<1x2x8x16xf32>, %arg1: tensor<1x2x8x16xf32>, %arg2: tensor<1x2x8x16xf32>) -> tensor<1x2x8x16xf32> {
+  %0 = "tfl.batch_matmul"(%arg0, %arg1) {adj_x = false, adj_y = true} : (tensor<1x2x8x16xf32>, tensor<1x2x8x16xf32>) -> tensor<1x2x8x8xf32>
+  %1 = "tfl.softmax"(%0) {beta = 1.000000e+00 : f32} : (tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  %2 = "tfl.batch_matmul"(%1, %arg2) {adj_x = false, adj_y = false} : (tensor<1x2x8x8xf32>, tensor<1x2x8x16xf32>) -> tensor<1x2x8x16xf32>
+  func.return %2 : tensor<1x2x8x16xf32>
+
+// CHECK: %[[MASK:.*]] = arith.constant dense<0.000000e+00> : tensor<1x1x1x1xf32>
+// CHECK: "tfl.custom"({{.*}}, %[[MASK]]) {custom_code = "odml.scaled_dot_product_attention"
+}
@@ -0,0 +1,24 @@
+// RUN: tf-opt %s -tfl-prepack-fully-connected-weights | FileCheck %s
+
+// CHECK-LABEL: PrepacksInt4Filter
+func.func @PrepacksInt4Filter(%arg0: tensor<1x32xf32>) -> tensor<1x4xf32> {
+  %w = "tfl.pseudo_qconst"() {qtype = tensor<4x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0,4.0}>>, value = dense<1> : tensor<4x32xi4>} : () -> tensor<4x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0,4.0}>>
+  %b = "tfl.no_value"() {value} : () -> none
+  %0 = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x32xf32>, tensor<4x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0,4.0}>>, none) -> tensor<1x4xf32>
+  func.return %0 : tensor<1x4xf32>
+
+// The packed values are offset by 7 and read back as signed INT4.
+// CHECK: %[[W:.*]] = "tfl.pseudo_qconst"() {qtype = tensor<4x32x!quant.uniform<i4:f32:0, {{.*}}>>, value = dense<-8> : tensor<4x32xi4>}
+// CHECK: "tfl.fully_connected"(%arg0, %[[W]], %{{.*}}) {{{.*}}weights_format = "PACKED4x32INT4"}
+}
+
+// CHECK-LABEL: KeepsUnalignedFilter
+func.func @KeepsUnalignedFilter(%arg0: tensor<1x32xf32>) -> tensor<1x3xf32> {
+  %w = "tfl.pseudo_qconst"() {qtype = tensor<3x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0}>>, value = dense<1> : tensor<3x32xi4>} : () -> tensor<3x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0}>>
+  %b = "tfl.no_value"() {value} : () -> none
+  %0 = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x32xf32>, tensor<3x32x!quant.uniform<i4:f32:0, {1.0,2.0,3.0}>>, none) -> tensor<1x3xf32>
+  func.return %0 : tensor<1x3xf32>
+
+// CHECK: value = dense<1> : tensor<3x32xi4>
+// CHECK: weights_format = "DEFAULT"
+}
@@ -466,6 +466,12 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
     pass_manager->addNestedPass<mlir::func::FuncOp>(
         mlir::TFL::CreateOptimizePass(/*enable_canonicalization=*/true,
                                       toco_flags.disable_fuse_mul_and_fc()));
+    // Runs after the optimize pass, which has fused GELU and folded the
+    // primitive ops into the forms the fusions match.
+    if (toco_flags.fuse_transformer_ops()) {
+      pass_manager->addNestedPass<mlir::func::FuncOp>(
+          mlir::TFL::CreateFuseTransformerOpsPass());
+    }
 
     // This pass operates on TensorFlow ops but is triggered after legalization
     // so that it can target constants introduced once TensorFlow Identity ops
@@ -479,6 +485,15 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
         mlir::createCanonicalizerPass());
     pass_manager->addNestedPass<mlir::func::FuncOp>(mlir::createCSEPass());
 
+    // Quantize the weights of the float fully connected ops to blockwise INT4
+    // before the quantization passes, which leave quantized constants as is.
+    if (pass_config.quant_specs.int4_weight_block_size > 0) {
+      pass_manager->addNestedPass<mlir::func::FuncOp>(
+          mlir::TFL::CreateBlockwiseQuantizeWeightsPass(
+              pass_config.quant_specs.int4_weight_block_size,
+              pass_config.quant_specs.minimum_elements_for_weights));
+    }
+
     // Run quantization after all the floating point model conversion is
     // completed. Add either full integer quantization or dynamic range
     // quantization passes based on quant_specs.
@@ -493,13 +508,20 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config, *pass_manager);
     }
-    pass_manager->addPass(mlir::createCanonicalizerPass());
+    // Canonicalizes the functions in parallel.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::createCanonicalizerPass());
 
     if (pass_config.reduce_type_precision ||
         toco_flags.reduce_type_precision()) {
       pass_manager->addPass(mlir::TFL::CreateReduceTypePrecisionPass());
     }
 
+    if (toco_flags.prepack_fully_connected_weights()) {
+      pass_manager->addNestedPass<mlir::func::FuncOp>(
+          mlir::TFL::CreatePrepackFullyConnectedWeightsPass());
+    }
+
     // This pass should be always at the end of the model
     // conversion (even after quantization). Some TFL ops like unidirectional
     // sequence lstm will have stateful operands and some optimization passes
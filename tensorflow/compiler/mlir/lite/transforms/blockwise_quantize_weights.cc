@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass quantizes the constant float filters of fully
+// connected ops to INT4 with a symmetric scale per block of `block_size`
+// consecutive values of each output unit. It needs no calibration data, and
+// the result runs on the hybrid 4 bit fully connected kernel of TFLite, which
+// reads the scales of filter `[num_units, depth]` as `[num_units, num_blocks]`
+// on quantized dimension 0.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/Dialect/Quant/QuantTypes.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/PatternMatch.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "mlir/Support/TypeID.h"  // from @llvm-project
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+//===----------------------------------------------------------------------===//
+// The BlockwiseQuantizeWeights Pass.
+//
+namespace mlir {
+namespace TFL {
+
+namespace {
+
+#define GEN_PASS_DEF_BLOCKWISEQUANTIZEWEIGHTSPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+// The range of the symmetric INT4 values.
+constexpr int64_t kInt4Max = 7;
+
+// The depth and width of the filter tiles of the 4 bit kernel, which the
+// blocks of a filter with more than one scale per unit must align with. See
+// lite/kernels/internal/optimized/fully_connected_4bit.h.
+constexpr int64_t kKernelFilterDepth = 32;
+constexpr int64_t kKernelFilterWidth = 4;
+
+class QuantizeFullyConnectedFilter
+    : public OpRewritePattern<TFL::FullyConnectedOp> {
+ public:
+  QuantizeFullyConnectedFilter(MLIRContext *context, int64_t block_size,
+                               int64_t min_elements)
+      : OpRewritePattern<TFL::FullyConnectedOp>(context),
+        block_size_(block_size),
+        min_elements_(min_elements) {}
+
+  LogicalResult matchAndRewrite(TFL::FullyConnectedOp op,
+                                PatternRewriter &rewriter) const override {
+    auto input_type = mlir::dyn_cast<ShapedType>(op.getInput().getType());
+    if (!input_type || !input_type.getElementType().isF32()) {
+      return failure();
+    }
+
+    DenseFPElementsAttr filter;
+    if (!matchPattern(op.getFilter(), m_Constant(&filter))) {
+      return failure();
+    }
+    auto filter_type = mlir::cast<ShapedType>(filter.getType());
+    if (!filter_type.getElementType().isF32() ||
+        filter_type.getRank() != 2 ||
+        filter_type.getNumElements() < min_elements_) {
+      return failure();
+    }
+
+    const int64_t num_units = filter_type.getDimSize(0);
+    const int64_t depth = filter_type.getDimSize(1);
+    const int64_t block_size = std::min(block_size_, depth);
+    if (block_size <= 0 || depth % block_size != 0) {
+      return failure();
+    }
+    const int64_t num_blocks = depth / block_size;
+    if (num_blocks > 1 && (block_size % kKernelFilterDepth != 0 ||
+                           num_units < kKernelFilterWidth)) {
+      return failure();
+    }
+
+    const auto values = llvm::to_vector(filter.getValues<float>());
+    SmallVector<double> scales(num_units * num_blocks);
+    SmallVector<llvm::APInt> quantized_values;
+    quantized_values.reserve(values.size());
+    for (int64_t block = 0; block < num_units * num_blocks; ++block) {
+      const float *block_values = values.data() + block * block_size;
+      float max_abs = 0.0f;
+      for (int64_t i = 0; i < block_size; ++i) {
+        max_abs = std::max(max_abs, std::abs(block_values[i]));
+      }
+      const double scale = max_abs > 0.0f ? max_abs / kInt4Max : 1.0;
+      scales[block] = scale;
+      for (int64_t i = 0; i < block_size; ++i) {
+        const int64_t quantized = std::clamp<int64_t>(
+            std::round(block_values[i] / scale), -kInt4Max, kInt4Max);
+        quantized_values.emplace_back(/*numBits=*/4, quantized,
+                                      /*isSigned=*/true);
+      }
+    }
+
+    Builder builder(op.getContext());
+    const SmallVector<int64_t> zero_points(scales.size(), 0);
+    auto quantized_type = quant::UniformQuantizedPerAxisType::get(
+        quant::QuantizationFlags::Signed, builder.getI4Type(),
+        builder.getF32Type(), scales, zero_points,
+        /*quantizedDimension=*/0, -kInt4Max, kInt4Max);
+    auto storage_type =
+        RankedTensorType::get(filter_type.getShape(), builder.getI4Type());
+    auto qconst = rewriter.create<TFL::QConstOp>(
+        op.getFilter().getLoc(),
+        TypeAttr::get(
+            RankedTensorType::get(filter_type.getShape(), quantized_type)),
+        DenseElementsAttr::get(storage_type, quantized_values));
+    rewriter.modifyOpInPlace(op, [&] { op.setOperand(1, qconst); });
+    return success();
+  }
+
+ private:
+  const int64_t block_size_;
+  const int64_t min_elements_;
+};
+
+class BlockwiseQuantizeWeightsPass
+    : public impl::BlockwiseQuantizeWeightsPassBase<
+          BlockwiseQuantizeWeightsPass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(BlockwiseQuantizeWeightsPass)
+
+  BlockwiseQuantizeWeightsPass() = default;
+  BlockwiseQuantizeWeightsPass(int64_t block_size, int64_t min_elements) {
+    block_size_ = block_size;
+    min_elements_ = min_elements;
+  }
+
+  void runOnOperation() override;
+};
+
+void BlockwiseQuantizeWeightsPass::runOnOperation() {
+  RewritePatternSet patterns(&getContext());
+  patterns.add<QuantizeFullyConnectedFilter>(&getContext(), block_size_,
+                                             min_elements_);
+  (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateBlockwiseQuantizeWeightsPass(
+    int64_t block_size, int64_t min_elements) {
+  return std::make_unique<BlockwiseQuantizeWeightsPass>(block_size,
+                                                        min_elements);
+}
+
+}  // namespace TFL
+}  // namespace mlir
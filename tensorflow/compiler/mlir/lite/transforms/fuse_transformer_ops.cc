@@ -0,0 +1,433 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass fuses the primitive ops that layer normalization
+// and scaled dot product attention of transformer models legalize to into the
+// `odml.layer_norm` and `odml.scaled_dot_product_attention` custom ops, which
+// the GenAI ops of TFLite (lite/experimental/genai) run in a single pass over
+// their activations. The so converted models need the GenAI ops registered.
+//
+// Layer normalization is matched as
+//   %mean = mean(%x, -1)
+//   %centered = sub(%x, %mean)
+//   %variance = mean(squared_difference(%x, %mean), -1)
+//   %normalized = mul(%centered, rsqrt(add(%variance, epsilon)))
+//   %y = add(mul(%normalized, %gamma), %beta)
+// where the variance may be computed from %centered, the mul by rsqrt may be
+// a div by sqrt, and both the scale and offset are optional.
+//
+// Attention over (B, N, T, H) heads is matched as
+//   %scores = mul(batch_matmul(%q, %k, adj_y = true), scale)
+//   %y = batch_matmul(softmax(add(%scores, %mask)), %v)
+// where the scale may be applied to %q instead, and both the scale and the
+// mask are optional.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"  // from @llvm-project
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/PatternMatch.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "mlir/Support/TypeID.h"  // from @llvm-project
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+//===----------------------------------------------------------------------===//
+// The FuseTransformerOps Pass.
+//
+namespace mlir {
+namespace TFL {
+
+namespace {
+
+#define GEN_PASS_DEF_FUSETRANSFORMEROPSPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+constexpr char kLayerNormCustomCode[] = "odml.layer_norm";
+constexpr char kAttentionCustomCode[] = "odml.scaled_dot_product_attention";
+
+// Permutation between the (B, N, T, H) heads of the matched attention and
+// the (B, T, N, H) heads of the custom op, which is its own inverse.
+constexpr int32_t kHeadsPermutation[] = {0, 2, 1, 3};
+
+ConstBytesAttr CustomOption(OpBuilder* builder, llvm::StringRef key,
+                            float value) {
+  flexbuffers::Builder fbb;
+  const size_t map_start = fbb.StartMap();
+  fbb.Float(key.data(), value);
+  fbb.EndMap(map_start);
+  fbb.Finish();
+  const std::vector<uint8_t>& buffer = fbb.GetBuffer();
+  return ConstBytesAttr::get(
+      builder->getContext(),
+      StringRef(reinterpret_cast<const char*>(buffer.data()), buffer.size()));
+}
+
+// Returns true if `value` is a float constant with a single value.
+bool MatchSplatConstant(Value value, float* splat) {
+  DenseFPElementsAttr attr;
+  if (!matchPattern(value, m_Constant(&attr)) || !attr.isSplat()) {
+    return false;
+  }
+  *splat = attr.getSplatValue<APFloat>().convertToFloat();
+  return true;
+}
+
+// Returns the operand of binary `op` other than `value`, or null if `value`
+// is not an operand of `op`.
+Value OtherOperand(Operation* op, Value value) {
+  if (op->getOperand(0) == value) return op->getOperand(1);
+  if (op->getOperand(1) == value) return op->getOperand(0);
+  return nullptr;
+}
+
+// Returns the single user of `value` if it is a `OpTy` without a fused
+// activation function, or null otherwise.
+template <typename OpTy>
+OpTy GetSingleUser(Value value) {
+  if (!value.hasOneUse()) return nullptr;
+  auto op = llvm::dyn_cast<OpTy>(*value.getUsers().begin());
+  if (!op || op.getFusedActivationFunction() != "NONE") return nullptr;
+  return op;
+}
+
+// Returns true if `value` is the mean of `input` over its last dimension.
+bool IsMeanOverLastDim(Value value, Value input) {
+  auto mean = value.getDefiningOp<TFL::MeanOp>();
+  if (!mean || mean.getInput() != input || !mean.getKeepDims()) return false;
+  auto input_type = mlir::dyn_cast<RankedTensorType>(input.getType());
+  DenseIntElementsAttr axis;
+  if (!input_type || !matchPattern(mean.getAxis(), m_Constant(&axis)) ||
+      axis.getNumElements() != 1) {
+    return false;
+  }
+  const int64_t dim = (*axis.getValues<APInt>().begin()).getSExtValue();
+  return dim == -1 || dim == input_type.getRank() - 1;
+}
+
+// Matches the variance of `input` over its last dimension, from its mean and
+// the `centered` input.
+bool IsVarianceOverLastDim(Value value, Value input, Value mean,
+                           Value centered) {
+  auto variance = value.getDefiningOp<TFL::MeanOp>();
+  if (!variance) return false;
+  Value squared = variance.getInput();
+  bool is_square = false;
+  if (auto op = squared.getDefiningOp<TFL::SquaredDifferenceOp>()) {
+    is_square = op.getLhs() == input && op.getRhs() == mean;
+  } else if (auto op = squared.getDefiningOp<TFL::SquareOp>()) {
+    is_square = op.getX() == centered;
+  } else if (auto op = squared.getDefiningOp<TFL::MulOp>()) {
+    is_square = op.getLhs() == centered && op.getRhs() == centered &&
+                op.getFusedActivationFunction() == "NONE";
+  }
+  return is_square && IsMeanOverLastDim(value, squared);
+}
+
+// Returns true if `value` is `(variance + epsilon)`, with a constant epsilon.
+bool MatchVariancePlusEpsilon(Value value, Value* variance, float* epsilon) {
+  auto add = value.getDefiningOp<TFL::AddOp>();
+  if (!add || add.getFusedActivationFunction() != "NONE") return false;
+  if (MatchSplatConstant(add.getRhs(), epsilon)) {
+    *variance = add.getLhs();
+    return true;
+  }
+  if (MatchSplatConstant(add.getLhs(), epsilon)) {
+    *variance = add.getRhs();
+    return true;
+  }
+  return false;
+}
+
+// Returns true if `value` may scale or offset the last dimension of `input`
+// without broadcasting it.
+bool IsPerChannel(Value value, RankedTensorType input_type) {
+  auto type = mlir::dyn_cast<RankedTensorType>(value.getType());
+  const int64_t depth = input_type.getShape().back();
+  return type && type.hasStaticShape() && type.getElementType().isF32() &&
+         type.getRank() >= 1 && type.getRank() <= input_type.getRank() &&
+         type.getNumElements() == depth && type.getShape().back() == depth;
+}
+
+Value CreateSplatConstant(PatternRewriter& rewriter, Location loc,
+                          ArrayRef<int64_t> shape, float value) {
+  auto type = RankedTensorType::get(shape, rewriter.getF32Type());
+  return rewriter.create<arith::ConstantOp>(
+      loc, DenseElementsAttr::get(type, rewriter.getF32FloatAttr(value)));
+}
+
+// Fuses the normalization of the input by its mean and variance, rooted at
+// the mul (or div) that applies the variance, along with the scale and offset
+// that follow it.
+class FuseLayerNorm : public RewritePattern {
+ public:
+  explicit FuseLayerNorm(MLIRContext* context)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context) {}
+
+  LogicalResult matchAndRewrite(Operation* op,
+                                PatternRewriter& rewriter) const override {
+    if (!llvm::isa<TFL::MulOp, TFL::DivOp>(op) ||
+        op->getAttrOfType<StringAttr>("fused_activation_function")
+                .getValue() != "NONE") {
+      return failure();
+    }
+
+    // Either `centered * rsqrt(variance + epsilon)` or
+    // `centered / sqrt(variance + epsilon)`.
+    Value centered, variance_plus_epsilon;
+    for (Value operand : op->getOperands()) {
+      if (llvm::isa<TFL::MulOp>(op)) {
+        if (auto rsqrt = operand.getDefiningOp<TFL::RsqrtOp>()) {
+          variance_plus_epsilon = rsqrt.getX();
+          centered = OtherOperand(op, operand);
+          break;
+        }
+      } else if (auto sqrt = operand.getDefiningOp<TFL::SqrtOp>()) {
+        if (operand != op->getOperand(1)) break;
+        variance_plus_epsilon = sqrt.getX();
+        centered = op->getOperand(0);
+        break;
+      }
+    }
+    if (!centered) return failure();
+
+    auto sub = centered.getDefiningOp<TFL::SubOp>();
+    if (!sub || sub.getFusedActivationFunction() != "NONE") return failure();
+    Value input = sub.getLhs();
+    Value mean = sub.getRhs();
+    auto input_type = mlir::dyn_cast<RankedTensorType>(input.getType());
+    if (!input_type || !input_type.getElementType().isF32() ||
+        input_type.getRank() < 1 ||
+        ShapedType::isDynamic(input_type.getShape().back()) ||
+        op->getResult(0).getType() != input_type ||
+        !IsMeanOverLastDim(mean, input)) {
+      return failure();
+    }
+    Value variance;
+    float epsilon;
+    if (!MatchVariancePlusEpsilon(variance_plus_epsilon, &variance,
+                                  &epsilon) ||
+        epsilon < 0.0f ||
+        !IsVarianceOverLastDim(variance, input, mean, centered)) {
+      return failure();
+    }
+
+    // The scale and offset.
+    Operation* root = op;
+    Value gamma, beta;
+    if (auto mul = GetSingleUser<TFL::MulOp>(root->getResult(0))) {
+      Value scale = OtherOperand(mul, root->getResult(0));
+      if (IsPerChannel(scale, input_type)) {
+        gamma = scale;
+        root = mul;
+      }
+    }
+    if (auto add = GetSingleUser<TFL::AddOp>(root->getResult(0))) {
+      Value offset = OtherOperand(add, root->getResult(0));
+      if (IsPerChannel(offset, input_type)) {
+        beta = offset;
+        root = add;
+      }
+    }
+    const int64_t depth = input_type.getShape().back();
+    if (!gamma) gamma = CreateSplatConstant(rewriter, op->getLoc(), depth, 1);
+    if (!beta) beta = CreateSplatConstant(rewriter, op->getLoc(), depth, 0);
+
+    auto layer_norm = rewriter.create<TFL::CustomOp>(
+        root->getLoc(), TypeRange{input_type}, ValueRange{input, gamma, beta},
+        kLayerNormCustomCode, CustomOption(&rewriter, "epsilon", epsilon));
+    rewriter.replaceOp(root, layer_norm.getResults());
+    return success();
+  }
+};
+
+// Returns the (B, T, N, H) heads of `heads`, which are (B, N, T, H), folding
+// the transpose that produced them if any.
+Value TransposeHeads(PatternRewriter& rewriter, Value heads) {
+  if (auto transpose = heads.getDefiningOp<TFL::TransposeOp>()) {
+    DenseIntElementsAttr perm;
+    if (matchPattern(transpose.getPerm(), m_Constant(&perm)) &&
+        llvm::equal(perm.getValues<int32_t>(), kHeadsPermutation)) {
+      return transpose.getInput();
+    }
+  }
+  auto type = mlir::cast<RankedTensorType>(heads.getType());
+  SmallVector<int64_t, 4> shape;
+  for (int32_t dim : kHeadsPermutation) shape.push_back(type.getDimSize(dim));
+  auto perm = rewriter.create<arith::ConstantOp>(
+      heads.getLoc(), rewriter.getI32TensorAttr(kHeadsPermutation));
+  return rewriter.create<TFL::TransposeOp>(
+      heads.getLoc(), RankedTensorType::get(shape, type.getElementType()),
+      heads, perm);
+}
+
+bool IsHeads(Value value) {
+  auto type = mlir::dyn_cast<RankedTensorType>(value.getType());
+  return type && type.hasStaticShape() && type.getRank() == 4 &&
+         type.getElementType().isF32();
+}
+
+// Fuses attention, rooted at the batch matmul of the attention weights and
+// the values.
+class FuseScaledDotProductAttention
+    : public OpRewritePattern<TFL::BatchMatMulOp> {
+ public:
+  using OpRewritePattern<TFL::BatchMatMulOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(TFL::BatchMatMulOp op,
+                                PatternRewriter& rewriter) const override {
+    if (op.getAdjX() || op.getAdjY() || !IsHeads(op.getY()) ||
+        !IsHeads(op.getOutput())) {
+      return failure();
+    }
+    auto softmax = op.getX().getDefiningOp<TFL::SoftmaxOp>();
+    // The custom op doesn't scale the mask as the beta of the softmax would.
+    if (!softmax || !softmax->hasOneUse() ||
+        !softmax.getBeta().isExactlyValue(1.0)) {
+      return failure();
+    }
+    float scale = 1.0f;
+
+    // The mask.
+    Value scores = softmax.getInput();
+    Value mask;
+    if (auto add = scores.getDefiningOp<TFL::AddOp>()) {
+      if (add.getFusedActivationFunction() != "NONE" || !add->hasOneUse()) {
+        return failure();
+      }
+      scores = add.getLhs();
+      mask = add.getRhs();
+      if (!scores.getDefiningOp<TFL::BatchMatMulOp>() &&
+          !scores.getDefiningOp<TFL::MulOp>()) {
+        std::swap(scores, mask);
+      }
+    }
+
+    // The scale of the scores.
+    float scores_scale;
+    if (auto mul = scores.getDefiningOp<TFL::MulOp>()) {
+      if (mul.getFusedActivationFunction() != "NONE" || !mul->hasOneUse()) {
+        return failure();
+      }
+      if (MatchSplatConstant(mul.getRhs(), &scores_scale)) {
+        scores = mul.getLhs();
+      } else if (MatchSplatConstant(mul.getLhs(), &scores_scale)) {
+        scores = mul.getRhs();
+      } else {
+        return failure();
+      }
+      scale *= scores_scale;
+    }
+
+    auto query_key = scores.getDefiningOp<TFL::BatchMatMulOp>();
+    if (!query_key || !query_key->hasOneUse() || query_key.getAdjX()) {
+      return failure();
+    }
+    Value query = query_key.getX();
+    Value key = query_key.getY();
+    if (!query_key.getAdjY()) {
+      // The keys may be transposed explicitly.
+      auto transpose = key.getDefiningOp<TFL::TransposeOp>();
+      DenseIntElementsAttr perm;
+      if (!transpose || !matchPattern(transpose.getPerm(), m_Constant(&perm)) ||
+          !llvm::equal(perm.getValues<int32_t>(),
+                       ArrayRef<int32_t>({0, 1, 3, 2}))) {
+        return failure();
+      }
+      key = transpose.getInput();
+    }
+    if (auto mul = query.getDefiningOp<TFL::MulOp>()) {
+      float query_scale;
+      if (mul.getFusedActivationFunction() == "NONE" && mul->hasOneUse() &&
+          MatchSplatConstant(mul.getRhs(), &query_scale)) {
+        query = mul.getLhs();
+        scale *= query_scale;
+      }
+    }
+    // The custom op treats non positive scales as unset.
+    if (!(scale > 0.0f)) return failure();
+
+    Value value = op.getY();
+    if (!IsHeads(query) || !IsHeads(key)) return failure();
+    auto query_type = mlir::cast<RankedTensorType>(query.getType());
+    auto key_type = mlir::cast<RankedTensorType>(key.getType());
+    if (key_type != value.getType() || query_type != op.getOutput().getType() ||
+        query_type.getDimSize(0) != key_type.getDimSize(0) ||
+        query_type.getDimSize(1) != key_type.getDimSize(1) ||
+        query_type.getDimSize(3) != key_type.getDimSize(3)) {
+      return failure();
+    }
+    // The mask must broadcast to (B, N, Tq, Tk).
+    const int64_t attention_shape[] = {
+        query_type.getDimSize(0), query_type.getDimSize(1),
+        query_type.getDimSize(2), key_type.getDimSize(2)};
+    if (mask) {
+      if (!IsHeads(mask)) return failure();
+      auto mask_type = mlir::cast<RankedTensorType>(mask.getType());
+      for (int i = 0; i < 4; ++i) {
+        const int64_t dim = mask_type.getDimSize(i);
+        if (dim != 1 && dim != attention_shape[i]) return failure();
+      }
+    } else {
+      mask = CreateSplatConstant(rewriter, op.getLoc(), {1, 1, 1, 1}, 0);
+    }
+
+    Value transposed_query = TransposeHeads(rewriter, query);
+    auto attention = rewriter.create<TFL::CustomOp>(
+        op.getLoc(), TypeRange{transposed_query.getType()},
+        ValueRange{transposed_query, TransposeHeads(rewriter, key),
+                   TransposeHeads(rewriter, value), mask},
+        kAttentionCustomCode, CustomOption(&rewriter, "scale", scale));
+    rewriter.replaceOp(op, TransposeHeads(rewriter, attention.getResult(0)));
+    return success();
+  }
+};
+
+class FuseTransformerOpsPass
+    : public impl::FuseTransformerOpsPassBase<FuseTransformerOpsPass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(FuseTransformerOpsPass)
+  void runOnOperation() override;
+};
+
+void FuseTransformerOpsPass::runOnOperation() {
+  RewritePatternSet patterns(&getContext());
+  patterns.add<FuseLayerNorm, FuseScaledDotProductAttention>(&getContext());
+  (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseTransformerOpsPass() {
+  return std::make_unique<FuseTransformerOpsPass>();
+}
+
+}  // namespace TFL
+}  // namespace mlir
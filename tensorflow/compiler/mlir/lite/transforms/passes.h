@@ -233,6 +233,21 @@ std::unique_ptr<OperationPass<ModuleOp>> CreateLegalizeTensorListPass();
 // tensor are within the range of the reduced precision.
 std::unique_ptr<OperationPass<ModuleOp>> CreateReduceTypePrecisionPass();
 
+// Quantizes the constant float filters of fully connected ops to INT4, with a
+// symmetric scale per `block_size` values of each output unit, without
+// calibration.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateBlockwiseQuantizeWeightsPass(
+    int64_t block_size = 32, int64_t min_elements = 1024);
+
+// Lays the INT4 filters of hybrid fully connected ops out as the packed tiles
+// of the optimized 4 bit kernel of TFLite, which then uses them in place.
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreatePrepackFullyConnectedWeightsPass();
+
+// Fuses the layer normalization and attention of transformer models into the
+// `odml.layer_norm` and `odml.scaled_dot_product_attention` custom ops.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseTransformerOpsPass();
+
 // Convervatively pushes transposes through elementwise ops to prepare
 // so redudant ones may be grouped and removed.
 std::unique_ptr<OperationPass<ModuleOp>> CreatePushTransposeThroughEwisePass();
@@ -0,0 +1,190 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass lays the INT4 filters of hybrid fully connected ops
+// out as the packed tiles of the optimized 4 bit kernel of TFLite, and marks
+// the ops with the PACKED4x32INT4 weights format. The kernel then uses the
+// filters in place from the model file instead of packing them into a copy.
+//
+// The packed tiles hold as many values as the filter when its units and depth
+// are multiples of the tile shape, so that the filter keeps its type and the
+// packed bytes are held as the INT4 values they will be serialized from.
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/Dialect/Quant/QuantTypes.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/PatternMatch.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "mlir/Support/TypeID.h"  // from @llvm-project
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+#include "tensorflow/compiler/mlir/lite/utils/low_bit_utils.h"
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
+
+//===----------------------------------------------------------------------===//
+// The PrepackFullyConnectedWeights Pass.
+//
+namespace mlir {
+namespace TFL {
+
+namespace {
+
+#define GEN_PASS_DEF_PREPACKFULLYCONNECTEDWEIGHTSPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+constexpr char kDefaultWeightsFormat[] = "DEFAULT";
+constexpr char kPackedWeightsFormat[] = "PACKED4x32INT4";
+
+// Returns the number of scales per unit of a filter the 4 bit kernel can run
+// with scales on the units, or 0 otherwise.
+int64_t GetNumGroups(quant::QuantizedType type, int64_t num_units,
+                     int64_t depth) {
+  auto per_axis_type =
+      mlir::dyn_cast<quant::UniformQuantizedPerAxisType>(type);
+  if (!per_axis_type || per_axis_type.getQuantizedDimension() != 0 ||
+      per_axis_type.getScales().size() % num_units != 0 ||
+      !llvm::all_of(per_axis_type.getZeroPoints(),
+                    [](int64_t zero_point) { return zero_point == 0; })) {
+    return 0;
+  }
+  const int64_t num_groups = per_axis_type.getScales().size() / num_units;
+  if (depth % num_groups != 0 ||
+      (depth / num_groups) % tflite::optimized_4bit::FilterDepth != 0) {
+    return 0;
+  }
+  return num_groups;
+}
+
+class PrepackFullyConnectedFilter
+    : public OpRewritePattern<TFL::FullyConnectedOp> {
+ public:
+  using OpRewritePattern<TFL::FullyConnectedOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(TFL::FullyConnectedOp op,
+                                PatternRewriter &rewriter) const override {
+    auto input_type = mlir::dyn_cast<ShapedType>(op.getInput().getType());
+    if (op.getWeightsFormat() != kDefaultWeightsFormat || !input_type ||
+        !input_type.getElementType().isF32()) {
+      return failure();
+    }
+
+    // Other users of the filter would read the packed values.
+    auto filter = op.getFilter().getDefiningOp<TFL::QConstOp>();
+    if (!filter || !filter->hasOneUse()) {
+      return failure();
+    }
+    auto filter_type = mlir::cast<ShapedType>(filter.getType());
+    auto quantized_type =
+        mlir::dyn_cast<quant::QuantizedType>(filter_type.getElementType());
+    if (!quantized_type || quantized_type.getStorageTypeIntegralWidth() != 4 ||
+        !filter_type.hasStaticShape() || filter_type.getRank() != 2) {
+      return failure();
+    }
+    const int64_t num_units = filter_type.getDimSize(0);
+    const int64_t depth = filter_type.getDimSize(1);
+    if (num_units % tflite::optimized_4bit::FilterWidth != 0 ||
+        depth % tflite::optimized_4bit::FilterDepth != 0) {
+      return failure();
+    }
+    const int64_t num_groups = GetNumGroups(quantized_type, num_units, depth);
+    if (num_groups == 0) {
+      return failure();
+    }
+
+    auto values = mlir::dyn_cast<DenseIntElementsAttr>(filter.getValue());
+    if (!values) {
+      return failure();
+    }
+    std::vector<uint8_t> unpacked;
+    unpacked.reserve(values.getNumElements());
+    for (const llvm::APInt &value : values.getValues<llvm::APInt>()) {
+      unpacked.push_back(static_cast<uint8_t>(value.getSExtValue()));
+    }
+    const std::vector<uint8_t> dense =
+        tflite::PackInt4ValuesDensely(std::move(unpacked));
+
+    tflite::optimized_4bit::OpData4Bit packed;
+    packed.AllocatePackedRegion(
+        tflite::optimized_4bit::kDefaultAlignmentPadding + dense.size());
+    const auto *dense_data = reinterpret_cast<const int8_t *>(dense.data());
+    if (num_groups > 1) {
+      tflite::optimized_4bit::api::PrepackPerGroup(
+          packed.prepacked_cache, dense_data, num_units, num_units, depth,
+          depth / num_groups, tflite::optimized_4bit::FilterWidth,
+          tflite::optimized_4bit::FilterDepth);
+    } else {
+      tflite::optimized_4bit::api::Prepack(
+          packed.prepacked_cache, dense_data, num_units, depth, num_units,
+          depth, tflite::optimized_4bit::FilterWidth,
+          tflite::optimized_4bit::FilterDepth);
+    }
+    const std::vector<char> packed_values = tflite::UnpackDenseInt4IntoInt8(
+        std::vector<uint8_t>(packed.prepacked_cache,
+                             packed.prepacked_cache + dense.size()),
+        values.getNumElements());
+
+    SmallVector<llvm::APInt> new_values;
+    new_values.reserve(packed_values.size());
+    for (char value : packed_values) {
+      new_values.emplace_back(/*numBits=*/4, value, /*isSigned=*/true);
+    }
+    auto new_filter = rewriter.create<TFL::QConstOp>(
+        filter.getLoc(), filter.getQtypeAttr(),
+        DenseElementsAttr::get(values.getType(), new_values));
+    rewriter.modifyOpInPlace(op, [&] {
+      op.setOperand(1, new_filter);
+      op.setWeightsFormatAttr(rewriter.getStringAttr(kPackedWeightsFormat));
+    });
+    return success();
+  }
+};
+
+class PrepackFullyConnectedWeightsPass
+    : public impl::PrepackFullyConnectedWeightsPassBase<
+          PrepackFullyConnectedWeightsPass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(
+      PrepackFullyConnectedWeightsPass)
+  void runOnOperation() override;
+};
+
+void PrepackFullyConnectedWeightsPass::runOnOperation() {
+  RewritePatternSet patterns(&getContext());
+  patterns.add<PrepackFullyConnectedFilter>(&getContext());
+  (void)applyPatternsAndFoldGreedily(getOperation(), std::move(patterns));
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreatePrepackFullyConnectedWeightsPass() {
+  return std::make_unique<PrepackFullyConnectedWeightsPass>();
+}
+
+}  // namespace TFL
+}  // namespace mlir
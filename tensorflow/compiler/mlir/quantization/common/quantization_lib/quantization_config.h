@@ -73,6 +73,12 @@ struct QuantizationSpecs {
   // in MLIR dynamic range quantizer with int8 weight data type.
   int64_t minimum_elements_for_weights = 1024;
 
+  // The number of consecutive weights of each output unit sharing a scale when
+  // quantizing the weights of fully connected ops to INT4 without calibration.
+  // Blockwise INT4 weight quantization is disabled if zero. Weights with
+  // fewer than `minimum_elements_for_weights` elements are kept in float.
+  int64_t int4_weight_block_size = 0;
+
   // Whether to calculate scales in float to keep quantized values the same with
   // old TOCO quantizer.
   bool legacy_float_scale = false;
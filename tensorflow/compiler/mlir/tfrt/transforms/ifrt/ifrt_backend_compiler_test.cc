@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/ifrt_backend_compiler.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/strings/str_cat.h"
@@ -28,13 +31,16 @@ limitations under the License.
 #include "mlir/InitAllDialects.h"  // from @llvm-project
 #include "mlir/Parser/Parser.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tensorflow/dialect_registration.h"
+#include "tensorflow/compiler/mlir/tensorflow/ir/host_runtime/tfrt_ops.h"
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/test_util.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_executable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_model_context.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 #include "tensorflow/core/tfrt/runtime/runtime.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 #include "tsl/framework/test_util/mock_serving_device_selector.h"
@@ -97,6 +103,65 @@ TEST(IfrtBackendCompilerTest, Basic) {
   TF_ASSERT_OK(compiler.CompileTensorflow(runtime_context, mlir_module.get()));
 }
 
+TEST(IfrtBackendCompilerTest, ForwardsBatchingOptions) {
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/compiler/mlir/tfrt/transforms/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/ifrt_cluster.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+  ASSERT_TRUE(mlir_module);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  std::unique_ptr<tensorflow::tfrt_stub::Runtime> runtime =
+      tensorflow::tfrt_stub::DefaultTfrtRuntime(/*num_threads=*/1);
+  tensorflow::tfrt_stub::GraphExecutionOptions graph_execution_options(
+      runtime.get());
+  tfrt::ResourceContext resource_context;
+  tensorflow::tfrt_stub::ModelRuntimeContext runtime_context(
+      &graph_execution_options, /*export_dir=*/"", &resource_context);
+
+  tsl::test_util::MockServingDeviceSelector mock_serving_device_selector;
+  IfrtServingCoreSelector core_selector(&mock_serving_device_selector);
+
+  runtime_context.resource_context().CreateResource<IfrtModelContext>(
+      "IfrtModelContext", client, &core_selector, &GetThreadPool());
+  std::optional<IfrtModelContext*> ifrt_model_context =
+      runtime_context.resource_context().GetResource<IfrtModelContext>(
+          "IfrtModelContext");
+  ASSERT_TRUE(ifrt_model_context.has_value());
+  IfrtServingBatchingOptions batching_options;
+  batching_options.max_batch_size = 8;
+  batching_options.allowed_batch_sizes = {4, 8};
+  (*ifrt_model_context)->set_batching_options(batching_options);
+
+  IfrtBackendCompiler compiler;
+  TF_ASSERT_OK(compiler.CompileTensorflow(runtime_context, mlir_module.get()));
+
+  std::vector<int64_t> program_ids;
+  mlir_module->walk([&](mlir::TF::IfrtCallOp call) {
+    program_ids.push_back(call.getProgramId());
+  });
+  ASSERT_FALSE(program_ids.empty());
+  for (int64_t program_id : program_ids) {
+    IfrtServingExecutable* executable =
+        ServingExecutableRegistry::Lookup(program_id);
+    ASSERT_NE(executable, nullptr);
+    EXPECT_EQ(executable->batching_options().max_batch_size, 8);
+    EXPECT_EQ(executable->batching_options().allowed_batch_sizes,
+              std::vector<int64_t>({4, 8}));
+  }
+}
+
 }  // namespace
 }  // namespace ifrt_serving
 }  // namespace tensorflow
@@ -55,11 +55,12 @@ absl::StatusOr<mlrt::bc::Buffer> ConvertTfMlirToBytecode(
     const TfrtCompileOptions& options, tfrt_stub::FallbackState& fallback_state,
     mlir::ModuleOp module, tfrt_stub::ModelRuntimeContext& model_context,
     mlir::OwningOpRef<mlir::ModuleOp>* module_with_op_keys,
-    std::vector<std::string>* added_xla_function_names) {
+    std::vector<std::string>* added_xla_function_names,
+    const tfrt_stub::CostRecorder* cost_recorder) {
   mlrt::bc::Buffer bytecode_buffer;
   TF_RETURN_IF_ERROR(ConvertTfMlirToRuntimeExecutable(
       options, module,
-      [&bytecode_buffer, &fallback_state, &model_context,
+      [&bytecode_buffer, &fallback_state, &model_context, cost_recorder,
        backend_compiler = options.backend_compiler,
        module_with_op_keys](mlir::PassManager& pm, mlir::ModuleOp module,
                             const TfrtPipelineOptions& options) {
@@ -122,7 +123,7 @@ absl::StatusOr<mlrt::bc::Buffer> ConvertTfMlirToBytecode(
         // Clear passes already run.
         pm.clear();
         // Create the remaining pipeline and run.
-        CreateTfToMlrtPipeline(pm, options, &fallback_state);
+        CreateTfToMlrtPipeline(pm, options, &fallback_state, cost_recorder);
         if (mlir::failed(pm.run(module))) {
           return diag_handler.Combine(absl::InternalError(
               "failed to lower TF Dialect to MLRT dialect."));
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/framework/function.h"
@@ -985,6 +986,21 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
   }
 }
 
+// Returns whether the engine executions are captured into CUDA graphs which
+// are replayed by later executions with the same shapes and buffers.
+static bool UseCudaGraphs() {
+  static const bool use_cuda_graphs = [] {
+    bool value;
+    Status status = ReadBoolFromEnvVar("TF_TRT_USE_CUDA_GRAPHS",
+                                       /*default_val=*/false, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return value;
+  }();
+  return use_cuda_graphs;
+}
+
 Status TRTEngineOp::ExecuteTrtEngine(
     OpKernelContext* ctx, EngineContext* engine_context, int trt_context_idx,
     const TrtShapeOptimizationProfile& profiles, TRTBaseAllocator* allocator) {
@@ -1053,9 +1069,35 @@ Status TRTEngineOp::ExecuteTrtEngine(
     TF_RETURN_IF_ERROR(context_device_memory.AllocateDeviceMemory(
         execution_context, allocator, engine_context->GetDeviceMemorySize()));
   }
-  // Enqueue the TensorRT engine for execution.
-  return TrtEnqueue(execution_context, buffers, stream, use_implicit_batch_,
-                    num_batch);
+  // Graphs can only capture the executions of contexts owning their device
+  // memory, as the memory allocated above is released after this call.
+  if (!UseCudaGraphs() || !has_device_memory) {
+    // Enqueue the TensorRT engine for execution.
+    return TrtEnqueue(execution_context, buffers, stream, use_implicit_batch_,
+                      num_batch);
+  }
+  std::unique_ptr<GpuGraphCache>& graph_cache =
+      engine_context->graph_caches[trt_context_idx];
+  if (graph_cache == nullptr) {
+    graph_cache = std::make_unique<GpuGraphCache>();
+  }
+  // Besides the context, an execution only depends on the input shapes, which
+  // have been set on the context above, and on the bound buffers.
+  GpuGraphKey key;
+  key.AddValue(num_batch);
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    key.AddShape(ctx->input(i).shape());
+  }
+  for (void* buffer : buffers) {
+    key.AddBuffer(buffer);
+  }
+  return graph_cache->Run(
+      key, ctx->op_device_context()->stream(), [&](se::Stream* graph_stream) {
+        return TrtEnqueue(execution_context, buffers,
+                          reinterpret_cast<cudaStream_t>(
+                              graph_stream->platform_specific_handle().stream),
+                          use_implicit_batch_, num_batch);
+      });
 }
 
 Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 
 #include <list>
+#include <memory>
 #include <thread>
 #include <unordered_map>
 
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
 #include "third_party/tensorrt/NvInfer.h"
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
 
@@ -180,6 +183,13 @@ struct EngineContext {
   // at https://github.com/tensorflow/tensorflow/issues/36959
   std::vector<ExecutionContext> execution_contexts TF_GUARDED_BY(mu);
 
+  // CUDA graphs of the enqueued engine executions of each execution context,
+  // when enabled by TF_TRT_USE_CUDA_GRAPHS. Declared after
+  // `execution_contexts` so that the graphs are destroyed before the device
+  // memory they use.
+  absl::flat_hash_map<int, std::unique_ptr<GpuGraphCache>> graph_caches
+      TF_GUARDED_BY(mu);
+
  private:
   // Until TRT 8.4 ICudaEngine::getDeviceMemorySize() has a non-negligible
   // latency. Since its value remains constant, we can cache it.
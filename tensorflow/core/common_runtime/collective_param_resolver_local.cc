@@ -68,7 +68,22 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      // The two-level reduction only pays off when the group spans several
+      // tasks, and requires them to contribute the same number of devices.
+      if (cp->instance.impl_details.communication_hint == "hierarchical" &&
+          cp->group.num_tasks > 1 && cp->group.same_num_devices_per_task) {
+        return "HierarchicalRingReduce";
+      }
+      // Lossy transport is only selected on request, and is only implemented
+      // for float32 reductions on CPU.
+      if ((cp->instance.impl_details.communication_hint == "fp16" ||
+           cp->instance.impl_details.communication_hint == "bf16") &&
+          cp->group.device_type == DEVICE_CPU &&
+          cp->instance.data_type == DT_FLOAT) {
+        return "QuantizedRingReduce";
+      }
+      return "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
@@ -191,19 +191,14 @@ Status Member::SetAssignedDeviceName(const string& device_name) {
   return absl::OkStatus();
 }
 
-Status Member::SetResourceDeviceName(const Node& node) {
+Status Member::SetResourceDeviceName(
+    const DeviceNameUtils::ParsedName& device_name) {
   if (DeviceNameUtils::HasSomeDetails(requested_device_name_)) {
     return errors::Internal(
         "Setting resource device name when there is a requested device set "
         "is unsupported");
   }
-
-  if (!DeviceNameUtils::ParseFullName(node.requested_device(),
-                                      &resource_device_name_)) {
-    return errors::InvalidArgument("Malformed device specification '",
-                                   node.requested_device(),
-                                   "' in node: ", node.DebugString());
-  }
+  resource_device_name_ = device_name;
 
   // Set requested device to resource device to maintain the invariant that
   // requested is a specialization of resource.
@@ -211,7 +206,8 @@ Status Member::SetResourceDeviceName(const Node& node) {
   return absl::OkStatus();
 }
 
-Status Member::SetRequestedDeviceName(const Node& node) {
+Status Member::SetRequestedDeviceName(
+    const DeviceNameUtils::ParsedName& device_name) {
   if (DeviceNameUtils::HasSomeDetails(assigned_device_name_)) {
     return errors::Internal(
         "Setting requested device name when there is an assigned device set "
@@ -222,12 +218,7 @@ Status Member::SetRequestedDeviceName(const Node& node) {
         "Setting requested device name when there is a resource device set "
         "is unsupported");
   }
-  if (!DeviceNameUtils::ParseFullName(node.requested_device(),
-                                      &requested_device_name_)) {
-    return errors::InvalidArgument("Malformed device specification '",
-                                   node.requested_device(),
-                                   "' in node: ", node.DebugString());
-  }
+  requested_device_name_ = device_name;
   return absl::OkStatus();
 }
 
@@ -1239,6 +1230,22 @@ Status ColocationGraph::GetDevicesForNode(
 
   Member& root_member = members_[node_root];
 
+  // Colocation groups with the same constraints have the same possible
+  // devices, which are only computed once.
+  string cache_key =
+      DeviceNameUtils::ParsedNameToString(root_member.requested_device_name());
+  for (const auto& [device_type, priority] :
+       root_member.supported_device_types()) {
+    strings::StrAppend(&cache_key, ";", device_type.type_string(), ":",
+                       priority);
+  }
+  auto cached = possible_devices_cache_.find(cache_key);
+  if (cached != possible_devices_cache_.end()) {
+    root_member.set_possible_devices(std::vector<Device*>(cached->second));
+    *possible_devices = &root_member.possible_devices();
+    return absl::OkStatus();
+  }
+
   // We have not yet computed the possible devices for the
   // colocated node set containing 'node', so we do so now using the
   // constraints on the root node.
@@ -1249,6 +1256,7 @@ Status ColocationGraph::GetDevicesForNode(
   // is guaranteed to respect the assigned and resource device names because
   // requested device is always a specialization of both.
   std::vector<Device*> devices;
+  bool soft_placed = false;
   if (DeviceNameUtils::HasSomeDetails(root_member.requested_device_name())) {
     // The root node has a (possibly partial) device
     // specification, so enumerate the physical devices that
@@ -1266,6 +1274,7 @@ Status ColocationGraph::GetDevicesForNode(
     // Perform soft placement if allow_soft_placement_ is set.
     if (devices.empty() && allow_soft_placement_) {
       GetSoftDeviceCandidates(*node, root_member, node_root, &devices);
+      soft_placed = true;
     }
 
     if (devices.empty()) {
@@ -1359,6 +1368,9 @@ Status ColocationGraph::GetDevicesForNode(
   }
 
   // Cache the result of the possible devices for this node group.
+  if (!soft_placed) {
+    possible_devices_cache_.emplace(std::move(cache_key), devices);
+  }
   root_member.set_possible_devices(std::move(devices));
   *possible_devices = &root_member.possible_devices();
   return absl::OkStatus();
@@ -1523,23 +1535,43 @@ Status ColocationGraph::InitializeMember(const Node& node, Member* member) {
     // If the NodeDef contains a device, then we interpret it as a
     // (partial) device specification.
     if (!node.requested_device().empty()) {
+      DeviceNameUtils::ParsedName requested_device_name;
+      TF_RETURN_IF_ERROR(ParseRequestedDevice(node, &requested_device_name));
       if (IsRefOrResourceGeneratorNode(node)) {
         // Treat requested device on resource generating nodes as assigned
         // device so that we don't override it.
-        TF_RETURN_IF_ERROR(member->SetResourceDeviceName(node));
+        TF_RETURN_IF_ERROR(
+            member->SetResourceDeviceName(requested_device_name));
       } else {
         // The user has specified a device in the NodeDef, try to find a
         // valid device matching their specification in the set of
         // devices.
         // NOTE: The full name may specify a device that is not in
         // n.supported_device_types(), but we check that in AssignDevice().
-        TF_RETURN_IF_ERROR(member->SetRequestedDeviceName(node));
+        TF_RETURN_IF_ERROR(
+            member->SetRequestedDeviceName(requested_device_name));
       }
     }
   }
   return absl::OkStatus();
 }
 
+Status ColocationGraph::ParseRequestedDevice(
+    const Node& node, DeviceNameUtils::ParsedName* device_name) {
+  auto it = parsed_device_names_.find(node.requested_device());
+  if (it != parsed_device_names_.end()) {
+    *device_name = it->second;
+    return absl::OkStatus();
+  }
+  if (!DeviceNameUtils::ParseFullName(node.requested_device(), device_name)) {
+    return errors::InvalidArgument("Malformed device specification '",
+                                   node.requested_device(),
+                                   "' in node: ", node.DebugString());
+  }
+  parsed_device_names_.emplace(node.requested_device(), *device_name);
+  return absl::OkStatus();
+}
+
 // Returns a list of devices having type in supported_device_types.  The
 // returned list is sorted by preferred type (higher numeric type is preferred).
 /*static*/ std::vector<Device*> ColocationGraph::FilterSupportedDevices(
@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/inspecting_placer.h"
@@ -46,8 +47,8 @@ class Member {
   }
 
   Status SetAssignedDeviceName(const string& device_name);
-  Status SetResourceDeviceName(const Node& node);
-  Status SetRequestedDeviceName(const Node& node);
+  Status SetResourceDeviceName(const DeviceNameUtils::ParsedName& device_name);
+  Status SetRequestedDeviceName(const DeviceNameUtils::ParsedName& device_name);
 
   Status FillPossibleDevices(PossibleDevices* possible_device) const;
 
@@ -362,6 +363,11 @@ class ColocationGraph {
 
   Status InitializeMember(const Node& node, Member* member);
 
+  // Parses the requested device of `node`. Large graphs usually request a few
+  // distinct devices, so the parsed names are cached by device string.
+  Status ParseRequestedDevice(const Node& node,
+                              DeviceNameUtils::ParsedName* device_name);
+
   // Returns the root node of the disjoint tree to which the node with the
   // given id is connected.
   // FindRoot should be called only for debugging or after the members have
@@ -384,6 +390,12 @@ class ColocationGraph {
   const bool allow_soft_placement_;
   const bool log_device_placement_;
 
+  absl::flat_hash_map<string, DeviceNameUtils::ParsedName> parsed_device_names_;
+  // The possible devices of the colocation groups, keyed by the requested
+  // device and supported device types of their root, which determine them
+  // unless soft placement is needed.
+  absl::flat_hash_map<string, std::vector<Device*>> possible_devices_cache_;
+
   ColocationGraph(const ColocationGraph&) = delete;
   void operator=(const ColocationGraph&) = delete;
 };
@@ -18,7 +18,10 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -100,14 +103,24 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
+  // With host callbacks, there are only events to poll if a host function
+  // failed to be enqueued.
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
 
+  {
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
       threadpool_.Schedule(std::move(callback));
@@ -154,7 +167,13 @@ void EventMgr::PollLoop() {
       if (callbacks_.empty()) {
         events_pending_.wait(l);
       }
-      PollEvents(/*stream=*/nullptr);  // poll all streams
+      const uint64 start_usecs = Env::Default()->NowMicros();
+      // Only the polls retiring events are recorded, to keep the busy polling
+      // of pending events cheap.
+      if (PollEvents(/*stream=*/nullptr) > 0) {  // poll all streams
+        metrics::UpdateEventMgrPollDuration(Env::Default()->NowMicros() -
+                                            start_usecs);
+      }
       events_still_pending = !callbacks_.empty();
     }
 
@@ -189,6 +208,73 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   }
 }
 
+void EventMgr::EnqueueHostCallback(se::Stream* stream,
+                                   std::function<void()> func) {
+  // Kept on the heap to fall back to an event if the host function can't be
+  // enqueued.
+  auto* pending_func = new std::function<void()>(std::move(func));
+  ++num_pending_host_callbacks_;
+  Status s = stream->DoHostCallback([this, pending_func]() {
+    OnHostCallback(std::move(*pending_func));
+    delete pending_func;
+  });
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to enqueue host callback, polling an event "
+                 << "instead: " << s;
+    --num_pending_host_callbacks_;
+    EnqueueCallback(stream, std::move(*pending_func));
+    delete pending_func;
+  }
+}
+
+void EventMgr::OnHostCallback(std::function<void()> func) {
+  // Host functions must not call into the driver, which the callbacks may do,
+  // so they only hand the callbacks off to the threadpool. Callbacks becoming
+  // ready while the threadpool runs others are run in the same closure.
+  mutex_lock l(mu_);
+  ready_callbacks_.push_back(std::move(func));
+  --num_pending_host_callbacks_;
+  if (!running_ready_callbacks_) {
+    running_ready_callbacks_ = true;
+    threadpool_.Schedule([this]() { RunReadyCallbacks(); });
+  }
+  if (num_pending_host_callbacks_ == 0) {
+    host_callbacks_done_.notify_all();
+  }
+}
+
+void EventMgr::RunReadyCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (ready_callbacks_.empty()) {
+        running_ready_callbacks_ = false;
+        return;
+      }
+      callbacks.swap(ready_callbacks_);
+    }
+    metrics::UpdateEventMgrCallbackBatchSize(callbacks.size());
+    for (std::function<void()>& callback : callbacks) {
+      callback();
+    }
+    callbacks.clear();
+  }
+}
+
+void EventMgr::ScheduleCallbacks(std::vector<std::function<void()>> callbacks) {
+  metrics::UpdateEventMgrCallbackBatchSize(callbacks.size());
+  if (callbacks.size() == 1) {
+    threadpool_.Schedule(std::move(callbacks[0]));
+    return;
+  }
+  threadpool_.Schedule([callbacks = std::move(callbacks)]() {
+    for (const std::function<void()>& callback : callbacks) {
+      callback();
+    }
+  });
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
@@ -196,11 +282,16 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
 // spikes of up to several hundred outstanding.  (If GPUKernelTracker
 // is used to cap pending kernels there should never be more than
 // that many.)
-void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
+int EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   VLOG(2) << "PollEvents with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
           << " unused event objects.";
 
+  // The callbacks of the completed events, scheduled as one closure rather
+  // than one each, which saves threadpool handoffs when many small ops
+  // complete between polls.
+  std::vector<std::function<void()>> completed_callbacks;
+
   // Polls the events for one stream.
   //
   // `stream_it` should be an iterator into callbacks_.  Modifies stream_it so
@@ -229,7 +320,7 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
               break;
             case se::Event::Status::kComplete:
               free_events_.push_back(std::move(event));
-              threadpool_.Schedule(std::move(callback));
+              completed_callbacks.push_back(std::move(callback));
               // std::deque::erase() does invalidate iterators, so we can't
               // erase `it` here.  Instead, we'll wait until the end of the loop
               // over stream_callbacks and erase all of the completed events at
@@ -267,6 +358,12 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
       poll_events_for_stream_it(stream_it);
     }
   }
+
+  const int num_completed = completed_callbacks.size();
+  if (num_completed > 0) {
+    ScheduleCallbacks(std::move(completed_callbacks));
+  }
+  return num_completed;
 }
 
 EventMgrFactory* EventMgrFactory::Singleton() {
@@ -69,6 +69,10 @@ class EventMgr {
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
     mutex_lock l(mu_);
+    if (use_host_callbacks_) {
+      EnqueueHostCallback(stream, std::move(func));
+      return;
+    }
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
   }
@@ -80,6 +84,7 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -90,12 +95,26 @@ class EventMgr {
   void EnqueueCallback(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Like EnqueueCallback, but has `stream` call a host function once it
+  // completes its outstanding work, rather than recording an event to poll.
+  void EnqueueHostCallback(se::Stream* stream, std::function<void()> func)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Called by the host functions of EnqueueHostCallback().
+  void OnHostCallback(std::function<void()> func) TF_LOCKS_EXCLUDED(mu_);
+
+  // Schedules `callbacks` to run in order on the threadpool, as one closure.
+  void ScheduleCallbacks(std::vector<std::function<void()>> callbacks);
+
+  // Runs ready_callbacks_ until there are none left.
+  void RunReadyCallbacks() TF_LOCKS_EXCLUDED(mu_);
+
   // This function should be called at roughly the same tempo as QueueTensors()
   // to check whether pending events have recorded, and then retire them.
   //
   // If `stream` is not null, we only poll events for that stream.  Otherwise we
-  // poll events for all streams.
-  void PollEvents(se::Stream* stream = nullptr)
+  // poll events for all streams.  Returns the number of retired events.
+  int PollEvents(se::Stream* stream = nullptr)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // An internal polling loop that runs at a low frequency to clear straggler
@@ -115,6 +134,15 @@ class EventMgr {
       std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
       callbacks_ TF_GUARDED_BY(mu_);
 
+  // Callbacks whose host functions were called, waiting to run on the
+  // threadpool.
+  std::vector<std::function<void()>> ready_callbacks_ TF_GUARDED_BY(mu_);
+  // Whether a closure running ready_callbacks_ is scheduled.
+  bool running_ready_callbacks_ TF_GUARDED_BY(mu_) = false;
+  // Number of host functions the streams did not call yet.
+  int64_t num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(mu_);
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
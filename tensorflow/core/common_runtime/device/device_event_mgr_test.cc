@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
 #include <atomic>
+#include <vector>
 
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -134,6 +135,34 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that callbacks run in order when streams call host functions instead
+// of recording events.
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  constexpr int kNumCallbacks = 100;
+  std::vector<int> order;
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [i, &order, &note]() {
+      order.push_back(i);
+      if (i == kNumCallbacks - 1) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  // No events are recorded.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+  ASSERT_EQ(kNumCallbacks, order.size());
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
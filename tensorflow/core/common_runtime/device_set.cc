@@ -49,6 +49,7 @@ void DeviceSet::FindMatchingDevices(const DeviceNameUtils::ParsedName& spec,
     auto match = matching_device_cache_.find(spec);
     if (match != matching_device_cache_.end()) {
       *devices = match->second;
+      return;
     }
   }
 
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/local_session_selection.h"
+#include "tensorflow/core/common_runtime/memory_compaction.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -90,6 +91,13 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Returns the cell of `direct_session_runs`, which is looked up once instead
+// of under the counter's lock on every step.
+monitoring::CounterCell* DirectSessionRunsCell() {
+  static monitoring::CounterCell* cell = direct_session_runs->GetCell();
+  return cell;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -507,6 +515,35 @@ Status DirectSession::DecorateAndPublishGraphForDebug(
   return absl::OkStatus();
 }
 
+void DirectSession::MaybeCompactDeviceMemory() {
+  const float threshold = options_.config.gpu_options()
+                              .experimental()
+                              .memory_compaction_fragmentation_threshold();
+  // Skips the compaction if another step is running, or another thread is
+  // already compacting.
+  mutex_lock l(memory_compaction_mu_, std::try_to_lock);
+  if (!l) return;
+  for (Device* device : devices_) {
+    if (device->tensorflow_accelerator_device_info() == nullptr) continue;
+    Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+    absl::optional<AllocatorStats> stats = allocator->GetStats();
+    if (!stats.has_value()) continue;
+    const double fragmentation = AllocatorFragmentation(*stats);
+    if (fragmentation <= threshold) continue;
+    Status s = device->Sync();
+    int64_t moved_bytes = 0;
+    if (s.ok()) s = CompactVariables(device, &moved_bytes);
+    if (s.ok()) s = device->Sync();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to compact the memory of " << device->name()
+                   << ": " << s;
+      continue;
+    }
+    VLOG(1) << "Moved " << moved_bytes << " bytes of variables on "
+            << device->name() << " with fragmentation " << fragmentation;
+  }
+}
+
 Status DirectSession::RunInternal(
     int64_t step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
@@ -518,6 +555,15 @@ Status DirectSession::RunInternal(
   RunState run_state(step_id, &devices_);
   const size_t num_executors = executors_and_keys->items.size();
 
+  // Steps hold the compaction lock shared, so that memory is only compacted
+  // between steps.
+  absl::optional<tf_shared_lock> memory_compaction_lock;
+  if (options_.config.gpu_options()
+          .experimental()
+          .memory_compaction_fragmentation_threshold() > 0) {
+    memory_compaction_lock.emplace(memory_compaction_mu_);
+  }
+
   profiler::TraceMeProducer activity(
       // To TraceMeConsumers in ExecutorState::Process/Finish.
       [&] {
@@ -672,6 +718,8 @@ Status DirectSession::RunInternal(
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
+  args.use_step_arena_allocator =
+      options_.config.experimental().use_step_arena_allocator();
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
 
@@ -838,6 +886,10 @@ Status DirectSession::RunInternal(
   }
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
+  if (memory_compaction_lock.has_value()) {
+    memory_compaction_lock.reset();
+    MaybeCompactDeviceMemory();
+  }
   return absl::OkStatus();
 }
 
@@ -860,7 +912,7 @@ Status DirectSession::Run(const RunOptions& run_options,
                           const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("Run()"));
-  direct_session_runs->GetCell()->IncrementBy(1);
+  DirectSessionRunsCell()->IncrementBy(1);
 
   // Extract the inputs names for this run of the session.
   std::vector<string> input_tensor_names;
@@ -1940,7 +1992,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
-  direct_session_runs->GetCell()->IncrementBy(1);
+  DirectSessionRunsCell()->IncrementBy(1);
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
@@ -1960,9 +2012,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   }
 
   // NOTE(mrry): Debug options are not currently supported in the
-  // callable interface.
-  DebugOptions debug_options;
-  RunStateArgs run_state_args(debug_options);
+  // callable interface, so the step has no RunStateArgs to set up.
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
@@ -2013,7 +2063,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
                                   actual_feed_tensors, fetch_tensors);
 
   if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(step_id, run_state_args.handle);
+    LogMemory::RecordStep(step_id, /*handle=*/"");
   }
 
   TF_RETURN_IF_ERROR(RunInternal(
@@ -310,14 +310,16 @@ class DirectSession : public Session {
   void WaitForNotification(Notification* n, RunState* run_state,
                            CancellationManager* cm, int64_t timeout_in_ms);
 
+  // These checks run on every step, so they only take shared locks to keep
+  // concurrent steps from serializing on them.
   ::tensorflow::Status CheckNotClosed() {
-    mutex_lock l(closed_lock_);
+    tf_shared_lock l(closed_lock_);
     if (closed_) return errors::Cancelled("Session has been closed.");
     return absl::OkStatus();
   }
 
   ::tensorflow::Status CheckGraphCreated(const char* method) {
-    mutex_lock l(graph_state_lock_);
+    tf_shared_lock l(graph_state_lock_);
     if (!graph_created_) {
       return errors::InvalidArgument(
           "Session was not created with a graph before ", method, "!");
@@ -333,6 +335,11 @@ class DirectSession : public Session {
   ::tensorflow::Status DecorateAndPublishGraphForDebug(
       const DebugOptions& debug_options, Graph* graph, Device* device);
 
+  // Compacts the memory of the GPU devices whose allocator is fragmented
+  // beyond GPUOptions.Experimental.memory_compaction_fragmentation_threshold,
+  // unless a step is running.
+  void MaybeCompactDeviceMemory() TF_LOCKS_EXCLUDED(memory_compaction_mu_);
+
   const SessionOptions options_;
 
   // Device structures.
@@ -405,6 +412,9 @@ class DirectSession : public Session {
   // library; it copies and modifies the function library.
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
 
+  // Held shared by the running steps and exclusively while compacting memory.
+  mutex memory_compaction_mu_;
+
   // true if the Session has been Closed.
   mutex closed_lock_;
   bool closed_ TF_GUARDED_BY(closed_lock_) = false;
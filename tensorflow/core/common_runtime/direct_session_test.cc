@@ -157,6 +157,26 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithStepArenaAllocator) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_use_step_arena_allocator(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The fetched tensors outlive the arenas of their steps.
+  std::vector<Tensor> first_outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &first_outputs));
+  std::vector<Tensor> second_outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &second_outputs));
+
+  ASSERT_EQ(1, first_outputs.size());
+  ASSERT_EQ(1, second_outputs.size());
+  EXPECT_FLOAT_EQ(5.0, first_outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(5.0, second_outputs[0].matrix<float>()(0, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
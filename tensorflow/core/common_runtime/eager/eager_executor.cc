@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <forward_list>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,6 +35,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t MaxCoalescedNodes() {
+  int64_t max_coalesced_nodes = 1;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_EXECUTOR_MAX_COALESCED_NODES", 1,
+                                  &max_coalesced_nodes));
+  return std::max<int64_t>(max_coalesced_nodes, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -46,6 +56,7 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
+      max_coalesced_nodes_(MaxCoalescedNodes()),
       in_flight_nodes_limit_(in_flight_nodes_limit) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
@@ -160,7 +171,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +267,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +301,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -347,8 +358,14 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
 void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
+  // Nodes that may be coalesced run synchronously on this thread.
+  const auto is_coalescible = [](const NodeItem& item) {
+    return item.node->AsAsync() == nullptr &&
+           item.node->AsAsyncRemoteExecuteNode() == nullptr;
+  };
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> coalesced_items;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -364,6 +381,24 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      // Look ahead in the queue for consecutive nodes to run together.
+      if (max_coalesced_nodes_ > 1 && is_coalescible(*curr_item)) {
+        const int64_t num_items = std::min<int64_t>(max_coalesced_nodes_,
+                                                    node_queue_.size());
+        for (int64_t i = 1; i < num_items; ++i) {
+          NodeItem* next_item = node_queue_[i].get();
+          if (!is_coalescible(*next_item)) break;
+          if (coalesced_items.empty()) {
+            coalesced_items.push_back(std::move(curr_item));
+          }
+          next_item->Ref();
+          coalesced_items.emplace_back(next_item);
+        }
+      }
+    }
+    if (!coalesced_items.empty()) {
+      RunCoalescedItems(std::move(coalesced_items));
+      continue;
     }
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -425,6 +460,42 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+void EagerExecutor::RunCoalescedItems(
+    std::vector<core::RefCountPtr<NodeItem>> items) {
+  DVLOG(3) << "Running " << items.size() << " coalesced nodes: [id "
+           << items.front()->id << " to " << items.back()->id << "]";
+  // Coalesced nodes are not remote functions, so they don't need to
+  // synchronize with the remote executors of previous nodes.
+  Status status;
+  int num_done = 0;
+  for (const auto& item : items) {
+    // Nodes are aborted, and removed from the queue, when another node fails.
+    if (num_done > 0 && !ok()) break;
+    status = item->node->Run();
+    if (!status.ok()) break;
+    ++num_done;
+  }
+
+  if (num_done > 0) {
+    mutex_lock l(node_queue_mutex_);
+    // If another node failed in the meantime, the queue was already cleared.
+    if (status_.ok()) {
+      for (int i = 0; i < num_done; ++i) {
+        DCHECK(!node_queue_.empty() &&
+               items[i].get() == node_queue_.front().get());
+        items[i]->state = NodeState::kDONE;
+        node_queue_.pop_front();
+      }
+      NotifyWaiters(items.front()->id);
+      nodes_done_.notify_all();
+    }
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run item: " << status;
+    NodeDone(items[num_done], status, /*from_queue=*/true);
+  }
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -434,7 +505,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -18,10 +18,10 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -211,6 +211,11 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs `items`, which are at the front of the queue and complete
+  // synchronously, back to back on the executor thread, and then removes them
+  // from the queue under a single acquisition of `node_queue_mutex_`. Stops at
+  // the first failing node, which is completed through NodeDone.
+  void RunCoalescedItems(std::vector<core::RefCountPtr<NodeItem>> items);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -230,7 +235,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -270,6 +275,12 @@ class EagerExecutor {
   // Enable sending remote executions through streaming enqueue.
   const bool enable_streaming_enqueue_;
 
+  // Maximum number of consecutive synchronous nodes that the executor thread
+  // takes from the queue and completes at once. Coalescing nodes amortizes
+  // the synchronization with the threads enqueuing nodes, but delays the
+  // notification of waiters until the whole batch has run. 1 disables it.
+  const int64_t max_coalesced_nodes_;
+
   // Callbacks to run on destruction.
   absl::flat_hash_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <cstdlib>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -241,6 +243,53 @@ TEST(EagerExecutorTest, TestAsyncExecutorFailRun) {
   ASSERT_EQ(state->read_state(), TestState::State::kFailure);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorCoalescesNodes) {
+  setenv("TF_EAGER_EXECUTOR_MAX_COALESCED_NODES", "4", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_EXECUTOR_MAX_COALESCED_NODES");
+
+  constexpr int kNumNodes = 10;
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < kNumNodes; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (const auto& state : states) {
+    EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorCoalescedNodesFailRun) {
+  setenv("TF_EAGER_EXECUTOR_MAX_COALESCED_NODES", "4", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_EXECUTOR_MAX_COALESCED_NODES");
+
+  // Nodes after the failing one are either aborted or rejected.
+  constexpr int kNumNodes = 10;
+  constexpr int kFailingNode = 2;
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < kNumNodes; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    async_executor
+        ->AddOrExecute(std::make_unique<TestEagerNode>(
+            states.back().get(), absl::OkStatus(),
+            i == kFailingNode ? errors::Internal("test") : absl::OkStatus()))
+        .IgnoreError();
+  }
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  for (int i = 0; i < kNumNodes; ++i) {
+    EXPECT_EQ(states[i]->read_state(),
+              i < kFailingNode    ? TestState::State::kSuccess
+              : i == kFailingNode ? TestState::State::kFailure
+                                  : TestState::State::kNotRun);
+  }
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorFailPrepareWithAsyncNode) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true);
@@ -35,7 +35,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_scheduler.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -80,6 +83,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
@@ -141,13 +145,40 @@ struct KernelTimer {
   }
 };
 
+// Returns TF_OP_LATENCY_SAMPLING_STEPS: the latencies of the ops of one of
+// every that many steps are recorded in metrics, or of none if it is 0 (the
+// default). Sampled steps only read the cycle counter around each kernel, so
+// this is cheap enough to leave on.
+int64_t ReadOpLatencySamplingSteps() {
+  int64_t steps;
+  Status s = ReadInt64FromEnvVar("TF_OP_LATENCY_SAMPLING_STEPS", 0, &steps);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    return 0;
+  }
+  return steps;
+}
+
+void RecordOpLatency(const NodeItem& item, const KernelTimer& timer) {
+  static const double cycles_per_usec =
+      static_cast<double>(profile_utils::CpuUtils::GetCycleCounterFrequency()) /
+      1e6;
+  if (cycles_per_usec <= 0) return;
+  const uint64 cycles =
+      profile_utils::CpuUtils::GetCurrentClockCycle() - timer.start_cycles;
+  metrics::UpdateOpLatency(item.kernel->type_string(),
+                           cycles / cycles_per_usec);
+}
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool work_stealing = false)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -167,6 +198,7 @@ class ExecutorImpl : public Executor {
     KernelStats() = default;
 
     void Initialize(const GraphView& gview) {
+      op_latency_sampling_steps_ = ReadOpLatencySamplingSteps();
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
@@ -188,6 +220,14 @@ class ExecutorImpl : public Executor {
               kOpIsExpensiveThresholdCycles);
     }
 
+    // Returns whether the latencies of the ops of a new step are recorded.
+    bool SampleOpLatencies() {
+      if (op_latency_sampling_steps_ <= 0) return false;
+      return num_steps_.fetch_add(1, std::memory_order_relaxed) %
+                 op_latency_sampling_steps_ ==
+             0;
+    }
+
     // Returns the value of kernel->IsExpensive().
     bool HasExpensiveMarker(const NodeItem& node) const {
       return is_expensive_[node.node_id];
@@ -210,6 +250,21 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Returns the bytes for the first chunk of the step arenas of the graph:
+    // the most that a previous step needed, so that steps usually allocate
+    // all their arena tensors from a single chunk.
+    size_t StepArenaBytes() const {
+      return step_arena_bytes_.load(std::memory_order_relaxed);
+    }
+
+    // Records the chunk bytes that the arena of a step needed.
+    void UpdateStepArenaBytes(size_t bytes) {
+      // N.B. As for cost estimates, simultaneous updates may be ignored.
+      if (bytes > step_arena_bytes_.load(std::memory_order_relaxed)) {
+        step_arena_bytes_.store(bytes, std::memory_order_relaxed);
+      }
+    }
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
@@ -221,10 +276,16 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    std::atomic<size_t> step_arena_bytes_{0};
+    int64_t op_latency_sampling_steps_ = 0;
+    std::atomic<int64_t> num_steps_{0};
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready nodes are dispatched through per-step work-stealing deques
+  // instead of one `runner` closure per node.
+  const bool work_stealing_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +345,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool work_stealing = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -298,6 +360,12 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // A node handed to `work_stealing_scheduler_`.
+  struct ScheduledNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -340,6 +408,14 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // The `ScheduleReady()` policy of the work-stealing executor. Inexpensive
+  // nodes are still run inline; the remaining nodes are pushed onto the deque
+  // of the calling worker, where the calling thread picks them up next unless
+  // an idle worker steals them first.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64_t scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -395,12 +471,21 @@ class ExecutorState {
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
+  // If not null, the arena of the step, released when it finishes.
+  StepArenaAllocator* step_arena_allocator_ = nullptr;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  // Whether the latencies of the ops of this step are recorded.
+  const bool sample_op_latencies_;
 
   PropagatorStateType propagator_;
 
+  // Set for the work-stealing executor. Holds ready nodes on per-worker deques,
+  // and may outlive this object while its last workers wind down.
+  std::shared_ptr<WorkStealingScheduler<ScheduledNode>>
+      work_stealing_scheduler_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -419,7 +504,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -448,6 +533,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      sample_op_latencies_(kernel_stats->SampleOpLatencies()),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -455,6 +541,20 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (args.use_step_arena_allocator) {
+    Device* device = immutable_state_.params().device;
+    if (device->device_type() == DEVICE_CPU) {
+      step_arena_allocator_ = StepArenaAllocator::Create(
+          device->GetAllocator(AllocatorAttributes()),
+          kernel_stats_->StepArenaBytes());
+    }
+  }
+  if (work_stealing && !run_all_kernels_inline_) {
+    work_stealing_scheduler_ = WorkStealingScheduler<ScheduledNode>::Create(
+        port::MaxParallelism(), runner_, [this](ScheduledNode node) {
+          Process(node.tagged_node, node.scheduled_nsec);
+        });
+  }
 }
 
 template <class PropagatorStateType>
@@ -463,6 +563,11 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_allocator_ != nullptr) {
+    kernel_stats_->UpdateStepArenaBytes(
+        step_arena_allocator_->TotalChunkBytes());
+    step_arena_allocator_->Release();
+  }
 }
 
 template <class PropagatorStateType>
@@ -550,6 +655,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsInterface* stats;
+  // Set if the latency of the op is sampled.
+  absl::optional<KernelTimer> timer;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -603,15 +710,19 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (kernel_stats_->HasExpensiveMarker(item) ||
+             TF_PREDICT_FALSE(sample_op_latencies_)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
+    if (TF_PREDICT_FALSE(sample_op_latencies_)) RecordOpLatency(item, timer);
     // For expensive kernels, always update the cost estimate. For inexpensive
     // kernels, update the cost estimate with ~1/16 probability. This assumes
     // that the last 4 bits of the CPU cycle count is uniformly distributed.
     constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
-    if (is_expensive ||
-        timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
+    if (kernel_stats_->HasExpensiveMarker(item) &&
+        (is_expensive ||
+         timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount ==
+             0)) {
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
     }
   } else {
@@ -635,6 +746,7 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
       new AsyncState(params, tagged_node, &item, first_input, stats);
 
   nodestats::SetOpStart(stats);
+  if (TF_PREDICT_FALSE(sample_op_latencies_)) state->timer.emplace();
 
   {
     // Always trace async ops.
@@ -673,6 +785,9 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
       Entry* first_input = state->first_input;       // Shorthand
 
       nodestats::SetOpEnd(stats);
+      if (state->timer.has_value()) {
+        RecordOpLatency(*state->item, *state->timer);
+      }
       EntryVector outputs(state->item->num_outputs);
       Status s =
           ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -773,6 +888,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->function_library = immutable_state_.params().function_library;
   params->resource_manager = device->resource_manager();
   params->step_container = step_container_;
+  params->step_arena_allocator = step_arena_allocator_;
   params->slice_reader_cache = slice_reader_cache_;
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
@@ -912,6 +1028,10 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       // Set up compute params.
       params->op_kernel = item.kernel;
+      DeviceContext* node_device_context = immutable_state_.device_context(id);
+      params->op_device_context = node_device_context != nullptr
+                                      ? node_device_context
+                                      : device_context_;
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
@@ -1119,7 +1239,9 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
   }
 
   for (int i = 0; i < item.num_outputs; ++i) {
-    const TensorValue val = ctx->release_output(i);
+    // The context keeps ownership of the non-ref output tensors, whose values
+    // are moved into the entries.
+    const TensorValue val = ctx->output_value(i);
     Entry* out = &outputs[i];
     DCHECK(out->state == Entry::State::NO_VALUE);
 
@@ -1174,11 +1296,6 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
                              FormatNodeDefForError(item.kernel->def())));
       }
     }
-    if (!val.is_ref()) {
-      // If OpKernelContext returns outputs via pass-by-value, we
-      // don't need this trouble.
-      delete val.tensor;
-    }
   }
   return s;
 }
@@ -1297,6 +1414,8 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (work_stealing_scheduler_ != nullptr) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
@@ -1374,6 +1493,35 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64_t scheduled_nsec) {
+  gtl::InlinedVector<ScheduledNode, 8> scheduled;
+  scheduled.reserve(ready->size());
+  if (inline_ready == nullptr) {
+    for (auto& tagged_node : *ready) {
+      scheduled.push_back({tagged_node, scheduled_nsec});
+    }
+  } else {
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        inline_ready->push_back(tagged_node);
+      } else {
+        scheduled.push_back({tagged_node, scheduled_nsec});
+      }
+    }
+    // Keep one expensive node on this thread when there is nothing else to
+    // run inline, rather than round-tripping it through the deque.
+    if (inline_ready->empty() && !scheduled.empty()) {
+      inline_ready->push_back(scheduled.back().tagged_node);
+      scheduled.pop_back();
+    }
+  }
+  work_stealing_scheduler_->Schedule(scheduled);
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1513,14 +1661,15 @@ void ExecutorState<PropagatorStateType>::Finish() {
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+                                               &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1574,6 +1723,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers an executor that runs ready nodes from per-worker LIFO deques with
+// randomized stealing, instead of scheduling each ready node on the shared
+// inter-op thread pool queue. This favors graphs with many small kernels, where
+// queue contention and moving successors across cores dominate kernel time.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl =
+          std::make_unique<ExecutorImpl>(params, /*work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
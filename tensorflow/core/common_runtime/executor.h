@@ -125,6 +125,10 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If true, the tensors of CPU kernels with default allocator attributes
+    // are allocated from an arena for the step (see StepArenaAllocator).
+    bool use_step_arena_allocator = false;
   };
   typedef std::function<void(const Status&)> DoneCallback;
 
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -40,8 +41,10 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -77,8 +80,10 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. An empty
+  // `executor_type` selects the default executor.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -93,7 +98,9 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    std::unique_ptr<Executor> executor;
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+    exec_ = executor.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -186,6 +193,76 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+using monitoring::testing::CellReader;
+using monitoring::testing::Histogram;
+
+constexpr char kOpLatencyMetric[] = "/tensorflow/core/op_latency_usecs";
+
+class OpLatencySamplingTest : public ExecutorTest {
+ protected:
+  // Runs c = a + b `num_steps` times, with TF_OP_LATENCY_SAMPLING_STEPS set
+  // to `sampling_steps` (or unset if null) when the executor is created.
+  // a and b are received by the async _Recv kernel.
+  void RunAdd(const char* sampling_steps, int num_steps) {
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+    auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+    auto tmp = test::graph::Add(g.get(), in0, in1);
+    test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+    if (sampling_steps != nullptr) {
+      setenv("TF_OP_LATENCY_SAMPLING_STEPS", sampling_steps, /*overwrite=*/1);
+    } else {
+      unsetenv("TF_OP_LATENCY_SAMPLING_STEPS");
+    }
+    Create(std::move(g));
+    unsetenv("TF_OP_LATENCY_SAMPLING_STEPS");
+    for (int i = 0; i < num_steps; ++i) {
+      Rendezvous::Args args;
+      TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                                 V(1.0), false));
+      TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args,
+                                 V(1.0), false));
+      TF_ASSERT_OK(Run(rendez_));
+      Tensor out = V(-1);
+      bool is_dead = false;
+      TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args,
+                                 &out, &is_dead));
+      EXPECT_EQ(2.0, V(out));
+    }
+  }
+};
+
+TEST_F(OpLatencySamplingTest, SamplesEveryStep) {
+  CellReader<Histogram> op_latency(kOpLatencyMetric);
+  RunAdd("1", /*num_steps=*/3);
+  // Add and _Send are sync kernels, _Recv is async.
+  EXPECT_FLOAT_EQ(op_latency.Delta("Add").num(), 3.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Send").num(), 3.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Recv").num(), 6.0);
+}
+
+TEST_F(OpLatencySamplingTest, SamplesOneOfEveryNSteps) {
+  CellReader<Histogram> op_latency(kOpLatencyMetric);
+  RunAdd("2", /*num_steps=*/4);
+  EXPECT_FLOAT_EQ(op_latency.Delta("Add").num(), 2.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Recv").num(), 4.0);
+}
+
+TEST_F(OpLatencySamplingTest, RecordsNothingByDefault) {
+  CellReader<Histogram> op_latency(kOpLatencyMetric);
+  RunAdd(nullptr, /*num_steps=*/3);
+  EXPECT_FLOAT_EQ(op_latency.Delta("Add").num(), 0.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Send").num(), 0.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Recv").num(), 0.0);
+}
+
+TEST_F(OpLatencySamplingTest, RecordsNothingWhenZero) {
+  CellReader<Histogram> op_latency(kOpLatencyMetric);
+  RunAdd("0", /*num_steps=*/3);
+  EXPECT_FLOAT_EQ(op_latency.Delta("Add").num(), 0.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("_Recv").num(), 0.0);
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -266,6 +343,23 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -301,6 +395,23 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
     rendez->Unref();
   }
 }
+
+TEST_F(ExecutorTest, ConcurrentAddAssignWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
 #endif
 
 TEST_F(ExecutorTest, SimpleSwitchLive) {
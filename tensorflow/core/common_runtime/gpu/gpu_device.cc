@@ -34,6 +34,7 @@ limitations under the License.
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -42,6 +43,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_split.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -52,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -60,8 +64,10 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -99,6 +105,7 @@ limitations under the License.
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
 #endif  // TF_GPU_USE_PJRT
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -281,6 +288,151 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   void operator=(const EigenGpuStreamDevice&) = delete;
 };
 
+// Defers the deallocations of the GPU allocator, and the release of the inputs
+// of ops, until all the compute streams of the device completed the work
+// enqueued so far. With several compute streams, the memory an op freed or
+// released may otherwise be handed to an op of another stream, by the
+// allocator or by forwarding, while the work of the op still accesses it.
+//
+// Releases are batched: at most one event per stream is pending at a time.
+class MultiStreamAllocator : public AllocatorWrapper {
+ public:
+  MultiStreamAllocator(Allocator* wrapped, EventMgr* em)
+      : AllocatorWrapper(wrapped), em_(em) {}
+
+  void SetStreams(std::vector<se::Stream*> streams) {
+    mutex_lock l(mu_);
+    streams_ = std::move(streams);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr == nullptr) return;
+    mutex_lock l(mu_);
+    pending_ptrs_.push_back(ptr);
+    if (!flushing_) FlushLocked();
+  }
+
+  void Retain(TensorReferenceVector tensors) {
+    mutex_lock l(mu_);
+    for (TensorReference& tensor : tensors) {
+      pending_tensors_.push_back(std::move(tensor));
+    }
+    if (!flushing_) FlushLocked();
+  }
+
+  std::optional<AllocatorStats> GetStats() override {
+    return wrapped()->GetStats();
+  }
+
+  bool ClearStats() override { return wrapped()->ClearStats(); }
+
+ private:
+  struct Batch {
+    std::vector<void*> ptrs;
+    TensorReferenceVector tensors;
+    std::atomic<int> num_pending_streams;
+  };
+
+  void FlushLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    flushing_ = true;
+    Batch* batch = new Batch;
+    batch->ptrs.swap(pending_ptrs_);
+    batch->tensors.swap(pending_tensors_);
+    batch->num_pending_streams = streams_.size();
+    for (se::Stream* stream : streams_) {
+      em_->ThenExecute(stream, [this, batch]() {
+        if (--batch->num_pending_streams == 0) Release(batch);
+      });
+    }
+  }
+
+  void Release(Batch* batch) TF_LOCKS_EXCLUDED(mu_) {
+    for (void* ptr : batch->ptrs) {
+      wrapped()->DeallocateRaw(ptr);
+    }
+    // May deallocate, and so defer, the buffers of the tensors.
+    for (const TensorReference& tensor : batch->tensors) {
+      tensor.Unref();
+    }
+    delete batch;
+    mutex_lock l(mu_);
+    flushing_ = false;
+    if (!pending_ptrs_.empty() || !pending_tensors_.empty()) FlushLocked();
+  }
+
+  EventMgr* const em_;
+  mutex mu_;
+  std::vector<se::Stream*> streams_ TF_GUARDED_BY(mu_);
+  // Whether a batch waits for the streams.
+  bool flushing_ TF_GUARDED_BY(mu_) = false;
+  std::vector<void*> pending_ptrs_ TF_GUARDED_BY(mu_);
+  TensorReferenceVector pending_tensors_ TF_GUARDED_BY(mu_);
+};
+
+namespace {
+
+// Maximum value of TF_GPU_COMPUTE_STREAMS.
+constexpr int64_t kMaxComputeStreams = 8;
+
+// Returns the MultiStreamAllocator of the GPU `tf_device_id`, wrapping
+// `gpu_allocator`. Like the streams, it is shared by all the devices of the GPU
+// and never deleted, since tensors may outlive the devices.
+MultiStreamAllocator* GetMultiStreamAllocator(tsl::TfDeviceId tf_device_id,
+                                              Allocator* gpu_allocator,
+                                              EventMgr* em) {
+  static mutex* mu = new mutex;
+  static auto* allocators =
+      new absl::flat_hash_map<int, MultiStreamAllocator*>();
+  mutex_lock l(*mu);
+  MultiStreamAllocator*& allocator = (*allocators)[tf_device_id.value()];
+  if (allocator == nullptr) {
+    allocator = new MultiStreamAllocator(gpu_allocator, em);
+  }
+  return allocator;
+}
+
+// Counts the live GPU devices using each GPUOptions.Experimental
+// autotune_results_path, to load the autotune results when the first one is
+// created and save them when the last one is destroyed.
+struct AutotuneResultsUsers {
+  mutex mu;
+  absl::flat_hash_map<std::string, int> num_devices TF_GUARDED_BY(mu);
+};
+
+AutotuneResultsUsers* GetAutotuneResultsUsers() {
+  static auto* users = new AutotuneResultsUsers;
+  return users;
+}
+
+void AddAutotuneResultsUser(const std::string& path) {
+  AutotuneResultsUsers* users = GetAutotuneResultsUsers();
+  mutex_lock l(users->mu);
+  if (users->num_devices[path]++ > 0) return;
+  Status s = LoadAutotuneMapsFromFile(path);
+  if (s.ok()) {
+    LOG(INFO) << "Loaded autotune results from " << path;
+  } else if (!errors::IsNotFound(s)) {
+    LOG(WARNING) << "Failed to load autotune results from " << path << ": "
+                 << s;
+  }
+}
+
+void RemoveAutotuneResultsUser(const std::string& path) {
+  AutotuneResultsUsers* users = GetAutotuneResultsUsers();
+  mutex_lock l(users->mu);
+  if (--users->num_devices[path] > 0) return;
+  users->num_devices.erase(path);
+  Status s = SaveAutotuneMapsToFile(path);
+  if (s.ok()) {
+    VLOG(1) << "Saved autotune results to " << path;
+  } else {
+    LOG(WARNING) << "Failed to save autotune results to " << path << ": "
+                 << s;
+  }
+}
+
+}  // namespace
+
 // This factory helps to ensure that different GPU device objects that refer to
 // the same physical device and stream group id use the same stream group
 // object (and therefore the same CUDA streams). This is necessary since there
@@ -356,6 +508,26 @@ class BaseGPUDevice::StreamGroupFactory {
     return group;
   }
 
+  // Returns the compute stream of the stream group {tf_device_id,
+  // stream_group_within_gpu}, creating it if it does not yet exist. Unlike
+  // GetOrCreate(), doesn't create the copy streams of the group.
+  // This function is thread safe.
+  se::Stream* GetOrCreateComputeStream(tsl::TfDeviceId tf_device_id,
+                                       int stream_group_within_gpu,
+                                       se::StreamExecutor* executor,
+                                       const GPUOptions& options) {
+    mutex_lock guard(lock_);
+    StreamGroup* group =
+        &streams_[key_type(tf_device_id.value(), stream_group_within_gpu)];
+    if (!group->compute) {
+      group->priority = GetPriority(tf_device_id.value(), options);
+      group->compute = GetInitializedStream(executor, group->priority);
+      VLOG(2) << "Created compute stream[" << stream_group_within_gpu
+              << "] = " << group->compute;
+    }
+    return group->compute;
+  }
+
   // Returns a reference to the StreamGroupFactory singleton. Note that this is
   // never destroyed, so the objects it owns are never deleted.
   static StreamGroupFactory& Global() {
@@ -477,15 +649,20 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 }
 
 BaseGPUDevice::~BaseGPUDevice() {
+  if (!autotune_results_path_.empty()) {
+    RemoveAutotuneResultsUser(autotune_results_path_);
+  }
   delete accelerator_device_info_;
-  if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
+  for (char* scratch : scratch_) {
+    gpu_allocator_->DeallocateRaw(scratch);
+  }
   device_context_->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
+  while (scratch_.size() < compute_streams_.size()) {
     DCHECK(stream_);
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
@@ -500,7 +677,7 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_.push_back(static_cast<char*>(scratch_buffer));
   }
   return OkStatus();
 }
@@ -590,6 +767,7 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         tracker_params, Env::Default(), stream_->compute, timing_counter,
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
+  TF_RETURN_IF_ERROR(InitComputeStreams(options));
 
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
@@ -662,9 +840,123 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
     LOG(INFO) << "Writing NodeDefs to file: " << node_file_writer_->filename();
   }
 
+  const string& autotune_results_path =
+      options.config.gpu_options().experimental().autotune_results_path();
+  if (!autotune_results_path.empty()) {
+    AddAutotuneResultsUser(autotune_results_path);
+    autotune_results_path_ = autotune_results_path;
+  }
+
+  return OkStatus();
+}
+
+Status BaseGPUDevice::InitComputeStreams(const SessionOptions& options) {
+  compute_streams_ = {stream_->compute};
+  device_context_->Ref();
+  stream_device_contexts_.emplace_back(device_context_);
+
+  // Running independent ops on several compute streams lets them use the SMs
+  // each other leaves idle, e.g. for the towers of multi-tower models.
+  int64_t num_compute_streams = 1;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_GPU_COMPUTE_STREAMS", 1,
+                                         &num_compute_streams));
+  if (num_compute_streams < 1 || num_compute_streams > kMaxComputeStreams) {
+    return errors::InvalidArgument("TF_GPU_COMPUTE_STREAMS must be in [1, ",
+                                   kMaxComputeStreams,
+                                   "], got: ", num_compute_streams);
+  }
+  if (num_compute_streams == 1) return OkStatus();
+#ifdef TF_GPU_USE_PJRT
+  LOG(WARNING) << "Ignoring TF_GPU_COMPUTE_STREAMS, which is not supported "
+               << "with PJRT.";
+#else
+  if (kernel_tracker_ != nullptr) {
+    LOG(WARNING) << "Ignoring TF_GPU_COMPUTE_STREAMS, since the kernel "
+                 << "tracker only tracks one compute stream.";
+    return OkStatus();
+  }
+  for (int i = 1; i < num_compute_streams; ++i) {
+    se::Stream* stream = StreamGroupFactory::Global().GetOrCreateComputeStream(
+        tf_device_id_, i, executor_, options.config.gpu_options());
+    if (stream == nullptr) {
+      return errors::Internal("Failed to create compute stream ", i,
+                              " of GPU ", tf_device_id_.value());
+    }
+    compute_streams_.push_back(stream);
+    stream_device_contexts_.emplace_back(NewDeviceContext(i));
+  }
+  multi_stream_allocator_ =
+      GetMultiStreamAllocator(tf_device_id_, gpu_allocator_, em_);
+  multi_stream_allocator_->SetStreams(compute_streams_);
+  gpu_allocator_ = multi_stream_allocator_;
+  VLOG(1) << "Using " << num_compute_streams << " compute streams on GPU "
+          << tf_device_id_.value();
+#endif  // TF_GPU_USE_PJRT
+  return OkStatus();
+}
+
+GPUDeviceContext* BaseGPUDevice::NewDeviceContext(int stream_id) const {
+  return new GPUDeviceContext(stream_id, compute_streams_[stream_id],
+#if TENSORFLOW_USE_ROCM
+                              stream_->nccl,
+#endif
+                              stream_->host_to_device, stream_->device_to_host,
+                              stream_->device_to_device,
+                              device_context_->host_memory_allocator());
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (compute_streams_.size() <= 1) return OkStatus();
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = compute_streams_.size();
+  std::vector<int> stream_ids;
+  TF_RETURN_IF_ERROR(gpu_stream_util::AssignStreams(*graph, opts, &stream_ids));
+  if (absl::c_all_of(stream_ids, [](int id) { return id <= 0; })) {
+    return OkStatus();
+  }
+
+  device_context_map->assign(graph->num_node_ids(), nullptr);
+  for (const Node* n : graph->nodes()) {
+    const int stream_id = stream_ids[n->id()];
+    if (stream_id < 0) continue;
+    // The inputs computed on other streams, by data or control edges.
+    gtl::InlinedVector<se::Stream*, 2> input_streams;
+    for (const Edge* e : n->in_edges()) {
+      const int input_stream_id = stream_ids[e->src()->id()];
+      if (input_stream_id < 0 || input_stream_id == stream_id) continue;
+      se::Stream* input_stream = compute_streams_[input_stream_id];
+      if (!absl::c_linear_search(input_streams, input_stream)) {
+        input_streams.push_back(input_stream);
+      }
+    }
+    GPUDeviceContext* device_context;
+    if (input_streams.empty()) {
+      device_context = stream_device_contexts_[stream_id].get();
+      device_context->Ref();
+    } else {
+      device_context = NewDeviceContext(stream_id);
+      device_context->set_input_streams(std::move(input_streams));
+    }
+    (*device_context_map)[n->id()] = device_context;
+    VLOG(2) << "Assigned " << n->name() << " to stream[" << stream_id << "]";
+  }
   return OkStatus();
 }
 
+void BaseGPUDevice::RetainInputs(OpKernelContext* context) {
+  TensorReferenceVector inputs;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (context->has_input(i) && !IsRefType(context->input_dtype(i)) &&
+        context->input_memory_type(i) == DEVICE_MEMORY) {
+      inputs.emplace_back(context->input(i));
+    }
+  }
+  if (!inputs.empty()) {
+    multi_stream_allocator_->Retain(std::move(inputs));
+  }
+}
+
 string BaseGPUDevice::ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                                  const int& stream_id) {
   return strings::StrCat(op_kernel.name(), " op ", op_kernel.type_string(),
@@ -789,6 +1081,9 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     }
   }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  for (se::Stream* input_stream : gpu_device_context->input_streams()) {
+    OP_REQUIRES_OK(context, stream->WaitFor(input_stream));
+  }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel->name_view().data(), context->step_id());
   bool should_log_inputs_and_outputs = ShouldLogInputsAndOutputs(op_kernel);
@@ -798,6 +1093,9 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
 
   op_kernel->Compute(context);
+  if (multi_stream_allocator_ != nullptr) {
+    RetainInputs(context);
+  }
 
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
@@ -848,11 +1146,14 @@ Status BaseGPUDevice::Sync() {
 
   // Device::Sync is supposed to block until all operations queued on the device
   // at the time of the call have completed.  On GPUs, only operations enqueued
-  // on the compute stream can remain pending after the (Async)OpKernel that
+  // on the compute streams can remain pending after the (Async)OpKernel that
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  for (se::Stream* stream : compute_streams_) {
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+  }
+  return OkStatus();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -883,6 +1184,15 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  for (se::Stream* input_stream : gpu_device_context->input_streams()) {
+    OP_REQUIRES_OK_ASYNC(context, stream->WaitFor(input_stream), done);
+  }
+  if (multi_stream_allocator_ != nullptr) {
+    done = [this, context, done = std::move(done)]() {
+      RetainInputs(context);
+      done();
+    };
+  }
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
@@ -1287,11 +1597,11 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_LT(stream_id, compute_streams_.size());
   const gpuStream_t gpu_stream = reinterpret_cast<gpuStream_t>(
-      stream_->compute->platform_specific_handle().stream);
+      compute_streams_[stream_id]->platform_specific_handle().stream);
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1308,7 +1618,7 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
+    CHECK_LT(stream_id, static_cast<int>(compute_streams_.size()));
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -54,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -68,6 +69,7 @@ class StreamInterface;
 
 namespace tensorflow {
 class GPUKernelTracker;
+class MultiStreamAllocator;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
  public:
@@ -124,6 +126,12 @@ class BaseGPUDevice : public LocalDevice {
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
+  // Spreads the nodes of `graph` over the compute streams of the device when
+  // it has several, see TF_GPU_COMPUTE_STREAMS.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   Status MakeTensorFromProto(const TensorProto& tensor_proto,
                              AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
@@ -194,9 +202,18 @@ class BaseGPUDevice : public LocalDevice {
 
   core::RefCountPtr<DeviceContext> pjrt_device_context_;
   StreamGroup* stream_;
+  // The compute streams ops run on, indexed by stream id. The first is the
+  // compute stream of `stream_`.
+  std::vector<se::Stream*> compute_streams_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The Eigen scratch buffer of each compute stream.
+  std::vector<char*> scratch_;
   GPUDeviceContext* device_context_;
+  // The context of the ops without inputs from other streams, for each
+  // compute stream. The first is `device_context_`.
+  std::vector<core::RefCountPtr<GPUDeviceContext>> stream_device_contexts_;
+  // Set when running ops on several compute streams. Not owned.
+  MultiStreamAllocator* multi_stream_allocator_ = nullptr;
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
@@ -207,6 +224,8 @@ class BaseGPUDevice : public LocalDevice {
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
+  // GPUOptions.Experimental.autotune_results_path, if set.
+  std::string autotune_results_path_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -214,6 +233,18 @@ class BaseGPUDevice : public LocalDevice {
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
+  // Creates the compute streams beyond the first and the state shared by the
+  // ops running on them.
+  Status InitComputeStreams(const SessionOptions& options);
+
+  // Returns a new context for ops running on the compute stream `stream_id`.
+  GPUDeviceContext* NewDeviceContext(int stream_id) const;
+
+  // Keeps the device memory inputs of the op of `context` alive until all the
+  // compute streams completed the work enqueued so far, so that their buffers
+  // are neither freed nor forwarded to other ops while the op reads them.
+  void RetainInputs(OpKernelContext* context);
+
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
 
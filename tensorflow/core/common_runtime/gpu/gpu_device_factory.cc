@@ -122,21 +122,25 @@ class GPUCompatibleCPUDeviceFactory : public DeviceFactory {
 
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
-    int n = 1;
+    const bool use_numa_affinity =
+        options.config.experimental().use_numa_affinity();
+    int num_numa_nodes = use_numa_affinity ? port::NUMANumNodes() : 1;
+    // With NUMA affinity, default to one device per NUMA node.
+    int n = num_numa_nodes;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
-    int num_numa_nodes = options.config.experimental().use_numa_affinity()
-                             ? port::NUMANumNodes()
-                             : 1;
+    if (use_numa_affinity && port::NUMAEnabled()) {
+      ProcessState::singleton()->EnableNUMA();
+    }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
       int numa_node = i % num_numa_nodes;
       DeviceLocality locality;
       locality.set_numa_node(numa_node);
       devices->push_back(absl::make_unique<GPUCompatibleCPUDevice>(
-          options, name, Bytes(256 << 20), DeviceLocality(),
+          options, name, Bytes(256 << 20), locality,
           ProcessState::singleton()->GetCPUAllocator(numa_node)));
     }
 
@@ -21,6 +21,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 
+#include <optional>
+
 #include "xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
@@ -216,6 +218,39 @@ TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncPreallocate)) {
   EXPECT_EQ(status.code(), error::OK);
 }
 
+TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncAllocatorType)) {
+  SessionOptions opts = MakeSessionOptions("0", 0, 1);
+  GPUOptions* gpu_options = opts.config.mutable_gpu_options();
+  gpu_options->set_allocator_type("cuda_malloc_async");
+  gpu_options->mutable_experimental()
+      ->set_cuda_malloc_async_release_threshold_bytes(1 << 20);
+  std::vector<std::unique_ptr<Device>> devices;
+  int number_instantiated =
+      se::GpuCudaMallocAsyncAllocator::GetInstantiatedCountTestOnly();
+  {  // The new scope is to trigger the destruction of the object.
+    TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+        opts, kDeviceNamePrefix, &devices));
+    EXPECT_THAT(devices, SizeIs(1));
+
+    AllocatorAttributes allocator_attributes = AllocatorAttributes();
+    allocator_attributes.set_gpu_compatible(true);
+    Allocator* allocator = devices[0]->GetAllocator(allocator_attributes);
+    void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+    EXPECT_NE(ptr, nullptr);
+    std::optional<AllocatorStats> stats = allocator->GetStats();
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->bytes_in_use, 1024);
+#if CUDA_VERSION >= 11030
+    ASSERT_TRUE(stats->pool_bytes.has_value());
+    EXPECT_GE(*stats->pool_bytes, 1024);
+    EXPECT_GE(*stats->peak_pool_bytes, *stats->pool_bytes);
+#endif
+    allocator->DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(number_instantiated + 1,
+            se::GpuCudaMallocAsyncAllocator::GetInstantiatedCountTestOnly());
+}
+
 TEST_F(GPUDeviceTest, FailedToParseVisibleDeviceList) {
   SessionOptions opts = MakeSessionOptions("0,abc");
   std::vector<std::unique_ptr<Device>> devices;
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/stream_executor/command_buffer.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+GpuGraphCache::GpuGraphCache(Options options) : options_(std::move(options)) {
+  DCHECK_GT(options_.capacity, 0);
+}
+
+absl::Status GpuGraphCache::Run(const GpuGraphKey& key, se::Stream* stream,
+                                EnqueueFn enqueue) {
+  mutex_lock l(mu_);
+  Entry& entry = GetEntry(key);
+  entry.last_run = ++num_runs_;
+  if (entry.graph != nullptr) {
+    ++stats_.num_replays;
+    return stream->parent()->Submit(stream, *entry.graph);
+  }
+  if (entry.uncapturable || entry.num_runs++ < options_.num_warmup_runs) {
+    return enqueue(stream);
+  }
+
+  // Captures on a new stream, on which nothing runs: the work is only
+  // executed when the graph is submitted.
+  absl::StatusOr<std::unique_ptr<se::CommandBuffer>> graph =
+      se::CommandBuffer::Trace(
+          stream->parent(),
+          [&enqueue](se::Stream* trace_stream) {
+            return enqueue(trace_stream);
+          },
+          se::CommandBuffer::Mode::kPrimary);
+  if (!graph.ok()) {
+    VLOG(1) << "Running GPU work directly as it can't be captured: "
+            << graph.status();
+    ++stats_.num_fallbacks;
+    entry.uncapturable = true;
+    return enqueue(stream);
+  }
+  ++stats_.num_captures;
+  entry.graph = *std::move(graph);
+  return stream->parent()->Submit(stream, *entry.graph);
+}
+
+GpuGraphCache::Stats GpuGraphCache::stats() const {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+GpuGraphCache::Entry& GpuGraphCache::GetEntry(const GpuGraphKey& key) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    return it->second;
+  }
+  if (static_cast<int64_t>(entries_.size()) >= options_.capacity) {
+    auto lru = std::min_element(entries_.begin(), entries_.end(),
+                                [](const auto& a, const auto& b) {
+                                  return a.second.last_run < b.second.last_run;
+                                });
+    entries_.erase(lru);
+  }
+  return entries_[key];
+}
+
+}  // namespace tensorflow
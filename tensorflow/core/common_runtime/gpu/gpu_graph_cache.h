@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "xla/stream_executor/command_buffer.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Identifies the GPU work captured into a graph: everything the work depends
+// on that a replay can't change, typically the shapes of its inputs and the
+// addresses of all the device buffers it reads or writes.
+class GpuGraphKey {
+ public:
+  void AddValue(int64_t value) { values_.push_back(value); }
+
+  void AddBuffer(const void* buffer) {
+    values_.push_back(reinterpret_cast<intptr_t>(buffer));
+  }
+
+  void AddShape(const TensorShape& shape) {
+    values_.push_back(shape.dims());
+    for (int64_t dim : shape.dim_sizes()) {
+      values_.push_back(dim);
+    }
+  }
+
+  bool operator==(const GpuGraphKey& other) const {
+    return values_ == other.values_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const GpuGraphKey& key) {
+    return H::combine(std::move(h), key.values_);
+  }
+
+ private:
+  std::vector<int64_t> values_;
+};
+
+// Captures the GPU work enqueued by a function into a CUDA graph (a
+// `se::CommandBuffer`) and then replays the graph instead of calling the
+// function again, which removes the launch overhead of the individual kernels.
+// That overhead dominates the latency of small-batch inference.
+//
+// The function captured is called on a dedicated stream, so that no other work
+// of the device ends up in the graph, and must enqueue all its work on the
+// stream it is given. The function must also be safe to call again on the
+// stream of `Run` when the capture fails, e.g. because the work synchronizes
+// with the host. The work of such a key then always runs directly.
+//
+// The graph of a key is only valid for as long as the buffers in the key are
+// owned by the caller; callers that reuse buffers for other purposes must
+// include everything identifying the work in the key.
+//
+// This class is thread-safe. Calls are serialized.
+class GpuGraphCache {
+ public:
+  struct Options {
+    // Number of times the work of a key runs directly before being captured,
+    // so that one-off buffers and lazy initialization (e.g. autotuning) don't
+    // end up in graphs.
+    int num_warmup_runs = 1;
+    // Maximum number of keys tracked. The least recently run is evicted.
+    int capacity = 16;
+  };
+
+  struct Stats {
+    int64_t num_captures = 0;
+    int64_t num_replays = 0;
+    // Number of failed captures, after which the work ran directly.
+    int64_t num_fallbacks = 0;
+  };
+
+  using EnqueueFn = absl::FunctionRef<absl::Status(se::Stream*)>;
+
+  explicit GpuGraphCache(Options options);
+  GpuGraphCache() : GpuGraphCache(Options()) {}
+
+  // Enqueues the work of `enqueue` for `key` on `stream`, by replaying its
+  // graph if it was captured and otherwise by calling `enqueue`, capturing its
+  // work once `key` was run `num_warmup_runs` times.
+  absl::Status Run(const GpuGraphKey& key, se::Stream* stream,
+                   EnqueueFn enqueue) TF_LOCKS_EXCLUDED(mu_);
+
+  Stats stats() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    int64_t num_runs = 0;
+    int64_t last_run = 0;
+    // Whether capturing the work failed.
+    bool uncapturable = false;
+    std::unique_ptr<se::CommandBuffer> graph;
+  };
+
+  // Returns the entry of `key`, evicting the least recently run one to make
+  // room for it if needed.
+  Entry& GetEntry(const GpuGraphKey& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+  mutable mutex mu_;
+  absl::flat_hash_map<GpuGraphKey, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t num_runs_ TF_GUARDED_BY(mu_) = 0;
+  Stats stats_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CACHE_H_
@@ -0,0 +1,155 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumElements = 256;
+
+class GpuGraphCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executor_ = se::GPUMachineManager()->ExecutorForDevice(0).value();
+    TF_ASSERT_OK_AND_ASSIGN(stream_, executor_->CreateStream());
+    buffer_ = executor_->AllocateArray<uint32_t>(kNumElements);
+    ASSERT_FALSE(buffer_.is_null());
+  }
+
+  void TearDown() override { executor_->Deallocate(&buffer_); }
+
+  // Runs a memset of the buffer with `pattern` through `cache`.
+  absl::Status RunMemset(GpuGraphCache& cache, uint32_t pattern) {
+    GpuGraphKey key;
+    key.AddBuffer(buffer_.opaque());
+    return cache.Run(key, stream_.get(), [&](se::Stream* stream) {
+      ++num_calls_;
+      return stream->Memset32(&buffer_, pattern, buffer_.size());
+    });
+  }
+
+  // Returns the value of the first element of the buffer.
+  uint32_t ReadBuffer() {
+    TF_CHECK_OK(stream_->BlockHostUntilDone());
+    std::vector<uint32_t> values(kNumElements);
+    TF_CHECK_OK(executor_->SynchronousMemcpyD2H(buffer_, buffer_.size(),
+                                                values.data()));
+    for (uint32_t value : values) {
+      EXPECT_EQ(value, values[0]);
+    }
+    return values[0];
+  }
+
+  se::StreamExecutor* executor_;
+  std::unique_ptr<se::Stream> stream_;
+  se::DeviceMemory<uint32_t> buffer_;
+  int num_calls_ = 0;
+};
+
+TEST(GpuGraphKeyTest, Equality) {
+  GpuGraphKey a, b, c;
+  for (GpuGraphKey* key : {&a, &b, &c}) {
+    key->AddShape(TensorShape({2, 3}));
+    key->AddValue(7);
+  }
+  int buffer;
+  a.AddBuffer(&buffer);
+  b.AddBuffer(&buffer);
+  c.AddBuffer(&buffer + 1);
+  EXPECT_EQ(a, b);
+  EXPECT_FALSE(a == c);
+
+  GpuGraphKey d, e;
+  d.AddShape(TensorShape({2, 3}));
+  e.AddShape(TensorShape({2}));
+  e.AddValue(3);
+  EXPECT_FALSE(d == e);
+  EXPECT_EQ(absl::flat_hash_set<GpuGraphKey>({a, b, c}).size(), 2);
+}
+
+TEST_F(GpuGraphCacheTest, CapturesAfterWarmupAndReplays) {
+  GpuGraphCache cache;
+  TF_ASSERT_OK(RunMemset(cache, 1));
+  EXPECT_EQ(ReadBuffer(), 1u);
+  EXPECT_EQ(num_calls_, 1);
+  EXPECT_EQ(cache.stats().num_captures, 0);
+
+  TF_ASSERT_OK(RunMemset(cache, 2));
+  EXPECT_EQ(ReadBuffer(), 2u);
+  EXPECT_EQ(cache.stats().num_captures, 1);
+
+  // The replay runs the captured work without calling the function.
+  TF_ASSERT_OK(stream_->MemZero(&buffer_, buffer_.size()));
+  TF_ASSERT_OK(RunMemset(cache, 3));
+  EXPECT_EQ(ReadBuffer(), 2u);
+  EXPECT_EQ(num_calls_, 2);
+  EXPECT_EQ(cache.stats().num_replays, 1);
+}
+
+TEST_F(GpuGraphCacheTest, FallsBackWhenCaptureFails) {
+  GpuGraphCache cache(GpuGraphCache::Options{/*num_warmup_runs=*/0});
+  GpuGraphKey key;
+  key.AddBuffer(buffer_.opaque());
+  for (uint32_t pattern : {4u, 5u}) {
+    TF_ASSERT_OK(cache.Run(key, stream_.get(), [&](se::Stream* stream) {
+      ++num_calls_;
+      TF_RETURN_IF_ERROR(stream->Memset32(&buffer_, pattern, buffer_.size()));
+      // Synchronizing with the host is not allowed while capturing.
+      return stream->BlockHostUntilDone();
+    }));
+    EXPECT_EQ(ReadBuffer(), pattern);
+  }
+  // The failed capture, then the direct runs.
+  EXPECT_EQ(num_calls_, 3);
+  EXPECT_EQ(cache.stats().num_fallbacks, 1);
+  EXPECT_EQ(cache.stats().num_captures, 0);
+}
+
+TEST_F(GpuGraphCacheTest, EvictsLeastRecentlyRun) {
+  GpuGraphCache cache(
+      GpuGraphCache::Options{/*num_warmup_runs=*/0, /*capacity=*/1});
+  TF_ASSERT_OK(RunMemset(cache, 6));
+  EXPECT_EQ(cache.stats().num_captures, 1);
+
+  GpuGraphKey other_key;
+  other_key.AddValue(1);
+  TF_ASSERT_OK(cache.Run(other_key, stream_.get(), [](se::Stream* stream) {
+    return absl::OkStatus();
+  }));
+
+  TF_ASSERT_OK(RunMemset(cache, 7));
+  EXPECT_EQ(ReadBuffer(), 7u);
+  EXPECT_EQ(cache.stats().num_captures, 3);
+  EXPECT_EQ(cache.stats().num_replays, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
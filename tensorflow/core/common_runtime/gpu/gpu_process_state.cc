@@ -21,9 +21,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -142,7 +144,8 @@ Allocator* GPUProcessState::GetGPUAllocator(
   AllocatorParts& allocator_parts = gpu_allocators_[tf_device_id.value()];
   if (allocator_parts.allocator == nullptr) {
     // Validate allocator types.
-    if (!allocator_type.empty() && allocator_type != "BFC") {
+    if (!allocator_type.empty() && allocator_type != "BFC" &&
+        allocator_type != "cuda_malloc_async") {
       LOG(ERROR) << "Invalid allocator type: " << allocator_type;
       return nullptr;
     }
@@ -194,7 +197,8 @@ Allocator* GPUProcessState::GetGPUAllocator(
       gpu_bfc_allocator.reset();
       gpu_allocator = new GPUcudaMallocAllocator(platform_device_id);
     } else if (UseCudaMallocAsyncAllocator() ||
-               options.experimental().use_cuda_malloc_async()) {
+               options.experimental().use_cuda_malloc_async() ||
+               allocator_type == "cuda_malloc_async") {
       LOG(INFO) << "Using CUDA malloc Async allocator for GPU: "
                 << platform_device_id;
       // If true, passes all allocation requests through to cudaMallocAsync
@@ -202,8 +206,13 @@ Allocator* GPUProcessState::GetGPUAllocator(
       // compute-sanitizer.
       // TODO: **WARNING** probably will not work in a multi-gpu scenario
       gpu_bfc_allocator.reset();
-      gpu_allocator =
-          new se::GpuCudaMallocAsyncAllocator(platform_device_id, total_bytes);
+      const int64_t release_threshold =
+          options.experimental().cuda_malloc_async_release_threshold_bytes();
+      gpu_allocator = new se::GpuCudaMallocAsyncAllocator(
+          platform_device_id, total_bytes, /*reserve_memory=*/false,
+          /*compute_stats=*/true,
+          release_threshold > 0 ? std::optional<size_t>(release_threshold)
+                                : std::nullopt);
     }
 
     Allocator* recording_allocator = nullptr;
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_scheduling_metrics_storage.h"
 #include "tsl/framework/serving_device_selector.h"
 
@@ -52,8 +53,20 @@ GpuServingDeviceSelector::GpuServingDeviceSelector(
 tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
     absl::string_view program_fingerprint) {
   absl::MutexLock lock(&mu_);
+  const int64_t now_ns = NowNs();
+  // Lets load-aware policies compare the queued work of the devices.
+  absl::FixedArray<int64_t, 8> estimated_time_till_idle_ns(
+      device_states_.size());
+  for (int i = 0; i < device_states_.size(); ++i) {
+    estimated_time_till_idle_ns[i] =
+        ServingDeviceSelector::EstimateTimeTillIdleNs(
+            device_states_[i], 0, min_exec_time_.value_or(kDefaultEstimateNs),
+            now_ns);
+  }
   DeviceStates device_states;
   device_states.states = absl::Span<const DeviceState>(device_states_);
+  device_states.estimated_time_till_idle_ns =
+      absl::Span<const int64_t>(estimated_time_till_idle_ns);
   auto [it, emplaced] =
       execution_info_.try_emplace(program_fingerprint, ExecutionInfo());
   const int device_index =
@@ -62,7 +75,7 @@ tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
   ServingDeviceSelector::EnqueueHelper(
       device_states_.at(device_index), device_index, it->second,
       program_fingerprint, /*priority=*/0, req_id_counter_++,
-      /*priority_queue_count=*/1, /*prefetch_results=*/0, NowNs());
+      /*priority_queue_count=*/1, /*prefetch_results=*/0, now_ns);
 
   return tsl::DeviceReservation(device_index, this);
 }
@@ -135,6 +135,39 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, LeastExpectedCompletionTimePolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2,
+      std::make_unique<tsl::LeastExpectedCompletionTimePolicy>());
+  // Record the execution times of a heavy program on device 0 and a light
+  // program on device 1. Only back-to-back runs are timed.
+  selector.Enqueue(0, "8ms");
+  selector.Enqueue(0, "8ms");
+  selector.Enqueue(1, "3ms");
+  selector.Enqueue(1, "3ms");
+  helper.ElapseNs(3e6);
+  selector.Completed(1);
+  helper.ElapseNs(3e6);
+  selector.Completed(1);
+  helper.ElapseNs(2e6);
+  selector.Completed(0);
+  helper.ElapseNs(8e6);
+  selector.Completed(0);
+
+  // While device 0 runs the heavy program, the light programs go to device 1
+  // until its queue takes longer than the heavy program.
+  selector.Enqueue(0, "8ms");
+  tsl::DeviceReservation reservation_0 = selector.ReserveDevice("3ms");
+  EXPECT_EQ(reservation_0.device_index(), 1);
+  tsl::DeviceReservation reservation_1 = selector.ReserveDevice("3ms");
+  EXPECT_EQ(reservation_1.device_index(), 1);
+  tsl::DeviceReservation reservation_2 = selector.ReserveDevice("3ms");
+  EXPECT_EQ(reservation_2.device_index(), 1);
+  tsl::DeviceReservation reservation_3 = selector.ReserveDevice("3ms");
+  EXPECT_EQ(reservation_3.device_index(), 0);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
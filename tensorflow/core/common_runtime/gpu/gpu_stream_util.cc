@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+bool HasOpInput(const Node* n) {
+  for (const Edge* e : n->in_edges()) {
+    if (e->src()->IsOp()) return true;
+  }
+  return false;
+}
+
+bool HasOpConsumer(const Node* n) {
+  for (const Edge* e : n->out_edges()) {
+    if (e->dst()->IsOp()) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph& graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* stream_ids) {
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   opts.max_streams);
+  }
+  stream_ids->assign(graph.num_node_ids(), 0);
+  (*stream_ids)[graph.source_node()->id()] = -1;
+  (*stream_ids)[graph.sink_node()->id()] = -1;
+  if (opts.max_streams == 1) return OkStatus();
+  for (const Node* n : graph.op_nodes()) {
+    // Loops would need the streams of iterations to be joined.
+    if (n->IsControlFlow()) return OkStatus();
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order, NodeComparatorName());
+  // Whether a node already passed its stream on to one of its consumers.
+  std::vector<bool> handed_off(graph.num_node_ids(), false);
+  int next_stream = 1;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    int& stream_id = (*stream_ids)[n->id()];
+    if (!HasOpInput(n) || !HasOpConsumer(n)) {
+      stream_id = 0;
+      continue;
+    }
+    std::vector<const Edge*> inputs;
+    TF_RETURN_IF_ERROR(n->input_edges(&inputs));
+    stream_id = -1;
+    for (const Edge* e : inputs) {
+      const Node* src = e->src();
+      if (src->IsOp() && !handed_off[src->id()]) {
+        handed_off[src->id()] = true;
+        stream_id = (*stream_ids)[src->id()];
+        break;
+      }
+    }
+    if (stream_id == -1) {
+      stream_id = next_stream;
+      next_stream = next_stream % (opts.max_streams - 1) + 1;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // Number of compute streams the nodes are spread over.
+  int max_streams = 1;
+};
+
+// Assigns each node of `graph`, the partition of a single GPU, to one of
+// `opts.max_streams` compute streams, so that independent branches of the
+// graph run concurrently. `stream_ids` is indexed by node id; the source and
+// sink nodes are assigned stream -1.
+//
+// A chain of dependent nodes stays on the stream of its first node, and each
+// branch forking from a node gets the next stream, round-robin. The nodes
+// without inputs or without consumers run on stream 0, so that the work of the
+// graph is ordered after and before that of the rest of the device, which only
+// uses stream 0. Graphs with control flow run on stream 0 only.
+Status AssignStreams(const Graph& graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* stream_ids);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+class AssignStreamsTest : public ::testing::Test {
+ protected:
+  AssignStreamsTest() : graph_(OpRegistry::Global()) {}
+
+  Node* Const() { return test::graph::Constant(&graph_, Tensor(1.0f)); }
+
+  Node* Identity(Node* input) {
+    return test::graph::Identity(&graph_, input);
+  }
+
+  std::vector<int> Assign(int max_streams) {
+    AssignStreamsOpts opts;
+    opts.max_streams = max_streams;
+    std::vector<int> stream_ids;
+    TF_CHECK_OK(AssignStreams(graph_, opts, &stream_ids));
+    EXPECT_EQ(stream_ids.size(), static_cast<size_t>(graph_.num_node_ids()));
+    EXPECT_EQ(stream_ids[graph_.source_node()->id()], -1);
+    EXPECT_EQ(stream_ids[graph_.sink_node()->id()], -1);
+    return stream_ids;
+  }
+
+  Graph graph_;
+};
+
+TEST_F(AssignStreamsTest, SingleStream) {
+  Node* a = Const();
+  Node* b = Identity(a);
+  Node* c = Identity(a);
+  Node* d = test::graph::Binary(&graph_, "Add", b, c);
+  std::vector<int> stream_ids = Assign(1);
+  for (Node* n : {a, b, c, d}) {
+    EXPECT_EQ(stream_ids[n->id()], 0);
+  }
+}
+
+TEST_F(AssignStreamsTest, IndependentBranches) {
+  Node* input = Const();
+  Node* tower0 = Identity(Identity(input));
+  Node* tower1_start = Identity(input);
+  Node* tower1 = Identity(tower1_start);
+  Node* tower2_start = Identity(input);
+  Node* tower2 = Identity(tower2_start);
+  Node* concat = test::graph::Binary(
+      &graph_, "Add", test::graph::Binary(&graph_, "Add", tower0, tower1),
+      tower2);
+  std::vector<int> stream_ids = Assign(3);
+
+  // The graph enters and exits on stream 0.
+  EXPECT_EQ(stream_ids[input->id()], 0);
+  EXPECT_EQ(stream_ids[concat->id()], 0);
+  // Each tower stays on one stream, a different one for each tower.
+  EXPECT_EQ(stream_ids[tower1->id()], stream_ids[tower1_start->id()]);
+  EXPECT_EQ(stream_ids[tower2->id()], stream_ids[tower2_start->id()]);
+  EXPECT_NE(stream_ids[tower0->id()], stream_ids[tower1->id()]);
+  EXPECT_NE(stream_ids[tower0->id()], stream_ids[tower2->id()]);
+  EXPECT_NE(stream_ids[tower1->id()], stream_ids[tower2->id()]);
+}
+
+TEST_F(AssignStreamsTest, BranchesShareStreamsRoundRobin) {
+  Node* input = Const();
+  std::vector<Node*> branches;
+  for (int i = 0; i < 5; ++i) {
+    branches.push_back(Identity(Identity(input)));
+  }
+  Node* output = branches[0];
+  for (size_t i = 1; i < branches.size(); ++i) {
+    output = test::graph::Binary(&graph_, "Add", output, branches[i]);
+  }
+  std::vector<int> stream_ids = Assign(2);
+  for (Node* branch : branches) {
+    EXPECT_GE(stream_ids[branch->id()], 0);
+    EXPECT_LT(stream_ids[branch->id()], 2);
+  }
+  EXPECT_EQ(stream_ids[output->id()], 0);
+}
+
+TEST_F(AssignStreamsTest, InvalidMaxStreams) {
+  Const();
+  AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  std::vector<int> stream_ids;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(AssignStreams(graph_, opts, &stream_ids)));
+}
+
+}  // namespace
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
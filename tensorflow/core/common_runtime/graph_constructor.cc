@@ -107,7 +107,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -162,6 +163,10 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If set, nodes are prepared in parallel on this pool, see
+    // PrepareNodesInParallel(). Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef absl::Span<const NodeDef* const> NodeDefSlice;
@@ -244,6 +249,13 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(std::shared_ptr<NodeProperties> props,
+                  Node::NodeClass node_class, Node** node);
+  // Validates the NodeDefs and makes the properties of their nodes in
+  // parallel on opts_.thread_pool, filling prepared_nodes_ for Convert() to
+  // add the nodes in topological order. Only used when not importing, since
+  // importing modifies each NodeDef based on the nodes before it.
+  void PrepareNodesInParallel();
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -298,7 +310,7 @@ class GraphConstructor {
   virtual const NodeDef& get_node_def(int i) const = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
-  // undefined.
+  // undefined. May be called concurrently for different nodes.
   virtual NodeDef consume_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
@@ -406,6 +418,16 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // A node prepared by PrepareNodesInParallel().
+  struct PreparedNode {
+    Status status;
+    std::shared_ptr<NodeProperties> props;
+    Node::NodeClass node_class = Node::NC_UNINITIALIZED;
+  };
+  // Indexed like node_defs_, and empty unless the nodes were prepared in
+  // parallel.
+  std::vector<PreparedNode> prepared_nodes_;
+
   GraphConstructor(const GraphConstructor&) = delete;
   void operator=(const GraphConstructor&) = delete;
 };
@@ -486,7 +508,8 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a std::vector<bool>, so that nodes can be consumed concurrently.
+  std::vector<uint8_t> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -814,6 +837,42 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   return absl::OkStatus();
 }
 
+Status GraphConstructor::MakeNode(std::shared_ptr<NodeProperties> props,
+                                  Node::NodeClass node_class, Node** node) {
+  *node = g_->AddNode(std::move(props), node_class);
+  if (opts_.expect_device_spec ||
+      (opts_.propagate_device_spec && !(*node)->def().device().empty())) {
+    (*node)->set_assigned_device_name((*node)->def().device());
+  }
+  return absl::OkStatus();
+}
+
+void GraphConstructor::PrepareNodesInParallel() {
+  prepared_nodes_.resize(node_def_count());
+  auto prepare = [this](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      PreparedNode& prepared = prepared_nodes_[i];
+      NodeDef node_def = consume_node_def(i);
+      const OpDef* op_def;
+      prepared.status = g_->op_registry()->LookUpOpDef(node_def.op(), &op_def);
+      if (!prepared.status.ok()) continue;
+      if (opts_.add_default_attributes) {
+        AddDefaultsToNodeDef(*op_def, &node_def);
+      }
+      if (opts_.validate_nodes) {
+        prepared.status = ValidateNodeDef(node_def, *op_def);
+        if (!prepared.status.ok()) continue;
+      }
+      prepared.status = g_->MakeNodeProperties(
+          std::move(node_def), &prepared.props, &prepared.node_class);
+    }
+  };
+  // Validating a NodeDef and inferring its types costs a few microseconds.
+  constexpr int64_t kCostPerNode = 10000;
+  opts_.thread_pool->ParallelFor(prepared_nodes_.size(), kCostPerNode,
+                                 prepare);
+}
+
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return absl::OkStatus();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
@@ -1185,6 +1244,13 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // Below this size, preparing the nodes in parallel isn't worth it.
+  constexpr int kMinNodesToPrepareInParallel = 1024;
+  if (!opts_.importing && opts_.thread_pool != nullptr &&
+      node_def_count() >= kMinNodesToPrepareInParallel) {
+    PrepareNodesInParallel();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1201,7 +1267,19 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef consumed_node_def;
+    std::shared_ptr<NodeProperties> props;
+    Node::NodeClass node_class = Node::NC_UNINITIALIZED;
+    if (!prepared_nodes_.empty()) {
+      PreparedNode& prepared = prepared_nodes_[o];
+      TF_RETURN_IF_ERROR(prepared.status);
+      props = std::move(prepared.props);
+      node_class = prepared.node_class;
+    } else {
+      consumed_node_def = consume_node_def(o);
+    }
+    // Prepared nodes are never imported, so their NodeDef isn't modified.
+    NodeDef& node_def = props != nullptr ? props->node_def : consumed_node_def;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1297,7 +1375,7 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (props == nullptr) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -1309,7 +1387,11 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    if (props != nullptr) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(props), node_class, &node));
+    } else {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    }
 
     if (node != nullptr) {
       if (traces_.contains(node_name)) {
@@ -1351,8 +1433,17 @@ Status GraphConstructor::Convert() {
     LOG(WARNING) << "IN " << __func__ << " " << (node_def_count() - processed)
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
-      if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+      if (pending_count_[i] == 0) continue;
+      // Prepared nodes are already consumed, and the NodeDef of a node that
+      // failed to be prepared is gone.
+      const NodeDef* node_def = nullptr;
+      if (prepared_nodes_.empty()) {
+        node_def = &get_node_def(i);
+      } else if (prepared_nodes_[i].props != nullptr) {
+        node_def = &prepared_nodes_[i].props->node_def;
+      }
+      if (node_def != nullptr) {
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(*node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
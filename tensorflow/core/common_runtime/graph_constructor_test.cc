@@ -33,9 +33,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -916,6 +918,55 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+// Returns a chain of `num_nodes` TestOneInputOneOutput nodes fed by a
+// TestParams node, and a TestDefaultAttr node.
+GraphDef LargeChainGraph(int num_nodes) {
+  GraphDef gdef;
+  NodeDef* params = gdef.add_node();
+  params->set_name("W1");
+  params->set_op("TestParams");
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestOneInputOneOutput");
+    node->add_input(i == 0 ? "W1" : strings::StrCat("n", i - 1));
+    AddNodeAttr("T", DT_FLOAT, node);
+  }
+  NodeDef* default_attr = gdef.add_node();
+  default_attr->set_name("default_attr");
+  default_attr->set_op("TestDefaultAttr");
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphInParallel) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &thread_pool;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, LargeChainGraph(2000), &graph_));
+  EXPECT_EQ(graph_.num_op_nodes(), 2002);
+  EXPECT_TRUE(HasEdge("W1", 0, "n0", 0));
+  EXPECT_TRUE(HasEdge("n1000", 0, "n1001", 0));
+  EXPECT_EQ(FindNode("n1999")->output_type(0), DT_FLOAT);
+  int default_int = 0;
+  TF_EXPECT_OK(
+      GetNodeAttr(FindNode("default_attr")->attrs(), "default_int",
+                  &default_int));
+  EXPECT_EQ(default_int, 31415);
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphInParallelError) {
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &thread_pool;
+  GraphDef gdef = LargeChainGraph(2000);
+  gdef.mutable_node(1500)->set_op("UnknownOp");
+  Status status = ConvertGraphDefToGraph(opts, gdef, &graph_);
+  EXPECT_FALSE(status.ok());
+  EXPECT_TRUE(absl::StrContains(status.message(), "UnknownOp")) << status;
+  // The graph is left unchanged on error.
+  EXPECT_EQ(graph_.num_op_nodes(), 0);
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
@@ -0,0 +1,343 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce got collective type ",
+                            col_params->instance.type);
+  }
+  std::unordered_map<string, int> num_devices_per_task;
+  for (const CollGroupMember& member : col_params->group.members) {
+    ++num_devices_per_task[member.task];
+  }
+  for (const auto& task_and_count : num_devices_per_task) {
+    if (task_and_count.second != num_devices_per_task.begin()->second) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires every task to contribute the same "
+          "number of devices, but task ",
+          task_and_count.first, " has ", task_and_count.second,
+          " devices and task ", num_devices_per_task.begin()->first, " has ",
+          num_devices_per_task.begin()->second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this collective doesn't require non-overlapping
+  // collectives, so unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  Status s = RunReduction();
+  if (!s.ok()) {
+    StartAbort(s);
+  }
+  {
+    mutex_lock l(status_mu_);
+    s = status_;
+  }
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunReduction() {
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // The default rank order groups the devices of each task together, ordered
+  // for a ring within the task.
+  std::vector<std::vector<int>> task_ranks;
+  std::unordered_map<string, int> task_index;
+  for (int r = 0; r < col_params_->group.members.size(); ++r) {
+    const int index = task_ranks.size();
+    auto it = task_index.emplace(col_params_->group.members[r].task, index)
+                  .first;
+    if (it->second == index) {
+      task_ranks.emplace_back();
+    }
+    task_ranks[it->second].push_back(r);
+  }
+  const int default_rank = col_params_->default_rank;
+  const int task =
+      task_index.at(col_params_->group.members[default_rank].task);
+  Ring local_ring{"local", task_ranks[task], 0};
+  while (local_ring.ranks[local_ring.position] != default_rank) {
+    ++local_ring.position;
+  }
+  Ring cross_task_ring{"cross_task", {}, task};
+  for (const std::vector<int>& ranks : task_ranks) {
+    cross_task_ring.ranks.push_back(ranks[local_ring.position]);
+  }
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank " << default_rank
+          << " task " << task << " local position " << local_ring.position;
+
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  const int num_local = local_ring.ranks.size();
+  const int num_tasks = cross_task_ring.ranks.size();
+  std::unique_ptr<CollectiveAdapter> ca(
+      MakeCollectiveAdapter(col_ctx_->output, num_local, allocator));
+  std::vector<Tensor> shards;
+  shards.reserve(num_local);
+  for (int i = 0; i < num_local; ++i) {
+    shards.push_back(ca->ChunkAlias(i));
+  }
+  TF_RETURN_IF_ERROR(ReduceScatter(local_ring, shards));
+
+  // Only the device owning a shard in each task takes part in its reduction
+  // across tasks.
+  Tensor owned_shard = shards[(local_ring.position + 1) % num_local];
+  std::unique_ptr<CollectiveAdapter> shard_ca(
+      MakeCollectiveAdapter(&owned_shard, num_tasks, allocator));
+  std::vector<Tensor> parts;
+  parts.reserve(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    parts.push_back(shard_ca->ChunkAlias(i));
+  }
+  TF_RETURN_IF_ERROR(ReduceScatter(cross_task_ring, parts));
+  Tensor& owned_part = parts[(task + 1) % num_tasks];
+  if (col_params_->final_op && owned_part.NumElements() > 0) {
+    Tensor group_size_tensor;
+    TF_RETURN_IF_ERROR(MakeGroupSizeTensor(*ca, &group_size_tensor));
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &owned_part, &group_size_tensor));
+  }
+  TF_RETURN_IF_ERROR(AllGather(cross_task_ring, parts));
+  TF_RETURN_IF_ERROR(AllGather(local_ring, shards));
+
+  parts.clear();
+  shards.clear();
+  ca->ConsumeFinalValue(col_ctx_->output);
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::ReduceScatter(const Ring& ring,
+                                             std::vector<Tensor>& chunks) {
+  const int n = ring.ranks.size();
+  if (n == 1) return absl::OkStatus();
+  tsl::profiler::TraceMe activity(
+      [&] { return strings::StrCat("ReduceScatter:", ring.name); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  std::vector<Tensor> tmp_chunks;
+  tmp_chunks.reserve(n);
+  for (const Tensor& chunk : chunks) {
+    tmp_chunks.emplace_back(allocator, chunk.dtype(),
+                            TensorShape({chunk.NumElements()}));
+  }
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info) {
+    // Wait for all currently queued events on the compute stream to complete,
+    // so that the temp buffers allocated above are valid for e.g. RDMA writes.
+    Notification note;
+    TF_RETURN_IF_ERROR(gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); }));
+    note.WaitForNotification();
+  }
+
+  // At step s, the device at position p forwards its partial sum of chunk
+  // p - s and adds the partial sum of chunk p - s - 1 it receives.
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (ring.position - step + n) % n;
+    const int recv_idx = (ring.position - step - 1 + 2 * n) % n;
+    TF_RETURN_IF_ERROR(
+        SendRecv(ring, step, chunks[send_idx], &tmp_chunks[recv_idx]));
+    if (chunks[recv_idx].NumElements() > 0) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunks[recv_idx], &tmp_chunks[recv_idx]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::AllGather(const Ring& ring,
+                                          std::vector<Tensor>& chunks) {
+  const int n = ring.ranks.size();
+  if (n == 1) return absl::OkStatus();
+  tsl::profiler::TraceMe activity(
+      [&] { return strings::StrCat("AllGather:", ring.name); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  // At step s, the device at position p forwards chunk p + 1 - s and receives
+  // chunk p - s.
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_idx = (ring.position + 1 - step + n) % n;
+    const int recv_idx = (ring.position - step + n) % n;
+    TF_RETURN_IF_ERROR(SendRecv(ring, n - 1 + step, chunks[send_idx],
+                                &chunks[recv_idx]));
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::SendRecv(const Ring& ring, int step,
+                                         const Tensor& send_chunk,
+                                         Tensor* recv_chunk) {
+  const int n = ring.ranks.size();
+  const int send_rank = ring.ranks[(ring.position + 1) % n];
+  const int recv_rank = ring.ranks[(ring.position - 1 + n) % n];
+  const auto buf_key = [this, &ring, step](int src_rank) {
+    return strings::StrCat(col_ctx_->exec_key, ":", ring.name, ":", step, ":",
+                           src_rank);
+  };
+  // The peers' chunks have the same sizes, so empty chunks, which only occur
+  // for very small tensors, are skipped on both sides.
+  Notification send_done;
+  Status send_status;
+  if (send_chunk.NumElements() > 0) {
+    const CollGroupMember& peer = col_params_->group.members[send_rank];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        peer.device.name(), peer.task, buf_key(col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &send_chunk,
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        [this, &send_done, &send_status](const Status& s) {
+          if (!s.ok()) StartAbort(s);
+          send_status = s;
+          send_done.Notify();
+        });
+  } else {
+    send_done.Notify();
+  }
+  Notification recv_done;
+  Status recv_status;
+  if (recv_chunk->NumElements() > 0) {
+    const CollGroupMember& peer = col_params_->group.members[recv_rank];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        peer.device.name(), peer.task, peer.is_local, buf_key(recv_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), recv_chunk,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(),
+        [this, &recv_done, &recv_status](const Status& s) {
+          if (!s.ok()) StartAbort(s);
+          recv_status = s;
+          recv_done.Notify();
+        });
+  } else {
+    recv_done.Notify();
+  }
+  send_done.WaitForNotification();
+  recv_done.WaitForNotification();
+  TF_RETURN_IF_ERROR(send_status);
+  return recv_status;
+}
+
+Status HierarchicalRingReducer::MakeGroupSizeTensor(const CollectiveAdapter& ca,
+                                                    Tensor* output) {
+  Tensor group_size_val = ca.Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    *output = group_size_val;
+    return absl::OkStatus();
+  }
+  *output = ca.Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, output,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  // As in `RingAlg`, start cancellation of all outstanding
+  // CollectiveRemoteAccess actions unless the op is already being cancelled.
+  if (abort_started) {
+    CancellationManager* cm = col_ctx_->op_ctx->cancellation_manager();
+    if (cm == nullptr || (!cm->IsCancelled() && !cm->IsCancelling())) {
+      col_ctx_->col_exec->StartAbort(s);
+    }
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
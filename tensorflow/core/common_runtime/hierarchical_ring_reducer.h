@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups spanning
+// several tasks with the same number of devices each.
+//
+// The devices of each task first reduce-scatter the tensor into one shard per
+// device over a ring in the default rank order, which follows the strongest
+// DeviceLocality links within the task. The devices owning the same shard in
+// every task then all-reduce it over a ring across the tasks, and finally the
+// devices of each task all-gather the shards. Only 1 / num_devices_per_task
+// of the tensor crosses task boundaries per device, whereas a flat ring over
+// all the devices sends the whole tensor through the slower links.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Checks that every task contributes the same number of devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Ranks of the devices forming one ring of the reduction in ring order, and
+  // the position of this device in the ring.
+  struct Ring {
+    std::string name;
+    std::vector<int> ranks;
+    int position;
+  };
+
+  Status RunReduction();
+
+  // Reduces `chunks`, holding one chunk per device of `ring`, so that the
+  // device at position p ends with the sum of chunk (p + 1) % ring size.
+  Status ReduceScatter(const Ring& ring, std::vector<Tensor>& chunks);
+  // Distributes the chunk owned by the device at position p, i.e. chunk
+  // (p + 1) % ring size, to all the devices of `ring`.
+  Status AllGather(const Ring& ring, std::vector<Tensor>& chunks);
+  // Sends `send_chunk` to the next device of `ring` while receiving
+  // `recv_chunk` from the previous one, and waits for both.
+  Status SendRecv(const Ring& ring, int step, const Tensor& send_chunk,
+                  Tensor* recv_chunk);
+
+  Status MakeGroupSizeTensor(const CollectiveAdapter& ca, Tensor* output);
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
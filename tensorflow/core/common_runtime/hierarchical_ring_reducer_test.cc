@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(op, op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  // Reduces tensors of `tensor_len` elements over `num_workers` tasks with
+  // `num_devices` devices each, and checks that every device ends with their
+  // mean.
+  void RunTest(int num_workers, int num_devices, int tensor_len,
+               int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    const int group_size = num_workers * num_devices;
+    std::vector<Tensor> tensors;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      Tensor t(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        t.flat<float>()(i) = rank * 10 + i;
+        expected[i] += (rank * 10 + i) / static_cast<float>(group_size);
+      }
+      tensors.push_back(t);
+    }
+    std::vector<Status> statuses(group_size);
+    BlockingCounter counter(group_size);
+    for (int rank = 0; rank < group_size; ++rank) {
+      SchedClosure([this, rank, tensor_len, &tensors, &statuses, &counter]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, rank, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+            DT_FLOAT, TensorShape({tensor_len}));
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[rank].device.name(), &device));
+        std::unique_ptr<OpKernel> merge_op =
+            GetBinOp("Add", DT_FLOAT, DEVICE_CPU, device);
+        std::unique_ptr<OpKernel> final_op =
+            GetBinOp("Div", DT_FLOAT, DEVICE_CPU, device);
+        col_params->merge_op = merge_op.get();
+        col_params->final_op = final_op.get();
+        statuses[rank] = RunCollective(test_env_.get(), col_params.get(),
+                                       device, &tensors[rank], &tensors[rank]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int rank = 0; rank < group_size; ++rank) {
+      if (fail_after > 0) {
+        EXPECT_NE(statuses[rank].message().find("Deliberate failure"),
+                  string::npos)
+            << statuses[rank];
+      } else {
+        TF_EXPECT_OK(statuses[rank]);
+        test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                      tensors[rank], 1e-4);
+      }
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(HierarchicalRingReducerTest, MultipleWorkers) { RunTest(2, 4, 1001, 0); }
+
+TEST_F(HierarchicalRingReducerTest, SingleWorker) { RunTest(1, 3, 1001, 0); }
+
+TEST_F(HierarchicalRingReducerTest, SingleDevicePerWorker) {
+  RunTest(3, 1, 1001, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, TensorSmallerThanGroup) {
+  RunTest(3, 2, 1, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, Failure) { RunTest(2, 4, 9408, 7); }
+
+TEST_F(HierarchicalRingReducerTest, RequiresSameNumberOfDevicesPerTask) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                      /*num_devices_per_worker=*/2, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env_, 0, "HierarchicalRingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({8}));
+  col_params->group.members.pop_back();
+  core::RefCountPtr<HierarchicalRingReducer> reducer(
+      new HierarchicalRingReducer());
+  Status s = reducer->InitializeCollectiveParams(col_params.get());
+  EXPECT_TRUE(absl::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_compaction.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+double AllocatorFragmentation(const AllocatorStats& stats) {
+  if (!stats.pool_bytes.has_value() || stats.largest_free_block_bytes <= 0) {
+    return 0.0;
+  }
+  const int64_t free_bytes = *stats.pool_bytes - stats.bytes_in_use;
+  if (free_bytes <= 0) return 0.0;
+  return std::max(
+      0.0, static_cast<double>(free_bytes - stats.largest_free_block_bytes) /
+               free_bytes);
+}
+
+Status CompactVariables(Device* device, int64_t* moved_bytes) {
+  if (moved_bytes != nullptr) *moved_bytes = 0;
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->default_context == nullptr) {
+    return OkStatus();
+  }
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  std::vector<core::RefCountPtr<Var>> vars =
+      device->resource_manager()->LookupAll<Var>();
+  std::vector<std::pair<int64_t, Var*>> vars_by_size;
+  for (const core::RefCountPtr<Var>& var : vars) {
+    tf_shared_lock l(*var->mu());
+    if (var->tensor()->IsInitialized()) {
+      vars_by_size.emplace_back(var->tensor()->TotalBytes(), var.get());
+    }
+  }
+  // Placing the largest tensors first leaves the small holes to small ones.
+  std::sort(vars_by_size.begin(), vars_by_size.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  for (const auto& [size, var] : vars_by_size) {
+    mutex_lock l(*var->mu());
+    Tensor* tensor = var->tensor();
+    if (!tensor->IsInitialized() || tensor->TotalBytes() == 0 ||
+        !DataTypeCanUseMemcpy(tensor->dtype()) || !tensor->RefCountIsOne() ||
+        var->copy_on_read_mode.load()) {
+      continue;
+    }
+    Tensor moved(allocator, tensor->dtype(), tensor->shape());
+    if (!moved.IsInitialized()) {
+      return errors::ResourceExhausted("Failed to allocate ",
+                                       tensor->TotalBytes(),
+                                       " bytes to move a variable on ",
+                                       device->name());
+    }
+    Notification copied;
+    Status copy_status;
+    device_context->CopyTensorInSameDevice(
+        tensor, device, &moved, [&copied, &copy_status](const Status& s) {
+          copy_status = s;
+          copied.Notify();
+        });
+    copied.WaitForNotification();
+    TF_RETURN_IF_ERROR(copy_status);
+    *tensor = std::move(moved);
+    if (moved_bytes != nullptr) *moved_bytes += size;
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,45 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Returns the fraction of the free memory of an allocator with `stats` that is
+// outside of its largest free block, in [0, 1]. Returns 0 if the allocator
+// doesn't report the size of its pool and of its largest free block.
+double AllocatorFragmentation(const AllocatorStats& stats);
+
+// Reallocates the tensors of the resource variables of `device` in its
+// resource manager, largest first, and copies them to their new buffers. The
+// best-fit allocators place the new buffers in the free blocks between other
+// allocations, and freeing the old ones merges the free blocks around them, so
+// the free memory ends up in fewer, larger blocks.
+//
+// Only variables whose buffer is not shared, e.g. with a pending read, are
+// moved. Must only be called when no kernel runs on `device`.
+// `moved_bytes`, if not null, is set to the number of bytes moved.
+Status CompactVariables(Device* device, int64_t* moved_bytes);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_COMPACTION_H_
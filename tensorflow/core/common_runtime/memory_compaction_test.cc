@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_compaction.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+AllocatorStats Stats(int64_t pool_bytes, int64_t bytes_in_use,
+                     int64_t largest_free_block_bytes) {
+  AllocatorStats stats;
+  stats.pool_bytes = pool_bytes;
+  stats.bytes_in_use = bytes_in_use;
+  stats.largest_free_block_bytes = largest_free_block_bytes;
+  return stats;
+}
+
+TEST(AllocatorFragmentationTest, NoPool) {
+  AllocatorStats stats;
+  stats.bytes_in_use = 1024;
+  stats.largest_free_block_bytes = 256;
+  EXPECT_EQ(AllocatorFragmentation(stats), 0.0);
+}
+
+TEST(AllocatorFragmentationTest, NothingFree) {
+  EXPECT_EQ(AllocatorFragmentation(Stats(1024, 1024, 0)), 0.0);
+}
+
+TEST(AllocatorFragmentationTest, SingleFreeBlock) {
+  EXPECT_EQ(AllocatorFragmentation(Stats(1024, 512, 512)), 0.0);
+}
+
+TEST(AllocatorFragmentationTest, FragmentedFreeMemory) {
+  EXPECT_DOUBLE_EQ(AllocatorFragmentation(Stats(1024, 512, 128)), 0.75);
+}
+
+}  // namespace
+}  // namespace tensorflow
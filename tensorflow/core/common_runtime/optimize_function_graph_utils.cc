@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <iterator>
 #include <memory>
@@ -48,8 +49,11 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -232,18 +236,47 @@ absl::StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(
   return optimized_function_graph_info_restored;
 }
 
+// Returns the fingerprint of everything the optimized graph of `fdef`
+// depends on, which is stable across processes: the function body without its
+// name, the functions it calls, the attrs and options of the instantiation,
+// the devices and the TF version.
+uint64_t FileCacheFingerprint(
+    const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  // The library and state handle are only valid in this process.
+  FunctionLibraryRuntime::InstantiateOptions stable_options = options;
+  stable_options.lib_def = nullptr;
+  stable_options.state_handle.clear();
+  string key = absl::StrCat(TF_VERSION_STRING, ";", TF_GRAPH_DEF_VERSION, ";",
+                            Canonicalize("", attrs, stable_options));
+  FunctionDef body = fdef;
+  body.mutable_signature()->clear_name();
+  string serialized;
+  SerializeToStringDeterministic(body, &serialized);
+  absl::StrAppend(&key, serialized.size(), ":", serialized);
+  SerializeToStringDeterministic(lib_def.ReachableDefinitions(fdef).ToProto(),
+                                 &serialized);
+  absl::StrAppend(&key, serialized.size(), ":", serialized);
+  for (const Device* device : dev_set.devices()) {
+    absl::StrAppend(&key, device->name(), ";");
+  }
+  for (const CompositeDevice* device : composite_devices) {
+    absl::StrAppend(&key, device->name(), ";");
+  }
+  return Fingerprint64(key);
+}
+
 // Gets the full path name of the file cache.
-// TODO(b/276813768) Include more runtime specific info like env/flag
-// values, or line number. An alternative is to use the fingerprint of the
-// graph once graph building cache is enabled.
 //
 // Current file cache key components:
 // 1) Job name.
 // 2) Task ID.
 // 3) Function name (without UUID suffix).
-// 4) TF graph node count.
+// 4) The fingerprint of the function and its instantiation.
 string GetFileCacheName(const string& dir_name, const string& function_name,
-                        const FunctionDef* fdef) {
+                        uint64_t fingerprint) {
   string plain_func_name = function_name;
   // Remove the random UUID in the function name.
   if (absl::StrContains(function_name, "_")) {
@@ -254,7 +287,7 @@ string GetFileCacheName(const string& dir_name, const string& function_name,
 
   return absl::StrCat(dir_name, "/", tsl::port::JobName(), "_",
                       tsl::port::TaskId(), "_", plain_func_name, "_",
-                      fdef->node_def_size());
+                      absl::Hex(fingerprint, absl::kZeroPad16));
 }
 
 // Generates graph and return information given the input function name,
@@ -686,7 +719,10 @@ OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name = GetFileCacheName(
+      dir_name, function_name,
+      FileCacheFingerprint(*fdef, attrs, options, dev_set, *lib_def,
+                           composite_devices));
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
@@ -195,7 +195,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   // Check that only one cache file exists.
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/_-1_FindDevice_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_EQ(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -215,7 +215,7 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   TF_ASSERT_OK(optimized_info.status());
   file_list.clear();
   TF_ASSERT_OK(env->GetMatchingPaths(
-      absl::StrCat(temp_dir, "/_-1_FindDevice_1"), &file_list));
+      absl::StrCat(temp_dir, "/_-1_FindDevice_*"), &file_list));
   EXPECT_EQ(file_list.size(), 1);
   EXPECT_GT(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
                 metrics::GraphOptimizationSource::kJit),
@@ -246,5 +246,47 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, FileCacheDependsOnFunctionBody) {
+  Env* env = Env::Default();
+  const string temp_dir = "/tmp/testing_cache_directory_body";
+  EXPECT_TRUE(env->RecursivelyCreateDir(temp_dir).ok());
+  setenv(kGraphCachingEnvVariableName, temp_dir.c_str(), 1);
+
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 3, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  // Caches the same function with a different body, and again with the same
+  // body.
+  FunctionDef fdef = test::function::FindDeviceWithUuid();
+  FunctionDef changed_fdef = fdef;
+  (*changed_fdef.mutable_attr())["_test_attr"].set_b(true);
+  for (const FunctionDef* def : {&fdef, &changed_fdef, &fdef}) {
+    FunctionDefLibrary proto;
+    *(proto.add_function()) = *def;
+    FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+    TF_ASSERT_OK(OptimizeFunctionGraphOrReadFromFileCache(
+                     "FindDevice_1234", {}, opts, device_set, &lib_def,
+                     /*composite_devices=*/{}, devices[0].get(),
+                     devices[1].get(), env,
+                     /*caching_threshold_duration=*/absl::ZeroDuration())
+                     .status());
+  }
+  std::vector<string> file_list;
+  TF_ASSERT_OK(env->GetMatchingPaths(
+      absl::StrCat(temp_dir, "/_-1_FindDevice_*"), &file_list));
+  EXPECT_EQ(file_list.size(), 2);
+
+  int64_t undeleted_files;
+  int64_t undeleted_dirs;
+  TF_EXPECT_OK(
+      env->DeleteRecursively(temp_dir, &undeleted_files, &undeleted_dirs));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
@@ -3108,5 +3109,47 @@ TEST_F(NestedPlacerTest, IndirectRecursion) {
       << s.ToString();
 }
 
+void BM_PlaceLargeGraph(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  const int num_tasks = state.range(1);
+  std::vector<std::unique_ptr<Device>> local_devices;
+  DeviceSet devices;
+  for (int i = 0; i < num_tasks; ++i) {
+    local_devices.emplace_back(FakeDevice::MakeCPU(
+        strings::StrCat("/job:a/replica:0/task:", i, "/device:FakeCPU:0")));
+    devices.AddDevice(local_devices.back().get());
+    local_devices.emplace_back(FakeDevice::MakeGPU(
+        strings::StrCat("/job:a/replica:0/task:", i, "/device:FakeGPU:0")));
+    devices.AddDevice(local_devices.back().get());
+  }
+
+  // A chain of ops spread over the GPUs of all the tasks.
+  Graph graph(OpRegistry::Global());
+  {
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* node = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    for (int i = 0; i < num_nodes; ++i) {
+      node = ops::UnaryOp(
+          "TestRelu", node,
+          b.opts()
+              .WithName(strings::StrCat("relu_", i))
+              .WithDevice(strings::StrCat("/job:a/task:", i % num_tasks,
+                                          "/device:FakeGPU:0")));
+    }
+    TF_CHECK_OK(GraphDefBuilderToGraph(b, &graph));
+  }
+
+  for (auto s : state) {
+    state.PauseTiming();
+    Graph copy(OpRegistry::Global());
+    CopyGraph(graph, &copy);
+    state.ResumeTiming();
+    Placer placer(&copy, "", &copy.flib_def(), &devices);
+    TF_CHECK_OK(placer.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+}
+BENCHMARK(BM_PlaceLargeGraph)->ArgPair(1000, 8)->ArgPair(500000, 128);
+
 }  // namespace
 }  // namespace tensorflow
@@ -58,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
@@ -86,6 +87,16 @@ int64_t GetParallelSubgraphThreshold() {
   return parallel_subgraph_threshold;
 }
 
+int64_t GetOptimizedGraphCacheBytes() {
+  static int64_t optimized_graph_cache_bytes = []() {
+    int64_t result;
+    TF_CHECK_OK(tsl::ReadInt64FromEnvVar("TF_PFLR_OPTIMIZED_GRAPH_CACHE_BYTES",
+                                         256 << 20, &result));
+    return result;
+  }();
+  return optimized_graph_cache_bytes;
+}
+
 }  // namespace
 
 const char ProcessFunctionLibraryRuntime::kDefaultFLRDevice[] = "null";
@@ -573,6 +584,32 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
+  // Look up the optimized graph of a function with the same body.
+  std::optional<Fprint128> optimized_graph_key;
+  if ((!optimized_graph_proto.has_value() ||
+       !optimized_graph_proto.value().ok()) &&
+      GetOptimizedGraphCacheBytes() > 0 &&
+      options.graph_collector == nullptr) {
+    optimized_graph_key = OptimizedGraphKey(function_name, attrs, options,
+                                            *dev_set, composite_devices);
+  }
+  if (optimized_graph_key.has_value()) {
+    tf_shared_lock l(mu_);
+    auto it = optimized_graphs_.find(*optimized_graph_key);
+    if (it != optimized_graphs_.end()) {
+      VLOG(1) << "Reusing the optimized graph of function \""
+              << it->second.name() << "\" for function \"" << function_name
+              << "\"";
+      metrics::UpdateFunctionGraphOptimizationSavingTime(
+          it->second.optimization_time_usecs(),
+          metrics::GraphOptimizationSource::kJit);
+      metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+          1, metrics::GraphOptimizationSource::kJit);
+      optimized_graph_proto = it->second;
+      optimized_graph_key.reset();
+    }
+  }
+
   absl::StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
       (!optimized_graph_proto.has_value() ||
        !optimized_graph_proto.value().ok())
@@ -582,6 +619,12 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
           : OptimizedFunctionGraphInfo::FromProto(
                 std::move(optimized_graph_proto.value().value()));
   if (!optimized_graph_info.ok()) return optimized_graph_info.status();
+  optimized_graph_info->name = function_name;
+  if (optimized_graph_key.has_value()) {
+    CacheOptimizedGraph(*optimized_graph_key,
+                        OptimizedFunctionGraphInfo::ToProto(
+                            *optimized_graph_info));
+  }
 
   // Resets the library registration correctly.
   optimized_graph_info->function_graph->mutable_flib_def()
@@ -1169,6 +1212,54 @@ Status ProcessFunctionLibraryRuntime::IsCrossProcess(
   return errors::InvalidArgument("Handle ", handle, " not found.");
 }
 
+std::optional<Fprint128> ProcessFunctionLibraryRuntime::OptimizedGraphKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set,
+    const std::vector<CompositeDevice*>& composite_devices) const {
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) return std::nullopt;
+  FunctionDef body = *fdef;
+  body.mutable_signature()->clear_name();
+  string key = Canonicalize("", attrs, options);
+  string serialized;
+  SerializeToStringDeterministic(body, &serialized);
+  absl::StrAppend(&key, serialized.size(), ":", serialized);
+  // The optimized graph also depends on the functions called by the body.
+  SerializeToStringDeterministic(lib_def->ReachableDefinitions(*fdef).ToProto(),
+                                 &serialized);
+  absl::StrAppend(&key, serialized.size(), ":", serialized);
+  for (const Device* device : dev_set.devices()) {
+    absl::StrAppend(&key, device->name(), ";");
+  }
+  for (const CompositeDevice* device : composite_devices) {
+    absl::StrAppend(&key, device->name(), ";");
+  }
+  return Fingerprint128(key);
+}
+
+void ProcessFunctionLibraryRuntime::CacheOptimizedGraph(
+    const Fprint128& key, OptimizedFunctionGraph optimized_graph) {
+  const int64_t max_bytes = GetOptimizedGraphCacheBytes();
+  const int64_t bytes = optimized_graph.ByteSizeLong();
+  // Caching a graph that would evict most of the others isn't worth it.
+  if (bytes > max_bytes / 4) return;
+  mutex_lock l(mu_);
+  if (!optimized_graphs_.emplace(key, std::move(optimized_graph)).second) {
+    return;
+  }
+  optimized_graphs_order_.push_back({key, bytes});
+  optimized_graphs_bytes_ += bytes;
+  while (optimized_graphs_bytes_ > max_bytes) {
+    const auto& [oldest_key, oldest_bytes] = optimized_graphs_order_.front();
+    optimized_graphs_.erase(oldest_key);
+    optimized_graphs_bytes_ -= oldest_bytes;
+    optimized_graphs_order_.pop_front();
+  }
+}
+
 void ProcessFunctionLibraryRuntime::InstantiateRemote(
     const string& function_name, AttrSlice attrs,
     const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -15,21 +15,27 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -378,6 +384,20 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Returns the key of the optimized graph of `function_name`, which depends
+  // on the body of the function but not on its name, or nullopt if the
+  // function isn't in the library.
+  std::optional<Fprint128> OptimizedGraphKey(
+      const string& function_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const DeviceSet& dev_set,
+      const std::vector<CompositeDevice*>& composite_devices) const;
+
+  // Adds the optimized graph of `key` to optimized_graphs_, evicting the
+  // oldest graphs beyond the bytes limit of the cache.
+  void CacheOptimizedGraph(const Fprint128& key,
+                           OptimizedFunctionGraph optimized_graph);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -522,6 +542,17 @@ class ProcessFunctionLibraryRuntime {
                      std::unique_ptr<MultiDeviceFunctionData>>
       mdevice_data_ TF_GUARDED_BY(mu_);
 
+  // The optimized graphs of the instantiated multi-device functions, keyed by
+  // OptimizedGraphKey(), so that the functions only differing by their names,
+  // e.g. after retracing, are only optimized once.
+  absl::flat_hash_map<Fprint128, OptimizedFunctionGraph, Fprint128Hasher>
+      optimized_graphs_ TF_GUARDED_BY(mu_);
+  // The keys of `optimized_graphs_` and the size of their graphs, oldest
+  // first.
+  std::deque<std::pair<Fprint128, int64_t>> optimized_graphs_order_
+      TF_GUARDED_BY(mu_);
+  int64_t optimized_graphs_bytes_ TF_GUARDED_BY(mu_) = 0;
+
   std::unique_ptr<
       std::unordered_map<Device*, core::RefCountPtr<FunctionLibraryRuntime>>>
       flr_map_;
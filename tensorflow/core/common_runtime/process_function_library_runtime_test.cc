@@ -486,6 +486,34 @@ TEST_F(ProcessFunctionLibraryRuntimeTest,
   test::ExpectTensorEqual<int32>(y, test::AsTensor<int32>({4, 8, 12, 16}));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDeviceSharesOptimizedGraphOfSameBody) {
+  FunctionDef renamed = test::function::XTimesTwoInt32();
+  renamed.mutable_signature()->set_name("RenamedXTimesTwoInt32");
+  Init({test::function::XTimesTwoInt32(), renamed});
+  auto x = test::AsTensor<int32>({1, 2, 3, 4});
+  FunctionLibraryRuntime::Options opts;
+  opts.source_device = "/job:a/replica:0/task:0/cpu:0";
+  opts.remote_execution = true;
+  FunctionLibraryRuntime::InstantiateOptions instantiate_opts;
+  instantiate_opts.target = "/job:a/replica:0/task:0/cpu:0";
+  instantiate_opts.input_devices = {"/job:a/replica:0/task:0/cpu:0"};
+  instantiate_opts.output_devices = {"/job:a/replica:0/task:0/cpu:0"};
+  instantiate_opts.is_multi_device_function = true;
+  const int64_t hit_count = metrics::GetFunctionGraphOptimizationCacheHitCount(
+      metrics::GraphOptimizationSource::kJit);
+  Tensor y;
+  TF_CHECK_OK(Run("XTimesTwoInt32", opts, {{"T", DT_INT32}}, instantiate_opts,
+                  {x}, {&y}));
+  test::ExpectTensorEqual<int32>(y, test::AsTensor<int32>({2, 4, 6, 8}));
+  TF_CHECK_OK(Run("RenamedXTimesTwoInt32", opts, {{"T", DT_INT32}},
+                  instantiate_opts, {x}, {&y}));
+  test::ExpectTensorEqual<int32>(y, test::AsTensor<int32>({2, 4, 6, 8}));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hit_count + 1);
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultipleCallsSameDeviceFindDevice) {
   Init({test::function::FindDevice()});
   FunctionLibraryRuntime::Options opts;
@@ -62,7 +62,8 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
 }
 
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
-  if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
+  const bool numa_enabled = numa_enabled_.load(std::memory_order_relaxed);
+  if (!numa_enabled || numa_node == port::kNUMANoAffinity) numa_node = 0;
 
   // Check if allocator for the numa node is in lock-free cache.
   if (numa_node < cpu_allocators_cached_.load(std::memory_order_acquire)) {
@@ -76,17 +77,21 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // NUMA-bound allocators default to BFC as well, so that each node keeps a
+    // growing arena of node-local memory instead of a small pool. Once NUMA is
+    // enabled this covers the node 0 allocator too, see EnableNUMA().
     bool use_bfc_allocator = false;
     Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined || numa_enabled,
+        &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled || alloc_visitors_defined || use_bfc_allocator)
             ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
+                  numa_enabled ? numa_node : port::kNUMANoAffinity,
                   cpu_alloc_visitors_, cpu_free_visitors_)
             : nullptr;
     if (use_bfc_allocator) {
@@ -115,7 +120,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
           new PoolAllocator(/*pool_size_limit=*/100, /*auto_resize=*/true,
                             sub_allocator, new NoopRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
-              << "numa_enabled_=" << numa_enabled_
+              << "numa_enabled_=" << numa_enabled
               << " numa_node=" << numa_node;
     } else {
       DCHECK(!sub_allocator);
@@ -164,6 +169,8 @@ void ProcessState::TestOnlyReset() {
     if (a != default_cpu_allocator) delete a;
   }
   cpu_allocators_.clear();
+  cpu_allocators_cached_.store(0, std::memory_order_release);
+  numa_enabled_.store(false, std::memory_order_relaxed);
   for (Allocator* a : cpu_al_) {
     delete a;
   }
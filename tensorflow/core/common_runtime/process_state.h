@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <unordered_map>
@@ -56,7 +57,12 @@ class ProcessState : public ProcessStateInterface {
 
   // If NUMA Allocators are desired, call this before calling any
   // Allocator accessor.
-  void EnableNUMA() { numa_enabled_ = true; }
+  //
+  // This applies to the whole process: every CPU allocator created afterwards
+  // is bound to a node, including the node 0 allocator that backs ops without
+  // a NUMA affinity, and defaults to a BFCAllocator unless
+  // TF_CPU_ALLOCATOR_USE_BFC=false. Allocators created earlier are unchanged.
+  void EnableNUMA() { numa_enabled_.store(true, std::memory_order_relaxed); }
 
   // Returns what we know about the memory at ptr.
   // If we know nothing, it's called CPU 0 with no other attributes.
@@ -81,6 +87,7 @@ class ProcessState : public ProcessStateInterface {
   virtual ~ProcessState() {}
   friend class GPUProcessState;
   friend class PluggableDeviceProcessState;
+  friend class ThreadPoolDeviceNumaTest;
 
   // If these flags need to be runtime configurable consider adding
   // them to ConfigProto.
@@ -92,7 +99,8 @@ class ProcessState : public ProcessStateInterface {
   void TestOnlyReset();
 
   static ProcessState* instance_;
-  bool numa_enabled_;
+  // Read without holding `mu_` by GetCPUAllocator.
+  std::atomic<bool> numa_enabled_;
 
   mutex mu_;
 
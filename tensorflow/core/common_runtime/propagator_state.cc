@@ -114,6 +114,7 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
     is_frame_done = input_frame->DecrementOutstandingOps(input_iter, ready);
   } else if (item->is_exit) {
     if (is_dead) {
+      bool iter_done;
       {
         tf_shared_lock l(input_frame->mu);
         // Stop and remember this node if it is a dead exit.
@@ -121,8 +122,11 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
           mutex_lock l(input_frame->iter_mu);
           input_frame->dead_exits.push_back(item);
         }
+        iter_done = input_frame->AdjustOutstandingOpsFastPath(input_iter, -1);
       }
-      is_frame_done = input_frame->DecrementOutstandingOps(input_iter, ready);
+      is_frame_done =
+          iter_done &&
+          input_frame->CleanupIterationsAfterFastPath(input_iter, ready);
     } else {
       output_frame = input_frame->parent_frame;
       output_iter = input_frame->parent_iter;
@@ -136,8 +140,14 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
     if (is_dead) {
       // Stop the deadness propagation.
       output_frame = nullptr;
+      is_frame_done = input_frame->DecrementOutstandingOps(input_iter, ready);
     } else {
+      // Unless a new iteration has to be created, this node is retired from
+      // its iteration under the same shared lock that activates its outputs,
+      // so a loop running many parallel iterations takes the frame lock once
+      // per NextIteration node.
       bool need_create_iter = false;
+      bool iter_done = false;
       {
         tf_shared_lock l(input_frame->mu);
         if (input_iter->iter_num == input_frame->iteration_count) {
@@ -145,48 +155,53 @@ void PropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
               input_frame->max_parallel_iterations) {
             // Reached the maximum for parallel iterations.
             output_frame = nullptr;
-            mutex_lock l(input_frame->iter_mu);
-            input_frame->next_iter_roots.push_back({item, (*outputs)[0]});
+            {
+              mutex_lock l(input_frame->iter_mu);
+              input_frame->next_iter_roots.push_back({item, (*outputs)[0]});
+            }
           } else {
             // Need to create iteration state after acquiring mutex lock.
             need_create_iter = true;
           }
         } else {
           output_iter = input_frame->GetIteration(input_iter->iter_num + 1);
+          int activated = input_frame->ActivateNodesShared(
+              item, is_dead, output_iter, outputs, ready);
+          input_frame->AdjustOutstandingOpsFastPath(output_iter, activated);
+        }
+        if (!need_create_iter) {
+          iter_done = input_frame->AdjustOutstandingOpsFastPath(input_iter, -1);
         }
       }
-      if (output_frame != nullptr) {
-        if (need_create_iter) {
-          tsl::profiler::TraceMe activit1y(
-              [&]() {
-                return strings::StrCat(
-                    "PropagateOutputs::NextIteration::CreateIterationState");
-              },
-              tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
-          mutex_lock l(input_frame->mu);
-          if (input_iter->iter_num == input_frame->iteration_count) {
-            // Check another time since another thread may create the required
-            // iteration state.
-            // TODO(fishx): This may cause contention since multiple threads may
-            // race for this mutex lock. Further improve this if needed.
-            output_iter = input_frame->IncrementIteration(ready);
-          } else {
-            output_iter = input_frame->GetIteration(input_iter->iter_num + 1);
-          }
-          DCHECK(input_frame == output_frame);
-          int activated = output_frame->ActivateNodesLocked(
-              item, is_dead, output_iter, outputs, ready);
-          output_frame->AdjustOutstandingOpsLocked(output_iter, activated,
-                                                   ready);
+      if (need_create_iter) {
+        tsl::profiler::TraceMe activit1y(
+            [&]() {
+              return strings::StrCat(
+                  "PropagateOutputs::NextIteration::CreateIterationState");
+            },
+            tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+        mutex_lock l(input_frame->mu);
+        if (input_iter->iter_num == input_frame->iteration_count) {
+          // Check another time since another thread may create the required
+          // iteration state.
+          // TODO(fishx): This may cause contention since multiple threads may
+          // race for this mutex lock. Further improve this if needed.
+          output_iter = input_frame->IncrementIteration(ready);
         } else {
-          DCHECK(input_frame == output_frame);
-          output_frame->ActivateNodesAndAdjustOutstanding(
-              item, is_dead, output_iter, outputs, ready,
-              /*decrement_activation=*/0);
+          output_iter = input_frame->GetIteration(input_iter->iter_num + 1);
         }
+        DCHECK(input_frame == output_frame);
+        int activated = output_frame->ActivateNodesLocked(
+            item, is_dead, output_iter, outputs, ready);
+        output_frame->AdjustOutstandingOpsLocked(output_iter, activated,
+                                                 ready);
+        is_frame_done =
+            input_frame->DecrementOutstandingOpsLocked(input_iter, ready);
+      } else if (iter_done) {
+        is_frame_done =
+            input_frame->CleanupIterationsAfterFastPath(input_iter, ready);
       }
     }
-    is_frame_done = input_frame->DecrementOutstandingOps(input_iter, ready);
   }
 
   // At this point, this node is completely done. We also know if the
@@ -682,6 +697,20 @@ int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
   }
 }
 
+int PropagatorState::FrameState::ActivateNodesShared(const NodeItem* item,
+                                                     const bool is_dead,
+                                                     IterationState* iter_state,
+                                                     EntryVector* outputs,
+                                                     TaggedNodeSeq* ready) {
+  if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
+    return ActivateNodesSlowPathShared(item, is_dead, iter_state, outputs,
+                                       ready);
+  } else {
+    return ActivateNodesFastPathShared(item, is_dead, iter_state, outputs,
+                                       ready);
+  }
+}
+
 void PropagatorState::FrameState::ActivateNexts(IterationState* iter_state,
                                                 TaggedNodeSeq* ready) {
   int activated = 0;
@@ -861,6 +890,13 @@ bool PropagatorState::FrameState::AdjustOutstandingOps(
   return CleanupIterations(iter_state, ready);
 }
 
+bool PropagatorState::FrameState::CleanupIterationsAfterFastPath(
+    IterationState* iter_state, TaggedNodeSeq* ready) {
+  mutex_lock l(mu);
+  DCHECK(IsIterationDone(iter_state));
+  return CleanupIterations(iter_state, ready);
+}
+
 bool PropagatorState::FrameState::AdjustOutstandingOpsFastPath(
     IterationState* iter_state, int delta) {
   auto old_val = iter_state->outstanding_ops.fetch_add(delta);
@@ -400,6 +400,19 @@ class PropagatorState {
                             TaggedNodeSeq* ready)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
 
+    // Same as the above, but requires 'mu' already held in shared mode, so
+    // that the caller can do other fast path updates under the same lock.
+    int ActivateNodesShared(const NodeItem* item, const bool is_dead,
+                            IterationState* iter_state, EntryVector* outputs,
+                            TaggedNodeSeq* ready) TF_SHARED_LOCKS_REQUIRED(mu);
+
+    // Cleans up the iterations of this frame after a fast path adjustment
+    // found 'iter_state' done. Return true iff the execution of the frame is
+    // done.
+    bool CleanupIterationsAfterFastPath(IterationState* iter_state,
+                                        TaggedNodeSeq* ready)
+        TF_LOCKS_EXCLUDED(mu);
+
     // Cleanup iterations of this frame starting from the given iteration.
     bool CleanupIterations(IterationState* iter_state, TaggedNodeSeq* ready)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/quantized_ring_reducer.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace {
+
+template <typename From, typename To>
+void CastTo(const Tensor& from, Tensor* to) {
+  to->flat<To>() = from.flat<From>().template cast<To>();
+}
+
+void Quantize(const Tensor& from, Tensor* to) {
+  if (to->dtype() == DT_HALF) {
+    CastTo<float, Eigen::half>(from, to);
+  } else {
+    CastTo<float, bfloat16>(from, to);
+  }
+}
+
+void Dequantize(const Tensor& from, Tensor* to) {
+  if (from.dtype() == DT_HALF) {
+    CastTo<Eigen::half, float>(from, to);
+  } else {
+    CastTo<bfloat16, float>(from, to);
+  }
+}
+
+}  // namespace
+
+DataType QuantizedRingReducer::TransportType(
+    const CollectiveParams& col_params) {
+  const string& hint = col_params.instance.impl_details.communication_hint;
+  if (hint == "fp16") return DT_HALF;
+  if (hint == "bf16") return DT_BFLOAT16;
+  return DT_INVALID;
+}
+
+Status QuantizedRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("QuantizedRingReduce got collective type ",
+                            col_params->instance.type);
+  }
+  if (TransportType(*col_params) == DT_INVALID) {
+    return errors::InvalidArgument(
+        "QuantizedRingReduce requires communication hint fp16 or bf16, got ",
+        col_params->instance.impl_details.communication_hint);
+  }
+  if (col_params->instance.data_type != DT_FLOAT ||
+      col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "QuantizedRingReduce only supports float32 reductions on CPU, got ",
+        DataTypeString(col_params->instance.data_type), " on ",
+        col_params->group.device_type.type_string());
+  }
+  return RingAlg::InitializeCollectiveParams(col_params);
+}
+
+void QuantizedRingReducer::DispatchSend(RingField* rf,
+                                        const StatusCallback& done) {
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  auto quantized = std::make_shared<Tensor>(
+      allocator, TransportType(*col_params_), rf->chunk.shape());
+  Quantize(rf->chunk, quantized.get());
+  if (rf->second_pass) {
+    // Only the owner of the fully reduced value holds it at a higher
+    // precision than the devices it is sent to, so round it the same way.
+    // This is a no-op on the devices forwarding it.
+    Dequantize(*quantized, &rf->chunk);
+  }
+  DispatchSendTensor(rf, quantized.get(),
+                     [quantized, done](const Status& s) { done(s); });
+}
+
+void QuantizedRingReducer::DispatchRecv(RingField* rf,
+                                        const StatusCallback& done) {
+  Tensor* dst = RecvDestination(rf);
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  auto quantized = std::make_shared<Tensor>(
+      allocator, TransportType(*col_params_), dst->shape());
+  DispatchRecvTensor(rf, quantized.get(),
+                     [quantized, dst, done](const Status& s) {
+                       if (s.ok()) {
+                         Dequantize(*quantized, dst);
+                       }
+                       done(s);
+                     });
+}
+
+namespace {
+REGISTER_COLLECTIVE(QuantizedRingReduce, QuantizedRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
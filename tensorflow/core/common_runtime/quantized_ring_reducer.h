@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
+
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/types.pb.h"
+
+namespace tensorflow {
+
+// Lossy variant of `RingReducer` for float32 reductions on CPU, which
+// transfers values in a 16-bit floating point type to halve the bytes sent.
+// Partial sums are reduced in float32, and each device rounds the fully
+// reduced values it owns before distributing them, so that all the devices
+// end with the same result.
+//
+// Selected with the communication hint "fp16" for IEEE half precision, or
+// "bf16" for bfloat16, which keeps the range of float32 at a lower precision.
+class QuantizedRingReducer : public RingReducer {
+ public:
+  QuantizedRingReducer() = default;
+  ~QuantizedRingReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Returns the type values of `col_params` are transferred in, or DT_INVALID
+  // if its communication hint doesn't select QuantizedRingReducer.
+  static DataType TransportType(const CollectiveParams& col_params);
+
+ protected:
+  void DispatchSend(RingField* rf, const StatusCallback& done) override;
+  void DispatchRecv(RingField* rf, const StatusCallback& done) override;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
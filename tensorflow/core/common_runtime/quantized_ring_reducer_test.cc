@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/quantized_ring_reducer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(op, op)
+                  .Attr("T", DT_FLOAT)
+                  .Input(FakeInput(DT_FLOAT))
+                  .Input(FakeInput(DT_FLOAT))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class QuantizedRingReducerTest : public ::testing::Test {
+ protected:
+  // Averages tensors of `tensor_len` elements over `num_workers` tasks with
+  // `num_devices` devices each, transferring values as `hint` specifies, and
+  // checks that every device ends with the same value close to the mean.
+  void RunTest(const string& hint, int num_workers, int num_devices,
+               int tensor_len, float tolerance) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<Tensor> tensors;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      Tensor t(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        const float value = 0.001f * (rank + 1) * (i % 100 - 50);
+        t.flat<float>()(i) = value;
+        expected[i] += value / group_size;
+      }
+      tensors.push_back(t);
+    }
+    BlockingCounter counter(group_size);
+    for (int rank = 0; rank < group_size; ++rank) {
+      SchedClosure([this, &hint, rank, tensor_len, &tensors, &counter]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, rank, "QuantizedRingReduce", REDUCTION_COLLECTIVE,
+            DT_FLOAT, TensorShape({tensor_len}));
+        col_params->instance.impl_details.communication_hint = hint;
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[rank].device.name(), &device));
+        std::unique_ptr<OpKernel> merge_op = GetBinOp("Add", device);
+        std::unique_ptr<OpKernel> final_op = GetBinOp("Div", device);
+        col_params->merge_op = merge_op.get();
+        col_params->final_op = final_op.get();
+        TF_EXPECT_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                   &tensors[rank], &tensors[rank]));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    test::ExpectTensorNear<float>(test::AsTensor<float>(expected), tensors[0],
+                                  tolerance);
+    for (int rank = 1; rank < group_size; ++rank) {
+      test::ExpectTensorEqual<float>(tensors[0], tensors[rank]);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(QuantizedRingReducerTest, Fp16) { RunTest("fp16", 2, 2, 1001, 0.01); }
+
+TEST_F(QuantizedRingReducerTest, Bf16) { RunTest("bf16", 2, 2, 1001, 0.05); }
+
+TEST_F(QuantizedRingReducerTest, Fp16ManyDevices) {
+  RunTest("fp16", 2, 4, 4096, 0.01);
+}
+
+TEST_F(QuantizedRingReducerTest, TransportType) {
+  CollectiveParams col_params;
+  col_params.instance.impl_details.communication_hint = "fp16";
+  EXPECT_EQ(QuantizedRingReducer::TransportType(col_params), DT_HALF);
+  col_params.instance.impl_details.communication_hint = "bf16";
+  EXPECT_EQ(QuantizedRingReducer::TransportType(col_params), DT_BFLOAT16);
+  col_params.instance.impl_details.communication_hint = "ring";
+  EXPECT_EQ(QuantizedRingReducer::TransportType(col_params), DT_INVALID);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -64,6 +64,11 @@ class RequestCost {
     int64_t padding_size = 0;
     // Costs for processing this batch.
     absl::flat_hash_map<std::string, absl::Duration> batch_costs;
+    // How long the input from this rpc request waited for this batch to start
+    // processing.
+    absl::Duration queueing_delay = absl::ZeroDuration();
+    // In this batch, size in bytes of the input tensors from this rpc request.
+    int64_t input_bytes = 0;
   };
 
   // Records the metrics of a batch.
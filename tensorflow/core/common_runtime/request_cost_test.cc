@@ -76,23 +76,29 @@ TEST(RequestCostTest, RecordBatchMetrics) {
       /*processed_size=*/8,
       /*input_size=*/8,
       /*padding_size=*/0,
-      {{"gcu", absl::Milliseconds(80)}, {"tpu", absl::Milliseconds(160)}}});
+      {{"gcu", absl::Milliseconds(80)}, {"tpu", absl::Milliseconds(160)}},
+      /*queueing_delay=*/absl::Milliseconds(5),
+      /*input_bytes=*/64});
   request_cost.RecordBatchMetrics(RequestCost::BatchMetrics{
       /*processed_size=*/4,
       /*input_size=*/2,
       /*padding_size=*/1,
-      {{"gcu", absl::Milliseconds(40)}, {"tpu", absl::Milliseconds(80)}}});
+      {{"gcu", absl::Milliseconds(40)}, {"tpu", absl::Milliseconds(80)}},
+      /*queueing_delay=*/absl::Milliseconds(2),
+      /*input_bytes=*/16});
 
   EXPECT_THAT(
       request_cost.GetBatchMetrics(),
       ElementsAre(
           FieldsAre(8, 8, 0,
                     UnorderedElementsAre(Pair("gcu", absl::Milliseconds(80)),
-                                         Pair("tpu", absl::Milliseconds(160)))),
+                                         Pair("tpu", absl::Milliseconds(160))),
+                    absl::Milliseconds(5), 64),
           FieldsAre(
               4, 2, 1,
               UnorderedElementsAre(Pair("gcu", absl::Milliseconds(40)),
-                                   Pair("tpu", absl::Milliseconds(80))))));
+                                   Pair("tpu", absl::Milliseconds(80))),
+              absl::Milliseconds(2), 16)));
 }
 
 }  // namespace
@@ -395,6 +395,11 @@ string RingAlg::RingField::DebugString() const {
 }
 
 void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
+  DispatchSendTensor(rf, &rf->chunk, done);
+}
+
+void RingAlg::DispatchSendTensor(RingField* rf, const Tensor* tensor,
+                                 const StatusCallback& done) {
   DCHECK(rf->do_send);
   string send_buf_key = RingAlgBufKey(name_, col_ctx_->exec_key,
                                       rf->second_pass, rf->sc_idx, rf->rank);
@@ -408,12 +413,17 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
+  DispatchRecvTensor(rf, RecvDestination(rf), done);
+}
+
+void RingAlg::DispatchRecvTensor(RingField* rf, Tensor* tensor,
+                                 const StatusCallback& done) {
   DCHECK(rf->do_recv);
   string recv_buf_key =
       RingAlgBufKey(name_, col_ctx_->exec_key, rf->second_pass, rf->sc_idx,
@@ -421,19 +431,22 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   VLOG(3) << "DispatchRecv rank=" << col_params_->default_rank << " recv key "
           << recv_buf_key << " chunk " << ca_->TBounds(rf->chunk) << " into "
           << ((col_params_->merge_op != nullptr) ? "tmp_chunk" : "chunk");
-  Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
-                           ? &rf->tmp_chunk
-                           : &rf->chunk;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
       col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
+Tensor* RingAlg::RecvDestination(RingField* rf) {
+  return (!rf->second_pass && (col_params_->merge_op != nullptr))
+             ? &rf->tmp_chunk
+             : &rf->chunk;
+}
+
 string RingAlg::FieldState() {
   string s = strings::StrCat(
       "Ring", name_, " ", strings::Hex(reinterpret_cast<uint64>(this)),
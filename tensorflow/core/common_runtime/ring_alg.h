@@ -81,8 +81,19 @@ class RingAlg : public CollectiveImplementationInterface {
   virtual void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                              int field_idx);
   void AdvanceToSecondPass(RingField* rf);
-  void DispatchSend(RingField* rf, const StatusCallback& done);
-  void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Sends the value of `rf` to the next device in its subdivision ring, or
+  // receives the value from the previous one into RecvDestination(rf).
+  // Subclasses may override these to change how values are transported.
+  virtual void DispatchSend(RingField* rf, const StatusCallback& done);
+  virtual void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Like DispatchSend and DispatchRecv, but transfer `tensor` in place of the
+  // value of `rf`.
+  void DispatchSendTensor(RingField* rf, const Tensor* tensor,
+                          const StatusCallback& done);
+  void DispatchRecvTensor(RingField* rf, Tensor* tensor,
+                          const StatusCallback& done);
+  // Tensor that the value received for `rf` in its current pass is stored in.
+  Tensor* RecvDestination(RingField* rf);
 
   // For constructing log messages for debugging.
   string FieldState();
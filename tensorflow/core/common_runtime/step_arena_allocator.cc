@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+size_t RoundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+StepArenaAllocator* StepArenaAllocator::Create(Allocator* base,
+                                               size_t first_chunk_bytes) {
+  return new StepArenaAllocator(
+      base, std::clamp(first_chunk_bytes, kChunkBytes, kMaxChunkBytes));
+}
+
+size_t StepArenaAllocator::TotalChunkBytes() const {
+  mutex_lock l(mu_);
+  return total_chunk_bytes_;
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (current_chunk_ != nullptr) {
+    DCHECK_EQ(current_chunk_->num_allocations, 0);
+    base_->DeallocateRaw(current_chunk_->data);
+    delete current_chunk_;
+  }
+}
+
+void StepArenaAllocator::Release() {
+  bool delete_arena;
+  {
+    mutex_lock l(mu_);
+    released_ = true;
+    delete_arena = num_allocations_ == 0;
+  }
+  if (delete_arena) delete this;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, alignof(Header));
+  const size_t header_bytes = RoundUp(sizeof(Header), alignment);
+  if (num_bytes > kMaxArenaAllocationBytes ||
+      alignment > Allocator::kAllocatorAlignment) {
+    void* base_ptr = base_->AllocateRaw(alignment, header_bytes + num_bytes);
+    if (base_ptr == nullptr) return nullptr;
+    char* ptr = static_cast<char*>(base_ptr) + header_bytes;
+    *(reinterpret_cast<Header*>(ptr) - 1) = {nullptr, base_ptr};
+    mutex_lock l(mu_);
+    ++num_allocations_;
+    return ptr;
+  }
+
+  // Keeps the allocations of a chunk aligned to kAllocatorAlignment, so that
+  // `alignment` only needs to divide `header_bytes`.
+  const size_t bytes =
+      RoundUp(header_bytes + num_bytes, Allocator::kAllocatorAlignment);
+  Chunk* chunk_to_deallocate = nullptr;
+  char* ptr;
+  {
+    mutex_lock l(mu_);
+    if (current_chunk_ == nullptr ||
+        current_chunk_->used + bytes > current_chunk_->size) {
+      const size_t chunk_bytes =
+          total_chunk_bytes_ == 0 ? first_chunk_bytes_ : kChunkBytes;
+      void* data =
+          base_->AllocateRaw(Allocator::kAllocatorAlignment, chunk_bytes);
+      if (data == nullptr) return nullptr;
+      // The previous chunk is deallocated with its last allocation.
+      if (current_chunk_ != nullptr && current_chunk_->num_allocations == 0) {
+        chunk_to_deallocate = current_chunk_;
+      }
+      current_chunk_ = new Chunk{static_cast<char*>(data), chunk_bytes};
+      total_chunk_bytes_ += chunk_bytes;
+    }
+    ptr = current_chunk_->data + current_chunk_->used + header_bytes;
+    current_chunk_->used += bytes;
+    ++current_chunk_->num_allocations;
+    ++num_allocations_;
+    *(reinterpret_cast<Header*>(ptr) - 1) = {current_chunk_, nullptr};
+  }
+  if (chunk_to_deallocate != nullptr) {
+    base_->DeallocateRaw(chunk_to_deallocate->data);
+    delete chunk_to_deallocate;
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  const Header header = *(reinterpret_cast<Header*>(ptr) - 1);
+  // The arena may be deleted by a concurrent Release() once `mu_` is unlocked.
+  Allocator* const base = base_;
+  Chunk* chunk_to_deallocate = nullptr;
+  bool delete_arena;
+  {
+    mutex_lock l(mu_);
+    --num_allocations_;
+    if (header.chunk != nullptr && --header.chunk->num_allocations == 0) {
+      if (header.chunk == current_chunk_) {
+        header.chunk->used = 0;
+      } else {
+        chunk_to_deallocate = header.chunk;
+      }
+    }
+    delete_arena = released_ && num_allocations_ == 0;
+  }
+  if (header.chunk == nullptr) base->DeallocateRaw(header.base_ptr);
+  if (chunk_to_deallocate != nullptr) {
+    base->DeallocateRaw(chunk_to_deallocate->data);
+    delete chunk_to_deallocate;
+  }
+  if (delete_arena) delete this;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator for the tensors of a single step, which bump-allocates small
+// tensors from chunks obtained from a base allocator.
+//
+// A chunk is returned to the base allocator once all the tensors allocated
+// from it are deallocated, and the current chunk is reused from its start in
+// that case. Tensors that outlive the step hence remain valid: the arena only
+// deletes itself once it is released and all its tensors are deallocated.
+//
+// Tensors larger than kMaxArenaAllocationBytes, or with more than the default
+// alignment, are allocated from the base allocator.
+//
+// Steps of the same graph usually allocate the same tensors, so the first
+// chunk can be sized from the chunk bytes of a previous step, to fit all the
+// tensors of a step into a single chunk.
+class StepArenaAllocator : public Allocator {
+ public:
+  static constexpr size_t kChunkBytes = 1 << 20;
+  static constexpr size_t kMaxChunkBytes = 256 << 20;
+  static constexpr size_t kMaxArenaAllocationBytes = 64 << 10;
+
+  // Returns a new arena allocating from `base`, which must outlive it. The
+  // arena must be released with Release() rather than deleted. The first
+  // chunk has `first_chunk_bytes`, clamped to [kChunkBytes, kMaxChunkBytes].
+  static StepArenaAllocator* Create(Allocator* base,
+                                    size_t first_chunk_bytes = kChunkBytes);
+
+  // Returns the total size of the chunks allocated so far.
+  size_t TotalChunkBytes() const;
+
+  // Ends the step of the arena, which deletes itself once all its tensors are
+  // deallocated.
+  void Release();
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t size;
+    size_t used = 0;
+    int64_t num_allocations = 0;
+  };
+
+  // Stored right before each allocation.
+  struct Header {
+    // The chunk of the allocation, or null if it is from the base allocator.
+    Chunk* chunk;
+    // The pointer to deallocate to the base allocator, if `chunk` is null.
+    void* base_ptr;
+  };
+
+  StepArenaAllocator(Allocator* base, size_t first_chunk_bytes)
+      : base_(base), first_chunk_bytes_(first_chunk_bytes) {}
+  ~StepArenaAllocator() override;
+
+  Allocator* const base_;
+  const size_t first_chunk_bytes_;
+
+  mutable mutex mu_;
+  size_t total_chunk_bytes_ TF_GUARDED_BY(mu_) = 0;
+  Chunk* current_chunk_ TF_GUARDED_BY(mu_) = nullptr;
+  int64_t num_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(StepArenaAllocatorTest, AllocatesAligned) {
+  StepArenaAllocator* arena = StepArenaAllocator::Create(cpu_allocator());
+  std::vector<void*> ptrs;
+  for (size_t num_bytes : {1, 7, 64, 100, 4096, 1 << 20}) {
+    for (size_t alignment : {8, 16, 64, 256}) {
+      void* ptr = arena->AllocateRaw(alignment, num_bytes);
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+      memset(ptr, 0xab, num_bytes);
+      ptrs.push_back(ptr);
+    }
+  }
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, ReusesChunk) {
+  StepArenaAllocator* arena = StepArenaAllocator::Create(cpu_allocator());
+  void* first = arena->AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  arena->DeallocateRaw(first);
+  void* second = arena->AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  EXPECT_EQ(first, second);
+  arena->DeallocateRaw(second);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, FillsManyChunks) {
+  StepArenaAllocator* arena = StepArenaAllocator::Create(cpu_allocator());
+  const size_t num_bytes = StepArenaAllocator::kMaxArenaAllocationBytes;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    ASSERT_NE(ptr, nullptr);
+    memset(ptr, i, num_bytes);
+    ptrs.push_back(ptr);
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(static_cast<unsigned char*>(ptrs[i])[num_bytes - 1], i);
+    arena->DeallocateRaw(ptrs[i]);
+  }
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, SizesFirstChunk) {
+  const size_t num_bytes = StepArenaAllocator::kMaxArenaAllocationBytes;
+  StepArenaAllocator* arena = StepArenaAllocator::Create(cpu_allocator());
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 100));
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                      num_bytes - 1024));
+  }
+  const size_t total_chunk_bytes = arena->TotalChunkBytes();
+  EXPECT_GT(total_chunk_bytes, StepArenaAllocator::kChunkBytes);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  arena->Release();
+
+  // A second step of the same allocations fits in its first chunk.
+  arena = StepArenaAllocator::Create(cpu_allocator(), total_chunk_bytes);
+  ptrs.clear();
+  for (int i = 0; i < 100; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 100));
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                                      num_bytes - 1024));
+  }
+  EXPECT_EQ(arena->TotalChunkBytes(), total_chunk_bytes);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, TensorsOutliveStep) {
+  StepArenaAllocator* arena = StepArenaAllocator::Create(cpu_allocator());
+  Tensor small(arena, DT_FLOAT, TensorShape({16}));
+  Tensor large(arena, DT_FLOAT, TensorShape({1 << 20}));
+  arena->Release();
+  small.flat<float>().setConstant(1.0f);
+  large.flat<float>().setConstant(2.0f);
+  EXPECT_EQ(small.flat<float>()(15), 1.0f);
+  EXPECT_EQ(large.flat<float>()((1 << 20) - 1), 2.0f);
+}
+
+}  // namespace
+}  // namespace tensorflow
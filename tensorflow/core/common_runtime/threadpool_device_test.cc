@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +74,52 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+}  // namespace
+
+// Creating NUMA devices enables NUMA allocators in the ProcessState singleton,
+// so each test starts and ends with a reset singleton.
+class ThreadPoolDeviceNumaTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ProcessState::singleton()->TestOnlyReset(); }
+  void TearDown() override { ProcessState::singleton()->TestOnlyReset(); }
+
+  bool NumaEnabled() { return ProcessState::singleton()->numa_enabled_; }
+};
+
+namespace {
+
+TEST_F(ThreadPoolDeviceNumaTest, NumaAffinityCreatesOneDevicePerNode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("CPU")->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  ASSERT_EQ(devices.size(), port::NUMANumNodes());
+  for (int i = 0; i < devices.size(); ++i) {
+    EXPECT_EQ(devices[i]->attributes().locality().numa_node(), i);
+  }
+  EXPECT_EQ(NumaEnabled(), port::NUMAEnabled());
+
+  // An explicit device count still takes precedence.
+  (*options.config.mutable_device_count())["CPU"] = 3;
+  devices.clear();
+  TF_ASSERT_OK(DeviceFactory::GetFactory("CPU")->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  ASSERT_EQ(devices.size(), 3);
+  for (int i = 0; i < devices.size(); ++i) {
+    EXPECT_EQ(devices[i]->attributes().locality().numa_node(),
+              i % port::NUMANumNodes());
+  }
+}
+
+TEST_F(ThreadPoolDeviceNumaTest, DefaultDevicesLeaveNumaDisabled) {
+  SessionOptions options;
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("CPU")->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  ASSERT_EQ(devices.size(), 1);
+  EXPECT_FALSE(NumaEnabled());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,205 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Passes values of type `T` to a handler on a bounded set of workers, each of
+// which owns a deque of pending values.
+//
+// Values scheduled from a worker thread are pushed onto that worker's deque
+// and popped in LIFO order, so the values produced while handling a value are
+// usually handled next on the same thread, while their inputs are still in
+// cache. A worker whose deque is empty steals the oldest value of a randomly
+// chosen victim. Workers are started through `runner` only when there is
+// pending work and an idle worker slot, and exit once they find no work, so a
+// scheduler whose workers are all busy never goes through the runner's queue.
+//
+// Each running worker holds a reference on the scheduler, so it may outlive
+// its creator. The handler is only invoked on values passed to `Schedule()`.
+//
+// This class is thread-safe.
+template <typename T>
+class WorkStealingScheduler
+    : public std::enable_shared_from_this<WorkStealingScheduler<T>> {
+ public:
+  using Runner = std::function<void(std::function<void()>)>;
+  using Handler = std::function<void(T)>;
+
+  static std::shared_ptr<WorkStealingScheduler> Create(int num_workers,
+                                                       Runner runner,
+                                                       Handler handler) {
+    return std::shared_ptr<WorkStealingScheduler>(new WorkStealingScheduler(
+        num_workers, std::move(runner), std::move(handler)));
+  }
+
+  // Schedules `values` to be passed to the handler, and starts idle workers
+  // to pick them up.
+  void Schedule(absl::Span<const T> values) {
+    if (values.empty()) return;
+    int target = CurrentWorker();
+    if (target < 0) {
+      target = next_external_worker_.fetch_add(1, std::memory_order_relaxed) %
+               num_workers_;
+    }
+    {
+      Worker& worker = workers_[target];
+      mutex_lock l(worker.mu);
+      worker.queue.insert(worker.queue.end(), values.begin(), values.end());
+    }
+    num_queued_.fetch_add(values.size());
+    MaybeStartWorkers(values.size());
+  }
+
+  int num_workers() const { return num_workers_; }
+
+ private:
+  struct Worker {
+    mutex mu;
+    std::deque<T> queue TF_GUARDED_BY(mu);
+    // State of the xorshift generator used to pick steal victims. Only
+    // accessed by the thread currently running this worker.
+    uint64_t rng_state = 0;
+  };
+
+  WorkStealingScheduler(int num_workers, Runner runner, Handler handler)
+      : num_workers_(std::max(num_workers, 1)),
+        runner_(std::move(runner)),
+        handler_(std::move(handler)),
+        workers_(new Worker[num_workers_]) {
+    idle_workers_.reserve(num_workers_);
+    for (int i = num_workers_ - 1; i >= 0; --i) {
+      workers_[i].rng_state = 0x9E3779B97F4A7C15ull * (i + 1);
+      idle_workers_.push_back(i);
+    }
+  }
+
+  // Returns the index of the worker running on the calling thread, or -1 if
+  // the calling thread is not one of this scheduler's workers.
+  int CurrentWorker() const {
+    return current_scheduler_ == this ? current_worker_ : -1;
+  }
+
+  // Starts up to `n` idle workers.
+  void MaybeStartWorkers(int64_t n) {
+    for (; n > 0; --n) {
+      int worker;
+      {
+        mutex_lock l(mu_);
+        if (idle_workers_.empty()) return;
+        worker = idle_workers_.back();
+        idle_workers_.pop_back();
+      }
+      runner_([self = this->shared_from_this(), worker]() {
+        self->RunWorker(worker);
+      });
+    }
+  }
+
+  void RunWorker(int worker) {
+    const WorkStealingScheduler* const saved_scheduler = current_scheduler_;
+    const int saved_worker = current_worker_;
+    current_scheduler_ = this;
+    current_worker_ = worker;
+    while (std::optional<T> value = Pop(worker)) {
+      handler_(*std::move(value));
+    }
+    current_scheduler_ = saved_scheduler;
+    current_worker_ = saved_worker;
+    {
+      mutex_lock l(mu_);
+      idle_workers_.push_back(worker);
+    }
+    // A value may have been scheduled after the last `Pop()` failed but
+    // before this worker became idle again, in which case the caller of
+    // `Schedule()` found no idle worker to start.
+    if (num_queued_.load() > 0) {
+      MaybeStartWorkers(1);
+    }
+  }
+
+  // Pops the newest value from the deque of `worker`, or steals the oldest
+  // value from another worker.
+  std::optional<T> Pop(int worker) {
+    std::optional<T> value = PopFromDeque(worker, /*newest=*/true);
+    if (value.has_value() || num_workers_ == 1 || num_queued_.load() <= 0) {
+      return value;
+    }
+    uint64_t& rng = workers_[worker].rng_state;
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    const int start = rng % num_workers_;
+    for (int i = 0; i < num_workers_; ++i) {
+      const int victim = (start + i) % num_workers_;
+      if (victim == worker) continue;
+      value = PopFromDeque(victim, /*newest=*/false);
+      if (value.has_value()) break;
+    }
+    return value;
+  }
+
+  std::optional<T> PopFromDeque(int index, bool newest) {
+    Worker& worker = workers_[index];
+    mutex_lock l(worker.mu);
+    if (worker.queue.empty()) return std::nullopt;
+    std::optional<T> value;
+    if (newest) {
+      value.emplace(std::move(worker.queue.back()));
+      worker.queue.pop_back();
+    } else {
+      value.emplace(std::move(worker.queue.front()));
+      worker.queue.pop_front();
+    }
+    num_queued_.fetch_sub(1, std::memory_order_relaxed);
+    return value;
+  }
+
+  static inline thread_local const WorkStealingScheduler* current_scheduler_ =
+      nullptr;
+  static inline thread_local int current_worker_ = -1;
+
+  const int num_workers_;
+  const Runner runner_;
+  const Handler handler_;
+  const std::unique_ptr<Worker[]> workers_;
+
+  // Number of values in all deques. May briefly undercount or overcount.
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<uint32_t> next_external_worker_{0};
+
+  mutex mu_;
+  std::vector<int> idle_workers_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_SCHEDULER_H_
@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_scheduler.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Scheduler = WorkStealingScheduler<int>;
+
+TEST(WorkStealingSchedulerTest, LocalValuesRunLastInFirstOut) {
+  std::vector<int> order;
+  std::shared_ptr<Scheduler> scheduler;
+  scheduler = Scheduler::Create(
+      /*num_workers=*/1, [](std::function<void()> fn) { fn(); },
+      [&](int value) {
+        order.push_back(value);
+        if (value == 0) {
+          scheduler->Schedule({1, 2, 3});
+        }
+      });
+  scheduler->Schedule({0});
+  EXPECT_EQ(order, std::vector<int>({0, 3, 2, 1}));
+}
+
+TEST(WorkStealingSchedulerTest, AllValuesAreHandled) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  constexpr int kDepth = 10;
+  // Each value schedules two children until `kDepth`, forming a full binary
+  // tree.
+  BlockingCounter counter((1 << (kDepth + 1)) - 1);
+  std::shared_ptr<Scheduler> scheduler;
+  scheduler = Scheduler::Create(
+      /*num_workers=*/4,
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int depth) {
+        if (depth < kDepth) {
+          scheduler->Schedule({depth + 1, depth + 1});
+        }
+        counter.DecrementCount();
+      });
+  scheduler->Schedule({0});
+  counter.Wait();
+}
+
+TEST(WorkStealingSchedulerTest, IdleWorkersSteal) {
+  constexpr int kNumWorkers = 4;
+  thread::ThreadPool pool(Env::Default(), "test", kNumWorkers);
+  // All values land on a single deque, so every worker but one must steal to
+  // get past the barrier.
+  BlockingCounter barrier(kNumWorkers);
+  BlockingCounter done(kNumWorkers);
+  std::shared_ptr<Scheduler> scheduler = Scheduler::Create(
+      kNumWorkers,
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int) {
+        barrier.DecrementCount();
+        barrier.Wait();
+        done.DecrementCount();
+      });
+  scheduler->Schedule({0, 1, 2, 3});
+  done.Wait();
+}
+
+TEST(WorkStealingSchedulerTest, OutlivesCreator) {
+  thread::ThreadPool pool(Env::Default(), "test", 2);
+  BlockingCounter counter(100);
+  {
+    std::shared_ptr<Scheduler> scheduler = Scheduler::Create(
+        /*num_workers=*/2,
+        [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+        [&](int) { counter.DecrementCount(); });
+    std::vector<int> values(100);
+    scheduler->Schedule(values);
+  }
+  counter.Wait();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -61,6 +61,9 @@ class Flags {
                   "propagated during while op lowering to switch/merge ops.")
   TF_DECLARE_FLAG(enable_tf2min_ici_weight, false,
                   "If true, ici weight optimization will be used in tf2/min.")
+  TF_DECLARE_FLAG(deduplicate_partitioned_embedding_ids, false,
+                  "If true, lookups into partitioned embeddings fetch each "
+                  "distinct id from its partition only once.")
   // LINT.ThenChange(//tensorflow/core/config/flags_api_wrapper.cc)
 };
 
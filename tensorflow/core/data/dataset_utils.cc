@@ -91,6 +91,7 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapAndBatchVectorizationOpt[] = "map_and_batch_vectorization";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -161,6 +162,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapAndBatchFusionOpt);
     }
   }
+  if (optimization_options.optional_map_and_batch_vectorization_case() ==
+      OptimizationOptions::kMapAndBatchVectorization) {
+    if (optimization_options.map_and_batch_vectorization()) {
+      optimization_enabled->insert(kMapAndBatchVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapAndBatchVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_map_and_filter_fusion_case() ==
       OptimizationOptions::kMapAndFilterFusion) {
     if (optimization_options.map_and_filter_fusion()) {
@@ -807,69 +816,82 @@ Status CopyBatch(AnyContext ctx,
           component_index);
     }
   }
+  // Builds each output tuple component by copying one slice from each input
+  // element in the batch. Copies are numbered component by component.
+  const int64_t num_copies = num_tuple_components * num_batch_elements;
+  auto copy_element_fn = [num_batch_elements, &batch_elements,
+                          out_tensors](int64_t copy_index) {
+    const size_t component_index = copy_index / num_batch_elements;
+    const int64_t index = copy_index % num_batch_elements;
+    const TensorShape& first_element_shape =
+        batch_elements.at(0)[component_index].shape();
+    if (batch_elements.at(index)[component_index].shape() !=
+        first_element_shape) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different shapes in component ",
+          component_index, ". First element had shape ",
+          first_element_shape.DebugString(), " and element ", index,
+          " had shape ",
+          batch_elements.at(index)[component_index].shape().DebugString(),
+          ".");
+    }
+    return batch_util::CopyElementToSlice(
+        std::move(batch_elements.at(index)[component_index]),
+        &out_tensors->at(component_index), index);
+  };
+  int64_t total_bytes = 0;
   for (size_t component_index = 0; component_index < num_tuple_components;
        ++component_index) {
-    Tensor& batch_component = out_tensors->at(component_index);
-    const Tensor& first_element = batch_elements.at(0)[component_index];
-    TensorShape first_element_shape(first_element.shape());
-    // Build the output tuple component by copying one slice from each input
-    // element in the batch.
-    auto copy_element_fn = [component_index, &batch_elements, &batch_component,
-                            &first_element_shape](int index) {
-      if (batch_elements.at(index)[component_index].shape() !=
-          first_element_shape) {
-        return errors::InvalidArgument(
-            "Cannot batch tensors with different shapes in component ",
-            component_index, ". First element had shape ",
-            first_element_shape.DebugString(), " and element ", index,
-            " had shape ",
-            batch_elements.at(index)[component_index].shape().DebugString(),
-            ".");
-      }
-      return batch_util::CopyElementToSlice(
-          std::move(batch_elements.at(index)[component_index]),
-          &batch_component, index);
-    };
-    const auto total_bytes =
-        first_element.AllocatedBytes() * num_batch_elements;
-    // Use parallelism for creating the batch as long as the final batch is at
-    // least 1MB.
-    if (parallel_copy && total_bytes >= (1 << 20)) {
-      Status status;
-      mutex status_mu;
-      const auto num_threads = ctx.runner_threadpool_size;
-      const auto slice_size = num_batch_elements / num_threads;
-      int64_t offset = 0;
-      BlockingCounter counter(num_threads);
-      for (size_t i = 0; i < num_threads; ++i) {
-        int64_t length = slice_size;
-        // When the number of threads does not divide the number of elements
-        // evenly, the size of some slices is incremented to guarantee their
-        // sizes add up to the total number of elements.
-        if (i < num_batch_elements % num_threads) ++length;
-        (*ctx.runner)([offset, length, &status, &status_mu, &counter,
-                       &copy_element_fn]() {
-          Status s;
-          for (size_t j = offset; j < offset + length; ++j) {
-            s.Update(copy_element_fn(j));
-          }
-          {
-            mutex_lock l(status_mu);
-            status.Update(s);
-          }
-          counter.DecrementCount();
-        });
-        offset += length;
+    total_bytes += batch_elements.at(0)[component_index].AllocatedBytes() *
+                   num_batch_elements;
+  }
+  // Use parallelism for creating the batch as long as the final batch is at
+  // least 1MB.
+  if (!parallel_copy || total_bytes < (1 << 20)) {
+    for (int64_t i = 0; i < num_copies; ++i) {
+      TF_RETURN_IF_ERROR(copy_element_fn(i));
+    }
+    return absl::OkStatus();
+  }
+
+  // All components are copied in one round of shards of about the same number
+  // of bytes, so that large components are split across threads and small
+  // ones don't each wait for a round of their own.
+  const int64_t num_shards = std::max<int64_t>(
+      1, std::min<int64_t>(ctx.runner_threadpool_size, num_copies));
+  const int64_t bytes_per_shard = (total_bytes + num_shards - 1) / num_shards;
+  std::vector<int64_t> shard_starts = {0};
+  int64_t shard_bytes = 0;
+  for (int64_t i = 0; i < num_copies; ++i) {
+    if (shard_bytes >= bytes_per_shard &&
+        shard_starts.size() < static_cast<size_t>(num_shards)) {
+      shard_starts.push_back(i);
+      shard_bytes = 0;
+    }
+    shard_bytes +=
+        batch_elements.at(0)[i / num_batch_elements].AllocatedBytes();
+  }
+  shard_starts.push_back(num_copies);
+
+  Status status;
+  mutex status_mu;
+  BlockingCounter counter(shard_starts.size() - 1);
+  for (size_t i = 0; i + 1 < shard_starts.size(); ++i) {
+    (*ctx.runner)([begin = shard_starts[i], end = shard_starts[i + 1], &status,
+                   &status_mu, &counter, &copy_element_fn]() {
+      Status s;
+      for (int64_t j = begin; j < end; ++j) {
+        s.Update(copy_element_fn(j));
       }
-      counter.Wait();
-      TF_RETURN_IF_ERROR(status);
-    } else {
-      for (size_t i = 0; i < num_batch_elements; ++i) {
-        TF_RETURN_IF_ERROR(copy_element_fn(i));
+      {
+        mutex_lock l(status_mu);
+        status.Update(s);
       }
-    }
+      counter.DecrementCount();
+    });
   }
-  return absl::OkStatus();
+  counter.Wait();
+  return status;
 }
 
 absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
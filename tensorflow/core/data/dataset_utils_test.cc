@@ -227,6 +227,35 @@ TEST(DatasetUtilsTest, MakeNestedIteratorContext) {
   EXPECT_TRUE(nested_ctx.split_providers().empty());
 }
 
+TEST(DatasetUtilsTest, CopyBatchInParallel) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  IteratorContext iter_ctx(IteratorContext::Params(test_ctx->op_ctx()));
+  // The large component makes the batch big enough to be copied in parallel.
+  constexpr int64_t kBatchSize = 8;
+  constexpr int64_t kLargeComponentSize = 64 << 10;
+  std::vector<std::vector<Tensor>> batch_elements;
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    Tensor large(DT_FLOAT, TensorShape({kLargeComponentSize}));
+    large.flat<float>().setConstant(i);
+    batch_elements.push_back({CreateTensor<int64_t>(TensorShape{}, {i}),
+                              std::move(large),
+                              CreateTensor<tstring>(TensorShape{}, {"a"})});
+  }
+
+  std::vector<Tensor> batch;
+  TF_ASSERT_OK(CopyBatch(AnyContext(&iter_ctx), std::move(batch_elements),
+                         /*parallel_copy=*/true, &batch));
+  ASSERT_EQ(batch.size(), 3);
+  EXPECT_EQ(batch[1].shape(), TensorShape({kBatchSize, kLargeComponentSize}));
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(batch[0].vec<int64_t>()(i), i);
+    EXPECT_EQ(batch[1].matrix<float>()(i, 0), i);
+    EXPECT_EQ(batch[1].matrix<float>()(i, kLargeComponentSize - 1), i);
+    EXPECT_EQ(batch[2].vec<tstring>()(i), "a");
+  }
+}
+
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_0",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_1",
@@ -350,13 +350,12 @@ Status VariantTensorDataWriter::WriteTensor(StringPiece name, StringPiece key,
 
 void VariantTensorDataWriter::MaybeFlush() {
   if (is_flushed_) return;
-  for (auto& keys : keys_) {
-    const string name = keys.first;
+  for (const auto& [name, keys] : keys_) {
     string metadata = name;
-    for (size_t i = 0; i < keys_[name].size(); ++i) {
-      strings::StrAppend(&metadata, kDelimiter, keys_[name][i]);
+    for (const string& key : keys) {
+      strings::StrAppend(&metadata, kDelimiter, key);
     }
-    data_[name]->set_metadata(metadata);
+    data_[name]->set_metadata(std::move(metadata));
   }
   is_flushed_ = true;
 }
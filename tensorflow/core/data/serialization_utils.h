@@ -174,6 +174,9 @@ class IteratorStateVariant {
  public:
   IteratorStateVariant() = default;
   IteratorStateVariant(const IteratorStateVariant& other);
+  // Moves the state without copying it, so it should be preferred when
+  // `other` is no longer needed.
+  IteratorStateVariant(IteratorStateVariant&& other) = default;
   IteratorStateVariant& operator=(IteratorStateVariant&& other) = default;
   IteratorStateVariant& operator=(const IteratorStateVariant& other) = delete;
 
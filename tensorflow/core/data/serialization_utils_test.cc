@@ -305,6 +305,19 @@ TEST_P(ParemeterizedCheckpointIndicesTest,
   }
 }
 
+TEST(SerializationUtilsTest, IteratorStateVariantMoveKeepsData) {
+  auto data = std::make_unique<VariantTensorData>();
+  *data->add_tensors() = CreateTensor<int64_t>(TensorShape{1}, {1});
+  const VariantTensorData* data_ptr = data.get();
+  IteratorStateVariant state;
+  TF_ASSERT_OK(state.InitializeFromVariantData(std::move(data)));
+
+  Variant variant = std::move(state);
+  const auto* moved = variant.get<IteratorStateVariant>();
+  ASSERT_NE(moved, nullptr);
+  EXPECT_EQ(moved->GetData(), data_ptr);
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedIteratorStateVariantTest,
                          ::testing::ValuesIn(TestCases()));
 
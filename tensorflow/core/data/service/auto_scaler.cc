@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -206,6 +207,21 @@ absl::Status MultipleIterationsAutoScaler::UnregisterIteration(
 
 absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
     int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+  absl::StatusOr<int64_t> bound_optimal_number_of_workers =
+      GetBoundedOptimalNumberOfWorkers(current_number_of_workers);
+  if (!bound_optimal_number_of_workers.ok()) {
+    return bound_optimal_number_of_workers.status();
+  }
+
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
+      *bound_optimal_number_of_workers);
+
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t>
+MultipleIterationsAutoScaler::GetBoundedOptimalNumberOfWorkers(
+    int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_) {
   if (current_number_of_workers <= 0)
     return absl::InvalidArgumentError(
         "The current number of workers must be positive");
@@ -214,8 +230,8 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       GetOptimalNumberOfWorkers();
   if (!optimal_number_of_workers)
     return absl::UnavailableError(
-        "Cannot update the optimal number of workers metric because there are "
-        "no reported processing and target processing times for at least one "
+        "Cannot estimate the optimal number of workers because there are no "
+        "reported processing and target processing times for at least one "
         "iteration");
 
   VLOG(3) << "Estimated optimal number of workers: "
@@ -235,11 +251,7 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       std::min(bound_optimal_number_of_workers, int64_t{100000});
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
-
-  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
-      bound_optimal_number_of_workers);
-
-  return absl::OkStatus();
+  return bound_optimal_number_of_workers;
 }
 
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
@@ -311,5 +323,59 @@ absl::Status MultipleIterationsAutoScaler::RemoveConsumer(int64_t iteration_id,
   return status;
 }
 
+WorkerScalingPolicy::WorkerScalingPolicy(const Options& options)
+    : options_(options) {}
+
+int64_t WorkerScalingPolicy::Clamp(int64_t number_of_workers) const {
+  number_of_workers =
+      std::max(number_of_workers, std::max(options_.min_workers, int64_t{1}));
+  if (options_.max_workers > 0) {
+    number_of_workers = std::min(number_of_workers, options_.max_workers);
+  }
+  return number_of_workers;
+}
+
+int64_t WorkerScalingPolicy::Update(int64_t current_number_of_workers,
+                                    std::optional<int64_t> estimate) {
+  if (!target_.has_value()) {
+    target_ = Clamp(current_number_of_workers);
+  }
+  if (!estimate.has_value()) {
+    direction_ = 0;
+    num_consecutive_estimates_ = 0;
+    return *target_;
+  }
+
+  const int64_t clamped_estimate = Clamp(*estimate);
+  const double target = static_cast<double>(*target_);
+  int direction = 0;
+  if (clamped_estimate > target * (1.0 + options_.tolerance)) {
+    direction = 1;
+  } else if (clamped_estimate < target * (1.0 - options_.tolerance)) {
+    direction = -1;
+  }
+  if (direction == 0 || direction != direction_) {
+    direction_ = direction;
+    num_consecutive_estimates_ = 0;
+    conservative_estimate_ = clamped_estimate;
+  }
+  if (direction == 0) {
+    return *target_;
+  }
+
+  ++num_consecutive_estimates_;
+  conservative_estimate_ =
+      direction > 0 ? std::min(conservative_estimate_, clamped_estimate)
+                    : std::max(conservative_estimate_, clamped_estimate);
+  if (num_consecutive_estimates_ >= options_.num_confirmations) {
+    VLOG(1) << "Changing the target number of tf.data service workers from "
+            << *target_ << " to " << conservative_estimate_;
+    target_ = conservative_estimate_;
+    direction_ = 0;
+    num_consecutive_estimates_ = 0;
+  }
+  return *target_;
+}
+
 }  // namespace data
 }  // namespace tensorflow
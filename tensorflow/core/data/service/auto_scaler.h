@@ -22,6 +22,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
@@ -126,6 +127,11 @@ class MultipleIterationsAutoScaler {
   // iteration, or `current_number_of_workers` is not positive.
   absl::Status UpdateOptimalNumberOfWorkersMetric(
       int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers, limited as the metric
+  // value exported by `UpdateOptimalNumberOfWorkersMetric`. Returns an error in
+  // the same cases.
+  absl::StatusOr<int64_t> GetBoundedOptimalNumberOfWorkers(
+      int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_);
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times for at least one iteration, returns nullopt.
@@ -173,6 +179,48 @@ class MultipleIterationsAutoScaler {
       TF_GUARDED_BY(mu_);
 };
 
+// Turns the noisy estimates of the optimal number of workers into a stable
+// target number of workers for the cluster.
+//
+// The target only changes once `num_confirmations` consecutive estimates are
+// on the same side of the band of +/- `tolerance` (relative) around it. It
+// then moves to the most conservative of those estimates: the smallest one
+// when scaling up and the largest one when scaling down. Estimates, and thus
+// the target, are clamped to [`min_workers`, `max_workers`].
+//
+// WorkerScalingPolicy is not thread-safe.
+class WorkerScalingPolicy {
+ public:
+  struct Options {
+    double tolerance = 0.1;
+    int64_t num_confirmations = 3;
+    int64_t min_workers = 1;
+    // No upper bound if not positive.
+    int64_t max_workers = 0;
+  };
+
+  explicit WorkerScalingPolicy(const Options& options);
+
+  // Records the latest `estimate` of the optimal number of workers, if any,
+  // and returns the target number of workers. The target starts at
+  // `current_number_of_workers`.
+  int64_t Update(int64_t current_number_of_workers,
+                 std::optional<int64_t> estimate);
+
+ private:
+  int64_t Clamp(int64_t number_of_workers) const;
+
+  const Options options_;
+  std::optional<int64_t> target_;
+  // 1 if the latest estimates are above the band around the target, -1 if
+  // they are below it, 0 if the latest estimate is within the band.
+  int direction_ = 0;
+  // Number of consecutive estimates in `direction_`, and the most
+  // conservative of them.
+  int64_t num_consecutive_estimates_ = 0;
+  int64_t conservative_estimate_ = 0;
+};
+
 }  // namespace data
 }  // namespace tensorflow
 
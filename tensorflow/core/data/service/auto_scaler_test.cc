@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
 #include <optional>
 
 #include "absl/time/time.h"
@@ -27,6 +28,7 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
 TEST(AutoScalerTest, GetOptimalNumberOfWorkersInitialState) {
@@ -743,6 +745,71 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest, GetBoundedOptimalNumberOfWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(2),
+              StatusIs(absl::StatusCode::kUnavailable));
+
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(1)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  // Estimated workers = 10, limited to 4 * 2 = 8.
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(2), IsOkAndHolds(8));
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(5),
+              IsOkAndHolds(10));
+}
+
+TEST(WorkerScalingPolicyTest, TargetStartsAtCurrentNumberOfWorkers) {
+  WorkerScalingPolicy policy({});
+  EXPECT_EQ(policy.Update(5, std::nullopt), 5);
+  EXPECT_EQ(policy.Update(7, std::nullopt), 5);
+}
+
+TEST(WorkerScalingPolicyTest, ScalesUpAfterConsistentEstimates) {
+  WorkerScalingPolicy policy({/*tolerance=*/0.1, /*num_confirmations=*/3});
+  EXPECT_EQ(policy.Update(10, 20), 10);
+  EXPECT_EQ(policy.Update(10, 16), 10);
+  // Scales to the smallest of the estimates.
+  EXPECT_EQ(policy.Update(10, 30), 16);
+}
+
+TEST(WorkerScalingPolicyTest, ScalesDownAfterConsistentEstimates) {
+  WorkerScalingPolicy policy({/*tolerance=*/0.1, /*num_confirmations=*/2});
+  EXPECT_EQ(policy.Update(10, 4), 10);
+  // Scales to the largest of the estimates.
+  EXPECT_EQ(policy.Update(10, 6), 6);
+}
+
+TEST(WorkerScalingPolicyTest, IgnoresEstimatesWithinTolerance) {
+  WorkerScalingPolicy policy({/*tolerance=*/0.2, /*num_confirmations=*/2});
+  for (int64_t estimate : {11, 12, 9, 8, 12}) {
+    EXPECT_EQ(policy.Update(10, estimate), 10);
+  }
+}
+
+TEST(WorkerScalingPolicyTest, DoesNotFlap) {
+  WorkerScalingPolicy policy({/*tolerance=*/0.1, /*num_confirmations=*/2});
+  for (int64_t estimate : {20, 5, 20, 5, 20, 5}) {
+    EXPECT_EQ(policy.Update(10, estimate), 10);
+  }
+  // Missing estimates also restart the confirmations.
+  EXPECT_EQ(policy.Update(10, 20), 10);
+  EXPECT_EQ(policy.Update(10, std::nullopt), 10);
+  EXPECT_EQ(policy.Update(10, 20), 10);
+  EXPECT_EQ(policy.Update(10, 20), 20);
+}
+
+TEST(WorkerScalingPolicyTest, ClampsTarget) {
+  WorkerScalingPolicy policy({/*tolerance=*/0.1, /*num_confirmations=*/1,
+                              /*min_workers=*/2, /*max_workers=*/8});
+  EXPECT_EQ(policy.Update(4, 100), 8);
+  EXPECT_EQ(policy.Update(8, 100), 8);
+  EXPECT_EQ(policy.Update(8, 1), 2);
+}
+
 }  // namespace
 
 }  // namespace data
@@ -0,0 +1,208 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/columnar_elements.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+size_t AlignedSize(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+size_t NumBytes(DataType dtype, const TensorShape& shape) {
+  return shape.num_elements() * DataTypeSize(dtype);
+}
+
+// Owns the data of a column, and keeps it alive while tensors share it.
+class ColumnData : public core::RefCounted {
+ public:
+  explicit ColumnData(std::string data) : data_(std::move(data)) {
+    base_ = data_.data();
+    if (reinterpret_cast<uintptr_t>(base_) % kAlignment != 0) {
+      // Tensors are expected to be aligned, so copy misaligned data into an
+      // aligned allocation.
+      aligned_copy_ = Tensor(
+          DT_UINT8, TensorShape({static_cast<int64_t>(data_.size())}));
+      std::memcpy(aligned_copy_.data(), data_.data(), data_.size());
+      base_ = static_cast<char*>(aligned_copy_.data());
+      std::string().swap(data_);
+    }
+  }
+
+  char* base() const { return base_; }
+
+ private:
+  std::string data_;
+  Tensor aligned_copy_;
+  char* base_ = nullptr;
+};
+
+// Backs a tensor with a slice of the data of a column.
+class ColumnSliceBuffer : public TensorBuffer {
+ public:
+  ColumnSliceBuffer(core::RefCountPtr<ColumnData> column, size_t offset,
+                    size_t size)
+      : TensorBuffer(column->base() + offset),
+        column_(std::move(column)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ColumnarElements");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  // Keeps the data `data()` points into alive.
+  const core::RefCountPtr<ColumnData> column_;
+  const size_t size_;
+};
+
+}  // namespace
+
+bool IsColumnarCompatible(const std::vector<Tensor>& element) {
+  if (element.empty()) {
+    return false;
+  }
+  for (const Tensor& component : element) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ColumnarElementSize(const std::vector<Tensor>& element) {
+  size_t size = 0;
+  for (const Tensor& component : element) {
+    size += component.TotalBytes();
+  }
+  return size;
+}
+
+absl::Status AppendToColumnarElements(const std::vector<Tensor>& element,
+                                      int64_t element_index,
+                                      ColumnarElements& batch) {
+  if (!IsColumnarCompatible(element)) {
+    return absl::InvalidArgumentError(
+        "Only elements whose components have memcpy-able dtypes can be "
+        "batched in a columnar layout.");
+  }
+  if (batch.columns().empty()) {
+    for (const Tensor& component : element) {
+      batch.add_columns()->set_dtype(component.dtype());
+    }
+  }
+  if (batch.columns_size() != element.size()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Expected an element with ", batch.columns_size(),
+        " components in the columnar batch, got ", element.size(), "."));
+  }
+  for (int i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    ColumnarElements::Column& column = *batch.mutable_columns(i);
+    if (column.dtype() != component.dtype()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Expected component ", i, " of the element to have dtype ",
+          DataTypeString(column.dtype()), ", got ",
+          DataTypeString(component.dtype()), "."));
+    }
+    std::string& data = *column.mutable_data();
+    data.resize(AlignedSize(data.size()), '\0');
+    column.add_offsets(data.size());
+    component.shape().AsProto(column.add_shapes());
+    absl::string_view bytes = component.tensor_data();
+    data.append(bytes.data(), bytes.size());
+  }
+  batch.add_element_indices(element_index);
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarElementsToTensors(
+    ColumnarElements& batch, std::vector<std::vector<Tensor>>& elements) {
+  const int64_t num_elements = batch.element_indices_size();
+  elements.clear();
+  elements.resize(num_elements);
+  for (ColumnarElements::Column& column : *batch.mutable_columns()) {
+    if (column.shapes_size() != num_elements ||
+        column.offsets_size() != num_elements) {
+      return absl::InternalError(absl::StrCat(
+          "Invalid columnar elements: expected ", num_elements,
+          " shapes and offsets, got ", column.shapes_size(), " and ",
+          column.offsets_size(), "."));
+    }
+    if (!DataTypeCanUseMemcpy(column.dtype())) {
+      return absl::InternalError(
+          absl::StrCat("Invalid columnar elements: unexpected dtype ",
+                       DataTypeString(column.dtype()), "."));
+    }
+    const size_t data_size = column.data().size();
+    core::RefCountPtr<ColumnData> data(
+        new ColumnData(std::move(*column.mutable_data())));
+    for (int64_t i = 0; i < num_elements; ++i) {
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(
+          TensorShape::BuildTensorShape(column.shapes(i), &shape));
+      const size_t offset = column.offsets(i);
+      const size_t num_bytes = NumBytes(column.dtype(), shape);
+      if (offset > data_size || num_bytes > data_size - offset) {
+        return absl::InternalError(absl::StrCat(
+            "Invalid columnar elements: component of ", num_bytes,
+            " bytes at offset ", offset, " exceeds the ", data_size,
+            " bytes of the column."));
+      }
+      if (num_bytes == 0) {
+        elements[i].emplace_back(column.dtype(), shape);
+        continue;
+      }
+      core::RefCountPtr<TensorBuffer> buffer(
+          new ColumnSliceBuffer(data.GetNewRef(), offset, num_bytes));
+      elements[i].emplace_back(column.dtype(), std::move(shape),
+                               std::move(buffer));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_COLUMNAR_ELEMENTS_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_COLUMNAR_ELEMENTS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns true if `element` can be added to a `ColumnarElements` batch, i.e.
+// if all its components have memcpy-able dtypes.
+bool IsColumnarCompatible(const std::vector<Tensor>& element);
+
+// Returns the number of bytes `AppendToColumnarElements` adds to a batch for
+// `element`, excluding padding.
+size_t ColumnarElementSize(const std::vector<Tensor>& element);
+
+// Appends `element`, which has index `element_index` within its task, to
+// `batch`. Returns an error if `element` is not columnar-compatible or if its
+// dtypes differ from those of the elements already in `batch`.
+absl::Status AppendToColumnarElements(const std::vector<Tensor>& element,
+                                      int64_t element_index,
+                                      ColumnarElements& batch);
+
+// Moves the elements out of `batch` into `elements`. The tensors share the
+// data of `batch` rather than copying it, unless it is misaligned.
+absl::Status ColumnarElementsToTensors(
+    ColumnarElements& batch, std::vector<std::vector<Tensor>>& elements);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_COLUMNAR_ELEMENTS_H_
@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/columnar_elements.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<float>({1.0f * i, 2.0f * i, 3.0f * i}, {3}),
+          Tensor(DT_INT32, TensorShape({0, 2}))};
+}
+
+TEST(ColumnarElementsTest, RoundTrip) {
+  constexpr int64_t kNumElements = 5;
+  ColumnarElements batch;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    TF_ASSERT_OK(AppendToColumnarElements(MakeElement(i),
+                                          /*element_index=*/10 + i, batch));
+  }
+  ASSERT_EQ(batch.columns_size(), 3);
+  for (const auto& column : batch.columns()) {
+    for (uint64_t offset : column.offsets()) {
+      EXPECT_EQ(offset % Allocator::kAllocatorAlignment, 0);
+    }
+  }
+  EXPECT_EQ(batch.element_indices_size(), kNumElements);
+  EXPECT_EQ(batch.element_indices(0), 10);
+
+  std::vector<std::vector<Tensor>> elements;
+  TF_ASSERT_OK(ColumnarElementsToTensors(batch, elements));
+  ASSERT_EQ(elements.size(), kNumElements);
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    std::vector<Tensor> expected = MakeElement(i);
+    ASSERT_EQ(elements[i].size(), expected.size());
+    for (int j = 0; j < expected.size(); ++j) {
+      test::ExpectEqual(elements[i][j], expected[j]);
+      EXPECT_TRUE(elements[i][j].IsAligned());
+    }
+  }
+}
+
+TEST(ColumnarElementsTest, TensorsOutliveBatch) {
+  std::vector<std::vector<Tensor>> elements;
+  {
+    ColumnarElements batch;
+    TF_ASSERT_OK(AppendToColumnarElements(MakeElement(7),
+                                          /*element_index=*/0, batch));
+    TF_ASSERT_OK(ColumnarElementsToTensors(batch, elements));
+  }
+  ASSERT_EQ(elements.size(), 1);
+  test::ExpectEqual(elements[0][1], MakeElement(7)[1]);
+}
+
+TEST(ColumnarElementsTest, IsColumnarCompatible) {
+  EXPECT_TRUE(IsColumnarCompatible(MakeElement(0)));
+  EXPECT_FALSE(IsColumnarCompatible({}));
+  EXPECT_FALSE(IsColumnarCompatible(
+      {test::AsScalar<int64_t>(0), test::AsScalar<tstring>("string")}));
+}
+
+TEST(ColumnarElementsTest, StringComponent) {
+  ColumnarElements batch;
+  EXPECT_THAT(AppendToColumnarElements({test::AsScalar<tstring>("string")},
+                                       /*element_index=*/0, batch),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ColumnarElementsTest, MismatchedDtypes) {
+  ColumnarElements batch;
+  TF_ASSERT_OK(AppendToColumnarElements({test::AsScalar<int64_t>(0)},
+                                        /*element_index=*/0, batch));
+  EXPECT_THAT(AppendToColumnarElements({test::AsScalar<float>(0)},
+                                       /*element_index=*/1, batch),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(
+      AppendToColumnarElements(
+          {test::AsScalar<int64_t>(0), test::AsScalar<int64_t>(1)},
+          /*element_index=*/1, batch),
+      StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(ColumnarElementsTest, InvalidOffset) {
+  ColumnarElements batch;
+  TF_ASSERT_OK(AppendToColumnarElements({test::AsScalar<int64_t>(0)},
+                                        /*element_index=*/0, batch));
+  batch.mutable_columns(0)->set_offsets(0, 1024);
+  std::vector<std::vector<Tensor>> elements;
+  EXPECT_THAT(ColumnarElementsToTensors(batch, elements),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -24,13 +24,20 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -46,6 +53,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements falling out of the in-memory window are spilled to
+// local disk, bounded by a second budget, so that slower trainers keep reading
+// them instead of skipping ahead. Each trainer reads spilled elements through
+// its own cursor, and the element after the one it reads is read back from
+// disk in the background.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -89,6 +102,27 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes and deserializes elements spilled to disk. Only called if the
+  // cache spills elements, possibly concurrently with `GetNext`.
+  virtual StatusOr<std::string> Serialize(const ElementType&) const {
+    return errors::Unimplemented(
+        "Spilling is not supported by this cross-trainer cache sequence.");
+  }
+  virtual StatusOr<ElementType> Deserialize(absl::string_view) const {
+    return errors::Unimplemented(
+        "Spilling is not supported by this cross-trainer cache sequence.");
+  }
+};
+
+// Options for spilling elements evicted from the memory of a
+// `CrossTrainerCache` to local disk.
+struct CrossTrainerCacheSpillOptions {
+  // Directory under which spilled elements are written. Spilling is disabled
+  // if empty.
+  std::string directory;
+  // Maximum total size of the spilled elements in bytes, as serialized.
+  size_t max_spill_size_bytes = 0;
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -100,8 +134,9 @@ class CrossTrainerCache {
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
-  virtual ~CrossTrainerCache() = default;
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      CrossTrainerCacheSpillOptions spill_options = {});
+  virtual ~CrossTrainerCache();
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
 
@@ -126,6 +161,28 @@ class CrossTrainerCache {
     bool cache_hit;
   };
 
+  // An element evicted from `cache_` to disk.
+  struct SpilledElement {
+    // Pending writes hold a reference, so the file is complete or absent.
+    ~SpilledElement() { Env::Default()->DeleteFile(path).IgnoreError(); }
+
+    std::string path;
+    // The element, kept in memory until it is written.
+    std::shared_ptr<const ElementType> element;
+    size_t size_bytes = 0;
+    // True if the element could not be written, and is skipped by readers.
+    bool lost = false;
+    // True once the element is removed from `spilled_`.
+    bool evicted = false;
+  };
+
+  // A spilled element read from disk ahead of a trainer's next request.
+  struct ReadBack {
+    size_t index = 0;
+    Notification done;
+    StatusOr<std::shared_ptr<const ElementType>> element;
+  };
+
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
@@ -152,6 +209,27 @@ class CrossTrainerCache {
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
 
+  // Returns true if evicted elements are spilled to disk.
+  bool SpillEnabled() const { return spill_thread_pool_ != nullptr; }
+
+  // Returns the spilled element at `element_index` for `trainer_id` and starts
+  // reading back the next one. Returns nullptr if the element was lost.
+  // May release `mu_` while reading from disk.
+  StatusOr<std::shared_ptr<const ElementType>> GetSpilledElement(
+      const std::string& trainer_id, size_t element_index);
+
+  // Writes `spilled` to disk and releases its in-memory copy.
+  void WriteSpilledElement(std::shared_ptr<SpilledElement> spilled);
+
+  // Reads `spilled` from memory if it is not written yet, otherwise from disk.
+  // Returns nullptr if the element was lost.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      const SpilledElement& spilled);
+
+  // Drops the oldest spilled elements to keep the spilled size below
+  // `CrossTrainerCacheSpillOptions::max_spill_size_bytes`.
+  void FreeSpillSpace();
+
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
 
@@ -178,18 +256,77 @@ class CrossTrainerCache {
   // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
+
+  // The spilling configuration, with `directory` private to this cache.
+  CrossTrainerCacheSpillOptions spill_options_;
+
+  // `spilled_` stores the elements evicted from `cache_`, i.e. the elements
+  // with indices [spill_start_index_, cache_start_index_).
+  std::deque<std::shared_ptr<SpilledElement>> spilled_ TF_GUARDED_BY(mu_);
+  size_t spill_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t spill_start_index_ TF_GUARDED_BY(mu_) = 0;
+
+  // Maps trainer IDs to the spilled element being read ahead for them.
+  absl::flat_hash_map<std::string, std::shared_ptr<ReadBack>> read_backs_
+      TF_GUARDED_BY(mu_);
+
+  // Writes and reads back spilled elements. Null iff spilling is disabled.
+  // Declared last so that pending work finishes before the cache is destroyed.
+  std::unique_ptr<thread::ThreadPool> spill_thread_pool_;
 };
 
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    CrossTrainerCacheSpillOptions spill_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_options_(std::move(spill_options)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+  if (spill_options_.directory.empty()) {
+    return;
+  }
+  // Each cache spills into its own directory, as several tasks may share the
+  // configured one.
+  spill_options_.directory = io::JoinPath(
+      spill_options_.directory,
+      absl::StrCat("cross_trainer_cache_", random::New64()));
+  Status s = Env::Default()->RecursivelyCreateDir(spill_options_.directory);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to create tf.data service cross-trainer cache "
+                 << "spill directory " << spill_options_.directory
+                 << ". Elements evicted from memory will not be spilled: "
+                 << s;
+    return;
+  }
+  spill_thread_pool_ = std::make_unique<thread::ThreadPool>(
+      Env::Default(), "tf_data_cross_trainer_cache_spill", /*num_threads=*/2);
+  VLOG(2) << "tf.data service cross-trainer cache spills up to "
+          << ByteSize::Bytes(spill_options_.max_spill_size_bytes) << " to "
+          << spill_options_.directory << ".";
+}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::~CrossTrainerCache() {
+  if (!SpillEnabled()) {
+    return;
+  }
+  // Waits for pending writes and read-backs, then deletes the spilled files.
+  spill_thread_pool_.reset();
+  {
+    mutex_lock l(mu_);
+    spilled_.clear();
+    read_backs_.clear();
+  }
+  int64_t undeleted_files = 0, undeleted_dirs = 0;
+  Env::Default()
+      ->DeleteRecursively(spill_options_.directory, &undeleted_files,
+                          &undeleted_dirs)
+      .IgnoreError();
 }
 
 template <class ElementType>
@@ -216,6 +353,15 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
+        const size_t element_index = GetElementIndex(trainer_id);
+        if (element_index < cache_start_index_) {
+          TF_ASSIGN_OR_RETURN(
+              std::shared_ptr<const ElementType> element,
+              GetSpilledElement(trainer_id, element_index));
+          // A lost element is skipped, as if it had been discarded.
+          if (element == nullptr) continue;
+          return CacheQueryResult{element, /*is_cache_hit=*/true};
+        }
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
@@ -271,12 +417,124 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  const size_t start_index =
+      spilled_.empty() ? cache_start_index_ : spill_start_index_;
+  if (element_index < start_index) {
+    element_index = start_index;
   }
   return element_index;
 }
 
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::GetSpilledElement(const std::string& trainer_id,
+                                                  size_t element_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::shared_ptr<SpilledElement> spilled =
+      spilled_[element_index - spill_start_index_];
+  trainer_to_element_index_map_[trainer_id] = element_index + 1;
+
+  std::shared_ptr<ReadBack> read_back;
+  auto it = read_backs_.find(trainer_id);
+  if (it != read_backs_.end()) {
+    if (it->second->index == element_index) {
+      read_back = std::move(it->second);
+    }
+    read_backs_.erase(it);
+  }
+  // Starts reading the trainer's next element if it is also on disk.
+  if (element_index + 1 < cache_start_index_) {
+    std::shared_ptr<SpilledElement> next =
+        spilled_[element_index + 1 - spill_start_index_];
+    auto next_read_back = std::make_shared<ReadBack>();
+    next_read_back->index = element_index + 1;
+    read_backs_[trainer_id] = next_read_back;
+    spill_thread_pool_->Schedule([this, next, next_read_back]() {
+      next_read_back->element = ReadSpilledElement(*next);
+      next_read_back->done.Notify();
+    });
+  }
+  if (spilled->element != nullptr) {
+    return spilled->element;
+  }
+
+  // Reads from disk without holding the lock. `spilled` keeps the file alive.
+  mu_.unlock();
+  StatusOr<std::shared_ptr<const ElementType>> result;
+  if (read_back != nullptr) {
+    read_back->done.WaitForNotification();
+    result = std::move(read_back->element);
+  } else {
+    result = ReadSpilledElement(*spilled);
+  }
+  mu_.lock();
+  return result;
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(
+    const SpilledElement& spilled) TF_LOCKS_EXCLUDED(mu_) {
+  {
+    mutex_lock l(mu_);
+    if (spilled.element != nullptr) {
+      return spilled.element;
+    }
+    if (spilled.lost) {
+      return std::shared_ptr<const ElementType>();
+    }
+  }
+  std::string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), spilled.path, &data));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->Deserialize(data));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::WriteSpilledElement(
+    std::shared_ptr<SpilledElement> spilled) TF_LOCKS_EXCLUDED(mu_) {
+  std::shared_ptr<const ElementType> element;
+  {
+    mutex_lock l(mu_);
+    element = spilled->element;
+  }
+  StatusOr<std::string> data = cachable_sequence_->Serialize(*element);
+  Status s = data.status();
+  if (s.ok()) {
+    s = WriteStringToFile(Env::Default(), spilled->path, *data);
+  }
+
+  mutex_lock l(mu_);
+  if (s.ok()) {
+    if (!spilled->evicted) {
+      spilled->size_bytes = data->size();
+      spill_size_bytes_ += spilled->size_bytes;
+    }
+  } else {
+    LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache "
+                 << "element to " << spilled->path << ": " << s;
+    spilled->lost = true;
+  }
+  spilled->element.reset();
+  FreeSpillSpace();
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::FreeSpillSpace()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  while (!spilled_.empty() &&
+         spill_size_bytes_ > spill_options_.max_spill_size_bytes) {
+    spilled_.front()->evicted = true;
+    spill_size_bytes_ -= spilled_.front()->size_bytes;
+    spilled_.pop_front();
+    ++spill_start_index_;
+  }
+  if (spilled_.empty()) {
+    spill_start_index_ = cache_start_index_;
+  }
+}
+
 template <class ElementType>
 Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(ElementType element, cachable_sequence_->GetNext());
@@ -305,6 +563,18 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    if (SpillEnabled()) {
+      if (spilled_.empty()) {
+        spill_start_index_ = cache_start_index_;
+      }
+      auto spilled = std::make_shared<SpilledElement>();
+      spilled->path = io::JoinPath(spill_options_.directory,
+                                   absl::StrCat("element_", cache_start_index_));
+      spilled->element = std::move(cache_.front());
+      spilled_.push_back(spilled);
+      spill_thread_pool_->Schedule(
+          [this, spilled]() { WriteSpilledElement(spilled); });
+    }
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
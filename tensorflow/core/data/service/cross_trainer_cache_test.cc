@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -61,6 +63,20 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+class SpillableRange : public InfiniteRange {
+ public:
+  absl::StatusOr<std::string> Serialize(const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+  absl::StatusOr<int64_t> Deserialize(absl::string_view data) const override {
+    int64_t element;
+    if (!absl::SimpleAtoi(data, &element)) {
+      return errors::DataLoss("Invalid spilled element: ", data);
+    }
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   absl::StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -190,6 +206,34 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCacheSpillOptions spill_options;
+  spill_options.directory = testing::TmpDir();
+  spill_options.max_spill_size_bytes = 1024;
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableRange>(), spill_options);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer 1"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(0)));
+
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainers read the elements evicted from memory from disk, each
+  // at its own pace.
+  for (int i = 1; i < 50; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer 1"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 50; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer 1"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
@@ -127,13 +127,15 @@ Status DataServiceDispatcherClient::GetDatasetDef(const std::string& dataset_id,
   return absl::OkStatus();
 }
 
-Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
+Status DataServiceDispatcherClient::GetSplit(const std::string& worker_address,
+                                             int64_t iteration_id,
                                              int64_t repetition,
                                              int64_t split_provider_index,
                                              Tensor& split,
                                              bool& end_of_splits) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetSplitRequest req;
+  req.set_worker_address(worker_address);
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
@@ -380,6 +382,18 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetScalingRecommendation(
+    GetScalingRecommendationResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetScalingRecommendationRequest request;
+  grpc::Status s = stub_->GetScalingRecommendation(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get scaling recommendation", s);
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
@@ -62,8 +62,10 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
-  Status GetSplit(int64_t iteration_id, int64_t repetition,
+  // provider index. `worker_address` is the address of the requesting worker,
+  // or empty if unknown.
+  Status GetSplit(const std::string& worker_address, int64_t iteration_id,
+                  int64_t repetition,
                   int64_t split_provider_index, Tensor& split,
                   bool& end_of_splits);
 
@@ -137,6 +139,10 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Returns the number of workers the cluster should be scaled to, and the
+  // workers which can be removed.
+  Status GetScalingRecommendation(GetScalingRecommendationResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -185,6 +185,14 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
   }
   return new_config;
 }
+
+WorkerScalingPolicy::Options GetWorkerScalingPolicyOptions(
+    const DispatcherConfig& config) {
+  WorkerScalingPolicy::Options options;
+  options.min_workers = config.autoscaling_min_workers();
+  options.max_workers = config.autoscaling_max_workers();
+  return options;
+}
 }  // namespace
 
 DataServiceDispatcherImpl::DataServiceDispatcherImpl(
@@ -192,7 +200,8 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     : config_(ApplyConfigDefaults(config)),
       env_(Env::Default()),
       snapshot_assignment_manager_(config_.worker_max_concurrent_snapshots()),
-      state_(config_) {
+      state_(config_),
+      worker_scaling_policy_(GetWorkerScalingPolicyOptions(config_)) {
   if (config_.work_dir().empty()) {
     dataset_store_ = std::make_unique<MemoryDatasetStore>();
   } else {
@@ -231,8 +240,8 @@ Status DataServiceDispatcherImpl::Start() {
     started_ = true;
     return absl::OkStatus();
   }
-  journal_writer_ =
-      std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir()));
+  journal_writer_ = std::make_unique<GroupCommitJournalWriter>(
+      env_, JournalDir(config_.work_dir()));
   LOG(INFO) << "Attempting to restore dispatcher state from journal in "
             << JournalDir(config_.work_dir());
   Update update;
@@ -302,6 +311,24 @@ void DataServiceDispatcherImpl::Stop() TF_LOCKS_EXCLUDED(mu_) {
   for (SnapshotManager* snapshot_manager : snapshot_managers) {
     snapshot_manager->Cancel();
   }
+
+  Status s = SyncJournal();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to sync the dispatcher journal: " << s;
+  }
+}
+
+Status DataServiceDispatcherImpl::SyncJournal() TF_LOCKS_EXCLUDED(mu_) {
+  JournalWriter* journal_writer = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (!journal_writer_.has_value()) {
+      return absl::OkStatus();
+    }
+    // The writer lives as long as the dispatcher once set by `Start`.
+    journal_writer = journal_writer_->get();
+  }
+  return journal_writer->Sync();
 }
 
 size_t DataServiceDispatcherImpl::NumActiveIterations() TF_LOCKS_EXCLUDED(mu_) {
@@ -370,7 +397,8 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !draining_workers_.contains(worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -535,6 +563,8 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   mutex_lock l(get_split_mu_);
   int64_t current_repetition = 0;
   SplitProvider* split_provider = nullptr;
+  LocalityAwareSplitAssigner* split_assigner = nullptr;
+  std::vector<std::string> worker_tags;
   {
     mutex_lock l(mu_);
     std::shared_ptr<const Iteration> iteration;
@@ -554,6 +584,16 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
       return absl::OkStatus();
     }
     split_provider = split_providers_[iteration_id][provider_index].get();
+    if (config_.split_locality_lookahead() > 0 &&
+        !config_.fault_tolerant_mode()) {
+      // Splits are only journaled by count, so they are restored in order.
+      split_assigner = GetOrCreateSplitAssigner(iteration_id, provider_index);
+      std::shared_ptr<const Worker> worker;
+      if (!request->worker_address().empty() &&
+          state_.WorkerFromAddress(request->worker_address(), worker).ok()) {
+        worker_tags = worker->tags;
+      }
+    }
   }
   if (request->repetition() > current_repetition) {
     // This could happen if an iterator is repeated before reaching end of
@@ -561,16 +601,23 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
     // the previous repetitions as completed and advance to the requested
     // repetition.
     TF_RETURN_IF_ERROR(split_provider->Reset());
+    if (split_assigner != nullptr) split_assigner->Reset();
   }
   Tensor split;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  if (split_assigner != nullptr) {
+    TF_RETURN_IF_ERROR(split_assigner->GetNext(
+        request->worker_address(), worker_tags, &split, &end_of_splits));
+  } else {
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  }
   TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
                                          provider_index, end_of_splits));
   response->set_end_of_splits(end_of_splits);
   if (end_of_splits) {
     // Reset the split provider to prepare for the next iteration.
     TF_RETURN_IF_ERROR(split_provider->Reset());
+    if (split_assigner != nullptr) split_assigner->Reset();
   } else {
     split.AsProtoTensorContent(response->mutable_split());
   }
@@ -579,6 +626,26 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   return absl::OkStatus();
 }
 
+LocalityAwareSplitAssigner*
+DataServiceDispatcherImpl::GetOrCreateSplitAssigner(int64_t iteration_id,
+                                                    int64_t provider_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::unique_ptr<LocalityAwareSplitAssigner>>& split_assigners =
+      split_assigners_[iteration_id];
+  if (split_assigners.empty()) {
+    absl::flat_hash_map<std::string, std::string> file_locality_tags(
+        config_.file_locality_tags().begin(),
+        config_.file_locality_tags().end());
+    for (const std::unique_ptr<SplitProvider>& split_provider :
+         split_providers_[iteration_id]) {
+      split_assigners.push_back(std::make_unique<LocalityAwareSplitAssigner>(
+          split_provider.get(), config_.split_locality_lookahead(),
+          file_locality_tags));
+    }
+  }
+  return split_assigners[provider_index].get();
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -939,6 +1006,9 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (draining_workers_.contains(worker->address)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1304,6 +1374,32 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetScalingRecommendation(
+    const GetScalingRecommendationRequest* request,
+    GetScalingRecommendationResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  if (!WorkerAutoscalingEnabled()) {
+    return errors::FailedPrecondition(
+        "Scaling recommendations require setting `worker_autoscaling` in the "
+        "dispatcher config, and workers registering dynamically.");
+  }
+  mutex_lock l(mu_);
+  const int64_t num_workers = latest_worker_heartbeats_time_.size();
+  response->set_current_num_workers(num_workers);
+  response->set_target_num_workers(target_num_workers_ > 0 ? target_num_workers_
+                                                           : num_workers);
+  std::vector<std::string> draining_workers(draining_workers_.begin(),
+                                            draining_workers_.end());
+  std::sort(draining_workers.begin(), draining_workers.end());
+  for (const std::string& worker_address : draining_workers) {
+    response->add_draining_workers(worker_address);
+    if (NumUnfinishedTasks(worker_address) == 0) {
+      response->add_removable_workers(worker_address);
+    }
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1404,6 +1500,9 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
                 << s;
       }
     }
+    if (WorkerAutoscalingEnabled()) {
+      UpdateWorkerScaling();
+    }
     {
       Status s = GcOldIterations();
       if (!s.ok()) {
@@ -1486,6 +1585,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      draining_workers_.erase(it->first);
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
@@ -1494,6 +1594,63 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
   }
 }
 
+bool DataServiceDispatcherImpl::WorkerAutoscalingEnabled() const {
+  // Statically sharded iterations need a task on every configured worker.
+  return config_.worker_autoscaling() && config_.worker_addresses().empty();
+}
+
+int64_t DataServiceDispatcherImpl::NumUnfinishedTasks(
+    const std::string& worker_address) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return 0;
+  }
+  return absl::c_count_if(tasks, [](const std::shared_ptr<const Task>& task) {
+    return !task->finished && !task->removed && !task->iteration->finished;
+  });
+}
+
+void DataServiceDispatcherImpl::UpdateWorkerScaling()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t num_workers = latest_worker_heartbeats_time_.size();
+  if (num_workers == 0) {
+    return;
+  }
+  absl::StatusOr<int64_t> estimate =
+      auto_scaler_.GetBoundedOptimalNumberOfWorkers(num_workers);
+  target_num_workers_ = worker_scaling_policy_.Update(
+      num_workers,
+      estimate.ok() ? std::make_optional(*estimate) : std::nullopt);
+
+  // Drains the least loaded workers above the target, so that they become
+  // removable as early as possible, and resumes the most loaded ones first
+  // when the target grows again.
+  const int64_t num_to_drain =
+      std::max<int64_t>(0, num_workers - target_num_workers_);
+  std::vector<std::pair<int64_t, std::string>> draining;
+  std::vector<std::pair<int64_t, std::string>> active;
+  for (const auto& [worker_address, unused] : latest_worker_heartbeats_time_) {
+    auto& workers =
+        draining_workers_.contains(worker_address) ? draining : active;
+    workers.emplace_back(NumUnfinishedTasks(worker_address), worker_address);
+  }
+  std::sort(draining.begin(), draining.end());
+  std::sort(active.begin(), active.end());
+  while (static_cast<int64_t>(draining.size()) > num_to_drain) {
+    VLOG(1) << "Resuming task creation on tf.data service worker "
+            << draining.back().second;
+    draining_workers_.erase(draining.back().second);
+    draining.pop_back();
+  }
+  for (const auto& [num_tasks, worker_address] : active) {
+    if (static_cast<int64_t>(draining_workers_.size()) >= num_to_drain) {
+      break;
+    }
+    VLOG(1) << "Draining tf.data service worker " << worker_address;
+    draining_workers_.insert(worker_address);
+  }
+}
+
 Status DataServiceDispatcherImpl::GcOldIterations()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Iteration>> iterations =
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
+#include "tensorflow/core/data/service/split_provider.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -148,6 +149,11 @@ class DataServiceDispatcherImpl {
   // Returns the number of active iterations.
   size_t NumActiveIterations() TF_LOCKS_EXCLUDED(mu_);
 
+  // Blocks until the updates journaled so far are durable. The journal syncs
+  // concurrent updates together, so RPC handlers call this after their
+  // request is handled, once `mu_` is released, and before responding.
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_);
+
   // See dispatcher.proto for API documentation.
 
   /// Worker-facing API.
@@ -188,6 +194,9 @@ class DataServiceDispatcherImpl {
   Status DisableCompressionAtRuntime(
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
+  Status GetScalingRecommendation(
+      const GetScalingRecommendationRequest* request,
+      GetScalingRecommendationResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -203,6 +212,12 @@ class DataServiceDispatcherImpl {
       const DispatcherState::Iteration& iteration,
       std::vector<std::unique_ptr<SplitProvider>>& restored)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the locality-aware assigner of the splits of split provider
+  // `provider_index` of iteration `iteration_id`, creating the assigners of the
+  // iteration if needed.
+  LocalityAwareSplitAssigner* GetOrCreateSplitAssigner(int64_t iteration_id,
+                                                       int64_t provider_index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Makes split providers for the specified `dataset_id`, and stores them in
   // `split_providers`.
   Status MakeSplitProviders(
@@ -332,6 +347,15 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if `worker_autoscaling` is enabled and applies to this
+  // deployment.
+  bool WorkerAutoscalingEnabled() const;
+  // Updates `target_num_workers_` from the latest AutoScaler estimate, and
+  // drains or stops draining live workers to match it.
+  void UpdateWorkerScaling() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the number of tasks of unfinished iterations on the worker.
+  int64_t NumUnfinishedTasks(const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -366,6 +390,12 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Mapping from iteration id to the locality-aware assigners of the splits of
+  // its split providers, if `split_locality_lookahead` is set. Only used while
+  // holding `get_split_mu_`.
+  absl::flat_hash_map<int64_t,
+                      std::vector<std::unique_ptr<LocalityAwareSplitAssigner>>>
+      split_assigners_ TF_GUARDED_BY(mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats,
   // and may be stale.
@@ -396,6 +426,13 @@ class DataServiceDispatcherImpl {
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
+  // Stabilizes the AutoScaler estimates when `worker_autoscaling` is enabled.
+  WorkerScalingPolicy worker_scaling_policy_ TF_GUARDED_BY(mu_);
+  // Latest target of `worker_scaling_policy_`, 0 until the first update.
+  int64_t target_num_workers_ TF_GUARDED_BY(mu_) = 0;
+  // Workers above the target, which don't get tasks of new iterations. Not
+  // journaled: after a restart, draining starts over from the next update.
+  absl::flat_hash_set<std::string> draining_workers_ TF_GUARDED_BY(mu_);
 
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
@@ -45,11 +45,15 @@ DispatcherStateExport GrpcDispatcherImpl::ExportState() const {
   return impl_.ExportState();
 }
 
+// Responses are only sent once the updates journaled so far are durable, so
+// that they never reflect dispatcher state that a restart could lose.
 #define HANDLER(method)                                                   \
   grpc::Status GrpcDispatcherImpl::method(ServerContext* context,         \
                                           const method##Request* request, \
                                           method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));                 \
+    Status s = impl_.method(request, response);                           \
+    s.Update(impl_.SyncJournal());                                        \
+    return ToGrpcStatus(s);                                               \
   }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
@@ -69,6 +73,7 @@ HANDLER(Snapshot);
 HANDLER(GetSnapshotSplit);
 HANDLER(GetSnapshotStreams);
 HANDLER(DisableCompressionAtRuntime);
+HANDLER(GetScalingRecommendation);
 #undef HANDLER
 
 }  // namespace data
@@ -63,6 +63,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetSnapshotSplit);
   HANDLER(GetSnapshotStreams);
   HANDLER(DisableCompressionAtRuntime);
+  HANDLER(GetScalingRecommendation);
 #undef HANDLER
 
  private:
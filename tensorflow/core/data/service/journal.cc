@@ -18,15 +18,18 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
 
@@ -77,21 +80,103 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  return WriteBatch(absl::MakeConstSpan(&update, 1));
+}
+
+Status FileJournalWriter::WriteBatch(absl::Span<const Update> updates) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
-  std::string s = update.SerializeAsString();
-  if (s.empty()) {
-    return errors::Internal("Failed to serialize update ", update.DebugString(),
-                            " to string");
+  for (const Update& update : updates) {
+    std::string s = update.SerializeAsString();
+    if (s.empty()) {
+      return errors::Internal("Failed to serialize update ",
+                              update.DebugString(), " to string");
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   }
-  TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   TF_RETURN_IF_ERROR(writer_->Flush());
   TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
-    VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    for (const Update& update : updates) {
+      VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    }
+  }
+  return absl::OkStatus();
+}
+
+GroupCommitJournalWriter::GroupCommitJournalWriter(
+    Env* env, const std::string& journal_dir)
+    : env_(env), writer_(env, journal_dir) {}
+
+GroupCommitJournalWriter::~GroupCommitJournalWriter() {
+  std::unique_ptr<Thread> journal_thread;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+    journal_thread = std::move(journal_thread_);
+  }
+  // Joins the thread after it writes the remaining updates.
+  journal_thread.reset();
+}
+
+Status GroupCommitJournalWriter::EnsureInitialized() {
+  mutex_lock l(mu_);
+  return EnsureInitializedLocked();
+}
+
+Status GroupCommitJournalWriter::EnsureInitializedLocked() {
+  if (journal_thread_) {
+    return absl::OkStatus();
   }
+  TF_RETURN_IF_ERROR(writer_.EnsureInitialized());
+  journal_thread_ = absl::WrapUnique(env_->StartThread(
+      {}, "tf_data_journal", [this] { JournalThread(); }));
   return absl::OkStatus();
 }
 
+Status GroupCommitJournalWriter::Write(const Update& update) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(status_);
+  TF_RETURN_IF_ERROR(EnsureInitializedLocked());
+  pending_updates_.push_back(update);
+  ++num_written_;
+  cv_.notify_all();
+  return absl::OkStatus();
+}
+
+Status GroupCommitJournalWriter::Sync() {
+  mutex_lock l(mu_);
+  const int64_t num_written = num_written_;
+  while (status_.ok() && num_synced_ < num_written) {
+    cv_.wait(l);
+  }
+  return status_;
+}
+
+void GroupCommitJournalWriter::JournalThread() {
+  while (true) {
+    std::vector<Update> updates;
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && pending_updates_.empty()) {
+        cv_.wait(l);
+      }
+      if (pending_updates_.empty()) {
+        return;
+      }
+      updates.swap(pending_updates_);
+    }
+    Status s = writer_.WriteBatch(updates);
+    mutex_lock l(mu_);
+    if (!s.ok() && status_.ok()) {
+      LOG(ERROR) << "Failed to write to the tf.data service journal: " << s;
+      status_ = s;
+    }
+    num_synced_ += updates.size();
+    cv_.notify_all();
+  }
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
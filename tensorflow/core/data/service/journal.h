@@ -15,14 +15,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -35,10 +40,13 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
 class JournalWriter {
  public:
   virtual ~JournalWriter() = default;
-  // Writes and syncs an update to the journal.
+  // Writes an update to the journal. The update is durable once `Write`
+  // returns, or for writers that sync asynchronously, once `Sync` returns.
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Blocks until all updates written before the call are durable.
+  virtual Status Sync() { return absl::OkStatus(); }
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -69,6 +77,9 @@ class FileJournalWriter : public JournalWriter {
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
 
+  // Writes `updates` and syncs them together.
+  Status WriteBatch(absl::Span<const Update> updates);
+
  private:
   Env* env_;
   const std::string journal_dir_;
@@ -76,6 +87,46 @@ class FileJournalWriter : public JournalWriter {
   std::unique_ptr<io::RecordWriter> writer_;
 };
 
+// GroupCommitJournalWriter is thread-safe.
+//
+// GroupCommitJournalWriter writes the same journal files as FileJournalWriter,
+// but `Write` only queues an update. A journal thread writes all the updates
+// queued while it synced the previous ones and syncs them together, so that
+// concurrent writers share the latency of a sync. Writers call `Sync` to wait
+// until their updates are durable.
+class GroupCommitJournalWriter : public JournalWriter {
+ public:
+  explicit GroupCommitJournalWriter(Env* env, const std::string& journal_dir);
+  // Waits for the queued updates to be synced.
+  ~GroupCommitJournalWriter() override;
+  GroupCommitJournalWriter(const GroupCommitJournalWriter&) = delete;
+  GroupCommitJournalWriter& operator=(const GroupCommitJournalWriter&) =
+      delete;
+
+  Status Write(const Update& update) override;
+  Status EnsureInitialized() override;
+  Status Sync() override;
+
+ private:
+  Status EnsureInitializedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void JournalThread();
+
+  Env* env_;
+  // Only used by the journal thread once it is started.
+  FileJournalWriter writer_;
+
+  mutex mu_;
+  condition_variable cv_;
+  std::vector<Update> pending_updates_ TF_GUARDED_BY(mu_);
+  // Number of updates written and synced since the writer was created.
+  int64_t num_written_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_synced_ TF_GUARDED_BY(mu_) = 0;
+  // The first error of the journal thread, returned by all later calls.
+  Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> journal_thread_ TF_GUARDED_BY(mu_);
+};
+
 // Interface for reading from a journal.
 class JournalReader {
  public:
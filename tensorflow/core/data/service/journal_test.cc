@@ -115,6 +115,59 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, WriteBatch) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.WriteBatch(updates));
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, GroupCommitConcurrentWrites) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  constexpr int kNumThreads = 8;
+  constexpr int kNumUpdatesPerThread = 20;
+  GroupCommitJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.EnsureInitialized());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+          ThreadOptions(), "writer", [&writer] {
+            for (int j = 0; j < kNumUpdatesPerThread; ++j) {
+              TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+              TF_EXPECT_OK(writer.Sync());
+            }
+          })));
+    }
+  }
+
+  // All updates are durable once their writers' `Sync` calls returned.
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, std::vector<Update>(kNumThreads * kNumUpdatesPerThread,
+                                       MakeFinishTaskUpdate())));
+}
+
+TEST(Journal, GroupCommitAppendExistingJournal) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  for (const auto& update : updates) {
+    // The writer writes its queued updates when it is destroyed.
+    GroupCommitJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(update));
+  }
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
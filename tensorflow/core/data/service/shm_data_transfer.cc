@@ -0,0 +1,787 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/random.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Initial and maximum sizes of the segment each client shares with the
+// server. Clients grow their segment when it is too small to hold an element,
+// in which case the element is sent through the socket instead.
+constexpr size_t kInitialSegmentSize = 16 << 20;  // 16 MiB
+constexpr size_t kMaxSegmentSize = 1 << 30;       // 1 GiB
+// Maximum sizes of the frames read by the server (the handshake and
+// `GetElementRequest`s) and by the client (responses, which may hold inlined
+// tensors), so that a bogus size cannot make either end allocate unbounded
+// memory.
+constexpr uint64_t kMaxRequestFrameSize = 1 << 20;             // 1 MiB
+constexpr uint64_t kMaxResponseFrameSize = uint64_t{1} << 32;  // 4 GiB
+// Alignment of tensors in the segment.
+constexpr size_t kSegmentAlignment = 64;
+// Number of random ports `ShmDataTransferServer::Start` tries to bind.
+constexpr int kMaxBindAttempts = 100;
+constexpr int kMaxRandomPort = 1 << 30;
+
+// How a component of an element is sent to the client.
+enum ComponentEncoding : uint32_t {
+  // Raw tensor contents, in the shared memory segment.
+  kSegment = 0,
+  // Raw tensor contents, in the response header.
+  kInline = 1,
+  // A serialized `CompressedElement`, in the response header.
+  kCompressed = 2,
+  // A serialized `TensorProto`, in the response header.
+  kTensorProto = 3,
+};
+
+size_t RoundUp(size_t offset) {
+  return (offset + kSegmentAlignment - 1) / kSegmentAlignment *
+         kSegmentAlignment;
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+absl::Status ErrnoStatus(absl::string_view context) {
+  return errors::Unavailable(context, ": ", std::strerror(errno));
+}
+
+Status WriteAll(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = send(fd, data.data(), data.size(), kSendFlags);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoStatus("Failed to write to shm data transfer socket");
+    }
+    data.remove_prefix(written);
+  }
+  return absl::OkStatus();
+}
+
+Status ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t read = recv(fd, data, size, 0);
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoStatus("Failed to read from shm data transfer socket");
+    }
+    if (read == 0) {
+      return errors::Unavailable("Shm data transfer socket was closed.");
+    }
+    data += read;
+    size -= read;
+  }
+  return absl::OkStatus();
+}
+
+// Frames are sent as their native-endian 64-bit size followed by their
+// contents; both ends of the socket run on the same host.
+Status WriteFrame(int fd, absl::string_view frame) {
+  const uint64_t size = frame.size();
+  TF_RETURN_IF_ERROR(WriteAll(
+      fd,
+      absl::string_view(reinterpret_cast<const char*>(&size), sizeof(size))));
+  return WriteAll(fd, frame);
+}
+
+Status ReadFrame(int fd, uint64_t max_size, std::string& frame) {
+  uint64_t size = 0;
+  TF_RETURN_IF_ERROR(ReadAll(fd, reinterpret_cast<char*>(&size), sizeof(size)));
+  if (size > max_size) {
+    return errors::InvalidArgument("Shm data transfer frame of ", size,
+                                   " bytes exceeds the limit of ", max_size,
+                                   " bytes.");
+  }
+  frame.resize(size);
+  return ReadAll(fd, frame.data(), size);
+}
+
+void PutLengthPrefixed(std::string& dst, absl::string_view value) {
+  core::PutVarint64(&dst, value.size());
+  dst.append(value.data(), value.size());
+}
+
+bool GetLengthPrefixed(absl::string_view& input, absl::string_view& value) {
+  uint64_t size = 0;
+  if (!core::GetVarint64(&input, &size) || size > input.size()) return false;
+  value = input.substr(0, size);
+  input.remove_prefix(size);
+  return true;
+}
+
+// A header starts with the status of the request, followed by the element if
+// it succeeded.
+std::string EncodeStatus(const Status& status) {
+  std::string header;
+  core::PutVarint32(&header, static_cast<uint32_t>(status.code()));
+  if (!status.ok()) PutLengthPrefixed(header, status.message());
+  return header;
+}
+
+Status DecodeStatus(absl::string_view& header) {
+  uint32_t code = 0;
+  if (!core::GetVarint32(&header, &code)) {
+    return errors::Internal("Failed to parse shm data transfer response.");
+  }
+  if (code == static_cast<uint32_t>(absl::StatusCode::kOk)) {
+    return absl::OkStatus();
+  }
+  absl::string_view message;
+  if (!GetLengthPrefixed(header, message)) {
+    return errors::Internal("Failed to parse shm data transfer response.");
+  }
+  return Status(static_cast<absl::StatusCode>(code), message);
+}
+
+void SetCloseOnExec(int fd) { fcntl(fd, F_SETFD, FD_CLOEXEC); }
+
+absl::StatusOr<int> ParsePort(absl::string_view address) {
+  int port = 0;
+  size_t colon = address.rfind(':');
+  if (colon == absl::string_view::npos ||
+      !absl::SimpleAtoi(address.substr(colon + 1), &port) || port <= 0) {
+    return errors::InvalidArgument(
+        "Expected the address of an shm data transfer server to be of the "
+        "form <host>:<port>, but got ",
+        address);
+  }
+  return port;
+}
+
+Status MakeSocketAddress(int port, sockaddr_un& addr) {
+  const std::string path = ShmSocketPath(port);
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return errors::InvalidArgument("Shm data transfer socket path ", path,
+                                   " is too long.");
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return absl::OkStatus();
+}
+
+// Returns true if nothing listens on the socket file at `addr`, e.g. because
+// it was left behind by a worker that crashed.
+bool IsStaleSocket(const sockaddr_un& addr) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  const bool stale = connect(fd, reinterpret_cast<const sockaddr*>(&addr),
+                             sizeof(addr)) != 0 &&
+                     errno == ECONNREFUSED;
+  close(fd);
+  return stale;
+}
+
+}  // namespace
+
+std::string ShmSocketPath(int port) {
+  return absl::StrCat("/tmp/tf_data_service_shm.", port, ".sock");
+}
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element)
+    : get_element_(std::move(get_element)) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    // Wakes up the threads blocked on the sockets.
+    if (listen_fd_ >= 0) shutdown(listen_fd_, SHUT_RDWR);
+    for (int fd : connection_fds_) shutdown(fd, SHUT_RDWR);
+  }
+  accept_thread_.reset();
+  {
+    mutex_lock l(mu_);
+    connection_threads.swap(connection_threads_);
+  }
+  connection_threads.clear();
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    unlink(ShmSocketPath(port_).c_str());
+  }
+}
+
+Status ShmDataTransferServer::Start(const experimental::WorkerConfig& config) {
+  if (listen_fd_ >= 0) {
+    return errors::FailedPrecondition(
+        "Shm data transfer server has already been started.");
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return ErrnoStatus("Failed to create shm data transfer socket");
+  SetCloseOnExec(fd);
+  const int attempts = config.port() > 0 ? 1 : kMaxBindAttempts;
+  int port = -1;
+  for (int i = 0; i < attempts && port < 0; ++i) {
+    const int candidate =
+        config.port() > 0 ? config.port()
+                          : 1 + random::New64() % (kMaxRandomPort - 1);
+    sockaddr_un addr;
+    Status s = MakeSocketAddress(candidate, addr);
+    if (!s.ok()) {
+      close(fd);
+      return s;
+    }
+    bool bound =
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    if (!bound && errno == EADDRINUSE && IsStaleSocket(addr)) {
+      unlink(addr.sun_path);
+      bound = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    if (bound) {
+      port = candidate;
+    } else if (errno != EADDRINUSE) {
+      break;
+    }
+  }
+  if (port < 0) {
+    Status s = ErrnoStatus("Failed to bind shm data transfer socket");
+    close(fd);
+    return s;
+  }
+  if (listen(fd, SOMAXCONN) != 0) {
+    Status s = ErrnoStatus("Failed to listen on shm data transfer socket");
+    close(fd);
+    unlink(ShmSocketPath(port).c_str());
+    return s;
+  }
+  listen_fd_ = fd;
+  port_ = port;
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_service_shm_accept", [this] { AcceptConnections(); }));
+  VLOG(2) << "Started shm data transfer server at " << ShmSocketPath(port_);
+  return absl::OkStatus();
+}
+
+int ShmDataTransferServer::Port() const { return port_; }
+
+absl::StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo()
+    const {
+  return port::Hostname();
+}
+
+void ShmDataTransferServer::AcceptConnections() {
+  while (true) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    // Declared before `l`, so that the reaped threads are joined after `mu_`
+    // is released.
+    std::vector<std::unique_ptr<Thread>> finished_threads;
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      if (fd >= 0) close(fd);
+      return;
+    }
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      LOG(ERROR) << ErrnoStatus("Failed to accept shm data transfer client");
+      return;
+    }
+    SetCloseOnExec(fd);
+    // Reaps the threads of the connections that were closed since the last
+    // one was accepted.
+    for (int64_t id : finished_connections_) {
+      auto it = connection_threads_.find(id);
+      finished_threads.push_back(std::move(it->second));
+      connection_threads_.erase(it);
+    }
+    finished_connections_.clear();
+    const int64_t id = next_connection_id_++;
+    connection_fds_.insert(fd);
+    // `ServeConnection` reports its end under `mu_`, so its thread is
+    // registered before it can be marked as finished.
+    connection_threads_[id] = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_service_shm_connection",
+        [this, fd, id] { ServeConnection(fd, id); }));
+  }
+}
+
+void ShmDataTransferServer::ServeConnection(int fd, int64_t id) {
+  char* segment = nullptr;
+  uint64_t segment_size = 0;
+  // The client starts by sending the size and name of its segment.
+  std::string frame;
+  Status s = ReadFrame(fd, kMaxRequestFrameSize, frame);
+  if (s.ok()) {
+    absl::string_view input = frame;
+    absl::string_view name;
+    if (!core::GetVarint64(&input, &segment_size) ||
+        !GetLengthPrefixed(input, name)) {
+      s = errors::InvalidArgument(
+          "Failed to parse shm data transfer handshake.");
+    } else {
+      int shm_fd = shm_open(std::string(name).c_str(), O_RDWR, 0);
+      struct stat info;
+      if (shm_fd < 0 || fstat(shm_fd, &info) != 0) {
+        s = ErrnoStatus(absl::StrCat("Failed to open shared memory ", name));
+      } else if (segment_size != static_cast<uint64_t>(info.st_size)) {
+        // Writing past the end of the segment would raise SIGBUS in the
+        // worker, so its size must match the one the client claims.
+        s = errors::InvalidArgument("Shared memory ", name, " holds ",
+                                    info.st_size, " bytes, but the client "
+                                    "claims ", segment_size, " bytes.");
+      } else if (segment_size == 0 || segment_size > kMaxSegmentSize) {
+        s = errors::InvalidArgument("Shared memory ", name, " holds ",
+                                    segment_size, " bytes, which is not in "
+                                    "(0, ", kMaxSegmentSize, "].");
+      } else {
+        void* data = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, shm_fd, 0);
+        if (data == MAP_FAILED) {
+          s = ErrnoStatus(absl::StrCat("Failed to map shared memory ", name));
+        } else {
+          segment = static_cast<char*>(data);
+        }
+      }
+      if (shm_fd >= 0) close(shm_fd);
+    }
+    if (WriteFrame(fd, EncodeStatus(s)).ok() && s.ok()) {
+      GetElementRequest request;
+      while (ReadFrame(fd, kMaxRequestFrameSize, frame).ok()) {
+        std::string header;
+        if (!request.ParseFromString(frame)) {
+          header = EncodeStatus(
+              errors::InvalidArgument("Failed to parse GetElementRequest."));
+        } else if (Status status =
+                       GetElement(request, segment, segment_size, header);
+                   !status.ok()) {
+          header = EncodeStatus(status);
+        }
+        if (!WriteFrame(fd, header).ok()) break;
+      }
+    }
+  }
+  if (segment != nullptr) munmap(segment, segment_size);
+  mutex_lock l(mu_);
+  connection_fds_.erase(fd);
+  close(fd);
+  if (!cancelled_) finished_connections_.push_back(id);
+}
+
+Status ShmDataTransferServer::GetElement(const GetElementRequest& request,
+                                         char* segment, size_t segment_size,
+                                         std::string& header) {
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(get_element_(&request, &result));
+  header = EncodeStatus(absl::OkStatus());
+  core::PutVarint64(&header, result.element_index);
+  core::PutVarint32(&header, result.end_of_sequence);
+  core::PutVarint32(&header, result.skip);
+  core::PutVarint64(&header, result.components.size());
+  size_t offset = 0;
+  for (const Tensor& component : result.components) {
+    core::PutVarint32(&header, component.dtype());
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      const absl::string_view data = component.tensor_data();
+      const size_t start = RoundUp(offset);
+      const bool fits = start + data.size() <= segment_size;
+      core::PutVarint32(&header, fits ? kSegment : kInline);
+      core::PutVarint32(&header, component.dims());
+      for (int64_t dim : component.shape().dim_sizes()) {
+        core::PutVarint64(&header, dim);
+      }
+      if (fits) {
+        core::PutVarint64(&header, start);
+        core::PutVarint64(&header, data.size());
+        std::memcpy(segment + start, data.data(), data.size());
+        offset = start + data.size();
+      } else {
+        PutLengthPrefixed(header, data);
+      }
+      continue;
+    }
+    const CompressedElement* compressed = nullptr;
+    if (component.dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(component.shape())) {
+      compressed = component.scalar<Variant>()().get<CompressedElement>();
+    }
+    if (compressed != nullptr) {
+      core::PutVarint32(&header, kCompressed);
+      PutLengthPrefixed(header, compressed->SerializeAsString());
+    } else {
+      TensorProto proto;
+      component.AsProtoTensorContent(&proto);
+      core::PutVarint32(&header, kTensorProto);
+      PutLengthPrefixed(header, proto.SerializeAsString());
+    }
+  }
+  return absl::OkStatus();
+}
+
+// A POSIX shared memory segment created by the client.
+class ShmDataTransferClient::Segment {
+ public:
+  static absl::StatusOr<std::unique_ptr<Segment>> Create(size_t size) {
+    const std::string name = absl::StrCat("/tf_data_service_shm.", getpid(),
+                                          ".", random::New64());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+      return ErrnoStatus(absl::StrCat("Failed to create shared memory ", name));
+    }
+    void* data = MAP_FAILED;
+#if defined(__linux__)
+    // Reserves the memory up front, so that running out of shared memory
+    // fails here instead of raising SIGBUS when the server writes to it.
+    const bool allocated = posix_fallocate(fd, 0, size) == 0;
+#else
+    const bool allocated = ftruncate(fd, size) == 0;
+#endif
+    if (allocated) {
+      data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (data == MAP_FAILED) {
+      Status s =
+          ErrnoStatus(absl::StrCat("Failed to map shared memory ", name));
+      close(fd);
+      shm_unlink(name.c_str());
+      return s;
+    }
+    close(fd);
+    return absl::WrapUnique(
+        new Segment(name, static_cast<char*>(data), size));
+  }
+
+  ~Segment() {
+    munmap(data_, size_);
+    Unlink();
+  }
+
+  // Removes the name of the segment, once the server has mapped it, so that
+  // its memory is released as soon as both ends unmap it.
+  void Unlink() {
+    if (!name_.empty()) shm_unlink(name_.c_str());
+    name_.clear();
+  }
+
+  const std::string& name() const { return name_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  Segment(std::string name, char* data, size_t size)
+      : name_(std::move(name)), data_(data), size_(size) {}
+
+  std::string name_;
+  char* const data_;
+  const size_t size_;
+};
+
+ShmDataTransferClient::ShmDataTransferClient(absl::string_view address,
+                                             Allocator* allocator)
+    : address_(address),
+      allocator_(allocator),
+      segment_size_(kInitialSegmentSize),
+      max_segment_size_(kMaxSegmentSize) {
+  VLOG(2) << "Create ShmDataTransferClient for worker " << address_ << ".";
+}
+
+ShmDataTransferClient::~ShmDataTransferClient() {
+  mutex_lock l(mu_);
+  Disconnect();
+}
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  VLOG(3) << "GetElement for task " << req.task_id() << " from shm worker "
+          << "server.";
+  mutex_lock l(mu_);
+  {
+    mutex_lock cl(cancel_mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+  }
+  TF_RETURN_IF_ERROR(EnsureConnected());
+  {
+    mutex_lock cl(cancel_mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    active_fd_ = fd_;
+  }
+  int64_t start_time_us = env_->NowMicros();
+  std::string header;
+  Status s = WriteFrame(fd_, req.SerializeAsString());
+  if (s.ok()) s = ReadFrame(fd_, kMaxResponseFrameSize, header);
+  int64_t end_time_us = env_->NowMicros();
+  bool cancelled = false;
+  {
+    mutex_lock cl(cancel_mu_);
+    active_fd_ = -1;
+    cancelled = cancelled_;
+  }
+  if (!s.ok()) {
+    Disconnect();
+    if (cancelled) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    return s;
+  }
+  metrics::RecordTFDataServiceGetElementDuration(kShmTransferProtocol,
+                                                 end_time_us - start_time_us);
+  return ParseResponse(header, result);
+}
+
+void ShmDataTransferClient::TryCancel() {
+  VLOG(2) << "Cancel ShmDataTransferClient.";
+  mutex_lock l(cancel_mu_);
+  cancelled_ = true;
+  if (active_fd_ >= 0) shutdown(active_fd_, SHUT_RDWR);
+}
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& server_compatibility_info) const {
+  const std::string hostname = port::Hostname();
+  if (server_compatibility_info != hostname) {
+    return errors::FailedPrecondition(
+        "The shm data transfer protocol requires the server to run on the "
+        "same host as the client, but the server runs on ",
+        server_compatibility_info, " and the client on ", hostname, ".");
+  }
+  // The socket may still be out of reach, e.g. from another container.
+  TF_ASSIGN_OR_RETURN(int port, ParsePort(address_));
+  struct stat info;
+  if (stat(ShmSocketPath(port).c_str(), &info) != 0) {
+    return errors::FailedPrecondition("Shm data transfer socket ",
+                                      ShmSocketPath(port),
+                                      " is not accessible: ",
+                                      std::strerror(errno));
+  }
+  return absl::OkStatus();
+}
+
+Status ShmDataTransferClient::EnsureConnected() {
+  if (fd_ >= 0) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(int port, ParsePort(address_));
+  sockaddr_un addr;
+  TF_RETURN_IF_ERROR(MakeSocketAddress(port, addr));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<Segment> segment,
+                      CreateSegment());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return ErrnoStatus("Failed to create shm data transfer socket");
+  SetCloseOnExec(fd);
+  Status s;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    s = ErrnoStatus(absl::StrCat("Failed to connect to shm data transfer "
+                                 "server at ",
+                                 ShmSocketPath(port)));
+  }
+  if (s.ok()) {
+    std::string handshake;
+    core::PutVarint64(&handshake, segment->size());
+    PutLengthPrefixed(handshake, segment->name());
+    s = WriteFrame(fd, handshake);
+  }
+  std::string response;
+  if (s.ok()) s = ReadFrame(fd, kMaxRequestFrameSize, response);
+  if (s.ok()) {
+    absl::string_view input = response;
+    s = DecodeStatus(input);
+  }
+  if (!s.ok()) {
+    close(fd);
+    return s;
+  }
+  segment->Unlink();
+  fd_ = fd;
+  segment_ = std::move(segment);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<ShmDataTransferClient::Segment>>
+ShmDataTransferClient::CreateSegment() {
+  absl::StatusOr<std::unique_ptr<Segment>> segment =
+      Segment::Create(segment_size_);
+  if (segment.ok() || segment_size_ == kInitialSegmentSize) {
+    return segment;
+  }
+  LOG(WARNING) << "Failed to grow the shm data transfer segment to "
+               << segment_size_ << " bytes, larger elements will be sent "
+               << "through the socket: " << segment.status();
+  segment_size_ = kInitialSegmentSize;
+  max_segment_size_ = kInitialSegmentSize;
+  return Segment::Create(segment_size_);
+}
+
+void ShmDataTransferClient::Disconnect() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+  segment_.reset();
+}
+
+Status ShmDataTransferClient::ParseResponse(absl::string_view header,
+                                            GetElementResult& result) {
+  TF_RETURN_IF_ERROR(DecodeStatus(header));
+  auto parse_error = [] {
+    return errors::Internal("Failed to parse shm data transfer response.");
+  };
+  uint64_t element_index = 0, num_components = 0;
+  uint32_t end_of_sequence = 0, skip = 0;
+  if (!core::GetVarint64(&header, &element_index) ||
+      !core::GetVarint32(&header, &end_of_sequence) ||
+      !core::GetVarint32(&header, &skip) ||
+      !core::GetVarint64(&header, &num_components)) {
+    return parse_error();
+  }
+  result.element_index = element_index;
+  result.end_of_sequence = end_of_sequence;
+  result.skip = skip;
+  result.components.clear();
+  result.components.reserve(num_components);
+  // Size the segment would need to hold the whole element.
+  size_t required_segment_size = 0;
+  bool inlined = false;
+  for (uint64_t i = 0; i < num_components; ++i) {
+    uint32_t dtype = 0, encoding = 0;
+    if (!core::GetVarint32(&header, &dtype) ||
+        !core::GetVarint32(&header, &encoding)) {
+      return parse_error();
+    }
+    if (encoding == kSegment || encoding == kInline) {
+      uint32_t dims = 0;
+      if (!core::GetVarint32(&header, &dims)) return parse_error();
+      TensorShape shape;
+      for (uint32_t d = 0; d < dims; ++d) {
+        uint64_t dim = 0;
+        if (!core::GetVarint64(&header, &dim)) return parse_error();
+        TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim));
+      }
+      absl::string_view data;
+      required_segment_size = RoundUp(required_segment_size);
+      if (encoding == kSegment) {
+        uint64_t offset = 0, size = 0;
+        if (!core::GetVarint64(&header, &offset) ||
+            !core::GetVarint64(&header, &size) ||
+            offset + size > segment_->size()) {
+          return parse_error();
+        }
+        data = absl::string_view(segment_->data() + offset, size);
+      } else if (!GetLengthPrefixed(header, data)) {
+        return parse_error();
+      } else {
+        inlined = true;
+      }
+      required_segment_size += data.size();
+      Tensor tensor(allocator_, static_cast<DataType>(dtype), shape);
+      if (tensor.TotalBytes() != data.size()) return parse_error();
+      std::memcpy(const_cast<char*>(tensor.tensor_data().data()), data.data(),
+                  data.size());
+      result.components.push_back(std::move(tensor));
+      continue;
+    }
+    absl::string_view serialized;
+    if (!GetLengthPrefixed(header, serialized)) return parse_error();
+    if (encoding == kCompressed) {
+      CompressedElement compressed;
+      if (!compressed.ParseFromArray(serialized.data(), serialized.size())) {
+        return parse_error();
+      }
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(compressed);
+      result.components.push_back(std::move(tensor));
+    } else if (encoding == kTensorProto) {
+      TensorProto proto;
+      Tensor tensor;
+      if (!proto.ParseFromArray(serialized.data(), serialized.size()) ||
+          !tensor.FromProto(allocator_, proto)) {
+        return errors::Internal("Failed to parse tensor.");
+      }
+      result.components.push_back(std::move(tensor));
+    } else {
+      return parse_error();
+    }
+  }
+  if (inlined && segment_size_ < max_segment_size_) {
+    // Reconnects with a larger segment on the next request.
+    segment_size_ = std::min(
+        max_segment_size_, std::max(2 * segment_size_, required_segment_size));
+    Disconnect();
+  }
+  return absl::OkStatus();
+}
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out =
+              std::make_shared<ShmDataTransferServer>(std::move(get_element));
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<ShmDataTransferClient>(config.address,
+                                                         config.allocator);
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
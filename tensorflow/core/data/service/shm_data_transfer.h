@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients running on the same host as the
+// tf.data service worker. Requests and element metadata are exchanged over a
+// Unix domain socket, while the contents of tensors with memcpy-able dtypes
+// are passed through a POSIX shared memory segment owned by each client, so
+// they are never serialized. Other components (e.g. compressed elements) are
+// sent through the socket in their serialized form.
+//
+// Clients on other hosts fail the compatibility check, so that the data
+// service client falls back to gRPC for them. Workers using this protocol
+// should set `data_transfer_address` to "<host>:%port%".
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Returns the path of the Unix domain socket an "shm" server listening on
+// `port` accepts connections on. Ports of "shm" servers only identify their
+// socket, and are unrelated to TCP ports.
+std::string ShmSocketPath(int port);
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element);
+  ~ShmDataTransferServer() override;
+
+  // Binds the socket of the server to `config.port()` if set, or to an unused
+  // port otherwise.
+  Status Start(const experimental::WorkerConfig& config) override;
+  int Port() const override;
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  void AcceptConnections();
+  // Serves the connection `id` on `fd`, until the client disconnects.
+  void ServeConnection(int fd, int64_t id);
+  // Fetches the element requested by `request` and writes its tensors to
+  // `segment`, or to the returned response header if they don't fit.
+  Status GetElement(const GetElementRequest& request, char* segment,
+                    size_t segment_size, std::string& header);
+
+  const GetElementT get_element_;
+
+  mutex mu_;
+  int listen_fd_ = -1;
+  int port_ = -1;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  absl::flat_hash_set<int> connection_fds_ TF_GUARDED_BY(mu_);
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+  // Destroying a thread joins it. The threads of closed connections are
+  // joined when the next connection is accepted, and the others when the
+  // server is destroyed.
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads_
+      TF_GUARDED_BY(mu_);
+  std::vector<int64_t> finished_connections_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> accept_thread_;
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // `address` is the "<host>:<port>" address of the server.
+  ShmDataTransferClient(absl::string_view address, Allocator* allocator);
+  ~ShmDataTransferClient() override;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+  void TryCancel() override;
+
+  // Returns an error unless the server runs on the same host as the client.
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override;
+
+ private:
+  class Segment;
+
+  // Connects to the server and shares a new segment with it.
+  Status EnsureConnected() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  absl::StatusOr<std::unique_ptr<Segment>> CreateSegment()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Disconnect() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status ParseResponse(absl::string_view header, GetElementResult& result)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string address_;
+  Allocator* const allocator_;
+
+  // Serializes requests: the segment holds a single response at a time.
+  mutex mu_;
+  int fd_ TF_GUARDED_BY(mu_) = -1;
+  std::unique_ptr<Segment> segment_ TF_GUARDED_BY(mu_);
+  size_t segment_size_ TF_GUARDED_BY(mu_);
+  size_t max_segment_size_ TF_GUARDED_BY(mu_);
+
+  // Guards `cancelled_` and `active_fd_` without waiting for in-flight
+  // requests, so that they can be cancelled.
+  mutex cancel_mu_;
+  bool cancelled_ TF_GUARDED_BY(cancel_mu_) = false;
+  int active_fd_ TF_GUARDED_BY(cancel_mu_) = -1;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,263 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+class ShmDataTransferTest : public ::testing::Test {
+ protected:
+  void StartServer(DataTransferServer::GetElementT get_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                           std::move(get_element), &server_));
+    TF_ASSERT_OK(server_->Start(experimental::WorkerConfig()));
+  }
+
+  std::unique_ptr<DataTransferClient> CreateClient() {
+    std::unique_ptr<DataTransferClient> client;
+    TF_CHECK_OK(DataTransferClient::Build(
+        kShmTransferProtocol,
+        {kShmTransferProtocol, absl::StrCat("localhost:", server_->Port()),
+         cpu_allocator()},
+        &client));
+    return client;
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+};
+
+sockaddr_un SocketAddress(int port) {
+  const std::string path = ShmSocketPath(port);
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  return addr;
+}
+
+TEST_F(ShmDataTransferTest, GetElement) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(
+        test::AsTensor<int64_t>({request->task_id(), 2, 3}, {3}));
+    result->components.push_back(test::AsTensor<tstring>({"a", "bc"}, {2}));
+    result->components.push_back(test::AsScalar<float>(1.5));
+    result->element_index = 7;
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  TF_ASSERT_OK_AND_ASSIGN(std::string info, server_->GetCompatibilityInfo());
+  TF_ASSERT_OK(client->CheckCompatibility(info));
+
+  for (int64_t task_id = 0; task_id < 3; ++task_id) {
+    GetElementRequest request;
+    request.set_task_id(task_id);
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(request, result));
+    EXPECT_EQ(result.element_index, 7);
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_FALSE(result.skip);
+    ASSERT_EQ(result.components.size(), 3);
+    test::ExpectEqual(result.components[0],
+                      test::AsTensor<int64_t>({task_id, 2, 3}, {3}));
+    test::ExpectEqual(result.components[1],
+                      test::AsTensor<tstring>({"a", "bc"}, {2}));
+    test::ExpectEqual(result.components[2], test::AsScalar<float>(1.5));
+  }
+}
+
+TEST_F(ShmDataTransferTest, CompressedElement) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    CompressedElement compressed;
+    compressed.set_data("compressed data");
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(compressed);
+    result->components.push_back(std::move(tensor));
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* compressed =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(compressed, nullptr);
+  EXPECT_EQ(compressed->data(), "compressed data");
+}
+
+TEST_F(ShmDataTransferTest, LargeElements) {
+  // Larger than the initial segment, so that the first element is sent
+  // through the socket and the following ones through a larger segment.
+  Tensor large(DT_FLOAT, TensorShape({5, 1 << 20}));
+  test::FillIota<float>(&large, 0.0f);
+  StartServer([&large](const GetElementRequest* request,
+                       GetElementResult* result) {
+    result->components.push_back(large);
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  for (int i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+    ASSERT_EQ(result.components.size(), 1);
+    test::ExpectEqual(result.components[0], large);
+  }
+}
+
+TEST_F(ShmDataTransferTest, EndOfSequence) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(ShmDataTransferTest, PropagatesErrors) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    return errors::NotFound("Task not found");
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(GetElementRequest(), result),
+              StatusIs(error::NOT_FOUND, "Task not found"));
+}
+
+TEST_F(ShmDataTransferTest, Cancel) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(test::AsScalar<int64_t>(1));
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  client->TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(GetElementRequest(), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST_F(ShmDataTransferTest, IncompatibleHost) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    return absl::OkStatus();
+  });
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  EXPECT_THAT(client->CheckCompatibility("some-other-host"),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+TEST_F(ShmDataTransferTest, ReplacesStaleSocket) {
+  // Leaves a socket file nothing listens on, as a crashed worker would.
+  const int port = 1 + random::New64() % ((1 << 30) - 1);
+  sockaddr_un addr = SocketAddress(port);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  close(fd);
+
+  TF_ASSERT_OK(DataTransferServer::Build(
+      kShmTransferProtocol,
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->components.push_back(test::AsScalar<int64_t>(1));
+        return absl::OkStatus();
+      },
+      &server_));
+  experimental::WorkerConfig config;
+  config.set_port(port);
+  TF_ASSERT_OK(server_->Start(config));
+  EXPECT_EQ(server_->Port(), port);
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], test::AsScalar<int64_t>(1));
+}
+
+TEST_F(ShmDataTransferTest, RejectsMismatchingSegmentSize) {
+  StartServer([](const GetElementRequest* request, GetElementResult* result) {
+    return absl::OkStatus();
+  });
+  const std::string name =
+      absl::StrCat("/tf_data_service_shm_test.", getpid());
+  int shm_fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  ASSERT_GE(shm_fd, 0);
+  ASSERT_EQ(ftruncate(shm_fd, 4096), 0);
+  close(shm_fd);
+
+  sockaddr_un addr = SocketAddress(server_->Port());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  // Claims a segment larger than the one it shares.
+  std::string handshake;
+  core::PutVarint64(&handshake, 1 << 20);
+  core::PutVarint64(&handshake, name.size());
+  handshake.append(name);
+  const uint64_t size = handshake.size();
+  ASSERT_EQ(write(fd, &size, sizeof(size)), ssize_t{sizeof(size)});
+  ASSERT_EQ(write(fd, handshake.data(), size), static_cast<ssize_t>(size));
+
+  uint64_t response_size = 0;
+  ASSERT_EQ(read(fd, &response_size, sizeof(response_size)),
+            ssize_t{sizeof(response_size)});
+  std::string response(response_size, '\0');
+  ASSERT_EQ(read(fd, response.data(), response_size),
+            static_cast<ssize_t>(response_size));
+  absl::string_view input = response;
+  uint32_t code = 0;
+  ASSERT_TRUE(core::GetVarint32(&input, &code));
+  EXPECT_EQ(code, static_cast<uint32_t>(absl::StatusCode::kInvalidArgument));
+  close(fd);
+  shm_unlink(name.c_str());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,188 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace data {
+
+ParallelTFRecordReader::ParallelTFRecordReader(
+    std::vector<std::string> files, const std::string& compression,
+    const DataTypeVector& dtypes, tsl::Env* env, int64_t num_read_threads,
+    int64_t buffer_size, bool deterministic,
+    std::optional<int64_t> output_buffer_size)
+    : env_(env),
+      files_(std::move(files)),
+      compression_(compression),
+      dtypes_(dtypes),
+      // Without determinism, the reading threads share a single buffer.
+      max_buffered_records_(std::max<int64_t>(
+          1, deterministic ? buffer_size : buffer_size * num_read_threads)),
+      deterministic_(deterministic),
+      output_buffer_size_(output_buffer_size),
+      buffers_(deterministic ? files_.size() : 1) {
+  const int64_t num_threads = std::max<int64_t>(
+      1, std::min<int64_t>(num_read_threads, files_.size()));
+  thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+      env_, tsl::ThreadOptions{}, "read_tfrecord_thread", num_threads);
+  for (int64_t i = 0; i < num_threads; ++i) {
+    thread_pool_->Schedule([this]() { ReadFiles(); });
+  }
+}
+
+ParallelTFRecordReader::~ParallelTFRecordReader() {
+  {
+    absl::MutexLock l(&mu_);
+    cancelled_ = true;
+    ready_to_push_.SignalAll();
+    ready_to_pop_.SignalAll();
+  }
+  thread_pool_.reset();
+}
+
+absl::Status ParallelTFRecordReader::Read(std::vector<Tensor>& record)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  while (true) {
+    TF_RETURN_IF_ERROR(status_);
+    if (deterministic_ && next_file_to_return_ >= files_.size()) {
+      return absl::OutOfRangeError("Reached the end of the TFRecord files.");
+    }
+    Buffer& buffer = GetBuffer(next_file_to_return_);
+    if (!buffer.records.empty()) {
+      record = std::move(buffer.records.front());
+      buffer.records.pop_front();
+      ready_to_push_.SignalAll();
+      return absl::OkStatus();
+    }
+    if (deterministic_ && buffer.num_finished_files > 0) {
+      ++next_file_to_return_;
+      continue;
+    }
+    if (!deterministic_ && buffer.num_finished_files >= files_.size()) {
+      return absl::OutOfRangeError("Reached the end of the TFRecord files.");
+    }
+    ready_to_pop_.Wait(&mu_);
+  }
+}
+
+uint64_t ParallelTFRecordReader::BytesRead() const ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  return bytes_read_;
+}
+
+void ParallelTFRecordReader::ReadFiles() {
+  while (true) {
+    int64_t file_index = 0;
+    {
+      absl::MutexLock l(&mu_);
+      if (cancelled_ || !status_.ok() || next_file_to_read_ >= files_.size()) {
+        return;
+      }
+      file_index = next_file_to_read_++;
+    }
+    UpdateStatus(ReadFile(file_index));
+  }
+}
+
+absl::Status ParallelTFRecordReader::ReadFile(int64_t file_index)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  const std::string& filename = files_[file_index];
+  snapshot_util::TFRecordReader reader(filename, compression_, dtypes_,
+                                       output_buffer_size_);
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(reader.Initialize(env_),
+                                  " Failed to open TFRecord file: ", filename);
+
+  absl::Status status;
+  bool cancelled = false;
+  while (status.ok() && !cancelled) {
+    std::vector<Tensor> record;
+    {
+      tsl::profiler::TraceMe activity("ReadTFRecord",
+                                      tsl::profiler::TraceMeLevel::kInfo);
+      status = reader.ReadTensors(&record);
+    }
+    if (status.ok()) {
+      cancelled = !PushRecord(file_index, std::move(record));
+    }
+  }
+
+  absl::MutexLock l(&mu_);
+  bytes_read_ += reader.BytesRead();
+  if (cancelled) {
+    return absl::OkStatus();
+  }
+  if (!absl::IsOutOfRange(status)) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        status, " Failed to read TFRecord file: ", filename);
+  }
+  ++GetBuffer(file_index).num_finished_files;
+  ready_to_pop_.SignalAll();
+  return absl::OkStatus();
+}
+
+bool ParallelTFRecordReader::PushRecord(int64_t file_index,
+                                        std::vector<Tensor> record)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  Buffer& buffer = GetBuffer(file_index);
+  while (!cancelled_ && status_.ok() &&
+         buffer.records.size() >= max_buffered_records_) {
+    ready_to_push_.Wait(&mu_);
+  }
+  if (cancelled_ || !status_.ok()) {
+    return false;
+  }
+  buffer.records.push_back(std::move(record));
+  ready_to_pop_.SignalAll();
+  return true;
+}
+
+ParallelTFRecordReader::Buffer& ParallelTFRecordReader::GetBuffer(
+    int64_t file_index) {
+  return deterministic_ ? buffers_[file_index] : buffers_[0];
+}
+
+void ParallelTFRecordReader::UpdateStatus(absl::Status status)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  if (status.ok()) {
+    return;
+  }
+  absl::MutexLock l(&mu_);
+  status_.Update(std::move(status));
+  ready_to_push_.SignalAll();
+  ready_to_pop_.SignalAll();
+}
+
+}  // namespace data
+}  // namespace tensorflow
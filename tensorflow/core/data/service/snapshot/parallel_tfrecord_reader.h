@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Uses multiple threads to read TFRecord files in parallel, e.g. the shards
+// written by `ParallelTFRecordWriter`. Each thread reads, decompresses, and
+// parses one file at a time, and buffers up to `buffer_size` records ahead of
+// the caller. If `deterministic` is true, records are returned file by file in
+// the order of `files`. Otherwise, they are returned in the order they are
+// read. This class is thread-safe.
+//
+// Usage example:
+//
+// ParallelTFRecordReader reader(
+//     {"/path/to/file1", "/path/to/file2"}, tsl::io::compression::kSnappy,
+//     {DT_INT64}, Env::Default());
+//
+// std::vector<Tensor> record;
+// absl::Status status = reader.Read(record);
+// while (status.ok()) {
+//   ...
+//   status = reader.Read(record);
+// }
+// if (!absl::IsOutOfRange(status)) {
+//   return status;
+// }
+class ParallelTFRecordReader {
+ public:
+  explicit ParallelTFRecordReader(
+      std::vector<std::string> files, const std::string& compression,
+      const DataTypeVector& dtypes, tsl::Env* env,
+      int64_t num_read_threads = 2, int64_t buffer_size = 1,
+      bool deterministic = true,
+      std::optional<int64_t> output_buffer_size = std::nullopt);
+  virtual ~ParallelTFRecordReader();
+  ParallelTFRecordReader(const ParallelTFRecordReader&) = delete;
+  ParallelTFRecordReader& operator=(const ParallelTFRecordReader&) = delete;
+
+  // Reads the next record into `record`. Blocks until a record is available.
+  // Returns OutOfRange once all the files have been read, or the first error
+  // encountered by the reading threads.
+  absl::Status Read(std::vector<Tensor>& record);
+
+  // Returns the number of bytes read from the files so far.
+  uint64_t BytesRead() const;
+
+ private:
+  // Records read from a file, or from all the files if not `deterministic_`.
+  struct Buffer {
+    std::deque<std::vector<Tensor>> records;
+    int64_t num_finished_files = 0;
+  };
+
+  // Run by a thread to read the files not yet claimed by other threads.
+  void ReadFiles();
+
+  // Reads the file at `file_index` in `files_` into its buffer.
+  absl::Status ReadFile(int64_t file_index);
+
+  // Buffers `record`. Blocks until there is space in the buffer. Returns false
+  // if the reader is cancelled or failed.
+  bool PushRecord(int64_t file_index, std::vector<Tensor> record);
+
+  // Returns the buffer of the file at `file_index`.
+  Buffer& GetBuffer(int64_t file_index) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Updates the status of the reader and notifies waiters.
+  void UpdateStatus(absl::Status status);
+
+  tsl::Env* const env_;
+  const std::vector<std::string> files_;
+  const std::string compression_;
+  const DataTypeVector dtypes_;
+  const int64_t max_buffered_records_;
+  const bool deterministic_;
+  const std::optional<int64_t> output_buffer_size_;
+
+  mutable absl::Mutex mu_;
+  absl::CondVar ready_to_push_;
+  absl::CondVar ready_to_pop_;
+
+  bool cancelled_ ABSL_GUARDED_BY(mu_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+  uint64_t bytes_read_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Index of the next file to be claimed by a reading thread.
+  int64_t next_file_to_read_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Index of the file records are returned from, if `deterministic_`.
+  int64_t next_file_to_return_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // One buffer per file if `deterministic_`, otherwise a single buffer.
+  std::vector<Buffer> buffers_ ABSL_GUARDED_BY(mu_);
+
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PARALLEL_TFRECORD_READER_H_
@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAreArray;
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestDir() {
+  std::string test_dir;
+  if (!tsl::Env::Default()->LocalTempFilename(&test_dir)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(test_dir));
+  return test_dir;
+}
+
+// Writes `num_files` files of `num_records` records each. File `i` holds the
+// records `i * num_records` to `(i + 1) * num_records - 1`.
+absl::StatusOr<std::vector<std::string>> WriteFiles(
+    int64_t num_files, int64_t num_records, const std::string& compression) {
+  TF_ASSIGN_OR_RETURN(std::string test_dir, TestDir());
+  std::vector<std::string> files;
+  for (int64_t i = 0; i < num_files; ++i) {
+    files.push_back(tsl::io::JoinPath(test_dir, absl::StrCat("chunk_", i)));
+    snapshot_util::TFRecordWriter writer(files.back(), compression);
+    TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+    for (int64_t j = 0; j < num_records; ++j) {
+      TF_RETURN_IF_ERROR(writer.WriteTensors({Tensor(i * num_records + j)}));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+  }
+  return files;
+}
+
+absl::StatusOr<std::vector<int64_t>> ReadRecords(
+    ParallelTFRecordReader& reader) {
+  std::vector<int64_t> result;
+  while (true) {
+    std::vector<Tensor> record;
+    absl::Status status = reader.Read(record);
+    if (absl::IsOutOfRange(status)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(status);
+    result.push_back(record[0].unaligned_flat<int64_t>().data()[0]);
+  }
+  return result;
+}
+
+std::vector<int64_t> Range(int64_t range) {
+  std::vector<int64_t> result;
+  for (int64_t i = 0; i < range; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+class ParallelTFRecordReaderParamTest
+    : public ::testing::TestWithParam<
+          std::tuple<int64_t, int64_t, int64_t, bool, std::string>> {
+ protected:
+  int64_t NumFiles() const { return std::get<0>(GetParam()); }
+  int64_t NumReadThreads() const { return std::get<1>(GetParam()); }
+  int64_t BufferSize() const { return std::get<2>(GetParam()); }
+  bool Deterministic() const { return std::get<3>(GetParam()); }
+  std::string Compression() const { return std::get<4>(GetParam()); }
+};
+
+TEST_P(ParallelTFRecordReaderParamTest, ReadRecords) {
+  constexpr int64_t kNumRecords = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> files,
+                          WriteFiles(NumFiles(), kNumRecords, Compression()));
+  ParallelTFRecordReader reader(files, Compression(), {DT_INT64},
+                                tsl::Env::Default(), NumReadThreads(),
+                                BufferSize(), Deterministic());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> records, ReadRecords(reader));
+  if (Deterministic()) {
+    EXPECT_THAT(records, ElementsAreArray(Range(NumFiles() * kNumRecords)));
+  } else {
+    EXPECT_THAT(records,
+                UnorderedElementsAreArray(Range(NumFiles() * kNumRecords)));
+  }
+  if (NumFiles() > 0) {
+    EXPECT_GT(reader.BytesRead(), 0);
+  }
+
+  // Subsequent reads keep returning the end of the files.
+  std::vector<Tensor> record;
+  EXPECT_THAT(reader.Read(record), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParallelTFRecordReaderParams, ParallelTFRecordReaderParamTest,
+    ::testing::Combine(
+        /*num_files=*/::testing::Values(0, 1, 5),
+        /*num_read_threads=*/::testing::Values(1, 3, 10),
+        /*buffer_size=*/::testing::Values(1, 100),
+        /*deterministic=*/::testing::Bool(),
+        /*compression=*/
+        ::testing::Values(tsl::io::compression::kNone,
+                          tsl::io::compression::kSnappy,
+                          tsl::io::compression::kZlib)));
+
+TEST(ParallelTFRecordReaderTest, DestroyBeforeReadingAllRecords) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> files,
+      WriteFiles(/*num_files=*/5, /*num_records=*/100,
+                 tsl::io::compression::kSnappy));
+  ParallelTFRecordReader reader(files, tsl::io::compression::kSnappy,
+                                {DT_INT64}, tsl::Env::Default(),
+                                /*num_read_threads=*/3, /*buffer_size=*/1);
+  std::vector<Tensor> record;
+  TF_ASSERT_OK(reader.Read(record));
+  EXPECT_EQ(record[0].unaligned_flat<int64_t>().data()[0], 0);
+}
+
+TEST(ParallelTFRecordReaderTest, FileNotFound) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
+  ParallelTFRecordReader reader(
+      {tsl::io::JoinPath(test_dir, "not_found")},
+      tsl::io::compression::kNone, {DT_INT64}, tsl::Env::Default());
+  EXPECT_THAT(ReadRecords(reader), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ParallelTFRecordReaderTest, NoFiles) {
+  ParallelTFRecordReader reader(/*files=*/{}, tsl::io::compression::kNone,
+                                {DT_INT64}, tsl::Env::Default());
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> records, ReadRecords(reader));
+  EXPECT_THAT(records, IsEmpty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/parallel_tfrecord_reader.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -39,6 +40,7 @@ namespace {
 
 constexpr const char* const kChunkFile = "chunk_file";
 constexpr const char* const kCompression = "compression";
+constexpr const char* const kReadAhead = "read_ahead";
 constexpr const char* const kStartIndex = "start_index";
 constexpr const char* const kOutputTypes = "output_types";
 constexpr const char* const kOutputShapes = "output_shapes";
@@ -66,16 +68,19 @@ class SnapshotChunkDatasetOp : public DatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   std::string compression_;
+  int64_t read_ahead_ = 0;
 };
 
 class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& chunk_file,
-          const std::string& compression, const DataTypeVector& dtypes,
+          const std::string& compression, int64_t read_ahead,
+          const DataTypeVector& dtypes,
           const std::vector<PartialTensorShape>& shapes)
       : DatasetBase(std::move(ctx)),
         chunk_file_(chunk_file),
         compression_(compression),
+        read_ahead_(read_ahead),
         dtypes_(dtypes),
         shapes_(shapes) {}
 
@@ -101,15 +106,20 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     Node* chunk_file = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(chunk_file_, &chunk_file));
 
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
     AttrValue compression;
     b->BuildAttrValue(compression_, &compression);
+    attrs.emplace_back(kCompression, compression);
+    if (read_ahead_ > 0) {
+      AttrValue read_ahead;
+      b->BuildAttrValue(read_ahead_, &read_ahead);
+      attrs.emplace_back(kReadAhead, read_ahead);
+    }
 
     return b->AddDataset(this,
                          /*inputs=*/
                          {std::make_pair(0, chunk_file)},
-                         /*list_inputs=*/{},
-                         /*attrs=*/
-                         {{kCompression, compression}},
+                         /*list_inputs=*/{}, attrs,
                          /*use_dataset_name=*/true, output);
   }
 
@@ -128,6 +138,17 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
+      if (dataset()->read_ahead_ > 0) {
+        // Reads, decompresses, and parses the records on a background thread
+        // so that reading from remote storage overlaps with the consumer.
+        parallel_reader_ = std::make_unique<ParallelTFRecordReader>(
+            std::vector<std::string>{
+                TranslateFileName(dataset()->chunk_file_)},
+            dataset()->compression_, dataset()->dtypes_, ctx->env(),
+            /*num_read_threads=*/1, dataset()->read_ahead_,
+            /*deterministic=*/true, kTFRecordReaderOutputBufferSize);
+        return absl::OkStatus();
+      }
       reader_ = std::make_unique<snapshot_util::TFRecordReader>(
           TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
           dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
@@ -139,7 +160,7 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       *end_of_sequence = false;
-      absl::Status status = reader_->ReadTensors(out_tensors);
+      absl::Status status = ReadTensors(out_tensors);
       if (absl::IsOutOfRange(status)) {
         *end_of_sequence = true;
         return absl::OkStatus();
@@ -162,34 +183,45 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  IteratorStateReader* reader) override {
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(full_name(kStartIndex), &start_index_));
+      parallel_reader_.reset();
       TF_RETURN_IF_ERROR(Initialize(ctx));
       return AdvanceToStartIndex(ctx);
     }
 
    private:
+    absl::Status ReadTensors(std::vector<Tensor>* out_tensors) {
+      if (parallel_reader_) {
+        return parallel_reader_->Read(*out_tensors);
+      }
+      return reader_->ReadTensors(out_tensors);
+    }
+
     // TODO(b/250921378): Optimize this to not parse every single element. We
     // may consider switching the data format to ArrayRecords so we can use the
     // index to jump straight to the starting record.
     absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
       for (int64_t i = 0; i < start_index_; ++i) {
         std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
+        TF_RETURN_IF_ERROR(ReadTensors(&unused));
       }
       return absl::OkStatus();
     }
 
     void RecordBytesRead() {
-      uint64_t bytes_read = reader_->BytesRead();
+      uint64_t bytes_read = parallel_reader_ ? parallel_reader_->BytesRead()
+                                             : reader_->BytesRead();
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
     std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    std::unique_ptr<ParallelTFRecordReader> parallel_reader_;
     int64_t start_index_ = 0;
   };
 
   const tstring chunk_file_;
   const tstring compression_;
+  const int64_t read_ahead_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
 };
@@ -199,6 +231,9 @@ SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  if (ctx->HasAttr(kReadAhead)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadAhead, &read_ahead_));
+  }
 }
 
 void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -206,9 +241,9 @@ void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
   tstring chunk_file;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kChunkFile, &chunk_file));
 
-  *output = new SnapshotChunkDatasetOp::Dataset(DatasetContext(ctx), chunk_file,
-                                                compression_, output_types_,
-                                                output_shapes_);
+  *output = new SnapshotChunkDatasetOp::Dataset(
+      DatasetContext(ctx), chunk_file, compression_, read_ahead_,
+      output_types_, output_shapes_);
   metrics::RecordTFDataServiceSnapshotOp(
       std::string(GetSnapshotPath(chunk_file)), kSnapshotChunkDataset);
 }
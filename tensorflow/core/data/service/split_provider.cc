@@ -15,19 +15,28 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -43,9 +52,9 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
   }
   TF_RETURN_IF_ERROR(grpc_util::Retry(
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        return dispatcher_->GetSplit(iteration_id_, repetition_,
-                                     split_provider_index_, *split,
-                                     *end_of_splits);
+        return dispatcher_->GetSplit(worker_address_, iteration_id_,
+                                     repetition_, split_provider_index_,
+                                     *split, *end_of_splits);
       },
       "get next split",
       /*deadline_micros=*/Env::Default()->NowMicros() +
@@ -81,6 +90,98 @@ Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+LocalityAwareSplitAssigner::LocalityAwareSplitAssigner(
+    SplitProvider* split_provider, int64_t lookahead,
+    absl::flat_hash_map<std::string, std::string> file_locality_tags)
+    : split_provider_(split_provider),
+      lookahead_(std::max<int64_t>(lookahead, 1)),
+      file_locality_tags_(std::move(file_locality_tags)) {}
+
+Status LocalityAwareSplitAssigner::GetNext(
+    absl::string_view worker_address,
+    const std::vector<std::string>& worker_tags, Tensor* split,
+    bool* end_of_splits) {
+  while (!end_of_splits_ && pending_splits_.size() < lookahead_) {
+    Tensor next;
+    bool end_of_provider_splits = false;
+    TF_RETURN_IF_ERROR(
+        split_provider_->GetNext(&next, &end_of_provider_splits));
+    if (end_of_provider_splits) {
+      end_of_splits_ = true;
+      break;
+    }
+    pending_splits_.push_back(MakePendingSplit(std::move(next)));
+  }
+  if (pending_splits_.empty()) {
+    *end_of_splits = true;
+    return absl::OkStatus();
+  }
+
+  size_t chosen = 0;
+  if (pending_splits_.front().passes < lookahead_) {
+    int64_t best_score = -1;
+    for (size_t i = 0; i < pending_splits_.size(); ++i) {
+      int64_t score = Score(pending_splits_[i], worker_address, worker_tags);
+      if (score > best_score) {
+        best_score = score;
+        chosen = i;
+      }
+    }
+  }
+  for (size_t i = 0; i < chosen; ++i) {
+    ++pending_splits_[i].passes;
+  }
+  PendingSplit& pending_split = pending_splits_[chosen];
+  if (!worker_address.empty() && !pending_split.directory.empty()) {
+    last_directories_[std::string(worker_address)] = pending_split.directory;
+  }
+  *split = std::move(pending_split.split);
+  *end_of_splits = false;
+  pending_splits_.erase(pending_splits_.begin() + chosen);
+  return absl::OkStatus();
+}
+
+void LocalityAwareSplitAssigner::Reset() {
+  pending_splits_.clear();
+  end_of_splits_ = false;
+}
+
+LocalityAwareSplitAssigner::PendingSplit
+LocalityAwareSplitAssigner::MakePendingSplit(Tensor split) const {
+  PendingSplit pending_split;
+  if (split.dtype() == DT_STRING &&
+      TensorShapeUtils::IsScalar(split.shape())) {
+    absl::string_view path = split.scalar<tstring>()();
+    size_t longest_prefix = 0;
+    for (const auto& [prefix, tag] : file_locality_tags_) {
+      if (prefix.size() >= longest_prefix && absl::StartsWith(path, prefix)) {
+        longest_prefix = prefix.size();
+        pending_split.locality_tag = tag;
+      }
+    }
+    pending_split.directory = std::string(io::Dirname(path));
+  }
+  pending_split.split = std::move(split);
+  return pending_split;
+}
+
+int64_t LocalityAwareSplitAssigner::Score(
+    const PendingSplit& split, absl::string_view worker_address,
+    const std::vector<std::string>& worker_tags) const {
+  int64_t score = 0;
+  if (!split.locality_tag.empty() &&
+      std::find(worker_tags.begin(), worker_tags.end(), split.locality_tag) !=
+          worker_tags.end()) {
+    score += 2;
+  }
+  auto it = last_directories_.find(worker_address);
+  if (!split.directory.empty() && it != last_directories_.end() &&
+      it->second == split.directory) {
+    score += 1;
+  }
+  return score;
+}
+
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
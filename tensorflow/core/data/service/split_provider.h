@@ -16,11 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -35,14 +41,18 @@ namespace data {
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
 class DataServiceSplitProvider : public SplitProvider {
  public:
+  // `worker_address` is the address of the worker reading the splits, which
+  // the dispatcher uses to hand out splits local to it.
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           const std::string& worker_address = "")
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        worker_address_(worker_address) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -57,12 +67,67 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::string worker_address_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
+// Hands out the splits of a split provider to workers, preferring for each
+// worker the splits which are cheap for it to read:
+//
+// (1) splits naming a file whose locality tag is one of the worker's tags; the
+//     locality tag of a file is the one mapped to the longest prefix of its
+//     path in `file_locality_tags`, e.g. the zone of the bucket it is in.
+// (2) splits naming a file in the directory of the last file the worker read,
+//     which the worker's file system is likely to have cached.
+//
+// Considers the next `lookahead` splits of the split provider. A split which
+// has been passed over by `lookahead` requests is handed out to the next
+// worker regardless of locality, so that every split is eventually produced.
+//
+// Not thread-safe.
+class LocalityAwareSplitAssigner {
+ public:
+  LocalityAwareSplitAssigner(
+      SplitProvider* split_provider, int64_t lookahead,
+      absl::flat_hash_map<std::string, std::string> file_locality_tags);
+
+  // Gets the next split for the worker at `worker_address` with
+  // `worker_tags`.
+  Status GetNext(absl::string_view worker_address,
+                 const std::vector<std::string>& worker_tags, Tensor* split,
+                 bool* end_of_splits);
+
+  // Drops the splits read ahead. Must be called when resetting the split
+  // provider.
+  void Reset();
+
+ private:
+  struct PendingSplit {
+    Tensor split;
+    // The locality tag and directory of the file named by the split, if any.
+    std::string locality_tag;
+    std::string directory;
+    // Number of times the split has been passed over.
+    size_t passes = 0;
+  };
+
+  PendingSplit MakePendingSplit(Tensor split) const;
+  int64_t Score(const PendingSplit& split, absl::string_view worker_address,
+                const std::vector<std::string>& worker_tags) const;
+
+  SplitProvider* const split_provider_;
+  const size_t lookahead_;
+  const absl::flat_hash_map<std::string, std::string> file_locality_tags_;
+
+  std::deque<PendingSplit> pending_splits_;
+  bool end_of_splits_ = false;
+  // Directory of the last file read by each worker.
+  absl::flat_hash_map<std::string, std::string> last_directories_;
+};
+
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
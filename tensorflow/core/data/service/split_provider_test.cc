@@ -16,14 +16,21 @@ limitations under the License.
 
 #include <array>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -110,6 +117,110 @@ TEST(SplitProviderTest, SampleFromDatasetsCardinality) {
               UnorderedElementsAre(5, 5, 5, kInfiniteCardinality));
 }
 
+// Produces the file names it is constructed with, as string splits.
+class FileSplitProvider : public SplitProvider {
+ public:
+  explicit FileSplitProvider(std::vector<std::string> files)
+      : files_(std::move(files)) {}
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override {
+    *end_of_splits = index_ >= files_.size();
+    if (!*end_of_splits) {
+      *split = Tensor(tstring(files_[index_++]));
+    }
+    return absl::OkStatus();
+  }
+  Status Reset() override {
+    index_ = 0;
+    return absl::OkStatus();
+  }
+  Status Save(std::function<std::string(std::string)> full_name,
+              IteratorStateWriter* writer) override {
+    return errors::Unimplemented("Save is not implemented");
+  }
+  Status Restore(std::function<std::string(std::string)> full_name,
+                 IteratorStateReader* reader) override {
+    return errors::Unimplemented("Restore is not implemented");
+  }
+
+ private:
+  const std::vector<std::string> files_;
+  size_t index_ = 0;
+};
+
+std::string GetNextFile(LocalityAwareSplitAssigner& assigner,
+                        const std::string& worker_address,
+                        const std::vector<std::string>& worker_tags) {
+  Tensor split;
+  bool end_of_splits = false;
+  TF_CHECK_OK(
+      assigner.GetNext(worker_address, worker_tags, &split, &end_of_splits));
+  if (end_of_splits) return "";
+  return split.scalar<tstring>()();
+}
+
+TEST(LocalityAwareSplitAssignerTest, PrefersLocalFiles) {
+  FileSplitProvider split_provider(
+      {"/zone_a/f0", "/zone_b/f1", "/zone_a/f2", "/zone_b/f3"});
+  LocalityAwareSplitAssigner assigner(
+      &split_provider, /*lookahead=*/4,
+      {{"/zone_a/", "zone:a"}, {"/zone_b/", "zone:b"}});
+  EXPECT_EQ(GetNextFile(assigner, "worker_b", {"zone:b"}), "/zone_b/f1");
+  EXPECT_EQ(GetNextFile(assigner, "worker_b", {"zone:b"}), "/zone_b/f3");
+  EXPECT_EQ(GetNextFile(assigner, "worker_a", {"zone:a"}), "/zone_a/f0");
+  EXPECT_EQ(GetNextFile(assigner, "worker_b", {"zone:b"}), "/zone_a/f2");
+  EXPECT_EQ(GetNextFile(assigner, "worker_b", {"zone:b"}), "");
+}
+
+TEST(LocalityAwareSplitAssignerTest, PrefersLongestPrefix) {
+  FileSplitProvider split_provider({"/data/zone_b/f0", "/data/f1"});
+  LocalityAwareSplitAssigner assigner(
+      &split_provider, /*lookahead=*/2,
+      {{"/data/", "zone:a"}, {"/data/zone_b/", "zone:b"}});
+  EXPECT_EQ(GetNextFile(assigner, "worker_a", {"zone:a"}), "/data/f1");
+  EXPECT_EQ(GetNextFile(assigner, "worker_a", {"zone:a"}), "/data/zone_b/f0");
+}
+
+TEST(LocalityAwareSplitAssignerTest, PrefersRecentlyReadDirectories) {
+  FileSplitProvider split_provider(
+      {"/d0/f0", "/d1/f1", "/d0/f2", "/d1/f3", "/d0/f4"});
+  LocalityAwareSplitAssigner assigner(&split_provider, /*lookahead=*/4, {});
+  EXPECT_EQ(GetNextFile(assigner, "worker_0", {}), "/d0/f0");
+  EXPECT_EQ(GetNextFile(assigner, "worker_1", {}), "/d1/f1");
+  EXPECT_EQ(GetNextFile(assigner, "worker_1", {}), "/d1/f3");
+  EXPECT_EQ(GetNextFile(assigner, "worker_0", {}), "/d0/f2");
+  EXPECT_EQ(GetNextFile(assigner, "worker_0", {}), "/d0/f4");
+}
+
+TEST(LocalityAwareSplitAssignerTest, DoesNotStarveRemoteSplits) {
+  std::vector<std::string> files = {"/zone_b/f0"};
+  for (int i = 1; i < 10; ++i) {
+    files.push_back(absl::StrCat("/zone_a/f", i));
+  }
+  FileSplitProvider split_provider(files);
+  LocalityAwareSplitAssigner assigner(&split_provider, /*lookahead=*/3,
+                                      {{"/zone_a/", "zone:a"}});
+  std::vector<std::string> assigned;
+  for (int i = 0; i < 4; ++i) {
+    assigned.push_back(GetNextFile(assigner, "worker_a", {"zone:a"}));
+  }
+  // "/zone_b/f0" is passed over by three requests, then handed out.
+  EXPECT_THAT(assigned, ElementsAre("/zone_a/f1", "/zone_a/f2", "/zone_a/f3",
+                                    "/zone_b/f0"));
+}
+
+TEST(LocalityAwareSplitAssignerTest, Reset) {
+  FileSplitProvider split_provider({"/f0", "/f1", "/f2"});
+  LocalityAwareSplitAssigner assigner(&split_provider, /*lookahead=*/2, {});
+  EXPECT_EQ(GetNextFile(assigner, "worker", {}), "/f0");
+  TF_ASSERT_OK(split_provider.Reset());
+  assigner.Reset();
+  EXPECT_EQ(GetNextFile(assigner, "worker", {}), "/f0");
+  EXPECT_EQ(GetNextFile(assigner, "worker", {}), "/f1");
+  EXPECT_EQ(GetNextFile(assigner, "worker", {}), "/f2");
+  EXPECT_EQ(GetNextFile(assigner, "worker", {}), "");
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -153,7 +155,8 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+                             size_t max_cache_size_bytes,
+                             CrossTrainerCacheSpillOptions spill_options = {});
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -179,6 +182,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    StatusOr<std::string> Serialize(
+        const GetElementResult& element) const override;
+    StatusOr<GetElementResult> Deserialize(
+        absl::string_view data) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
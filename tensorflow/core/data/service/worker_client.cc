@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker_client.h"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -26,10 +27,12 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "tensorflow/core/data/service/columnar_elements.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -54,6 +57,20 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Maximum number of elements requested in one GetElement call. Workers serve
+// at most `WorkerConfig.max_elements_per_response` elements.
+constexpr int64_t kMaxElementsPerRequest = 1024;
+
+// Returns true if the response to `req` may hold several elements.
+bool AcceptsSeveralElements(const GetElementRequest& req) {
+  return req.optional_consumer_index_case() ==
+             GetElementRequest::OPTIONAL_CONSUMER_INDEX_NOT_SET &&
+         req.trainer_id().empty();
+}
+
+}  // namespace
 
 StatusOr<std::unique_ptr<DataServiceWorkerClient>>
 CreateDataServiceWorkerClient(const std::string& dispatcher_protocol,
@@ -110,11 +127,25 @@ class GrpcDataTransferClient : public DataTransferClient {
                     GetElementResult& result) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
+    const bool accepts_several_elements = AcceptsSeveralElements(req);
     {
       mutex_lock l(mu_);
       if (cancelled_) {
         return errors::Cancelled("Client was cancelled.");
       }
+      // Serves the elements received with a previous columnar response.
+      if (accepts_several_elements) {
+        auto it = buffered_elements_.find(req.task_id());
+        if (it != buffered_elements_.end() && !it->second.empty()) {
+          result = std::move(it->second.front());
+          it->second.pop_front();
+          return absl::OkStatus();
+        }
+      }
+    }
+    GetElementRequest request = req;
+    if (accepts_several_elements) {
+      request.set_max_elements(kMaxElementsPerRequest);
     }
     grpc::ClientContext ctx;
     gtl::Cleanup<std::function<void()>> cleanup;
@@ -128,7 +159,7 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     GetElementResponse resp;
     int64_t start_time_us = env_->NowMicros();
-    grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    grpc::Status s = stub_->GetElement(&ctx, request, &resp);
     int64_t end_time_us = env_->NowMicros();
     if (!s.ok()) {
       return grpc_util::WrapError("Failed to get element", s);
@@ -152,6 +183,8 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kColumnar:
+        return ReadColumnarElements(req.task_id(), resp, result);
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
@@ -168,6 +201,29 @@ class GrpcDataTransferClient : public DataTransferClient {
   }
 
  private:
+  // Moves the first element of the columnar `resp` into `result`, and buffers
+  // the other ones for the next requests for `task_id`.
+  Status ReadColumnarElements(int64_t task_id, GetElementResponse& resp,
+                              GetElementResult& result) {
+    std::vector<std::vector<Tensor>> elements;
+    TF_RETURN_IF_ERROR(
+        ColumnarElementsToTensors(*resp.mutable_columnar(), elements));
+    if (elements.empty()) {
+      return errors::Internal("Received an empty columnar response.");
+    }
+    const auto& element_indices = resp.columnar().element_indices();
+    result.components = std::move(elements[0]);
+    result.element_index = element_indices[0];
+    mutex_lock l(mu_);
+    std::deque<GetElementResult>& buffer = buffered_elements_[task_id];
+    for (int64_t i = 1; i < elements.size(); ++i) {
+      GetElementResult& buffered = buffer.emplace_back();
+      buffered.components = std::move(elements[i]);
+      buffered.element_index = element_indices[i];
+    }
+    return absl::OkStatus();
+  }
+
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
@@ -177,6 +233,9 @@ class GrpcDataTransferClient : public DataTransferClient {
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Elements received in columnar responses and not yet returned, by task ID.
+  absl::flat_hash_map<int64_t, std::deque<GetElementResult>> buffered_elements_
+      TF_GUARDED_BY(mu_);
 };
 
 class GrpcTransferClientRegistrar {
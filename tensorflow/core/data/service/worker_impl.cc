@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/columnar_elements.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -76,6 +78,8 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// Maximum amount of tensor data in a columnar GetElement response.
+constexpr ByteSize kMaxColumnarResponseSize = ByteSize::MB(16);
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -451,7 +455,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          task_def.worker_address()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -483,11 +488,53 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
   response->set_end_of_sequence(result.end_of_sequence);
   response->set_skip_task(result.skip);
-  if (!response->end_of_sequence() && !response->skip_task()) {
-    TF_RETURN_IF_ERROR(
-        MoveElementToResponse(std::move(result.components), *response));
-    VLOG(3) << "Producing an element for task " << request->task_id();
+  if (response->end_of_sequence() || response->skip_task()) {
+    return absl::OkStatus();
+  }
+  // Round-robin and cross-trainer cache reads must be served one element at a
+  // time to keep the consumers in sync.
+  const int64_t max_elements =
+      std::min(request->max_elements(), config_.max_elements_per_response());
+  if (max_elements > 1 &&
+      request->optional_consumer_index_case() ==
+          GetElementRequest::OPTIONAL_CONSUMER_INDEX_NOT_SET &&
+      request->trainer_id().empty() &&
+      IsColumnarCompatible(result.components)) {
+    return MoveElementsToColumnarResponse(*request, std::move(result),
+                                          max_elements, *response);
+  }
+  TF_RETURN_IF_ERROR(
+      MoveElementToResponse(std::move(result.components), *response));
+  VLOG(3) << "Producing an element for task " << request->task_id();
+  return absl::OkStatus();
+}
+
+Status DataServiceWorkerImpl::MoveElementsToColumnarResponse(
+    const GetElementRequest& request, struct GetElementResult first,
+    int64_t max_elements, GetElementResponse& response) {
+  response.set_element_index(first.element_index);
+  ColumnarElements& batch = *response.mutable_columnar();
+  ByteSize batch_size = ByteSize::Bytes(ColumnarElementSize(first.components));
+  TF_RETURN_IF_ERROR(AppendToColumnarElements(
+      first.components, first.element_index, batch));
+
+  // Only adds the elements which are already available, so that batching
+  // doesn't delay the first element.
+  GetElementRequest next_request = request;
+  next_request.set_allow_skip(true);
+  while (batch.element_indices_size() < max_elements &&
+         batch_size < kMaxColumnarResponseSize) {
+    struct GetElementResult next;
+    TF_RETURN_IF_ERROR(GetElementResult(&next_request, &next));
+    if (next.end_of_sequence || next.skip) {
+      break;
+    }
+    batch_size += ByteSize::Bytes(ColumnarElementSize(next.components));
+    TF_RETURN_IF_ERROR(AppendToColumnarElements(
+        next.components, next.element_index, batch));
   }
+  VLOG(3) << "Producing " << batch.element_indices_size()
+          << " elements for task " << request.task_id();
   return absl::OkStatus();
 }
 
@@ -131,6 +131,12 @@ class DataServiceWorkerImpl {
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status EnsureTaskInitialized(Task& task);
+  // Moves `first` and up to `max_elements - 1` elements of the same task which
+  // are ready to be served into a columnar `response`.
+  Status MoveElementsToColumnarResponse(const GetElementRequest& request,
+                                        struct GetElementResult first,
+                                        int64_t max_elements,
+                                        GetElementResponse& response);
   // Stops a task, cancelling the task's outstanding requests and waiting for
   // them to finish.
   void StopTask(Task& task) TF_LOCKS_EXCLUDED(mu_);
@@ -20,6 +20,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
@@ -134,6 +135,29 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+std::vector<TfDatazMetricsCollector::StageMetrics>
+TfDatazMetricsCollector::GetStageMetrics() {
+  std::vector<StageMetrics> metrics;
+  std::shared_ptr<model::Node> output = model_ ? model_->output() : nullptr;
+  if (output == nullptr) {
+    return metrics;
+  }
+  model::Node::NodeVector nodes = output->CollectNodes(
+      model::TraversalOrder::BFS,
+      [](const std::shared_ptr<model::Node>) { return true; });
+  nodes.insert(nodes.begin(), output);
+  metrics.reserve(nodes.size());
+  for (const std::shared_ptr<model::Node>& node : nodes) {
+    StageMetrics stage;
+    stage.name = node->long_name();
+    stage.num_elements = node->num_elements();
+    stage.bytes_produced = node->bytes_produced();
+    stage.stats = node->stage_stats();
+    metrics.push_back(std::move(stage));
+  }
+  return metrics;
+}
+
 std::shared_ptr<model::Model> TfDatazMetricsCollector::GetModel() {
   return model_;
 }
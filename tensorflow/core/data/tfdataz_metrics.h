@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
@@ -91,6 +92,16 @@ class ApproximateLatencyEstimator {
 // Collects and exports the tf.data performance metrics to /tfdataz.
 class TfDatazMetricsCollector {
  public:
+  // Lightweight per-element metrics of one iterator (i.e. stage) of the input
+  // pipeline, which tell the stage causing a stall apart from the others.
+  struct StageMetrics {
+    // Long name of the model node of the iterator, e.g. "Map(id:3)".
+    std::string name;
+    int64_t num_elements = 0;
+    int64_t bytes_produced = 0;
+    model::StageStats stats;
+  };
+
   // Constructs a `TfDatazMetricsCollector`.
   // We only collect metrics for CPU devices. This is a heuristic to avoid
   // collecting metrics for device-side iterators created by the multi-device
@@ -118,6 +129,10 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the metrics of every iterator of the pipeline, from the output to
+  // the sources. Empty when the iterator is not modeled.
+  std::vector<StageMetrics> GetStageMetrics();
+
   std::shared_ptr<model::Model> GetModel();
 
  private:
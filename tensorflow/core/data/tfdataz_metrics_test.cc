@@ -16,9 +16,11 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
@@ -179,6 +181,49 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+TEST_F(TfDatazMetricsTest, GetStageMetricsWithoutModel) {
+  EXPECT_TRUE(tfdataz_metrics_->GetStageMetrics().empty());
+}
+
+TEST(TfDatazStageMetricsTest, GetStageMetrics) {
+  auto model = std::make_shared<model::Model>();
+  std::shared_ptr<model::Node> root;
+  model->AddNode(
+      [](model::Node::Args args) {
+        return model::MakeUnknownNode(std::move(args));
+      },
+      "Root", nullptr, &root);
+  std::shared_ptr<model::Node> input;
+  model->AddNode(
+      [](model::Node::Args args) {
+        return model::MakeUnknownNode(std::move(args));
+      },
+      "Input", root, &input);
+
+  model::Node::Call call = model::Node::start_call(0);
+  input->record_start(0);
+  input->record_stop(100);
+  input->stop_call(call, 100, /*record_stage_stats=*/true);
+  input->record_element();
+  input->record_bytes_produced(8);
+  input->record_element_bytes(8);
+
+  std::unique_ptr<DatasetBaseIterator> iterator;
+  TfDatazMetricsCollector collector(*Env::Default(), iterator.get(), model);
+  std::vector<TfDatazMetricsCollector::StageMetrics> metrics =
+      collector.GetStageMetrics();
+  ASSERT_EQ(metrics.size(), 2);
+  EXPECT_EQ(metrics[0].name, root->long_name());
+  EXPECT_EQ(metrics[0].num_elements, 0);
+  EXPECT_EQ(metrics[0].stats.latency.count, 0);
+  EXPECT_EQ(metrics[1].name, input->long_name());
+  EXPECT_EQ(metrics[1].num_elements, 1);
+  EXPECT_EQ(metrics[1].bytes_produced, 8);
+  EXPECT_EQ(metrics[1].stats.latency.sum, 100);
+  EXPECT_EQ(metrics[1].stats.processing_time.sum, 100);
+  EXPECT_EQ(metrics[1].stats.bytes.sum, 8);
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
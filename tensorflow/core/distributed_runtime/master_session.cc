@@ -52,11 +52,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -68,6 +70,50 @@ limitations under the License.
 
 namespace tensorflow {
 
+// The partitions registered on workers by the client graphs of a session,
+// shared by the client graphs whose partition on a worker is identical, e.g.
+// because they only differ by fetches computed on other workers.
+class MasterSession::RegisteredPartitionCache {
+ public:
+  // Returns the handle of the partition registered with `key` and takes a
+  // reference on it, or returns an empty string if there is none.
+  string Lookup(const string& key) {
+    mutex_lock l(mu_);
+    auto it = partitions_.find(key);
+    if (it == partitions_.end()) return "";
+    ++it->second.refs;
+    return it->second.graph_handle;
+  }
+
+  // Records that the partition with `key` is registered as `graph_handle`,
+  // with one reference. Returns false if another partition was recorded with
+  // `key` in the meantime.
+  bool Insert(const string& key, const string& graph_handle) {
+    mutex_lock l(mu_);
+    return partitions_.emplace(key, Partition{graph_handle, 1}).second;
+  }
+
+  // Releases a reference on the partition with `key`. Returns true if it was
+  // the last one, in which case the caller must deregister the partition.
+  bool Release(const string& key) {
+    mutex_lock l(mu_);
+    auto it = partitions_.find(key);
+    DCHECK(it != partitions_.end()) << key;
+    if (it == partitions_.end() || --it->second.refs > 0) return false;
+    partitions_.erase(it);
+    return true;
+  }
+
+ private:
+  struct Partition {
+    string graph_handle;
+    int64_t refs;
+  };
+
+  mutex mu_;
+  std::unordered_map<string, Partition> partitions_ TF_GUARDED_BY(mu_);
+};
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -111,6 +157,7 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
       DeregisterPartitions();
     } else {
       for (Part& part : partitions_) {
+        if (!part.cache_key.empty()) partition_cache_->Release(part.cache_key);
         worker_cache_->ReleaseWorker(part.name, part.worker);
       }
     }
@@ -204,8 +251,11 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // Local execution methods.
 
   // Partitions the graph into subgraphs and registers them on
-  // workers.
-  Status RegisterPartitions(PartitionOptions popts);
+  // workers. If `partition_cache` is not null, the subgraphs already
+  // registered by other client graphs are reused.
+  Status RegisterPartitions(
+      PartitionOptions popts,
+      std::shared_ptr<RegisteredPartitionCache> partition_cache);
 
   // Runs one step of all partitions.
   Status RunPartitions(const MasterEnv* env, int64_t step_id,
@@ -274,6 +324,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
+    // If not empty, the key of this partition in `partition_cache_`, which
+    // holds a reference on it for this client graph.
+    string cache_key;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
@@ -282,6 +336,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // acquiring locks.
   std::vector<Part> partitions_;
 
+  // Set by RegisterPartitions() if partitions are shared with other client
+  // graphs.
+  std::shared_ptr<RegisteredPartitionCache> partition_cache_;
+
   mutable mutex mu_;
 
   // Partition initialization and registration only needs to happen
@@ -341,10 +399,12 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 };
 
 Status MasterSession::ReffedClientGraph::RegisterPartitions(
-    PartitionOptions popts) {
+    PartitionOptions popts,
+    std::shared_ptr<RegisteredPartitionCache> partition_cache) {
   {  // Ensure register once.
     mu_.lock();
     if (client_graph_before_register_) {
+      partition_cache_ = std::move(partition_cache);
       // The `ClientGraph` is no longer needed after partitions are registered.
       // Since it can account for a large amount of memory, we consume it here,
       // and it will be freed after concluding with registration.
@@ -472,6 +532,8 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     RegisterGraphRequest req;
     RegisterGraphResponse resp;
     Status status;
+    string cache_key;
+    bool cached = false;
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
@@ -489,6 +551,21 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
+    if (partition_cache_) {
+      string serialized;
+      SerializeToStringDeterministic(c->req, &serialized);
+      const Fprint128 fingerprint = Fingerprint128(serialized);
+      c->cache_key = strings::StrCat(part.name, ";", fingerprint.high64, "_",
+                                     fingerprint.low64);
+      const string graph_handle = partition_cache_->Lookup(c->cache_key);
+      if (!graph_handle.empty()) {
+        VLOG(2) << "Reuse partition " << graph_handle << " on " << part.name;
+        c->resp.set_graph_handle(graph_handle);
+        c->cached = true;
+        done.DecrementCount();
+        continue;
+      }
+    }
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
@@ -501,6 +578,11 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     Call* c = &calls[i];
     s.Update(c->status);
     partitions_[i].graph_handle = c->resp.graph_handle();
+    if (c->cached ||
+        (partition_cache_ && c->status.ok() &&
+         partition_cache_->Insert(c->cache_key, c->resp.graph_handle()))) {
+      partitions_[i].cache_key = c->cache_key;
+    }
   }
   return s;
 }
@@ -1102,6 +1184,11 @@ void MasterSession::ReffedClientGraph::DeregisterPartitions() {
     DeregisterGraphResponse resp;
   };
   for (Part& part : partitions_) {
+    if (!part.cache_key.empty() && !partition_cache_->Release(part.cache_key)) {
+      // The partition is still used by other client graphs.
+      worker_cache_->ReleaseWorker(part.name, part.worker);
+      continue;
+    }
     // The graph handle may be empty if we failed during partition registration.
     if (!part.graph_handle.empty()) {
       Call* c = new Call;
@@ -1246,6 +1333,9 @@ MasterSession::MasterSession(
       graph_version_(0),
       run_graphs_(5),
       partial_run_graphs_(5) {
+  if (session_opts_.config.experimental().share_identical_partitions()) {
+    partition_cache_ = std::make_shared<RegisteredPartitionCache>();
+  }
   UpdateLastAccessTime();
   CHECK(devices_) << "device_set was null!";
 
@@ -1694,10 +1784,25 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
   // The closures popts.{new_name,get_incarnation} are called synchronously in
   // RegisterPartitions() below, so do not need a Ref()/Unref() pair to keep
   // "this" alive during the closure.
-  popts.new_name = [this](const string& prefix) {
-    mutex_lock l(mu_);
-    return strings::StrCat(prefix, "_S", next_node_id_++);
-  };
+  // Partitions can only be shared if all client graphs name them alike, so the
+  // nodes and tensors added by partitioning are then named from the edges of
+  // the client graph only, independently of the other client graphs.
+  std::unordered_map<string, int64_t> name_counts;
+  if (partition_cache_) {
+    popts.new_name = [&name_counts](const string& prefix) {
+      return strings::StrCat(prefix, "_S", name_counts[prefix]++);
+    };
+    popts.get_tensor_name_attr = [](const Edge* edge) {
+      return strings::StrCat("edge_", edge->src()->name(), "_",
+                             edge->src_output(), "_", edge->dst()->name(), "_",
+                             edge->dst_input());
+    };
+  } else {
+    popts.new_name = [this](const string& prefix) {
+      mutex_lock l(mu_);
+      return strings::StrCat(prefix, "_S", next_node_id_++);
+    };
+  }
   popts.get_incarnation = [this](const string& name) -> int64 {
     Device* d = devices_->FindDeviceByName(name);
     if (d == nullptr) {
@@ -1725,7 +1830,8 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
     popts.need_to_record_start_times = true;
   }
 
-  TF_RETURN_IF_ERROR(rcg->RegisterPartitions(std::move(popts)));
+  TF_RETURN_IF_ERROR(
+      rcg->RegisterPartitions(std::move(popts), partition_cache_));
 
   return absl::OkStatus();
 }
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -206,6 +207,11 @@ class MasterSession : public core::RefCounted {
   // nodes) are unique across all sub-graphs within this session.
   int64_t next_node_id_ TF_GUARDED_BY(mu_) = 0;
 
+  // The partitions registered on workers, shared by the client graphs, or null
+  // if they aren't shared. See ConfigProto.Experimental.
+  class RegisteredPartitionCache;
+  std::shared_ptr<RegisteredPartitionCache> partition_cache_;
+
   // Used to cancel running steps on Close().
   CancellationManager cancellation_manager_;
 
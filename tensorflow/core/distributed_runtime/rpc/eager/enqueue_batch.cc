@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batch.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueBatch::EnqueueBatch(uint64 context_id, int64_t id) : id_(id) {
+  request_.set_context_id(context_id);
+}
+
+void EnqueueBatch::Add(const EnqueueRequest& request,
+                       EnqueueResponse* response, StatusCallback done) {
+  for (const QueueItem& item : request.queue()) {
+    *request_.add_queue() = item;
+  }
+  callers_.push_back({response, std::move(done), request.queue_size()});
+}
+
+void EnqueueBatch::Resolve(const Status& status, EnqueueResponse* response) {
+  const int num_succeeded = status.ok()
+                                ? response->queue_response_size()
+                                : response->queue_response_size() - 1;
+  int offset = 0;
+  for (Caller& caller : callers_) {
+    const int end = offset + caller.num_items;
+    if (end <= num_succeeded) {
+      for (int i = offset; i < end; ++i) {
+        caller.response->add_queue_response()->Swap(
+            response->mutable_queue_response(i));
+      }
+      caller.done(absl::OkStatus());
+    } else if (status.ok()) {
+      caller.done(errors::Internal("Expected a response to ", end,
+                                   " enqueued items, but got ",
+                                   response->queue_response_size()));
+    } else {
+      caller.done(status);
+    }
+    offset = end;
+  }
+}
+
+}  // namespace eager
+}  // namespace tensorflow
@@ -0,0 +1,70 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Queue items of consecutive enqueues to one remote context, merged into a
+// single EnqueueRequest, along with the callers they were enqueued by.
+//
+// Not thread-safe.
+class EnqueueBatch {
+ public:
+  // `id` distinguishes this batch from earlier batches of the same context.
+  EnqueueBatch(uint64 context_id, int64_t id);
+
+  // Appends the items of `request` to the batch. `done` is called by
+  // Resolve(), once the responses to those items have been added to
+  // `response`.
+  void Add(const EnqueueRequest& request, EnqueueResponse* response,
+           StatusCallback done);
+
+  // The request holding the items of every Add() call so far, in order.
+  const EnqueueRequest& request() const { return request_; }
+
+  int64_t id() const { return id_; }
+
+  // Hands the responses to the items of request() back to their callers, given
+  // the `status` and `response` of sending the request. The server stops at
+  // the first failing item, after adding its response: callers whose items all
+  // precede it succeed and the others get the error.
+  void Resolve(const Status& status, EnqueueResponse* response);
+
+ private:
+  struct Caller {
+    EnqueueResponse* response;
+    StatusCallback done;
+    int num_items;
+  };
+
+  const int64_t id_;
+  EnqueueRequest request_;
+  std::vector<Caller> callers_;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_ENQUEUE_BATCH_H_
@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batch.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+constexpr uint64 kContextId = 7;
+
+// One enqueue of a remote execute node: a request with the given operations,
+// and the response and status it is resolved with.
+struct Enqueue {
+  EnqueueRequest request;
+  EnqueueResponse response;
+  Status status = errors::Unknown("Not resolved");
+  int num_done = 0;
+};
+
+Enqueue MakeEnqueue(const std::vector<int64_t>& op_ids) {
+  Enqueue enqueue;
+  enqueue.request.set_context_id(kContextId);
+  for (int64_t op_id : op_ids) {
+    enqueue.request.add_queue()->mutable_operation()->set_id(op_id);
+  }
+  return enqueue;
+}
+
+void AddToBatch(Enqueue* enqueue, EnqueueBatch* batch) {
+  batch->Add(enqueue->request, &enqueue->response,
+             [enqueue](const Status& status) {
+               enqueue->status = status;
+               ++enqueue->num_done;
+             });
+}
+
+// Returns a response to `num_items` items, the i-th naming device "d<i>".
+EnqueueResponse MakeResponse(int num_items) {
+  EnqueueResponse response;
+  for (int i = 0; i < num_items; ++i) {
+    response.add_queue_response()->add_device(strings::StrCat("d", i));
+  }
+  return response;
+}
+
+std::vector<string> Devices(const EnqueueResponse& response) {
+  std::vector<string> devices;
+  for (const QueueResponse& queue_response : response.queue_response()) {
+    for (const string& device : queue_response.device()) {
+      devices.push_back(device);
+    }
+  }
+  return devices;
+}
+
+TEST(EnqueueBatchTest, MergesEnqueuesInOrder) {
+  EnqueueBatch batch(kContextId, /*id=*/3);
+  Enqueue first = MakeEnqueue({1});
+  Enqueue second = MakeEnqueue({2, 3});
+  Enqueue third = MakeEnqueue({4});
+  AddToBatch(&first, &batch);
+  AddToBatch(&second, &batch);
+  AddToBatch(&third, &batch);
+
+  EXPECT_EQ(batch.id(), 3);
+  EXPECT_EQ(batch.request().context_id(), kContextId);
+  ASSERT_EQ(batch.request().queue_size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(batch.request().queue(i).operation().id(), i + 1);
+  }
+  // Nothing is resolved before the batch is.
+  EXPECT_EQ(first.num_done, 0);
+  EXPECT_EQ(second.num_done, 0);
+  EXPECT_EQ(third.num_done, 0);
+}
+
+TEST(EnqueueBatchTest, SplitsResponsesPerEnqueue) {
+  EnqueueBatch batch(kContextId, /*id=*/0);
+  Enqueue first = MakeEnqueue({1});
+  Enqueue second = MakeEnqueue({2, 3});
+  Enqueue third = MakeEnqueue({4});
+  AddToBatch(&first, &batch);
+  AddToBatch(&second, &batch);
+  AddToBatch(&third, &batch);
+
+  EnqueueResponse response = MakeResponse(4);
+  batch.Resolve(absl::OkStatus(), &response);
+
+  EXPECT_EQ(first.num_done, 1);
+  EXPECT_EQ(second.num_done, 1);
+  EXPECT_EQ(third.num_done, 1);
+  TF_EXPECT_OK(first.status);
+  TF_EXPECT_OK(second.status);
+  TF_EXPECT_OK(third.status);
+  EXPECT_EQ(Devices(first.response), std::vector<string>({"d0"}));
+  EXPECT_EQ(Devices(second.response), std::vector<string>({"d1", "d2"}));
+  EXPECT_EQ(Devices(third.response), std::vector<string>({"d3"}));
+}
+
+TEST(EnqueueBatchTest, FailsEnqueuesFromTheFailingItemOn) {
+  EnqueueBatch batch(kContextId, /*id=*/0);
+  Enqueue first = MakeEnqueue({1});
+  Enqueue second = MakeEnqueue({2, 3});
+  Enqueue third = MakeEnqueue({4});
+  AddToBatch(&first, &batch);
+  AddToBatch(&second, &batch);
+  AddToBatch(&third, &batch);
+
+  // The server executed item 0 and failed on item 1.
+  EnqueueResponse response = MakeResponse(2);
+  batch.Resolve(errors::InvalidArgument("Op 2 failed"), &response);
+
+  EXPECT_EQ(first.num_done, 1);
+  EXPECT_EQ(second.num_done, 1);
+  EXPECT_EQ(third.num_done, 1);
+  TF_EXPECT_OK(first.status);
+  EXPECT_EQ(Devices(first.response), std::vector<string>({"d0"}));
+  EXPECT_TRUE(errors::IsInvalidArgument(second.status));
+  EXPECT_TRUE(errors::IsInvalidArgument(third.status));
+}
+
+TEST(EnqueueBatchTest, FailsAllEnqueuesOnRpcError) {
+  EnqueueBatch batch(kContextId, /*id=*/0);
+  Enqueue first = MakeEnqueue({1});
+  Enqueue second = MakeEnqueue({2, 3});
+  AddToBatch(&first, &batch);
+  AddToBatch(&second, &batch);
+
+  EnqueueResponse response;
+  batch.Resolve(errors::Unavailable("Stream closed"), &response);
+
+  EXPECT_EQ(first.num_done, 1);
+  EXPECT_EQ(second.num_done, 1);
+  EXPECT_TRUE(errors::IsUnavailable(first.status));
+  EXPECT_TRUE(errors::IsUnavailable(second.status));
+  EXPECT_EQ(first.response.queue_response_size(), 0);
+  EXPECT_EQ(second.response.queue_response_size(), 0);
+}
+
+TEST(EnqueueBatchTest, FailsEnqueuesMissingResponses) {
+  EnqueueBatch batch(kContextId, /*id=*/0);
+  Enqueue first = MakeEnqueue({1});
+  Enqueue second = MakeEnqueue({2, 3});
+  AddToBatch(&first, &batch);
+  AddToBatch(&second, &batch);
+
+  EnqueueResponse response = MakeResponse(2);
+  batch.Resolve(absl::OkStatus(), &response);
+
+  TF_EXPECT_OK(first.status);
+  EXPECT_TRUE(errors::IsInternal(second.status));
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rpc/eager/enqueue_batch.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -74,6 +77,26 @@ bool EnableStreaming() {
   return result;
 }
 
+// Setting environment variable "TF_EAGER_CLIENT_ENQUEUE_BATCH_SIZE" to N > 1
+// makes streaming enqueue merge up to N queue items destined for the same
+// remote context into a single request, which lowers the RPC rate per worker
+// when many small ops are dispatched asynchronously. A batch that is not full
+// is sent "TF_EAGER_CLIENT_ENQUEUE_BATCH_TIMEOUT_US" microseconds after its
+// first item was added. Items are sent in the order they were enqueued.
+int64_t EnqueueBatchSize() {
+  int64_t result;
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_SIZE", 1, &result));
+  return result;
+}
+
+int64_t EnqueueBatchTimeoutUs() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_TIMEOUT_US",
+                                  100, &result));
+  return result;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -119,7 +142,11 @@ class GrpcEagerClient : public EagerClient {
  public:
   GrpcEagerClient(const tensorflow::SharedGrpcChannelPtr& channel,
                   GrpcEagerClientThread* thread, const string& target)
-      : stub_(channel), thread_(thread), target_(target) {
+      : stub_(channel),
+        thread_(thread),
+        target_(target),
+        max_enqueue_batch_size_(EnqueueBatchSize()),
+        enqueue_batch_timeout_us_(EnqueueBatchTimeoutUs()) {
     // Hold a reference to make sure the corresponding EagerClientThread
     // outlives the client.
     thread_->Ref();
@@ -209,6 +236,9 @@ class GrpcEagerClient : public EagerClient {
     mutex_lock l(mu_);
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
+      // Send the pending batch so that its callers are notified when the
+      // streaming call is cancelled, as for requests already in flight.
+      FlushEnqueueBatch(request->context_id());
       it->second.CancelCall();
       enqueue_dispatchers_.erase(it);
     } else if (EnableStreaming()) {
@@ -240,7 +270,12 @@ class GrpcEagerClient : public EagerClient {
         it = it_and_bool.first;
       }
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      if (max_enqueue_batch_size_ > 1) {
+        AddToEnqueueBatch(*request, response, std::move(done_wrapped));
+      } else {
+        it->second.SendNextRequest(*request, response,
+                                   std::move(done_wrapped));
+      }
     } else {
       Notification n;
       Status status;
@@ -266,6 +301,67 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  const int64_t max_enqueue_batch_size_;
+  const int64_t enqueue_batch_timeout_us_;
+  // Queue items waiting to be sent to a remote context in a single streaming
+  // request, keyed on context id.
+  std::unordered_map<uint64, EnqueueBatch> enqueue_batches_ TF_GUARDED_BY(mu_);
+  int64_t next_enqueue_batch_id_ TF_GUARDED_BY(mu_) = 0;
+
+  // Adds the items of `request` to the batch of its context, and sends the
+  // batch once it is full. `done` is called once the response to the items
+  // has been copied to `response`.
+  void AddToEnqueueBatch(const EnqueueRequest& request,
+                         EnqueueResponse* response, StatusCallback done)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const uint64 context_id = request.context_id();
+    auto it = enqueue_batches_.find(context_id);
+    const bool is_new_batch = it == enqueue_batches_.end();
+    if (is_new_batch) {
+      it = enqueue_batches_
+               .try_emplace(context_id, context_id, next_enqueue_batch_id_++)
+               .first;
+    }
+    EnqueueBatch& batch = it->second;
+    batch.Add(request, response, std::move(done));
+
+    if (batch.request().queue_size() >= max_enqueue_batch_size_) {
+      FlushEnqueueBatch(context_id);
+    } else if (is_new_batch) {
+      Ref();
+      // The id tells whether the batch was already sent when the closure runs.
+      Env::Default()->SchedClosureAfter(
+          enqueue_batch_timeout_us_, [this, context_id, id = batch.id()]() {
+            {
+              mutex_lock l(mu_);
+              const auto it = enqueue_batches_.find(context_id);
+              if (it != enqueue_batches_.end() && it->second.id() == id) {
+                FlushEnqueueBatch(context_id);
+              }
+            }
+            this->Unref();
+          });
+    }
+  }
+
+  // Sends the pending batch of `context_id`, if any, on its streaming call.
+  void FlushEnqueueBatch(uint64 context_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto batch_it = enqueue_batches_.find(context_id);
+    if (batch_it == enqueue_batches_.end()) {
+      return;
+    }
+    auto batch = std::make_shared<EnqueueBatch>(std::move(batch_it->second));
+    enqueue_batches_.erase(batch_it);
+    auto response = std::make_shared<EnqueueResponse>();
+    // Batches are only created for contexts with a dispatcher, which outlives
+    // them.
+    enqueue_dispatchers_.at(context_id)
+        .SendNextRequest(batch->request(), response.get(),
+                         [batch, response](const Status& status) {
+                           batch->Resolve(status, response.get());
+                         });
+  }
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
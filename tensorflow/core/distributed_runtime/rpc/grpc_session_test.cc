@@ -315,6 +315,43 @@ TEST(GrpcSessionTest, FetchMultipleTimes) {
   TF_ASSERT_OK(session->Close());
 }
 
+TEST(GrpcSessionTest, ShareIdenticalPartitions) {
+  GraphDef graph;
+  string node_names[3];
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
+      TestClusterConfig()
+          .Options(Devices(1, 0))
+          .Jobs({TestJob{"localhost", /*num_tasks=*/2}}),
+      &cluster));
+
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_experimental()->set_share_identical_partitions(true);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(graph));
+
+  // The client graphs for the different fetches share partitions.
+  const std::vector<std::pair<string, Tensor>> inputs;
+  const string a = node_names[0] + ":0";
+  const string c = node_names[2] + ":0";
+  for (int iters = 0; iters < 3; ++iters) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(inputs, {c}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(4.0, outputs[0].flat<float>()(0));
+
+    TF_ASSERT_OK(session->Run(inputs, {c, a}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ(4.0, outputs[0].flat<float>()(0));
+    test::ExpectTensorEqual<float>(
+        outputs[1], test::AsTensor<float>({1, 2}, TensorShape({1, 2})));
+  }
+  TF_ASSERT_OK(session->Close());
+}
+
 TEST(GrpcSessionTest, DisableOutputPartitionGraphs) {
   GraphDef graph;
   string node_names[3];
@@ -18,6 +18,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -134,7 +135,49 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+namespace {
+
+// Encodes `response`, whose tensor field must be unset, with `val` as its
+// tensor compressed into `*result`. Returns false, leaving `*response` and
+// `*result` unchanged, if compression doesn't make the contents smaller.
+bool EncodeCompressedTensorWithResponse(RecvTensorResponse* response,
+                                        const Tensor& val,
+                                        ::grpc::ByteBuffer* result) {
+  TensorProto tensor;
+  if (!CompressTensorContent(val, tensor.mutable_tensor_content()) ||
+      tensor.tensor_content().size() >= val.TotalBytes()) {
+    return false;
+  }
+  tensor.set_dtype(val.dtype());
+  val.shape().AsProto(tensor.mutable_tensor_shape());
+
+  // The receiver must see "compressed" before the tensor, so the tensor is
+  // encoded after all the other fields, out of field number order.
+  response->set_compressed(true);
+  response->set_send_start_micros(Env::Default()->NowMicros());
+  string header;
+  response->AppendToString(&header);
+  const size_t tensor_size = tensor.ByteSizeLong();
+  ::grpc::Slice slice(header.size() +
+                      VarLengthEncodingSize(
+                          RecvTensorResponse::kTensorFieldNumber, tensor_size));
+  io::ProtoEncodeHelper e(
+      const_cast<char*>(reinterpret_cast<const char*>(slice.begin())),
+      slice.size());
+  e.WriteRawBytes(header);
+  e.WriteVarlengthBeginning(RecvTensorResponse::kTensorFieldNumber,
+                            tensor_size);
+  tensor.SerializeWithCachedSizesToArray(
+      const_cast<uint8*>(reinterpret_cast<const uint8*>(slice.begin())) +
+      e.size());
+  ::grpc::ByteBuffer tmp(&slice, 1);
+  result->Swap(&tmp);
+  return true;
+}
+
+// Encodes `response`, whose tensor field must be unset, with `val` as its
+// tensor into `*result`.
+void EncodeTensorWithResponse(RecvTensorResponse* response, const Tensor& val,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   const int64_t kProtoBufLimitBytes = 1LL << 31;
@@ -147,20 +190,15 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                << ", tensor shape: " << val.shape().AsProto().DebugString();
   }
 
-  RecvTensorResponse response;
-  if (is_dead) {
-    response.set_is_dead(is_dead);
-  }
-  response.set_require_ack(require_ack);
-  response.set_send_start_micros(Env::Default()->NowMicros());
+  response->set_send_start_micros(Env::Default()->NowMicros());
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
-    val.AsProtoTensorContent(response.mutable_tensor());
+    val.AsProtoTensorContent(response->mutable_tensor());
 
     // Encode full protocol buffer to a ByteBuffer
-    EncodeRecvTensorResponseToByteBuffer(response, result);
+    EncodeRecvTensorResponseToByteBuffer(*response, result);
   } else {
     // skeleton is the encoded TensorProto contents (dtype and shape), but
     // not the actual data
@@ -174,7 +212,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
          VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
                                tdata.size()));
     string header;  // All of RecvTensorResponse except the tensor() field
-    response.AppendToString(&header);
+    response->AppendToString(&header);
 
     size_t expected_size =
         (header.size() +
@@ -250,5 +288,42 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+}  // namespace
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  response.set_require_ack(require_ack);
+  EncodeTensorWithResponse(&response, val, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              int64_t compression_min_bytes,
+                              ::grpc::ByteBuffer* result) {
+  if (is_dead || compression_min_bytes <= 0 ||
+      !DataTypeCanUseMemcpy(val.dtype()) ||
+      val.TotalBytes() < compression_min_bytes) {
+    EncodeTensorToByteBuffer(is_dead, val, require_ack, result);
+    return;
+  }
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  if (!EncodeCompressedTensorWithResponse(&response, val, result)) {
+    EncodeTensorWithResponse(&response, val, result);
+  }
+}
+
+void EncodeTensorChunkToByteBuffer(const Tensor& chunk,
+                                   const TensorShape& shape, bool require_ack,
+                                   ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  shape.AsProto(response.mutable_chunked_tensor_shape());
+  EncodeTensorWithResponse(&response, chunk, result);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
@@ -16,10 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <cstdint>
+
 #include "grpcpp/impl/codegen/byte_buffer.h"
 
 namespace tensorflow {
 class Tensor;
+class TensorShape;
 class RecvTensorResponse;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
@@ -49,6 +52,24 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Like above, but if "compression_min_bytes" is positive, compresses the
+// contents of "val" as described by "RecvTensorResponse::compressed" when it
+// holds at least "compression_min_bytes" bytes and compression makes it
+// smaller.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              int64_t compression_min_bytes,
+                              ::grpc::ByteBuffer* result);
+
+// Encode "chunk", a 1-D slice of the flattened contents of a live tensor of
+// shape "shape", into a byte buffer in a format that is parseable as a
+// RecvTensorResponse protocol buffer holding "chunk" as its tensor and "shape"
+// as its chunked_tensor_shape.
+//
+// Discards original contents of *result.
+void EncodeTensorChunkToByteBuffer(const Tensor& chunk,
+                                   const TensorShape& shape, bool require_ack,
+                                   ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
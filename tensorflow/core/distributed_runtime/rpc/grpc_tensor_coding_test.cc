@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -100,4 +101,79 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, Chunk) {
+  Tensor t(DT_FLOAT, TensorShape({4, 1000}));
+  test::FillIota<float>(&t, 0);
+  Tensor flat;
+  ASSERT_TRUE(flat.CopyFrom(t, TensorShape({4000})));
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorChunkToByteBuffer(flat.Slice(1000, 3000), t.shape(),
+                                      /*require_ack=*/true, &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  EXPECT_FALSE(response.is_dead());
+  EXPECT_TRUE(response.require_ack());
+  EXPECT_EQ(TensorShape(response.chunked_tensor_shape()), t.shape());
+
+  Tensor chunk;
+  ASSERT_TRUE(chunk.FromProto(response.tensor()));
+  Tensor expected(DT_FLOAT, TensorShape({2000}));
+  test::FillIota<float>(&expected, 1000);
+  test::ExpectTensorEqual<float>(chunk, expected);
+}
+
+TEST_F(GrpcTensorCodingTest, Compressed) {
+  Tensor t(DT_FLOAT, TensorShape({4, 1000}));
+  test::FillIota<float>(&t, 0);
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, /*require_ack=*/false,
+                                 /*compression_min_bytes=*/1024, &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  EXPECT_LT(tmp.size(), t.TotalBytes());
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  ASSERT_TRUE(response.compressed());
+  EXPECT_EQ(TensorShape(response.tensor().tensor_shape()), t.shape());
+
+  Tensor result(DT_FLOAT, t.shape());
+  ASSERT_TRUE(UncompressTensorContent(
+      response.tensor().tensor_content(), DT_FLOAT,
+      const_cast<char*>(result.tensor_data().data()), result.TotalBytes()));
+  test::ExpectTensorEqual<float>(result, t);
+}
+
+TEST_F(GrpcTensorCodingTest, SmallTensorNotCompressed) {
+  Tensor t(DT_FLOAT, TensorShape({10}));
+  test::FillIota<float>(&t, 0);
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, t, /*require_ack=*/false,
+                                 /*compression_min_bytes=*/1024, &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  EXPECT_FALSE(response.compressed());
+  Tensor result;
+  ASSERT_TRUE(result.FromProto(response.tensor()));
+  test::ExpectTensorEqual<float>(result, t);
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -45,6 +46,8 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
@@ -446,14 +449,43 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  const bool chunked = (request->max_chunk_bytes() > 0 && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
-    if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+  // Requests for the remaining chunks of a tensor are served from the tensor
+  // kept by the request for its first chunk.
+  if (chunked && request->chunk_offset() > 0) {
+    Tensor tensor;
+    {
+      mutex_lock l(chunked_tensors_mu_);
+      auto it = chunked_tensors_.find(request_id);
+      if (it == chunked_tensors_.end()) {
+        done(errors::FailedPrecondition(
+            "No chunked tensor found for RecvTensor request ", request_id,
+            " at offset ", request->chunk_offset()));
+        return;
+      }
+      tensor = it->second.tensor;
     }
-    done(status);
+    done(EncodeRecvTensorChunk(*request, tensor, /*is_dead=*/false,
+                               cache_enabled, response));
+    return;
+  }
+
+  auto do_response = [this, request, response, done, cache_enabled, chunked](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
+    Status s = status;
+    if (s.ok()) {
+      if (chunked) {
+        s = EncodeRecvTensorChunk(*request, tensor, is_dead, cache_enabled,
+                                  response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       request->compression_min_bytes(),
+                                       response);
+      }
+    }
+    done(s);
   };
 
   // If response cache is enabled and the response cache already contains the
@@ -554,6 +586,39 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+Status GrpcWorker::EncodeRecvTensorChunk(const RecvTensorRequest& request,
+                                         const Tensor& tensor, bool is_dead,
+                                         bool cache_enabled,
+                                         ::grpc::ByteBuffer* response) {
+  const int64_t offset = request.chunk_offset();
+  if (is_dead || !DataTypeCanUseMemcpy(tensor.dtype()) ||
+      (offset == 0 && tensor.TotalBytes() <= request.max_chunk_bytes())) {
+    grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+    return absl::OkStatus();
+  }
+  const int64_t num_elements = tensor.NumElements();
+  if (offset < 0 || offset >= num_elements) {
+    return errors::InvalidArgument("RecvTensor chunk offset ", offset,
+                                   " is out of range for a tensor of ",
+                                   num_elements, " elements");
+  }
+  const int64_t chunk_elements = std::max<int64_t>(
+      1, request.max_chunk_bytes() / DataTypeSize(tensor.dtype()));
+  const int64_t end = std::min(num_elements, offset + chunk_elements);
+  if (offset == 0) {
+    mutex_lock l(chunked_tensors_mu_);
+    chunked_tensors_[request.request_id()] = {request.step_id(), tensor};
+  }
+  Tensor flat;
+  CHECK(flat.CopyFrom(tensor, TensorShape({num_elements})));
+  // The receiver asks for the last chunk only once it has all the others, so
+  // its ack releases the tensor.
+  grpc::EncodeTensorChunkToByteBuffer(flat.Slice(offset, end), tensor.shape(),
+                                      /*require_ack=*/end == num_elements,
+                                      response);
+  return absl::OkStatus();
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -736,6 +801,16 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  {
+    mutex_lock l(chunked_tensors_mu_);
+    for (auto it = chunked_tensors_.begin(); it != chunked_tensors_.end();) {
+      if (it->second.step_id == request->step_id()) {
+        chunked_tensors_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
@@ -745,6 +820,8 @@ void GrpcWorker::RemoveCacheEntryForId(int64_t request_id) {
   if (response_cache_) {
     response_cache_->EraseRequestId(request_id);
   }
+  mutex_lock l(chunked_tensors_mu_);
+  chunked_tensors_.erase(request_id);
 }
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env,
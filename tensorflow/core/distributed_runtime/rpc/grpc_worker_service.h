@@ -20,10 +20,14 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
 #include "xla/tsl/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace grpc {
@@ -68,8 +72,26 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  // A tensor sent in chunks, kept until the receiver acks the last chunk or
+  // the step is cleaned up.
+  struct ChunkedTensor {
+    int64_t step_id;
+    Tensor tensor;
+  };
+
+  // Encodes the chunk of `tensor` asked for by `request` into `*response`, or
+  // the whole tensor if it should not be sent in chunks.
+  Status EncodeRecvTensorChunk(const RecvTensorRequest& request,
+                               const Tensor& tensor, bool is_dead,
+                               bool cache_enabled,
+                               ::grpc::ByteBuffer* response);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+
+  mutex chunked_tensors_mu_;
+  absl::flat_hash_map<int64_t, ChunkedTensor> chunked_tensors_
+      TF_GUARDED_BY(chunked_tensors_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -23,6 +28,9 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -31,15 +39,46 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Maximum number of chunk requests of a chunked RecvTensor call in flight.
+constexpr int kMaxRecvTensorChunksInFlight = 4;
+
+// Returns the chunk size, in bytes, in which tensors received into device
+// memory are requested, or 0 if they are received whole. Chunked tensors are
+// received into host memory and copied to the device chunk by chunk, so that
+// the copy of the first chunks overlaps with the transfer of the others.
+int64_t RecvTensorChunkBytes() {
+  static const int64_t chunk_bytes = []() {
+    int64_t value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_CHUNK_BYTES", 0, &value));
+    return value;
+  }();
+  return chunk_bytes;
+}
+
+// Returns the minimum size in bytes of the tensors whose contents the RPC
+// rendezvous asks to receive compressed, or 0 if it doesn't.
+int64_t RecvTensorCompressionMinBytes() {
+  static const int64_t min_bytes = []() {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_RPC_RECV_TENSOR_COMPRESSION_MIN_BYTES", 0, &value));
+    return value;
+  }();
+  return min_bytes;
+}
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<RemoteTensorTransport> transport)
+      : BaseRemoteRendezvous(env, step_id), transport_(std::move(transport)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +88,15 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives the tensor of `parsed` with `transport_` if it can, and returns
+  // whether it does.
+  bool RecvFromTransportAsync(const Rendezvous::ParsedKey& parsed,
+                              Device* dst_device,
+                              const Rendezvous::Args& recv_args,
+                              DoneCallback& done);
+
+  const std::shared_ptr<RemoteTensorTransport> transport_;
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -69,6 +117,13 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    if (RecvTensorChunkBytes() > 0 && !alloc_attrs.on_host() &&
+        dst_device->tensorflow_accelerator_device_info() != nullptr) {
+      req_.set_max_chunk_bytes(RecvTensorChunkBytes());
+    }
+    if (RecvTensorCompressionMinBytes() > 0) {
+      req_.set_compression_min_bytes(RecvTensorCompressionMinBytes());
+    }
   }
 
   void Reset() {
@@ -83,9 +138,14 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    device_tensor_ = Tensor();
+    flat_device_tensor_ = Tensor();
+    has_device_tensor_ = false;
+    device_context_ = nullptr;
     {
       mutex_lock l(mu_);
       status_ = absl::OkStatus();
+      chunk_calls_.clear();
     }
     done_ = nullptr;
   }
@@ -103,11 +163,18 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   }
 
   void StartAbort(const Status& s) override {
+    std::vector<CallOptions*> chunk_opts;
     {
       mutex_lock l(mu_);
       status_.Update(s);
+      for (const auto& chunk_call : chunk_calls_) {
+        chunk_opts.push_back(&chunk_call->opts);
+      }
     }
     opts_.StartCancel();
+    for (CallOptions* opts : chunk_opts) {
+      opts->StartCancel();
+    }
   }
 
   Status status() const override {
@@ -122,7 +189,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return has_device_tensor_ ? device_tensor_ : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
@@ -133,18 +202,30 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
  private:
   friend class RpcRemoteRendezvous;
 
+  // A RecvTensor call for one of the chunks after the first.
+  struct ChunkCall {
+    int64_t offset = 0;
+    CallOptions opts;
+    RecvTensorRequest req;
+    TensorResponse resp;
+  };
+
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
-    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    const bool chunked = req_.max_chunk_bytes() > 0;
+    resp_.InitAlloc(dst_device_, chunked ? HostAllocAttrs() : alloc_attrs_);
     auto abort_checked = std::make_shared<Notification>();
-    auto cb = [this, abort_checked,
-               recv_done = std::move(recv_done)](const Status& s) {
+    auto cb = [this, abort_checked, chunked,
+               recv_done = std::move(recv_done)](const Status& s) mutable {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
+      } else if (chunked) {
+        StartChunkedCopy(std::move(recv_done));
+        return;
       }
       recv_done();
     };
@@ -167,6 +248,201 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Attributes of the pinned host memory that chunks are received into.
+  AllocatorAttributes HostAllocAttrs() const {
+    AllocatorAttributes attrs = alloc_attrs_;
+    attrs.set_on_host(true);
+    attrs.set_gpu_compatible(true);
+    return attrs;
+  }
+
+  // Copies the host tensor received by the main call, which is either the
+  // whole tensor or its first chunk, to `dst_device_`, and fetches and copies
+  // the remaining chunks, if any. Calls `recv_done` when all chunks have been
+  // copied or the call failed.
+  void StartChunkedCopy(std::function<void()> recv_done) {
+    const Tensor& host_tensor = resp_.tensor();
+    if (resp_.metadata().is_dead()) {
+      recv_done();
+      return;
+    }
+    if (!DataTypeCanUseMemcpy(host_tensor.dtype())) {
+      // Such tensors are never sent in chunks.
+      TensorProto proto;
+      host_tensor.AsProtoTensorContent(&proto);
+      Status s = dst_device_->MakeTensorFromProto(proto, alloc_attrs_,
+                                                  &device_tensor_);
+      if (s.ok()) {
+        has_device_tensor_ = true;
+      } else {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+      return;
+    }
+
+    TensorShape shape = host_tensor.shape();
+    Status s;
+    if (resp_.metadata().has_chunked_tensor_shape()) {
+      s = TensorShape::BuildTensorShape(resp_.metadata().chunked_tensor_shape(),
+                                        &shape);
+      if (s.ok() &&
+          (host_tensor.dims() != 1 || host_tensor.NumElements() == 0 ||
+           host_tensor.NumElements() > shape.num_elements())) {
+        s = errors::Internal("Unexpected first RecvTensor chunk of shape ",
+                             host_tensor.shape().DebugString(), " for ",
+                             req_.rendezvous_key());
+      }
+    }
+    if (s.ok()) {
+      device_tensor_ = Tensor(dst_device_->GetAllocator(alloc_attrs_),
+                              host_tensor.dtype(), shape);
+      if (!device_tensor_.IsInitialized() && shape.num_elements() > 0) {
+        s = errors::ResourceExhausted("OOM when allocating tensor of shape ",
+                                      shape.DebugString(), " on ",
+                                      dst_device_->name());
+      }
+    }
+    if (!s.ok()) {
+      device_tensor_ = Tensor();
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      recv_done();
+      return;
+    }
+    has_device_tensor_ = true;
+    if (shape.num_elements() == 0) {
+      recv_done();
+      return;
+    }
+
+    device_context_ = recv_args_.device_context;
+    if (device_context_ == nullptr) {
+      device_context_ =
+          dst_device_->tensorflow_accelerator_device_info()->default_context;
+    }
+    CHECK(flat_device_tensor_.CopyFrom(device_tensor_,
+                                       TensorShape({shape.num_elements()})));
+    {
+      mutex_lock l(mu_);
+      chunks_done_ = std::move(recv_done);
+      num_elements_ = shape.num_elements();
+      chunk_elements_ = std::max<int64_t>(1, host_tensor.NumElements());
+      next_chunk_offset_ = host_tensor.NumElements();
+      chunks_in_flight_ = 0;
+      pending_ops_ = 1;
+    }
+    StartChunkCalls();
+    CopyChunkToDevice(host_tensor, 0);
+  }
+
+  // Issues requests for the next chunks, up to kMaxRecvTensorChunksInFlight at
+  // a time. The last chunk is requested only once all others have been
+  // received, since the sender releases the tensor when it is acked.
+  void StartChunkCalls() {
+    std::vector<ChunkCall*> calls;
+    {
+      mutex_lock l(mu_);
+      // Keeps the call alive while the requests are issued.
+      ++pending_ops_;
+      while (status_.ok() && next_chunk_offset_ < num_elements_ &&
+             chunks_in_flight_ < kMaxRecvTensorChunksInFlight) {
+        const int64_t end =
+            std::min(num_elements_, next_chunk_offset_ + chunk_elements_);
+        if (end == num_elements_ && chunks_in_flight_ > 0) break;
+        auto call = std::make_unique<ChunkCall>();
+        call->offset = next_chunk_offset_;
+        call->req = req_;
+        call->req.set_chunk_offset(next_chunk_offset_);
+        call->resp.InitAlloc(dst_device_, HostAllocAttrs());
+        calls.push_back(call.get());
+        chunk_calls_.push_back(std::move(call));
+        next_chunk_offset_ = end;
+        ++chunks_in_flight_;
+      }
+    }
+    for (ChunkCall* call : calls) {
+      wi_->RecvTensorAsync(&call->opts, &call->req, &call->resp,
+                           [this, call](const Status& s) {
+                             ChunkReceived(call, s);
+                           });
+      // See the comment in StartRTCall().
+      if (!status().ok()) {
+        call->opts.StartCancel();
+      }
+    }
+    {
+      mutex_lock l(mu_);
+      --pending_ops_;
+    }
+    MaybeFinishChunks();
+  }
+
+  void ChunkReceived(ChunkCall* call, Status s) {
+    const int64_t offset = call->offset;
+    const Tensor chunk = call->resp.tensor();
+    if (s.ok() &&
+        (!call->resp.metadata().has_chunked_tensor_shape() ||
+         chunk.dtype() != device_tensor_.dtype() || chunk.dims() != 1 ||
+         chunk.NumElements() !=
+             std::min(chunk_elements_, num_elements_ - offset))) {
+      s = errors::Internal("Unexpected RecvTensor chunk at offset ", offset,
+                           " for ", req_.rendezvous_key());
+    }
+    // Only `chunk` references the received data from now on, so that it is
+    // freed once copied.
+    call->resp.ClearTensor();
+    {
+      mutex_lock l(mu_);
+      --chunks_in_flight_;
+      if (s.ok()) {
+        ++pending_ops_;
+      } else {
+        status_.Update(s);
+      }
+    }
+    if (s.ok()) {
+      StartChunkCalls();
+      CopyChunkToDevice(chunk, offset);
+    } else {
+      MaybeFinishChunks();
+    }
+  }
+
+  // Copies `chunk` to the elements of `device_tensor_` starting at `offset`.
+  void CopyChunkToDevice(const Tensor& chunk, int64_t offset) {
+    Tensor* cpu_tensor = new Tensor(chunk);
+    Tensor* device_slice = new Tensor(
+        flat_device_tensor_.Slice(offset, offset + chunk.NumElements()));
+    device_context_->CopyCPUTensorToDevice(
+        cpu_tensor, dst_device_, device_slice,
+        [this, cpu_tensor, device_slice](const Status& s) {
+          delete cpu_tensor;
+          delete device_slice;
+          {
+            mutex_lock l(mu_);
+            --pending_ops_;
+            status_.Update(s);
+          }
+          MaybeFinishChunks();
+        });
+  }
+
+  void MaybeFinishChunks() {
+    std::function<void()> done;
+    {
+      mutex_lock l(mu_);
+      if (chunks_in_flight_ > 0 || pending_ops_ > 0) return;
+      if (status_.ok() && next_chunk_offset_ < num_elements_) return;
+      done = std::move(chunks_done_);
+      chunks_done_ = nullptr;
+    }
+    if (done) done();
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -178,8 +454,25 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
+  // Destination of a chunked call, and its flattened view.
+  Tensor device_tensor_;
+  Tensor flat_device_tensor_;
+  bool has_device_tensor_ = false;
+  DeviceContext* device_context_ = nullptr;  // Not owned.
+
+  // Number of elements of the whole tensor and of each chunk of a chunked
+  // call.
+  int64_t num_elements_ = 0;
+  int64_t chunk_elements_ = 0;
+
   mutable mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<ChunkCall>> chunk_calls_ TF_GUARDED_BY(mu_);
+  int64_t next_chunk_offset_ TF_GUARDED_BY(mu_) = 0;
+  int chunks_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // Chunk copies and StartChunkCalls() invocations in progress.
+  int pending_ops_ TF_GUARDED_BY(mu_) = 0;
+  std::function<void()> chunks_done_ TF_GUARDED_BY(mu_);
 
   RpcRecvTensorCall(const RpcRecvTensorCall&) = delete;
   void operator=(const RpcRecvTensorCall&) = delete;
@@ -260,12 +553,13 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   if (s.ok()) {
     s = sess->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
   }
-  if (!s.ok()) {
+  if (!s.ok() ||
+      RecvFromTransportAsync(parsed, dst_device, recv_args, done)) {
     if (rwi != nullptr) {
       sess->worker_cache()->ReleaseWorker(call->src_worker_, rwi);
     }
     get_call_freelist()->Release(call);
-    done(s, Args(), recv_args, Tensor{}, false);
+    if (!s.ok()) done(s, Args(), recv_args, Tensor{}, false);
     return;
   }
 
@@ -305,15 +599,48 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+bool RpcRemoteRendezvous::RecvFromTransportAsync(
+    const Rendezvous::ParsedKey& parsed, Device* dst_device,
+    const Rendezvous::Args& recv_args, DoneCallback& done) {
+  if (transport_ == nullptr) return false;
+  std::unique_ptr<RemoteTensorTransportCall> call = transport_->CreateRecvCall(
+      session(), step_id_, parsed, dst_device, recv_args);
+  if (call == nullptr) return false;
+
+  // Record "call" in calls_ so that it can be aborted cleanly.
+  RegisterCall(call.get(), recv_args);
+  if (!call->status().ok()) {
+    DeregisterCall(call.get(), recv_args);
+    done(call->status(), Args(), Args(), Tensor(), false);
+    return true;
+  }
+
+  Ref();
+  RemoteTensorTransportCall* started_call = call.release();
+  started_call->Start([this, started_call, recv_args,
+                       done = std::move(done)]() {
+    // Removes "call" from calls_. Prevent StartAbort().
+    DeregisterCall(started_call, recv_args);
+    const Status s = started_call->status();
+    done(s, Args(), recv_args,
+         s.ok() ? started_call->tensor() : Tensor(),
+         s.ok() && started_call->is_dead());
+    delete started_call;
+    Unref();
+  });
+  return true;
+}
+
 }  // namespace
 
-RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+RpcRendezvousMgr::RpcRendezvousMgr(
+    const WorkerEnv* env, std::shared_ptr<RemoteTensorTransport> transport)
+    : BaseRendezvousMgr(env), transport_(std::move(transport)) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, transport_));
 }
 
 }  // end namespace tensorflow
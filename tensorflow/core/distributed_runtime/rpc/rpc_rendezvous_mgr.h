@@ -16,13 +16,45 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
+class Device;
 class DeviceMgr;
+class WorkerSession;
+
+// A call receiving a tensor through a RemoteTensorTransport.
+class RemoteTensorTransportCall : public BaseRecvTensorCall {
+ public:
+  // The received tensor and whether it is dead, valid once the call is done
+  // with an OK status.
+  virtual const Tensor& tensor() const = 0;
+  virtual bool is_dead() const = 0;
+};
+
+// Moves tensors between workers without the RecvTensor RPC, e.g. with
+// one-sided RDMA writes into memory registered once per allocator region.
+// The RPCs still carry the control messages of the steps.
+class RemoteTensorTransport {
+ public:
+  virtual ~RemoteTensorTransport() = default;
+
+  // Returns a call that receives the tensor of `parsed`, sent on `step_id`,
+  // into `dst_device` once started, or nullptr if this transport cannot
+  // receive it, in which case it is received with the RecvTensor RPC.
+  virtual std::unique_ptr<RemoteTensorTransportCall> CreateRecvCall(
+      WorkerSession* session, int64_t step_id,
+      const Rendezvous::ParsedKey& parsed, Device* dst_device,
+      const Rendezvous::Args& recv_args) = 0;
+};
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
@@ -44,13 +76,19 @@ class DeviceMgr;
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
-  explicit RpcRendezvousMgr(const WorkerEnv* env);
+  // If `transport` is not null, tensors are received through it when it can,
+  // and with the RecvTensor RPC otherwise.
+  explicit RpcRendezvousMgr(
+      const WorkerEnv* env,
+      std::shared_ptr<RemoteTensorTransport> transport = nullptr);
 
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  const std::shared_ptr<RemoteTensorTransport> transport_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <functional>
+#include <memory>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -305,6 +308,58 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvOne) {
   rmgr_.Cleanup(step_id);
 }
 
+// Receives the tensors named "transported" with the value "transport".
+class FakeTransport : public RemoteTensorTransport {
+ public:
+  std::unique_ptr<RemoteTensorTransportCall> CreateRecvCall(
+      WorkerSession* session, int64_t step_id,
+      const Rendezvous::ParsedKey& parsed, Device* dst_device,
+      const Rendezvous::Args& recv_args) override {
+    if (parsed.edge_name != "transported") return nullptr;
+    return std::make_unique<Call>();
+  }
+
+ private:
+  class Call : public RemoteTensorTransportCall {
+   public:
+    void Start(std::function<void()> recv_done) override {
+      tensor_ = V("transport");
+      recv_done();
+    }
+    void StartAbort(const Status& s) override {}
+    Status status() const override { return absl::OkStatus(); }
+    const Tensor& tensor() const override { return tensor_; }
+    bool is_dead() const override { return false; }
+
+   private:
+    Tensor tensor_;
+  };
+};
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvWithTransport) {
+  RpcRendezvousMgr rmgr(&env, std::make_shared<FakeTransport>());
+  const int64_t step_id = 123;
+  const Rendezvous::ParsedKey transported_key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "transported", FrameAndIter(0, 0)));
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Rendezvous::Args args;
+    Tensor val(DT_STRING);
+    bool val_dead = false;
+
+    TF_ASSERT_OK(rendez->Recv(transported_key, args, &val, &val_dead));
+    EXPECT_EQ(V(val), "transport");
+    // The tensors that the transport does not receive use the RPC.
+    TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+  }
+  rmgr.Cleanup(step_id);
+}
+
 TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   const int64_t step_id = 123;
   const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
@@ -15,14 +15,87 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <string>
+#include <utility>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 
+bool CompressTensorContent(const Tensor& val, std::string* out) {
+  const StringPiece data = val.tensor_data();
+  const size_t element_size = DataTypeSize(val.dtype());
+  if (element_size <= 1) {
+    return port::Snappy_Compress(data.data(), data.size(), out);
+  }
+  // Shuffling the bytes groups the similar high order bytes of numbers, which
+  // makes them compress much better.
+  const size_t num_elements = data.size() / element_size;
+  std::string shuffled(data.size(), '\0');
+  for (size_t i = 0; i < num_elements; ++i) {
+    for (size_t b = 0; b < element_size; ++b) {
+      shuffled[b * num_elements + i] = data[i * element_size + b];
+    }
+  }
+  return port::Snappy_Compress(shuffled.data(), shuffled.size(), out);
+}
+
+bool UncompressTensorContent(StringPiece compressed, DataType dtype, char* out,
+                             size_t size) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
+                                          &uncompressed_size) ||
+      uncompressed_size != size) {
+    return false;
+  }
+  const size_t element_size = DataTypeSize(dtype);
+  if (element_size <= 1) {
+    return port::Snappy_Uncompress(compressed.data(), compressed.size(), out);
+  }
+  if (size % element_size != 0) return false;
+  std::string shuffled(size, '\0');
+  if (!port::Snappy_Uncompress(compressed.data(), compressed.size(),
+                               &shuffled[0])) {
+    return false;
+  }
+  const size_t num_elements = size / element_size;
+  for (size_t i = 0; i < num_elements; ++i) {
+    for (size_t b = 0; b < element_size; ++b) {
+      out[i * element_size + b] = shuffled[b * num_elements + i];
+    }
+  }
+  return true;
+}
+
+namespace {
+
+// Replaces the compressed contents of the tensor of `*response`, if any, by
+// their uncompressed value.
+Status UncompressTensorProto(RecvTensorResponse* response) {
+  if (!response->compressed()) return absl::OkStatus();
+  TensorProto* proto = response->mutable_tensor();
+  if (!DataTypeCanUseMemcpy(proto->dtype()) ||
+      !TensorShape::IsValid(proto->tensor_shape())) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  const TensorShape shape(proto->tensor_shape());
+  std::string content(shape.num_elements() * DataTypeSize(proto->dtype()),
+                      '\0');
+  if (!UncompressTensorContent(proto->tensor_content(), proto->dtype(),
+                               &content[0], content.size())) {
+    return errors::InvalidArgument("Cannot uncompress tensor from response");
+  }
+  *proto->mutable_tensor_content() = std::move(content);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -51,13 +124,13 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
-  Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  Status s = UncompressTensorProto(&meta_);
+  if (s.ok() && on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
-  } else {
+  } else if (s.ok()) {
     s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
   }
   {
@@ -87,8 +160,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    Status s = UncompressTensorProto(&meta_);
+    if (s.ok()) {
+      s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    }
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -197,6 +272,17 @@ bool TensorResponse::ParseTensorSubmessage(
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
+        if (meta_.compressed()) {
+          std::string compressed;
+          if (!input->ReadString(&compressed, num_bytes) ||
+              !UncompressTensorContent(compressed, tensor_meta->dtype(),
+                                       const_cast<char*>(buf.data()),
+                                       buf.size())) {
+            return false;
+          }
+          tensor_ = std::move(t);
+          break;
+        }
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
         // the underlying ZeroCopyInputStream data is properly aligned
@@ -265,6 +351,20 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kChunkedTensorShapeFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_chunked_tensor_shape()))
+          return false;
+        break;
+      }
+      case RecvTensorResponse::kCompressedFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        // The contents must be parsed knowing whether they are compressed.
+        if (meta_.has_tensor()) return false;
+        meta_.set_compressed(v != 0);
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -276,7 +376,8 @@ bool TensorResponse::ParseFast(Source* source) {
 }
 
 bool TensorResponse::ParseSlow(Source* source) {
-  if (!meta_.ParseFromZeroCopyStream(source->contents())) {
+  if (!meta_.ParseFromZeroCopyStream(source->contents()) ||
+      !UncompressTensorProto(&meta_).ok()) {
     return false;
   }
 
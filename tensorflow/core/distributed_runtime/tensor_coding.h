@@ -28,6 +28,17 @@ namespace tensorflow {
 class DeviceBase;
 class TensorProto;
 
+// Compresses the contents of `val`, a tensor of a type that can use memcpy,
+// into `*out` as described by `RecvTensorResponse.compressed`. Returns false if
+// the contents can't be compressed.
+bool CompressTensorContent(const Tensor& val, std::string* out);
+
+// Uncompresses `compressed`, produced by CompressTensorContent() from a tensor
+// of type `dtype`, into the `size` bytes at `out`. Returns false if
+// `compressed` doesn't hold `size` bytes of contents.
+bool UncompressTensorContent(StringPiece compressed, DataType dtype, char* out,
+                             size_t size);
+
 // TensorResponse can be used as the destination of an RPC that returns
 // a RecvTensorResponse.  It efficiently decodes the incoming data
 // into Tensor contents as well as associated metadata.
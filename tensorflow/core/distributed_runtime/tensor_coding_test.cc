@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +159,41 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, Compressed) {
+  Tensor src(DT_FLOAT, TensorShape({4, 1000}));
+  test::FillIota<float>(&src, 0);
+  RecvTensorResponse proto;
+  proto.set_compressed(true);
+  ASSERT_TRUE(CompressTensorContent(
+      src, proto.mutable_tensor()->mutable_tensor_content()));
+  proto.mutable_tensor()->set_dtype(DT_FLOAT);
+  src.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+
+  // With "compressed" first, as senders encode it, the fast path applies.
+  // Otherwise the response is parsed by the slow path.
+  RecvTensorResponse header;
+  header.set_compressed(true);
+  RecvTensorResponse tensor;
+  *tensor.mutable_tensor() = proto.tensor();
+  const std::vector<string> encodings = {
+      header.SerializeAsString() + tensor.SerializeAsString(),
+      proto.SerializeAsString()};
+  for (const string& encoded : encodings) {
+    StringSource source(&encoded, 1024);
+    TensorResponse response;
+    DummyDevice cpu_device(Env::Default());
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+  }
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.InitFrom(&proto));
+  test::ExpectTensorEqual<float>(response.tensor(), src);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
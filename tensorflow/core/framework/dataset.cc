@@ -1120,11 +1120,13 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   auto model = ctx->model();
   bool output_was_recording =
       node_ && node_->output() && node_->output()->is_recording();
+  model::Node::Call call;
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     if (output_was_recording) {
       node_->output()->record_stop(now_nanos);
     }
+    call = model::Node::start_call(now_nanos);
     node_->record_start(now_nanos);
   }
   out_tensors->clear();
@@ -1147,6 +1149,8 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     node_->record_stop(now_nanos);
+    node_->stop_call(call, now_nanos,
+                     /*record_stage_stats=*/s.ok() && !*end_of_sequence);
     if (output_was_recording) {
       node_->output()->record_start(now_nanos);
     }
@@ -1171,18 +1175,21 @@ Status DatasetBaseIterator::Skip(IteratorContext* ctx, int num_to_skip,
   auto model = ctx->model();
   bool output_was_recording =
       node_ && node_->output() && node_->output()->is_recording();
+  model::Node::Call call;
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     auto output = node_->output();
     if (output_was_recording) {
       output->record_stop(now_nanos);
     }
+    call = model::Node::start_call(now_nanos);
     node_->record_start(now_nanos);
   }
   Status s = SkipInternal(ctx, num_to_skip, end_of_sequence, num_skipped);
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     node_->record_stop(now_nanos);
+    node_->stop_call(call, now_nanos, /*record_stage_stats=*/false);
     auto output = node_->output();
     if (output_was_recording) {
       output->record_start(now_nanos);
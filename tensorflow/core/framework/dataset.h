@@ -1598,6 +1598,7 @@ class DatasetBaseIterator : public IteratorBase {
       int64_t num_bytes = GetAllocatedBytes(*out_tensors);
       node_->record_element();
       node_->record_bytes_produced(num_bytes);
+      node_->record_element_bytes(num_bytes);
       if (node_->output()) {
         node_->output()->record_bytes_consumed(num_bytes);
       }
@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -156,6 +157,18 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Sets `device_context_map` to the DeviceContext* of each node of `graph`,
+  // indexed by node id, for devices that run nodes in different contexts (e.g.
+  // on different streams). Devices using the context of TryGetDeviceContext()
+  // for all nodes leave it empty.
+  //
+  // The caller takes ownership of one reference on each non-null output
+  // DeviceContext*, and should call Unref().
+  virtual Status FillContextMap(
+      const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+    return OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -400,6 +401,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
@@ -436,6 +438,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
 }
 
 Status LocalRendezvous::status() {
+  if (!aborted_.load(std::memory_order_acquire)) return OkStatus();
   tf_shared_lock ml(mu_);
   return status_;
 }
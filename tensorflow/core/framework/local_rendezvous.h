@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -93,7 +94,9 @@ class LocalRendezvous {
     mutex mu;
     Table table TF_GUARDED_BY(mu);
 
-    // Track the number of pening callbacks using a counter.
+    // Track the number of pending callbacks using a counter. It is decremented
+    // under `mu`, so that the destructor cannot free the bucket between the
+    // decrement of the last callback and its notification.
     int pending_callback_counter TF_GUARDED_BY(mu) = 0;
     condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
   };
@@ -102,6 +105,9 @@ class LocalRendezvous {
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // True once `status_` is an error, so that Send and Recv do not take `mu_`
+  // (shared by all the buckets) until the rendezvous is aborted.
+  std::atomic<bool> aborted_ = false;
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
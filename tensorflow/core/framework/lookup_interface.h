@@ -26,9 +26,10 @@ class OpKernelContext;
 
 namespace lookup {
 
-// Forward declaration so we can define GetInitializableLookupTable() in
-// LookupInterface.
+// Forward declarations so we can define GetInitializableLookupTable() and
+// GetAnnIndex() in LookupInterface.
 class InitializableLookupTable;
+class AnnIndex;
 
 // Lookup interface for batch lookups used by table lookup ops.
 class LookupInterface : public ResourceBase {
@@ -142,6 +143,10 @@ class LookupInterface : public ResourceBase {
     return nullptr;
   }
 
+  // Returns an AnnIndex, a subclass of LookupInterface, if the current object
+  // is an AnnIndex. Otherwise, returns nullptr.
+  virtual AnnIndex* GetAnnIndex() { return nullptr; }
+
  protected:
   virtual ~LookupInterface() = default;
 
@@ -37,6 +37,10 @@ auto* persistent_cache_load_count = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/persistent_cache_load_count",
     "The number of times a binary is loaded from the persistent cache.");
 
+auto* xla_donated_variable_buffer_count = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_donated_variable_buffer_count",
+    "The number of resource variable buffers donated to XLA executables.");
+
 auto* aot_bef_mlir_load_count = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/aot_bef_mlir_load_count",
     "The number of times BEF and MLIR are deserialized instead of generated "
@@ -63,6 +67,28 @@ auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* event_mgr_poll_duration_usecs = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr_poll_duration_usecs",
+     "The time spent by a device EventMgr polling the events of all its "
+     "streams in microseconds."},
+    // Power of 2 with bucket count 14 (> 8ms)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 14)});
+
+auto* event_mgr_callback_batch_size = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr_callback_batch_size",
+     "The number of completion callbacks a device EventMgr dispatched to its "
+     "threadpool as one batch."},
+    // Power of 2 with bucket count 14 (> 8k)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 14)});
+
+auto* op_latency_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/op_latency_usecs",
+     "The wall-clock time spent on executing sampled ops of a given type in "
+     "microseconds.",
+     "op"},
+    // Power of 2 with bucket count 24 (> 8s)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -791,6 +817,12 @@ void UpdatePersistentCacheLoadCount() {
   persistent_cache_load_count_cell->IncrementBy(1);
 }
 
+void UpdateXlaDonatedVariableBufferCount() {
+  static auto* xla_donated_variable_buffer_count_cell =
+      xla_donated_variable_buffer_count->GetCell();
+  xla_donated_variable_buffer_count_cell->IncrementBy(1);
+}
+
 void UpdateAotBefMlirLoadCount() {
   static auto* aot_bef_mlir_load_count_cell =
       aot_bef_mlir_load_count->GetCell();
@@ -815,6 +847,22 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void UpdateEventMgrPollDuration(uint64 duration_usecs) {
+  static auto* event_mgr_poll_duration_cell =
+      event_mgr_poll_duration_usecs->GetCell();
+  event_mgr_poll_duration_cell->Add(duration_usecs);
+}
+
+void UpdateEventMgrCallbackBatchSize(uint64 num_callbacks) {
+  static auto* event_mgr_callback_batch_size_cell =
+      event_mgr_callback_batch_size->GetCell();
+  event_mgr_callback_batch_size_cell->Add(num_callbacks);
+}
+
+void UpdateOpLatency(const string& op_type, double latency_usecs) {
+  op_latency_usecs->GetCell(op_type)->Add(latency_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
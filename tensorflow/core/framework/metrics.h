@@ -269,6 +269,15 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the time spent by a device EventMgr polling the events of all its
+// streams, and the number of completion callbacks it dispatched as one batch.
+void UpdateEventMgrPollDuration(uint64 duration_usecs);
+void UpdateEventMgrCallbackBatchSize(uint64 num_callbacks);
+
+// Records the latency of one execution of an op of type `op_type`, for the
+// steps sampled by the executor.
+void UpdateOpLatency(const string& op_type, double latency_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -279,6 +288,10 @@ void RecordPipelineProcessingTime(const string& id,
 // Increments the count of binaries loaded from the persistent cache.
 void UpdatePersistentCacheLoadCount();
 
+// Increments the count of resource variable buffers donated to XLA
+// executables, each of which saves allocating and copying the variable.
+void UpdateXlaDonatedVariableBufferCount();
+
 // Increments the count of BEF and MLIR deserialized.
 void UpdateAotBefMlirLoadCount();
 
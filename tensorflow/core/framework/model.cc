@@ -18,15 +18,21 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <queue>
+#include <random>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/host_info.h"
@@ -361,6 +367,315 @@ inline void UpdateStateValues(Node::ModelParameters* parameters) {
   }
 }
 
+// Gaussian process regression with a squared exponential kernel over points
+// of the unit hypercube, used as the surrogate of the output time by the
+// Bayesian optimization.
+class GaussianProcess {
+ public:
+  // Fits the posterior to the observations `ys` at the points `xs`. Returns
+  // false if the kernel matrix can't be factorized.
+  bool Fit(const std::vector<std::vector<double>>& xs,
+           const std::vector<double>& ys) {
+    const int n = xs.size();
+    if (n == 0) {
+      return false;
+    }
+    xs_ = xs;
+    length_scale_ = kLengthScale * std::sqrt(xs[0].size());
+    y_mean_ = std::accumulate(ys.begin(), ys.end(), 0.0) / n;
+    double y_variance = 0.0;
+    for (double y : ys) {
+      y_variance += Square(y - y_mean_);
+    }
+    y_scale_ = std::sqrt(y_variance / n);
+    if (y_scale_ < kMinScale) {
+      y_scale_ = 1.0;
+    }
+    // Cholesky factorization of the kernel matrix, in row-major order.
+    cholesky_.assign(n * n, 0.0);
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j <= i; ++j) {
+        double sum = Kernel(xs[i], xs[j]) + (i == j ? kNoise : 0.0);
+        for (int k = 0; k < j; ++k) {
+          sum -= cholesky_[i * n + k] * cholesky_[j * n + k];
+        }
+        if (i == j) {
+          if (sum <= 0.0) {
+            return false;
+          }
+          cholesky_[i * n + i] = std::sqrt(sum);
+        } else {
+          cholesky_[i * n + j] = sum / cholesky_[j * n + j];
+        }
+      }
+    }
+    std::vector<double> normalized(n);
+    for (int i = 0; i < n; ++i) {
+      normalized[i] = (ys[i] - y_mean_) / y_scale_;
+    }
+    alpha_ = SolveLower(normalized);
+    // Back substitution with the transposed factor.
+    for (int i = n - 1; i >= 0; --i) {
+      for (int k = i + 1; k < n; ++k) {
+        alpha_[i] -= cholesky_[k * n + i] * alpha_[k];
+      }
+      alpha_[i] /= cholesky_[i * n + i];
+    }
+    return true;
+  }
+
+  // Returns the posterior mean and standard deviation at `x`.
+  void Predict(const std::vector<double>& x, double* mean,
+               double* stddev) const {
+    const int n = xs_.size();
+    std::vector<double> k(n);
+    double normalized_mean = 0.0;
+    for (int i = 0; i < n; ++i) {
+      k[i] = Kernel(x, xs_[i]);
+      normalized_mean += k[i] * alpha_[i];
+    }
+    const std::vector<double> v = SolveLower(k);
+    double variance = 1.0;
+    for (double value : v) {
+      variance -= value * value;
+    }
+    *mean = normalized_mean * y_scale_ + y_mean_;
+    *stddev = std::sqrt(std::max(variance, 0.0)) * y_scale_;
+  }
+
+ private:
+  // Length scale of the kernel along the diagonal of the unit hypercube.
+  static constexpr double kLengthScale = 0.25;
+  // Observation noise, which also absorbs the plateaus created by rounding
+  // the parameter values.
+  static constexpr double kNoise = 1e-4;
+  static constexpr double kMinScale = 1e-12;
+
+  double Kernel(const std::vector<double>& a,
+                const std::vector<double>& b) const {
+    double distance = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+      distance += Square(a[i] - b[i]);
+    }
+    return std::exp(-0.5 * distance / Square(length_scale_));
+  }
+
+  // Solves `L * result = b` where `L` is the Cholesky factor.
+  std::vector<double> SolveLower(const std::vector<double>& b) const {
+    const int n = b.size();
+    std::vector<double> result(b);
+    for (int i = 0; i < n; ++i) {
+      for (int k = 0; k < i; ++k) {
+        result[i] -= cholesky_[i * n + k] * result[k];
+      }
+      result[i] /= cholesky_[i * n + i];
+    }
+    return result;
+  }
+
+  std::vector<std::vector<double>> xs_;
+  std::vector<double> cholesky_;
+  std::vector<double> alpha_;
+  double length_scale_ = kLengthScale;
+  double y_mean_ = 0.0;
+  double y_scale_ = 1.0;
+};
+
+// Returns the expected improvement of a point whose value follows a normal
+// distribution of the given mean and standard deviation over the `best`
+// (i.e. lowest) value observed so far.
+inline double ExpectedImprovement(double best, double mean, double stddev) {
+  constexpr double kMinStddev = 1e-12;
+  constexpr double kInverseSqrt2Pi = 0.3989422804014327;
+  if (stddev < kMinStddev) {
+    return std::max(best - mean, 0.0);
+  }
+  const double z = (best - mean) / stddev;
+  const double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+  const double pdf = kInverseSqrt2Pi * std::exp(-0.5 * z * z);
+  return (best - mean) * cdf + stddev * pdf;
+}
+
+// Maps `x` in [0, 1] to a value of `parameter` on a logarithmic scale, so that
+// small values, where the output time changes the most, get most of the range.
+inline double ParameterValueFromUnit(const Parameter& parameter, double x) {
+  const double low = std::log1p(parameter.min);
+  const double high = std::log1p(parameter.max);
+  return std::clamp(std::round(std::expm1(low + x * (high - low))),
+                    parameter.min, parameter.max);
+}
+
+// The inverse of `ParameterValueFromUnit`.
+inline double ParameterValueToUnit(const Parameter& parameter, double value) {
+  const double low = std::log1p(parameter.min);
+  const double high = std::log1p(parameter.max);
+  return high > low ? (std::log1p(value) - low) / (high - low) : 0.0;
+}
+
+// The result of evaluating a configuration of the tunable parameters.
+struct ConfigurationCost {
+  // The value to minimize.
+  double objective;
+  // Whether the configuration fits in the resource budgets.
+  bool feasible;
+};
+
+// Uses Bayesian optimization to search the values of `parameters` minimizing
+// the cost returned by `evaluate`, which receives one value per parameter.
+// Configurations rejected by `is_admissible` are never evaluated. The search
+// is warm started from the current parameter values and from their minimum
+// values. Returns the values of the best feasible configuration, or an empty
+// vector if no evaluated configuration was feasible.
+std::vector<double> MinimizeWithGaussianProcess(
+    const std::vector<Parameter*>& parameters,
+    const std::function<bool(const std::vector<double>&)>& is_admissible,
+    const std::function<ConfigurationCost(const std::vector<double>&)>&
+        evaluate,
+    const std::function<bool()>& is_cancelled) {
+  // Maximum number of configurations evaluated.
+  constexpr int kMaxEvaluations = 64;
+  // Number of random configurations evaluated before fitting the surrogate.
+  constexpr int kNumInitialRandomEvaluations = 4;
+  // Number of random candidates scored by the acquisition function in every
+  // step, on top of the neighbors of the best configuration.
+  constexpr int kNumRandomCandidates = 256;
+  // Standard deviation, in the unit hypercube, of the random perturbations of
+  // the best configuration used as candidates.
+  constexpr double kPerturbationStddev = 0.1;
+  // The search stops after this many evaluations without improvement.
+  constexpr int kPatience = 16;
+
+  const int num_parameters = parameters.size();
+  // The search is deterministic so that it finds the same configuration in
+  // every optimization round of an unchanged pipeline.
+  std::mt19937_64 rng(/*seed=*/0);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::normal_distribution<double> perturbation(0.0, kPerturbationStddev);
+
+  std::vector<std::vector<double>> xs;
+  std::vector<double> ys;
+  absl::flat_hash_set<std::vector<double>> evaluated;
+  std::vector<double> best_values;
+  double best_objective = std::numeric_limits<double>::infinity();
+  int evaluations_since_improvement = 0;
+
+  auto to_values = [&](const std::vector<double>& x) {
+    std::vector<double> values(num_parameters);
+    for (int i = 0; i < num_parameters; ++i) {
+      values[i] = ParameterValueFromUnit(*parameters[i], x[i]);
+    }
+    return values;
+  };
+  auto to_unit = [&](const std::vector<double>& values) {
+    std::vector<double> x(num_parameters);
+    for (int i = 0; i < num_parameters; ++i) {
+      x[i] = ParameterValueToUnit(*parameters[i], values[i]);
+    }
+    return x;
+  };
+  auto is_candidate = [&](const std::vector<double>& values) {
+    return !evaluated.contains(values) && is_admissible(values);
+  };
+  auto observe = [&](const std::vector<double>& values) {
+    evaluated.insert(values);
+    const ConfigurationCost cost = evaluate(values);
+    // The surrogate models the logarithm of the objective, which varies over
+    // orders of magnitude across configurations.
+    xs.push_back(to_unit(values));
+    ys.push_back(std::log1p(std::max(cost.objective, 0.0)));
+    if (cost.feasible && cost.objective < best_objective) {
+      best_objective = cost.objective;
+      best_values = values;
+      evaluations_since_improvement = 0;
+    } else {
+      ++evaluations_since_improvement;
+    }
+  };
+
+  std::vector<double> current_values(num_parameters);
+  std::vector<double> min_values(num_parameters);
+  for (int i = 0; i < num_parameters; ++i) {
+    current_values[i] = std::clamp(std::round(parameters[i]->value),
+                                   parameters[i]->min, parameters[i]->max);
+    min_values[i] = parameters[i]->min;
+  }
+  for (const auto& values : {current_values, min_values}) {
+    if (is_candidate(values)) {
+      observe(values);
+    }
+  }
+  for (int i = 0; i < kNumInitialRandomEvaluations; ++i) {
+    std::vector<double> x(num_parameters);
+    for (double& value : x) {
+      value = uniform(rng);
+    }
+    const std::vector<double> values = to_values(x);
+    if (is_candidate(values)) {
+      observe(values);
+    }
+  }
+
+  while (xs.size() < kMaxEvaluations &&
+         evaluations_since_improvement < kPatience && !is_cancelled()) {
+    GaussianProcess gaussian_process;
+    if (!gaussian_process.Fit(xs, ys)) {
+      break;
+    }
+    const double best_y = *std::min_element(ys.begin(), ys.end());
+
+    // The candidates are the configurations one step away from the best one,
+    // which is how hill climbing would proceed, random perturbations of the
+    // best configuration, and random configurations.
+    std::vector<std::vector<double>> candidates;
+    if (!best_values.empty()) {
+      for (int i = 0; i < num_parameters; ++i) {
+        for (double step : {-1.0, 1.0}) {
+          std::vector<double> values = best_values;
+          values[i] = std::clamp(values[i] + step, parameters[i]->min,
+                                 parameters[i]->max);
+          candidates.push_back(std::move(values));
+        }
+      }
+      const std::vector<double> best_x = to_unit(best_values);
+      for (int i = 0; i < kNumRandomCandidates / 2; ++i) {
+        std::vector<double> x = best_x;
+        for (double& value : x) {
+          value = std::clamp(value + perturbation(rng), 0.0, 1.0);
+        }
+        candidates.push_back(to_values(x));
+      }
+    }
+    while (candidates.size() <
+           static_cast<size_t>(kNumRandomCandidates + 2 * num_parameters)) {
+      std::vector<double> x(num_parameters);
+      for (double& value : x) {
+        value = uniform(rng);
+      }
+      candidates.push_back(to_values(x));
+    }
+
+    const std::vector<double>* next_values = nullptr;
+    double best_improvement = -1.0;
+    for (const auto& values : candidates) {
+      if (!is_candidate(values)) {
+        continue;
+      }
+      double mean, stddev;
+      gaussian_process.Predict(to_unit(values), &mean, &stddev);
+      const double improvement = ExpectedImprovement(best_y, mean, stddev);
+      if (improvement > best_improvement) {
+        best_improvement = improvement;
+        next_values = &values;
+      }
+    }
+    if (next_values == nullptr) {
+      break;
+    }
+    observe(*next_values);
+  }
+  return best_values;
+}
+
 // Recursively produces protos for nodes in a subtree of `output` node and
 // appends them to nodes of the given model.
 Status ModelToProtoHelper(std::shared_ptr<Node> output, ModelProto* model) {
@@ -1397,6 +1712,44 @@ class AsyncUnknownRatio : public AsyncRatio {
 }  // namespace
 
 thread_local int64_t Node::work_start_;
+thread_local int64_t Node::thread_processing_time_;
+thread_local int64_t Node::thread_input_time_;
+
+int ExponentialHistogram::BucketIndex(int64_t value) {
+  if (value <= 1) {
+    return 0;
+  }
+  return std::min(Log2Floor64(value - 1) + 1, kNumBuckets - 1);
+}
+
+ExponentialHistogram::Snapshot ExponentialHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+double ExponentialHistogram::Snapshot::Mean() const {
+  return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+int64_t ExponentialHistogram::Snapshot::Percentile(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * count;
+  int64_t cumulative_count = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    cumulative_count += buckets[i];
+    if (cumulative_count >= rank && cumulative_count > 0) {
+      return int64_t{1} << i;
+    }
+  }
+  return int64_t{1} << (kNumBuckets - 1);
+}
 
 std::shared_ptr<Parameter> MakeParameter(const string& name,
                                          std::shared_ptr<SharedState> state,
@@ -1634,6 +1987,31 @@ Node::ModelParameters Node::CollectNodeTunableParameters() const {
   return parameters;
 }
 
+void Node::WarmStartParameters(
+    const absl::flat_hash_map<string, double>& values) const {
+  tf_shared_lock l(mu_);
+  for (const auto& pair : parameters_) {
+    const std::shared_ptr<Parameter>& parameter = pair.second;
+    if (parameter->state == nullptr || !parameter->state->tunable) {
+      continue;
+    }
+    auto it = values.find(strings::StrCat(long_name(), ":", parameter->name));
+    if (it == values.end()) {
+      continue;
+    }
+    const double value =
+        std::clamp(std::round(it->second), parameter->min, parameter->max);
+    mutex_lock state_lock(*parameter->state->mu);
+    if (parameter->state->value == kAutotune) {
+      VLOG(2) << "Warm starting " << long_name() << ":" << parameter->name
+              << " at " << value;
+      parameter->value = value;
+      parameter->state->value = value;
+      parameter->state->cond_var->notify_all();
+    }
+  }
+}
+
 string Node::DebugString() const {
   absl::flat_hash_map<string, string> debug_strings;
   tf_shared_lock l(mu_);
@@ -1745,6 +2123,15 @@ double Node::TotalMaximumBufferedBytes() const {
   return total_bytes[long_name()];
 }
 
+StageStats Node::stage_stats() const {
+  StageStats stats;
+  stats.latency = latency_histogram_.GetSnapshot();
+  stats.processing_time = processing_time_histogram_.GetSnapshot();
+  stats.queueing_time = queueing_time_histogram_.GetSnapshot();
+  stats.bytes = bytes_histogram_.GetSnapshot();
+  return stats;
+}
+
 double Node::TotalProcessingTime(Node::NodeValues* processing_times) {
   // Create a hash map to store the per-element CPU time spent in the subtree
   // rooted in each node.
@@ -2290,6 +2677,9 @@ void Model::AddNode(Node::Factory factory, const string& name,
   auto node_name = str_util::Split(name, ':', str_util::SkipEmpty()).back();
   mutex_lock l(mu_);
   std::shared_ptr<Node> node = factory({id_counter_++, node_name, parent});
+  if (!warm_start_values_.empty()) {
+    node->WarmStartParameters(warm_start_values_);
+  }
   if (!output_) {
     output_ = node;
   }
@@ -2306,6 +2696,37 @@ void Model::AddNode(Node::Factory factory, const string& name,
   // to enable this functionality caused a regression (see b/179812091).
 }
 
+absl::flat_hash_map<string, double> Model::TunableParameterValues() {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  absl::flat_hash_map<string, double> values;
+  if (!output) {
+    return values;
+  }
+  for (const auto& pair : output->CollectTunableParameters()) {
+    const std::shared_ptr<Parameter>& parameter = pair.second;
+    // The optimization updates the shared state rather than the parameter.
+    double value;
+    {
+      mutex_lock l(*parameter->state->mu);
+      value = parameter->state->value;
+    }
+    if (value != kAutotune) {
+      values[strings::StrCat(pair.first, ":", parameter->name)] = value;
+    }
+  }
+  return values;
+}
+
+void Model::SetWarmStartParameterValues(
+    absl::flat_hash_map<string, double> values) {
+  mutex_lock l(mu_);
+  warm_start_values_ = std::move(values);
+}
+
 void Model::FlushMetrics() {
   std::deque<std::shared_ptr<Node>> queue;
   {
@@ -2386,6 +2807,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::BAYESIAN:
+      OptimizeBayesian(snapshot, optimization_params, cancellation_manager,
+                       ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -3138,6 +3563,115 @@ void Model::OptimizeMaxParallelism(
                           should_stop);
 }
 
+void Model::OptimizeBayesian(std::shared_ptr<Node> snapshot,
+                             const OptimizationParams& optimization_params,
+                             CancellationManager* cancellation_manager,
+                             RamBudgetManager& ram_budget_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with Bayesian "
+             "optimization.";
+  auto parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+
+  // Weight of the resource usage in the objective. It is small enough for the
+  // output time to dominate, so it only breaks ties between configurations
+  // that are equally fast, e.g. because they outpace the consumer.
+  constexpr double kResourceWeight = 0.01;
+
+  // Skip buffer size optimization if we are running the new buffering
+  // algorithm.
+  const bool skip_buffer_sizes =
+      experiments_.contains("autotune_buffer_optimization");
+  std::vector<Parameter*> tuned_parameters;
+  std::vector<Parameter*> parallelism_parameters;
+  double min_parallelism = 0;
+  for (auto& pair : parameters) {
+    Parameter* parameter = pair.second.get();
+    if (parameter->name == kParallelism) {
+      parallelism_parameters.push_back(parameter);
+      min_parallelism += parameter->min;
+    }
+    if (skip_buffer_sizes && parameter->name == kBufferSize) {
+      continue;
+    }
+    if (parameter->max > parameter->min) {
+      tuned_parameters.push_back(parameter);
+    } else {
+      parameter->value = parameter->min;
+    }
+  }
+  // The CPU budget can't be smaller than the parallelism at the minimum
+  // values, otherwise no configuration would be admissible.
+  const double cpu_budget = std::max(
+      static_cast<double>(optimization_params.cpu_budget()), min_parallelism);
+  const double ram_budget = optimization_params.ram_budget();
+  // The time between the consumer's calls to `GetNext()`. Producing elements
+  // faster than that doesn't increase the throughput of the job.
+  const double target_time_nsec = ComputeTargetTimeNsec();
+
+  auto set_values = [&tuned_parameters](const std::vector<double>& values) {
+    for (size_t i = 0; i < tuned_parameters.size(); ++i) {
+      tuned_parameters[i]->value = values[i];
+    }
+  };
+  auto total_parallelism = [&parallelism_parameters]() {
+    double parallelism = 0;
+    for (const Parameter* parameter : parallelism_parameters) {
+      parallelism += parameter->value;
+    }
+    return parallelism;
+  };
+  auto is_admissible = [&](const std::vector<double>& values) {
+    set_values(values);
+    return total_parallelism() <= cpu_budget;
+  };
+  auto evaluate = [&](const std::vector<double>& values) {
+    set_values(values);
+    const double output_time =
+        OutputTime(snapshot, optimization_params.model_input_time(),
+                   /*gradients=*/nullptr);
+    const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    double resource_usage = total_parallelism() / cpu_budget;
+    if (ram_budget > 0) {
+      resource_usage += buffered_bytes / ram_budget;
+    }
+    double objective = std::max(output_time, target_time_nsec) *
+                       (1.0 + kResourceWeight * resource_usage);
+    const bool feasible = buffered_bytes <= ram_budget;
+    if (!feasible) {
+      // Penalize configurations exceeding the RAM budget in proportion to the
+      // excess, so that the surrogate learns where the budget is exceeded.
+      objective *= 2.0 + (buffered_bytes - ram_budget) /
+                             std::max(ram_budget, 1.0);
+    }
+    return ConfigurationCost{objective, feasible};
+  };
+  std::vector<double> best_values;
+  if (!tuned_parameters.empty()) {
+    best_values = MinimizeWithGaussianProcess(
+        tuned_parameters, is_admissible, evaluate,
+        [cancellation_manager]() {
+          return cancellation_manager->IsCancelled();
+        });
+  }
+  if (best_values.empty()) {
+    VLOG(2) << "No configuration of the tunable parameters fits in the "
+               "resource budgets. Using their minimum values.";
+    for (Parameter* parameter : tuned_parameters) {
+      parameter->value = parameter->min;
+    }
+  } else {
+    set_values(best_values);
+  }
+  if (ram_budget_manager.RequestModelAllocation(
+          TotalMaximumBufferedBytes(snapshot))) {
+    UpdateStateValues(&parameters);
+  }
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          Model::ParameterGradients* gradients) {
   // To store the input time for each node.
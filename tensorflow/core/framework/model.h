@@ -16,6 +16,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -175,7 +177,7 @@ class RamBudgetManager {
   // Returns whether the request succeeded.
   bool RequestModelAllocation(int64_t total_bytes) {
     mutex_lock l(mu_);
-    if (total_bytes > budget_ - legacy_prefetch_allocated_) {
+    if (total_bytes > budget_ - legacy_prefetch_allocated_ - cache_allocated_) {
       return false;
     }
     model_allocated_ = total_bytes;
@@ -195,7 +197,8 @@ class RamBudgetManager {
     // memory.
     if (delta_elements > 0) {
       int64_t max_delta_elements = static_cast<int64_t>(
-          (budget_ - legacy_prefetch_allocated_ - model_allocated_) /
+          (budget_ - legacy_prefetch_allocated_ - cache_allocated_ -
+           model_allocated_) /
           element_size);
       if (max_delta_elements < 0) {
         return 0;
@@ -218,17 +221,34 @@ class RamBudgetManager {
   // request. If not, no bytes are allocated.
   bool RequestLegacyPrefetchBytes(int64_t delta_bytes) {
     mutex_lock l(mu_);
-    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - model_allocated_) {
+    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - cache_allocated_ -
+                          model_allocated_) {
       return false;
     }
     legacy_prefetch_allocated_ += delta_bytes;
     return true;
   }
 
+  // Requests `delta_bytes` additional bytes for elements held by in-memory
+  // caches (e.g. `CacheDatasetOp` with a spill tier). `delta_bytes` can be
+  // negative to release previously requested bytes.
+  //
+  // Returns whether there were enough bytes left in the budget to serve the
+  // request. If not, no bytes are allocated.
+  bool RequestCacheBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - cache_allocated_ -
+                          model_allocated_) {
+      return false;
+    }
+    cache_allocated_ += delta_bytes;
+    return true;
+  }
+
   // The total number of bytes that the model could potentially use.
   int64_t AvailableModelRam() const {
     tf_shared_lock l(mu_);
-    return budget_ - legacy_prefetch_allocated_;
+    return budget_ - legacy_prefetch_allocated_ - cache_allocated_;
   }
 
   void UpdateBudget(int64_t budget) {
@@ -241,7 +261,8 @@ class RamBudgetManager {
     mutex_lock l(mu_);
     return absl::StrCat("RamBudgetManager: budget_: ", budget_,
                         " prefetch allocated: ", legacy_prefetch_allocated_,
-                        " model allocated: ", model_allocated_);
+                        " model allocated: ", model_allocated_,
+                        " cache allocated: ", cache_allocated_);
   }
 
  private:
@@ -251,6 +272,56 @@ class RamBudgetManager {
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes held by in-memory caches.
+  int64_t cache_allocated_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Histogram of non-negative values with power-of-two bucket boundaries. It is
+// updated with relaxed atomic increments so that it is cheap enough to record
+// every element produced by an iterator. Bucket 0 counts the values in [0, 1]
+// and bucket `i > 0` the values in (2^(i-1), 2^i].
+class ExponentialHistogram {
+ public:
+  static constexpr int kNumBuckets = 48;
+
+  struct Snapshot {
+    int64_t count = 0;
+    int64_t sum = 0;
+    std::array<int64_t, kNumBuckets> buckets = {};
+
+    double Mean() const;
+    // Returns the upper boundary of the bucket containing the `percentile`
+    // (in [0, 100]) of the values.
+    int64_t Percentile(double percentile) const;
+  };
+
+  void Add(int64_t value) {
+    buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(std::max<int64_t>(value, 0), std::memory_order_relaxed);
+  }
+
+  Snapshot GetSnapshot() const;
+
+  static int BucketIndex(int64_t value);
+
+ private:
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_ = {};
+  std::atomic<int64_t> sum_ = 0;
+};
+
+// Per-stage histograms of the `GetNext` calls of an iterator, all times being
+// in nanoseconds:
+// - `latency` is the wall time of the calls,
+// - `processing_time` the time spent executing the logic of the iterator,
+// - `queueing_time` the time spent waiting, e.g. for a background thread to
+//   produce the element, i.e. what remains of the latency after excluding the
+//   processing time and the calls to the inputs made by the same thread,
+// - `bytes` is the size of the produced elements.
+struct StageStats {
+  ExponentialHistogram::Snapshot latency;
+  ExponentialHistogram::Snapshot processing_time;
+  ExponentialHistogram::Snapshot queueing_time;
+  ExponentialHistogram::Snapshot bytes;
 };
 
 // Abstract representation of a TensorFlow input pipeline node. It collects
@@ -477,6 +548,7 @@ class Node {
     // TODO(jsimsa): Use DCHECK_NE(work_start_, 0) here.
     if (work_start_ != 0) {
       processing_time_ += time_nanos - work_start_;
+      thread_processing_time_ += time_nanos - work_start_;
       work_start_ = 0;
     } else {
       VLOG(1) << "Encountered a stop event without a matching start event.";
@@ -487,6 +559,50 @@ class Node {
   // currently between a `record_start` and a `record_stop`.
   bool is_recording() TF_LOCKS_EXCLUDED(mu_) { return work_start_ > 0; }
 
+  // State of a `GetNext` or `Skip` call of the iterator of a node on the
+  // calling thread.
+  struct Call {
+    int64_t start_nanos = 0;
+    int64_t thread_processing_time = 0;
+    int64_t thread_input_time = 0;
+  };
+
+  // Records that a thread has started a call of the iterator of this node. It
+  // must be called after the output stopped recording and before this node
+  // starts recording.
+  static Call start_call(int64_t time_nanos) {
+    return Call{time_nanos, thread_processing_time_, thread_input_time_};
+  }
+
+  // Records that a thread has finished a call of the iterator of this node,
+  // after this node stopped recording and before the output resumes. If
+  // `record_stage_stats` is true, updates the per-stage histograms with the
+  // call.
+  void stop_call(const Call& call, int64_t time_nanos,
+                 bool record_stage_stats) {
+    const int64_t latency = time_nanos - call.start_nanos;
+    if (record_stage_stats) {
+      const int64_t processing_time =
+          thread_processing_time_ - call.thread_processing_time;
+      const int64_t input_time = thread_input_time_ - call.thread_input_time;
+      latency_histogram_.Add(latency);
+      processing_time_histogram_.Add(processing_time);
+      queueing_time_histogram_.Add(latency - processing_time - input_time);
+    }
+    // Hides the processing time of this node and its inputs from the output,
+    // to which the whole call counts as input time.
+    thread_processing_time_ = call.thread_processing_time;
+    thread_input_time_ = call.thread_input_time + latency;
+  }
+
+  // Records the size of an element produced by the node.
+  void record_element_bytes(int64_t num_bytes) {
+    bytes_histogram_.Add(num_bytes);
+  }
+
+  // Returns the per-stage histograms of the node.
+  StageStats stage_stats() const;
+
   // Removes an input.
   void remove_input(std::shared_ptr<Node> input) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -557,6 +673,12 @@ class Node {
   // Collects tunable parameters in this node.
   ModelParameters CollectNodeTunableParameters() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Sets the tunable parameters of this node that haven't been given a value
+  // yet, i.e. whose value is `kAutotune`, to their value in `values`. The keys
+  // of `values` are formatted as by `Model::TunableParameterValues()`.
+  void WarmStartParameters(const absl::flat_hash_map<string, double>& values)
+      const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns a human-readable representation of this node.
   string DebugString() const TF_LOCKS_EXCLUDED(mu_);
 
@@ -813,6 +935,11 @@ class Node {
   // on thread `t`, then `n->record_stop()` must be called before another call
   // to `Node::record_start()` (for any node).
   static thread_local int64_t work_start_;  // Will be initialized to zero.
+  // Processing time recorded by, and wall time of the calls to the iterators
+  // of, any node on the calling thread. Used to attribute the latency of
+  // nested calls to the right node.
+  static thread_local int64_t thread_processing_time_;
+  static thread_local int64_t thread_input_time_;
 
   mutable mutex mu_;
   const int64_t id_;
@@ -831,6 +958,10 @@ class Node {
   std::atomic<int64_t> bytes_produced_;
   std::atomic<int64_t> num_elements_;
   std::atomic<int64_t> processing_time_;
+  ExponentialHistogram latency_histogram_;
+  ExponentialHistogram processing_time_histogram_;
+  ExponentialHistogram queueing_time_histogram_;
+  ExponentialHistogram bytes_histogram_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
@@ -989,6 +1120,19 @@ class Model {
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the current values of the tunable parameters of the model, keyed
+  // by `<node long name>:<parameter name>`. Node ids are assigned in the order
+  // the nodes are added, so the keys are the same across runs of the same input
+  // pipeline.
+  absl::flat_hash_map<string, double> TunableParameterValues()
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Makes the tunable parameters of the nodes added from now on start from
+  // their value in `values`, e.g. as returned by `TunableParameterValues()` in
+  // a previous run of the same input pipeline, instead of their default values.
+  void SetWarmStartParameterValues(absl::flat_hash_map<string, double> values)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Produces a proto for this model.
   Status ToProto(ModelProto* model_proto);
 
@@ -1115,6 +1259,21 @@ class Model {
                           CancellationManager* cancellation_manager,
                           RamBudgetManager& ram_budget_manager);
 
+  // This optimization fits a Gaussian process to the output time estimated
+  // for the configurations of all the tunable parameters evaluated so far,
+  // and repeatedly evaluates the configuration with the largest expected
+  // improvement. Unlike hill climbing, which changes one parameter by one
+  // step at a time, it tunes interacting parameters such as `cycle_length`,
+  // `parallelism` and `buffer_size` jointly and needs far fewer evaluations on
+  // pipelines with many tunable parameters. Configurations exceeding the CPU
+  // budget are not evaluated and configurations exceeding the RAM budget are
+  // penalized. Among configurations that outpace the consumer of the pipeline,
+  // the ones using fewer resources are preferred.
+  void OptimizeBayesian(std::shared_ptr<Node> snapshot,
+                        const OptimizationParams& optimization_params,
+                        CancellationManager* cancellation_manager,
+                        RamBudgetManager& ram_budget_manager);
+
   // This is the first part of the stage-based optimization that optimizes
   // tunable parallelism parameters for async interleave many nodes only. We
   // separately optimize async interleave many nodes more aggressively because
@@ -1165,6 +1324,8 @@ class Model {
   condition_variable optimize_cond_var_;
   int64_t id_counter_ TF_GUARDED_BY(mu_) = 1;
   std::shared_ptr<Node> output_ TF_GUARDED_BY(mu_) = nullptr;
+  // Initial values of the tunable parameters of the nodes added to the model.
+  absl::flat_hash_map<string, double> warm_start_values_ TF_GUARDED_BY(mu_);
 
   // Determines the time the optimization loop should wait between
   // running optimizations.
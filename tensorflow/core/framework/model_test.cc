@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -1382,7 +1383,87 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 }
 
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
-                         ::testing::Values(0, 1, 2, 3));
+                         ::testing::Values(0, 1, 2, 3, 5));
+
+TEST(OptimizeBayesianTest, StaysWithinCpuBudget) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::shared_ptr<Node> output;
+  for (int i = 1; i <= 2; ++i) {
+    std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+        {i, strings::StrCat(i), output}, 1,
+        {model::MakeParameter(
+            "parallelism",
+            std::make_shared<SharedState>(
+                /*value=*/model::kAutotune, std::make_shared<mutex>(),
+                std::make_shared<condition_variable>()),
+            /*min=*/1, /*max=*/8)});
+    node->add_processing_time(1000);
+    node->record_element();
+    node->record_buffer_event(1, 1);
+    nodes.push_back(node);
+    output = node;
+  }
+
+  model::Model model;
+  std::shared_ptr<Node> parent;
+  for (auto& node : nodes) {
+    model.AddNode([&node](model::Node::Args args) { return node; },
+                  node->name(), parent, &node);
+    parent = node;
+  }
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(1000);
+  model.Optimize(AutotuneAlgorithm::BAYESIAN, CpuBudgetFunc(4),
+                 /*ram_budget_share=*/1.0,
+                 /*fixed_ram_budget=*/1000,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  const double parallelism = nodes[0]->parameter_value("parallelism") +
+                             nodes[1]->parameter_value("parallelism");
+  // Both nodes are bottlenecks, so their parallelism is raised as far as the
+  // CPU budget allows.
+  EXPECT_GT(parallelism, 2);
+  EXPECT_LE(parallelism, 4);
+}
+
+TEST(WarmStartTest, RestoresTunableParameterValues) {
+  auto make_node = [](model::Node::Args args) {
+    return model::MakeAsyncKnownRatioNode(
+        std::move(args), 1,
+        {model::MakeParameter(
+            "parallelism",
+            std::make_shared<SharedState>(
+                /*value=*/model::kAutotune, std::make_shared<mutex>(),
+                std::make_shared<condition_variable>()),
+            /*min=*/1, /*max=*/8)});
+  };
+
+  model::Model tuned_model;
+  std::shared_ptr<Node> tuned_node;
+  tuned_model.AddNode(make_node, "Iterator::ParallelMap", nullptr,
+                      &tuned_node);
+  tuned_node->record_element();
+  EXPECT_TRUE(tuned_model.TunableParameterValues().empty());
+  auto tuned_parameters = tuned_node->CollectNodeTunableParameters();
+  ASSERT_EQ(tuned_parameters.size(), 1);
+  tuned_parameters[0].second->state->value = 5;
+  absl::flat_hash_map<string, double> values =
+      tuned_model.TunableParameterValues();
+  ASSERT_EQ(values.size(), 1);
+  EXPECT_EQ(values.begin()->first, "ParallelMap(id:1):parallelism");
+  EXPECT_EQ(values.begin()->second, 5);
+
+  model::Model model;
+  model.SetWarmStartParameterValues(values);
+  std::shared_ptr<Node> node;
+  model.AddNode(make_node, "Iterator::ParallelMap", nullptr, &node);
+  node->record_element();
+  auto parameters = node->CollectNodeTunableParameters();
+  ASSERT_EQ(parameters.size(), 1);
+  EXPECT_EQ(parameters[0].second->state->value, 5);
+  EXPECT_EQ(node->parameter_value("parallelism"), 5);
+}
 
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
@@ -3572,6 +3653,22 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+TEST(RamBudgetManagerTest, RequestCacheBytes) {
+  RamBudgetManager rbm(10);
+  EXPECT_TRUE(rbm.RequestCacheBytes(4));
+  EXPECT_EQ(rbm.AvailableModelRam(), 6);
+  // Over budget 7 > 10 - 4
+  EXPECT_FALSE(rbm.RequestModelAllocation(7));
+  EXPECT_TRUE(rbm.RequestModelAllocation(5));
+  // Over budget 2 > 10 - 4 - 5
+  EXPECT_FALSE(rbm.RequestCacheBytes(2));
+  EXPECT_FALSE(rbm.RequestLegacyPrefetchBytes(2));
+  // Releasing cache bytes should make room for more prefetch bytes
+  EXPECT_TRUE(rbm.RequestCacheBytes(-3));
+  EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(2));
+  EXPECT_EQ(rbm.AvailableModelRam(), 7);
+}
+
 TEST(NodeTest, OnlyCollectParametersThatHaveElementsProduced) {
   // Builds a graph:
   // root <- parallel_map <- parallel_interleave
@@ -3621,6 +3718,84 @@ TEST(NodeTest, OnlyCollectParametersThatHaveElementsProduced) {
   EXPECT_EQ(root->CollectTunableParameters().size(), 2);
 }
 
+TEST(ExponentialHistogramTest, Buckets) {
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(-5), 0);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(0), 0);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(1), 0);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(2), 1);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(3), 2);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(4), 2);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(5), 3);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(int64_t{1} << 40), 40);
+  EXPECT_EQ(ExponentialHistogram::BucketIndex(
+                std::numeric_limits<int64_t>::max()),
+            ExponentialHistogram::kNumBuckets - 1);
+}
+
+TEST(ExponentialHistogramTest, Snapshot) {
+  ExponentialHistogram histogram;
+  EXPECT_EQ(histogram.GetSnapshot().count, 0);
+  EXPECT_EQ(histogram.GetSnapshot().Mean(), 0.0);
+  EXPECT_EQ(histogram.GetSnapshot().Percentile(50), 0);
+
+  for (int64_t value : {1, 3, 3, 4, 100}) {
+    histogram.Add(value);
+  }
+  ExponentialHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 5);
+  EXPECT_EQ(snapshot.sum, 111);
+  EXPECT_DOUBLE_EQ(snapshot.Mean(), 22.2);
+  EXPECT_EQ(snapshot.buckets[0], 1);
+  EXPECT_EQ(snapshot.buckets[2], 3);
+  EXPECT_EQ(snapshot.buckets[7], 1);
+  EXPECT_EQ(snapshot.Percentile(0), 1);
+  EXPECT_EQ(snapshot.Percentile(50), 4);
+  EXPECT_EQ(snapshot.Percentile(80), 4);
+  EXPECT_EQ(snapshot.Percentile(100), 128);
+}
+
+TEST(NodeTest, StageStats) {
+  // Simulates a synchronous root calling an input which waits for 20ns, e.g.
+  // for a background thread to produce the element.
+  std::shared_ptr<Node> root = MakeUnknownNode({0, "root", nullptr});
+  std::shared_ptr<Node> input = MakeUnknownNode({1, "input", root});
+  root->add_input(input);
+
+  Node::Call root_call = Node::start_call(0);
+  root->record_start(0);
+  root->record_stop(10);
+  Node::Call input_call = Node::start_call(10);
+  input->record_start(10);
+  input->record_stop(15);
+  input->record_start(35);
+  input->record_stop(40);
+  input->stop_call(input_call, 40, /*record_stage_stats=*/true);
+  input->record_element_bytes(64);
+  root->record_start(40);
+  root->record_stop(50);
+  root->stop_call(root_call, 50, /*record_stage_stats=*/true);
+
+  StageStats input_stats = input->stage_stats();
+  EXPECT_EQ(input_stats.latency.count, 1);
+  EXPECT_EQ(input_stats.latency.sum, 30);
+  EXPECT_EQ(input_stats.processing_time.sum, 10);
+  EXPECT_EQ(input_stats.queueing_time.sum, 20);
+  EXPECT_EQ(input_stats.bytes.sum, 64);
+
+  StageStats root_stats = root->stage_stats();
+  EXPECT_EQ(root_stats.latency.sum, 50);
+  EXPECT_EQ(root_stats.processing_time.sum, 20);
+  EXPECT_EQ(root_stats.queueing_time.sum, 0);
+  EXPECT_EQ(root_stats.bytes.count, 0);
+
+  // Calls which are not recorded don't update the histograms.
+  Node::Call skip_call = Node::start_call(50);
+  input->record_start(50);
+  input->record_stop(60);
+  input->stop_call(skip_call, 60, /*record_stage_stats=*/false);
+  EXPECT_EQ(input->stage_stats().latency.count, 1);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
@@ -358,8 +358,8 @@ OpKernelContext::OpKernelContext(Params* params, int num_outputs)
 
 OpKernelContext::~OpKernelContext() {
   for (TensorValue& value : outputs_) {
-    if (!value.is_ref()) {
-      delete value.tensor;
+    if (!value.is_ref() && value.tensor != nullptr) {
+      DeleteOutputTensor(value.tensor);
     }
   }
   if (params_->track_allocations &&
@@ -377,6 +377,8 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->step_arena_allocator != nullptr && attr.value == 0) {
+    allocator = params_->step_arena_allocator;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -818,11 +820,13 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
-  auto output_tensor = std::make_unique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Tensor* output_tensor = NewOutputTensor(index);
+  Status s = allocate_tensor(type, shape, output_tensor, attr);
   if (s.ok()) {
-    outputs_[index] = TensorValue(output_tensor.release());
-    *output = outputs_[index].tensor;
+    outputs_[index] = TensorValue(output_tensor);
+    *output = output_tensor;
+  } else {
+    DeleteOutputTensor(output_tensor);
   }
   return s;
 }
@@ -954,13 +958,13 @@ bool OpKernelContext::maybe_set_output_by_allocate_and_copy(
     profiler::ScopedMemoryDebugAnnotation op_annotation(
         op_kernel().name_view().data(), step_id(), "output", tensor.dtype(),
         [&tensor]() { return tensor.shape().DebugString(); });
-    auto new_tensor = std::make_unique<Tensor>();
-    Status s = allocate_tensor(tensor.dtype(), tensor.shape(), new_tensor.get(),
+    Tensor* new_tensor = NewOutputTensor(index);
+    Status s = allocate_tensor(tensor.dtype(), tensor.shape(), new_tensor,
                                output_alloc_attr(index));
     TF_CHECK_OK(s);
-    device()->CopyTensorInSameDevice(&tensor, new_tensor.get(),
-                                     op_device_context(), [](const Status&) {});
-    outputs_[index] = TensorValue(new_tensor.release());
+    device()->CopyTensorInSameDevice(&tensor, new_tensor, op_device_context(),
+                                     [](const Status&) {});
+    outputs_[index] = TensorValue(new_tensor);
   }
   return allocate_and_copy;
 }
@@ -993,8 +997,10 @@ void OpKernelContext::set_output(int index, const Tensor& tensor) {
   if (TF_PREDICT_TRUE(!maybe_set_output_by_allocate_and_copy(index, tensor))) {
     // Input can be forwarded to output; incref on `tensor` and set output at
     // `index` to this tensor.
-    outputs_[index] = TensorValue(new Tensor(tensor));
-    maybe_track_allocations_for_set_output(*outputs_[index].tensor);
+    Tensor* output_tensor = NewOutputTensor(index);
+    *output_tensor = tensor;
+    outputs_[index] = TensorValue(output_tensor);
+    maybe_track_allocations_for_set_output(*output_tensor);
   }
 }
 
@@ -1006,8 +1012,10 @@ void OpKernelContext::set_output(int index, Tensor&& tensor) {
   CHECK_EQ(outputs_[index].tensor, nullptr);
   if (TF_PREDICT_TRUE(!maybe_set_output_by_allocate_and_copy(index, tensor))) {
     // Input can be forwarded to output; set output at `index` to this tensor.
-    outputs_[index] = TensorValue(new Tensor(std::move(tensor)));
-    maybe_track_allocations_for_set_output(*outputs_[index].tensor);
+    Tensor* output_tensor = NewOutputTensor(index);
+    *output_tensor = std::move(tensor);
+    outputs_[index] = TensorValue(output_tensor);
+    maybe_track_allocations_for_set_output(*output_tensor);
   }
 }
 
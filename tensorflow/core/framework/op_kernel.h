@@ -619,6 +619,10 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, allocates the tensors with default allocator attributes
+    // instead of the device.
+    Allocator* step_arena_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
@@ -1197,6 +1201,12 @@ class OpKernelContext {
   void set_output_ref(int index, mutex* mu, Tensor* tensor_for_ref);
   TensorValue release_output(int index);
 
+  // Returns output `index` without releasing it: its tensor, if not a ref,
+  // remains owned by the context, and the caller may move its value out. This
+  // avoids the heap allocation of the tensor of release_output() for the first
+  // outputs.
+  TensorValue output_value(int index) const;
+
   bool track_allocations() const { return params_->track_allocations; }
 
   // Records temp memory allocation. Tensor object is recorded to identify the
@@ -1259,13 +1269,41 @@ class OpKernelContext {
   void ResetOutputs(int num_outputs = 0) {
     for (TensorValue& value : outputs_) {
       DCHECK(!value.is_ref());
-      delete value.tensor;
+      DeleteOutputTensor(value.tensor);
       value.tensor = nullptr;
     }
     outputs_.resize(num_outputs);
   }
 
  private:
+  // The first outputs are stored in the context rather than on the heap.
+  static constexpr int kNumInlineOutputs = 4;
+
+  // Returns a new empty tensor for output `index`, to be deleted with
+  // DeleteOutputTensor().
+  Tensor* NewOutputTensor(int index) {
+    if (index < kNumInlineOutputs) {
+      inline_outputs_[index].Init();
+      return inline_outputs_[index].get();
+    }
+    return new Tensor;
+  }
+
+  bool IsInlineOutputTensor(const Tensor* tensor) const {
+    for (int i = 0; i < kNumInlineOutputs; ++i) {
+      if (tensor == inline_outputs_[i].get()) return true;
+    }
+    return false;
+  }
+
+  void DeleteOutputTensor(Tensor* tensor) {
+    if (IsInlineOutputTensor(tensor)) {
+      tensor->~Tensor();
+    } else {
+      delete tensor;
+    }
+  }
+
   bool record_memory_consumption_ = false;
 
   // Internal common method used when allocating tensor memory
@@ -1298,6 +1336,8 @@ class OpKernelContext {
   friend class CollectiveExecutor;  // for access to params_
   Params* params_;                  // not owned
   absl::InlinedVector<TensorValue, 4UL> outputs_;
+  // Storage for the tensors of the first outputs, see NewOutputTensor().
+  gtl::ManualConstructor<Tensor> inline_outputs_[kNumInlineOutputs];
 
   // Keep track of calls to ScopedAllocator.
   // TODO(ayushd): change to absl::flat_hash_set.
@@ -1639,9 +1679,21 @@ inline TensorValue OpKernelContext::release_output(int index) {
   DCHECK_LT(index, num_outputs());
   TensorValue value = outputs_[index];
   outputs_[index] = TensorValue();
+  if (!value.is_ref() && IsInlineOutputTensor(value.tensor)) {
+    // The caller owns the released tensor.
+    Tensor* tensor = new Tensor(std::move(*value.tensor));
+    DeleteOutputTensor(value.tensor);
+    value.tensor = tensor;
+  }
   return value;
 }
 
+inline TensorValue OpKernelContext::output_value(int index) const {
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, num_outputs());
+  return outputs_[index];
+}
+
 template <typename T>
 T* OpKernelContext::op_device_context() {
   static_assert(std::is_base_of<DeviceContext, T>::value,
@@ -533,6 +533,40 @@ TEST_F(OpKernelTest, AllocateOutput) {
   EXPECT_THAT(s.message(), ::testing::ContainsRegex("bad index=1"));
 }
 
+TEST_F(OpKernelTest, ReleaseOutput) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  DummyDevice device(env);
+  params.device = &device;
+  Status status;
+  std::unique_ptr<OpKernel> op(
+      CreateOpKernel(DEVICE_CPU, params.device, cpu_allocator(),
+                     CreateNodeDef("Test1", {DT_FLOAT, DT_INT32}),
+                     TF_GRAPH_DEF_VERSION, &status));
+  EXPECT_TRUE(status.ok());
+  params.op_kernel = op.get();
+  Tensor a(DT_FLOAT, TensorShape({}));
+  Tensor b(DT_INT32, TensorShape({}));
+  gtl::InlinedVector<TensorValue, 4> inputs{TensorValue(&a), TensorValue(&b)};
+  params.inputs = inputs;
+  auto ctx = std::make_unique<OpKernelContext>(&params);
+  Tensor* output = nullptr;
+  TF_ASSERT_OK(ctx->allocate_output(0, TensorShape({2}), &output));
+  output->flat<uint8>().setConstant(7);
+
+  // The context owns the output it returns without releasing it.
+  EXPECT_EQ(ctx->output_value(0).tensor, output);
+
+  // The caller owns the released output.
+  std::unique_ptr<Tensor> released(ctx->release_output(0).tensor);
+  ASSERT_NE(released, nullptr);
+  EXPECT_EQ(released->shape(), TensorShape({2}));
+  EXPECT_EQ(released->flat<uint8>()(1), 7);
+  EXPECT_EQ(ctx->output_value(0).tensor, nullptr);
+  ctx.reset();
+  EXPECT_EQ(released->flat<uint8>()(0), 7);
+}
+
 // A mock device that mimics the behavior of scoped allocator upon calling
 // GetAllocator with a positive scope_id.
 class ScopedAllocatorDevice : public DeviceBase {
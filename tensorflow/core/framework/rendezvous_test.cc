@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <vector>
+
 #include "absl/status/status.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/cancellation.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -519,5 +522,47 @@ void BM_PingPong(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PingPong)->Arg(100)->Arg(200)->Arg(300);
 
+void BM_ConcurrentSendRecvManyKeys(::testing::benchmark::State& state) {
+  const int num_shards = state.range(0);
+  constexpr int kNumThreads = 8;
+  constexpr int kKeysPerThread = 1000;
+  std::vector<Rendezvous::ParsedKey> keys;
+  keys.reserve(kNumThreads * kKeysPerThread);
+  for (int i = 0; i < kNumThreads * kKeysPerThread; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", kNumThreads);
+
+  // Benchmark loop
+  // In each iteration, each thread sends its own keys and then receives them,
+  // as in a step with many independent Send/Recv pairs.
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous(num_shards);
+    BlockingCounter counter(kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool->Schedule([rendez, &keys, &counter, t]() {
+        const Tensor orig = V("val");
+        Tensor val;
+        bool is_dead = false;
+        Rendezvous::Args args;
+        const int begin = t * kKeysPerThread;
+        for (int i = begin; i < begin + kKeysPerThread; ++i) {
+          TF_CHECK_OK(rendez->Send(keys[i], args, orig, is_dead));
+        }
+        for (int i = begin; i < begin + kKeysPerThread; ++i) {
+          TF_CHECK_OK(rendez->Recv(keys[i], args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(kNumThreads * kKeysPerThread * state.iterations());
+  delete pool;
+}
+BENCHMARK(BM_ConcurrentSendRecvManyKeys)->Arg(1)->Arg(8)->Arg(64);
+
 }  // namespace
 }  // namespace tensorflow
@@ -128,10 +128,21 @@ ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
   return *this;
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+namespace {
+
+uint64 NewResourceMgrId() {
+  // Starts at 1, so that 0 never identifies a manager.
+  static std::atomic<uint64> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+ResourceMgr::ResourceMgr()
+    : default_container_("localhost"), id_(NewResourceMgrId()) {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container), id_(NewResourceMgrId()) {}
 
 ResourceMgr::~ResourceMgr() { Clear(); }
 
@@ -143,6 +154,7 @@ void ResourceMgr::Clear() {
     mutex_lock l(mu_);
     tmp_containers = std::move(containers_);
     containers_.clear();  // reinitialize after move.
+    BumpGeneration();
   }
   for (const auto& p : tmp_containers) {
     delete p.second;
@@ -180,6 +192,22 @@ string ResourceMgr::DebugString() const {
   return absl::StrJoin(text, "\n");
 }
 
+std::vector<core::RefCountPtr<ResourceBase>> ResourceMgr::DoLookupAll(
+    uint64 type_hash_code) const {
+  tf_shared_lock l(mu_);
+  std::vector<core::RefCountPtr<ResourceBase>> resources;
+  for (const auto& p : containers_) {
+    for (const auto& q : *p.second) {
+      if (q.first.first != type_hash_code) continue;
+      core::RefCountPtr<ResourceBase> resource = q.second.GetResource();
+      if (resource) {
+        resources.push_back(std::move(resource));
+      }
+    }
+  }
+  return resources;
+}
+
 Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
                              const string& name, ResourceBase* resource,
                              bool owns_resource) {
@@ -205,6 +233,7 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
+        BumpGeneration();
       }
     };
     resource_and_name.resource =
@@ -277,6 +306,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
   }
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
+  BumpGeneration();
   return OkStatus();
 }
 
@@ -326,6 +356,7 @@ Status ResourceMgr::Cleanup(const string& container) {
     }
     b = iter->second;
     containers_.erase(iter);
+    BumpGeneration();
   }
   CHECK(b != nullptr);
   delete b;
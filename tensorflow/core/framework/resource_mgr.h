@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -194,6 +195,10 @@ class ResourceMgr {
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
+  // Returns all the resources of type T, in all containers.
+  template <typename T>
+  std::vector<core::RefCountPtr<T>> LookupAll() const;
+
   // Similar to Lookup, but looks up multiple resources at once, with only a
   // single lock acquisition.  If containers_and_names[i] is uninitialized
   // then this function does not modify resources[i].
@@ -234,6 +239,17 @@ class ResourceMgr {
   // Deletes all resources in all containers.
   void Clear();
 
+  // Returns a counter that is incremented whenever a resource is removed from
+  // *this, so that a resource looked up earlier is known to still be the one
+  // registered under its name while the counter is unchanged.
+  uint64 generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
+  // Returns an id that is unique among the managers of the process, unlike
+  // the address of *this which may be reused by a later manager.
+  uint64 id() const { return id_; }
+
   // Returns a text description for all resources.
   std::string DebugString() const;
 
@@ -275,6 +291,13 @@ class ResourceMgr {
   const std::string default_container_;
   mutable mutex mu_;
   absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  std::atomic<uint64> generation_{0};
+  const uint64 id_;
+
+  // Increments generation_ after a resource was removed from containers_.
+  void BumpGeneration() {
+    generation_.fetch_add(1, std::memory_order_release);
+  }
 
   template <typename T, bool use_dynamic_cast = false>
   Status LookupInternal(const std::string& container, const std::string& name,
@@ -292,6 +315,8 @@ class ResourceMgr {
   Status DoLookup(const std::string& container, TypeIndex type,
                   const std::string& name, ResourceBase** resource) const
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  std::vector<core::RefCountPtr<ResourceBase>> DoLookupAll(
+      uint64 type_hash_code) const TF_LOCKS_EXCLUDED(mu_);
   Status DoLookup(const std::string& container, uint64 type_hash_code,
                   const std::string& type_name,
                   const std::string& resource_name,
@@ -682,6 +707,17 @@ Status ResourceMgr::LookupMany(
   return OkStatus();
 }
 
+template <typename T>
+std::vector<core::RefCountPtr<T>> ResourceMgr::LookupAll() const {
+  CheckDeriveFromResourceBase<T>();
+  std::vector<core::RefCountPtr<T>> resources;
+  for (core::RefCountPtr<ResourceBase>& resource :
+       DoLookupAll(TypeIndex::Make<T>().hash_code())) {
+    resources.emplace_back(static_cast<T*>(resource.release()));
+  }
+  return resources;
+}
+
 // Simple wrapper to allow conditional dynamic / static casts.
 template <typename T, bool use_dynamic_cast>
 struct TypeCastFunctor {
@@ -842,6 +878,72 @@ Status LookupResources(OpKernelContext* ctx,
   return ctx->resource_manager()->LookupMany(containers_and_names, values);
 }
 
+// Remembers the resource that a kernel last looked up in a resource manager,
+// so that kernels resolving the same handle on every step skip the name
+// hashing and the lock of the manager. The cached entry holds a weak reference
+// on its resource, so that it does not keep a deleted resource alive, and is
+// only used while the generation of the manager shows that no resource has
+// been removed since it was filled. Ref-counting handles own their resource
+// and bypass the cache.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  // Same as LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p,
+                core::RefCountPtr<T>* value) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutex mu_;
+  // The id of the manager, 0 while the cache is empty.
+  uint64 resource_manager_id_ TF_GUARDED_BY(mu_) = 0;
+  uint64 generation_ TF_GUARDED_BY(mu_) = 0;
+  std::string container_ TF_GUARDED_BY(mu_);
+  std::string name_ TF_GUARDED_BY(mu_);
+  core::WeakPtr<T> resource_ TF_GUARDED_BY(mu_);
+};
+
+template <typename T>
+Status ResourceLookupCache<T>::Lookup(OpKernelContext* ctx,
+                                      const ResourceHandle& p,
+                                      core::RefCountPtr<T>* value) {
+  ResourceMgr* resource_manager = ctx->resource_manager();
+  if (p.IsRefCounting() || resource_manager == nullptr) {
+    return LookupResource(ctx, p, value);
+  }
+  TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+  {
+    tf_shared_lock l(mu_);
+    if (resource_manager_id_ == resource_manager->id() &&
+        generation_ == resource_manager->generation() && name_ == p.name() &&
+        container_ == p.container()) {
+      core::RefCountPtr<T> resource = resource_.GetNewRef();
+      if (resource) {
+        *value = std::move(resource);
+        return OkStatus();
+      }
+    }
+  }
+
+  // Reads the generation before the lookup, so that a removal racing with it
+  // invalidates the new entry.
+  const uint64 generation = resource_manager->generation();
+  T* resource = nullptr;
+  TF_RETURN_IF_ERROR(
+      resource_manager->Lookup<T>(p.container(), p.name(), &resource));
+  value->reset(resource);
+  core::WeakPtr<T> weak_resource(resource);
+  {
+    mutex_lock l(mu_);
+    resource_manager_id_ = resource_manager->id();
+    generation_ = generation;
+    container_ = p.container();
+    name_ = p.name();
+    std::swap(resource_, weak_resource);
+  }
+  // `weak_resource` drops the previous weak reference outside of mu_.
+  return OkStatus();
+}
+
 // If the resource manager in "ctx" has a resource pointed at by "p", returns
 // it in "*value". Otherwise, invokes creator() to create the resource.
 // The caller takes the ownership of one ref on "*value".
@@ -144,6 +144,23 @@ TEST(ResourceMgrTest, Basic) {
   TF_CHECK_OK(rm.Cleanup("bar"));
 }
 
+TEST(ResourceMgrTest, LookupAll) {
+  ResourceMgr rm;
+  EXPECT_TRUE(rm.LookupAll<Resource>().empty());
+  TF_CHECK_OK(rm.Create("foo", "bar", new Resource("cat")));
+  TF_CHECK_OK(rm.Create("baz", "bar", new Resource("dog")));
+  TF_CHECK_OK(rm.Create("foo", "bar", new Other("tiger")));
+
+  std::vector<string> labels;
+  for (const core::RefCountPtr<Resource>& r : rm.LookupAll<Resource>()) {
+    labels.push_back(r->DebugString());
+  }
+  EXPECT_THAT(labels, ::testing::UnorderedElementsAre("R/cat", "R/dog"));
+  std::vector<core::RefCountPtr<Other>> others = rm.LookupAll<Other>();
+  ASSERT_EQ(others.size(), 1);
+  EXPECT_EQ(others[0]->DebugString(), "O/tiger");
+}
+
 TEST(ResourceMgrTest, CreateUnowned) {
   core::RefCountPtr<Resource> cat{new Resource("cat")};
   core::RefCountPtr<Resource> kitty{new Resource("kitty")};
@@ -527,4 +544,91 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   EXPECT_NE(LookupResource<StubResource>(&ctx, p, &lookup_r).ok(), true);
 }
 
+TEST(ResourceLookupCacheTest, RevalidatesAfterDelete) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  ResourceHandle q =
+      MakeResourceHandle<StubResource>(&ctx, "container", "other");
+  StubResource* r = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, r));
+  StubResource* s = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, q, s));
+
+  ResourceLookupCache<StubResource> cache;
+  core::RefCountPtr<StubResource> lookup_r;
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), s);
+  lookup_r.reset();
+
+  // A resource created under the same name after a deletion is found
+  // instead of the cached one.
+  const uint64 generation = resource_mgr.generation();
+  TF_ASSERT_OK(DeleteResource(&ctx, q));
+  EXPECT_GT(resource_mgr.generation(), generation);
+  EXPECT_FALSE(cache.Lookup(&ctx, q, &lookup_r).ok());
+  StubResource* t = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, q, t));
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), t);
+}
+
+TEST(ResourceLookupCacheTest, DoesNotKeepDeletedResourceAlive) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  StubResource* r = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, r));
+  core::WeakPtr<StubResource> weak_r(r);
+
+  ResourceLookupCache<StubResource> cache;
+  core::RefCountPtr<StubResource> lookup_r;
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  lookup_r.reset();
+  TF_ASSERT_OK(DeleteResource(&ctx, p));
+  EXPECT_EQ(weak_r.GetNewRef().get(), nullptr);
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &lookup_r).ok());
+}
+
+TEST(ResourceLookupCacheTest, RevalidatesForAnotherManager) {
+  StubDevice device("device_name");
+  ResourceLookupCache<StubResource> cache;
+  uint64 previous_id = 0;
+  for (int i = 0; i < 3; ++i) {
+    // Managers destroyed in turn may be allocated at the same address.
+    auto resource_mgr = std::make_unique<ResourceMgr>("");
+    EXPECT_NE(resource_mgr->id(), previous_id);
+    previous_id = resource_mgr->id();
+    OpKernelContext::Params params;
+    params.resource_manager = resource_mgr.get();
+    params.device = &device;
+    OpKernelContext ctx(&params, 0);
+
+    ResourceHandle p =
+        MakeResourceHandle<StubResource>(&ctx, "container", "name");
+    StubResource* r = new StubResource;
+    TF_ASSERT_OK(CreateResource(&ctx, p, r));
+    core::RefCountPtr<StubResource> lookup_r;
+    TF_ASSERT_OK(cache.Lookup(&ctx, p, &lookup_r));
+    EXPECT_EQ(lookup_r.get(), r);
+  }
+}
+
 }  // end namespace tensorflow
@@ -543,22 +543,28 @@ absl::StatusOr<Node*> Graph::AddNode(NodeDef node_def) {
 }
 
 Node* Graph::AddNode(NodeDef node_def, Status* status) {
-  const OpRegistrationData* op_reg_data;
-  status->Update(ops_.LookUp(node_def.op(), &op_reg_data));
+  std::shared_ptr<NodeProperties> props;
+  Node::NodeClass node_class;
+  status->Update(MakeNodeProperties(std::move(node_def), &props, &node_class));
   if (!status->ok()) return nullptr;
+  return AddNode(std::move(props), node_class);
+}
+
+Status Graph::MakeNodeProperties(NodeDef node_def,
+                                 std::shared_ptr<NodeProperties>* props,
+                                 Node::NodeClass* node_class) const {
+  const OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(ops_.LookUp(node_def.op(), &op_reg_data));
 
   DataTypeVector inputs;
   DataTypeVector outputs;
-  status->Update(
-      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
-  }
+  Status status =
+      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs);
+  if (!status.ok()) return AttachDef(status, node_def);
 
-  Node::NodeClass node_class = op_reg_data->is_function_op
-                                   ? Node::NC_FUNCTION_OP
-                                   : Node::GetNodeClassForOp(node_def.op());
+  *node_class = op_reg_data->is_function_op
+                    ? Node::NC_FUNCTION_OP
+                    : Node::GetNodeClassForOp(node_def.op());
 
   if (node_def.has_experimental_type()) {
     VLOG(3) << "AddNode: node has type set, skipping type constructor "
@@ -570,21 +576,23 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
           full_type::SpecializeType(AttrSlice(node_def), op_reg_data->op_def,
                                     *(node_def.mutable_experimental_type()));
       if (!s.ok()) {
-        *status = errors::InvalidArgument("type error: ", s.ToString());
         VLOG(3) << "AddNode: type inference failed for " << node_def.name()
                 << ": " << s;
-        return nullptr;
+        return errors::InvalidArgument("type error: ", s.ToString());
       }
     } else {
       VLOG(3) << "AddNode: no type constructor for " << node_def.name();
     }
   }
 
-  Node* node = AllocateNode(
-      std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
-      nullptr, node_class);
-  return node;
+  *props = std::make_shared<NodeProperties>(
+      &op_reg_data->op_def, std::move(node_def), inputs, outputs);
+  return absl::OkStatus();
+}
+
+Node* Graph::AddNode(std::shared_ptr<NodeProperties> props,
+                     Node::NodeClass node_class) {
+  return AllocateNode(std::move(props), nullptr, node_class);
 }
 
 Node* Graph::CopyNode(const Node* node) {
@@ -565,6 +565,19 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   absl::StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // Infers the Op, input/output types and class of a node with `node_def`,
+  // to add it with AddNode(props, node_class) below. Unlike AddNode(), may be
+  // called concurrently, e.g. to construct the nodes of a large graph in
+  // parallel before adding them in order.
+  Status MakeNodeProperties(NodeDef node_def,
+                            std::shared_ptr<NodeProperties>* props,
+                            Node::NodeClass* node_class) const;
+
+  // Adds a new node with properties returned by MakeNodeProperties(), and
+  // returns it. *this owns the returned instance.
+  Node* AddNode(std::shared_ptr<NodeProperties> props,
+                Node::NodeClass node_class);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
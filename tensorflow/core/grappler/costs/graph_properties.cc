@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
@@ -2514,10 +2515,89 @@ Status GraphProperties::UpdateEnqueue(
   return absl::OkStatus();
 }
 
+namespace {
+
+// Number of InferStatically results a ScopedGraphPropertiesCache keeps.
+constexpr int kMaxCachedGraphProperties = 2;
+
+thread_local ScopedGraphPropertiesCache* current_graph_properties_cache =
+    nullptr;
+
+// Computes the key under which the results of InferStatically on `item` with
+// the given options are cached. The feeds only matter when they are not
+// assumed to be valid. Returns false if the graph can't be serialized.
+bool InferStaticallyCacheKey(const GrapplerItem& item, bool assume_valid_feeds,
+                             bool aggressive_shape_inference,
+                             bool include_input_tensor_values,
+                             bool include_output_tensor_values,
+                             Fprint128* cache_key) {
+  string key;
+  if (!SerializeToStringDeterministic(item.graph, &key)) return false;
+  key.push_back(assume_valid_feeds ? '1' : '0');
+  key.push_back(aggressive_shape_inference ? '1' : '0');
+  key.push_back(include_input_tensor_values ? '1' : '0');
+  key.push_back(include_output_tensor_values ? '1' : '0');
+  if (!assume_valid_feeds) {
+    for (const auto& feed : item.feed) {
+      strings::StrAppend(&key, feed.first, ";");
+    }
+  }
+  *cache_key = Fingerprint128(key);
+  return true;
+}
+
+}  // namespace
+
+ScopedGraphPropertiesCache::ScopedGraphPropertiesCache()
+    : previous_(current_graph_properties_cache) {
+  current_graph_properties_cache = this;
+}
+
+ScopedGraphPropertiesCache::~ScopedGraphPropertiesCache() {
+  DCHECK_EQ(current_graph_properties_cache, this);
+  current_graph_properties_cache = previous_;
+}
+
+/* static */ ScopedGraphPropertiesCache* ScopedGraphPropertiesCache::Current() {
+  return current_graph_properties_cache;
+}
+
+const ScopedGraphPropertiesCache::Entry* ScopedGraphPropertiesCache::Find(
+    const Fprint128& key) const {
+  for (const Entry& entry : entries_) {
+    if (entry.key == key) return &entry;
+  }
+  return nullptr;
+}
+
+void ScopedGraphPropertiesCache::Insert(Entry entry) {
+  if (entries_.size() >= kMaxCachedGraphProperties) entries_.pop_front();
+  entries_.push_back(std::move(entry));
+}
+
 Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  ScopedGraphPropertiesCache* cache = ScopedGraphPropertiesCache::Current();
+  Fprint128 cache_key;
+  if (cache != nullptr &&
+      !InferStaticallyCacheKey(item_, assume_valid_feeds,
+                               aggressive_shape_inference,
+                               include_input_tensor_values,
+                               include_output_tensor_values, &cache_key)) {
+    cache = nullptr;
+  }
+  if (cache != nullptr) {
+    if (const auto* entry = cache->Find(cache_key)) {
+      VLOG(2) << "Reusing the graph properties of an identical graph";
+      input_properties_ = entry->input_properties;
+      output_properties_ = entry->output_properties;
+      incompatible_shape_nodes_ = entry->incompatible_shape_nodes;
+      return absl::OkStatus();
+    }
+  }
+
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
@@ -2756,6 +2836,10 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
   TF_RETURN_IF_ERROR(VerboseShapeInferenceLogging(item_.graph, refiner.get(),
                                                   shape_manager.get()));
 
+  if (cache != nullptr) {
+    cache->Insert({cache_key, input_properties_, output_properties_,
+                   incompatible_shape_nodes_});
+  }
   return absl::OkStatus();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 
@@ -72,6 +74,44 @@ ABSL_CONST_INIT const char kOutputShapes[] = "_output_shape_vector";
 class SymbolicShapeRefiner;
 class TopoQueue;
 
+// Keeps the results of GraphProperties::InferStatically while it is in scope
+// on the current thread. Grappler passes that run one after the other each
+// infer the shapes of their input graph from scratch; with a cache in scope,
+// an inference whose graph, feeds and options match one of the last few
+// inferences copies their results instead of propagating the shapes again.
+// Scopes can be nested, in which case the innermost one is used.
+class ScopedGraphPropertiesCache {
+ public:
+  ScopedGraphPropertiesCache();
+  ~ScopedGraphPropertiesCache();
+
+ private:
+  friend class GraphProperties;
+
+  struct Entry {
+    Fprint128 key;
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        input_properties;
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        output_properties;
+    std::unordered_set<string> incompatible_shape_nodes;
+  };
+
+  // Returns the innermost cache in scope on the current thread, if any.
+  static ScopedGraphPropertiesCache* Current();
+
+  // Returns the entry with `key`, or nullptr.
+  const Entry* Find(const Fprint128& key) const;
+  // Adds `entry`, evicting the oldest entry if the cache is full.
+  void Insert(Entry entry);
+
+  ScopedGraphPropertiesCache* const previous_;
+  std::deque<Entry> entries_;
+
+  ScopedGraphPropertiesCache(const ScopedGraphPropertiesCache&) = delete;
+  void operator=(const ScopedGraphPropertiesCache&) = delete;
+};
+
 // Infer OpInfo::TensorProperties for graph nodes inputs/outputs.
 //
 // Typical use case, is to infer tensor properties from a graph, before doing
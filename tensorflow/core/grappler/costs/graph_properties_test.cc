@@ -233,6 +233,34 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, ScopedCacheOnlyReusesIdenticalGraphs) {
+  ScopedGraphPropertiesCache cache;
+  auto infer_add_n_output_shape = [this](int tensor_size) {
+    TrivialTestGraphInputYielder fake_input(4, 1, tensor_size, false,
+                                            cluster_->GetDeviceNames());
+    GrapplerItem item;
+    CHECK(fake_input.NextItem(&item));
+    GraphProperties properties(item);
+    TF_CHECK_OK(properties.InferStatically(true));
+    for (const auto& node : item.graph.node()) {
+      if (node.op() == "AddN") {
+        const auto props = properties.GetOutputProperties(node.name());
+        CHECK_EQ(1, props.size());
+        return props[0].shape().DebugString();
+      }
+    }
+    return string();
+  };
+
+  const string shape = infer_add_n_output_shape(10);
+  EXPECT_EQ(PartialTensorShape({10, 1}).AsProto().DebugString(), shape);
+  // The same graph gets the same properties, from the cache.
+  EXPECT_EQ(shape, infer_add_n_output_shape(10));
+  // A different graph is inferred again.
+  EXPECT_EQ(PartialTensorShape({20, 1}).AsProto().DebugString(),
+            infer_add_n_output_shape(20));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -18,7 +18,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
 #include <cmath>
+#include <deque>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -48,14 +52,18 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/overflow.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 
@@ -67,6 +75,90 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 const int64_t kMaxConstantSize = 100 * 1024;
 
 namespace {
+
+// A process-wide cache of the values of folded nodes, keyed by the contents of
+// the nodes and of their constant inputs. The same subgraphs are often folded
+// many times in a process, e.g. in the functions and partitions of a model or
+// in several instances of the same model, and are then evaluated only once.
+//
+// The cache is bounded by the total size of its values, set by the
+// TF_CONSTANT_FOLDING_CACHE_BYTES environment variable, and evicts its oldest
+// values first. It is disabled unless that size is positive, since the values
+// it keeps are never released otherwise.
+class FoldedValueCache {
+ public:
+  static FoldedValueCache* Global() {
+    static FoldedValueCache* cache = [] {
+      int64_t max_bytes;
+      Status s = ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_BYTES",
+                                     kDefaultMaxBytes, &max_bytes);
+      if (!s.ok()) {
+        LOG(WARNING) << s;
+        max_bytes = kDefaultMaxBytes;
+      }
+      return new FoldedValueCache(max_bytes);
+    }();
+    return cache;
+  }
+
+  bool enabled() const { return max_bytes_ > 0; }
+
+  // Returns the key of `node` applied to the constant `inputs`.
+  static Fprint128 Key(const NodeDef& node,
+                       const std::vector<const TensorProto*>& inputs) {
+    NodeDef stripped_node;
+    stripped_node.set_op(node.op());
+    *stripped_node.mutable_attr() = node.attr();
+    string key;
+    SerializeToStringDeterministic(stripped_node, &key);
+    for (const TensorProto* input : inputs) {
+      string serialized_input;
+      SerializeToStringDeterministic(*input, &serialized_input);
+      absl::StrAppend(&key, serialized_input.size(), ":", serialized_input);
+    }
+    return Fingerprint128(key);
+  }
+
+  // Returns true and sets `outputs` if the cache holds the values of `key`.
+  bool Lookup(const Fprint128& key, std::vector<Tensor>* outputs) {
+    mutex_lock l(mu_);
+    auto it = values_.find(key);
+    if (it == values_.end()) return false;
+    *outputs = it->second;
+    return true;
+  }
+
+  void Insert(const Fprint128& key, std::vector<Tensor> outputs) {
+    int64_t bytes = 0;
+    for (const Tensor& output : outputs) bytes += output.TotalBytes();
+    // Caching a value that would evict most of the others isn't worth it.
+    if (bytes > max_bytes_ / 4) return;
+    mutex_lock l(mu_);
+    if (!values_.emplace(key, std::move(outputs)).second) return;
+    insertion_order_.push_back({key, bytes});
+    total_bytes_ += bytes;
+    while (total_bytes_ > max_bytes_) {
+      const auto& [oldest_key, oldest_bytes] = insertion_order_.front();
+      values_.erase(oldest_key);
+      total_bytes_ -= oldest_bytes;
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr int64_t kDefaultMaxBytes = 0;
+
+  explicit FoldedValueCache(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  const int64_t max_bytes_;
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, std::vector<Tensor>, Fprint128Hasher> values_
+      TF_GUARDED_BY(mu_);
+  // The keys of `values_` and the size of their values, oldest first.
+  std::deque<std::pair<Fprint128, int64_t>> insertion_order_ TF_GUARDED_BY(mu_);
+  int64_t total_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -1358,6 +1450,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   });
 
   size_t total_inputs_size = 0;
+  std::vector<const TensorProto*> input_protos;
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
     if (input_tensor.index() < 0) {
@@ -1392,10 +1485,36 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                        " with shape ", raw_val.tensor_shape().DebugString()));
     }
     inputs.emplace_back(value);
+    input_protos.push_back(&raw_val);
     total_inputs_size += value->TotalBytes();
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  FoldedValueCache* cache = FoldedValueCache::Global();
+  Fprint128 key = {0, 0};
+  std::vector<Tensor> cached_outputs;
+  if (cache->enabled()) key = FoldedValueCache::Key(node, input_protos);
+  if (cache->enabled() && cache->Lookup(key, &cached_outputs)) {
+    for (const Tensor& cached_output : cached_outputs) {
+      output_tensors.emplace_back(new Tensor(cached_output));
+    }
+  } else {
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    // Dead outputs, e.g. of a Switch, aren't cached, nor are variants and
+    // resources, which may refer to state that isn't part of the key.
+    bool cacheable = cache->enabled();
+    for (const auto& output : output_tensors) {
+      if (output.tensor == nullptr || output.tensor->dtype() == DT_VARIANT ||
+          output.tensor->dtype() == DT_RESOURCE) {
+        cacheable = false;
+      }
+    }
+    if (cacheable) {
+      for (const auto& output : output_tensors) {
+        cached_outputs.push_back(*output.tensor);
+      }
+      cache->Insert(key, std::move(cached_outputs));
+    }
+  }
   if (output_tensors.empty()) {
     return Status(absl::StatusCode::kInvalidArgument,
                   "Expected at least one output.");
@@ -315,6 +315,73 @@ TEST_F(ConstantFoldingTest, SimpleFolding) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, FoldsSameNodesWithDifferentInputs) {
+  // The values of folded nodes are cached by the contents of the nodes and
+  // their inputs, so folding the same graph with other constants must not
+  // reuse the values of the previous ones.
+  for (float b_value : {2.0f, 3.0f, 2.0f}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output a = ops::Const(s.WithOpName("a"), 1.0f, {1});
+    Output b = ops::Const(s.WithOpName("b"), b_value, {1});
+    Output c = ops::AddN(s.WithOpName("c"), {a, b});
+    Output d = ops::AddN(s.WithOpName("d"), {b, c});
+
+    GrapplerItem item;
+    item.fetch.push_back("d");
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+    ConstantFolding optimizer(/*cpu_device=*/nullptr);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+    ASSERT_EQ(1, output.node_size());
+    EXPECT_EQ("Const", output.node(0).op());
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(1, tensors.size());
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({1.0f + 2 * b_value}, {1}), tensors[0]);
+  }
+}
+
+TEST_F(ConstantFoldingTest, FoldsSameGraphTwice) {
+  // The second optimization reuses the values cached by the first one, and
+  // must produce the same graph.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), {1.0f, 2.0f}, {2});
+  Output b = ops::Const(s.WithOpName("b"), {3.0f, 4.0f}, {2});
+  Output c = ops::Mul(s.WithOpName("c"), a, b);
+  Output d = ops::Sqrt(s.WithOpName("d"), c);
+  Output e = ops::AddN(s.WithOpName("e"), {c, d});
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape(TensorShape({2})));
+  Output f = ops::Mul(s.WithOpName("f"), e, x);
+
+  GrapplerItem item;
+  item.fetch.push_back("f");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef first_output;
+  ConstantFolding first_optimizer(/*cpu_device=*/nullptr);
+  TF_EXPECT_OK(
+      first_optimizer.Optimize(/*cluster=*/nullptr, item, &first_output));
+  GraphDef second_output;
+  ConstantFolding second_optimizer(/*cpu_device=*/nullptr);
+  TF_EXPECT_OK(
+      second_optimizer.Optimize(/*cluster=*/nullptr, item, &second_output));
+  CompareGraphs(first_output, second_output);
+  for (const NodeDef& node : second_output.node()) {
+    EXPECT_NE("Sqrt", node.op());
+    EXPECT_NE("AddN", node.op());
+  }
+
+  Tensor x_t = test::AsTensor<float>({1.0f, -1.0f}, {2});
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(second_output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
 TEST_F(ConstantFoldingTest, AddTree) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
@@ -69,6 +69,8 @@ const ConfigList& DefaultPluginConfigs() {
        {"auto_mixed_precision_mkl", RewriterConfig::ON},
        {"auto_mixed_precision_cpu", RewriterConfig::ON},
        {"pin_to_host_optimization", RewriterConfig::ON},
+       {"horizontal_fusion", RewriterConfig::ON},
+       {"decode_image_fusion", RewriterConfig::ON},
        {"layout_optimizer", RewriterConfig::ON},
        {"remapping", RewriterConfig::ON},
        {"loop_optimization", RewriterConfig::ON},
@@ -123,6 +125,10 @@ PluginGraphOptimizerRegistry::CreateOptimizers(
   return optimizer_list;
 }
 
+bool PluginGraphOptimizerRegistry::HasRegisteredOptimizers() {
+  return !GetPluginRegistrationMap()->empty();
+}
+
 void PluginGraphOptimizerRegistry::RegisterPluginOptimizerOrDie(
     const Creator& optimizer_creator, const std::string& device_type,
     ConfigList& configs) {
@@ -84,6 +84,10 @@ class PluginGraphOptimizerRegistry {
   static std::vector<std::unique_ptr<CustomGraphOptimizer>> CreateOptimizers(
       const std::set<string>& device_types);
 
+  // Returns true if a plug-in CustomGraphOptimizer is registered for any
+  // device type.
+  static bool HasRegisteredOptimizers();
+
   typedef std::function<CustomGraphOptimizer*()> Creator;
 
   // Returns plugin's config. If any of the config is turned off, the returned
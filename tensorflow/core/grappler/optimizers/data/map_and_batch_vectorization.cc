@@ -0,0 +1,316 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_and_batch_vectorization.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kFuncAttr[] = "f";
+constexpr char kOutputShapesAttr[] = "output_shapes";
+constexpr char kOutputTypesAttr[] = "output_types";
+
+// Element-wise ops, mapped to the indices of the inputs that must not depend
+// on the function arguments because they are not broadcast element-wise (e.g.
+// the pattern of RegexReplace).
+const absl::flat_hash_map<absl::string_view, absl::flat_hash_set<int>>&
+ElementwiseOps() {
+  static const auto* const kOps =
+      new absl::flat_hash_map<absl::string_view, absl::flat_hash_set<int>>({
+          {"Abs", {}},
+          {"Add", {}},
+          {"AddV2", {}},
+          {"AsString", {}},
+          {"BitwiseAnd", {}},
+          {"BitwiseOr", {}},
+          {"BitwiseXor", {}},
+          {"Cast", {}},
+          {"Ceil", {}},
+          {"Div", {}},
+          {"Equal", {}},
+          {"Exp", {}},
+          {"Floor", {}},
+          {"FloorDiv", {}},
+          {"FloorMod", {}},
+          {"Greater", {}},
+          {"GreaterEqual", {}},
+          {"Identity", {}},
+          {"IsFinite", {}},
+          {"IsInf", {}},
+          {"IsNan", {}},
+          {"Less", {}},
+          {"LessEqual", {}},
+          {"Log", {}},
+          {"Log1p", {}},
+          {"LogicalAnd", {}},
+          {"LogicalNot", {}},
+          {"LogicalOr", {}},
+          {"Maximum", {}},
+          {"Minimum", {}},
+          {"Mul", {}},
+          {"Neg", {}},
+          {"NotEqual", {}},
+          {"Pow", {}},
+          {"RealDiv", {}},
+          {"Reciprocal", {}},
+          {"RegexFullMatch", {1}},
+          {"RegexReplace", {1, 2}},
+          {"Rint", {}},
+          {"Round", {}},
+          {"Rsqrt", {}},
+          {"SelectV2", {}},
+          {"Sigmoid", {}},
+          {"Sign", {}},
+          {"Sqrt", {}},
+          {"Square", {}},
+          {"SquaredDifference", {}},
+          {"StaticRegexFullMatch", {}},
+          {"StaticRegexReplace", {}},
+          {"StringJoin", {}},
+          {"StringLength", {}},
+          {"StringLower", {}},
+          {"StringStrip", {}},
+          {"StringToHashBucket", {}},
+          {"StringToHashBucketFast", {}},
+          {"StringToHashBucketStrong", {}},
+          {"StringToNumber", {}},
+          {"StringUpper", {}},
+          {"Sub", {}},
+          {"Tanh", {}},
+      });
+  return *kOps;
+}
+
+bool IsScalarConst(const NodeDef& node) {
+  if (node.op() != "Const") return false;
+  const auto* value = gtl::FindOrNull(node.attr(), "value");
+  return value != nullptr && value->has_tensor() &&
+         value->tensor().tensor_shape().dim_size() == 0;
+}
+
+// Returns the name of the function argument or node producing `input`.
+absl::string_view InputName(absl::string_view input) {
+  return input.substr(0, input.find(':'));
+}
+
+bool IsScalarDataset(const NodeDef& node) {
+  const auto* shapes = gtl::FindOrNull(node.attr(), kOutputShapesAttr);
+  if (shapes == nullptr || shapes->list().shape_size() == 0) return false;
+  for (const auto& shape : shapes->list().shape()) {
+    if (shape.unknown_rank() || shape.dim_size() != 0) return false;
+  }
+  return gtl::FindOrNull(node.attr(), kOutputTypesAttr) != nullptr;
+}
+
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& map_input_node, MutableGraphView* graph) {
+  NodeDef new_node = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, map_node.input(0));
+
+  // The batch now holds the elements of the map input, as vectors of the
+  // batch size of the original batch.
+  const auto& batch_shapes =
+      batch_node.attr().at(kOutputShapesAttr).list().shape();
+  TensorShapeProto shape;
+  if (!batch_shapes.empty() && batch_shapes[0].dim_size() > 0) {
+    *shape.add_dim() = batch_shapes[0].dim(0);
+  } else {
+    shape.add_dim()->set_size(-1);
+  }
+  auto* shapes = (*new_node.mutable_attr())[kOutputShapesAttr].mutable_list();
+  shapes->Clear();
+  const int num_components =
+      map_input_node.attr().at(kOutputTypesAttr).list().type_size();
+  for (int i = 0; i < num_components; ++i) {
+    *shapes->add_shape() = shape;
+  }
+  graph_utils::CopyAttribute(kOutputTypesAttr, map_input_node, &new_node);
+  return new_node;
+}
+
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node, const FunctionDef& function,
+                    MutableGraphView* graph) {
+  NodeDef new_node = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, new_batch_node.name());
+  (*new_node.mutable_attr())[kFuncAttr].mutable_func()->set_name(
+      function.signature().name());
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+  return new_node;
+}
+
+// Returns a copy of `function` without the scalar shapes recorded for its
+// arguments and nodes, which no longer hold once it is applied to batches.
+FunctionDef MakeVectorizedFunction(const FunctionDef& function,
+                                   const FunctionDefLibrary& library) {
+  FunctionDef vectorized = function;
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat("vectorized_", function.signature().name()), &library,
+      &vectorized);
+  vectorized.clear_arg_attr();
+  for (auto& node : *vectorized.mutable_node_def()) {
+    node.mutable_attr()->erase("_output_shapes");
+  }
+  return vectorized;
+}
+
+}  // namespace
+
+bool IsElementwiseVectorizable(const FunctionDef& function) {
+  if (function.signature().is_stateful() || !function.control_ret().empty()) {
+    return false;
+  }
+  absl::flat_hash_set<absl::string_view> arg_derived;
+  for (const auto& arg : function.signature().input_arg()) {
+    arg_derived.insert(arg.name());
+  }
+  // Nodes are not necessarily in topological order, so propagate until the set
+  // of argument-derived values stops growing.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : function.node_def()) {
+      if (arg_derived.contains(node.name())) continue;
+      for (const string& input : node.input()) {
+        if (absl::StartsWith(input, "^")) continue;
+        if (arg_derived.contains(InputName(input))) {
+          arg_derived.insert(node.name());
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  const auto& elementwise_ops = ElementwiseOps();
+  for (const NodeDef& node : function.node_def()) {
+    if (IsScalarConst(node)) continue;
+    const auto* fixed_inputs = gtl::FindOrNull(elementwise_ops, node.op());
+    if (fixed_inputs == nullptr) {
+      VLOG(2) << "Function " << function.signature().name()
+              << " is not vectorizable because of op " << node.op();
+      return false;
+    }
+    for (int i = 0; i < node.input_size(); ++i) {
+      if (absl::StartsWith(node.input(i), "^")) return false;
+      if (fixed_inputs->contains(i) &&
+          arg_derived.contains(InputName(node.input(i)))) {
+        return false;
+      }
+    }
+  }
+
+  // Outputs computed from constants only would not be batched.
+  for (const auto& ret : function.ret()) {
+    if (!arg_derived.contains(InputName(ret.second))) return false;
+  }
+  return true;
+}
+
+Status MapAndBatchVectorization::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  GraphDef sorted_old_graph = item.graph;
+  TF_RETURN_IF_ERROR(TopologicalSort(&sorted_old_graph));
+  *output = sorted_old_graph;
+
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : sorted_old_graph.node()) {
+    if (node.op() != "BatchDataset" && node.op() != "BatchDatasetV2") {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    if (!batch_node.attr().contains(kOutputShapesAttr)) continue;
+
+    // Only maps without captured inputs are rewritten, since captured inputs
+    // may not be broadcastable against a batch.
+    const NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (!((map_node->op() == kMapDataset && map_node->input_size() == 1) ||
+          (map_node->op() == kParallelMapDatasetV2 &&
+           map_node->input_size() == 2))) {
+      continue;
+    }
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+        1) {
+      continue;
+    }
+    const NodeDef* map_input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (!IsScalarDataset(*map_input_node)) continue;
+
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at(kFuncAttr).func().name());
+    if (function == nullptr || !IsElementwiseVectorizable(*function)) {
+      continue;
+    }
+
+    FunctionDef vectorized_function =
+        MakeVectorizedFunction(*function, output->library());
+    const NodeDef* new_batch_node = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *map_input_node, &graph));
+    const NodeDef* new_map_node =
+        graph.AddNode(MakeMapNode(*map_node, batch_node, *new_batch_node,
+                                  vectorized_function, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+    TF_RETURN_IF_ERROR(function_library.AddFunctionDef(vectorized_function));
+    *output->mutable_library()->add_function() = vectorized_function;
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapAndBatchVectorization,
+                            "map_and_batch_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_BATCH_VECTORIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_BATCH_VECTORIZATION_H_
+
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Returns true if applying `function` to a batch of scalar elements produces
+// the batch of the results of applying it to each element, i.e. if all its
+// inputs are scalars and its body only consists of element-wise ops and scalar
+// constants.
+bool IsElementwiseVectorizable(const FunctionDef& function);
+
+// This optimization swaps a map transformation followed by a batch
+// transformation when the map function is element-wise, so that the function
+// is invoked once per batch instead of once per element:
+//
+//   input.map(f).batch(n) -> input.batch(n).map(f)
+//
+// Only maps of datasets of scalars without captured inputs are rewritten.
+class MapAndBatchVectorization : public TFDataOptimizerBase {
+ public:
+  MapAndBatchVectorization() = default;
+  ~MapAndBatchVectorization() override = default;
+
+  string name() const override { return "map_and_batch_vectorization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_BATCH_VECTORIZATION_H_
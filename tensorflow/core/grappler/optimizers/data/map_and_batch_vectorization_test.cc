@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_and_batch_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+GrapplerItem MakeMapAndBatchItem(StringPiece function_name,
+                                 const FunctionDef& function) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", absl::Span<const TensorShape>{TensorShape({})}},
+             {"output_types", absl::Span<const DataType>{DT_INT64}}}),
+       MakeMapNode("map", "range", function_name),
+       NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {function});
+  return item;
+}
+
+TEST(MapAndBatchVectorizationTest, BatchesBeforeElementwiseMap) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("XTimesTwo", test::function::XTimesTwo());
+
+  MapAndBatchVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  EXPECT_EQ(batch_node.attr().at("output_shapes").list().shape(0).dim_size(),
+            1);
+  EXPECT_EQ(batch_node.attr().at("output_types").list().type(0), DT_INT64);
+
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), map_node.name());
+
+  const string& function_name = map_node.attr().at("f").func().name();
+  EXPECT_NE(function_name, "XTimesTwo");
+  EXPECT_TRUE(graph_utils::ContainsGraphFunctionWithName(function_name,
+                                                         output.library()));
+}
+
+TEST(MapAndBatchVectorizationTest, SkipsNonElementwiseMap) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("GetUnique", test::function::Unique());
+
+  MapAndBatchVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapAndBatchVectorizationTest, IsElementwiseVectorizable) {
+  EXPECT_TRUE(IsElementwiseVectorizable(test::function::XTimesTwo()));
+  EXPECT_FALSE(IsElementwiseVectorizable(test::function::Unique()));
+  EXPECT_FALSE(
+      IsElementwiseVectorizable(test::function::XTimesTwoWithControlInput()));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
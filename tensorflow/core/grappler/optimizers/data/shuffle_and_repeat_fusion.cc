@@ -40,6 +40,7 @@ constexpr char kShuffleAndRepeatDataset[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kCompressBuffer[] = "compress_buffer";
 
 Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
                               const NodeDef& repeat_node,
@@ -69,6 +70,11 @@ Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
   graph_utils::CopyShapesAndTypesAttrs(shuffle_node, fused_node);
   graph_utils::CopyAttribute(kReshuffleEachIteration, shuffle_node, fused_node);
 
+  // Preserve the `compress_buffer` attribute of graphs that set it.
+  if (shuffle_node.attr().contains(kCompressBuffer)) {
+    graph_utils::CopyAttribute(kCompressBuffer, shuffle_node, fused_node);
+  }
+
   // Optionally set the `metadata` attribute.
   graph_utils::MaybeSetFusedMetadata(shuffle_node, repeat_node, fused_node);
 
@@ -146,6 +152,11 @@ Status FuseShuffleV3AndRepeat(const NodeDef& shuffle_node,
   graph_utils::CopyShapesAndTypesAttrs(shuffle_node, fused_node);
   graph_utils::CopyAttribute(kReshuffleEachIteration, shuffle_node, fused_node);
 
+  // Preserve the `compress_buffer` attribute of graphs that set it.
+  if (shuffle_node.attr().contains(kCompressBuffer)) {
+    graph_utils::CopyAttribute(kCompressBuffer, shuffle_node, fused_node);
+  }
+
   // Optionally set the `metadata` attribute.
   graph_utils::MaybeSetFusedMetadata(shuffle_node, repeat_node, fused_node);
 
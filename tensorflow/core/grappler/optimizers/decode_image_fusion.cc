@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/decode_image_fusion.h"
+
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDecodeAndCropAndResizeJpeg[] = "_DecodeAndCropAndResizeJpeg";
+
+// Returns true if `node` is a constant holding the single integer `value`.
+bool IsConstantScalar(const NodeDef& node, int64_t value) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) return tensor.flat<int32>()(0) == value;
+  if (tensor.dtype() == DT_INT64) return tensor.flat<int64_t>()(0) == value;
+  return false;
+}
+
+}  // namespace
+
+Status DecodeImageFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  const int num_nodes = optimized_graph->node_size();
+  absl::flat_hash_map<string, int> node_index;
+  absl::flat_hash_map<string, int> num_fanouts;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = optimized_graph->node(i);
+    node_index[node.name()] = i;
+    for (const string& input : node.input()) ++num_fanouts[NodeName(input)];
+  }
+
+  // Returns the node producing the first output of `node`'s `input`, if it is
+  // only consumed by `node`, can be removed and is placed on the device of
+  // `node`, or null.
+  auto fusable_input = [&](const NodeDef& node, int input) -> NodeDef* {
+    if (node.input_size() <= input) return nullptr;
+    const TensorId tensor = ParseTensorName(node.input(input));
+    auto it = node_index.find(tensor.node());
+    if (tensor.index() != 0 || it == node_index.end()) return nullptr;
+    NodeDef* input_node = optimized_graph->mutable_node(it->second);
+    if (num_fanouts[input_node->name()] != 1 ||
+        nodes_to_preserve.count(input_node->name()) > 0 ||
+        input_node->device() != node.device()) {
+      return nullptr;
+    }
+    return input_node;
+  };
+
+  std::set<int> nodes_to_delete;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* squeeze = optimized_graph->mutable_node(i);
+    if (squeeze->op() != "Squeeze") continue;
+    std::vector<int32> squeeze_dims;
+    if (!GetNodeAttr(*squeeze, "squeeze_dims", &squeeze_dims).ok() ||
+        squeeze_dims != std::vector<int32>{0}) {
+      continue;
+    }
+
+    NodeDef* resize = fusable_input(*squeeze, 0);
+    if (resize == nullptr || resize->op() != "ResizeBilinear") continue;
+    DataType t;
+    bool align_corners;
+    bool half_pixel_centers;
+    if (!GetNodeAttr(*resize, "T", &t).ok() || t != DT_UINT8 ||
+        !GetNodeAttr(*resize, "align_corners", &align_corners).ok() ||
+        align_corners ||
+        !GetNodeAttr(*resize, "half_pixel_centers", &half_pixel_centers)
+             .ok() ||
+        !half_pixel_centers) {
+      continue;
+    }
+
+    NodeDef* expand_dims = fusable_input(*resize, 0);
+    if (expand_dims == nullptr || expand_dims->op() != "ExpandDims" ||
+        expand_dims->input_size() < 2) {
+      continue;
+    }
+    auto axis = node_index.find(NodeName(expand_dims->input(1)));
+    if (axis == node_index.end() ||
+        !IsConstantScalar(optimized_graph->node(axis->second), 0)) {
+      continue;
+    }
+
+    NodeDef* decode = fusable_input(*expand_dims, 0);
+    int32 ratio;
+    if (decode == nullptr || decode->op() != "DecodeAndCropJpeg" ||
+        decode->input_size() < 2 ||
+        !GetNodeAttr(*decode, "ratio", &ratio).ok() || ratio != 1) {
+      continue;
+    }
+
+    // The fused node replaces the squeeze, so that its consumers are kept.
+    NodeDef fused_node;
+    fused_node.set_name(squeeze->name());
+    fused_node.set_op(kDecodeAndCropAndResizeJpeg);
+    fused_node.set_device(squeeze->device());
+    fused_node.add_input(decode->input(0));
+    fused_node.add_input(decode->input(1));
+    fused_node.add_input(resize->input(1));
+    for (const NodeDef* node : {decode, expand_dims, resize, squeeze}) {
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) fused_node.add_input(input);
+      }
+    }
+    auto* attr = fused_node.mutable_attr();
+    for (const char* name : {"channels", "fancy_upscaling",
+                             "try_recover_truncated", "acceptable_fraction",
+                             "dct_method"}) {
+      if (decode->attr().count(name) > 0) {
+        (*attr)[name] = decode->attr().at(name);
+      }
+    }
+    if (!fused_node.device().empty() &&
+        !IsKernelRegisteredForNode(fused_node).ok()) {
+      continue;
+    }
+
+    VLOG(2) << "Fused the decoding and resizing of " << decode->name()
+            << " into " << fused_node.name();
+    *squeeze = std::move(fused_node);
+    nodes_to_delete.insert(node_index[decode->name()]);
+    nodes_to_delete.insert(node_index[expand_dims->name()]);
+    nodes_to_delete.insert(node_index[resize->name()]);
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  return absl::OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DECODE_IMAGE_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DECODE_IMAGE_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses the DecodeAndCropJpeg -> ExpandDims -> ResizeBilinear -> Squeeze
+// chains of input pipelines, as created by tf.image.decode_and_crop_jpeg
+// followed by tf.image.resize, into a single _DecodeAndCropAndResizeJpeg op.
+// The fused op decodes large images resized to small ones at a reduced DCT
+// scale, so its output may slightly differ from the unfused chain, and the
+// optimizer is hence off by default.
+class DecodeImageFusion : public GraphOptimizer {
+ public:
+  DecodeImageFusion() {}
+  explicit DecodeImageFusion(RewriterConfig::Toggle opt_level) {}
+
+  ~DecodeImageFusion() override {}
+
+  string name() const override { return "decode_image_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DECODE_IMAGE_FUSION_H_
@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/decode_image_fusion.h"
+
+#include <cstdint>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+class DecodeImageFusionTest : public GrapplerTest {
+ protected:
+  // Returns a JPEG image of `height` x `width` RGB pixels.
+  Output EncodedImage(const Scope& s, int height, int width) {
+    Tensor image(DT_UINT8, TensorShape({height, width, 3}));
+    auto pixels = image.tensor<uint8, 3>();
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) pixels(y, x, c) = (4 * y + 2 * x + c) % 256;
+      }
+    }
+    return ops::EncodeJpeg(s.WithOpName("encode"),
+                           ops::Const(s.WithOpName("image"), image));
+  }
+
+  // Returns the graph decoding, cropping and resizing a JPEG image the way
+  // tf.image.decode_and_crop_jpeg and tf.image.resize do.
+  GrapplerItem DecodeAndResize(int out_height, int out_width,
+                               bool half_pixel_centers = true) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+    Output contents = EncodedImage(s, 64, 96);
+    Output crop_window =
+        ops::Const(s.WithOpName("crop_window"), {4, 8, 48, 80}, {4});
+    Output decode = ops::DecodeAndCropJpeg(
+        s.WithOpName("decode"), contents, crop_window,
+        ops::DecodeAndCropJpeg::Channels(3));
+    Output expand_dims = ops::ExpandDims(s.WithOpName("expand_dims"), decode,
+                                         ops::Const(s.WithOpName("axis"), 0));
+    Output size =
+        ops::Const(s.WithOpName("size"), {out_height, out_width}, {2});
+    Output resize = ops::ResizeBilinear(
+        s.WithOpName("resize"), expand_dims, size,
+        ops::ResizeBilinear::HalfPixelCenters(half_pixel_centers));
+    Output squeeze = ops::Squeeze(s.WithOpName("squeeze"), resize,
+                                  ops::Squeeze::Axis({0}));
+    Output out = ops::Identity(s.WithOpName("out"), squeeze);
+
+    GrapplerItem item;
+    item.fetch = {"out"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(DecodeImageFusionTest, FusesDecodeAndCropAndResize) {
+  // The crop window is too small for a reduced DCT scale, so the fused op
+  // decodes the same pixels.
+  GrapplerItem item = DecodeAndResize(32, 60);
+  GraphDef output;
+  DecodeImageFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "DecodeAndCropJpeg");
+    EXPECT_NE(node.op(), "ResizeBilinear");
+    if (node.name() == "squeeze") {
+      ++found;
+      EXPECT_EQ(node.op(), "_DecodeAndCropAndResizeJpeg");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "encode");
+      EXPECT_EQ(node.input(1), "crop_window");
+      EXPECT_EQ(node.input(2), "size");
+      EXPECT_EQ(node.attr().at("channels").i(), 3);
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-3);
+}
+
+TEST_F(DecodeImageFusionTest, DecodesAtReducedScale) {
+  GrapplerItem item = DecodeAndResize(12, 20);
+  GraphDef output;
+  DecodeImageFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  EXPECT_EQ(tensors[0].shape(), TensorShape({12, 20, 3}));
+}
+
+TEST_F(DecodeImageFusionTest, DoesNotFuseResizeWithoutHalfPixelCenters) {
+  GrapplerItem item = DecodeAndResize(32, 60, /*half_pixel_centers=*/false);
+  GraphDef output;
+  DecodeImageFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_DecodeAndCropAndResizeJpeg");
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,246 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// An op with a single output that can be fused with the ops of the same fused
+// op and attributes. Its fused op has an "N" attribute and the same
+// attributes, takes the list of the N inputs of each of its inputs, and
+// returns the list of the N outputs.
+struct BatchableOp {
+  const char* fused_op;
+  std::vector<string> attrs;
+  // If set, the ops of different types sharing `fused_op` are fused together,
+  // and the fused op has a list attribute of this name, holding the
+  // `list_attr_value` of each of them.
+  const char* list_attr = nullptr;
+  const char* list_attr_value = nullptr;
+};
+
+const absl::flat_hash_map<string, BatchableOp>& BatchableOps() {
+  static const auto* batchable_ops =
+      new absl::flat_hash_map<string, BatchableOp>({
+          {"StringToHashBucketFast",
+           {"_FusedStringToHashBucketFast", {"num_buckets"}}},
+          {"StringToHashBucketStrong",
+           {"_FusedStringToHashBucketStrong", {"num_buckets", "key"}}},
+          // Embedding lookups, once the arithmetic optimizer has turned the
+          // lookups of tf.nn.embedding_lookup_sparse() into sparse segment
+          // reductions of the embedding tables themselves.
+          {"SparseSegmentSum",
+           {"_FusedSparseSegmentReduction",
+            {"T", "Tidx", "Tsegmentids"},
+            "combiners",
+            "Sum"}},
+          {"SparseSegmentMean",
+           {"_FusedSparseSegmentReduction",
+            {"T", "Tidx", "Tsegmentids"},
+            "combiners",
+            "Mean"}},
+          {"SparseSegmentSqrtN",
+           {"_FusedSparseSegmentReduction",
+            {"T", "Tidx", "Tsegmentids"},
+            "combiners",
+            "SqrtN"}},
+      });
+  return *batchable_ops;
+}
+
+// Returns the batchable op of `node`, or null.
+const BatchableOp* GetBatchableOp(const NodeDef& node) {
+  auto it = BatchableOps().find(node.op());
+  return it == BatchableOps().end() ? nullptr : &it->second;
+}
+
+// Returns the number of regular inputs of `node`.
+int NumRegularInputs(const NodeDef& node) {
+  int num_inputs = 0;
+  while (num_inputs < node.input_size() &&
+         !IsControlInput(node.input(num_inputs))) {
+    ++num_inputs;
+  }
+  return num_inputs;
+}
+
+// Returns the key of the nodes that can be fused together, or an empty string
+// if `node` can't be fused.
+string FusionKey(const NodeDef& node, const FrameView& frames) {
+  const BatchableOp* batchable_op = GetBatchableOp(node);
+  if (batchable_op == nullptr || node.device().empty()) return "";
+  string key = absl::StrCat(batchable_op->fused_op, ";", node.device(), ";",
+                            NumRegularInputs(node), ";",
+                            absl::StrJoin(frames.Frames(node), ","));
+  for (const string& attr : batchable_op->attrs) {
+    auto it = node.attr().find(attr);
+    if (it == node.attr().end()) return "";
+    absl::StrAppend(&key, ";", SummarizeAttrValue(it->second));
+  }
+  return key;
+}
+
+}  // namespace
+
+Status HorizontalFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  FrameView frames;
+  TF_RETURN_IF_ERROR(frames.InferFromGraph(*optimized_graph));
+
+  const int num_nodes = optimized_graph->node_size();
+  absl::flat_hash_map<string, int> node_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index[optimized_graph->node(i).name()] = i;
+  }
+
+  // The nodes depending on a batchable node. Batchable nodes that depend on
+  // another one are not fused, so that fused nodes never depend on each other.
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  std::vector<int> queue;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = optimized_graph->node(i);
+    for (const string& input : node.input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it != node_index.end()) fanouts[it->second].push_back(i);
+    }
+    if (GetBatchableOp(node) != nullptr) queue.push_back(i);
+  }
+  std::vector<bool> depends_on_batchable(num_nodes, false);
+  while (!queue.empty()) {
+    const int i = queue.back();
+    queue.pop_back();
+    for (int fanout : fanouts[i]) {
+      if (depends_on_batchable[fanout]) continue;
+      depends_on_batchable[fanout] = true;
+      queue.push_back(fanout);
+    }
+  }
+
+  // The fusable nodes, grouped by fused op, device, attributes and frame, in
+  // graph order.
+  std::map<string, std::vector<int>> groups;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = optimized_graph->node(i);
+    if (depends_on_batchable[i] || nodes_to_preserve.count(node.name()) > 0) {
+      continue;
+    }
+    const string key = FusionKey(node, frames);
+    if (!key.empty()) groups[key].push_back(i);
+  }
+
+  // Maps the name of each node that was fused to its fused node and output.
+  absl::flat_hash_map<string, std::pair<string, int>> fused_outputs;
+  std::set<int> nodes_to_delete;
+  for (const auto& [key, fusion] : groups) {
+    if (fusion.size() < 2) continue;
+    const NodeDef& first = optimized_graph->node(fusion[0]);
+    const BatchableOp& batchable_op = *GetBatchableOp(first);
+    NodeDef fused_node;
+    string name = AddPrefixToNodeName(first.name(), "HorizontalFusion");
+    while (node_index.contains(name)) name = absl::StrCat(name, "_");
+    fused_node.set_name(name);
+    fused_node.set_op(batchable_op.fused_op);
+    fused_node.set_device(first.device());
+    const int num_inputs = NumRegularInputs(first);
+    for (int input = 0; input < num_inputs; ++input) {
+      for (int i : fusion) {
+        fused_node.add_input(optimized_graph->node(i).input(input));
+      }
+    }
+    std::vector<string> control_inputs;
+    for (int i : fusion) {
+      const NodeDef& node = optimized_graph->node(i);
+      for (int input = num_inputs; input < node.input_size(); ++input) {
+        control_inputs.push_back(node.input(input));
+      }
+    }
+    std::sort(control_inputs.begin(), control_inputs.end());
+    control_inputs.erase(
+        std::unique(control_inputs.begin(), control_inputs.end()),
+        control_inputs.end());
+    for (const string& control_input : control_inputs) {
+      fused_node.add_input(control_input);
+    }
+    auto* attr = fused_node.mutable_attr();
+    SetAttrValue(static_cast<int>(fusion.size()), &(*attr)["N"]);
+    for (const string& attr_name : batchable_op.attrs) {
+      (*attr)[attr_name] = first.attr().at(attr_name);
+    }
+    if (batchable_op.list_attr != nullptr) {
+      std::vector<string> values;
+      for (int i : fusion) {
+        values.push_back(
+            GetBatchableOp(optimized_graph->node(i))->list_attr_value);
+      }
+      SetAttrValue(values, &(*attr)[batchable_op.list_attr]);
+    }
+    if (!IsKernelRegisteredForNode(fused_node).ok()) continue;
+
+    for (int j = 0, n = fusion.size(); j < n; ++j) {
+      fused_outputs[optimized_graph->node(fusion[j]).name()] = {name, j};
+      nodes_to_delete.insert(fusion[j]);
+    }
+    node_index[name] = -1;
+    VLOG(2) << "Fused " << fusion.size() << " " << batchable_op.fused_op
+            << " nodes into " << name;
+    *optimized_graph->add_node() = std::move(fused_node);
+  }
+  if (fused_outputs.empty()) return absl::OkStatus();
+
+  // Makes the consumers of the fused nodes read the outputs of their fused
+  // node.
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    for (int i = 0; i < node.input_size(); ++i) {
+      const TensorId tensor = ParseTensorName(node.input(i));
+      auto it = fused_outputs.find(tensor.node());
+      if (it == fused_outputs.end()) continue;
+      const auto& [fused_name, output] = it->second;
+      node.set_input(i, IsControlInput(tensor)
+                            ? AsControlDependency(fused_name)
+                            : absl::StrCat(fused_name, ":", output));
+    }
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  return absl::OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses the independent ops of the same batchable type and attributes placed
+// on the same device, such as the hundreds of StringToHashBucketFast ops of
+// per-feature transforms or unrolled loops, into a single fused op with a list
+// of inputs and outputs, which runs them all in one kernel invocation and
+// shards their elements over the worker threads.
+//
+// The batchable ops, and the attributes that must match for them to be fused,
+// are listed in horizontal_fusion.cc. They include the SparseSegmentSum,
+// SparseSegmentMean and SparseSegmentSqrtN ops of embedding lookups, which are
+// fused into a single _FusedSparseSegmentReduction op whatever their combiner,
+// so this should run after the arithmetic optimizer, which turns the lookups
+// of tf.nn.embedding_lookup_sparse() into sparse segment reductions of the
+// embedding tables themselves.
+class HorizontalFusion : public GraphOptimizer {
+ public:
+  HorizontalFusion() {}
+  explicit HorizontalFusion(RewriterConfig::Toggle opt_level) {}
+
+  ~HorizontalFusion() override {}
+
+  string name() const override { return "horizontal_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_HORIZONTAL_FUSION_H_
@@ -0,0 +1,201 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
+
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+class HorizontalFusionTest : public GrapplerTest {};
+
+TEST_F(HorizontalFusionTest, FusesIndependentOpsWithSameAttrs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output a = ops::Const(s.WithOpName("a"), {"x", "y", "z"}, {3});
+  Output b = ops::Const(s.WithOpName("b"), {"u", "v"}, {2, 1});
+  Output c = ops::Const(s.WithOpName("c"), {"w"}, {1});
+  Output hash_a = ops::StringToHashBucketFast(s.WithOpName("hash_a"), a, 10);
+  Output hash_b = ops::StringToHashBucketFast(s.WithOpName("hash_b"), b, 10);
+  // A different number of buckets is not fused with the others.
+  Output hash_c = ops::StringToHashBucketFast(s.WithOpName("hash_c"), c, 20);
+  Output strong_a =
+      ops::StringToHashBucketStrong(s.WithOpName("strong_a"), a, 10, {1, 2});
+  Output strong_b =
+      ops::StringToHashBucketStrong(s.WithOpName("strong_b"), b, 10, {1, 2});
+  Output out_a = ops::Identity(s.WithOpName("out_a"), hash_a);
+  Output out_b = ops::Identity(s.WithOpName("out_b"), hash_b);
+  Output out_c = ops::Identity(s.WithOpName("out_c"), hash_c);
+  Output out_strong_a = ops::Identity(s.WithOpName("out_strong_a"), strong_a);
+  Output out_strong_b = ops::Identity(s.WithOpName("out_strong_b"), strong_b);
+
+  GrapplerItem item;
+  item.fetch = {"out_a", "out_b", "out_c", "out_strong_a", "out_strong_b"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  HorizontalFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "StringToHashBucketStrong");
+    if (node.op() == "_FusedStringToHashBucketFast") {
+      ++found;
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      EXPECT_EQ(node.attr().at("num_buckets").i(), 10);
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "a");
+      EXPECT_EQ(node.input(1), "b");
+    } else if (node.op() == "_FusedStringToHashBucketStrong") {
+      ++found;
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      EXPECT_EQ(node.attr().at("key").list().i_size(), 2);
+    } else if (node.name() == "out_b") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "HorizontalFusion/hash_a:1");
+    } else if (node.name() == "out_c") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "hash_c");
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), tensors_expected.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<int64_t>(tensors[i], tensors_expected[i]);
+  }
+}
+
+TEST_F(HorizontalFusionTest, DoesNotFuseDependentOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output a = ops::Const(s.WithOpName("a"), {"x", "y"}, {2});
+  Output first = ops::StringToHashBucketFast(s.WithOpName("first"), a, 10);
+  Output str = ops::AsString(s.WithOpName("str"), first);
+  Output second = ops::StringToHashBucketFast(s.WithOpName("second"), str, 10);
+  Output out = ops::Identity(s.WithOpName("out"), second);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  HorizontalFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedStringToHashBucketFast");
+  }
+}
+
+TEST_F(HorizontalFusionTest, FusesEmbeddingLookupsWithDifferentCombiners) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output table_a = ops::Const(s.WithOpName("table_a"),
+                              {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, {3, 2});
+  Output table_b =
+      ops::Const(s.WithOpName("table_b"), {1.0f, 2.0f, 3.0f, 4.0f}, {4, 1});
+  Output ids_a = ops::Const(s.WithOpName("ids_a"), {0, 2, 1});
+  Output segments_a = ops::Const(s.WithOpName("segments_a"), {0, 0, 1});
+  Output ids_b = ops::Const(s.WithOpName("ids_b"), {3, 1});
+  Output segments_b = ops::Const(s.WithOpName("segments_b"), {0, 2});
+  Output sum =
+      ops::SparseSegmentSum(s.WithOpName("sum"), table_a, ids_a, segments_a);
+  Output mean =
+      ops::SparseSegmentMean(s.WithOpName("mean"), table_b, ids_b, segments_b);
+  Output sqrtn = ops::SparseSegmentSqrtN(s.WithOpName("sqrtn"), table_a, ids_a,
+                                         segments_a);
+  Output out_sum = ops::Identity(s.WithOpName("out_sum"), sum);
+  Output out_mean = ops::Identity(s.WithOpName("out_mean"), mean);
+  Output out_sqrtn = ops::Identity(s.WithOpName("out_sqrtn"), sqrtn);
+
+  GrapplerItem item;
+  item.fetch = {"out_sum", "out_mean", "out_sqrtn"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  HorizontalFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "SparseSegmentSum");
+    EXPECT_NE(node.op(), "SparseSegmentMean");
+    EXPECT_NE(node.op(), "SparseSegmentSqrtN");
+    if (node.op() == "_FusedSparseSegmentReduction") {
+      ++found;
+      EXPECT_EQ(node.attr().at("N").i(), 3);
+      const auto& combiners = node.attr().at("combiners").list().s();
+      ASSERT_EQ(combiners.size(), 3);
+      EXPECT_EQ(combiners[0], "Sum");
+      EXPECT_EQ(combiners[1], "Mean");
+      EXPECT_EQ(combiners[2], "SqrtN");
+      ASSERT_EQ(node.input_size(), 9);
+      EXPECT_EQ(node.input(0), "table_a");
+      EXPECT_EQ(node.input(1), "table_b");
+      EXPECT_EQ(node.input(3), "ids_a");
+      EXPECT_EQ(node.input(7), "segments_b");
+    } else if (node.name() == "out_mean") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "HorizontalFusion/sum:1");
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), tensors_expected.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-6);
+  }
+}
+
+TEST_F(HorizontalFusionTest, DoesNotFuseDependentLookups) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output table = ops::Const(s.WithOpName("table"), {1.0f, 2.0f}, {2, 1});
+  Output ids = ops::Const(s.WithOpName("ids"), {0, 1});
+  Output segments = ops::Const(s.WithOpName("segments"), {0, 0});
+  Output first =
+      ops::SparseSegmentSum(s.WithOpName("first"), table, ids, segments);
+  Output second =
+      ops::SparseSegmentSum(s.WithOpName("second"), first, segments, segments);
+  Output out = ops::Identity(s.WithOpName("out"), second);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  HorizontalFusion optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedSparseSegmentReduction");
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
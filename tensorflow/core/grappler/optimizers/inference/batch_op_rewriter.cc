@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "google/protobuf/wrappers.pb.h"
 #include "google/protobuf/map.h"
@@ -65,6 +66,7 @@ struct AdaptiveBatchSchedulerParams {
   int32 max_inflight_batches;
   int32 batches_to_average_over;
   int64_t full_batch_scheduling_boost_micros;
+  int64_t target_p99_latency_micros;
 };
 
 AdaptiveBatchSchedulerParams GetAdaptiveBatchSchedulerParams(
@@ -90,6 +92,10 @@ AdaptiveBatchSchedulerParams GetAdaptiveBatchSchedulerParams(
       option.has_full_batch_scheduling_boost_micros()
           ? option.full_batch_scheduling_boost_micros().value()
           : kBoostMicrosNotSet;
+  params.target_p99_latency_micros =
+      option.has_target_p99_latency_micros()
+          ? option.target_p99_latency_micros().value()
+          : 0;
   return params;
 }
 
@@ -109,6 +115,10 @@ void SetNodeAttrs(const AdaptiveBatchSchedulerParams& params, NodeDef* node) {
         kFullBatchSchedulingBoostMicros,
         params.full_batch_scheduling_boost_micros, node);
   }
+  if (params.target_p99_latency_micros > 0) {
+    ::tensorflow::graph_transforms::SetNodeAttr(
+        kTargetP99LatencyMicrosAttr, params.target_p99_latency_micros, node);
+  }
 }
 
 void UpdateBatchOps(GraphDef* graph, BatchOpRewriteFunction rewrite_fn) {
@@ -265,6 +275,24 @@ Status BatchOpRewriter::Optimize(Cluster* cluster, const GrapplerItem& item,
               kEnableLargeBatchSplitting,
               !batch_options.disable_large_batch_splitting(), batch_op);
         }
+        if (batch_options.has_latency_slo_micros()) {
+          ::tensorflow::graph_transforms::SetNodeAttr(
+              kLatencySloMicrosAttr, batch_options.latency_slo_micros(),
+              batch_op);
+        }
+        if (batch_options.has_enable_ragged_batching()) {
+          ::tensorflow::graph_transforms::SetNodeAttr(
+              kEnableRaggedBatchingAttr, batch_options.enable_ragged_batching(),
+              batch_op);
+        }
+        if (!batch_options.ragged_length_bucket_boundaries().empty()) {
+          ::tensorflow::graph_transforms::SetNodeAttr(
+              kRaggedLengthBucketBoundariesAttr,
+              std::vector<int64_t>(
+                  batch_options.ragged_length_bucket_boundaries().begin(),
+                  batch_options.ragged_length_bucket_boundaries().end()),
+              batch_op);
+        }
       });
     }
   }
@@ -183,6 +183,10 @@ TEST_P(BatchOpRewriterTest, AdaptiveBatchScheduler) {
       .mutable_adaptive_batch_scheduler_option()
       ->mutable_full_batch_scheduling_boost_micros()
       ->set_value(12345);
+  (*config.mutable_batch_options())["model_with_override"]
+      .mutable_adaptive_batch_scheduler_option()
+      ->mutable_target_p99_latency_micros()
+      ->set_value(20000);
 
   RewriterConfig_CustomGraphOptimizer rewriter_config = MakeConfig(config);
   ConfigProto config_proto;
@@ -209,7 +213,8 @@ TEST_P(BatchOpRewriterTest, AdaptiveBatchScheduler) {
               {kInitialInflightBatchesAttr, 16},
               {kMinInflightBatchesAttr, 8},
               {kMaxInflightBatchesAttr, 32},
-              {kFullBatchSchedulingBoostMicros, 12345}});
+              {kFullBatchSchedulingBoostMicros, 12345},
+              {kTargetP99LatencyMicrosAttr, 20000}});
 
   EXPECT_EQ(optimized_graph.DebugString(), expected_graph.DebugString());
 }
@@ -296,6 +301,69 @@ TEST_F(BatchOpRewriterTest, UpdateBatchOptions) {
   EXPECT_EQ(optimized_graph.DebugString(), expected_graph.DebugString());
 }
 
+TEST_F(BatchOpRewriterTest, UpdateLatencySlo) {
+  BatchOpRewriteConfig config;
+  (*config.mutable_batch_options())["model_with_override"]
+      .set_latency_slo_micros(20000);
+
+  RewriterConfig_CustomGraphOptimizer rewriter_config = MakeConfig(config);
+  ConfigProto config_proto;
+  config_proto.mutable_experimental()->mutable_session_metadata()->set_name(
+      "model_with_override");
+  BatchOpRewriter optimizer;
+  TF_ASSERT_OK(optimizer.InitWithConfig(config_proto, &rewriter_config));
+
+  GraphDef optimized_graph;
+  GrapplerItem item;
+  AddBatchOp(&item.graph);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &optimized_graph));
+
+  GraphDef expected_graph;
+  AddBatchOp(&expected_graph);
+  ::tensorflow::graph_transforms::SetNodeAttr(
+      kLatencySloMicrosAttr, int64_t{20000}, expected_graph.mutable_node(0));
+  ::tensorflow::graph_transforms::SetNodeAttr(
+      kLatencySloMicrosAttr, int64_t{20000},
+      expected_graph.mutable_library()->mutable_function(0)->mutable_node_def(
+          0));
+  EXPECT_EQ(optimized_graph.DebugString(), expected_graph.DebugString());
+}
+
+TEST_F(BatchOpRewriterTest, UpdateRaggedBatching) {
+  BatchOpRewriteConfig config;
+  (*config.mutable_batch_options())["model_with_override"]
+      .set_enable_ragged_batching(true);
+  const std::vector<int64_t> boundaries{32, 128};
+  (*config.mutable_batch_options())["model_with_override"]
+      .mutable_ragged_length_bucket_boundaries()
+      ->Add(boundaries.begin(), boundaries.end());
+
+  RewriterConfig_CustomGraphOptimizer rewriter_config = MakeConfig(config);
+  ConfigProto config_proto;
+  config_proto.mutable_experimental()->mutable_session_metadata()->set_name(
+      "model_with_override");
+  BatchOpRewriter optimizer;
+  TF_ASSERT_OK(optimizer.InitWithConfig(config_proto, &rewriter_config));
+
+  GraphDef optimized_graph;
+  GrapplerItem item;
+  AddBatchOp(&item.graph);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &optimized_graph));
+
+  GraphDef expected_graph;
+  AddBatchOp(&expected_graph);
+  for (NodeDef* batch_op :
+       {expected_graph.mutable_node(0),
+        expected_graph.mutable_library()->mutable_function(0)->mutable_node_def(
+            0)}) {
+    ::tensorflow::graph_transforms::SetNodeAttr(kEnableRaggedBatchingAttr,
+                                                true, batch_op);
+    ::tensorflow::graph_transforms::SetNodeAttr(
+        kRaggedLengthBucketBoundariesAttr, boundaries, batch_op);
+  }
+  EXPECT_EQ(optimized_graph.DebugString(), expected_graph.DebugString());
+}
+
 TEST_F(BatchOpRewriterTest,
        UpdateAdaptiveSharedBatchSchedulerAndNumBatchThreads) {
   GrapplerItem item;
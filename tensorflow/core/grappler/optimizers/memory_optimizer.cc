@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <limits>
+#include <memory>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -30,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -977,6 +981,48 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Simulates the execution of the item on the cluster and records the time at
+// which each node completes.
+static bool EstimateOpCompletionTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+    }
+  }
+  return true;
+}
+
+// Returns the time at which the peak memory usage is reached, i.e. the time at
+// which the last tensor live at the peak was allocated.
+static Costs::Duration GetPeakTime(const GraphMemory::MemoryUsage& mem_usage) {
+  Costs::Duration peak_time = -1;
+  for (const auto& live_tensor : mem_usage.live_tensors) {
+    if (live_tensor.allocation_time > peak_time) {
+      peak_time = live_tensor.allocation_time;
+    }
+  }
+  return peak_time;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1012,37 +1058,11 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpCompletionTimes(cluster, *item, &op_completion_times)) {
+      return false;
     }
 
-    Costs::Duration peak_time = -1;
-    for (const auto& live_tensor : mem_usage.live_tensors) {
-      if (live_tensor.allocation_time > peak_time) {
-        peak_time = live_tensor.allocation_time;
-      }
-    }
+    Costs::Duration peak_time = GetPeakTime(mem_usage);
 
     std::vector<MemInfo> mem_state;
 
@@ -1146,6 +1166,313 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// A way to take a tensor live at the memory peak out of device memory, and its
+// cost in step time per byte saved.
+struct EvictionInfo {
+  MutableGraphView::OutputPort port;
+  int64_t memory_saved;
+  // Uses of the tensor that run after the memory peak.
+  std::vector<MutableGraphView::InputPort> uses_left;
+  // Recompute the tensor for its uses left if true, swap it out otherwise.
+  bool recompute;
+  double cost;
+
+  bool operator<(const EvictionInfo& other) const { return cost < other.cost; }
+};
+
+// Returns true if the node can be recomputed on demand to get the value it
+// produced in the first place.
+static bool IsRecomputable(const NodeDef& node,
+                           const std::unordered_set<string>& feeds) {
+  return feeds.count(node.name()) == 0 && IsFreeOfSideEffect(node) &&
+         !IsVariable(node) && !IsControlFlow(node) && !IsPersistent(node) &&
+         !ModifiesInputsInPlace(node);
+}
+
+// Adds the input to the list of inputs that SwappingPass() swaps out for the
+// node, as a manual "_swap_to_host" annotation would.
+static void AnnotateInputToSwap(NodeDef* node, int input_id) {
+  AttrValue& val = (*node->mutable_attr())["_swap_to_host"];
+  if (val.value_case() == AttrValue::kI) {
+    int64_t annotated_input = val.i();
+    val.mutable_list()->add_i(annotated_input);
+  }
+  for (int64_t annotated_input : val.list().i()) {
+    if (annotated_input == input_id) {
+      return;
+    }
+  }
+  val.mutable_list()->add_i(input_id);
+}
+
+// Picks the tensors to evict from the memory of the GPUs whose peak memory
+// usage exceeds the memory limit (or their memory size if the limit is not
+// positive). For each tensor live at the peak, recomputing it is estimated to
+// cost the compute time of its producer, and swapping it to cost the part of
+// the host transfers that can't overlap with the computations before and after
+// the peak. The cheapest option per byte saved is picked, and tensors are
+// evicted in increasing order of cost until the peak fits within the limit.
+// Swaps are expressed as "_swap_to_host" annotations for SwappingPass() to
+// apply, while recomputations are applied right away.
+static bool CostModelMemoryPass(Cluster* cluster, int64_t memory_limit_bytes,
+                                std::unique_ptr<GraphMemory>* memory_ptr,
+                                GrapplerItem* item,
+                                std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  // The simulation and the shape inference are only needed if some device
+  // runs out of memory.
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unique_ptr<GraphProperties> properties;
+  std::unordered_map<string, const NodeDef*> name_map;
+  OpLevelCostEstimator cost_estimator;
+
+  // Tensors to swap out, as (consumer, input_id) pairs, and producers to
+  // recompute for their consumers.
+  std::vector<std::pair<string, int>> inputs_to_swap;
+  std::vector<std::pair<string, std::vector<string>>> nodes_to_recompute;
+
+  MutableGraphView graph(&item->graph);
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    const int64_t memory_limit =
+        memory_limit_bytes > 0 ? memory_limit_bytes : prop.memory_size();
+    if (memory_limit <= 0) {
+      VLOG(1) << "Memory limit unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= memory_limit) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - memory_limit;
+
+    if (properties == nullptr) {
+      if (!EstimateOpCompletionTimes(cluster, *item, &op_completion_times)) {
+        return false;
+      }
+      properties = std::make_unique<GraphProperties>(*item);
+      if (!properties
+               ->InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false)
+               .ok()) {
+        return false;
+      }
+      for (const auto& node : item->graph.node()) {
+        name_map[node.name()] = &node;
+      }
+    }
+
+    const Costs::Duration peak_time = GetPeakTime(mem_usage);
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<EvictionInfo> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+
+      EvictionInfo info;
+      info.port = port;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      bool swappable = IsSwappable(graph, port);
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        string input_name =
+            strings::StrCat(input.node->name(), ":", input.port_id);
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(input_name) != skip_list->end()) {
+          valid = false;
+          break;
+        }
+        swappable = swappable && IsSwappable(input);
+        info.uses_left.emplace_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || info.uses_left.empty()) {
+        continue;
+      }
+
+      // Let's assume we're going to swap over PCIe running at 16 GBps. The
+      // swap out overlaps with the computations between the allocation of the
+      // tensor and the peak, and the swap in with the ones between the peak
+      // and the first use left.
+      //
+      // Note that we must perform the arithmetic inexactly as "double", since
+      // the values do not fit into any integral type.
+      double swap_cost = std::numeric_limits<double>::infinity();
+      if (swappable) {
+        const double time_to_swap = live_tensor.memory_used / 16.0;
+        const double time_before_peak =
+            (peak_time - live_tensor.allocation_time).count();
+        const double time_after_peak = (earliest_use - peak_time).count();
+        swap_cost = (std::max(0.0, time_to_swap - time_before_peak) +
+                     std::max(0.0, time_to_swap - time_after_peak)) /
+                    live_tensor.memory_used;
+      }
+
+      // Recomputing the tensor keeps its inputs alive until the recomputation,
+      // which offsets the memory saved unless they are live at the peak anyway.
+      double recompute_cost = std::numeric_limits<double>::infinity();
+      int64_t recompute_savings = live_tensor.memory_used;
+      const NodeDef& producer = *port.node;
+      if (live_tensor.output_id == 0 && IsRecomputable(producer, feeds)) {
+        const std::vector<OpInfo::TensorProperties>& inputs =
+            properties->GetInputProperties(producer.name());
+        for (int i = 0;
+             i < static_cast<int>(inputs.size()) && i < producer.input_size();
+             ++i) {
+          const string& input = producer.input(i);
+          if (IsControlInput(input)) {
+            break;
+          }
+          int input_port;
+          const string input_node = ParseNodeName(input, &input_port);
+          auto fanin = name_map.find(input_node);
+          if (fanin != name_map.end() && IsPersistent(*fanin->second)) {
+            continue;
+          }
+          if (live_at_peak.count(strings::StrCat(input_node, ":",
+                                                 input_port)) == 0) {
+            recompute_savings -= CalculateTensorSize(inputs[i]);
+          }
+        }
+        if (recompute_savings > 0) {
+          OpContext op_context;
+          op_context.name = producer.name();
+          op_context.device_name = producer.device();
+          op_context.op_info =
+              BuildOpInfoWithoutDevice(producer, name_map, inputs);
+          *op_context.op_info.mutable_device() = prop;
+          for (const auto& output :
+               properties->GetOutputProperties(producer.name())) {
+            *op_context.op_info.add_outputs() = output;
+          }
+          op_context.function_library = &item->graph.library();
+          const Costs costs = cost_estimator.PredictCosts(op_context);
+          recompute_cost = static_cast<double>(costs.compute_time.count()) /
+                           recompute_savings;
+        }
+      }
+
+      if (swap_cost == std::numeric_limits<double>::infinity() &&
+          recompute_cost == std::numeric_limits<double>::infinity()) {
+        continue;
+      }
+      info.recompute = recompute_cost < swap_cost;
+      info.memory_saved =
+          info.recompute ? recompute_savings : live_tensor.memory_used;
+      info.cost = std::min(swap_cost, recompute_cost);
+      candidates.push_back(std::move(info));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const EvictionInfo& info : candidates) {
+      const string& producer = info.port.node->name();
+      if (info.recompute) {
+        VLOG(1) << "Will recompute " << producer << " for "
+                << info.uses_left.size() << " uses, saving "
+                << info.memory_saved;
+        std::vector<string> consumers;
+        for (const MutableGraphView::InputPort& use : info.uses_left) {
+          consumers.push_back(use.node->name());
+        }
+        nodes_to_recompute.emplace_back(producer, std::move(consumers));
+        // Don't attempt to evict the tensor again in a subsequent pass.
+        skip_list->insert(producer);
+      } else {
+        for (const MutableGraphView::InputPort& use : info.uses_left) {
+          VLOG(1) << "Will swap fanout " << use.node->name() << ":"
+                  << use.port_id << " of tensor " << producer << ":"
+                  << info.port.port_id << " of size " << info.memory_saved;
+          inputs_to_swap.emplace_back(use.node->name(), use.port_id);
+        }
+      }
+      required_savings -= info.memory_saved;
+      if (required_savings < 0) {
+        break;
+      }
+    }
+  }
+
+  if (inputs_to_swap.empty() && nodes_to_recompute.empty()) {
+    return false;
+  }
+
+  for (const auto& input : inputs_to_swap) {
+    MutableGraphView::InputPort port =
+        graph.GetInputPort(input.first, input.second);
+    AnnotateInputToSwap(port.node, input.second);
+  }
+
+  if (!nodes_to_recompute.empty()) {
+    // As in RecomputationRewritingPass(), the topological numbering and the
+    // NodeMap only need to be valid for the nodes of the original graph.
+    if (!TopologicalSort(&item->graph).ok()) {
+      return !inputs_to_swap.empty();
+    }
+    NodeMap node_map(&item->graph);
+    std::unordered_map<const NodeDef*, int> topological_numbering;
+    for (int node_number = 0; node_number < item->graph.node_size();
+         ++node_number) {
+      topological_numbering[item->graph.mutable_node(node_number)] =
+          item->graph.node_size() - node_number - 1;
+    }
+    for (const auto& recompute : nodes_to_recompute) {
+      std::unordered_set<NodeDef*> target_nodes;
+      for (const string& consumer : recompute.second) {
+        target_nodes.insert(node_map.GetNode(consumer));
+      }
+      RecomputeSubgraph({node_map.GetNode(recompute.first)}, target_nodes,
+                        node_map, topological_numbering, &item->graph);
+      skip_list->insert(
+          AddPrefixToNodeName(recompute.first, kRecomputedNodePrefix));
+    }
+  }
+  return true;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                   Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
@@ -1413,7 +1740,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       updated_graph = false;
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
-           optimization_level_ == RewriterConfig::HEURISTICS) &&
+           optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS) &&
           cluster != nullptr) {
         if (SchedulingPass(cluster, &memory, &optimized_item)) {
           // Reset the inferred memory usage since the graph changed.
@@ -1422,11 +1750,23 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS &&
+          cluster != nullptr) {
+        if (CostModelMemoryPass(cluster, memory_limit_bytes_, &memory,
+                                &optimized_item, &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
@@ -21,6 +21,8 @@ limitations under the License.
 #include <type_traits>
 #include <utility>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -44,8 +47,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/decode_image_fusion.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/horizontal_fusion.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
@@ -62,7 +67,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -80,6 +93,7 @@ namespace {
 
 constexpr int kDefaultNumberOfIterations = 2;
 constexpr int kDefaultMinGraphNodes = 4;
+constexpr int kDefaultMaxFunctionOptimizationThreads = 16;
 constexpr char kGrapplerCategory[] = "Grappler";
 
 int64_t NumEdges(const GraphDef& graph) {
@@ -103,6 +117,33 @@ int NumIterations(const RewriterConfig& cfg) {
              : cfg.meta_optimizer_iterations();
 }
 
+// Returns true if `cfg` might run optimizers that are not part of Grappler,
+// which are not required to be thread-safe.
+bool UsesCustomOrPluginOptimizers(const RewriterConfig& cfg) {
+  if (cfg.custom_optimizers_size() > 0) return true;
+  if (cfg.use_plugin_optimizers() != RewriterConfig::OFF &&
+      PluginGraphOptimizerRegistry::HasRegisteredOptimizers()) {
+    return true;
+  }
+  // Optimizers listed by name might be registered custom optimizers.
+  const std::vector<string> custom_optimizers =
+      CustomGraphOptimizerRegistry::GetRegisteredOptimizers();
+  for (const string& optimizer : cfg.optimizers()) {
+    if (absl::c_linear_search(custom_optimizers, optimizer)) return true;
+  }
+  return false;
+}
+
+int NumFunctionOptimizationThreads(const RewriterConfig& cfg) {
+  if (cfg.function_optimization_threads() > 0) {
+    return cfg.function_optimization_threads();
+  }
+  // Custom and plugin optimizers would run on several functions at once.
+  if (UsesCustomOrPluginOptimizers(cfg)) return 1;
+  return std::min(port::MaxParallelism(),
+                  kDefaultMaxFunctionOptimizationThreads);
+}
+
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
@@ -128,6 +169,84 @@ FunctionDefLibrary GetFunctionDefLibraryStub(
   return stub;
 }
 
+// Process-wide cache of optimized function bodies, keyed by the fingerprint of
+// everything the optimization of a function depends on. Each entry holds the
+// optimized function first, followed by the specialized functions that were
+// added to the library while optimizing it. Entries can optionally be
+// persisted to a directory, one binary FunctionDefLibrary file per key, so
+// that they are shared across processes.
+class OptimizedFunctionCache {
+ public:
+  static OptimizedFunctionCache* Global() {
+    static OptimizedFunctionCache* cache = new OptimizedFunctionCache();
+    return cache;
+  }
+
+  // Returns true and fills `entry` if `key` is either cached in memory or
+  // persisted in `persist_dir` (when non-empty).
+  bool Lookup(uint64 key, const string& persist_dir, FunctionDefLibrary* entry)
+      TF_LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock l(mu_);
+      auto it = entries_.find(key);
+      if (it != entries_.end()) {
+        *entry = it->second;
+        return true;
+      }
+    }
+    if (persist_dir.empty()) return false;
+    const string path = PersistPath(key, persist_dir);
+    Env* env = Env::Default();
+    if (!env->FileExists(path).ok()) return false;
+    Status s = ReadBinaryProto(env, path, entry);
+    if (!s.ok() || entry->function_size() == 0) {
+      LOG(WARNING) << "Ignoring invalid optimized function cache entry "
+                   << path << ": " << s;
+      return false;
+    }
+    mutex_lock l(mu_);
+    if (entries_.size() < kMaxEntries) entries_.emplace(key, *entry);
+    return true;
+  }
+
+  void Insert(uint64 key, const string& persist_dir,
+              const FunctionDefLibrary& entry) TF_LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock l(mu_);
+      if (entries_.size() < kMaxEntries) entries_.emplace(key, entry);
+    }
+    if (persist_dir.empty()) return;
+    // Write to a temporary file first, so that concurrent readers never see a
+    // partially written entry.
+    Env* env = Env::Default();
+    const string path = PersistPath(key, persist_dir);
+    string tmp_path = path;
+    Status s = env->RecursivelyCreateDir(persist_dir);
+    if (s.ok() && !env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+      s = errors::Internal("Failed to create a temporary file name");
+    }
+    if (s.ok()) s = WriteBinaryProto(env, tmp_path, entry);
+    if (s.ok()) s = env->RenameFile(tmp_path, path);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to persist optimized function cache entry "
+                   << path << ": " << s;
+    }
+  }
+
+ private:
+  // Bounds the memory used by the cache; once full, new entries are only
+  // persisted.
+  static constexpr size_t kMaxEntries = 1 << 14;
+
+  static string PersistPath(uint64 key, const string& persist_dir) {
+    return io::JoinPath(persist_dir,
+                        absl::StrCat(absl::Hex(key, absl::kZeroPad16), ".pb"));
+  }
+
+  mutex mu_;
+  absl::flat_hash_map<uint64, FunctionDefLibrary> entries_ TF_GUARDED_BY(mu_);
+};
+
 uint64 DeadlineMicroSeconds(const RewriterConfig& cfg) {
   if (cfg.meta_optimizer_timeout_ms() <= 0) return 0;  // no deadline
   return Env::Default()->NowMicros() + cfg.meta_optimizer_timeout_ms() * 1000;
@@ -260,6 +379,10 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("horizontal_fusion", "horizontal_fusion",
+         new HorizontalFusion(cfg_.horizontal_fusion()));
+  MK_OPT("decode_image_fusion", "decode_image_fusion",
+         new DecodeImageFusion(cfg_.decode_image_fusion()));
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -421,6 +544,16 @@ Status MetaOptimizer::InitializeOptimizers(
           cfg_.arithmetic_optimization()));
     }
   }
+  if (BOTH_ARE_ON(horizontal_fusion))
+    optimizers->push_back(std::make_unique<HorizontalFusion>());
+  else if (BOTH_ARE_EXPERIMENTAL_MLIR(horizontal_fusion) ||
+           BOTH_ARE_EXPERIMENTAL_BOTH(horizontal_fusion))
+    VLOG(2) << "horizontal_fusion is not implemented in TFG yet";
+  if (BOTH_ARE_ON(decode_image_fusion))
+    optimizers->push_back(std::make_unique<DecodeImageFusion>());
+  else if (BOTH_ARE_EXPERIMENTAL_MLIR(decode_image_fusion) ||
+           BOTH_ARE_EXPERIMENTAL_BOTH(decode_image_fusion))
+    VLOG(2) << "decode_image_fusion is not implemented in TFG yet";
   if (BOTH_NOT_OFF(layout_optimizer)) {
     if (USER_IS_EXPERIMENTAL_MLIR(layout_optimizer) ||
         USER_IS_EXPERIMENTAL_BOTH(layout_optimizer)) {
@@ -473,13 +606,15 @@ Status MetaOptimizer::InitializeOptimizers(
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
+      optimizers->push_back(std::make_unique<MemoryOptimizer>(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          cfg_.memory_optimization(), "gradients/",
+          cfg_.memory_optimizer_memory_limit_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_memory_limit_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -636,6 +771,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(constant_folding)
     PRINT_CFG(shape_optimization)
     PRINT_CFG(pin_to_host_optimization)
+    PRINT_CFG(horizontal_fusion)
+    PRINT_CFG(decode_image_fusion)
     PRINT_CFG(layout_optimizer)
     PRINT_CFG(remapping)
     PRINT_CFG(loop_optimization)
@@ -689,6 +826,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
+      PRINT_CFG("horizontal_fusion", "horizontal_fusion")
+      PRINT_CFG("decode_image_fusion", "decode_image_fusion")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
       PRINT_CFG("loop", "loop_optimization")
@@ -730,6 +869,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
         pair.first == "pin_to_host_optimization" ||
+        pair.first == "horizontal_fusion" ||
+        pair.first == "decode_image_fusion" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
       // TODO(penporn): Remove the hard-coded length and change it to max length
@@ -813,6 +954,10 @@ Status MetaOptimizer::OptimizeGraph(
     CompressConstants(optimized_graph);
   }
 
+  // Lets the optimizers reuse the shapes inferred by an earlier optimizer when
+  // the graph has not changed in between.
+  ScopedGraphPropertiesCache graph_properties_cache;
+
   for (int iteration = 0; iteration < NumIterations(cfg_); ++iteration) {
     // Don't bother optimizing further if the graph is already tiny.
     if (optimized_graph->node_size() < min_graph_nodes) {
@@ -888,7 +1033,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1164,11 +1312,202 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // The optimized body of a function only depends on the function, the
+  // functions reachable from it, the optimization options, the config and
+  // devices of the meta optimizer, its custom optimizers and the TF version.
+  // When the cache of optimized functions is enabled, we look up functions by
+  // the fingerprint of all of these.
+  const bool use_function_cache =
+      cfg_.function_optimization_cache() == RewriterConfig::ON;
+  const string& function_cache_dir = cfg_.function_optimization_cache_dir();
+  uint64 function_cache_base_key = 0;
+  if (use_function_cache) {
+    string config_str;
+    SerializeToStringDeterministic(config_proto_, &config_str);
+    function_cache_base_key = FingerprintCat64(
+        Fingerprint64(config_str),
+        Fingerprint64(absl::StrCat(TF_VERSION_STRING, ":", TF_GRAPH_DEF_VERSION,
+                                   ":", producer, ":", is_tpu_graph, ":",
+                                   xla_auto_clustering_on_)));
+    for (const auto& custom_optimizer : cfg_.custom_optimizers()) {
+      string parameters_str;
+      SerializeToStringDeterministic(custom_optimizer, &parameters_str);
+      function_cache_base_key = FingerprintCat64(
+          function_cache_base_key,
+          Fingerprint64(absl::StrCat(custom_optimizer.name(), ":",
+                                     parameters_str)));
+    }
+    if (cluster != nullptr) {
+      std::vector<string> device_names = cluster->GetDeviceNames();
+      std::sort(device_names.begin(), device_names.end());
+      function_cache_base_key =
+          FingerprintCat64(function_cache_base_key,
+                           Fingerprint64(absl::StrJoin(device_names, ",")));
+    }
+  }
+  // Fingerprints of the functions in `flib`, invalidated when they change.
+  absl::flat_hash_map<string, uint64> function_fingerprints;
+  const auto fingerprint_function = [&](const string& name) -> uint64 {
+    auto it = function_fingerprints.find(name);
+    if (it != function_fingerprints.end()) return it->second;
+    string func_str;
+    const FunctionDef* func_def = flib.Find(name);
+    if (func_def != nullptr) {
+      SerializeToStringDeterministic(*func_def, &func_str);
+    }
+    const uint64 fingerprint = FingerprintCat64(
+        Fingerprint64(func_str),
+        Fingerprint64(absl::StrCat(name, ":", flib.FindGradient(name))));
+    function_fingerprints.emplace(name, fingerprint);
+    return fingerprint;
+  };
+  const auto function_cache_key = [&](const FunctionDef& func,
+                                      bool allow_non_differentiable_rewrites) {
+    const string& func_name = func.signature().name();
+    uint64 key = FingerprintCat64(function_cache_base_key,
+                                  fingerprint_function(func_name));
+    key = FingerprintCat64(key, allow_non_differentiable_rewrites);
+    std::vector<string> reachable =
+        flib.ReachableDefinitions(func).ListFunctionNames();
+    std::sort(reachable.begin(), reachable.end());
+    for (const string& name : reachable) {
+      key = FingerprintCat64(key, fingerprint_function(name));
+    }
+    return key;
+  };
+  const auto replace_function = [&](const string& func_name,
+                                    const FunctionDef& optimized_func) {
+    function_fingerprints.erase(func_name);
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+  int num_cached_funcs = 0;
+
+  // State of the optimization of a single function body.
+  struct FunctionOptimization {
+    const FunctionDef* func;
+    bool allow_non_differentiable_rewrites;
+    uint64 cache_key = 0;
+    GrapplerFunctionItem func_item;
+    GraphDef optimized_func_graph;
+    Status status;
+  };
+
+  // Optimizes the body of `f.func` against the current function library,
+  // without modifying it. Safe to call concurrently.
+  const auto optimize_function = [&](FunctionOptimization& f) -> Status {
+    // Make a GrapplerItem from a FunctionDef.
+    GrapplerFunctionItem& func_item = f.func_item;
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(*f.func, flib, producer, &func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item.optimization_options().allow_non_differentiable_rewrites =
+        f.allow_non_differentiable_rewrites;
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item.devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, func_item,
+                                              &f.optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         &f.optimized_func_graph);
+  };
+
+  // Returns true if the optimization of `f` created a specialized function
+  // with the same name as, but a different body than, a function added to the
+  // library by another function optimized concurrently in the same pass.
+  const auto has_conflicting_functions =
+      [&](const FunctionOptimization& f,
+          const absl::flat_hash_set<string>& added_funcs) -> bool {
+    for (const FunctionDef& func_def :
+         f.optimized_func_graph.library().function()) {
+      const string& name = func_def.signature().name();
+      if (!added_funcs.contains(name)) continue;
+      const FunctionDef* existing = flib.Find(name);
+      if (existing != nullptr && !FunctionDefsEqual(*existing, func_def)) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Replaces `f.func` with its optimized body in the function library.
+  const auto add_optimized_function =
+      [&](FunctionOptimization& f,
+          absl::flat_hash_set<string>& added_funcs) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    FunctionDefLibrary cache_entry;
+    cache_entry.add_function();
+    for (const FunctionDef& func_def :
+         f.optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+        added_funcs.insert(func_def.signature().name());
+        if (use_function_cache) *cache_entry.add_function() = func_def;
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    f.func_item.SwapFunctionBody(std::move(f.optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(f.func_item, flib, &optimized_func));
+
+    if (use_function_cache) {
+      *cache_entry.mutable_function(0) = optimized_func;
+      OptimizedFunctionCache::Global()->Insert(f.cache_key, function_cache_dir,
+                                               cache_entry);
+    }
+
+    // Replace optimized function with a new FunctionDef.
+    return replace_function(f.func->signature().name(), optimized_func);
+  };
+
+  const int max_function_threads = NumFunctionOptimizationThreads(cfg_);
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    std::vector<std::unique_ptr<FunctionOptimization>> pending_funcs;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1201,78 +1540,94 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
+      const bool allow_non_differentiable_rewrites =
           !differentiable_functions.contains(func_name);
 
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+      // Reuse the optimized function body if the function was already
+      // optimized in the same context.
+      if (use_function_cache) {
+        FunctionDefLibrary cached;
+        if (OptimizedFunctionCache::Global()->Lookup(
+                function_cache_key(func, allow_non_differentiable_rewrites),
+                function_cache_dir, &cached)) {
+          VLOG(3) << "Reuse cached optimized function: function=" << func_name;
+          for (int i = 1; i < cached.function_size(); ++i) {
+            if (flib.Find(cached.function(i).signature().name()) == nullptr) {
+              TF_RETURN_IF_ERROR(flib.AddFunctionDef(cached.function(i)));
+            }
+          }
+          TF_RETURN_IF_ERROR(replace_function(func_name, cached.function(0)));
+          ++num_cached_funcs;
+          continue;
+        }
       }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
-      }
+      auto pending = std::make_unique<FunctionOptimization>();
+      pending->func = &func;
+      pending->allow_non_differentiable_rewrites =
+          allow_non_differentiable_rewrites;
+      pending_funcs.push_back(std::move(pending));
+    }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+    // Independent functions are optimized concurrently against the library as
+    // of the start of this pass, and are added back to it in library order, so
+    // that the optimized library doesn't depend on the thread schedule.
+    const int num_threads = std::min<int>(max_function_threads,
+                                          pending_funcs.size());
+    const bool optimize_concurrently = num_threads > 1;
+    if (optimize_concurrently) {
+      const size_t results_begin = optimization_results_.size();
+      for (auto& f : pending_funcs) {
+        if (use_function_cache) {
+          f->cache_key = function_cache_key(
+              *f->func, f->allow_non_differentiable_rewrites);
         }
       }
+      {
+        thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                                num_threads);
+        for (auto& f : pending_funcs) {
+          FunctionOptimization* func = f.get();
+          pool.Schedule([func, &optimize_function]() {
+            func->status = optimize_function(*func);
+          });
+        }
+      }
+      // Sort the optimization results of the functions in library order.
+      absl::flat_hash_map<string, int> func_order;
+      for (int i = 0; i < static_cast<int>(pending_funcs.size()); ++i) {
+        func_order.emplace(pending_funcs[i]->func->signature().name(), i);
+      }
+      std::stable_sort(optimization_results_.begin() + results_begin,
+                       optimization_results_.end(),
+                       [&](const GraphOptimizationResult& a,
+                           const GraphOptimizationResult& b) {
+                         return func_order[a.id] < func_order[b.id];
+                       });
+    }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+    absl::flat_hash_set<string> added_funcs;
+    for (auto& f : pending_funcs) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      // Specialized function names are only unique within the library the
+      // function was optimized against. On conflicts, optimize the function
+      // again against the current library.
+      if (!optimize_concurrently ||
+          (f->status.ok() && has_conflicting_functions(*f, added_funcs))) {
+        if (optimize_concurrently) {
+          VLOG(2) << "Reoptimize function with conflicting specializations: "
+                  << "function=" << f->func->signature().name();
+          f->func_item = GrapplerFunctionItem();
+          f->optimized_func_graph.Clear();
+        }
+        if (use_function_cache) {
+          f->cache_key = function_cache_key(
+              *f->func, f->allow_non_differentiable_rewrites);
+        }
+        f->status = optimize_function(*f);
+      }
+      TF_RETURN_IF_ERROR(f->status);
+      TF_RETURN_IF_ERROR(add_optimized_function(*f, added_funcs));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1306,8 +1661,9 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   }
 #endif
 
-  VLOG(1) << "Optimized " << optimized_funcs.size()
-          << " functions: " << absl::StrJoin(optimized_funcs, ", ");
+  VLOG(1) << "Optimized " << optimized_funcs.size() << " functions ("
+          << num_cached_funcs
+          << " from cache): " << absl::StrJoin(optimized_funcs, ", ");
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
   if (VLOG_IS_ON(1)) {
     DumpGraphDefToFile(
@@ -1357,6 +1713,8 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.horizontal_fusion() == RewriterConfig::ON ||
+         rewrite_cfg.decode_image_fusion() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
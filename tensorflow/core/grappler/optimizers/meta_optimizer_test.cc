@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -113,6 +115,8 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override {
     *optimized_graph = item.graph;
+    // Functions might be optimized concurrently.
+    mutex_lock l(mu_);
     if (optimization_options_) {
       optimization_options_->insert({item.id, item.optimization_options()});
     }
@@ -120,10 +124,12 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
   }
 
  private:
+  static mutex mu_;
   static gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
       optimization_options_;
 };
 
+mutex GrapplerItemPropertiesAccumulator::mu_(LINKER_INITIALIZED);
 gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
     GrapplerItemPropertiesAccumulator::optimization_options_;
 
@@ -703,6 +709,267 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
       optimization_options_my_mul_2->allow_non_differentiable_rewrites);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryReusesCachedFunctions) {
+  using test::function::NDef;
+
+  // We will record which GrapplerItems (main graph and graphs for each
+  // function) are optimized.
+  gtl::FlatMap<string, GrapplerItem::OptimizationOptions> optimization_options;
+  GrapplerItemPropertiesAccumulator::SetOptimizationOptions(
+      &optimization_options);
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.add_optimizers("GrapplerItemPropertiesAccumulator");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_function_optimization_cache(RewriterConfig::ON);
+
+  const auto make_function = [](const string& name, const string& op) {
+    return FunctionDefHelper::Create(
+        name, {"x:float", "y:float"}, {"z:float"}, {},
+        {{{"z"}, op, {"x", "y"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "z:z:0"}});
+  };
+  const auto make_item = [&](const string& cached_2_op) {
+    GrapplerItem item;
+    item.id = "main";
+    item.graph = test::function::GDef(
+        {NDef("x0", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+         NDef("x1", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+         NDef("z1", "Cached1", {"x0", "x1"}, {}, kDevice),
+         NDef("z2", "Cached2", {"x0", "x1"}, {}, kDevice)},
+        /*funcs=*/
+        {make_function("Cached1", "Mul"),
+         make_function("Cached2", cached_2_op)});
+    item.fetch = {"z1", "z2"};
+    return item;
+  };
+
+  // The first run optimizes both functions.
+  GraphDef output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, make_item("Mul"), &output));
+  EXPECT_EQ(optimization_options.size(), 3);
+  EXPECT_EQ(optimization_options.count("Cached1"), 1);
+  EXPECT_EQ(optimization_options.count("Cached2"), 1);
+
+  // Running again on the same graph reuses the optimized functions.
+  optimization_options.clear();
+  GraphDef cached_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, make_item("Mul"), &cached_output));
+  EXPECT_EQ(optimization_options.size(), 1);
+  EXPECT_EQ(optimization_options.count("main"), 1);
+  CompareGraphs(output, cached_output);
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  FunctionLibraryDefinition cached_flib(OpRegistry::Global(),
+                                        cached_output.library());
+  for (const string& name : {"Cached1", "Cached2"}) {
+    ASSERT_NE(cached_flib.Find(name), nullptr);
+    CompareFunctions(*flib.Find(name), *cached_flib.Find(name));
+  }
+
+  // Only the function that changed is optimized again.
+  optimization_options.clear();
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, make_item("Add"), &output));
+  EXPECT_EQ(optimization_options.size(), 2);
+  EXPECT_EQ(optimization_options.count("main"), 1);
+  EXPECT_EQ(optimization_options.count("Cached2"), 1);
+
+  GrapplerItemPropertiesAccumulator::ResetOptimizationOptions();
+}
+
+TEST_F(MetaOptimizerTest, FunctionCacheDependsOnCustomOptimizerParameters) {
+  using test::function::NDef;
+
+  gtl::FlatMap<string, GrapplerItem::OptimizationOptions> optimization_options;
+  GrapplerItemPropertiesAccumulator::SetOptimizationOptions(
+      &optimization_options);
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_function_optimization_cache(RewriterConfig::ON);
+  auto* custom_optimizer = rewriter_config.add_custom_optimizers();
+  custom_optimizer->set_name("GrapplerItemPropertiesAccumulator");
+  (*custom_optimizer->mutable_parameter_map())["mode"].set_s("first");
+
+  GrapplerItem item;
+  item.id = "main";
+  item.graph = test::function::GDef(
+      {NDef("x0", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("x1", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("z", "CachedWithParameters", {"x0", "x1"}, {}, kDevice)},
+      /*funcs=*/
+      {FunctionDefHelper::Create(
+          "CachedWithParameters", {"x:float", "y:float"}, {"z:float"}, {},
+          {{{"z"}, "Sub", {"x", "y"}, {{"T", DT_FLOAT}}}},
+          /*ret_def=*/
+          {{"z", "z:z:0"}})});
+  item.fetch = {"z"};
+
+  GraphDef output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_EQ(optimization_options.count("CachedWithParameters"), 1);
+
+  // The same parameters reuse the optimized function.
+  optimization_options.clear();
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_EQ(optimization_options.count("CachedWithParameters"), 0);
+
+  // Other parameters may optimize the function differently.
+  (*custom_optimizer->mutable_parameter_map())["mode"].set_s("second");
+  optimization_options.clear();
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &output));
+  EXPECT_EQ(optimization_options.count("CachedWithParameters"), 1);
+
+  GrapplerItemPropertiesAccumulator::ResetOptimizationOptions();
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  using test::function::NDef;
+
+  // Define a library of independent functions with redundant nodes.
+  constexpr int kNumFunctions = 8;
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  std::vector<string> fetch;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("MyFunc", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {{{"y"}, "Identity", {"x"}, {{"T", DT_FLOAT}}},
+         {{"z"}, "Mul", {"y:output:0", "y:output:0"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "z:z:0"}}));
+    nodes.push_back(NDef(absl::StrCat("call", i), name, {"x"}, {}, kDevice));
+    fetch.push_back(absl::StrCat("call", i));
+  }
+
+  GrapplerItem item;
+  item.id = "main";
+  item.graph = test::function::GDef(nodes, funcs);
+  item.fetch = fetch;
+
+  // Optimizing functions concurrently must produce the same library as
+  // optimizing them sequentially.
+  const auto optimize = [&](int num_threads, GraphDef* output) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_threads(num_threads);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, output));
+  };
+  GraphDef sequential_output;
+  optimize(1, &sequential_output);
+  GraphDef concurrent_output;
+  optimize(4, &concurrent_output);
+
+  CompareGraphs(sequential_output, concurrent_output);
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential_output.library());
+  FunctionLibraryDefinition concurrent_flib(OpRegistry::Global(),
+                                            concurrent_output.library());
+  EXPECT_EQ(sequential_flib.num_functions(), concurrent_flib.num_functions());
+  for (const string& name : sequential_flib.ListFunctionNames()) {
+    const FunctionDef* func = concurrent_flib.Find(name);
+    ASSERT_NE(func, nullptr) << name;
+    CompareFunctions(*sequential_flib.Find(name), *func);
+  }
+}
+
+// Records the largest number of graphs it was optimizing at the same time.
+class ConcurrencyTrackingOptimizer : public CustomGraphOptimizer {
+ public:
+  static void Reset() { max_concurrent_calls_ = 0; }
+  static int MaxConcurrentCalls() { return max_concurrent_calls_; }
+
+  ConcurrencyTrackingOptimizer() {}
+  string name() const override { return "concurrency_tracking_optimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    const int concurrent_calls = ++concurrent_calls_;
+    int max_concurrent_calls = max_concurrent_calls_;
+    while (concurrent_calls > max_concurrent_calls &&
+           !max_concurrent_calls_.compare_exchange_weak(max_concurrent_calls,
+                                                        concurrent_calls)) {
+    }
+    Env::Default()->SleepForMicroseconds(10000);
+    *optimized_graph = item.graph;
+    --concurrent_calls_;
+    return absl::OkStatus();
+  }
+
+ private:
+  static std::atomic<int> concurrent_calls_;
+  static std::atomic<int> max_concurrent_calls_;
+};
+
+std::atomic<int> ConcurrencyTrackingOptimizer::concurrent_calls_;
+std::atomic<int> ConcurrencyTrackingOptimizer::max_concurrent_calls_;
+
+REGISTER_GRAPH_OPTIMIZER(ConcurrencyTrackingOptimizer);
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibrarySequentiallyWithCustom) {
+  using test::function::NDef;
+
+  constexpr int kNumFunctions = 8;
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  std::vector<string> fetch;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("MyFunc", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {{{"z"}, "Identity", {"x"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "z:output:0"}}));
+    nodes.push_back(NDef(absl::StrCat("call", i), name, {"x"}, {}, kDevice));
+    fetch.push_back(absl::StrCat("call", i));
+  }
+
+  GrapplerItem item;
+  item.id = "main";
+  item.graph = test::function::GDef(nodes, funcs);
+  item.fetch = fetch;
+
+  // Custom optimizers need not be thread-safe, so unless the number of
+  // threads is set, functions are optimized one at a time.
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.add_custom_optimizers()->set_name(
+      "ConcurrencyTrackingOptimizer");
+
+  ConcurrencyTrackingOptimizer::Reset();
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(ConcurrencyTrackingOptimizer::MaxConcurrentCalls(), 1);
+}
+
 class SleepingOptimizer : public CustomGraphOptimizer {
  public:
   SleepingOptimizer() {}
@@ -24,7 +24,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -74,6 +79,9 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chains of elementwise ops (e.g. Mul + AddV2 + Tanh + Mul) on CPU, that don't
+// broadcast other than with scalars -> _FusedElementwise
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -92,6 +100,7 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -106,6 +115,9 @@ constexpr char kFill[] = "fill";
 
 constexpr int kMissingIndex = -1;
 
+// Maximum number of ops fused into a single _FusedElementwise node.
+constexpr int kMaxFusedElementwiseOps = 32;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status,
                            RewriterConfig::CpuLayout cpu_layout_conversion,
@@ -170,6 +182,16 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of elementwise ops that can be replaced with a _FusedElementwise.
+struct FusedElementwise {
+  // Fused nodes in topological order: the last one is the root of the chain.
+  std::vector<int> nodes;
+  // Inputs of the fused node, and attributes describing the ops to evaluate.
+  std::vector<string> args;
+  std::vector<string> fused_ops;
+  std::vector<int> operands;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -4665,6 +4687,197 @@ Status ReplaceSoftplusTanhAndMulWithMish(
   return absl::OkStatus();
 }
 
+// Returns true if the node is an elementwise op that _FusedElementwise can
+// evaluate.
+bool IsFusibleElementwise(const NodeDef& node) {
+  // Must be kept in sync with the ops supported by the kernel.
+  static const auto* const kFusibleOps = new absl::flat_hash_set<string>{
+      "Add", "AddV2", "Sub", "Mul", "Div", "RealDiv", "Maximum", "Minimum",
+      "SquaredDifference", "Neg", "Abs", "Square", "Sqrt", "Rsqrt", "Exp",
+      "Log", "Tanh", "Sigmoid", "Erf", "Inv", "Reciprocal", "Relu", "Relu6"};
+  if (!kFusibleOps->contains(node.op())) return false;
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE || dtype == DT_HALF ||
+         dtype == DT_BFLOAT16;
+}
+
+// Elementwise ops reading the output of a contraction or of a batch norm are
+// left to the fusions dedicated to them.
+bool ReadsFusibleContraction(const utils::MutableNodeView& node_view) {
+  for (const auto& fanin : node_view.GetRegularFanins()) {
+    const NodeDef* fanin_node = fanin.node_view()->node();
+    // Fused contractions left by a previous run of the remapper may still be
+    // extended with activations by the patterns above.
+    if (IsConvOrMatMul(*fanin_node) || IsBiasAdd(*fanin_node) ||
+        IsFusedBatchNorm(*fanin_node) ||
+        absl::StartsWith(fanin_node->op(), "_Fused") ||
+        absl::StartsWith(fanin_node->op(), "_Mkl")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsScalarShape(const TensorShapeProto& shape) {
+  return !shape.unknown_rank() && shape.dim_size() == 0;
+}
+
+// Finds the longest chain of elementwise ops on CPU ending at the node, whose
+// intermediate results are not used outside of the chain, and whose inputs are
+// either scalars or of the output shape (i.e. the chain doesn't broadcast).
+bool FindFusedElementwise(const RemapperContext& ctx, int node_index,
+                          const std::vector<bool>& invalidated_nodes,
+                          const std::vector<bool>& nodes_to_delete,
+                          FusedElementwise* matched) {
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root = root_view->node();
+  if (!IsFusibleElementwise(*root) || !NodeIsOnCpu(root) ||
+      HasControlFaninOrFanout(*root_view) ||
+      ReadsFusibleContraction(*root_view)) {
+    return false;
+  }
+  const std::vector<OpInfo::TensorProperties>& root_props =
+      ctx.graph_properties.GetOutputProperties(root->name());
+  if (root_props.empty() || root_props[0].shape().unknown_rank()) {
+    return false;
+  }
+  const TensorShapeProto& output_shape = root_props[0].shape();
+
+  const auto is_fusible = [&](const utils::MutableNodeView& node_view) {
+    const int index = node_view.node_index();
+    // Nodes added by previous remaps are never fused.
+    if (index >= static_cast<int>(invalidated_nodes.size()) ||
+        invalidated_nodes[index] ||
+        nodes_to_delete[index]) {
+      return false;
+    }
+    const NodeDef* node = node_view.node();
+    return IsFusibleElementwise(*node) && node->device() == root->device() &&
+           HaveSameDataType(node, root) && !IsInPreserveSet(ctx, node) &&
+           !HasControlFaninOrFanout(node_view) &&
+           !ReadsFusibleContraction(node_view);
+  };
+
+  // Grow the chain towards its inputs, absorbing the nodes all the fanouts of
+  // which are already part of it.
+  absl::flat_hash_set<int> chain = {node_index};
+  bool changed = true;
+  while (changed && static_cast<int>(chain.size()) < kMaxFusedElementwiseOps) {
+    changed = false;
+    for (int index : std::vector<int>(chain.begin(), chain.end())) {
+      for (const auto& fanin :
+           ctx.graph_view.GetNode(index)->GetRegularFanins()) {
+        const auto* fanin_view = fanin.node_view();
+        if (chain.contains(fanin_view->node_index()) || fanin.index() != 0 ||
+            !is_fusible(*fanin_view) ||
+            fanin_view->NumRegularFanouts() !=
+                fanin_view->GetRegularFanout(0).size()) {
+          continue;
+        }
+        const bool fanouts_in_chain = absl::c_all_of(
+            fanin_view->GetRegularFanout(0), [&](const auto& fanout) {
+              return chain.contains(fanout.node_index());
+            });
+        if (fanouts_in_chain &&
+            static_cast<int>(chain.size()) < kMaxFusedElementwiseOps) {
+          chain.insert(fanin_view->node_index());
+          changed = true;
+        }
+      }
+    }
+  }
+  if (chain.size() < 2) return false;
+
+  // Nodes are sorted topologically, and so are the ops of the chain.
+  matched->nodes.assign(chain.begin(), chain.end());
+  std::sort(matched->nodes.begin(), matched->nodes.end());
+
+  // Inputs of the chain, keyed by their node index and port.
+  std::map<std::pair<int, int>, int> args;
+  matched->args.clear();
+  for (int index : matched->nodes) {
+    const auto* node_view = ctx.graph_view.GetNode(index);
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto& fanin = node_view->GetRegularFanin(i);
+      const int fanin_index = fanin.node_view()->node_index();
+      if (chain.contains(fanin_index)) continue;
+      const std::pair<int, int> key(fanin_index, fanin.index());
+      if (args.count(key) > 0) continue;
+      const std::vector<OpInfo::TensorProperties>& props =
+          ctx.graph_properties.GetOutputProperties(
+              fanin.node_view()->node()->name());
+      if (fanin.index() >= static_cast<int>(props.size())) return false;
+      const TensorShapeProto& shape = props[fanin.index()].shape();
+      if (!IsScalarShape(shape) &&
+          !ShapesSymbolicallyEqual(shape, output_shape)) {
+        return false;
+      }
+      args[key] = matched->args.size();
+      matched->args.push_back(node_view->node()->input(i));
+    }
+  }
+
+  const int num_args = matched->args.size();
+  absl::flat_hash_map<int, int> values;
+  matched->fused_ops.clear();
+  matched->operands.clear();
+  for (int i = 0; i < static_cast<int>(matched->nodes.size()); ++i) {
+    const auto* node_view = ctx.graph_view.GetNode(matched->nodes[i]);
+    for (int j = 0; j < 2; ++j) {
+      if (j >= node_view->NumRegularFanins()) {
+        matched->operands.push_back(-1);
+        continue;
+      }
+      const auto& fanin = node_view->GetRegularFanin(j);
+      const int fanin_index = fanin.node_view()->node_index();
+      matched->operands.push_back(
+          chain.contains(fanin_index)
+              ? values.at(fanin_index)
+              : args.at(std::make_pair(fanin_index, fanin.index())));
+    }
+    matched->fused_ops.push_back(node_view->node()->op());
+    values[matched->nodes[i]] = num_args + i;
+  }
+  return true;
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.nodes.back());
+  VLOG(2) << "Fuse elementwise ops [" << absl::StrJoin(matched.fused_ops, ", ")
+          << "] into " << root.name() << " on device=" << root.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  for (const string& arg : matched.args) {
+    fused_op.add_input(arg);
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.fused_ops, &(*attr)["fused_ops"]);
+  SetAttrValue(matched.operands, &(*attr)["operands"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (int index : matched.nodes) {
+    if (index != matched.nodes.back()) (*nodes_to_delete)[index] = true;
+  }
+
+  return absl::OkStatus();
+}
+
 // Check if a node is a candidate to one of the patterns that require inferred
 // shapes:
 //   (1) Splitting FusedBatchNorm into primitives.
@@ -4809,17 +5022,28 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a FusedElementwise fusion.
+  const auto is_elementwise_fusion_candidate = [&]() -> bool {
+    if (!IsFusibleElementwise(*node_def) || !NodeIsOnCpu(node_def)) {
+      return false;
+    }
+    return absl::c_any_of(node_view->GetRegularFanins(), [](const auto& fanin) {
+      return IsFusibleElementwise(*fanin.node_view()->node());
+    });
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) || is_elementwise_fusion_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_elementwise_fusion_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -5189,6 +5413,18 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap chains of elementwise ops into the _FusedElementwise. This runs
+    // last so that the dedicated fusions above take precedence, and is left to
+    // XLA when auto clustering is on.
+    FusedElementwise fused_elementwise;
+    if (allow_non_differentiable_rewrites && !ctx.xla_auto_clustering_on &&
+        FindFusedElementwise(ctx, i, invalidated_nodes, nodes_to_delete,
+                             &fused_elementwise)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
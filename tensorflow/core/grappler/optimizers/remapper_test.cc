@@ -1767,6 +1767,103 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 64}));
+  // Tanh approximation of Gelu:
+  //   0.5 * x * (1 + tanh(0.797885 * (x + 0.044715 * x^3)))
+  auto cube = ops::Mul(s.WithOpName("cube"),
+                       ops::Mul(s.WithOpName("square"), x, x), x);
+  auto inner = ops::AddV2(
+      s.WithOpName("inner"), x,
+      ops::Mul(s.WithOpName("scaled_cube"),
+               ops::Const(s.WithOpName("c0"), 0.044715f), cube));
+  auto tanh = ops::Tanh(
+      s.WithOpName("tanh"),
+      ops::Mul(s.WithOpName("scaled_inner"),
+               ops::Const(s.WithOpName("c1"), 0.797885f), inner));
+  auto gelu = ops::Mul(
+      s.WithOpName("gelu"),
+      ops::Mul(s.WithOpName("half_x"), ops::Const(s.WithOpName("c2"), 0.5f),
+               x),
+      ops::AddV2(s.WithOpName("one_plus_tanh"),
+                 ops::Const(s.WithOpName("c3"), 1.0f), tanh));
+  auto fetch = ops::Identity(s.WithOpName("fetch"), gelu);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "tanh");
+    EXPECT_NE(node.name(), "square");
+    if (node.name() == "gelu") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.attr().at("num_args").i(), 5);
+      EXPECT_EQ(node.attr().at("fused_ops").list().s_size(), 9);
+      EXPECT_EQ(node.attr().at("operands").list().i_size(), 18);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DoNotFuseBroadcastingElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 64}));
+  auto y = Placeholder(s.WithOpName("y"), DT_FLOAT,
+                       ops::Placeholder::Shape({64}));
+  auto add = ops::AddV2(s.WithOpName("add"), x, y);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
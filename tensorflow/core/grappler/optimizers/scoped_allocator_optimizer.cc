@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -524,7 +528,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -889,12 +894,245 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Eliminates the copy of a ConcatV2 along the outer dimension by having the
+// producers of its inputs allocate their outputs as consecutive slices of a
+// ScopedAllocator backing tensor, which then is the concatenation.  The
+// ConcatV2 becomes a _ScopedAllocatorConcat that just outputs the backing
+// tensor with the shape of the concatenation.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool ConsolidatesNodes() const override { return false; }
+
+  // Returns non-OK if `concat` cannot be rewritten.  Otherwise populates
+  // *inputs with its data inputs, *input_shapes with their shapes and
+  // *output_shape with the shape of the concatenation.
+  Status AnalyzeConcat(ScopedAllocatorOptimizer* sa_opti, NodeDef* concat,
+                       DataType* dtype, std::vector<TensorShape>* input_shapes,
+                       std::vector<InputDesc>* inputs,
+                       TensorShape* output_shape) {
+    CHECK(graph_properties_);
+    NodeMap* node_map = sa_opti->node_map();
+    if (sa_opti->nodes_to_preserve().count(concat->name()) > 0) {
+      return errors::Aborted("Node ", concat->name(), " must be preserved");
+    }
+    // Another rewrite may have made the output of the concat a field of its
+    // backing tensor, which a _ScopedAllocatorConcat could not allocate.
+    if (HasNodeAttr(*concat, kScopedAllocatorAttrName)) {
+      return errors::Aborted("Output of ", concat->name(),
+                             " is allocated from a ScopedAllocator");
+    }
+    int num_inputs;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "N", &num_inputs));
+    TF_RETURN_IF_ERROR(GetNodeAttr(*concat, "T", dtype));
+    if (concat->input_size() <= num_inputs ||
+        IsControlInput(concat->input(num_inputs))) {
+      return errors::Internal("Node ", concat->name(), " lacks an axis input");
+    }
+    const int type_size = DataTypeSize(*dtype);
+    if (type_size == 0 || Allocator::kAllocatorAlignment % type_size != 0) {
+      return errors::Aborted("Type ", DataTypeString(*dtype),
+                             " does not evenly divide kAllocatorAlignment");
+    }
+
+    // The concatenation must be fully known and along the outer dimension,
+    // so that its inputs are laid out one after the other.
+    const std::vector<OpInfo::TensorProperties>& output_props =
+        graph_properties_->GetOutputProperties(concat->name());
+    if (output_props.size() != 1 ||
+        !TensorShape::IsValid(output_props[0].shape()) ||
+        output_props[0].shape().unknown_rank() ||
+        output_props[0].shape().dim_size() == 0) {
+      return errors::Aborted("Complete shape not known for ", concat->name());
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+    const NodeDef* axis_node = node_map->GetNode(concat->input(num_inputs));
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return errors::Aborted("Axis of ", concat->name(), " is not a Const");
+    }
+    Tensor axis_tensor;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*axis_node, "value", &axis_tensor));
+    if (axis_tensor.NumElements() != 1) {
+      return errors::Internal("Axis of ", concat->name(), " is not a scalar");
+    }
+    const int64_t axis = axis_tensor.dtype() == DT_INT32
+                             ? axis_tensor.flat<int32>()(0)
+                             : axis_tensor.flat<int64_t>()(0);
+    if (axis != 0 && axis != -output_shape->dims()) {
+      return errors::Aborted("Node ", concat->name(),
+                             " does not concatenate along axis 0");
+    }
+
+    // Every input but the last one must fill a whole number of alignment
+    // units, or ScopedAllocatorMgr::PopulateFields would pad between the
+    // fields.  So must the last one, for the backing tensor to hold exactly
+    // the concatenation.
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        graph_properties_->GetInputProperties(concat->name());
+    if (input_props.size() < static_cast<size_t>(num_inputs)) {
+      return errors::Aborted("Input shapes not known for ", concat->name());
+    }
+    absl::flat_hash_set<string> seen_inputs;
+    for (int i = 0; i < num_inputs; ++i) {
+      const OpInfo::TensorProperties& props = input_props[i];
+      if (props.dtype() != *dtype || !TensorShape::IsValid(props.shape()) ||
+          props.shape().unknown_rank()) {
+        return errors::Aborted("Complete shape not known for input ", i,
+                               " of ", concat->name());
+      }
+      TensorShape shape(props.shape());
+      const int64_t num_bytes = shape.num_elements() * type_size;
+      if (num_bytes == 0 || num_bytes % Allocator::kAllocatorAlignment != 0) {
+        return errors::Aborted("Input ", i, " of ", concat->name(), " has ",
+                               num_bytes, " bytes, which is not a multiple "
+                               "of kAllocatorAlignment");
+      }
+      input_shapes->push_back(std::move(shape));
+
+      int position = 0;
+      const string producer_name = ParseNodeName(concat->input(i), &position);
+      NodeDef* producer = node_map->GetNode(producer_name);
+      if (producer == nullptr || position < 0) {
+        return errors::Internal("Failed to find input ", i, " of ",
+                                concat->name());
+      }
+      // The producer must allocate its output with the AllocatorAttributes
+      // set by the executor, in the frame and on the device of the concat.
+      if (IsArg(*producer) || IsHostConstant(*producer) ||
+          IsPlaceholder(*producer) ||
+          IsVariable(*producer) || IsControlFlow(*producer) ||
+          absl::StartsWith(producer->op(), "_ScopedAllocator") ||
+          producer->device() != concat->device()) {
+        return errors::Aborted("Input ", producer->name(), " of ",
+                               concat->name(), " cannot be allocated from a "
+                               "ScopedAllocator");
+      }
+      // The output must not be read by anything but the concat, which would
+      // see it change if a consumer of the concat updates it in place.
+      if (!seen_inputs.insert(strings::StrCat(producer_name, ":", position))
+               .second) {
+        return errors::Aborted("Input ", concat->input(i), " of ",
+                               concat->name(), " is repeated");
+      }
+      for (const NodeDef* output : node_map->GetOutputs(producer_name)) {
+        if (output == concat) continue;
+        for (const string& output_input : output->input()) {
+          int output_position = 0;
+          if (ParseNodeName(output_input, &output_position) == producer_name &&
+              output_position == position) {
+            return errors::Aborted("Input ", concat->input(i), " of ",
+                                   concat->name(), " is also read by ",
+                                   output->name());
+          }
+        }
+      }
+      inputs->emplace_back(producer, position, concat);
+    }
+    TF_RETURN_IF_ERROR(CheckUsesAllocatorAttributes(*inputs));
+    return CheckExistingScopedAllocator(*inputs);
+  }
+
+  // Replaces `concat` by a _ScopedAllocatorConcat of the backing tensor of a
+  // new ScopedAllocator, which allocates the outputs of its inputs.
+  Status RewriteConcat(ScopedAllocatorOptimizer* sa_opti,
+                       int64_t invocation_count, GraphDef* graph,
+                       NodeDef* concat, DataType dtype,
+                       const std::vector<TensorShape>& input_shapes,
+                       const std::vector<InputDesc>& inputs,
+                       const TensorShape& output_shape) {
+    NodeMap* node_map = sa_opti->node_map();
+    const string& device_name = concat->device();
+    int sa_id = sa_opti->NewScopedAllocatorId(input_shapes.size());
+    string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, {concat}, device_name, dtype, sa_id, sa_name,
+        input_shapes, inputs, TensorShape({output_shape.num_elements()})));
+
+    string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id, "_",
+                                      invocation_count);
+    VLOG(2) << "Replacing " << concat->name() << " by " << sac_name;
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (const InputDesc& input : inputs) {
+      sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                              dtype);
+    }
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(device_name);
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", static_cast<int>(sac_inputs.size()));
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (const InputDesc& input : inputs) {
+      node_map->AddOutput(input.from_node_def->name(), sac_name);
+    }
+    for (const string& concat_input : concat->input()) {
+      if (IsControlInput(concat_input)) {
+        sac_node->add_input(concat_input);
+        node_map->AddOutput(NodeName(concat_input), sac_name);
+      }
+    }
+
+    // Copy the output node set since we'll be modifying the version
+    // maintained by NodeMap in the loop.
+    auto output_nodes = node_map->GetOutputs(concat->name());
+    for (NodeDef* n : output_nodes) {
+      for (int i = 0; i < n->input_size(); ++i) {
+        int position = 0;
+        if (ParseNodeName(n->input(i), &position) != concat->name()) continue;
+        *n->mutable_input(i) =
+            position == -1 ? strings::StrCat("^", sac_name) : sac_name;
+      }
+      node_map->UpdateInput(n->name(), concat->name(), sac_name);
+    }
+    node_map->RemoveInputs(concat->name());
+    concat->clear_input();
+    node_map->RemoveOutputs(concat->name());
+    RemoveNode(concat, graph, node_map);
+    return absl::OkStatus();
+  }
+
+  // Rewrites each of `ops` that allows it, and leaves the others alone.
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    for (NodeDef* concat : ops) {
+      DataType dtype;
+      std::vector<TensorShape> input_shapes;
+      std::vector<InputDesc> inputs;
+      TensorShape output_shape;
+      Status s = AnalyzeConcat(sa_opti, concat, &dtype, &input_shapes, &inputs,
+                               &output_shape);
+      if (!s.ok()) {
+        VLOG(1) << "Not rewriting " << concat->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(RewriteConcat(sa_opti, invocation_count, graph,
+                                       concat, dtype, input_shapes, inputs,
+                                       output_shape));
+      *applied = true;
+    }
+    return absl::OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -904,7 +1142,7 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = op_name == "ConcatV2" ? concat_rewriter : r;
     }
   }
 }
@@ -1110,6 +1348,15 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (!rewriter->ConsolidatesNodes()) {
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     it.second, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -1124,7 +1371,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
-                                         &op_name, invocation_count](Tree* t) {
+                                         &graph_properties, &op_name,
+                                         invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
@@ -1132,13 +1380,18 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
                 Status s = OrderNodeSet(&lg);
                 TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                for (const std::vector<NodeDef*>& bucket :
+                     SplitIntoBuckets(graph_properties, std::move(lg))) {
+                  if (bucket.size() <= 1) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name << " to "
+                          << bucket.size() << " nodes";
+                  s = rewriter->Rewrite(this, invocation_count, graph,
+                                        op_name, bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
@@ -1207,6 +1460,39 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return absl::OkStatus();
 }
 
+std::vector<std::vector<NodeDef*>> ScopedAllocatorOptimizer::SplitIntoBuckets(
+    const GraphProperties& graph_properties,
+    std::vector<NodeDef*> nodes) const {
+  std::vector<std::vector<NodeDef*>> buckets;
+  if (max_bucket_bytes_ <= 0) {
+    buckets.push_back(std::move(nodes));
+    return buckets;
+  }
+  int64_t bucket_bytes = 0;
+  for (NodeDef* node : nodes) {
+    // Nodes with unknown input sizes are left out by the rewriter anyway.
+    int64_t node_bytes = 0;
+    for (const OpInfo::TensorProperties& input :
+         graph_properties.GetInputProperties(node->name())) {
+      const PartialTensorShape shape(input.shape());
+      if (shape.IsFullyDefined()) {
+        node_bytes += shape.num_elements() * DataTypeSize(input.dtype());
+      }
+    }
+    if (buckets.empty() ||
+        (!buckets.back().empty() &&
+         bucket_bytes + node_bytes > max_bucket_bytes_)) {
+      buckets.emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets.back().push_back(node);
+    bucket_bytes += node_bytes;
+  }
+  VLOG(1) << "Split " << nodes.size() << " nodes into " << buckets.size()
+          << " buckets of at most " << max_bucket_bytes_ << " bytes";
+  return buckets;
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
@@ -72,6 +72,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   NodeMap* node_map() { return node_map_.get(); }
 
+  const std::unordered_set<string>& nodes_to_preserve() const {
+    return nodes_to_preserve_;
+  }
+
   const absl::flat_hash_set<string>& repeated_outputs() {
     return repeated_outputs_;
   }
@@ -93,6 +97,12 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if Rewrite replaces a group of parallel nodes by a single
+    // one, so that it only applies to groups of more than one node.
+    // Otherwise Rewrite is passed all the nodes of the op on a device and
+    // rewrites each of them on its own.
+    virtual bool ConsolidatesNodes() const { return true; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -107,7 +117,14 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Splits the ordered `nodes` into buckets of consecutive nodes whose inputs
+  // add up to at most max_bucket_bytes_, if set.
+  std::vector<std::vector<NodeDef*>> SplitIntoBuckets(
+      const GraphProperties& graph_properties,
+      std::vector<NodeDef*> nodes) const;
+
   RewriterConfig::Toggle opt_level_;
+  const int64_t max_bucket_bytes_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
   absl::flat_hash_map<string, Rewriter*> rewriters_;
@@ -267,6 +267,49 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph.
+  //
+  // a, b, and c are Const ops of shape [rows, 4].  s1 and s2 are Add ops, and
+  // n is a Neg op that is only built if extra_reader is true.
+  //
+  // If shape [rows, 4] is a whole number of alignment units, we expect s1 and
+  // s2 to be allocated from a new ScopedAllocator, and concat to become a
+  // _ScopedAllocatorConcat of its backing tensor.
+  /*
+        a    b    c
+         \  / \  /
+          s1   s2
+          | \  /
+         (n) concat
+               |
+               r
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int rows, bool extra_reader) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a = ops::Const<float>(s.WithOpName("a"), 1.0, {rows, 4});
+    Output b = ops::Const<float>(s.WithOpName("b"), 2.0, {rows, 4});
+    Output c = ops::Const<float>(s.WithOpName("c"), -7.0, {rows, 4});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    if (extra_reader) {
+      ops::Neg(s.WithOpName("n"), s1);
+    }
+    Output concat = ops::Concat(s.WithOpName("concat"), {s1, s2}, 0);
+    Output r = ops::Abs(s.WithOpName("r"), concat);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
+  // Returns the number of nodes of `graph` with op `op`.
+  int CountOps(const GraphDef& graph, const string& op) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == op) ++count;
+    }
+    return count;
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +326,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +341,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -414,6 +458,44 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, SplitsIntoBuckets) {
+  // Builds 5 parallel Abs ops on 2x2 float inputs, i.e. 16 bytes each.
+  GrapplerItem item;
+  Scope s = Scope::NewRootScope();
+  s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+  Output a =
+      ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+  Output b =
+      ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+  for (int i = 0; i < 5; ++i) {
+    Output sum = ops::Add(s.WithOpName(strings::StrCat("s", i)), a, b);
+    Output abs = ops::Abs(s.WithOpName(strings::StrCat("a", i)), sum);
+    ops::Reshape(s.WithOpName(strings::StrCat("r", i)), abs, {1, 4});
+  }
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  SetShapes(&item.graph);
+
+  const auto num_scoped_allocators = [&item](int64_t max_bucket_bytes) {
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("Abs");
+    opts.set_max_bucket_bytes(max_bucket_bytes);
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+    GraphDef optimized_graph;
+    TF_CHECK_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+    int count = 0;
+    for (const NodeDef& node : optimized_graph.node()) {
+      if (node.op() == "_ScopedAllocator") ++count;
+    }
+    return count;
+  };
+  EXPECT_EQ(num_scoped_allocators(0), 1);
+  // Buckets of 2, 2, and 1 ops, the last of which is left alone.
+  EXPECT_EQ(num_scoped_allocators(32), 2);
+  EXPECT_EQ(num_scoped_allocators(48), 2);
+  // Every bucket holds a single op.
+  EXPECT_EQ(num_scoped_allocators(16), 0);
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Builds the same graph as UnaryRewriteOnly but also executes it and
   // validates the output.
@@ -596,6 +678,67 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewrite) {
+  // Inputs of shape [4, 4] are 64 bytes each, which leaves no padding between
+  // them in the backing tensor.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*rows=*/4, /*extra_reader=*/false);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  EXPECT_EQ(CountOps(optimized_graph, "ConcatV2"), 0);
+  EXPECT_EQ(CountOps(optimized_graph, "_ScopedAllocator"), 1);
+  NodeMap node_map(&optimized_graph);
+  ValidateSAControlInput(&optimized_graph, &node_map, "s1");
+  ValidateSAControlInput(&optimized_graph, &node_map, "s2");
+  NodeDef* r = nullptr;
+  GetNode(&node_map, "r", &r);
+  NodeDef* sac = nullptr;
+  GetNode(&node_map, NodeName(r->input(0)), &sac);
+  EXPECT_EQ(sac->op(), "_ScopedAllocatorConcat");
+  EXPECT_TRUE(sac->attr().at("reshape").b());
+  EXPECT_EQ(TensorShape(sac->attr().at("shape").shape()),
+            TensorShape({8, 4}));
+  ASSERT_EQ(sac->input_size(), 3);
+  EXPECT_EQ(sac->input(1), "s1");
+  EXPECT_EQ(sac->input(2), "s2");
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatNotRewritten) {
+  const auto num_concats = [this](int rows, bool extra_reader) {
+    GrapplerItem item;
+    BuildConcatGraph(&item.graph, rows, extra_reader);
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("ConcatV2");
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+    GraphDef optimized_graph;
+    TF_CHECK_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+    EXPECT_EQ(CountOps(optimized_graph, "_ScopedAllocator"), 0);
+    return CountOps(optimized_graph, "ConcatV2");
+  };
+  // Inputs of shape [2, 4] are 32 bytes each, which would leave padding
+  // between them in the backing tensor.
+  EXPECT_EQ(num_concats(/*rows=*/2, /*extra_reader=*/false), 1);
+  // s1 is also read by n, which may see it change if r works in place.
+  EXPECT_EQ(num_concats(/*rows=*/4, /*extra_reader=*/true), 1);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*rows=*/4, /*extra_reader=*/false);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"r:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  // a + b == 3, |b + c| == 5
+  std::vector<float> expected(16, 3.0);
+  expected.resize(32, 5.0);
+  ValidateValues(outputs, {expected});
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
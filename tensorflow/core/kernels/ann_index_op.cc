@@ -0,0 +1,441 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// An approximate nearest neighbor index of float embeddings of `dim`
+// elements, keyed by int64 ids, for the retrieval of the embeddings with the
+// highest dot product with, or the smallest L2 distance to, a batch of
+// queries. It is an inverted file index: the embeddings are clustered with
+// k-means into `num_lists` lists, and a query only scans the lists of its
+// `num_probes` closest centroids.
+//
+// As a lookup table, the index is filled with LookupTableInsertV2, finds the
+// embeddings of ids with LookupTableFindV2, and is saved and restored with
+// LookupTableExportV2 and LookupTableImportV2, as mutable hash tables are. The
+// lists are built by the first search after enough embeddings were inserted;
+// the embeddings inserted since are scanned by every search, until the lists
+// are rebuilt once they are more than an eighth of the index.
+class AnnIndex final : public LookupInterface {
+ public:
+  // Indexes with fewer embeddings are searched exhaustively.
+  static constexpr int64_t kMinIndexedRows = 4096;
+  // The number of k-means training embeddings per list.
+  static constexpr int64_t kTrainingRowsPerList = 64;
+  static constexpr int kNumKMeansIterations = 8;
+
+  AnnIndex(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "dim", &dim_));
+    string metric;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "metric", &metric));
+    dot_ = metric == "dot";
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_lists", &num_lists_));
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "num_probes", &num_probes_));
+  }
+
+  AnnIndex* GetAnnIndex() override { return this; }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return ids_.size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& keys, Tensor* values,
+              const Tensor& default_value) override {
+    const auto keys_flat = keys.flat<int64_t>();
+    float* values_data = values->flat<float>().data();
+    const float* default_data = default_value.flat<float>().data();
+    const bool use_default_per_key = default_value.NumElements() > dim_;
+    tf_shared_lock l(mu_);
+    for (int64_t i = 0; i < keys_flat.size(); ++i) {
+      auto it = rows_.find(keys_flat(i));
+      const float* value =
+          it != rows_.end() ? &embeddings_[it->second * dim_]
+          : use_default_per_key ? default_data + i * dim_
+                                : default_data;
+      std::copy(value, value + dim_, values_data + i * dim_);
+    }
+    return absl::OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    mutex_lock l(mu_);
+    InsertLocked(keys, values);
+    return absl::OkStatus();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("AnnIndex does not support removing ids");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    tf_shared_lock l(mu_);
+    const int64_t size = ids_.size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size, dim_}), &values));
+    std::copy(ids_.begin(), ids_.end(), keys->flat<int64_t>().data());
+    std::copy(embeddings_.begin(), embeddings_.end(),
+              values->flat<float>().data());
+    return absl::OkStatus();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    mutex_lock l(mu_);
+    ids_.clear();
+    embeddings_.clear();
+    rows_.clear();
+    list_offsets_.clear();
+    centroids_.clear();
+    num_indexed_rows_ = 0;
+    num_updated_rows_ = 0;
+    InsertLocked(keys, values);
+    return absl::OkStatus();
+  }
+
+  DataType key_dtype() const override { return DT_INT64; }
+  DataType value_dtype() const override { return DT_FLOAT; }
+  TensorShape key_shape() const override { return TensorShape(); }
+  TensorShape value_shape() const override { return TensorShape({dim_}); }
+
+  int64_t MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(AnnIndex) +
+           (embeddings_.capacity() + centroids_.capacity()) * sizeof(float) +
+           (ids_.capacity() + list_offsets_.capacity()) * sizeof(int64_t) +
+           rows_.capacity() * sizeof(std::pair<int64_t, int64_t>);
+  }
+
+  // Writes the ids and scores of the `k` embeddings with the highest scores
+  // for each of the `queries`, from the highest score, into `ids` and
+  // `scores`. The score is the dot product with the query, or the opposite of
+  // the squared L2 distance to it. Missing neighbors have id -1 and score
+  // -infinity.
+  Status Search(OpKernelContext* ctx, const Tensor& queries, int64_t k,
+                Tensor* ids, Tensor* scores) {
+    if (queries.dim_size(1) != dim_) {
+      return errors::InvalidArgument("Expected queries of ", dim_,
+                                     " elements, got shape ",
+                                     queries.shape().DebugString());
+    }
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    bool needs_build;
+    {
+      tf_shared_lock l(mu_);
+      needs_build = NeedsBuildLocked();
+    }
+    if (needs_build) {
+      mutex_lock l(mu_);
+      // Another search may have built the lists in the meantime.
+      if (NeedsBuildLocked()) BuildListsLocked(worker_threads);
+    }
+
+    tf_shared_lock l(mu_);
+    // The shards read the index through these, under the lock of the caller.
+    const float* embeddings = embeddings_.data();
+    const int64_t* row_ids = ids_.data();
+    const int64_t* list_offsets = list_offsets_.data();
+    const float* centroids = centroids_.data();
+    const int64_t num_rows = ids_.size();
+    const int64_t num_indexed_rows = num_indexed_rows_;
+    const int64_t num_lists =
+        list_offsets_.empty() ? 0 : centroids_.size() / dim_;
+    const int64_t num_probes = std::min(num_probes_, num_lists);
+    const float* queries_data = queries.flat<float>().data();
+    int64_t* ids_data = ids->flat<int64_t>().data();
+    float* scores_data = scores->flat<float>().data();
+    auto search = [&](int64_t begin, int64_t end) {
+      for (int64_t q = begin; q < end; ++q) {
+        const float* query = queries_data + q * dim_;
+        gtl::TopN<std::pair<float, int64_t>, HigherScore> top_rows(k);
+        if (num_probes > 0) {
+          gtl::TopN<std::pair<float, int64_t>, HigherScore> top_lists(
+              num_probes);
+          for (int64_t list = 0; list < num_lists; ++list) {
+            top_lists.push({Score(query, centroids + list * dim_), list});
+          }
+          for (auto it = top_lists.unsorted_begin();
+               it != top_lists.unsorted_end(); ++it) {
+            ScanRows(query, embeddings, list_offsets[it->second],
+                     list_offsets[it->second + 1], &top_rows);
+          }
+        }
+        ScanRows(query, embeddings, num_indexed_rows, num_rows, &top_rows);
+
+        std::unique_ptr<std::vector<std::pair<float, int64_t>>> top(
+            top_rows.Extract());
+        for (int64_t i = 0; i < k; ++i) {
+          const bool found = i < static_cast<int64_t>(top->size());
+          ids_data[q * k + i] = found ? row_ids[(*top)[i].second] : -1;
+          scores_data[q * k + i] =
+              found ? (*top)[i].first : -std::numeric_limits<float>::infinity();
+        }
+      }
+    };
+    const int64_t num_scanned_rows =
+        num_lists == 0 ? num_rows
+                       : num_lists + (num_rows - num_indexed_rows) +
+                             num_indexed_rows * num_probes / num_lists;
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          queries.dim_size(0), std::max<int64_t>(1, num_scanned_rows * dim_),
+          search);
+    return absl::OkStatus();
+  }
+
+ private:
+  // Orders the (score, row) pairs by decreasing score, then by row.
+  struct HigherScore {
+    bool operator()(const std::pair<float, int64_t>& a,
+                    const std::pair<float, int64_t>& b) const {
+      if (a.first != b.first) return a.first > b.first;
+      return a.second < b.second;
+    }
+  };
+
+  // Returns the score of `embedding` for `query`, with Eigen's vectorized
+  // reductions.
+  float Score(const float* query, const float* embedding) const {
+    Eigen::Map<const Eigen::VectorXf> q(query, dim_);
+    Eigen::Map<const Eigen::VectorXf> e(embedding, dim_);
+    return dot_ ? q.dot(e) : -(q - e).squaredNorm();
+  }
+
+  // Returns the list of the centroid with the highest score for `embedding`.
+  int64_t NearestList(const float* embedding,
+                      const std::vector<float>& centroids) const {
+    int64_t nearest = 0;
+    float best_score = -std::numeric_limits<float>::infinity();
+    const int64_t num_lists = centroids.size() / dim_;
+    for (int64_t list = 0; list < num_lists; ++list) {
+      const float score = Score(embedding, &centroids[list * dim_]);
+      if (score > best_score) {
+        best_score = score;
+        nearest = list;
+      }
+    }
+    return nearest;
+  }
+
+  // Pushes the rows [begin, end) of `embeddings` into `top_rows`.
+  void ScanRows(
+      const float* query, const float* embeddings, int64_t begin, int64_t end,
+      gtl::TopN<std::pair<float, int64_t>, HigherScore>* top_rows) const {
+    for (int64_t row = begin; row < end; ++row) {
+      top_rows->push({Score(query, embeddings + row * dim_), row});
+    }
+  }
+
+  void InsertLocked(const Tensor& keys, const Tensor& values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto keys_flat = keys.flat<int64_t>();
+    const float* values_data = values.flat<float>().data();
+    for (int64_t i = 0; i < keys_flat.size(); ++i) {
+      const float* value = values_data + i * dim_;
+      auto [it, inserted] = rows_.try_emplace(keys_flat(i), ids_.size());
+      if (inserted) {
+        ids_.push_back(keys_flat(i));
+        embeddings_.insert(embeddings_.end(), value, value + dim_);
+      } else {
+        // The updated embedding stays in its list until the next build.
+        std::copy(value, value + dim_, &embeddings_[it->second * dim_]);
+        if (it->second < num_indexed_rows_) ++num_updated_rows_;
+      }
+    }
+  }
+
+  // Returns whether the lists must be built, when they hold less than 8/9 of
+  // the embeddings of an index large enough.
+  bool NeedsBuildLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    const int64_t num_rows = ids_.size();
+    const int64_t num_unindexed_rows =
+        num_rows - num_indexed_rows_ + num_updated_rows_;
+    return num_rows >= kMinIndexedRows &&
+           num_unindexed_rows > num_indexed_rows_ / 8;
+  }
+
+  // Clusters the embeddings with k-means, trained on an evenly spaced sample
+  // of them, and sorts the embeddings by list.
+  void BuildListsLocked(const DeviceBase::CpuWorkerThreads& worker_threads)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t num_rows = ids_.size();
+    const int64_t num_lists =
+        std::min(num_lists_ > 0 ? num_lists_
+                                : static_cast<int64_t>(std::sqrt(num_rows)),
+                 num_rows);
+    const int64_t num_samples =
+        std::min(num_rows, num_lists * kTrainingRowsPerList);
+    std::vector<float> centroids(num_lists * dim_);
+    for (int64_t list = 0; list < num_lists; ++list) {
+      const int64_t row = list * num_rows / num_lists;
+      std::copy_n(&embeddings_[row * dim_], dim_, &centroids[list * dim_]);
+    }
+    // The shards read the embeddings through `data`, under the lock of the
+    // caller.
+    const float* data = embeddings_.data();
+    std::vector<int64_t> assignments(num_rows);
+    auto assign = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        assignments[i] = NearestList(data + i * dim_, centroids);
+      }
+    };
+    const int64_t assign_cost = num_lists * dim_;
+    for (int iteration = 0; iteration < kNumKMeansIterations; ++iteration) {
+      // The samples are the first `num_samples` of the evenly spaced rows.
+      auto assign_samples = [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          assignments[i] = NearestList(
+              data + i * num_rows / num_samples * dim_, centroids);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_samples,
+            assign_cost, assign_samples);
+      std::vector<double> sums(num_lists * dim_, 0.0);
+      std::vector<int64_t> counts(num_lists, 0);
+      for (int64_t i = 0; i < num_samples; ++i) {
+        const float* embedding =
+            &embeddings_[i * num_rows / num_samples * dim_];
+        double* sum = &sums[assignments[i] * dim_];
+        for (int64_t j = 0; j < dim_; ++j) sum[j] += embedding[j];
+        ++counts[assignments[i]];
+      }
+      for (int64_t list = 0; list < num_lists; ++list) {
+        // Empty lists keep their centroid.
+        if (counts[list] == 0) continue;
+        for (int64_t j = 0; j < dim_; ++j) {
+          centroids[list * dim_ + j] = sums[list * dim_ + j] / counts[list];
+        }
+      }
+    }
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          assign_cost, assign);
+
+    // Sorts the rows by list, with a counting sort.
+    std::vector<int64_t> list_offsets(num_lists + 1, 0);
+    for (int64_t list : assignments) ++list_offsets[list + 1];
+    for (int64_t list = 0; list < num_lists; ++list) {
+      list_offsets[list + 1] += list_offsets[list];
+    }
+    std::vector<int64_t> positions(list_offsets.begin(),
+                                   list_offsets.end() - 1);
+    std::vector<int64_t> ids(num_rows);
+    std::vector<float> embeddings(num_rows * dim_);
+    for (int64_t row = 0; row < num_rows; ++row) {
+      const int64_t position = positions[assignments[row]]++;
+      ids[position] = ids_[row];
+      std::copy_n(&embeddings_[row * dim_], dim_, &embeddings[position * dim_]);
+      rows_[ids_[row]] = position;
+    }
+    ids_ = std::move(ids);
+    embeddings_ = std::move(embeddings);
+    centroids_ = std::move(centroids);
+    list_offsets_ = std::move(list_offsets);
+    num_indexed_rows_ = num_rows;
+    num_updated_rows_ = 0;
+    VLOG(1) << "Built an ANN index of " << num_rows << " embeddings in "
+            << num_lists << " lists";
+  }
+
+  int64_t dim_;
+  bool dot_;
+  int64_t num_lists_;
+  int64_t num_probes_;
+
+  mutable mutex mu_;
+  // The ids and embeddings of the rows of the index, whose first
+  // `num_indexed_rows_` are sorted by list.
+  std::vector<int64_t> ids_ TF_GUARDED_BY(mu_);
+  std::vector<float> embeddings_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, int64_t> rows_ TF_GUARDED_BY(mu_);
+  // The rows of list i are [list_offsets_[i], list_offsets_[i + 1]).
+  std::vector<int64_t> list_offsets_ TF_GUARDED_BY(mu_);
+  std::vector<float> centroids_ TF_GUARDED_BY(mu_);
+  int64_t num_indexed_rows_ TF_GUARDED_BY(mu_) = 0;
+  // The number of indexed rows whose embedding was updated since the build.
+  int64_t num_updated_rows_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace lookup
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndex").Device(DEVICE_CPU),
+                        LookupTableOp<lookup::AnnIndex, int64_t, float>);
+
+class AnnIndexSearchOp : public OpKernel {
+ public:
+  explicit AnnIndexSearchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("k", &k_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::LookupInterface* table;
+    OP_REQUIRES_OK(ctx,
+                   lookup::GetLookupTable("table_handle", ctx, &table));
+    core::ScopedUnref unref_me(table);
+    lookup::AnnIndex* index = table->GetAnnIndex();
+    OP_REQUIRES(ctx, index != nullptr,
+                errors::InvalidArgument("Table is not an AnnIndex"));
+
+    const Tensor& queries = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(queries.shape()),
+                errors::InvalidArgument("queries must be a matrix, got shape ",
+                                        queries.shape().DebugString()));
+    const TensorShape output_shape({queries.dim_size(0), k_});
+    Tensor* ids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output("ids", output_shape, &ids));
+    Tensor* scores;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output("scores", output_shape, &scores));
+    OP_REQUIRES_OK(ctx, index->Search(ctx, queries, k_, ids, scores));
+  }
+
+ private:
+  int64_t k_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexSearch").Device(DEVICE_CPU),
+                        AnnIndexSearchOp);
+
+}  // namespace tensorflow
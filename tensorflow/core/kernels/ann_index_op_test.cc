@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/lookup_ops.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace ops {
+namespace {
+
+constexpr int kDim = 8;
+
+// Returns `num_rows` pseudo-random embeddings of kDim elements.
+Tensor MakeEmbeddings(int64_t num_rows) {
+  Tensor embeddings(DT_FLOAT, TensorShape({num_rows, kDim}));
+  auto flat = embeddings.flat<float>();
+  uint32_t state = 1;
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    state = state * 1664525u + 1013904223u;
+    flat(i) = static_cast<float>(state >> 8) / (1 << 24) - 0.5f;
+  }
+  return embeddings;
+}
+
+Tensor MakeIds(int64_t num_rows) {
+  Tensor ids(DT_INT64, TensorShape({num_rows}));
+  for (int64_t i = 0; i < num_rows; ++i) ids.flat<int64_t>()(i) = 100 + i;
+  return ids;
+}
+
+TEST(AnnIndexOpTest, SearchesSmallIndexExhaustively) {
+  Scope root = Scope::NewRootScope();
+  auto index = AnnIndex(root, 2);
+  auto insert = LookupTableInsertV2(
+      root, index, Const<int64_t>(root, {1, 2, 3}),
+      Const<float>(root, {{1.0f, 0.0f}, {0.0f, 2.0f}, {3.0f, 3.0f}}));
+  auto search = AnnIndexSearch(
+      root, index, Const<float>(root, {{1.0f, 0.0f}, {0.0f, -1.0f}}), 4);
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run({}, {}, {insert}, &outputs));
+  TF_ASSERT_OK(session.Run({search.ids, search.scores}, &outputs));
+  const float inf = std::numeric_limits<float>::infinity();
+  test::ExpectTensorEqual<int64_t>(
+      outputs[0], test::AsTensor<int64_t>({3, 1, 2, -1, 1, 2, 3, -1},
+                                          TensorShape({2, 4})));
+  test::ExpectTensorEqual<float>(
+      outputs[1],
+      test::AsTensor<float>({3.0f, 1.0f, 0.0f, -inf, 0.0f, -2.0f, -3.0f, -inf},
+                            TensorShape({2, 4})));
+}
+
+TEST(AnnIndexOpTest, FindsIndexedEmbeddings) {
+  constexpr int64_t kNumRows = 10000;
+  Scope root = Scope::NewRootScope();
+  auto index = AnnIndex(root, kDim, AnnIndex::Metric("l2").NumProbes(1));
+  const Tensor embeddings = MakeEmbeddings(kNumRows);
+  auto insert = LookupTableInsertV2(root, index, Const(root, MakeIds(kNumRows)),
+                                    Const(root, embeddings));
+  // The embeddings of every 100th id, which are their own nearest neighbors.
+  Tensor queries(DT_FLOAT, TensorShape({kNumRows / 100, kDim}));
+  for (int64_t i = 0; i < kNumRows / 100; ++i) {
+    for (int j = 0; j < kDim; ++j) {
+      queries.matrix<float>()(i, j) = embeddings.matrix<float>()(i * 100, j);
+    }
+  }
+  auto search = AnnIndexSearch(root, index, Const(root, queries), 1);
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run({}, {}, {insert}, &outputs));
+  TF_ASSERT_OK(session.Run({search.ids, search.scores}, &outputs));
+  for (int64_t i = 0; i < kNumRows / 100; ++i) {
+    EXPECT_EQ(outputs[0].matrix<int64_t>()(i, 0), 100 + i * 100);
+    EXPECT_EQ(outputs[1].matrix<float>()(i, 0), 0.0f);
+  }
+}
+
+TEST(AnnIndexOpTest, ExportsAndImports) {
+  constexpr int64_t kNumRows = 5000;
+  Scope root = Scope::NewRootScope();
+  // Probes all the lists, for the searches to be exact.
+  const auto attrs = AnnIndex::NumProbes(1000);
+  auto index = AnnIndex(root, kDim, attrs);
+  auto insert = LookupTableInsertV2(root, index, Const(root, MakeIds(kNumRows)),
+                                    Const(root, MakeEmbeddings(kNumRows)));
+  auto search =
+      AnnIndexSearch(root, index, Const(root, MakeEmbeddings(16)), 10);
+  auto exported = LookupTableExportV2(root, index, DT_INT64, DT_FLOAT);
+  auto restored = AnnIndex(root, kDim, attrs);
+  auto import =
+      LookupTableImportV2(root, restored, exported.keys, exported.values);
+  auto restored_search =
+      AnnIndexSearch(root, restored, Const(root, MakeEmbeddings(16)), 10);
+  auto find = LookupTableFindV2(root, restored, Const<int64_t>(root, {104, 7}),
+                                Const<float>(root, 0.0f, {kDim}));
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run({}, {}, {insert}, &outputs));
+  TF_ASSERT_OK(session.Run({search.ids, search.scores}, &outputs));
+  std::vector<Tensor> restored_outputs;
+  TF_ASSERT_OK(session.Run({}, {}, {import}, &restored_outputs));
+  TF_ASSERT_OK(session.Run({restored_search.ids, restored_search.scores, find},
+                           &restored_outputs));
+  test::ExpectTensorEqual<int64_t>(outputs[0], restored_outputs[0]);
+  test::ExpectTensorEqual<float>(outputs[1], restored_outputs[1]);
+
+  const Tensor embeddings = MakeEmbeddings(kNumRows);
+  for (int j = 0; j < kDim; ++j) {
+    EXPECT_EQ(restored_outputs[2].matrix<float>()(0, j),
+              embeddings.matrix<float>()(4, j));
+    EXPECT_EQ(restored_outputs[2].matrix<float>()(1, j), 0.0f);
+  }
+}
+
+}  // namespace
+}  // namespace ops
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batch_kernel_test_util.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -33,15 +34,24 @@ bool BatchFunctionKernelTestAccess::enable_adaptive_batch_threads() const {
   return kernel_->enable_adaptive_batch_threads_;
 }
 
-Status BatchFunctionKernelTestBase::Init(bool enable_adaptive_scheduler) {
+int64_t BatchFunctionKernelTestAccess::target_p99_latency_micros() const {
+  if (!kernel_->adaptive_batch_scheduler_options_.has_value()) return 0;
+  return kernel_->adaptive_batch_scheduler_options_->target_p99_latency_micros;
+}
+
+Status BatchFunctionKernelTestBase::Init(bool enable_adaptive_scheduler,
+                                         int64_t target_p99_latency_micros) {
   std::vector<DataType> input_dtypes({DataType::DT_INT64, DataType::DT_INT64});
   std::vector<NodeDefBuilder::NodeOut> inputs(
       {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64}),
        NodeDefBuilder::NodeOut({"n2", 1, DataType::DT_INT64})});
   NameAttrList f;
   f.set_name("func_to_batch");
-  TF_CHECK_OK(NodeDefBuilder("BatchTPUInput", "BatchFunction")
-                  .Attr("max_batch_size", 32)
+  NodeDefBuilder builder("BatchTPUInput", "BatchFunction");
+  if (target_p99_latency_micros > 0) {
+    builder.Attr("_target_p99_latency_micros", target_p99_latency_micros);
+  }
+  TF_CHECK_OK(builder.Attr("max_batch_size", 32)
                   .Attr("num_batch_threads", enable_adaptive_scheduler ? 0 : 8)
                   .Attr("allowed_batch_sizes", {2, 4, 8})
                   .Attr("batch_timeout_micros", 1000)
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCH_KERNEL_TEST_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_BATCH_KERNEL_TEST_UTIL_H_
 
+#include <cstdint>
+
 #include <gtest/gtest.h>
 #include "tensorflow/core/kernels/batch_kernels.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -31,6 +33,9 @@ class BatchFunctionKernelTestAccess {
 
   bool enable_adaptive_batch_threads() const;
 
+  // Zero if the adaptive batch scheduler is disabled.
+  int64_t target_p99_latency_micros() const;
+
  private:
   const BatchFunctionKernel* const kernel_;
 };
@@ -38,8 +43,10 @@ class BatchFunctionKernelTestAccess {
 class BatchFunctionKernelTestBase : public OpsTestBase,
                                     public ::testing::WithParamInterface<bool> {
  public:
-  // Init test fixture with a batch kernel instance.
-  Status Init(bool enable_adaptive_scheduler);
+  // Init test fixture with a batch kernel instance. A positive
+  // `target_p99_latency_micros` is set as the corresponding attribute.
+  Status Init(bool enable_adaptive_scheduler,
+              int64_t target_p99_latency_micros = 0);
 };
 
 }  // namespace test_util
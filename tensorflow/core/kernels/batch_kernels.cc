@@ -64,6 +64,7 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kTargetP99LatencyMicrosAttr[] = "_target_p99_latency_micros";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -217,6 +218,7 @@ class BatchResource : public serving::BatchResourceBase {
       int32_t max_batch_size, int32_t batch_timeout_micros,
       int32_t max_enqueued_batches,
       const std::vector<int32>& allowed_batch_sizes,
+      int64_t target_p99_latency_micros,
       std::unique_ptr<BatchResource>* resource) {
     std::shared_ptr<AdaptiveBatcherT> batcher;
     TF_RETURN_IF_ERROR(AdaptiveBatcherT::Create(
@@ -227,7 +229,7 @@ class BatchResource : public serving::BatchResourceBase {
         GetAdaptiveBatcherQueueOptions(
             max_batch_size, batch_timeout_micros, max_enqueued_batches,
             /*enable_large_batch_splitting=*/true, allowed_batch_sizes,
-            /*disable_padding=*/false),
+            /*disable_padding=*/false, target_p99_latency_micros),
         allowed_batch_sizes));
     return absl::OkStatus();
   }
@@ -416,6 +418,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           /*has_process_batch_function=*/true,
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
+          adaptive_batch_scheduler_options_->target_p99_latency_micros,
           &new_resource));
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
@@ -623,6 +626,15 @@ void BatchFunctionKernel::SetAdaptiveBatchSchedulerOptions(
                                  &options.full_batch_scheduling_boost_micros));
   }
 
+  if (c->HasAttr(kTargetP99LatencyMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kTargetP99LatencyMicrosAttr,
+                                 &options.target_p99_latency_micros));
+    OP_REQUIRES(c, options.target_p99_latency_micros >= 0,
+                errors::InvalidArgument(kTargetP99LatencyMicrosAttr,
+                                        " must be non-negative, got ",
+                                        options.target_p99_latency_micros));
+  }
+
   // At this point, the batch kernel is configured to use adaptive scheduling.
   // To validate or return error at kernel construction time, invokes
   // `GetOrCreateBatchThreadsPool` and validates returned `thread_pool` is
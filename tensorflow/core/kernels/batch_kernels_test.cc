@@ -66,6 +66,20 @@ TEST_P(BatchFunctionKernelTest, EnableAdaptiveScheduler) {
                 .enable_adaptive_batch_threads());
 }
 
+TEST_P(BatchFunctionKernelTest, TargetP99LatencyMicros) {
+  const bool adaptive_scheduler_enabled = GetParam();
+
+  TF_EXPECT_OK(Init(adaptive_scheduler_enabled,
+                    /*target_p99_latency_micros=*/20000));
+
+  BatchFunctionKernel *batch_kernel =
+      dynamic_cast<BatchFunctionKernel *>(op_kernel());
+  // The target only applies to the adaptive batch scheduler.
+  EXPECT_EQ(test_util::BatchFunctionKernelTestAccess(batch_kernel)
+                .target_p99_latency_micros(),
+            adaptive_scheduler_enabled ? 20000 : 0);
+}
+
 INSTANTIATE_TEST_SUITE_P(Params, BatchFunctionKernelTest, ::testing::Bool());
 
 class SharedBatchFunctionTestState : public OpsTestBase {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <random>
@@ -47,6 +48,8 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+class ASBSBatchSizePolicy;
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -171,6 +174,19 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // Batch sizes the queue may close batches at, in increasing order. The
+    // largest must not exceed max_batch_size. Only used together with
+    // target_p99_latency_micros.
+    std::vector<int32> allowed_batch_sizes;
+    // If positive, batches are closed at a batch size chosen per batch from
+    // allowed_batch_sizes rather than at max_batch_size. The choice comes from
+    // a model of processing latency vs. batch size fitted online to this
+    // queue's batches, and is the largest size whose predicted p99 processing
+    // latency is within this target, i.e. the size with the best throughput
+    // that meets it. Batch timeouts still apply, so under low load batches
+    // stay small.
+    int64_t target_p99_latency_micros = 0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -292,6 +308,75 @@ class AdaptiveSharedBatchScheduler
 // Implementation details follow. API users need not read.
 
 namespace internal {
+// Chooses the batch size a queue closes batches at, given the queue's
+// allowed_batch_sizes and target_p99_latency_micros. Processing latency is
+// modelled as `intercept + slope * batch_size`, fitted by exponentially
+// weighted least squares so that it follows changes in the workload, and the
+// weighted spread of the residuals turns the predicted mean into a p99. Thread
+// safe.
+class ASBSBatchSizePolicy {
+ public:
+  ASBSBatchSizePolicy(std::vector<int32> allowed_batch_sizes,
+                      int64_t target_p99_latency_micros)
+      : allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+        target_p99_latency_micros_(target_p99_latency_micros),
+        limit_index_(allowed_batch_sizes_.size() - 1),
+        batch_size_limit_(allowed_batch_sizes_.back()) {}
+
+  // Size at which the next batch should be closed.
+  int batch_size_limit() const {
+    return batch_size_limit_.load(std::memory_order_relaxed);
+  }
+
+  // Adds an observation and updates batch_size_limit(). Batch `size` is
+  // rounded up to the next allowed batch size, matching the padding done by
+  // BatchResourceBase.
+  void RecordProcessingTime(int size, int64_t processing_micros);
+
+  // Predicted p99 processing latency of a batch of `size`.
+  double PredictP99LatencyMicros(int size) const {
+    mutex_lock l(mu_);
+    return PredictP99LatencyMicrosLocked(size);
+  }
+
+ private:
+  double PredictMeanLatencyMicrosLocked(int size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  double PredictP99LatencyMicrosLocked(int size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Weight of past observations relative to the next one.
+  constexpr static double kDecay = 0.99;
+  // Observations needed before batch_size_limit() departs from the largest
+  // allowed batch size.
+  constexpr static int kMinObservations = 16;
+  // Standard deviations above the mean for the 99th percentile of a normal
+  // distribution.
+  constexpr static double kP99StdDevs = 2.326;
+
+  const std::vector<int32> allowed_batch_sizes_;
+  const int64_t target_p99_latency_micros_;
+
+  mutable mutex mu_;
+  // Exponentially weighted sums over observations (x = batch size, y =
+  // processing latency).
+  double weight_sum_ TF_GUARDED_BY(mu_) = 0;
+  double x_sum_ TF_GUARDED_BY(mu_) = 0;
+  double y_sum_ TF_GUARDED_BY(mu_) = 0;
+  double xx_sum_ TF_GUARDED_BY(mu_) = 0;
+  double xy_sum_ TF_GUARDED_BY(mu_) = 0;
+  // Exponentially weighted sum of squared prediction errors and its weight.
+  double residual_sq_sum_ TF_GUARDED_BY(mu_) = 0;
+  double residual_weight_sum_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_observations_ TF_GUARDED_BY(mu_) = 0;
+  // Index of batch_size_limit_ in allowed_batch_sizes_.
+  int limit_index_ TF_GUARDED_BY(mu_);
+  std::atomic<int> batch_size_limit_;
+
+  ASBSBatchSizePolicy(const ASBSBatchSizePolicy&) = delete;
+  void operator=(const ASBSBatchSizePolicy&) = delete;
+};
+
 // Consolidates tasks into batches, passing them off to the
 // AdaptiveSharedBatchScheduler for processing.
 template <typename TaskType>
@@ -326,14 +411,21 @@ class ASBSQueue : public BatchScheduler<TaskType> {
   // Number of size 1 tasks which could currently be scheduled without failing.
   size_t SchedulingCapacityLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Size at which the next batch will be closed.
+  int NextBatchSizeLimit() const;
+
   // Returns uint64 one greater than was returned by the previous call.
   // Context id is reused after std::numeric_limits<uint64>::max is exhausted.
   static uint64 NewTraceMeContextIdForBatch();
 
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Null unless options_.target_p99_latency_micros is set.
+  const std::shared_ptr<ASBSBatchSizePolicy> batch_size_policy_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ TF_GUARDED_BY(mu_) = nullptr;
+  // Size at which current_batch_ is closed.
+  int current_batch_size_limit_ TF_GUARDED_BY(mu_) = 0;
   int64_t num_enqueued_batches_ TF_GUARDED_BY(mu_) = 0;
   int64_t num_enqueued_tasks_ TF_GUARDED_BY(mu_) = 0;
   mutable mutex mu_;
@@ -346,11 +438,13 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64_t creation_time_micros,
-            int64_t batch_timeout_micros, uint64 traceme_context_id)
+            int64_t batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<ASBSBatchSizePolicy> batch_size_policy = nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        batch_size_policy_(std::move(batch_size_policy)) {}
 
   ~ASBSBatch() override {}
 
@@ -362,11 +456,18 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // Policy to report this batch's processing time to. Kept by the batch since
+  // its queue may be destroyed while the batch is being processed.
+  const std::shared_ptr<ASBSBatchSizePolicy>& batch_size_policy() const {
+    return batch_size_policy_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64_t creation_time_micros_;
   const int64_t schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<ASBSBatchSizePolicy> batch_size_policy_;
   ASBSBatch(const ASBSBatch&) = delete;
   void operator=(const ASBSBatch&) = delete;
 };
@@ -467,6 +568,30 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
           options.max_batch_size);
     }
   }
+  if (!std::is_sorted(options.allowed_batch_sizes.begin(),
+                      options.allowed_batch_sizes.end(),
+                      std::less_equal<int32>())) {
+    return errors::InvalidArgument(
+        "allowed_batch_sizes must be strictly increasing");
+  }
+  if (!options.allowed_batch_sizes.empty() &&
+      (options.allowed_batch_sizes.front() <= 0 ||
+       options.allowed_batch_sizes.back() > options.max_batch_size)) {
+    return errors::InvalidArgument(
+        "allowed_batch_sizes must be positive and not larger than "
+        "max_batch_size (",
+        options.max_batch_size, ")");
+  }
+  if (options.target_p99_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_p99_latency_micros can't be negative; was ",
+        options.target_p99_latency_micros);
+  }
+  if (options.target_p99_latency_micros > 0 &&
+      options.allowed_batch_sizes.empty()) {
+    return errors::InvalidArgument(
+        "target_p99_latency_micros requires allowed_batch_sizes");
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
@@ -642,9 +767,18 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  // `batch` is owned, and may be deleted, by the callback.
+  std::shared_ptr<internal::ASBSBatchSizePolicy> batch_size_policy =
+      batch->batch_size_policy();
+  const int batch_size = batch->size();
+  const int64_t process_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
+  if (batch_size_policy != nullptr) {
+    batch_size_policy->RecordProcessingTime(batch_size,
+                                            end_time - process_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -703,14 +837,80 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeAdjustInflightLimit() {
   }
 }
 
-// ---------------- ASBSQueue ----------------
+// ---------------- ASBSBatchSizePolicy ----------------
 
 namespace internal {
+inline void ASBSBatchSizePolicy::RecordProcessingTime(
+    int size, int64_t processing_micros) {
+  auto it = std::lower_bound(allowed_batch_sizes_.begin(),
+                             allowed_batch_sizes_.end(), size);
+  const double x = it == allowed_batch_sizes_.end() ? size : *it;
+  const double y = processing_micros;
+
+  mutex_lock l(mu_);
+  if (num_observations_ >= 2) {
+    const double residual = y - PredictMeanLatencyMicrosLocked(x);
+    residual_sq_sum_ = kDecay * residual_sq_sum_ + residual * residual;
+    residual_weight_sum_ = kDecay * residual_weight_sum_ + 1;
+  }
+  weight_sum_ = kDecay * weight_sum_ + 1;
+  x_sum_ = kDecay * x_sum_ + x;
+  y_sum_ = kDecay * y_sum_ + y;
+  xx_sum_ = kDecay * xx_sum_ + x * x;
+  xy_sum_ = kDecay * xy_sum_ + x * y;
+  if (++num_observations_ < kMinObservations) return;
+
+  // The largest allowed size predicted to meet the target. Increases are
+  // limited to one step at a time, so that the model is extended with
+  // observations at each new size before relying on it for even larger ones.
+  int index = static_cast<int>(allowed_batch_sizes_.size()) - 1;
+  while (index > 0 && PredictP99LatencyMicrosLocked(
+                          allowed_batch_sizes_[index]) >
+                          target_p99_latency_micros_) {
+    --index;
+  }
+  limit_index_ = std::min(index, limit_index_ + 1);
+  batch_size_limit_.store(allowed_batch_sizes_[limit_index_],
+                          std::memory_order_relaxed);
+}
+
+inline double ASBSBatchSizePolicy::PredictMeanLatencyMicrosLocked(
+    int size) const {
+  if (weight_sum_ == 0) return 0;
+  const double variance_x = weight_sum_ * xx_sum_ - x_sum_ * x_sum_;
+  if (variance_x <= 1e-9 * weight_sum_ * xx_sum_) {
+    // All observations are at the same batch size, so the slope is unknown.
+    // Assume latency proportional to batch size: this overestimates larger
+    // batches and so errs on the side of the latency target.
+    return x_sum_ > 0 ? size * y_sum_ / x_sum_ : y_sum_ / weight_sum_;
+  }
+  const double slope =
+      std::max(0.0, (weight_sum_ * xy_sum_ - x_sum_ * y_sum_) / variance_x);
+  const double intercept = (y_sum_ - slope * x_sum_) / weight_sum_;
+  return intercept + slope * size;
+}
+
+inline double ASBSBatchSizePolicy::PredictP99LatencyMicrosLocked(
+    int size) const {
+  const double stddev = residual_weight_sum_ > 0
+                            ? std::sqrt(residual_sq_sum_ / residual_weight_sum_)
+                            : 0;
+  return PredictMeanLatencyMicrosLocked(size) + kP99StdDevs * stddev;
+}
+
+// ---------------- ASBSQueue ----------------
+
 template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      batch_size_policy_(options.target_p99_latency_micros > 0
+                             ? std::make_shared<ASBSBatchSizePolicy>(
+                                   options.allowed_batch_sizes,
+                                   options.target_p99_latency_micros)
+                             : nullptr) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -755,8 +955,8 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     int remaining_batch_size =
         current_batch_ == nullptr
-            ? options_.max_batch_size
-            : options_.max_batch_size - current_batch_->size();
+            ? NextBatchSizeLimit()
+            : current_batch_size_limit_ - current_batch_->size();
     if (options_.split_input_task_func == nullptr ||
         size <= remaining_batch_size) {
       // Either we don't allow task splitting or task fits within the current
@@ -767,13 +967,13 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Beyond this point Schedule should not fail, as the caller has been
       // promised that all of the split tasks will be scheduled.
       TF_RETURN_IF_ERROR(options_.split_input_task_func(
-          task, remaining_batch_size, options_.max_batch_size,
+          task, remaining_batch_size, NextBatchSizeLimit(),
           &tasks_to_schedule));
     }
     for (auto& task : tasks_to_schedule) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
-          current_batch_->size() + task->size() > options_.max_batch_size) {
+          current_batch_->size() + task->size() > current_batch_size_limit_) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -786,7 +986,9 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            options_.batch_timeout_micros, NewTraceMeContextIdForBatch(),
+            batch_size_policy_);
+        current_batch_size_limit_ = NextBatchSizeLimit();
         new_batches.push_back(current_batch_);
       }
 
@@ -806,7 +1008,8 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
-      if (current_batch_->size() == options_.max_batch_size ||
+      // A task larger than an adaptive limit fills its batch on its own.
+      if (current_batch_->size() >= current_batch_size_limit_ ||
           reached_max_tasks) {
         current_batch_->Close();
         closed_batch = true;
@@ -836,6 +1039,12 @@ void ASBSQueue<TaskType>::ReleaseBatch(const ASBSBatch<TaskType>* batch) {
   }
 }
 
+template <typename TaskType>
+int ASBSQueue<TaskType>::NextBatchSizeLimit() const {
+  return batch_size_policy_ == nullptr ? options_.max_batch_size
+                                       : batch_size_policy_->batch_size_limit();
+}
+
 template <typename TaskType>
 size_t ASBSQueue<TaskType>::NumEnqueuedTasks() const {
   mutex_lock l(mu_);
@@ -517,6 +517,62 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, BadAdaptiveBatchSizeOptions) {
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  auto queue_callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 64;
+  queue_options.target_p99_latency_micros = 1000;
+  // A latency target needs batch sizes to choose from.
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {16, 8, 64};
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {8, 16, 128};
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {8, 16, 64};
+  TF_EXPECT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+}
+
+TEST(ASBSBatchSizePolicyTest, ChoosesLargestBatchSizeMeetingTarget) {
+  internal::ASBSBatchSizePolicy policy({8, 16, 32, 64},
+                                       /*target_p99_latency_micros=*/500);
+  // Without observations the largest batch size is used.
+  EXPECT_EQ(policy.batch_size_limit(), 64);
+
+  // Processing takes 100us plus 10us per element: batches of 32 (420us) meet
+  // the target, batches of 64 (740us) don't.
+  for (int i = 0; i < 100; ++i) {
+    for (int size : {8, 16, 32, 64}) {
+      policy.RecordProcessingTime(size, 100 + 10 * size);
+    }
+  }
+  EXPECT_EQ(policy.batch_size_limit(), 32);
+  EXPECT_NEAR(policy.PredictP99LatencyMicros(64), 740, 1);
+
+  // Once processing gets faster, batches of 64 (370us) meet the target again.
+  for (int i = 0; i < 100; ++i) {
+    for (int size : {8, 16, 32, 64}) {
+      policy.RecordProcessingTime(size, 50 + 5 * size);
+    }
+  }
+  EXPECT_EQ(policy.batch_size_limit(), 64);
+}
+
+TEST(ASBSBatchSizePolicyTest, RoundsUpToAllowedBatchSizes) {
+  internal::ASBSBatchSizePolicy policy({8, 16},
+                                       /*target_p99_latency_micros=*/100);
+  // Batches of 9 are padded to 16, so their latency is what a batch of 16
+  // costs.
+  for (int i = 0; i < 20; ++i) {
+    policy.RecordProcessingTime(9, 200);
+    policy.RecordProcessingTime(5, 80);
+  }
+  EXPECT_EQ(policy.batch_size_limit(), 8);
+  EXPECT_NEAR(policy.PredictP99LatencyMicros(16), 200, 1);
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
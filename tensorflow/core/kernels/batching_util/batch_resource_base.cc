@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/functional/bind_front.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
@@ -326,6 +327,117 @@ string GetTensorNamesAndShapesString(const OpKernelContext* context,
   return out.str();
 }
 
+namespace {
+
+// Concatenates `tensors`, each of shape [rows, length, ...] with `length`
+// varying between them, into the components of a ragged tensor with one row
+// per row of `tensors`, padded with empty rows up to `padded_num_rows`. Appends
+// the values and row_splits to `outputs`. `prototype` gives the dtype and inner
+// shape of the values when `tensors` is empty.
+Status ConcatRaggedInput(OpKernelContext* context,
+                         const std::vector<Tensor>& tensors,
+                         int padded_num_rows, const Tensor& prototype,
+                         std::vector<Tensor>* outputs) {
+  TensorShape inner_shape = prototype.shape();
+  inner_shape.RemoveDimRange(0, 2);
+
+  Tensor row_splits;
+  AllocatorAttributes cpu_alloc;
+  cpu_alloc.set_on_host(true);
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_INT64, TensorShape({padded_num_rows + 1}), &row_splits, cpu_alloc));
+  auto splits = row_splits.vec<int64_t>();
+  splits(0) = 0;
+  int row = 0;
+
+  std::vector<Tensor> flattened;
+  flattened.reserve(tensors.size());
+  for (const Tensor& tensor : tensors) {
+    bool same_inner_shape = tensor.dims() == prototype.dims();
+    for (int d = 2; same_inner_shape && d < tensor.dims(); ++d) {
+      same_inner_shape = tensor.dim_size(d) == prototype.dim_size(d);
+    }
+    if (!same_inner_shape) {
+      return errors::InvalidArgument(
+          "Ragged batching inputs must have the same rank and the same shape "
+          "after the 2nd dimension; got ",
+          tensor.shape().DebugString(), " and ",
+          prototype.shape().DebugString());
+    }
+    const int64_t num_rows = tensor.dim_size(0);
+    const int64_t length = tensor.dim_size(1);
+    if (row + num_rows > padded_num_rows) {
+      return errors::Internal("Ragged batch has more rows than its size ",
+                              padded_num_rows);
+    }
+    TensorShape flat_shape({num_rows * length});
+    flat_shape.AppendShape(inner_shape);
+    Tensor flat;
+    if (!flat.CopyFrom(tensor, flat_shape)) {
+      return errors::Internal(
+          "Failed to flatten ragged batching input of shape ",
+          tensor.shape().DebugString());
+    }
+    flattened.push_back(std::move(flat));
+    for (int64_t i = 0; i < num_rows; ++i, ++row) {
+      splits(row + 1) = splits(row) + length;
+    }
+  }
+  // Padding rows are empty.
+  for (; row < padded_num_rows; ++row) {
+    splits(row + 1) = splits(row);
+  }
+
+  Tensor values;
+  if (flattened.empty()) {
+    TensorShape values_shape({0});
+    values_shape.AppendShape(inner_shape);
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(prototype.dtype(), values_shape, &values));
+  } else {
+    TF_RETURN_IF_ERROR(Concat(context, flattened, &values));
+  }
+  outputs->push_back(std::move(values));
+  outputs->push_back(std::move(row_splits));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+Status BatchResourceBase::set_ragged_batching_options(
+    RaggedBatchingOptions options) {
+  if (options.enabled && !has_process_batch_function_) {
+    return errors::InvalidArgument(
+        "Ragged batching requires a batch function.");
+  }
+  // std::adjacent_find finds the first pair that is not strictly increasing.
+  if (std::adjacent_find(options.length_bucket_boundaries.begin(),
+                         options.length_bucket_boundaries.end(),
+                         std::greater_equal<int64_t>()) !=
+      options.length_bucket_boundaries.end()) {
+    return errors::InvalidArgument(
+        "Ragged batching length_bucket_boundaries must be strictly "
+        "increasing, got [",
+        absl::StrJoin(options.length_bucket_boundaries, ", "), "].");
+  }
+  ragged_batching_options_ = std::move(options);
+  return absl::OkStatus();
+}
+
+string BatchResourceBase::GetBatcherQueueName(const string& batcher_queue_name,
+                                              const BatchTask& task) const {
+  const std::vector<int64_t>& boundaries =
+      ragged_batching_options_.length_bucket_boundaries;
+  if (!ragged_batching_options_.enabled || boundaries.empty()) {
+    return batcher_queue_name;
+  }
+  const int64_t length = task.inputs[0].dim_size(1);
+  const int64_t bucket =
+      std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+      boundaries.begin();
+  return absl::StrCat(batcher_queue_name, "/length_bucket_", bucket);
+}
+
 Status BatchResourceBase::RegisterWarmupInputs(
     int64_t guid, OpKernelContext* context, const string& batcher_queue_name,
     const CreateBatchTaskFn& create_batch_task_fn,
@@ -389,6 +501,12 @@ Status BatchResourceBase::RegisterInput(
           "have equal 0th-dimension size.\nBelow are the input tensors: \n",
           GetTensorNamesAndShapesString(context, tensors));
     }
+    if (ragged_batching_options_.enabled && tensor.shape().dims() < 2) {
+      return errors::InvalidArgument(
+          "Ragged batching input tensors must have at least two dimensions."
+          "\nBelow are the input tensors: \n",
+          GetTensorNamesAndShapesString(context, tensors));
+    }
     batch_components->inputs.push_back(tensor);
   }
   RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context),
@@ -471,8 +589,9 @@ Status BatchResourceBase::RegisterInput(
   }
 
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      GetBatcherQueueName(batcher_queue_name, *batch_components),
+      &batcher_queue));
 
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
@@ -580,7 +699,8 @@ BatchResourceBase::GetBatcherQueueOptions(
 BatchResourceBase::GetAdaptiveBatcherQueueOptions(
     int32_t max_batch_size, int32_t batch_timeout_micros,
     int32_t max_enqueued_batches, bool enable_large_batch_splitting,
-    const std::vector<int32>& allowed_batch_sizes, bool disable_padding) {
+    const std::vector<int32>& allowed_batch_sizes, bool disable_padding,
+    int64_t target_p99_latency_micros) {
   AdaptiveBatcherT::QueueOptions batcher_queue_options;
   batcher_queue_options.max_input_task_size =
       std::make_optional(max_batch_size);
@@ -591,6 +711,9 @@ BatchResourceBase::GetAdaptiveBatcherQueueOptions(
   } else {
     batcher_queue_options.max_batch_size = *allowed_batch_sizes.rbegin();
   }
+  // Candidate batch sizes if a target_p99_latency_micros is set.
+  batcher_queue_options.allowed_batch_sizes = allowed_batch_sizes;
+  batcher_queue_options.target_p99_latency_micros = target_p99_latency_micros;
 
   if (enable_large_batch_splitting) {
     batcher_queue_options.split_input_task_func =
@@ -687,7 +810,9 @@ Status BatchResourceBase::ConcatInputTensors(
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
-  concatenated_tensors->reserve(num_inputs);
+  concatenated_tensors->reserve(ragged_batching_options_.enabled
+                                    ? 2 * num_inputs
+                                    : num_inputs);
 
   // Process each input one at a time (the typical case has just one). When
   // `just_for_warmup` is true, the real data is not added. Otherwise, the real
@@ -708,6 +833,14 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    if (ragged_batching_options_.enabled) {
+      TF_RETURN_IF_ERROR(ConcatRaggedInput(context, to_concatenate,
+                                           padded_batch_size,
+                                           batch.task(0).inputs.at(i),
+                                           concatenated_tensors));
+      continue;
+    }
+
     // Add padding as needed if padding is allowed. Use the first row of the
     // first task's tensor as the data for padding.
     if (padding_amount != 0) {
@@ -959,6 +1092,7 @@ void BatchResourceBase::ProcessFuncBatch(
   auto& last_task = batch->task(batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
   const std::string& model_name = GetModelName(last_task_context);
+  const uint64 batch_start_time_ns = EnvTime::NowNanos();
 
   // Regardless of the outcome, we need to propagate the status to the
   // individual tasks and signal that they are done. We use MakeCleanup() to
@@ -974,7 +1108,8 @@ void BatchResourceBase::ProcessFuncBatch(
     // consideration when excluding the wasted cost and propagate cost to the
     // unbatched tasks.
     SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
-                                    processed_size, *batch);
+                                    processed_size, *batch,
+                                    batch_start_time_ns);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
     batch_cost_measurements.clear();
@@ -1069,10 +1204,12 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   AsyncOpKernel::DoneCallback last_task_callback =
       batch->task(batch->num_tasks() - 1).done_callback;
   const std::string& model_name = GetModelName(last_task_context);
+  const uint64 batch_start_time_ns = EnvTime::NowNanos();
 
   auto batch_cost_cleanup = gtl::MakeCleanup([&] {
     SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
-                                    processed_size, *batch);
+                                    processed_size, *batch,
+                                    batch_start_time_ns);
   });
 
   OP_REQUIRES_OK_ASYNC(last_task_context, ValidateBatch(*batch),
@@ -1166,6 +1303,18 @@ void BatchResourceBase::ProcessBatchCallBack(
   }
 }
 
+void BatchResourceBase::ExpiredTaskCallBack(std::unique_ptr<BatchTask> task) {
+  if (!session_metadata().name().empty()) {
+    absl::MutexLock lock(&outstanding_batch_mu_);
+    num_outstanding_batched_items_ -= task->size();
+  }
+  CleanUpFunctionHelper(
+      *task, errors::DeadlineExceeded(
+                 "Batching queue task was not scheduled within the latency "
+                 "SLO of ",
+                 batcher_queue_options_.latency_slo_micros, " microseconds."));
+}
+
 // Looks up the batcher queue for 'queue_name'. If it didn't previously exist,
 // creates it.
 Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
@@ -1180,8 +1329,13 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
 
   std::unique_ptr<BatcherQueueT> new_queue;
   if (batcher_) {
+    BatcherT::QueueOptions batcher_queue_options = batcher_queue_options_;
+    if (batcher_queue_options.latency_slo_micros > 0) {
+      batcher_queue_options.expired_task_callback =
+          absl::bind_front(&BatchResourceBase::ExpiredTaskCallBack, this);
+    }
     TF_RETURN_IF_ERROR(batcher_->AddQueue(
-        batcher_queue_options_,
+        batcher_queue_options,
         absl::bind_front(&BatchResourceBase::ProcessBatchCallBack, this),
         &new_queue));
   } else if (adaptive_batcher_) {
@@ -1204,7 +1358,8 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     const std::string& model_name,
     const std::vector<std::unique_ptr<CostMeasurement>>&
         batch_cost_measurements,
-    const int64_t processed_size, BatchT& batch) {
+    const int64_t processed_size, BatchT& batch,
+    const uint64 batch_start_time_ns) {
   absl::flat_hash_map<std::string, absl::Duration> batch_costs;
   // 1. Split the batch costs to each task.
   for (const auto& batch_cost_measurement : batch_cost_measurements) {
@@ -1261,9 +1416,18 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
     // Skip recording the metrics if the request_cost is null.
     if (!request_cost) continue;
 
+    const BatchTask& task = batch.task(i);
+    absl::Duration queueing_delay = absl::ZeroDuration();
+    if (batch_start_time_ns > task.start_time) {
+      queueing_delay = absl::Nanoseconds(batch_start_time_ns - task.start_time);
+    }
+    int64_t input_bytes = 0;
+    for (const Tensor& input : task.inputs) {
+      input_bytes += input.TotalBytes();
+    }
     request_cost->RecordBatchMetrics(RequestCost::BatchMetrics{
-        processed_size, static_cast<int64_t>(batch.task(i).size()),
-        padding_size, batch_costs});
+        processed_size, static_cast<int64_t>(task.size()), padding_size,
+        batch_costs, queueing_delay, input_bytes});
   }
 }
 
@@ -45,6 +45,22 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// Options for batching variable-length inputs without padding them to a common
+// length.
+struct RaggedBatchingOptions {
+  // If true, every batched input has shape [rows, length, ...] where `length`
+  // may differ between tasks. The batch function receives each input as two
+  // arguments, values of shape [sum(rows * length), ...] and int64 row_splits
+  // of shape [padded_batch_size + 1], i.e. the components of a RaggedTensor
+  // with one row per batch element. Rows added as padding are empty, so
+  // padding costs no values. Only supported for batch functions.
+  bool enabled = false;
+  // If non-empty, tasks are only batched with tasks whose first input's
+  // `length` falls into the same bucket: {32, 128} batches lengths below 32,
+  // below 128 and the rest separately. Must be strictly increasing.
+  std::vector<int64_t> length_bucket_boundaries;
+};
+
 // Options used to create a batch resource.
 struct BatchResourceOptions {
   int32_t num_batch_threads;
@@ -57,6 +73,11 @@ struct BatchResourceOptions {
   int32_t low_priority_max_enqueued_batches;
   std::vector<int32_t> low_priority_allowed_batch_sizes;
   MixedPriorityBatchingPolicy mixed_priority_batching_policy;
+  // If positive, tasks that wait longer than this in the batching queue fail
+  // with DEADLINE_EXCEEDED instead of being processed. See
+  // `SharedBatchScheduler::QueueOptions::latency_slo_micros`.
+  int64_t latency_slo_micros = 0;
+  RaggedBatchingOptions ragged_batching;
 };
 
 // Base class for resource that encapsulating the state and logic for batching
@@ -183,6 +204,14 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Fails if `options` are invalid, in which case the current options are
+  // kept.
+  Status set_ragged_batching_options(RaggedBatchingOptions options);
+
+  const RaggedBatchingOptions& ragged_batching_options() const {
+    return ragged_batching_options_;
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -219,10 +248,14 @@ class BatchResourceBase : public ResourceBase {
       const std::vector<int32>& low_priority_allowed_batch_sizes,
       MixedPriorityBatchingPolicy mixed_priority_batching_policy);
 
+  // If `target_p99_latency_micros` is positive, batches are closed at the
+  // largest of `allowed_batch_sizes` expected to meet it. See
+  // `AdaptiveSharedBatchScheduler::QueueOptions::target_p99_latency_micros`.
   static AdaptiveBatcherT::QueueOptions GetAdaptiveBatcherQueueOptions(
       int32_t max_batch_size, int32_t batch_timeout_micros,
       int32_t max_enqueued_batches, bool enable_large_batch_splitting,
-      const std::vector<int32>& allowed_batch_sizes, bool disable_padding);
+      const std::vector<int32>& allowed_batch_sizes, bool disable_padding,
+      int64_t target_p99_latency_micros = 0);
 
   // Split 'input' of 'input_task_ptr' along 0th dimension, into a list of
   // 'output_tasks'.
@@ -263,12 +296,16 @@ class BatchResourceBase : public ResourceBase {
   //   including:
   //   1) the batch size;
   //   2) the input size from this task;
-  //   3) the padding amount.
+  //   3) the padding amount;
+  //   4) the time this task waited until `batch_start_time_ns` (the
+  //      EnvTime::NowNanos() at which the batch started processing), if it is
+  //      non-zero;
+  //   5) the size in bytes of the inputs from this task.
   static void SplitBatchCostsAndRecordMetrics(
       const std::string& model_name,
       const std::vector<std::unique_ptr<CostMeasurement>>&
           batch_cost_measurements,
-      int64_t processed_size, BatchT& batch);
+      int64_t processed_size, BatchT& batch, uint64 batch_start_time_ns = 0);
 
  private:
   // Implementation of calling the process batch function.
@@ -295,9 +332,13 @@ class BatchResourceBase : public ResourceBase {
   // done callback on the task.
   void CleanUpFunctionHelper(BatchTask& task, const Status& status) const;
 
+  // Fails a task that the batcher queue shed for missing the latency SLO.
+  void ExpiredTaskCallBack(std::unique_ptr<BatchTask> task);
+
   // Concatenates the input tensors of the tasks from the batch and the
   // unbatched task vector. When padding is enabled in the batcher queue, they
-  // are padded with garbage value up to the nearest allowed batch size.
+  // are padded with garbage value up to the nearest allowed batch size. With
+  // ragged batching, each input is emitted as values and row_splits instead.
   Status ConcatInputTensors(
       const BatchT& batch,
       const std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks,
@@ -337,8 +378,15 @@ class BatchResourceBase : public ResourceBase {
   Status LookupOrCreateBatcherQueue(const string& queue_name,
                                     BatcherQueueT** queue);
 
+  // Returns the name of the queue `task` is batched in: `batcher_queue_name`,
+  // plus a length bucket suffix with ragged length bucketing.
+  string GetBatcherQueueName(const string& batcher_queue_name,
+                             const BatchTask& task) const;
+
   SessionMetadata session_metadata_;
 
+  RaggedBatchingOptions ragged_batching_options_;
+
   absl::Mutex outstanding_batch_mu_;
   int num_outstanding_batched_items_ TF_GUARDED_BY(outstanding_batch_mu_) = 0;
 
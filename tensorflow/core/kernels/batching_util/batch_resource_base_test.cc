@@ -16,20 +16,35 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/public/version.h"
+#include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/criticality.h"
+#include "tsl/platform/refcount.h"
 
 namespace tensorflow {
 namespace serving {
@@ -113,6 +128,7 @@ std::unique_ptr<BatchResourceBase::BatchTask> MakeBatchTask(
   auto task = std::make_unique<BatchResourceBase::BatchTask>();
   task->inputs.push_back(Tensor(DT_DOUBLE, TensorShape({task_size, 1})));
   task->request_cost = request_cost;
+  task->start_time = 0;
   return task;
 }
 
@@ -129,7 +145,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnNoCostMeasurement) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
-                  ::testing::IsEmpty())));
+                  ::testing::IsEmpty(), /*queueing_delay=*/absl::ZeroDuration(),
+                  /*input_bytes=*/8)));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroCost) {
@@ -148,7 +165,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroCost) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
-                  ::testing::IsEmpty())));
+                  ::testing::IsEmpty(), /*queueing_delay=*/absl::ZeroDuration(),
+                  /*input_bytes=*/8)));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroBatchSize) {
@@ -202,7 +220,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/8)));
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
       UnorderedElementsAre(Pair("test_tpu_with_smear", absl::Milliseconds(90)),
@@ -211,7 +230,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/72)));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
@@ -241,7 +261,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/8)));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -254,7 +275,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/72)));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
@@ -281,7 +303,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/8)));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -291,7 +314,359 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration(), /*input_bytes=*/72)));
+}
+
+TEST(SplitBatchCostsAndRecordMetricsTest, RecordsQueueingDelay) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.mutable_task(0)->start_time = 1000;
+  batch.mutable_task(1)->start_time = 4000;
+  batch.Close();
+
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  BatchResourceBase::SplitBatchCostsAndRecordMetrics(
+      "model_name", batch_cost_measurements, /*processed_size=*/16, batch,
+      /*batch_start_time_ns=*/5000);
+
+  EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/6,
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::Nanoseconds(4000),
+                  /*input_bytes=*/8)));
+  EXPECT_THAT(batch.task(1).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/16, /*input_size=*/9, /*padding_size=*/6,
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::Nanoseconds(1000),
+                  /*input_bytes=*/72)));
+}
+
+TEST(GetAdaptiveBatcherQueueOptionsTest, ForwardsTargetP99Latency) {
+  const BatchResourceBase::AdaptiveBatcherT::QueueOptions options =
+      BatchResourceBase::GetAdaptiveBatcherQueueOptions(
+          /*max_batch_size=*/16, /*batch_timeout_micros=*/1000,
+          /*max_enqueued_batches=*/10, /*enable_large_batch_splitting=*/true,
+          /*allowed_batch_sizes=*/{4, 8, 16}, /*disable_padding=*/false,
+          /*target_p99_latency_micros=*/20000);
+  EXPECT_EQ(options.target_p99_latency_micros, 20000);
+  EXPECT_THAT(options.allowed_batch_sizes, ::testing::ElementsAre(4, 8, 16));
+  EXPECT_EQ(options.max_batch_size, 16);
+}
+
+TEST(GetAdaptiveBatcherQueueOptionsTest, NoTargetP99LatencyByDefault) {
+  const BatchResourceBase::AdaptiveBatcherT::QueueOptions options =
+      BatchResourceBase::GetAdaptiveBatcherQueueOptions(
+          /*max_batch_size=*/16, /*batch_timeout_micros=*/1000,
+          /*max_enqueued_batches=*/10, /*enable_large_batch_splitting=*/true,
+          /*allowed_batch_sizes=*/{4, 8, 16}, /*disable_padding=*/false);
+  EXPECT_EQ(options.target_p99_latency_micros, 0);
+}
+
+// Batch resource whose batch function takes ragged inputs and returns, for
+// every row of the batch, the sum of that row's values of the first input.
+class RowSumBatchResource : public BatchResourceBase {
+ public:
+  using BatchResourceBase::BatchResourceBase;
+
+  std::string DebugString() const override { return "RowSumBatchResource"; }
+
+  // Returns the arguments of every call of the batch function so far.
+  std::vector<std::vector<Tensor>> batch_function_args() const {
+    absl::MutexLock lock(&mu_);
+    return batch_function_args_;
+  }
+
+ private:
+  void ProcessFuncBatchImpl(
+      const BatchResourceBase::BatchTask& last_task,
+      absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
+      std::function<void(const Status&)> done) const override {
+    {
+      absl::MutexLock lock(&mu_);
+      batch_function_args_.emplace_back(inputs.begin(), inputs.end());
+    }
+    const auto values = inputs[0].vec<int64_t>();
+    const auto row_splits = inputs[1].vec<int64_t>();
+    Tensor sums(DT_INT64, TensorShape({row_splits.size() - 1}));
+    for (int64_t row = 0; row < sums.NumElements(); ++row) {
+      int64_t sum = 0;
+      for (int64_t i = row_splits(row); i < row_splits(row + 1); ++i) {
+        sum += values(i);
+      }
+      sums.vec<int64_t>()(row) = sum;
+    }
+    combined_outputs->push_back(std::move(sums));
+    done(absl::OkStatus());
+  }
+
+  mutable absl::Mutex mu_;
+  mutable std::vector<std::vector<Tensor>> batch_function_args_
+      ABSL_GUARDED_BY(mu_);
+};
+
+class RaggedBatchingTest : public ::testing::Test {
+ protected:
+  // Long enough that batches only close once they are full.
+  static constexpr int32_t kNoBatchTimeoutMicros = 60 * 1000 * 1000;
+
+  // One invocation of the batch op, with two int64 inputs.
+  struct Invocation {
+    std::vector<Tensor> tensors;
+    std::vector<TensorValue> inputs;
+    OpKernelContext::Params params;
+    std::unique_ptr<OpKernelContext> context;
+    absl::Notification done;
+  };
+
+  void SetUp() override {
+    device_ = DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+    NameAttrList f;
+    f.set_name("row_sum");
+    NodeDef node_def;
+    TF_ASSERT_OK(NodeDefBuilder("ragged_batch", "BatchFunction")
+                     .Attr("max_batch_size", 4)
+                     .Attr("num_batch_threads", 1)
+                     .Attr("batch_timeout_micros", 0)
+                     .Attr("Tin", {DT_INT64, DT_INT64})
+                     .Input(std::vector<NodeDefBuilder::NodeOut>(
+                         {{"n1", 0, DT_INT64}, {"n2", 0, DT_INT64}}))
+                     .Attr("Tcaptured", std::vector<DataType>{})
+                     .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                     .Attr("Tout", {DT_INT64})
+                     .Attr("f", f)
+                     .Finalize(&node_def));
+    Status status;
+    kernel_ = CreateOpKernel(DEVICE_CPU, device_.get(),
+                             device_->GetAllocator({}), node_def,
+                             TF_GRAPH_DEF_VERSION, &status);
+    TF_ASSERT_OK(status);
+  }
+
+  // Creates a ragged batching resource whose batches close once they hold
+  // `max_batch_size` rows or after `batch_timeout_micros`.
+  core::RefCountPtr<RowSumBatchResource> CreateResource(
+      int32_t max_batch_size, int32_t batch_timeout_micros,
+      const std::vector<int32>& allowed_batch_sizes) {
+    std::shared_ptr<BatchResourceBase::BatcherT> batcher;
+    TF_CHECK_OK(BatchResourceBase::BatcherT::Create(
+        BatchResourceBase::BatcherT::Options(), &batcher));
+    core::RefCountPtr<RowSumBatchResource> resource(new RowSumBatchResource(
+        /*has_process_batch_function=*/true, std::move(batcher),
+        BatchResourceBase::GetBatcherQueueOptions(
+            /*num_batch_threads=*/1, max_batch_size, batch_timeout_micros,
+            /*max_enqueued_batches=*/10, allowed_batch_sizes,
+            /*enable_large_batch_splitting=*/false,
+            /*disable_padding=*/false),
+        allowed_batch_sizes));
+    RaggedBatchingOptions options;
+    options.enabled = true;
+    TF_CHECK_OK(resource->set_ragged_batching_options(std::move(options)));
+    return resource;
+  }
+
+  // Enqueues `invocation`, whose inputs must already be set, into `resource`.
+  Status Register(RowSumBatchResource* resource, Invocation* invocation) {
+    for (Tensor& tensor : invocation->tensors) {
+      invocation->inputs.emplace_back(&tensor);
+    }
+    invocation->params.device = device_.get();
+    invocation->params.op_kernel = kernel_.get();
+    invocation->params.inputs = invocation->inputs;
+    invocation->context =
+        std::make_unique<OpKernelContext>(&invocation->params);
+    return resource->RegisterInput(
+        next_guid_++, invocation->context.get(), "ragged_queue",
+        []() -> StatusOr<std::unique_ptr<BatchResourceBase::BatchTask>> {
+          return std::make_unique<BatchResourceBase::BatchTask>();
+        },
+        [invocation]() { invocation->done.Notify(); });
+  }
+
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<OpKernel> kernel_;
+  int64_t next_guid_ = 0;
+};
+
+TEST_F(RaggedBatchingTest, ConcatenatesVariableLengthInputsWithoutPadding) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/3, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2, 3}, {1, 3}),
+                   test::AsTensor<int64_t>({7}, {1, 1})};
+  second.tensors = {test::AsTensor<int64_t>({4, 5}, {2, 1}),
+                    test::AsTensor<int64_t>({8, 9, 10, 11}, {2, 2})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  const std::vector<std::vector<Tensor>> args =
+      resource->batch_function_args();
+  ASSERT_EQ(args.size(), 1);
+  ASSERT_EQ(args[0].size(), 4);
+  test::ExpectTensorEqual<int64_t>(args[0][0],
+                                   test::AsTensor<int64_t>({1, 2, 3, 4, 5}));
+  test::ExpectTensorEqual<int64_t>(args[0][1],
+                                   test::AsTensor<int64_t>({0, 3, 4, 5}));
+  test::ExpectTensorEqual<int64_t>(args[0][2],
+                                   test::AsTensor<int64_t>({7, 8, 9, 10, 11}));
+  test::ExpectTensorEqual<int64_t>(args[0][3],
+                                   test::AsTensor<int64_t>({0, 1, 3, 5}));
+}
+
+TEST_F(RaggedBatchingTest, MixesRaggedAndDenseInputs) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/3, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  // The first input's length differs between the invocations, the second
+  // input's does not.
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2, 3, 4}, {2, 2}),
+                   test::AsTensor<int64_t>({10, 11, 12, 13}, {2, 2})};
+  second.tensors = {test::AsTensor<int64_t>({5, 6, 7}, {1, 3}),
+                    test::AsTensor<int64_t>({14, 15}, {1, 2})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  const std::vector<std::vector<Tensor>> args =
+      resource->batch_function_args();
+  ASSERT_EQ(args.size(), 1);
+  ASSERT_EQ(args[0].size(), 4);
+  test::ExpectTensorEqual<int64_t>(
+      args[0][0], test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6, 7}));
+  test::ExpectTensorEqual<int64_t>(args[0][1],
+                                   test::AsTensor<int64_t>({0, 2, 4, 7}));
+  // The dense input is batched the same way, with uniform row splits.
+  test::ExpectTensorEqual<int64_t>(
+      args[0][2], test::AsTensor<int64_t>({10, 11, 12, 13, 14, 15}));
+  test::ExpectTensorEqual<int64_t>(args[0][3],
+                                   test::AsTensor<int64_t>({0, 2, 4, 6}));
+}
+
+TEST_F(RaggedBatchingTest, SplitsOutputsPerTask) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/3, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2, 3, 4}, {2, 2}),
+                   test::AsTensor<int64_t>({0, 0}, {2, 1})};
+  second.tensors = {test::AsTensor<int64_t>({5, 6, 7}, {1, 3}),
+                    test::AsTensor<int64_t>({0}, {1, 1})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  TF_ASSERT_OK(first.context->status());
+  TF_ASSERT_OK(second.context->status());
+  test::ExpectTensorEqual<int64_t>(*first.context->mutable_output(0),
+                                   test::AsTensor<int64_t>({3, 7}));
+  test::ExpectTensorEqual<int64_t>(*second.context->mutable_output(0),
+                                   test::AsTensor<int64_t>({18}));
+}
+
+TEST_F(RaggedBatchingTest, PadsWithEmptyRows) {
+  // The batch of 3 rows closes on timeout and is padded to 4 rows.
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/4, /*batch_timeout_micros=*/100 * 1000,
+      /*allowed_batch_sizes=*/{4});
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2}, {1, 2}),
+                   test::AsTensor<int64_t>({3}, {1, 1})};
+  second.tensors = {test::AsTensor<int64_t>({4, 5}, {2, 1}),
+                    test::AsTensor<int64_t>({6, 7, 8, 9, 10, 11}, {2, 3})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  const std::vector<std::vector<Tensor>> args =
+      resource->batch_function_args();
+  ASSERT_EQ(args.size(), 1);
+  ASSERT_EQ(args[0].size(), 4);
+  test::ExpectTensorEqual<int64_t>(args[0][0],
+                                   test::AsTensor<int64_t>({1, 2, 4, 5}));
+  test::ExpectTensorEqual<int64_t>(args[0][1],
+                                   test::AsTensor<int64_t>({0, 2, 3, 4, 4}));
+  test::ExpectTensorEqual<int64_t>(
+      args[0][2], test::AsTensor<int64_t>({3, 6, 7, 8, 9, 10, 11}));
+  test::ExpectTensorEqual<int64_t>(args[0][3],
+                                   test::AsTensor<int64_t>({0, 1, 4, 7, 7}));
+  // The padding row is dropped from the outputs.
+  TF_ASSERT_OK(first.context->status());
+  TF_ASSERT_OK(second.context->status());
+  test::ExpectTensorEqual<int64_t>(*first.context->mutable_output(0),
+                                   test::AsTensor<int64_t>({3}));
+  test::ExpectTensorEqual<int64_t>(*second.context->mutable_output(0),
+                                   test::AsTensor<int64_t>({4, 5}));
+}
+
+TEST_F(RaggedBatchingTest, FailsOnInputsOfDifferentRank) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/2, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  // Both first inputs have 4 elements per row, but of different ranks.
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2, 3, 4}, {1, 2, 2}),
+                   test::AsTensor<int64_t>({0}, {1, 1})};
+  second.tensors = {test::AsTensor<int64_t>({5, 6, 7, 8}, {1, 2, 1, 2}),
+                    test::AsTensor<int64_t>({0}, {1, 1})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  EXPECT_TRUE(absl::IsInvalidArgument(first.context->status()));
+  EXPECT_TRUE(absl::IsInvalidArgument(second.context->status()));
+  EXPECT_TRUE(resource->batch_function_args().empty());
+}
+
+TEST_F(RaggedBatchingTest, FailsOnInputsOfDifferentInnerShapes) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/2, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  // Both first inputs have 4 elements per row, but different inner shapes.
+  Invocation first, second;
+  first.tensors = {test::AsTensor<int64_t>({1, 2, 3, 4}, {1, 2, 2, 1}),
+                   test::AsTensor<int64_t>({0}, {1, 1})};
+  second.tensors = {test::AsTensor<int64_t>({5, 6, 7, 8}, {1, 2, 1, 2}),
+                    test::AsTensor<int64_t>({0}, {1, 1})};
+  TF_ASSERT_OK(Register(resource.get(), &first));
+  TF_ASSERT_OK(Register(resource.get(), &second));
+  first.done.WaitForNotification();
+  second.done.WaitForNotification();
+
+  EXPECT_TRUE(absl::IsInvalidArgument(first.context->status()));
+  EXPECT_TRUE(absl::IsInvalidArgument(second.context->status()));
+  EXPECT_TRUE(resource->batch_function_args().empty());
+}
+
+TEST_F(RaggedBatchingTest, RejectsLengthBucketBoundariesNotIncreasing) {
+  core::RefCountPtr<RowSumBatchResource> resource = CreateResource(
+      /*max_batch_size=*/2, kNoBatchTimeoutMicros,
+      /*allowed_batch_sizes=*/{});
+  RaggedBatchingOptions options;
+  options.enabled = true;
+  options.length_bucket_boundaries = {32, 32, 128};
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      resource->set_ragged_batching_options(options)));
+  options.length_bucket_boundaries = {128, 32};
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      resource->set_ragged_batching_options(options)));
+  // The previous options are kept.
+  EXPECT_TRUE(
+      resource->ragged_batching_options().length_bucket_boundaries.empty());
+
+  options.length_bucket_boundaries = {32, 128};
+  TF_EXPECT_OK(resource->set_ragged_batching_options(options));
 }
 
 }  // namespace
@@ -25,6 +25,7 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -93,6 +94,13 @@ namespace serving {
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
 //
+// Queues may also be configured with a latency SLO (see
+// `QueueOptions::latency_slo_micros`), which gives each enqueued task a
+// deadline. Whenever any queue with an SLO has a schedulable batch, a free
+// thread takes the batch whose oldest task has the earliest deadline, and only
+// falls back to round-robin otherwise. Tasks whose deadline has already passed
+// when their batch is dequeued are shed instead of taking a batch slot.
+//
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
 // recommended that the queue sizes be configured such that the sum of the sizes
@@ -269,6 +277,21 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If positive, each task must start processing within this many
+    // microseconds of being enqueued. Batches of queues with a latency SLO are
+    // scheduled earliest-deadline-first, ahead of the round-robin rotation,
+    // and tasks that have already missed their deadline when their batch is
+    // dequeued are handed to `expired_task_callback` instead of being
+    // processed.
+    //
+    // Must be non-negative. Only supported when `enable_lazy_split` is false;
+    // low priority tasks are not subject to the SLO.
+    int64_t latency_slo_micros = 0;
+
+    // Receives the tasks shed for missing `latency_slo_micros`. Always invoked
+    // from a batch thread. Required iff `latency_slo_micros` is positive.
+    std::function<void(std::unique_ptr<TaskType>)> expired_task_callback;
   };
   Status AddQueue(const QueueOptions& options,
                   ProcessBatchCallback process_batch_callback,
@@ -281,10 +304,18 @@ class SharedBatchScheduler
                               BatchUniquePtr* batch_to_process_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Asks the queue with a latency SLO whose next schedulable batch has the
+  // earliest deadline for that batch. Leaves the outputs untouched if no such
+  // queue has a schedulable batch.
+  void GetEarliestDeadlineWorkItem_Locked(
+      internal::Queue<TaskType>** queue_for_batch_out,
+      BatchUniquePtr* batch_to_process_out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
-  // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
-  // queue declines to provide a batch to process, moves onto the next queue. If
-  // no queues provide a batch to process, just sleeps briefly and exits.
+  // queue with the earliest deadline if there is one, or else from the queue
+  // pointed to by 'next_queue_to_schedule_', and processes it. If that queue
+  // declines to provide a batch to process, moves onto the next queue. If no
+  // queues provide a batch to process, just sleeps briefly and exits.
   void ThreadLogic();
 
   // Called by `AddQueue`.
@@ -312,6 +343,9 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
 
+  // The number of queues in 'queues_' that have a latency SLO.
+  int num_queues_with_latency_slo_ TF_GUARDED_BY(mu_) = 0;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -428,6 +462,13 @@ class Queue {
 
   bool closed() const TF_NO_THREAD_SAFETY_ANALYSIS { return closed_.load(); }
 
+  int64_t latency_slo_micros() const { return options_.latency_slo_micros; }
+
+  // Returns the deadline of the oldest task of the batch that the next call to
+  // ScheduleBatch() would return, or nullopt if the queue has no latency SLO
+  // or no schedulable batch.
+  std::optional<uint64> NextBatchDeadlineMicros() const;
+
  private:
   // Computes the max_execution_batch_size of the queue based on queue options.
   static size_t GetMaxExecutionBatchSize(
@@ -461,6 +502,13 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves the tasks of `batch` that have missed the latency SLO into
+  // `expired_tasks_`. `enqueue_times_micros` holds the enqueue time of each
+  // task in `batch`.
+  void ShedExpiredTasks(const std::vector<uint64>& enqueue_times_micros,
+                        std::unique_ptr<Batch<TaskType>>* batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   Status SplitInputBatchIntoSubtasks(
       std::unique_ptr<TaskType>* input_task,
@@ -582,6 +630,17 @@ class Queue {
   std::deque<std::unique_ptr<Batch<TaskType>>> high_priority_batches_
       TF_GUARDED_BY(mu_);
 
+  // The enqueue time of each task in the corresponding element of
+  // `high_priority_batches_`.
+  //
+  // Used iff `QueueOptions.latency_slo_micros` is positive.
+  std::deque<std::vector<uint64>> high_priority_enqueue_times_micros_
+      TF_GUARDED_BY(mu_);
+
+  // Tasks shed by ScheduleBatch() for missing the latency SLO, to be passed to
+  // `options_.expired_task_callback` by the next ProcessBatch().
+  std::vector<std::unique_ptr<TaskType>> expired_tasks_ TF_GUARDED_BY(mu_);
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -722,6 +781,25 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "enable_large_batch_splitting is enabled.");
   }
 
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros);
+  }
+
+  if (options.latency_slo_micros > 0) {
+    if (options.enable_lazy_split) {
+      return errors::InvalidArgument(
+          "latency_slo_micros is not supported with enable_lazy_split.");
+    }
+    if (options.expired_task_callback == nullptr) {
+      return errors::InvalidArgument(
+          "expired_task_callback must be specified when latency_slo_micros is "
+          "positive: ",
+          options.latency_slo_micros);
+    }
+  }
+
   if (options.enable_large_batch_splitting &&
       (options.input_batch_size_limit < options.max_execution_batch_size)) {
     return errors::InvalidArgument(
@@ -745,6 +823,9 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
                                           internal_queue.get()));
   {
     mutex_lock l(mu_);
+    if (options.latency_slo_micros > 0) {
+      ++num_queues_with_latency_slo_;
+    }
     queues_.push_back(std::move(internal_queue));
     if (next_queue_to_schedule_ == queues_.end()) {
       next_queue_to_schedule_ = queues_.begin();
@@ -784,6 +865,7 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     BatchUniquePtr* batch_to_process_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  GetEarliestDeadlineWorkItem_Locked(&queue_for_batch, &batch_to_process);
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -808,6 +890,9 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
         !BatchExists(batch_to_process)) {
       // We've encountered a closed queue with no work to do. Drop it.
       DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
+      if ((*next_queue_to_schedule_)->latency_slo_micros() > 0) {
+        --num_queues_with_latency_slo_;
+      }
       next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
     } else {
       ++next_queue_to_schedule_;
@@ -821,6 +906,31 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   *batch_to_process_out = std::move(batch_to_process);
 }
 
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::GetEarliestDeadlineWorkItem_Locked(
+    internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
+  if (num_queues_with_latency_slo_ == 0) return;
+  internal::Queue<TaskType>* earliest_queue = nullptr;
+  uint64 earliest_deadline_micros = 0;
+  for (const auto& queue : queues_) {
+    const std::optional<uint64> deadline_micros =
+        queue->NextBatchDeadlineMicros();
+    if (deadline_micros.has_value() &&
+        (earliest_queue == nullptr ||
+         *deadline_micros < earliest_deadline_micros)) {
+      earliest_queue = queue.get();
+      earliest_deadline_micros = *deadline_micros;
+    }
+  }
+  if (earliest_queue == nullptr) return;
+  BatchUniquePtr batch_to_process = earliest_queue->ScheduleBatch();
+  if (BatchExists(batch_to_process)) {
+    *queue_for_batch_out = earliest_queue;
+    *batch_to_process_out = std::move(batch_to_process);
+  }
+}
+
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::ThreadLogic() {
   // A batch to process next (or nullptr if no work to do).
@@ -865,10 +975,15 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
         std::move(absl::get<BatchTaskUniqueptr>(batch_to_process));
   }
 
-  size_t batch_size_to_schedule = batch_to_schedule->size();
-  queue_for_batch->ProcessBatch(
-      std::move(batch_to_schedule),
-      queue_for_batch->GetLowPriorityTasksForPadding(batch_size_to_schedule));
+  // The batch is empty if all of its tasks missed the latency SLO, in which
+  // case there is nothing to pad.
+  std::vector<std::unique_ptr<TaskType>> padding_tasks;
+  if (!batch_to_schedule->empty()) {
+    padding_tasks = queue_for_batch->GetLowPriorityTasksForPadding(
+        batch_to_schedule->size());
+  }
+  queue_for_batch->ProcessBatch(std::move(batch_to_schedule),
+                                std::move(padding_tasks));
 }
 
 namespace internal {
@@ -894,6 +1009,9 @@ Queue<TaskType>::Queue(
         new Batch<BatchInputTaskHandle<TaskType>>);
   } else {
     GetBatches().emplace_back(new Batch<TaskType>);
+    if (options_.latency_slo_micros > 0) {
+      high_priority_enqueue_times_micros_.emplace_back();
+    }
   }
 }
 
@@ -1027,13 +1145,17 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     TF_RETURN_IF_ERROR(SplitInputBatchIntoSubtasks(task, &output_tasks));
   }
 
+  const uint64 now_micros = env_->NowMicros();
   for (int i = 0; i < output_tasks.size(); ++i) {
     if (batches.back()->size() + output_tasks[i]->size() >
         max_execution_batch_size()) {
       StartNewBatch();
     }
     if (batches.back()->empty()) {
-      open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_start_time_micros_ = now_micros;
+    }
+    if (options_.latency_slo_micros > 0) {
+      high_priority_enqueue_times_micros_.back().push_back(now_micros);
     }
     profiler::TraceMeProducer trace_me(
         [&output_tasks, i] {
@@ -1230,6 +1352,11 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       // There is at least one closed batch that is ready to be scheduled.
       batch_to_schedule = std::move(batches.front());
       batches.pop_front();
+      if (options_.latency_slo_micros > 0) {
+        ShedExpiredTasks(high_priority_enqueue_times_micros_.front(),
+                         &batch_to_schedule);
+        high_priority_enqueue_times_micros_.pop_front();
+      }
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1335,13 +1462,27 @@ void Queue<TaskType>::ProcessBatch(
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
-  if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
-          process_batch_callback_)) {
-    std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
-        std::move(batch));
-  } else {
-    std::get<ProcessBatchCallbackWithPaddingTasks>(process_batch_callback_)(
-        std::move(batch), std::move(padding_task));
+  if (options_.latency_slo_micros > 0) {
+    std::vector<std::unique_ptr<TaskType>> expired_tasks;
+    {
+      mutex_lock l(mu_);
+      expired_tasks.swap(expired_tasks_);
+    }
+    for (std::unique_ptr<TaskType>& task : expired_tasks) {
+      options_.expired_task_callback(std::move(task));
+    }
+  }
+
+  // The batch is empty if all of its tasks missed the latency SLO.
+  if (!batch->empty()) {
+    if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
+            process_batch_callback_)) {
+      std::get<ProcessBatchCallbackWithoutPaddingTasks>(
+          process_batch_callback_)(std::move(batch));
+    } else {
+      std::get<ProcessBatchCallbackWithPaddingTasks>(process_batch_callback_)(
+          std::move(batch), std::move(padding_task));
+    }
   }
 
   {
@@ -1398,6 +1539,38 @@ void Queue<TaskType>::StartNewBatch() {
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
   batches.back()->Close();
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
+  if (options_.latency_slo_micros > 0) {
+    high_priority_enqueue_times_micros_.emplace_back();
+  }
+}
+
+template <typename TaskType>
+void Queue<TaskType>::ShedExpiredTasks(
+    const std::vector<uint64>& enqueue_times_micros,
+    std::unique_ptr<Batch<TaskType>>* batch) {
+  DCHECK_EQ(enqueue_times_micros.size(), (*batch)->num_tasks());
+  // Tasks are added in enqueue order, so the expired ones form a prefix.
+  const uint64 now_micros = env_->NowMicros();
+  int num_expired = 0;
+  while (num_expired < enqueue_times_micros.size() &&
+         enqueue_times_micros[num_expired] + options_.latency_slo_micros <
+             now_micros) {
+    ++num_expired;
+  }
+  if (num_expired == 0) return;
+
+  std::vector<std::unique_ptr<TaskType>> tasks = (*batch)->RemoveAllTasks();
+  auto remaining_batch =
+      std::make_unique<Batch<TaskType>>((*batch)->traceme_context_id());
+  for (int i = 0; i < tasks.size(); ++i) {
+    if (i < num_expired) {
+      expired_tasks_.push_back(std::move(tasks[i]));
+    } else {
+      remaining_batch->AddTask(std::move(tasks[i]));
+    }
+  }
+  remaining_batch->Close();
+  *batch = std::move(remaining_batch);
 }
 
 template <typename TaskType>
@@ -1422,6 +1595,19 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
              open_batch_start_time_micros_ + options_.batch_timeout_micros;
 }
 
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::NextBatchDeadlineMicros() const {
+  if (options_.latency_slo_micros <= 0) return std::nullopt;
+  mutex_lock l(mu_);
+  if (GetBatches().size() < 2 && !IsOpenBatchSchedulable()) {
+    return std::nullopt;
+  }
+  const std::vector<uint64>& enqueue_times_micros =
+      high_priority_enqueue_times_micros_.front();
+  if (enqueue_times_micros.empty()) return std::nullopt;
+  return enqueue_times_micros.front() + options_.latency_slo_micros;
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (!options_.enable_lazy_split) {
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -1615,6 +1617,178 @@ INSTANTIATE_TEST_SUITE_P(
                       std::make_tuple(/*enable_input_batch_split=*/false,
                                       /*enable_lazy_split=*/false)));
 
+// Creates QueueOptions for a queue with the given latency SLO, whose expired
+// tasks are passed to `expired_task_callback`.
+QueueOptions CreateLatencySloQueueOptions(
+    size_t max_execution_batch_size, size_t batch_timeout_micros,
+    int64_t latency_slo_micros,
+    std::function<void(std::unique_ptr<FakeTask>)> expired_task_callback) {
+  QueueOptions queue_options = CreateQueueOptions(
+      max_execution_batch_size, max_execution_batch_size, batch_timeout_micros,
+      /*max_enqueued_batches=*/100, /*enable_large_batch_splitting=*/false,
+      /*enable_lazy_split=*/false, /*split_func=*/nullptr);
+  queue_options.latency_slo_micros = latency_slo_micros;
+  queue_options.expired_task_callback = std::move(expired_task_callback);
+  return queue_options;
+}
+
+TEST(SharedBatchSchedulerLatencySloTest, InvalidOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto expired_task_callback = [](std::unique_ptr<FakeTask> task) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  std::unique_ptr<Queue> queue;
+
+  EXPECT_THAT(scheduler->AddQueue(
+                  CreateLatencySloQueueOptions(10, 0, -1, expired_task_callback),
+                  callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("latency_slo_micros")));
+  EXPECT_THAT(
+      scheduler->AddQueue(CreateLatencySloQueueOptions(10, 0, 100, nullptr),
+                          callback, &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        HasSubstr("expired_task_callback")));
+
+  QueueOptions lazy_split_options =
+      CreateLatencySloQueueOptions(10, 0, 100, expired_task_callback);
+  lazy_split_options.enable_large_batch_splitting = true;
+  lazy_split_options.enable_lazy_split = true;
+  lazy_split_options.split_input_task_func =
+      [](std::unique_ptr<FakeTask>* input_task, int open_batch_remaining_slot,
+         int max_batch_size,
+         std::vector<std::unique_ptr<FakeTask>>* output_tasks) -> Status {
+    output_tasks->push_back(std::move(*input_task));
+    return absl::OkStatus();
+  };
+  EXPECT_THAT(scheduler->AddQueue(lazy_split_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("enable_lazy_split")));
+}
+
+TEST(SharedBatchSchedulerLatencySloTest, ShedsExpiredTasks) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_started, first_batch_proceed,
+        second_batch_processed;
+    std::vector<size_t> second_batch_task_sizes;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_started.HasBeenNotified()) {
+        first_batch_started.Notify();
+        first_batch_proceed.WaitForNotification();
+        return;
+      }
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        second_batch_task_sizes.push_back(batch->task(i).size());
+      }
+      second_batch_processed.Notify();
+    };
+    std::vector<size_t> expired_task_sizes;
+    auto expired_task_callback = [&](std::unique_ptr<FakeTask> task) {
+      expired_task_sizes.push_back(task->size());
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    auto queue = CreateQueue(
+        scheduler,
+        CreateLatencySloQueueOptions(/*max_execution_batch_size=*/10,
+                                     /*batch_timeout_micros=*/10,
+                                     /*latency_slo_micros=*/100,
+                                     expired_task_callback),
+        callback);
+
+    // Occupy the only batch thread.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    first_batch_started.WaitForNotification();
+
+    // The first task has missed its deadline by the time the thread frees up,
+    // while the second one can still meet it.
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    env.AdvanceByMicroseconds(50);
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    env.AdvanceByMicroseconds(60);
+    first_batch_proceed.Notify();
+
+    second_batch_processed.WaitForNotification();
+    EXPECT_EQ(expired_task_sizes, std::vector<size_t>({2}));
+    EXPECT_EQ(second_batch_task_sizes, std::vector<size_t>({3}));
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerLatencySloTest, EarliestDeadlineFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_started, first_batch_proceed, all_processed;
+    std::vector<int> processed_queues;
+    auto make_callback = [&](int queue_index) {
+      return [&, queue_index](std::unique_ptr<Batch<FakeTask>> batch) {
+        if (!first_batch_started.HasBeenNotified()) {
+          first_batch_started.Notify();
+          first_batch_proceed.WaitForNotification();
+          return;
+        }
+        processed_queues.push_back(queue_index);
+        if (processed_queues.size() == 3) {
+          all_processed.Notify();
+        }
+      };
+    };
+    auto expired_task_callback = [](std::unique_ptr<FakeTask> task) {
+      ADD_FAILURE() << "Unexpected expired task";
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    std::vector<std::unique_ptr<Queue>> queues;
+    // Queue 0 has no latency SLO, and queue 2 has a tighter one than queue 1.
+    queues.push_back(CreateQueue(
+        scheduler,
+        CreateQueueOptions(10, 10, /*batch_timeout_micros=*/10,
+                           /*max_enqueued_batches=*/100,
+                           /*enable_large_batch_splitting=*/false,
+                           /*enable_lazy_split=*/false, /*split_func=*/nullptr),
+        make_callback(0)));
+    queues.push_back(CreateQueue(
+        scheduler,
+        CreateLatencySloQueueOptions(10, /*batch_timeout_micros=*/10,
+                                     /*latency_slo_micros=*/1000,
+                                     expired_task_callback),
+        make_callback(1)));
+    queues.push_back(CreateQueue(
+        scheduler,
+        CreateLatencySloQueueOptions(10, /*batch_timeout_micros=*/10,
+                                     /*latency_slo_micros=*/100,
+                                     expired_task_callback),
+        make_callback(2)));
+
+    // Occupy the only batch thread, which moves the round-robin rotation on to
+    // queue 1.
+    TF_ASSERT_OK(ScheduleTask(10, queues[0].get()));
+    first_batch_started.WaitForNotification();
+
+    for (const auto& queue : queues) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    env.AdvanceByMicroseconds(10);
+    first_batch_proceed.Notify();
+
+    all_processed.WaitForNotification();
+    EXPECT_EQ(processed_queues, std::vector<int>({2, 1, 0}));
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 #ifdef PLATFORM_GOOGLE
 // This benchmark relies on https://github.com/google/benchmark features,
 // (in particular, `Benchmark::ThreadRange`) not available in open-sourced TF
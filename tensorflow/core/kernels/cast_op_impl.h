@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_CAST_OP_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_CAST_OP_IMPL_H_
 
+#include <array>
 #include <cstdint>
 #include <limits>
 
@@ -69,6 +70,55 @@ VALIDATE_CAST(int64, double);
 
 CAST_FUNCTORS(Eigen::ThreadPoolDevice);
 
+// Widens float8 values through a table of all 256 converted values. The table
+// is built with the scalar conversion, so the results match it bit for bit,
+// while each element only costs a load instead of a branchy decode.
+template <typename OUT_TYPE, typename IN_TYPE>
+struct Float8TableCastFunctor {
+  static_assert(sizeof(IN_TYPE) == 1, "Only 8 bit inputs have a table");
+
+  static const OUT_TYPE* Table() {
+    static const std::array<OUT_TYPE, 256>* table = [] {
+      auto* table = new std::array<OUT_TYPE, 256>;
+      for (int i = 0; i < 256; ++i) {
+        (*table)[i] = static_cast<OUT_TYPE>(
+            Eigen::numext::bit_cast<IN_TYPE>(static_cast<uint8_t>(i)));
+      }
+      return table;
+    }();
+    return table->data();
+  }
+
+  struct Lookup {
+    EIGEN_STRONG_INLINE OUT_TYPE operator()(const IN_TYPE x) const {
+      return table[Eigen::numext::bit_cast<uint8_t>(x)];
+    }
+    const OUT_TYPE* table;
+  };
+
+  void operator()(const Eigen::ThreadPoolDevice& d,
+                  typename TTypes<OUT_TYPE>::Flat out_tensor,
+                  typename TTypes<IN_TYPE>::ConstFlat in_tensor,
+                  bool truncate = false) const {
+    out_tensor.device(d) = in_tensor.unaryExpr(Lookup{Table()});
+  }
+};
+
+#define SPECIALIZE_FLOAT8_TABLE_CAST(OUT_TYPE, IN_TYPE)          \
+  template <>                                                    \
+  struct CastFunctor<Eigen::ThreadPoolDevice, OUT_TYPE, IN_TYPE> \
+      : Float8TableCastFunctor<OUT_TYPE, IN_TYPE> {};
+
+SPECIALIZE_FLOAT8_TABLE_CAST(float, float8_e5m2)
+SPECIALIZE_FLOAT8_TABLE_CAST(double, float8_e5m2)
+SPECIALIZE_FLOAT8_TABLE_CAST(Eigen::half, float8_e5m2)
+SPECIALIZE_FLOAT8_TABLE_CAST(bfloat16, float8_e5m2)
+SPECIALIZE_FLOAT8_TABLE_CAST(float, float8_e4m3fn)
+SPECIALIZE_FLOAT8_TABLE_CAST(double, float8_e4m3fn)
+SPECIALIZE_FLOAT8_TABLE_CAST(Eigen::half, float8_e4m3fn)
+SPECIALIZE_FLOAT8_TABLE_CAST(bfloat16, float8_e4m3fn)
+#undef SPECIALIZE_FLOAT8_TABLE_CAST
+
 
 }  // namespace functor
 
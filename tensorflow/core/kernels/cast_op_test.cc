@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -78,6 +79,26 @@ class CastOpTest : public OpsTestBase {
                              {OUTPUT(1), OUTPUT(2), OUTPUT(3), OUTPUT(4)});
     test::ExpectTensorEqual<OUTPUT>(expected, *GetOutput(0));
   }
+
+  // Checks the cast of every float8 value against the scalar conversion.
+  template <typename INPUT, typename OUTPUT>
+  void CheckAllFloat8Values() {
+    MakeOp(DataTypeToEnum<INPUT>::v(), DataTypeToEnum<OUTPUT>::v(), false);
+    std::vector<INPUT> inputs;
+    std::vector<OUTPUT> outputs;
+    for (int i = 0; i < 256; ++i) {
+      const INPUT value =
+          Eigen::numext::bit_cast<INPUT>(static_cast<uint8_t>(i));
+      inputs.push_back(value);
+      outputs.push_back(static_cast<OUTPUT>(value));
+    }
+    AddInputFromArray<INPUT>(TensorShape({256}), inputs);
+    TF_ASSERT_OK(RunOpKernel());
+    Tensor expected(allocator(), DataTypeToEnum<OUTPUT>::v(),
+                    TensorShape({256}));
+    test::FillValues<OUTPUT>(&expected, outputs);
+    test::ExpectTensorEqual<OUTPUT>(expected, *GetOutput(0));
+  }
 };
 
 #define TEST_CAST(in, out)                                                   \
@@ -156,6 +177,22 @@ TEST_CAST(uint4, uint4)
 #undef TEST_INT_CASTS_TO
 #undef TEST_CAST
 
+#define TEST_FLOAT8_CAST(in, out)                         \
+  TEST_F(CastOpTest, TestCastAllValues_##_##in##_##out) { \
+    CheckAllFloat8Values<in, out>();                      \
+  }
+
+TEST_FLOAT8_CAST(float8_e5m2, float)
+TEST_FLOAT8_CAST(float8_e5m2, double)
+TEST_FLOAT8_CAST(float8_e5m2, half)
+TEST_FLOAT8_CAST(float8_e5m2, bfloat16)
+TEST_FLOAT8_CAST(float8_e4m3fn, float)
+TEST_FLOAT8_CAST(float8_e4m3fn, double)
+TEST_FLOAT8_CAST(float8_e4m3fn, half)
+TEST_FLOAT8_CAST(float8_e4m3fn, bfloat16)
+
+#undef TEST_FLOAT8_CAST
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(::testing::benchmark::State& state) {
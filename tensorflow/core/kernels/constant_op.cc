@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+#include "tensorflow/core/util/shared_tensor_registry.h"
 
 namespace tensorflow {
 
@@ -86,6 +87,11 @@ ConstantOp::ConstantOp(OpKernelConstruction* ctx)
       errors::InvalidArgument("Type mismatch between value (",
                               DataTypeString(tensor_.dtype()), ") and dtype (",
                               DataTypeString(ctx->output_type(0)), ")"));
+  if (ctx->device_type() == DEVICE_CPU && ShareReadOnlyTensorsEnabled()) {
+    // Shares the value with identical constants of other graphs in this
+    // process, e.g. other instances of the same model.
+    tensor_ = SharedTensorRegistry::Global()->Intern(tensor_);
+  }
 }
 
 void ConstantOp::Compute(OpKernelContext* ctx) {
@@ -17,6 +17,8 @@ limitations under the License.
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -32,12 +34,14 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
+#include "tensorflow/core/kernels/data/cache_spill_file.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
@@ -76,6 +80,17 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+constexpr char kSpillCheckpointErrorMessage[] =
+    "Saving the iterator of a memory cache whose elements have been spilled "
+    "to disk is not supported. Unset TF_DATA_CACHE_SPILL_DIR or use a file "
+    "cache instead.";
+// Name of the environment variable that enables the spill tier of the memory
+// cache. When set to a local directory, elements that do not fit in the RAM
+// budget of the iterator are written to a spill file in that directory
+// instead of being held in memory.
+constexpr char kSpillDirEnvVar[] = "TF_DATA_CACHE_SPILL_DIR";
+// Number of spilled elements that are read ahead of the consumer.
+constexpr size_t kSpillPrefetchBufferSize = 16;
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -760,10 +775,12 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             std::string spill_directory)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        spill_directory_(std::move(spill_directory)) {
     input_->Ref();
     random_indexing_compatible_ = input_->RandomIndexingCompatible();
   }
@@ -876,6 +893,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                         IteratorStateWriter* writer) override {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
+        if (cache_->spill_file() != nullptr) {
+          return errors::Unimplemented(kSpillCheckpointErrorMessage);
+        }
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
@@ -909,7 +929,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if ((!temp_cache_.empty() || spill_file_ != nullptr) &&
+            !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
@@ -929,16 +950,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(CompleteCache());
           }
           return absl::OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        TF_RETURN_IF_ERROR(AddToCache(ctx, *out_tensors));
+        const int64_t num_spilled = spill_file_ ? spill_file_->size() : 0;
+        if (temp_cache_.size() + num_spilled ==
+            dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(CompleteCache());
         }
         return absl::OkStatus();
       }
@@ -954,6 +976,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
+          if (spill_file_ != nullptr) {
+            return errors::Unimplemented(kSpillCheckpointErrorMessage);
+          }
           TF_RETURN_IF_ERROR(
               WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
         }
@@ -971,10 +996,45 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       }
 
      private:
+      // Holds `element` in memory if the spill tier is disabled or the element
+      // fits in the RAM budget. Otherwise, appends it and all subsequent
+      // elements to the spill file so that spilled elements are always the
+      // suffix of the cache.
+      Status AddToCache(IteratorContext* ctx, const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_file_ == nullptr && !dataset()->spill_directory_.empty() &&
+            ctx->ram_budget_manager() != nullptr &&
+            !cache_->ReserveBytes(ctx->ram_budget_manager(),
+                                  GetAllocatedBytes(element))) {
+          TF_ASSIGN_OR_RETURN(spill_file_,
+                              CacheSpillFile::Create(
+                                  ctx->env(), dataset()->spill_directory_));
+          VLOG(2) << "Spilling cache elements starting at index "
+                  << temp_cache_.size() << " to " << spill_file_->filename();
+        }
+        if (spill_file_ != nullptr) {
+          return spill_file_->Append(element);
+        }
+        RecordBufferEnqueue(ctx, element);
+        temp_cache_.emplace_back(element);
+        return absl::OkStatus();
+      }
+
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_file_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_file_->Finalize());
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spill_file_));
+        return absl::OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      // Elements that did not fit in the RAM budget. Only set when the spill
+      // tier is enabled.
+      std::unique_ptr<CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -984,6 +1044,12 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
             cache_(cache),
             index_(0) {}
 
+      ~MemoryReaderIterator() override {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+
       Status Initialize(IteratorContext* ctx) override {
         // The memory allocated for the cache is owned by the parent
         // dataset but performance modeling uses the iterator abstraction and
@@ -991,7 +1057,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
+        for (size_t i = 0; i < cache_->memory_size(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
         return absl::OkStatus();
@@ -1001,13 +1067,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
-        if (index_ < cache_->size()) {
+        if (index_ < cache_->memory_size()) {
           const std::vector<Tensor>& cache_tensors = cache_->at(index_);
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
           index_++;
           *end_of_sequence = false;
           return absl::OkStatus();
+        } else if (index_ < cache_->size()) {
+          return GetSpilledElement(ctx, l, out_tensors, end_of_sequence);
         } else {
           *end_of_sequence = true;
           return absl::OkStatus();
@@ -1040,13 +1108,92 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           }
           index_ = static_cast<size_t>(temp);
         }
+        // Discard elements read ahead for the previous position.
+        prefetch_buffer_.clear();
+        next_prefetch_index_ = index_;
+        ++prefetch_generation_;
+        cond_var_.notify_all();
         return absl::OkStatus();
       }
 
      private:
+      struct PrefetchedElement {
+        Status status;
+        std::vector<Tensor> value;
+      };
+
+      Status GetSpilledElement(IteratorContext* ctx, mutex_lock& l,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!prefetch_thread_) {
+          next_prefetch_index_ = index_;
+          prefetch_thread_ = ctx->StartThread(
+              "tf_data_cache_spill_prefetch", [this]() { PrefetchThread(); });
+        }
+        while (!cancelled_ && prefetch_buffer_.empty()) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        PrefetchedElement element = std::move(prefetch_buffer_.front());
+        prefetch_buffer_.pop_front();
+        cond_var_.notify_all();
+        TF_RETURN_IF_ERROR(element.status);
+        out_tensors->insert(out_tensors->begin(),
+                            std::make_move_iterator(element.value.begin()),
+                            std::make_move_iterator(element.value.end()));
+        index_++;
+        *end_of_sequence = false;
+        return absl::OkStatus();
+      }
+
+      // Reads spilled elements ahead of the consumer so that the file reads
+      // and deserialization overlap with downstream processing.
+      void PrefetchThread() {
+        while (true) {
+          MemoryCache* cache;
+          size_t index;
+          int64_t generation;
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ &&
+                   (prefetch_buffer_.size() >= kSpillPrefetchBufferSize ||
+                    next_prefetch_index_ >= cache_->size())) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) {
+              return;
+            }
+            cache = cache_;
+            index = next_prefetch_index_++;
+            generation = prefetch_generation_;
+          }
+          PrefetchedElement element;
+          element.status = cache->Get(index, &element.value);
+          mutex_lock l(mu_);
+          if (generation != prefetch_generation_) {
+            continue;
+          }
+          prefetch_buffer_.push_back(std::move(element));
+          cond_var_.notify_all();
+        }
+      }
+
       mutex mu_;
+      condition_variable cond_var_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
+      // Spilled elements read ahead of `index_`, in order.
+      std::deque<PrefetchedElement> prefetch_buffer_ TF_GUARDED_BY(mu_);
+      size_t next_prefetch_index_ TF_GUARDED_BY(mu_) = 0;
+      // Incremented whenever the read position changes so that elements read
+      // for a stale position are dropped.
+      int64_t prefetch_generation_ TF_GUARDED_BY(mu_) = 0;
+      // Must be destroyed before the members it accesses.
+      std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -1075,6 +1222,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // Directory of the spill tier, or empty if the spill tier is disabled.
+  const std::string spill_directory_;
   mutable std::unique_ptr<DatasetRandomAccessCache> dataset_random_access_cache_
       TF_GUARDED_BY(mu_);
   mutable std::unique_ptr<IteratorRandomAccessCache>
@@ -1088,8 +1237,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                std::string spill_directory)
+      : MemoryDatasetBase(ctx, input, manager->get(),
+                          std::move(spill_directory)),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -1130,8 +1281,9 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, std::string spill_directory)
+      : MemoryDatasetBase(ctx, input, manager->get(),
+                          std::move(spill_directory)),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1182,6 +1334,9 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   tstring filename;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
   if (filename.empty()) {
+    std::string spill_directory;
+    OP_REQUIRES_OK(ctx, ReadStringFromEnvVar(kSpillDirEnvVar, "",
+                                             &spill_directory));
     static std::atomic<int64_t> resource_id_counter(0);
     const string& container = ctx->resource_manager()->default_container();
     auto name = strings::StrCat(ctx->op_kernel().name(), "/", kMemoryCache, "_",
@@ -1207,7 +1362,7 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, std::move(spill_directory));
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1219,7 +1374,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  std::move(spill_directory));
     }
   } else {
     if (op_version_ == 2) {
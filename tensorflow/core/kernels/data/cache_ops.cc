@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -33,10 +38,21 @@ constexpr char kMemoryCache[] = "MemoryCache";
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+MemoryCache::~MemoryCache() {
+  mutex_lock l(mu_);
+  ReleaseBytes();
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*spill_file=*/nullptr);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::unique_ptr<CacheSpillFile> spill_file) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_file_ = std::move(spill_file);
     completed_ = true;
   }
 }
@@ -50,6 +66,8 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_file_.reset();
+  ReleaseBytes();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -58,16 +76,67 @@ const std::vector<Tensor>& MemoryCache::at(int64_t index) {
   return cache_[index];
 }
 
+Status MemoryCache::Get(int64_t index, std::vector<Tensor>* out_tensors) {
+  tf_shared_lock l(mu_);
+  if (index < cache_.size()) {
+    *out_tensors = cache_[index];
+    return absl::OkStatus();
+  }
+  if (spill_file_ == nullptr) {
+    return errors::OutOfRange("Index out of range [0, ", cache_.size(),
+                              "): ", index);
+  }
+  return spill_file_->Read(index - cache_.size(), out_tensors);
+}
+
 size_t MemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return cache_.size() + (spill_file_ ? spill_file_->size() : 0);
+}
+
+size_t MemoryCache::memory_size() {
   tf_shared_lock l(mu_);
   return cache_.size();
 }
 
+const CacheSpillFile* MemoryCache::spill_file() {
+  tf_shared_lock l(mu_);
+  return spill_file_.get();
+}
+
 const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   tf_shared_lock l(mu_);
   return cache_;
 }
 
+bool MemoryCache::ReserveBytes(
+    const std::shared_ptr<model::RamBudgetManager>& ram_budget_manager,
+    int64_t bytes) {
+  mutex_lock l(mu_);
+  if (ram_budget_manager == nullptr) {
+    return false;
+  }
+  if (ram_budget_manager_ != nullptr &&
+      ram_budget_manager_ != ram_budget_manager) {
+    // Bytes are only tracked against a single budget at a time.
+    return false;
+  }
+  if (!ram_budget_manager->RequestCacheBytes(bytes)) {
+    return false;
+  }
+  ram_budget_manager_ = ram_budget_manager;
+  reserved_bytes_ += bytes;
+  return true;
+}
+
+void MemoryCache::ReleaseBytes() {
+  if (ram_budget_manager_ != nullptr && reserved_bytes_ > 0) {
+    ram_budget_manager_->RequestCacheBytes(-reserved_bytes_);
+  }
+  ram_budget_manager_.reset();
+  reserved_bytes_ = 0;
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
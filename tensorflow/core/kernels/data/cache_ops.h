@@ -16,8 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/data/cache_spill_file.h"
 
 namespace tensorflow {
 namespace data {
@@ -27,34 +33,69 @@ namespace data {
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// The cache optionally has a spill tier: the elements that do not fit in the
+// RAM budget reserved through `ReserveBytes()` are kept in a `CacheSpillFile`
+// and are indexed after the in-memory elements.
 class MemoryCache {
  public:
   MemoryCache() = default;
+  ~MemoryCache();
 
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed. The elements of `spill_file` (if not null)
+  // follow the elements of `cache`. `spill_file` must be finalized.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<CacheSpillFile> spill_file);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the in-memory element at the given index.
   const std::vector<Tensor>& at(int64_t index);
 
-  // Returns the size of the cache.
+  // Copies the element at the given index into `out_tensors`, reading it from
+  // the spill tier if it is not held in memory.
+  Status Get(int64_t index, std::vector<Tensor>* out_tensors);
+
+  // Returns the size of the cache, including spilled elements.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
+  // Returns the number of elements held in memory.
+  size_t memory_size();
+
+  // Returns the spill tier of the cache, or nullptr if all elements are held
+  // in memory. The returned pointer will be invalidated by any call to
+  // Reset().
+  const CacheSpillFile* spill_file();
+
+  // Returns a reference to the cache's in-memory data. The returned reference
+  // will be invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
+  // Requests `bytes` from `ram_budget_manager` for an element that is about to
+  // be held in memory. The reserved bytes are released when the cache is reset
+  // or destroyed. Returns whether the request succeeded.
+  bool ReserveBytes(
+      const std::shared_ptr<model::RamBudgetManager>& ram_budget_manager,
+      int64_t bytes);
+
  private:
+  void ReleaseBytes() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<CacheSpillFile> spill_file_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+      TF_GUARDED_BY(mu_);
+  int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
 };
 
 // A resource wrapping a shared instance of a memory cache.
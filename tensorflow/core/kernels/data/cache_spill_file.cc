@@ -0,0 +1,172 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_spill_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kSpillFilePrefix[] = "tf_data_cache_spill";
+constexpr char kSpillFileSuffix[] = ".tfrecord";
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<CacheSpillFile>> CacheSpillFile::Create(
+    Env* env, const std::string& directory) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  std::string filename = io::JoinPath(directory, kSpillFilePrefix);
+  if (!env->CreateUniqueFileName(&filename, kSpillFileSuffix)) {
+    return errors::Internal("Failed to create a unique spill file name in ",
+                            directory);
+  }
+  std::unique_ptr<CacheSpillFile> spill_file(
+      new CacheSpillFile(env, std::move(filename)));
+  TF_RETURN_IF_ERROR(
+      env->NewWritableFile(spill_file->filename_, &spill_file->file_));
+  spill_file->writer_ =
+      std::make_unique<io::RecordWriter>(spill_file->file_.get());
+  return spill_file;
+}
+
+CacheSpillFile::CacheSpillFile(Env* env, std::string filename)
+    : env_(env), filename_(std::move(filename)) {}
+
+CacheSpillFile::~CacheSpillFile() {
+  writer_.reset();
+  file_.reset();
+  region_.reset();
+  random_access_file_.reset();
+  absl::Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cache spill file " << filename_ << ": "
+                 << s;
+  }
+}
+
+absl::Status CacheSpillFile::Append(const std::vector<Tensor>& element) {
+  if (finalized_) {
+    return errors::FailedPrecondition("Cache spill file ", filename_,
+                                      " has already been finalized.");
+  }
+  element_first_record_.push_back(record_offsets_.size());
+  std::string serialized;
+  for (const Tensor& tensor : element) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    serialized.clear();
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Failed to serialize tensor of shape ",
+                              tensor.shape().DebugString(),
+                              " for the cache spill file.");
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(serialized));
+    record_offsets_.push_back(file_size_ + io::RecordWriter::kHeaderSize);
+    record_lengths_.push_back(serialized.size());
+    file_size_ += io::RecordWriter::kHeaderSize + serialized.size() +
+                  io::RecordWriter::kFooterSize;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CacheSpillFile::Finalize() {
+  if (finalized_) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(writer_->Close());
+  TF_RETURN_IF_ERROR(file_->Close());
+  writer_.reset();
+  file_.reset();
+  finalized_ = true;
+  absl::Status s = env_->NewReadOnlyMemoryRegionFromFile(filename_, &region_);
+  if (s.ok() && region_->length() >= file_size_) {
+    return absl::OkStatus();
+  }
+  VLOG(2) << "Reading cache spill file " << filename_
+          << " without a memory mapping: " << s;
+  region_.reset();
+  return env_->NewRandomAccessFile(filename_, &random_access_file_);
+}
+
+absl::Status CacheSpillFile::ReadRecord(uint64_t offset, uint64_t length,
+                                        std::string* scratch,
+                                        StringPiece* record) const {
+  if (region_) {
+    *record = StringPiece(static_cast<const char*>(region_->data()) + offset,
+                          length);
+    return absl::OkStatus();
+  }
+  scratch->resize(length);
+  TF_RETURN_IF_ERROR(
+      random_access_file_->Read(offset, length, record, scratch->data()));
+  if (record->size() != length) {
+    return errors::DataLoss("Truncated record at offset ", offset,
+                            " in cache spill file ", filename_);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CacheSpillFile::Read(int64_t index,
+                                  std::vector<Tensor>* out_tensors) const {
+  if (!finalized_) {
+    return errors::FailedPrecondition("Cache spill file ", filename_,
+                                      " has not been finalized.");
+  }
+  if (index < 0 || index >= size()) {
+    return errors::OutOfRange("Index out of range [0, ", size(), "): ", index);
+  }
+  const int64_t begin = element_first_record_[index];
+  const int64_t end = index + 1 < size() ? element_first_record_[index + 1]
+                                         : record_offsets_.size();
+  out_tensors->clear();
+  out_tensors->reserve(end - begin);
+  std::string scratch;
+  for (int64_t i = begin; i < end; ++i) {
+    StringPiece record;
+    TF_RETURN_IF_ERROR(
+        ReadRecord(record_offsets_[i], record_lengths_[i], &scratch, &record));
+    TensorProto proto;
+    if (!proto.ParseFromArray(record.data(), record.size())) {
+      return errors::DataLoss("Failed to parse tensor ", i - begin,
+                              " of element ", index, " in cache spill file ",
+                              filename_);
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::DataLoss("Invalid tensor ", i - begin, " of element ",
+                              index, " in cache spill file ", filename_);
+    }
+    out_tensors->push_back(std::move(tensor));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
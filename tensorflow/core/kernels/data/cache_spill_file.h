@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_SPILL_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_CACHE_SPILL_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// An append-only local file holding the dataset elements that did not fit in
+// the RAM budget of a `MemoryCache`.
+//
+// Each tensor of an element is written as a TFRecord-framed `TensorProto`.
+// Once `Finalize()` is called, the file is mapped into memory (falling back to
+// positional reads if the file system does not support memory regions) and
+// elements can be read back concurrently through `Read()`. The file is deleted
+// when the object is destroyed.
+class CacheSpillFile {
+ public:
+  // Creates a new, empty spill file in `directory`.
+  static absl::StatusOr<std::unique_ptr<CacheSpillFile>> Create(
+      Env* env, const std::string& directory);
+
+  ~CacheSpillFile();
+
+  CacheSpillFile(const CacheSpillFile&) = delete;
+  CacheSpillFile& operator=(const CacheSpillFile&) = delete;
+
+  // Appends an element to the file. Must not be called after `Finalize()`.
+  absl::Status Append(const std::vector<Tensor>& element);
+
+  // Closes the file for writing and makes it available for reading.
+  absl::Status Finalize();
+
+  // Reads the element at `index`. Must only be called after `Finalize()`. This
+  // method is thread-safe.
+  absl::Status Read(int64_t index, std::vector<Tensor>* out_tensors) const;
+
+  // Returns the number of elements in the file.
+  int64_t size() const { return element_first_record_.size(); }
+
+  // Returns the number of bytes written to the file.
+  uint64_t bytes() const { return file_size_; }
+
+  const std::string& filename() const { return filename_; }
+
+ private:
+  CacheSpillFile(Env* env, std::string filename);
+
+  absl::Status ReadRecord(uint64_t offset, uint64_t length,
+                          std::string* scratch, StringPiece* record) const;
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> writer_;
+  bool finalized_ = false;
+
+  // At most one of the following is set once the file is finalized.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  std::unique_ptr<RandomAccessFile> random_access_file_;
+
+  // File offset and length of the payload of every record, in file order.
+  std::vector<uint64_t> record_offsets_;
+  std::vector<uint64_t> record_lengths_;
+  // Index of the first record of each element.
+  std::vector<int64_t> element_first_record_;
+  uint64_t file_size_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_CACHE_SPILL_FILE_H_
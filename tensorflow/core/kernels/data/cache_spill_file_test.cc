@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_spill_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/cache_ops.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string SpillDirectory() {
+  return io::JoinPath(testing::TmpDir(), "cache_spill_file_test");
+}
+
+std::vector<Tensor> MakeElement(int64_t value) {
+  return {test::AsScalar<int64_t>(value),
+          test::AsTensor<tstring>({"a", "bc"}, {2})};
+}
+
+TEST(CacheSpillFileTest, AppendAndRead) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CacheSpillFile> spill_file,
+      CacheSpillFile::Create(Env::Default(), SpillDirectory()));
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(spill_file->Append(MakeElement(i)));
+  }
+  TF_ASSERT_OK(spill_file->Finalize());
+  EXPECT_EQ(spill_file->size(), 10);
+
+  // Read out of order to exercise random access.
+  for (int64_t i = 9; i >= 0; --i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(spill_file->Read(i, &element));
+    ASSERT_EQ(element.size(), 2);
+    test::ExpectEqual(element[0], MakeElement(i)[0]);
+    test::ExpectEqual(element[1], MakeElement(i)[1]);
+  }
+}
+
+TEST(CacheSpillFileTest, ReadOutOfRange) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CacheSpillFile> spill_file,
+      CacheSpillFile::Create(Env::Default(), SpillDirectory()));
+  TF_ASSERT_OK(spill_file->Append(MakeElement(0)));
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsFailedPrecondition(spill_file->Read(0, &element)));
+  TF_ASSERT_OK(spill_file->Finalize());
+  EXPECT_TRUE(errors::IsOutOfRange(spill_file->Read(1, &element)));
+  EXPECT_TRUE(errors::IsFailedPrecondition(spill_file->Append(MakeElement(1))));
+}
+
+TEST(CacheSpillFileTest, FileIsDeletedOnDestruction) {
+  std::string filename;
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<CacheSpillFile> spill_file,
+        CacheSpillFile::Create(Env::Default(), SpillDirectory()));
+    TF_ASSERT_OK(spill_file->Finalize());
+    filename = spill_file->filename();
+    TF_EXPECT_OK(Env::Default()->FileExists(filename));
+  }
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(filename)));
+}
+
+TEST(MemoryCacheTest, SpilledElementsFollowInMemoryElements) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CacheSpillFile> spill_file,
+      CacheSpillFile::Create(Env::Default(), SpillDirectory()));
+  TF_ASSERT_OK(spill_file->Append(MakeElement(2)));
+  TF_ASSERT_OK(spill_file->Finalize());
+
+  MemoryCache cache;
+  cache.Complete({MakeElement(0), MakeElement(1)}, std::move(spill_file));
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.memory_size(), 2);
+  for (int64_t i = 0; i < 3; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(cache.Get(i, &element));
+    test::ExpectEqual(element[0], MakeElement(i)[0]);
+  }
+  cache.Reset();
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.spill_file(), nullptr);
+}
+
+TEST(MemoryCacheTest, ReservedBytesAreReleasedOnReset) {
+  auto ram_budget_manager =
+      std::make_shared<model::RamBudgetManager>(/*budget=*/100);
+  MemoryCache cache;
+  EXPECT_TRUE(cache.ReserveBytes(ram_budget_manager, 60));
+  EXPECT_FALSE(cache.ReserveBytes(ram_budget_manager, 60));
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 40);
+  cache.Reset();
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 100);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/threadpool_dataset_op.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -38,6 +42,7 @@ namespace experimental {
 /* static */ constexpr const char* const
     PrivateThreadPoolDatasetOp::kDatasetType;
 /* static */ constexpr const char* const PrivateThreadPoolDatasetOp::kDatasetOp;
+/* static */ constexpr const char* const PrivateThreadPoolDatasetOp::kNumaAware;
 
 namespace {
 // To prevent integer overflow issues when allocating threadpool memory for an
@@ -53,6 +58,15 @@ Status ValidateNumThreads(int32_t num_threads) {
   }
   return absl::OkStatus();
 }
+
+// Returns the number of pools to split a private threadpool of `num_threads`
+// threads into.
+int NumPrivateThreadPools(int num_threads, bool numa_aware) {
+  if (!numa_aware || !port::NUMAEnabled()) {
+    return 1;
+  }
+  return std::max(1, std::min(port::NUMANumNodes(), num_threads));
+}
 }  // namespace
 
 class ThreadPoolResource : public ResourceBase {
@@ -433,19 +447,38 @@ void MaxIntraOpParallelismDatasetOp::MakeDataset(OpKernelContext* ctx,
 
 class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
  public:
-  Dataset(OpKernelContext* ctx, const DatasetBase* input, int num_threads)
-      : Dataset(ctx, DatasetContext(ctx), input, num_threads) {}
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int num_threads,
+          bool numa_aware)
+      : Dataset(ctx, DatasetContext(ctx), input, num_threads, numa_aware) {}
 
   Dataset(OpKernelContext* ctx, DatasetContext&& dataset_ctx,
-          const DatasetBase* input, int num_threads)
+          const DatasetBase* input, int num_threads, bool numa_aware)
       : DatasetBase(std::move(dataset_ctx)),
         input_(input),
         num_threads_(num_threads == 0 ? port::MaxParallelism() : num_threads),
+        numa_aware_(numa_aware),
         traceme_metadata_(
             {{"num_threads",
-              strings::Printf("%lld", static_cast<long long>(num_threads_))}}) {
-    thread_pool_ = std::make_unique<thread::ThreadPool>(
-        ctx->env(), ThreadOptions{}, "data_private_threadpool", num_threads_);
+              strings::Printf("%lld", static_cast<long long>(num_threads_))},
+             {"numa_aware", numa_aware ? "true" : "false"}}) {
+    const int num_pools = NumPrivateThreadPools(num_threads_, numa_aware);
+    if (num_pools == 1) {
+      thread_pools_.push_back(std::make_unique<thread::ThreadPool>(
+          ctx->env(), ThreadOptions{}, "data_private_threadpool",
+          num_threads_));
+    } else {
+      // Splits the threads evenly between the NUMA nodes and pins the threads
+      // of each pool to its node.
+      for (int node = 0; node < num_pools; ++node) {
+        ThreadOptions thread_options;
+        thread_options.numa_node = node;
+        const int pool_size =
+            num_threads_ / num_pools + (node < num_threads_ % num_pools);
+        thread_pools_.push_back(std::make_unique<thread::ThreadPool>(
+            ctx->env(), thread_options,
+            strings::StrCat("data_private_threadpool_numa", node), pool_size));
+      }
+    }
     input_->Ref();
   }
 
@@ -490,8 +523,16 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
     Node* num_threads_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(num_threads_, &num_threads_node));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_graph_node, num_threads_node}, output));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    // Only set when true, so that the graph stays compatible with
+    // `ExperimentalPrivateThreadPoolDataset`, which doesn't have the attr.
+    if (numa_aware_) {
+      AttrValue numa_aware_attr;
+      b->BuildAttrValue(numa_aware_, &numa_aware_attr);
+      attrs.emplace_back(kNumaAware, numa_aware_attr);
+    }
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, num_threads_node}, attrs, output));
     return absl::OkStatus();
   }
 
@@ -499,7 +540,9 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          default_pool_(dataset()->next_default_pool_.fetch_add(1) %
+                        dataset()->thread_pools_.size()) {}
 
     Status Initialize(IteratorContext* ctx) override {
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
@@ -508,12 +551,12 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      thread::ThreadPool* pool = dataset()->thread_pool_.get();
+      thread::ThreadPool* pool = dataset()->thread_pools_[GetPool()].get();
       IteratorContext::Params params(ctx);
       params.runner = [pool](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
-      params.runner_threadpool_size = dataset()->num_threads_;
+      params.runner_threadpool_size = pool->NumThreads();
       return input_impl_->GetNext(IteratorContext{std::move(params)},
                                   out_tensors, end_of_sequence);
     }
@@ -542,26 +585,56 @@ class PrivateThreadPoolDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Returns the pool of the NUMA node of the calling thread, so that the
+    // elements are produced near the memory they are consumed from. Callers
+    // without NUMA affinity use the default pool of the iterator.
+    size_t GetPool() const {
+      if (dataset()->thread_pools_.size() == 1) {
+        return 0;
+      }
+      const int num_pools = dataset()->thread_pools_.size();
+      const int node = port::NUMAGetThreadNodeAffinity();
+      if (node >= 0 && node < num_pools) {
+        return node;
+      }
+      return default_pool_;
+    }
+
+    // Spreads the iterators of callers without NUMA affinity across the pools.
+    const size_t default_pool_;
     std::unique_ptr<IteratorBase> input_impl_;
   };
 
   const DatasetBase* const input_;
   const int64_t num_threads_;
+  const bool numa_aware_;
   const TraceMeMetadata traceme_metadata_;
-  std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // One pool per NUMA node if `numa_aware_` and the host has several NUMA
+  // nodes, a single pool otherwise.
+  std::vector<std::unique_ptr<thread::ThreadPool>> thread_pools_;
+  mutable std::atomic<size_t> next_default_pool_{0};
 };
 
 /* static */
 void PrivateThreadPoolDatasetOp::MakeDatasetFromOptions(OpKernelContext* ctx,
                                                         DatasetBase* input,
                                                         int32_t num_threads,
+                                                        bool numa_aware,
                                                         DatasetBase** output) {
   OP_REQUIRES_OK(ctx, ValidateNumThreads(num_threads));
   *output = new Dataset(ctx,
                         DatasetContext(DatasetContext::Params(
                             {PrivateThreadPoolDatasetOp::kDatasetType,
                              PrivateThreadPoolDatasetOp::kDatasetOp})),
-                        input, num_threads);
+                        input, num_threads, numa_aware);
+}
+
+PrivateThreadPoolDatasetOp::PrivateThreadPoolDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kNumaAware)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumaAware, &numa_aware_));
+  }
 }
 
 void PrivateThreadPoolDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -571,7 +644,7 @@ void PrivateThreadPoolDatasetOp::MakeDataset(OpKernelContext* ctx,
   OP_REQUIRES_OK(
       ctx, ParseScalarArgument<int64_t>(ctx, "num_threads", &num_threads));
   OP_REQUIRES_OK(ctx, ValidateNumThreads(num_threads));
-  *output = new Dataset(ctx, input, num_threads);
+  *output = new Dataset(ctx, input, num_threads, numa_aware_);
 }
 
 namespace {
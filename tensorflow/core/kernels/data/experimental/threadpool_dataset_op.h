@@ -50,14 +50,15 @@ class PrivateThreadPoolDatasetOp : public UnaryDatasetOpKernel {
  public:
   static constexpr const char* const kDatasetType = "PrivateThreadPoolDataset";
   static constexpr const char* const kDatasetOp = "PrivateThreadPoolDatasetOp";
+  static constexpr const char* const kNumaAware = "numa_aware";
 
   // Executes the logic of the PrivateThreadpoolDatasetOp directly (as
   // opposed to through executing the PrivateThreadpoolDatasetOp op kernel).
   static void MakeDatasetFromOptions(OpKernelContext* ctx, DatasetBase* input,
-                                     int32_t num_threads, DatasetBase** output);
+                                     int32_t num_threads, bool numa_aware,
+                                     DatasetBase** output);
 
-  explicit PrivateThreadPoolDatasetOp(OpKernelConstruction* ctx)
-      : UnaryDatasetOpKernel(ctx) {}
+  explicit PrivateThreadPoolDatasetOp(OpKernelConstruction* ctx);
 
  protected:
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -65,6 +66,9 @@ class PrivateThreadPoolDatasetOp : public UnaryDatasetOpKernel {
 
  private:
   class Dataset;
+
+  // Whether to split the threads into one pool per NUMA node.
+  bool numa_aware_ = false;
 };
 
 }  // namespace experimental
@@ -37,10 +37,12 @@ namespace {
 
 void GetModelDatasetParams(const Options& options,
                            model::AutotuneAlgorithm* algorithm,
-                           int64_t* cpu_budget, int64_t* ram_budget) {
+                           int64_t* cpu_budget, int64_t* ram_budget,
+                           std::string* cache_path) {
   *algorithm = model::AutotuneAlgorithm::HILL_CLIMB;
   *cpu_budget = options.autotune_options().cpu_budget();
   *ram_budget = options.autotune_options().ram_budget();
+  *cache_path = options.autotune_options().cache_path();
 }
 
 void MakeDatasetHelper(OpKernelContext* ctx, bool has_captured_ref,
@@ -58,7 +60,7 @@ void MakeDatasetHelper(OpKernelContext* ctx, bool has_captured_ref,
   if (ShouldUsePrivateThreadPool(options)) {
     experimental::PrivateThreadPoolDatasetOp::MakeDatasetFromOptions(
         ctx, input, options.threading_options().private_threadpool_size(),
-        output);
+        options.threading_options().private_threadpool_numa_aware(), output);
     input->Unref();
     input = *output;
   }
@@ -66,9 +68,11 @@ void MakeDatasetHelper(OpKernelContext* ctx, bool has_captured_ref,
     model::AutotuneAlgorithm algorithm;
     int64_t cpu_budget;
     int64_t ram_budget;
-    GetModelDatasetParams(options, &algorithm, &cpu_budget, &ram_budget);
+    std::string cache_path;
+    GetModelDatasetParams(options, &algorithm, &cpu_budget, &ram_budget,
+                          &cache_path);
     ModelDatasetOp::MakeDatasetFromOptions(ctx, input, algorithm, cpu_budget,
-                                           ram_budget, output);
+                                           ram_budget, cache_path, output);
     input->Unref();
     input = *output;
   }
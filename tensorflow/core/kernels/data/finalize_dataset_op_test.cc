@@ -94,6 +94,14 @@ constexpr char kPrivateThreadPoolOptions[] = R"pb(
   optimization_options { apply_default_optimizations: false }
   threading_options { private_threadpool_size: 10 }
 )pb";
+constexpr char kNumaAwarePrivateThreadPoolOptions[] = R"pb(
+  autotune_options { enabled: false }
+  optimization_options { apply_default_optimizations: false }
+  threading_options {
+    private_threadpool_size: 10
+    private_threadpool_numa_aware: true
+  }
+)pb";
 constexpr char kModelOptions[] = R"pb(
   optimization_options { apply_default_optimizations: false }
 )pb";
@@ -138,6 +146,17 @@ OptionsDatasetParams PrivateThreadPoolOptionsParams() {
                               /*node_name=*/"options_dataset_0");
 }
 
+OptionsDatasetParams NumaAwarePrivateThreadPoolOptionsParams() {
+  Options options;
+  protobuf::TextFormat::ParseFromString(kNumaAwarePrivateThreadPoolOptions,
+                                        &options);
+  return OptionsDatasetParams(RangeDatasetParams(0, 10, 3),
+                              options.SerializeAsString(),
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/"options_dataset_0");
+}
+
 OptionsDatasetParams ModelOptionsParams() {
   Options options;
   protobuf::TextFormat::ParseFromString(kModelOptions, &options);
@@ -189,6 +208,13 @@ FinalizeDatasetParams PrivateThreadPoolParams() {
                                /*node_name=*/"PrivateThreadPoolDatasetOp");
 }
 
+FinalizeDatasetParams NumaAwarePrivateThreadPoolParams() {
+  return FinalizeDatasetParams(NumaAwarePrivateThreadPoolOptionsParams(),
+                               /*output_dtypes=*/{DT_INT64},
+                               /*output_shapes=*/{PartialTensorShape({})},
+                               /*node_name=*/"PrivateThreadPoolDatasetOp");
+}
+
 FinalizeDatasetParams ModelParams() {
   return FinalizeDatasetParams(ModelOptionsParams(),
                                /*output_dtypes=*/{DT_INT64},
@@ -227,6 +253,9 @@ std::vector<GetNextTestCase<FinalizeDatasetParams>> GetNextTestCases() {
           {/*dataset_params=*/PrivateThreadPoolParams(),
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape({}), {{0}, {3}, {6}, {9}})},
+          {/*dataset_params=*/NumaAwarePrivateThreadPoolParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {3}, {6}, {9}})},
           {/*dataset_params=*/ModelParams(),
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape({}), {{0}, {3}, {6}, {9}})},
@@ -15,14 +15,17 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/interleave_dataset_op.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/flat_map_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
@@ -34,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -82,8 +86,10 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
             {{"block_length",
               strings::Printf("%lld", static_cast<long long>(block_length))},
              {"cycle_length",
-              strings::Printf("%lld", static_cast<long long>(cycle_length))}}) {
+              strings::Printf("%lld", static_cast<long long>(cycle_length))}}),
+        random_access_handler_(ctx, input, *captured_func_) {
     input_->Ref();
+    random_indexing_compatible_ = input_->RandomIndexingCompatible();
   }
 
   ~Dataset() override { input_->Unref(); }
@@ -104,6 +110,20 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType);
   }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+        CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<int64_t> cardinality = random_access_handler_.Cardinality();
+    if (!cardinality.ok()) {
+      LOG(ERROR) << "Unable to compute cardinality for dataset "
+                 << DebugString() << " due to error: " << cardinality.status();
+      return kUnknownCardinality;
+    }
+    return *cardinality;
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     inputs->push_back(input_);
     return absl::OkStatus();
@@ -114,6 +134,10 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  absl::Status RandomIndexingCompatible() const override {
+    return random_indexing_compatible_;
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -187,6 +211,9 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper()) {
+        return Get(ctx, out_tensors, end_of_sequence);
+      }
       mutex_lock l(mu_);
       while (!end_of_input_ || num_open_ > 0) {
         if (current_elements_[cycle_index_]) {
@@ -280,6 +307,88 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
       return absl::OkStatus();
     }
 
+    // Produces the element at the next position given by
+    // `ctx->index_mapper()`. As the index mapper defines the order of the
+    // elements, globally shuffled interleaves don't cycle through their inputs
+    // and produce the same elements as a globally shuffled `flat_map`.
+    absl::Status Get(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                     bool* end_of_sequence) TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      TF_ASSIGN_OR_RETURN(size_t parent_index,
+                          ctx->index_mapper()(element_count_));
+
+      FlatMapRandomAccessHandler& random_access =
+          dataset()->random_access_handler_;
+      absl::StatusOr<int64_t> dataset_index =
+          random_access.GetDatasetIndex(parent_index);
+      if (absl::IsOutOfRange(dataset_index.status())) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      TF_RETURN_IF_ERROR(dataset_index.status());
+
+      if (dataset_iterators_.empty()) {
+        TF_ASSIGN_OR_RETURN(
+            dataset_iterators_,
+            random_access.MakeInputIterators(ctx, this, prefix()));
+        next_positions_.resize(dataset_iterators_.size(), 0);
+        input_element_counts_.resize(dataset_iterators_.size(), 0);
+      }
+
+      IteratorContext::Params params(ctx);
+      params.index_mapper =
+          GetInterleaveIndexMapper(ctx->index_mapper(), *dataset_index);
+      IteratorContext global_shuffle_ctx(std::move(params));
+      TF_RETURN_IF_ERROR(dataset_iterators_[*dataset_index]->GetNext(
+          &global_shuffle_ctx, out_tensors, end_of_sequence));
+      ctx->MergeCheckpoint(global_shuffle_ctx.checkpoint());
+      ++element_count_;
+      ++input_element_counts_[*dataset_index];
+      return absl::OkStatus();
+    }
+
+    // Returns the index mapper of the input `input_dataset_index`, which maps
+    // its element positions to the next positions of this iterator whose
+    // shuffled indices belong to that input.
+    IndexMapperFn GetInterleaveIndexMapper(IndexMapperFn parent_index_mapper,
+                                           size_t input_dataset_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      absl::StatusOr<int64_t> cardinality =
+          dataset()->random_access_handler_.Cardinality();
+      return [this, parent_index_mapper = std::move(parent_index_mapper),
+              input_dataset_index, cardinality = std::move(cardinality)](
+                 size_t element_position) -> absl::StatusOr<size_t> {
+        if (!cardinality.ok() || *cardinality < 0) {
+          return absl::FailedPreconditionError(
+              "Global shuffling requires finite cardinalities.");
+        }
+
+        FlatMapRandomAccessHandler& random_access =
+            dataset()->random_access_handler_;
+        while (next_positions_[input_dataset_index] < *cardinality) {
+          // `index` is the shuffled index of this dataset, not any of the
+          // inputs.
+          size_t index = next_positions_[input_dataset_index];
+          if (parent_index_mapper != nullptr) {
+            TF_ASSIGN_OR_RETURN(index, parent_index_mapper(index));
+          }
+          ++next_positions_[input_dataset_index];
+          TF_ASSIGN_OR_RETURN(int64_t shuffled_dataset_index,
+                              random_access.GetDatasetIndex(index));
+          if (input_dataset_index == shuffled_dataset_index) {
+            if (input_dataset_index > 0) {
+              TF_ASSIGN_OR_RETURN(
+                  int64_t cumulative_cardinality,
+                  random_access.CumulativeCardinality(input_dataset_index - 1));
+              index -= cumulative_cardinality;
+            }
+            return index;
+          }
+        }
+        return *cardinality;
+      };
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -314,6 +423,9 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return RestoreForGlobalShuffle(ctx, reader);
+      }
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       int64_t cycle_index;
@@ -360,6 +472,51 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
       return absl::OkStatus();
     }
 
+    Status RestoreForGlobalShuffle(IteratorContext* ctx,
+                                   IteratorStateReader* reader)
+        TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      element_count_ = *ctx->restored_element_count();
+
+      FlatMapRandomAccessHandler& random_access =
+          dataset()->random_access_handler_;
+      TF_ASSIGN_OR_RETURN(int64_t cardinality, random_access.Cardinality());
+      if (dataset_iterators_.empty()) {
+        TF_ASSIGN_OR_RETURN(
+            dataset_iterators_,
+            random_access.MakeInputIterators(ctx, this, prefix()));
+      }
+      input_element_counts_.resize(dataset_iterators_.size(), 0);
+      next_positions_.resize(dataset_iterators_.size(), 0);
+      std::fill(input_element_counts_.begin(), input_element_counts_.end(), 0);
+      std::fill(next_positions_.begin(), next_positions_.end(), 0);
+
+      // Counts how many elements each input dataset has produced.
+      for (size_t count = 0; count < element_count_ && count < cardinality;
+           ++count) {
+        TF_ASSIGN_OR_RETURN(size_t parent_index, ctx->index_mapper()(count));
+        absl::StatusOr<size_t> dataset_index =
+            random_access.GetDatasetIndex(parent_index);
+        if (absl::IsOutOfRange(dataset_index.status())) {
+          break;
+        }
+        TF_RETURN_IF_ERROR(dataset_index.status());
+        ++input_element_counts_[*dataset_index];
+        next_positions_[*dataset_index] = count + 1;
+      }
+
+      // Passes individual element counts to each dataset to be restored.
+      for (size_t i = 0; i < dataset_iterators_.size(); ++i) {
+        IteratorContext::Params params(ctx);
+        params.restored_element_count = input_element_counts_[i];
+        IteratorContext ctx_copy(std::move(params));
+        TF_RETURN_IF_ERROR(
+            RestoreInput(&ctx_copy, reader, dataset_iterators_[i]));
+        ctx->MergeCheckpoint(ctx_copy.checkpoint());
+      }
+      return absl::OkStatus();
+    }
+
     TraceMeMetadata GetTraceMeMetadata() const override {
       return dataset()->traceme_metadata_;
     }
@@ -767,6 +924,19 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
     int64_t block_index_ TF_GUARDED_BY(mu_) = 0;
     bool end_of_input_ TF_GUARDED_BY(mu_) = false;
     size_t num_open_ TF_GUARDED_BY(mu_) = 0;
+
+    // Number of elements produced by the iterator under global shuffling.
+    size_t element_count_ TF_GUARDED_BY(mu_) = 0;
+    // Counts the number of elements each input iterator has produced. Only
+    // populated when global shuffling is enabled.
+    std::vector<int64_t> input_element_counts_ TF_GUARDED_BY(mu_);
+    // Keeps track of the position of this iterator that each input starts to
+    // scan for its next index. Only populated when global shuffling is enabled.
+    std::vector<size_t> next_positions_;
+    // All input dataset iterators. Only populated when global shuffling is
+    // enabled.
+    std::vector<std::unique_ptr<IteratorBase>> dataset_iterators_
+        TF_GUARDED_BY(mu_);
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
   };
 
@@ -777,6 +947,8 @@ class InterleaveDatasetOp::Dataset : public DatasetBase {
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const TraceMeMetadata traceme_metadata_;
+  absl::Status random_indexing_compatible_ = absl::OkStatus();
+  mutable FlatMapRandomAccessHandler random_access_handler_;
 };
 
 InterleaveDatasetOp::InterleaveDatasetOp(OpKernelConstruction* ctx)
@@ -379,7 +379,7 @@ class IteratorVariantSerializer {
     for (auto& it : data) {
       IteratorStateVariant v;
       TF_RETURN_IF_ERROR(v.InitializeFromVariantData(std::move(it)));
-      variants_.push_back(v);
+      variants_.push_back(std::move(v));
     }
     num_tensors_ = variants_.size();
     can_serialize_ = true;
@@ -409,8 +409,8 @@ class IteratorVariantSerializer {
 
   int64_t NumTensors() { return num_tensors_; }
 
-  // Stores the IteratorStateVariant list into a pre-allocated tensor. Expects
-  // that InitializeFromIterator was called before.
+  // Moves the IteratorStateVariant list into a pre-allocated tensor. Expects
+  // that InitializeFromIterator was called before, once per call.
   Status Serialize(Tensor* serialized) {
     if (!can_serialize_) {
       return errors::InvalidArgument(
@@ -422,8 +422,9 @@ class IteratorVariantSerializer {
         return errors::Internal(
             "Cannot serialize an empty IteratorStateVariant");
       }
-      serialized->vec<Variant>()(i) = variants_[i];
+      serialized->vec<Variant>()(i) = std::move(variants_[i]);
     }
+    can_serialize_ = false;
     return absl::OkStatus();
   }
 
@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/mapped_record_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr size_t kHeaderSize = io::RecordReader::kHeaderSize;
+constexpr size_t kFooterSize = io::RecordReader::kFooterSize;
+
+// Backs a scalar string tensor with a view into a `MappedRecordFile`.
+class MappedRecordBuffer : public TensorBuffer {
+ public:
+  MappedRecordBuffer(core::RefCountPtr<MappedRecordFile> file,
+                     StringPiece record)
+      : TensorBuffer(&value_), file_(std::move(file)) {
+    value_.assign_as_view(record);
+  }
+
+  size_t size() const override { return sizeof(tstring); }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(sizeof(tstring));
+    proto->set_allocator_name("MappedRecordFile");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  tstring value_;
+  // Keeps the mapping that `value_` points into alive.
+  const core::RefCountPtr<MappedRecordFile> file_;
+};
+
+}  // namespace
+
+absl::StatusOr<core::RefCountPtr<MappedRecordFile>> MappedRecordFile::Open(
+    Env* env, const std::string& filename, uint64_t start_offset) {
+  uint64_t file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  // Mapping an empty file fails on most platforms, and there is nothing to
+  // read from it anyway.
+  if (file_size > 0) {
+    TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+  }
+  core::RefCountPtr<MappedRecordFile> file(
+      new MappedRecordFile(filename, std::move(region)));
+  if (start_offset > file->length_) {
+    return errors::OutOfRange("Offset ", start_offset,
+                              " is past the end of file ", filename,
+                              " of size ", file->length_);
+  }
+  file->BuildIndex(start_offset);
+  return file;
+}
+
+MappedRecordFile::MappedRecordFile(std::string filename,
+                                   std::unique_ptr<ReadOnlyMemoryRegion> region)
+    : filename_(std::move(filename)),
+      region_(std::move(region)),
+      data_(region_ ? static_cast<const char*>(region_->data()) : nullptr),
+      length_(region_ ? region_->length() : 0) {}
+
+void MappedRecordFile::BuildIndex(uint64_t start_offset) {
+  uint64_t offset = start_offset;
+  while (offset < length_) {
+    if (length_ - offset < kHeaderSize) {
+      status_ = errors::DataLoss("truncated record at ", offset, " in file ",
+                                 filename_);
+      break;
+    }
+    const char* header = data_ + offset;
+    const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+      status_ = errors::DataLoss("corrupted record at ", offset, " in file ",
+                                 filename_);
+      break;
+    }
+    const uint64_t length = core::DecodeFixed64(header);
+    if (length > length_ - offset - kHeaderSize ||
+        length_ - offset - kHeaderSize - length < kFooterSize) {
+      status_ = errors::DataLoss("truncated record at ", offset, " in file ",
+                                 filename_);
+      break;
+    }
+    offsets_.push_back(offset);
+    lengths_.push_back(length);
+    offset += kHeaderSize + length + kFooterSize;
+  }
+  end_offset_ = offset;
+}
+
+uint64_t MappedRecordFile::offset(int64_t index) const {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, num_records());
+  return index < num_records() ? offsets_[index] : end_offset_;
+}
+
+absl::StatusOr<int64_t> MappedRecordFile::IndexOfOffset(
+    uint64_t offset) const {
+  if (offset == end_offset_) {
+    return num_records();
+  }
+  auto it = std::lower_bound(offsets_.begin(), offsets_.end(), offset);
+  if (it == offsets_.end() || *it != offset) {
+    return errors::InvalidArgument("Offset ", offset,
+                                   " is not the start of a record in file ",
+                                   filename_);
+  }
+  return it - offsets_.begin();
+}
+
+absl::Status MappedRecordFile::GetRecord(int64_t index,
+                                         StringPiece* record) const {
+  if (index < 0 || index >= num_records()) {
+    return errors::OutOfRange("Record index ", index, " out of range [0, ",
+                              num_records(), ") in file ", filename_);
+  }
+  const char* payload = data_ + offsets_[index] + kHeaderSize;
+  const uint64_t length = lengths_[index];
+  const uint32 masked_crc = core::DecodeFixed32(payload + length);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(payload, length)) {
+    return errors::DataLoss("corrupted record at ", offsets_[index],
+                            " in file ", filename_);
+  }
+  *record = StringPiece(payload, length);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Tensor> MappedRecordFile::GetRecordTensor(int64_t index) {
+  StringPiece record;
+  TF_RETURN_IF_ERROR(GetRecord(index, &record));
+  Ref();
+  core::RefCountPtr<TensorBuffer> buffer(
+      new MappedRecordBuffer(core::RefCountPtr<MappedRecordFile>(this), record));
+  return Tensor(DT_STRING, TensorShape({}), std::move(buffer));
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_MAPPED_RECORD_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_MAPPED_RECORD_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// A read-only memory mapping of an uncompressed TFRecord file together with
+// an index of its records.
+//
+// The index is built once, when the file is opened, by walking the record
+// headers; record payloads are not touched until they are requested. Records
+// are returned as scalar string tensors whose `tstring` is a view into the
+// mapping, so no copy of the payload is made. Each such tensor holds a
+// reference on the `MappedRecordFile`, which keeps the mapping alive for as
+// long as the tensor is in use.
+//
+// This class is thread-safe.
+class MappedRecordFile : public core::RefCounted {
+ public:
+  // Maps `filename` and indexes the records starting at `start_offset`.
+  //
+  // If the file ends with a truncated or corrupted record header, the records
+  // before it are still indexed and `status()` reports the error.
+  static absl::StatusOr<core::RefCountPtr<MappedRecordFile>> Open(
+      Env* env, const std::string& filename, uint64_t start_offset = 0);
+
+  // Returns the number of complete records in the file.
+  int64_t num_records() const { return offsets_.size(); }
+
+  // Returns the error encountered while indexing past the last record, if
+  // any.
+  const absl::Status& status() const { return status_; }
+
+  // Returns the byte offset of the header of the record at `index`. For
+  // `index == num_records()`, returns the offset past the last record.
+  uint64_t offset(int64_t index) const;
+
+  // Returns the index of the record whose header starts at `offset`.
+  absl::StatusOr<int64_t> IndexOfOffset(uint64_t offset) const;
+
+  // Returns the payload of the record at `index`, checking its CRC. The
+  // returned view is valid for the lifetime of this object.
+  absl::Status GetRecord(int64_t index, StringPiece* record) const;
+
+  // Returns the record at `index` as a scalar `DT_STRING` tensor backed by the
+  // mapping.
+  absl::StatusOr<Tensor> GetRecordTensor(int64_t index);
+
+ private:
+  MappedRecordFile(std::string filename,
+                   std::unique_ptr<ReadOnlyMemoryRegion> region);
+
+  // Walks the record headers starting at `start_offset`.
+  void BuildIndex(uint64_t start_offset);
+
+  const std::string filename_;
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const uint64_t length_;
+
+  // Header offset and payload length of each record.
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> lengths_;
+  uint64_t end_offset_ = 0;
+  absl::Status status_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_MAPPED_RECORD_FILE_H_
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/mapped_record_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string WriteRecords(const std::string& name,
+                         const std::vector<std::string>& records) {
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  for (const std::string& record : records) {
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return filename;
+}
+
+TEST(MappedRecordFileTest, ReadRecords) {
+  const std::vector<std::string> records = {"a", "", "bcdef", "gh"};
+  const std::string filename = WriteRecords("mapped_records", records);
+  TF_ASSERT_OK_AND_ASSIGN(core::RefCountPtr<MappedRecordFile> file,
+                          MappedRecordFile::Open(Env::Default(), filename));
+  TF_EXPECT_OK(file->status());
+  ASSERT_EQ(file->num_records(), records.size());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    StringPiece record;
+    TF_ASSERT_OK(file->GetRecord(i, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+  StringPiece record;
+  EXPECT_TRUE(errors::IsOutOfRange(file->GetRecord(records.size(), &record)));
+}
+
+TEST(MappedRecordFileTest, TensorOutlivesFile) {
+  const std::string filename = WriteRecords("mapped_tensor", {"hello"});
+  Tensor tensor;
+  {
+    TF_ASSERT_OK_AND_ASSIGN(core::RefCountPtr<MappedRecordFile> file,
+                            MappedRecordFile::Open(Env::Default(), filename));
+    TF_ASSERT_OK_AND_ASSIGN(tensor, file->GetRecordTensor(0));
+  }
+  EXPECT_EQ(tensor.dtype(), DT_STRING);
+  EXPECT_EQ(tensor.scalar<tstring>()(), "hello");
+  EXPECT_EQ(tensor.scalar<tstring>()().type(), tstring::VIEW);
+}
+
+TEST(MappedRecordFileTest, Offsets) {
+  const std::string filename = WriteRecords("mapped_offsets", {"ab", "cd"});
+  TF_ASSERT_OK_AND_ASSIGN(core::RefCountPtr<MappedRecordFile> file,
+                          MappedRecordFile::Open(Env::Default(), filename));
+  // Each record is a 12 byte header, the payload and a 4 byte footer.
+  EXPECT_EQ(file->offset(0), 0);
+  EXPECT_EQ(file->offset(1), 18);
+  EXPECT_EQ(file->offset(2), 36);
+  TF_ASSERT_OK_AND_ASSIGN(int64_t index, file->IndexOfOffset(18));
+  EXPECT_EQ(index, 1);
+  TF_ASSERT_OK_AND_ASSIGN(index, file->IndexOfOffset(36));
+  EXPECT_EQ(index, 2);
+  EXPECT_TRUE(errors::IsInvalidArgument(file->IndexOfOffset(5).status()));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      core::RefCountPtr<MappedRecordFile> suffix,
+      MappedRecordFile::Open(Env::Default(), filename, /*start_offset=*/18));
+  ASSERT_EQ(suffix->num_records(), 1);
+  StringPiece record;
+  TF_ASSERT_OK(suffix->GetRecord(0, &record));
+  EXPECT_EQ(record, "cd");
+}
+
+TEST(MappedRecordFileTest, TruncatedFile) {
+  const std::string truncated =
+      WriteRecords("mapped_truncated", {"ab", "cdefgh"});
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), truncated, &contents));
+  contents.resize(contents.size() - 3);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), truncated, contents));
+
+  TF_ASSERT_OK_AND_ASSIGN(core::RefCountPtr<MappedRecordFile> file,
+                          MappedRecordFile::Open(Env::Default(), truncated));
+  EXPECT_EQ(file->num_records(), 1);
+  EXPECT_TRUE(errors::IsDataLoss(file->status()));
+}
+
+TEST(MappedRecordFileTest, EmptyFile) {
+  const std::string filename = WriteRecords("mapped_empty", {});
+  TF_ASSERT_OK_AND_ASSIGN(core::RefCountPtr<MappedRecordFile> file,
+                          MappedRecordFile::Open(Env::Default(), filename));
+  EXPECT_EQ(file->num_records(), 0);
+  TF_EXPECT_OK(file->status());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -22,14 +22,27 @@ limitations under the License.
 // On mobile we do not provide model dataset op because not all of its
 // dependencies are available there. The op is replaced with a no-op.
 #if !defined(IS_MOBILE_PLATFORM)
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -39,6 +52,58 @@ namespace {
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = model::kRamBudgetShare;
 
+// Extension of the files holding the tuned parameter values in the cache path.
+constexpr char kTunedParametersFileExtension[] = "tuned_parameters";
+
+// Computes the fingerprint under which the tuned parameter values of `input`
+// are saved. Tuned values depend on the pipeline, on the host and on the
+// resource budgets, so all of them are part of the fingerprint.
+Status ComputeTunedParametersFingerprint(OpKernelContext* ctx,
+                                         const DatasetBase* input,
+                                         int64_t cpu_budget,
+                                         int64_t ram_budget,
+                                         uint64* fingerprint) {
+  GraphDef graph_def;
+  SerializationContext::Params params(ctx);
+  std::vector<std::pair<string, Tensor>> input_list;
+  params.input_list = &input_list;
+  params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+  TF_RETURN_IF_ERROR(
+      AsGraphDef(input, SerializationContext(params), &graph_def));
+  uint64 hash;
+  TF_RETURN_IF_ERROR(HashGraph(graph_def, &hash));
+  hash = Hash64Combine(hash, port::NumSchedulableCPUs());
+  hash = Hash64Combine(hash, port::GetMemoryInfo().total);
+  hash = Hash64Combine(hash, cpu_budget);
+  hash = Hash64Combine(hash, ram_budget);
+  *fingerprint = hash;
+  return absl::OkStatus();
+}
+
+// Returns the file holding the tuned parameter values of `input` in
+// `cache_path`, or an empty string if they can't be saved.
+std::string GetTunedParametersFile(OpKernelContext* ctx,
+                                   const DatasetBase* input,
+                                   int64_t cpu_budget, int64_t ram_budget,
+                                   const std::string& cache_path,
+                                   uint64* fingerprint) {
+  if (cache_path.empty()) {
+    return "";
+  }
+  Status s = ComputeTunedParametersFingerprint(ctx, input, cpu_budget,
+                                               ram_budget, fingerprint);
+  if (!s.ok()) {
+    LOG(WARNING) << "Tuned parameters of the dataset won't be saved to "
+                 << cache_path
+                 << " because its graph can't be fingerprinted: " << s;
+    return "";
+  }
+  return io::JoinPath(
+      cache_path,
+      strings::StrCat(strings::Hex(*fingerprint, strings::kZeroPad16), ".",
+                      kTunedParametersFileExtension));
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const ModelDatasetOp::kDatasetType;
@@ -46,23 +111,29 @@ constexpr double kRamBudgetShare = model::kRamBudgetShare;
 /* static */ constexpr const char* const ModelDatasetOp::kAlgorithm;
 /* static */ constexpr const char* const ModelDatasetOp::kCpuBudget;
 /* static */ constexpr const char* const ModelDatasetOp::kRamBudget;
+/* static */ constexpr const char* const ModelDatasetOp::kCachePath;
 
 class ModelDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           model::AutotuneAlgorithm algorithm, int64_t cpu_budget,
-          int64_t ram_budget)
-      : Dataset(DatasetContext(ctx), input, algorithm, cpu_budget, ram_budget) {
-  }
-
-  Dataset(DatasetContext&& ctx, const DatasetBase* input,
-          model::AutotuneAlgorithm algorithm, int64_t cpu_budget,
-          int64_t ram_budget)
-      : DatasetBase(std::move(ctx)),
+          int64_t ram_budget, const std::string& cache_path)
+      : Dataset(ctx, DatasetContext(ctx), input, algorithm, cpu_budget,
+                ram_budget, cache_path) {}
+
+  Dataset(OpKernelContext* ctx, DatasetContext&& dataset_ctx,
+          const DatasetBase* input, model::AutotuneAlgorithm algorithm,
+          int64_t cpu_budget, int64_t ram_budget,
+          const std::string& cache_path)
+      : DatasetBase(std::move(dataset_ctx)),
         input_(input),
         algorithm_(algorithm),
         cpu_budget_(cpu_budget),
         ram_budget_(ram_budget),
+        cache_path_(cache_path),
+        tuned_parameters_file_(
+            GetTunedParametersFile(ctx, input, cpu_budget, ram_budget,
+                                   cache_path, &fingerprint_)),
         traceme_metadata_(
             {{"algorithm", model::AutotuneAlgorithm_Name(algorithm)},
              {"cpu_budget",
@@ -114,12 +185,15 @@ class ModelDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(cpu_budget_, &cpu_budget_attr);
     AttrValue ram_budget_attr;
     b->BuildAttrValue(ram_budget_, &ram_budget_attr);
+    AttrValue cache_path_attr;
+    b->BuildAttrValue(cache_path_, &cache_path_attr);
 
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {input_graph_node},
                       {std::make_pair(kAlgorithm, algorithm_attr),
                        std::make_pair(kCpuBudget, cpu_budget_attr),
-                       std::make_pair(kRamBudget, ram_budget_attr)},
+                       std::make_pair(kRamBudget, ram_budget_attr),
+                       std::make_pair(kCachePath, cache_path_attr)},
                       output));
     return absl::OkStatus();
   }
@@ -138,10 +212,21 @@ class ModelDatasetOp::Dataset : public DatasetBase {
       model_ = std::make_shared<model::Model>();
     }
 
-    ~Iterator() override { cancellation_manager_->StartCancel(); }
+    ~Iterator() override {
+      cancellation_manager_->StartCancel();
+      Status s = SaveTunedParameters();
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to save tuned parameters: " << s;
+      }
+    }
 
     Status Initialize(IteratorContext* ctx) override {
-      return dataset()->input_->MakeIterator(IteratorContext(CreateParams(ctx)),
+      IteratorContext::Params params = CreateParams(ctx);
+      if (!dataset()->tuned_parameters_file_.empty()) {
+        tuned_model_ = params.model;
+        LoadTunedParameters();
+      }
+      return dataset()->input_->MakeIterator(IteratorContext(std::move(params)),
                                              this, prefix(), &input_impl_);
     }
 
@@ -165,6 +250,12 @@ class ModelDatasetOp::Dataset : public DatasetBase {
 
     Status SaveInternal(SerializationContext* ctx,
                         IteratorStateWriter* writer) override {
+      // Checkpoints are the last chance to save the tuned parameters of jobs
+      // which are preempted.
+      Status s = SaveTunedParameters();
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to save tuned parameters: " << s;
+      }
       return SaveInput(ctx, writer, input_impl_);
     }
 
@@ -187,6 +278,53 @@ class ModelDatasetOp::Dataset : public DatasetBase {
       return params;
     }
 
+    // Warm-starts the tunable parameters from the values saved by a previous
+    // run of the same pipeline, if any.
+    void LoadTunedParameters() {
+      const std::string& file = dataset()->tuned_parameters_file_;
+      Env* env = Env::Default();
+      if (!env->FileExists(file).ok()) {
+        return;
+      }
+      model::TunedParametersProto proto;
+      Status s = ReadBinaryProto(env, file, &proto);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to read tuned parameters from " << file
+                     << ": " << s;
+        return;
+      }
+      if (proto.fingerprint() != dataset()->fingerprint_) {
+        return;
+      }
+      VLOG(2) << "Warm starting " << proto.values_size()
+              << " tunable parameters from " << file;
+      tuned_model_->SetWarmStartParameterValues(
+          {proto.values().begin(), proto.values().end()});
+    }
+
+    Status SaveTunedParameters() {
+      if (!tuned_model_) {
+        return absl::OkStatus();
+      }
+      absl::flat_hash_map<string, double> values =
+          tuned_model_->TunableParameterValues();
+      if (values.empty()) {
+        return absl::OkStatus();
+      }
+      model::TunedParametersProto proto;
+      proto.set_fingerprint(dataset()->fingerprint_);
+      proto.mutable_values()->insert(values.begin(), values.end());
+      Env* env = Env::Default();
+      TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dataset()->cache_path_));
+      // Write to a temporary file first, so that other jobs sharing the cache
+      // path never read a partially written file.
+      const std::string& file = dataset()->tuned_parameters_file_;
+      const std::string temp_file =
+          strings::StrCat(file, ".tmp", random::New64());
+      TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_file, proto));
+      return env->RenameFile(temp_file, file);
+    }
+
     Status EnsureOptimizationLoopThreadStarted(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!model_thread_) {
@@ -211,6 +349,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
 
     mutex mu_;
     std::shared_ptr<model::Model> model_;
+    // The model whose tuned parameters are saved, i.e. `model_` unless the
+    // iterator is part of a pipeline modeled by another model.
+    std::shared_ptr<model::Model> tuned_model_;
     std::unique_ptr<IteratorBase> input_impl_;
     const int64_t cpu_budget_;
     const int64_t ram_budget_;
@@ -224,6 +365,10 @@ class ModelDatasetOp::Dataset : public DatasetBase {
   const model::AutotuneAlgorithm algorithm_;
   const int64_t cpu_budget_;
   const int64_t ram_budget_;
+  const std::string cache_path_;
+  uint64 fingerprint_ = 0;
+  // Empty if the tuned parameters aren't saved.
+  const std::string tuned_parameters_file_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -233,11 +378,13 @@ void ModelDatasetOp::MakeDatasetFromOptions(OpKernelContext* ctx,
                                             model::AutotuneAlgorithm algorithm,
                                             int64_t cpu_budget,
                                             int64_t ram_budget,
+                                            const std::string& cache_path,
                                             DatasetBase** output) {
   *output = new ModelDatasetOp::Dataset(
+      ctx,
       DatasetContext(DatasetContext::Params(
           {ModelDatasetOp::kDatasetType, ModelDatasetOp::kDatasetOp})),
-      input, algorithm, cpu_budget, ram_budget);
+      input, algorithm, cpu_budget, ram_budget, cache_path);
 }
 
 ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
@@ -261,12 +408,15 @@ ModelDatasetOp::ModelDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES(ctx, ram_budget_ >= 0,
               errors::InvalidArgument("RAM budget must be positive but is ",
                                       ram_budget_, "."));
+  if (ctx->HasAttr(kCachePath)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCachePath, &cache_path_));
+  }
 }
 
 void ModelDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   *output = new ModelDatasetOp::Dataset(ctx, input, algorithm_, cpu_budget_,
-                                        ram_budget_);
+                                        ram_budget_, cache_path_);
 }
 
 namespace {
@@ -283,6 +433,7 @@ void ModelDatasetOp::MakeDatasetFromOptions(OpKernelContext* ctx,
                                             DatasetBase* input,
                                             model::AutotuneAlgorithm algorithm,
                                             bool cpu_budget, bool ram_budget,
+                                            const std::string& cache_path,
                                             DatasetBase** output) {
   input->Ref();
   *output = input;
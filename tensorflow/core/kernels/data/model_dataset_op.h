@@ -20,6 +20,8 @@ limitations under the License.
 // On mobile we do not provide model dataset op because not all of its
 // dependencies are available there. The op is replaced with a no-op.
 #if !defined(IS_MOBILE_PLATFORM)
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 
@@ -33,12 +35,14 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kAlgorithm = "algorithm";
   static constexpr const char* const kCpuBudget = "cpu_budget";
   static constexpr const char* const kRamBudget = "ram_budget";
+  static constexpr const char* const kCachePath = "cache_path";
 
   // Executes the logic of the ModelDatasetOp directly (as opposed to through
   // executing the ModelDatasetOp op kernel).
   static void MakeDatasetFromOptions(OpKernelContext* ctx, DatasetBase* input,
                                      model::AutotuneAlgorithm algorithm,
                                      int64_t cpu_budget, int64_t ram_budget,
+                                     const std::string& cache_path,
                                      DatasetBase** output);
 
   explicit ModelDatasetOp(OpKernelConstruction* ctx);
@@ -53,11 +57,16 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   model::AutotuneAlgorithm algorithm_;
   int64_t cpu_budget_;
   int64_t ram_budget_;
+  // Directory where the tuned parameter values are saved. Empty if they are
+  // not saved.
+  std::string cache_path_;
 };
 
 }  // namespace data
 }  // namespace tensorflow
 #else  // !IS_MOBILE_PLATFORM
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -71,6 +80,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
   static void MakeDatasetFromOptions(OpKernelContext* ctx, DatasetBase* input,
                                      model::AutotuneAlgorithm algorithm,
                                      bool cpu_budget, bool ram_budget,
+                                     const std::string& cache_path,
                                      DatasetBase** output);
 
   explicit ModelDatasetOp(OpKernelConstruction* ctx);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <utility>
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -50,6 +52,10 @@ const char kAnonymousMultiDeviceIteratorV3[] = "AnonymousMultiDeviceIteratorV3";
 const char kDevices[] = "devices";
 const char kOutputShapes[] = "output_shapes";
 const char kOutputTypes[] = "output_types";
+// Name of the environment variable that disables staging the elements bound to
+// GPUs in pinned host memory.
+const char kPinnedStagingEnvVar[] =
+    "TF_DATA_MULTI_DEVICE_ITERATOR_PINNED_STAGING";
 
 struct HostBufferElement {
   Status status;
@@ -60,6 +66,48 @@ struct HostBufferElement {
 using MultiDeviceIteratorCallback =
     std::function<void(const HostBufferElement&)>;
 
+// Returns whether the elements for `devices` should be staged in pinned host
+// memory, which is the case if any of them is a GPU.
+bool ShouldStageInPinnedMemory(const std::vector<string>& devices) {
+  bool enabled = true;
+  Status s = ReadBoolFromEnvVar(kPinnedStagingEnvVar, true, &enabled);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  if (!enabled) return false;
+  for (const string& device : devices) {
+    DeviceNameUtils::ParsedName parsed_name;
+    if (DeviceNameUtils::ParseFullName(device, &parsed_name) &&
+        parsed_name.type == DEVICE_GPU) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Copies `tensors` into pinned host memory. The copies of pinned tensors to
+// GPUs are asynchronous DMAs on the host-to-device streams, whereas the driver
+// stages copies from pageable memory synchronously. Staging the elements while
+// they are buffered takes that copy off the critical path of the steps.
+void StageInPinnedMemory(IteratorContext* ctx, std::vector<Tensor>* tensors) {
+  AllocatorAttributes attrs;
+  attrs.set_on_host(true);
+  attrs.set_gpu_compatible(true);
+  Allocator* allocator = ctx->allocator(attrs);
+  for (Tensor& tensor : *tensors) {
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.TotalBytes() == 0) {
+      continue;
+    }
+    Tensor staged(allocator, tensor.dtype(), tensor.shape());
+    if (!staged.IsInitialized()) {
+      // Out of pinned memory, the element is copied from pageable memory.
+      return;
+    }
+    std::memcpy(staged.data(), tensor.data(), tensor.TotalBytes());
+    tensor = std::move(staged);
+  }
+}
+
 // MultiDeviceIterator provides the ability for multiple devices to fetch from
 // one iterator in a roundrobin sequence, which is deterministic. This means
 // that, for exmaple, starting from the beginning GetNextFromShard(0) always
@@ -88,6 +136,7 @@ class MultiDeviceIterator : public ResourceBase {
         output_types_(output_types),
         output_shapes_(output_shapes),
         devices_(devices),
+        stage_in_pinned_memory_(ShouldStageInPinnedMemory(devices)),
         flib_def_(std::move(flib_def)),
         flr_(flr),
         pflr_(std::move(pflr)),
@@ -371,6 +420,8 @@ class MultiDeviceIterator : public ResourceBase {
 
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
+        } else if (elem.status.ok() && parent_->stage_in_pinned_memory_) {
+          StageInPinnedMemory(ctx.get(), &elem.value);
         }
 
         std::shared_ptr<HostBuffer::CallbackContainer> callback_container;
@@ -461,6 +512,7 @@ class MultiDeviceIterator : public ResourceBase {
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const std::vector<string> devices_;
+  const bool stage_in_pinned_memory_;
   const std::unique_ptr<FunctionLibraryDefinition> flib_def_;
   FunctionLibraryRuntime* const flr_ = nullptr;  // not owned.
   const std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
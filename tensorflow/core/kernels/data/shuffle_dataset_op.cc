@@ -25,13 +25,17 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
@@ -54,6 +58,7 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kCompressBuffer;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -82,7 +87,42 @@ constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
-    : UnaryDatasetOpKernel(ctx) {}
+    : UnaryDatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kCompressBuffer)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompressBuffer, &compress_buffer_));
+  }
+}
+
+namespace {
+
+// Replaces the components of `element` by a single scalar variant tensor
+// holding their compressed serialization, which has none of the per-tensor
+// overhead of the components.
+Status CompressBufferElement(std::vector<Tensor>* element) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(*element, &compressed));
+  Tensor tensor(DT_VARIANT, TensorShape({}));
+  tensor.scalar<Variant>()() = std::move(compressed);
+  element->clear();
+  element->push_back(std::move(tensor));
+  return absl::OkStatus();
+}
+
+Status UncompressBufferElement(const std::vector<Tensor>& element,
+                               std::vector<Tensor>* out_tensors) {
+  const CompressedElement* compressed = nullptr;
+  if (element.size() == 1 && element[0].dtype() == DT_VARIANT &&
+      element[0].dims() == 0) {
+    compressed = element[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  if (compressed == nullptr) {
+    return errors::Internal(
+        "Expected a compressed element in the shuffle buffer.");
+  }
+  return UncompressElement(*compressed, out_tensors);
+}
+
+}  // namespace
 
 // Abstract base dataset that implements a shuffling iterator.
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
@@ -90,12 +130,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, bool compress_buffer)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        compress_buffer_(compress_buffer),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -217,31 +258,41 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
-      mutex_lock l(mu_);
-      TF_RETURN_IF_ERROR(FillBuffer(ctx));
-      if (num_elements_ == 0) {
-        DCHECK(input_impl_ == nullptr);
-        *end_of_sequence = true;
+      std::vector<Tensor> element;
+      {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(FillBuffer(ctx));
+        if (num_elements_ == 0) {
+          DCHECK(input_impl_ == nullptr);
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+
+        *end_of_sequence = false;
+        ClearEmptySlices();
+        DCHECK(!slices_.empty());
+        // Choose an element to produce uniformly at random from the first
+        // slice, and then remove the element from the slice.
+        int64_t offset =
+            Random() % (slices_.front()->end - slices_.front()->start);
+        int64_t index = (slices_.front()->start + offset) % buffer_->size();
+        element = std::move(buffer_->at(index));
+        this->RecordBufferDequeue(ctx, element);
+        std::swap(buffer_->at(index),
+                  buffer_->at(slices_.front()->start % buffer_->size()));
+        checkpoint_indices_.insert(index);
+        checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
+        slices_.front()->start++;
+        num_elements_--;
+      }
+      if (!dataset()->compress_buffer_) {
+        *out_tensors = std::move(element);
         return absl::OkStatus();
       }
-
-      *end_of_sequence = false;
-      ClearEmptySlices();
-      DCHECK(!slices_.empty());
-      // Choose an element to produce uniformly at random from the first
-      // slice, and then remove the element from the slice.
-      int64_t offset =
-          Random() % (slices_.front()->end - slices_.front()->start);
-      int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
-      this->RecordBufferDequeue(ctx, *out_tensors);
-      std::swap(buffer_->at(index),
-                buffer_->at(slices_.front()->start % buffer_->size()));
-      checkpoint_indices_.insert(index);
-      checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
-      slices_.front()->start++;
-      num_elements_--;
-      return absl::OkStatus();
+      // Uncompress outside of the lock so that concurrent callers, e.g. a
+      // downstream parallel map or prefetch, overlap their uncompression with
+      // the sampling of the next elements.
+      return UncompressBufferElement(element, out_tensors);
     }
 
    protected:
@@ -463,6 +514,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
+          if (dataset()->compress_buffer_) {
+            TF_RETURN_IF_ERROR(CompressBufferElement(&input_element));
+          }
           AddToShuffleBuffer(ctx, std::move(input_element));
           continue;
         }
@@ -588,6 +642,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // Whether the buffered elements are kept compressed, trading the CPU time
+  // of compressing and uncompressing every element for a larger buffer in the
+  // same memory.
+  const bool compress_buffer_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -601,8 +659,9 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, bool compress_buffer)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           compress_buffer),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -635,11 +694,13 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue compress_buffer;
+    b->BuildAttrValue(compress_buffer_, &compress_buffer);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, seed_node, seed2_node},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kCompressBuffer, compress_buffer)},  // Attrs
         output));
     return absl::OkStatus();
   }
@@ -660,7 +721,8 @@ class ShuffleDatasetOp::DatasetV2 : public ShuffleDatasetBase {
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, SeedGeneratorManager* manager,
             ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           /*compress_buffer=*/false),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -713,8 +775,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            bool compress_buffer)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           compress_buffer),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -753,12 +817,16 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue compress_buffer;
+    b->BuildAttrValue(compress_buffer_, &compress_buffer);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kCompressBuffer,
+                                      compress_buffer)},  // Attrs
                       output));
     return absl::OkStatus();
   }
@@ -836,9 +904,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, compress_buffer_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -898,9 +966,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
         MakeResourceHandle<SeedGeneratorManager>(ctx, container, name);
 
     // Ownership of manager is transferred onto `Dataset`.
-    *output = new ShuffleDatasetOp::Dataset(ctx, input, buffer_size, count,
-                                            std::move(seeds), manager,
-                                            std::move(handle));
+    *output = new ShuffleDatasetOp::Dataset(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), compress_buffer_);
   }
 }
 
@@ -908,8 +976,9 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           RandomSeeds&& seeds, SeedGeneratorManager* manager, int64_t count,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, bool compress_buffer)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           compress_buffer),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -944,10 +1013,12 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue compress_buffer;
+    b->BuildAttrValue(compress_buffer_, &compress_buffer);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size, seed, seed2, count},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kCompressBuffer, compress_buffer)},  // Attrs
         output));
     return absl::OkStatus();
   }
@@ -963,8 +1034,10 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
  public:
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            bool compress_buffer)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           compress_buffer),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1005,12 +1078,16 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue compress_buffer;
+    b->BuildAttrValue(compress_buffer_, &compress_buffer);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, count_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kCompressBuffer,
+                                      compress_buffer)},  // Attrs
                       output));
     return absl::OkStatus();
   }
@@ -1098,7 +1175,7 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
     // Ownership of manager is transferred onto `DatasetV2`.
     *output = new ShuffleAndRepeatDatasetOp::DatasetV2(
         ctx, input, buffer_size, count, std::move(seeds), manager,
-        std::move(handle), owns_resource);
+        std::move(handle), owns_resource, compress_buffer_);
   } else {
     if (op_version_ != 1) {
       LOG(WARNING) << "Unsupported version of shuffle dataset op: "
@@ -1125,7 +1202,7 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
 
     // Ownership of manager is transferred onto `Dataset`.
     *output = new Dataset(ctx, input, buffer_size, std::move(seeds), manager,
-                          count, std::move(handle));
+                          count, std::move(handle), compress_buffer_);
   }
 }
 
@@ -30,11 +30,14 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kReshuffleEachIteration =
       "reshuffle_each_iteration";
+  static constexpr const char* const kCompressBuffer = "compress_buffer";
 
   explicit ShuffleDatasetOpBase(OpKernelConstruction* ctx);
 
  protected:
   class ShuffleDatasetBase;
+
+  bool compress_buffer_ = false;
 };
 
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
@@ -33,14 +33,15 @@ class ShuffleDatasetParams : public DatasetParams {
                        bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, bool compress_buffer = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        compress_buffer_(compress_buffer) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -78,6 +79,7 @@ class ShuffleDatasetParams : public DatasetParams {
     attr_vector->emplace_back("reshuffle_each_iteration",
                               reshuffle_each_iteration_);
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back("compress_buffer", compress_buffer_);
     return absl::OkStatus();
   }
 
@@ -96,6 +98,7 @@ class ShuffleDatasetParams : public DatasetParams {
   int64_t seed2_;
   int64_t count_;
   bool reshuffle_each_iteration_;
+  bool compress_buffer_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -208,6 +211,34 @@ ShuffleDatasetParams ShuffleDatasetParams8() {
                               /*node_name=*/kShuffleAndRepeatNodeName);
 }
 
+// Test case 9: similar with the test case 3 but with a compressed buffer.
+ShuffleDatasetParams ShuffleDatasetParams9() {
+  return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
+                              /*buffer_size=*/2,
+                              /*seed=*/1,
+                              /*seed2=*/2,
+                              /*count=*/1,
+                              /*reshuffle_each_iteration=*/true,
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/kShuffleNodeName,
+                              /*compress_buffer=*/true);
+}
+
+// Test case 10: similar with the test case 7 but with a compressed buffer.
+ShuffleDatasetParams ShuffleDatasetParams10() {
+  return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
+                              /*buffer_size=*/10,
+                              /*seed=*/1,
+                              /*seed2=*/2,
+                              /*count=*/2,
+                              /*reshuffle_each_iteration=*/false,
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/kShuffleAndRepeatNodeName,
+                              /*compress_buffer=*/true);
+}
+
 // Test case 4: similar with the test case 2 but a buffer size of UNKNOWN.
 ShuffleDatasetParams ShuffleDatasetParamsWithUnknownCardinality() {
   return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
@@ -330,6 +361,24 @@ std::vector<GetNextTestCase<ShuffleDatasetParams>> GetNextTestCases() {
            TensorShape({}),
            {{2}, {0}, {1}, {2}, {0}, {1}, {2}, {0}, {1}, {2}, {0},
             {1}, {2}, {0}, {1}, {2}, {0}, {1}, {2}, {0}, {1}})},
+      {/*dataset_params=*/ShuffleDatasetParams9(),
+       /*expected_shuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}), {{0}, {2}, {1}, {3}, {5}, {6}, {4}, {7}, {8}, {9}}),
+       /*expected_reshuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}),
+           {{1}, {0}, {2}, {3}, {4}, {5}, {6}, {7}, {9}, {8}})},
+      {/*dataset_params=*/ShuffleDatasetParams10(),
+       /*expected_shuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}), {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+                             {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}}),
+       /*expected_reshuffle_outputs=*/
+       CreateTensors<int64_t>(
+           TensorShape({}),
+           {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+            {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}})},
       {/*dataset_params=*/ShuffleDatasetParamsWithUnknownCardinality(),
        /*expected_shuffle_outputs=*/
        CreateTensors<int64_t>(
@@ -532,6 +581,19 @@ IteratorSaveAndRestoreTestCases() {
                TensorShape({}),
                {{2}, {0}, {1}, {2}, {0}, {1}, {2}, {0}, {1}, {2}, {0},
                 {1}, {2}, {0}, {1}, {2}, {0}, {1}, {2}, {0}, {1}})},
+          {/*dataset_params=*/ShuffleDatasetParams9(),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_shuffle_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape({}),
+               {{0}, {2}, {1}, {3}, {5}, {6}, {4}, {7}, {8}, {9}})},
+          {/*dataset_params=*/ShuffleDatasetParams10(),
+           /*breakpoints=*/{0, 5, 22},
+           /*expected_shuffle_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape({}),
+               {{9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5},
+                {9}, {0}, {8}, {6}, {1}, {3}, {7}, {2}, {4}, {5}})},
           {/*dataset_params=*/ShuffleDatasetParamsWithUnknownCardinality(),
            /*breakpoints=*/{0, 4, 11},
            /*expected_shuffle_outputs=*/
@@ -22,8 +22,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -37,17 +39,21 @@ constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+// Name of the environment variable setting the number of buffers read ahead of
+// the lines on a background thread. Zero disables the read ahead.
+constexpr char kReadaheadBuffersEnvVar[] = "TF_DATA_READAHEAD_BUFFERS";
 
 class TextLineDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, std::vector<string> filenames,
           const string& compression_type,
-          const io::ZlibCompressionOptions& options)
+          const io::ZlibCompressionOptions& options, int readahead_buffers)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         use_compression_(!compression_type.empty()),
-        options_(options) {}
+        options_(options),
+        readahead_buffers_(readahead_buffers) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
@@ -98,6 +104,11 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      ResetStreamsLocked();
+    }
+
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
@@ -197,32 +208,43 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
           &file_));
       input_stream_ =
           std::make_unique<io::RandomAccessInputStream>(file_.get(), false);
+      io::InputStreamInterface* input_stream = input_stream_.get();
+      if (dataset()->readahead_buffers_ > 0) {
+        readahead_input_stream_ = std::make_unique<io::ReadaheadInputStream>(
+            input_stream, dataset()->options_.input_buffer_size,
+            dataset()->readahead_buffers_);
+        input_stream = readahead_input_stream_.get();
+      }
 
       if (dataset()->use_compression_) {
         zlib_input_stream_ = std::make_unique<io::ZlibInputStream>(
-            input_stream_.get(), dataset()->options_.input_buffer_size,
+            input_stream, dataset()->options_.input_buffer_size,
             dataset()->options_.input_buffer_size, dataset()->options_);
         buffered_input_stream_ = std::make_unique<io::BufferedInputStream>(
             zlib_input_stream_.get(), dataset()->options_.input_buffer_size,
             false);
       } else {
         buffered_input_stream_ = std::make_unique<io::BufferedInputStream>(
-            input_stream_.get(), dataset()->options_.input_buffer_size, false);
+            input_stream, dataset()->options_.input_buffer_size, false);
       }
       return absl::OkStatus();
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-      input_stream_.reset();
-      zlib_input_stream_.reset();
+      // The read ahead stream waits for its reads of `input_stream_`.
       buffered_input_stream_.reset();
+      zlib_input_stream_.reset();
+      readahead_input_stream_.reset();
+      input_stream_.reset();
       file_.reset();
     }
 
     mutex mu_;
     std::unique_ptr<io::RandomAccessInputStream> input_stream_
         TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::ReadaheadInputStream> readahead_input_stream_
+        TF_GUARDED_BY(mu_);
     std::unique_ptr<io::ZlibInputStream> zlib_input_stream_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::BufferedInputStream> buffered_input_stream_
         TF_GUARDED_BY(mu_);
@@ -235,6 +257,7 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
   const tstring compression_type_;
   const bool use_compression_;
   const io::ZlibCompressionOptions options_;
+  const int readahead_buffers_;
 };
 
 TextLineDatasetOp::TextLineDatasetOp(OpKernelConstruction* ctx)
@@ -283,8 +306,12 @@ void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
   LogFilenames(filenames);
 
+  int64_t readahead_buffers = 0;
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar(kReadaheadBuffersEnvVar, 0,
+                                          &readahead_buffers));
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        zlib_compression_options);
+                        zlib_compression_options, readahead_buffers);
 }
 
 namespace {
@@ -14,17 +14,35 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/mapped_record_file.h"
+#include "tensorflow/core/kernels/data/tfrecord_index.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -45,6 +63,28 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Name of the environment variable that enables reading uncompressed local
+// TFRecord files through a memory mapping. In this mode records are produced
+// without copying them out of the page cache, and the dataset supports random
+// access (e.g. for global shuffling).
+constexpr char kMmapEnvVar[] = "TF_DATA_TFRECORD_MMAP";
+// Name of the environment variable naming a directory where the record offset
+// indices of uncompressed files are persisted, so that random access (e.g.
+// global shuffling) doesn't scan the files again in later runs.
+constexpr char kIndexDirEnvVar[] = "TF_DATA_TFRECORD_INDEX_DIR";
+// Name of the environment variable setting the number of buffers read ahead of
+// the records on a background thread. Zero disables the read ahead.
+constexpr char kReadaheadBuffersEnvVar[] = "TF_DATA_READAHEAD_BUFFERS";
+// Number of globally shuffled records read in parallel from indexed files.
+constexpr int kRandomAccessReadAhead = 16;
+// Maximum number of files indexed in parallel.
+constexpr int kMaxIndexingThreads = 16;
+
+// Returns whether `filename` refers to the local file system.
+bool IsLocalFile(absl::string_view filename) {
+  return !absl::StrContains(filename, "://") ||
+         absl::StartsWith(filename, "file://");
+}
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -58,17 +98,23 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   bool use_mmap, std::string index_dir,
+                   int readahead_buffers)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        use_mmap_(use_mmap),
+        use_index_(!use_mmap && compression_type.empty()),
+        index_dir_(std::move(index_dir)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    options_.readahead_buffers = readahead_buffers;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -96,12 +142,48 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType, params);
   }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!RandomIndexingCompatible().ok() ||
+        options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    mutex_lock l(mu_);
+    Status s = IndexAllFilesLocked();
+    if (!s.ok()) {
+      VLOG(2) << "Failed to compute the cardinality of " << DebugString()
+              << ": " << s;
+      return kUnknownCardinality;
+    }
+    return cumulative_num_records_.back();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     return absl::OkStatus();
   }
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_ASSIGN_OR_RETURN(Tensor record, GetRecord(index));
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return absl::OkStatus();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (!use_mmap_ && !use_index_) {
+      return DatasetBase::RandomIndexingCompatible();
+    }
+    return absl::OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -120,19 +202,157 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  // Maps the file at `file_index`, starting at its byte offset if one was
+  // specified.
+  absl::StatusOr<core::RefCountPtr<MappedRecordFile>> MapFile(
+      Env* env, size_t file_index) const {
+    return MappedRecordFile::Open(
+        env, TranslateFileName(filenames_[file_index]),
+        byte_offsets_.empty() ? 0 : byte_offsets_[file_index]);
+  }
+
+  // Returns the record at `index` as a scalar string tensor.
+  absl::StatusOr<Tensor> GetRecord(int64_t index) const {
+    TF_RETURN_IF_ERROR(RandomIndexingCompatible());
+    core::RefCountPtr<MappedRecordFile> file;
+    const TFRecordIndex* record_index = nullptr;
+    int64_t index_in_file;
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(IndexAllFilesLocked());
+      if (index < 0 || index >= cumulative_num_records_.back()) {
+        return errors::OutOfRange("Index out of range [0, ",
+                                  cumulative_num_records_.back(),
+                                  "):", index);
+      }
+      const size_t file_index =
+          std::upper_bound(cumulative_num_records_.begin(),
+                           cumulative_num_records_.end(), index) -
+          cumulative_num_records_.begin() - 1;
+      if (use_mmap_) {
+        file = mapped_files_[file_index].GetNewRef();
+      } else {
+        // Indices are never released once built.
+        record_index = record_indices_[file_index].get();
+      }
+      index_in_file = index - cumulative_num_records_[file_index];
+    }
+    if (file) {
+      return file->GetRecordTensor(index_in_file);
+    }
+    Tensor record(DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(
+        record_index->ReadRecord(index_in_file, &record.scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.scalar<tstring>()().size());
+    return record;
+  }
+
+  // Maps or indexes every file of the dataset for random access.
+  Status IndexAllFilesLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!cumulative_num_records_.empty()) {
+      return absl::OkStatus();
+    }
+    std::vector<int64_t> num_records(filenames_.size());
+    if (use_mmap_) {
+      std::vector<core::RefCountPtr<MappedRecordFile>> mapped_files;
+      mapped_files.reserve(filenames_.size());
+      for (size_t i = 0; i < filenames_.size(); ++i) {
+        TF_ASSIGN_OR_RETURN(core::RefCountPtr<MappedRecordFile> file,
+                            MapFile(Env::Default(), i));
+        TF_RETURN_IF_ERROR(file->status());
+        num_records[i] = file->num_records();
+        mapped_files.push_back(std::move(file));
+      }
+      mapped_files_ = std::move(mapped_files);
+    } else {
+      TF_ASSIGN_OR_RETURN(record_indices_, IndexFiles());
+      for (size_t i = 0; i < filenames_.size(); ++i) {
+        num_records[i] = record_indices_[i]->num_records();
+      }
+    }
+    std::vector<int64_t> cumulative_num_records = {0};
+    for (int64_t n : num_records) {
+      cumulative_num_records.push_back(cumulative_num_records.back() + n);
+    }
+    cumulative_num_records_ = std::move(cumulative_num_records);
+    return absl::OkStatus();
+  }
+
+  // Builds or loads the record offset indices of all the files, in parallel
+  // since building them is bound by the latency of the file system.
+  absl::StatusOr<std::vector<std::unique_ptr<TFRecordIndex>>> IndexFiles()
+      const {
+    std::vector<std::unique_ptr<TFRecordIndex>> indices(filenames_.size());
+    std::vector<Status> statuses(filenames_.size());
+    auto index_file = [&](size_t i) {
+      absl::StatusOr<std::unique_ptr<TFRecordIndex>> index =
+          TFRecordIndex::LoadOrBuild(
+              Env::Default(), TranslateFileName(filenames_[i]),
+              byte_offsets_.empty() ? 0 : byte_offsets_[i], index_dir_);
+      if (index.ok()) {
+        indices[i] = *std::move(index);
+      } else {
+        statuses[i] = index.status();
+      }
+    };
+    const int num_threads =
+        std::min<int>(filenames_.size(), kMaxIndexingThreads);
+    if (num_threads <= 1) {
+      for (size_t i = 0; i < filenames_.size(); ++i) {
+        index_file(i);
+      }
+    } else {
+      // The destructor of the pool waits for all the files to be indexed.
+      thread::ThreadPool pool(Env::Default(), "tf_record_index", num_threads);
+      for (size_t i = 0; i < filenames_.size(); ++i) {
+        pool.Schedule([&index_file, i]() { index_file(i); });
+      }
+    }
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
+    return indices;
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        if (dataset()->use_index_) {
+          mutex_lock l(mu_);
+          return GetNextShuffledLocked(ctx, out_tensors, end_of_sequence);
+        }
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
+        // We are currently processing a mapped file, so try to produce the
+        // next record without copying it.
+        if (mapped_file_) {
+          Status s = GetNextMappedRecordLocked(out_tensors);
+          if (s.ok()) {
+            *end_of_sequence = false;
+            return absl::OkStatus();
+          }
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!errors::IsOutOfRange(s)) {
+            return s;
+          }
+        }
+
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
@@ -178,6 +398,27 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       *num_skipped = 0;
       mutex_lock l(mu_);
       do {
+        // We are currently processing a mapped file, so skipping only moves
+        // the record index.
+        if (mapped_file_) {
+          const int64_t num_remaining =
+              mapped_file_->num_records() - record_index_;
+          const int64_t last_num_skipped = std::min<int64_t>(
+              num_remaining, num_to_skip - *num_skipped);
+          record_index_ += last_num_skipped;
+          *num_skipped += last_num_skipped;
+          if (*num_skipped == num_to_skip) {
+            *end_of_sequence = false;
+            return absl::OkStatus();
+          }
+          Status s = mapped_file_->status();
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!s.ok()) {
+            return s;
+          }
+        }
+
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
         if (reader_) {
@@ -230,11 +471,22 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
       }
+      if (mapped_file_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kOffset,
+            static_cast<int64_t>(mapped_file_->offset(record_index_))));
+      }
       return absl::OkStatus();
     }
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        mutex_lock l(mu_);
+        shuffled_element_count_ = *ctx->restored_element_count();
+        read_ahead_.clear();
+        return global_shuffle_iterator_.Restore(ctx);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -245,7 +497,12 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        if (mapped_file_) {
+          TF_ASSIGN_OR_RETURN(record_index_,
+                              mapped_file_->IndexOfOffset(offset));
+        } else {
+          TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        }
       }
       return absl::OkStatus();
     }
@@ -259,6 +516,13 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             " >= filenames_.size():", dataset()->filenames_.size());
       }
 
+      if (dataset()->use_mmap_) {
+        TF_ASSIGN_OR_RETURN(mapped_file_,
+                            dataset()->MapFile(env, current_file_index_));
+        record_index_ = 0;
+        return absl::OkStatus();
+      }
+
       // Actually move on to next file.
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
@@ -272,10 +536,78 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       return absl::OkStatus();
     }
 
+    // Produces the record at `record_index_` of `mapped_file_`. Returns
+    // `OutOfRange` once all the records of the file have been produced.
+    Status GetNextMappedRecordLocked(std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (record_index_ >= mapped_file_->num_records()) {
+        TF_RETURN_IF_ERROR(mapped_file_->status());
+        return errors::OutOfRange("eof");
+      }
+      TF_ASSIGN_OR_RETURN(Tensor record,
+                          mapped_file_->GetRecordTensor(record_index_));
+      ++record_index_;
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(record.scalar<tstring>()().size());
+      out_tensors->push_back(std::move(record));
+      return absl::OkStatus();
+    }
+
+    // Produces the next record in the order given by `ctx->index_mapper()`.
+    // Random reads are dominated by the latency of the file system, so the
+    // records of the next `kRandomAccessReadAhead` positions are read in
+    // parallel.
+    Status GetNextShuffledLocked(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (read_ahead_.empty()) {
+        if (read_ahead_pool_ == nullptr) {
+          read_ahead_pool_ = ctx->CreateThreadPool("tf_record_read_ahead",
+                                                   kRandomAccessReadAhead);
+        }
+        std::vector<absl::StatusOr<Tensor>> records(
+            kRandomAccessReadAhead, absl::UnknownError("Record not read"));
+        BlockingCounter counter(kRandomAccessReadAhead);
+        for (int i = 0; i < kRandomAccessReadAhead; ++i) {
+          absl::StatusOr<size_t> index =
+              ctx->index_mapper()(shuffled_element_count_ + i);
+          if (!index.ok()) {
+            records[i] = index.status();
+            counter.DecrementCount();
+            continue;
+          }
+          read_ahead_pool_->Schedule([this, &records, &counter, i,
+                                      index = *index]() {
+            records[i] = dataset()->GetRecord(index);
+            counter.DecrementCount();
+          });
+        }
+        counter.Wait();
+        read_ahead_.assign(std::make_move_iterator(records.begin()),
+                           std::make_move_iterator(records.end()));
+      }
+      absl::StatusOr<Tensor> record = std::move(read_ahead_.front());
+      read_ahead_.pop_front();
+      ++shuffled_element_count_;
+      if (absl::IsOutOfRange(record.status())) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      TF_RETURN_IF_ERROR(record.status());
+      out_tensors->clear();
+      out_tensors->push_back(*std::move(record));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_file_.reset();
+      record_index_ = 0;
     }
 
     mutex mu_;
@@ -285,6 +617,19 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // Set instead of `file_` and `reader_` when the dataset reads records
+    // through a memory mapping.
+    core::RefCountPtr<MappedRecordFile> mapped_file_ TF_GUARDED_BY(mu_);
+    // Index of the next record of `mapped_file_` to produce.
+    int64_t record_index_ TF_GUARDED_BY(mu_) = 0;
+
+    GlobalShuffleIterator global_shuffle_iterator_;
+    // Number of records produced in the globally shuffled order from indexed
+    // files, and the records read ahead for the next positions.
+    int64_t shuffled_element_count_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<absl::StatusOr<Tensor>> read_ahead_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<thread::ThreadPool> read_ahead_pool_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
@@ -292,6 +637,24 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  // Whether records are read through a memory mapping.
+  const bool use_mmap_;
+  // Whether random access goes through record offset indices, which is the
+  // case for uncompressed files that aren't memory mapped.
+  const bool use_index_;
+  // Directory where the indices are persisted, if not empty.
+  const std::string index_dir_;
+
+  mutable mutex mu_;
+  // Mappings or indices of all the files, built on first use of the random
+  // access API.
+  mutable std::vector<core::RefCountPtr<MappedRecordFile>> mapped_files_
+      TF_GUARDED_BY(mu_);
+  mutable std::vector<std::unique_ptr<TFRecordIndex>> record_indices_
+      TF_GUARDED_BY(mu_);
+  // `cumulative_num_records_[i]` is the number of records in the first `i`
+  // files.
+  mutable std::vector<int64_t> cumulative_num_records_ TF_GUARDED_BY(mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
@@ -308,6 +671,7 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
 
   bool is_gcs_fs = true;
   bool is_s3_fs = true;
+  bool is_local_fs = true;
   std::vector<string> filenames;
   filenames.reserve(filenames_tensor->NumElements());
   for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
@@ -315,6 +679,7 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     filenames.push_back(filenames_tensor->flat<tstring>()(i));
     is_gcs_fs &= absl::StartsWith(filenames[i], kGcsFsPrefix);
     is_s3_fs &= absl::StartsWith(filenames[i], kS3FsPrefix);
+    is_local_fs &= IsLocalFile(filenames[i]);
     metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
   }
   LogFilenames(filenames);
@@ -361,8 +726,22 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
+  bool use_mmap = false;
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar(kMmapEnvVar, false, &use_mmap));
+  // Memory mapping only applies to uncompressed files on the local file
+  // system.
+  use_mmap &= is_local_fs && compression_type.empty();
+
+  std::string index_dir;
+  OP_REQUIRES_OK(ctx, ReadStringFromEnvVar(kIndexDirEnvVar, "", &index_dir));
+
+  int64_t readahead_buffers = 0;
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar(kReadaheadBuffersEnvVar, 0,
+                                          &readahead_buffers));
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        use_mmap, std::move(index_dir), readahead_buffers);
 }
 
 namespace {
@@ -0,0 +1,251 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr size_t kHeaderSize = io::RecordReader::kHeaderSize;
+constexpr size_t kFooterSize = io::RecordReader::kFooterSize;
+
+// Size of the reads issued while walking the record headers. Large enough to
+// amortize the latency of remote file systems.
+constexpr int64_t kBuildBufferSize = 4 << 20;  // 4MB
+
+// Index files hold the magic, the size, modification time and start offset of
+// the indexed file, the number of offsets, the offsets, and a masked CRC of
+// all of the above. All integers are little-endian 64-bit values, except the
+// 32-bit CRC.
+constexpr char kIndexMagic[] = "TFRIDX01";
+constexpr size_t kIndexMagicSize = sizeof(kIndexMagic) - 1;
+constexpr size_t kIndexHeaderSize = kIndexMagicSize + 4 * sizeof(uint64_t);
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<TFRecordIndex>> TFRecordIndex::LoadOrBuild(
+    Env* env, const std::string& filename, uint64_t start_offset,
+    const std::string& index_dir) {
+  FileStatistics stats;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stats));
+  FileVersion version;
+  version.size = stats.length;
+  version.mtime_nsec = stats.mtime_nsec;
+  version.start_offset = start_offset;
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+
+  const std::string index_filename =
+      index_dir.empty() ? "" : IndexFilename(index_dir, filename);
+  absl::StatusOr<std::vector<uint64_t>> offsets =
+      absl::NotFoundError("No index directory");
+  if (!index_filename.empty()) {
+    offsets = Load(env, index_filename, version);
+    if (!offsets.ok() && !absl::IsNotFound(offsets.status())) {
+      LOG(WARNING) << "Ignoring the TFRecord index " << index_filename
+                   << " of " << filename << ": " << offsets.status();
+    }
+  }
+  if (!offsets.ok()) {
+    TF_ASSIGN_OR_RETURN(offsets, Build(filename, file.get(), version));
+    if (!index_filename.empty()) {
+      absl::Status s = Save(env, index_filename, version, *offsets);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to persist the TFRecord index of " << filename
+                     << " to " << index_filename << ": " << s;
+      }
+    }
+  }
+  return absl::WrapUnique(
+      new TFRecordIndex(filename, std::move(file), *std::move(offsets)));
+}
+
+std::string TFRecordIndex::IndexFilename(const std::string& index_dir,
+                                         const std::string& filename) {
+  return io::JoinPath(
+      index_dir,
+      absl::StrCat(io::Basename(filename), ".",
+                   absl::Hex(Fingerprint64(filename), absl::kZeroPad16),
+                   ".tfrecord_index"));
+}
+
+TFRecordIndex::TFRecordIndex(std::string filename,
+                             std::unique_ptr<RandomAccessFile> file,
+                             std::vector<uint64_t> offsets)
+    : filename_(std::move(filename)),
+      file_(std::move(file)),
+      offsets_(std::move(offsets)) {}
+
+absl::Status TFRecordIndex::ReadRecord(int64_t index, tstring* record) const {
+  if (index < 0 || index >= num_records()) {
+    return errors::OutOfRange("Record index out of range [0, ", num_records(),
+                              "): ", index);
+  }
+  const uint64_t offset = offsets_[index];
+  const size_t size = offsets_[index + 1] - offset;
+  const size_t length = size - kHeaderSize - kFooterSize;
+  record->resize_uninitialized(size);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file_->Read(offset, size, &result, record->mdata()));
+  if (result.size() != size) {
+    return errors::DataLoss("truncated record at ", offset, " in file ",
+                            filename_);
+  }
+  const char* header = result.data();
+  if (core::DecodeFixed64(header) != length ||
+      crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64_t))) !=
+          crc32c::Value(header, sizeof(uint64_t))) {
+    return errors::DataLoss("corrupted record at ", offset, " in file ",
+                            filename_);
+  }
+  const char* payload = header + kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(payload + length)) !=
+      crc32c::Value(payload, length)) {
+    return errors::DataLoss("corrupted record at ", offset, " in file ",
+                            filename_);
+  }
+  // `result` may not point into `record` for file systems which serve reads
+  // from their own buffers.
+  std::memmove(record->mdata(), payload, length);
+  record->resize(length);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<uint64_t>> TFRecordIndex::Build(
+    const std::string& filename, RandomAccessFile* file,
+    const FileVersion& version) {
+  io::RecordReaderOptions options;
+  options.buffer_size = kBuildBufferSize;
+  io::RecordReader reader(file, options);
+  std::vector<uint64_t> offsets;
+  uint64_t offset = version.start_offset;
+  while (true) {
+    const uint64_t record_offset = offset;
+    int num_skipped = 0;
+    absl::Status s = reader.SkipRecords(&offset, 1, &num_skipped);
+    if (absl::IsOutOfRange(s)) {
+      break;
+    }
+    if (!s.ok()) {
+      return absl::Status(s.code(), absl::StrCat("Failed to index ", filename,
+                                                 ": ", s.message()));
+    }
+    offsets.push_back(record_offset);
+  }
+  offsets.push_back(offset);
+  VLOG(2) << "Indexed " << offsets.size() - 1 << " records of " << filename;
+  return offsets;
+}
+
+absl::StatusOr<std::vector<uint64_t>> TFRecordIndex::Load(
+    Env* env, const std::string& index_filename, const FileVersion& version) {
+  if (!env->FileExists(index_filename).ok()) {
+    return errors::NotFound("No index at ", index_filename);
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() < kIndexHeaderSize + sizeof(uint32_t) ||
+      absl::string_view(contents.data(), kIndexMagicSize) !=
+          absl::string_view(kIndexMagic, kIndexMagicSize)) {
+    return errors::DataLoss("Invalid TFRecord index header");
+  }
+  const size_t crc_offset = contents.size() - sizeof(uint32_t);
+  if (crc32c::Unmask(core::DecodeFixed32(contents.data() + crc_offset)) !=
+      crc32c::Value(contents.data(), crc_offset)) {
+    return errors::DataLoss("Corrupted TFRecord index");
+  }
+  const char* p = contents.data() + kIndexMagicSize;
+  const uint64_t size = core::DecodeFixed64(p);
+  const int64_t mtime_nsec = core::DecodeFixed64(p + 8);
+  const uint64_t start_offset = core::DecodeFixed64(p + 16);
+  const uint64_t num_offsets = core::DecodeFixed64(p + 24);
+  if (size != version.size || mtime_nsec != version.mtime_nsec ||
+      start_offset != version.start_offset) {
+    return errors::NotFound("Stale index at ", index_filename);
+  }
+  if (num_offsets == 0 ||
+      num_offsets != (crc_offset - kIndexHeaderSize) / sizeof(uint64_t) ||
+      (crc_offset - kIndexHeaderSize) % sizeof(uint64_t) != 0) {
+    return errors::DataLoss("Invalid TFRecord index size");
+  }
+  std::vector<uint64_t> offsets(num_offsets);
+  p = contents.data() + kIndexHeaderSize;
+  for (uint64_t i = 0; i < num_offsets; ++i, p += sizeof(uint64_t)) {
+    offsets[i] = core::DecodeFixed64(p);
+    if (i > 0 && offsets[i] < offsets[i - 1] + kHeaderSize + kFooterSize) {
+      return errors::DataLoss("Invalid TFRecord index offsets");
+    }
+  }
+  if (offsets.back() > version.size) {
+    return errors::DataLoss("Invalid TFRecord index offsets");
+  }
+  return offsets;
+}
+
+absl::Status TFRecordIndex::Save(Env* env, const std::string& index_filename,
+                                 const FileVersion& version,
+                                 const std::vector<uint64_t>& offsets) {
+  std::string contents(kIndexMagic, kIndexMagicSize);
+  contents.reserve(kIndexHeaderSize + offsets.size() * sizeof(uint64_t) +
+                   sizeof(uint32_t));
+  core::PutFixed64(&contents, version.size);
+  core::PutFixed64(&contents, version.mtime_nsec);
+  core::PutFixed64(&contents, version.start_offset);
+  core::PutFixed64(&contents, offsets.size());
+  for (uint64_t offset : offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  const uint32_t crc = crc32c::Value(contents.data(), contents.size());
+  core::PutFixed32(&contents, crc32c::Mask(crc));
+
+  // Writes to a temporary file first so that concurrent readers never see a
+  // partial index.
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(io::Dirname(index_filename)));
+  const std::string tmp_filename =
+      absl::StrCat(index_filename, ".tmp.", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  absl::Status s = env->RenameFile(tmp_filename, index_filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// An index of the record offsets of an uncompressed TFRecord file, for reading
+// its records in any order on any file system.
+//
+// Building the index reads the whole file once, skipping over the record
+// payloads. Since that is expensive for large remote files, the index can be
+// persisted to a directory and is then reused by later runs, for as long as
+// the size and modification time of the file don't change.
+//
+// This class is thread-safe.
+class TFRecordIndex {
+ public:
+  // Returns the index of the records of `filename` starting at
+  // `start_offset`. If `index_dir` is not empty, loads the index persisted
+  // there if it is up to date, and otherwise persists the index it builds.
+  // Failing to persist the index is not an error.
+  static absl::StatusOr<std::unique_ptr<TFRecordIndex>> LoadOrBuild(
+      Env* env, const std::string& filename, uint64_t start_offset = 0,
+      const std::string& index_dir = "");
+
+  // Returns the path of the file in `index_dir` persisting the index of
+  // `filename`.
+  static std::string IndexFilename(const std::string& index_dir,
+                                   const std::string& filename);
+
+  // Returns the number of records in the file.
+  int64_t num_records() const { return offsets_.size() - 1; }
+
+  // Returns the byte offset of the header of the record at `index`. For
+  // `index == num_records()`, returns the offset past the last record.
+  uint64_t offset(int64_t index) const { return offsets_[index]; }
+
+  // Reads the payload of the record at `index` into `record` with a single
+  // read of the file, checking its CRCs.
+  absl::Status ReadRecord(int64_t index, tstring* record) const;
+
+ private:
+  // Metadata of the file the index was built for.
+  struct FileVersion {
+    uint64_t size = 0;
+    int64_t mtime_nsec = 0;
+    uint64_t start_offset = 0;
+  };
+
+  TFRecordIndex(std::string filename, std::unique_ptr<RandomAccessFile> file,
+                std::vector<uint64_t> offsets);
+
+  // Walks the record headers of `file` from `version.start_offset`.
+  static absl::StatusOr<std::vector<uint64_t>> Build(
+      const std::string& filename, RandomAccessFile* file,
+      const FileVersion& version);
+  // Reads the offsets persisted in `index_filename`. Returns `NotFound` if they
+  // don't exist or are stale.
+  static absl::StatusOr<std::vector<uint64_t>> Load(
+      Env* env, const std::string& index_filename, const FileVersion& version);
+  static absl::Status Save(Env* env, const std::string& index_filename,
+                           const FileVersion& version,
+                           const std::vector<uint64_t>& offsets);
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  // Header offset of each record, followed by the offset past the last one.
+  const std::vector<uint64_t> offsets_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_TFRECORD_INDEX_H_
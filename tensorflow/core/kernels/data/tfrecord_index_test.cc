@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string WriteRecords(const std::string& name,
+                         const std::vector<std::string>& records) {
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  for (const std::string& record : records) {
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return filename;
+}
+
+void ExpectRecords(const TFRecordIndex& index,
+                   const std::vector<std::string>& records) {
+  ASSERT_EQ(index.num_records(), records.size());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    tstring record;
+    TF_ASSERT_OK(index.ReadRecord(i, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+  tstring record;
+  EXPECT_TRUE(errors::IsOutOfRange(index.ReadRecord(records.size(), &record)));
+}
+
+TEST(TFRecordIndexTest, ReadRecords) {
+  const std::vector<std::string> records = {"a", "", "bcdef", "gh"};
+  const std::string filename = WriteRecords("indexed_records", records);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::LoadOrBuild(Env::Default(), filename));
+  ExpectRecords(*index, records);
+  EXPECT_EQ(index->offset(0), uint64_t{0});
+}
+
+TEST(TFRecordIndexTest, StartOffset) {
+  const std::vector<std::string> records = {"abc", "de", "f"};
+  const std::string filename = WriteRecords("offset_records", records);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> full_index,
+                          TFRecordIndex::LoadOrBuild(Env::Default(), filename));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename,
+                                 full_index->offset(1)));
+  ExpectRecords(*index, {"de", "f"});
+}
+
+TEST(TFRecordIndexTest, PersistedIndex) {
+  const std::vector<std::string> records = {"a", "bc", "def"};
+  const std::string filename = WriteRecords("persisted_records", records);
+  const std::string index_dir = io::JoinPath(testing::TmpDir(), "indices");
+  const std::string index_filename =
+      TFRecordIndex::IndexFilename(index_dir, filename);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename, 0, index_dir));
+  ExpectRecords(*index, records);
+  TF_ASSERT_OK(Env::Default()->FileExists(index_filename));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename, 0, index_dir));
+  ExpectRecords(*index, records);
+
+  // A stale or corrupted index is rebuilt.
+  const std::vector<std::string> new_records = {"ghijk", "l"};
+  WriteRecords("persisted_records", new_records);
+  TF_ASSERT_OK_AND_ASSIGN(
+      index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename, 0, index_dir));
+  ExpectRecords(*index, new_records);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, "garbage"));
+  TF_ASSERT_OK_AND_ASSIGN(
+      index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename, 0, index_dir));
+  ExpectRecords(*index, new_records);
+}
+
+TEST(TFRecordIndexTest, TruncatedFile) {
+  const std::string filename = WriteRecords("truncated_records", {"abc"});
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents.resize(contents.size() - 2);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  EXPECT_TRUE(errors::IsDataLoss(
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename).status()));
+}
+
+TEST(TFRecordIndexTest, EmptyFile) {
+  const std::string filename = WriteRecords("empty_records", {});
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::LoadOrBuild(Env::Default(), filename));
+  ExpectRecords(*index, {});
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
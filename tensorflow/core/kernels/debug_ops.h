@@ -466,14 +466,19 @@ class DebugIdentityV2Op : public OpKernel {
     if (context->HasAttr("tfdbg_run_id")) {
       OP_REQUIRES_OK(context, context->GetAttr("tfdbg_run_id", &tfdbg_run_id_));
     }
+    // The writers are per-dump-root singletons that are never deleted, so
+    // they are looked up once rather than under a global lock on every step.
+    for (const string& dump_root : dump_roots_) {
+      debug_events_writers_.push_back(
+          tfdbg::DebugEventsWriter::GetDebugEventsWriter(
+              dump_root, tfdbg_run_id_, circular_buffer_size_));
+    }
   }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& tensor = context->input(0);
-    for (const string& dump_root : dump_roots_) {
-      tfdbg::DebugEventsWriter* debug_events_writer =
-          tfdbg::DebugEventsWriter::GetDebugEventsWriter(
-              dump_root, tfdbg_run_id_, circular_buffer_size_);
+    for (tfdbg::DebugEventsWriter* debug_events_writer :
+         debug_events_writers_) {
       OP_REQUIRES_OK(context, debug_events_writer->WriteGraphExecutionTrace(
                                   tfdbg_context_id_, device_name_, op_name_,
                                   output_slot_, tensor_debug_mode_, tensor));
@@ -483,6 +488,7 @@ class DebugIdentityV2Op : public OpKernel {
 
  private:
   std::vector<string> dump_roots_;
+  std::vector<tfdbg::DebugEventsWriter*> debug_events_writers_;
   string tfdbg_context_id_;
   string device_name_;
   string op_name_;
@@ -586,11 +592,7 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
                      context->allocate_output(0, shape, &output_tensor));
       output_tensor->flat<Tout>()(0) = tensor_id;  // Slot tensor id
       output_tensor->flat<Tout>()(1) = 0.0;        // Has inf or nan
-      int fp_props =
-          std::accumulate(data, data + size, 0, [](const int x, const Tin& y) {
-            return Eigen::numext::isfinite(y) ? x : 1;
-          });
-      if (fp_props) {
+      if (!AllFinite(data, size)) {
         output_tensor->flat<Tout>()(1) = 1.0;
       }
     } else if (tensor_debug_mode_ == 3) {  // CONCISE_HEALTH
@@ -602,7 +604,8 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
 
       // Accumulator value [neg_inf_count, pos_inf_count, nan_count]
       Tout fp_props[3] = {0.0, 0.0, 0.0};
-      std::for_each(data, data + size, [&fp_props](const Tin& y) {
+      const int64_t count_size = AllFinite(data, size) ? 0 : size;
+      std::for_each(data, data + count_size, [&fp_props](const Tin& y) {
         if (TF_PREDICT_TRUE(Eigen::numext::isfinite(y))) {
           // Do nothing: common case.
         } else if (Eigen::numext::isinf(y)) {
@@ -691,8 +694,9 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
       output_tensor->flat<Tout>()(1) = 0.0;  // Slot for inf.
       output_tensor->flat<Tout>()(2) = 0.0;  // Slot for nan.
 
-      int fp_props =
-          std::accumulate(data, data + size, 0, [](const int x, const Tin& y) {
+      const int64_t count_size = AllFinite(data, size) ? 0 : size;
+      int fp_props = std::accumulate(
+          data, data + count_size, 0, [](const int x, const Tin& y) {
             int result = x;
             if (TF_PREDICT_TRUE(Eigen::numext::isfinite(y))) {
               // Do nothing: common case.
@@ -721,6 +725,20 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
   }
 
  private:
+  // Returns whether all the `size` elements of `data` are finite.  Multiplying
+  // by zero maps the finite values to zero and the others to NaN, so this is a
+  // sum, which Eigen vectorizes, rather than a branch per element.
+  static bool AllFinite(const Tin* data, int64_t size) {
+    if constexpr (Eigen::NumTraits<Tin>::IsInteger) {
+      return true;
+    } else {
+      typename TTypes<Tin>::ConstFlat in(data, size);
+      const Eigen::Tensor<Tin, 0, Eigen::RowMajor> zero_sum =
+          (in * in.constant(Tin(0))).sum();
+      return Eigen::numext::isfinite(zero_sum());
+    }
+  }
+
   int tensor_debug_mode_;
   int64_t tensor_id_;
   static constexpr int kShapeDims = 6;
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <algorithm>
+#include <deque>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -21,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -81,148 +85,196 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    // Records are parsed independently into disjoint output elements, so large
+    // batches are split across the worker threads. Each shard stops at its
+    // first bad record, and the error of the first bad record in the batch is
+    // reported, as if the records were parsed in order.
+    int64_t total_bytes = 0;
     for (int64_t i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
-
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+      total_bytes += records_t(i).size();
+    }
+    const int64_t cost_per_record =
+        kCostPerByte * (total_bytes / std::max<int64_t>(records_size, 1)) +
+        kCostPerField * out_type_.size();
 
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32_t value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
-            }
-            break;
+    mutex mu;
+    int64_t first_error_record = records_size;
+    Status first_error;
+    auto parse_records = [&](int64_t start, int64_t limit) {
+      std::vector<StringPiece> fields;
+      std::deque<string> unescaped_fields;
+      for (int64_t i = start; i < limit; ++i) {
+        Status s = ParseRecord(records_t(i), i, record_defaults, &output,
+                               &fields, &unescaped_fields);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < first_error_record) {
+            first_error_record = i;
+            first_error = std::move(s);
           }
-          case DT_INT64: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+          return;
+        }
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_record, parse_records);
+    OP_REQUIRES_OK(ctx, first_error);
+  }
+
+ private:
+  // Rough costs for sharding the records, in cycles.
+  static constexpr int64_t kCostPerByte = 10;
+  static constexpr int64_t kCostPerField = 100;
+
+  std::vector<DataType> out_type_;
+  std::vector<int64_t> select_cols_;
+  char delim_;
+  bool use_quote_delim_;
+  bool select_all_cols_;
+  string na_value_;
 
-              output[f]->flat<int64_t>()(i) =
-                  record_defaults[f].flat<int64_t>()(0);
-            } else {
-              int64_t value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64_t>()(i) = value;
+  // Parses the selected fields of `record` into element `i` of the outputs.
+  // The numeric fields are converted directly from the record, without
+  // copying them into strings. `fields` and `unescaped_fields` are scratch
+  // space reused across records.
+  Status ParseRecord(StringPiece record, int64_t i,
+                     const OpInputList& record_defaults, OpOutputList* output,
+                     std::vector<StringPiece>* fields,
+                     std::deque<string>* unescaped_fields) const {
+    fields->clear();
+    unescaped_fields->clear();
+    TF_RETURN_IF_ERROR(ExtractFields(record, fields, unescaped_fields));
+    if (fields->size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields->size(),
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const DataType& dtype = out_type_[f];
+      const StringPiece field = (*fields)[f];
+      // If this field is empty or NA value, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      const bool missing = field.empty() || field == na_value_;
+      if (missing) {
+        TF_RETURN_IF_ERROR(CheckHasDefault(record_defaults, f, i, dtype));
+      }
+      switch (dtype) {
+        case DT_INT32: {
+          if (missing) {
+            (*output)[f]->flat<int32>()(i) =
+                record_defaults[f].flat<int32>()(0);
+          } else {
+            int32_t value;
+            if (!strings::safe_strto32(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ", field);
             }
-            break;
+            (*output)[f]->flat<int32>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (missing) {
+            (*output)[f]->flat<int64_t>()(i) =
+                record_defaults[f].flat<int64_t>()(0);
+          } else {
+            int64_t value;
+            if (!strings::safe_strto64(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ", field);
             }
-            break;
+            (*output)[f]->flat<int64_t>()(i) = value;
           }
-          case DT_DOUBLE: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<double>()(i) =
-                  record_defaults[f].flat<double>()(0);
-            } else {
-              double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid double: ", fields[f]));
-              output[f]->flat<double>()(i) = value;
+          break;
+        }
+        case DT_FLOAT: {
+          if (missing) {
+            (*output)[f]->flat<float>()(i) =
+                record_defaults[f].flat<float>()(0);
+          } else {
+            float value;
+            if (!strings::safe_strtof(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ", field);
             }
-            break;
+            (*output)[f]->flat<float>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<tstring>()(i) =
-                  record_defaults[f].flat<tstring>()(0);
-            } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+          break;
+        }
+        case DT_DOUBLE: {
+          if (missing) {
+            (*output)[f]->flat<double>()(i) =
+                record_defaults[f].flat<double>()(0);
+          } else {
+            double value;
+            if (!strings::safe_strtod(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid double: ", field);
             }
-            break;
+            (*output)[f]->flat<double>()(i) = value;
+          }
+          break;
+        }
+        case DT_STRING: {
+          if (missing) {
+            (*output)[f]->flat<tstring>()(i) =
+                record_defaults[f].flat<tstring>()(0);
+          } else {
+            (*output)[f]->flat<tstring>()(i).assign(field.data(),
+                                                    field.size());
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        default:
+          return errors::InvalidArgument("csv: data type ", dtype,
+                                         " not supported in field ", f);
       }
     }
+    return OkStatus();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  std::vector<int64_t> select_cols_;
-  char delim_;
-  bool use_quote_delim_;
-  bool select_all_cols_;
-  string na_value_;
+  static Status CheckHasDefault(const OpInputList& record_defaults, int f,
+                                int64_t i, DataType dtype) {
+    switch (dtype) {
+      case DT_INT32:
+      case DT_INT64:
+      case DT_FLOAT:
+      case DT_DOUBLE:
+      case DT_STRING:
+        if (record_defaults[f].NumElements() != 1) {
+          return errors::InvalidArgument(
+              "Field ", f, " is required but missing in record ", i, "!");
+        }
+        return OkStatus();
+      default:
+        // Reported as an unsupported type by the caller.
+        return OkStatus();
+    }
+  }
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64_t current_idx = 0;
+  // Splits `input` into its selected fields. The fields point into `input`,
+  // except for quoted fields with escaped quotes, which are unescaped into
+  // `unescaped_fields`. Delimiters and quotes are found with memchr rather
+  // than by testing each character.
+  Status ExtractFields(StringPiece input, std::vector<StringPiece>* result,
+                       std::deque<string>* unescaped_fields) const {
+    size_t current_idx = 0;
     int64_t num_fields_parsed = 0;
     int64_t selector_idx = 0;  // Keep track of index into select_cols
 
     if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
+      while (current_idx < input.size()) {
         if (input[current_idx] == '\n' || input[current_idx] == '\r') {
           current_idx++;
           continue;
         }
 
         bool quoted = false;
-        bool include =
-            (select_all_cols_ || select_cols_[selector_idx] ==
-                                     static_cast<size_t>(num_fields_parsed));
+        bool include = (select_all_cols_ ||
+                        select_cols_[selector_idx] == num_fields_parsed);
 
         if (use_quote_delim_ && input[current_idx] == '"') {
           quoted = true;
@@ -230,67 +282,69 @@ class DecodeCSVOp : public OpKernel {
         }
 
         // This is the body of the field;
-        string field;
+        StringPiece field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          size_t end = input.find(delim_, current_idx);
+          if (end == StringPiece::npos) end = input.size();
+          field = input.substr(current_idx, end - current_idx);
+          if ((use_quote_delim_ && field.find('"') != StringPiece::npos) ||
+              field.find('\n') != StringPiece::npos ||
+              field.find('\r') != StringPiece::npos) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
 
           // Go to next field or the end
-          current_idx++;
-        } else if (use_quote_delim_) {
+          current_idx = end + 1;
+        } else {
           // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
+          const size_t field_start = current_idx;
+          string* unescaped = nullptr;
+          while (true) {
+            const size_t quote = input.find('"', current_idx);
+            if (quote == StringPiece::npos) {
+              return errors::InvalidArgument(
+                  "Quoted field has to end with quote followed by delim or "
+                  "end");
+            }
+            const bool is_last = quote == input.size() - 1 ||
+                                 input[quote + 1] == delim_;
+            if (!is_last && input[quote + 1] != '"') {
+              return errors::InvalidArgument(
+                  "Quote inside a string has to be escaped by another quote");
             }
+            if (is_last && unescaped == nullptr) {
+              field = input.substr(field_start, quote - field_start);
+            } else if (include) {
+              if (unescaped == nullptr) {
+                unescaped = &unescaped_fields->emplace_back();
+              }
+              unescaped->append(input.data() + current_idx,
+                                quote - current_idx);
+              if (!is_last) unescaped->push_back('"');
+            }
+            current_idx = quote + 2;
+            if (is_last) break;
           }
-
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
-
-          current_idx += 2;
+          if (unescaped != nullptr) field = *unescaped;
         }
 
         num_fields_parsed++;
         if (include) {
           result->push_back(field);
           selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+          if (selector_idx == select_cols_.size()) return OkStatus();
         }
       }
 
-      bool include =
-          (select_all_cols_ || select_cols_[selector_idx] ==
-                                   static_cast<size_t>(num_fields_parsed));
+      bool include = (select_all_cols_ ||
+                      select_cols_[selector_idx] == num_fields_parsed);
       // Check if the last field is missing
-      if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+      if (include && input[input.size() - 1] == delim_) {
+        result->push_back(StringPiece());
+      }
     }
+    return OkStatus();
   }
 };
 
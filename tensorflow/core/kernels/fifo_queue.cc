@@ -48,8 +48,48 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   }
 }
 
+bool FIFOQueue::TryEnqueueFast(const Tuple& tuple, OpKernelContext* ctx) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  bool has_dequeue_attempts;
+  {
+    mutex_lock l(mu_);
+    // Waiting enqueues, including a pending Close, must complete first.
+    if (closed_ || !enqueue_attempts_.empty() ||
+        queues_[0].size() >= static_cast<size_t>(capacity_)) {
+      return false;
+    }
+    for (int i = 0; i < num_components(); ++i) {
+      queues_[i].push_back(tuple[i]);
+    }
+    has_dequeue_attempts = !dequeue_attempts_.empty();
+  }
+  if (has_dequeue_attempts) FlushUnlocked();
+  return true;
+}
+
+bool FIFOQueue::TryDequeueFast(OpKernelContext* ctx, Tuple* tuple) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  bool has_enqueue_attempts;
+  {
+    mutex_lock l(mu_);
+    // Waiting dequeues, including DequeueMany, must complete first.
+    if (!dequeue_attempts_.empty() || queues_[0].empty()) {
+      return false;
+    }
+    DequeueLocked(ctx, tuple);
+    has_enqueue_attempts = !enqueue_attempts_.empty();
+  }
+  if (has_enqueue_attempts) FlushUnlocked();
+  return true;
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  if (TryEnqueueFast(tuple, ctx)) {
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +193,14 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  {
+    Tuple tuple;
+    if (TryDequeueFast(ctx, &tuple)) {
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -61,6 +61,16 @@ class FIFOQueue : public TypedQueue<std::deque<Tensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Fast paths of TryEnqueue and TryDequeue for when the element can be moved
+  // right away and no earlier attempt is waiting. They take mu_ once and skip
+  // the attempt and cancellation bookkeeping, and only flush the attempts of
+  // the other side if there are any. Return false, having done nothing, if
+  // the operation has to wait or fail through the attempt machinery.
+  bool TryEnqueueFast(const Tuple& tuple, OpKernelContext* ctx)
+      TF_LOCKS_EXCLUDED(mu_);
+  bool TryDequeueFast(OpKernelContext* ctx, Tuple* tuple)
+      TF_LOCKS_EXCLUDED(mu_);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64_t index,
                                              int component,
                                              OpKernelContext* ctx,
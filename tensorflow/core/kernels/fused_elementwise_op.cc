@@ -0,0 +1,419 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Evaluates a chain of elementwise ops, as fused by the Grappler remapper,
+// block by block: every op of the chain is applied to a block of elements that
+// fits in the L1 cache before moving on to the next block, so that the
+// intermediate results never go through main memory.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class FusedOp {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+  kNeg,
+  kAbs,
+  kSquare,
+  kSqrt,
+  kRsqrt,
+  kExp,
+  kLog,
+  kTanh,
+  kSigmoid,
+  kErf,
+  kInverse,
+  kRelu,
+  kRelu6,
+};
+
+struct FusedOpInfo {
+  FusedOp op;
+  bool is_binary;
+};
+
+const absl::flat_hash_map<std::string, FusedOpInfo>& FusedOps() {
+  static const auto* const fused_ops =
+      new absl::flat_hash_map<std::string, FusedOpInfo>({
+          {"Add", {FusedOp::kAdd, true}},
+          {"AddV2", {FusedOp::kAdd, true}},
+          {"Sub", {FusedOp::kSub, true}},
+          {"Mul", {FusedOp::kMul, true}},
+          {"Div", {FusedOp::kDiv, true}},
+          {"RealDiv", {FusedOp::kDiv, true}},
+          {"Maximum", {FusedOp::kMaximum, true}},
+          {"Minimum", {FusedOp::kMinimum, true}},
+          {"SquaredDifference", {FusedOp::kSquaredDifference, true}},
+          {"Neg", {FusedOp::kNeg, false}},
+          {"Abs", {FusedOp::kAbs, false}},
+          {"Square", {FusedOp::kSquare, false}},
+          {"Sqrt", {FusedOp::kSqrt, false}},
+          {"Rsqrt", {FusedOp::kRsqrt, false}},
+          {"Exp", {FusedOp::kExp, false}},
+          {"Log", {FusedOp::kLog, false}},
+          {"Tanh", {FusedOp::kTanh, false}},
+          {"Sigmoid", {FusedOp::kSigmoid, false}},
+          {"Erf", {FusedOp::kErf, false}},
+          {"Inv", {FusedOp::kInverse, false}},
+          {"Reciprocal", {FusedOp::kInverse, false}},
+          {"Relu", {FusedOp::kRelu, false}},
+          {"Relu6", {FusedOp::kRelu6, false}},
+      });
+  return *fused_ops;
+}
+
+template <typename Functor>
+int64_t FunctorCost() {
+  return Eigen::internal::functor_traits<typename Functor::func>::Cost;
+}
+
+// Returns the estimated cost, in cycles, to apply the op to one element.
+template <typename T>
+int64_t FusedOpCost(FusedOp op) {
+  switch (op) {
+    case FusedOp::kAdd:
+      return FunctorCost<functor::add<T>>();
+    case FusedOp::kSub:
+      return FunctorCost<functor::sub<T>>();
+    case FusedOp::kMul:
+      return FunctorCost<functor::mul<T>>();
+    case FusedOp::kDiv:
+      return FunctorCost<functor::div<T>>();
+    case FusedOp::kMaximum:
+    case FusedOp::kRelu:
+      return FunctorCost<functor::maximum<T>>();
+    case FusedOp::kMinimum:
+      return FunctorCost<functor::minimum<T>>();
+    case FusedOp::kSquaredDifference:
+      return FunctorCost<functor::squared_difference<T>>();
+    case FusedOp::kNeg:
+      return FunctorCost<functor::neg<T>>();
+    case FusedOp::kAbs:
+      return FunctorCost<functor::abs<T>>();
+    case FusedOp::kSquare:
+      return FunctorCost<functor::square<T>>();
+    case FusedOp::kSqrt:
+      return FunctorCost<functor::sqrt<T>>();
+    case FusedOp::kRsqrt:
+      return FunctorCost<functor::rsqrt<T>>();
+    case FusedOp::kExp:
+      return FunctorCost<functor::exp<T>>();
+    case FusedOp::kLog:
+      return FunctorCost<functor::log<T>>();
+    case FusedOp::kTanh:
+      return FunctorCost<functor::tanh<T>>();
+    case FusedOp::kSigmoid:
+      return FunctorCost<functor::sigmoid<T>>();
+    case FusedOp::kErf:
+      return FunctorCost<functor::erf<T>>();
+    case FusedOp::kInverse:
+      return FunctorCost<functor::inverse<T>>();
+    case FusedOp::kRelu6:
+      return FunctorCost<functor::maximum<T>>() +
+             FunctorCost<functor::minimum<T>>();
+  }
+  return 1;
+}
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args_));
+    std::vector<std::string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    std::vector<int32> operands;
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+    OP_REQUIRES(context, operands.size() == 2 * fused_ops.size(),
+                errors::InvalidArgument(
+                    "_FusedElementwise expects two operands per fused op, got ",
+                    operands.size(), " operands for ", fused_ops.size(),
+                    " ops"));
+
+    const int num_values = num_args_ + fused_ops.size();
+    std::vector<int> last_use(num_values, -1);
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      auto it = FusedOps().find(fused_ops[i]);
+      OP_REQUIRES(context, it != FusedOps().end(),
+                  errors::Unimplemented("Fusion of ", fused_ops[i],
+                                        " is not supported."));
+      Instruction instruction;
+      instruction.op = it->second.op;
+      instruction.lhs = operands[2 * i];
+      instruction.rhs = it->second.is_binary ? operands[2 * i + 1] : -1;
+      const int value = num_args_ + i;
+      for (int operand : {instruction.lhs, instruction.rhs}) {
+        if (operand == -1 && !it->second.is_binary) continue;
+        OP_REQUIRES(context, operand >= 0 && operand < value,
+                    errors::InvalidArgument("Invalid operand ", operand,
+                                            " of fused op ", i, " (",
+                                            fused_ops[i], ")"));
+        last_use[operand] = i;
+      }
+      cost_per_element_ += FusedOpCost<T>(instruction.op);
+      program_.push_back(instruction);
+    }
+
+    // Allocate the slots of scratch memory holding the result of each op, so
+    // that results share slots once they are no longer used.
+    std::vector<int> slots(num_values, -1);
+    std::vector<int> free_slots;
+    for (int i = 0; i < program_.size(); ++i) {
+      Instruction& instruction = program_[i];
+      instruction.lhs_slot = slots[instruction.lhs];
+      instruction.rhs_slot =
+          instruction.rhs != -1 ? slots[instruction.rhs] : -1;
+      // Operands are read before the result is written, element by element,
+      // so the result may reuse the slot of an operand used for the last time.
+      for (int operand : {instruction.lhs, instruction.rhs}) {
+        if (operand >= num_args_ && last_use[operand] == i &&
+            slots[operand] != -1) {
+          free_slots.push_back(slots[operand]);
+          last_use[operand] = -1;
+        }
+      }
+      if (i == program_.size() - 1) {
+        // The last op writes the output.
+        instruction.slot = -1;
+      } else if (!free_slots.empty()) {
+        instruction.slot = free_slots.back();
+        free_slots.pop_back();
+      } else {
+        instruction.slot = num_slots_++;
+      }
+      slots[num_args_ + i] = instruction.slot;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList args;
+    OP_REQUIRES_OK(context, context->input_list("args", &args));
+
+    // Arguments are either scalars, broadcast to the output shape, or of the
+    // output shape.
+    const Tensor* shaped_arg = nullptr;
+    std::vector<int> forwardable_args;
+    for (int i = 0; i < args.size(); ++i) {
+      if (TensorShapeUtils::IsScalar(args[i].shape())) continue;
+      if (shaped_arg == nullptr) {
+        shaped_arg = &args[i];
+      } else {
+        OP_REQUIRES(context, args[i].shape() == shaped_arg->shape(),
+                    errors::InvalidArgument(
+                        "_FusedElementwise arguments must be scalars or have "
+                        "the same shape, got ",
+                        shaped_arg->shape().DebugString(), " and ",
+                        args[i].shape().DebugString()));
+      }
+      forwardable_args.push_back(i);
+    }
+    const TensorShape output_shape =
+        shaped_arg != nullptr ? shaped_arg->shape() : TensorShape({});
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                forwardable_args, 0, output_shape, &output));
+    const int64_t num_elements = output_shape.num_elements();
+    if (num_elements == 0) return;
+
+    std::vector<const T*> arg_data(args.size());
+    std::vector<bool> arg_is_scalar(args.size());
+    for (int i = 0; i < args.size(); ++i) {
+      arg_data[i] = args[i].flat<T>().data();
+      arg_is_scalar[i] = TensorShapeUtils::IsScalar(args[i].shape());
+    }
+    T* output_data = output->flat<T>().data();
+
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * args.size(),
+                                   /*bytes_stored=*/sizeof(T),
+                                   cost_per_element_);
+    context->eigen_device<Eigen::ThreadPoolDevice>().parallelFor(
+        num_elements, cost,
+        [this, &arg_data, &arg_is_scalar, output_data](int64_t begin,
+                                                       int64_t end) {
+          Evaluate(arg_data, arg_is_scalar, output_data, begin, end);
+        });
+  }
+
+ private:
+  // Number of elements each op is applied to at a time.
+  static constexpr int64_t kBlockSize = 1024;
+
+  struct Instruction {
+    FusedOp op;
+    // Operands, as indices of either arguments or results of previous ops.
+    int lhs;
+    int rhs;
+    // Slots of scratch memory holding the operands if they are results of
+    // previous ops, and the result (-1 for the output).
+    int lhs_slot;
+    int rhs_slot;
+    int slot;
+  };
+
+  using ConstBlock = typename TTypes<T>::UnalignedConstFlat;
+  using Block = typename TTypes<T>::UnalignedFlat;
+
+  static void Apply(FusedOp op, const ConstBlock& x, const ConstBlock& y,
+                    Block* out) {
+    switch (op) {
+      case FusedOp::kAdd:
+        *out = x.binaryExpr(y, typename functor::add<T>::func());
+        break;
+      case FusedOp::kSub:
+        *out = x.binaryExpr(y, typename functor::sub<T>::func());
+        break;
+      case FusedOp::kMul:
+        *out = x.binaryExpr(y, typename functor::mul<T>::func());
+        break;
+      case FusedOp::kDiv:
+        *out = x.binaryExpr(y, typename functor::div<T>::func());
+        break;
+      case FusedOp::kMaximum:
+        *out = x.binaryExpr(y, typename functor::maximum<T>::func());
+        break;
+      case FusedOp::kMinimum:
+        *out = x.binaryExpr(y, typename functor::minimum<T>::func());
+        break;
+      case FusedOp::kSquaredDifference:
+        *out = x.binaryExpr(y, typename functor::squared_difference<T>::func());
+        break;
+      case FusedOp::kNeg:
+        *out = x.unaryExpr(typename functor::neg<T>::func());
+        break;
+      case FusedOp::kAbs:
+        *out = x.unaryExpr(typename functor::abs<T>::func());
+        break;
+      case FusedOp::kSquare:
+        *out = x.unaryExpr(typename functor::square<T>::func());
+        break;
+      case FusedOp::kSqrt:
+        *out = x.unaryExpr(typename functor::sqrt<T>::func());
+        break;
+      case FusedOp::kRsqrt:
+        *out = x.unaryExpr(typename functor::rsqrt<T>::func());
+        break;
+      case FusedOp::kExp:
+        *out = x.unaryExpr(typename functor::exp<T>::func());
+        break;
+      case FusedOp::kLog:
+        *out = x.unaryExpr(typename functor::log<T>::func());
+        break;
+      case FusedOp::kTanh:
+        *out = x.unaryExpr(typename functor::tanh<T>::func());
+        break;
+      case FusedOp::kSigmoid:
+        *out = x.unaryExpr(typename functor::sigmoid<T>::func());
+        break;
+      case FusedOp::kErf:
+        *out = x.unaryExpr(typename functor::erf<T>::func());
+        break;
+      case FusedOp::kInverse:
+        *out = x.unaryExpr(typename functor::inverse<T>::func());
+        break;
+      // Same as the Relu and Relu6 kernels.
+      case FusedOp::kRelu:
+        *out = x.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0));
+        break;
+      case FusedOp::kRelu6:
+        *out = x.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0))
+                   .template cwiseMin<Eigen::PropagateNaN>(static_cast<T>(6));
+        break;
+    }
+  }
+
+  // Evaluates the elements [begin, end) of the output.
+  void Evaluate(const std::vector<const T*>& arg_data,
+                const std::vector<bool>& arg_is_scalar, T* output_data,
+                int64_t begin, int64_t end) const {
+    std::vector<T> scratch(num_slots_ * kBlockSize);
+    // Scalar arguments are broadcast to a block once and for all.
+    std::vector<std::vector<T>> broadcast_args(arg_data.size());
+    for (int i = 0; i < arg_data.size(); ++i) {
+      if (arg_is_scalar[i]) {
+        broadcast_args[i].assign(kBlockSize, *arg_data[i]);
+      }
+    }
+
+    for (int64_t block = begin; block < end; block += kBlockSize) {
+      const int64_t size = std::min(kBlockSize, end - block);
+      auto operand = [&](int value, int slot) -> const T* {
+        if (value < num_args_) {
+          return arg_is_scalar[value] ? broadcast_args[value].data()
+                                      : arg_data[value] + block;
+        }
+        return scratch.data() + slot * kBlockSize;
+      };
+      for (const Instruction& instruction : program_) {
+        ConstBlock x(operand(instruction.lhs, instruction.lhs_slot), size);
+        // Unary ops ignore their second operand.
+        ConstBlock y(instruction.rhs != -1
+                         ? operand(instruction.rhs, instruction.rhs_slot)
+                         : x.data(),
+                     size);
+        Block out(instruction.slot == -1
+                      ? output_data + block
+                      : scratch.data() + instruction.slot * kBlockSize,
+                  size);
+        Apply(instruction.op, x, y, &out);
+      }
+    }
+  }
+
+  int num_args_;
+  std::vector<Instruction> program_;
+  int num_slots_ = 0;
+  int64_t cost_per_element_ = 0;
+};
+
+#define REGISTER_CPU_KERNEL(T)                                             \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+TF_CALL_half(REGISTER_CPU_KERNEL);
+TF_CALL_float(REGISTER_CPU_KERNEL);
+TF_CALL_double(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
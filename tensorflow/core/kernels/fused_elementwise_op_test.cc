@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_args, const std::vector<string>& fused_ops,
+                const std::vector<int>& operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("T", DT_FLOAT)
+                           .Attr("fused_ops", fused_ops)
+                           .Attr("operands", operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, TanhApproximationOfGelu) {
+  // x * 0.5 * (1 + tanh(x)), over more elements than a single block.
+  TF_ASSERT_OK(MakeOp(3, {"Tanh", "AddV2", "Mul", "Mul"},
+                      {0, -1, /**/ 3, 2, /**/ 0, 1, /**/ 5, 4}));
+  const int kSize = 3000;
+  std::vector<float> x(kSize);
+  for (int i = 0; i < kSize; ++i) x[i] = (i - kSize / 2) / 100.0f;
+  AddInputFromArray<float>(TensorShape({kSize}), x);
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSize}));
+  for (int i = 0; i < kSize; ++i) {
+    expected.flat<float>()(i) = x[i] * 0.5f * (1.0f + std::tanh(x[i]));
+  }
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, ReusesResults) {
+  // relu(square(x - y) * (x - y)), where x - y is used twice by one op.
+  TF_ASSERT_OK(MakeOp(2, {"Sub", "Square", "Mul", "Relu"},
+                      {0, 1, /**/ 2, -1, /**/ 3, 2, /**/ 4, -1}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 0, 1, 8});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, ScalarArguments) {
+  TF_ASSERT_OK(MakeOp(2, {"Maximum", "Sqrt"}, {0, 1, /**/ 2, -1}));
+  AddInputFromArray<float>(TensorShape({}), {16});
+  AddInputFromArray<float>(TensorShape({}), {9});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({}));
+  test::FillValues<float>(&expected, {4});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, IncompatibleShapes) {
+  TF_ASSERT_OK(MakeOp(2, {"Mul", "Exp"}, {0, 1, /**/ 2, -1}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, UnsupportedOp) {
+  Status s = MakeOp(1, {"Sin"}, {0, -1});
+  EXPECT_TRUE(absl::IsUnimplemented(s)) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, InvalidOperand) {
+  Status s = MakeOp(1, {"Exp", "Mul"}, {0, -1, /**/ 1, 2});
+  EXPECT_TRUE(absl::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
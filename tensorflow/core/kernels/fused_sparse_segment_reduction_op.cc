@@ -0,0 +1,470 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Performs the sparse segment reductions of many embedding tables, as fused by
+// the Grappler embedding lookup fusion, in a single op: the rows of each table
+// are read directly from the indices, without materializing the gathered rows,
+// and all the tables are processed by a single parallel loop on CPU or by a
+// single kernel launch on GPU.
+
+#define EIGEN_USE_THREADS
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/fused_sparse_segment_reduction_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/prefetch.h"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/kernels/gpu_device_array.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#if GOOGLE_CUDA
+#include "xla/stream_executor/cuda/cuda_activation.h"
+
+using stream_executor::cuda::ScopedActivateExecutorContext;
+#elif TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/rocm.h"
+
+using stream_executor::rocm::ScopedActivateExecutorContext;
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// The rows read this many indices ahead are prefetched, so that the random
+// accesses to large embedding tables overlap with the reduction.
+constexpr int kPrefetchDistance = 8;
+
+// Minimum number of elements reduced by a unit of work on CPU.
+constexpr int64_t kMinElementsPerShard = 16384;
+
+template <typename T>
+struct AccumulatorType {
+  typedef T type;
+};
+
+template <>
+struct AccumulatorType<Eigen::half> {
+  typedef float type;
+};
+
+template <>
+struct AccumulatorType<bfloat16> {
+  typedef float type;
+};
+
+Status ParseCombiners(const std::vector<string>& names, int num_tables,
+                      std::vector<SegmentCombiner>* combiners) {
+  if (names.size() != static_cast<size_t>(num_tables)) {
+    return errors::InvalidArgument("Expected ", num_tables,
+                                   " combiners, got ", names.size());
+  }
+  for (const string& name : names) {
+    if (name == "Sum") {
+      combiners->push_back(SegmentCombiner::kSum);
+    } else if (name == "Mean") {
+      combiners->push_back(SegmentCombiner::kMean);
+    } else if (name == "SqrtN") {
+      combiners->push_back(SegmentCombiner::kSqrtN);
+    } else {
+      return errors::InvalidArgument("Unsupported combiner: ", name);
+    }
+  }
+  return OkStatus();
+}
+
+Status ValidateTable(int i, const Tensor& data, const Tensor& indices,
+                     const Tensor& segment_ids) {
+  if (!TensorShapeUtils::IsVectorOrHigher(data.shape())) {
+    return errors::InvalidArgument("data[", i, "] must be at least rank 1");
+  }
+  if (!TensorShapeUtils::IsVector(indices.shape())) {
+    return errors::InvalidArgument("indices[", i, "] should be a vector, got ",
+                                   indices.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+    return errors::InvalidArgument("segment_ids[", i,
+                                   "] should be a vector, got ",
+                                   segment_ids.shape().DebugString());
+  }
+  if (indices.NumElements() != segment_ids.NumElements()) {
+    return errors::InvalidArgument(
+        "segment_ids[", i, "] and indices[", i,
+        "] should have same size, got ", segment_ids.NumElements(), " and ",
+        indices.NumElements());
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+template <typename Device, typename T, typename Index, typename SegmentId>
+class FusedSparseSegmentReductionOp;
+
+template <typename T, typename Index, typename SegmentId>
+class FusedSparseSegmentReductionOp<CPUDevice, T, Index, SegmentId>
+    : public OpKernel {
+ public:
+  explicit FusedSparseSegmentReductionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> combiners;
+    OP_REQUIRES_OK(context, context->GetAttr("combiners", &combiners));
+    OP_REQUIRES_OK(context, ParseCombiners(combiners, num_inputs() / 3,
+                                           &combiners_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const int num_tables = combiners_.size();
+    std::vector<Table> tables(num_tables);
+    std::vector<Shard> shards;
+    for (int i = 0; i < num_tables; ++i) {
+      const Tensor& data = context->input(i);
+      const Tensor& indices = context->input(num_tables + i);
+      const Tensor& segment_ids = context->input(2 * num_tables + i);
+      OP_REQUIRES_OK(context, ValidateTable(i, data, indices, segment_ids));
+
+      const int64_t num_indices = indices.NumElements();
+      const SegmentId* segment_ids_data = segment_ids.flat<SegmentId>().data();
+      const int64_t output_rows =
+          num_indices > 0 ? static_cast<int64_t>(internal::SubtleMustCopy(
+                                segment_ids_data[num_indices - 1])) +
+                                1
+                          : 0;
+      OP_REQUIRES(context, num_indices == 0 || output_rows > 0,
+                  errors::InvalidArgument("segment ids must be >= 0"));
+      TensorShape output_shape = data.shape();
+      OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, output_rows));
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(i, output_shape, &output));
+
+      Table& table = tables[i];
+      table.data = data.flat<T>().data();
+      table.indices = indices.flat<Index>().data();
+      table.segment_ids = segment_ids_data;
+      table.output = output->flat<T>().data();
+      table.data_rows = data.dim_size(0);
+      table.num_indices = num_indices;
+      table.num_cols = 1;
+      for (int d = 1; d < data.dims(); ++d) {
+        table.num_cols *= data.dim_size(d);
+      }
+      table.combiner = combiners_[i];
+      if (output_rows == 0 || table.num_cols == 0) continue;
+
+      // Splits the output rows of the table into shards of about
+      // kMinElementsPerShard reduced elements.
+      const int64_t num_shards = std::clamp<int64_t>(
+          num_indices * table.num_cols / kMinElementsPerShard, 1, output_rows);
+      for (int64_t s = 0; s < num_shards; ++s) {
+        shards.push_back({i, output_rows * s / num_shards,
+                          output_rows * (s + 1) / num_shards});
+      }
+    }
+    if (shards.empty()) return;
+
+    mutex mu;
+    Status status;
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; ++s) {
+        Status shard_status = ReduceShard(tables[shards[s].table], shards[s]);
+        if (!shard_status.ok()) {
+          mutex_lock l(mu);
+          status.Update(shard_status);
+        }
+      }
+    };
+    int64_t total_elements = 0;
+    for (const Table& table : tables) {
+      total_elements += table.num_indices * table.num_cols;
+    }
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        shards.size(), total_elements / shards.size(), work);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  using Table = SparseSegmentReductionTable<T, Index, SegmentId>;
+  using Acc = typename AccumulatorType<T>::type;
+
+  // A range of the output rows of a table.
+  struct Shard {
+    int table;
+    int64_t begin_row;
+    int64_t end_row;
+  };
+
+  // Returns the position of the first segment id of `table` not less than
+  // `segment`. Checking that the segment ids of each shard are increasing and
+  // within its rows checks that all the segment ids are sorted.
+  static int64_t LowerBound(const Table& table, int64_t segment) {
+    return std::lower_bound(table.segment_ids,
+                            table.segment_ids + table.num_indices, segment,
+                            [](SegmentId id, int64_t value) {
+                              return static_cast<int64_t>(id) < value;
+                            }) -
+           table.segment_ids;
+  }
+
+  Status ReduceShard(const Table& table, const Shard& shard) const {
+    const int64_t output_rows =
+        static_cast<int64_t>(table.segment_ids[table.num_indices - 1]) + 1;
+    int64_t j = shard.begin_row == 0 ? 0 : LowerBound(table, shard.begin_row);
+    const int64_t end = shard.end_row == output_rows
+                            ? table.num_indices
+                            : LowerBound(table, shard.end_row);
+    const int64_t num_cols = table.num_cols;
+    std::vector<Acc> sum(num_cols);
+    for (int64_t row = shard.begin_row; row < shard.end_row; ++row) {
+      std::fill(sum.begin(), sum.end(), Acc(0));
+      const int64_t segment_begin = j;
+      for (; j < end && table.segment_ids[j] == row; ++j) {
+        if (j + kPrefetchDistance < end) {
+          const Index next = table.indices[j + kPrefetchDistance];
+          if (FastBoundsCheck(next, table.data_rows)) {
+            absl::PrefetchToLocalCache(table.data + next * num_cols);
+          }
+        }
+        const Index index = internal::SubtleMustCopy(table.indices[j]);
+        if (!FastBoundsCheck(index, table.data_rows)) {
+          return errors::InvalidArgument("indices[", j, "] = ", index,
+                                         " is not in [0, ", table.data_rows,
+                                         ")");
+        }
+        const T* data_row = table.data + index * num_cols;
+        for (int64_t c = 0; c < num_cols; ++c) {
+          sum[c] += static_cast<Acc>(data_row[c]);
+        }
+      }
+      const int64_t count = j - segment_begin;
+      Acc scale = Acc(1);
+      if (count > 1 && table.combiner == SegmentCombiner::kMean) {
+        scale = Acc(1) / static_cast<Acc>(count);
+      } else if (count > 1 && table.combiner == SegmentCombiner::kSqrtN) {
+        scale = Acc(1) / std::sqrt(static_cast<Acc>(count));
+      }
+      T* output_row = table.output + row * num_cols;
+      for (int64_t c = 0; c < num_cols; ++c) {
+        output_row[c] = static_cast<T>(sum[c] * scale);
+      }
+    }
+    if (j != end) {
+      return errors::InvalidArgument(
+          "segment ids are not increasing: segment_ids[", j,
+          "] = ", table.segment_ids[j]);
+    }
+    return OkStatus();
+  }
+
+  std::vector<SegmentCombiner> combiners_;
+};
+
+#define REGISTER_CPU_KERNEL(T, Index, SegmentId)                      \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedSparseSegmentReduction")                            \
+          .Device(DEVICE_CPU)                                         \
+          .TypeConstraint<T>("T")                                     \
+          .TypeConstraint<Index>("Tidx")                              \
+          .TypeConstraint<SegmentId>("Tsegmentids"),                  \
+      FusedSparseSegmentReductionOp<CPUDevice, T, Index, SegmentId>);
+
+#define REGISTER_CPU_KERNELS(T)                \
+  REGISTER_CPU_KERNEL(T, int32, int32);        \
+  REGISTER_CPU_KERNEL(T, int32, int64_t);      \
+  REGISTER_CPU_KERNEL(T, int64_t, int32);      \
+  REGISTER_CPU_KERNEL(T, int64_t, int64_t);
+
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNEL
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Async because the number of output rows of each table, its last segment id
+// plus one, has to be copied from the device before allocating the outputs.
+// The segment ids of all the tables are copied at once.
+template <typename T, typename Index, typename SegmentId>
+class FusedSparseSegmentReductionOp<GPUDevice, T, Index, SegmentId>
+    : public AsyncOpKernel {
+ public:
+  explicit FusedSparseSegmentReductionOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {
+    std::vector<string> combiners;
+    OP_REQUIRES_OK(context, context->GetAttr("combiners", &combiners));
+    OP_REQUIRES_OK(context, ParseCombiners(combiners, num_inputs() / 3,
+                                           &combiners_));
+  }
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const int num_tables = combiners_.size();
+    for (int i = 0; i < num_tables; ++i) {
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          ValidateTable(i, context->input(i), context->input(num_tables + i),
+                        context->input(2 * num_tables + i)),
+          done);
+    }
+
+    AllocatorAttributes host_alloc_attrs;
+    host_alloc_attrs.set_on_host(true);
+    host_alloc_attrs.set_gpu_compatible(true);
+    Tensor last_segment_ids;
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_temp(DataTypeToEnum<SegmentId>::value,
+                               TensorShape({num_tables}), &last_segment_ids,
+                               host_alloc_attrs),
+        done);
+    SegmentId* last_segment_ids_host =
+        last_segment_ids.flat<SegmentId>().data();
+
+    auto stream = context->op_device_context()->stream();
+    bool has_indices = false;
+    for (int i = 0; i < num_tables; ++i) {
+      const Tensor& segment_ids = context->input(2 * num_tables + i);
+      const int64_t num_indices = segment_ids.NumElements();
+      if (num_indices == 0) {
+        last_segment_ids_host[i] = -1;
+        continue;
+      }
+      has_indices = true;
+      se::DeviceMemoryBase last_segment_id_device(
+          const_cast<SegmentId*>(segment_ids.flat<SegmentId>().data()) +
+          (num_indices - 1));
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          stream->Memcpy(&last_segment_ids_host[i], last_segment_id_device,
+                         sizeof(SegmentId)),
+          done);
+    }
+
+    auto compute = [this, context, last_segment_ids, done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      auto stream = context->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+      ReduceAll(context, last_segment_ids.flat<SegmentId>().data());
+      done();
+    };
+    if (!has_indices) {
+      compute();
+      return;
+    }
+    context->device()
+        ->tensorflow_accelerator_device_info()
+        ->event_mgr->ThenExecute(stream, compute);
+  }
+
+ private:
+  using Table = SparseSegmentReductionTable<T, Index, SegmentId>;
+
+  void ReduceAll(OpKernelContext* context, const SegmentId* last_segment_ids) {
+    const int num_tables = combiners_.size();
+    GpuDeviceArrayOnHost<Table> tables(context, num_tables);
+    OP_REQUIRES_OK(context, tables.Init());
+    int64_t total_output_size = 0;
+    for (int i = 0; i < num_tables; ++i) {
+      const Tensor& data = context->input(i);
+      const Tensor& indices = context->input(num_tables + i);
+      const Tensor& segment_ids = context->input(2 * num_tables + i);
+      const int64_t output_rows =
+          static_cast<int64_t>(last_segment_ids[i]) + 1;
+      OP_REQUIRES(context, indices.NumElements() == 0 || output_rows > 0,
+                  errors::InvalidArgument("segment ids must be >= 0"));
+      TensorShape output_shape = data.shape();
+      OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, output_rows));
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(i, output_shape, &output));
+
+      Table table;
+      table.data = data.flat<T>().data();
+      table.indices = indices.flat<Index>().data();
+      table.segment_ids = segment_ids.flat<SegmentId>().data();
+      table.output = output->flat<T>().data();
+      table.data_rows = data.dim_size(0);
+      table.num_indices = indices.NumElements();
+      table.num_cols = 1;
+      for (int d = 1; d < data.dims(); ++d) {
+        table.num_cols *= data.dim_size(d);
+      }
+      table.output_offset = total_output_size;
+      table.combiner = combiners_[i];
+      tables.Set(i, table);
+      total_output_size += output->NumElements();
+    }
+    if (total_output_size == 0) return;
+    OP_REQUIRES_OK(context, tables.Finalize());
+    OP_REQUIRES_OK(
+        context,
+        functor::FusedSparseSegmentReductionFunctor<GPUDevice, T, Index,
+                                                    SegmentId>()(
+            context->eigen_device<GPUDevice>(), total_output_size,
+            tables.data()));
+  }
+
+  std::vector<SegmentCombiner> combiners_;
+};
+
+#define REGISTER_GPU_KERNEL(T, Index, SegmentId)                      \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedSparseSegmentReduction")                            \
+          .Device(DEVICE_GPU)                                         \
+          .TypeConstraint<T>("T")                                     \
+          .TypeConstraint<Index>("Tidx")                              \
+          .TypeConstraint<SegmentId>("Tsegmentids"),                  \
+      FusedSparseSegmentReductionOp<GPUDevice, T, Index, SegmentId>);
+
+#define REGISTER_GPU_KERNELS(T)                \
+  REGISTER_GPU_KERNEL(T, int32, int32);        \
+  REGISTER_GPU_KERNEL(T, int32, int64_t);      \
+  REGISTER_GPU_KERNEL(T, int64_t, int32);      \
+  REGISTER_GPU_KERNEL(T, int64_t, int64_t);
+
+TF_CALL_half(REGISTER_GPU_KERNELS);
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_double(REGISTER_GPU_KERNELS);
+
+#undef REGISTER_GPU_KERNELS
+#undef REGISTER_GPU_KERNEL
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_SPARSE_SEGMENT_REDUCTION_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_SPARSE_SEGMENT_REDUCTION_OP_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/status.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/gpu_device_array_gpu.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace tensorflow {
+
+enum class SegmentCombiner : int { kSum, kMean, kSqrtN };
+
+// One of the reductions of a _FusedSparseSegmentReduction: the rows of `data`
+// selected by `indices` are combined into the rows of `output` selected by the
+// sorted `segment_ids`.
+template <typename T, typename Index, typename SegmentId>
+struct SparseSegmentReductionTable {
+  const T* data;
+  const Index* indices;
+  const SegmentId* segment_ids;
+  T* output;
+  int64_t data_rows;
+  int64_t num_indices;
+  int64_t num_cols;
+  // Offset of the output of this table in the concatenation of the outputs of
+  // all the tables.
+  int64_t output_offset;
+  SegmentCombiner combiner;
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+namespace functor {
+
+// Computes the outputs of all `tables`, of `total_output_size` elements
+// together, in a single kernel launch. Out-of-range indices are ignored.
+template <typename Device, typename T, typename Index, typename SegmentId>
+struct FusedSparseSegmentReductionFunctor {
+  using Table = SparseSegmentReductionTable<T, Index, SegmentId>;
+
+  Status operator()(const Device& d, int64_t total_output_size,
+                    const GpuDeviceArrayStruct<Table>& tables);
+};
+
+}  // namespace functor
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_SPARSE_SEGMENT_REDUCTION_OP_H_
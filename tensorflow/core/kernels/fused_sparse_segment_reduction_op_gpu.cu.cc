@@ -0,0 +1,152 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/fused_sparse_segment_reduction_op.h"
+#include "tensorflow/core/kernels/gpu_device_array_gpu.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+template <class T>
+struct AccumulatorType {
+  typedef T type;
+};
+
+template <>
+struct AccumulatorType<Eigen::half> {
+  typedef float type;
+};
+
+// Returns the position of the first of the `size` sorted `values` not less
+// than (or, if `upper`, greater than) `value`.
+template <typename SegmentId>
+__device__ int64_t SegmentBound(const SegmentId* values, int64_t size,
+                                int64_t value, bool upper) {
+  int64_t begin = 0;
+  int64_t end = size;
+  while (begin < end) {
+    const int64_t mid = begin + (end - begin) / 2;
+    const int64_t v = static_cast<int64_t>(ldg(values + mid));
+    if (v < value || (upper && v == value)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+// Each thread computes one element of the concatenation of the outputs of all
+// the tables, without atomics: it finds its table and output row, and sums the
+// rows of the segment, found by binary search in the sorted segment ids.
+template <typename T, typename Index, typename SegmentId>
+__global__ void FusedSparseSegmentReductionKernel(
+    int64_t total_output_size,
+    GpuDeviceArrayStruct<SparseSegmentReductionTable<T, Index, SegmentId>>
+        tables_array) {
+  using Acc = typename AccumulatorType<T>::type;
+  const SparseSegmentReductionTable<T, Index, SegmentId>* tables =
+      GetGpuDeviceArrayOnDevice(&tables_array);
+  const int num_tables = tables_array.size;
+  for (int64_t i : GpuGridRangeX<int64_t>(total_output_size)) {
+    // The last table whose output starts at or before element i.
+    int first = 0;
+    int last = num_tables - 1;
+    while (first < last) {
+      const int mid = (first + last + 1) / 2;
+      if (tables[mid].output_offset <= i) {
+        first = mid;
+      } else {
+        last = mid - 1;
+      }
+    }
+    const SparseSegmentReductionTable<T, Index, SegmentId>& table =
+        tables[first];
+    const int64_t element = i - table.output_offset;
+    const int64_t row = element / table.num_cols;
+    const int64_t col = element % table.num_cols;
+    const int64_t begin = SegmentBound(table.segment_ids, table.num_indices,
+                                       row, /*upper=*/false);
+    const int64_t end = SegmentBound(table.segment_ids, table.num_indices, row,
+                                     /*upper=*/true);
+    Acc sum = Acc(0);
+    for (int64_t j = begin; j < end; ++j) {
+      const Index index = ldg(table.indices + j);
+      if (index < 0 || index >= table.data_rows) continue;
+      sum += static_cast<Acc>(ldg(table.data + index * table.num_cols + col));
+    }
+    const int64_t count = end - begin;
+    if (count > 1 && table.combiner == SegmentCombiner::kMean) {
+      sum /= static_cast<Acc>(count);
+    } else if (count > 1 && table.combiner == SegmentCombiner::kSqrtN) {
+      sum /= sqrt(static_cast<Acc>(count));
+    }
+    table.output[element] = static_cast<T>(sum);
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename Index, typename SegmentId>
+struct FusedSparseSegmentReductionFunctor<GPUDevice, T, Index, SegmentId> {
+  using Table = SparseSegmentReductionTable<T, Index, SegmentId>;
+
+  Status operator()(const GPUDevice& d, int64_t total_output_size,
+                    const GpuDeviceArrayStruct<Table>& tables) {
+    // The kernel loops over the elements beyond the grid size.
+    GpuLaunchConfig config = GetGpuLaunchConfig(
+        std::min<int64_t>(total_output_size, kint32max), d);
+    return GpuLaunchKernel(
+        FusedSparseSegmentReductionKernel<T, Index, SegmentId>,
+        config.block_count, config.thread_per_block, 0, d.stream(),
+        total_output_size, tables);
+  }
+};
+
+#define DEFINE_GPU_SPECS_INDEX(T, Index)                                     \
+  template struct FusedSparseSegmentReductionFunctor<GPUDevice, T, Index,    \
+                                                     int32>;                 \
+  template struct FusedSparseSegmentReductionFunctor<GPUDevice, T, Index,    \
+                                                     int64_t>;
+
+#define DEFINE_GPU_SPECS(T)           \
+  DEFINE_GPU_SPECS_INDEX(T, int32);   \
+  DEFINE_GPU_SPECS_INDEX(T, int64_t);
+
+TF_CALL_half(DEFINE_GPU_SPECS);
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+#undef DEFINE_GPU_SPECS_INDEX
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
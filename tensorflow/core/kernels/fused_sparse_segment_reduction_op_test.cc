@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedSparseSegmentReductionOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(const std::vector<string>& combiners) {
+    const int n = combiners.size();
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("fused_sparse_segment_reduction",
+                       "_FusedSparseSegmentReduction")
+            .Input(FakeInput(n, DT_FLOAT))
+            .Input(FakeInput(n, DT_INT32))
+            .Input(FakeInput(n, DT_INT32))
+            .Attr("combiners", combiners)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedSparseSegmentReductionOpTest, MultipleTables) {
+  TF_ASSERT_OK(MakeOp({"Sum", "Mean", "SqrtN"}));
+  // Tables of 3x2, 2x1 and 4x3 elements.
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  AddInputFromArray<float>(TensorShape({4, 3}),
+                           {1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4});
+  // Indices.
+  AddInputFromArray<int32>(TensorShape({4}), {0, 2, 2, 1});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 3});
+  // Segment ids, with an empty segment in the first table.
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_sum(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected_sum, {6, 8, 0, 0, 8, 10});
+  test::ExpectClose(expected_sum, *GetOutput(0));
+  Tensor expected_mean(allocator(), DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&expected_mean, {15, 20});
+  test::ExpectClose(expected_mean, *GetOutput(1));
+  Tensor expected_sqrtn(allocator(), DT_FLOAT, TensorShape({1, 3}));
+  const float sqrtn = 6 / std::sqrt(2.0f);
+  test::FillValues<float>(&expected_sqrtn, {sqrtn, sqrtn, sqrtn});
+  test::ExpectClose(expected_sqrtn, *GetOutput(2));
+}
+
+TEST_F(FusedSparseSegmentReductionOpTest, ManySegments) {
+  // Enough segments to be split into several shards.
+  TF_ASSERT_OK(MakeOp({"Sum"}));
+  const int kRows = 8;
+  const int kCols = 64;
+  const int kSegments = 4096;
+  std::vector<float> data(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) data[i] = i / kCols;
+  std::vector<int32> indices(2 * kSegments);
+  std::vector<int32> segment_ids(2 * kSegments);
+  for (int i = 0; i < 2 * kSegments; ++i) {
+    indices[i] = i % kRows;
+    segment_ids[i] = i / 2;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), data);
+  AddInputFromArray<int32>(TensorShape({2 * kSegments}), indices);
+  AddInputFromArray<int32>(TensorShape({2 * kSegments}), segment_ids);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kSegments, kCols}));
+  for (int s = 0; s < kSegments; ++s) {
+    for (int c = 0; c < kCols; ++c) {
+      expected.matrix<float>()(s, c) = (2 * s) % kRows + (2 * s + 1) % kRows;
+    }
+  }
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedSparseSegmentReductionOpTest, IndexOutOfRange) {
+  TF_ASSERT_OK(MakeOp({"Sum"}));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedSparseSegmentReductionOpTest, UnsortedSegmentIds) {
+  TF_ASSERT_OK(MakeOp({"Sum"}));
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 0});
+  AddInputFromArray<int32>(TensorShape({3}), {1, 0, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
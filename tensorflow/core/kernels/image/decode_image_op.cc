@@ -15,11 +15,13 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -75,6 +77,33 @@ FileFormat ClassifyFileFormat(StringPiece data) {
   return kUnknownFormat;
 }
 
+// Reads the JPEG decoding attributes, other than `ratio` and `channels`, of a
+// `DecodeJpeg`-like op into `flags`.
+Status GetJpegDecodeAttrs(OpKernelConstruction* context,
+                          jpeg::UncompressFlags* flags) {
+  TF_RETURN_IF_ERROR(
+      context->GetAttr("fancy_upscaling", &flags->fancy_upscaling));
+  TF_RETURN_IF_ERROR(context->GetAttr("try_recover_truncated",
+                                      &flags->try_recover_truncated_jpeg));
+  TF_RETURN_IF_ERROR(context->GetAttr("acceptable_fraction",
+                                      &flags->min_acceptable_fraction));
+  string dct_method;
+  TF_RETURN_IF_ERROR(context->GetAttr("dct_method", &dct_method));
+  if (!(dct_method.empty() || dct_method == "INTEGER_FAST" ||
+        dct_method == "INTEGER_ACCURATE")) {
+    return errors::InvalidArgument(
+        "dct_method must be one of {'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}");
+  }
+  // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+  // image quality for speed.
+  if (dct_method.empty() || dct_method == "INTEGER_FAST") {
+    flags->dct_method = JDCT_IFAST;
+  } else if (dct_method == "INTEGER_ACCURATE") {
+    flags->dct_method = JDCT_ISLOW;
+  }
+  return absl::OkStatus();
+}
+
 // Decode an image. Supported image formats are JPEG, PNG, GIF and BMP. This is
 // a newer version of `DecodeImageOp` for enabling image data parsing to take
 // place in kernels only, reducing security vulnerabilities and redundancy.
@@ -106,29 +135,7 @@ class DecodeImageV2Op : public OpKernel {
                       flags_.ratio == 8,
                   errors::InvalidArgument("ratio must be 1, 2, 4, or 8, got ",
                                           flags_.ratio));
-      OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
-                                               &flags_.fancy_upscaling));
-      OP_REQUIRES_OK(context,
-                     context->GetAttr("try_recover_truncated",
-                                      &flags_.try_recover_truncated_jpeg));
-      OP_REQUIRES_OK(context,
-                     context->GetAttr("acceptable_fraction",
-                                      &flags_.min_acceptable_fraction));
-      string dct_method;
-      OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
-      OP_REQUIRES(
-          context,
-          (dct_method.empty() || dct_method == "INTEGER_FAST" ||
-           dct_method == "INTEGER_ACCURATE"),
-          errors::InvalidArgument("dct_method must be one of "
-                                  "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
-      // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
-      // image quality for speed.
-      if (dct_method.empty() || dct_method == "INTEGER_FAST") {
-        flags_.dct_method = JDCT_IFAST;
-      } else if (dct_method == "INTEGER_ACCURATE") {
-        flags_.dct_method = JDCT_ISLOW;
-      }
+      OP_REQUIRES_OK(context, GetJpegDecodeAttrs(context, &flags_));
     } else {
       flags_ = jpeg::UncompressFlags();
       flags_.dct_method = JDCT_IFAST;
@@ -687,6 +694,186 @@ REGISTER_KERNEL_BUILDER(Name("DecodeImage").Device(DEVICE_CPU),
                         DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodeBmp").Device(DEVICE_CPU), DecodeImageV2Op);
 
+// Decodes the crop window of a JPEG image at the largest DCT scaling ratio at
+// which the window still has at least the output size, and resizes it with
+// bilinear interpolation and half pixel centers, as ResizeBilinear does. Most
+// of the decoding work of a large image resized to a small one is thus saved,
+// and the intermediate uint8 image is never materialized as a tensor.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, GetJpegDecodeAttrs(context, &flags_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("`contents` must be scalar but got ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, ClassifyFileFormat(input) == kJpgFormat,
+                errors::InvalidArgument(
+                    "DecodeAndCropAndResizeJpeg can run on JPEG only."));
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::FailedPrecondition(
+                    "JPEG contents are too large for int: ", input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be a vector of four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be a vector of two elements, got shape ",
+                    size.shape().DebugString()));
+    const auto crop_window_vec = crop_window.vec<int32>();
+    const int crop_y = crop_window_vec(0);
+    const int crop_x = crop_window_vec(1);
+    const int crop_height = crop_window_vec(2);
+    const int crop_width = crop_window_vec(3);
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int image_width;
+    int image_height;
+    int image_channels;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                                   &image_height, &image_channels),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(context,
+                crop_height > 0 && crop_width > 0 && crop_y >= 0 &&
+                    crop_x >= 0 && crop_y <= image_height - crop_height &&
+                    crop_x <= image_width - crop_width,
+                errors::InvalidArgument(
+                    "Invalid crop window: y=", crop_y, ", x=", crop_x,
+                    ", h=", crop_height, ", w=", crop_width, " for image ",
+                    image_height, "x", image_width));
+
+    int ratio = 8;
+    while (ratio > 1 && (crop_height / ratio < out_height ||
+                         crop_width / ratio < out_width)) {
+      ratio /= 2;
+    }
+
+    // The crop window in the coordinates of the image scaled by `ratio`,
+    // whose dimensions libjpeg rounds up, extended to whole pixels.
+    const int scaled_height = (image_height + ratio - 1) / ratio;
+    const int scaled_width = (image_width + ratio - 1) / ratio;
+    const int y_begin = crop_y / ratio;
+    const int x_begin = crop_x / ratio;
+    const int y_end =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height);
+    const int x_end =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width);
+
+    jpeg::UncompressFlags flags = flags_;
+    flags.components = channels_;
+    flags.ratio = ratio;
+    flags.crop = true;
+    flags.crop_y = y_begin;
+    flags.crop_x = x_begin;
+    flags.crop_height = y_end - y_begin;
+    flags.crop_width = x_end - x_begin;
+
+    std::unique_ptr<uint8[]> buffer;
+    int height = 0;
+    int width = 0;
+    int channels = 0;
+    jpeg::Uncompress(input.data(), input.size(), flags, nullptr /* nwarn */,
+                     [&](int w, int h, int c) -> uint8* {
+                       width = w;
+                       height = h;
+                       channels = c;
+                       buffer.reset(new uint8[static_cast<int64_t>(h) * w * c]);
+                       return buffer.get();
+                     });
+    OP_REQUIRES(
+        context, buffer != nullptr && height > 0 && width > 0,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    // The source coordinates of the output pixels, with half pixel centers,
+    // relative to the decoded window.
+    const std::vector<Interpolation> ys = ComputeInterpolation(
+        out_height, static_cast<float>(crop_y) / ratio - y_begin,
+        static_cast<float>(crop_height) / ratio / out_height, height);
+    const std::vector<Interpolation> xs = ComputeInterpolation(
+        out_width, static_cast<float>(crop_x) / ratio - x_begin,
+        static_cast<float>(crop_width) / ratio / out_width, width);
+    const int64_t row_size = static_cast<int64_t>(width) * channels;
+    float* out = output->flat<float>().data();
+    for (const Interpolation& y : ys) {
+      const uint8* top = buffer.get() + y.lower * row_size;
+      const uint8* bottom = buffer.get() + y.upper * row_size;
+      for (const Interpolation& x : xs) {
+        const int64_t left = static_cast<int64_t>(x.lower) * channels;
+        const int64_t right = static_cast<int64_t>(x.upper) * channels;
+        for (int c = 0; c < channels; ++c) {
+          const float top_left = top[left + c];
+          const float bottom_left = bottom[left + c];
+          const float top_value =
+              top_left + (top[right + c] - top_left) * x.lerp;
+          const float bottom_value =
+              bottom_left + (bottom[right + c] - bottom_left) * x.lerp;
+          *out++ = top_value + (bottom_value - top_value) * y.lerp;
+        }
+      }
+    }
+  }
+
+ private:
+  struct Interpolation {
+    int lower;
+    int upper;
+    float lerp;
+  };
+
+  // Returns the source pixels and weights of each of the `out_size` output
+  // pixels, whose centers are at `offset + (i + 0.5) * scale` in a source of
+  // `in_size` pixels.
+  static std::vector<Interpolation> ComputeInterpolation(int out_size,
+                                                         float offset,
+                                                         float scale,
+                                                         int in_size) {
+    std::vector<Interpolation> interpolation(out_size);
+    for (int i = 0; i < out_size; ++i) {
+      const float in = offset + ((static_cast<float>(i) + 0.5f) * scale - 0.5f);
+      const float in_floor = std::floor(in);
+      interpolation[i].lower =
+          std::min(std::max(static_cast<int>(in_floor), 0), in_size - 1);
+      interpolation[i].upper =
+          std::min(std::max(static_cast<int>(std::ceil(in)), 0), in_size - 1);
+      interpolation[i].lerp = in - in_floor;
+    }
+    return interpolation;
+  }
+
+  int channels_ = 0;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
 void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
                                 uint8* const output, const int width,
                                 const int height, const int output_channels,
@@ -18,6 +18,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/util/shared_tensor_registry.h"
 
 namespace tensorflow {
 
@@ -96,18 +97,37 @@ ImmutableConstantOp::ImmutableConstantOp(OpKernelConstruction* context)
 }
 
 void ImmutableConstantOp::Compute(OpKernelContext* ctx) {
+  if (ShareReadOnlyTensorsEnabled()) {
+    // Keeps one view of the region, shared with the identical constants of
+    // other graphs in this process, rather than mapping it on every step.
+    mutex_lock l(mu_);
+    if (!shared_tensor_.IsInitialized()) {
+      Tensor mapped;
+      OP_REQUIRES_OK(ctx, MapRegion(ctx->env(), &mapped));
+      shared_tensor_ = SharedTensorRegistry::Global()->Intern(mapped);
+    }
+    ctx->set_output(0, shared_tensor_);
+    return;
+  }
+  Tensor mapped;
+  OP_REQUIRES_OK(ctx, MapRegion(ctx->env(), &mapped));
+  ctx->set_output(0, mapped);
+}
+
+Status ImmutableConstantOp::MapRegion(Env* env, Tensor* tensor) {
   std::unique_ptr<MemmappedTensorAllocator> allocator(
       new MemmappedTensorAllocator());
 
-  OP_REQUIRES_OK(ctx,
-                 allocator->InitializeFromRegion(region_name_, ctx->env()));
-  OP_REQUIRES(ctx, dtype_ != DT_STRING,
-              errors::Unimplemented("Sorry, DT_STRING is not currently "
-                                    "supported for ImmutableConstOp."));
-  ctx->set_output(0, Tensor(allocator.get(), dtype_, shape_));
-  OP_REQUIRES_OK(ctx, allocator->allocation_status());
+  TF_RETURN_IF_ERROR(allocator->InitializeFromRegion(region_name_, env));
+  if (dtype_ == DT_STRING) {
+    return errors::Unimplemented(
+        "Sorry, DT_STRING is not currently supported for ImmutableConstOp.");
+  }
+  *tensor = Tensor(allocator.get(), dtype_, shape_);
+  TF_RETURN_IF_ERROR(allocator->allocation_status());
   // Allocator is owned by the tensor from this point.
   allocator.release()->set_delete_on_deallocate();
+  return absl::OkStatus();
 }
 
 ImmutableConstantOp::~ImmutableConstantOp() {}
@@ -22,6 +22,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -38,9 +40,16 @@ class ImmutableConstantOp : public OpKernel {
   static constexpr char const* kMemoryRegionNameAttr = "memory_region_name";
 
  private:
+  // Sets "tensor" to a tensor viewing the memory region.
+  Status MapRegion(Env* env, Tensor* tensor);
+
   string region_name_;
   DataType dtype_;
   TensorShape shape_;
+  mutex mu_;
+  // If ShareReadOnlyTensorsEnabled(), the value interned in
+  // SharedTensorRegistry::Global() on the first Compute().
+  Tensor shared_tensor_ TF_GUARDED_BY(mu_);
   ImmutableConstantOp(const ImmutableConstantOp&) = delete;
   void operator=(const ImmutableConstantOp&) = delete;
 };
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -101,6 +102,30 @@ Status InitializableLookupTable::Initialize(
   return absl::OkStatus();
 }
 
+Status InitializableLookupTable::InitializeFromMappedTable(
+    std::unique_ptr<MappedLookupTable> mapped_table,
+    std::unique_ptr<InitializerSerializer> serializer) {
+  mutex_lock l(mu_);
+  if (is_initialized()) {
+    if (static_cast<size_t>(mapped_table->size()) != size()) {
+      return errors::FailedPrecondition(
+          "Table was already initialized with "
+          "different data.");
+    }
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(DoInitializeFromMappedTable(std::move(mapped_table)));
+  initializer_serializer_ = std::move(serializer);
+  is_initialized_.store(true, std::memory_order_release);
+  return absl::OkStatus();
+}
+
+Status InitializableLookupTable::DoInitializeFromMappedTable(
+    std::unique_ptr<MappedLookupTable> mapped_table) {
+  return errors::Unimplemented(
+      "This table can't be initialized from a mapped lookup table.");
+}
+
 Status InitializableLookupTable::AreEntriesSame(const InitTableIterator& iter,
                                                 bool* result) {
   *result = static_cast<size_t>(iter.total_size()) == size();
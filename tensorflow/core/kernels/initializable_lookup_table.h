@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_INITIALIZABLE_LOOKUP_TABLE_H_
 
 #include <atomic>
+#include <memory>
 
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/platform/macros.h"
@@ -24,6 +25,8 @@ limitations under the License.
 namespace tensorflow {
 namespace lookup {
 
+class MappedLookupTable;
+
 // Base class for lookup tables that require initialization.
 class InitializableLookupTable : public LookupInterface {
  public:
@@ -100,6 +103,13 @@ class InitializableLookupTable : public LookupInterface {
   Status Initialize(InitTableIterator& iter,
                     std::unique_ptr<InitializerSerializer> serializer);
 
+  // Initializes the table to serve the lookups of `mapped_table`, without
+  // copying its entries. Returns Unimplemented for tables which can't be
+  // backed by a mapped table.
+  Status InitializeFromMappedTable(
+      std::unique_ptr<MappedLookupTable> mapped_table,
+      std::unique_ptr<InitializerSerializer> serializer);
+
   // Basic iterator to initialize lookup tables.
   // It yields a sequence of pairs of `keys()` and `values()` Tensors, so that
   // the consumer may insert key-value pairs in batches.
@@ -199,6 +209,10 @@ class InitializableLookupTable : public LookupInterface {
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
 
+  // Makes the table serve the lookups of `mapped_table`.
+  virtual Status DoInitializeFromMappedTable(
+      std::unique_ptr<MappedLookupTable> mapped_table);
+
   virtual Status AreEntriesSame(const InitTableIterator& iter, bool* result);
 
   mutex mu_;
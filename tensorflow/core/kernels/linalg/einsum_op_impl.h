@@ -21,6 +21,9 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <memory>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_split.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -39,6 +42,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/einsum_op_util.h"
@@ -493,18 +498,14 @@ class EinsumOp : public OpKernel {
     OpInputList inputs;
     OP_REQUIRES_OK(ctx, ctx->input_list("inputs", &inputs));
 
-    OperandLabels input_labels(input_labels_);
-    Labels output_labels(output_labels_);
-    std::vector<EinsumDimensionType> label_types(label_types_);
-    OperandLabelCounts input_label_counts(input_label_counts_);
-    LabelCounts output_label_counts(output_label_counts_);
-    LabelToDimSizes label_to_dim_sizes;
-
-    OP_REQUIRES_OK(ctx, EinsumHelper::ProcessDimensions(
-                            inputs, input_has_ellipsis_, output_has_ellipsis_,
-                            &input_labels, &output_labels, &label_types,
-                            &input_label_counts, &output_label_counts,
-                            &label_to_dim_sizes));
+    std::shared_ptr<const Plan> plan;
+    OP_REQUIRES_OK(ctx, GetPlan(inputs, &plan));
+    OperandLabels input_labels(plan->input_labels);
+    const Labels& output_labels = plan->output_labels;
+    const std::vector<EinsumDimensionType>& label_types = plan->label_types;
+    const OperandLabelCounts& input_label_counts = plan->input_label_counts;
+    const LabelCounts& output_label_counts = plan->output_label_counts;
+    const LabelToDimSizes& label_to_dim_sizes = plan->label_to_dim_sizes;
 
     // The reduction phase (a) sums across reduction dimensions, (b) takes
     // generalized diagonals, and (c) reshapes it into shape
@@ -620,6 +621,54 @@ class EinsumOp : public OpKernel {
   }
 
  private:
+  // The labels of the equation with the broadcasting dimensions of the input
+  // shapes.
+  struct Plan {
+    OperandLabels input_labels;
+    Labels output_labels;
+    std::vector<EinsumDimensionType> label_types;
+    OperandLabelCounts input_label_counts;
+    LabelCounts output_label_counts;
+    LabelToDimSizes label_to_dim_sizes;
+  };
+
+  // The maximum number of input shapes whose plans are cached.
+  static constexpr int kMaxCachedPlans = 64;
+
+  // Returns the plan of the input shapes, which is built and cached the first
+  // time the kernel runs on them.
+  Status GetPlan(const OpInputList& inputs,
+                 std::shared_ptr<const Plan>* plan) {
+    std::vector<int64_t> key;
+    for (int i = 0; i < inputs.size(); ++i) {
+      key.push_back(inputs[i].dims());
+      for (int64_t dim : inputs[i].shape().dim_sizes()) key.push_back(dim);
+    }
+    {
+      tf_shared_lock l(mu_);
+      auto it = plans_.find(key);
+      if (it != plans_.end()) {
+        *plan = it->second;
+        return absl::OkStatus();
+      }
+    }
+    auto new_plan = std::make_shared<Plan>();
+    new_plan->input_labels = input_labels_;
+    new_plan->output_labels = output_labels_;
+    new_plan->label_types = label_types_;
+    new_plan->input_label_counts = input_label_counts_;
+    new_plan->output_label_counts = output_label_counts_;
+    TF_RETURN_IF_ERROR(EinsumHelper::ProcessDimensions(
+        inputs, input_has_ellipsis_, output_has_ellipsis_,
+        &new_plan->input_labels, &new_plan->output_labels,
+        &new_plan->label_types, &new_plan->input_label_counts,
+        &new_plan->output_label_counts, &new_plan->label_to_dim_sizes));
+    *plan = new_plan;
+    mutex_lock l(mu_);
+    if (plans_.size() < kMaxCachedPlans) plans_.emplace(std::move(key), *plan);
+    return absl::OkStatus();
+  }
+
   string equation_;
   OperandLabels input_labels_;
   Labels output_labels_;
@@ -628,6 +677,10 @@ class EinsumOp : public OpKernel {
   LabelCounts output_label_counts_;
   gtl::InlinedVector<bool, 2> input_has_ellipsis_;
   bool output_has_ellipsis_ = false;
+
+  mutex mu_;
+  absl::flat_hash_map<std::vector<int64_t>, std::shared_ptr<const Plan>> plans_
+      TF_GUARDED_BY(mu_);
 };
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
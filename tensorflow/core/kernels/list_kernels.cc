@@ -101,7 +101,7 @@ Status GetInputList(OpKernelContext* c, int index, const TensorList** list) {
 Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
                                    int32_t output_index,
                                    const TensorList& input_list,
-                                   TensorList** output_list) {
+                                   TensorList** output_list, size_t capacity) {
   // Attempt to forward the input tensor to the output if possible.
   std::unique_ptr<Tensor> maybe_output = c->forward_input(
       input_index, output_index, DT_VARIANT, TensorShape{},
@@ -130,7 +130,7 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
       c->allocate_output(output_index, {}, &output_tensor, attr));
-  output_tensor->scalar<Variant>()() = input_list.Copy();
+  output_tensor->scalar<Variant>()() = input_list.Copy(capacity);
 
   *output_list = output_tensor->scalar<Variant>()().get<TensorList>();
   return absl::OkStatus();
@@ -224,7 +224,8 @@ class TensorListPushBack : public OpKernel {
     }
 
     TensorList* output_list = nullptr;
-    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list,
+                                                  l->tensors().size() + 1));
     output_list->tensors().push_back(input);
   }
 
@@ -469,9 +470,12 @@ class TensorListSetItem : public OpKernel {
                     "list index. Item element shape: ",
                     value.shape().DebugString(),
                     " list shape: ", l->element_shape.DebugString()));
-    TensorList* output_list = nullptr;
-    OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
     int32_t index = c->input(1).scalar<int32>()();
+    TensorList* output_list = nullptr;
+    OP_REQUIRES_OK(
+        c, ForwardInputOrCreateNewList(
+               c, 0, 0, *l, &output_list,
+               resize_if_index_out_of_bounds_ ? std::max(0, index + 1) : 0));
     if (!resize_if_index_out_of_bounds_) {
       OP_REQUIRES(c, index < l->tensors().size(),
                   errors::InvalidArgument("Trying to modify element ", index,
@@ -602,7 +606,8 @@ class TensorListConcatLists : public OpKernel {
         std::copy(l_b->tensors().begin(), l_b->tensors().end(),
                   std::back_inserter(out->tensors()));
       } else {
-        TensorList out = l_a->Copy();
+        TensorList out =
+            l_a->Copy(l_a->tensors().size() + l_b->tensors().size());
         std::copy(l_b->tensors().begin(), l_b->tensors().end(),
                   std::back_inserter(out.tensors()));
         output_t(i) = std::move(out);
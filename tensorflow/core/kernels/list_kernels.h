@@ -64,10 +64,13 @@ Status GetElementShapeFromInput(OpKernelContext* c,
 
 Status GetInputList(OpKernelContext* c, int index, const TensorList** list);
 
+// Forwards the input list to the output if the list is uniquely owned, and
+// otherwise copies it to a new output list with room for `capacity` tensors.
 Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
                                    int32_t output_index,
                                    const TensorList& input_list,
-                                   TensorList** output_list);
+                                   TensorList** output_list,
+                                   size_t capacity = 0);
 
 // TODO(penporn): Move this to a proper place.
 inline bool IsPluggableDevice(OpKernelContext* c) {
@@ -1094,7 +1097,7 @@ class TensorListPushBackBatch : public OpKernel {
 
     for (int64_t b = 0; b < batch_size; ++b) {
       if (!ok_to_alias) {
-        result_t(b) = tl_batch[b]->Copy();
+        result_t(b) = tl_batch[b]->Copy(tl_batch[b]->tensors().size() + 1);
       }
       TensorList* output = result_t(b).get<TensorList>();
       DCHECK(output != nullptr);
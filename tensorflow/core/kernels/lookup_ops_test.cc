@@ -15,16 +15,23 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <cstdint>
+#include <random>
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +107,235 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+using ShardedMap = lookup::ShardedHashMap<int64_t, int64_t>;
+
+// Returns the keys `begin` to `end - 1`.
+Tensor KeyRange(int64_t begin, int64_t end) {
+  std::vector<int64_t> keys;
+  for (int64_t key = begin; key < end; ++key) keys.push_back(key);
+  return test::AsTensor<int64_t>(keys);
+}
+
+// Maps each of `keys` to twice its value.
+void InsertDoubled(const Tensor& keys, ShardedMap* table) {
+  auto key_values = keys.flat<int64_t>();
+  table->ForEachExclusive(key_values, [&](int64_t i, ShardedMap::Map& map) {
+    map[key_values(i)] = 2 * key_values(i);
+  });
+}
+
+void Erase(const Tensor& keys, ShardedMap* table) {
+  auto key_values = keys.flat<int64_t>();
+  table->ForEachExclusive(
+      key_values,
+      [&](int64_t i, ShardedMap::Map& map) { map.erase(key_values(i)); });
+}
+
+// Returns the value of each of `keys`, or -1 for keys not in `table`.
+std::vector<int64_t> Find(const Tensor& keys, const ShardedMap& table) {
+  auto key_values = keys.flat<int64_t>();
+  std::vector<int64_t> values(key_values.size());
+  table.ForEachShared(key_values, [&](int64_t i, const ShardedMap::Map& map) {
+    auto it = map.find(key_values(i));
+    values[i] = it == map.end() ? -1 : it->second;
+  });
+  return values;
+}
+
+// Returns the number of entries in `table` as seen through WithAllShared().
+size_t CountAllShared(const ShardedMap& table) {
+  size_t count = 0;
+  table.WithAllShared([&](absl::Span<const ShardedMap::Map* const> maps) {
+    for (const ShardedMap::Map* map : maps) count += map->size();
+  });
+  return count;
+}
+
+TEST(ShardedHashMapTest, InsertFindEraseAcrossShards) {
+  ShardedMap table;
+  InsertDoubled(KeyRange(0, 1000), &table);
+  EXPECT_EQ(table.size(), 1000);
+  EXPECT_EQ(CountAllShared(table), 1000);
+
+  // The keys are spread over more than one shard.
+  int non_empty_shards = 0;
+  table.WithAllShared([&](absl::Span<const ShardedMap::Map* const> maps) {
+    for (const ShardedMap::Map* map : maps) {
+      if (!map->empty()) ++non_empty_shards;
+    }
+  });
+  EXPECT_GT(non_empty_shards, 1);
+
+  std::vector<int64_t> values = Find(KeyRange(0, 1000), table);
+  for (int64_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(values[key], 2 * key);
+  }
+
+  Erase(KeyRange(0, 500), &table);
+  EXPECT_EQ(table.size(), 500);
+  values = Find(KeyRange(0, 1000), table);
+  for (int64_t key = 0; key < 1000; ++key) {
+    EXPECT_EQ(values[key], key < 500 ? -1 : 2 * key);
+  }
+}
+
+TEST(ShardedHashMapTest, SingleKeyOperations) {
+  ShardedMap table;
+  InsertDoubled(test::AsTensor<int64_t>({7}), &table);
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_EQ(Find(test::AsTensor<int64_t>({7}), table),
+            std::vector<int64_t>({14}));
+  EXPECT_EQ(Find(test::AsTensor<int64_t>({8}), table),
+            std::vector<int64_t>({-1}));
+  Erase(test::AsTensor<int64_t>({7}), &table);
+  EXPECT_EQ(table.size(), 0);
+}
+
+TEST(ShardedHashMapTest, DuplicateKeysInOneBatch) {
+  ShardedMap table;
+  auto keys = test::AsTensor<int64_t>({3, 5, 3, 3, 5});
+  auto key_values = keys.flat<int64_t>();
+  table.ForEachExclusive(key_values, [&](int64_t i, ShardedMap::Map& map) {
+    map[key_values(i)] = i;
+  });
+  // Keys of one shard are visited in input order, so the last write wins.
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_EQ(Find(test::AsTensor<int64_t>({3, 5}), table),
+            std::vector<int64_t>({3, 4}));
+}
+
+TEST(ShardedHashMapTest, GrowsThroughRehashes) {
+  constexpr int64_t kNumKeys = 20000;
+  ShardedMap table;
+  const int64_t initial_buckets = table.NumBucketEntries();
+  for (int64_t begin = 0; begin < kNumKeys; begin += 100) {
+    InsertDoubled(KeyRange(begin, begin + 100), &table);
+    ASSERT_EQ(table.size(), begin + 100);
+  }
+  EXPECT_GT(table.NumBucketEntries(), initial_buckets);
+  EXPECT_GE(table.NumBucketEntries(), kNumKeys);
+
+  std::vector<int64_t> values = Find(KeyRange(0, kNumKeys), table);
+  for (int64_t key = 0; key < kNumKeys; ++key) {
+    ASSERT_EQ(values[key], 2 * key);
+  }
+}
+
+TEST(ShardedHashMapTest, ClearAndRefill) {
+  ShardedMap table;
+  InsertDoubled(KeyRange(0, 1000), &table);
+  table.ClearAnd([&](absl::Span<ShardedMap::Shard> shards) {
+    for (int64_t key = 2000; key < 2100; ++key) {
+      ShardedMap::MapFor(shards, key)[key] = 2 * key;
+    }
+  });
+  EXPECT_EQ(table.size(), 100);
+  EXPECT_EQ(CountAllShared(table), 100);
+
+  // Refilled keys are found through the sharded lookup path.
+  std::vector<int64_t> values = Find(KeyRange(2000, 2100), table);
+  for (int64_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i], 2 * (2000 + i));
+  }
+  EXPECT_EQ(Find(KeyRange(0, 3), table), std::vector<int64_t>({-1, -1, -1}));
+}
+
+TEST(ShardedHashMapTest, ConcurrentInsertFindEraseOnDisjointKeys) {
+  constexpr int kNumThreads = 8;
+  constexpr int64_t kKeysPerThread = 2000;
+  ShardedMap table;
+  {
+    thread::ThreadPool pool(Env::Default(), "sharded_map", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&table, t] {
+        const int64_t begin = t * kKeysPerThread;
+        const int64_t end = begin + kKeysPerThread;
+        for (int64_t key = begin; key < end; key += 50) {
+          InsertDoubled(KeyRange(key, key + 50), &table);
+        }
+        std::vector<int64_t> values = Find(KeyRange(begin, end), table);
+        for (int64_t i = 0; i < kKeysPerThread; ++i) {
+          EXPECT_EQ(values[i], 2 * (begin + i));
+        }
+        // Erase the first half of this thread's keys.
+        Erase(KeyRange(begin, begin + kKeysPerThread / 2), &table);
+      });
+    }
+  }
+  EXPECT_EQ(table.size(), kNumThreads * kKeysPerThread / 2);
+  std::vector<int64_t> values =
+      Find(KeyRange(0, kNumThreads * kKeysPerThread), table);
+  for (int64_t key = 0; key < kNumThreads * kKeysPerThread; ++key) {
+    const bool erased = key % kKeysPerThread < kKeysPerThread / 2;
+    ASSERT_EQ(values[key], erased ? -1 : 2 * key);
+  }
+}
+
+TEST(ShardedHashMapTest, StressMixedOperationsOnSharedKeys) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIterations = 2000;
+  constexpr int64_t kNumKeys = 256;
+  ShardedMap table;
+  {
+    thread::ThreadPool pool(Env::Default(), "sharded_map", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&table, t] {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<int64_t> key_dist(0, kNumKeys - 1);
+        for (int iter = 0; iter < kNumIterations; ++iter) {
+          std::vector<int64_t> batch(1 + iter % 17);
+          for (int64_t& key : batch) key = key_dist(rng);
+          const Tensor keys = test::AsTensor<int64_t>(batch);
+          switch (rng() % 8) {
+            case 0:
+            case 1:
+            case 2:
+              InsertDoubled(keys, &table);
+              break;
+            case 3:
+            case 4:
+              Erase(keys, &table);
+              break;
+            case 5: {
+              // Every entry visible under all shard locks is consistent.
+              table.WithAllShared(
+                  [&](absl::Span<const ShardedMap::Map* const> maps) {
+                    for (const ShardedMap::Map* map : maps) {
+                      for (const auto& entry : *map) {
+                        EXPECT_EQ(entry.second, 2 * entry.first);
+                      }
+                    }
+                  });
+              break;
+            }
+            case 6:
+              if (iter % 100 == 0) {
+                table.ClearAnd([&](absl::Span<ShardedMap::Shard> shards) {
+                  for (int64_t key : batch) {
+                    ShardedMap::MapFor(shards, key)[key] = 2 * key;
+                  }
+                });
+              }
+              break;
+            default: {
+              std::vector<int64_t> values = Find(keys, table);
+              for (size_t i = 0; i < batch.size(); ++i) {
+                EXPECT_TRUE(values[i] == -1 || values[i] == 2 * batch[i]);
+              }
+              break;
+            }
+          }
+        }
+      });
+    }
+  }
+  EXPECT_LE(table.size(), kNumKeys);
+  EXPECT_EQ(CountAllShared(table), table.size());
+  std::vector<int64_t> values = Find(KeyRange(0, kNumKeys), table);
+  for (int64_t key = 0; key < kNumKeys; ++key) {
+    EXPECT_TRUE(values[key] == -1 || values[key] == 2 * key);
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
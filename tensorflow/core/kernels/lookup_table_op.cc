@@ -16,10 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -41,6 +45,8 @@ std::string UniqueNodeName(const std::string& base) {
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The map is sharded so that concurrent Find and Insert calls on different
+// keys rarely contend on the same lock.
 //
 // Sample use case:
 //
@@ -55,10 +61,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +73,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.ForEachShared(key_values, [&](int64_t i, const Map& map) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +81,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
+          map, SubtleMustCopyIfIntegral(key_values(i)),
           is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    });
 
     return absl::OkStatus();
   }
@@ -90,14 +92,20 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
+      table_.ClearAnd([&](absl::Span<typename Table::Shard> shards) {
+        for (int64_t i = 0; i < key_values.size(); ++i) {
+          const K key = SubtleMustCopyIfIntegral(key_values(i));
+          gtl::InsertOrUpdate(&Table::MapFor(shards, key), key,
+                              SubtleMustCopyIfIntegral(value_values(i)));
+        }
+      });
+      return absl::OkStatus();
     }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    table_.ForEachExclusive(key_values, [&](int64_t i, Map& map) {
+      gtl::InsertOrUpdate(&map, SubtleMustCopyIfIntegral(key_values(i)),
                           SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    });
     return absl::OkStatus();
   }
 
@@ -109,10 +117,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachExclusive(key_values, [&](int64_t i, Map& map) {
+      map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return absl::OkStatus();
   }
 
@@ -122,17 +129,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    Status s;
+    table_.WithAllShared([&](absl::Span<const Map* const> maps) {
+      int64_t size = TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      s = ctx->allocate_output("keys", TensorShape({size}), &keys);
+      if (!s.ok()) return;
+      s = ctx->allocate_output("values", TensorShape({size}), &values);
+      if (!s.ok()) return;
+      ExportKeysAndValues(maps, keys, values);
+    });
+    return s;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +153,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.NumBucketEntries();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShared([&](absl::Span<const Map* const> maps) {
+      int64_t size = TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,21 +197,31 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef ShardedHashMap<K, V> Table;
+  typedef typename Table::Map Map;
+
+  static int64_t TotalSize(absl::Span<const Map* const> maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
+  // Writes all keys and values in `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `TotalSize(maps)`.
+  static void ExportKeysAndValues(absl::Span<const Map* const> maps,
+                                  Tensor* keys, Tensor* values) {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -226,10 +238,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,10 +251,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.ForEachShared(key_values, [&](int64_t i, const Map& map) {
+      const ValueArray* value_vec =
+          gtl::FindOrNull(map, SubtleMustCopyIfIntegral(key_values(i)));
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,7 +270,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return absl::OkStatus();
   }
@@ -272,19 +280,27 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    auto value_vec = [&](int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      return value_vec;
+    };
+    if (clear) {
+      table_.ClearAnd([&](absl::Span<typename Table::Shard> shards) {
+        for (int64_t i = 0; i < key_values.size(); ++i) {
+          const K key = SubtleMustCopyIfIntegral(key_values(i));
+          gtl::InsertOrUpdate(&Table::MapFor(shards, key), key, value_vec(i));
+        }
+      });
+      return absl::OkStatus();
     }
+    table_.ForEachExclusive(key_values, [&](int64_t i, Map& map) {
+      gtl::InsertOrUpdate(&map, SubtleMustCopyIfIntegral(key_values(i)),
+                          value_vec(i));
+    });
     return absl::OkStatus();
   }
 
@@ -296,10 +312,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachExclusive(key_values, [&](int64_t i, Map& map) {
+      map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    });
     return absl::OkStatus();
   }
 
@@ -309,18 +324,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
     int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    Status s;
+    table_.WithAllShared([&](absl::Span<const Map* const> maps) {
+      int64_t size = TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      s = ctx->allocate_output("keys", TensorShape({size}), &keys);
+      if (!s.ok()) return;
+      s = ctx->allocate_output("values", TensorShape({size, value_dim}),
+                               &values);
+      if (!s.ok()) return;
+      ExportKeysAndValues(maps, keys, values);
+    });
+    return s;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +350,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.NumBucketEntries();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShared([&](absl::Span<const Map* const> maps) {
+      int64_t size = TotalSize(maps);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(maps, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +396,38 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  typedef ShardedHashMap<K, ValueArray> Table;
+  typedef typename Table::Map Map;
+
+  static int64_t TotalSize(absl::Span<const Map* const> maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
+  // Writes all keys and values in `maps` into `keys` and `values`. `keys` and
+  // `values` must point to tensors of size `TotalSize(maps)`.
+  void ExportKeysAndValues(absl::Span<const Map* const> maps, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
@@ -16,7 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,11 +32,14 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -202,6 +212,169 @@ inline const ResourceHandle& SubtleMustCopyIfIntegral(
 // Returns a unique node name starting with "base".
 std::string UniqueNodeName(const std::string& base);
 
+// An unordered_map split into independently locked shards.
+//
+// Keys are assigned to shards by hash, so concurrent lookups and inserts only
+// contend when they touch the same shard. Batched operations group their keys
+// by shard and take each shard's lock once.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = std::unordered_map<K, V>;
+
+  struct Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(i, map)` for each index `i` of the flat tensor `keys`, where
+  // `map` is the shard that holds `keys(i)`, with a shared lock on that shard
+  // held.
+  template <typename Keys, typename Fn>
+  void ForEachShared(const Keys& keys, const Fn& fn) const {
+    if (keys.size() == 1) {
+      const Shard& shard = shards_[ShardOf(SubtleMustCopyIfIntegral(keys(0)))];
+      tf_shared_lock l(shard.mu);
+      fn(0, shard.map);
+      return;
+    }
+    ShardedIndices indices;
+    GroupByShard(keys, &indices);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (indices.offsets[s] == indices.offsets[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64_t j = indices.offsets[s]; j < indices.offsets[s + 1]; ++j) {
+        fn(indices.order[j], shard.map);
+      }
+    }
+  }
+
+  // Like `ForEachShared()`, but with an exclusive lock on each shard held.
+  template <typename Keys, typename Fn>
+  void ForEachExclusive(const Keys& keys, const Fn& fn) {
+    if (keys.size() == 1) {
+      Shard& shard = shards_[ShardOf(SubtleMustCopyIfIntegral(keys(0)))];
+      mutex_lock l(shard.mu);
+      fn(0, shard.map);
+      return;
+    }
+    ShardedIndices indices;
+    GroupByShard(keys, &indices);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (indices.offsets[s] == indices.offsets[s + 1]) continue;
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      for (int64_t j = indices.offsets[s]; j < indices.offsets[s + 1]; ++j) {
+        fn(indices.order[j], shard.map);
+      }
+    }
+  }
+
+  // Calls `fn(maps)` with a shared lock on every shard held, for operations
+  // that need a consistent view of the whole table.
+  template <typename Fn>
+  void WithAllShared(const Fn& fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::array<const Map*, kNumShards> maps;
+    for (int s = 0; s < kNumShards; ++s) {
+      shards_[s].mu.lock_shared();
+      maps[s] = &shards_[s].map;
+    }
+    fn(absl::MakeConstSpan(maps));
+    for (int s = kNumShards - 1; s >= 0; --s) {
+      shards_[s].mu.unlock_shared();
+    }
+  }
+
+  // Clears the table and calls `fn()` with every shard exclusively locked, so
+  // that no reader observes a partially cleared table.
+  template <typename Fn>
+  void ClearAnd(const Fn& fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) {
+      shard.mu.lock();
+      shard.map.clear();
+    }
+    fn(absl::MakeSpan(shards_));
+    for (int s = kNumShards - 1; s >= 0; --s) {
+      shards_[s].mu.unlock();
+    }
+  }
+
+  // Returns the number of buckets used by the table, counting empty buckets
+  // as one entry.
+  int64_t NumBucketEntries() const {
+    int64_t ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (unsigned i = 0; i < shard.map.bucket_count(); ++i) {
+        size_t bucket_size = shard.map.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
+      }
+    }
+    return ret;
+  }
+
+  // Returns the map of the shard that holds `key`. REQUIRES: the shard is
+  // exclusively locked, e.g. from within `ClearAnd()`.
+  static Map& MapFor(absl::Span<Shard> shards,
+                     const K& key) TF_NO_THREAD_SAFETY_ANALYSIS {
+    return shards[ShardOf(key)].map;
+  }
+
+ private:
+  static constexpr int kShardBits = 4;
+  static constexpr int kNumShards = 1 << kShardBits;
+
+  struct ShardedIndices {
+    // Key indices, ordered by shard. The indices of shard `s` are
+    // `order[offsets[s]]` to `order[offsets[s + 1] - 1]`.
+    gtl::InlinedVector<int64_t, 32> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+  };
+
+  static int ShardOf(const K& key) {
+    // std::hash is the identity for integers on common platforms, so mix the
+    // bits before taking the top ones.
+    const uint64 hash = static_cast<uint64>(std::hash<K>()(key));
+    return (hash * 0x9E3779B97F4A7C15ull) >> (64 - kShardBits);
+  }
+
+  template <typename Keys>
+  static void GroupByShard(const Keys& keys, ShardedIndices* indices) {
+    const int64_t n = keys.size();
+    gtl::InlinedVector<uint8, 32> shard_of(n);
+    indices->offsets.fill(0);
+    for (int64_t i = 0; i < n; ++i) {
+      shard_of[i] = ShardOf(SubtleMustCopyIfIntegral(keys(i)));
+      ++indices->offsets[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      indices->offsets[s + 1] += indices->offsets[s];
+    }
+    std::array<int64_t, kNumShards> next;
+    std::copy_n(indices->offsets.begin(), kNumShards, next.begin());
+    indices->order.resize(n);
+    for (int64_t i = 0; i < n; ++i) {
+      indices->order[next[shard_of[i]]++] = i;
+    }
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 // Lookup table that wraps an flat_hash_map, where the key and value data type
 // is specified.
 //
@@ -234,7 +407,7 @@ class HashTable : public InitializableLookupTable {
                            .WithAttr("key_dtype", key_dtype())
                            .WithAttr("value_dtype", value_dtype())
                            .WithAttr("use_node_name_sharing", true));
-    if (table_.empty()) {
+    if (table_.empty() && mapped_table_ == nullptr) {
       *out = hash_table_node;
       return absl::OkStatus();
     }
@@ -257,6 +430,8 @@ class HashTable : public InitializableLookupTable {
   size_t size() const override {
     if (!is_initialized())
       return 0;
+    else if (mapped_table_ != nullptr)
+      return mapped_table_->size();
     else
       return table_.size();
   }
@@ -266,7 +441,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64_t size = table_.size();
+    const int64_t size = this->size();
 
     Tensor* keys;
     Tensor* values;
@@ -277,6 +452,12 @@ class HashTable : public InitializableLookupTable {
 
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
+    if (mapped_table_ != nullptr) {
+      for (int64_t i = 0; i < size; ++i) {
+        mapped_table_->GetEntry(i, &keys_data(i), &values_data(i));
+      }
+      return absl::OkStatus();
+    }
     int64_t i = 0;
     for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
       keys_data(i) = it->first;
@@ -326,6 +507,15 @@ class HashTable : public InitializableLookupTable {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
+    if (mapped_table_ != nullptr) {
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        if (!mapped_table_->Find(SubtleMustCopyIfIntegral(key_values(i)),
+                                 &value_values(i))) {
+          value_values(i) = default_val;
+        }
+      }
+      return absl::OkStatus();
+    }
     for (int64_t i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
           table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
@@ -333,16 +523,35 @@ class HashTable : public InitializableLookupTable {
     return absl::OkStatus();
   }
 
+  Status DoInitializeFromMappedTable(
+      std::unique_ptr<MappedLookupTable> mapped_table) override {
+    if (mapped_table->key_dtype() != key_dtype() ||
+        mapped_table->value_dtype() != value_dtype()) {
+      return errors::InvalidArgument(
+          "Mapped lookup table of ", DataTypeString(mapped_table->key_dtype()),
+          "->", DataTypeString(mapped_table->value_dtype()),
+          " doesn't match the table of ", DataTypeString(key_dtype()), "->",
+          DataTypeString(value_dtype()));
+    }
+    mapped_table_ = std::move(mapped_table);
+    return absl::OkStatus();
+  }
+
   int64_t MemoryUsed() const override {
     if (!is_initialized()) {
       return 0;
     }
+    // The entries of a mapped table are in the page cache, shared with the
+    // other processes mapping the file.
+    if (mapped_table_ != nullptr) return 0;
     const int64_t num_elements = table_.size();
     return num_elements * (sizeof(K) + sizeof(V));
   }
 
  private:
   absl::flat_hash_map<K, V> table_;
+  // If set, serves the lookups instead of `table_`.
+  std::unique_ptr<MappedLookupTable> mapped_table_;
 };
 
 }  // namespace lookup
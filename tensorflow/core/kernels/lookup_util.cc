@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
@@ -22,9 +26,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -266,6 +272,67 @@ class TextFileLineIterator
   void operator=(const TextFileLineIterator&) = delete;
 };
 
+// Collects the unique entries of `iter` and writes them as a mapped lookup
+// table to `filename`.
+template <typename K, typename V>
+Status WriteMappedTable(InitializableLookupTable::InitTableIterator& iter,
+                        const MappedLookupTable::TextFileOptions& options,
+                        Env* env, const string& filename) {
+  absl::flat_hash_map<K, V> table;
+  std::vector<K> keys;
+  std::vector<V> values;
+  while (iter.Valid()) {
+    const auto key_values = iter.keys().flat<K>();
+    const auto value_values = iter.values().flat<V>();
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      auto result = table.try_emplace(key_values(i), value_values(i));
+      if (!result.second) {
+        if (result.first->second != value_values(i)) {
+          return errors::FailedPrecondition(
+              "HashTable has different value for same key. Key ",
+              key_values(i), " has ", result.first->second,
+              " and trying to add value ", value_values(i));
+        }
+        continue;
+      }
+      keys.push_back(key_values(i));
+      values.push_back(value_values(i));
+    }
+    iter.Next();
+  }
+  if (!errors::IsOutOfRange(iter.status())) {
+    return iter.status();
+  }
+  return MappedLookupTable::Write(env, keys, values, options, filename);
+}
+
+// Initializes `table` from the mapped lookup table `filename`, which must have
+// been built from a text file with the same `options`.
+Status InitializeTableFromMappedFile(
+    const string& filename, const MappedLookupTable::TextFileOptions& options,
+    Env* env, std::unique_ptr<InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<MappedLookupTable> mapped_table,
+                      MappedLookupTable::Open(env, filename));
+  const MappedLookupTable::TextFileOptions& mapped_options =
+      mapped_table->text_file_options();
+  if (mapped_options.vocab_size != options.vocab_size ||
+      mapped_options.delimiter != options.delimiter ||
+      mapped_options.key_index != options.key_index ||
+      mapped_options.value_index != options.value_index ||
+      mapped_options.offset != options.offset) {
+    return errors::InvalidArgument(
+        "Mapped lookup table ", filename,
+        " was built with other text file options than its initializer: "
+        "vocab_size ",
+        mapped_options.vocab_size, ", key_index ", mapped_options.key_index,
+        ", value_index ", mapped_options.value_index, ", offset ",
+        mapped_options.offset);
+  }
+  return table->InitializeFromMappedTable(std::move(mapped_table),
+                                          std::move(serializer));
+}
+
 Status GetTableHandle(StringPiece input_name, OpKernelContext* ctx,
                       string* container, string* table_handle) {
   {
@@ -401,15 +468,22 @@ Status InitializeTableFromTextFile(
         DataTypeString(table->value_dtype()));
   }
 
-  TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, offset,
-                               env));
+  Status s;
+  if (MappedLookupTable::IsMappedTableFile(env, filename)) {
+    s = InitializeTableFromMappedFile(
+        filename, {vocab_size, delimiter, key_index, value_index, offset}, env,
+        std::move(serializer), table);
+  } else {
+    TextFileLineIterator iter;
+    TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                                 key_index, value_dtype, value_index, offset,
+                                 env));
+    s = table->Initialize(iter, std::move(serializer));
+  }
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
   // time.
-  Status s = table->Initialize(iter, std::move(serializer));
   if (absl::IsFailedPrecondition(s) && table->is_initialized()) {
     LOG(INFO) << "Table trying to initialize from file " << filename
               << " is already initialized.";
@@ -418,5 +492,38 @@ Status InitializeTableFromTextFile(
   return s;
 }
 
+Status WriteMappedTableFromTextFile(const string& filename,
+                                    int64_t vocab_size, char delimiter,
+                                    int32_t key_index, int32_t value_index,
+                                    int64_t offset, DataType key_dtype,
+                                    DataType value_dtype, Env* env,
+                                    const string& output_filename) {
+  if ((key_dtype != DT_INT64 && key_dtype != DT_STRING) ||
+      (value_dtype != DT_INT64 && value_dtype != DT_STRING)) {
+    return errors::InvalidArgument(
+        "Mapped lookup tables only support int64 and string keys and values, "
+        "got ",
+        DataTypeString(key_dtype), "->", DataTypeString(value_dtype));
+  }
+  TextFileLineIterator iter;
+  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
+                               key_index, value_dtype, value_index, offset,
+                               env));
+  const MappedLookupTable::TextFileOptions options = {
+      vocab_size, delimiter, key_index, value_index, offset};
+  if (key_dtype == DT_INT64 && value_dtype == DT_INT64) {
+    return WriteMappedTable<int64_t, int64_t>(iter, options, env,
+                                              output_filename);
+  } else if (key_dtype == DT_INT64) {
+    return WriteMappedTable<int64_t, tstring>(iter, options, env,
+                                              output_filename);
+  } else if (value_dtype == DT_INT64) {
+    return WriteMappedTable<tstring, int64_t>(iter, options, env,
+                                              output_filename);
+  }
+  return WriteMappedTable<tstring, tstring>(iter, options, env,
+                                            output_filename);
+}
+
 }  // namespace lookup
 }  // namespace tensorflow
@@ -65,6 +65,19 @@ Status InitializeTableFromTextFile(
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table);
 
+// Writes to `output_filename` the mapped lookup table of the entries that
+// InitializeTableFromTextFile() would initialize a table with from `filename`
+// with the same arguments. Initializing a table from `output_filename` with
+// these arguments then maps it instead of parsing a text file, which loads
+// large vocabularies almost instantly. Keys and values must be int64 or
+// string.
+Status WriteMappedTableFromTextFile(const string& filename,
+                                    int64_t vocab_size, char delimiter,
+                                    int32_t key_index, int32_t value_index,
+                                    int64_t offset, DataType key_dtype,
+                                    DataType value_dtype, Env* env,
+                                    const string& output_filename);
+
 }  // namespace lookup
 }  // namespace tensorflow
 
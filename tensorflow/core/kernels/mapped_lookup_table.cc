@@ -0,0 +1,205 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'L', 'U', 'M', 'A', 'P', '1'};
+
+struct Header {
+  char magic[8];
+  uint32_t key_dtype;
+  uint32_t value_dtype;
+  uint64_t num_entries;
+  uint64_t num_buckets;
+  uint64_t strings_size;
+  int64_t vocab_size;
+  int64_t offset;
+  int32_t key_index;
+  int32_t value_index;
+  uint32_t delimiter;
+  uint32_t padding;
+};
+static_assert(sizeof(Header) == 72, "Header must have no implicit padding");
+
+bool IsSupportedDtype(uint32_t dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+// Returns the key or value `data` as stored in an entry, appending strings to
+// `strings`.
+uint64_t Put(int64_t data, std::string* strings) {
+  return static_cast<uint64_t>(data);
+}
+
+uint64_t Put(const tstring& data, std::string* strings) {
+  const uint64_t offset = strings->size();
+  const uint32_t size = data.size();
+  strings->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  strings->append(data.data(), data.size());
+  return offset;
+}
+
+}  // namespace
+
+bool MappedLookupTable::IsMappedTableFile(Env* env,
+                                          const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  if (!env->NewRandomAccessFile(filename, &file).ok()) return false;
+  char magic[sizeof(kMagic)];
+  StringPiece result;
+  return file->Read(0, sizeof(magic), &result, magic).ok() &&
+         result == StringPiece(kMagic, sizeof(kMagic));
+}
+
+absl::StatusOr<std::unique_ptr<MappedLookupTable>> MappedLookupTable::Open(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<MappedLookupTable> table(new MappedLookupTable);
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &table->region_));
+  TF_RETURN_IF_ERROR(table->Init(filename));
+  return table;
+}
+
+Status MappedLookupTable::Init(const std::string& filename) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Mapped lookup tables are only supported on little endian hosts.");
+  }
+  const char* data = static_cast<const char*>(region_->data());
+  const uint64_t length = region_->length();
+  Header header;
+  if (length < sizeof(header)) {
+    return errors::DataLoss("Truncated mapped lookup table ", filename);
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      !IsSupportedDtype(header.key_dtype) ||
+      !IsSupportedDtype(header.value_dtype) || header.num_buckets == 0 ||
+      (header.num_buckets & (header.num_buckets - 1)) != 0 ||
+      header.num_entries >= header.num_buckets) {
+    return errors::DataLoss("Corrupted mapped lookup table ", filename);
+  }
+  // The sizes are bounded by the length of the file, so that the expected
+  // length doesn't overflow.
+  const uint64_t max_elements = length / sizeof(uint64_t);
+  if (header.num_buckets > max_elements || header.num_entries > max_elements ||
+      header.strings_size > length ||
+      sizeof(header) + header.num_buckets * sizeof(uint64_t) +
+              header.num_entries * sizeof(Entry) + header.strings_size !=
+          length) {
+    return errors::DataLoss("Corrupted mapped lookup table ", filename,
+                            " of ", length, " bytes");
+  }
+  key_dtype_ = static_cast<DataType>(header.key_dtype);
+  value_dtype_ = static_cast<DataType>(header.value_dtype);
+  options_.vocab_size = header.vocab_size;
+  options_.delimiter = static_cast<char>(header.delimiter);
+  options_.key_index = header.key_index;
+  options_.value_index = header.value_index;
+  options_.offset = header.offset;
+  num_entries_ = header.num_entries;
+  num_buckets_ = header.num_buckets;
+  buckets_ = reinterpret_cast<const uint64_t*>(data + sizeof(header));
+  entries_ = reinterpret_cast<const Entry*>(buckets_ + num_buckets_);
+  strings_ = reinterpret_cast<const char*>(entries_ + num_entries_);
+  strings_size_ = header.strings_size;
+  for (uint64_t i = 0; i < num_buckets_; i += 4096 / sizeof(uint64_t)) {
+    // Checks a sample of the buckets rather than all of them, which would
+    // read the whole file.
+    if (buckets_[i] > num_entries_) {
+      return errors::DataLoss("Corrupted mapped lookup table ", filename);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename K, typename V>
+Status MappedLookupTable::Write(Env* env, const std::vector<K>& keys,
+                                const std::vector<V>& values,
+                                const TextFileOptions& options,
+                                const std::string& filename) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Mapped lookup tables are only supported on little endian hosts.");
+  }
+  if (keys.size() != values.size()) {
+    return errors::InvalidArgument("Got ", keys.size(), " keys but ",
+                                   values.size(), " values");
+  }
+  // Keeps the buckets at most half full, so that probes are short.
+  uint64_t num_buckets = 2;
+  while (num_buckets < 2 * keys.size()) num_buckets *= 2;
+  std::vector<uint64_t> buckets(num_buckets, 0);
+  std::vector<Entry> entries(keys.size());
+  std::string strings;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    entries[i] = {Put(keys[i], &strings), Put(values[i], &strings)};
+    uint64_t bucket = Hash(keys[i]) & (num_buckets - 1);
+    while (buckets[bucket] != 0) bucket = (bucket + 1) & (num_buckets - 1);
+    buckets[bucket] = i + 1;
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.key_dtype = DataTypeToEnum<K>::v();
+  header.value_dtype = DataTypeToEnum<V>::v();
+  header.num_entries = entries.size();
+  header.num_buckets = num_buckets;
+  header.strings_size = strings.size();
+  header.vocab_size = options.vocab_size;
+  header.offset = options.offset;
+  header.key_index = options.key_index;
+  header.value_index = options.value_index;
+  header.delimiter = static_cast<unsigned char>(options.delimiter);
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(
+      file->Append(StringPiece(reinterpret_cast<const char*>(&header),
+                               sizeof(header))));
+  TF_RETURN_IF_ERROR(file->Append(
+      StringPiece(reinterpret_cast<const char*>(buckets.data()),
+                  buckets.size() * sizeof(uint64_t))));
+  TF_RETURN_IF_ERROR(file->Append(
+      StringPiece(reinterpret_cast<const char*>(entries.data()),
+                  entries.size() * sizeof(Entry))));
+  TF_RETURN_IF_ERROR(file->Append(strings));
+  return file->Close();
+}
+
+#define REGISTER_WRITE(K, V)                                              \
+  template Status MappedLookupTable::Write<K, V>(                         \
+      Env * env, const std::vector<K>& keys, const std::vector<V>& values, \
+      const TextFileOptions& options, const std::string& filename)
+
+REGISTER_WRITE(int64_t, int64_t);
+REGISTER_WRITE(int64_t, tstring);
+REGISTER_WRITE(tstring, int64_t);
+REGISTER_WRITE(tstring, tstring);
+
+#undef REGISTER_WRITE
+
+}  // namespace lookup
+}  // namespace tensorflow
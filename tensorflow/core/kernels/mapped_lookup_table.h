@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
+#define TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A read-only hash table stored in a file, which is mapped into memory to
+// serve lookups without parsing the file. The pages of the file are shared by
+// all the processes mapping it.
+//
+// The file is built from the entries a table would be initialized with from a
+// text file (see WriteMappedTableFromTextFile() in lookup_util.h), and records
+// the arguments of that initialization, so that it can be checked against the
+// initializer of the table it is mapped into.
+//
+// Keys and values are either int64 or string. The file is little endian: the
+// buckets of its open addressing hash table, then the key-value entries, then
+// the strings of the entries as 32-bit lengths followed by their bytes.
+//
+// This class is thread-safe.
+class MappedLookupTable {
+ public:
+  // The arguments of the initialization from a text file the table was built
+  // from.
+  struct TextFileOptions {
+    int64_t vocab_size = -1;
+    char delimiter = '\t';
+    int32_t key_index = 0;
+    int32_t value_index = 0;
+    int64_t offset = 0;
+  };
+
+  // A key or value of an entry: the integer itself, or the offset of the
+  // string in the strings of the file.
+  struct Entry {
+    uint64_t key;
+    uint64_t value;
+  };
+
+  // Returns whether `filename` is a mapped table file. Text files are not.
+  static bool IsMappedTableFile(Env* env, const std::string& filename);
+
+  // Maps the table file `filename`.
+  static absl::StatusOr<std::unique_ptr<MappedLookupTable>> Open(
+      Env* env, const std::string& filename);
+
+  // Writes the table of `keys` and `values` to `filename`. `keys` must be
+  // unique. K and V are int64_t or tstring.
+  template <typename K, typename V>
+  static Status Write(Env* env, const std::vector<K>& keys,
+                      const std::vector<V>& values,
+                      const TextFileOptions& options,
+                      const std::string& filename);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  int64_t size() const { return num_entries_; }
+  const TextFileOptions& text_file_options() const { return options_; }
+
+  // Sets `*value` to the value of `key` and returns true, or returns false if
+  // `key` is not in the table. K and V must match the key and value dtypes.
+  template <typename K, typename V>
+  bool Find(const K& key, V* value) const {
+    uint64_t bucket = Hash(key) & (num_buckets_ - 1);
+    while (true) {
+      const uint64_t entry = buckets_[bucket];
+      if (entry == 0) return false;
+      if (Get<K>(entries_[entry - 1].key) == key) {
+        *value = Get<V>(entries_[entry - 1].value);
+        return true;
+      }
+      bucket = (bucket + 1) & (num_buckets_ - 1);
+    }
+  }
+
+  // Returns the key and value of the `i`-th entry, in [0, size()).
+  template <typename K, typename V>
+  void GetEntry(int64_t i, K* key, V* value) const {
+    *key = Get<K>(entries_[i].key);
+    *value = Get<V>(entries_[i].value);
+  }
+
+ private:
+  MappedLookupTable() = default;
+
+  // Initializes the table from the mapped file, checking its structure.
+  Status Init(const std::string& filename);
+
+  template <typename T>
+  static uint64_t Hash(const T& key) {
+    if constexpr (std::is_same_v<T, tstring>) {
+      return Hash64(key.data(), key.size());
+    } else {
+      return Hash64(reinterpret_cast<const char*>(&key), sizeof(key));
+    }
+  }
+
+  // Returns the key or value `data` of an entry as a T, or a default T for
+  // types the table can't hold.
+  template <typename T>
+  T Get(uint64_t data) const {
+    if constexpr (std::is_same_v<T, tstring>) {
+      const StringPiece s = GetString(data);
+      return tstring(s.data(), s.size());
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      return static_cast<int64_t>(data);
+    } else {
+      return T();
+    }
+  }
+
+  // Returns the string at `offset`, or an empty string if it is out of the
+  // bounds of the file.
+  StringPiece GetString(uint64_t offset) const {
+    uint32_t size;
+    if (strings_size_ < sizeof(size) || offset > strings_size_ - sizeof(size)) {
+      return StringPiece();
+    }
+    std::memcpy(&size, strings_ + offset, sizeof(size));
+    if (size > strings_size_ - offset - sizeof(size)) return StringPiece();
+    return StringPiece(strings_ + offset + sizeof(size), size);
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  TextFileOptions options_;
+  uint64_t num_entries_ = 0;
+  uint64_t num_buckets_ = 0;
+  // Index + 1 of the entry in each bucket, or 0 for empty buckets.
+  const uint64_t* buckets_ = nullptr;
+  const Entry* entries_ = nullptr;
+  const char* strings_ = nullptr;
+  uint64_t strings_size_ = 0;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
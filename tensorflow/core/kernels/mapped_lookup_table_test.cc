@@ -0,0 +1,153 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr int kLineNumber = -1;
+constexpr int kWholeLine = -2;
+
+std::string WriteVocabulary(const std::string& name,
+                            const std::string& contents) {
+  const std::string filename = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+  return filename;
+}
+
+TEST(MappedLookupTableTest, FindsStringKeys) {
+  Env* env = Env::Default();
+  const std::string vocab = WriteVocabulary("vocab.txt", "a\nbc\n\ndef\n");
+  const std::string mapped =
+      io::JoinPath(testing::TmpDir(), "vocab.mapped_table");
+  TF_ASSERT_OK(WriteMappedTableFromTextFile(vocab, -1, '\t', kWholeLine,
+                                            kLineNumber, 0, DT_STRING,
+                                            DT_INT64, env, mapped));
+  EXPECT_TRUE(MappedLookupTable::IsMappedTableFile(env, mapped));
+  EXPECT_FALSE(MappedLookupTable::IsMappedTableFile(env, vocab));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedLookupTable> table,
+                          MappedLookupTable::Open(env, mapped));
+  EXPECT_EQ(table->key_dtype(), DT_STRING);
+  EXPECT_EQ(table->value_dtype(), DT_INT64);
+  EXPECT_EQ(table->size(), 4);
+  int64_t value;
+  ASSERT_TRUE(table->Find(tstring("a"), &value));
+  EXPECT_EQ(value, 0);
+  ASSERT_TRUE(table->Find(tstring("bc"), &value));
+  EXPECT_EQ(value, 1);
+  ASSERT_TRUE(table->Find(tstring(""), &value));
+  EXPECT_EQ(value, 2);
+  ASSERT_TRUE(table->Find(tstring("def"), &value));
+  EXPECT_EQ(value, 3);
+  EXPECT_FALSE(table->Find(tstring("de"), &value));
+}
+
+TEST(MappedLookupTableTest, FindsManyIntegerKeys) {
+  Env* env = Env::Default();
+  std::string contents;
+  for (int i = 0; i < 10000; ++i) {
+    strings::StrAppend(&contents, i * 7, "\tvalue", i, "\n");
+  }
+  const std::string vocab = WriteVocabulary("ints.txt", contents);
+  const std::string mapped =
+      io::JoinPath(testing::TmpDir(), "ints.mapped_table");
+  TF_ASSERT_OK(WriteMappedTableFromTextFile(vocab, -1, '\t', 0, 1, 0,
+                                            DT_INT64, DT_STRING, env, mapped));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedLookupTable> table,
+                          MappedLookupTable::Open(env, mapped));
+  EXPECT_EQ(table->size(), 10000);
+  tstring value;
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(table->Find(int64_t{i * 7}, &value));
+    EXPECT_EQ(value, strings::StrCat("value", i));
+    EXPECT_FALSE(table->Find(int64_t{i * 7 + 1}, &value));
+  }
+}
+
+TEST(MappedLookupTableTest, InitializesHashTable) {
+  Env* env = Env::Default();
+  const std::string vocab = WriteVocabulary("table.txt", "x\ny\nz\n");
+  const std::string mapped =
+      io::JoinPath(testing::TmpDir(), "table.mapped_table");
+  TF_ASSERT_OK(WriteMappedTableFromTextFile(vocab, -1, '\t', kWholeLine,
+                                            kLineNumber, 0, DT_STRING,
+                                            DT_INT64, env, mapped));
+
+  auto* table = new HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(InitializeTableFromTextFile(mapped, -1, '\t', kWholeLine,
+                                           kLineNumber, 0, env, table));
+  EXPECT_TRUE(table->is_initialized());
+  EXPECT_EQ(table->size(), 3);
+
+  Tensor keys = test::AsTensor<tstring>({"z", "w", "x"});
+  Tensor values(DT_INT64, TensorShape({3}));
+  Tensor default_value = test::AsScalar<int64_t>(-1);
+  TF_ASSERT_OK(table->Find(nullptr, keys, &values, default_value));
+  test::ExpectTensorEqual<int64_t>(values, test::AsTensor<int64_t>({2, -1, 0}));
+}
+
+TEST(MappedLookupTableTest, RejectsOtherInitializer) {
+  Env* env = Env::Default();
+  const std::string vocab = WriteVocabulary("other.txt", "x\ny\n");
+  const std::string mapped =
+      io::JoinPath(testing::TmpDir(), "other.mapped_table");
+  TF_ASSERT_OK(WriteMappedTableFromTextFile(vocab, -1, '\t', kWholeLine,
+                                            kLineNumber, 0, DT_STRING,
+                                            DT_INT64, env, mapped));
+
+  auto* table = new HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  EXPECT_TRUE(absl::IsInvalidArgument(InitializeTableFromTextFile(
+      mapped, -1, '\t', kWholeLine, kLineNumber, 1, env, table)));
+  EXPECT_FALSE(table->is_initialized());
+}
+
+TEST(MappedLookupTableTest, RejectsTruncatedFile) {
+  Env* env = Env::Default();
+  const std::string vocab = WriteVocabulary("truncated.txt", "x\ny\n");
+  const std::string mapped =
+      io::JoinPath(testing::TmpDir(), "truncated.mapped_table");
+  TF_ASSERT_OK(WriteMappedTableFromTextFile(vocab, -1, '\t', kWholeLine,
+                                            kLineNumber, 0, DT_STRING,
+                                            DT_INT64, env, mapped));
+  std::string data;
+  TF_ASSERT_OK(ReadFileToString(env, mapped, &data));
+  data.resize(data.size() - 1);
+  TF_ASSERT_OK(WriteStringToFile(env, mapped, data));
+  EXPECT_TRUE(absl::IsDataLoss(MappedLookupTable::Open(env, mapped).status()));
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -1547,4 +1547,11 @@ BM_TopKCPU(128, 70000, 70000, 16, "topk_nmt_r_128_c_70000_k_70000_th_16");
 BM_TopKCPU(128, 175000, 175000, 16, "topk_nmt_r_128_c_175000_k_175000_th_16");
 BM_TopKCPU(128, 350000, 350000, 16, "topk_nmt_r_128_c_350000_k_350000_th_16");
 
+// Candidate retrieval over large vocabularies.
+BM_TopKCPU(1, 1000000, 100, 16, "topk_r_1_c_1000000_k_100_th_16");
+BM_TopKCPU(1, 10000000, 1000, 16, "topk_r_1_c_10000000_k_1000_th_16");
+BM_TopKCPU(4, 1000000, 1000, 16, "topk_r_4_c_1000000_k_1000_th_16");
+BM_TopKCPU(16, 100000, 50000, 16, "topk_r_16_c_100000_k_50000_th_16");
+BM_TopKCPU(4096, 16, 4, 16, "topk_r_4096_c_16_k_4_th_16");
+
 }  // namespace tensorflow
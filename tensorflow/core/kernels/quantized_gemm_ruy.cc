@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/quantized_gemm_ruy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "ruy/context.h"  // from @ruy
+#include "ruy/matrix.h"  // from @ruy
+#include "ruy/mul_params.h"  // from @ruy
+#include "ruy/ruy.h"  // from @ruy
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/dynamic_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The minimum number of rows or columns of the result computed by a thread,
+// since each thread packs the whole operand it doesn't split.
+constexpr int kMinBlockSize = 16;
+
+// Multiplies the row major or (if transpose) column major matrices `a` and
+// `b` into the row major `c` on the calling thread.
+void RuyMul(bool transpose_a, bool transpose_b, const std::uint8_t* a,
+            const std::uint8_t* b, std::int32_t* c, int m, int n, int k,
+            int offset_a, int offset_b, int lda, int ldb, int ldc) {
+  ruy::Matrix<std::uint8_t> lhs;
+  ruy::MakeSimpleLayout(
+      m, k, transpose_a ? ruy::Order::kColMajor : ruy::Order::kRowMajor,
+      lhs.mutable_layout());
+  lhs.mutable_layout()->set_stride(lda);
+  lhs.set_data(a);
+  lhs.set_zero_point(offset_a);
+  ruy::Matrix<std::uint8_t> rhs;
+  ruy::MakeSimpleLayout(
+      k, n, transpose_b ? ruy::Order::kColMajor : ruy::Order::kRowMajor,
+      rhs.mutable_layout());
+  rhs.mutable_layout()->set_stride(ldb);
+  rhs.set_data(b);
+  rhs.set_zero_point(offset_b);
+  ruy::Matrix<std::int32_t> dst;
+  ruy::MakeSimpleLayout(m, n, ruy::Order::kRowMajor, dst.mutable_layout());
+  dst.mutable_layout()->set_stride(ldc);
+  dst.set_data(c);
+  // Ruy returns the raw accumulators for int32 results.
+  ruy::MulParams<std::int32_t, std::int32_t> mul_params;
+  // The threads are TensorFlow's, so each has a single threaded context,
+  // which keeps its packing buffers across calls.
+  thread_local ruy::Context ruy_context;
+  ruy::Mul(lhs, rhs, mul_params, &ruy_context, &dst);
+}
+
+}  // namespace
+
+bool IsRuyQuantizedGemmSupported(int offset_a, int offset_b) {
+  return offset_a >= 0 && offset_a <= 255 && offset_b >= 0 && offset_b <= 255;
+}
+
+void RuyQuantizedGemm(OpKernelContext* context, bool transpose_a,
+                      bool transpose_b, const quint8* a_data,
+                      const quint8* b_data, qint32* c_data, int m, int n, int k,
+                      int offset_a, int offset_b, int lda, int ldb, int ldc) {
+  if (m == 0 || n == 0) return;
+  const std::uint8_t* a = &(a_data->value);
+  const std::uint8_t* b = &(b_data->value);
+  std::int32_t* c = &(c_data->value);
+  if (k == 0) {
+    for (int i = 0; i < m; ++i) {
+      std::memset(c + static_cast<int64_t>(i) * ldc, 0, n * sizeof(*c));
+    }
+    return;
+  }
+
+  // Splits the larger dimension of the result into a block per thread, e.g.
+  // the columns for the single row of a matrix-vector product.
+  auto& worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  const bool split_rows = m >= n;
+  const int size = split_rows ? m : n;
+  const int num_blocks = std::max(
+      1, std::min(worker_threads.num_threads, size / kMinBlockSize));
+  const int64_t block_cost = static_cast<int64_t>(m) * n * k / num_blocks;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        block_cost, [&](int64_t start, int64_t limit) {
+          for (int64_t block = start; block < limit; ++block) {
+            const int begin = block * size / num_blocks;
+            const int end = (block + 1) * size / num_blocks;
+            if (split_rows) {
+              const int64_t a_offset =
+                  transpose_a ? begin : static_cast<int64_t>(begin) * lda;
+              RuyMul(transpose_a, transpose_b, a + a_offset, b,
+                     c + static_cast<int64_t>(begin) * ldc, end - begin, n, k,
+                     offset_a, offset_b, lda, ldb, ldc);
+            } else {
+              const int64_t b_offset =
+                  transpose_b ? static_cast<int64_t>(begin) * ldb : begin;
+              RuyMul(transpose_a, transpose_b, a, b + b_offset, c + begin, m,
+                     end - begin, k, offset_a, offset_b, lda, ldb, ldc);
+            }
+          }
+        });
+  // Since ruy uses assembly to write to the output, msan won't detect the
+  // output buffer as written to, so we mark it manually.
+  for (int i = 0; i < m; ++i) {
+    TF_ANNOTATE_MEMORY_IS_INITIALIZED(c + static_cast<int64_t>(i) * ldc,
+                                      n * sizeof(*c));
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_RUY_H_
+#define TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_RUY_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// Ruy picks the fastest of its kernels for the CPU it runs on at runtime, e.g.
+// AVX2, AVX-512 or AVX-512 VNNI on x86 and NEON or dot product instructions on
+// Arm, so it is faster than gemmlowp, whose x86 kernels only use SSE4.
+
+// Returns true if RuyQuantizedGemm supports the offsets of the operands, which
+// ruy takes as uint8 zero points.
+bool IsRuyQuantizedGemmSupported(int offset_a, int offset_b);
+
+// Calculates the quantized matrix multiplication:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] - offset_a) * (b_data[l, j] - offset_b)) : l in [0, k)
+//
+// If transpose_a is false the lhs operand has row major layout, otherwise
+// column major. Similarly transpose_b describes the layout of the rhs operand.
+// The result has row major layout. lda, ldb, and ldc are the strides of the lhs
+// operand, rhs operand and the result arrays.
+//
+// The computation is sharded over the CPU worker threads of `context`.
+void RuyQuantizedGemm(OpKernelContext* context, bool transpose_a,
+                      bool transpose_b, const quint8* a_data,
+                      const quint8* b_data, qint32* c_data, int m, int n, int k,
+                      int offset_a, int offset_b, int lda, int ldb, int ldc);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_RUY_H_
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -37,6 +38,7 @@ namespace tensorflow {
 
 class QuantizedMatMulTest : public OpsTestBase {
  protected:
+  void TestLarge(bool transpose_a, bool transpose_b);
 };
 
 // Runs two small matrices through the operator, and leaves all the parameters
@@ -393,4 +395,56 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Multiplies matrices large enough to be split over the threads, and tests
+// the results against the reference GEMM.
+void QuantizedMatMulTest::TestLarge(bool transpose_a, bool transpose_b) {
+  const int m = 67;
+  const int n = 45;
+  const int k = 131;
+  TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                   .Attr("transpose_a", transpose_a)
+                   .Attr("transpose_b", transpose_b)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  std::vector<quint8> a(m * k);
+  std::vector<quint8> b(k * n);
+  for (int i = 0; i < m * k; ++i) a[i] = (i * 37) % 256;
+  for (int i = 0; i < k * n; ++i) b[i] = (i * 101 + 7) % 256;
+  AddInputFromArray<quint8>(transpose_a ? TensorShape({k, m})
+                                        : TensorShape({m, k}),
+                            a);
+  AddInputFromArray<quint8>(transpose_b ? TensorShape({n, k})
+                                        : TensorShape({k, n}),
+                            b);
+  AddInputFromArray<float>(TensorShape({1}), {-1.0f});
+  AddInputFromArray<float>(TensorShape({1}), {1.0f});
+  AddInputFromArray<float>(TensorShape({1}), {-2.0f});
+  AddInputFromArray<float>(TensorShape({1}), {1.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const int offset_a = FloatToQuantizedUnclamped<quint8>(0.0f, -1.0f, 1.0f);
+  const int offset_b = FloatToQuantizedUnclamped<quint8>(0.0f, -2.0f, 1.0f);
+  Tensor expected(DT_QINT32, TensorShape({m, n}));
+  ReferenceGemm<quint8, quint8, qint32>(
+      transpose_a, transpose_b, false, m, n, k, a.data(), offset_a,
+      transpose_a ? m : k, b.data(), offset_b, transpose_b ? k : n,
+      expected.flat<qint32>().data(), 0, 0, 1, n);
+  test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+}
+
+TEST_F(QuantizedMatMulTest, Large) { TestLarge(false, false); }
+
+TEST_F(QuantizedMatMulTest, Large_TransposeA) { TestLarge(true, false); }
+
+TEST_F(QuantizedMatMulTest, Large_TransposeB) { TestLarge(false, true); }
+
+TEST_F(QuantizedMatMulTest, Large_TransposeAB) { TestLarge(true, true); }
+
 }  // namespace tensorflow
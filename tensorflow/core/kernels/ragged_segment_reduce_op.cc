@@ -0,0 +1,186 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+namespace {
+
+// The reductions of RaggedSegmentReduce, which match the UnsortedSegment ops.
+template <typename T>
+struct SumReducer {
+  static T Identity() { return T(0); }
+  static T Reduce(const T& data, const T& output) { return output + data; }
+};
+
+template <typename T>
+struct MinReducer {
+  static T Identity() { return Eigen::NumTraits<T>::highest(); }
+  static T Reduce(const T& data, const T& output) {
+    return std::min(data, output);
+  }
+};
+
+template <typename T>
+struct MaxReducer {
+  static T Identity() { return Eigen::NumTraits<T>::lowest(); }
+  static T Reduce(const T& data, const T& output) {
+    return std::max(data, output);
+  }
+};
+
+// Reduces the rows [begin, end) of `output`, of `inner_size` elements each,
+// from the rows of `data` given by `row_splits`. Each output row reduces its
+// data rows in order, with an inner loop over the elements of the rows that
+// the compiler vectorizes.
+template <typename T, typename SPLITS_TYPE, typename Reducer>
+void ReduceRows(const T* data, const SPLITS_TYPE* row_splits,
+                int64_t inner_size, int64_t begin, int64_t end, T* output) {
+  for (int64_t row = begin; row < end; ++row) {
+    T* output_row = output + row * inner_size;
+    std::fill_n(output_row, inner_size, Reducer::Identity());
+    for (int64_t i = row_splits[row]; i < row_splits[row + 1]; ++i) {
+      const T* data_row = data + i * inner_size;
+      for (int64_t j = 0; j < inner_size; ++j) {
+        output_row[j] = Reducer::Reduce(data_row[j], output_row[j]);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T, typename SPLITS_TYPE>
+class RaggedSegmentReduceOp : public OpKernel {
+ public:
+  explicit RaggedSegmentReduceOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::string reduction;
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction));
+    if (reduction == "sum") {
+      reduce_rows_ = ReduceRows<T, SPLITS_TYPE, SumReducer<T>>;
+    } else if (reduction == "min") {
+      reduce_rows_ = ReduceRows<T, SPLITS_TYPE, MinReducer<T>>;
+    } else {
+      reduce_rows_ = ReduceRows<T, SPLITS_TYPE, MaxReducer<T>>;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& data_in = context->input(0);
+    const Tensor& row_splits_in = context->input(1);
+    OP_REQUIRES(context, data_in.dims() >= 1,
+                InvalidArgument("data must have rank at least 1"));
+    OP_REQUIRES(context, row_splits_in.dims() == 1,
+                InvalidArgument("row_splits must be a vector"));
+    OP_REQUIRES(context, row_splits_in.NumElements() >= 1,
+                InvalidArgument("row_splits must not be empty"));
+
+    const auto row_splits = row_splits_in.vec<SPLITS_TYPE>();
+    const int64_t num_rows = row_splits.size() - 1;
+    const int64_t num_values = data_in.dim_size(0);
+    OP_REQUIRES(context, row_splits(0) == 0,
+                InvalidArgument("row_splits must start with 0, got ",
+                                row_splits(0)));
+    for (int64_t row = 0; row < num_rows; ++row) {
+      OP_REQUIRES(context, row_splits(row) <= row_splits(row + 1),
+                  InvalidArgument("row_splits must be sorted, got ",
+                                  row_splits(row), " before ",
+                                  row_splits(row + 1)));
+    }
+    OP_REQUIRES(context, row_splits(num_rows) == num_values,
+                InvalidArgument("row_splits must end with the number of "
+                                "values ",
+                                num_values, ", got ", row_splits(num_rows)));
+
+    TensorShape output_shape = data_in.shape();
+    output_shape.set_dim(0, num_rows);
+    Tensor* output_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output_out));
+    if (output_out->NumElements() == 0) return;
+
+    const int64_t inner_size = output_out->NumElements() / num_rows;
+    const T* data = data_in.flat<T>().data();
+    T* output = output_out->flat<T>().data();
+
+    // Splits the rows into blocks of about as much work, counting each row as
+    // one data row more than its length.
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_blocks =
+        std::min<int64_t>(num_rows, 4 * worker_threads.num_threads);
+    const int64_t total_work = num_values + num_rows;
+    std::vector<int64_t> block_rows(num_blocks + 1);
+    for (int64_t block = 0; block <= num_blocks; ++block) {
+      const int64_t target = block * total_work / num_blocks;
+      int64_t lo = 0;
+      int64_t hi = num_rows;
+      // The first row whose work starts at or after `target`.
+      while (lo < hi) {
+        const int64_t mid = lo + (hi - lo) / 2;
+        if (static_cast<int64_t>(row_splits(mid)) + mid < target) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      block_rows[block] = lo;
+    }
+    const SPLITS_TYPE* row_splits_data = row_splits.data();
+    auto reduce_blocks = [&](int64_t begin, int64_t end) {
+      for (int64_t block = begin; block < end; ++block) {
+        reduce_rows_(data, row_splits_data, inner_size, block_rows[block],
+                     block_rows[block + 1], output);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          std::max<int64_t>(1, total_work / num_blocks * inner_size),
+          reduce_blocks);
+  }
+
+ private:
+  void (*reduce_rows_)(const T*, const SPLITS_TYPE*, int64_t, int64_t, int64_t,
+                       T*);
+};
+
+#define REGISTER_CPU_KERNEL(TYPE)                                  \
+  REGISTER_KERNEL_BUILDER(Name("RaggedSegmentReduce")              \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int32>("Tsplits"),   \
+                          RaggedSegmentReduceOp<TYPE, int32>);     \
+  REGISTER_KERNEL_BUILDER(Name("RaggedSegmentReduce")              \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<TYPE>("T")           \
+                              .TypeConstraint<int64_t>("Tsplits"), \
+                          RaggedSegmentReduceOp<TYPE, int64_t>);
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedSegmentReduceOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  template <typename T>
+  void BuildRaggedSegmentReduceGraph(const char* reduction) {
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedSegmentReduce")
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))  // data
+                     .Input(FakeInput(DT_INT64))                // row_splits
+                     .Attr("reduction", reduction)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedSegmentReduceOpTest, Sum) {
+  BuildRaggedSegmentReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({5, 2}),
+                           {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});  // data
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 5});  // row_splits
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Expected: [[1 + 3, 2 + 4], [0, 0], [5 + 7 + 9, 6 + 8 + 10]]
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({4, 6, 0, 0, 21, 24}, TensorShape({3, 2})));
+}
+
+TEST_F(RaggedSegmentReduceOpTest, Max) {
+  BuildRaggedSegmentReduceGraph<int32>("max");
+  AddInputFromArray<int32>(TensorShape({4}), {3, -1, 7, 2});  // data
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 0, 4});     // row_splits
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0),
+      test::AsTensor<int32>({std::numeric_limits<int32>::lowest(), 7}));
+}
+
+TEST_F(RaggedSegmentReduceOpTest, Min) {
+  BuildRaggedSegmentReduceGraph<int32>("min");
+  AddInputFromArray<int32>(TensorShape({4}), {3, -1, 7, 2});  // data
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 4});     // row_splits
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(*GetOutput(0),
+                                 test::AsTensor<int32>({3, -1}));
+}
+
+TEST_F(RaggedSegmentReduceOpTest, ManyRows) {
+  // Rows of very different lengths, for the rows to be split into blocks of
+  // different sizes.
+  BuildRaggedSegmentReduceGraph<int64_t>("sum");
+  constexpr int kNumRows = 1000;
+  std::vector<int64_t> row_splits = {0};
+  for (int row = 0; row < kNumRows; ++row) {
+    row_splits.push_back(row_splits.back() + (row % 10 == 0 ? 100 : row % 3));
+  }
+  const int64_t num_values = row_splits.back();
+  std::vector<int64_t> data(num_values * 3);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = i;
+  AddInputFromArray<int64_t>(TensorShape({num_values, 3}), data);
+  AddInputFromArray<int64_t>(TensorShape({kNumRows + 1}), row_splits);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_INT64, TensorShape({kNumRows, 3}));
+  expected.flat<int64_t>().setZero();
+  for (int row = 0; row < kNumRows; ++row) {
+    for (int64_t i = row_splits[row]; i < row_splits[row + 1]; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        expected.matrix<int64_t>()(row, j) += i * 3 + j;
+      }
+    }
+  }
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0), expected);
+}
+
+TEST_F(RaggedSegmentReduceOpTest, InvalidRowSplits) {
+  BuildRaggedSegmentReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});     // data
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 1});  // row_splits
+  EXPECT_EQ(RunOpKernel().message(),
+            "row_splits must be sorted, got 2 before 1");
+}
+
+TEST_F(RaggedSegmentReduceOpTest, RowSplitsDoNotMatchData) {
+  BuildRaggedSegmentReduceGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});     // data
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 4});  // row_splits
+  EXPECT_EQ(RunOpKernel().message(),
+            "row_splits must end with the number of values 3, got 4");
+}
+
+TEST_F(RaggedSegmentReduceOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedSegmentReduce");
+  INFER_OK(op, "?;?", "?");
+  INFER_OK(op, "[?,2,3];[4]", "[3,d0_1,d0_2]");
+  INFER_OK(op, "[?];?", "[?]");
+  INFER_ERROR("must be at least rank 1", op, "[];?");
+  INFER_ERROR("Shape must be rank 1", op, "?;[2,3]");
+}
+
+}  // namespace
+}  // namespace tensorflow
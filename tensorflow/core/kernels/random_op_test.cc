@@ -14,17 +14,86 @@ limitations under the License.
 ==============================================================================*/
 
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/random_op_cpu.h"
 #include "tensorflow/core/lib/math/math_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
 
+TEST(PhiloxBatchTest, MatchesGenerator) {
+  for (uint32 counter0 : {0u, 5u, 0xfffffff8u, 0xffffffffu}) {
+    for (uint32 counter1 : {0u, 0xffffffffu}) {
+      random::PhiloxRandom::ResultType counter;
+      counter[0] = counter0;
+      counter[1] = counter1;
+      counter[2] = 0xffffffffu;
+      counter[3] = 7;
+      random::PhiloxRandom::Key key;
+      key[0] = 0x12345;
+      key[1] = 0x6789a;
+      random::PhiloxRandom batch_gen(counter, key);
+      random::PhiloxRandom gen(counter, key);
+      uint32 samples[4 * functor::kPhiloxBatchSize];
+      for (int batch = 0; batch < 3; ++batch) {
+        functor::GeneratePhiloxBatch(&batch_gen, samples);
+        for (int i = 0; i < functor::kPhiloxBatchSize; ++i) {
+          const random::PhiloxRandom::ResultType sample = gen();
+          for (int j = 0; j < 4; ++j) {
+            EXPECT_EQ(samples[4 * i + j], sample[j]);
+          }
+        }
+      }
+      for (int j = 0; j < 4; ++j) {
+        EXPECT_EQ(batch_gen.counter()[j], gen.counter()[j]);
+      }
+    }
+  }
+}
+
+// Tests that filling in batches returns the samples of the distribution.
+template <class Distribution>
+void TestFillPhiloxRandomTask(int64_t size, int64_t start_group,
+                              int64_t limit_group) {
+  using T = typename Distribution::ResultElementType;
+  const int kGroupSize = Distribution::kResultElementCount;
+  random::PhiloxRandom gen(0x12345, 0x6789a);
+  std::vector<T> data(size);
+  functor::FillPhiloxRandomTask<Distribution, false>::Run(
+      gen, data.data(), size, start_group, limit_group, Distribution());
+  gen.Skip(start_group);
+  Distribution dist;
+  for (int64_t group = start_group; group < limit_group; ++group) {
+    const auto samples = dist(&gen);
+    for (int i = 0; i < kGroupSize && group * kGroupSize + i < size; ++i) {
+      EXPECT_EQ(data[group * kGroupSize + i], samples[i]);
+    }
+  }
+}
+
+TEST(FillPhiloxRandomTaskTest, MatchesDistribution) {
+  using random::NormalDistribution;
+  using random::PhiloxRandom;
+  using random::UniformDistribution;
+  TestFillPhiloxRandomTask<UniformDistribution<PhiloxRandom, float>>(1001, 0,
+                                                                     251);
+  TestFillPhiloxRandomTask<UniformDistribution<PhiloxRandom, float>>(1001, 3,
+                                                                     100);
+  TestFillPhiloxRandomTask<UniformDistribution<PhiloxRandom, double>>(999, 7,
+                                                                      500);
+  TestFillPhiloxRandomTask<NormalDistribution<PhiloxRandom, float>>(1002, 1,
+                                                                    251);
+  TestFillPhiloxRandomTask<NormalDistribution<PhiloxRandom, double>>(1001, 0,
+                                                                     501);
+}
+
 Tensor VecShape(int64_t v) {
   if (v >= std::numeric_limits<int32>::max()) {
     Tensor shape(DT_INT64, TensorShape({1}));
@@ -116,6 +185,22 @@ void BM_PhiloxRandom(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PhiloxRandom);
 
+void BM_PhiloxRandomBatch(::testing::benchmark::State& state) {
+  // Fill 2M random numbers
+  int count = 2 << 20;
+  random::PhiloxRandom gen(0x12345);
+  uint32 samples[4 * functor::kPhiloxBatchSize];
+
+  for (auto s : state) {
+    for (int j = 0; j < count; j += 4 * functor::kPhiloxBatchSize) {
+      functor::GeneratePhiloxBatch(&gen, samples);
+      tensorflow::testing::DoNotOptimize(samples);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_PhiloxRandomBatch);
+
 void BM_StdMTRandom(::testing::benchmark::State& state) {
   // Fill 2M random numbers
   int count = 2 << 20;
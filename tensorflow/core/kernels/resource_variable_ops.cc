@@ -61,8 +61,10 @@ limitations under the License.
 #include <type_traits>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -86,6 +88,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -146,7 +149,7 @@ Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   core::RefCountPtr<Var> variable;
   const ResourceHandle& handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Could not find variable ", handle.name(), ". ",
@@ -707,6 +710,24 @@ REGISTER_KERNEL_BUILDER(Name("VarIsInitializedOp")
                             .HostMemory("is_initialized"),
                         VarIsInitializedOp);
 
+namespace {
+
+// Like EnsureSparseVariableAccess(), for the gathers.  A host variable backed
+// by memory it does not own, e.g. a memory-mapped checkpoint restored with
+// TF_RESTORE_MAP_VARIABLES, is never updated in place (see
+// Tensor::RefCountIsOne()), so it is gathered from without copying it.
+template <typename Device, typename T>
+Status EnsureSparseVariableReadAccess(OpKernelContext* ctx, Var* var) {
+  if (std::is_same<Device, CPUDevice>::value) {
+    tf_shared_lock ml(*var->mu());
+    const TensorBuffer* buffer = DMAHelper::buffer(var->tensor());
+    if (buffer != nullptr && !buffer->OwnsMemory()) return absl::OkStatus();
+  }
+  return EnsureSparseVariableAccess<Device, T>(ctx, var);
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Index>
 class ResourceGatherOp : public OpKernel {
  public:
@@ -719,8 +740,8 @@ class ResourceGatherOp : public OpKernel {
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
-    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    OP_REQUIRES_OK(c, variable_cache_.Lookup(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, EnsureSparseVariableReadAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -839,6 +860,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -898,7 +920,7 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    OP_REQUIRES_OK(c, EnsureSparseVariableReadAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -1111,11 +1133,18 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (!s.ok()) {
       use_exclusive_lock_ = false;
     }
+    if (isCPUDevice<Device>() && (op == scatter_op::UpdateOp::ADD ||
+                                  op == scatter_op::UpdateOp::SUB)) {
+      OP_REQUIRES_OK(c, ReadBoolFromEnvVar("TF_RESOURCE_SCATTER_COALESCE",
+                                           false, &coalesce_duplicates_));
+    }
   }
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    Tensor indices = c->input(1);
+    Tensor updates = c->input(2);
 
     // Check data type of update and resource to scatter.
     const DataType update_dtype = c->input(2).dtype();
@@ -1127,25 +1156,87 @@ class ResourceScatterUpdateOp : public OpKernel {
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
                                   c->input_dtype(0) == DT_VARIANT;
+    if (coalesce_duplicates_ && !is_non_pod_dtype) {
+      // Sums the updates of the same rows before taking the variable's lock,
+      // so that hot rows are only updated once per call.
+      OP_REQUIRES_OK(c, CoalesceDuplicates(c, &indices, &updates));
+    }
     if (is_non_pod_dtype || use_exclusive_lock_) {
       mutex_lock ml(*v->mu());
-      DoCompute(c);
+      DoCompute(c, indices, updates);
     } else {
       // For POD dtypes, we can safely run the update without the mutex.
       tf_shared_lock ml(*v->mu());
-      DoCompute(c);
+      DoCompute(c, indices, updates);
     }
   }
 
  private:
   bool use_exclusive_lock_;
+  bool coalesce_duplicates_ = false;
+
+  // Replaces `indices` and `updates` with the unique indices, in order of
+  // first occurrence, and the sums of their updates. Leaves them unchanged if
+  // the indices have no duplicates or the shapes don't match, which
+  // DoCompute() reports.
+  Status CoalesceDuplicates(OpKernelContext* c, Tensor* indices,
+                            Tensor* updates) {
+    if constexpr (op == scatter_op::UpdateOp::ADD ||
+                  op == scatter_op::UpdateOp::SUB) {
+      const int64_t num_indices = indices->NumElements();
+      if (num_indices < 2 || updates->dims() < indices->dims()) {
+        return absl::OkStatus();
+      }
+      for (int i = 0; i < indices->dims(); ++i) {
+        if (updates->dim_size(i) != indices->dim_size(i)) {
+          return absl::OkStatus();
+        }
+      }
+      const int64_t row_size = updates->NumElements() / num_indices;
+      const auto indices_flat = indices->flat<Index>();
+      absl::flat_hash_map<Index, int64_t> unique_rows;
+      unique_rows.reserve(num_indices);
+      std::vector<int64_t> rows(num_indices);
+      for (int64_t i = 0; i < num_indices; ++i) {
+        rows[i] = unique_rows.emplace(indices_flat(i), unique_rows.size())
+                      .first->second;
+      }
+      const int64_t num_unique = unique_rows.size();
+      if (num_unique == num_indices) return absl::OkStatus();
+
+      Tensor unique_indices;
+      TF_RETURN_IF_ERROR(c->allocate_temp(
+          indices->dtype(), TensorShape({num_unique}), &unique_indices));
+      TensorShape summed_shape({num_unique});
+      for (int i = indices->dims(); i < updates->dims(); ++i) {
+        summed_shape.AddDim(updates->dim_size(i));
+      }
+      Tensor summed_updates;
+      TF_RETURN_IF_ERROR(
+          c->allocate_temp(updates->dtype(), summed_shape, &summed_updates));
+
+      auto unique_indices_flat = unique_indices.flat<Index>();
+      const auto updates_flat = updates->shaped<T, 2>({num_indices, row_size});
+      auto summed_flat = summed_updates.shaped<T, 2>({num_unique, row_size});
+      summed_flat.setZero();
+      for (int64_t i = 0; i < num_indices; ++i) {
+        unique_indices_flat(rows[i]) = indices_flat(i);
+        summed_flat.template chip<0>(rows[i]) +=
+            updates_flat.template chip<0>(i);
+      }
+      VLOG(2) << "Coalesced " << num_indices << " scatter updates of "
+              << def().name() << " into " << num_unique;
+      *indices = std::move(unique_indices);
+      *updates = std::move(summed_updates);
+    }
+    return absl::OkStatus();
+  }
 
-  void DoCompute(OpKernelContext* c) {
+  void DoCompute(OpKernelContext* c, const Tensor& indices,
+                 const Tensor& updates) {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     Tensor* params = v->tensor();
-    const Tensor& indices = c->input(1);
-    const Tensor& updates = c->input(2);
 
     // Check that rank(updates.shape) = rank(indices.shape + params.shape[1:])
     OP_REQUIRES(c,
@@ -0,0 +1,152 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCoalesceEnvVar[] = "TF_RESOURCE_SCATTER_COALESCE";
+
+// Runs one resource scatter op on a fresh variable.
+class ResourceScatterRunner : public OpsTestBase {
+ public:
+  void TestBody() override {}
+
+  // Applies `op` with `indices` and `updates` to a variable holding `params`,
+  // with duplicate coalescing enabled iff `coalesce`, and sets `result` to the
+  // new value of the variable.
+  Status Run(const std::string& op, bool coalesce, const Tensor& params,
+             const Tensor& indices, const Tensor& updates, Tensor* result) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("scatter", op)
+                           .Input(FakeInput(DT_RESOURCE))
+                           .Input(FakeInput(indices.dtype()))
+                           .Input(FakeInput(updates.dtype()))
+                           .Finalize(node_def()));
+    // The kernel reads the environment variable when it is constructed.
+    setenv(kCoalesceEnvVar, coalesce ? "1" : "0", /*overwrite=*/1);
+    const Status init_status = InitOp();
+    unsetenv(kCoalesceEnvVar);
+    TF_RETURN_IF_ERROR(init_status);
+
+    Var* var = new Var(params.dtype());
+    *var->tensor() = tensor::DeepCopy(params);
+    var->is_initialized = true;
+    AddResourceInput("", "var", var);
+    *AddInput(indices.dtype(), indices.shape()) = indices;
+    *AddInput(updates.dtype(), updates.shape()) = updates;
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    *result = *var->tensor();
+    return absl::OkStatus();
+  }
+};
+
+// Checks that `op` gives `expected` both with and without coalescing.
+template <typename T>
+void ExpectScatterResult(const std::string& op, const Tensor& params,
+                         const Tensor& indices, const Tensor& updates,
+                         const Tensor& expected) {
+  Tensor serial, coalesced;
+  TF_ASSERT_OK(ResourceScatterRunner().Run(op, /*coalesce=*/false, params,
+                                           indices, updates, &serial));
+  TF_ASSERT_OK(ResourceScatterRunner().Run(op, /*coalesce=*/true, params,
+                                           indices, updates, &coalesced));
+  test::ExpectTensorEqual<T>(expected, serial);
+  test::ExpectTensorEqual<T>(serial, coalesced);
+}
+
+TEST(ResourceScatterCoalesceTest, AddFloatWithDuplicates) {
+  ExpectScatterResult<float>(
+      "ResourceScatterAdd",
+      test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {4, 2}),
+      test::AsTensor<int32>({1, 3, 1, 1, 0, 3}),
+      test::AsTensor<float>({10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120},
+                            {6, 2}),
+      test::AsTensor<float>({91, 102, 133, 164, 5, 6, 147, 168}, {4, 2}));
+}
+
+TEST(ResourceScatterCoalesceTest, SubFloatWithDuplicates) {
+  ExpectScatterResult<float>(
+      "ResourceScatterSub", test::AsTensor<float>({1, 2, 3, 4}, {2, 2}),
+      test::AsTensor<int64_t>({1, 1, 1}),
+      test::AsTensor<float>({1, 1, 2, 2, 3, 3}, {3, 2}),
+      test::AsTensor<float>({1, 2, -3, -2}, {2, 2}));
+}
+
+TEST(ResourceScatterCoalesceTest, AddInt32WithDuplicates) {
+  ExpectScatterResult<int32>(
+      "ResourceScatterAdd", test::AsTensor<int32>({0, 0, 0}, {3}),
+      test::AsTensor<int64_t>({2, 0, 2, 2}),
+      test::AsTensor<int32>({1, 2, 3, 4}), test::AsTensor<int32>({2, 0, 8}));
+}
+
+TEST(ResourceScatterCoalesceTest, SubInt64WithDuplicates) {
+  ExpectScatterResult<int64_t>(
+      "ResourceScatterSub", test::AsTensor<int64_t>({10, 20, 30, 40}, {2, 2}),
+      test::AsTensor<int32>({0, 1, 0}),
+      test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6}, {3, 2}),
+      test::AsTensor<int64_t>({4, 12, 27, 36}, {2, 2}));
+}
+
+TEST(ResourceScatterCoalesceTest, AddHigherRankIndicesWithDuplicates) {
+  ExpectScatterResult<int32>(
+      "ResourceScatterAdd", test::AsTensor<int32>({0, 0, 0, 0}, {2, 2}),
+      test::AsTensor<int32>({1, 0, 1, 1}, {2, 2}),
+      test::AsTensor<int32>({1, 2, 3, 4, 5, 6, 7, 8}, {2, 2, 2}),
+      test::AsTensor<int32>({3, 4, 13, 16}, {2, 2}));
+}
+
+TEST(ResourceScatterCoalesceTest, AddWithoutDuplicates) {
+  ExpectScatterResult<float>(
+      "ResourceScatterAdd", test::AsTensor<float>({1, 2, 3}, {3}),
+      test::AsTensor<int32>({2, 0}), test::AsTensor<float>({10, 20}),
+      test::AsTensor<float>({21, 2, 13}));
+}
+
+TEST(ResourceScatterCoalesceTest, AddEmptyUpdates) {
+  ExpectScatterResult<float>(
+      "ResourceScatterAdd", test::AsTensor<float>({1, 2, 3, 4}, {2, 2}),
+      test::AsTensor<int32>({}),
+      Tensor(DT_FLOAT, TensorShape({0, 2})),
+      test::AsTensor<float>({1, 2, 3, 4}, {2, 2}));
+}
+
+TEST(ResourceScatterCoalesceTest, AddOutOfRangeDuplicateFails) {
+  Tensor params = test::AsTensor<float>({1, 2}, {2});
+  Tensor indices = test::AsTensor<int32>({5, 0, 5});
+  Tensor updates = test::AsTensor<float>({1, 2, 3});
+  Tensor result;
+  EXPECT_FALSE(ResourceScatterRunner()
+                   .Run("ResourceScatterAdd", /*coalesce=*/true, params,
+                        indices, updates, &result)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -251,6 +253,11 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Small tensors are restored serially unless there are enough of them to give
+// each of up to kMaxSmallRestoreRuns concurrent runs this many tensors.
+const int kMinSmallRestoreOpsPerRun = 64;
+const int kMaxSmallRestoreRuns = 8;
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -258,13 +265,15 @@ const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
-            DataType dtype)
+            DataType dtype, bool use_mmap, bool map_outputs)
       : context(context),
         idx(idx),
         tensor_name(tensor_name),
         shape_and_slice(shape_and_slice),
         reader_prefix(reader_prefix),
-        dtype(dtype) {}
+        dtype(dtype),
+        use_mmap(use_mmap),
+        map_outputs(map_outputs) {}
 
   // Move-only. It does not make sense to "run()" a copied RestoreOp.
   RestoreOp(const RestoreOp&) = delete;
@@ -285,7 +294,11 @@ struct RestoreOp {
 
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader(BundleCache* cache) {
-    BundleReader reader(tsl::Env::Default(), reader_prefix, {cache, false});
+    BundleReader::Options options;
+    options.cache = cache;
+    options.use_mmap = use_mmap;
+    options.verify_mapped_checksums = !map_outputs;
+    BundleReader reader(tsl::Env::Default(), reader_prefix, options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -302,7 +315,14 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    Tensor mapped_tensor;
+    if (shape_and_slice.empty() && map_outputs) {
+      // The output views the data file, so that a variable it is assigned to
+      // stays backed by the page cache until it is first written to.
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped_tensor));
+      context->set_output(idx, mapped_tensor);
+      restored_tensor = &mapped_tensor;
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -356,6 +376,9 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  bool use_mmap;
+  // Whether full tensors are output as views of the mapped data files.
+  bool map_outputs;
 
   ::tensorflow::Status status;
 };
@@ -371,16 +394,38 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
+  // Memory-mapping the data files lets concurrent restores copy tensors out of
+  // the page cache without issuing a read per tensor.
+  bool use_mmap = false;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_RESTORE_USE_MMAP", /*default_val=*/false,
+                         &use_mmap));
+  // Outputting views of the mapped data files instead lets serving variables,
+  // which AssignVariableOp adopts without a copy, share the page cache: memory
+  // and restore time then scale with the pages actually read.  The checksums
+  // of such tensors are not verified, as that would read every page.  The
+  // data files must be aligned, see TF_SAVE_V2_MMAP_ALIGNED.
+  bool map_outputs = false;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_RESTORE_MAP_VARIABLES", /*default_val=*/false,
+                         &map_outputs));
+  use_mmap |= map_outputs;
+
   std::vector<RestoreOp> restore_ops;
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
-                           shape_and_slices_flat(i), prefix_string, dtypes[i]});
+                           shape_and_slices_flat(i), prefix_string, dtypes[i],
+                           use_mmap, map_outputs});
   }
 
   tsl::Env* const env = tsl::Env::Default();
   BundleCache cache(env);
-  BundleReader default_reader(env, prefix_string, {&cache, false});
+  BundleReader::Options reader_options;
+  reader_options.cache = &cache;
+  reader_options.use_mmap = use_mmap;
+  reader_options.verify_mapped_checksums = !map_outputs;
+  BundleReader default_reader(env, prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -443,11 +488,17 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   } else {
     // If no restore parallelism is specified, we run large restore ops with
-    // a modest parallelism, and small restore ops serially.
-
-    // Avoid creating a pool if there are no large restore ops.
+    // a modest parallelism.  Small restore ops run serially, or, when there
+    // are many of them, in a few contiguous runs of the sorted order: each run
+    // reads its part of the data files sequentially, and runs (and hence
+    // typically different data shards) proceed concurrently.
+    const int num_small_runs = std::min<int>(
+        kMaxSmallRestoreRuns,
+        small_restore_ops.size() / kMinSmallRestoreOpsPerRun);
+
+    // Avoid creating a pool if there is nothing to run on it.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!large_restore_ops.empty()) {
+    if (!large_restore_ops.empty() || num_small_runs > 1) {
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto* op : large_restore_ops) {
@@ -456,9 +507,25 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
-    // Read small tensors from the op thread.
-    for (auto* op : small_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    if (num_small_runs > 1) {
+      const size_t num_small_ops = small_restore_ops.size();
+      for (int run = 0; run < num_small_runs; ++run) {
+        const size_t begin = num_small_ops * run / num_small_runs;
+        const size_t end = num_small_ops * (run + 1) / num_small_runs;
+        reader_pool->Schedule([&, begin, end]() {
+          BundleReader reader(env, prefix_string, reader_options);
+          for (size_t i = begin; i < end; ++i) {
+            RestoreOp* op = small_restore_ops[i];
+            op->status = reader.status().ok() ? op->run(&reader)
+                                              : reader.status();
+          }
+        });
+      }
+    } else {
+      // Read small tensors from the op thread.
+      for (auto* op : small_restore_ops) {
+        TF_RETURN_IF_ERROR(op->run(&default_reader));
+      }
     }
 
     // Wait for all scheduled work to finish and check the status of all
@@ -467,6 +534,11 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     for (auto* op : large_restore_ops) {
       TF_RETURN_IF_ERROR(op->status);
     }
+    if (num_small_runs > 1) {
+      for (auto* op : small_restore_ops) {
+        TF_RETURN_IF_ERROR(op->status);
+      }
+    }
   }
 
   for (const RestoreOp& restore_op : restore_ops) {
@@ -16,14 +16,20 @@ limitations under the License.
 // See docs in ../ops/io_ops.cc.
 
 #include <cstddef>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
@@ -32,7 +38,11 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"  // IWYU pragma: keep
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -90,12 +100,105 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// The environment variable enabling asynchronous saves.
+constexpr char kAsyncSaveEnvVar[] = "TF_SAVE_V2_ASYNC";
+
+// The environment variable aligning the tensors in the data files, so that
+// RestoreV2 can output views of them with TF_RESTORE_MAP_VARIABLES.
+constexpr char kMmapAlignedSaveEnvVar[] = "TF_SAVE_V2_MMAP_ALIGNED";
+
+// The number of threads writing asynchronous saves.
+constexpr int kNumAsyncSaveThreads = 4;
+
+// How long MergeV2Checkpoints waits for the asynchronous saves of other
+// processes to write their checkpoints.
+constexpr int64_t kMaxMergeWaitMicros = 10LL * 60 * 1000 * 1000;
+
+// The saves of SaveV2 running in the background, by checkpoint prefix.
+class AsyncSaves {
+ public:
+  static AsyncSaves* Global() {
+    static AsyncSaves* saves = new AsyncSaves();
+    return saves;
+  }
+
+  // Runs `save` in the background as the save of `prefix`, once the previous
+  // save of `prefix` is done. Returns the error of the previous save, if it
+  // failed and nothing waited for it.
+  Status Schedule(const string& prefix, std::function<Status()> save) {
+    Status s = Wait(prefix);
+    auto pending = std::make_shared<PendingSave>();
+    {
+      mutex_lock l(mu_);
+      saves_[prefix] = pending;
+    }
+    pool_.Schedule([this, prefix, pending, save = std::move(save)]() {
+      pending->status = save();
+      if (pending->status.ok()) {
+        // Errors are kept until something waits for them.
+        Erase(prefix, pending);
+      }
+      pending->done.Notify();
+    });
+    return s;
+  }
+
+  // Waits for the save of `prefix`, if any, and returns its status.
+  Status Wait(const string& prefix) {
+    std::shared_ptr<PendingSave> pending;
+    {
+      mutex_lock l(mu_);
+      auto it = saves_.find(prefix);
+      if (it == saves_.end()) return absl::OkStatus();
+      pending = it->second;
+    }
+    pending->done.WaitForNotification();
+    Erase(prefix, pending);
+    return pending->status;
+  }
+
+ private:
+  struct PendingSave {
+    Notification done;
+    Status status;
+  };
+
+  AsyncSaves()
+      : pool_(Env::Default(), "async_save_v2", kNumAsyncSaveThreads) {}
+
+  void Erase(const string& prefix, const std::shared_ptr<PendingSave>& save) {
+    mutex_lock l(mu_);
+    auto it = saves_.find(prefix);
+    if (it != saves_.end() && it->second == save) saves_.erase(it);
+  }
+
+  mutex mu_;
+  std::unordered_map<string, std::shared_ptr<PendingSave>> saves_
+      TF_GUARDED_BY(mu_);
+  thread::ThreadPool pool_;
+};
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// If the TF_SAVE_V2_ASYNC environment variable is true, the op only copies
+// the tensors to host memory, and writes them in the background. The next
+// SaveV2 of the same prefix, a RestoreV2 of the prefix and a
+// MergeV2Checkpoints of it wait for the write and return its error, if any.
+//
+// If the TF_SAVE_V2_MMAP_ALIGNED environment variable is true, the tensors are
+// aligned to Allocator::kAllocatorAlignment in the data files.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar(kAsyncSaveEnvVar, false, &async_));
+    bool mmap_aligned = false;
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar(kMmapAlignedSaveEnvVar, false,
+                                               &mmap_aligned));
+    if (mmap_aligned) data_alignment_ = Allocator::kAllocatorAlignment;
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -111,34 +214,94 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<string> names(num_tensors);
+    std::vector<string> shape_specs(num_tensors);
+    std::vector<Tensor> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      names[i] = tensor_names_flat(i);
+      shape_specs[i] = shape_and_slices_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
+      // The copy is the snapshot written in the background, which the step
+      // may update as soon as the op returns.
+      tensors[i] = async_ ? tensor::DeepCopy(tensor) : tensor;
+    }
+
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager =
+        nullptr;
+    ResourceMgr* resource_manager = context->resource_manager();
+    if (resource_manager != nullptr) {
+      OP_REQUIRES_OK(
+          context,
+          resource_manager
+              ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
+                  resource_manager->default_container(),
+                  std::string(
+                      checkpoint::kCheckpointCallbackManagerResourceName),
+                  &checkpoint_callback_manager,
+                  [](checkpoint::CheckpointCallbackManager** out) {
+                    *out = new checkpoint::CheckpointCallbackManager();
+                    return absl::OkStatus();
+                  }));
+    }
+
+    auto save = [prefix_string, names = std::move(names),
+                 shape_specs = std::move(shape_specs),
+                 tensors = std::move(tensors), checkpoint_callback_manager,
+                 data_alignment = data_alignment_]() {
+      Status s = SaveTensors(prefix_string, names, shape_specs, tensors,
+                             data_alignment);
+      if (checkpoint_callback_manager != nullptr) {
+        if (s.ok()) checkpoint_callback_manager->Save(prefix_string);
+        checkpoint_callback_manager->Unref();
+      }
+      return s;
+    };
+    if (async_) {
+      VLOG(1) << "Scheduling async save of prefix_string: " << prefix_string;
+      OP_REQUIRES_OK(context, AsyncSaves::Global()->Schedule(
+                                  prefix_string, std::move(save)));
+    } else {
+      OP_REQUIRES_OK(context, save());
+    }
+  }
+
+ private:
+  // Writes `tensors`, named `names` and with the slice specs `shape_specs`,
+  // to the checkpoint `prefix`.
+  static Status SaveTensors(const string& prefix,
+                            const std::vector<string>& names,
+                            const std::vector<string>& shape_specs,
+                            const std::vector<Tensor>& tensors,
+                            int data_alignment) {
+    BundleWriter::Options options;
+    options.data_alignment = data_alignment;
+    BundleWriter writer(Env::Default(), prefix, options);
+    TF_RETURN_IF_ERROR(writer.status());
+    VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      const string& tensor_name = names[i];
+      const Tensor& tensor = tensors[i];
       VLOG(2) << "Starting save of " << tensor_name;
 
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
+      if (!shape_specs[i].empty()) {
+        const string& shape_spec = shape_specs[i];
         TensorShape shape;
         TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
 
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
+        TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(
+            shape_spec, &shape, &slice, &slice_shape));
+        if (!slice_shape.IsSameSize(tensor.shape())) {
+          return errors::InvalidArgument(
+              "Slice in shape_and_slice specification does not match the "
+              "shape of the tensor to  save: ",
+              shape_spec, ", tensor: ", tensor.shape().DebugString());
+        }
+
+        TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
       } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+        TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
       }
 
       if (VLOG_IS_ON(5)) {
@@ -160,28 +323,15 @@ class SaveV2 : public OpKernel {
 
       VLOG(2) << "Done save of " << tensor_name;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
-
-    ResourceMgr* resource_manager = context->resource_manager();
-    if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
-      OP_REQUIRES_OK(
-          context,
-          resource_manager
-              ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
-                  resource_manager->default_container(),
-                  std::string(
-                      checkpoint::kCheckpointCallbackManagerResourceName),
-                  &checkpoint_callback_manager,
-                  [](checkpoint::CheckpointCallbackManager** out) {
-                    *out = new checkpoint::CheckpointCallbackManager();
-                    return absl::OkStatus();
-                  }));
-      checkpoint_callback_manager->Save(prefix_string);
-      checkpoint_callback_manager->Unref();
-    }
+    TF_RETURN_IF_ERROR(writer.Finish());
+    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+    return absl::OkStatus();
   }
+
+  // Whether the tensors are written in the background.
+  bool async_ = false;
+  // The alignment of the tensors in the data files.
+  int data_alignment_ = 1;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -205,6 +355,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, AsyncSaves::Global()->Wait(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -268,6 +419,8 @@ class MergeV2Checkpoints : public OpKernel {
                    context->GetAttr("delete_old_dirs", &delete_old_dirs_));
     OP_REQUIRES_OK(context, context->GetAttr("allow_missing_files",
                                              &allow_missing_files_));
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar(kAsyncSaveEnvVar, false, &async_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -287,6 +440,20 @@ class MergeV2Checkpoints : public OpKernel {
         absl::Span<const tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const string& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, AsyncSaves::Global()->Wait(input_prefix));
+    }
+    if (async_ && !allow_missing_files_) {
+      // The shards saved by other processes are complete once their metadata
+      // file, written last, exists.
+      const uint64 deadline = env->NowMicros() + kMaxMergeWaitMicros;
+      for (const string& input_prefix : input_prefixes) {
+        while (!env->FileExists(MetaFilename(input_prefix)).ok() &&
+               env->NowMicros() < deadline) {
+          env->SleepForMicroseconds(100 * 1000);
+        }
+      }
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
@@ -311,6 +478,9 @@ class MergeV2Checkpoints : public OpKernel {
   // On merge, whether or not to relax condition that all input prefix filenames
   // to exist.
   bool allow_missing_files_;
+
+  // Whether the saves of the inputs may still be running in other processes.
+  bool async_ = false;
 };
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
@@ -340,5 +340,53 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, Async) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "async/part");
+  const string merged_prefix = io::JoinPath(testing::TmpDir(), "async_merged");
+  setenv("TF_SAVE_V2_ASYNC", "1", /*overwrite=*/1);
+  TF_ASSERT_OK(NodeDefBuilder("save", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT}))  // tensors
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_float"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({100}),
+                  [](int x) -> float { return static_cast<float>(x); });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The save writes a snapshot of the tensor.
+  mutable_input(3).tensor->flat<float>().setZero();
+
+  // Merging the checkpoint waits for the save.
+  TF_ASSERT_OK(NodeDefBuilder("merge", "MergeV2Checkpoints")
+                   .Input(FakeInput())  // checkpoint_prefixes
+                   .Input(FakeInput())  // destination_prefix
+                   .Attr("delete_old_dirs", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  inputs_.clear();
+  AddInput<tstring>(TensorShape({1}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({}), [&merged_prefix](int x) -> tstring {
+    return merged_prefix;
+  });
+  TF_ASSERT_OK(RunOpKernel());
+  unsetenv("TF_SAVE_V2_ASYNC");
+
+  BundleReader reader(Env::Default(), merged_prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(static_cast<float>(i), val.flat<float>()(i));
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
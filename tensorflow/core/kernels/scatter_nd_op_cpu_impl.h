@@ -20,7 +20,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
@@ -127,6 +129,12 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
+    if (d.numThreads() > 1 && batch_size >= kMinParallelUpdates &&
+        batch_size * slice_size >= kMinParallelElements) {
+      return ParallelScatter(d, output_shape_prefix, batch_strides, Tindices,
+                             Tupdates, Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -151,6 +159,81 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
 
     return error_loc;
   }
+
+ private:
+  static constexpr int64_t kMinParallelUpdates = 1024;
+  static constexpr int64_t kMinParallelElements = 1 << 16;
+
+  // Applies the updates over the threads of `d`. The output slices are split
+  // into contiguous blocks, and the updates of each block are applied in their
+  // order by a single thread, with a stable counting sort of the updates by
+  // block. Updates of the same slice are hence applied in the same order as
+  // by the serial loop, e.g. the last one wins for ASSIGN, and sums are
+  // deterministic for ADD. Returns the location of the first out-of-bounds
+  // index without updating the output, or -1.
+  static Index ParallelScatter(
+      const CPUDevice& d,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    const int64_t num_slices = Toutput.dimension(0);
+    const int64_t num_blocks =
+        std::min<int64_t>(num_slices, 4 * d.numThreads());
+
+    std::vector<Index> slices(batch_size);
+    std::vector<int64_t> block_offsets(num_blocks + 1, 0);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      Index i = 0;
+      for (int dim = 0; dim < IXDIM; ++dim) {
+        const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+        if (TF_PREDICT_FALSE(
+                !FastBoundsCheck(ix_d, output_shape_prefix[dim]))) {
+          return loc;
+        }
+        i += ix_d * batch_strides[dim];
+      }
+      slices[loc] = i;
+      ++block_offsets[i * num_blocks / num_slices + 1];
+    }
+    for (int64_t block = 0; block < num_blocks; ++block) {
+      block_offsets[block + 1] += block_offsets[block];
+    }
+    std::vector<int64_t> positions(block_offsets.begin(),
+                                   block_offsets.end() - 1);
+    std::vector<Eigen::DenseIndex> sorted_locs(batch_size);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      sorted_locs[positions[slices[loc] * num_blocks / num_slices]++] = loc;
+    }
+
+    // Each block is applied on a single thread.
+    const Eigen::DefaultDevice device;
+    auto update_blocks = [&](Eigen::Index begin, Eigen::Index end) {
+      for (Eigen::Index block = begin; block < end; ++block) {
+        for (int64_t j = block_offsets[block]; j < block_offsets[block + 1];
+             ++j) {
+          const Eigen::DenseIndex loc = sorted_locs[j];
+          auto input_chip = Toutput.template chip<0>(slices[loc]);
+          auto output_chip = input_chip;
+          auto update_chip = Tupdates.template chip<0>(loc);
+          update_executor::UpdateExecutor<
+              Eigen::DefaultDevice, decltype(input_chip),
+              decltype(update_chip), decltype(output_chip),
+              OP>::Execute(device, input_chip, update_chip, output_chip);
+        }
+      }
+    };
+    const double bytes_per_block = static_cast<double>(batch_size) *
+                                   Toutput.dimension(1) * sizeof(T) /
+                                   num_blocks;
+    d.parallelFor(num_blocks,
+                  Eigen::TensorOpCost(bytes_per_block, bytes_per_block,
+                                      bytes_per_block),
+                  update_blocks);
+    return -1;
+  }
 };
 
 #define REGISTER_SCATTER_ND_FULL(T, Index, op)                               \
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -240,6 +241,94 @@ TEST_F(ScatterNdUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+class ScatterNdManyUpdatesOpTest : public OpsTestBase {
+ protected:
+  static constexpr int kRows = 100;
+  static constexpr int kCols = 16;
+  static constexpr int kNumUpdates = 8192;
+
+  // Runs `op` on zeros with kNumUpdates updates of random rows, many of them
+  // duplicates, enough to be applied in parallel. Returns the indices.
+  std::vector<int32> RunManyUpdates(const char* op, std::vector<float>* updates,
+                                    int bad_index_at = -1) {
+    TF_CHECK_OK(NodeDefBuilder("myop", op)
+                    .Input(FakeInput(DT_FLOAT_REF))
+                    .Input(FakeInput(DT_INT32))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    random::PhiloxRandom philox(301, 17);
+    random::SimplePhilox rnd(&philox);
+    std::vector<int32> indices;
+    for (int i = 0; i < kNumUpdates; ++i) {
+      indices.push_back(i == bad_index_at ? kRows : rnd.Uniform(kRows));
+      for (int j = 0; j < kCols; ++j) {
+        updates->push_back(static_cast<float>(rnd.Uniform(64)) - 32);
+      }
+    }
+    AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                             std::vector<float>(kRows * kCols, 0.0f));
+    AddInputFromArray<int32>(TensorShape({kNumUpdates, 1}), indices);
+    AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), *updates);
+    status_ = RunOpKernel();
+    return indices;
+  }
+
+  Status status_;
+};
+
+TEST_F(ScatterNdManyUpdatesOpTest, Update) {
+  std::vector<float> updates;
+  std::vector<int32> indices = RunManyUpdates("ScatterNdUpdate", &updates);
+  TF_ASSERT_OK(status_);
+  // The last update of each row wins.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  expected.flat<float>().setZero();
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected.matrix<float>()(indices[i], j) = updates[i * kCols + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterNdManyUpdatesOpTest, Add) {
+  std::vector<float> updates;
+  std::vector<int32> indices = RunManyUpdates("ScatterNdAdd", &updates);
+  TF_ASSERT_OK(status_);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  expected.flat<float>().setZero();
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected.matrix<float>()(indices[i], j) += updates[i * kCols + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterNdManyUpdatesOpTest, Max) {
+  std::vector<float> updates;
+  std::vector<int32> indices = RunManyUpdates("ScatterNdMax", &updates);
+  TF_ASSERT_OK(status_);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  expected.flat<float>().setZero();
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      float& value = expected.matrix<float>()(indices[i], j);
+      value = std::max(value, updates[i * kCols + j]);
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterNdManyUpdatesOpTest, Error_IndexOutOfRange) {
+  std::vector<float> updates;
+  RunManyUpdates("ScatterNdAdd", &updates, /*bad_index_at=*/5000);
+  EXPECT_TRUE(absl::StrContains(
+      status_.ToString(), "indices[5000] = [100] does not index into shape"))
+      << status_;
+}
+
 class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
  public:
   void TestBody() override {}
@@ -255,14 +344,14 @@ class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
 
 template <typename Index>
 void BM_ScatterNdHelper(::testing::benchmark::State& state, int embedding_size,
-                        const char* op) {
+                        const char* op, int num_updates = 1000) {
   const int kRows = 10000000 / embedding_size;
   std::vector<float> values;
   values.reserve(kRows);
   for (int i = 0; i < kRows * embedding_size; i++) {
     values.push_back(i);
   }
-  const int kNumUpdates = 1000;
+  const int kNumUpdates = num_updates;
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices;
@@ -325,5 +414,22 @@ BENCHMARK(BM_ScatterNdUpdateInt64)
 BENCHMARK(BM_ScatterNdAddInt32)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 BENCHMARK(BM_ScatterNdAddInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 
+// Enough updates to be applied in parallel.
+void BM_ScatterNdUpdateManyUpdates(::testing::benchmark::State& state) {
+  const int embedding_size = state.range(0);
+
+  BM_ScatterNdHelper<int32>(state, embedding_size, "ScatterNdUpdate",
+                            /*num_updates=*/100000);
+}
+void BM_ScatterNdAddManyUpdates(::testing::benchmark::State& state) {
+  const int embedding_size = state.range(0);
+
+  BM_ScatterNdHelper<int32>(state, embedding_size, "ScatterNdAdd",
+                            /*num_updates=*/100000);
+}
+
+BENCHMARK(BM_ScatterNdUpdateManyUpdates)->Arg(1)->Arg(10)->Arg(64);
+BENCHMARK(BM_ScatterNdAddManyUpdates)->Arg(1)->Arg(10)->Arg(64);
+
 }  // namespace
 }  // namespace tensorflow
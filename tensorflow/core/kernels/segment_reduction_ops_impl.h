@@ -27,6 +27,12 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/prefetch.h"
 #include "absl/container/flat_hash_map.h"
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -41,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
 
@@ -606,6 +613,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    if (num_threads > 1 && num_indices * num_col >= 2 * kMinElementsPerShard) {
+      ReduceInParallel(context, input_flat, indices_vec, segment_vec,
+                       output_rows, output_flat);
+      return;
+    }
+
     Tensor temp;
     if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
       temp = tensorflow::Tensor(DT_FLOAT, output_shape);
@@ -677,6 +692,154 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // Minimum number of input elements reduced by a shard of the parallel
+  // implementation.
+  static constexpr int64_t kMinElementsPerShard = 16384;
+
+  // The input rows of the indices this far ahead are prefetched.
+  static constexpr int kPrefetchDistance = 8;
+
+  using Accumulator =
+      typename std::conditional<std::is_same<T, bfloat16>::value ||
+                                    std::is_same<T, Eigen::half>::value,
+                                float, T>::type;
+
+  // Reduces the segments on the worker threads. The output rows are split
+  // into shards of about the same number of indices, aligned on segment
+  // boundaries, and the input rows of each segment are accumulated with
+  // vectorized adds while the rows of the next indices are prefetched. When
+  // the segment ids are unique, the input rows are copied without any
+  // accumulation.
+  void ReduceInParallel(OpKernelContext* context,
+                        const typename TTypes<T>::ConstMatrix& input_flat,
+                        const typename TTypes<Index>::ConstVec& indices_vec,
+                        const typename TTypes<SegmentId>::ConstVec& segment_vec,
+                        int64_t output_rows,
+                        typename TTypes<T>::Matrix output_flat) {
+    const int64_t num_indices = indices_vec.dimension(0);
+    const int64_t num_col = output_flat.dimension(1);
+    const int64_t input_rows = input_flat.dimension(0);
+
+    // The shards rely on the segment ids being sorted, so they are validated
+    // up front.
+    std::vector<SegmentId> segments(num_indices);
+    bool unique_segments = true;
+    for (int64_t i = 0; i < num_indices; ++i) {
+      segments[i] = internal::SubtleMustCopy(segment_vec(i));
+      if (i > 0) {
+        OP_REQUIRES(context, segments[i - 1] <= segments[i],
+                    errors::InvalidArgument("segment ids are not increasing"));
+        unique_segments &= segments[i - 1] < segments[i];
+      }
+      OP_REQUIRES(
+          context, FastBoundsCheck(segments[i], output_rows),
+          errors::InvalidArgument(
+              "Segment id ", segments[i], " out of range [0, ", output_rows,
+              "), possibly because 'segment_ids' input is not sorted."));
+    }
+
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    const int64_t num_shards =
+        std::clamp<int64_t>(num_indices * num_col / kMinElementsPerShard, 1,
+                            4 * static_cast<int64_t>(num_threads));
+    // Shard s reduces the output rows [shard_rows[s], shard_rows[s + 1]) from
+    // the indices [shard_indices[s], shard_indices[s + 1]).
+    std::vector<int64_t> shard_rows(num_shards + 1);
+    std::vector<int64_t> shard_indices(num_shards + 1);
+    shard_rows[num_shards] = output_rows;
+    shard_indices[num_shards] = num_indices;
+    for (int64_t s = 1; s < num_shards; ++s) {
+      shard_rows[s] = segments[num_indices * s / num_shards];
+      shard_indices[s] =
+          std::lower_bound(segments.begin(), segments.end(), shard_rows[s]) -
+          segments.begin();
+    }
+
+    // The position of the first out of range index of each shard, if any.
+    std::vector<int64_t> bad_offsets(num_shards, -1);
+    auto reduce_shard = [&](int64_t s) {
+      constexpr bool kAccumulateInOutput = std::is_same<Accumulator, T>::value;
+      std::vector<Accumulator> buffer;
+      if (!kAccumulateInOutput) buffer.resize(num_col);
+      int64_t j = shard_indices[s];
+      const int64_t end = shard_indices[s + 1];
+      for (int64_t row = shard_rows[s]; row < shard_rows[s + 1]; ++row) {
+        T* output_row = &output_flat(row, 0);
+        if (j == end || segments[j] != row) {
+          std::fill_n(output_row, num_col, default_value_);
+          continue;
+        }
+        if (unique_segments) {
+          const Index index = internal::SubtleMustCopy(indices_vec(j));
+          if (!FastBoundsCheck(index, input_rows)) {
+            bad_offsets[s] = j;
+            return;
+          }
+          if (j + kPrefetchDistance < end) {
+            PrefetchRow(input_flat, indices_vec(j + kPrefetchDistance));
+          }
+          std::copy_n(&input_flat(index, 0), num_col, output_row);
+          ++j;
+          continue;
+        }
+        Accumulator* sum_data = buffer.data();
+        if constexpr (kAccumulateInOutput) sum_data = output_row;
+        Eigen::Map<Eigen::Array<Accumulator, Eigen::Dynamic, 1>> sum(sum_data,
+                                                                     num_col);
+        const int64_t segment_begin = j;
+        for (; j < end && segments[j] == row; ++j) {
+          if (j + kPrefetchDistance < end) {
+            PrefetchRow(input_flat, indices_vec(j + kPrefetchDistance));
+          }
+          const Index index = internal::SubtleMustCopy(indices_vec(j));
+          if (!FastBoundsCheck(index, input_rows)) {
+            bad_offsets[s] = j;
+            return;
+          }
+          Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> input_row(
+              &input_flat(index, 0), num_col);
+          if (j == segment_begin) {
+            sum = input_row.template cast<Accumulator>();
+          } else {
+            sum += input_row.template cast<Accumulator>();
+          }
+        }
+        const int64_t count = j - segment_begin;
+        if (is_mean_ && count > 1) {
+          sum /= static_cast<Accumulator>(count);
+        } else if (is_sqrtn_ && count > 1) {
+          sum /= static_cast<Accumulator>(std::sqrt(count));
+        }
+        if constexpr (!kAccumulateInOutput) {
+          Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>(output_row, num_col) =
+              sum.template cast<T>();
+        }
+      }
+    };
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_shards, num_indices * num_col / num_shards,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t s = begin; s < end; ++s) reduce_shard(s);
+        });
+
+    for (int64_t s = 0; s < num_shards; ++s) {
+      const int64_t bad_offset = bad_offsets[s];
+      OP_REQUIRES(context, bad_offset < 0,
+                  errors::InvalidArgument(
+                      "Bad: indices[", bad_offset, "] == ",
+                      indices_vec(bad_offset), " out of range [0, ",
+                      input_rows, ")"));
+    }
+  }
+
+  static void PrefetchRow(const typename TTypes<T>::ConstMatrix& input_flat,
+                          Index index) {
+    if (FastBoundsCheck(index, input_flat.dimension(0))) {
+      absl::PrefetchToLocalCache(&input_flat(index, 0));
+    }
+  }
+
   const DataType dtidx_;
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
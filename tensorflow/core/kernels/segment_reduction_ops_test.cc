@@ -290,4 +290,47 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+// Reduces `ids_per_segment` rows of a 100000 x `embedding_dim` table for each
+// of the `batch_size` segments.
+static void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int embedding_dim = state.range(1);
+  const int ids_per_segment = state.range(2);
+  const int kNumRows = 100000;
+  const int num_indices = batch_size * ids_per_segment;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, embedding_dim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (i * 7919) % kNumRows;
+    segments_flat(i) = i / ids_per_segment;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * embedding_dim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSum)
+    ->UseRealTime()
+    ->Args({1024, 16, 1})
+    ->Args({1024, 16, 20})
+    ->Args({1024, 64, 20})
+    ->Args({16384, 16, 1})
+    ->Args({16384, 16, 20})
+    ->Args({16384, 64, 20});
+
 }  // namespace tensorflow
@@ -326,6 +326,80 @@ class StringCrosser {
   const tstring k_feature_separator_;
 };
 
+// Fingerprints of the features of one batch row, reused across the rows
+// crossed by a shard.
+using RowFingerprints = gtl::InlinedVector<std::vector<uint64>, 6>;
+
+// Returns the bucket of a cross fingerprint as an int64 based on the number
+// of buckets.
+inline int64_t BucketizeFingerprint(uint64 hashed_output,
+                                    const int64_t num_buckets) {
+  if (num_buckets > 0) {
+    return hashed_output % num_buckets;
+  } else {
+    // To prevent negative output we take modulo to max int64.
+    return hashed_output % std::numeric_limits<int64_t>::max();
+  }
+}
+
+// Writes all the hashed crosses of a batch row in the order of
+// ProductIterator. The features of the row are fingerprinted once instead of
+// once per cross, and the fingerprint of each prefix of a cross is shared by
+// all the crosses that extend it, so that a cross costs a single
+// FingerprintCat64 on average. If `seed` is not null the first feature is
+// concatenated to it, otherwise the fingerprint starts from the first feature.
+void GenerateHashedCrosses(
+    const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
+    const int64_t batch_index, bool strong_hash, const uint64* seed,
+    const int64_t num_buckets, const OutputUpdater<int64_t>& updater,
+    RowFingerprints* fingerprints) {
+  const int num_columns = columns.size();
+  if (num_columns == 0) {
+    updater.Update(batch_index, 0,
+                   BucketizeFingerprint(seed ? *seed : 0, num_buckets));
+    return;
+  }
+  fingerprints->resize(num_columns);
+  for (int i = 0; i < num_columns; ++i) {
+    const int64_t feature_count = columns[i]->FeatureCount(batch_index);
+    if (feature_count == 0) return;
+    std::vector<uint64>& column_fingerprints = (*fingerprints)[i];
+    column_fingerprints.resize(feature_count);
+    for (int64_t n = 0; n < feature_count; ++n) {
+      column_fingerprints[n] =
+          columns[i]->Feature(batch_index, n, strong_hash);
+    }
+  }
+
+  gtl::InlinedVector<size_t, 6> position(num_columns, 0);
+  gtl::InlinedVector<uint64, 6> prefix(num_columns);
+  // Recomputes the prefix fingerprints from column `i` onwards.
+  auto update_prefix = [&](int i) {
+    for (; i < num_columns; ++i) {
+      const uint64 hash_i = (*fingerprints)[i][position[i]];
+      if (i > 0) {
+        prefix[i] = FingerprintCat64(prefix[i - 1], hash_i);
+      } else {
+        prefix[i] = seed ? FingerprintCat64(*seed, hash_i) : hash_i;
+      }
+    }
+  };
+  update_prefix(0);
+  int64_t cross_count = 0;
+  while (true) {
+    updater.Update(batch_index, cross_count++,
+                   BucketizeFingerprint(prefix.back(), num_buckets));
+    // Advances to the next permutation, the last column varying fastest.
+    int i = num_columns - 1;
+    while (i >= 0 && ++position[i] == (*fingerprints)[i].size()) {
+      position[i] = 0;
+      --i;
+    }
+    if (i < 0) break;
+    update_prefix(i);
+  }
+}
+
 // Generates the sparse crosses as nested hash to avoid string manipulations.
 class HashCrosser {
  public:
@@ -353,6 +427,15 @@ class HashCrosser {
     }
   }
 
+  // Writes all the crosses of a batch row, as Generate would for each
+  // permutation of ProductIterator.
+  void GenerateRow(const int64_t batch_index, bool unused_strong_hash,
+                   const OutputUpdater<int64_t>& updater,
+                   RowFingerprints* fingerprints) const {
+    GenerateHashedCrosses(columns_, batch_index, /*strong_hash=*/false,
+                          &hash_key_, num_buckets_, updater, fingerprints);
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
@@ -388,6 +471,15 @@ class HashCrosserV2 {
     }
   }
 
+  // Writes all the crosses of a batch row, as Generate would for each
+  // permutation of ProductIterator.
+  void GenerateRow(const int64_t batch_index, bool strong_hash,
+                   const OutputUpdater<int64_t>& updater,
+                   RowFingerprints* fingerprints) const {
+    GenerateHashedCrosses(columns_, batch_index, strong_hash, /*seed=*/nullptr,
+                          num_buckets_, updater, fingerprints);
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
@@ -786,14 +878,21 @@ class SparseCrossOp : public OpKernel {
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater updater(
         output_start_indices, indices_out, values_out);
     auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<InternalType> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
+      if constexpr (HASHED_OUTPUT) {
+        RowFingerprints fingerprints;
+        for (int b = begin; b < end; b++) {
+          crosser.GenerateRow(b, false, updater, &fingerprints);
+        }
+      } else {
+        for (int b = begin; b < end; b++) {
+          ProductIterator<InternalType> product_iterator(columns, b);
+          int64_t cross_count = 0;
+          while (product_iterator.HasNext()) {
+            const auto permutation = product_iterator.Next();
+            updater.Update(b, cross_count,
+                           crosser.Generate(b, permutation, false));
+            cross_count++;
+          }
         }
       }
     };
@@ -935,17 +1034,11 @@ class SparseCrossHashedOp : public OpKernel {
     HashCrosserV2 crosser(columns, num_buckets, 0, unused_sep);
     OutputUpdater<int64_t> updater(output_start_indices, indices_out,
                                    values_out);
-    auto do_work = [&columns, crosser, updater, strong_hash](int64_t begin,
-                                                             int64_t end) {
+    auto do_work = [crosser, updater, strong_hash](int64_t begin,
+                                                   int64_t end) {
+      RowFingerprints fingerprints;
       for (int b = begin; b < end; b++) {
-        ProductIterator<int64_t> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, strong_hash));
-          cross_count++;
-        }
+        crosser.GenerateRow(b, strong_hash, updater, &fingerprints);
       }
     };
 
@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -264,10 +268,6 @@ Status SparseTensorDenseMatMulImpl(
   const int lhs_index_a = ADJ_A ? 1 : 0;
   const int rhs_index_a = ADJ_A ? 0 : 1;
 
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
-
   if (rhs_right < kNumVectorize) {
     // Disable vectorization if the RHS of output is too small
     auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
@@ -321,6 +321,130 @@ Status SparseTensorDenseMatMulImpl(
   }
   return absl::OkStatus();
 }
+
+// The minimum number of multiply-adds for SparseTensorDenseMatMulCsrImpl to
+// be worth sorting the nonzeros of A and sharding the product.
+constexpr int64_t kMinCsrMultiplyAdds = 1 << 16;
+
+// Multiplies the rows of A in parallel, once its nonzeros are sorted by row
+// into compressed sparse row (CSR) form. The work is split into blocks of rows
+// with about as many nonzeros each, and into tiles of columns of the output;
+// the tile of an output row stays in cache, and its inner loop is vectorized,
+// across the nonzeros of the row. The sort is stable, so that each output
+// element sums the same products in the same order as
+// SparseTensorDenseMatMulImpl.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCsrImpl(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  static constexpr int64_t kColumnTile = 512;
+
+  const int64_t nnz = a_values.size();
+  const int64_t num_rows = out.dimension(0);
+  const int64_t rhs_right = ADJ_B ? b.dimension(0) : b.dimension(1);
+  const int64_t lhs_right = ADJ_B ? b.dimension(1) : b.dimension(0);
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+
+  std::vector<int64_t> row_offsets(num_rows + 1, 0);
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++row_offsets[m + 1];
+  }
+  for (int64_t m = 0; m < num_rows; ++m) {
+    row_offsets[m + 1] += row_offsets[m];
+  }
+  std::vector<int64_t> positions(row_offsets.begin(), row_offsets.end() - 1);
+  std::vector<Tindices> csr_cols(nnz);
+  std::vector<Tsum> csr_values(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const int64_t position = positions[rows[i]]++;
+    csr_cols[position] = cols[i];
+    csr_values[position] =
+        static_cast<Tsum>(ADJ_A ? MaybeConj(a_values(i)) : a_values(i));
+  }
+
+  // Transposes and conjugates B once, for the rows of B to be contiguous.
+  const T* b_data = b.data();
+  Tensor b_adjoint_t;
+  if (ADJ_B) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({lhs_right, rhs_right}),
+                                          &b_adjoint_t));
+    Eigen::array<int, 2> shuffle(1, 0);
+    b_adjoint_t.matrix<T>().device(ctx->eigen_device<CPUDevice>()) =
+        b.shuffle(shuffle).conjugate();
+    b_data = b_adjoint_t.matrix<T>().data();
+  }
+
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  const int64_t num_tiles = (rhs_right + kColumnTile - 1) / kColumnTile;
+  const int64_t num_blocks =
+      std::min<int64_t>(num_rows, 4 * worker_threads.num_threads);
+  // The first row of each block, the first whose nonzeros start at or after
+  // the share of the block. The rows after the last block have no nonzeros.
+  std::vector<int64_t> block_rows(num_blocks + 1);
+  for (int64_t block = 0; block <= num_blocks; ++block) {
+    block_rows[block] =
+        std::lower_bound(row_offsets.begin(), row_offsets.end(),
+                         block * nnz / num_blocks) -
+        row_offsets.begin();
+  }
+  Tsum* out_data = out.data();
+  auto multiply = [&](int64_t begin, int64_t end) {
+    for (int64_t unit = begin; unit < end; ++unit) {
+      const int64_t block = unit / num_tiles;
+      const int64_t col_begin = unit % num_tiles * kColumnTile;
+      const int64_t col_end = std::min(col_begin + kColumnTile, rhs_right);
+      for (int64_t m = block_rows[block]; m < block_rows[block + 1]; ++m) {
+        Tsum* out_row = out_data + m * rhs_right;
+        for (int64_t j = row_offsets[m]; j < row_offsets[m + 1]; ++j) {
+          const Tsum a_value = csr_values[j];
+          const T* b_row =
+              b_data + static_cast<int64_t>(csr_cols[j]) * rhs_right;
+          for (int64_t n = col_begin; n < col_end; ++n) {
+            out_row[n] += a_value * static_cast<Tsum>(b_row[n]);
+          }
+        }
+      }
+    }
+  };
+  const int64_t cost_per_unit =
+      std::max<int64_t>(1, nnz / num_blocks * std::min(kColumnTile, rhs_right));
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_blocks * num_tiles, cost_per_unit, multiply);
+  return absl::OkStatus();
+}
+
+// Multiplies with SparseTensorDenseMatMulCsrImpl when there are threads to
+// share enough work, or SparseTensorDenseMatMulImpl otherwise.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCpu(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const int64_t multiply_adds = a_values.size() * out.dimension(1);
+  if (ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1 &&
+      multiply_adds >= kMinCsrMultiplyAdds) {
+    return SparseTensorDenseMatMulCsrImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        ctx, out, a_indices, a_values, b);
+  }
+  return SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+      out, a_indices, a_values, b);
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -338,8 +462,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+          SparseTensorDenseMatMulCpu<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -348,8 +472,8 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          SparseTensorDenseMatMulCpu<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+              ctx, out_workaround, a_indices, a_values, b));
     }
     return OkStatus();
   }
@@ -120,4 +120,9 @@ BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, true);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, true);
 
+// Wide models: a large batch of sparse features times narrow embeddings.
+BM_SparseTensorDenseMatmul(262144, 8192, 65536, 16, false, false);
+BM_SparseTensorDenseMatmul(262144, 8192, 65536, 64, false, false);
+BM_SparseTensorDenseMatmul(262144, 8192, 65536, 64, false, true);
+
 }  // end namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -22,9 +24,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace text {
@@ -578,6 +582,32 @@ TEST_F(NgramKernelTest, TestNoTokensNoPad) {
   assert_int64_equal(expected_splits, *GetOutput(1));
 }
 
+TEST_F(NgramKernelTest, TestManyBatchItems) {
+  MakeOp("|", {2}, "LP", "RP", -1, false);
+  // Each batch item is "a", "b", "c", possibly created on different threads.
+  constexpr int kNumItems = 10000;
+  std::vector<tstring> data;
+  std::vector<int64_t> splits = {0};
+  for (int i = 0; i < kNumItems; ++i) {
+    data.insert(data.end(), {"a", "b", "c"});
+    splits.push_back(splits.back() + 3);
+  }
+  AddInputFromArray<tstring>(TensorShape({3 * kNumItems}), data);
+  AddInputFromArray<int64_t>(TensorShape({kNumItems + 1}), splits);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<tstring> expected_values;
+  std::vector<int64_t> expected_splits = {0};
+  for (int i = 0; i < kNumItems; ++i) {
+    expected_values.insert(expected_values.end(),
+                           {"LP|a", "a|b", "b|c", "c|RP"});
+    expected_splits.push_back(expected_splits.back() + 4);
+  }
+
+  assert_string_equal(expected_values, *GetOutput(0));
+  assert_int64_equal(expected_splits, *GetOutput(1));
+}
+
 TEST_F(NgramKernelTest, ShapeFn) {
   ShapeInferenceTestOp op("StringNGrams");
   INFER_OK(op, "?;?", "[?];[?]");
@@ -587,5 +617,35 @@ TEST_F(NgramKernelTest, ShapeFn) {
   INFER_ERROR("Shape must be rank 1 but is rank 0", op, "?;[]");
 }
 
+static void BM_StringNGrams(::testing::benchmark::State& state) {
+  const int num_items = state.range(0);
+  constexpr int kTokensPerItem = 16;
+  Tensor data(DT_STRING, TensorShape({num_items * kTokensPerItem}));
+  auto data_flat = data.flat<tstring>();
+  for (int i = 0; i < data_flat.size(); ++i) {
+    data_flat(i) = absl::StrCat("token", i % 1000);
+  }
+  Tensor splits(DT_INT64, TensorShape({num_items + 1}));
+  auto splits_flat = splits.flat<int64_t>();
+  for (int i = 0; i <= num_items; ++i) splits_flat(i) = i * kTokensPerItem;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(NodeBuilder("string_ngrams_op", "StringNGrams")
+                  .Input(test::graph::Constant(g, data))
+                  .Input(test::graph::Constant(g, splits))
+                  .Attr("separator", " ")
+                  .Attr("ngram_widths", std::vector<int>{1, 2, 3})
+                  .Attr("left_pad", "")
+                  .Attr("right_pad", "")
+                  .Attr("pad_width", 0)
+                  .Attr("preserve_short_sequences", false)
+                  .Finalize(g, nullptr /* node */));
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_items);
+}
+
+BENCHMARK(BM_StringNGrams)->UseRealTime()->Arg(1)->Arg(64)->Arg(4096);
+
 }  // namespace text
 }  // namespace tensorflow
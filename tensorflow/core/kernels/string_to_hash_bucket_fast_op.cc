@@ -22,4 +22,8 @@ namespace tensorflow {
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketFast").Device(DEVICE_CPU),
                         StringToHashBucketOp<Fingerprint64>);
 
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedStringToHashBucketFast").Device(DEVICE_CPU),
+    FusedStringToHashBucketOp<Fingerprint64>);
+
 }  // namespace tensorflow
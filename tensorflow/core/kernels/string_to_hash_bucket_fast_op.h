@@ -16,16 +16,43 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Hashing a short string costs a few hundred cycles.
+constexpr int64_t kStringHashBucketCostPerElement = 200;
+
+// Computes the hash buckets of the `size` strings of `input` into `output`,
+// sharding the strings over the worker threads.
+template <typename Hash>
+void ComputeHashBuckets(OpKernelContext* context, const tstring* input,
+                        int64_t size, int64_t num_buckets, const Hash& hash,
+                        int64_t* output) {
+  auto work = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const uint64 bucket_id = hash(input[i]) % num_buckets;
+      // The number of buckets is always in the positive range of int64 so is
+      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
+      // safe.
+      output[i] = static_cast<int64_t>(bucket_id);
+    }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, size,
+        kStringHashBucketCostPerElement, work);
+}
+
 template <uint64 hash(StringPiece)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -42,17 +69,10 @@ class StringToHashBucketOp : public OpKernel {
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64_t>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
-    }
+    ComputeHashBuckets(
+        context, input_flat.data(), input_flat.size(), num_buckets_,
+        [](const tstring& input) { return hash(input); },
+        output_tensor->flat<int64_t>().data());
   }
 
  private:
@@ -62,6 +82,68 @@ class StringToHashBucketOp : public OpKernel {
   void operator=(const StringToHashBucketOp&) = delete;
 };
 
+// Computes the hash buckets of the N inputs of a fused op into its N outputs,
+// sharding the elements of all the inputs over the worker threads, so that
+// many small inputs are hashed in parallel in a single kernel invocation.
+template <typename Hash>
+void ComputeFusedHashBuckets(OpKernelContext* context, int64_t num_buckets,
+                             const Hash& hash) {
+  OpInputList inputs;
+  OP_REQUIRES_OK(context, context->input_list("input", &inputs));
+  OpOutputList outputs;
+  OP_REQUIRES_OK(context, context->output_list("output", &outputs));
+
+  const int num_inputs = inputs.size();
+  std::vector<const tstring*> input_data(num_inputs);
+  std::vector<int64_t*> output_data(num_inputs);
+  // offsets[i] is the position of the first element of input i in the
+  // concatenation of all the inputs.
+  std::vector<int64_t> offsets(num_inputs + 1, 0);
+  for (int i = 0; i < num_inputs; ++i) {
+    Tensor* output_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   outputs.allocate(i, inputs[i].shape(), &output_tensor));
+    input_data[i] = inputs[i].flat<tstring>().data();
+    output_data[i] = output_tensor->flat<int64_t>().data();
+    offsets[i + 1] = offsets[i] + inputs[i].NumElements();
+  }
+
+  auto work = [&](int64_t begin, int64_t end) {
+    int i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+            offsets.begin() - 1;
+    for (int64_t j = begin; j < end; ++j) {
+      while (j >= offsets[i + 1]) ++i;
+      const int64_t element = j - offsets[i];
+      const uint64 bucket_id = hash(input_data[i][element]) % num_buckets;
+      output_data[i][element] = static_cast<int64_t>(bucket_id);
+    }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        offsets[num_inputs], kStringHashBucketCostPerElement, work);
+}
+
+template <uint64 hash(StringPiece)>
+class FusedStringToHashBucketOp : public OpKernel {
+ public:
+  explicit FusedStringToHashBucketOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_buckets", &num_buckets_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    ComputeFusedHashBuckets(
+        context, num_buckets_,
+        [](const tstring& input) { return hash(input); });
+  }
+
+ private:
+  int64_t num_buckets_;
+
+  FusedStringToHashBucketOp(const FusedStringToHashBucketOp&) = delete;
+  void operator=(const FusedStringToHashBucketOp&) = delete;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
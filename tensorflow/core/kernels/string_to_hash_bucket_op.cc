@@ -38,17 +38,10 @@ class LegacyStringToHashBucketOp : public OpKernel {
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64_t>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = Hash64(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
-    }
+    ComputeHashBuckets(
+        context, input_flat.data(), input_flat.size(), num_buckets_,
+        [](const tstring& input) { return Hash64(input); },
+        output_tensor->flat<int64_t>().data());
   }
 
  private:
@@ -65,4 +58,8 @@ REGISTER_KERNEL_BUILDER(Name("StringToHashBucket").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketStrong").Device(DEVICE_CPU),
                         StringToKeyedHashBucketOp<StrongKeyedHash>);
 
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedStringToHashBucketStrong").Device(DEVICE_CPU),
+    FusedStringToKeyedHashBucketOp<StrongKeyedHash>);
+
 }  // namespace tensorflow
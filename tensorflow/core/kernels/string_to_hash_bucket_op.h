@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/string_to_hash_bucket_fast_op.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -49,17 +50,10 @@ class StringToKeyedHashBucketOp : public OpKernel {
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64_t>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
-    }
+    ComputeHashBuckets(
+        context, input_flat.data(), input_flat.size(), num_buckets_,
+        [this](const tstring& input) { return hash(key_, input); },
+        output_tensor->flat<int64_t>().data());
   }
 
  private:
@@ -70,6 +64,35 @@ class StringToKeyedHashBucketOp : public OpKernel {
   void operator=(const StringToKeyedHashBucketOp&) = delete;
 };
 
+template <uint64 hash(const uint64 (&)[2], const string&)>
+class FusedStringToKeyedHashBucketOp : public OpKernel {
+ public:
+  explicit FusedStringToKeyedHashBucketOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_buckets", &num_buckets_));
+
+    std::vector<int64_t> key;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("key", &key));
+    OP_REQUIRES(ctx, key.size() == 2,
+                errors::InvalidArgument("Key must have 2 elements"));
+    std::memcpy(key_, key.data(), sizeof(key_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    ComputeFusedHashBuckets(
+        context, num_buckets_,
+        [this](const tstring& input) { return hash(key_, input); });
+  }
+
+ private:
+  int64_t num_buckets_;
+  uint64 key_[2];
+
+  FusedStringToKeyedHashBucketOp(const FusedStringToKeyedHashBucketOp&) =
+      delete;
+  void operator=(const FusedStringToKeyedHashBucketOp&) = delete;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_OP_H_
@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns `num_strings` short strings, as the ids of categorical features.
+Tensor FeatureStrings(int num_strings) {
+  Tensor strings(DT_STRING, TensorShape({num_strings}));
+  auto strings_flat = strings.flat<tstring>();
+  for (int i = 0; i < num_strings; ++i) {
+    strings_flat(i) = absl::StrCat("feature_", i);
+  }
+  return strings;
+}
+
+class StringToHashBucketOpTest : public OpsTestBase {};
+
+TEST_F(StringToHashBucketOpTest, HashesManyStrings) {
+  TF_ASSERT_OK(NodeDefBuilder("hash", "StringToHashBucketFast")
+                   .Input(FakeInput(DT_STRING))
+                   .Attr("num_buckets", 1000)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  constexpr int kNumStrings = 100000;
+  const Tensor strings = FeatureStrings(kNumStrings);
+  const tstring* data = strings.flat<tstring>().data();
+  AddInputFromArray<tstring>(strings.shape(), std::vector<tstring>(
+                                                  data, data + kNumStrings));
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_INT64, strings.shape());
+  for (int i = 0; i < kNumStrings; ++i) {
+    expected.flat<int64_t>()(i) =
+        Fingerprint64(strings.flat<tstring>()(i)) % 1000;
+  }
+  test::ExpectTensorEqual<int64_t>(expected, *GetOutput(0));
+}
+
+Graph* StringToHashBucketGraph(const string& op, int num_strings) {
+  Graph* g = new Graph(OpRegistry::Global());
+  NodeBuilder builder("hash", op);
+  builder.Input(test::graph::Constant(g, FeatureStrings(num_strings)))
+      .Attr("num_buckets", 1 << 20);
+  if (op == "StringToHashBucketStrong") {
+    builder.Attr("key", std::vector<int64_t>{1, 2});
+  }
+  TF_CHECK_OK(builder.Finalize(g, nullptr /* node */));
+  return g;
+}
+
+static void BM_StringToHashBucketFast(::testing::benchmark::State& state) {
+  const int num_strings = state.range(0);
+  test::Benchmark("cpu",
+                  StringToHashBucketGraph("StringToHashBucketFast",
+                                          num_strings),
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_strings);
+}
+
+BENCHMARK(BM_StringToHashBucketFast)
+    ->UseRealTime()
+    ->Arg(16)
+    ->Arg(1024)
+    ->Arg(65536)
+    ->Arg(1 << 20);
+
+static void BM_StringToHashBucketStrong(::testing::benchmark::State& state) {
+  const int num_strings = state.range(0);
+  test::Benchmark("cpu",
+                  StringToHashBucketGraph("StringToHashBucketStrong",
+                                          num_strings),
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_strings);
+}
+
+BENCHMARK(BM_StringToHashBucketStrong)
+    ->UseRealTime()
+    ->Arg(16)
+    ->Arg(1024)
+    ->Arg(65536)
+    ->Arg(1 << 20);
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 #define TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -127,13 +128,18 @@ class TensorList {
   const std::vector<Tensor>& tensors() const { return tensors_->values_; }
 
   // Get a new TensorList containing a copy of the underlying tensor container.
-  TensorList Copy() const {
+  // The copy has room for at least `capacity` tensors, so that callers about
+  // to add tensors to it don't reallocate it right after the copy.
+  TensorList Copy(size_t capacity = 0) const {
     TensorList out;
     out.element_shape = element_shape;
     out.element_dtype = element_dtype;
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
-    out.tensors_->values_ = tensors_->values_;
+    out.tensors_->values_.reserve(
+        std::max(capacity, tensors_->values_.size()));
+    out.tensors_->values_.assign(tensors_->values_.begin(),
+                                 tensors_->values_.end());
     return out;
   }
 
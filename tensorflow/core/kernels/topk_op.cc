@@ -129,6 +129,27 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace {
+
+// Orders the columns of a row by decreasing value, and the columns of equal
+// values by increasing index, so that the top k columns are always the same.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (input_data[b] < input_data[a]) return true;
+    if (input_data[b] > input_data[a]) return false;
+    return a < b;
+  }
+
+  const T* input_data;
+};
+
+// Rows with at least this many columns per worker thread are split over the
+// threads when there are fewer rows than threads.
+constexpr int64_t kMinColsPerShard = 16 << 10;
+
+}  // namespace
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,7 +182,19 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64_t num_col_shards = std::min<int64_t>(
+        worker_threads.num_threads,
+        num_cols / std::max<int64_t>(kMinColsPerShard, 4 * k));
+    if (num_rows < worker_threads.num_threads && num_col_shards > 1) {
+      SplitRowsTopK(worker_threads, k, input, num_rows, num_cols,
+                    num_col_shards, values, indices);
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      // The columns of a row, for a partial sort.
+      std::vector<Tidx> partial_sort_columns;
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32_t a,
@@ -177,11 +210,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -204,6 +232,22 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+        } else if (4 * k >= num_cols) {
+          // Most pushes into a TopN heap of a large fraction of the columns
+          // would sift, so select the top k columns in linear time and sort
+          // them. The top k columns are sorted in both modes, which is also a
+          // valid order when sorting is not requested.
+          const StableGreater<T, Tidx> greater{input_data};
+          partial_sort_columns.resize(num_cols);
+          std::iota(partial_sort_columns.begin(), partial_sort_columns.end(),
+                    0);
+          std::nth_element(partial_sort_columns.begin(),
+                           partial_sort_columns.begin() + k,
+                           partial_sort_columns.end(), greater);
+          std::sort(partial_sort_columns.begin(),
+                    partial_sort_columns.begin() + k, greater);
+          std::copy(partial_sort_columns.begin(),
+                    partial_sort_columns.begin() + k, &indices(b, 0));
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
@@ -247,12 +291,54 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return OkStatus();
   }
+
+  // Computes the top k of each of the few huge rows of `input`, for example
+  // the scores of the candidates of a retrieval over a vocabulary: the
+  // columns of each row are split into `num_col_shards` shards of at least 4k
+  // columns, whose top k are computed in parallel with a TopN heap, which
+  // drops most columns after comparing them to its current minimum. The top
+  // k of the row are then selected and sorted among the top k of the shards.
+  static void SplitRowsTopK(
+      const DeviceBase::CpuWorkerThreads& worker_threads, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t num_col_shards,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<Tidx, 2>::Tensor indices) {
+    std::vector<Tidx> candidates(num_col_shards * k);
+    const double cost_per_shard =
+        (3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+         Eigen::TensorOpCost::AddCost<T>()) *
+        static_cast<double>(num_cols / num_col_shards);
+    for (int64_t b = 0; b < num_rows; ++b) {
+      const StableGreater<T, Tidx> greater{&input(b, 0)};
+      auto ShardTopK = [&](int64_t start_shard, int64_t limit_shard) {
+        for (int64_t shard = start_shard; shard < limit_shard; ++shard) {
+          const Tidx begin = num_cols * shard / num_col_shards;
+          const Tidx end = num_cols * (shard + 1) / num_col_shards;
+          gtl::TopN<Tidx, StableGreater<T, Tidx>> filter(k, greater);
+          filter.reserve(k + 1);
+          for (Tidx c = begin; c < end; ++c) filter.push(c);
+          std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                    candidates.begin() + shard * k);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_col_shards,
+            static_cast<int64_t>(cost_per_shard), ShardTopK);
+
+      std::nth_element(candidates.begin(), candidates.begin() + k,
+                       candidates.end(), greater);
+      std::sort(candidates.begin(), candidates.begin() + k, greater);
+      for (int i = 0; i < k; ++i) {
+        indices(b, i) = candidates[i];
+        values(b, i) = input(b, candidates[i]);
+      }
+    }
+  }
 };
 
 }  // namespace functor
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -143,6 +147,17 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
+    if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+      const int num_threads =
+          context->device()->tensorflow_cpu_worker_threads()->num_threads;
+      if (new_sizes[0] == 1 && new_sizes[2] == 1 && num_threads > 1 &&
+          new_sizes[1] >= 2 * kMinBlockSize) {
+        ComputeInParallel(context, input, axis, idx_vec, &uniq_size);
+        if (!context->status().ok()) return;
+        if (num_outputs() > 2) ComputeCounts(context, idx_vec, uniq_size);
+        return;
+      }
+    }
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
@@ -225,17 +240,139 @@ class UniqueOp : public OpKernel {
       }
     }
 
-    if (num_outputs() > 2) {
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context, context->allocate_output(
-                                  2, TensorShape({uniq_size}), &output));
-      auto count_output_vec = output->template vec<TIndex>();
-      count_output_vec.setZero();
-      const int N = idx_vec.size();
-      for (int64_t i = 0; i < N; ++i) {
-        count_output_vec(idx_vec(i))++;
+    if (num_outputs() > 2) ComputeCounts(context, idx_vec, uniq_size);
+  }
+
+ private:
+  // Minimum number of elements processed by a block of the parallel
+  // implementation.
+  static constexpr int64_t kMinBlockSize = 32768;
+
+  static void ComputeCounts(OpKernelContext* context,
+                            typename TTypes<TIndex>::Vec idx_vec,
+                            int64_t uniq_size) {
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                2, TensorShape({uniq_size}), &output));
+    auto count_output_vec = output->template vec<TIndex>();
+    count_output_vec.setZero();
+    const int N = idx_vec.size();
+    for (int64_t i = 0; i < N; ++i) {
+      count_output_vec(idx_vec(i))++;
+    }
+  }
+
+  // Uniquifies the single elements of a large input on the worker threads.
+  // The input is split into contiguous blocks, and the positions of the
+  // elements of all the blocks are grouped into as many partitions by the
+  // hash of the elements, in increasing order within each partition. Each
+  // partition then finds the first occurrence of its elements in its own hash
+  // map, so that the unique elements can be numbered in the order of their
+  // first occurrence, as in the sequential implementation, by a parallel
+  // prefix sum over the blocks.
+  static void ComputeInParallel(OpKernelContext* context, const Tensor& input,
+                                int64_t axis,
+                                typename TTypes<TIndex>::Vec idx_vec,
+                                int64_t* uniq_size) {
+    auto Tin = input.flat<T>();
+    // The input has fewer than kint32max elements, so its positions are
+    // stored as int32.
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_blocks =
+        std::clamp<int64_t>(N / kMinBlockSize, 1, worker_threads->num_threads);
+    auto block_begin = [N, num_blocks](int64_t block) {
+      return N * block / num_blocks;
+    };
+    auto partition = [num_blocks](T value) {
+      return static_cast<int64_t>(
+          ((static_cast<uint64>(value) * 0x9E3779B97F4A7C15ull) >> 32) %
+          num_blocks);
+    };
+    auto for_each_block = [&](const std::function<void(int64_t)>& fn) {
+      worker_threads->workers->ParallelFor(
+          num_blocks, N / num_blocks, [&fn](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) fn(b);
+          });
+    };
+
+    // offsets[b * num_blocks + p] is the number of elements of block b in
+    // partition p, then the position where block b writes them.
+    std::vector<int32> offsets(num_blocks * num_blocks, 0);
+    for_each_block([&](int64_t b) {
+      int32* block_offsets = &offsets[b * num_blocks];
+      for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+        ++block_offsets[partition(Tin(i))];
+      }
+    });
+    std::vector<int32> partition_begin(num_blocks + 1);
+    int32 offset = 0;
+    for (int64_t p = 0; p < num_blocks; ++p) {
+      partition_begin[p] = offset;
+      for (int64_t b = 0; b < num_blocks; ++b) {
+        const int32 count = offsets[b * num_blocks + p];
+        offsets[b * num_blocks + p] = offset;
+        offset += count;
       }
     }
+    partition_begin[num_blocks] = offset;
+    std::vector<int32> positions(N);
+    for_each_block([&](int64_t b) {
+      int32* block_offsets = &offsets[b * num_blocks];
+      for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+        positions[block_offsets[partition(Tin(i))]++] = i;
+      }
+    });
+
+    // The position of the first occurrence of each element.
+    std::vector<int32> first(N);
+    for_each_block([&](int64_t p) {
+      typename UniqueOpHashMap<T, int32>::map_type uniq;
+      uniq.reserve(2 * (partition_begin[p + 1] - partition_begin[p]));
+      for (int32 k = partition_begin[p]; k < partition_begin[p + 1]; ++k) {
+        const int32 i = positions[k];
+        first[i] = uniq.emplace(Tin(i), i).first->second;
+      }
+    });
+
+    // The index of the first unique element of each block.
+    std::vector<int64_t> block_uniq_begin(num_blocks + 1, 0);
+    for_each_block([&](int64_t b) {
+      int64_t count = 0;
+      for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+        count += first[i] == i;
+      }
+      block_uniq_begin[b + 1] = count;
+    });
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      block_uniq_begin[b + 1] += block_uniq_begin[b];
+    }
+    *uniq_size = block_uniq_begin[num_blocks];
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    // The positions are no longer needed, so they are reused to hold the
+    // index of each unique element at its first occurrence.
+    std::vector<int32>& uniq_index = positions;
+    for_each_block([&](int64_t b) {
+      int32 j = block_uniq_begin[b];
+      for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+        if (first[i] == i) {
+          Tout(j) = Tin(i);
+          uniq_index[i] = j++;
+        }
+      }
+    });
+    for_each_block([&](int64_t b) {
+      for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+        idx_vec(i) = uniq_index[first[i]];
+      }
+    });
   }
 };
 
@@ -27,6 +27,7 @@ limitations under the License.
 
 namespace tensorflow {
 namespace io {
+using tsl::io::ParallelZlibOutputBuffer;  // NOLINT(misc-unused-using-decls)
 using tsl::io::ZlibOutputBuffer;  // NOLINT(misc-unused-using-decls)
 }
 }  // namespace tensorflow
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/nccl/nccl_manager.h"
 
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -121,6 +123,10 @@ struct NcclManager::Communicator {
 
 namespace {
 
+// Maximum number of ready collectives whose kernels a stream launches in one
+// NCCL group.
+static constexpr size_t kMaxGroupedLaunches = 32;
+
 static constexpr DataTypeSet kValidDataTypes =
     ToSet(DT_HALF) | ToSet(DT_FLOAT) | ToSet(DT_DOUBLE) | ToSet(DT_INT32) |
     ToSet(DT_INT64);
@@ -726,8 +732,10 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
       comm_stream->platform_specific_handle().stream);
 
   while (true) {
-    // Find collective to run.
-    std::pair<Collective*, int> next_launch;
+    // Find collectives to run. Consecutive ready collectives of the same
+    // communicator are taken together, so that their kernels are launched as
+    // one NCCL group instead of one launch per collective.
+    std::vector<std::pair<Collective*, int>> next_launches;
     {
       VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
       mutex_lock l(nccl_stream->mu);
@@ -738,187 +746,217 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         }
         nccl_stream->cv.wait(l);
       }
-      next_launch = nccl_stream->pending_launches_.back();
-      nccl_stream->pending_launches_.pop_back();
+      const Communicator* communicator =
+          nccl_stream->pending_launches_.back().first->communicator;
+      while (!nccl_stream->pending_launches_.empty() &&
+             next_launches.size() < kMaxGroupedLaunches &&
+             nccl_stream->pending_launches_.back().first->communicator ==
+                 communicator) {
+        next_launches.push_back(nccl_stream->pending_launches_.back());
+        nccl_stream->pending_launches_.pop_back();
+      }
     }
 
-    // Launch the nccl kernel.
-    Collective* collective = next_launch.first;
-    tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
-                                                  collective->trace_context);
-
-    ncclDataType_t data_type = ToNcclType(collective->data_type);
-    int p_idx = next_launch.second;
-    Participant* p = collective->participants[p_idx].get();
-    auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
-    ncclResult_t nccl_result = ncclSuccess;
-    switch (collective->type) {
-      case kAllReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclAllReduce collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllReduce",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_reduce"}});
-        });
-        nccl_result = ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, collective->reduction_op,
-                                    nccl_comm, cu_stream);
-        break;
-      }
-      case kBroadcast: {
-        const void* sendbuff = nullptr;
-        void* recvbuff = nullptr;
-        int num_elements = -1;
-        if (p->input) {
-          sendbuff = p->input->tensor_data().data();
-          num_elements = p->input->NumElements();
+    // Launch the nccl kernels.
+    const bool grouped = next_launches.size() > 1;
+    if (grouped) {
+      VLOG(2) << "call ncclGroupStart for " << next_launches.size()
+              << " collectives on comm_stream " << comm_stream;
+      ncclGroupStart();
+    }
+    // Has (collective, participant_idx, nccl_result) of the launched kernels.
+    std::vector<std::tuple<Collective*, int, ncclResult_t>> launched;
+    launched.reserve(next_launches.size());
+    for (const std::pair<Collective*, int>& next_launch : next_launches) {
+      Collective* collective = next_launch.first;
+      tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
+                                                    collective->trace_context);
+
+      ncclDataType_t data_type = ToNcclType(collective->data_type);
+      int p_idx = next_launch.second;
+      Participant* p = collective->participants[p_idx].get();
+      auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
+      ncclResult_t nccl_result = ncclSuccess;
+      switch (collective->type) {
+        case kAllReduce: {
+          const void* sendbuff = p->input->tensor_data().data();
+          void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+          VLOG(2) << "call NcclAllReduce collective_key "
+                  << collective->collective_key << " participant " << p_idx
+                  << " num_participants " << collective->participants.size()
+                  << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+                  << " nccl_comm " << nccl_comm << " comm_stream "
+                  << comm_stream << " cuda_stream " << cu_stream;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "ncclAllReduce",
+                {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "all_reduce"}});
+          });
+          nccl_result =
+              ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
+                            data_type, collective->reduction_op, nccl_comm,
+                            cu_stream);
+          break;
         }
-        if (p->output) {
-          recvbuff = const_cast<char*>(p->output->tensor_data().data());
-          num_elements = p->output->NumElements();
-        } else {
-          // Operate in-place if no output (for the src node).
-          recvbuff = const_cast<void*>(sendbuff);
+        case kBroadcast: {
+          const void* sendbuff = nullptr;
+          void* recvbuff = nullptr;
+          int num_elements = -1;
+          if (p->input) {
+            sendbuff = p->input->tensor_data().data();
+            num_elements = p->input->NumElements();
+          }
+          if (p->output) {
+            recvbuff = const_cast<char*>(p->output->tensor_data().data());
+            num_elements = p->output->NumElements();
+          } else {
+            // Operate in-place if no output (for the src node).
+            recvbuff = const_cast<void*>(sendbuff);
+          }
+          if (num_elements < 0) {
+            p->done_callback(errors::Internal(
+                "Both input and output are null in ncclBroadcast"));
+            collective->Unref();
+            continue;
+          }
+          VLOG(2) << "call NcclBroadcast collective_key "
+                  << collective->collective_key << " participant " << p_idx
+                  << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+                  << " nccl_comm " << nccl_comm << " comm_stream "
+                  << comm_stream << " cuda_stream " << cu_stream;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "ncclBroadcast",
+                {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "broadcast"}});
+          });
+          nccl_result =
+              ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
+                            collective->root_rank, nccl_comm, cu_stream);
+          break;
         }
-        if (num_elements < 0) {
-          p->done_callback(errors::Internal(
-              "Both input and output are null in ncclBroadcast"));
-          collective->Unref();
-          continue;
+        case kReduce: {
+          const void* sendbuff = p->input->tensor_data().data();
+          void* recvbuff =
+              p->output ? const_cast<char*>(p->output->tensor_data().data())
+                        : nullptr;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "buffer_size",
+                {{"output_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "reduce"}});
+          });
+          nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
+                                   data_type, collective->reduction_op,
+                                   collective->root_rank, nccl_comm, cu_stream);
+          break;
         }
-        VLOG(2) << "call NcclBroadcast collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclBroadcast",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "broadcast"}});
-        });
-        nccl_result =
-            ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
-                          collective->root_rank, nccl_comm, cu_stream);
-        break;
-      }
-      case kReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff =
-            p->output ? const_cast<char*>(p->output->tensor_data().data())
-                      : nullptr;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "buffer_size",
-              {{"output_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "reduce"}});
-        });
-        nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                 data_type, collective->reduction_op,
-                                 collective->root_rank, nccl_comm, cu_stream);
-        break;
-      }
-      case kAllGather: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclAllGather collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " sendcount "
-                << p->input->NumElements() << " recvbuff " << recvbuff
-                << " recvcount " << p->output->NumElements() << " nccl_comm "
-                << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllGather",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_gather"}});
-        });
-        nccl_result = ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, nccl_comm, cu_stream);
-        break;
-      }
-      case kReduceScatter: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclReduceScatter collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclReduceScatter",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "reduce_scatter"}});
-        });
-        nccl_result = ncclReduceScatter(
-            sendbuff, recvbuff, p->output->NumElements(), data_type,
-            collective->reduction_op, nccl_comm, cu_stream);
-        break;
-      }
-      case kAllToAll: {
-        const char* sendbuff = p->input->tensor_data().data();
-        char* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-        size_t count =
-            p->input->NumElements() / collective->participants.size();
-        size_t rank_offset = count * DataTypeSize(collective->data_type);
-
-        VLOG(2) << "call Nccl All to All collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << static_cast<const void*>(sendbuff)
-                << " recvbuff " << static_cast<void*>(recvbuff) << " nccl_comm "
-                << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllToAll",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_to_all"}});
-        });
-        ncclGroupStart();
-        for (int i = 0; i < collective->participants.size(); ++i) {
-          ncclSend(sendbuff + i * rank_offset, count, data_type,
-                   collective->participants[i]->global_rank, nccl_comm,
-                   cu_stream);
-          ncclRecv(recvbuff + i * rank_offset, count, data_type,
-                   collective->participants[i]->global_rank, nccl_comm,
-                   cu_stream);
+        case kAllGather: {
+          const void* sendbuff = p->input->tensor_data().data();
+          void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+          VLOG(2) << "call NcclAllGather collective_key "
+                  << collective->collective_key << " participant " << p_idx
+                  << " sendbuff " << sendbuff << " sendcount "
+                  << p->input->NumElements() << " recvbuff " << recvbuff
+                  << " recvcount " << p->output->NumElements() << " nccl_comm "
+                  << nccl_comm << " comm_stream " << comm_stream
+                  << " cuda_stream " << cu_stream;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "ncclAllGather",
+                {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "all_gather"}});
+          });
+          nccl_result =
+              ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
+                            data_type, nccl_comm, cu_stream);
+          break;
+        }
+        case kReduceScatter: {
+          const void* sendbuff = p->input->tensor_data().data();
+          void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+          VLOG(2) << "call NcclReduceScatter collective_key "
+                  << collective->collective_key << " participant " << p_idx
+                  << " num_participants " << collective->participants.size()
+                  << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+                  << " nccl_comm " << nccl_comm << " comm_stream "
+                  << comm_stream << " cuda_stream " << cu_stream;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "ncclReduceScatter",
+                {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "reduce_scatter"}});
+          });
+          nccl_result = ncclReduceScatter(
+              sendbuff, recvbuff, p->output->NumElements(), data_type,
+              collective->reduction_op, nccl_comm, cu_stream);
+          break;
+        }
+        case kAllToAll: {
+          const char* sendbuff = p->input->tensor_data().data();
+          char* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+          size_t count =
+              p->input->NumElements() / collective->participants.size();
+          size_t rank_offset = count * DataTypeSize(collective->data_type);
+
+          VLOG(2) << "call Nccl All to All collective_key "
+                  << collective->collective_key << " participant " << p_idx
+                  << " num_participants " << collective->participants.size()
+                  << " sendbuff " << static_cast<const void*>(sendbuff)
+                  << " recvbuff " << static_cast<void*>(recvbuff)
+                  << " nccl_comm " << nccl_comm << " comm_stream "
+                  << comm_stream << " cuda_stream " << cu_stream;
+          profiler::AnnotatedTraceMe traceme([&] {
+            return profiler::TraceMeEncode(
+                "ncclAllToAll",
+                {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+                 {"collective_type", "all_to_all"}});
+          });
+          ncclGroupStart();
+          for (int i = 0; i < collective->participants.size(); ++i) {
+            ncclSend(sendbuff + i * rank_offset, count, data_type,
+                     collective->participants[i]->global_rank, nccl_comm,
+                     cu_stream);
+            ncclRecv(recvbuff + i * rank_offset, count, data_type,
+                     collective->participants[i]->global_rank, nccl_comm,
+                     cu_stream);
+          }
+          nccl_result = ncclGroupEnd();
+          break;
         }
-        nccl_result = ncclGroupEnd();
-        break;
       }
+      launched.emplace_back(collective, p_idx, nccl_result);
     }
-
-    // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
-      VLOG(2) << "done Nccl kernel collective_key "
-              << collective->collective_key << " participant " << p_idx
-              << " ncclResult " << nccl_result;
-      if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(OkStatus());
-      } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[p_idx]->done_callback(errors::Unknown(
-            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+    const ncclResult_t group_result = grouped ? ncclGroupEnd() : ncclSuccess;
+
+    // Run the done_callbacks when the nccl kernels finish running.
+    if (launched.empty()) continue;
+    EventMgr* event_mgr =
+        std::get<0>(launched[0])->participants[std::get<1>(launched[0])]
+            ->event_mgr;
+    auto done_callback = [launched = std::move(launched), group_result]() {
+      for (const auto& [collective, p_idx, launch_result] : launched) {
+        const ncclResult_t nccl_result =
+            launch_result == ncclSuccess ? group_result : launch_result;
+        VLOG(2) << "done Nccl kernel collective_key "
+                << collective->collective_key << " participant " << p_idx
+                << " ncclResult " << nccl_result;
+        if (nccl_result == ncclSuccess) {
+          collective->participants[p_idx]->done_callback(OkStatus());
+        } else {
+          // Propagate the error, but note that if other members of the
+          // collective did launch their kernels, then they are hanging.
+          collective->participants[p_idx]->done_callback(errors::Unknown(
+              "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+        }
+        collective->Unref();
       }
-      collective->Unref();
     };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
+    event_mgr->ThenExecute(comm_stream, std::move(done_callback));
   }
 }
 
@@ -526,6 +526,55 @@ REGISTER_OP("DecodeAndCropJpeg")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("_DecodeAndCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      DimensionHandle channels_dim = c->UnknownDim();
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(unused, 0), 4, &unused_dim));
+
+      TF_RETURN_IF_ERROR(SetOutputToSizedImage(c, c->UnknownDim(),
+                                               2 /* size_input_idx */,
+                                               channels_dim));
+      ShapeHandle image;
+      TF_RETURN_IF_ERROR(c->Subshape(c->output(0), 1, &image));
+      c->set_output(0, image);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Decodes the `crop_window` of a JPEG image and resizes it to `size`.
+
+Equivalent to DecodeAndCropJpeg followed by a half pixel centers
+ResizeBilinear, except that the JPEG is decoded at the largest DCT scaling
+ratio among 1, 2, 4 and 8 at which the crop window still has at least `size`
+pixels, so the output may slightly differ from the unfused ops.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
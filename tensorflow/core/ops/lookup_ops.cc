@@ -482,6 +482,47 @@ REGISTER_OP("AnonymousMutableDenseHashTable")
     .SetIsStateful()
     .SetShapeFn(MutableDenseHashTableShapeFn);
 
+REGISTER_OP("AnnIndex")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("dim: int >= 1")
+    .Attr("metric: {'dot', 'l2'} = 'dot'")
+    .Attr("num_lists: int >= 0 = 0")
+    .Attr("num_probes: int >= 1 = 8")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Scalar());
+      int64_t dim;
+      TF_RETURN_IF_ERROR(c->GetAttr("dim", &dim));
+      // ShapeAndType vector for {key, value}.
+      c->set_output_handle_shapes_and_types(
+          0, std::vector<ShapeAndType>{{c->Scalar(), DT_INT64},
+                                       {c->Vector(dim), DT_FLOAT}});
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("AnnIndexSearch")
+    .Input("table_handle: resource")
+    .Input("queries: float")
+    .Output("ids: int64")
+    .Output("scores: float")
+    .Attr("k: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      int64_t k;
+      TF_RETURN_IF_ERROR(c->GetAttr("k", &k));
+      ShapeHandle output = c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, output);
+      c->set_output(1, output);
+      return absl::OkStatus();
+    });
+
 REGISTER_OP("InitializeTable")
     .Input("table_handle: Ref(string)")
     .Input("keys: Tkey")
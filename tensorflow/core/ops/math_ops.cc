@@ -937,6 +937,51 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {bfloat16, half, float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string) >= 1")
+    .Attr("operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      // Arguments are either scalars or all of the output shape.
+      ShapeHandle out = c->Scalar();
+      bool has_non_scalar_arg = false;
+      for (int i = 0; i < c->num_inputs(); ++i) {
+        ShapeHandle arg = c->input(i);
+        if (c->RankKnown(arg) && c->Rank(arg) == 0) continue;
+        if (!has_non_scalar_arg) {
+          out = arg;
+          has_non_scalar_arg = true;
+        } else {
+          TF_RETURN_IF_ERROR(c->Merge(out, arg, &out));
+        }
+      }
+      c->set_output(0, out);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Performs a chain of elementwise operations in a single pass over memory.
+
+The operations are specified by the `fused_ops` attribute, which is a list of
+TF op names specified as strings (e.g. "Mul"), performed in order. The operands
+of the i-th op are `operands[2 * i]` and `operands[2 * i + 1]` (-1 for unary
+ops), where values [0, num_args) refer to `args` and values num_args + j to the
+result of the j-th op. The last op produces the output.
+
+Each of `args` is either a scalar or of the output shape: no other broadcasting
+is supported.
+
+Currently supported ops are: "Add", "AddV2", "Sub", "Mul", "Div", "RealDiv",
+"Maximum", "Minimum", "SquaredDifference", "Neg", "Abs", "Square", "Sqrt",
+"Rsqrt", "Exp", "Log", "Tanh", "Sigmoid", "Erf", "Inv", "Reciprocal", "Relu"
+and "Relu6".
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -1473,6 +1518,51 @@ REGISTER_OP("SparseSegmentSqrtNGradV2")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradV2ShapeFn);
 
+REGISTER_OP("_FusedSparseSegmentReduction")
+    .Input("data: N * T")
+    .Input("indices: N * Tidx")
+    .Input("segment_ids: N * Tsegmentids")
+    .Output("output: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {bfloat16, half, float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiners: list(string) >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle data_shape;
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(i), 1, &data_shape));
+        ShapeHandle indices_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(n + i), 1, &indices_shape));
+        ShapeHandle segment_ids_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(2 * n + i), 1, &segment_ids_shape));
+        ShapeHandle unused;
+        TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+        ShapeHandle subshape;
+        TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(c->Concatenate(
+            c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+        c->set_output(i, out);
+      }
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Performs N independent sparse segment reductions in a single op.
+
+`output[i]` is the result of the "SparseSegment<combiners[i]>" op (one of
+"Sum", "Mean" and "SqrtN") applied to `data[i]`, `indices[i]` and
+`segment_ids[i]`. Each of `data[i]` is typically an embedding table, so that
+the op performs the lookups of all the features of a model at once, with a
+single pass over the indices and without materializing the gathered rows.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -23,6 +23,7 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedSegmentReduceShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +39,15 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedSegmentReduce")
+    .Input("data: T")
+    .Input("row_splits: Tsplits")
+    .Output("output: T")
+    .Attr("reduction: {'sum', 'min', 'max'}")
+    .Attr("T: realnumbertype")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedSegmentReduceShapeFn);
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +88,21 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return absl::OkStatus();
 }
 
+Status RaggedSegmentReduceShapeFn(InferenceContext* c) {
+  ShapeHandle data;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &data));
+  ShapeHandle row_splits;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &row_splits));
+
+  // The output has a row for each pair of consecutive row splits.
+  DimensionHandle num_rows;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(row_splits, 0), 1, &num_rows));
+  ShapeHandle inner_shape;
+  TF_RETURN_IF_ERROR(c->Subshape(data, 1, &inner_shape));
+  ShapeHandle output;
+  TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(num_rows), inner_shape, &output));
+  c->set_output(0, output);
+  return absl::OkStatus();
+}
+
 }  // namespace tensorflow
@@ -102,6 +102,48 @@ REGISTER_OP("StringToHashBucketStrong")
     .Attr("key: list(int)")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+namespace {
+
+// Sets the shapes of the N outputs of a fused op to the shapes of its N
+// inputs.
+Status FusedUnchangedShapes(InferenceContext* c) {
+  for (int i = 0; i < c->num_inputs(); ++i) c->set_output(i, c->input(i));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+REGISTER_OP("_FusedStringToHashBucketFast")
+    .Input("input: N * string")
+    .Output("output: N * int64")
+    .Attr("N: int >= 1")
+    .Attr("num_buckets: int >= 1")
+    .SetShapeFn(FusedUnchangedShapes)
+    .Doc(R"doc(
+Performs N independent StringToHashBucketFast ops in a single op.
+
+`output[i]` is the result of StringToHashBucketFast applied to `input[i]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedStringToHashBucketStrong")
+    .Input("input: N * string")
+    .Output("output: N * int64")
+    .Attr("N: int >= 1")
+    .Attr("num_buckets: int >= 1")
+    .Attr("key: list(int)")
+    .SetShapeFn(FusedUnchangedShapes)
+    .Doc(R"doc(
+Performs N independent StringToHashBucketStrong ops in a single op.
+
+`output[i]` is the result of StringToHashBucketStrong applied to `input[i]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("StringToHashBucket")
     .Input("string_tensor: string")
     .Output("output: int64")
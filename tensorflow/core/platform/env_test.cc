@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/platform/env.h"
 
+#include <stdlib.h>
 #include <sys/stat.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -92,6 +95,34 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadBatch) {
+  // Batched reads of local files go through io_uring where it is supported.
+  setenv("TF_POSIX_IO_URING", "1", 1);
+  const string filename = io::JoinPath(BaseDir(), "read_batch");
+  const string input = CreateTestFile(env_, filename, 10000);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  std::vector<RandomAccessFile::ReadRequest> requests(1000);
+  std::vector<string> scratches(requests.size(), string(100, 0));
+  for (int i = 0; i < requests.size(); ++i) {
+    requests[i].offset = (i * 317) % 9950;
+    requests[i].n = 100;
+    requests[i].scratch = &scratches[i][0];
+  }
+  f->ReadBatch(absl::MakeSpan(requests));
+  for (int i = 0; i < requests.size(); ++i) {
+    const uint64 offset = requests[i].offset;
+    if (offset + 100 <= input.size()) {
+      TF_EXPECT_OK(requests[i].status);
+      EXPECT_EQ(input.substr(offset, 100), requests[i].result);
+    } else {
+      EXPECT_EQ(error::OUT_OF_RANGE, requests[i].status.code());
+      EXPECT_EQ(input.substr(offset), requests[i].result);
+    }
+  }
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
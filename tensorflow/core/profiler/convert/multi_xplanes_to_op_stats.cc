@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/preprocess_single_host_xplane.h"
 #include "tensorflow/core/profiler/convert/repository.h"
@@ -28,21 +33,56 @@ limitations under the License.
 
 namespace tensorflow {
 namespace profiler {
+namespace {
+
+// The maximum number of hosts whose XSpaces are converted at the same time. An
+// XSpace is much larger than the OpStats converted from it, so this bounds the
+// peak memory of the conversion.
+constexpr int kMaxConcurrentXSpaces = 16;
+
+// Converts the XSpace of the host at <index> into <op_stats>.
+Status ConvertHostXSpaceToOpStats(const SessionSnapshot& session_snapshot,
+                                  int index, const OpStatsOptions& options,
+                                  OpStats* op_stats) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
+                      session_snapshot.GetXSpace(index));
+  PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
+                             /*derived_timeline=*/false);
+  *op_stats = ConvertXSpaceToOpStats(*xspace, options);
+  return absl::OkStatus();
+}
+
+}  // namespace
 
 Status ConvertMultiXSpacesToCombinedOpStats(
     const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
     OpStats* combined_op_stats) {
-  // Read multiple XSpaces and convert to multiple OpStats.
-  // TODO(profiler): Change the combiner to convert and combine one OpStats at a
-  // time, to reduce peak memory usage.
-  std::vector<OpStats> all_op_stats;
-  all_op_stats.reserve(session_snapshot.XSpaceSize());
-  for (int i = 0; i < session_snapshot.XSpaceSize(); i++) {
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
-                        session_snapshot.GetXSpace(i));
-    PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
-                               /*derived_timeline=*/false);
-    all_op_stats.push_back(ConvertXSpaceToOpStats(*xspace, options));
+  // Read multiple XSpaces and convert to multiple OpStats. The hosts are
+  // converted in parallel, and each XSpace is released as soon as its OpStats
+  // is ready, so that at most one XSpace per thread is held in memory.
+  const int num_hosts = session_snapshot.XSpaceSize();
+  std::vector<OpStats> all_op_stats(num_hosts);
+  std::vector<Status> statuses(num_hosts);
+  const int num_threads = std::min(
+      {num_hosts, port::MaxParallelism(), kMaxConcurrentXSpaces});
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_hosts; i++) {
+      TF_RETURN_IF_ERROR(ConvertHostXSpaceToOpStats(session_snapshot, i,
+                                                    options, &all_op_stats[i]));
+    }
+  } else {
+    // The destructor of the thread pool waits for all the conversions.
+    thread::ThreadPool thread_pool(Env::Default(), "convert_xspaces",
+                                   num_threads);
+    for (int i = 0; i < num_hosts; i++) {
+      thread_pool.Schedule([&, i] {
+        statuses[i] = ConvertHostXSpaceToOpStats(session_snapshot, i, options,
+                                                 &all_op_stats[i]);
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
   }
 
   // Combine OpStats.
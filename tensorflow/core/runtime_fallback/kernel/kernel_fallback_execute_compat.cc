@@ -150,6 +150,40 @@ OpKernelRunState& GetThreadLocalOpKernelRunState() {
   return run_state;
 }
 
+// Points `run_state.input_tf_tensor_values` to the tensors of `args` without
+// copying them. If the argument is immutable or unique, we can just keep the
+// reference without the expensive atomic reference counting. And if the
+// argument is unique but mutable, then tensorflow optimizations like buffer
+// forwarding can be utilized. Otherwise, we conservatively take a reference on
+// its buffer, to be released by `ReleaseInputTensorBuffers()`. Unlike copying
+// the tensors, this does not allocate once `run_state` has warmed up.
+void SetUpInputTensorValues(llvm::ArrayRef<tfrt::AsyncValue*> args,
+                            OpKernelRunState& run_state) {
+  auto& input_tf_tensor_values = run_state.input_tf_tensor_values;
+  DCHECK(run_state.tensor_buffers.empty());
+  input_tf_tensor_values.resize(args.size());
+  for (int i = 0; i < args.size(); ++i) {
+    auto* arg = args[i];
+    auto& fallback_tensor = arg->get<tensorflow::tfrt_stub::FallbackTensor>();
+    if (!fallback_tensor.is_immutable() && !arg->IsUnique()) {
+      if (const auto* buffer = fallback_tensor.buffer()) {
+        buffer->Ref();
+        run_state.tensor_buffers.push_back(buffer);
+      }
+    }
+    input_tf_tensor_values[i].tensor = &fallback_tensor.tensor();
+  }
+}
+
+void ReleaseInputTensorBuffers(OpKernelRunState& run_state) {
+  for (const auto* buffer : run_state.tensor_buffers) {
+    DCHECK(buffer);
+    buffer->Unref();
+  }
+  run_state.tensor_buffers.clear();
+  run_state.input_tf_tensors.clear();
+}
+
 }  // namespace
 
 // Execute a tensorflow::OpKernel Asynchronously. `kernel_runner` and
@@ -437,26 +471,10 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOpInternal(
 
   auto& run_state = GetThreadLocalOpKernelRunState();
   auto clean_up_inputs =
-      gtl::MakeCleanup([&]() { run_state.input_tf_tensors.clear(); });
+      gtl::MakeCleanup([&]() { ReleaseInputTensorBuffers(run_state); });
 
   // Prepare the input tensors.
-  auto& input_tf_tensors = run_state.input_tf_tensors;
-  auto& input_tf_tensor_values = run_state.input_tf_tensor_values;
-  DCHECK(input_tf_tensors.empty());
-  input_tf_tensor_values.resize(args.size());
-  for (int i = 0; i < args.size(); ++i) {
-    auto* arg = args[i];
-    auto& fallback_tensor = arg->get<tensorflow::tfrt_stub::FallbackTensor>();
-    // If the argument is immutable or unique, we can just keep the reference
-    // without copying that invovles expensive atomic reference counting. And if
-    // the argument is unique but mutable, then tensorflow optimizations like
-    // buffer forwarding can be utilized. Otherwise, we conservatively copy the
-    // tensor.
-    if (!fallback_tensor.is_immutable() && !arg->IsUnique()) {
-      input_tf_tensors.push_back(fallback_tensor.tensor());
-    }
-    input_tf_tensor_values[i].tensor = &fallback_tensor.tensor();
-  }
+  SetUpInputTensorValues(args, run_state);
 
   SetUpParams(kernel_runner, fallback_request_state, device, run_state);
 
@@ -934,27 +952,14 @@ void BatchFunction(
 
   auto& run_state = GetThreadLocalOpKernelRunState();
   auto clean_up_inputs =
-      gtl::MakeCleanup([&]() { run_state.input_tf_tensors.clear(); });
+      gtl::MakeCleanup([&]() { ReleaseInputTensorBuffers(run_state); });
 
-  // TODO(bangdazhou): refactor the common logic into a util function.
   // Prepare the input tensors.
+  SetUpInputTensorValues(args.values(), run_state);
   auto& input_tf_tensors = run_state.input_tf_tensors;
   auto& input_tf_tensor_values = run_state.input_tf_tensor_values;
   DCHECK(input_tf_tensors.empty());
   input_tf_tensor_values.resize(args.size() + 1);
-  for (int i = 0; i < args.size(); ++i) {
-    auto* arg = args.values()[i];
-    auto& fallback_tensor = arg->get<tensorflow::tfrt_stub::FallbackTensor>();
-    // If the argument is immutable or unique, we can just keep the reference
-    // without copying that invovles expensive atomic reference counting. And if
-    // the argument is unique but mutable, then tensorflow optimizations like
-    // buffer forwarding can be utilized. Otherwise, we conservatively copy the
-    // tensor.
-    if (!fallback_tensor.is_immutable() && !arg->IsUnique()) {
-      input_tf_tensors.push_back(fallback_tensor.tensor());
-    }
-    input_tf_tensor_values[i].tensor = &fallback_tensor.tensor();
-  }
   // exec_ctx is passed in as the last input. exec_ctx is only valid during the
   // period of one bef execution. It should not be stored and accessed after bef
   // execution completes.
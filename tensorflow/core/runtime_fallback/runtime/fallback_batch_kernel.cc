@@ -42,6 +42,11 @@ constexpr char kMinInflightBatchesAttr[] = "_min_inflight_batches";
 constexpr char kInitialInflightBatchesAttr[] = "_initial_inflight_batches";
 constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
+constexpr char kLatencySloMicrosAttr[] = "_latency_slo_micros";
+constexpr char kTargetP99LatencyMicrosAttr[] = "_target_p99_latency_micros";
+constexpr char kEnableRaggedBatchingAttr[] = "_enable_ragged_batching";
+constexpr char kRaggedLengthBucketBoundariesAttr[] =
+    "_ragged_length_bucket_boundaries";
 // Default thread count in the per-process batching thread pool.
 // The value is the same as the TF batch kernel BatchKernel.
 
@@ -128,6 +133,24 @@ BatchFunctionFallbackKernelBase::BatchFunctionFallbackKernelBase(
     disable_padding_ = false;
   }
 
+  if (c->HasAttr(kLatencySloMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLatencySloMicrosAttr, &latency_slo_micros_));
+    OP_REQUIRES(c, latency_slo_micros_ >= 0,
+                errors::InvalidArgument(kLatencySloMicrosAttr,
+                                        " must be non-negative, got ",
+                                        latency_slo_micros_));
+  }
+
+  if (c->HasAttr(kEnableRaggedBatchingAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kEnableRaggedBatchingAttr,
+                                 &ragged_batching_options_.enabled));
+  }
+  if (c->HasAttr(kRaggedLengthBucketBoundariesAttr)) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr(kRaggedLengthBucketBoundariesAttr,
+                      &ragged_batching_options_.length_bucket_boundaries));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -135,6 +158,16 @@ BatchFunctionFallbackKernelBase::BatchFunctionFallbackKernelBase(
   if (!c->status().ok()) {
     return;
   }
+  OP_REQUIRES(c, !enable_adaptive_batch_threads_ || latency_slo_micros_ == 0,
+              errors::InvalidArgument(
+                  kLatencySloMicrosAttr,
+                  " is not supported with the adaptive batch scheduler"));
+  OP_REQUIRES(c,
+              !enable_adaptive_batch_threads_ ||
+                  !ragged_batching_options_.enabled,
+              errors::InvalidArgument(
+                  kEnableRaggedBatchingAttr,
+                  " is not supported with the adaptive batch scheduler"));
 
   if (enable_adaptive_batch_threads_) {
     // One scheduler instance contains a couple of queue instances,
@@ -211,6 +244,15 @@ void BatchFunctionFallbackKernelBase::SetAdaptiveBatchSchedulerOptions(
                                  &options.max_in_flight_batches_limit));
   }
 
+  if (c->HasAttr(kTargetP99LatencyMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kTargetP99LatencyMicrosAttr,
+                                 &options.target_p99_latency_micros));
+    OP_REQUIRES(c, options.target_p99_latency_micros >= 0,
+                errors::InvalidArgument(kTargetP99LatencyMicrosAttr,
+                                        " must be non-negative, got ",
+                                        options.target_p99_latency_micros));
+  }
+
   // At this point, the batch kernel is configured to use adaptive scheduling.
   // To validate or return error at kernel construction time, invokes
   // `GetOrCreateBatchThreadsPool` and validates returned `thread_pool` is
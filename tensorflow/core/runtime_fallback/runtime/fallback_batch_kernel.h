@@ -83,6 +83,9 @@ class BatchFunctionFallbackKernelBase : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool disable_padding_;
+  // See `serving::BatchResourceOptions::latency_slo_micros`.
+  int64_t latency_slo_micros_ = 0;
+  serving::RaggedBatchingOptions ragged_batching_options_;
 
   // Parameters for adaptive batch scheduler only.
   // Note 'num_batch_threads_' above is shared by two implementations of batch
@@ -98,6 +101,7 @@ class BatchFunctionFallbackKernelBase : public AsyncOpKernel {
     int32 initial_in_flight_batches_limit = kInitialInflightBatches;
     int32 max_in_flight_batches_limit = kMaxInflightBatches;
     int32 batches_to_average_over = kBatchesToAverageOver;
+    int64_t target_p99_latency_micros = 0;
   };
   std::optional<AdaptiveBatchSchedulerOptions>
       adaptive_batch_scheduler_options_ = std::nullopt;
@@ -194,7 +198,9 @@ void BatchFunctionFallbackKernel<BatchResourceType>::ComputeAsync(
       auto status = BatchResourceType::Create(
           c, adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
-          batch_function_, disable_padding_, &new_resource);
+          batch_function_, disable_padding_,
+          adaptive_batch_scheduler_options_->target_p99_latency_micros,
+          &new_resource);
       if (!status.ok()) return status;
       if (c->session_metadata() != nullptr) {
         new_resource->set_session_metadata(*c->session_metadata());
@@ -222,6 +228,8 @@ void BatchFunctionFallbackKernel<BatchResourceType>::ComputeAsync(
           low_priority_max_enqueued_batches_;
       batch_resource_options.low_priority_allowed_batch_sizes =
           low_priority_allowed_batch_sizes_;
+      batch_resource_options.latency_slo_micros = latency_slo_micros_;
+      batch_resource_options.ragged_batching = ragged_batching_options_;
 
       std::unique_ptr<BatchResourceType> new_resource;
       auto status = BatchResourceType::Create(
@@ -122,6 +122,17 @@ class FallbackBatchResource : public tensorflow::serving::BatchResourceBase {
     std::shared_ptr<BatcherT> batcher;
     TF_RETURN_IF_ERROR(BatcherT::Create(batcher_options, &batcher));
 
+    BatcherT::QueueOptions batcher_queue_options = GetBatcherQueueOptions(
+        options.num_batch_threads, options.max_batch_size,
+        options.batch_timeout_micros, options.max_enqueued_batches,
+        options.allowed_batch_sizes, enable_large_batch_splitting,
+        disable_padding, options.low_priority_max_batch_size,
+        options.low_priority_batch_timeout_micros,
+        options.low_priority_max_enqueued_batches,
+        options.low_priority_allowed_batch_sizes,
+        options.mixed_priority_batching_policy);
+    batcher_queue_options.latency_slo_micros = options.latency_slo_micros;
+
     const auto* fallback_request_state =
         exec_ctx->request_ctx()
             ->GetDataIfExists<tfd::KernelFallbackCompatRequestState>();
@@ -133,16 +144,9 @@ class FallbackBatchResource : public tensorflow::serving::BatchResourceBase {
     resource->reset(new FallbackBatchResource(
         *exec_ctx, *fallback_request_state, std::move(bef_func),
         std::move(batcher),
-        GetBatcherQueueOptions(
-            options.num_batch_threads, options.max_batch_size,
-            options.batch_timeout_micros, options.max_enqueued_batches,
-            options.allowed_batch_sizes, enable_large_batch_splitting,
-            disable_padding, options.low_priority_max_batch_size,
-            options.low_priority_batch_timeout_micros,
-            options.low_priority_max_enqueued_batches,
-            options.low_priority_allowed_batch_sizes,
-            options.mixed_priority_batching_policy),
-        options.allowed_batch_sizes));
+        batcher_queue_options, options.allowed_batch_sizes));
+    TF_RETURN_IF_ERROR(
+        (*resource)->set_ragged_batching_options(options.ragged_batching));
     return absl::OkStatus();
   }
 
@@ -152,6 +156,7 @@ class FallbackBatchResource : public tensorflow::serving::BatchResourceBase {
       int32_t max_batch_size, int32_t batch_timeout_micros,
       int32_t max_enqueued_batches, ArrayRef<int32_t> allowed_batch_sizes,
       tsl::RCReference<const tfrt::Function> bef_func, bool disable_padding,
+      int64_t target_p99_latency_micros,
       std::unique_ptr<FallbackBatchResource>* resource) {
     const tfrt::ExecutionContext* exec_ctx = nullptr;
     TF_RETURN_IF_ERROR(GetTfrtExecutionContext(c, &exec_ctx));
@@ -174,7 +179,8 @@ class FallbackBatchResource : public tensorflow::serving::BatchResourceBase {
         GetAdaptiveBatcherQueueOptions(max_batch_size, batch_timeout_micros,
                                        max_enqueued_batches,
                                        true /* enable large batch split */,
-                                       allowed_batch_sizes, disable_padding),
+                                       allowed_batch_sizes, disable_padding,
+                                       target_p99_latency_micros),
         allowed_batch_sizes));
     return absl::OkStatus();
   }
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/summary/summary_db_writer.h"
 
 #include <deque>
+#include <vector>
 
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -79,6 +80,12 @@ const int64_t kPreallocateRows = 1000;
 // allow writers in other processes a chance to schedule.
 const uint64 kFlushBytes = 1024 * 1024;
 
+// Tensors are written in batches, each in a single transaction, rather than in
+// a transaction (and hence an fsync) of their own. A batch is written once it
+// has this many tensors, or once this much time has passed since the last one.
+const size_t kMaxPendingTensors = 1000;
+const uint64 kMaxPendingMicros = 1000 * 1000;
+
 double DoubleTime(uint64 micros) {
   // TODO(@jart): Follow precise definitions for time laid out in schema.
   // TODO(@jart): Use monotonic clock from gRPC codebase.
@@ -635,12 +642,12 @@ class SeriesWriter {
     DCHECK(series_ > 0);
   }
 
-  Status Append(Sqlite* db, int64_t step, uint64 now, double computed_time,
-                const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db)
-      TF_LOCKS_EXCLUDED(mu_) {
+  Status Append(Sqlite* db, SqliteTransaction* txn, int64_t step,
+                double computed_time, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock lock(mu_);
     if (rowids_.empty()) {
-      Status s = Reserve(db, t);
+      Status s = Reserve(db, txn, t);
       if (!s.ok()) {
         rowids_.clear();
         return s;
@@ -655,6 +662,12 @@ class SeriesWriter {
     return s;
   }
 
+  /// \brief Forgets the reserved rows, which may have been rolled back.
+  void ClearReservations() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock lock(mu_);
+    rowids_.clear();
+  }
+
   Status Finish(Sqlite* db) SQLITE_TRANSACTIONS_EXCLUDED(*db)
       TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock lock(mu_);
@@ -679,16 +692,15 @@ class SeriesWriter {
 
  private:
   Status Write(Sqlite* db, int64_t rowid, int64_t step, double computed_time,
-               const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db) {
+               const Tensor& t) SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (t.dtype() == DT_STRING) {
       if (t.dims() == 0) {
         return Update(db, step, computed_time, t, t.scalar<tstring>()(), rowid);
       } else {
-        SqliteTransaction txn(*db);
         TF_RETURN_IF_ERROR(
             Update(db, step, computed_time, t, StringPiece(), rowid));
-        TF_RETURN_IF_ERROR(UpdateNdString(db, t, rowid));
-        return txn.Commit();
+        return UpdateNdString(db, t, rowid);
       }
     } else {
       return Update(db, step, computed_time, t, t.tensor_data(), rowid);
@@ -696,28 +708,32 @@ class SeriesWriter {
   }
 
   Status Update(Sqlite* db, int64_t step, double computed_time, const Tensor& t,
-                const StringPiece& data, int64_t rowid) {
-    const char* sql = R"sql(
-      UPDATE OR REPLACE
-        Tensors
-      SET
-        step = ?,
-        computed_time = ?,
-        dtype = ?,
-        shape = ?,
-        data = ?
-      WHERE
-        rowid = ?
-    )sql";
-    SqliteStatement stmt;
-    TF_RETURN_IF_ERROR(db->Prepare(sql, &stmt));
-    stmt.BindInt(1, step);
-    stmt.BindDouble(2, computed_time);
-    stmt.BindInt(3, t.dtype());
-    stmt.BindText(4, StringifyShape(t.shape()));
-    stmt.BindBlobUnsafe(5, data);
-    stmt.BindInt(6, rowid);
-    TF_RETURN_IF_ERROR(stmt.StepAndReset());
+                const StringPiece& data, int64_t rowid)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    // The statement is prepared once per series, as every tensor of the
+    // series is written with it.
+    if (!update_) {
+      const char* sql = R"sql(
+        UPDATE OR REPLACE
+          Tensors
+        SET
+          step = ?,
+          computed_time = ?,
+          dtype = ?,
+          shape = ?,
+          data = ?
+        WHERE
+          rowid = ?
+      )sql";
+      TF_RETURN_IF_ERROR(db->Prepare(sql, &update_));
+    }
+    update_.BindInt(1, step);
+    update_.BindDouble(2, computed_time);
+    update_.BindInt(3, t.dtype());
+    update_.BindText(4, StringifyShape(t.shape()));
+    update_.BindBlobUnsafe(5, data);
+    update_.BindInt(6, rowid);
+    TF_RETURN_IF_ERROR(update_.StepAndReset());
     return absl::OkStatus();
   }
 
@@ -751,20 +767,19 @@ class SeriesWriter {
     return absl::OkStatus();
   }
 
-  Status Reserve(Sqlite* db, const Tensor& t) SQLITE_TRANSACTIONS_EXCLUDED(*db)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    SqliteTransaction txn(*db);  // only for performance
+  Status Reserve(Sqlite* db, SqliteTransaction* txn, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     unflushed_bytes_ = 0;
     if (t.dtype() == DT_STRING) {
       if (t.dims() == 0) {
-        TF_RETURN_IF_ERROR(ReserveData(db, &txn, t.scalar<tstring>()().size()));
+        return ReserveData(db, txn, t.scalar<tstring>()().size());
       } else {
-        TF_RETURN_IF_ERROR(ReserveTensors(db, &txn, kReserveMinBytes));
+        return ReserveTensors(db, txn, kReserveMinBytes);
       }
     } else {
-      TF_RETURN_IF_ERROR(ReserveData(db, &txn, t.tensor_data().size()));
+      return ReserveData(db, txn, t.tensor_data().size());
     }
-    return txn.Commit();
   }
 
   Status ReserveData(Sqlite* db, SqliteTransaction* txn, size_t size)
@@ -819,6 +834,7 @@ class SeriesWriter {
   uint64 count_ TF_GUARDED_BY(mu_) = 0;
   std::deque<int64_t> rowids_ TF_GUARDED_BY(mu_);
   uint64 unflushed_bytes_ TF_GUARDED_BY(mu_) = 0;
+  SqliteStatement update_ TF_GUARDED_BY(mu_);
 
   SeriesWriter(const SeriesWriter&) = delete;
   void operator=(const SeriesWriter&) = delete;
@@ -835,11 +851,18 @@ class RunWriter {
  public:
   explicit RunWriter(RunMetadata* meta) : meta_{meta} {}
 
-  Status Append(Sqlite* db, int64_t tag_id, int64_t step, uint64 now,
-                double computed_time, const Tensor& t)
-      SQLITE_TRANSACTIONS_EXCLUDED(*db) TF_LOCKS_EXCLUDED(mu_) {
+  Status Append(Sqlite* db, SqliteTransaction* txn, int64_t tag_id,
+                int64_t step, double computed_time, const Tensor& t)
+      SQLITE_EXCLUSIVE_TRANSACTIONS_REQUIRED(*db) TF_LOCKS_EXCLUDED(mu_) {
     SeriesWriter* writer = GetSeriesWriter(tag_id);
-    return writer->Append(db, step, now, computed_time, t);
+    return writer->Append(db, txn, step, computed_time, t);
+  }
+
+  void ClearReservations() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock lock(mu_);
+    for (auto& series_writer : series_writers_) {
+      if (series_writer.second) series_writer.second->ClearReservations();
+    }
   }
 
   Status Finish(Sqlite* db) SQLITE_TRANSACTIONS_EXCLUDED(*db)
@@ -889,14 +912,17 @@ class SummaryDbWriter : public SummaryWriterInterface {
         db_{db},
         ids_{env_, db_},
         meta_{&ids_, experiment_name, run_name, user_name},
-        run_{&meta_} {
+        run_{&meta_},
+        last_flush_{env_->NowMicros()} {
     DCHECK(env_ != nullptr);
     db_->Ref();
   }
 
   ~SummaryDbWriter() override {
     core::ScopedUnref unref(db_);
-    Status s = run_.Finish(db_);
+    Status s = Flush();
+    if (!s.ok()) LOG(ERROR) << s;
+    s = run_.Finish(db_);
     if (!s.ok()) {
       // TODO(jart): Retry on transient errors here.
       LOG(ERROR) << s;
@@ -918,7 +944,29 @@ class SummaryDbWriter : public SummaryWriterInterface {
     }
   }
 
-  Status Flush() override { return absl::OkStatus(); }
+  Status Flush() override TF_LOCKS_EXCLUDED(flush_mu_, pending_mu_) {
+    // Holding flush_mu_ while writing keeps the batches in order.
+    mutex_lock flush_lock(flush_mu_);
+    std::vector<PendingTensor> pending;
+    {
+      mutex_lock lock(pending_mu_);
+      pending.swap(pending_);
+      last_flush_ = env_->NowMicros();
+    }
+    if (pending.empty()) return absl::OkStatus();
+    SqliteTransaction txn(*db_);
+    for (const PendingTensor& p : pending) {
+      Status s = run_.Append(db_, &txn, p.tag_id, p.step, p.computed_time, p.t);
+      if (!s.ok()) run_.ClearReservations();
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(s, meta_.user_name(), "/",
+                                      meta_.experiment_name(), "/",
+                                      meta_.run_name(), "/", p.tag, "@",
+                                      p.step);
+    }
+    Status s = txn.Commit();
+    if (!s.ok()) run_.ClearReservations();
+    return s;
+  }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
@@ -990,11 +1038,23 @@ class SummaryDbWriter : public SummaryWriterInterface {
     int64_t tag_id;
     TF_RETURN_IF_ERROR(
         meta_.GetTagId(db_, now, computed_time, tag, &tag_id, metadata));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        run_.Append(db_, tag_id, step, now, computed_time, t),
-        meta_.user_name(), "/", meta_.experiment_name(), "/", meta_.run_name(),
-        "/", tag, "@", step);
-    return absl::OkStatus();
+    return Enqueue(tag_id, tag, step, now, computed_time, t);
+  }
+
+  // Queues a tensor to be written with the next batch, which is written right
+  // away if it is due.
+  Status Enqueue(int64_t tag_id, const string& tag, int64_t step, uint64 now,
+                 double computed_time, const Tensor& t)
+      TF_LOCKS_EXCLUDED(flush_mu_, pending_mu_) {
+    {
+      mutex_lock lock(pending_mu_);
+      pending_.push_back({tag_id, tag, step, computed_time, t});
+      if (pending_.size() < kMaxPendingTensors &&
+          now - last_flush_ < kMaxPendingMicros) {
+        return absl::OkStatus();
+      }
+    }
+    return Flush();
   }
 
   Status MigrateEvent(std::unique_ptr<Event> e) {
@@ -1063,7 +1123,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     int64_t tag_id;
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return Enqueue(tag_id, s->tag(), e->step(), now, e->wall_time(), t);
   }
 
   // TODO(jart): Refactor Summary -> Tensor logic into separate file.
@@ -1076,7 +1136,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kScalarPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return Enqueue(tag_id, s->tag(), e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateHistogram(const Event* e, Summary::Value* s, uint64 now) {
@@ -1107,7 +1167,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kHistogramPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return Enqueue(tag_id, s->tag(), e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateImage(const Event* e, Summary::Value* s, uint64 now) {
@@ -1121,7 +1181,7 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kImagePluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return Enqueue(tag_id, s->tag(), e->step(), now, e->wall_time(), t);
   }
 
   Status MigrateAudio(const Event* e, Summary::Value* s, uint64 now) {
@@ -1134,14 +1194,26 @@ class SummaryDbWriter : public SummaryWriterInterface {
     PatchPluginName(s->mutable_metadata(), kAudioPluginName);
     TF_RETURN_IF_ERROR(meta_.GetTagId(db_, now, e->wall_time(), s->tag(),
                                       &tag_id, s->metadata()));
-    return run_.Append(db_, tag_id, e->step(), now, e->wall_time(), t);
+    return Enqueue(tag_id, s->tag(), e->step(), now, e->wall_time(), t);
   }
 
+  struct PendingTensor {
+    int64_t tag_id;
+    string tag;
+    int64_t step;
+    double computed_time;
+    Tensor t;
+  };
+
   Env* const env_;
   Sqlite* const db_;
   IdAllocator ids_;
   RunMetadata meta_;
   RunWriter run_;
+  mutex flush_mu_;
+  mutex pending_mu_;
+  std::vector<PendingTensor> pending_ TF_GUARDED_BY(pending_mu_);
+  uint64 last_flush_ TF_GUARDED_BY(pending_mu_);
 };
 
 }  // namespace
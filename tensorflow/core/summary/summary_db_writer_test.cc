@@ -230,6 +230,25 @@ TEST_F(SummaryDbWriterTest, TensorsWritten_RowsGetInitialized) {
             QueryDouble("SELECT computed_time FROM Tensors WHERE step = 2"));
 }
 
+TEST_F(SummaryDbWriterTest, TensorsWritten_BatchedUntilFlush) {
+  TF_ASSERT_OK(CreateSummaryDbWriter(db_, "mad-science", "train", "jart", &env_,
+                                     &writer_));
+  env_.AdvanceByMillis(23);
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(writer_->WriteScalar(i, MakeScalarInt64(i), "loss"));
+  }
+  ASSERT_EQ(1LL, QueryInt("SELECT COUNT(*) FROM Tags"));
+  ASSERT_EQ(0LL, QueryInt("SELECT COUNT(*) FROM Tensors"));
+  TF_ASSERT_OK(writer_->Flush());
+  ASSERT_EQ(1000LL, QueryInt("SELECT COUNT(*) FROM Tensors"));
+  EXPECT_EQ(10LL, QueryInt("SELECT COUNT(*) FROM Tensors WHERE dtype > 0"));
+
+  // A batch is written once it is old enough, without flushing.
+  env_.AdvanceByMillis(2000);
+  TF_ASSERT_OK(writer_->WriteScalar(10, MakeScalarInt64(10), "loss"));
+  EXPECT_EQ(11LL, QueryInt("SELECT COUNT(*) FROM Tensors WHERE dtype > 0"));
+}
+
 TEST_F(SummaryDbWriterTest, EmptyParentNames_NoParentsCreated) {
   TF_ASSERT_OK(CreateSummaryDbWriter(db_, "", "", "", &env_, &writer_));
   TF_ASSERT_OK(writer_->WriteTensor(1, MakeScalarInt64(123LL), "taggy", ""));
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -24,12 +27,25 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+// The number of full queues of summaries that may be pending while the writer
+// thread is busy, before new summaries are dropped.
+constexpr int kMaxPendingQueues = 10;
+
+// Writes the summaries on a background thread, so that writing them to slow
+// file systems doesn't block the steps that produce them.
+//
+// Summaries are enqueued, and handed over to the writer thread as a batch once
+// max_queue of them are pending or flush_millis have passed. If the writer
+// falls so far behind that kMaxPendingQueues queues are pending, new summaries
+// are dropped, but other events such as graphs are always written. Errors of
+// the writer thread are returned by the next call to WriteEvent() or Flush().
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -61,7 +77,12 @@ class SummaryFileWriter : public SummaryWriterInterface {
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
         events_writer_->InitWithSuffix(uniquified_filename_suffix),
         "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
+    {
+      mutex_lock l(queue_mu_);
+      last_flush_ = env_->NowMicros();
+    }
+    writer_thread_.reset(env_->StartThread(
+        ThreadOptions(), "summary_file_writer", [this]() { WriterLoop(); }));
     is_initialized_ = true;
     return absl::OkStatus();
   }
@@ -76,6 +97,12 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    {
+      mutex_lock l(queue_mu_);
+      stop_ = true;
+      queue_cv_.notify_all();
+    }
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -151,13 +178,19 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
+    mutex_lock l(queue_mu_);
+    const size_t max_pending = std::max(max_queue_, 1) * kMaxPendingQueues;
+    if (queue_.size() >= max_pending && event->has_summary()) {
+      ++num_dropped_;
+    } else {
+      queue_.emplace_back(std::move(event));
+    }
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      flush_requested_ = true;
+      queue_cv_.notify_all();
     }
-    return absl::OkStatus();
+    return std::exchange(status_, absl::OkStatus());
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -167,28 +200,75 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
+  // Writes the queued events to the file and flushes it, returning the errors
+  // of the writer thread too.
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    std::vector<std::unique_ptr<Event>> events;
+    int64_t num_dropped;
+    Status status;
+    {
+      mutex_lock l(queue_mu_);
+      events.swap(queue_);
+      flush_requested_ = false;
+      num_dropped = std::exchange(num_dropped_, 0);
+      status = std::exchange(status_, absl::OkStatus());
+    }
+    if (num_dropped > 0) {
+      LOG(WARNING) << "Dropped " << num_dropped
+                   << " summaries because the summary file writer could not "
+                      "keep up with them.";
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
-                                    "Could not flush events file.");
+    status.Update(events_writer_->Flush());
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(status, "Could not flush events file.");
+    mutex_lock l(queue_mu_);
     last_flush_ = env_->NowMicros();
     return absl::OkStatus();
   }
 
+  void WriterLoop() {
+    while (true) {
+      {
+        mutex_lock l(queue_mu_);
+        while (!stop_ && !flush_requested_) {
+          queue_cv_.wait(l);
+        }
+        if (stop_) return;
+      }
+      // Flush() holds mu_ while it writes the queued events, so that batches
+      // are written in order.
+      mutex_lock ml(mu_);
+      const Status status = InternalFlush();
+      if (!status.ok()) {
+        mutex_lock l(queue_mu_);
+        status_.Update(status);
+      }
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
   Env* env_;
+  // Serializes the writes to events_writer_.
   mutex mu_;
-  std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
   // A pointer to allow deferred construction.
   std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  // Guards the queue of events, which is written by the writer thread.
+  mutex queue_mu_;
+  condition_variable queue_cv_;
+  std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(queue_mu_);
+  uint64 last_flush_ TF_GUARDED_BY(queue_mu_);
+  bool flush_requested_ TF_GUARDED_BY(queue_mu_) = false;
+  bool stop_ TF_GUARDED_BY(queue_mu_) = false;
+  int64_t num_dropped_ TF_GUARDED_BY(queue_mu_) = 0;
+  // The first error of the writer thread since it was last returned.
+  Status status_ TF_GUARDED_BY(queue_mu_);
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
@@ -98,6 +98,28 @@ TEST(CostRecorderTest, ProtoRecordsTest) {
             kTestAvgCost);
 }
 
+TEST(CostRecorderTest, ReadFromFileTest) {
+  CostRecorder recorder;
+  recorder.RecordCost(kTestOpKey, kTestCost);
+  recorder.RecordCost(kTestOpKey, 2 * kTestCost);
+
+  std::string measured_cost_path;
+  tensorflow::Env::Default()->LocalTempFilename(&measured_cost_path);
+  TF_CHECK_OK(recorder.WriteToFile(measured_cost_path));
+
+  // The costs read replace the ones already recorded.
+  CostRecorder restored_recorder;
+  restored_recorder.RecordCost(kTestOpKey + 1, kTestCost);
+  TF_CHECK_OK(restored_recorder.ReadFromFile(measured_cost_path));
+
+  EXPECT_EQ(restored_recorder.size(), 1);
+  EXPECT_EQ(restored_recorder.GetCost(kTestOpKey), kTestAvgCost);
+
+  // New records are averaged with the costs read.
+  restored_recorder.RecordCost(kTestOpKey, kTestAvgCost + 2);
+  EXPECT_EQ(restored_recorder.GetCost(kTestOpKey), kTestAvgCost + 1);
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/tfrt/gpu/kernel/gpu_runner.h"
 #include "tensorflow/core/tfrt/runtime/runtime.h"
+#include "tsl/framework/serving_device_selector.h"
 #include "tsl/framework/serving_device_selector_policies.h"
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
 
@@ -29,7 +30,15 @@ namespace gpu {
 
 Status InitTfrtGpu(const GpuRunnerOptions& options,
                    tensorflow::tfrt_stub::Runtime& runtime) {
-  auto policy = std::make_unique<tsl::RoundRobinPolicy>();
+  std::unique_ptr<tsl::ServingDeviceSelector::Policy> policy;
+  switch (options.serving_selector_policy) {
+    case tsl::ServingDeviceSelectorPolicy::kRoundRobin:
+      policy = std::make_unique<tsl::RoundRobinPolicy>();
+      break;
+    case tsl::ServingDeviceSelectorPolicy::kLeastExpectedCompletionTime:
+      policy = std::make_unique<tsl::LeastExpectedCompletionTimePolicy>();
+      break;
+  }
   auto serving_device_selector =
       std::make_unique<tensorflow::gpu::GpuServingDeviceSelector>(
           options.num_gpu_streams, std::move(policy));
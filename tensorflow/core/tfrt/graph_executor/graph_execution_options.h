@@ -96,6 +96,14 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // If non-empty, the op costs recorded for each client graph are written
+    // to this directory when the graph is recompiled, and the MLRT
+    // executable of a client graph is compiled with the op costs found there
+    // when the graph is loaded, so that the costs measured by a previous run
+    // of the model are used from the first run. Only used when `enable_mlrt`
+    // is true.
+    std::string measured_costs_dir;
   };
 
   CostAnalysisOptions cost_analysis_options;
@@ -104,6 +112,14 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool enable_mlrt = false;
 
+  // If true, the `GraphExecutor::Run()` requests with the same inputs and
+  // targets are run by a single client graph evaluating the union of the
+  // outputs requested so far, which is recompiled when a request asks for a
+  // new output. This lets concurrent requests for different signatures share
+  // the batch ops of their common subgraphs, at the cost of evaluating outputs
+  // that are not requested. This option is experimental.
+  bool merge_client_graphs = false;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
@@ -63,8 +63,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
@@ -133,6 +136,14 @@ StepId GetNextStepId() {
   return gen.GetNextStepId();
 }
 
+// Returns the path of the file holding the op costs measured for the client
+// graph `graph_name` in `measured_costs_dir`.
+std::string GetMeasuredCostPath(absl::string_view measured_costs_dir,
+                                absl::string_view graph_name) {
+  return io::JoinPath(measured_costs_dir,
+                      absl::StrCat(Fingerprint64(graph_name), ".pbtxt"));
+}
+
 auto* graph_executor_mode = monitoring::Gauge<std::string, 2>::New(
     "/tfrt/graph_executor/mode",
     "Record the total number of imported savedmodel using different graph "
@@ -589,12 +600,32 @@ tensorflow::Status GraphExecutor::Run(
                                                     target_tensor_names.end());
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
+  // When merging client graphs, the requests with the same inputs and targets
+  // run the client graph evaluating all the outputs requested so far.
+  std::string merge_key;
+  std::vector<std::string> merged_output_names;
+  if (options_.merge_client_graphs) {
+    merge_key = absl::StrCat(
+        absl::StrJoin(sorted_input_names, kTensorNameJoiningDelimiter),
+        kArgumentTypeJoiningDelimiter,
+        absl::StrJoin(sorted_target_node_names, kTensorNameJoiningDelimiter));
+    merged_output_names = GetMergedOutputNames(merge_key, sorted_output_names);
+  }
+  RunOptions client_graph_run_options = run_options;
+  if (options_.merge_client_graphs) {
+    // The client graph is shared by requests for different signatures.
+    client_graph_run_options.name.clear();
+  }
+
   // Load the client graph.
   TF_ASSIGN_OR_RETURN(
       LoadedClientGraph & loaded_client_graph,
       GetOrCreateLoadedClientGraph(
-          run_options, sorted_input_names, sorted_input_dtypes,
-          sorted_output_names, sorted_target_node_names, run_options.work_queue,
+          client_graph_run_options, sorted_input_names, sorted_input_dtypes,
+          options_.merge_client_graphs
+              ? absl::Span<const std::string>(merged_output_names)
+              : absl::Span<const std::string>(sorted_output_names),
+          sorted_target_node_names, run_options.work_queue,
           /*graph_name=*/{}, inputs));
 
   // Get a shared_ptr of the executable so that during the current request the
@@ -652,6 +683,21 @@ tensorflow::Status GraphExecutor::Run(
   if (cost_recorder != nullptr) {
     loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
   }
+  if (options_.merge_client_graphs) {
+    // Select the requested outputs among the outputs of the merged client
+    // graph, which are sorted and unique.
+    std::vector<tensorflow::Tensor> requested_outputs;
+    requested_outputs.reserve(sorted_output_names.size());
+    for (const std::string& output_name : sorted_output_names) {
+      const auto iter =
+          std::lower_bound(merged_output_names.begin(),
+                           merged_output_names.end(), output_name);
+      requested_outputs.push_back(
+          flat_outputs[iter - merged_output_names.begin()]);
+    }
+    flat_outputs = std::move(requested_outputs);
+    UpdateMergedOutputNames(merge_key, std::move(merged_output_names));
+  }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
   auto flat_output_iter = flat_outputs.begin();
@@ -754,11 +800,36 @@ GraphExecutor::ImportAndCompileClientGraph(
       return tensorflow::errors::Internal("Missing kernel registry in MLRT.");
     }
 
+    // Use the op costs measured by a previous run of this graph, if any, so
+    // that Stream Analysis does not have to wait for costs to be recorded.
+    std::unique_ptr<CostRecorder> measured_costs;
+    const std::string& measured_costs_dir =
+        options_.cost_analysis_options.measured_costs_dir;
+    if (!measured_costs_dir.empty()) {
+      const std::string path =
+          GetMeasuredCostPath(measured_costs_dir, client_graph.name);
+      if (tensorflow::Env::Default()->FileExists(path).ok()) {
+        measured_costs = std::make_unique<CostRecorder>();
+        const tensorflow::Status status = measured_costs->ReadFromFile(path);
+        if (status.ok()) {
+          LOG(INFO) << "TFRT compiling client graph (" << &client_graph
+                    << ") with " << measured_costs->size()
+                    << " op costs measured in " << path;
+        } else {
+          LOG(WARNING) << "TFRT failed to read the op costs of client graph ("
+                       << &client_graph << ") from " << path << ": "
+                       << status;
+          measured_costs = nullptr;
+        }
+      }
+    }
+
     ASSIGN_OR_RETURN_IN_COMPILE(
         auto bytecode_buffer,
         tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
             options_.compile_options, fallback_state(), module.get(),
-            model_context, &module_with_op_keys));
+            model_context, &module_with_op_keys,
+            /*added_xla_function_names=*/nullptr, measured_costs.get()));
     mlrt::bc::Executable executable(bytecode_buffer.data());
     auto bytecode_executable =
         std::make_unique<mlrt::LoadedExecutable>(executable, *kernel_registry_);
@@ -979,6 +1050,40 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
   return {*loaded_client_graph_ptr};
 }
 
+std::vector<std::string> GraphExecutor::GetMergedOutputNames(
+    const std::string& merge_key,
+    absl::Span<const std::string> output_tensor_names) {
+  std::vector<std::string> merged_output_names(output_tensor_names.begin(),
+                                               output_tensor_names.end());
+  {
+    tensorflow::mutex_lock l(merged_output_names_mu_);
+    const auto iter = merged_output_names_.find(merge_key);
+    if (iter != merged_output_names_.end()) {
+      merged_output_names.insert(merged_output_names.end(),
+                                 iter->second.begin(), iter->second.end());
+    }
+  }
+  std::sort(merged_output_names.begin(), merged_output_names.end());
+  merged_output_names.erase(
+      std::unique(merged_output_names.begin(), merged_output_names.end()),
+      merged_output_names.end());
+  return merged_output_names;
+}
+
+void GraphExecutor::UpdateMergedOutputNames(
+    const std::string& merge_key,
+    std::vector<std::string> output_tensor_names) {
+  tensorflow::mutex_lock l(merged_output_names_mu_);
+  std::vector<std::string>& merged_output_names =
+      merged_output_names_[merge_key];
+  // Both are sorted. If a concurrent request merged outputs missing from
+  // `output_tensor_names`, they are kept; the next request will merge both.
+  if (std::includes(output_tensor_names.begin(), output_tensor_names.end(),
+                    merged_output_names.begin(), merged_output_names.end())) {
+    merged_output_names = std::move(output_tensor_names);
+  }
+}
+
 tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
     const std::string& graph_name, absl::Span<mlrt::Value> input_values,
     absl::Span<const std::string> input_names,
@@ -1068,6 +1173,18 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
         executable, *graph_executor_->kernel_registry_);
     new_executable_context = std::make_shared<ExecutableContext>(
         std::move(bytecode_buffer), std::move(bytecode_executable));
+
+    // Persist the costs so that the next load of this graph uses them.
+    const std::string& measured_costs_dir =
+        graph_executor_->options().cost_analysis_options.measured_costs_dir;
+    if (!measured_costs_dir.empty()) {
+      const std::string path = GetMeasuredCostPath(measured_costs_dir, name_);
+      const tensorflow::Status status = cost_recorder.WriteToFile(path);
+      if (!status.ok()) {
+        LOG(WARNING) << "TFRT failed to write the op costs of client graph "
+                     << name_ << " to " << path << ": " << status;
+      }
+    }
   } else {
     // Update costs in TFRT MLIR.
     auto tfrt_mlir = ::mlir::OwningOpRef<mlir::ModuleOp>(
@@ -357,6 +357,19 @@ class GraphExecutor {
       absl::Span<const std::pair<std::string, tensorflow::Tensor>> inputs = {})
       TF_LOCKS_EXCLUDED(loaded_client_graphs_mu_);
 
+  // Returns the sorted union of `output_tensor_names` and of the outputs of
+  // the merged client graph keyed by `merge_key`, if any.
+  std::vector<std::string> GetMergedOutputNames(
+      const std::string& merge_key,
+      absl::Span<const std::string> output_tensor_names)
+      TF_LOCKS_EXCLUDED(merged_output_names_mu_);
+
+  // Makes `output_tensor_names` the outputs of the merged client graph keyed
+  // by `merge_key`, unless concurrent requests added outputs it lacks.
+  void UpdateMergedOutputNames(const std::string& merge_key,
+                               std::vector<std::string> output_tensor_names)
+      TF_LOCKS_EXCLUDED(merged_output_names_mu_);
+
   Options options_;
   std::unique_ptr<FallbackState> fallback_state_;
 
@@ -373,6 +386,13 @@ class GraphExecutor {
                       std::unique_ptr<LoadedClientGraph>>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
 
+  tensorflow::mutex merged_output_names_mu_;
+  // With `Options::merge_client_graphs`, maps the joined input and target
+  // names of the requests to the sorted outputs of the client graph running
+  // them.
+  absl::flat_hash_map<std::string /*merge_key*/, std::vector<std::string>>
+      merged_output_names_ TF_GUARDED_BY(merged_output_names_mu_);
+
   std::unique_ptr<mlrt::KernelRegistry> kernel_registry_;
 
   std::unique_ptr<tfrt::ResourceContext> resource_context_;
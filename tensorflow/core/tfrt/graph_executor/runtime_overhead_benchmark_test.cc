@@ -0,0 +1,474 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the overhead of running the same graphs with DirectSession, the
+// TFRT GraphExecutor and the MLRT interpreter.
+//
+// Every benchmark is run for each runtime, selected by its first argument,
+// over a family of graphs sized by its second argument: chains of dependent
+// ops, wide fan-outs of independent ops, functional while loops and batch
+// functions. The ops do almost no work, so the step time is dominated by the
+// runtime. Besides the mean step time, each benchmark reports:
+//   ns_per_op: the mean step time divided by the number of ops run per step.
+//   p50_ns, p99_ns and p999_ns: percentiles of the step time.
+//
+// Run with e.g. --benchmark_filter=BM_Chain.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
+#include "tensorflow/core/tfrt/graph_executor/graph_executor.h"
+#include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
+#include "tensorflow/core/tfrt/mlrt/kernel/batch_kernel.h"
+#include "tensorflow/core/tfrt/mlrt/kernel/kernel.h"
+#include "tensorflow/core/tfrt/runtime/runtime.h"
+#include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tfrt/host_context/resource_context.h"  // from @tf_runtime
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+// The number of inter-op threads of every runtime.
+constexpr int kNumThreads = 4;
+
+// The runtimes to compare, as the first argument of the benchmarks.
+enum RuntimeKind : int64_t {
+  kDirectSession = 0,
+  kGraphExecutor = 1,
+  kMlrt = 2,
+};
+
+const char* RuntimeName(int64_t runtime) {
+  switch (runtime) {
+    case kDirectSession:
+      return "DirectSession";
+    case kGraphExecutor:
+      return "GraphExecutor";
+    case kMlrt:
+      return "MLRT";
+  }
+  return "Unknown";
+}
+
+// A graph to run, with its feeds and fetches.
+struct Workload {
+  GraphDef graph_def;
+  std::vector<std::pair<std::string, Tensor>> inputs;
+  std::vector<std::string> output_names;
+  // The number of ops run by a step, for the per-op overhead.
+  int64_t num_ops = 1;
+};
+
+// Runs a graph with one of the runtimes.
+class GraphRunner {
+ public:
+  virtual ~GraphRunner() = default;
+
+  virtual absl::Status Run(
+      const std::vector<std::pair<std::string, Tensor>>& inputs,
+      const std::vector<std::string>& output_names,
+      std::vector<Tensor>* outputs) = 0;
+};
+
+class DirectSessionRunner : public GraphRunner {
+ public:
+  static absl::StatusOr<std::unique_ptr<GraphRunner>> Create(
+      const GraphDef& graph_def) {
+    SessionOptions options;
+    options.config.set_inter_op_parallelism_threads(kNumThreads);
+    std::unique_ptr<Session> session(NewSession(options));
+    if (session == nullptr) {
+      return absl::InternalError("Failed to create a DirectSession.");
+    }
+    TF_RETURN_IF_ERROR(session->Create(graph_def));
+    return std::unique_ptr<GraphRunner>(
+        new DirectSessionRunner(std::move(session)));
+  }
+
+  ~DirectSessionRunner() override { session_->Close().IgnoreError(); }
+
+  absl::Status Run(const std::vector<std::pair<std::string, Tensor>>& inputs,
+                   const std::vector<std::string>& output_names,
+                   std::vector<Tensor>* outputs) override {
+    return session_->Run(inputs, output_names, /*target_tensor_names=*/{},
+                         outputs);
+  }
+
+ private:
+  explicit DirectSessionRunner(std::unique_ptr<Session> session)
+      : session_(std::move(session)) {}
+
+  std::unique_ptr<Session> session_;
+};
+
+class GraphExecutorRunner : public GraphRunner {
+ public:
+  static absl::StatusOr<std::unique_ptr<GraphRunner>> Create(
+      const GraphDef& graph_def, bool enable_mlrt) {
+    std::unique_ptr<GraphExecutorRunner> runner(new GraphExecutorRunner());
+    runner->runtime_ = DefaultTfrtRuntime(kNumThreads);
+    GraphExecutor::Options options(runner->runtime_.get());
+    options.enable_mlrt = enable_mlrt;
+    TF_ASSIGN_OR_RETURN(
+        auto fallback_state,
+        FallbackState::Create(CreateDefaultSessionOptions(options),
+                              graph_def.library()));
+    auto kernel_registry = std::make_unique<mlrt::KernelRegistry>();
+    tf_mlrt::RegisterTfMlrtKernels(*kernel_registry);
+    tf_mlrt::RegisterTfMlrtBatchKernels(*kernel_registry);
+    TF_ASSIGN_OR_RETURN(
+        runner->graph_executor_,
+        GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                              std::make_unique<tfrt::ResourceContext>(),
+                              graph_def, std::move(kernel_registry)));
+    return std::unique_ptr<GraphRunner>(std::move(runner));
+  }
+
+  absl::Status Run(const std::vector<std::pair<std::string, Tensor>>& inputs,
+                   const std::vector<std::string>& output_names,
+                   std::vector<Tensor>* outputs) override {
+    return graph_executor_->Run(/*run_options=*/{}, inputs, output_names,
+                                /*target_tensor_names=*/{}, outputs);
+  }
+
+ private:
+  GraphExecutorRunner() = default;
+
+  // The runtime is declared first so that it outlives the executor.
+  std::unique_ptr<Runtime> runtime_;
+  std::unique_ptr<GraphExecutor> graph_executor_;
+};
+
+absl::StatusOr<std::unique_ptr<GraphRunner>> CreateRunner(
+    int64_t runtime, const GraphDef& graph_def) {
+  switch (runtime) {
+    case kDirectSession:
+      return DirectSessionRunner::Create(graph_def);
+    case kGraphExecutor:
+      return GraphExecutorRunner::Create(graph_def, /*enable_mlrt=*/false);
+    case kMlrt:
+      return GraphExecutorRunner::Create(graph_def, /*enable_mlrt=*/true);
+  }
+  return absl::InvalidArgumentError(absl::StrCat("Unknown runtime ", runtime));
+}
+
+Tensor FloatTensor(const TensorShape& shape, float value) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setConstant(value);
+  return tensor;
+}
+
+// Sets the per-op overhead and the percentiles of `latencies`, which are
+// step times in nanoseconds, as counters of `state`.
+void ReportLatencies(::testing::benchmark::State& state, int64_t num_ops,
+                     std::vector<int64_t>* latencies) {
+  if (latencies->empty()) return;
+  std::sort(latencies->begin(), latencies->end());
+  const auto percentile = [latencies](double p) {
+    const size_t index = std::min(
+        latencies->size() - 1, static_cast<size_t>(p * latencies->size()));
+    return static_cast<double>((*latencies)[index]);
+  };
+  const double mean =
+      std::accumulate(latencies->begin(), latencies->end(), 0.0) /
+      latencies->size();
+  state.counters["ns_per_op"] = mean / num_ops;
+  state.counters["p50_ns"] = percentile(0.5);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p999_ns"] = percentile(0.999);
+}
+
+// Runs `workload` with the runtime selected by the first argument of the
+// benchmark, and reports the distribution of its step times.
+void RunWorkload(::testing::benchmark::State& state,
+                 const absl::StatusOr<Workload>& workload) {
+  const int64_t runtime = state.range(0);
+  state.SetLabel(RuntimeName(runtime));
+  if (!workload.ok()) {
+    state.SkipWithError(workload.status().ToString().c_str());
+    return;
+  }
+  absl::StatusOr<std::unique_ptr<GraphRunner>> runner =
+      CreateRunner(runtime, workload->graph_def);
+  if (!runner.ok()) {
+    state.SkipWithError(runner.status().ToString().c_str());
+    return;
+  }
+
+  // The first run prunes and compiles the graph, so it is not measured.
+  std::vector<Tensor> outputs;
+  absl::Status status =
+      (*runner)->Run(workload->inputs, workload->output_names, &outputs);
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(state.max_iterations);
+  Env* env = Env::Default();
+  for (auto s : state) {
+    outputs.clear();
+    const uint64_t start = env->NowNanos();
+    status = (*runner)->Run(workload->inputs, workload->output_names, &outputs);
+    latencies.push_back(env->NowNanos() - start);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(workload->num_ops * state.iterations());
+  ReportLatencies(state, workload->num_ops, &latencies);
+}
+
+// Registers a benchmark for every runtime and every size in `sizes`.
+void AddRuntimesAndSizes(::benchmark::internal::Benchmark* benchmark,
+                         const std::vector<int64_t>& sizes) {
+  benchmark->ArgNames({"runtime", "size"})->UseRealTime();
+  for (int64_t runtime : {kDirectSession, kGraphExecutor, kMlrt}) {
+    for (int64_t size : sizes) {
+      benchmark->ArgPair(runtime, size);
+    }
+  }
+}
+
+// A chain of `depth` dependent ops, alternating Mul and Div so that Grappler
+// does not fold them away. This emphasizes the per-op overhead of a runtime.
+absl::StatusOr<Workload> Chain(int depth) {
+  Scope scope = Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output input = ops::Placeholder(scope.WithOpName("input"), DT_FLOAT);
+  Output current = input;
+  for (int i = 0; i < depth; ++i) {
+    current = i % 2 == 0 ? Output(ops::Mul(scope, current, current))
+                         : Output(ops::Div(scope, current, current));
+  }
+  ops::Identity(scope.WithOpName("output"), current);
+
+  Workload workload;
+  TF_RETURN_IF_ERROR(scope.ToGraphDef(&workload.graph_def));
+  workload.inputs = {{"input", FloatTensor({1}, 1.0)}};
+  workload.output_names = {"output"};
+  workload.num_ops = depth + 1;
+  return workload;
+}
+
+static void BM_Chain(::testing::benchmark::State& state) {
+  RunWorkload(state, Chain(state.range(1)));
+}
+BENCHMARK(BM_Chain)->Apply([](::benchmark::internal::Benchmark* benchmark) {
+  AddRuntimesAndSizes(benchmark, {1, 16, 256, 4096});
+});
+
+// `width` independent ops reading the same input, whose outputs are packed.
+// This emphasizes the cost of scheduling ready ops.
+absl::StatusOr<Workload> FanOut(int width) {
+  Scope scope = Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output input = ops::Placeholder(scope.WithOpName("input"), DT_FLOAT);
+  std::vector<Output> branches;
+  branches.reserve(width);
+  for (int i = 0; i < width; ++i) {
+    // Distinct constants keep the branches from being deduplicated.
+    branches.push_back(
+        ops::Mul(scope, input, ops::Const(scope, static_cast<float>(i + 1))));
+  }
+  ops::Stack(scope.WithOpName("output"), branches);
+
+  Workload workload;
+  TF_RETURN_IF_ERROR(scope.ToGraphDef(&workload.graph_def));
+  workload.inputs = {{"input", FloatTensor({1}, 1.0)}};
+  workload.output_names = {"output"};
+  workload.num_ops = 2 * width + 1;
+  return workload;
+}
+
+static void BM_FanOut(::testing::benchmark::State& state) {
+  RunWorkload(state, FanOut(state.range(1)));
+}
+BENCHMARK(BM_FanOut)->Apply([](::benchmark::internal::Benchmark* benchmark) {
+  AddRuntimesAndSizes(benchmark, {1, 16, 256, 4096});
+});
+
+// A functional While op computing
+//
+//     i = input
+//     while (i < iterations)
+//       i += 1;
+//
+// which emphasizes the overhead of calling functions and of control flow.
+absl::StatusOr<Workload> WhileLoop(int iterations) {
+  FunctionDefLibrary library;
+  Tensor one(DT_INT32, TensorShape({}));
+  one.scalar<int32_t>()() = 1;
+  *library.add_function() = FunctionDefHelper::Define(
+      // Name
+      "XPlusOne",
+      // Args
+      {"x: int32"},
+      // Return values
+      {"y: int32"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"one"}, "Const", {}, {{"value", one}, {"dtype", DT_INT32}}},
+          {{"y"}, "Add", {"x", "one"}, {{"T", DT_INT32}}},
+      });
+  Tensor n(DT_INT32, TensorShape({}));
+  n.scalar<int32_t>()() = iterations;
+  *library.add_function() = FunctionDefHelper::Define(
+      // Name
+      "LessThanN",
+      // Args
+      {"x: int32"},
+      // Return values
+      {"z: bool"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"n"}, "Const", {}, {{"value", n}, {"dtype", DT_INT32}}},
+          {{"z"}, "Less", {"x", "n"}, {{"T", DT_INT32}}},
+      });
+
+  Scope scope = Scope::NewRootScope().WithDevice("/device:CPU:0");
+  TF_RETURN_IF_ERROR(scope.graph()->AddFunctionLibrary(library));
+  Output input = ops::Placeholder(scope.WithOpName("input"), DT_INT32,
+                                  ops::Placeholder::Shape({}));
+  NameAttrList cond;
+  cond.set_name("LessThanN");
+  NameAttrList body;
+  body.set_name("XPlusOne");
+  Node* while_node;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder("while", "While", &scope.graph()->flib_def())
+          .Input(std::vector<NodeBuilder::NodeOut>{input.node()})
+          .Attr("T", DataTypeVector{DT_INT32})
+          .Attr("cond", cond)
+          .Attr("body", body)
+          .Attr("output_shapes", std::vector<TensorShape>{TensorShape({})})
+          .Device("/device:CPU:0")
+          .Finalize(scope.graph(), &while_node));
+  ops::Identity(scope.WithOpName("output"), Output(while_node));
+
+  Workload workload;
+  TF_RETURN_IF_ERROR(scope.ToGraphDef(&workload.graph_def));
+  Tensor start(DT_INT32, TensorShape({}));
+  start.scalar<int32_t>()() = 0;
+  workload.inputs = {{"input", start}};
+  workload.output_names = {"output"};
+  // Two ops per evaluation of the condition and of the body, the While op
+  // and the Identity.
+  workload.num_ops = 2 * (iterations + 1) + 2 * iterations + 2;
+  return workload;
+}
+
+static void BM_WhileLoop(::testing::benchmark::State& state) {
+  RunWorkload(state, WhileLoop(state.range(1)));
+}
+BENCHMARK(BM_WhileLoop)->Apply([](::benchmark::internal::Benchmark* benchmark) {
+  AddRuntimesAndSizes(benchmark, {0, 1, 10, 100, 1000});
+});
+
+// A BatchFunction squaring a batch of `batch_size` rows. Requests are not
+// delayed for batching, so this emphasizes the overhead of the batch
+// scheduler and of splitting and merging the batches.
+absl::StatusOr<Workload> BatchFunction(int batch_size) {
+  FunctionDefLibrary library;
+  *library.add_function() = FunctionDefHelper::Define(
+      // Name
+      "BatchedSquare",
+      // Args
+      {"x: float"},
+      // Return values
+      {"y: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"y"}, "Square", {"x"}, {{"T", DT_FLOAT}}},
+      });
+
+  Scope scope = Scope::NewRootScope().WithDevice("/device:CPU:0");
+  TF_RETURN_IF_ERROR(scope.graph()->AddFunctionLibrary(library));
+  Output input =
+      ops::Placeholder(scope.WithOpName("input"), DT_FLOAT,
+                       ops::Placeholder::Shape({batch_size, 4}));
+  NameAttrList f;
+  f.set_name("BatchedSquare");
+  Node* batch_node;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder("batch", "BatchFunction", &scope.graph()->flib_def())
+          .Input(std::vector<NodeBuilder::NodeOut>{input.node()})
+          .Input(std::vector<NodeBuilder::NodeOut>{})
+          .Attr("f", f)
+          .Attr("num_batch_threads", 1)
+          .Attr("max_batch_size", batch_size)
+          .Attr("batch_timeout_micros", 0)
+          .Attr("shared_name", absl::StrCat("batch_", batch_size))
+          .Attr("Tin", DataTypeVector{DT_FLOAT})
+          .Attr("Tcaptured", DataTypeVector{})
+          .Attr("Tout", DataTypeVector{DT_FLOAT})
+          .Device("/device:CPU:0")
+          .Finalize(scope.graph(), &batch_node));
+  ops::Identity(scope.WithOpName("output"), Output(batch_node));
+
+  Workload workload;
+  TF_RETURN_IF_ERROR(scope.ToGraphDef(&workload.graph_def));
+  workload.inputs = {{"input", FloatTensor({batch_size, 4}, 2.0)}};
+  workload.output_names = {"output"};
+  workload.num_ops = 3;
+  return workload;
+}
+
+static void BM_BatchFunction(::testing::benchmark::State& state) {
+  RunWorkload(state, BatchFunction(state.range(1)));
+}
+BENCHMARK(BM_BatchFunction)
+    ->Apply([](::benchmark::internal::Benchmark* benchmark) {
+      AddRuntimesAndSizes(benchmark, {1, 16, 128});
+    });
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 #include "tsl/platform/threadpool.h"
 #include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
 
@@ -114,6 +115,15 @@ class IfrtModelContext {
     checkpoint_loader_queue_ = work_queue;
   }
 
+  // Batching options of the executables compiled for this model. Must be set
+  // before the model is compiled.
+  const IfrtServingBatchingOptions& batching_options() const {
+    return batching_options_;
+  }
+  void set_batching_options(IfrtServingBatchingOptions batching_options) {
+    batching_options_ = std::move(batching_options);
+  }
+
   // Freeze the model: release the resources such as host tensors that are used
   // by the device only. The caller guarantees all resources released in this
   // function is no longer in use in regular execution path.
@@ -135,6 +145,8 @@ class IfrtModelContext {
   // Dedicated work queue for heavy task such as variable tensor restoration.
   tfrt::ConcurrentWorkQueue* checkpoint_loader_queue_ = nullptr;
 
+  IfrtServingBatchingOptions batching_options_;
+
   std::vector<ServingExecutableRegistry::Handle> handles_;
 
   IfrtLoadedVariableRegistry loaded_variable_registry_;
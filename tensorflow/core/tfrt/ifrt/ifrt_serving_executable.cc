@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
@@ -64,6 +66,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
@@ -149,6 +153,70 @@ absl::StatusOr<std::vector<xla::ifrt::Device*>> GetAssignedDevices(
   return devices;
 }
 
+// Returns the key shared by the calls that can be batched with a call for
+// `inputs` and sets `num_rows` to its batch size, or returns nullopt if the
+// call cannot be batched.
+std::optional<std::string> GetBatchKey(
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices, int64_t* num_rows) {
+  std::string key;
+  *num_rows = -1;
+  int variable_index = 0;
+  for (int i = 0; i < inputs.size(); i++) {
+    const tensorflow::Tensor& input = inputs[i];
+    if (variable_index < variable_arg_indices.size() &&
+        i == variable_arg_indices[variable_index]) {
+      // Invalid variable keys are reported by the unbatched execution.
+      if (input.dtype() != tensorflow::DT_STRING ||
+          !tensorflow::TensorShapeUtils::IsScalar(input.shape())) {
+        return std::nullopt;
+      }
+      const tsl::tstring& name = input.scalar<tsl::tstring>()();
+      absl::StrAppend(&key, i, "v", name.size(), ":",
+                      absl::string_view(name.data(), name.size()), ";");
+      variable_index++;
+      continue;
+    }
+    if (input.dims() == 0 ||
+        (*num_rows >= 0 && input.dim_size(0) != *num_rows)) {
+      return std::nullopt;
+    }
+    *num_rows = input.dim_size(0);
+    absl::StrAppend(&key, i, "t", input.dtype());
+    for (int d = 1; d < input.dims(); ++d) {
+      absl::StrAppend(&key, ",", input.dim_size(d));
+    }
+    absl::StrAppend(&key, ";");
+  }
+  if (*num_rows <= 0) return std::nullopt;
+  return key;
+}
+
+int64_t GetPaddedBatchSize(const IfrtServingBatchingOptions& options,
+                           int64_t num_rows) {
+  for (const int64_t batch_size : options.allowed_batch_sizes) {
+    if (batch_size >= num_rows) return batch_size;
+  }
+  if (!options.allowed_batch_sizes.empty()) {
+    const int64_t max_batch_size = options.max_batch_size;
+    return (num_rows + max_batch_size - 1) / max_batch_size * max_batch_size;
+  }
+  return num_rows;
+}
+
+// Returns `num_rows` rows of zeros shaped like the rows of `input`.
+tensorflow::Tensor MakePadding(const tensorflow::Tensor& input,
+                               int64_t num_rows) {
+  tensorflow::TensorShape shape = input.shape();
+  shape.set_dim(0, num_rows);
+  tensorflow::Tensor padding(input.dtype(), shape);
+  if (tensorflow::DataTypeCanUseMemcpy(input.dtype())) {
+    std::memset(const_cast<char*>(padding.tensor_data().data()), 0,
+                padding.tensor_data().size());
+  }
+  return padding;
+}
+
 }  // namespace
 
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
@@ -420,6 +488,145 @@ bool IfrtServingExecutable::UsePortableExecution(
 absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
     absl::Span<const tensorflow::Tensor> inputs,
     absl::Span<const int> variable_arg_indices) {
+  const int64_t max_batch_size = batching_options_.max_batch_size;
+  if (max_batch_size <= 0) {
+    return ExecuteUnbatched(inputs, variable_arg_indices);
+  }
+  int64_t num_rows;
+  std::optional<std::string> batch_key =
+      GetBatchKey(inputs, variable_arg_indices, &num_rows);
+  if (!batch_key.has_value()) {
+    return ExecuteUnbatched(inputs, variable_arg_indices);
+  }
+
+  BatchTask task;
+  task.inputs = inputs;
+  task.num_rows = num_rows;
+  if (num_rows > max_batch_size ||
+      batching_options_.batch_timeout <= absl::ZeroDuration()) {
+    // Only pads the call, so that it reuses the executable of its bucket.
+    Batch batch;
+    batch.tasks.push_back(&task);
+    batch.num_rows = num_rows;
+    TF_RETURN_IF_ERROR(ExecuteBatch(batch, variable_arg_indices));
+    return std::move(task.outputs);
+  }
+  std::shared_ptr<Batch> batch;
+  bool is_leader = false;
+  {
+    absl::MutexLock lock(&batch_mutex_);
+    std::shared_ptr<Batch>& open_batch = open_batches_[*batch_key];
+    if (open_batch == nullptr ||
+        open_batch->num_rows + num_rows > max_batch_size) {
+      // Lets the batch that this call does not fit in start executing.
+      if (open_batch != nullptr) open_batch->closed = true;
+      open_batch = std::make_shared<Batch>();
+      is_leader = true;
+    }
+    batch = open_batch;
+    batch->tasks.push_back(&task);
+    batch->num_rows += num_rows;
+    if (batch->num_rows == max_batch_size) {
+      batch->closed = true;
+      open_batches_.erase(*batch_key);
+    }
+    if (is_leader) {
+      batch_mutex_.AwaitWithTimeout(absl::Condition(&batch->closed),
+                                    batching_options_.batch_timeout);
+      // A batch is removed from `open_batches_` whenever it is closed.
+      if (!batch->closed) {
+        batch->closed = true;
+        open_batches_.erase(*batch_key);
+      }
+    }
+  }
+
+  if (!is_leader) {
+    task.done.WaitForNotification();
+    return std::move(task.outputs);
+  }
+  // No call joins a closed batch, so its tasks can be read without the lock.
+  const absl::Status status = ExecuteBatch(*batch, variable_arg_indices);
+  for (BatchTask* batch_task : batch->tasks) {
+    if (!status.ok()) batch_task->outputs = status;
+    if (batch_task != &task) batch_task->done.Notify();
+  }
+  return std::move(task.outputs);
+}
+
+absl::Status IfrtServingExecutable::ExecuteBatch(
+    const Batch& batch, absl::Span<const int> variable_arg_indices) {
+  const int64_t padded_num_rows =
+      GetPaddedBatchSize(batching_options_, batch.num_rows);
+  if (batch.tasks.size() == 1 && padded_num_rows == batch.num_rows) {
+    batch.tasks[0]->outputs =
+        ExecuteUnbatched(batch.tasks[0]->inputs, variable_arg_indices);
+    return absl::OkStatus();
+  }
+
+  // All tasks have the same variables, so they are taken from the first one.
+  const absl::Span<const tensorflow::Tensor> first_inputs =
+      batch.tasks[0]->inputs;
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.reserve(first_inputs.size());
+  int variable_index = 0;
+  for (int i = 0; i < first_inputs.size(); i++) {
+    if (variable_index < variable_arg_indices.size() &&
+        i == variable_arg_indices[variable_index]) {
+      inputs.push_back(first_inputs[i]);
+      variable_index++;
+      continue;
+    }
+    std::vector<tensorflow::Tensor> parts;
+    parts.reserve(batch.tasks.size() + 1);
+    for (const BatchTask* task : batch.tasks) {
+      parts.push_back(task->inputs[i]);
+    }
+    if (padded_num_rows > batch.num_rows) {
+      parts.push_back(
+          MakePadding(first_inputs[i], padded_num_rows - batch.num_rows));
+    }
+    tensorflow::Tensor merged;
+    TF_RETURN_IF_ERROR(tensorflow::tensor::Concat(parts, &merged));
+    inputs.push_back(std::move(merged));
+  }
+
+  TF_ASSIGN_OR_RETURN(std::vector<tensorflow::Tensor> outputs,
+                      ExecuteUnbatched(inputs, variable_arg_indices));
+
+  std::vector<int64_t> sizes;
+  sizes.reserve(batch.tasks.size() + 1);
+  for (const BatchTask* task : batch.tasks) {
+    sizes.push_back(task->num_rows);
+  }
+  if (padded_num_rows > batch.num_rows) {
+    sizes.push_back(padded_num_rows - batch.num_rows);
+  }
+  std::vector<std::vector<tensorflow::Tensor>> task_outputs(
+      batch.tasks.size());
+  for (const tensorflow::Tensor& output : outputs) {
+    if (output.dims() == 0 || output.dim_size(0) != padded_num_rows) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Batched execution of program ", program_id_,
+          " expects outputs with a batch dimension of size ", padded_num_rows,
+          ", but got an output of shape ", output.shape().DebugString()));
+    }
+    std::vector<tensorflow::Tensor> pieces;
+    TF_RETURN_IF_ERROR(tensorflow::tensor::Split(output, sizes, &pieces));
+    for (int j = 0; j < batch.tasks.size(); j++) {
+      task_outputs[j].push_back(std::move(pieces[j]));
+    }
+  }
+  for (int j = 0; j < batch.tasks.size(); j++) {
+    batch.tasks[j]->outputs = std::move(task_outputs[j]);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<tensorflow::Tensor>>
+IfrtServingExecutable::ExecuteUnbatched(
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices) {
   for (int i = 1; i < variable_arg_indices.size(); i++) {
     if (variable_arg_indices[i] <= variable_arg_indices[i - 1]) {
       return absl::FailedPreconditionError(absl::StrCat(
@@ -30,6 +30,8 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
@@ -59,6 +61,25 @@ limitations under the License.
 namespace tensorflow {
 namespace ifrt_serving {
 
+// Options for merging concurrent calls to IfrtServingExecutable::Execute()
+// into one IFRT execution.  Calls are merged along dimension 0 (the batch
+// dimension) of their non-variable inputs, so batching must only be enabled
+// for programs that compute each row of their outputs from the same row of
+// those inputs, and whose outputs all have a batch dimension.
+struct IfrtServingBatchingOptions {
+  // The maximum number of rows in a merged execution.  Batching is disabled
+  // if 0.  Calls with more rows are executed on their own.
+  int64_t max_batch_size = 0;
+  // How long the first call of a batch waits for others to join it.  If 0,
+  // calls are not merged but still padded to `allowed_batch_sizes`.
+  absl::Duration batch_timeout = absl::Milliseconds(1);
+  // If non-empty, merged inputs are padded to the smallest of these sizes that
+  // fits them, to bound the number of distinct shapes compiled.  Calls with
+  // more than max_batch_size rows are padded to a multiple of it.  Must be in
+  // ascending order, with max_batch_size as the last element.
+  std::vector<int64_t> allowed_batch_sizes;
+};
+
 class IfrtServingExecutable {
  public:
   IfrtServingExecutable(
@@ -72,7 +93,8 @@ class IfrtServingExecutable {
       tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
       tensorflow::StaticDeviceMgr* device_mgr,
       tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
-      IfrtServingCoreSelector* ifrt_serving_core_selector)
+      IfrtServingCoreSelector* ifrt_serving_core_selector,
+      IfrtServingBatchingOptions batching_options = {})
       : program_id_(program_id),
         model_name_(std::string(model_name)),
         signature_name_(std::string(signature_name)),
@@ -84,7 +106,8 @@ class IfrtServingExecutable {
         checkpoint_loader_queue_(checkpoint_loader_queue),
         device_mgr_(device_mgr),
         shape_representation_fn_(std::move(shape_representation_fn)),
-        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)) {}
+        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)),
+        batching_options_(std::move(batching_options)) {}
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -94,9 +117,15 @@ class IfrtServingExecutable {
 
   absl::string_view model_name() const { return model_name_; }
   absl::string_view signature_name() const { return signature_name_; }
+  const IfrtServingBatchingOptions& batching_options() const {
+    return batching_options_;
+  }
 
   // Executes the computation.
   // variable_arg_indices are in sorted order.
+  // If batching is enabled, concurrent calls with the same variables and the
+  // same input dtypes and shapes but for dimension 0 may run as one execution,
+  // on the core chosen by the core selector for it.
   absl::StatusOr<std::vector<tensorflow::Tensor>> Execute(
       absl::Span<const tensorflow::Tensor> inputs,
       absl::Span<const int> variable_arg_indices);
@@ -139,6 +168,21 @@ class IfrtServingExecutable {
         delete;
   };
 
+  // A call to Execute() waiting to be merged into a batch.
+  struct BatchTask {
+    absl::Span<const tensorflow::Tensor> inputs;
+    int64_t num_rows = 0;
+    absl::StatusOr<std::vector<tensorflow::Tensor>> outputs;
+    absl::Notification done;
+  };
+
+  // Calls with the same batch key, executed together by the first of them.
+  struct Batch {
+    std::vector<BatchTask*> tasks;
+    int64_t num_rows = 0;
+    bool closed = false;
+  };
+
   int64_t program_id_;
   using SharedCachedExecutableBundle = std::shared_ptr<CachedExecutableBundle>;
 
@@ -156,11 +200,26 @@ class IfrtServingExecutable {
   tensorflow::StaticDeviceMgr* device_mgr_;  // Not owned. For host callback.
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
   IfrtServingCoreSelector* ifrt_serving_core_selector_;
+  IfrtServingBatchingOptions batching_options_;
 
   mutable absl::Mutex mutex_;
   absl::flat_hash_map<Key, xla::ifrt::Future<SharedCachedExecutableBundle>>
       executable_bundles_ ABSL_GUARDED_BY(mutex_);
 
+  absl::Mutex batch_mutex_;
+  // The batches still accepting calls, by batch key.
+  absl::flat_hash_map<std::string, std::shared_ptr<Batch>> open_batches_
+      ABSL_GUARDED_BY(batch_mutex_);
+
+  // Executes the computation for a single call.
+  absl::StatusOr<std::vector<tensorflow::Tensor>> ExecuteUnbatched(
+      absl::Span<const tensorflow::Tensor> inputs,
+      absl::Span<const int> variable_arg_indices);
+
+  // Executes `batch` as one call and splits its outputs between its tasks.
+  absl::Status ExecuteBatch(const Batch& batch,
+                            absl::Span<const int> variable_arg_indices);
+
   // Asynchronously load the restored variable tensors to Ifrt array.
   absl::Status AsyncLoadIfrtArray(
       absl::Span<const tensorflow::Tensor> inputs,
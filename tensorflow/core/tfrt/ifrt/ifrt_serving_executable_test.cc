@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
@@ -405,6 +406,223 @@ TEST_F(IfrtServingExecutableTest, NoReturn) {
   ASSERT_EQ(result.size(), 0);
 }
 
+TEST_F(IfrtServingExecutableTest, BatchesConcurrentCalls) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable_add.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  int64_t program_id = 222222;
+  // Both calls run as one execution, on one selected core.
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(1)
+      .WillOnce(Return(tsl::DeviceReservation(0, /*selector=*/nullptr)));
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtLoadedVariableRegistry ifrt_loaded_variable_registry;
+  IfrtRestoreTensorRegistry ifrt_restore_tensor_registry;
+  std::unique_ptr<tfrt::ConcurrentWorkQueue> work_queue =
+      tfrt::CreateMultiThreadedWorkQueue(
+          /*num_threads=*/4, /*num_blocking_threads=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<tensorflow::StaticDeviceMgr> device_mgr,
+      CreateTfStaticDeviceMgr());
+
+  // The batch only closes once full.
+  IfrtServingBatchingOptions batching_options;
+  batching_options.max_batch_size = 2;
+  batching_options.batch_timeout = absl::Seconds(60);
+  IfrtServingExecutable executable(
+      program_id, "test", "main", std::move(mlir_module), client,
+      &GetThreadPool(), &ifrt_loaded_variable_registry,
+      &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
+      tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+      batching_options);
+
+  std::vector<std::vector<tensorflow::Tensor>> inputs{
+      {AsTensor<int32_t>({1, 2}, tensorflow::TensorShape({1, 2})),
+       AsTensor<int32_t>({10, 20}, tensorflow::TensorShape({1, 2}))},
+      {AsTensor<int32_t>({3, 4}, tensorflow::TensorShape({1, 2})),
+       AsTensor<int32_t>({30, 40}, tensorflow::TensorShape({1, 2}))}};
+  std::vector<absl::StatusOr<std::vector<tensorflow::Tensor>>> results(2);
+  {
+    tsl::thread::ThreadPool callers(tsl::Env::Default(), "callers", 2);
+    for (int i = 0; i < 2; ++i) {
+      callers.Schedule([&, i] {
+        results[i] = executable.Execute(absl::MakeSpan(inputs[i]), {});
+      });
+    }
+  }
+
+  ASSERT_EQ(executable.num_executables(), 1);
+  TF_ASSERT_OK(results[0].status());
+  TF_ASSERT_OK(results[1].status());
+  EXPECT_THAT(*results[0], ElementsAre(TensorEq(AsTensor<int32_t>(
+                               {11, 22}, tensorflow::TensorShape({1, 2})))));
+  EXPECT_THAT(*results[1], ElementsAre(TensorEq(AsTensor<int32_t>(
+                               {33, 44}, tensorflow::TensorShape({1, 2})))));
+}
+
+TEST_F(IfrtServingExecutableTest, PadsBatchesToAllowedSizes) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable_add.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  int64_t program_id = 333333;
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(2)
+      .WillRepeatedly(
+          [](::testing::Unused) { return tsl::DeviceReservation(0, nullptr); });
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtLoadedVariableRegistry ifrt_loaded_variable_registry;
+  IfrtRestoreTensorRegistry ifrt_restore_tensor_registry;
+  std::unique_ptr<tfrt::ConcurrentWorkQueue> work_queue =
+      tfrt::CreateMultiThreadedWorkQueue(
+          /*num_threads=*/4, /*num_blocking_threads=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<tensorflow::StaticDeviceMgr> device_mgr,
+      CreateTfStaticDeviceMgr());
+
+  IfrtServingBatchingOptions batching_options;
+  batching_options.max_batch_size = 4;
+  batching_options.batch_timeout = absl::Milliseconds(1);
+  batching_options.allowed_batch_sizes = {4};
+  IfrtServingExecutable executable(
+      program_id, "test", "main", std::move(mlir_module), client,
+      &GetThreadPool(), &ifrt_loaded_variable_registry,
+      &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
+      tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+      batching_options);
+
+  std::vector<tensorflow::Tensor> inputs1{
+      AsTensor<int32_t>({1, 2}, tensorflow::TensorShape({1, 2})),
+      AsTensor<int32_t>({10, 20}, tensorflow::TensorShape({1, 2}))};
+  std::vector<tensorflow::Tensor> inputs3{
+      AsTensor<int32_t>({1, 2, 3, 4, 5, 6}, tensorflow::TensorShape({3, 2})),
+      AsTensor<int32_t>({1, 1, 1, 1, 1, 1}, tensorflow::TensorShape({3, 2}))};
+
+  TF_ASSERT_OK_AND_ASSIGN(auto result1,
+                          executable.Execute(absl::MakeSpan(inputs1), {}));
+  TF_ASSERT_OK_AND_ASSIGN(auto result3,
+                          executable.Execute(absl::MakeSpan(inputs3), {}));
+
+  // Both calls were padded to 4 rows, so share one executable.
+  ASSERT_EQ(executable.num_executables(), 1);
+  EXPECT_THAT(result1, ElementsAre(TensorEq(AsTensor<int32_t>(
+                           {11, 22}, tensorflow::TensorShape({1, 2})))));
+  EXPECT_THAT(result3,
+              ElementsAre(TensorEq(AsTensor<int32_t>(
+                  {2, 3, 4, 5, 6, 7}, tensorflow::TensorShape({3, 2})))));
+}
+
+TEST_F(IfrtServingExecutableTest, PadsUnmergedCallsToAllowedSizes) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable_add.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  int64_t program_id = 444444;
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(3)
+      .WillRepeatedly(
+          [](::testing::Unused) { return tsl::DeviceReservation(0, nullptr); });
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtLoadedVariableRegistry ifrt_loaded_variable_registry;
+  IfrtRestoreTensorRegistry ifrt_restore_tensor_registry;
+  std::unique_ptr<tfrt::ConcurrentWorkQueue> work_queue =
+      tfrt::CreateMultiThreadedWorkQueue(
+          /*num_threads=*/4, /*num_blocking_threads=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<tensorflow::StaticDeviceMgr> device_mgr,
+      CreateTfStaticDeviceMgr());
+
+  IfrtServingBatchingOptions batching_options;
+  batching_options.max_batch_size = 2;
+  batching_options.batch_timeout = absl::ZeroDuration();
+  batching_options.allowed_batch_sizes = {2};
+  IfrtServingExecutable executable(
+      program_id, "test", "main", std::move(mlir_module), client,
+      &GetThreadPool(), &ifrt_loaded_variable_registry,
+      &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
+      tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+      batching_options);
+
+  std::vector<tensorflow::Tensor> inputs1{
+      AsTensor<int32_t>({1, 2}, tensorflow::TensorShape({1, 2})),
+      AsTensor<int32_t>({10, 20}, tensorflow::TensorShape({1, 2}))};
+  std::vector<tensorflow::Tensor> inputs2{
+      AsTensor<int32_t>({1, 2, 3, 4}, tensorflow::TensorShape({2, 2})),
+      AsTensor<int32_t>({1, 1, 1, 1}, tensorflow::TensorShape({2, 2}))};
+  std::vector<tensorflow::Tensor> inputs3{
+      AsTensor<int32_t>({1, 2, 3, 4, 5, 6}, tensorflow::TensorShape({3, 2})),
+      AsTensor<int32_t>({1, 1, 1, 1, 1, 1}, tensorflow::TensorShape({3, 2}))};
+
+  TF_ASSERT_OK_AND_ASSIGN(auto result1,
+                          executable.Execute(absl::MakeSpan(inputs1), {}));
+  TF_ASSERT_OK_AND_ASSIGN(auto result2,
+                          executable.Execute(absl::MakeSpan(inputs2), {}));
+  TF_ASSERT_OK_AND_ASSIGN(auto result3,
+                          executable.Execute(absl::MakeSpan(inputs3), {}));
+
+  // The first two calls were padded to 2 rows and the last one to 4 rows.
+  ASSERT_EQ(executable.num_executables(), 2);
+  EXPECT_THAT(result1, ElementsAre(TensorEq(AsTensor<int32_t>(
+                           {11, 22}, tensorflow::TensorShape({1, 2})))));
+  EXPECT_THAT(result2, ElementsAre(TensorEq(AsTensor<int32_t>(
+                           {2, 3, 4, 5}, tensorflow::TensorShape({2, 2})))));
+  EXPECT_THAT(result3,
+              ElementsAre(TensorEq(AsTensor<int32_t>(
+                  {2, 3, 4, 5, 6, 7}, tensorflow::TensorShape({3, 2})))));
+}
+
 TEST_P(VariableInputTest, InterleaveVariable) {
   // Create test input module
   constexpr absl::string_view kDataDirectory =
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/protobuf.h"  // IWYU pragma: keep
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
@@ -109,59 +112,13 @@ void MlrtIfrtRestoreVariableKernel::Invoke() {
   const int num_outputs = var_handles().size();
   DCHECK_EQ(num_outputs, tensor_names().tensor().NumElements());
   auto& fallback_request_state = context().fallback_request_state();
-  tensorflow::AttrValue dtypes_attr_value;
-  for (const auto& dtype : restored_dtypes()) {
-    dtypes_attr_value.mutable_list()->mutable_type()->Add(dtype);
-  }
-  // Use `tf.RestoreV2` to restore tensor. This will also populate
-  // tensorflow::ResourceManager.
-  // TODO(b/319045348): avoid populating tensorflow::ResourceManager if the
-  // variable is only used by device/IFRT.
-  // TODO(b/319045348): consider directly calling restore function such as that
-  // in /tensorflow/core/kernels/save_restore_v2_ops.cc
-  auto runner = tfrt_stub::OpKernelRunner::Create(
-                    /*op_name=*/
-                    "RestoreV2", /*node_name=*/"RestoreV2",
-                    context().params().device->name(),
-                    /*num_args=*/3,
-                    [&](tensorflow::AttrValueMap* attr_value_map) {
-                      attr_value_map->insert({"dtypes", dtypes_attr_value});
-                      return absl::OkStatus();
-                    },
-                    fallback_request_state.device_manager(),
-                    fallback_request_state.process_function_library_runtime())
-                    .value();
-
-  // Prepare the input tensors.
-  std::vector<tensorflow::TensorValue> input_tf_tensor_values;
-  input_tf_tensor_values.resize(arguments().size());
-  for (int i = 0; i < arguments().size(); ++i) {
-    auto& fallback_tensor =
-        arguments()[i].Get<tensorflow::tfrt_stub::FallbackTensor>();
-    input_tf_tensor_values[i].tensor = &fallback_tensor.tensor();
-  }
-
-  auto& params = context().params();
-  SetUpParams(runner, input_tf_tensor_values, params);
-
-  struct AsyncState {
-    explicit AsyncState(
-        const std::vector<tensorflow::TensorValue>& input_tf_tensor_values,
-        const OpKernelContext::Params& params, int num_outputs)
-        : run_state(input_tf_tensor_values, params),
-          context(&run_state.params, num_outputs) {}
-
-    tfrt_stub::OpKernelRunState run_state;
-    OpKernelContext context;
-    std::vector<xla::ifrt::Promise<tensorflow::Tensor>> results;
-  };
-  auto async_state =
-      std::make_unique<AsyncState>(input_tf_tensor_values, params, num_outputs);
-
-  async_state->results.reserve(num_outputs);
 
   ifrt_serving::IfrtRestoreTensorRegistry& ifrt_restore_tensor_registry =
       (*ifrt_model_context)->GetRestoreTensorRegistry();
+  std::vector<xla::ifrt::Promise<tensorflow::Tensor>> results;
+  std::vector<int64_t> restored_bytes;
+  results.reserve(num_outputs);
+  restored_bytes.reserve(num_outputs);
   for (int i = 0; i < num_outputs; ++i) {
     auto promise = xla::ifrt::Future<tensorflow::Tensor>::CreatePromise();
     auto future = xla::ifrt::Future<tensorflow::Tensor>(promise);
@@ -175,6 +132,8 @@ void MlrtIfrtRestoreVariableKernel::Invoke() {
       execution_context().Fail(dtype_and_shape.status());
       return;
     }
+    restored_bytes.push_back(dtype_and_shape->shape.num_elements() *
+                             DataTypeSize(dtype_and_shape->dtype));
     std::string runtime_name =
         ifrt_serving::GetRuntimeNameFromVarHandle(var_handle);
     ifrt_serving::IfrtRestoreTensorRegistry::RestoredTensorInfo
@@ -185,37 +144,143 @@ void MlrtIfrtRestoreVariableKernel::Invoke() {
         !status.ok()) {
       // Propagate errors so that if already-registered futures are being waited
       // on, they can be unblocked.
-      for (auto& result : async_state->results) {
+      for (auto& result : results) {
         std::move(result).Set(status);
       }
       execution_context().Fail(std::move(status));
       return;
     }
-    async_state->results.push_back(std::move(promise));
+    results.push_back(std::move(promise));
   }
 
   // Use dedicated work queue for restore operation.
-  DCHECK((*ifrt_model_context)->checkpoint_loader_queue() != nullptr);
-  (*ifrt_model_context)
-      ->checkpoint_loader_queue()
-      ->AddTask(
-          [runner = std::move(runner), async_state = std::move(async_state)]() {
-            auto* op_kernel_context_ptr = &async_state->context;
-            runner.Run(op_kernel_context_ptr);
-
-            auto& op_kernel_context = async_state->context;
-            if (!op_kernel_context.status().ok()) {
-              for (auto& result : async_state->results) {
-                std::move(result).Set(op_kernel_context.status());
-              }
-              return;
-            }
-            for (int i = 0; i < op_kernel_context.num_outputs(); ++i) {
-              DCHECK(op_kernel_context.mutable_output(i));
-              std::move(async_state->results[i])
-                  .Set(std::move(*op_kernel_context.mutable_output(i)));
-            }
-          });
+  tfrt::ConcurrentWorkQueue* checkpoint_loader_queue =
+      (*ifrt_model_context)->checkpoint_loader_queue();
+  DCHECK(checkpoint_loader_queue != nullptr);
+
+  // The variables are restored in contiguous chunks of similar sizes run in
+  // parallel, so that the variables of the first restored chunks are
+  // transferred to the devices while the other chunks are being read.
+  const int num_chunks = std::max(
+      1, std::min(num_outputs, checkpoint_loader_queue->GetParallelismLevel()));
+  int64_t total_bytes = 0;
+  for (int64_t bytes : restored_bytes) total_bytes += bytes;
+  const tensorflow::tfrt_stub::FallbackTensor all_tensor_names = tensor_names();
+  const tensorflow::tfrt_stub::FallbackTensor all_shape_and_slices =
+      shape_and_slices();
+  const tensorflow::tfrt_stub::FallbackTensor restore_prefix = prefix();
+  const auto dtypes = restored_dtypes();
+
+  struct AsyncState {
+    explicit AsyncState(
+        const std::vector<tensorflow::TensorValue>& input_tf_tensor_values,
+        const OpKernelContext::Params& params, int num_outputs)
+        : run_state(input_tf_tensor_values, params),
+          context(&run_state.params, num_outputs) {}
+
+    tfrt_stub::OpKernelRunState run_state;
+    OpKernelContext context;
+    std::vector<xla::ifrt::Promise<tensorflow::Tensor>> results;
+  };
+
+  // Copies the strings of `tensor` in [begin, end). Slicing would not keep
+  // their alignment.
+  const auto copy_strings = [](const tensorflow::Tensor& tensor, int begin,
+                               int end) {
+    tensorflow::Tensor result(tensorflow::DT_STRING,
+                              tensorflow::TensorShape({end - begin}));
+    auto result_strings = result.flat<tsl::tstring>();
+    const auto strings = tensor.flat<tsl::tstring>();
+    for (int i = begin; i < end; ++i) result_strings(i - begin) = strings(i);
+    return result;
+  };
+
+  int begin = 0;
+  int64_t restored_end_bytes = 0;
+  for (int chunk = 0; chunk < num_chunks && begin < num_outputs; ++chunk) {
+    // Each chunk takes at least one variable, and the last one takes all the
+    // remaining variables.
+    int end = begin + 1;
+    restored_end_bytes += restored_bytes[begin];
+    const int64_t chunk_end_bytes = total_bytes * (chunk + 1) / num_chunks;
+    while (end < num_outputs &&
+           (chunk == num_chunks - 1 ||
+            restored_end_bytes + restored_bytes[end] <= chunk_end_bytes)) {
+      restored_end_bytes += restored_bytes[end];
+      ++end;
+    }
+
+    tensorflow::AttrValue dtypes_attr_value;
+    for (int i = begin; i < end; ++i) {
+      dtypes_attr_value.mutable_list()->mutable_type()->Add(dtypes[i]);
+    }
+    // Use `tf.RestoreV2` to restore tensor. This will also populate
+    // tensorflow::ResourceManager.
+    // TODO(b/319045348): avoid populating tensorflow::ResourceManager if the
+    // variable is only used by device/IFRT.
+    // TODO(b/319045348): consider directly calling restore function such as
+    // that in /tensorflow/core/kernels/save_restore_v2_ops.cc
+    absl::StatusOr<tfrt_stub::OpKernelRunner> runner =
+        tfrt_stub::OpKernelRunner::Create(
+            /*op_name=*/
+            "RestoreV2", /*node_name=*/"RestoreV2",
+            context().params().device->name(),
+            /*num_args=*/3,
+            [&](tensorflow::AttrValueMap* attr_value_map) {
+              attr_value_map->insert({"dtypes", dtypes_attr_value});
+              return absl::OkStatus();
+            },
+            fallback_request_state.device_manager(),
+            fallback_request_state.process_function_library_runtime());
+    if (!runner.ok()) {
+      for (int i = begin; i < num_outputs; ++i) {
+        std::move(results[i]).Set(runner.status());
+      }
+      execution_context().Fail(runner.status());
+      return;
+    }
+
+    // Prepare the input tensors.
+    tensorflow::Tensor input_tensors[] = {
+        restore_prefix.tensor(),
+        copy_strings(all_tensor_names.tensor(), begin, end),
+        copy_strings(all_shape_and_slices.tensor(), begin, end)};
+    std::vector<tensorflow::TensorValue> input_tf_tensor_values;
+    input_tf_tensor_values.reserve(3);
+    for (auto& input_tensor : input_tensors) {
+      input_tf_tensor_values.emplace_back(&input_tensor);
+    }
+
+    auto& params = context().params();
+    SetUpParams(*runner, input_tf_tensor_values, params);
+
+    auto async_state = std::make_unique<AsyncState>(input_tf_tensor_values,
+                                                    params, end - begin);
+    async_state->results.reserve(end - begin);
+    for (int i = begin; i < end; ++i) {
+      async_state->results.push_back(std::move(results[i]));
+    }
+
+    checkpoint_loader_queue->AddTask([runner = *std::move(runner),
+                                      async_state = std::move(async_state)]() {
+      auto* op_kernel_context_ptr = &async_state->context;
+      runner.Run(op_kernel_context_ptr);
+
+      auto& op_kernel_context = async_state->context;
+      if (!op_kernel_context.status().ok()) {
+        for (auto& result : async_state->results) {
+          std::move(result).Set(op_kernel_context.status());
+        }
+        return;
+      }
+      for (int i = 0; i < op_kernel_context.num_outputs(); ++i) {
+        DCHECK(op_kernel_context.mutable_output(i));
+        std::move(async_state->results[i])
+            .Set(std::move(*op_kernel_context.mutable_output(i)));
+      }
+    });
+    begin = end;
+  }
 }
 
 class MlrtIfrtLoadVariableKernel : public mlrt::KernelFrame {
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -140,6 +143,8 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       pending_tasks_(0),
+      max_blocking_inflight_(std::numeric_limits<int64_t>::max()),
+      start_time_us_(0),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -327,6 +332,22 @@ void ThreadWorkSource::DecrementPendingTaskCount() {
   pending_tasks_.fetch_sub(1, std::memory_order_release);
 }
 
+int64_t ThreadWorkSource::GetMaxBlockingInflight() {
+  return max_blocking_inflight_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetMaxBlockingInflight(int64_t value) {
+  max_blocking_inflight_.store(value, std::memory_order_relaxed);
+}
+
+uint64_t ThreadWorkSource::GetStartTimeUs() {
+  return start_time_us_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetStartTimeUs(uint64_t value) {
+  start_time_us_.store(value, std::memory_order_relaxed);
+}
+
 unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
@@ -356,6 +377,9 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      num_fast_lane_threads_(
+          std::min(options.num_fast_lane_threads, num_blocking_threads_)),
+      fast_lane_max_request_age_(options.fast_lane_max_request_age_micro_sec),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -482,7 +506,8 @@ Task RunHandlerThreadPool::FindTask(
     int sub_thread_pool_id, int max_blocking_inflight,
     bool may_steal_blocking_work,
     const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
-    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+    bool* task_from_blocking_queue, ThreadWorkSource** tws,
+    uint64_t min_start_time_us) {
   Task t;
   int current_index = thread_data_[thread_id].current_index;
   *task_from_blocking_queue = false;
@@ -494,10 +519,15 @@ Task RunHandlerThreadPool::FindTask(
     }
     *tws = thread_work_sources[current_index];
     ++current_index;
+    if (min_start_time_us > 0 && (*tws)->GetStartTimeUs() < min_start_time_us) {
+      continue;
+    }
 
     // For blocking thread, search for blocking tasks first.
     if (may_steal_blocking_work &&
-        (*tws)->GetInflightTaskCount(true) < max_blocking_inflight) {
+        (*tws)->GetInflightTaskCount(true) <
+            std::min<int64_t>(max_blocking_inflight,
+                              (*tws)->GetMaxBlockingInflight())) {
       t = (*tws)->PopBlockingTask();
       if (t.f) {
         *task_from_blocking_queue = true;
@@ -543,7 +573,17 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         thread_data_[thread_id].current_thread_work_sources.get();
     sub_thread_pool_id = thread_data_[thread_id].sub_thread_pool_id;
     int active_requests = thread_work_sources->size();
-    if (may_steal_blocking_work) {
+    if (may_steal_blocking_work &&
+        thread_id >= num_blocking_threads_ - num_fast_lane_threads_) {
+      // Fast lane threads only run the tasks of recent requests.
+      const uint64_t now = tensorflow::EnvTime::NowMicros();
+      t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
+                   kMaxBlockingInflight,
+                   /*may_steal_blocking_work=*/true, *thread_work_sources,
+                   &task_from_blocking_queue, &tws,
+                   /*min_start_time_us=*/
+                   std::max<int64_t>(now - fast_lane_max_request_age_, 1));
+    } else if (may_steal_blocking_work) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
       int search_range_start =
@@ -732,7 +772,9 @@ class RunHandlerPool::Impl {
                 options.use_adaptive_waiting_time, options.enable_wake_up,
                 options.max_concurrent_handler,
                 options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
+                options.sub_thread_request_percentage,
+                options.num_fast_lane_threads,
+                options.fast_lane_max_request_age_micro_sec),
             tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
@@ -1016,6 +1058,10 @@ void RunHandler::Impl::Reset(int64_t step_id,
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetStartTimeUs(start_time_us_);
+  tws_.SetMaxBlockingInflight(options.max_inter_op_threads > 0
+                                  ? options.max_inter_op_threads
+                                  : std::numeric_limits<int64_t>::max());
 }
 
 int RunHandler::Impl::RunHandlerEigenThreadPool::NumThreads() const {
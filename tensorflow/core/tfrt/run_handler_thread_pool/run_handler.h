@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_RUN_HANDLER_THREAD_POOL_RUN_HANDLER_H_
 #define TENSORFLOW_CORE_TFRT_RUN_HANDLER_THREAD_POOL_RUN_HANDLER_H_
 
+#include <atomic>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -48,6 +50,11 @@ struct RunHandlerOptions {
 
   // Request priority.
   int priority;
+
+  // The max number of inter-op tasks of the request run at the same time, so
+  // that an expensive request doesn't take all the inter-op threads. If 0, the
+  // pool's default limit is used.
+  int max_inter_op_threads = 0;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -108,6 +115,15 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // The number of inter-op threads, among `num_inter_op_threads`, reserved
+    // to the requests started less than `fast_lane_max_request_age_micro_sec`
+    // ago. They keep cheap requests from waiting for the threads busy with
+    // expensive ones.
+    int num_fast_lane_threads = 0;
+
+    // The age beyond which a request can no longer use the fast lane threads.
+    int64_t fast_lane_max_request_age_micro_sec = 1000;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -253,6 +269,16 @@ class ThreadWorkSource {
 
   void DecrementPendingTaskCount();
 
+  // The max number of blocking tasks run at the same time.
+  int64_t GetMaxBlockingInflight();
+
+  void SetMaxBlockingInflight(int64_t value);
+
+  // The start time of the request, in microseconds since unix epoch.
+  uint64_t GetStartTimeUs();
+
+  void SetStartTimeUs(uint64_t value);
+
   unsigned NonBlockingWorkShardingFactor();
 
   std::string ToString();
@@ -274,6 +300,9 @@ class ThreadWorkSource {
   // The number of tasks that are enqueued and not finished.
   std::atomic<int64_t> pending_tasks_;
 
+  std::atomic<int64_t> max_blocking_inflight_;
+  std::atomic<uint64_t> start_time_us_;
+
   Queue blocking_work_queue_;
   tensorflow::mutex blocking_queue_op_mu_;
   char pad_[128];
@@ -301,6 +330,11 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    // The last `num_fast_lane_threads` blocking threads only run the tasks of
+    // the requests started less than `fast_lane_max_request_age_micro_sec`
+    // ago.
+    int num_fast_lane_threads;
+    int64_t fast_lane_max_request_age_micro_sec;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -308,7 +342,9 @@ class RunHandlerThreadPool {
             bool use_adaptive_waiting_time, bool enable_wake_up,
             int max_concurrent_handler,
             const std::vector<int>& num_threads_in_sub_thread_pool,
-            const std::vector<double>& sub_thread_request_percentage)
+            const std::vector<double>& sub_thread_request_percentage,
+            int num_fast_lane_threads = 0,
+            int64_t fast_lane_max_request_age_micro_sec = 0)
         : num_blocking_threads(num_blocking_threads),
           num_non_blocking_threads(num_non_blocking_threads),
           wait_if_no_active_request(wait_if_no_active_request),
@@ -320,7 +356,10 @@ class RunHandlerThreadPool {
           enable_wake_up(enable_wake_up),
           max_concurrent_handler(max_concurrent_handler),
           num_threads_in_sub_thread_pool(num_threads_in_sub_thread_pool),
-          sub_thread_request_percentage(sub_thread_request_percentage) {}
+          sub_thread_request_percentage(sub_thread_request_percentage),
+          num_fast_lane_threads(num_fast_lane_threads),
+          fast_lane_max_request_age_micro_sec(
+              fast_lane_max_request_age_micro_sec) {}
   };
   struct PerThread {
     constexpr PerThread() : pool(nullptr), thread_id(-1) {}
@@ -361,13 +400,15 @@ class RunHandlerThreadPool {
 
   // Search tasks from Requets range searching_range_start to
   // searching_range_end. If there is no tasks in the search range and
-  // may_steal_blocking_work is true, then search from all requests.
+  // may_steal_blocking_work is true, then search from all requests. The
+  // requests started before min_start_time_us are skipped.
   Task FindTask(
       int searching_range_start, int searching_range_end, int thread_id,
       int sub_thread_pool_id, int max_blocking_inflight,
       bool may_steal_blocking_work,
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
-      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+      bool* task_from_blocking_queue, ThreadWorkSource** tws,
+      uint64_t min_start_time_us = 0);
 
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
@@ -399,6 +440,8 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const int num_fast_lane_threads_;
+  const int64_t fast_lane_max_request_age_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
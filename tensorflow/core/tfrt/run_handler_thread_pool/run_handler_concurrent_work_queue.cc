@@ -56,12 +56,16 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.num_fast_lane_threads = options.num_fast_lane_threads;
+  pool_options.fast_lane_max_request_age_micro_sec =
+      options.fast_lane_max_request_age_micro_sec;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
 absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
 RunHandlerThreadWorkQueue::InitializeRequest(int64_t request_id) const {
   RunHandlerOptions options;
+  options.max_inter_op_threads = options_.max_main_threads_per_request;
   std::unique_ptr<RunHandler> handler =
       handler_pool_->Get(request_id, options_.init_timeout_ms, options);
   if (!handler) {
@@ -126,7 +130,12 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", max_main_threads_per_request = "
+              << options.max_main_threads_per_request
+              << ", num_fast_lane_threads = " << options.num_fast_lane_threads
+              << ", fast_lane_max_request_age_micro_sec = "
+              << options.fast_lane_max_request_age_micro_sec << "}";
 }
 
 }  // namespace tf
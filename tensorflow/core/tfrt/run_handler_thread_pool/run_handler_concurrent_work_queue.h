@@ -79,6 +79,17 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // The max number of main threads running the tasks of a request at the
+    // same time. If 0, only the default limit of the pool applies.
+    int max_main_threads_per_request = 0;
+
+    // The number of main threads reserved to the requests started less than
+    // `fast_lane_max_request_age_micro_sec` ago.
+    int num_fast_lane_threads = 0;
+
+    // The age beyond which a request can no longer use the fast lane threads.
+    int64_t fast_lane_max_request_age_micro_sec = 1000;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -484,6 +484,77 @@ TEST_P(RunHandlerThreadPoolTest, FindTask) {
   }
 }
 
+TEST_P(RunHandlerThreadPoolTest, FindTaskWithRequestLimits) {
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      internal::RunHandlerThreadPool::Options(
+          /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+          /*wait_if_no_active_request=*/true,
+          /*non_blocking_threads_sleep_time_micro_sec=*/250,
+          /*blocking_threads_max_sleep_time_micro_sec=*/250,
+          /*use_adaptive_waiting_time=*/true, /*enable_wake_up=*/true,
+          /*max_concurrent_handler=*/128,
+          /*num_threads_in_sub_thread_pool=*/{1},
+          /*sub_thread_request_percentage=*/{1}),
+      tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+      "tf_run_handler_pool", &waiters_mu, &waiters);
+
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(2);
+  thread_work_sources.resize(2);
+  for (int i = 0; i < 2; ++i) {
+    thread_work_sources[i] = new internal::ThreadWorkSource();
+    thread_work_sources[i]->SetWaiter(1, &waiters[0], &waiters_mu[0]);
+    thread_work_sources[i]->SetStartTimeUs(100 * (i + 1));
+  }
+
+  int result = -1;
+  run_handler_thread_pool.AddWorkToQueue(
+      thread_work_sources[0],
+      /*is_blocking=*/true, TaskFunction([&result] { result = 0; }));
+  run_handler_thread_pool.AddWorkToQueue(
+      thread_work_sources[1],
+      /*is_blocking=*/true, TaskFunction([&result] { result = 1; }));
+
+  const auto find_blocking_task = [&](uint64_t min_start_time_us,
+                                      internal::Task* t) {
+    internal::ThreadWorkSource* tws;
+    bool task_from_blocking_queue;
+    *t = run_handler_thread_pool.FindTask(
+        /*searching_range_start=*/0, /*searching_range_end=*/2,
+        /*thread_id=*/0,
+        /*sub_thread_pool_id=*/0, /*max_blocking_inflight=*/10,
+        /*may_steal_blocking_work=*/true, thread_work_sources,
+        &task_from_blocking_queue, &tws, min_start_time_us);
+  };
+
+  // The first request already runs as many blocking tasks as it may.
+  thread_work_sources[0]->SetMaxBlockingInflight(1);
+  thread_work_sources[0]->IncrementInflightTaskCount(/*is_blocking=*/true);
+  internal::Task t;
+  find_blocking_task(/*min_start_time_us=*/0, &t);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 1);
+  find_blocking_task(/*min_start_time_us=*/0, &t);
+  EXPECT_EQ(t.f, nullptr);
+
+  // The first request started too early to be found.
+  thread_work_sources[0]->DecrementInflightTaskCount(/*is_blocking=*/true);
+  find_blocking_task(/*min_start_time_us=*/150, &t);
+  EXPECT_EQ(t.f, nullptr);
+  find_blocking_task(/*min_start_time_us=*/50, &t);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 0);
+
+  for (int i = 0; i < 2; ++i) {
+    delete thread_work_sources[i];
+  }
+}
+
 TEST_P(RunHandlerThreadPoolTest, RoundRobinExecution) {
   Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
   waiters_mu.resize(1);
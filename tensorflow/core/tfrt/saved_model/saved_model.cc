@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -54,6 +55,9 @@ limitations under the License.
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/env.h"
@@ -451,6 +455,20 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   LOG(INFO) << "TFRT loading v1 savedmodel: " << saved_model_dir;
   tfrt::metrics::AddTFRTVersionMetric();
 
+  int64_t reserved_memory_bytes = 0;
+  if (options.memory_budget != nullptr) {
+    reserved_memory_bytes =
+        EstimateModelMemoryBytes(meta_graph_def.graph_def());
+    TF_RETURN_IF_ERROR(options.memory_budget->Reserve(
+        options.graph_execution_options.model_metadata.name(),
+        reserved_memory_bytes));
+  }
+  // Releases the reservation if the loading fails.
+  absl::Cleanup release_memory = [memory_budget = options.memory_budget,
+                                  reserved_memory_bytes]() {
+    if (memory_budget != nullptr) memory_budget->Release(reserved_memory_bytes);
+  };
+
   UpdateTpuTargetByBridgeCompatibility(options.graph_execution_options,
                                        meta_graph_def.graph_def());
   UpdateCompileOptions(options);
@@ -690,13 +708,16 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   }
 
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(symbol_uids), std::move(meta_graph_def),
       std::move(bef), std::move(bef_file), std::move(bytecode),
       std::move(loaded_executable),
       std::move(initializers_and_signatures.signature_map),
       std::move(runner_table), std::move(resource_array),
-      std::move(graph_executor))};
+      std::move(graph_executor));
+  saved_model->reserved_memory_bytes_ = reserved_memory_bytes;
+  std::move(release_memory).Cancel();
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
@@ -722,6 +743,70 @@ SavedModelImpl::SavedModelImpl(
     bytecode_ = std::move(bytecode);
     loaded_executable_ = std::move(loaded_executable);
   }
+  if (options_.enable_lazy_loading &&
+      options_.lazy_loading_use_graph_executor &&
+      options_.compile_signatures_in_background) {
+    background_compilation_thread_.reset(
+        tensorflow::Env::Default()->StartThread(
+            tensorflow::ThreadOptions(), "tfrt_signature_compilation",
+            [this]() { CompileSignatures(); }));
+  }
+}
+
+SavedModelImpl::~SavedModelImpl() {
+  // Skips the signatures not compiled yet and waits for the current one.
+  stop_background_compilation_ = true;
+  background_compilation_thread_.reset();
+  if (options_.memory_budget != nullptr) {
+    options_.memory_budget->Release(reserved_memory_bytes_);
+  }
+}
+
+void SavedModelImpl::CompileSignatures() {
+  const auto compile_start_time = absl::Now();
+  for (const auto& [name, signature] : signatures_) {
+    if (stop_background_compilation_) return;
+    const auto sig_iter = meta_graph_def_.signature_def().find(name);
+    if (sig_iter == meta_graph_def_.signature_def().end()) continue;
+    const tensorflow::SignatureDef& signature_def = sig_iter->second;
+
+    // Uses the sorted tensor names of the signature, so that the client graph
+    // is found by `GraphExecutor::Run()` for the requests of this signature.
+    std::vector<std::pair<std::string, tensorflow::DataType>> inputs;
+    inputs.reserve(signature.input_names.size());
+    for (int i = 0; i < signature.input_names.size(); ++i) {
+      const auto& tensor_info =
+          signature_def.inputs().at(signature.input_names[i]);
+      inputs.push_back({tensor_info.name(), signature.input_specs[i].dtype});
+    }
+    std::sort(inputs.begin(), inputs.end());
+    std::vector<std::string> input_tensor_names;
+    std::vector<tensorflow::DataType> input_tensor_dtypes;
+    for (const auto& [tensor_name, dtype] : inputs) {
+      input_tensor_names.push_back(tensor_name);
+      input_tensor_dtypes.push_back(dtype);
+    }
+    std::vector<std::string> output_tensor_names;
+    output_tensor_names.reserve(signature.output_names.size());
+    for (const auto& output_key : signature.output_names) {
+      output_tensor_names.push_back(
+          signature_def.outputs().at(output_key).name());
+    }
+    std::sort(output_tensor_names.begin(), output_tensor_names.end());
+
+    const Status status = graph_executor_->CompileGraph(
+        /*graph_name=*/"", input_tensor_names, input_tensor_dtypes,
+        output_tensor_names, /*target_tensor_names=*/{});
+    if (!status.ok()) {
+      // The first request of this signature will compile it again and report
+      // the error.
+      LOG(WARNING) << "TFRT failed to compile signature " << name
+                   << " in background: " << status;
+    }
+  }
+  LOG(INFO) << "TFRT finished compiling signatures in background. Took "
+            << absl::ToInt64Milliseconds(absl::Now() - compile_start_time)
+            << " ms.";
 }
 
 std::vector<std::string> SavedModelImpl::GetFunctionNames() const {
@@ -1136,5 +1221,46 @@ SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
   return LoadJoinedSignature(joined_signature);
 }
 
+absl::Status WarmUpWithSyntheticInputs(
+    SavedModel& saved_model, const SavedModel::RunOptions& run_options) {
+  const SessionMetadata& model_metadata = saved_model.model_metadata();
+  auto per_model_data =
+      std::make_unique<serving::WarmupStateRegistry::PerModelData>();
+  per_model_data->warmup_all_batch_sizes = true;
+  TF_ASSIGN_OR_RETURN(
+      serving::WarmupStateRegistry::Handle warmup_handle,
+      serving::GetGlobalWarmupStateRegistry().Register(
+          {model_metadata.name(), model_metadata.version()},
+          std::move(per_model_data)));
+
+  for (const std::string& name : saved_model.GetFunctionNames()) {
+    const std::optional<FunctionMetadata> function_metadata =
+        saved_model.GetFunctionMetadata(name);
+    if (!function_metadata.has_value()) continue;
+
+    std::vector<tensorflow::Tensor> inputs;
+    for (const TensorSpec& spec : function_metadata->GetInputSpecs()) {
+      tensorflow::TensorShape shape;
+      if (!spec.shape.unknown_rank()) {
+        for (const int64_t dim : spec.shape.dim_sizes()) {
+          TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim < 0 ? 1 : dim));
+        }
+      }
+      tensorflow::Tensor input(spec.dtype, shape);
+      if (DataTypeCanUseMemcpy(spec.dtype)) {
+        std::memset(const_cast<char*>(input.tensor_data().data()), 0,
+                    input.tensor_data().size());
+      }
+      inputs.push_back(std::move(input));
+    }
+
+    LOG(INFO) << "Warming up signature " << name << " of model "
+              << model_metadata.name() << " with synthetic inputs.";
+    std::vector<tensorflow::Tensor> outputs;
+    TF_RETURN_IF_ERROR(saved_model.Run(run_options, name, inputs, &outputs));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 #define TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -107,9 +109,22 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/279197040 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // If true, the lazy loading path using tfrt_stub::GraphExecutor compiles
+    // the client graphs of all the signatures in a background thread once the
+    // saved model is loaded, so that the first requests of each signature
+    // don't wait for its compilation. The requests arriving while their
+    // signature is being compiled wait for that compilation.
+    bool compile_signatures_in_background = false;
+
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If set, loading fails with a ResourceExhausted error when the estimated
+    // memory of the model (see `EstimateModelMemoryBytes()`) does not fit in
+    // this budget, which can be shared by the models loaded in the process.
+    // The memory is reserved until the saved model is destroyed.
+    std::shared_ptr<SavedModelMemoryBudget> memory_budget;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -193,6 +208,14 @@ class SavedModel {
   std::unique_ptr<GraphExecutor> graph_executor_;
 };
 
+// Warms up `saved_model` by running each of its signatures once on synthetic
+// inputs: zeros (or empty strings) whose unknown dimensions have size 1. The
+// model is registered in the global WarmupStateRegistry meanwhile, so that its
+// batch ops also run a batch of each of their allowed batch sizes, which
+// compiles and autotunes all the padded shapes before the model serves.
+absl::Status WarmUpWithSyntheticInputs(
+    SavedModel& saved_model, const SavedModel::RunOptions& run_options = {});
+
 using SignatureMap = absl::flat_hash_map<std::string, internal::Signature>;
 using ::tensorflow::StatusOr;
 
@@ -228,7 +251,7 @@ class SavedModelImpl final : public SavedModel {
       std::unique_ptr<tfd::FallbackResourceArray> resource_array,
       std::unique_ptr<GraphExecutor> graph_executor);
 
-  ~SavedModelImpl() override = default;
+  ~SavedModelImpl() override;
 
   SavedModelImpl(const SavedModelImpl&) = delete;
   SavedModelImpl& operator=(const SavedModelImpl&) = delete;
@@ -300,6 +323,10 @@ class SavedModelImpl final : public SavedModel {
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Compiles the client graphs running each signature by itself, unless
+  // `stop_background_compilation_` is set.
+  void CompileSignatures();
+
   SymbolUids symbol_uids_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -324,6 +351,15 @@ class SavedModelImpl final : public SavedModel {
   absl::flat_hash_map<std::string /*joined_name*/,
                       std::unique_ptr<LoadingResult>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
+
+  // The thread running `CompileSignatures()` with
+  // `Options::compile_signatures_in_background`. It is the last member so that
+  // it is joined before the states it uses are destroyed.
+  // The bytes reserved in `Options::memory_budget`.
+  int64_t reserved_memory_bytes_ = 0;
+
+  std::atomic<bool> stop_background_compilation_ = false;
+  std::unique_ptr<tensorflow::Thread> background_compilation_thread_;
 };
 
 class SavedModelMiraImpl;
@@ -28,7 +28,9 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
@@ -49,7 +51,11 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/transforms/gpu_passes.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/status.h"
@@ -389,5 +395,76 @@ void RegisterTfrtDialectsForAot(mlir::DialectRegistry& registry) {
   tensorflow::RegisterGpuDialects(&registry);
 }
 
+namespace {
+
+// Returns the number of bytes of the variable or constant defined by `node`,
+// or 0 if it defines neither or their size is unknown.
+int64_t GetNodeMemoryBytes(const NodeDef& node) {
+  if (node.op() == "Const") {
+    const auto it = node.attr().find("value");
+    if (it == node.attr().end()) return 0;
+    const TensorProto& tensor = it->second.tensor();
+    if (!tensor.tensor_content().empty()) {
+      return tensor.tensor_content().size();
+    }
+    int64_t bytes = 0;
+    for (const auto& string_value : tensor.string_val()) {
+      bytes += string_value.size();
+    }
+    const PartialTensorShape shape(tensor.tensor_shape());
+    if (shape.IsFullyDefined()) {
+      bytes += shape.num_elements() * DataTypeSize(tensor.dtype());
+    }
+    return bytes;
+  }
+  if (node.op() == "VarHandleOp" || node.op() == "VariableV2" ||
+      node.op() == "Variable") {
+    const auto shape_it = node.attr().find("shape");
+    const auto dtype_it = node.attr().find("dtype");
+    if (shape_it == node.attr().end() || dtype_it == node.attr().end()) {
+      return 0;
+    }
+    const PartialTensorShape shape(shape_it->second.shape());
+    if (!shape.IsFullyDefined()) return 0;
+    return shape.num_elements() *
+           DataTypeSize(BaseType(dtype_it->second.type()));
+  }
+  return 0;
+}
+
+}  // namespace
+
+int64_t EstimateModelMemoryBytes(const GraphDef& graph_def) {
+  int64_t bytes = 0;
+  for (const NodeDef& node : graph_def.node()) {
+    bytes += GetNodeMemoryBytes(node);
+  }
+  for (const FunctionDef& function : graph_def.library().function()) {
+    for (const NodeDef& node : function.node_def()) {
+      bytes += GetNodeMemoryBytes(node);
+    }
+  }
+  return bytes;
+}
+
+absl::Status SavedModelMemoryBudget::Reserve(absl::string_view model_name,
+                                             int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  if (reserved_bytes_ + bytes > limit_bytes_) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Loading model ", model_name, " needs an estimated ", bytes,
+        " bytes, but only ", limit_bytes_ - reserved_bytes_, " of the ",
+        limit_bytes_, " bytes of the saved model memory budget are left."));
+  }
+  reserved_bytes_ += bytes;
+  return absl::OkStatus();
+}
+
+void SavedModelMemoryBudget::Release(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  reserved_bytes_ -= bytes;
+  DCHECK_GE(reserved_bytes_, 0);
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
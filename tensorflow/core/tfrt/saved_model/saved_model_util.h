@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_UTIL_H_
 #define TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_UTIL_H_
 
+#include <cstdint>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
@@ -146,6 +148,38 @@ CallableOptions CombineSignatureDefs(
 
 void RegisterTfrtDialectsForAot(mlir::DialectRegistry& registry);
 
+// Returns an estimate of the memory used by a model loaded from `graph_def`:
+// the sizes of its variables of known shape and of its constants, including
+// those of its functions. Activations are not included.
+int64_t EstimateModelMemoryBytes(const GraphDef& graph_def);
+
+// A memory budget shared by the saved models loaded in a process, so that
+// loading one more model fails instead of running the process out of memory.
+// It is thread-safe.
+class SavedModelMemoryBudget {
+ public:
+  explicit SavedModelMemoryBudget(int64_t limit_bytes)
+      : limit_bytes_(limit_bytes) {}
+
+  // Reserves `bytes` for `model_name`, or returns a ResourceExhausted error if
+  // they do not fit in the rest of the budget.
+  absl::Status Reserve(absl::string_view model_name, int64_t bytes);
+
+  // Releases `bytes` reserved by `Reserve()`.
+  void Release(int64_t bytes);
+
+  int64_t limit_bytes() const { return limit_bytes_; }
+  int64_t reserved_bytes() const {
+    absl::MutexLock lock(&mu_);
+    return reserved_bytes_;
+  }
+
+ private:
+  const int64_t limit_bytes_;
+  mutable absl::Mutex mu_;
+  int64_t reserved_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
 
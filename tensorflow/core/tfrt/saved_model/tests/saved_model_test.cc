@@ -181,6 +181,111 @@ TEST_P(SavedModelTest, OnlineCostAnalysis) {
               ::testing::ElementsAreArray({6}));
 }
 
+TEST(SavedModelTest, CompileSignaturesInBackground) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_use_graph_executor = true;
+  options.compile_signatures_in_background = true;
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_CHECK_OK(saved_model.status());
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+  // The signature is eventually run without compiling it in the request.
+  tfrt::SavedModel::RunOptions run_options;
+  run_options.disable_compilation = true;
+  std::vector<tensorflow::Tensor> outputs;
+  absl::Status status;
+  for (int i = 0; i < 600; ++i) {
+    status = (*saved_model)->Run(run_options, "toy", inputs, &outputs);
+    if (status.ok()) break;
+    absl::SleepFor(absl::Milliseconds(100));
+  }
+  TF_ASSERT_OK(status);
+  ASSERT_EQ(outputs.size(), 1);
+
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
+TEST(SavedModelTest, MemoryBudget) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.memory_budget = std::make_shared<SavedModelMemoryBudget>(
+      /*limit_bytes=*/1);
+
+  // The variable of the model does not fit in the budget.
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  EXPECT_EQ(saved_model.status().code(), absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(options.memory_budget->reserved_bytes(), 0);
+
+  options.memory_budget = std::make_shared<SavedModelMemoryBudget>(
+      /*limit_bytes=*/1 << 20);
+  saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                               /*tags=*/{"serve"});
+  TF_ASSERT_OK(saved_model.status());
+  EXPECT_GT(options.memory_budget->reserved_bytes(), 0);
+
+  // The reservation is released with the model.
+  saved_model->reset();
+  EXPECT_EQ(options.memory_budget->reserved_bytes(), 0);
+}
+
+TEST(SavedModelTest, WarmUpWithSyntheticInputs) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_use_graph_executor = true;
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_ASSERT_OK(saved_model.status());
+  TF_ASSERT_OK(WarmUpWithSyntheticInputs(**saved_model));
+
+  // The warmup compiled the signature.
+  tfrt::SavedModel::RunOptions run_options;
+  run_options.disable_compilation = true;
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
 TEST(SavedModelTest, BasicInlineExecution) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
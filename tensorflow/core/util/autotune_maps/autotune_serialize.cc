@@ -21,10 +21,13 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
@@ -43,26 +46,64 @@ using stream_executor::dnn::AlgorithmConfigProto;
 using stream_executor::dnn::AlgorithmDesc;
 using stream_executor::dnn::AlgorithmProto;
 
-template <typename Op>
-StatusOr<ConvMapProto> ConvMapToProto(
-    const AutotuneMap<ConvParameters, AutotuneEntry<Op>> &autotune_map) {
-  ConvMapProto proto;
+// Returns the parameters for `proto` on the device `ordinal` of `platform`.
+StatusOr<ConvParameters> ParametersFromProto(
+    se::Platform *platform, int ordinal, const ConvParametersProto &proto) {
+  return ConvParameters(ordinal, proto);
+}
+
+StatusOr<MatmulParameters> ParametersFromProto(
+    se::Platform *platform, int ordinal, const MatmulParametersProto &proto) {
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * stream_exec,
+                      platform->ExecutorForDevice(ordinal));
+  return MatmulParameters(stream_exec, proto);
+}
+
+// Returns the versions of the GPU driver, GPU runtime and DNN library of the
+// first GPU, which all the autotune results of this process are tied to.
+StatusOr<std::string> GetRuntimeIdentifier() {
+  TF_ASSIGN_OR_RETURN(
+      se::Platform * platform,
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()));
+  if (platform->VisibleDeviceCount() == 0) {
+    return errors::NotFound("No GPU is visible.");
+  }
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<se::DeviceDescription> device_desc,
+                      platform->DescriptionForDevice(0));
+  std::string dnn_version = "none";
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * stream_exec,
+                      platform->ExecutorForDevice(0));
+  if (stream_exec->AsDnn() != nullptr) {
+    TF_ASSIGN_OR_RETURN(se::dnn::VersionInfo version,
+                        stream_exec->AsDnn()->GetVersion());
+    dnn_version =
+        absl::StrCat(version.major_version(), ".", version.minor_version(), ".",
+                     version.patch());
+  }
+  return absl::StrCat("driver ", device_desc->driver_version(), ", runtime ",
+                      device_desc->runtime_version(), ", dnn ", dnn_version);
+}
+
+template <typename MapProto, typename Parameters, typename Op>
+StatusOr<MapProto> AutotuneMapToProto(
+    const AutotuneMap<Parameters, AutotuneEntry<Op>> &autotune_map) {
+  MapProto proto;
 
   // Deterministically sort the entries in autotune maps
   // according to the serialized string of ConvParametersProto in order to
   // enable deterministic serialization. The actual order is meaningless.
   //
   // This step also filters out duplicate entries (only device_id's are
-  // different) in the autotune maps. So that there is only one entry for a
-  // convolution operation with a specific GPU device type.
-  std::map<string, ConvMapProto::Entry> sorted_map;
+  // different) in the autotune maps. So that there is only one entry for an
+  // operation with a specific GPU device type.
+  std::map<string, typename MapProto::Entry> sorted_map;
 
   for (auto const &p : autotune_map.GetMap()) {
-    const ConvParameters &params = p.first;
-    const ConvParametersProto &params_proto = params.proto();
+    const Parameters &params = p.first;
+    const auto &params_proto = params.proto();
     VLOG(1) << "Reading: " << params.ToString();
 
-    ConvMapProto::Entry kv;
+    typename MapProto::Entry kv;
     *kv.mutable_key() = params_proto;
 
     if (p.second.is_algorithm_config()) {
@@ -84,16 +125,16 @@ StatusOr<ConvMapProto> ConvMapToProto(
   }
 
   for (auto const &p : sorted_map) {
-    ConvMapProto::Entry *kv = proto.add_kv_pairs();
+    typename MapProto::Entry *kv = proto.add_kv_pairs();
     *kv = p.second;
   }
   return proto;
 }
 
-template <typename Op>
-Status PopulateConvMap(
-    const ConvMapProto &m,
-    AutotuneMap<ConvParameters, AutotuneEntry<Op>> *autotune_map) {
+template <typename MapProto, typename Parameters, typename Op>
+Status PopulateAutotuneMap(
+    const MapProto &m, absl::string_view op_kind,
+    AutotuneMap<Parameters, AutotuneEntry<Op>> *autotune_map) {
   if (m.kv_pairs().size() == 0) {
     return OkStatus();
   }
@@ -110,20 +151,19 @@ Status PopulateConvMap(
   }
 
   std::set<std::string> unmatched_device_descs;
-  for (const ConvMapProto::Entry &kv : m.kv_pairs()) {
-    const ConvParametersProto &params_proto = kv.key();
+  for (const typename MapProto::Entry &kv : m.kv_pairs()) {
+    const auto &params_proto = kv.key();
     // Abort the loading process whenever there is an entry whose version number
     // doesn't match runtime version because the autotune results may be
     // incorrect.
-    if (params_proto.version() != ConvParameters::kVersion) {
-      VLOG(1) << "ConvParametersProto with the incompatible version:"
+    if (params_proto.version() != Parameters::kVersion) {
+      VLOG(1) << "Parameters proto with the incompatible version:"
               << params_proto.DebugString();
       return errors::Aborted(
-          "Aborted because the loaded autotune results for convolution "
-          "operations have a version different "
+          "Aborted because the loaded autotune results for ", op_kind,
+          " operations have a version different "
           "from runtime's version. Expected version: ",
-          ConvParameters::kVersion,
-          ". Actual version: ", params_proto.version());
+          Parameters::kVersion, ". Actual version: ", params_proto.version());
     }
 
     const AlgorithmConfigProto &algorithm_config_proto = kv.value();
@@ -152,7 +192,9 @@ Status PopulateConvMap(
       entry = AutotuneEntry<Op>(primary, fallback);
 #endif
 
-      autotune_map->Insert(ConvParameters(ordinal, params_proto), entry);
+      TF_ASSIGN_OR_RETURN(Parameters params,
+                          ParametersFromProto(platform, ordinal, params_proto));
+      autotune_map->Insert(params, entry);
     }
 
     if (!devices_matched) {
@@ -176,10 +218,19 @@ Status PopulateConvMap(
 Status SerializeAutotuneMaps(std::string *output) {
   AutotuneMapsProto proto;
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
-  TF_ASSIGN_OR_RETURN(*proto.mutable_conv_map(),
-                      ConvMapToProto(*ConvAutotuneMap::GetInstance()));
-  TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
-                      ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(
+      *proto.mutable_conv_map(),
+      AutotuneMapToProto<ConvMapProto>(*ConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(
+      *proto.mutable_fused_conv_map(),
+      AutotuneMapToProto<ConvMapProto>(*FusedConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(*proto.mutable_fused_matmul_map(),
+                      AutotuneMapToProto<MatmulMapProto>(
+                          *FusedMatmulAutotuneMap::GetInstance()));
+  StatusOr<std::string> runtime_identifier = GetRuntimeIdentifier();
+  if (runtime_identifier.ok()) {
+    proto.set_runtime_identifier(*std::move(runtime_identifier));
+  }
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
@@ -195,10 +246,24 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  if (!proto.runtime_identifier().empty()) {
+    StatusOr<std::string> runtime_identifier = GetRuntimeIdentifier();
+    if (runtime_identifier.ok() &&
+        *runtime_identifier != proto.runtime_identifier()) {
+      return errors::Aborted(
+          "Aborted because the loaded autotune results were autotuned with "
+          "different GPU library versions. Expected: ",
+          *runtime_identifier, ". Actual: ", proto.runtime_identifier());
+    }
+  }
+  TF_RETURN_IF_ERROR(PopulateAutotuneMap(proto.conv_map(), "convolution",
+                                         ConvAutotuneMap::GetInstance()));
+  TF_RETURN_IF_ERROR(PopulateAutotuneMap(proto.fused_conv_map(),
+                                         "convolution",
+                                         FusedConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(
-      PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
-  TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
-                                     FusedConvAutotuneMap::GetInstance()));
+      PopulateAutotuneMap(proto.fused_matmul_map(), "matmul",
+                          FusedMatmulAutotuneMap::GetInstance()));
   // TODO(b/189530096): Populate autotune maps for more ops.
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   return absl::OkStatus();
@@ -208,7 +273,34 @@ void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
+  FusedMatmulAutotuneMap::GetInstance()->ClearMap();
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &serialized));
+  return LoadSerializedAutotuneMaps(serialized);
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+  // Merges the results other processes saved since this one loaded them.
+  Status load_status = LoadAutotuneMapsFromFile(path);
+  if (!load_status.ok() && !errors::IsNotFound(load_status)) {
+    LOG(WARNING) << "Overwriting the autotune results at " << path
+                 << " that failed to load: " << load_status;
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+  // Writes to a temporary file that is then renamed, so that concurrent
+  // readers never see a partially written file.
+  std::string tmp_path = path;
+  if (!Env::Default()->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), tmp_path, serialized));
+  return Env::Default()->RenameFile(tmp_path, path);
+}
+
 }  // namespace tensorflow
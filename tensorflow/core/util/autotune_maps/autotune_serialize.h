@@ -43,6 +43,15 @@ Status SerializeAutotuneMaps(std::string* output);
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
+// Loads the autotune maps from the file at `path`, which may be on any
+// filesystem registered with Env (e.g. a URI), as written by
+// SaveAutotuneMapsToFile. Returns NotFound if there is no such file.
+Status LoadAutotuneMapsFromFile(const std::string& path);
+
+// Writes all the autotune maps to the file at `path`, merged with the ones the
+// file already holds, e.g. from other processes sharing it.
+Status SaveAutotuneMapsToFile(const std::string& path);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
@@ -181,6 +182,64 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that SaveAutotuneMapsToFile and LoadAutotuneMapsFromFile round trip
+// the conv and fused matmul autotune maps, and that saving merges the entries
+// already in the file.
+TEST(AutotuneSerializeTest, File) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_serialize_test_file");
+  EXPECT_THAT(LoadAutotuneMapsFromFile(path), StatusIs(error::NOT_FOUND));
+
+  ConvParameters conv_params = {GetStreamExec(),
+                                /*batch=*/1,
+                                /*in_depths=*/1,
+                                /*in=*/{{1, 1}},
+                                /*data_format=*/TensorFormat::FORMAT_NCHW,
+                                /*out_depths=*/1,
+                                /*filter=*/{{1, 1}},
+                                /*dilation=*/{{1, 1}},
+                                /*stride=*/{{1, 1}},
+                                /*padding=*/{{1, 1}},
+                                /*dtype=*/DataType::DT_INT8,
+                                /*group_count=*/1};
+  MatmulParameters matmul_params = {GetStreamExec(),
+                                    /*ab_dtype=*/DataType::DT_FLOAT,
+                                    /*c_dtype=*/DataType::DT_FLOAT,
+                                    /*trans_a=*/false,
+                                    /*trans_b=*/false,
+                                    /*m=*/16,
+                                    /*n=*/16,
+                                    /*k=*/16,
+                                    /*lda=*/16,
+                                    /*ldb=*/16,
+                                    /*ldc=*/16,
+                                    se::dnn::ActivationMode::kRelu};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> conv_entry(algorithm, absl::nullopt);
+  AutotuneEntry<se::dnn::FusedMatmulOp> matmul_entry(algorithm,
+                                                     absl::nullopt);
+  ConvAutotuneMap::GetInstance()->Insert(conv_params, conv_entry);
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+
+  // Another process autotunes a matmul and saves its results.
+  ResetAutotuneMaps();
+  FusedMatmulAutotuneMap::GetInstance()->Insert(matmul_params, matmul_entry);
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+  AutotuneEntry<se::dnn::ConvOp> loaded_conv_entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params, &loaded_conv_entry));
+  EXPECT_EQ(loaded_conv_entry, conv_entry);
+  AutotuneEntry<se::dnn::FusedMatmulOp> loaded_matmul_entry;
+  EXPECT_TRUE(FusedMatmulAutotuneMap::GetInstance()->Find(
+      matmul_params, &loaded_matmul_entry));
+  EXPECT_EQ(loaded_matmul_entry, matmul_entry);
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -16,11 +16,11 @@ limitations under the License.
 // For Google-internal use only.
 //
 // This file defines the map data structure for storing autotuning results for
-// fused_conv2d_bias_activation_op_kernels.
+// fused_conv2d_bias_activation_op_kernels and fused matmuls.
 //
-// The key of the map uniquely identifies a convolution operation that runs on a
-// particular device model while the value might be the autotuned algorithm we
-// choose for the conv.
+// The key of the map uniquely identifies a convolution or matmul operation that
+// runs on a particular device model while the value might be the autotuned
+// algorithm we choose for the op.
 //
 // This map will be merged after fused_conv2d_bias_activation_op_kernels is
 // merged into conv_ops_fused_impl.h (b/177365158, b/189530096)
@@ -54,6 +54,15 @@ using FusedConvAutotuneMap =
     AutotuneSingleton<ConvAutotuneGroup, ConvParameters,
                       AutotuneEntry<se::dnn::FusedConvOp>>;
 
+// A dummy type to group fused matmul autotune results together.
+struct FusedMatmulAutotuneGroup {
+  static string name() { return "FusedMatmul"; }
+};
+
+using FusedMatmulAutotuneMap =
+    AutotuneSingleton<FusedMatmulAutotuneGroup, MatmulParameters,
+                      AutotuneEntry<se::dnn::FusedMatmulOp>>;
+
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
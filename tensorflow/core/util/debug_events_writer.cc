@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/util/debug_events_writer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -36,6 +40,106 @@ void MaybeSetDebugEventTimestamp(DebugEvent* debug_event, Env* env) {
     debug_event->set_wall_time(env->NowMicros() / 1e6);
   }
 }
+
+// The number of flush signals received.  Only counted in the signal handler,
+// which must not lock or write files.
+std::atomic<int64_t> num_flush_signals{0};
+
+void HandleFlushSignal(int) {
+  num_flush_signals.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Installs the handler of the TF_DEBUG_EVENTS_FLUSH_SIGNAL signal, if any.
+void InstallFlushSignalHandler() {
+  static const bool installed = []() {
+    int64_t signal_number = 0;
+    Status s = ReadInt64FromEnvVar("TF_DEBUG_EVENTS_FLUSH_SIGNAL", 0,
+                                   &signal_number);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+      return false;
+    }
+    if (signal_number <= 0) return false;
+    if (std::signal(signal_number, HandleFlushSignal) == SIG_ERR) {
+      LOG(WARNING) << "Failed to install the tfdbg flush handler of signal "
+                   << signal_number;
+      return false;
+    }
+    return true;
+  }();
+  (void)installed;
+}
+
+// Returns whether `values`, the floating-point values of a tensor or its
+// summary, include an infinity or a NaN.
+template <typename T>
+bool AnyNonFinite(const Tensor& values, int64_t begin, int64_t end) {
+  const auto flat = values.flat<T>();
+  for (int64_t i = begin; i < std::min(end, flat.size()); ++i) {
+    if (!Eigen::numext::isfinite(flat(i))) return true;
+  }
+  return false;
+}
+
+template <typename T>
+bool AnyNonZero(const Tensor& values, int64_t begin, int64_t end) {
+  const auto flat = values.flat<T>();
+  for (int64_t i = begin; i < std::min(end, flat.size()); ++i) {
+    if (flat(i) != T(0)) return true;
+  }
+  return false;
+}
+
+// Returns whether a graph execution trace with `tensor_debug_mode` and
+// `tensor_value` reports an infinity or a NaN.  See TensorDebugMode for the
+// layouts of the summaries.
+bool ReportsNonFinite(int32_t tensor_debug_mode, const Tensor& tensor_value) {
+  int64_t begin;
+  int64_t end;
+  switch (tensor_debug_mode) {
+    case CURT_HEALTH:
+      begin = 1;
+      end = 2;
+      break;
+    case CONCISE_HEALTH:
+      begin = 2;
+      end = 5;
+      break;
+    case FULL_HEALTH:
+      begin = 5;
+      end = 8;
+      break;
+    case REDUCE_INF_NAN_THREE_SLOTS:
+      begin = 0;
+      end = 3;
+      break;
+    case FULL_TENSOR:
+      switch (tensor_value.dtype()) {
+        case DT_HALF:
+          return AnyNonFinite<Eigen::half>(tensor_value, 0, kint64max);
+        case DT_BFLOAT16:
+          return AnyNonFinite<bfloat16>(tensor_value, 0, kint64max);
+        case DT_FLOAT:
+          return AnyNonFinite<float>(tensor_value, 0, kint64max);
+        case DT_DOUBLE:
+          return AnyNonFinite<double>(tensor_value, 0, kint64max);
+        default:
+          return false;
+      }
+    default:
+      return false;
+  }
+  // The summary slots hold counts or flags, which are non-zero if the tensor
+  // has infinities or NaNs.
+  switch (tensor_value.dtype()) {
+    case DT_FLOAT:
+      return AnyNonZero<float>(tensor_value, begin, end);
+    case DT_DOUBLE:
+      return AnyNonZero<double>(tensor_value, begin, end);
+    default:
+      return false;
+  }
+}
 }  // namespace
 
 SingleDebugEventFileWriter::SingleDebugEventFileWriter(const string& file_path)
@@ -245,11 +349,14 @@ Status DebugEventsWriter::WriteExecution(Execution* execution) {
     string serialized;
     debug_event.SerializeToString(&serialized);
 
-    mutex_lock l(execution_buffer_mu_);
-    execution_buffer_.emplace_back(std::move(serialized));
-    if (execution_buffer_.size() > circular_buffer_size_) {
-      execution_buffer_.pop_front();
+    {
+      mutex_lock l(execution_buffer_mu_);
+      execution_buffer_.emplace_back(std::move(serialized));
+      if (execution_buffer_.size() > circular_buffer_size_) {
+        execution_buffer_.pop_front();
+      }
     }
+    MaybeFlushOnSignal();
     return absl::OkStatus();
   }
 }
@@ -270,11 +377,14 @@ Status DebugEventsWriter::WriteGraphExecutionTrace(
     string serialized;
     debug_event.SerializeToString(&serialized);
 
-    mutex_lock l(graph_execution_trace_buffer_mu_);
-    graph_execution_trace_buffer_.emplace_back(std::move(serialized));
-    if (graph_execution_trace_buffer_.size() > circular_buffer_size_) {
-      graph_execution_trace_buffer_.pop_front();
+    {
+      mutex_lock l(graph_execution_trace_buffer_mu_);
+      graph_execution_trace_buffer_.emplace_back(std::move(serialized));
+      if (graph_execution_trace_buffer_.size() > circular_buffer_size_) {
+        graph_execution_trace_buffer_.pop_front();
+      }
     }
+    MaybeFlushOnSignal();
     return absl::OkStatus();
   }
 }
@@ -296,7 +406,14 @@ Status DebugEventsWriter::WriteGraphExecutionTrace(
   }
   trace->set_device_name(device_name);
   tensor_value.AsProtoTensorContent(trace->mutable_tensor_proto());
-  return WriteGraphExecutionTrace(trace.release());
+  TF_RETURN_IF_ERROR(WriteGraphExecutionTrace(trace.release()));
+  if (circular_buffer_size_ > 0 && flush_on_non_finite_ &&
+      ReportsNonFinite(tensor_debug_mode, tensor_value)) {
+    // Saves the events leading to the infinity or NaN before they are
+    // overwritten in the circular buffers.
+    return FlushExecutionFiles();
+  }
+  return absl::OkStatus();
 }
 
 void DebugEventsWriter::WriteSerializedNonExecutionDebugEvent(
@@ -331,11 +448,27 @@ void DebugEventsWriter::WriteSerializedExecutionDebugEvent(
     (*writer)->WriteSerializedDebugEvent(debug_event_str);
   } else {
     // Circular buffer behavior.
-    mutex_lock l(*mu);
-    buffer->push_back(debug_event_str);
-    if (buffer->size() > circular_buffer_size_) {
-      buffer->pop_front();
+    {
+      mutex_lock l(*mu);
+      buffer->push_back(debug_event_str);
+      if (buffer->size() > circular_buffer_size_) {
+        buffer->pop_front();
+      }
     }
+    MaybeFlushOnSignal();
+  }
+}
+
+void DebugEventsWriter::MaybeFlushOnSignal() {
+  const int64_t num_signals = num_flush_signals.load(std::memory_order_relaxed);
+  if (num_flush_signals_seen_.load(std::memory_order_relaxed) == num_signals ||
+      num_flush_signals_seen_.exchange(num_signals) == num_signals) {
+    return;
+  }
+  Status s = FlushExecutionFiles();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to flush the tfdbg execution files on a signal: "
+                 << s;
   }
 }
 
@@ -493,7 +626,14 @@ DebugEventsWriter::DebugEventsWriter(const string& dump_root,
       graph_execution_trace_buffer_(),
       graph_execution_trace_buffer_mu_(),
       device_name_to_id_(),
-      device_mu_() {}
+      device_mu_() {
+  if (circular_buffer_size_ > 0) {
+    InstallFlushSignalHandler();
+    Status s = ReadBoolFromEnvVar("TF_DEBUG_EVENTS_FLUSH_ON_NON_FINITE", false,
+                                  &flush_on_non_finite_);
+    if (!s.ok()) LOG(WARNING) << s;
+  }
+}
 
 Status DebugEventsWriter::InitNonMetadataFile(DebugEventFileType type) {
   std::unique_ptr<SingleDebugEventFileWriter>* writer = nullptr;
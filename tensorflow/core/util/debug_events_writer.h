@@ -106,6 +106,14 @@ class DebugEventsWriter {
   //   circular_buffer_size: Circular buffer size (in number of DebugEvent
   //     protos). If set to a value <=0, will abolish the circular-buffer
   //     behavior.
+  //
+  // With a circular buffer, the buffered events are also written to their
+  // files, as by FlushExecutionFiles(), on either of these triggers:
+  //   - A graph execution trace reports an infinity or a NaN, if the
+  //     TF_DEBUG_EVENTS_FLUSH_ON_NON_FINITE environment variable is true.
+  //   - The process received the signal numbered by the
+  //     TF_DEBUG_EVENTS_FLUSH_SIGNAL environment variable (e.g. 10 for
+  //     SIGUSR1 on Linux), checked whenever an execution event is written.
   // Returns:
   //   A pointer to a DebugEventsWriter object: a per-dump_root singleton.
   static DebugEventsWriter* GetDebugEventsWriter(const string& dump_root,
@@ -235,6 +243,10 @@ class DebugEventsWriter {
 
   void SelectWriter(DebugEventFileType type,
                     std::unique_ptr<SingleDebugEventFileWriter>** writer);
+
+  // Flushes the execution files if a flush signal was received since the
+  // last call.
+  void MaybeFlushOnSignal();
   const string GetSuffix(DebugEventFileType type);
   string GetFileNameInternal(DebugEventFileType type);
 
@@ -247,6 +259,10 @@ class DebugEventsWriter {
   mutex initialization_mu_;
 
   const int64_t circular_buffer_size_;
+  // Whether traces reporting infinities or NaNs flush the execution files.
+  bool flush_on_non_finite_ = false;
+  // The number of flush signals received as of the last flush on a signal.
+  std::atomic<int64_t> num_flush_signals_seen_{0};
   std::deque<string> execution_buffer_ TF_GUARDED_BY(execution_buffer_mu_);
   mutex execution_buffer_mu_;
   std::deque<string> graph_execution_trace_buffer_
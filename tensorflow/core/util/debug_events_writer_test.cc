@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstdlib>
 #include <memory>
 #include <vector>
 
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -706,6 +708,45 @@ TEST_F(DebugEventsWriterTest, WriteGrahExecutionTraceWithCyclicBufferNoFlush) {
   TF_ASSERT_OK(writer->Close());
 }
 
+TEST_F(DebugEventsWriterTest, NonFiniteGraphExecutionTraceFlushesCyclicBuffer) {
+  setenv("TF_DEBUG_EVENTS_FLUSH_ON_NON_FINITE", "1", /*overwrite=*/1);
+  const size_t kCyclicBufferSize = 10;
+  DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
+      dump_root_, tfdbg_run_id_, kCyclicBufferSize);
+  unsetenv("TF_DEBUG_EVENTS_FLUSH_ON_NON_FINITE");
+  TF_ASSERT_OK(writer->Init());
+
+  // CURT_HEALTH summaries: [tensor_id, has_inf_or_nan].
+  Tensor summary(DT_FLOAT, TensorShape({2}));
+  summary.flat<float>()(1) = 0;
+  for (int i = 0; i < 3; ++i) {
+    summary.flat<float>()(0) = i;
+    TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+        "graph_0", "/device:CPU:0", strings::StrCat("op_", i), 0,
+        TensorDebugMode::CURT_HEALTH, summary));
+  }
+  std::vector<DebugEvent> actuals;
+  ReadDebugEventProtos(writer, DebugEventFileType::GRAPH_EXECUTION_TRACES,
+                       &actuals);
+  EXPECT_EQ(actuals.size(), 0);
+
+  summary.flat<float>()(0) = 3;
+  summary.flat<float>()(1) = 1;
+  TF_ASSERT_OK(writer->WriteGraphExecutionTrace(
+      "graph_0", "/device:CPU:0", "op_3", 0, TensorDebugMode::CURT_HEALTH,
+      summary));
+  ReadDebugEventProtos(writer, DebugEventFileType::GRAPH_EXECUTION_TRACES,
+                       &actuals);
+  ASSERT_EQ(actuals.size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(actuals[i].graph_execution_trace().op_name(),
+              strings::StrCat("op_", i));
+  }
+
+  // Close the writer so the files can be safely deleted.
+  TF_ASSERT_OK(writer->Close());
+}
+
 TEST_F(DebugEventsWriterTest, WriteGrahExecutionTraceWithoutPreviousInitCall) {
   const size_t kCyclicBufferSize = -1;
   DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
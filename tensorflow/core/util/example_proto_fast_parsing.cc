@@ -29,12 +29,14 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
@@ -117,6 +119,66 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Decodes a single varint starting at `p`, one byte at a time. Returns the
+// position past the varint, or nullptr if it is malformed or runs past `end`.
+inline const uint8* DecodeVarint64Fallback(const uint8* p, const uint8* end,
+                                           uint64* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 64 && p < end; shift += 7) {
+    const uint64 byte = *p++;
+    result |= (byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+// Decodes the packed varints in [p, end) and appends them to `result`.
+//
+// Instead of consuming one byte at a time through `CodedInputStream`, the
+// input is loaded eight bytes at a time and the continuation bits of the whole
+// word are inspected at once: a word without continuation bits holds eight
+// single-byte values, and otherwise the lowest clear continuation bit gives
+// the length of the next varint. Varints longer than eight bytes (e.g.
+// negative values) take the byte-at-a-time path.
+template <typename Result>
+bool DecodePackedVarint64(const uint8* p, const uint8* end, Result* result) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  while (p < end) {
+    if (end - p >= static_cast<ptrdiff_t>(sizeof(uint64))) {
+      const uint64 word =
+          core::DecodeFixed64(reinterpret_cast<const char*>(p));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          result->push_back(static_cast<int64_t>(p[i]));
+        }
+        p += 8;
+        continue;
+      }
+      const uint64 terminators = ~word & kContinuationBits;
+      if (terminators != 0) {
+        // The lowest terminator bit is bit 7 of the last byte of the varint.
+        const uint64 lowest_terminator = terminators & (~terminators + 1);
+        const int length = (Log2Floor64(lowest_terminator) >> 3) + 1;
+        uint64 value = 0;
+        for (int i = 0; i < length; ++i) {
+          value |= static_cast<uint64>(p[i] & 0x7f) << (7 * i);
+        }
+        result->push_back(static_cast<int64_t>(value));
+        p += length;
+        continue;
+      }
+    }
+    uint64 value;
+    p = DecodeVarint64Fallback(p, end, &value);
+    if (p == nullptr) return false;
+    result->push_back(static_cast<int64_t>(value));
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +365,28 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
-        }
+        // The input is a flat array, so the packed values can be decoded
+        // straight from the underlying buffer.
+        const void* buffer;
+        int buffer_size;
+        if (stream.GetDirectBufferPointer(&buffer, &buffer_size) &&
+            buffer_size >= packed_length) {
+          const uint8* begin = static_cast<const uint8*>(buffer);
+          if (!DecodePackedVarint64(begin, begin + packed_length, int64_list))
+            return false;
+          if (!stream.Skip(packed_length)) return false;
+        } else {
+          auto packed_limit = stream.PushLimit(packed_length);
 
-        stream.PopLimit(packed_limit);
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64_t>(n));
+          }
+
+          stream.PopLimit(packed_limit);
+        }
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -558,6 +633,20 @@ struct SparseBuffer {
   std::vector<size_t> example_end_indices;
 };
 
+// Memoizes the config index lookups of the previous example of a minibatch,
+// by position in the feature map. Examples of a batch are usually produced by
+// the same writer and list their features in the same order, so most lookups
+// are resolved by comparing the feature name with the cached one, without
+// hashing the name and probing the config index.
+struct FeatureIndexCache {
+  struct Entry {
+    StringPiece feature_name;
+    bool found = false;
+    std::pair<size_t, Type> d_and_type;
+  };
+  std::vector<Entry> entries;
+};
+
 struct SeededHasher {
   uint64 operator()(StringPiece s) const {
     return Hash64(s.data(), s.size(), seed);
@@ -595,7 +684,8 @@ Status FastParseSerializedExample(
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     std::vector<SparseBuffer>* output_ragged,
-    PerExampleFeatureStats* output_stats) {
+    PerExampleFeatureStats* output_stats,
+    FeatureIndexCache* feature_index_cache) {
   DCHECK(output_dense != nullptr);
   DCHECK(output_sparse != nullptr);
   DCHECK(output_ragged != nullptr);
@@ -618,6 +708,11 @@ Status FastParseSerializedExample(
     output_stats->features_count = parsed_example_size;
   }
 
+  if (feature_index_cache != nullptr &&
+      feature_index_cache->entries.size() < parsed_example_size) {
+    feature_index_cache->entries.resize(parsed_example_size);
+  }
+
   for (size_t i = 0; i < parsed_example_size; ++i) {
     // This is a logic that standard protobuf parsing is implementing.
     // I.e. last entry in the map overwrites all the previous ones.
@@ -628,23 +723,41 @@ Status FastParseSerializedExample(
     parsed::Feature& feature = name_and_feature.second;
 
     std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    FeatureIndexCache::Entry* cache_entry =
+        feature_index_cache != nullptr
+            ? &feature_index_cache->entries[parsed_example_size - i - 1]
+            : nullptr;
+    if (cache_entry != nullptr && cache_entry->feature_name == feature_name &&
+        cache_entry->feature_name.data() != nullptr) {
+      if (!cache_entry->found) continue;
+      d_and_type = cache_entry->d_and_type;
+    } else {
+      uint64 h = hasher(feature_name);
+      bool found = config_index.Find(h, &d_and_type);
+      if (found) {
+        // Testing for PresizedCuckooMap collision.
+        // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
+        const size_t d = d_and_type.first;
+        const tstring& config_feature_name =
+            d_and_type.second == Type::Dense
+                ? config.dense[d].feature_name
+                : (d_and_type.second == Type::Ragged
+                       ? config.ragged[d].feature_name
+                       : config.sparse[d].feature_name);
+        found = feature_name == config_feature_name;
+      }
+      if (cache_entry != nullptr) {
+        cache_entry->feature_name = feature_name;
+        cache_entry->found = found;
+        cache_entry->d_and_type = d_and_type;
+      }
+      if (!found) continue;
+    }
 
     size_t d = d_and_type.first;
     bool is_dense = d_and_type.second == Type::Dense;
     bool is_ragged = d_and_type.second == Type::Ragged;
 
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const tstring& config_feature_name =
-          is_dense ? config.dense[d].feature_name
-                   : (is_ragged ? config.ragged[d].feature_name
-                                : config.sparse[d].feature_name);
-      if (feature_name != config_feature_name) continue;
-    }
-
     auto example_error = [&](StringPiece suffix) {
       return errors::InvalidArgument("Name: ", example_name,
                                      ", Key: ", feature_name,
@@ -1230,6 +1343,7 @@ Status FastParseExample(const Config& config,
   std::vector<std::vector<SparseBuffer>> ragged_buffers(num_minibatches);
   std::vector<Status> status_of_minibatch(num_minibatches);
   auto ProcessMiniBatch = [&](size_t minibatch) {
+    FeatureIndexCache feature_index_cache;
     sparse_buffers[minibatch].resize(config.sparse.size());
     varlen_dense_buffers[minibatch].resize(config.dense.size());
     ragged_buffers[minibatch].resize(config.ragged.size());
@@ -1245,7 +1359,7 @@ Status FastParseExample(const Config& config,
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
           config_index, hasher, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch],
-          &ragged_buffers[minibatch], stats);
+          &ragged_buffers[minibatch], stats, &feature_index_cache);
       if (!status_of_minibatch[minibatch].ok()) break;
     }
   };
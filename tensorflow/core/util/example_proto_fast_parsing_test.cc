@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -327,6 +328,57 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, PackedInt64OfAllVarintLengths) {
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())["ids"]
+                     .mutable_int64_list();
+  // Covers every varint length from 1 to 10 bytes, runs of single-byte values
+  // and values straddling 8-byte word boundaries.
+  for (int i = 0; i < 20; ++i) values->add_value(i);
+  for (int shift = 0; shift < 64; shift += 3) {
+    values->add_value(int64_t{1} << shift);
+    values->add_value((int64_t{1} << shift) - 1);
+    values->add_value(-(int64_t{1} << shift));
+  }
+  values->add_value(std::numeric_limits<int64_t>::max());
+  values->add_value(std::numeric_limits<int64_t>::min());
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, DenseInt64WithChangingFeaturePositions) {
+  // Examples whose feature maps differ, which shifts the position of the
+  // features, must not be confused by lookups cached per position.
+  auto make_example = [](const std::vector<std::pair<string, int64_t>>& kvs) {
+    Example example;
+    for (const auto& [key, value] : kvs) {
+      (*example.mutable_features()->mutable_feature())[key]
+          .mutable_int64_list()
+          ->add_value(value);
+    }
+    return Serialize(example);
+  };
+  std::vector<tstring> serialized = {
+      make_example({{"a", 1}, {"b", 2}}),
+      make_example({{"a", 3}, {"b", 4}}),
+      make_example({{"b", 6}, {"c", 0}, {"a", 5}}),
+      make_example({{"a", 7}, {"b", 8}}),
+  };
+
+  FastParseExampleConfig config;
+  AddDenseFeature("a", DT_INT64, {}, false, 1, &config);
+  AddDenseFeature("b", DT_INT64, {}, false, 1, &config);
+
+  Result result;
+  TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 2);
+  auto a = result.dense_values[0].flat<int64_t>();
+  auto b = result.dense_values[1].flat<int64_t>();
+  for (int i = 0; i < serialized.size(); ++i) {
+    EXPECT_EQ(a(i), 2 * i + 1);
+    EXPECT_EQ(b(i), 2 * i + 2);
+  }
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
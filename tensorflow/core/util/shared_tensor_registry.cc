@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/shared_tensor_registry.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+uint64_t MakeKey(DataType dtype, const TensorShape& shape,
+                 uint64_t fingerprint) {
+  uint64_t key = FingerprintCat64(fingerprint, static_cast<uint64_t>(dtype));
+  for (int64_t dim : shape.dim_sizes()) {
+    key = FingerprintCat64(key, static_cast<uint64_t>(dim));
+  }
+  return key;
+}
+
+}  // namespace
+
+// Aliases the buffer of a registered tensor.  Keeps that tensor alive, and
+// unregisters it once the last tensor sharing it is released.
+class SharedTensorRegistry::SharedBuffer : public TensorBuffer {
+ public:
+  SharedBuffer(SharedTensorRegistry* registry, uint64_t key,
+               const Tensor& tensor)
+      : TensorBuffer(const_cast<char*>(tensor.tensor_data().data())),
+        registry_(registry),
+        key_(key),
+        tensor_(tensor) {}
+
+  ~SharedBuffer() override { registry_->Unregister(key_, this); }
+
+  size_t size() const override { return tensor_.TotalBytes(); }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("SharedTensorRegistry");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Prevents kernels from forwarding the shared buffer to their outputs and
+  // writing into it, even when they hold its only reference.
+  bool OwnsMemory() const override { return false; }
+
+  const Tensor& tensor() const { return tensor_; }
+
+ private:
+  SharedTensorRegistry* const registry_;
+  const uint64_t key_;
+  const Tensor tensor_;
+};
+
+SharedTensorRegistry* SharedTensorRegistry::Global() {
+  static SharedTensorRegistry* const registry = new SharedTensorRegistry;
+  return registry;
+}
+
+Tensor SharedTensorRegistry::Intern(const Tensor& tensor) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.NumElements() == 0) {
+    return tensor;
+  }
+  return Intern(tensor, Fingerprint64(tensor.tensor_data()));
+}
+
+Tensor SharedTensorRegistry::Intern(const Tensor& tensor,
+                                    uint64_t fingerprint) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.NumElements() == 0) {
+    return tensor;
+  }
+  const uint64_t key = MakeKey(tensor.dtype(), tensor.shape(), fingerprint);
+  core::RefCountPtr<TensorBuffer> shared;
+  {
+    mutex_lock l(mu_);
+    SharedBuffer* buffer =
+        RefBufferLocked(key, tensor.dtype(), tensor.shape());
+    if (buffer == nullptr) {
+      // Either nothing is registered under "key" or the registered buffer is
+      // being destroyed, in which case it will leave the new one in place.
+      buffer = new SharedBuffer(this, key, tensor);
+      buffers_[key] = buffer;
+      return Tensor(tensor.dtype(), tensor.shape(),
+                    core::RefCountPtr<TensorBuffer>(buffer));
+    }
+    shared.reset(buffer);
+  }
+  // Compared, and possibly released, outside "mu_" as releasing the last
+  // reference unregisters the buffer.
+  const absl::string_view data = tensor.tensor_data();
+  if (shared->size() != data.size() ||
+      std::memcmp(shared->data(), data.data(), data.size()) != 0) {
+    // A fingerprint collision: leave the registered tensor in place.
+    return tensor;
+  }
+  return Tensor(tensor.dtype(), tensor.shape(), std::move(shared));
+}
+
+bool SharedTensorRegistry::Lookup(DataType dtype, const TensorShape& shape,
+                                  uint64_t fingerprint, Tensor* tensor) {
+  mutex_lock l(mu_);
+  SharedBuffer* buffer =
+      RefBufferLocked(MakeKey(dtype, shape, fingerprint), dtype, shape);
+  if (buffer == nullptr) return false;
+  *tensor = Tensor(dtype, shape, core::RefCountPtr<TensorBuffer>(buffer));
+  return true;
+}
+
+size_t SharedTensorRegistry::size() const {
+  mutex_lock l(mu_);
+  return buffers_.size();
+}
+
+SharedTensorRegistry::SharedBuffer* SharedTensorRegistry::RefBufferLocked(
+    uint64_t key, DataType dtype, const TensorShape& shape) {
+  auto it = buffers_.find(key);
+  if (it == buffers_.end()) return nullptr;
+  SharedBuffer* buffer = it->second;
+  if (buffer->tensor().dtype() != dtype || buffer->tensor().shape() != shape) {
+    return nullptr;
+  }
+  // The last reference may have just been released, with the destructor
+  // waiting on "mu_" to unregister the buffer.
+  return buffer->TryRef() ? buffer : nullptr;
+}
+
+void SharedTensorRegistry::Unregister(uint64_t key, SharedBuffer* buffer) {
+  mutex_lock l(mu_);
+  auto it = buffers_.find(key);
+  if (it != buffers_.end() && it->second == buffer) buffers_.erase(it);
+}
+
+bool ShareReadOnlyTensorsEnabled() {
+  static const bool enabled = [] {
+    bool enabled = false;
+    Status s = ReadBoolFromEnvVar("TF_SHARE_READ_ONLY_TENSORS",
+                                  /*default_val=*/false, &enabled);
+    if (!s.ok()) LOG(ERROR) << s;
+    return enabled;
+  }();
+  return enabled;
+}
+
+}  // namespace tensorflow
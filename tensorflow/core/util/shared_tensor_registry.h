@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_SHARED_TENSOR_REGISTRY_H_
+#define TENSORFLOW_CORE_UTIL_SHARED_TENSOR_REGISTRY_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide registry of read-only host tensors keyed by their contents,
+// so that models loaded several times in one process (e.g. replicas of the
+// same SavedModel) can share a single copy of their constant weights.
+//
+// A tensor stays registered while any tensor returned by the registry refers
+// to it; once the last one is released, its buffer is freed as usual.
+//
+// Tensors returned by the registry must never be written to.
+//
+// This class is thread-safe.
+class SharedTensorRegistry {
+ public:
+  SharedTensorRegistry() = default;
+
+  SharedTensorRegistry(const SharedTensorRegistry&) = delete;
+  SharedTensorRegistry& operator=(const SharedTensorRegistry&) = delete;
+
+  // Returns the registry shared by the whole process.
+  static SharedTensorRegistry* Global();
+
+  // Returns a tensor equal to "tensor" that shares its buffer with every
+  // other tensor with the same dtype, shape and contents interned so far, and
+  // registers "tensor" if there is none.  Tensors whose dtype cannot be
+  // compared bytewise (e.g. DT_STRING) are returned unchanged.
+  Tensor Intern(const Tensor& tensor);
+
+  // As above, with "fingerprint" being Fingerprint64(tensor.tensor_data()),
+  // which callers that already know it can pass to avoid rehashing.
+  Tensor Intern(const Tensor& tensor, uint64_t fingerprint);
+
+  // Looks up a registered tensor with the given dtype, shape and contents
+  // fingerprint, without reading the contents.  Returns true and sets
+  // "*tensor" on success.
+  bool Lookup(DataType dtype, const TensorShape& shape, uint64_t fingerprint,
+              Tensor* tensor);
+
+  // Returns the number of registered tensors.
+  size_t size() const;
+
+ private:
+  class SharedBuffer;
+
+  // Returns a new reference to the buffer registered under "key" if it holds
+  // a tensor with the given dtype and shape, or nullptr.
+  SharedBuffer* RefBufferLocked(uint64_t key, DataType dtype,
+                                const TensorShape& shape)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Unregister(uint64_t key, SharedBuffer* buffer);
+
+  mutable mutex mu_;
+  // Buffers are not owned: each one unregisters itself when destroyed.
+  absl::flat_hash_map<uint64_t, SharedBuffer*> buffers_ TF_GUARDED_BY(mu_);
+};
+
+// Returns true if constant kernels (Const, ImmutableConst) placed on the host
+// should intern their values in SharedTensorRegistry::Global(), as requested
+// by setting the environment variable TF_SHARE_READ_ONLY_TENSORS to true.
+bool ShareReadOnlyTensorsEnabled();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_SHARED_TENSOR_REGISTRY_H_
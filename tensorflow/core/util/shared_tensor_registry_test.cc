@@ -0,0 +1,84 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/shared_tensor_registry.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SharedTensorRegistryTest, SharesEqualTensors) {
+  SharedTensorRegistry registry;
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  Tensor b = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+
+  Tensor shared_a = registry.Intern(a);
+  Tensor shared_b = registry.Intern(b);
+  EXPECT_EQ(registry.size(), 1);
+  EXPECT_EQ(shared_a.tensor_data().data(), a.tensor_data().data());
+  EXPECT_EQ(shared_b.tensor_data().data(), a.tensor_data().data());
+  test::ExpectTensorEqual<float>(shared_b, b);
+}
+
+TEST(SharedTensorRegistryTest, DistinguishesShapesAndContents) {
+  SharedTensorRegistry registry;
+  Tensor a = registry.Intern(test::AsTensor<float>({1, 2, 3, 4}, {2, 2}));
+  Tensor b = registry.Intern(test::AsTensor<float>({1, 2, 3, 4}, {4}));
+  Tensor c = registry.Intern(test::AsTensor<float>({1, 2, 3, 5}, {2, 2}));
+  Tensor d = registry.Intern(test::AsTensor<int32>({1, 2, 3, 4}, {2, 2}));
+  EXPECT_EQ(registry.size(), 4);
+  EXPECT_NE(a.tensor_data().data(), b.tensor_data().data());
+  EXPECT_NE(a.tensor_data().data(), c.tensor_data().data());
+}
+
+TEST(SharedTensorRegistryTest, UnregistersReleasedTensors) {
+  SharedTensorRegistry registry;
+  {
+    Tensor a = registry.Intern(test::AsTensor<int32>({1, 2, 3}, {3}));
+    EXPECT_EQ(registry.size(), 1);
+    // The shared buffer must not be forwarded to, and written by, kernels.
+    EXPECT_FALSE(a.RefCountIsOne());
+  }
+  EXPECT_EQ(registry.size(), 0);
+}
+
+TEST(SharedTensorRegistryTest, LookupByFingerprint) {
+  SharedTensorRegistry registry;
+  Tensor a = test::AsTensor<int64_t>({7, 8, 9}, {3});
+  const uint64_t fingerprint = Fingerprint64(a.tensor_data());
+
+  Tensor found;
+  EXPECT_FALSE(registry.Lookup(DT_INT64, TensorShape({3}), fingerprint, &found));
+  Tensor shared = registry.Intern(a, fingerprint);
+  EXPECT_FALSE(
+      registry.Lookup(DT_INT64, TensorShape({1, 3}), fingerprint, &found));
+  ASSERT_TRUE(registry.Lookup(DT_INT64, TensorShape({3}), fingerprint, &found));
+  EXPECT_EQ(found.tensor_data().data(), a.tensor_data().data());
+}
+
+TEST(SharedTensorRegistryTest, LeavesStringTensorsUnchanged) {
+  SharedTensorRegistry registry;
+  Tensor a = test::AsTensor<tstring>({"a", "b"}, {2});
+  Tensor shared = registry.Intern(a);
+  EXPECT_EQ(registry.size(), 0);
+  EXPECT_TRUE(shared.SharesBufferWith(a));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -23,6 +24,8 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -43,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
@@ -51,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
+#include "tensorflow/core/util/shared_tensor_registry.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
@@ -424,17 +429,108 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// Backs a numeric tensor with a view into a memory-mapped data file.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReaderMmap");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  // Keeps the mapping that the buffer points into alive.
+  const std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
+struct BundleWriter::DataShard {
+  // Appends "val" to the data file and fills in the location fields of
+  // "entry", or points "entry" at "base_entry" if the contents are unchanged.
+  Status Append(const Tensor& val, int alignment, bool record_fingerprint,
+                const BundleEntryProto* base_entry, BundleEntryProto* entry);
+
+  int id = 0;
+  std::string path;  // Possibly a temporary file name.
+  std::unique_ptr<tsl::BufferedWritableFile> out;
+  int64_t size = 0;  // Number of bytes written into out.
+  // Number of bytes assigned to this shard, maintained by the calling thread.
+  int64_t assigned_bytes = 0;
+  Status status;
+  // Entries completed by "writer", merged into entries_ by Finish().
+  std::vector<std::pair<std::string, BundleEntryProto>> written;
+  // Null iff there is a single shard, which is then written synchronously.
+  // Declared last so that queued writes finish before "out" is destroyed.
+  std::unique_ptr<thread::ThreadPool> writer;
+};
+
+Status BundleWriter::DataShard::Append(const Tensor& val, int alignment,
+                                       bool record_fingerprint,
+                                       const BundleEntryProto* base_entry,
+                                       BundleEntryProto* entry) {
+  if (!status.ok()) return status;
+  if (record_fingerprint && DataTypeCanUseMemcpy(val.dtype())) {
+    entry->set_fingerprint(Fingerprint64(val.tensor_data()));
+    if (base_entry != nullptr &&
+        base_entry->fingerprint() == entry->fingerprint() &&
+        base_entry->dtype() == entry->dtype() &&
+        TensorShape(base_entry->shape()) == val.shape()) {
+      *entry = *base_entry;
+      return absl::OkStatus();
+    }
+  }
+  entry->set_shard_id(id);
+  entry->set_offset(size);
+
+  // Updates the data file.
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->reset_crc32();
+  if (val.dtype() == DT_STRING) {
+    status = WriteStringTensor(val, out.get(), &data_bytes_written, &crc32c);
+  } else if (val.dtype() == DT_VARIANT) {
+    status = WriteVariantTensor(val, out.get(), &data_bytes_written, &crc32c);
+  } else {
+    status = WriteTensor(val, out.get(), &data_bytes_written);
+    crc32c = out->crc32();
+  }
+
+  if (status.ok()) {
+    entry->set_size(data_bytes_written);
+    entry->set_crc32c(crc32c::Mask(crc32c));
+    size += data_bytes_written;
+    status = PadAlignment(out.get(), alignment, &size);
+  }
+  return status;
+}
+
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
 
-  data_path_ = DataFilename(prefix_, 0, 1);
+  if (options_.num_shards < 1) {
+    status_ = errors::InvalidArgument(
+        "BundleWriter needs at least one shard, got ", options_.num_shards);
+    return;
+  }
+
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -443,51 +539,124 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
+  status_ = absl::OkStatus();
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::make_unique<tsl::BufferedWritableFile>(
-      std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+  if (!options_.base_prefix.empty()) {
+    status_ = ReadBaseEntries();
+    if (!status_.ok()) return;
+  }
+
+  for (int i = 0; i < options_.num_shards; ++i) {
+    auto shard = std::make_unique<DataShard>();
+    shard->id = i;
+    shard->path = DataFilename(prefix_, i, options_.num_shards);
+    if (use_temp_file_) {
+      shard->path = strings::StrCat(shard->path, ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(shard->path, &wrapper);
+    if (!status_.ok()) return;
+    shard->out = std::make_unique<tsl::BufferedWritableFile>(
+        std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+    if (options_.num_shards > 1) {
+      shard->writer = std::make_unique<thread::ThreadPool>(
+          env_, "bundle_writer", /*num_threads=*/1);
+    }
+    VLOG(1) << "Writing to file " << shard->path;
+    shards_.push_back(std::move(shard));
+  }
+}
+
+BundleWriter::~BundleWriter() = default;
 
-  VLOG(1) << "Writing to file " << data_path_;
+Status BundleWriter::ReadBaseEntries() {
+  BundleReader reader(env_, options_.base_prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  reader.Seek(kHeaderEntryKey);
+  BundleHeaderProto header;
+  TF_RETURN_IF_ERROR(ParseEntryProto(reader.key(), reader.value(), &header));
+  for (reader.Next(); reader.Valid(); reader.Next()) {
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(ParseEntryProto(reader.key(), reader.value(), &entry));
+    if (entry.fingerprint() == 0 || entry.slices_size() > 0) continue;
+    // Entries that already refer to an older bundle keep doing so, which keeps
+    // chains of incremental saves one level deep.
+    if (entry.data_prefix().empty()) {
+      entry.set_data_prefix(options_.base_prefix);
+      entry.set_data_num_shards(header.num_shards());
+    }
+    base_entries_.emplace(string(reader.key()), std::move(entry));
+  }
+  return absl::OkStatus();
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
-  const string key_string(key);
-  if (entries_.find(key_string) != entries_.end()) {
+  if (options_.max_chunk_bytes > 0 && DataTypeCanUseMemcpy(val.dtype()) &&
+      val.dims() > 0 && val.dim_size(0) > 1 &&
+      val.TotalBytes() > options_.max_chunk_bytes) {
+    return AddChunked(key, val);
+  }
+  return AddTensor(string(key), val);
+}
+
+Status BundleWriter::AddChunked(StringPiece key, const Tensor& val) {
+  if (entries_.find(string(key)) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+  const int64_t num_rows = val.dim_size(0);
+  const int64_t row_bytes = val.TotalBytes() / num_rows;
+  const int64_t rows_per_chunk =
+      std::max<int64_t>(1, options_.max_chunk_bytes / row_bytes);
+  for (int64_t start = 0; start < num_rows; start += rows_per_chunk) {
+    const int64_t length = std::min(rows_per_chunk, num_rows - start);
+    TensorSlice slice_spec(val.dims());
+    slice_spec.set_start(0, start);
+    slice_spec.set_length(0, length);
+    TF_RETURN_IF_ERROR(AddSlice(key, val.shape(), slice_spec,
+                                val.Slice(start, start + length)));
+  }
+  return absl::OkStatus();
+}
+
+Status BundleWriter::AddTensor(const string& key, const Tensor& val) {
+  if (entries_.find(key) != entries_.end()) {
     status_ = errors::InvalidArgument("Adding duplicate key: ", key);
     return status_;
   }
 
-  BundleEntryProto* entry = &entries_[key_string];
+  BundleEntryProto* entry = &entries_[key];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
+  const bool record_fingerprint =
+      options_.record_fingerprints || !options_.base_prefix.empty();
+  const BundleEntryProto* base_entry = gtl::FindOrNull(base_entries_, key);
 
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->reset_crc32();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32();
+  if (shards_.size() == 1) {
+    status_ = shards_[0]->Append(val, options_.data_alignment,
+                                 record_fingerprint, base_entry, entry);
+    return status_;
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
-  return status_;
+  // Balances the shards by the number of bytes assigned to each.  The slot in
+  // entries_ only reserves the key until Finish() fills it in.
+  DataShard* shard =
+      absl::c_min_element(shards_, [](const std::unique_ptr<DataShard>& a,
+                                      const std::unique_ptr<DataShard>& b) {
+        return a->assigned_bytes < b->assigned_bytes;
+      })->get();
+  shard->assigned_bytes += val.TotalBytes();
+  shard->writer->Schedule([shard, key, val, pending = *entry,
+                           alignment = options_.data_alignment,
+                           record_fingerprint, base_entry]() mutable {
+    if (shard->Append(val, alignment, record_fingerprint, base_entry, &pending)
+            .ok()) {
+      shard->written.emplace_back(key, std::move(pending));
+    }
+  });
+  return absl::OkStatus();
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -523,29 +692,37 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   TensorSliceProto* slice_proto = full_entry->add_slices();
   slice_spec.AsProto(slice_proto);
 
-  // The slice itself is handled by a regular Add(), which includes adding its
-  // own metadata entry, and writing out the slice's values.
+  // The slice itself is handled like a regular Add(), which includes adding
+  // its own metadata entry, and writing out the slice's values.  It is never
+  // split further.
   const string slice_name =
       checkpoint::EncodeTensorNameSlice(full_tensor_key_string, slice_spec);
-  status_ = Add(slice_name, slice_tensor);
+  status_ = AddTensor(slice_name, slice_tensor);
   return status_;
 }
 
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
+  // Waits for the queued writes.
+  for (auto& shard : shards_) shard->writer = nullptr;
+  for (auto& shard : shards_) {
+    status_.Update(shard->status);
+    if (shard->out) status_.Update(shard->out->Close());
+    shard->out = nullptr;
+  }
+  for (auto& shard : shards_) {
     if (status_.ok()) {
       if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
+        status_ = Env::Default()->RenameFile(
+            shard->path, DataFilename(prefix_, shard->id, options_.num_shards));
       }
     } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
+      Env::Default()->DeleteFile(shard->path).IgnoreError();
     }
+    for (auto& p : shard->written) entries_[p.first] = std::move(p.second);
   }
+  shards_.clear();
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
   std::unique_ptr<WritableFile> file;
@@ -559,7 +736,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(options_.num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -697,7 +874,12 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       continue;
     }
 
-    // Key doesn't duplicate: a fresh tensor/slice entry.
+    // Key doesn't duplicate: a fresh tensor/slice entry.  Entries referring to
+    // the data files of another bundle keep doing so.
+    if (!to_merge_entry.data_prefix().empty()) {
+      merge_state->entries[key] = to_merge_entry;
+      continue;
+    }
     auto result = merge_state->shard_ids.insert(
         {DataFilename(prefix, to_merge_entry.shard_id(), num_shards),
          merge_state->shard_ids.size()});
@@ -785,7 +967,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      use_mmap_(options.use_mmap),
+      verify_mapped_checksums_(options.verify_mapped_checksums) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -907,13 +1091,12 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   }
 
   // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
+  const string data_filename = DataFilenameForEntry(entry);
+  io::InputBuffer*& buffered_file = data_[data_filename];
   if (buffered_file == nullptr) {
     RandomAccessFile* file = nullptr;
-    TF_RETURN_IF_ERROR(cache_->GetFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+    TF_RETURN_IF_ERROR(cache_->GetFile(data_filename, &file));
     buffered_file = new io::InputBuffer(file, kBufferSize);
-    data_[entry.shard_id()] = buffered_file;
   }
   CHECK(buffered_file != nullptr);
 
@@ -923,7 +1106,13 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
-    if (entry.size() > kBufferSize || enable_multi_threading_for_testing_) {
+    if (use_mmap_ && entry.size() > 0) {
+      std::shared_ptr<const ReadOnlyMemoryRegion> region;
+      const char* data;
+      TF_RETURN_IF_ERROR(GetMappedData(entry, &region, &data));
+      memcpy(backing_buffer, data, entry.size());
+    } else if (entry.size() > kBufferSize ||
+               enable_multi_threading_for_testing_) {
       StringPiece sp;
       if (!enable_multi_threading_for_testing_ &&
           entry.size() < kLargeTensorThreshold) {
@@ -954,9 +1143,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
                                                      : section_size;
             std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
+            if (auto file_status =
+                    env_->NewRandomAccessFile(data_filename, &section_reader);
                 !file_status.ok()) {
               statuses[i] = file_status;
               return;
@@ -1019,6 +1207,101 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return absl::OkStatus();
 }
 
+string BundleReader::DataFilenameForEntry(
+    const BundleEntryProto& entry) const {
+  // Entries written by an incremental save may refer to the data files of
+  // another bundle.
+  if (!entry.data_prefix().empty()) {
+    return DataFilename(entry.data_prefix(), entry.shard_id(),
+                        entry.data_num_shards());
+  }
+  return DataFilename(prefix_, entry.shard_id(), num_shards_);
+}
+
+Status BundleReader::GetMappedData(
+    const BundleEntryProto& entry,
+    std::shared_ptr<const ReadOnlyMemoryRegion>* region, const char** data) {
+  const string data_filename = DataFilenameForEntry(entry);
+  TF_RETURN_IF_ERROR(cache_->GetMappedFile(data_filename, region));
+  const uint64 length = (*region)->length();
+  if (entry.offset() < 0 || entry.size() < 0 || entry.offset() > length ||
+      entry.size() > length - entry.offset()) {
+    return errors::DataLoss("Bundle entry at offset ", entry.offset(), " of ",
+                            entry.size(), " bytes is past the end of ",
+                            data_filename, " of size ", length);
+  }
+  *data = static_cast<const char*>((*region)->data()) + entry.offset();
+  return absl::OkStatus();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  if (!use_mmap_) {
+    return errors::FailedPrecondition(
+        "LookupMapped() requires BundleReader::Options::use_mmap");
+  }
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ && entry.size() > 0) {
+    std::shared_ptr<const ReadOnlyMemoryRegion> region;
+    const char* data;
+    TF_RETURN_IF_ERROR(GetMappedData(entry, &region, &data));
+    if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment ==
+        0) {
+      const int64_t expected_size =
+          shape.num_elements() * DataTypeSize(entry.dtype());
+      if (entry.size() != expected_size) {
+        return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                                "; stored size ", entry.size(),
+                                "; expected size ", expected_size);
+      }
+      if (verify_mapped_checksums_) {
+        const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+        if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+          return errors::DataLoss(
+              "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+              entry.size(), " bytes): Checksum does not match: stored ",
+              strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+              " vs. calculated on the mapped bytes ", actual_crc32c);
+        }
+      }
+      core::RefCountPtr<TensorBuffer> buffer(
+          new MappedTensorBuffer(std::move(region), data, entry.size()));
+      *val = Tensor(entry.dtype(), shape, std::move(buffer));
+      return absl::OkStatus();
+    }
+  }
+  *val = Tensor(entry.dtype(), shape);
+  if (entry.slices().empty()) return GetValue(entry, val);
+  return GetSliceValue(key, entry, TensorSlice(shape.dims()), val);
+}
+
+Status BundleReader::LookupShared(StringPiece key, Tensor* val) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  SharedTensorRegistry* registry = SharedTensorRegistry::Global();
+  // The recorded fingerprint is of the bytes as written, which only match the
+  // restored ones if no byte swapping is needed.
+  const bool has_fingerprint = entry.fingerprint() != 0 &&
+                               entry.slices().empty() && !need_to_swap_bytes_;
+  if (has_fingerprint &&
+      registry->Lookup(entry.dtype(), shape, entry.fingerprint(), val)) {
+    return absl::OkStatus();
+  }
+  Tensor tensor;
+  if (use_mmap_) {
+    TF_RETURN_IF_ERROR(LookupMapped(key, &tensor));
+  } else {
+    tensor = Tensor(entry.dtype(), shape);
+    TF_RETURN_IF_ERROR(Lookup(key, &tensor));
+  }
+  *val = has_fingerprint ? registry->Intern(tensor, entry.fingerprint())
+                         : registry->Intern(tensor);
+  return absl::OkStatus();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1225,17 +1508,18 @@ string BundleReader::DebugString() {
 
 BundleCache::BundleCache(Env* env) : env_(env) {}
 
+BundleCache::FileState* BundleCache::GetFileState(const std::string& name) {
+  absl::MutexLock l(&mu_);
+  auto& slot = opened_files_[name];
+  if (slot == nullptr) {
+    slot = std::make_unique<FileState>();
+  }
+  return slot.get();
+}
+
 BundleCache::FileState* BundleCache::EnsureOpened(std::string name) {
   // Get the file, opening it if necessary.
-  FileState* f;
-  {
-    absl::MutexLock l(&mu_);
-    auto& slot = opened_files_[name];
-    if (slot == nullptr) {
-      slot = std::make_unique<FileState>();
-    }
-    f = slot.get();
-  }
+  FileState* f = GetFileState(name);
 
   // Open the file or wait for a concurrent open to complete. We do not hold
   // mu_ here to avoid blocking threads reading from other files.
@@ -1252,6 +1536,19 @@ Status BundleCache::GetFile(const std::string& fname, RandomAccessFile** file) {
   return f->open_status;
 }
 
+Status BundleCache::GetMappedFile(
+    const std::string& fname,
+    std::shared_ptr<const ReadOnlyMemoryRegion>* region) {
+  FileState* f = GetFileState(fname);
+  absl::call_once(f->map_once, [this, &fname, f] {
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    f->map_status = env_->NewReadOnlyMemoryRegionFromFile(fname, &mapped);
+    f->region = std::move(mapped);
+  });
+  *region = f->region;
+  return f->map_status;
+}
+
 namespace {
 inline char* AlignedMalloc(size_t size) {
   char* buffer = static_cast<char*>(port::AlignedMalloc(size, 64));
@@ -119,9 +119,29 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files to spread the tensor data across.  Must be >= 1.
+    // With more than one, each data file is appended to by its own thread and
+    // Add() only queues the tensor, which must then not be modified until
+    // Finish() returns.  Errors writing the data are reported by Finish().
+    int num_shards{1};
+    // If positive, Add() stores a numeric tensor of more than this many bytes
+    // as slices of whole rows along dimension 0, each of at most this many
+    // bytes or a single row.  Readers reassemble the slices transparently.
+    int64_t max_chunk_bytes{0};
+    // If true, records a fingerprint of every numeric tensor (or slice) so that
+    // the bundle can later be used as the "base_prefix" of another writer.
+    bool record_fingerprints{false};
+    // If non-empty, the prefix of an earlier bundle written with
+    // "record_fingerprints".  Numeric tensors (or slices) whose key, dtype,
+    // shape and fingerprint match an entry there are not rewritten; their
+    // entries refer to the data files of that bundle instead, which must then
+    // be kept for as long as this bundle is read.  Implies
+    // "record_fingerprints".
+    std::string base_prefix;
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
@@ -153,15 +173,28 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // A data file together with the thread, if any, appending to it.
+  struct DataShard;
+
+  // Adds "val" under "key" without splitting it into chunks.
+  Status AddTensor(const std::string& key, const Tensor& val);
+
+  // Stores "val" as slices of at most "options_.max_chunk_bytes" bytes.
+  Status AddChunked(absl::string_view key, const Tensor& val);
+
+  // Loads the fingerprinted entries of the bundle at "options_.base_prefix".
+  Status ReadBaseEntries();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const std::string prefix_;
   std::string metadata_path_;
-  std::string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<tsl::BufferedWritableFile> out_;
-  int64_t size_;  // Number of bytes written into out_.
+  std::vector<std::unique_ptr<DataShard>> shards_;
   std::map<std::string, BundleEntryProto> entries_;
+  // Entries of the base bundle with a recorded fingerprint, with "data_prefix"
+  // and "data_num_shards" filled in.
+  std::map<std::string, BundleEntryProto> base_entries_;
   Status status_;
 
   BundleWriter(const BundleWriter&) = delete;
@@ -212,6 +245,17 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, data files are memory-mapped and numeric tensors are copied
+    // straight out of the mapping, which lets many readers sharing "cache"
+    // restore concurrently without issuing reads.  Also enables
+    // LookupMapped().
+    bool use_mmap = false;
+
+    // If false, LookupMapped() does not validate the checksums of the tensors
+    // it returns without copying, so that only the pages that are read are
+    // ever loaded from the data files.
+    bool verify_mapped_checksums = true;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -264,6 +308,29 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but for a non-partitioned numeric tensor returns in "val" a
+  // tensor viewing the memory-mapped data file without copying, which stays
+  // valid after the reader is destroyed.  Such a tensor must not be written
+  // to.  Falls back to a copy when the entry cannot be viewed in place, e.g.
+  // when its offset in the data file is not a multiple of
+  // Allocator::kAllocatorAlignment (see BundleWriter::Options::data_alignment)
+  // or when the bundle needs byte swapping.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes, unless
+  // Options::verify_mapped_checksums is false.
+  // REQUIRES: status().ok() and Options::use_mmap
+  Status LookupMapped(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Like Lookup(), but returns in "val" a tensor shared through
+  // SharedTensorRegistry::Global() with every other equal tensor interned in
+  // this process, e.g. the same entry looked up by another reader of the same
+  // bundle.  Entries written with BundleWriter::Options::record_fingerprints
+  // that are already registered are found without reading the data file.
+  // Reads through LookupMapped() if Options::use_mmap is set.  The returned
+  // tensor must not be written to.
+  // REQUIRES: status().ok()
+  Status LookupShared(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -330,6 +397,15 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the name of the data file holding the contents of "entry".
+  std::string DataFilenameForEntry(const BundleEntryProto& entry) const;
+
+  // Maps the data file of "entry" and points "data" at the entry's bytes.
+  // REQUIRES: DataTypeCanUseMemcpy(entry.dtype())
+  Status GetMappedData(const BundleEntryProto& entry,
+                       std::shared_ptr<const ReadOnlyMemoryRegion>* region,
+                       const char** data) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const std::string prefix_;
   std::unique_ptr<BundleCache> owned_cache_;  // may be null
@@ -341,8 +417,9 @@ class BundleReader {
   table::Cache* index_cache_;
   table::Iterator* iter_;
 
-  // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
-  std::unordered_map<int32_t, io::InputBuffer*> data_;
+  // Owned InputBuffer objects, keyed by data file name. cache_ owns the
+  // underlying RandomAccessFiles.
+  std::unordered_map<std::string, io::InputBuffer*> data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -359,6 +436,8 @@ class BundleReader {
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
+  bool use_mmap_ = false;
+  bool verify_mapped_checksums_ = true;
 
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
@@ -401,6 +480,10 @@ class BundleCache {
   // while the BundleCache lives.
   Status GetFile(const std::string& fname, RandomAccessFile** file);
 
+  // Get a read-only mapping of fname, shared by all callers.
+  Status GetMappedFile(const std::string& fname,
+                       std::shared_ptr<const ReadOnlyMemoryRegion>* region);
+
  private:
   // State for each opened file (opened on first read).
   struct FileState {
@@ -408,8 +491,13 @@ class BundleCache {
 
     std::unique_ptr<RandomAccessFile> file;
     Status open_status;  // Records any error encountered on open
+
+    absl::once_flag map_once;  // Ensures file is mapped exactly once.
+    std::shared_ptr<const ReadOnlyMemoryRegion> region;
+    Status map_status;  // Records any error encountered on mapping
   };
 
+  FileState* GetFileState(const std::string& name);
   FileState* EnsureOpened(std::string name);
 
   Env* const env_;
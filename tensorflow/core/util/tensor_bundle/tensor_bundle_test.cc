@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <cstring>
 #include <random>
 #include <string>
 #include <vector>
@@ -24,6 +25,7 @@ limitations under the License.
 #endif  // _WIN32
 
 #include "absl/status/status.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -917,6 +919,202 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, ShardedWrite) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.num_shards = 3;
+    BundleWriter writer(env, Prefix("sharded"), opts);
+    TF_ASSERT_OK(writer.status());
+    for (int i = 0; i < 8; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("tensor", i),
+                              Constant<float>(i, TensorShape({i + 1, 10}))));
+    }
+    TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"a", "bc"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("sharded"), i, 3)));
+  }
+  BundleReader reader(env, Prefix("sharded"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 8; ++i) {
+    Expect<float>(&reader, strings::StrCat("tensor", i),
+                  Constant<float>(i, TensorShape({i + 1, 10})));
+  }
+  Expect<tstring>(&reader, "strings", test::AsTensor<tstring>({"a", "bc"}));
+
+  BundleWriter::Options opts;
+  opts.num_shards = 0;
+  BundleWriter writer(env, Prefix("no_shards"), opts);
+  EXPECT_EQ(writer.status().code(), error::INVALID_ARGUMENT);
+}
+
+TEST(TensorBundleTest, ChunkedWrite) {
+  Tensor val(DT_FLOAT, TensorShape({10, 10}));
+  test::FillIota<float>(&val, 0);
+  {
+    BundleWriter::Options opts;
+    // Three rows of 40 bytes each per chunk.
+    opts.max_chunk_bytes = 150;
+    BundleWriter writer(Env::Default(), Prefix("chunked"), opts);
+    TF_EXPECT_OK(writer.Add("big", val));
+    TF_EXPECT_OK(writer.Add("small", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("chunked"));
+  TF_ASSERT_OK(reader.status());
+  std::vector<TensorSlice> slices;
+  TF_ASSERT_OK(reader.LookupTensorSlices("big", &slices));
+  ASSERT_EQ(slices.size(), 4);
+  EXPECT_EQ(slices[3].start(0), 9);
+  EXPECT_EQ(slices[3].length(0), 1);
+  TF_ASSERT_OK(reader.LookupTensorSlices("small", &slices));
+  EXPECT_TRUE(slices.empty());
+  Expect<float>(&reader, "big", val);
+  Expect<float>(&reader, "small", Constant_2x3<float>(1));
+}
+
+TEST(TensorBundleTest, IncrementalWrite) {
+  Env* env = Env::Default();
+  const Tensor kUnchanged = Constant_100x100<float>(1);
+  {
+    BundleWriter::Options opts;
+    opts.record_fingerprints = true;
+    BundleWriter writer(env, Prefix("base"), opts);
+    TF_EXPECT_OK(writer.Add("unchanged", kUnchanged));
+    TF_EXPECT_OK(writer.Add("changed", Constant_100x100<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("base");
+    BundleWriter writer(env, Prefix("incremental"), opts);
+    TF_ASSERT_OK(writer.status());
+    TF_EXPECT_OK(writer.Add("unchanged", kUnchanged));
+    TF_EXPECT_OK(writer.Add("changed", Constant_100x100<float>(3)));
+    TF_EXPECT_OK(writer.Add("new", Constant_2x3<float>(4)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Only "changed" and "new" are written to the incremental bundle's data.
+  uint64 data_size = 0;
+  TF_ASSERT_OK(
+      env->GetFileSize(DataFilename(Prefix("incremental"), 0, 1), &data_size));
+  EXPECT_EQ(data_size, (100 * 100 + 2 * 3) * sizeof(float));
+  {
+    // A save based on the incremental one still reads from the first bundle.
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("incremental");
+    BundleWriter writer(env, Prefix("incremental2"), opts);
+    TF_EXPECT_OK(writer.Add("unchanged", kUnchanged));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (const char* prefix : {"incremental", "incremental2"}) {
+    BundleReader reader(env, Prefix(prefix));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "unchanged", kUnchanged);
+  }
+  BundleReader reader(env, Prefix("incremental"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "changed", Constant_100x100<float>(3));
+  Expect<float>(&reader, "new", Constant_2x3<float>(4));
+}
+
+TEST(TensorBundleTest, MappedLookup) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = Allocator::kAllocatorAlignment;
+    BundleWriter writer(env, Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("odd", Constant(static_cast<int8>(1),
+                                            TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(2)));
+    TF_EXPECT_OK(writer.Add("string", test::AsTensor<tstring>({"a"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped;
+  {
+    BundleReader::Options options;
+    options.use_mmap = true;
+    BundleReader reader(env, Prefix("mapped"), options);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "float", Constant_100x100<float>(2));
+    TF_ASSERT_OK(reader.LookupMapped("float", &mapped));
+    Tensor string_val;
+    TF_ASSERT_OK(reader.LookupMapped("string", &string_val));
+    test::ExpectTensorEqual<tstring>(string_val,
+                                     test::AsTensor<tstring>({"a"}));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(2));
+
+  BundleReader reader(env, Prefix("mapped"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.LookupMapped("float", &mapped).code(),
+            error::FAILED_PRECONDITION);
+}
+
+TEST(TensorBundleTest, MappedLookupWithoutChecksums) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = Allocator::kAllocatorAlignment;
+    BundleWriter writer(env, Prefix("unverified"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const string datafile = DataFilename(Prefix("unverified"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  const float value = 2;
+  memcpy(&data[0], &value, sizeof(value));
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, data));
+
+  BundleReader::Options options;
+  options.use_mmap = true;
+  Tensor mapped;
+  {
+    BundleReader reader(env, Prefix("unverified"), options);
+    TF_ASSERT_OK(reader.status());
+    EXPECT_TRUE(absl::IsDataLoss(reader.LookupMapped("float", &mapped)));
+  }
+  options.verify_mapped_checksums = false;
+  BundleReader reader(env, Prefix("unverified"), options);
+  TF_ASSERT_OK(reader.status());
+  TF_ASSERT_OK(reader.LookupMapped("float", &mapped));
+  test::ExpectTensorEqual<float>(
+      mapped, test::AsTensor<float>({2, 1, 1, 1, 1, 1}, TensorShape({2, 3})));
+}
+
+TEST(TensorBundleTest, SharedLookup) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options opts;
+    opts.record_fingerprints = true;
+    BundleWriter writer(env, Prefix("shared"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(3)));
+    TF_EXPECT_OK(writer.Add("string", test::AsTensor<tstring>({"a"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader0(env, Prefix("shared"));
+  TF_ASSERT_OK(reader0.status());
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader1(env, Prefix("shared"), options);
+  TF_ASSERT_OK(reader1.status());
+
+  Tensor val0, val1;
+  TF_ASSERT_OK(reader0.LookupShared("float", &val0));
+  TF_ASSERT_OK(reader1.LookupShared("float", &val1));
+  test::ExpectTensorEqual<float>(val1, Constant_100x100<float>(3));
+  EXPECT_EQ(val0.tensor_data().data(), val1.tensor_data().data());
+
+  TF_ASSERT_OK(reader0.LookupShared("string", &val0));
+  TF_ASSERT_OK(reader1.LookupShared("string", &val1));
+  test::ExpectTensorEqual<tstring>(val1, test::AsTensor<tstring>({"a"}));
+  EXPECT_FALSE(val0.SharesBufferWith(val1));
+}
+
 TEST(TensorBundleTest, SortForSequentialAccess) {
   Env* env = Env::Default();
   const std::vector<string> kBundlePrefixes = {Prefix("worker0"),
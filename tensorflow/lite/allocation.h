@@ -95,6 +95,15 @@ class MMAPAllocation : public Allocation {
     return offset_of_buffer_in_file_;
   }
 
+  // Hints that the bytes in [ptr, ptr + bytes) of the mapping will be read
+  // soon, so that the kernel starts paging them in in the background.
+  void AdviseWillNeed(const void* ptr, size_t bytes) const;
+
+  // Lets the pages entirely within [ptr, ptr + bytes) of the mapping be
+  // dropped from memory. They are read from the file again on their next
+  // access, so this only costs time, never correctness.
+  void AdviseDontNeed(const void* ptr, size_t bytes) const;
+
   static bool IsSupported();
 
  protected:
@@ -52,6 +52,28 @@ TEST(MMAPAllocation, TestValidFile) {
   EXPECT_NE(allocation.base(), nullptr);
 }
 
+TEST(MMAPAllocation, TestAdviceKeepsContents) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(
+      "tensorflow/lite/testdata/empty_model.bin", &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  const char* base = static_cast<const char*>(allocation.base());
+  const std::string contents(base, allocation.bytes());
+
+  allocation.AdviseDontNeed(base, allocation.bytes());
+  EXPECT_EQ(std::string(base, allocation.bytes()), contents);
+  allocation.AdviseWillNeed(base, allocation.bytes());
+  EXPECT_EQ(std::string(base, allocation.bytes()), contents);
+  // Ranges outside of the mapping are ignored.
+  allocation.AdviseDontNeed(base + allocation.bytes(), 1);
+  allocation.AdviseWillNeed(base - 1, 1);
+  EXPECT_EQ(std::string(base, allocation.bytes()), contents);
+}
+
 #if defined(__linux__)
 TEST(MMAPAllocation, TestInvalidFileDescriptor) {
   if (!MMAPAllocation::IsSupported()) {
@@ -20,6 +20,8 @@ limitations under the License.
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -33,19 +35,76 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Placement problems with at most this many reorderable tensors are refined
+// with a local search after the candidate orders have been compared.
+constexpr size_t kMaxTensorsForLocalSearch = 128;
+constexpr int kMaxLocalSearchPasses = 4;
+// Bounds the memory held by the process-wide cache of solved placements.
+constexpr size_t kMaxCachedAllocationOrders = 64;
+
+namespace {
+
+// The result of `ArenaPlanner::OptimizeAllocationOrder` for one placement
+// problem. `signature` describes the problem (alignment, then size and usage
+// interval of each tensor in default order) and is kept in full so that hash
+// collisions are never mistaken for hits. `permutation[i]` is the position in
+// the default order of the tensor to allocate i-th.
+struct CachedAllocationOrder {
+  std::vector<size_t> signature;
+  std::vector<int32_t> permutation;
+};
+
+std::mutex& AllocationOrderCacheMutex() {
+  static std::mutex* mutex = new std::mutex;
+  return *mutex;
+}
+
+std::unordered_map<uint64_t, CachedAllocationOrder>& AllocationOrderCache() {
+  static auto* cache =
+      new std::unordered_map<uint64_t, CachedAllocationOrder>();
+  return *cache;
+}
+
+uint64_t HashSignature(const std::vector<size_t>& signature) {
+  // FNV-1a.
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t value : signature) {
+    hash ^= static_cast<uint64_t>(value);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
-                           int subgraph_index)
+                           int subgraph_index, bool optimize_placement,
+                           std::shared_ptr<SharedArenaBuffer> shared_arena)
     : context_(context),
       graph_info_(std::move(graph_info)),
-      arena_(kDefaultArenaAlignment, subgraph_index),
+      arena_(kDefaultArenaAlignment, subgraph_index, std::move(shared_arena)),
       has_nonpersistent_memory_(false),
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
-      last_active_node_(kLastActiveNodeUndefined) {}
+      optimize_placement_(optimize_placement),
+      last_active_node_(kLastActiveNodeUndefined) {
+  // Another interpreter moved the shared arena, so the tensors that point into
+  // it are pointed at its new address.
+  arena_.SetSharedBufferMovedCallback([this]() {
+    if (!has_nonpersistent_memory_) return;
+    TfLiteTensor* tensors = graph_info_->tensors();
+    for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+      TfLiteTensor& tensor = tensors[i];
+      if (tensor.allocation_type == kTfLiteArenaRw &&
+          tensor.data.raw != nullptr) {
+        ResolveTensorAllocation(i, tensors);
+      }
+    }
+  });
+}
 
 ArenaPlanner::~ArenaPlanner() {
   arena_.ReleaseBuffer();
@@ -310,7 +369,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       if (tensor_index == kTfLiteOptionalTensor) continue;
       //  Don't allocate output tensors here for shared memory parts.
       nodes_to_tensors_[i].insert(tensor_index);
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(
+          allocate(graph_info_->concurrent_nodes(i).first, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -325,7 +385,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
           tensor_index = FindSharedTensor(tensor_index);
           --refcounts[tensor_index];
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(deallocate(
+                graph_info_->concurrent_nodes(i).second, tensor_index));
           }
         }
       }
@@ -349,13 +410,15 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   for (size_t i = first_node;
        i <= static_cast<size_t>(last_node) && i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    const std::pair<size_t, size_t> concurrent_nodes =
+        graph_info_->concurrent_nodes(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = concurrent_nodes.first;
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = concurrent_nodes.second;
       }
     }
   }
@@ -428,6 +491,44 @@ void ArenaPlanner::GetAllocInfo(size_t* arena_size,
   *arena_persist_size = persistent_arena_.GetBufferSize();
 }
 
+bool ArenaPlanner::GetArenaPlacements(ArenaPlacements* placements) const {
+  placements->clear();
+  for (int32_t i = 0; i < static_cast<int32_t>(allocs_.size()); ++i) {
+    const ArenaAllocWithUsageInterval& alloc = allocs_[i];
+    if (alloc.size == 0 || !OwnsArenaBuffer(i)) continue;
+    placements->push_back({i, alloc.first_node, alloc.last_node, alloc.size,
+                           alloc.offset});
+  }
+  return true;
+}
+
+void ArenaPlanner::SetArenaPlacements(const ArenaPlacements& placements) {
+  arena_placements_.clear();
+  for (const ArenaTensorPlacement& placement : placements) {
+    arena_placements_[placement.tensor] = placement;
+  }
+}
+
+bool ArenaPlanner::MatchesArenaPlacements(
+    const std::vector<int32_t>& tensors_to_allocate) const {
+  if (arena_placements_.empty()) return false;
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  for (int32_t tensor_index : tensors_to_allocate) {
+    if (tensors[tensor_index].bytes == 0 || !OwnsArenaBuffer(tensor_index)) {
+      continue;
+    }
+    auto it = arena_placements_.find(tensor_index);
+    if (it == arena_placements_.end() ||
+        it->second.size != tensors[tensor_index].bytes ||
+        it->second.first_node != alloc_node_[tensor_index] ||
+        it->second.last_node != dealloc_node_[tensor_index] ||
+        it->second.offset % tensor_alignment_ != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::Commit(bool* reallocated) {
   bool arena_reallocated, persistent_arena_reallocated;
   TF_LITE_ENSURE_STATUS(arena_.Commit(&arena_reallocated));
@@ -471,6 +572,157 @@ void ArenaPlanner::CreateTensorAllocationVector(
             tensor_compare);
 }
 
+bool ArenaPlanner::OwnsArenaBuffer(int32_t tensor_index) const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  if (tensors[tensor_index].allocation_type != kTfLiteArenaRw) {
+    return false;
+  }
+  auto it = actual_tensor_id_.find(tensor_index);
+  if (it == actual_tensor_id_.end()) {
+    return true;
+  }
+  // Same check as in `CalculateAllocations`: sharing is only kept while the
+  // owning tensor is still arena allocated with the same size.
+  return tensors[it->second].allocation_type != kTfLiteArenaRw ||
+         tensors[it->second].bytes != tensors[it->first].bytes;
+}
+
+size_t ArenaPlanner::SimulateArenaSize(const std::vector<int32_t>& order) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  // The scratch arena never commits, so no memory is allocated for it.
+  SimpleMemoryArena scratch(kDefaultArenaAlignment);
+  ArenaAllocWithUsageInterval alloc;
+  for (int32_t tensor_index : order) {
+    if (scratch.Allocate(context_, tensor_alignment_,
+                         tensors[tensor_index].bytes, tensor_index,
+                         alloc_node_[tensor_index], dealloc_node_[tensor_index],
+                         &alloc) != kTfLiteOk) {
+      return std::numeric_limits<size_t>::max();
+    }
+  }
+  return scratch.RequiredBufferSize();
+}
+
+void ArenaPlanner::OptimizeAllocationOrder(
+    std::vector<int32_t>* tensors_to_allocate) {
+  // Only tensors which get their own buffer in `arena_` influence its size.
+  // The others keep their relative order and go last.
+  std::vector<int32_t> placeable;
+  std::vector<int32_t> others;
+  for (int32_t tensor_index : *tensors_to_allocate) {
+    (OwnsArenaBuffer(tensor_index) ? placeable : others)
+        .push_back(tensor_index);
+  }
+  if (placeable.size() < 2) {
+    return;
+  }
+
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<size_t> signature;
+  signature.reserve(3 * placeable.size() + 1);
+  signature.push_back(tensor_alignment_);
+  for (int32_t tensor_index : placeable) {
+    signature.push_back(tensors[tensor_index].bytes);
+    signature.push_back(static_cast<uint32_t>(alloc_node_[tensor_index]));
+    signature.push_back(static_cast<uint32_t>(dealloc_node_[tensor_index]));
+  }
+  const uint64_t key = HashSignature(signature);
+
+  std::vector<int32_t> best;
+  {
+    std::lock_guard<std::mutex> lock(AllocationOrderCacheMutex());
+    auto it = AllocationOrderCache().find(key);
+    if (it != AllocationOrderCache().end() &&
+        it->second.signature == signature) {
+      best.reserve(placeable.size());
+      for (int32_t position : it->second.permutation) {
+        best.push_back(placeable[position]);
+      }
+    }
+  }
+
+  if (best.empty()) {
+    // Tensors living through the whole inference lead the default order. They
+    // never share memory, so their placement is left as is.
+    auto is_whole_lifetime = [&](int32_t tensor_index) {
+      return alloc_node_[tensor_index] == 0 &&
+             dealloc_node_[tensor_index] == kNodeNotAssigned;
+    };
+    size_t num_fixed = 0;
+    while (num_fixed < placeable.size() &&
+           is_whole_lifetime(placeable[num_fixed])) {
+      ++num_fixed;
+    }
+    auto lifetime = [&](int32_t tensor_index) {
+      return static_cast<int64_t>(dealloc_node_[tensor_index]) -
+             alloc_node_[tensor_index] + 1;
+    };
+
+    best = placeable;
+    size_t best_size = SimulateArenaSize(best);
+    auto try_order = [&](auto compare) {
+      std::vector<int32_t> candidate = placeable;
+      std::stable_sort(candidate.begin() + num_fixed, candidate.end(),
+                       compare);
+      const size_t size = SimulateArenaSize(candidate);
+      if (size < best_size) {
+        best_size = size;
+        best = std::move(candidate);
+      }
+    };
+    // Longest lived first: these constrain the most other tensors.
+    try_order([&](int32_t idx1, int32_t idx2) {
+      if (lifetime(idx1) != lifetime(idx2)) {
+        return lifetime(idx1) > lifetime(idx2);
+      }
+      return tensors[idx1].bytes > tensors[idx2].bytes;
+    });
+    // Largest area in the (offset, node) plane first.
+    try_order([&](int32_t idx1, int32_t idx2) {
+      return static_cast<double>(tensors[idx1].bytes) * lifetime(idx1) >
+             static_cast<double>(tensors[idx2].bytes) * lifetime(idx2);
+    });
+
+    // Refine small problems by swapping neighbours in the allocation order,
+    // keeping every swap which shrinks the arena.
+    if (best.size() - num_fixed <= kMaxTensorsForLocalSearch) {
+      for (int pass = 0; pass < kMaxLocalSearchPasses; ++pass) {
+        bool improved = false;
+        for (size_t i = num_fixed; i + 1 < best.size(); ++i) {
+          std::swap(best[i], best[i + 1]);
+          const size_t size = SimulateArenaSize(best);
+          if (size < best_size) {
+            best_size = size;
+            improved = true;
+          } else {
+            std::swap(best[i], best[i + 1]);
+          }
+        }
+        if (!improved) break;
+      }
+    }
+
+    std::unordered_map<int32_t, int32_t> position;
+    for (int32_t i = 0; i < static_cast<int32_t>(placeable.size()); ++i) {
+      position[placeable[i]] = i;
+    }
+    CachedAllocationOrder entry;
+    entry.signature = std::move(signature);
+    entry.permutation.reserve(best.size());
+    for (int32_t tensor_index : best) {
+      entry.permutation.push_back(position[tensor_index]);
+    }
+    std::lock_guard<std::mutex> lock(AllocationOrderCacheMutex());
+    if (AllocationOrderCache().size() >= kMaxCachedAllocationOrders) {
+      AllocationOrderCache().clear();
+    }
+    AllocationOrderCache()[key] = std::move(entry);
+  }
+
+  best.insert(best.end(), others.begin(), others.end());
+  *tensors_to_allocate = std::move(best);
+}
+
 std::vector<int32_t> ArenaPlanner::GetTensorsToAllocate(int first_node,
                                                         int last_node) {
   int num_tensors = static_cast<int>(graph_info_->num_tensors());
@@ -509,15 +761,28 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  bool arena_was_reset = false;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
+    arena_was_reset = true;
     last_active_node_ = first_node;
   } else {
     // NOMUTANTS -- This function has no impact on the results, it only makes
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
-  CreateTensorAllocationVector(tensors_allocated);
+  // Recorded placements are only valid for the whole set of tensors, so they
+  // only apply when no earlier allocations are kept.
+  const bool use_placements =
+      arena_was_reset && MatchesArenaPlacements(*tensors_allocated);
+  if (!use_placements) {
+    CreateTensorAllocationVector(tensors_allocated);
+  }
+  // The search simulates allocation into an empty arena, so it only applies
+  // when no earlier allocations are kept.
+  if (optimize_placement_ && arena_was_reset && !use_placements) {
+    OptimizeAllocationOrder(tensors_allocated);
+  }
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -541,10 +806,17 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      if (use_placements && tensor.bytes != 0) {
+        TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+            arena_placements_[tensor_index].offset, tensor.bytes, tensor_index,
+            alloc_node_[tensor_index], dealloc_node_[tensor_index],
+            &allocs_[tensor_index]));
+      } else {
+        TF_LITE_ENSURE_STATUS(arena_.Allocate(
+            context_, tensor_alignment_, tensor.bytes, tensor_index,
+            alloc_node_[tensor_index], dealloc_node_[tensor_index],
+            &allocs_[tensor_index]));
+      }
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
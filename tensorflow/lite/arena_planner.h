@@ -50,10 +50,14 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
-  // of inference.
+  // of inference. If `optimize_placement` is true, full re-plans search over
+  // several tensor allocation orders and keep the one with the smallest arena,
+  // see `OptimizeAllocationOrder`. If `shared_arena` is set, the non-persistent
+  // tensors are placed in it, see `SharedArenaBuffer`.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_all_tensors, int tensor_alignment,
-               int subgraph_index = 0);
+               int subgraph_index = 0, bool optimize_placement = false,
+               std::shared_ptr<SharedArenaBuffer> shared_arena = nullptr);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -68,6 +72,8 @@ class ArenaPlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  bool GetArenaPlacements(ArenaPlacements* placements) const override;
+  void SetArenaPlacements(const ArenaPlacements& placements) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -95,6 +101,28 @@ class ArenaPlanner : public MemoryPlanner {
   // first goes first.
   void CreateTensorAllocationVector(std::vector<int32_t>* tensors_to_allocate);
 
+  // Reorders `tensors_to_allocate`, already sorted by
+  // `CreateTensorAllocationVector`, so that allocating the tensors in that
+  // order into an empty arena gives the smallest arena found. Candidates are
+  // the default order, lifetime- and area-ordered variants and, for small
+  // graphs, a local search over adjacent swaps. Results are cached process
+  // wide by the shape of the placement problem so identical models only pay
+  // for the search once.
+  void OptimizeAllocationOrder(std::vector<int32_t>* tensors_to_allocate);
+
+  // Returns the arena size needed when the `kTfLiteArenaRw` tensors in
+  // `order` are allocated one after another into an empty arena.
+  size_t SimulateArenaSize(const std::vector<int32_t>& order);
+
+  // True if `tensor_index` will be given its own buffer in `arena_` rather
+  // than share the buffer of another tensor.
+  bool OwnsArenaBuffer(int32_t tensor_index) const;
+
+  // True if every tensor of `tensors_to_allocate` owning memory in `arena_`
+  // has a placement recorded for its current size and lifetime.
+  bool MatchesArenaPlacements(
+      const std::vector<int32_t>& tensors_to_allocate) const;
+
   // Returns vector containing the indices of all tensors allocated between
   // `first_node` and `last_node`.
   std::vector<int32_t> GetTensorsToAllocate(int first_node, int last_node);
@@ -156,6 +184,10 @@ class ArenaPlanner : public MemoryPlanner {
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
 
+  // If true, full re-plans search for a smaller tensor placement instead of
+  // using the greedy by-size order directly.
+  bool optimize_placement_;
+
   // Index of the last node whose tensors were allocated.
   int last_active_node_;
 
@@ -166,6 +198,10 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Placements set by `SetArenaPlacements`, by tensor index.
+  // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+  std::unordered_map<int32_t, ArenaTensorPlacement> arena_placements_;
 };
 
 }  // namespace tflite
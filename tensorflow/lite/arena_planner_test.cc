@@ -208,12 +208,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                bool optimize_placement = false) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_ = std::make_unique<ArenaPlanner>(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment);
+        preserve_all_tensors, kTensorAlignment, /*subgraph_index=*/0,
+        optimize_placement);
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -266,6 +268,13 @@ class ArenaPlannerTest : public ::testing::Test {
     return offset;
   }
 
+  // Returns the size of the non-persistent arena.
+  size_t GetArenaSize() {
+    size_t arena_size, arena_persist_size;
+    planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+    return arena_size;
+  }
+
   // Returns if the given tensor is unallocated or not.
   bool IsUnallocated(int tensor_index) {
     return (*graph_->tensors())[tensor_index].data.raw == nullptr;
@@ -1046,6 +1055,152 @@ TEST_F(ArenaPlannerTest, GraphWithIntermediates) {
   EXPECT_EQ(GetOffset(2), GetOffsetAfter(5));
 }
 
+TEST_F(ArenaPlannerTest, OptimizedPlacementShrinksArena) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{1, 2}, {3}, {}},
+                      {{3}, {4}, {}},
+                      {{2, 4}, {5}, {}},
+                  },
+                  {5});
+  (*graph.tensors())[0].bytes = 32;
+  (*graph.tensors())[1].bytes = 28;
+  (*graph.tensors())[2].bytes = 8;
+  (*graph.tensors())[3].bytes = 16;
+  (*graph.tensors())[4].bytes = 8;
+  (*graph.tensors())[5].bytes = 32;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  const size_t greedy_arena_size = GetArenaSize();
+
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           /*optimize_placement=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  const size_t optimized_arena_size = GetArenaSize();
+  EXPECT_LT(optimized_arena_size, greedy_arena_size);
+
+  // Alloc(+) and dealloc(-) order: +0 +1 +2 +3 -1 +4 -3 +5 -2 -4
+  auto disjoint = [&](int a, int b) {
+    return GetOffsetAfter(a) <= GetOffset(b) ||
+           GetOffsetAfter(b) <= GetOffset(a);
+  };
+  const std::vector<std::pair<int, int>> live_together = {
+      {0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}, {1, 2},
+      {1, 3}, {2, 3}, {2, 4}, {2, 5}, {3, 4}, {4, 5}};
+  for (const auto& [a, b] : live_together) {
+    EXPECT_TRUE(disjoint(a, b)) << a << " overlaps " << b;
+  }
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // A second planner for the same graph reuses the cached placement.
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           /*optimize_placement=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetArenaSize(), optimized_arena_size);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, ReusesArenaPlacements) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{1, 2}, {3}, {}},
+                      {{3}, {4}, {}},
+                      {{2, 4}, {5}, {}},
+                  },
+                  {5});
+  (*graph.tensors())[0].bytes = 32;
+  (*graph.tensors())[1].bytes = 28;
+  (*graph.tensors())[2].bytes = 8;
+  (*graph.tensors())[3].bytes = 16;
+  (*graph.tensors())[4].bytes = 8;
+  (*graph.tensors())[5].bytes = 32;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  const size_t greedy_arena_size = GetArenaSize();
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           /*optimize_placement=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  const size_t optimized_arena_size = GetArenaSize();
+  ASSERT_LT(optimized_arena_size, greedy_arena_size);
+  ArenaPlacements placements;
+  ASSERT_TRUE(planner_->GetArenaPlacements(&placements));
+  EXPECT_EQ(placements.size(), 6);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // A greedy planner given the placements uses them.
+  SetGraph(&graph);
+  planner_->SetArenaPlacements(placements);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetArenaSize(), optimized_arena_size);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+
+  // Placements recorded for other tensor sizes are ignored.
+  (*graph.tensors())[3].bytes = 64;
+  SetGraph(&graph);
+  planner_->SetArenaPlacements(placements);
+  Execute(0, graph.nodes().size() - 1);
+  auto disjoint = [&](int a, int b) {
+    return GetOffsetAfter(a) <= GetOffset(b) ||
+           GetOffsetAfter(b) <= GetOffset(a);
+  };
+  for (int other : {0, 1, 2, 4}) {
+    EXPECT_TRUE(disjoint(3, other)) << "3 overlaps " << other;
+  }
+}
+
+TEST_F(ArenaPlannerTest, SharedArenaFollowsLargestGraph) {
+  TestGraph small_graph({0}, {{{0}, {1}, {}}}, {1});
+  (*small_graph.tensors())[0].bytes = 64;
+  (*small_graph.tensors())[1].bytes = 64;
+  TestGraph large_graph({0}, {{{0}, {1}, {}}}, {1});
+  (*large_graph.tensors())[0].bytes = 1 << 20;
+  (*large_graph.tensors())[1].bytes = 1 << 20;
+  context_.ReportError = ReportError;
+  auto shared_arena = std::make_shared<SharedArenaBuffer>(kTensorAlignment);
+  ArenaPlanner small_planner(
+      &context_, std::make_unique<TestGraphInfo>(&small_graph),
+      /*preserve_all_tensors=*/false, kTensorAlignment, /*subgraph_index=*/0,
+      /*optimize_placement=*/false, shared_arena);
+  ArenaPlanner large_planner(
+      &context_, std::make_unique<TestGraphInfo>(&large_graph),
+      /*preserve_all_tensors=*/false, kTensorAlignment, /*subgraph_index=*/0,
+      /*optimize_placement=*/false, shared_arena);
+  for (ArenaPlanner* planner : {&small_planner, &large_planner}) {
+    ASSERT_EQ(planner->ResetAllocations(), kTfLiteOk);
+    ASSERT_EQ(planner->PlanAllocations(), kTfLiteOk);
+  }
+  ASSERT_EQ(small_planner.ExecuteAllocations(0, 0), kTfLiteOk);
+  ASSERT_EQ(large_planner.ExecuteAllocations(0, 0), kTfLiteOk);
+
+  // One buffer of the size of the larger graph holds both.
+  EXPECT_EQ(shared_arena->GetSize(), 2 << 20);
+  const std::intptr_t base = large_planner.BasePointer(kTfLiteArenaRw);
+  EXPECT_EQ(small_planner.BasePointer(kTfLiteArenaRw), base);
+  // The tensors of the smaller graph followed the buffer when it moved.
+  for (int i = 0; i < 2; ++i) {
+    const std::intptr_t data =
+        reinterpret_cast<std::intptr_t>((*small_graph.tensors())[i].data.raw);
+    EXPECT_GE(data, base);
+    EXPECT_LT(data, base + (2 << 20));
+  }
+}
+
 TEST_F(ArenaPlannerTest, DebugTensors) {
   TestGraph graph({0, 1},
                   {
@@ -1558,6 +1558,10 @@ TfLiteStatus ParseFullyConnected(const Operator* op,
         params->weights_format =
             kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8;
         break;
+      case FullyConnectedOptionsWeightsFormat_PACKED4x32INT4:
+        params->weights_format =
+            kTfLiteFullyConnectedWeightsFormatPacked4x32Int4;
+        break;
       default:
         TF_LITE_REPORT_ERROR(error_reporter,
                              "Unhandled fully-connected weights format.");
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/branch_thread_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT
+
+namespace tflite {
+namespace internal {
+
+BranchThreadPool::BranchThreadPool(int num_threads) {
+  for (int thread = 1; thread < num_threads; ++thread) {
+    threads_.emplace_back([this, thread]() { WorkerLoop(thread); });
+  }
+}
+
+BranchThreadPool::~BranchThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void BranchThreadPool::ParallelFor(int num_tasks,
+                                   const std::function<void(int, int)>& fn) {
+  if (threads_.empty() || num_tasks <= 1) {
+    for (int task = 0; task < num_tasks; ++task) {
+      fn(task, /*thread=*/0);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_tasks_ = num_tasks;
+    next_task_.store(0, std::memory_order_relaxed);
+    num_busy_threads_ = threads_.size();
+    ++generation_;
+  }
+  work_cv_.notify_all();
+  RunTasks(/*thread=*/0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return num_busy_threads_ == 0; });
+  fn_ = nullptr;
+}
+
+void BranchThreadPool::WorkerLoop(int thread) {
+  int generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock,
+                    [&]() { return stop_ || generation_ != generation; });
+      if (stop_) return;
+      generation = generation_;
+    }
+    RunTasks(thread);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_busy_threads_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+void BranchThreadPool::RunTasks(int thread) {
+  for (int task = next_task_.fetch_add(1); task < num_tasks_;
+       task = next_task_.fetch_add(1)) {
+    (*fn_)(task, thread);
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_BRANCH_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_BRANCH_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace tflite {
+namespace internal {
+
+// A fixed set of threads running the independent nodes of an execution plan
+// stage concurrently. The calling thread takes part in the work, so a pool of
+// `num_threads` threads only starts `num_threads - 1` threads.
+//
+// WARNING: This is an experimental API and subject to change.
+class BranchThreadPool {
+ public:
+  explicit BranchThreadPool(int num_threads);
+  ~BranchThreadPool();
+  BranchThreadPool(const BranchThreadPool&) = delete;
+  BranchThreadPool& operator=(const BranchThreadPool&) = delete;
+
+  int num_threads() const { return threads_.size() + 1; }
+
+  // Calls `fn(task, thread)` for every task in [0, num_tasks) and returns once
+  // all the calls have returned. `thread` is in [0, num_threads()), 0 being
+  // the calling thread, and no two calls with the same `thread` overlap.
+  // Must not be called concurrently.
+  void ParallelFor(int num_tasks, const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop(int thread);
+  void RunTasks(int thread);
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  // State of the current ParallelFor call, guarded by mutex_ except for
+  // next_task_.
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+  int generation_ = 0;
+  int num_busy_threads_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_BRANCH_THREAD_POOL_H_
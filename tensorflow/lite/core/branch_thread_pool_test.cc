@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/branch_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace internal {
+namespace {
+
+using ::testing::Each;
+
+TEST(BranchThreadPoolTest, RunsEveryTaskOnce) {
+  BranchThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    pool.ParallelFor(num_tasks, [&](int task, int thread) {
+      EXPECT_GE(thread, 0);
+      EXPECT_LT(thread, 4);
+      runs[task].fetch_add(1);
+    });
+    for (const auto& run : runs) {
+      EXPECT_EQ(run.load(), 1);
+    }
+  }
+}
+
+TEST(BranchThreadPoolTest, ThreadsDontOverlap) {
+  BranchThreadPool pool(3);
+  std::vector<std::atomic<int>> running(pool.num_threads());
+  std::vector<int> overlaps(pool.num_threads(), 0);
+  for (int i = 0; i < 100; ++i) {
+    pool.ParallelFor(8, [&](int task, int thread) {
+      if (running[thread].fetch_add(1) != 0) ++overlaps[thread];
+      running[thread].fetch_sub(1);
+    });
+  }
+  EXPECT_THAT(overlaps, Each(0));
+}
+
+TEST(BranchThreadPoolTest, SingleThreadRunsOnCaller) {
+  BranchThreadPool pool(1);
+  EXPECT_EQ(pool.num_threads(), 1);
+  std::vector<int> threads;
+  pool.ParallelFor(3, [&](int task, int thread) { threads.push_back(thread); });
+  EXPECT_THAT(threads, Each(0));
+  EXPECT_EQ(threads.size(), 3);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
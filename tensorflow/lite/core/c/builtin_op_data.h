@@ -183,6 +183,7 @@ typedef struct {
 typedef enum {
   kTfLiteFullyConnectedWeightsFormatDefault = 0,
   kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8 = 1,
+  kTfLiteFullyConnectedWeightsFormatPacked4x32Int4 = 2,
 } TfLiteFullyConnectedWeightsFormat;
 
 typedef struct {
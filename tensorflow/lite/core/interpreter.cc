@@ -438,12 +438,25 @@ TfLiteStatus Interpreter::SetMetadata(
           &model_control_dependencies_)) {
     model_control_dependencies_.clear();
   }
+  const auto maybe_model_arena_placements =
+      metadata_.find(kModelArenaPlacementsMetadataKey);
+  if (maybe_model_arena_placements == metadata_.end() ||
+      !ParseModelArenaPlacements(maybe_model_arena_placements->second.data(),
+                                 maybe_model_arena_placements->second.size(),
+                                 &model_arena_placements_) ||
+      model_arena_placements_.size() != subgraphs_.size()) {
+    model_arena_placements_.clear();
+  }
   for (int subgraph_index = 0; subgraph_index < subgraphs_.size();
        ++subgraph_index) {
     TF_LITE_ENSURE_STATUS(subgraphs_[subgraph_index]->SetMetadata(
-        &metadata_, model_control_dependencies_.empty()
-                        ? nullptr
-                        : &model_control_dependencies_[subgraph_index]));
+        &metadata_,
+        model_control_dependencies_.empty()
+            ? nullptr
+            : &model_control_dependencies_[subgraph_index],
+        model_arena_placements_.empty()
+            ? nullptr
+            : &model_arena_placements_[subgraph_index]));
   }
   return kTfLiteOk;
 }
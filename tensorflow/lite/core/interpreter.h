@@ -490,6 +490,16 @@ class Interpreter {
   /// invocation.
   TfLiteStatus ReleaseNonPersistentMemory();
 
+  /// \warning Experimental interface, subject to change. \n
+  /// \brief Serializes the placements of the non-persistent arena tensors of
+  /// all subgraphs chosen by the last AllocateTensors into `metadata`. Storing
+  /// `metadata` in the model metadata under
+  /// `kModelArenaPlacementsMetadataKey` lets later interpreters of the model
+  /// reuse the placements instead of searching for them, as long as the
+  /// tensors have the same sizes, e.g. for the same input shapes. Ops are
+  /// still prepared. Fails if a subgraph has dynamic tensors.
+  TfLiteStatus GetArenaPlacementsMetadata(std::string* metadata) const;
+
   /// Update allocations for all tensors. This will redim dependent tensors
   /// using the input tensor dimensionality as given. This is relatively
   /// expensive. This *must be* called after the interpreter has been created
@@ -992,6 +1002,12 @@ class Interpreter {
   // checks when dereferencing by subgraph and operator index) will take place.
   ModelControlDependencies model_control_dependencies_;
 
+  // Arena placements that are encoded in the metadata of the model, by
+  // subgraph. Updated in SetMetadata like model_control_dependencies_. The
+  // placements are checked against the sizes and lifetimes of the tensors
+  // before being used.
+  ModelArenaPlacements model_arena_placements_;
+
   // Flag indicating whether to continue or cancel in flight invocation.
   // If false, the in flight invocation will be cancelled.
   // Will be set true when application starts a new invocation.
@@ -406,7 +406,8 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
 
 TfLiteStatus InterpreterBuilder::ParseQuantization(
     const QuantizationParameters* src_quantization,
-    TfLiteQuantization* quantization, const std::vector<int>& dims) {
+    TfLiteQuantization* quantization, const std::vector<int>& dims,
+    TensorType type) {
   quantization->type = kTfLiteNoQuantization;
   if (!src_quantization || !src_quantization->scale() ||
       src_quantization->scale()->size() == 0) {
@@ -447,9 +448,20 @@ TfLiteStatus InterpreterBuilder::ParseQuantization(
 
   // Ensure that the number of scales is 1 for per-layer quantization, and
   // matches number of quantization dimensions for per-axis quantization.
+  // INT4 tensors may also be quantized per group, with num_groups scales per
+  // index of the quantized dimension splitting the last dimension into
+  // groups of the same size.
+  const auto is_per_group = [&]() {
+    if (type != TensorType_INT4 || dims.size() < 2) return false;
+    const int channels = dims[src_quantization->quantized_dimension()];
+    if (channels <= 0 || num_scales % channels != 0) return false;
+    const int num_groups = num_scales / channels;
+    return dims.back() % num_groups == 0;
+  };
   if (num_scales != 1 &&
       (!dims.empty() &&
-       num_scales != dims[src_quantization->quantized_dimension()])) {
+       num_scales != dims[src_quantization->quantized_dimension()]) &&
+      !is_per_group()) {
     TF_LITE_REPORT_ERROR(
         error_reporter_,
         "num_scales must be 1 for per-layer quantization, or %d for per-axis "
@@ -658,7 +670,8 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
 
     const auto* src_quantization = tensor->quantization();
     TfLiteQuantization quantization;
-    if (ParseQuantization(src_quantization, &quantization, dims) != kTfLiteOk) {
+    if (ParseQuantization(src_quantization, &quantization, dims,
+                          tensor->type()) != kTfLiteOk) {
       TF_LITE_REPORT_ERROR(error_reporter_,
                            "Tensor %d has invalid quantization parameters.", i);
       status = kTfLiteError;
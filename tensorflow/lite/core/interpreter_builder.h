@@ -139,7 +139,8 @@ class InterpreterBuilder {
   TfLiteStatus ApplyDelegates(Interpreter* interpreter);
   TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
                                  TfLiteQuantization* quantization,
-                                 const std::vector<int>& dims);
+                                 const std::vector<int>& dims,
+                                 TensorType type);
   TfLiteStatus ParseSparsity(const SparsityParameters* src_sparsity,
                              TfLiteSparsity** sparsity);
   TfLiteStatus ParseSignatureDefs(
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/interpreter.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/profiling/root_profiler.h"
 
@@ -51,6 +53,16 @@ TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   return primary_subgraph().ReleaseNonPersistentMemory();
 }
 
+TfLiteStatus Interpreter::GetArenaPlacementsMetadata(
+    std::string* metadata) const {
+  ModelArenaPlacements placements(subgraphs_.size());
+  for (int i = 0; i < subgraphs_.size(); ++i) {
+    TF_LITE_ENSURE_STATUS(subgraphs_[i]->GetArenaPlacements(&placements[i]));
+  }
+  *metadata = SerializeModelArenaPlacements(placements);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::ResetVariableTensors() {
   for (auto& subgraph : subgraphs_) {
     TF_LITE_ENSURE_STATUS(subgraph->ResetVariableTensors());
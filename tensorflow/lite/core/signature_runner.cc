@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/lite/core/signature_runner.h"
 
+#include <cstddef>
 #include <vector>
 
 #include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
 
 namespace tflite {
 namespace impl {
@@ -79,6 +82,18 @@ TfLiteStatus SignatureRunner::Invoke() {
   if (subgraph_->continue_invocation_)
     (void)subgraph_->continue_invocation_->test_and_set();
 
+  if (bindings_need_allocation_) {
+    TF_LITE_ENSURE_STATUS(subgraph_->AllocateTensors());
+    bindings_need_allocation_ = false;
+  }
+  for (const auto& [tensor_index, bytes] : bound_buffer_bytes_) {
+    if (bytes < subgraph_->tensor(tensor_index)->bytes) {
+      subgraph_->ReportError("Buffer bound to tensor %d is too small",
+                             tensor_index);
+      return kTfLiteError;
+    }
+  }
+
   TF_LITE_ENSURE_STATUS(subgraph_->Invoke());
 
   // Makes sure output tensors are readable.
@@ -113,5 +128,75 @@ TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
   return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
 }
 
+TfLiteStatus SignatureRunner::BindInputBuffer(const char* input_name,
+                                              void* data, size_t bytes) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return BindBuffer(it->second, data, bytes);
+}
+
+TfLiteStatus SignatureRunner::BindOutputBuffer(const char* output_name,
+                                               void* data, size_t bytes) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return BindBuffer(it->second, data, bytes);
+}
+
+TfLiteStatus SignatureRunner::UnbindInputBuffer(const char* input_name) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return UnbindBuffer(it->second);
+}
+
+TfLiteStatus SignatureRunner::UnbindOutputBuffer(const char* output_name) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return UnbindBuffer(it->second);
+}
+
+TfLiteStatus SignatureRunner::BindBuffer(int tensor_index, void* data,
+                                         size_t bytes) {
+  const bool first_binding =
+      bound_buffer_bytes_.find(tensor_index) == bound_buffer_bytes_.end();
+  if (first_binding &&
+      subgraph_->state_ == Subgraph::kStateInvokableAndImmutable) {
+    subgraph_->ReportError(
+        "Buffers can't be bound after delegates made the graph immutable");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(subgraph_->SetCustomAllocationForTensor(
+      tensor_index, TfLiteCustomAllocation{data, bytes}));
+  bound_buffer_bytes_[tensor_index] = bytes;
+  if (first_binding) {
+    // Tensors sharing the arena memory of the tensor must be planned again.
+    subgraph_->state_ = Subgraph::kStateUninvokable;
+    bindings_need_allocation_ = true;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus SignatureRunner::UnbindBuffer(int tensor_index) {
+  if (bound_buffer_bytes_.erase(tensor_index) == 0) {
+    subgraph_->ReportError("No buffer is bound to tensor %d", tensor_index);
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(
+      subgraph_->RemoveCustomAllocationForTensor(tensor_index));
+  bindings_need_allocation_ = true;
+  return kTfLiteOk;
+}
+
 }  // namespace impl
 }  // namespace tflite
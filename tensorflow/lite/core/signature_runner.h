@@ -27,6 +27,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -204,6 +205,39 @@ class SignatureRunner {
       const char* output_name, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds the caller-owned buffer `data` of `bytes` bytes to the given
+  /// input, so that invocations read the input from it without copies.
+  /// The runtime does NOT take ownership of the underlying memory.
+  ///
+  /// Unlike `SetCustomAllocationForInputTensor`, bindings are managed by the
+  /// signature runner:
+  /// 1. The first binding of a tensor excludes it from the arena; the memory
+  ///    plan is redone by the next `Invoke` if needed.
+  /// 2. A bound tensor can be bound to another buffer before every `Invoke`,
+  ///    e.g. to the next camera frame, without calling `AllocateTensors`.
+  /// 3. Bindings are kept across `ResizeInputTensor` and `AllocateTensors`,
+  ///    and every buffer is checked against the tensor size before invoking.
+  ///
+  /// `data` must be aligned to kDefaultTensorAlignment defined in
+  /// lite/util.h and stay valid until the tensor is bound to another buffer
+  /// or unbound. Bindings must be made before applying delegates which make
+  /// the graph immutable.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindInputBuffer(const char* input_name, void* data,
+                               size_t bytes);
+
+  /// \brief Same as `BindInputBuffer`, for the given output. Invocations
+  /// write the output to `data`.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindOutputBuffer(const char* output_name, void* data,
+                                size_t bytes);
+
+  /// \brief Unbinds the buffer bound to the given input or output, which gets
+  /// interpreter-owned memory again from the next `Invoke`.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus UnbindInputBuffer(const char* input_name);
+  TfLiteStatus UnbindOutputBuffer(const char* output_name);
+
   /// \brief Set if buffer handle output is allowed.
   ///
   /// When using hardware delegation, Interpreter will make the data of output
@@ -228,6 +262,9 @@ class SignatureRunner {
   friend class ::tflite::SignatureRunnerJNIHelper;
   friend class ::tflite::TensorHandle;
 
+  TfLiteStatus BindBuffer(int tensor_index, void* data, size_t bytes);
+  TfLiteStatus UnbindBuffer(int tensor_index);
+
   // The SignatureDef object is owned by the interpreter.
   const internal::SignatureDef* signature_def_;
   // The Subgraph object is owned by the interpreter.
@@ -238,6 +275,12 @@ class SignatureRunner {
   std::vector<const char*> output_names_;
 
   bool allow_buffer_handle_output_ = false;
+
+  // Size of the buffer bound to every bound tensor, by tensor index.
+  std::map<int, size_t> bound_buffer_bytes_;
+  // True if bindings changed which tensors the arena holds since the last
+  // memory plan.
+  bool bindings_need_allocation_ = false;
 };
 
 }  // namespace impl
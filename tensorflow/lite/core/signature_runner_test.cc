@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace impl {
@@ -96,6 +97,58 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, BindsBuffers) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float inputs[2][16] = {{2, 4}, {1, 3}};
+  alignas(kDefaultTensorAlignment) float outputs[2][16] = {};
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(add_runner->BindInputBuffer("x", inputs[i], sizeof(inputs[i])),
+              kTfLiteOk);
+    ASSERT_EQ(add_runner->BindOutputBuffer("output_0", outputs[i],
+                                           sizeof(outputs[i])),
+              kTfLiteOk);
+    ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(add_runner->output_tensor("output_0")->data.f, outputs[i]);
+    EXPECT_EQ(outputs[i][0], inputs[i][0] + 2);
+    EXPECT_EQ(outputs[i][1], inputs[i][1] + 2);
+  }
+
+  // Buffers are checked against the tensor size.
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {32}), kTfLiteOk);
+  ASSERT_NE(add_runner->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(add_runner->BindInputBuffer("x", inputs[0], 4), kTfLiteOk);
+  EXPECT_NE(add_runner->Invoke(), kTfLiteOk);
+
+  // Unbound tensors get interpreter-owned memory again.
+  ASSERT_EQ(add_runner->UnbindInputBuffer("x"), kTfLiteOk);
+  ASSERT_EQ(add_runner->UnbindOutputBuffer("output_0"), kTfLiteOk);
+  EXPECT_NE(add_runner->UnbindOutputBuffer("output_0"), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* input = add_runner->input_tensor("x");
+  ASSERT_NE(input->data.f, inputs[0]);
+  input->data.f[0] = 5;
+  input->data.f[1] = 6;
+  ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+  const TfLiteTensor* output = add_runner->output_tensor("output_0");
+  EXPECT_NE(output->data.f, outputs[1]);
+  EXPECT_EQ(output->data.f[0], 7);
+  EXPECT_EQ(output->data.f[1], 8);
+}
+
 }  // namespace
 }  // namespace impl
 }  // namespace tflite
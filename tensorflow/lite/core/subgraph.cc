@@ -38,9 +38,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
+#include "tensorflow/lite/core/branch_thread_pool.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -78,6 +80,10 @@ struct TfLiteSparsityDeleter {
 using ScopedTfLiteSparsity =
     std::unique_ptr<TfLiteSparsity, TfLiteSparsityDeleter>;
 
+// CPU backend context of the ops run by Subgraph::InvokeConcurrentNodes on
+// the current thread, if any.
+thread_local TfLiteExternalContext* branch_cpu_backend_context = nullptr;
+
 TfLiteStatus ReportOpError(TfLiteContext* context, const TfLiteNode& node,
                            const TfLiteRegistration& registration,
                            int node_index, const char* message) {
@@ -242,6 +248,10 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const override {
+    return subgraph_->concurrent_nodes(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -565,6 +575,8 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   GetDelegateKernalName(registration), node_subsets.size());
 
   execution_plan_.clear();
+  concurrent_nodes_.clear();
+  arena_placement_cache_.clear();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -616,6 +628,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext && branch_cpu_backend_context) {
+    return branch_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -840,9 +855,33 @@ TfLiteStatus Subgraph::SetVariables(std::vector<int> variables) {
 
 TfLiteStatus Subgraph::SetMetadata(
     const std::map<std::string, std::string>* metadata,
-    const ControlEdges* control_edges) {
+    const ControlEdges* control_edges,
+    const ArenaPlacements* arena_placements) {
   metadata_ = metadata;
   control_edges_ = control_edges;
+  arena_placements_ = arena_placements;
+  if (memory_planner_ && arena_placements_) {
+    memory_planner_->SetArenaPlacements(*arena_placements_);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::GetArenaPlacements(ArenaPlacements* placements) {
+  placements->clear();
+  // Subgraphs which were never allocated, e.g. branches of control flow ops
+  // not run yet, have no placements.
+  if (!memory_planner_) return kTfLiteOk;
+  if (next_execution_plan_index_to_prepare_ !=
+      static_cast<int>(execution_plan_.size())) {
+    ReportError(
+        "Arena placements are only available for subgraphs without dynamic "
+        "tensors.");
+    return kTfLiteError;
+  }
+  if (!memory_planner_->GetArenaPlacements(placements)) {
+    ReportError("The memory planner doesn't support arena placements.");
+    return kTfLiteError;
+  }
   return kTfLiteOk;
 }
 
@@ -1021,6 +1060,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Initialize the mapping between tensor index and the last execution plan
   // index that uses the tensor.
   InitializeTensorReleaseMap();
+  ReleaseConstantTensors();
 
   // Temporary tensors allocated during Prepare for nodes which are subsequently
   // delegated are not required and can be freed.
@@ -1134,6 +1174,8 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  concurrent_nodes_.clear();
+  arena_placement_cache_.clear();
   return kTfLiteOk;
 }
 
@@ -1523,28 +1565,81 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
         last_original_exec_plan_index_prepared + 1;
   }
 
+  // The execution plan is only reordered, and its stages only run
+  // concurrently, when preparing it from the start, i.e. never during Invoke.
+  const bool prepare_from_start = next_execution_plan_index_to_prepare_ == 0;
+  bool replan_allocations = prepare_from_start && OrderExecutionPlanByStage();
+
   int last_exec_plan_index_prepared = 0;
   TF_LITE_ENSURE_STATUS(
       PrepareOpsStartingAt(next_execution_plan_index_to_prepare_,
                            execution_plan_, &last_exec_plan_index_prepared));
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
+  if (prepare_from_start) {
+    replan_allocations |= UpdateConcurrentNodes();
+  }
+  if (memory_planner_ && replan_allocations) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
     memory_planner_ = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+        kDefaultTensorAlignment, subgraph_index_,
+        ShouldOptimizeArenaPlacement(), SharedArena());
 #endif
+    if (arena_placements_) {
+      memory_planner_->SetArenaPlacements(*arena_placements_);
+    }
     memory_planner_->PlanAllocations();
   }
 
+  // Reuse the arena placement found earlier for the same input shapes.
+  const int arena_placement_cache_size = ArenaPlacementCacheSize();
+  std::vector<int> input_shapes;
+  bool arena_placements_cached = false;
+  if (prepare_from_start && arena_placement_cache_size > 0) {
+    input_shapes = GetInputShapeSignature();
+    auto it = std::find_if(
+        arena_placement_cache_.begin(), arena_placement_cache_.end(),
+        [&input_shapes](const auto& entry) {
+          return entry.first == input_shapes;
+        });
+    arena_placements_cached = it != arena_placement_cache_.end();
+    if (arena_placements_cached) {
+      arena_placement_cache_.splice(arena_placement_cache_.begin(),
+                                    arena_placement_cache_, it);
+      memory_planner_->SetArenaPlacements(it->second);
+    } else {
+      memory_planner_->SetArenaPlacements(
+          arena_placements_ ? *arena_placements_ : ArenaPlacements());
+    }
+  }
+
   // Execute arena allocations.
   TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
       next_execution_plan_index_to_plan_allocation_,
       last_exec_plan_index_prepared));
 
+  // Placements are only complete when no tensor is dynamic.
+  if (prepare_from_start && arena_placement_cache_size > 0 &&
+      !arena_placements_cached &&
+      next_execution_plan_index_to_prepare_ ==
+          static_cast<int>(execution_plan_.size())) {
+    ArenaPlacements placements;
+    if (memory_planner_->GetArenaPlacements(&placements)) {
+      arena_placement_cache_.emplace_front(std::move(input_shapes),
+                                           std::move(placements));
+      if (static_cast<int>(arena_placement_cache_.size()) >
+          arena_placement_cache_size) {
+        arena_placement_cache_.pop_back();
+      }
+    }
+  }
+
   if (!custom_allocations_.empty()) {
     // Verify custom allocations for output tensors from the ops that have just
     // been prepared. Other output tensors might be resized later.
@@ -1590,7 +1685,13 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
 }
 
 TfLiteStatus Subgraph::Invoke() {
+  SharedArenaBuffer* shared_arena = SharedArena().get();
+  if (shared_arena && !shared_arena->TryLock()) {
+    ReportError("Invoke called while the shared arena is in use.");
+    return kTfLiteError;
+  }
   auto status = InvokeImpl();
+  if (shared_arena) shared_arena->Unlock();
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
   return status;
 }
@@ -1625,6 +1726,16 @@ TfLiteStatus Subgraph::InvokeImpl() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    if (!concurrent_nodes_.empty()) {
+      const int last_concurrent_node =
+          concurrent_nodes_[execution_plan_index].second;
+      if (last_concurrent_node > execution_plan_index) {
+        TF_LITE_ENSURE_STATUS(
+            InvokeConcurrentNodes(execution_plan_index, last_concurrent_node));
+        execution_plan_index = last_concurrent_node;
+        continue;
+      }
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1647,6 +1758,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
           (node.delegate->flags & kTfLiteDelegateFlagsPerOperatorProfiling));
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
+    PrefetchConstantTensors(execution_plan_index + 1);
 
     for (int i = 0; i < node.inputs->size; ++i) {
       int tensor_index = node.inputs->data[i];
@@ -1724,6 +1836,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     }
     // Release dynamic tensor memory if configured by the user.
     MaybeReleaseDynamicTensors(node, node_index);
+    MaybeReleaseConstantTensors(node, node_index);
 
 #ifdef TF_LITE_TENSORFLOW_PROFILER
     tflite::OnTfLiteOpInvokeEnd(trace_op);
@@ -1735,6 +1848,262 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+namespace {
+
+// Returns true if `node` must not run concurrently with any other node.
+bool MustRunAlone(const TfLiteNode& node,
+                  const TfLiteRegistration& registration,
+                  const std::vector<TfLiteTensor>& tensors) {
+  // Delegate kernels may share state, e.g. a thread pool, between nodes.
+  if (node.might_have_side_effect || node.delegate != nullptr) return true;
+  switch (registration.builtin_code) {
+    // Ops running subgraphs, which can't be invoked concurrently.
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinReduceWindow:
+    case kTfLiteBuiltinStablehloComposite:
+    case kTfLiteBuiltinStablehloReduce:
+    case kTfLiteBuiltinStablehloReduceWindow:
+    case kTfLiteBuiltinStablehloScatter:
+    case kTfLiteBuiltinStablehloSort:
+    case kTfLiteBuiltinStablehloWhile:
+      return true;
+    default:
+      break;
+  }
+  // Variable tensors are updated in place, and variant tensors may share
+  // state between ops.
+  const auto uses_state = [&tensors](const TfLiteIntArray* indices) {
+    for (int i = 0; i < indices->size; ++i) {
+      const int index = indices->data[i];
+      if (index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors[index];
+      if (tensor.is_variable || tensor.type == kTfLiteVariant ||
+          tensor.type == kTfLiteResource) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return uses_state(node.inputs) || uses_state(node.outputs);
+}
+
+}  // namespace
+
+std::vector<int> Subgraph::GetInputShapeSignature() const {
+  std::vector<int> signature;
+  for (int tensor_index : inputs_) {
+    if (tensor_index == kTfLiteOptionalTensor) {
+      signature.push_back(-1);
+      continue;
+    }
+    const TfLiteIntArray* dims = tensors_[tensor_index].dims;
+    if (dims == nullptr) {
+      signature.push_back(0);
+      continue;
+    }
+    signature.push_back(dims->size);
+    signature.insert(signature.end(), dims->data, dims->data + dims->size);
+  }
+  return signature;
+}
+
+bool Subgraph::OrderExecutionPlanByStage() {
+  if (MaxParallelBranches() <= 1) {
+    execution_plan_stages_.clear();
+    return false;
+  }
+  const int num_nodes = execution_plan_.size();
+  // Stage of the node producing every tensor, -1 for tensors not produced by
+  // the execution plan.
+  std::vector<int> producer_stage(tensors_.size(), -1);
+  std::vector<int> node_stage(nodes_and_registration_.size(), -1);
+  std::vector<int> stages(num_nodes);
+  // Nodes must run after `first_stage`, the stage following the last node
+  // that must run alone.
+  int first_stage = 0;
+  int last_stage = -1;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    int stage = first_stage;
+    if (MustRunAlone(node, registration, tensors_)) {
+      stage = std::max(first_stage, last_stage + 1);
+      first_stage = stage + 1;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        stage = std::max(stage, producer_stage[tensor_index] + 1);
+      }
+      if (control_edges_) {
+        for (const ControlEdge& edge : *control_edges_) {
+          if (edge.second == node_index && edge.first >= 0 &&
+              edge.first < static_cast<int>(node_stage.size()) &&
+              node_stage[edge.first] >= 0) {
+            stage = std::max(stage, node_stage[edge.first] + 1);
+          }
+        }
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      producer_stage[tensor_index] = stage;
+    }
+    node_stage[node_index] = stage;
+    stages[i] = stage;
+    last_stage = std::max(last_stage, stage);
+  }
+
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&stages](int a, int b) { return stages[a] < stages[b]; });
+  bool changed = false;
+  std::vector<int> new_plan(num_nodes);
+  execution_plan_stages_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    changed |= order[i] != i;
+    new_plan[i] = execution_plan_[order[i]];
+    execution_plan_stages_[i] = stages[order[i]];
+  }
+  execution_plan_ = std::move(new_plan);
+  return changed;
+}
+
+bool Subgraph::UpdateConcurrentNodes() {
+  const int num_nodes = execution_plan_.size();
+  bool run_concurrently =
+      MaxParallelBranches() > 1 &&
+      static_cast<int>(execution_plan_stages_.size()) == num_nodes &&
+      next_execution_plan_index_to_prepare_ == num_nodes;
+  for (int i = 0; run_concurrently && i < num_nodes; ++i) {
+    const TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[i]].first;
+    // Dynamic tensors are resized while the ops run.
+    run_concurrently = !HasDynamicTensor(context_, node.outputs, nullptr) &&
+                       !HasDynamicTensor(context_, node.temporaries, nullptr);
+  }
+  std::vector<std::pair<size_t, size_t>> concurrent_nodes;
+  int max_stage_size = 1;
+  if (run_concurrently) {
+    concurrent_nodes.resize(num_nodes);
+    for (int first = 0, last = 0; first < num_nodes; first = last + 1) {
+      last = first;
+      const int stage = execution_plan_stages_[first];
+      while (last + 1 < num_nodes &&
+             execution_plan_stages_[last + 1] == stage) {
+        ++last;
+      }
+      for (int i = first; i <= last; ++i) concurrent_nodes[i] = {first, last};
+      max_stage_size = std::max(max_stage_size, last - first + 1);
+    }
+    if (max_stage_size == 1) concurrent_nodes.clear();
+  }
+  if (!concurrent_nodes.empty()) {
+    const int num_threads = std::min(MaxParallelBranches(), max_stage_size);
+    if (!branch_thread_pool_ ||
+        branch_thread_pool_->num_threads() != num_threads) {
+      branch_thread_pool_ =
+          std::make_unique<internal::BranchThreadPool>(num_threads);
+      branch_cpu_backend_contexts_.resize(num_threads);
+      for (auto& cpu_backend_context : branch_cpu_backend_contexts_) {
+        if (!cpu_backend_context) {
+          cpu_backend_context = std::make_unique<ExternalCpuBackendContext>();
+        }
+      }
+    }
+  }
+  const bool changed = concurrent_nodes != concurrent_nodes_;
+  concurrent_nodes_ = std::move(concurrent_nodes);
+  return changed;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentNodes(int first_execution_plan_index,
+                                             int last_execution_plan_index) {
+  TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(),
+                                       "InvokeConcurrentNodes");
+  // Everything that may report an error or change the subgraph happens on
+  // the calling thread, the other threads only run the ops.
+  for (int execution_plan_index = first_execution_plan_index;
+       execution_plan_index <= last_execution_plan_index;
+       ++execution_plan_index) {
+    auto& [node, registration] =
+        nodes_and_registration_[execution_plan_[execution_plan_index]];
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const int tensor_index = node.inputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->delegate != node.delegate &&
+          tensor->data_is_stale) {
+        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+      }
+      // See InvokeImpl for the shape input of reshape.
+      if (tensor->data.raw == nullptr && tensor->bytes > 0 &&
+          !(registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+            tensor->dims->size != 1)) {
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+    MayAllocateOpOutput(&node);
+  }
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+  EnsureTensorsVectorCapacity();
+
+  // Divide the threads given to the ops between the threads running them.
+  const int num_threads = branch_thread_pool_->num_threads();
+  const int recommended_num_threads = context_.recommended_num_threads;
+  if (recommended_num_threads > 0) {
+    context_.recommended_num_threads =
+        std::max(1, recommended_num_threads / num_threads);
+  }
+  for (auto& cpu_backend_context : branch_cpu_backend_contexts_) {
+    if (cpu_backend_context->internal_backend_context() &&
+        context_.recommended_num_threads != -1) {
+      cpu_backend_context->internal_backend_context()->SetMaxNumThreads(
+          context_.recommended_num_threads);
+    }
+  }
+  const int num_nodes =
+      last_execution_plan_index - first_execution_plan_index + 1;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  branch_thread_pool_->ParallelFor(num_nodes, [&](int task, int thread) {
+    const int node_index = execution_plan_[first_execution_plan_index + task];
+    auto& node_and_registration = nodes_and_registration_[node_index];
+    branch_cpu_backend_context = branch_cpu_backend_contexts_[thread].get();
+    statuses[task] = OpInvoke(node_and_registration.second,
+                              &node_and_registration.first);
+    branch_cpu_backend_context = nullptr;
+  });
+  context_.recommended_num_threads = recommended_num_threads;
+
+  for (int task = 0; task < num_nodes; ++task) {
+    const int node_index = execution_plan_[first_execution_plan_index + task];
+    const auto& node_and_registration = nodes_and_registration_[node_index];
+    if (statuses[task] != kTfLiteOk) {
+      auto err =
+          ReportOpError(&context_, node_and_registration.first,
+                        node_and_registration.second, node_index,
+                        "failed to invoke");
+      return statuses[task] == kTfLiteCancelled ? statuses[task] : err;
+    }
+    MaybeReleaseDynamicTensors(node_and_registration.first, node_index);
+    MaybeReleaseConstantTensors(node_and_registration.first, node_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1967,6 +2336,8 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  concurrent_nodes_.clear();
+  arena_placement_cache_.clear();
   return kTfLiteOk;
 }
 
@@ -2105,6 +2476,8 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  concurrent_nodes_.clear();
+  arena_placement_cache_.clear();
 
   // Handling FP16 delegation (if applies).
   //
@@ -2373,6 +2746,19 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::RemoveCustomAllocationForTensor(int tensor_index) {
+  TF_LITE_ENSURE(context(), state_ != kStateInvokableAndImmutable);
+  const auto it = custom_allocations_.find(tensor_index);
+  TF_LITE_ENSURE(context(), it != custom_allocations_.end());
+  custom_allocations_.erase(it);
+  TfLiteTensor* tensor = &context_.tensors[tensor_index];
+  tensor->allocation_type = kTfLiteArenaRw;
+  tensor->data.data = nullptr;
+  // The memory plan must include the tensor again.
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
@@ -2487,4 +2873,53 @@ void Subgraph::MaybeReleaseDynamicTensors(const TfLiteNode& node,
   }
 }
 
+const MMAPAllocation* Subgraph::StreamedAllocation() const {
+  if (!options_ || !options_->GetStreamConstantTensors() || !allocation_ ||
+      allocation_->type() != tflite::Allocation::Type::kMMap) {
+    return nullptr;
+  }
+  return static_cast<const MMAPAllocation*>(allocation_);
+}
+
+void Subgraph::ReleaseConstantTensors() {
+  const MMAPAllocation* allocation = StreamedAllocation();
+  if (!allocation) return;
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteMmapRo) {
+      allocation->AdviseDontNeed(tensor.data.raw, tensor.bytes);
+    }
+  }
+}
+
+void Subgraph::PrefetchConstantTensors(int execution_plan_index) {
+  if (execution_plan_index >= static_cast<int>(execution_plan_.size())) return;
+  const MMAPAllocation* allocation = StreamedAllocation();
+  if (!allocation) return;
+  const TfLiteNode& node =
+      nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const TfLiteTensor* input_tensor = tensor(node.inputs->data[i]);
+    if (input_tensor && input_tensor->allocation_type == kTfLiteMmapRo) {
+      allocation->AdviseWillNeed(input_tensor->data.raw, input_tensor->bytes);
+    }
+  }
+}
+
+void Subgraph::MaybeReleaseConstantTensors(const TfLiteNode& node,
+                                           size_t node_index) {
+  const MMAPAllocation* allocation = StreamedAllocation();
+  if (!allocation) return;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int input_tensor_index = node.inputs->data[i];
+    const TfLiteTensor* input_tensor = tensor(input_tensor_index);
+    if (!input_tensor || input_tensor->allocation_type != kTfLiteMmapRo) {
+      continue;
+    }
+    auto it = tensor_to_last_op_index_.find(input_tensor_index);
+    if (it != tensor_to_last_op_index_.end() && it->second == node_index) {
+      allocation->AdviseDontNeed(input_tensor->data.raw, input_tensor->bytes);
+    }
+  }
+}
+
 }  // namespace tflite
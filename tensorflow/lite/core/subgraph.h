@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <atomic>
 #include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
@@ -33,10 +34,12 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/core/branch_thread_pool.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -410,6 +413,14 @@ class Subgraph {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Removes the custom memory allocation of the given tensor, which gets
+  // interpreter-owned memory again after the next AllocateTensors().
+  // Fails if the tensor has no custom allocation, or if delegates made the
+  // graph immutable.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus RemoveCustomAllocationForTensor(int tensor_index);
+
   void SetName(const char* name);
   const std::string& GetName() const;
 
@@ -424,6 +435,14 @@ class Subgraph {
   // information about tenosrs and ops.
   void DumpMemoryPlannerDebugInfo() const;
 
+  // WARNING: This is an experimental API and subject to change.
+  // Fills `placements` with the placements of the non-persistent arena tensors
+  // chosen by the last AllocateTensors, to be reused through the model
+  // metadata, see `Interpreter::GetArenaPlacementsMetadata`. `placements` is
+  // empty if the subgraph hasn't been allocated. Fails if the subgraph has
+  // dynamic tensors.
+  TfLiteStatus GetArenaPlacements(ArenaPlacements* placements);
+
   typedef struct SubgraphAllocInfo {
     size_t arena_size;
     size_t arena_persist_size;
@@ -455,6 +474,41 @@ class Subgraph {
     return (options_ && options_->GetPreserveAllTensors());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if the arena planner should search for a smaller tensor placement.
+  bool ShouldOptimizeArenaPlacement() const {
+    return (options_ && options_->GetOptimizeArenaPlacement());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of input shape signatures whose arena placements are kept.
+  int ArenaPlacementCacheSize() const {
+    return options_ ? options_->GetArenaPlacementCacheSize() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // The arena shared with other interpreters, if any. Only the primary
+  // subgraph uses it, since control flow ops invoke the other subgraphs while
+  // the tensors of their caller are live.
+  std::shared_ptr<SharedArenaBuffer> SharedArena() const {
+    return options_ && subgraph_index_ == 0 ? options_->GetSharedArena()
+                                            : nullptr;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Maximum number of independent nodes run at the same time.
+  int MaxParallelBranches() const {
+    return options_ ? options_->GetMaxParallelBranches() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the first and last execution plan indices of the nodes that run
+  // concurrently with the node at execution plan index `index`.
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const {
+    return concurrent_nodes_.empty() ? std::make_pair(index, index)
+                                     : concurrent_nodes_[index];
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // True if all intermediate dynamic tensors should be released once they are
   // not used by the model.
@@ -720,6 +774,26 @@ class Subgraph {
   // Does not report invoke status through profiler.
   TfLiteStatus InvokeImpl();
 
+  // If parallel branches are enabled, stably orders the execution plan by
+  // stage, the stage of a node being the number of nodes it transitively
+  // depends on along its longest path. Nodes that can't run concurrently with
+  // others get a stage of their own. Returns true if the order changed.
+  bool OrderExecutionPlanByStage();
+
+  // Runs the stages of the execution plan concurrently if parallel branches
+  // are enabled, all the nodes are prepared and no tensor is dynamic, and
+  // sequentially otherwise. Returns true if this changed the lifetimes the
+  // memory planner must use.
+  bool UpdateConcurrentNodes();
+
+  // Invokes the nodes at execution plan indices [first, last] of a stage
+  // concurrently.
+  TfLiteStatus InvokeConcurrentNodes(int first_execution_plan_index,
+                                     int last_execution_plan_index);
+
+  // Returns the rank and dimensions of every input tensor, concatenated.
+  std::vector<int> GetInputShapeSignature() const;
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -925,7 +999,8 @@ class Subgraph {
   // remains valid for the latter's lifetime.
   // Also sets relevant fields on context_ based on known metadata.
   TfLiteStatus SetMetadata(const std::map<std::string, std::string>* metadata,
-                           const ControlEdges* control_edges = nullptr);
+                           const ControlEdges* control_edges = nullptr,
+                           const ArenaPlacements* arena_placements = nullptr);
 
   // Initializes the mapping between tensor index to the index of the
   // last operation that uses the tensor as input.
@@ -940,6 +1015,22 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Returns the memory-mapped model file if the constant tensors are streamed
+  // from it, or nullptr.
+  const MMAPAllocation* StreamedAllocation() const;
+
+  // Drops the pages of all constant tensors from memory, e.g. once Prepare
+  // has touched them, if they are streamed.
+  void ReleaseConstantTensors();
+
+  // Starts paging in the constant inputs of the node at `execution_plan_index`
+  // if they are streamed.
+  void PrefetchConstantTensors(int execution_plan_index);
+
+  // Drops the pages of the constant inputs of `node` that no later node reads
+  // if they are streamed.
+  void MaybeReleaseConstantTensors(const TfLiteNode& node, size_t node_index);
+
   // The state of the Subgraph.
   enum State {
     // The Subgraph isn't ready to be invoked.
@@ -1061,6 +1152,19 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Stage of every node of the execution plan, set by
+  // OrderExecutionPlanByStage.
+  std::vector<int> execution_plan_stages_;
+  // For every execution plan index, the first and last execution plan indices
+  // of its stage. Empty when the execution plan runs sequentially.
+  std::vector<std::pair<size_t, size_t>> concurrent_nodes_;
+  // Threads running the nodes of a stage, and the CPU backend context used by
+  // the ops on each of them, since ruy and gemmlowp contexts can't be shared
+  // between threads.
+  std::unique_ptr<internal::BranchThreadPool> branch_thread_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      branch_cpu_backend_contexts_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -1137,6 +1241,15 @@ class Subgraph {
   // metadata_ by appropriately parametrized SetMetadata method calls.
   const ControlEdges* control_edges_ = nullptr;
 
+  // Placements of the non-persistent arena tensors computed ahead of time;
+  // can be nullptr. Initialized from metadata like `control_edges_`.
+  const ArenaPlacements* arena_placements_ = nullptr;
+
+  // Arena placements found for recent input shape signatures, most recently
+  // used first. See `InterpreterOptions::SetArenaPlacementCacheSize`.
+  std::list<std::pair<std::vector<int>, ArenaPlacements>>
+      arena_placement_cache_;
+
   // Whether this subgraph is "delegation skippable". If a subgraph is
   // delegation-skippable, then the subgraph will be handled by a TfLiteDelegate
   // (and that the delegate is supposed to be already aware of this state), and
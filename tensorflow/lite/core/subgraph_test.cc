@@ -83,6 +83,77 @@ TEST(RemoveUnusedInputs, BypassInputsWithoutOp) {
   ASSERT_EQ(subgraph.inputs(), std::vector<int>({0, -1, 2}));
 }
 
+TEST(ParallelBranches, RunsIndependentNodesInTheSameStage) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetMaxParallelBranches(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                                    TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({2, 4});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  // Two branches of two nodes each, added one branch after the other.
+  subgraph.AddNodeWithParameters({0}, {1}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({0}, {3}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({3}, {4}, {}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(subgraph.execution_plan(), ElementsAreArray({0, 2, 1, 3}));
+  EXPECT_EQ(subgraph.concurrent_nodes(0), std::make_pair<size_t>(0, 1));
+  EXPECT_EQ(subgraph.concurrent_nodes(3), std::make_pair<size_t>(2, 3));
+
+  for (float value : {1.f, -3.f}) {
+    float* input = subgraph.tensor(0)->data.f;
+    input[0] = value;
+    input[1] = 2 * value;
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    for (int output : {2, 4}) {
+      EXPECT_THAT(std::vector<float>(subgraph.tensor(output)->data.f,
+                                     subgraph.tensor(output)->data.f + 2),
+                  ElementsAreArray({value, 2 * value}));
+    }
+  }
+}
+
+TEST(ArenaPlacementCache, AlternatingInputShapes) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetArenaPlacementCacheSize(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                                    TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({2});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {1}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {2}, {}, nullptr, 0, nullptr, neg_op);
+
+  // Shapes 2 and 5 are served from the cache after their first use, shape 3
+  // evicts shape 2.
+  for (int size : {2, 5, 2, 5, 3, 2, 5}) {
+    ASSERT_EQ(subgraph.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+    std::vector<float> values(size);
+    std::iota(values.begin(), values.end(), 1.f);
+    std::copy(values.begin(), values.end(), subgraph.tensor(0)->data.f);
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    EXPECT_THAT(std::vector<float>(subgraph.tensor(2)->data.f,
+                                   subgraph.tensor(2)->data.f + size),
+                ElementsAreArray(values));
+  }
+}
+
 TEST(GetSubgraphContext, NonConstGetSubgraphContext) {
   Interpreter interpreter;
   auto& subgraph = interpreter.primary_subgraph();
@@ -34,17 +34,24 @@ OptionalAndroidHardwareBuffer::OptionalAndroidHardwareBuffer() {
       dlsym(dlopen_handle_, "AHardwareBuffer_release"));
   describe_ = reinterpret_cast<decltype(describe_)>(
       dlsym(dlopen_handle_, "AHardwareBuffer_describe"));
+  lock_ = reinterpret_cast<decltype(lock_)>(
+      dlsym(dlopen_handle_, "AHardwareBuffer_lock"));
+  unlock_ = reinterpret_cast<decltype(unlock_)>(
+      dlsym(dlopen_handle_, "AHardwareBuffer_unlock"));
   is_supported_ = reinterpret_cast<decltype(is_supported_)>(
       dlsym(dlopen_handle_, "AHardwareBuffer_isSupported"));
   supported_ =
       (allocate_ != nullptr && acquire_ != nullptr && release_ != nullptr &&
-       describe_ != nullptr && is_supported_ != nullptr);
+       describe_ != nullptr && is_supported_ != nullptr && lock_ != nullptr &&
+       unlock_ != nullptr);
 #else
   dlopen_handle_ = nullptr;
   allocate_ = nullptr;
   acquire_ = nullptr;
   release_ = nullptr;
   describe_ = nullptr;
+  lock_ = nullptr;
+  unlock_ = nullptr;
   is_supported_ = nullptr;
   supported_ = false;
 #endif
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/background_gpu_interpreter.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/gpu/delegate.h"
+#include "tensorflow/lite/delegates/gpu/delegate_options.h"
+#include "tensorflow/lite/delegates/serialization.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace gpu {
+
+absl::StatusOr<std::unique_ptr<BackgroundGpuInterpreter>>
+BackgroundGpuInterpreter::Create(const FlatBufferModel& model,
+                                 const OpResolver& op_resolver,
+                                 const TfLiteGpuDelegateOptionsV2& options,
+                                 const std::string& cache_dir) {
+  auto runner =
+      absl::WrapUnique(new BackgroundGpuInterpreter(model, op_resolver));
+  runner->SetGpuOptions(options, cache_dir);
+  BackgroundGpuInterpreter* const runner_ptr = runner.get();
+  absl::Status status = runner->Start([runner_ptr] {
+    return Interpreter::TfLiteDelegatePtr(
+        TfLiteGpuDelegateV2Create(&runner_ptr->options_),
+        TfLiteGpuDelegateV2Delete);
+  });
+  if (!status.ok()) return status;
+  return runner;
+}
+
+absl::StatusOr<std::unique_ptr<BackgroundGpuInterpreter>>
+BackgroundGpuInterpreter::CreateWithDelegateFactory(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    DelegateFactory delegate_factory) {
+  auto runner =
+      absl::WrapUnique(new BackgroundGpuInterpreter(model, op_resolver));
+  absl::Status status = runner->Start(std::move(delegate_factory));
+  if (!status.ok()) return status;
+  return runner;
+}
+
+void BackgroundGpuInterpreter::SetGpuOptions(
+    const TfLiteGpuDelegateOptionsV2& options, const std::string& cache_dir) {
+  options_ = options;
+  options_.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY;
+  options_.experimental_flags &= ~TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY;
+
+  // Caches the compiled kernels unless the options already do.
+  if (options_.serialization_dir != nullptr) {
+    serialization_dir_ = options_.serialization_dir;
+  } else {
+    serialization_dir_ = cache_dir;
+  }
+  if (options_.model_token != nullptr) {
+    model_token_ = options_.model_token;
+  } else if (model_.allocation() != nullptr) {
+    model_token_ = delegates::StrFingerprint(model_.allocation()->base(),
+                                             model_.allocation()->bytes());
+  }
+  if (!serialization_dir_.empty() && !model_token_.empty()) {
+    options_.experimental_flags |=
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
+    options_.serialization_dir = serialization_dir_.c_str();
+    options_.model_token = model_token_.c_str();
+  }
+}
+
+absl::Status BackgroundGpuInterpreter::Start(DelegateFactory delegate_factory) {
+  if (InterpreterBuilder(model_, op_resolver_)(&cpu_interpreter_) !=
+      kTfLiteOk) {
+    return absl::InternalError("Failed to build the CPU interpreter");
+  }
+  if (cpu_interpreter_->AllocateTensors() != kTfLiteOk) {
+    return absl::InternalError("Failed to allocate the CPU interpreter");
+  }
+  gpu_thread_ =
+      std::thread([this, delegate_factory = std::move(delegate_factory)] {
+        gpu_status_ = BuildGpuInterpreter(delegate_factory);
+      });
+  return absl::OkStatus();
+}
+
+BackgroundGpuInterpreter::~BackgroundGpuInterpreter() {
+  if (gpu_thread_.joinable()) gpu_thread_.join();
+}
+
+absl::Status BackgroundGpuInterpreter::WaitForGpu() {
+  if (gpu_thread_.joinable()) gpu_thread_.join();
+  return gpu_status_;
+}
+
+absl::Status BackgroundGpuInterpreter::BuildGpuInterpreter(
+    const DelegateFactory& delegate_factory) {
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(model_, op_resolver_)(&interpreter) != kTfLiteOk) {
+    return absl::InternalError("Failed to build the GPU interpreter");
+  }
+  Interpreter::TfLiteDelegatePtr delegate = delegate_factory();
+  if (delegate == nullptr ||
+      interpreter->ModifyGraphWithDelegate(std::move(delegate)) != kTfLiteOk) {
+    return absl::UnavailableError("Failed to apply the GPU delegate");
+  }
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    return absl::InternalError("Failed to allocate the GPU interpreter");
+  }
+  gpu_interpreter_ = std::move(interpreter);
+  gpu_ready_.store(true, std::memory_order_release);
+  return absl::OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace tflite
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_GPU_BACKGROUND_GPU_INTERPRETER_H_
+#define TENSORFLOW_LITE_DELEGATES_GPU_BACKGROUND_GPU_INTERPRETER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/delegates/gpu/delegate_options.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace gpu {
+
+// Hides the cold start of the GPU delegate, which compiles its OpenCL kernels
+// when it is applied to a graph. The model runs on a CPU interpreter while a
+// second interpreter is built with the delegate on a background thread, and
+// interpreter() switches over to the latter once its kernels are ready. If
+// the delegate fails to apply, the model keeps running on the CPU.
+//
+// The two interpreters have their own tensors, so callers should get the
+// interpreter, fill its inputs, invoke it and read its outputs through the
+// same pointer for each inference, e.g.
+//
+//   auto runner = BackgroundGpuInterpreter::Create(*model, resolver, options);
+//   Interpreter* interpreter = (*runner)->interpreter();
+//   std::memcpy(interpreter->typed_input_tensor<float>(0), frame, size);
+//   interpreter->Invoke();
+//
+// The compiled kernels are cached with the serialization of the delegate so
+// that later cold starts load them instead. When `options` do not enable it,
+// the cache is kept in `cache_dir` under a fingerprint of the model. No cache
+// is kept if `cache_dir` is empty, since the serialized kernels must be kept
+// in a directory private to the application.
+//
+// The delegate is forced onto the OpenCL backend, because an OpenGL one can
+// only be invoked on the thread it was applied on.
+class BackgroundGpuInterpreter {
+ public:
+  using DelegateFactory = std::function<Interpreter::TfLiteDelegatePtr()>;
+
+  // `model` and `op_resolver` must outlive the returned instance.
+  static absl::StatusOr<std::unique_ptr<BackgroundGpuInterpreter>> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const TfLiteGpuDelegateOptionsV2& options,
+      const std::string& cache_dir = "");
+
+  // Same as Create(), but applies the delegate returned by `delegate_factory`
+  // instead of a GPU delegate. `delegate_factory` is called on the background
+  // thread.
+  static absl::StatusOr<std::unique_ptr<BackgroundGpuInterpreter>>
+  CreateWithDelegateFactory(const FlatBufferModel& model,
+                            const OpResolver& op_resolver,
+                            DelegateFactory delegate_factory);
+
+  // Waits for the background build to finish.
+  ~BackgroundGpuInterpreter();
+
+  // Returns the interpreter to run the next inference on.
+  Interpreter* interpreter() {
+    return gpu_ready_.load(std::memory_order_acquire) ? gpu_interpreter_.get()
+                                                      : cpu_interpreter_.get();
+  }
+
+  // Returns whether interpreter() runs the model on the GPU.
+  bool gpu_ready() const { return gpu_ready_.load(std::memory_order_acquire); }
+
+  // Blocks until the GPU interpreter is built, and returns the reason it could
+  // not be if it failed.
+  absl::Status WaitForGpu();
+
+ private:
+  BackgroundGpuInterpreter(const FlatBufferModel& model,
+                           const OpResolver& op_resolver)
+      : model_(model), op_resolver_(op_resolver) {}
+
+  // Sets `options_` to the GPU delegate options to apply.
+  void SetGpuOptions(const TfLiteGpuDelegateOptionsV2& options,
+                     const std::string& cache_dir);
+  // Builds the CPU interpreter and starts building the GPU one.
+  absl::Status Start(DelegateFactory delegate_factory);
+  absl::Status BuildGpuInterpreter(const DelegateFactory& delegate_factory);
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  TfLiteGpuDelegateOptionsV2 options_ = TfLiteGpuDelegateOptionsV2Default();
+  // Owns the strings `options_` point to.
+  std::string serialization_dir_;
+  std::string model_token_;
+
+  std::unique_ptr<Interpreter> cpu_interpreter_;
+  std::unique_ptr<Interpreter> gpu_interpreter_;
+  std::atomic<bool> gpu_ready_ = false;
+  absl::Status gpu_status_;
+  std::thread gpu_thread_;
+};
+
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_GPU_BACKGROUND_GPU_INTERPRETER_H_
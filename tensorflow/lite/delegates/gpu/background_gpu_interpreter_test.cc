@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/background_gpu_interpreter.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+constexpr int kNumElements = 1 * 8 * 8 * 3;
+
+// A delegate that doesn't claim any node, so that the model still runs on the
+// builtin kernels once it is applied.
+TfLiteStatus PrepareNothing(TfLiteContext* context, TfLiteDelegate* delegate) {
+  return kTfLiteOk;
+}
+
+TfLiteStatus FailToPrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  return kTfLiteError;
+}
+
+Interpreter::TfLiteDelegatePtr MakeDelegate(
+    TfLiteStatus (*prepare)(TfLiteContext*, TfLiteDelegate*)) {
+  auto* delegate = new TfLiteDelegate(TfLiteDelegateCreate());
+  delegate->Prepare = prepare;
+  return Interpreter::TfLiteDelegatePtr(
+      delegate, [](TfLiteDelegate* to_delete) { delete to_delete; });
+}
+
+// The model computes output = (input + input) + input.
+void ExpectRunsModel(Interpreter* interpreter) {
+  float* input = interpreter->typed_input_tensor<float>(0);
+  std::fill(input, input + kNumElements, 1.0f);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(output[i], 3.0f);
+  }
+}
+
+class BackgroundGpuInterpreterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolver resolver_;
+};
+
+TEST_F(BackgroundGpuInterpreterTest, RunsOnCpuUntilDelegateIsApplied) {
+  absl::Notification apply_delegate;
+  auto runner = BackgroundGpuInterpreter::CreateWithDelegateFactory(
+      *model_, resolver_, [&apply_delegate] {
+        apply_delegate.WaitForNotification();
+        return MakeDelegate(PrepareNothing);
+      });
+  ASSERT_TRUE(runner.ok()) << runner.status();
+
+  EXPECT_FALSE((*runner)->gpu_ready());
+  Interpreter* interpreter = (*runner)->interpreter();
+  ASSERT_NE(interpreter, nullptr);
+  ExpectRunsModel(interpreter);
+  EXPECT_EQ((*runner)->interpreter(), interpreter);
+
+  apply_delegate.Notify();
+  EXPECT_TRUE((*runner)->WaitForGpu().ok());
+}
+
+TEST_F(BackgroundGpuInterpreterTest, SwitchesOverOnceDelegateIsApplied) {
+  auto runner = BackgroundGpuInterpreter::CreateWithDelegateFactory(
+      *model_, resolver_, [] { return MakeDelegate(PrepareNothing); });
+  ASSERT_TRUE(runner.ok()) << runner.status();
+  Interpreter* cpu_interpreter = (*runner)->interpreter();
+
+  EXPECT_TRUE((*runner)->WaitForGpu().ok());
+  EXPECT_TRUE((*runner)->gpu_ready());
+  Interpreter* gpu_interpreter = (*runner)->interpreter();
+  ASSERT_NE(gpu_interpreter, nullptr);
+  EXPECT_NE(gpu_interpreter, cpu_interpreter);
+  ExpectRunsModel(gpu_interpreter);
+}
+
+TEST_F(BackgroundGpuInterpreterTest, StaysOnCpuIfDelegateFails) {
+  auto runner = BackgroundGpuInterpreter::CreateWithDelegateFactory(
+      *model_, resolver_, [] { return MakeDelegate(FailToPrepare); });
+  ASSERT_TRUE(runner.ok()) << runner.status();
+  Interpreter* cpu_interpreter = (*runner)->interpreter();
+
+  EXPECT_EQ((*runner)->WaitForGpu().code(), absl::StatusCode::kUnavailable);
+  EXPECT_FALSE((*runner)->gpu_ready());
+  EXPECT_EQ((*runner)->interpreter(), cpu_interpreter);
+  ExpectRunsModel(cpu_interpreter);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
@@ -29,6 +29,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <future>  // NOLINT(build/c++11)
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -677,14 +678,26 @@ absl::Status DelegateKernelCore::SaveSerializedOpenCL(
 // Represent the execution of a subset of nodes on GPU.
 class DelegateKernel {
  public:
-  explicit DelegateKernel(Delegate* delegate) : core_(delegate) {}
+  explicit DelegateKernel(Delegate* delegate)
+      : core_(delegate),
+        pipeline_invocations_(
+            delegate->options().experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_PIPELINE_INVOCATIONS) {}
   ~DelegateKernel() = default;
 
   absl::Status Prepare(TfLiteContext* context,
                        const TfLiteDelegateParams* delegate_params) {
     thread_id_prepare_ = std::this_thread::get_id();
 
-    return core_.Setup(context, delegate_params);
+    RETURN_IF_ERROR(core_.Setup(context, delegate_params));
+    // The OpenGL runner can only be used on the thread it was created on.
+    if (pipeline_invocations_ && core_.enforce_same_thread()) {
+      TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_WARNING,
+                           "Pipelined invocations need the OpenCL backend, "
+                           "running them synchronously.");
+      pipeline_invocations_ = false;
+    }
+    return absl::OkStatus();
   }
 
   // This directs the runtime to allocate memory for input/output temporary
@@ -730,8 +743,12 @@ class DelegateKernel {
       RETURN_IF_ERROR(DequantizeInputs(context, core_.input_indices(),
                                        core_.quant_conversion_map()));
     }
-    RETURN_IF_ERROR(SetInputsAndOutputs(context));
-    RETURN_IF_ERROR(core_.runner()->Run());
+    if (pipeline_invocations_) {
+      RETURN_IF_ERROR(InvokePipelined(context));
+    } else {
+      RETURN_IF_ERROR(SetInputsAndOutputs(context));
+      RETURN_IF_ERROR(core_.runner()->Run());
+    }
     if (is_dequant_required) {
       RETURN_IF_ERROR(QuantizeOutputs(context, core_.output_indices(),
                                       core_.quant_conversion_map()));
@@ -757,9 +774,78 @@ class DelegateKernel {
     return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
   }
 
+  // Runs the partition on the GPU for the inputs of this invocation while the
+  // interpreter goes on with the nodes on the CPU, and sets the outputs of the
+  // previous invocation. The tensors and the staging buffers the runner reads
+  // and writes instead double buffer the boundary of the partition. The first
+  // invocation runs synchronously, so its outputs are set twice.
+  absl::Status InvokePipelined(TfLiteContext* context) {
+    if (!pipeline_started_) {
+      AllocateStagingBuffers(context);
+      CopyInputsToStagingBuffers(context);
+      RETURN_IF_ERROR(RunStaged());
+      CopyStagingBuffersToOutputs(context);
+      pipeline_started_ = true;
+      return absl::OkStatus();
+    }
+    if (pending_run_.valid()) {
+      RETURN_IF_ERROR(pending_run_.get());
+    }
+    CopyStagingBuffersToOutputs(context);
+    CopyInputsToStagingBuffers(context);
+    pending_run_ =
+        std::async(std::launch::async, [this] { return RunStaged(); });
+    return absl::OkStatus();
+  }
+
+  void AllocateStagingBuffers(TfLiteContext* context) {
+    staged_inputs_.clear();
+    for (int index : core_.input_indices()) {
+      staged_inputs_.emplace_back(context->tensors[index].bytes);
+    }
+    staged_outputs_.clear();
+    for (int index : core_.output_indices()) {
+      staged_outputs_.emplace_back(context->tensors[index].bytes);
+    }
+  }
+
+  void CopyInputsToStagingBuffers(TfLiteContext* context) {
+    for (int i = 0; i < core_.input_indices().size(); ++i) {
+      const auto& tensor = context->tensors[core_.input_indices()[i]];
+      std::memcpy(staged_inputs_[i].data(), tensor.data.raw, tensor.bytes);
+    }
+  }
+
+  void CopyStagingBuffersToOutputs(TfLiteContext* context) {
+    for (int i = 0; i < core_.output_indices().size(); ++i) {
+      auto& tensor = context->tensors[core_.output_indices()[i]];
+      std::memcpy(tensor.data.raw, staged_outputs_[i].data(), tensor.bytes);
+    }
+  }
+
+  absl::Status RunStaged() {
+    for (int i = 0; i < staged_inputs_.size(); ++i) {
+      RETURN_IF_ERROR(core_.runner()->SetInputObject(
+          i, MakeCpuMemory(absl::MakeSpan(staged_inputs_[i]))));
+    }
+    for (int i = 0; i < staged_outputs_.size(); ++i) {
+      RETURN_IF_ERROR(core_.runner()->SetOutputObject(
+          i, MakeCpuMemory(absl::MakeSpan(staged_outputs_[i]))));
+    }
+    return core_.runner()->Run();
+  }
+
  private:
   DelegateKernelCore core_;
   std::thread::id thread_id_prepare_;  // thread id used for Prepare()
+
+  bool pipeline_invocations_;
+  bool pipeline_started_ = false;
+  std::vector<std::vector<uint8_t>> staged_inputs_;
+  std::vector<std::vector<uint8_t>> staged_outputs_;
+  // The run of the previous invocation. Declared after `core_`, so that it is
+  // waited for before the runner is destroyed.
+  std::future<absl::Status> pending_run_;
 };
 
 #if defined(__ANDROID__)
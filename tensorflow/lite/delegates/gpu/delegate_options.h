@@ -71,6 +71,16 @@ enum TfLiteGpuExperimentalFlags {
   // TfLiteGpuDelegateOptionsV2.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Pipelines the delegated partitions across invocations: the GPU runs a
+  // partition on the inputs of invocation N while the interpreter runs the
+  // nodes on the CPU, which read the outputs of the partition for invocation
+  // N-1. This hides the synchronous readbacks of models whose unsupported ops
+  // fall back to the CPU, at the cost of one invocation of latency. It is
+  // only correct for streaming inputs such as video frames, on graphs where
+  // the CPU nodes after a partition do not also read its inputs.
+  //
+  // NOTE: Currently works only if CL backend is used.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_PIPELINE_INVOCATIONS = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
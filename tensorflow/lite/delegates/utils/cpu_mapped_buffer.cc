@@ -0,0 +1,239 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/utils/cpu_mapped_buffer.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <variant>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/gpu/android_hardware_buffer.h"
+#include "tensorflow/lite/delegates/utils/ret_macros.h"
+#include "tensorflow/lite/delegates/utils/sync_fence.h"
+
+#if defined(__linux__)
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#endif  // defined(__linux__)
+
+namespace tflite::delegates::utils {
+namespace {
+
+using ::tflite::gpu::OptionalAndroidHardwareBuffer;
+
+CpuMappedBuffer::DmaBufSyncFunction dma_buf_sync_for_testing = nullptr;
+
+// The values of AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN and
+// AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN, which are only declared on Android.
+constexpr uint64_t kUsageCpuReadOften = 3UL;
+constexpr uint64_t kUsageCpuWriteOften = 3UL << 4;
+
+uint64_t GetAHardwareBufferUsage(CpuMappedBuffer::Access access) {
+  switch (access) {
+    case CpuMappedBuffer::Access::kRead:
+      return kUsageCpuReadOften;
+    case CpuMappedBuffer::Access::kWrite:
+      return kUsageCpuWriteOften;
+    case CpuMappedBuffer::Access::kReadWrite:
+      return kUsageCpuReadOften | kUsageCpuWriteOften;
+  }
+  return 0;
+}
+
+#if defined(__linux__)
+int GetProtection(CpuMappedBuffer::Access access) {
+  switch (access) {
+    case CpuMappedBuffer::Access::kRead:
+      return PROT_READ;
+    case CpuMappedBuffer::Access::kWrite:
+      return PROT_WRITE;
+    case CpuMappedBuffer::Access::kReadWrite:
+      return PROT_READ | PROT_WRITE;
+  }
+  return PROT_NONE;
+}
+
+uint64_t GetDmaBufSyncFlags(CpuMappedBuffer::Access access) {
+  switch (access) {
+    case CpuMappedBuffer::Access::kRead:
+      return DMA_BUF_SYNC_READ;
+    case CpuMappedBuffer::Access::kWrite:
+      return DMA_BUF_SYNC_WRITE;
+    case CpuMappedBuffer::Access::kReadWrite:
+      return DMA_BUF_SYNC_RW;
+  }
+  return 0;
+}
+
+bool SyncDmaBuf(int fd, uint64_t flags) {
+  if (dma_buf_sync_for_testing != nullptr) {
+    return dma_buf_sync_for_testing(fd, flags);
+  }
+  struct dma_buf_sync sync = {flags};
+  while (true) {
+    const int ret = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+    if (ret == -1 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    return ret == 0;
+  }
+}
+#endif  // defined(__linux__)
+
+// Blocks until the producer of the buffer is done with it.
+std::optional<std::monostate> WaitForFence(int fence_fd) {
+  if (fence_fd < 0) {
+    return std::monostate{};
+  }
+  return WaitForAllFds({fence_fd});
+}
+
+}  // namespace
+
+std::optional<CpuMappedBuffer> CpuMappedBuffer::MapAHardwareBuffer(
+    AHardwareBuffer* buffer, size_t offset, size_t size, Access access,
+    int fence_fd) {
+  constexpr auto kError = std::nullopt;
+  auto& ahwb = OptionalAndroidHardwareBuffer::Instance();
+  TFLITE_RET_CHECK(ahwb.Supported(), "AHardwareBuffer is not supported",
+                   kError);
+  TFLITE_RET_CHECK(buffer != nullptr, "", kError);
+
+  AHardwareBuffer_Desc desc;
+  ahwb.Describe(buffer, &desc);
+  // A BLOB buffer is `width` bytes large.
+  TFLITE_RET_CHECK(desc.height == 1 && desc.layers == 1,
+                   "Only BLOB AHardwareBuffers can be mapped", kError);
+  TFLITE_RET_CHECK(offset <= desc.width && size <= desc.width - offset,
+                   "The mapped range exceeds the AHardwareBuffer", kError);
+
+  // The fence is waited on here rather than handed to AHardwareBuffer_lock,
+  // which would take the ownership of it.
+  TFLITE_RET_CHECK(WaitForFence(fence_fd).has_value(),
+                   "Failed to wait on the sync fence", kError);
+  void* mapping = nullptr;
+  TFLITE_RET_CHECK(
+      ahwb.Lock(buffer, GetAHardwareBufferUsage(access), /*fence=*/-1,
+                /*rect=*/nullptr, &mapping) == 0,
+      "Failed to lock the AHardwareBuffer", kError);
+  return CpuMappedBuffer(Kind::kAHardwareBuffer, buffer, /*dma_buf_fd=*/-1,
+                         mapping, desc.width,
+                         static_cast<uint8_t*>(mapping) + offset, size,
+                         access);
+}
+
+std::optional<CpuMappedBuffer> CpuMappedBuffer::MapDmaBuf(int fd, size_t offset,
+                                                          size_t size,
+                                                          Access access,
+                                                          int fence_fd) {
+  constexpr auto kError = std::nullopt;
+#if defined(__linux__)
+  TFLITE_RET_CHECK(fd >= 0, "", kError);
+  TFLITE_RET_CHECK(WaitForFence(fence_fd).has_value(),
+                   "Failed to wait on the sync fence", kError);
+
+  // mmap() needs a page aligned offset, so the mapping starts at the page of
+  // `offset`.
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t mapping_offset = offset - offset % page_size;
+  const size_t mapping_size = offset - mapping_offset + size;
+  void* mapping = mmap(nullptr, mapping_size, GetProtection(access),
+                       MAP_SHARED, fd, mapping_offset);
+  TFLITE_RET_CHECK(mapping != MAP_FAILED, "Failed to mmap the DMA-BUF",
+                   kError);
+  if (!SyncDmaBuf(fd, DMA_BUF_SYNC_START | GetDmaBufSyncFlags(access))) {
+    munmap(mapping, mapping_size);
+    TFLITE_RET_CHECK(false, "Failed to start the CPU access of the DMA-BUF",
+                     kError);
+  }
+  return CpuMappedBuffer(
+      Kind::kDmaBuf, /*ahwb=*/nullptr, fd, mapping, mapping_size,
+      static_cast<uint8_t*>(mapping) + (offset - mapping_offset), size,
+      access);
+#else
+  TFLITE_RET_CHECK(false, "DMA-BUF is only supported on Linux", kError);
+#endif  // defined(__linux__)
+}
+
+void CpuMappedBuffer::SetDmaBufSyncForTesting(DmaBufSyncFunction sync) {
+  dma_buf_sync_for_testing = sync;
+}
+
+CpuMappedBuffer::CpuMappedBuffer(Kind kind, AHardwareBuffer* ahwb,
+                                 int dma_buf_fd, void* mapping,
+                                 size_t mapping_size, void* data, size_t size,
+                                 Access access)
+    : kind_(kind),
+      ahwb_(ahwb),
+      dma_buf_fd_(dma_buf_fd),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      data_(data),
+      size_(size),
+      access_(access) {}
+
+CpuMappedBuffer::CpuMappedBuffer(CpuMappedBuffer&& other)
+    : kind_(std::exchange(other.kind_, Kind::kNone)),
+      ahwb_(other.ahwb_),
+      dma_buf_fd_(other.dma_buf_fd_),
+      mapping_(other.mapping_),
+      mapping_size_(other.mapping_size_),
+      data_(other.data_),
+      size_(other.size_),
+      access_(other.access_) {}
+
+CpuMappedBuffer::~CpuMappedBuffer() {
+  const std::optional<int> release_fence = Unmap();
+  if (release_fence.has_value() && *release_fence >= 0) {
+    // Nobody else can wait on the fence, so the CPU writes are flushed here.
+    WaitForFence(*release_fence);
+    close(*release_fence);
+  }
+}
+
+std::optional<int> CpuMappedBuffer::Unmap() {
+  constexpr auto kError = std::optional<int>();
+  switch (std::exchange(kind_, Kind::kNone)) {
+    case Kind::kNone:
+      return -1;
+    case Kind::kAHardwareBuffer: {
+      int32_t release_fence = -1;
+      TFLITE_RET_CHECK(OptionalAndroidHardwareBuffer::Instance().Unlock(
+                           ahwb_, &release_fence) == 0,
+                       "Failed to unlock the AHardwareBuffer", kError);
+      return release_fence;
+    }
+    case Kind::kDmaBuf: {
+#if defined(__linux__)
+      const bool synced = SyncDmaBuf(
+          dma_buf_fd_, DMA_BUF_SYNC_END | GetDmaBufSyncFlags(access_));
+      munmap(mapping_, mapping_size_);
+      TFLITE_RET_CHECK(synced, "Failed to end the CPU access of the DMA-BUF",
+                       kError);
+#endif  // defined(__linux__)
+      // The CPU writes are visible once the access has ended.
+      return -1;
+    }
+  }
+  return kError;
+}
+
+}  // namespace tflite::delegates::utils
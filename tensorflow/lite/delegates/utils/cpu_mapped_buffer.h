@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_UTILS_CPU_MAPPED_BUFFER_H_
+#define TENSORFLOW_LITE_DELEGATES_UTILS_CPU_MAPPED_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/gpu/android_hardware_buffer.h"
+
+namespace tflite::delegates::utils {
+
+// A CPU mapping of a hardware buffer registered with the async API, so that
+// the CPU kernels and XNNPACK can read and write the buffer in place instead
+// of through a copy into the tensor arena. While the buffer is mapped, its
+// address can be set as the custom allocation of the tensor it backs, e.g.
+//
+//   auto mapping = CpuMappedBuffer::MapAHardwareBuffer(
+//       buffer, offset, size, CpuMappedBuffer::Access::kRead, fence_fd);
+//   interpreter->SetCustomAllocationForTensor(
+//       tensor_index, mapping->AsCustomAllocation());
+//   interpreter->Invoke();
+//   std::optional<int> release_fence = mapping->Unmap();
+//
+// The address is aligned to kDefaultTensorAlignment whenever `offset` is.
+class CpuMappedBuffer {
+ public:
+  enum class Access { kRead, kWrite, kReadWrite };
+
+  // Maps `size` bytes at `offset` of the BLOB AHardwareBuffer. Blocks until
+  // `fence_fd`, if non-negative, has been signalled. Returns an error
+  // (signified by an instance with no value) if the buffer can not be mapped.
+  // The caller keeps the ownership of `buffer` and `fence_fd`.
+  static std::optional<CpuMappedBuffer> MapAHardwareBuffer(
+      AHardwareBuffer* buffer, size_t offset, size_t size, Access access,
+      int fence_fd);
+
+  // Maps `size` bytes at `offset` of the DMA-BUF `fd`, and starts the CPU
+  // access of the mapping so that the caches are coherent with the device.
+  // Blocks until `fence_fd`, if non-negative, has been signalled. The caller
+  // keeps the ownership of `fd` and `fence_fd`.
+  static std::optional<CpuMappedBuffer> MapDmaBuf(int fd, size_t offset,
+                                                  size_t size, Access access,
+                                                  int fence_fd);
+
+  CpuMappedBuffer(CpuMappedBuffer&& other);
+  CpuMappedBuffer& operator=(CpuMappedBuffer&& other) = delete;
+  CpuMappedBuffer(const CpuMappedBuffer&) = delete;
+  CpuMappedBuffer& operator=(const CpuMappedBuffer&) = delete;
+
+  // Unmaps the buffer if Unmap() has not been called.
+  ~CpuMappedBuffer();
+
+  void* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  TfLiteCustomAllocation AsCustomAllocation() const { return {data_, size_}; }
+
+  // Ends the CPU access of the buffer and unmaps it. Returns a sync fence fd
+  // owned by the caller that is signalled when the CPU writes are visible to
+  // the other users of the buffer, -1 if they already are, or an error.
+  std::optional<int> Unmap();
+
+  // Replaces the DMA_BUF_IOCTL_SYNC ioctl, so that tests can map regular files
+  // with MapDmaBuf(). `sync` returns whether the sync succeeded. Pass nullptr
+  // to restore the ioctl.
+  using DmaBufSyncFunction = bool (*)(int fd, uint64_t flags);
+  static void SetDmaBufSyncForTesting(DmaBufSyncFunction sync);
+
+ private:
+  enum class Kind { kNone, kAHardwareBuffer, kDmaBuf };
+
+  CpuMappedBuffer(Kind kind, AHardwareBuffer* ahwb, int dma_buf_fd,
+                  void* mapping, size_t mapping_size, void* data, size_t size,
+                  Access access);
+
+  Kind kind_;
+  AHardwareBuffer* ahwb_;
+  int dma_buf_fd_;
+  // The mapped pages, which start at or before `data_`.
+  void* mapping_;
+  size_t mapping_size_;
+  void* data_;
+  size_t size_;
+  Access access_;
+};
+
+}  // namespace tflite::delegates::utils
+
+#endif  // TENSORFLOW_LITE_DELEGATES_UTILS_CPU_MAPPED_BUFFER_H_
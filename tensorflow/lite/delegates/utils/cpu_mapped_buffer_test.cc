@@ -0,0 +1,190 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/utils/cpu_mapped_buffer.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#if defined(__linux__)
+#include <linux/dma-buf.h>
+#endif  // defined(__linux__)
+
+namespace tflite::delegates::utils {
+namespace {
+
+#if defined(__linux__)
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// The flags of the DMA-BUF syncs, in order.
+std::vector<uint64_t>* syncs = nullptr;
+// The sync with these flags fails.
+uint64_t failing_sync = 0;
+
+bool RecordSync(int fd, uint64_t flags) {
+  syncs->push_back(flags);
+  return flags != failing_sync;
+}
+
+// Maps a regular file in place of a DMA-BUF, which mmap() handles the same
+// way, with the syncs recorded instead of sent to the driver.
+class CpuMappedBufferDmaBufTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kFileSize = 3 * 4096;
+
+  void SetUp() override {
+    syncs = &syncs_;
+    failing_sync = 0;
+    CpuMappedBuffer::SetDmaBufSyncForTesting(RecordSync);
+
+    file_ = std::tmpfile();
+    ASSERT_NE(file_, nullptr);
+    fd_ = fileno(file_);
+    std::vector<uint8_t> contents(kFileSize);
+    for (size_t i = 0; i < kFileSize; ++i) contents[i] = i % 251;
+    ASSERT_EQ(pwrite(fd_, contents.data(), kFileSize, 0), kFileSize);
+  }
+
+  void TearDown() override {
+    CpuMappedBuffer::SetDmaBufSyncForTesting(nullptr);
+    syncs = nullptr;
+    std::fclose(file_);
+  }
+
+  uint8_t ReadByte(size_t offset) {
+    uint8_t byte = 0;
+    EXPECT_EQ(pread(fd_, &byte, 1, offset), 1);
+    return byte;
+  }
+
+  std::vector<uint64_t> syncs_;
+  FILE* file_ = nullptr;
+  int fd_ = -1;
+};
+
+TEST_F(CpuMappedBufferDmaBufTest, ReadAccessIsStartedAndEnded) {
+  // Not page aligned, and spanning two pages.
+  constexpr size_t kOffset = 4000;
+  constexpr size_t kSize = 200;
+  std::optional<CpuMappedBuffer> mapping = CpuMappedBuffer::MapDmaBuf(
+      fd_, kOffset, kSize, CpuMappedBuffer::Access::kRead, /*fence_fd=*/-1);
+  ASSERT_TRUE(mapping.has_value());
+  EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ));
+
+  ASSERT_EQ(mapping->size(), kSize);
+  const uint8_t* data = static_cast<const uint8_t*>(mapping->data());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(data[i], (kOffset + i) % 251);
+  }
+
+  EXPECT_EQ(mapping->Unmap(), -1);
+  EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ,
+                                  DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ));
+
+  // Neither a second Unmap() nor the destructor end the access again.
+  EXPECT_EQ(mapping->Unmap(), -1);
+  mapping.reset();
+  EXPECT_EQ(syncs_.size(), 2);
+}
+
+TEST_F(CpuMappedBufferDmaBufTest, WritesAreVisibleAfterUnmap) {
+  constexpr size_t kOffset = 8192;
+  constexpr size_t kSize = 16;
+  std::optional<CpuMappedBuffer> mapping = CpuMappedBuffer::MapDmaBuf(
+      fd_, kOffset, kSize, CpuMappedBuffer::Access::kReadWrite,
+      /*fence_fd=*/-1);
+  ASSERT_TRUE(mapping.has_value());
+  std::memset(mapping->data(), 0xAB, kSize);
+
+  EXPECT_EQ(mapping->Unmap(), -1);
+  EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW,
+                                  DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW));
+  EXPECT_EQ(ReadByte(kOffset - 1), (kOffset - 1) % 251);
+  EXPECT_EQ(ReadByte(kOffset), 0xAB);
+  EXPECT_EQ(ReadByte(kOffset + kSize - 1), 0xAB);
+  EXPECT_EQ(ReadByte(kOffset + kSize), (kOffset + kSize) % 251);
+}
+
+TEST_F(CpuMappedBufferDmaBufTest, DestructorEndsAccessOnce) {
+  {
+    std::optional<CpuMappedBuffer> mapping = CpuMappedBuffer::MapDmaBuf(
+        fd_, /*offset=*/0, /*size=*/64, CpuMappedBuffer::Access::kWrite,
+        /*fence_fd=*/-1);
+    ASSERT_TRUE(mapping.has_value());
+    // The moved-from mapping doesn't end the access.
+    CpuMappedBuffer moved = *std::move(mapping);
+    mapping.reset();
+    EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE));
+  }
+  EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_WRITE,
+                                  DMA_BUF_SYNC_END | DMA_BUF_SYNC_WRITE));
+}
+
+TEST_F(CpuMappedBufferDmaBufTest, FailedStartIsNotEnded) {
+  failing_sync = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ;
+  EXPECT_FALSE(CpuMappedBuffer::MapDmaBuf(fd_, /*offset=*/0, /*size=*/64,
+                                          CpuMappedBuffer::Access::kRead,
+                                          /*fence_fd=*/-1)
+                   .has_value());
+  EXPECT_THAT(syncs_, ElementsAre(DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ));
+
+  // The buffer can be mapped again once the sync succeeds.
+  failing_sync = 0;
+  std::optional<CpuMappedBuffer> mapping =
+      CpuMappedBuffer::MapDmaBuf(fd_, /*offset=*/0, /*size=*/64,
+                                 CpuMappedBuffer::Access::kRead,
+                                 /*fence_fd=*/-1);
+  ASSERT_TRUE(mapping.has_value());
+  EXPECT_EQ(mapping->Unmap(), -1);
+}
+
+TEST_F(CpuMappedBufferDmaBufTest, UnmapAfterFailedEnd) {
+  failing_sync = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+  std::optional<CpuMappedBuffer> mapping =
+      CpuMappedBuffer::MapDmaBuf(fd_, /*offset=*/0, /*size=*/64,
+                                 CpuMappedBuffer::Access::kRead,
+                                 /*fence_fd=*/-1);
+  ASSERT_TRUE(mapping.has_value());
+  EXPECT_FALSE(mapping->Unmap().has_value());
+
+  // The mapping is released even though the sync failed.
+  EXPECT_EQ(mapping->Unmap(), -1);
+  mapping.reset();
+  EXPECT_EQ(syncs_.size(), 2);
+}
+
+TEST_F(CpuMappedBufferDmaBufTest, InvalidFdIsNotMapped) {
+  EXPECT_FALSE(CpuMappedBuffer::MapDmaBuf(/*fd=*/-1, /*offset=*/0,
+                                          /*size=*/64,
+                                          CpuMappedBuffer::Access::kRead,
+                                          /*fence_fd=*/-1)
+                   .has_value());
+  EXPECT_THAT(syncs_, IsEmpty());
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace tflite::delegates::utils
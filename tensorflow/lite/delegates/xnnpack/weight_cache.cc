@@ -0,0 +1,392 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/logger.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// Alignment of the packed buffers, in memory and in the data section of the
+// cache file. The file is mapped at a page boundary.
+constexpr size_t kMinAlignment = 128;
+
+size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// 64-bit FNV-1a.
+class Fingerprint {
+ public:
+  void Add(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      value_ = (value_ ^ bytes[i]) * 0x100000001b3ull;
+    }
+  }
+  // Same as Add(), but mixes in 8 bytes at a time, which is much faster on
+  // large buffers.
+  void AddWords(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (; size >= sizeof(uint64_t);
+         bytes += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, bytes, sizeof(word));
+      value_ = (value_ ^ word) * 0x100000001b3ull;
+    }
+    Add(bytes, size);
+  }
+  template <typename T>
+  void Add(const T& value) {
+    Add(&value, sizeof(value));
+  }
+  uint64_t value() const { return value_; }
+
+ private:
+  uint64_t value_ = 0xcbf29ce484222325ull;
+};
+
+#if !defined(_WIN32)
+bool WriteFully(int fd, const void* data, size_t size) {
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t written = write(fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += written;
+    size -= written;
+  }
+  return true;
+}
+
+bool WritePadding(int fd, size_t size) {
+  static const char kZeros[kMinAlignment] = {};
+  while (size > 0) {
+    const size_t chunk = std::min(size, sizeof(kZeros));
+    if (!WriteFully(fd, kZeros, chunk)) return false;
+    size -= chunk;
+  }
+  return true;
+}
+#endif
+
+// Identifies buffers packed from weights without an identifier by address.
+PackIdentifier TransientIdentifier(
+    const xnn_weights_cache_look_up_key* cache_key) {
+  return {cache_key->seed, reinterpret_cast<uintptr_t>(cache_key->kernel),
+          reinterpret_cast<uintptr_t>(cache_key->bias)};
+}
+
+}  // namespace
+
+uint64_t FingerprintStaticTensors(const TfLiteContext* context) {
+  Fingerprint fingerprint;
+  fingerprint.Add(kXNNPackCommit, sizeof(kXNNPackCommit));
+  fingerprint.Add(static_cast<uint64_t>(XNNPackCacheHeader::kVersion));
+  fingerprint.Add(context->tensors_size);
+  for (size_t t = 0; t < context->tensors_size; ++t) {
+    const TfLiteTensor& tensor = context->tensors[t];
+    if (tensor.allocation_type != kTfLiteMmapRo) continue;
+    fingerprint.Add(t);
+    fingerprint.Add(tensor.type);
+    fingerprint.Add(tensor.bytes);
+    if (tensor.dims != nullptr) {
+      fingerprint.Add(tensor.dims->data, sizeof(int) * tensor.dims->size);
+    }
+    // Models that only differ in their weights must not share packed
+    // buffers, so the whole contents of every static tensor are hashed.
+    if (tensor.data.raw_const != nullptr) {
+      fingerprint.AddWords(tensor.data.raw_const, tensor.bytes);
+    }
+  }
+  return fingerprint.value();
+}
+
+MMapWeightCacheProvider::MMapWeightCacheProvider() {
+  cache_provider_.context = this;
+  cache_provider_.look_up = look_up;
+  cache_provider_.reserve_space = reserve_space;
+  cache_provider_.look_up_or_insert = look_up_or_insert;
+  cache_provider_.is_finalized = is_finalized;
+  cache_provider_.offset_to_addr = offset_to_addr;
+  cache_provider_.delete_cache = delete_cache;
+}
+
+MMapWeightCacheProvider::~MMapWeightCacheProvider() {
+#if !defined(_WIN32)
+  if (mmap_base_ != nullptr) munmap(mmap_base_, mmap_size_);
+#endif
+}
+
+bool MMapWeightCacheProvider::LoadOrStartBuild(uint64_t fingerprint) {
+  if (is_active_ || file_path_.empty()) return is_active_;
+  fingerprint_ = fingerprint;
+  if (Load(fingerprint)) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                    "XNNPack weight cache loaded from '%s'.",
+                    file_path_.c_str());
+  } else {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                    "XNNPack weight cache not found or outdated, building "
+                    "'%s'.",
+                    file_path_.c_str());
+  }
+  is_active_ = true;
+  return true;
+}
+
+bool MMapWeightCacheProvider::Load(uint64_t fingerprint) {
+#if defined(_WIN32)
+  return false;
+#else
+  const int fd = open(file_path_.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      file_stat.st_size < static_cast<off_t>(sizeof(XNNPackCacheHeader))) {
+    close(fd);
+    return false;
+  }
+  const size_t size = file_stat.st_size;
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return false;
+
+  XNNPackCacheHeader header;
+  memcpy(&header, base, sizeof(header));
+  const bool valid =
+      header.version == XNNPackCacheHeader::kVersion &&
+      header.fingerprint == fingerprint &&
+      header.data_offset % kMinAlignment == 0 &&
+      header.data_size % kMinAlignment == 0 &&
+      // Written so that corrupted offsets and sizes can't overflow.
+      header.data_offset <= size &&
+      header.data_size <= size - header.data_offset &&
+      header.entries_offset <= size &&
+      header.num_entries <=
+          (size - header.entries_offset) / sizeof(PackedBufferEntry);
+  if (!valid) {
+    munmap(base, size);
+    return false;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(base);
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    PackedBufferEntry entry;
+    memcpy(&entry, bytes + header.entries_offset + i * sizeof(entry),
+           sizeof(entry));
+    if (entry.location.offset > header.data_size ||
+        entry.location.size > header.data_size - entry.location.offset) {
+      entries_.clear();
+      munmap(base, size);
+      return false;
+    }
+    entries_[entry.identifier] = entry.location;
+  }
+  mmap_base_ = base;
+  mmap_size_ = size;
+  mmap_data_ = bytes + header.data_offset;
+  mmap_data_size_ = header.data_size;
+  return true;
+#endif
+}
+
+void MMapWeightCacheProvider::MapTensorIdentifier(const void* data,
+                                                  uint64_t id) {
+  data_to_id_[data] = id;
+}
+
+bool MMapWeightCacheProvider::GetPackIdentifier(
+    const xnn_weights_cache_look_up_key* cache_key,
+    PackIdentifier* identifier) const {
+  identifier->seed = cache_key->seed;
+  const auto kernel_it = data_to_id_.find(cache_key->kernel);
+  if (kernel_it == data_to_id_.end()) return false;
+  identifier->kernel_id = kernel_it->second;
+  identifier->bias_id = PackIdentifier::kNoId;
+  if (cache_key->bias != nullptr) {
+    const auto bias_it = data_to_id_.find(cache_key->bias);
+    if (bias_it == data_to_id_.end()) return false;
+    identifier->bias_id = bias_it->second;
+  }
+  return true;
+}
+
+size_t MMapWeightCacheProvider::LookUp(
+    const xnn_weights_cache_look_up_key* cache_key) {
+  PackIdentifier identifier;
+  if (GetPackIdentifier(cache_key, &identifier)) {
+    const auto it = entries_.find(identifier);
+    return it == entries_.end() ? SIZE_MAX : it->second.offset;
+  }
+  const auto it = transient_entries_.find(TransientIdentifier(cache_key));
+  return it == transient_entries_.end() ? SIZE_MAX : it->second.offset;
+}
+
+size_t MMapWeightCacheProvider::GrowBuffer(size_t size) {
+  const size_t offset = RoundUp(buffer_size_, kMinAlignment);
+  if (offset + size > buffer_capacity_) {
+    const size_t capacity = std::max(2 * buffer_capacity_, offset + size);
+    std::unique_ptr<uint8_t[]> storage(new uint8_t[capacity + kMinAlignment]);
+    uint8_t* buffer = reinterpret_cast<uint8_t*>(RoundUp(
+        reinterpret_cast<uintptr_t>(storage.get()), kMinAlignment));
+    if (buffer_size_ > 0) memcpy(buffer, buffer_, buffer_size_);
+    buffer_storage_ = std::move(storage);
+    buffer_ = buffer;
+    buffer_capacity_ = capacity;
+  }
+  return offset;
+}
+
+void* MMapWeightCacheProvider::ReserveSpace(size_t size) {
+  const size_t offset = GrowBuffer(size);
+  return buffer_ + offset;
+}
+
+size_t MMapWeightCacheProvider::LookUpOrInsert(
+    const xnn_weights_cache_look_up_key* cache_key, void* ptr, size_t size) {
+  const size_t existing = LookUp(cache_key);
+  if (existing != SIZE_MAX) return existing;
+
+  // XNNPACK packs into the space returned by ReserveSpace, copy the buffer if
+  // it comes from elsewhere.
+  size_t offset = RoundUp(buffer_size_, kMinAlignment);
+  if (buffer_ == nullptr || ptr != buffer_ + offset) {
+    offset = GrowBuffer(size);
+    memcpy(buffer_ + offset, ptr, size);
+  }
+  buffer_size_ = offset + size;
+  const BufferLocation location{mmap_data_size_ + offset, size};
+
+  PackIdentifier identifier;
+  if (GetPackIdentifier(cache_key, &identifier)) {
+    entries_[identifier] = location;
+    has_new_entries_ = true;
+  } else {
+    transient_entries_[TransientIdentifier(cache_key)] = location;
+  }
+  return location.offset;
+}
+
+void* MMapWeightCacheProvider::OffsetToAddr(size_t offset) {
+  if (offset < mmap_data_size_) {
+    return const_cast<uint8_t*>(mmap_data_) + offset;
+  }
+  return buffer_ + (offset - mmap_data_size_);
+}
+
+bool MMapWeightCacheProvider::Finalize() {
+  is_finalized_ = true;
+  if (!has_new_entries_) return true;
+  if (!WriteFile()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "Could not write XNNPack weight cache '%s'.",
+                    file_path_.c_str());
+    return false;
+  }
+  has_new_entries_ = false;
+  return true;
+}
+
+bool MMapWeightCacheProvider::WriteFile() const {
+#if defined(_WIN32)
+  return false;
+#else
+  // Write to a temporary file and rename it, so that concurrent processes
+  // only ever map complete cache files.
+  const std::string temp_path =
+      file_path_ + ".tmp." + std::to_string(getpid());
+  const int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+
+  XNNPackCacheHeader header;
+  header.version = XNNPackCacheHeader::kVersion;
+  header.fingerprint = fingerprint_;
+  header.data_offset = RoundUp(sizeof(header), kMinAlignment);
+  header.data_size = mmap_data_size_ + RoundUp(buffer_size_, kMinAlignment);
+  header.entries_offset = header.data_offset + header.data_size;
+  header.num_entries = entries_.size();
+
+  bool ok = WriteFully(fd, &header, sizeof(header)) &&
+            WritePadding(fd, header.data_offset - sizeof(header)) &&
+            WriteFully(fd, mmap_data_, mmap_data_size_) &&
+            (buffer_size_ == 0 || WriteFully(fd, buffer_, buffer_size_)) &&
+            WritePadding(fd, RoundUp(buffer_size_, kMinAlignment) -
+                                 buffer_size_);
+  for (auto it = entries_.begin(); ok && it != entries_.end(); ++it) {
+    const PackedBufferEntry entry{it->first, it->second};
+    ok = WriteFully(fd, &entry, sizeof(entry));
+  }
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(temp_path.c_str(), file_path_.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+#endif
+}
+
+size_t MMapWeightCacheProvider::look_up(
+    void* context, const xnn_weights_cache_look_up_key* cache_key) {
+  return static_cast<MMapWeightCacheProvider*>(context)->LookUp(cache_key);
+}
+
+void* MMapWeightCacheProvider::reserve_space(void* context, size_t n) {
+  return static_cast<MMapWeightCacheProvider*>(context)->ReserveSpace(n);
+}
+
+size_t MMapWeightCacheProvider::look_up_or_insert(
+    void* context, const xnn_weights_cache_look_up_key* cache_key, void* ptr,
+    size_t size) {
+  return static_cast<MMapWeightCacheProvider*>(context)->LookUpOrInsert(
+      cache_key, ptr, size);
+}
+
+bool MMapWeightCacheProvider::is_finalized(void* context) {
+  return static_cast<MMapWeightCacheProvider*>(context)->is_finalized_;
+}
+
+void* MMapWeightCacheProvider::offset_to_addr(void* context, size_t offset) {
+  return static_cast<MMapWeightCacheProvider*>(context)->OffsetToAddr(offset);
+}
+
+enum xnn_status MMapWeightCacheProvider::delete_cache(void* context) {
+  // The provider is owned by the delegate.
+  return xnn_status_success;
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
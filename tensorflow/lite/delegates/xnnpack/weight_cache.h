@@ -0,0 +1,197 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/core/c/common.h"
+
+// WARNING: the interface in this file is still under experimentation and
+// subject to change.
+
+namespace tflite {
+namespace xnnpack {
+
+// Identifies the XNNPACK sources whose packing layouts a cache file holds.
+// Keep in sync with the XNNPACK commit in tensorflow/workspace2.bzl.
+inline constexpr char kXNNPackCommit[] =
+    "50037f8072731a2cc30a961b96e199ad691887e4";
+
+// Identifies a packed buffer independently of the addresses of the weights it
+// was packed from, so that other processes can find it.
+struct PackIdentifier {
+  enum : uint64_t { kNoId = UINT64_MAX };
+  uint64_t seed;
+  uint64_t kernel_id;
+  uint64_t bias_id;
+
+  friend bool operator==(const PackIdentifier& a, const PackIdentifier& b) {
+    return a.seed == b.seed && a.kernel_id == b.kernel_id &&
+           a.bias_id == b.bias_id;
+  }
+
+  struct Hash {
+    size_t operator()(const PackIdentifier& p) const {
+      std::hash<uint64_t> hasher;
+      return hasher(p.seed) ^ (hasher(p.kernel_id) << 1) ^
+             (hasher(p.bias_id) << 2);
+    }
+  };
+};
+
+// Position of a packed buffer in the data section of the cache file.
+struct BufferLocation {
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Layout of a cache file: the header, then the packed buffers starting at
+// `data_offset`, then `num_entries` PackedBufferEntry records starting at
+// `entries_offset`.
+struct XNNPackCacheHeader {
+  enum : uint64_t { kVersion = 1 };
+  uint64_t version;
+  // See FingerprintStaticTensors.
+  uint64_t fingerprint;
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint64_t entries_offset;
+  uint64_t num_entries;
+};
+
+struct PackedBufferEntry {
+  PackIdentifier identifier;
+  BufferLocation location;
+};
+
+// Returns a fingerprint of the static tensors of `context`, metadata and
+// contents, and of the XNNPACK sources.
+uint64_t FingerprintStaticTensors(const TfLiteContext* context);
+
+// An XNNPACK weights cache provider backed by a file.
+//
+// The first process to use a given file packs the weights in memory and
+// writes them to the file. Later processes, and later delegates in the same
+// process, mmap the file and skip the packing, sharing the mapped pages.
+//
+// XNNPACK looks packed buffers up by the addresses of the original weights,
+// which differ from one process to the next. Delegates therefore declare a
+// stable identifier for every static tensor with MapTensorIdentifier before
+// creating their runtimes. Buffers packed from weights without an identifier
+// are only cached in memory.
+class MMapWeightCacheProvider {
+ public:
+  MMapWeightCacheProvider();
+  ~MMapWeightCacheProvider();
+  MMapWeightCacheProvider(const MMapWeightCacheProvider&) = delete;
+  MMapWeightCacheProvider& operator=(const MMapWeightCacheProvider&) = delete;
+
+  void SetFilePath(const char* path) { file_path_ = path; }
+  const std::string& file_path() const { return file_path_; }
+
+  // Maps the cache file if it was written for the same `fingerprint`,
+  // otherwise starts building a new cache in memory. Subsequent calls do
+  // nothing. Returns false if the provider can't be used.
+  bool LoadOrStartBuild(uint64_t fingerprint);
+  // True once the packed buffers come from the cache file.
+  bool IsLoaded() const { return mmap_data_ != nullptr; }
+  bool IsActive() const { return is_active_; }
+
+  // Declares that the static tensor data at `data` is identified by `id`.
+  void MapTensorIdentifier(const void* data, uint64_t id);
+  // Forgets all the identifiers, and the buffers packed from weights without
+  // an identifier, since the tensor data they refer to may move.
+  void ClearTensorIdentifiers() {
+    data_to_id_.clear();
+    transient_entries_.clear();
+  }
+
+  // Runtimes can't be set up while the cache is being extended.
+  void StartInserting() { is_finalized_ = false; }
+  // Writes the cache file if new buffers were packed since the cache was
+  // built, and marks the cache as finalized. Returns false if writing fails,
+  // in which case the in-memory cache stays usable.
+  bool Finalize();
+
+  xnn_weights_cache_t GetCacheProvider() { return &cache_provider_; }
+
+  // XNNPACK weights cache provider interface.
+  size_t LookUp(const xnn_weights_cache_look_up_key* cache_key);
+  void* ReserveSpace(size_t size);
+  size_t LookUpOrInsert(const xnn_weights_cache_look_up_key* cache_key,
+                        void* ptr, size_t size);
+  void* OffsetToAddr(size_t offset);
+
+ private:
+  // Returns the identifier of `cache_key`, or false if one of its buffers has
+  // no identifier.
+  bool GetPackIdentifier(const xnn_weights_cache_look_up_key* cache_key,
+                         PackIdentifier* identifier) const;
+  bool Load(uint64_t fingerprint);
+  // Grows the in-memory storage to hold `size` more bytes past the end of the
+  // last buffer and returns the aligned position of the new buffer.
+  size_t GrowBuffer(size_t size);
+  bool WriteFile() const;
+
+  static size_t look_up(void* context,
+                        const xnn_weights_cache_look_up_key* cache_key);
+  static void* reserve_space(void* context, size_t n);
+  static size_t look_up_or_insert(
+      void* context, const xnn_weights_cache_look_up_key* cache_key,
+      void* ptr, size_t size);
+  static bool is_finalized(void* context);
+  static void* offset_to_addr(void* context, size_t offset);
+  static enum xnn_status delete_cache(void* context);
+
+  xnn_weights_cache_provider cache_provider_;
+  std::string file_path_;
+  uint64_t fingerprint_ = 0;
+  bool is_active_ = false;
+  bool is_finalized_ = true;
+
+  // Mapped cache file. Offsets below mmap_data_size_ refer to its data
+  // section, larger offsets to the in-memory buffers.
+  void* mmap_base_ = nullptr;
+  size_t mmap_size_ = 0;
+  const uint8_t* mmap_data_ = nullptr;
+  size_t mmap_data_size_ = 0;
+
+  // Buffers packed by this process.
+  std::unique_ptr<uint8_t[]> buffer_storage_;
+  uint8_t* buffer_ = nullptr;
+  size_t buffer_capacity_ = 0;
+  size_t buffer_size_ = 0;
+  // Buffers packed since the file was last written.
+  bool has_new_entries_ = false;
+
+  std::unordered_map<const void*, uint64_t> data_to_id_;
+  std::unordered_map<PackIdentifier, BufferLocation, PackIdentifier::Hash>
+      entries_;
+  // Buffers packed from weights without an identifier, keyed by address.
+  std::unordered_map<PackIdentifier, BufferLocation, PackIdentifier::Hash>
+      transient_entries_;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
@@ -0,0 +1,257 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+std::string CachePath(const char* name) {
+  std::string path = ::testing::TempDir() + "/" + name;
+  std::remove(path.c_str());
+  return path;
+}
+
+// Packs `kernel` into `provider` the way XNNPACK does, and returns the offset
+// of the packed buffer.
+size_t Pack(MMapWeightCacheProvider& provider, uint32_t seed,
+            const std::vector<float>& kernel) {
+  xnn_weights_cache_look_up_key key{seed, kernel.data(), nullptr};
+  const size_t offset = provider.LookUp(&key);
+  if (offset != SIZE_MAX) return offset;
+  const size_t size = kernel.size() * sizeof(float);
+  void* space = provider.ReserveSpace(size);
+  memcpy(space, kernel.data(), size);
+  return provider.LookUpOrInsert(&key, space, size);
+}
+
+std::vector<float> Read(MMapWeightCacheProvider& provider, size_t offset,
+                        size_t count) {
+  const float* data = static_cast<const float*>(provider.OffsetToAddr(offset));
+  return std::vector<float>(data, data + count);
+}
+
+TEST(MMapWeightCacheProviderTest, PersistsPackedBuffers) {
+  const std::string path = CachePath("persists.xnn_cache");
+  const std::vector<float> kernel1 = {1, 2, 3};
+  const std::vector<float> kernel2 = {4, 5, 6, 7, 8};
+  size_t offset1, offset2;
+  {
+    MMapWeightCacheProvider provider;
+    provider.SetFilePath(path.c_str());
+    ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/42));
+    EXPECT_FALSE(provider.IsLoaded());
+    provider.StartInserting();
+    provider.MapTensorIdentifier(kernel1.data(), 1);
+    provider.MapTensorIdentifier(kernel2.data(), 2);
+    offset1 = Pack(provider, 7, kernel1);
+    offset2 = Pack(provider, 7, kernel2);
+    EXPECT_NE(offset1, offset2);
+    EXPECT_EQ(Pack(provider, 7, kernel1), offset1);
+    ASSERT_TRUE(provider.Finalize());
+  }
+
+  // Another process maps the file: the weights live at other addresses, but
+  // have the same identifiers.
+  const std::vector<float> kernel1_copy = kernel1;
+  const std::vector<float> kernel2_copy = kernel2;
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/42));
+  EXPECT_TRUE(provider.IsLoaded());
+  provider.StartInserting();
+  provider.MapTensorIdentifier(kernel1_copy.data(), 1);
+  provider.MapTensorIdentifier(kernel2_copy.data(), 2);
+  xnn_weights_cache_look_up_key key{7, kernel2_copy.data(), nullptr};
+  ASSERT_EQ(provider.LookUp(&key), offset2);
+  EXPECT_EQ(Read(provider, offset2, kernel2.size()), kernel2);
+  EXPECT_EQ(Read(provider, Pack(provider, 7, kernel1_copy), kernel1.size()),
+            kernel1);
+  // A different seed, e.g. another operator, misses.
+  key.seed = 8;
+  EXPECT_EQ(provider.LookUp(&key), SIZE_MAX);
+}
+
+TEST(MMapWeightCacheProviderTest, ExtendsLoadedCache) {
+  const std::string path = CachePath("extends.xnn_cache");
+  const std::vector<float> kernel1 = {1, 2, 3};
+  const std::vector<float> kernel2 = {4, 5};
+  {
+    MMapWeightCacheProvider provider;
+    provider.SetFilePath(path.c_str());
+    ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+    provider.StartInserting();
+    provider.MapTensorIdentifier(kernel1.data(), 1);
+    Pack(provider, 0, kernel1);
+    ASSERT_TRUE(provider.Finalize());
+  }
+  size_t offset2;
+  {
+    MMapWeightCacheProvider provider;
+    provider.SetFilePath(path.c_str());
+    ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+    ASSERT_TRUE(provider.IsLoaded());
+    provider.StartInserting();
+    provider.MapTensorIdentifier(kernel2.data(), 2);
+    offset2 = Pack(provider, 0, kernel2);
+    EXPECT_EQ(Read(provider, offset2, kernel2.size()), kernel2);
+    ASSERT_TRUE(provider.Finalize());
+  }
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+  provider.MapTensorIdentifier(kernel1.data(), 1);
+  provider.MapTensorIdentifier(kernel2.data(), 2);
+  xnn_weights_cache_look_up_key key1{0, kernel1.data(), nullptr};
+  xnn_weights_cache_look_up_key key2{0, kernel2.data(), nullptr};
+  EXPECT_EQ(Read(provider, provider.LookUp(&key1), kernel1.size()), kernel1);
+  EXPECT_EQ(provider.LookUp(&key2), offset2);
+  EXPECT_EQ(Read(provider, offset2, kernel2.size()), kernel2);
+}
+
+TEST(MMapWeightCacheProviderTest, RebuildsForOtherModel) {
+  const std::string path = CachePath("rebuilds.xnn_cache");
+  const std::vector<float> kernel = {1, 2, 3};
+  {
+    MMapWeightCacheProvider provider;
+    provider.SetFilePath(path.c_str());
+    ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+    provider.StartInserting();
+    provider.MapTensorIdentifier(kernel.data(), 1);
+    Pack(provider, 0, kernel);
+    ASSERT_TRUE(provider.Finalize());
+  }
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/2));
+  EXPECT_FALSE(provider.IsLoaded());
+  provider.MapTensorIdentifier(kernel.data(), 1);
+  xnn_weights_cache_look_up_key key{0, kernel.data(), nullptr};
+  EXPECT_EQ(provider.LookUp(&key), SIZE_MAX);
+}
+
+TEST(MMapWeightCacheProviderTest, KeepsUnidentifiedBuffersInMemory) {
+  const std::string path = CachePath("unidentified.xnn_cache");
+  const std::vector<float> kernel = {1, 2, 3};
+  const std::vector<float> bias = {4};
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+  provider.StartInserting();
+  provider.MapTensorIdentifier(kernel.data(), 1);
+  // The bias has no identifier.
+  xnn_weights_cache_look_up_key key{0, kernel.data(), bias.data()};
+  void* space = provider.ReserveSpace(sizeof(float) * 3);
+  memcpy(space, kernel.data(), sizeof(float) * 3);
+  const size_t offset =
+      provider.LookUpOrInsert(&key, space, sizeof(float) * kernel.size());
+  EXPECT_EQ(provider.LookUp(&key), offset);
+  EXPECT_EQ(Read(provider, offset, kernel.size()), kernel);
+  EXPECT_TRUE(provider.Finalize());
+
+  provider.ClearTensorIdentifiers();
+  EXPECT_EQ(provider.LookUp(&key), SIZE_MAX);
+}
+
+// Offset of the entries in the files written by WriteCacheFile.
+constexpr uint64_t kEntriesOffset = 256;
+
+// Writes a cache file made of `header`, zeros up to kEntriesOffset, and
+// `entries`.
+void WriteCacheFile(const std::string& path, XNNPackCacheHeader header,
+                    const std::vector<PackedBufferEntry>& entries) {
+  std::vector<uint8_t> data(kEntriesOffset - sizeof(header), 0);
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(std::fwrite(&header, sizeof(header), 1, file), size_t{1});
+  ASSERT_EQ(std::fwrite(data.data(), data.size(), 1, file), size_t{1});
+  if (!entries.empty()) {
+    ASSERT_EQ(std::fwrite(entries.data(), sizeof(PackedBufferEntry),
+                          entries.size(), file),
+              entries.size());
+  }
+  std::fclose(file);
+}
+
+TEST(MMapWeightCacheProviderTest, RejectsOverflowingHeader) {
+  const std::string path = CachePath("overflowing_header.xnn_cache");
+  // data_offset + data_size wraps around to a size within the file.
+  XNNPackCacheHeader header{XNNPackCacheHeader::kVersion,
+                            /*fingerprint=*/1,
+                            /*data_offset=*/128,
+                            /*data_size=*/UINT64_MAX - 127,
+                            kEntriesOffset,
+                            /*num_entries=*/0};
+  WriteCacheFile(path, header, {});
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+  EXPECT_FALSE(provider.IsLoaded());
+}
+
+TEST(MMapWeightCacheProviderTest, RejectsOverflowingEntry) {
+  const std::string path = CachePath("overflowing_entry.xnn_cache");
+  XNNPackCacheHeader header{XNNPackCacheHeader::kVersion,
+                            /*fingerprint=*/1,
+                            /*data_offset=*/128,
+                            /*data_size=*/128,
+                            kEntriesOffset,
+                            /*num_entries=*/1};
+  // offset + size wraps around to a position within the data.
+  PackedBufferEntry entry{{0, 1, PackIdentifier::kNoId},
+                          {/*offset=*/64, /*size=*/UINT64_MAX - 63}};
+  WriteCacheFile(path, header, {entry});
+  MMapWeightCacheProvider provider;
+  provider.SetFilePath(path.c_str());
+  ASSERT_TRUE(provider.LoadOrStartBuild(/*fingerprint=*/1));
+  EXPECT_FALSE(provider.IsLoaded());
+}
+
+// Returns the fingerprint of a context with one static tensor holding
+// `weights`.
+uint64_t FingerprintWeights(std::vector<float> weights) {
+  TfLiteTensor tensor = {};
+  tensor.type = kTfLiteFloat32;
+  tensor.allocation_type = kTfLiteMmapRo;
+  tensor.bytes = weights.size() * sizeof(float);
+  tensor.data.raw_const = reinterpret_cast<const char*>(weights.data());
+  TfLiteContext context = {};
+  context.tensors = &tensor;
+  context.tensors_size = 1;
+  return FingerprintStaticTensors(&context);
+}
+
+TEST(FingerprintStaticTensorsTest, DependsOnEveryWeight) {
+  std::vector<float> weights(1024, 1.0f);
+  const uint64_t fingerprint = FingerprintWeights(weights);
+  EXPECT_EQ(FingerprintWeights(weights), fingerprint);
+  // Only a byte in the middle of the weights differs.
+  reinterpret_cast<uint8_t*>(weights.data())[2001] ^= 1;
+  EXPECT_NE(FingerprintWeights(weights), fingerprint);
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
@@ -13,7 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <sys/stat.h>
+
+#include <cstdio>
 #include <memory>  // For std::unique_ptr.
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
@@ -178,6 +182,53 @@ TEST(XNNPACK_WEIGHTS_CACHE, SoftFinalization) {
   ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
 }
 
+TEST(XNNPACK_WEIGHTS_CACHE, SharedThroughFile) {
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  DummyOpResolver resolver;
+  const std::string path =
+      ::testing::TempDir() + "/xnnpack_weights_cache_test.xnn_cache";
+  std::remove(path.c_str());
+
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.weight_cache_file_path = path.c_str();
+
+  // The first interpreter packs the weights and writes them to the file, the
+  // second one maps them.
+  std::vector<float> outputs[2];
+  struct stat file_stats[2];
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<Interpreter> interpreter;
+    ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter));
+    ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+
+    std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+        delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+                 TfLiteXNNPackDelegateDelete);
+    ASSERT_EQ(kTfLiteOk, interpreter->ModifyGraphWithDelegate(delegate.get()));
+
+    float* input = interpreter->typed_input_tensor<float>(0);
+    const size_t input_size =
+        interpreter->input_tensor(0)->bytes / sizeof(float);
+    for (size_t j = 0; j < input_size; ++j) {
+      input[j] = static_cast<float>(j % 17) / 8.0f - 1.0f;
+    }
+    ASSERT_EQ(kTfLiteOk, interpreter->Invoke());
+    const float* output = interpreter->typed_output_tensor<float>(0);
+    outputs[i].assign(
+        output, output + interpreter->output_tensor(0)->bytes / sizeof(float));
+
+    ASSERT_EQ(stat(path.c_str(), &file_stats[i]), 0);
+  }
+
+  // The file is rewritten, to a new inode, whenever buffers that it doesn't
+  // hold are packed.
+  EXPECT_EQ(file_stats[0].st_ino, file_stats[1].st_ino);
+  EXPECT_EQ(file_stats[0].st_size, file_stats[1].st_size);
+  EXPECT_EQ(outputs[0], outputs[1]);
+}
+
 // Dummy class to use with parameterized test.
 class WeightsCacheTest : public testing::TestWithParam<size_t> {};
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -525,6 +526,10 @@ class Delegate {
         options != nullptr ? *options : TfLiteXNNPackDelegateOptionsDefault();
     delegate_.flags = GetXNNPackDelegateFlags();
     workspace_.reset(workspace);
+    if (options_.weights_cache == nullptr &&
+        options_.weight_cache_file_path != nullptr) {
+      weight_cache_provider_.SetFilePath(options_.weight_cache_file_path);
+    }
   }
 
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
@@ -610,14 +615,59 @@ class Delegate {
 #endif
   }
 
-  xnn_weights_cache_t weights_cache() const {
-    if (options_.weights_cache == nullptr) {
-      return nullptr;
-    } else {
+  xnn_weights_cache_t weights_cache() {
+    if (options_.weights_cache != nullptr) {
       return reinterpret_cast<xnn_weights_cache_t>(options_.weights_cache);
+    } else if (weight_cache_provider_.IsActive()) {
+      return weight_cache_provider_.GetCacheProvider();
+    } else {
+      return nullptr;
+    }
+  }
+
+  // Maps or starts building the weight cache file, and identifies the static
+  // tensors of `context` so that the buffers packed from them can be found in
+  // the file by other processes. Must be called before creating the runtimes
+  // of `context`.
+  void PrepareWeightCache(TfLiteContext* context) {
+    if (weight_cache_provider_.file_path().empty()) {
+      return;
+    }
+    const uint64_t fingerprint = FingerprintStaticTensors(context);
+    if (!weight_cache_provider_.LoadOrStartBuild(fingerprint)) {
+      return;
+    }
+    weight_cache_provider_.ClearTensorIdentifiers();
+    weight_cache_provider_.StartInserting();
+    for (int t = 0; t < context->tensors_size; ++t) {
+      const void* data = nullptr;
+      if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
+        data = context->tensors[t].data.raw_const;
+      } else {
+        const auto it = static_unpacked_data_map_.find(t);
+        if (it != static_unpacked_data_map_.end()) {
+          data = static_unpacked_data_.data() + it->second;
+        }
+      }
+      if (data != nullptr) {
+        // The fingerprint tells apart the tensors of different subgraphs.
+        weight_cache_provider_.MapTensorIdentifier(
+            data, fingerprint ^ (static_cast<uint64_t>(t) *
+                                 UINT64_C(0x9E3779B97F4A7C15)));
+      }
     }
   }
 
+  // Writes the buffers packed for the runtimes created since
+  // PrepareWeightCache to the weight cache file.
+  void FinalizeWeightCache() {
+    if (!weight_cache_provider_.IsActive()) {
+      return;
+    }
+    weight_cache_provider_.Finalize();
+    weight_cache_provider_.ClearTensorIdentifiers();
+  }
+
   xnn_workspace_t workspace() const { return workspace_.get(); }
 
   TfLiteStatus AssociateVariableWithTensor(int local_id,
@@ -709,6 +759,8 @@ class Delegate {
       nullptr, &xnn_release_workspace};
 
   TfLiteXNNPackDelegateOptions options_{};
+  // Weights cache backed by options_.weight_cache_file_path.
+  MMapWeightCacheProvider weight_cache_provider_;
   VariableHolder variable_holder_;
   std::mutex workspace_mutex_;
 };
@@ -7728,16 +7780,21 @@ const TfLiteRegistration kSubgraphRegistration = {
 };
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  auto* xnnpack_delegate =
+      static_cast<::tflite::xnnpack::Delegate*>(delegate->data_);
   TfLiteIntArray* ops_to_replace =
-      static_cast<::tflite::xnnpack::Delegate*>(delegate->data_)
-          ->PrepareOpsToDelegate(context);
+      xnnpack_delegate->PrepareOpsToDelegate(context);
   if (ops_to_replace == nullptr) {
     return kTfLiteError;
   }
 
+  // The runtimes, which pack the weights, are created while replacing the
+  // nodes.
+  xnnpack_delegate->PrepareWeightCache(context);
   const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kSubgraphRegistration, ops_to_replace, delegate);
   TfLiteIntArrayFree(ops_to_replace);
+  xnnpack_delegate->FinalizeWeightCache();
   return status;
 }
 
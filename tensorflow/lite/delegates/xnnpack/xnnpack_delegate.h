@@ -70,6 +70,14 @@ typedef struct {
   bool handle_variable_ops;
   // Enable adaptive optimization for AVX CPUs.
   bool experimental_adaptive_avx_optimization;
+  // Path of a file caching packed weights across interpreters and processes.
+  // The first delegate using the file writes the weights it packs to it, and
+  // later delegates mmap the file instead of packing the weights again. The
+  // file is rebuilt when the model or the XNNPACK version changes. Ignored
+  // when `weights_cache` is set.
+  //
+  // WARNING: This is an experimental flag.
+  const char* weight_cache_file_path;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
@@ -24,6 +24,7 @@ namespace custom {
 
 TfLiteRegistration* Register_KV_CACHE();
 TfLiteRegistration* Register_SDPA();
+TfLiteRegistration* Register_LAYER_NORM();
 
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
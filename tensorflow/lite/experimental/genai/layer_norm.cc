@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <math.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kInputTensor = 0;
+static const int kGammaTensor = 1;
+static const int kBetaTensor = 2;
+static const int kOutputTensor = 0;
+
+// Epsilon of keras.layers.LayerNormalization.
+static const float kDefaultEpsilon = 1e-3f;
+
+struct LayerNormOpData {
+  float epsilon;
+};
+
+void* LayerNormInit(TfLiteContext* context, const char* buffer,
+                    size_t length) {
+  LayerNormOpData* op_data = new LayerNormOpData();
+  op_data->epsilon = kDefaultEpsilon;
+  return op_data;
+}
+
+TfLiteStatus LayerNormPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  LayerNormOpData* op_data =
+      reinterpret_cast<LayerNormOpData*>(node->user_data);
+
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  const TfLiteTensor* gamma;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kGammaTensor, &gamma));
+  const TfLiteTensor* beta;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kBetaTensor, &beta));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, gamma->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, beta->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, NumDimensions(input) >= 1);
+  // The input is normalized over its last dimension, which gamma and beta
+  // scale and offset.
+  const int depth = SizeOfDimension(input, NumDimensions(input) - 1);
+  TF_LITE_ENSURE_EQ(context, NumElements(gamma), depth);
+  TF_LITE_ENSURE_EQ(context, NumElements(beta), depth);
+
+  if (node->custom_initial_data_size > 0) {
+    const uint8_t* buffer =
+        reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+    const size_t length = node->custom_initial_data_size;
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+    auto epsilon = flexbuffer_map["epsilon"];
+    if (!epsilon.IsNull()) op_data->epsilon = epsilon.AsFloat();
+  }
+
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
+void LayerNormFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<LayerNormOpData*>(buffer);
+}
+
+TfLiteStatus LayerNormEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  const TfLiteTensor* gamma;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kGammaTensor, &gamma));
+  const TfLiteTensor* beta;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kBetaTensor, &beta));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+  const LayerNormOpData* op_data =
+      reinterpret_cast<LayerNormOpData*>(node->user_data);
+
+  const int depth = SizeOfDimension(input, NumDimensions(input) - 1);
+  if (depth == 0) return kTfLiteOk;
+  const int num_rows = NumElements(input) / depth;
+  const float* input_data = GetTensorData<float>(input);
+  const float* gamma_data = GetTensorData<float>(gamma);
+  const float* beta_data = GetTensorData<float>(beta);
+  float* output_data = GetTensorData<float>(output);
+  // Each row is read twice, for its mean and then for its variance, while it
+  // is still in cache, and written once.
+  for (int r = 0; r < num_rows; ++r) {
+    const float* input_row = input_data + r * depth;
+    float* output_row = output_data + r * depth;
+    float sum = 0.0f;
+    for (int i = 0; i < depth; ++i) sum += input_row[i];
+    const float mean = sum / depth;
+    float squared_sum = 0.0f;
+    for (int i = 0; i < depth; ++i) {
+      const float centered = input_row[i] - mean;
+      squared_sum += centered * centered;
+    }
+    const float inv_stddev =
+        1.0f / sqrtf(squared_sum / depth + op_data->epsilon);
+    for (int i = 0; i < depth; ++i) {
+      output_row[i] =
+          (input_row[i] - mean) * inv_stddev * gamma_data[i] + beta_data[i];
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_LAYER_NORM() {
+  static TfLiteRegistration r = {llm::LayerNormInit, llm::LayerNormFree,
+                                 llm::LayerNormPrepare, llm::LayerNormEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <math.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class LayerNormOpModel : public SingleOpModel {
+ public:
+  LayerNormOpModel(const std::vector<int>& input_shape, float epsilon) {
+    const int depth = input_shape.back();
+    input_ = AddInput({TensorType_FLOAT32, input_shape});
+    gamma_ = AddInput({TensorType_FLOAT32, {depth}});
+    beta_ = AddInput({TensorType_FLOAT32, {depth}});
+    output_ = AddOutput({TensorType_FLOAT32, input_shape});
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("epsilon", epsilon); });
+    fbb.Finish();
+    SetCustomOp("LayerNorm", fbb.GetBuffer(), ops::custom::Register_LAYER_NORM);
+    BuildInterpreter({input_shape, {depth}, {depth}});
+  }
+
+  void SetInputs(const std::vector<float>& input,
+                 const std::vector<float>& gamma,
+                 const std::vector<float>& beta) {
+    PopulateTensor(input_, input);
+    PopulateTensor(gamma_, gamma);
+    PopulateTensor(beta_, beta);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int gamma_;
+  int beta_;
+  int output_;
+};
+
+TEST(LayerNormOpTest, NormalizesLastDimension) {
+  LayerNormOpModel m({2, 4}, 1e-5f);
+  m.SetInputs({1, 2, 3, 4, -2, 0, 2, 4}, {1, 1, 2, 2}, {0, 1, 0, 1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  const float inv_stddev = 1 / sqrt(1.25f + 1e-5f);
+  const float inv_stddev_1 = 1 / sqrt(5.0f + 1e-5f);
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-1.5f * inv_stddev, -0.5f * inv_stddev + 1,
+                   1.0f * inv_stddev, 3.0f * inv_stddev + 1,
+                   -3.0f * inv_stddev_1, -1.0f * inv_stddev_1 + 1,
+                   2.0f * inv_stddev_1, 6.0f * inv_stddev_1 + 1},
+                  1e-5)));
+}
+
+TEST(LayerNormOpTest, ConstantRowsAreNotAmplified) {
+  LayerNormOpModel m({1, 1, 3}, 1e-3f);
+  m.SetInputs({5, 5, 5}, {1, 1, 1}, {0.5f, 0.5f, 0.5f});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({0.5f, 0.5f, 0.5f}, 1e-6)));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,23 +15,18 @@ limitations under the License.
 
 #include <math.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <limits>
+#include <vector>
 
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/common.h"
-#include "tensorflow/lite/kernels/internal/reference/add.h"
-#include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
-#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
-#include "tensorflow/lite/kernels/internal/reference/softmax.h"
-#include "tensorflow/lite/kernels/internal/reference/transpose.h"
-#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
-#include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -45,27 +40,141 @@ static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
 static const int kOutputTensor = 0;
 
-static const int kNumTempTensors = 10;
-static const int kTransposeQueryTempTensorIndex = 0;
-static const int kTransposeKeyTempTensorIndex = 1;
-static const int kMatMul1TempTensorIndex = 2;
-static const int kAddTempTensorIndex = 3;
-static const int kTransposeValueTempTensorIndex = 4;
-static const int kMatMul2TempTensorIndex = 5;
-static const int kReshape1TempTensorIndex = 6;
-static const int kReshape2TempTensorIndex = 7;
-static const int kBroadcastKTempTensorIndex = 8;
-static const int kBroadcastVTempTensorIndex = 9;
+// Number of query positions and of key/value positions processed together.
+// The scores of one query tile against one key/value block are the only
+// intermediate values, so memory use doesn't grow with the sequence length.
+static const int kQueryTileSize = 16;
+static const int kKeyValueBlockSize = 64;
 
 struct OpData {
   float scale;
-  int scratch_tensor_index;
+};
+
+// Shapes are (B, T, N, H) for the query, key, value and output, and the mask
+// broadcasts to (B, N, Tq, Tk).
+struct AttentionParams {
+  const float* query;
+  const float* key;
+  const float* value;
+  const float* mask;
+  float* output;
+  int batch_size;
+  int query_len;
+  int num_heads;
+  int kv_len;
+  int num_kv_heads;
+  int head_dim;
+  float scale;
+  // Strides of the mask along (B, N, Tq, Tk), 0 for broadcast dimensions.
+  int mask_strides[4];
+};
+
+// Computes the output of `head` of batch `batch` for the query positions
+// [query_begin, query_end) with an online softmax: the key/value positions
+// are streamed in blocks, and the running maximum, sum and weighted values of
+// each query row are rescaled whenever the maximum grows.
+void AttendQueryTile(const AttentionParams& p, int batch, int head,
+                     int query_begin, int query_end, float* scores,
+                     float* accumulators, float* row_max, float* row_sum) {
+  const int num_rows = query_end - query_begin;
+  const int head_dim = p.head_dim;
+  // Query heads map to key/value heads like torch.repeat_interleave.
+  const int kv_head = head / (p.num_heads / p.num_kv_heads);
+  const float kNegInf = -std::numeric_limits<float>::infinity();
+  std::fill(accumulators, accumulators + num_rows * head_dim, 0.0f);
+  std::fill(row_max, row_max + num_rows, kNegInf);
+  std::fill(row_sum, row_sum + num_rows, 0.0f);
+
+  for (int kv_begin = 0; kv_begin < p.kv_len;
+       kv_begin += kKeyValueBlockSize) {
+    const int block_len = std::min(kKeyValueBlockSize, p.kv_len - kv_begin);
+    for (int r = 0; r < num_rows; ++r) {
+      const int q = query_begin + r;
+      const float* query_row =
+          p.query + ((batch * p.query_len + q) * p.num_heads + head) * head_dim;
+      const float* mask_row = p.mask + batch * p.mask_strides[0] +
+                              head * p.mask_strides[1] + q * p.mask_strides[2];
+      float* score_row = scores + r * kKeyValueBlockSize;
+      float block_max = kNegInf;
+      for (int j = 0; j < block_len; ++j) {
+        const int k = kv_begin + j;
+        const float* key_row =
+            p.key + ((batch * p.kv_len + k) * p.num_kv_heads + kv_head) *
+                        head_dim;
+        float dot = 0.0f;
+        for (int d = 0; d < head_dim; ++d) dot += query_row[d] * key_row[d];
+        score_row[j] = dot * p.scale + mask_row[k * p.mask_strides[3]];
+        block_max = std::max(block_max, score_row[j]);
+      }
+      const float new_max = std::max(row_max[r], block_max);
+      // Every position seen so far is masked out.
+      if (new_max == kNegInf) continue;
+
+      float* accumulator = accumulators + r * head_dim;
+      const float correction = expf(row_max[r] - new_max);
+      row_sum[r] *= correction;
+      for (int d = 0; d < head_dim; ++d) accumulator[d] *= correction;
+      for (int j = 0; j < block_len; ++j) {
+        const float weight = expf(score_row[j] - new_max);
+        row_sum[r] += weight;
+        const float* value_row =
+            p.value +
+            ((batch * p.kv_len + kv_begin + j) * p.num_kv_heads + kv_head) *
+                head_dim;
+        for (int d = 0; d < head_dim; ++d) {
+          accumulator[d] += weight * value_row[d];
+        }
+      }
+      row_max[r] = new_max;
+    }
+  }
+
+  for (int r = 0; r < num_rows; ++r) {
+    float* output_row =
+        p.output +
+        ((batch * p.query_len + query_begin + r) * p.num_heads + head) *
+            head_dim;
+    const float* accumulator = accumulators + r * head_dim;
+    const float inv_sum = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+    for (int d = 0; d < head_dim; ++d) {
+      output_row[d] = accumulator[d] * inv_sum;
+    }
+  }
+}
+
+// Computes the (batch, head, query tile) work items [start, end).
+struct SDPAWorkerTask : cpu_backend_threadpool::Task {
+  SDPAWorkerTask(const AttentionParams* params, int start, int end)
+      : params(params), start(start), end(end) {}
+  void Run() override {
+    const int num_tiles =
+        (params->query_len + kQueryTileSize - 1) / kQueryTileSize;
+    std::vector<float> scores(kQueryTileSize * kKeyValueBlockSize);
+    std::vector<float> accumulators(kQueryTileSize * params->head_dim);
+    std::vector<float> row_max(kQueryTileSize);
+    std::vector<float> row_sum(kQueryTileSize);
+    for (int i = start; i < end; ++i) {
+      const int tile = i % num_tiles;
+      const int head = (i / num_tiles) % params->num_heads;
+      const int batch = i / (num_tiles * params->num_heads);
+      const int query_begin = tile * kQueryTileSize;
+      const int query_end =
+          std::min(query_begin + kQueryTileSize, params->query_len);
+      AttendQueryTile(*params, batch, head, query_begin, query_end,
+                      scores.data(), accumulators.data(), row_max.data(),
+                      row_sum.data());
+    }
+  }
+
+ private:
+  const AttentionParams* params;
+  int start;
+  int end;
 };
 
 void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   OpData* op_data = new OpData();
   op_data->scale = 0.0f;
-  context->AddTensors(context, kNumTempTensors, &op_data->scratch_tensor_index);
   return op_data;
 }
 
@@ -86,11 +195,33 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* mask_tensor;
   TF_LITE_ENSURE_OK(
       context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), NumDimensions(k_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), NumDimensions(v_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
                     NumDimensions(mask_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, k_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, v_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, mask_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, HaveSameShapes(k_tensor, v_tensor));
+  TF_LITE_ENSURE_EQ(context, q_tensor->dims->data[0], k_tensor->dims->data[0]);
+  TF_LITE_ENSURE_EQ(context, q_tensor->dims->data[3], k_tensor->dims->data[3]);
+  // Grouped (and multi) query attention.
+  TF_LITE_ENSURE(context, k_tensor->dims->data[2] > 0);
+  TF_LITE_ENSURE_EQ(context,
+                    q_tensor->dims->data[2] % k_tensor->dims->data[2], 0);
+  // The mask must broadcast to (B, N, Tq, Tk).
+  const int attention_dims[4] = {
+      q_tensor->dims->data[0], q_tensor->dims->data[2],
+      q_tensor->dims->data[1], k_tensor->dims->data[1]};
+  for (int i = 0; i < 4; ++i) {
+    const int mask_dim = mask_tensor->dims->data[i];
+    TF_LITE_ENSURE(context, mask_dim == 1 || mask_dim == attention_dims[i]);
+  }
 
   // Get custom op params
   const uint8_t* buffer =
@@ -104,254 +235,8 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   if (op_data->scale == 0.0f)
     op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
 
-  TfLiteIntArrayFree(node->temporaries);
-  node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
-
-  // Temp tensor for Transposed Q;
-  {
-    node->temporaries->data[kTransposeQueryTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeQueryTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeQueryTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = q_tensor->dims->data[i];
-    }
-    // Swap middle two dimensions.
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = q_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed K;
-  {
-    node->temporaries->data[kTransposeKeyTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeKeyTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeKeyTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
-    }
-    // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  TfLiteIntArray* add_broadcast_shape = nullptr;
-  // Temp tensor for Matmul1 output;
-  {
-    node->temporaries->data[kMatMul1TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
-    int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
-                               q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = matmul_out_shape[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-    // get dims from attention_mask, matmul1_out for add broadcast
-    CalculateShapeForBroadcast(context, mask_tensor, scratch_buffer,
-                               &add_broadcast_shape);
-  }
-
-  // Temp tensor for add output;
-  int add_out_shape[4];
-  {
-    node->temporaries->data[kAddTempTensorIndex] =
-        op_data->scratch_tensor_index + kAddTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                                /*index=*/kAddTempTensorIndex,
-                                                &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = add_broadcast_shape;
-    for (int i = 0; i < 4; ++i) {
-      add_out_shape[i] = scratch_buffer_size->data[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed V;
-  {
-    node->temporaries->data[kTransposeValueTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeValueTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeValueTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Matmul2 output;
-  {
-    node->temporaries->data[kMatMul2TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // logits_out_shape = add_out_shape
-    // mha/gqa: [logits_out[0], logits_out[1], logits_out[2], permute_v[2]]
-    scratch_buffer_size->data[0] = add_out_shape[0];
-    scratch_buffer_size->data[1] = add_out_shape[1];
-    scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Reshape K / Transpose Q;
-  {
-    node->temporaries->data[kReshape1TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
-    } else {
-      scratch_buffer_size->data[0] = q_tensor->dims->data[0];
-      scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-      scratch_buffer_size->data[2] = q_tensor->dims->data[3];
-      scratch_buffer_size->data[3] = q_tensor->dims->data[1];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Reshape V / Add_out (softmax_out);
-  {
-    node->temporaries->data[kReshape2TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
-    } else {
-      scratch_buffer_size->data[0] = add_out_shape[0];
-      scratch_buffer_size->data[1] = add_out_shape[1];
-      scratch_buffer_size->data[2] = add_out_shape[3];
-      scratch_buffer_size->data[3] = add_out_shape[2];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Broadcast K
-  {
-    node->temporaries->data[kBroadcastKTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastKTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastKTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = k_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-    scratch_buffer_size->data[3] = k_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Broadcast V
-  {
-    node->temporaries->data[kBroadcastVTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastVTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastVTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  return kTfLiteOk;
+  return context->ResizeTensor(context, output_tensor,
+                               TfLiteIntArrayCopy(q_tensor->dims));
 }
 
 void SDPAFree(TfLiteContext* context, void* buffer) {
@@ -360,7 +245,7 @@ void SDPAFree(TfLiteContext* context, void* buffer) {
 
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
-  Simple implementation of Scaled Dot Product Attention.
+  Tiled implementation of Scaled Dot Product Attention.
   Takes query_proj, key_proj, value_proj, mask tensors as inputs, and
   outputs the attention result.
 
@@ -368,296 +253,67 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   Scale is computed using 1/sqrt(head_dim),
   head_dim = q[-1] = embedding_dim // num_q_heads
   Only support for FLOAT32 inputs for now.
-  Only support static tensors for now (k/v[1] = max sequence length)
+  The (Tq, Tk) attention scores are never materialized: each query tile
+  streams the keys and values in blocks, and the (batch, head, query tile)
+  work items are spread over the CPU backend threadpool.
   */
 
   const TfLiteTensor* query_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
-  auto query_shape = GetTensorShape(query_tensor);
-  auto query_data = GetTensorData<float>(query_tensor);
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
   const TfLiteTensor* attention_mask_tensor;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
                                           &attention_mask_tensor));
-  auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
-  auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
   TfLiteTensor* output_tensor;
   TF_LITE_ENSURE_OK(
       context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
-  auto output_shape = GetTensorShape(output_tensor);
-  auto output_data = GetTensorData<float>(output_tensor);
-
-  // temporaries
-  TfLiteTensor* transpose_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeQueryTempTensorIndex,
-                       &transpose_q_out_tensor));
-  auto transpose_q_out_shape = GetTensorShape(transpose_q_out_tensor);
-  auto transpose_q_out_data = GetTensorData<float>(transpose_q_out_tensor);
-  TfLiteTensor* transpose_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeKeyTempTensorIndex,
-                       &transpose_k_out_tensor));
-  auto transpose_k_out_shape = GetTensorShape(transpose_k_out_tensor);
-  auto transpose_k_out_data = GetTensorData<float>(transpose_k_out_tensor);
-  TfLiteTensor* matmul1_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul1TempTensorIndex,
-                                              &matmul1_out_tensor));
-  auto matmul1_out_shape = GetTensorShape(matmul1_out_tensor);
-  auto matmul1_out_data = GetTensorData<float>(matmul1_out_tensor);
-  TfLiteTensor* add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, /*index=*/kAddTempTensorIndex,
-                                &add_out_tensor));
-  auto add_out_shape = GetTensorShape(add_out_tensor);
-  auto add_out_data = GetTensorData<float>(add_out_tensor);
-  TfLiteTensor* transpose_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeValueTempTensorIndex,
-                       &transpose_v_out_tensor));
-  auto transpose_v_out_shape = GetTensorShape(transpose_v_out_tensor);
-  auto transpose_v_out_data = GetTensorData<float>(transpose_v_out_tensor);
-  TfLiteTensor* matmul2_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul2TempTensorIndex,
-                                              &matmul2_out_tensor));
-  auto matmul2_out_shape = GetTensorShape(matmul2_out_tensor);
-  auto matmul2_out_data = GetTensorData<float>(matmul2_out_tensor);
-  TfLiteTensor* reshape_k_or_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape1TempTensorIndex,
-                       &reshape_k_or_q_out_tensor));
-  auto reshape_k_or_q_out_shape = GetTensorShape(reshape_k_or_q_out_tensor);
-  auto reshape_k_or_q_out_data =
-      GetTensorData<float>(reshape_k_or_q_out_tensor);
-  TfLiteTensor* reshape_v_or_add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape2TempTensorIndex,
-                       &reshape_v_or_add_out_tensor));
-  auto reshape_v_or_add_out_shape = GetTensorShape(reshape_v_or_add_out_tensor);
-  auto reshape_v_or_add_out_data =
-      GetTensorData<float>(reshape_v_or_add_out_tensor);
-  TfLiteTensor* broadcast_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastKTempTensorIndex,
-                       &broadcast_k_out_tensor));
-  auto broadcast_k_out_shape = GetTensorShape(broadcast_k_out_tensor);
-  auto broadcast_k_out_data = GetTensorData<float>(broadcast_k_out_tensor);
-  TfLiteTensor* broadcast_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastVTempTensorIndex,
-                       &broadcast_v_out_tensor));
-  auto broadcast_v_out_shape = GetTensorShape(broadcast_v_out_tensor);
-  auto broadcast_v_out_data = GetTensorData<float>(broadcast_v_out_tensor);
-
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  bool mqa = key_tensor->dims->data[2] == 1;
-  bool gqa = !mqa && (key_tensor->dims->data[2] != query_tensor->dims->data[2]);
-
-  // scale * q
-  float scale = op_data->scale;
-  int flat_size = query_shape.FlatSize();
-  float output_min = -std::numeric_limits<float>::infinity();
-  float output_max = std::numeric_limits<float>::infinity();
-  for (int i = 0; i < flat_size; ++i) {
-    query_tensor->data.f[i] = ActivationFunctionWithMinMax(
-        query_tensor->data.f[i] * scale, output_min, output_max);
-  }
-
-  // permute q {0, 2, 1, 3}
-  tflite::TransposeParams transpose_q_params;
-  transpose_q_params.perm_count = 4;
-  transpose_q_params.perm[0] = 0;
-  transpose_q_params.perm[1] = 2;
-  transpose_q_params.perm[2] = 1;
-  transpose_q_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_q_params, query_shape, query_data,
-                           transpose_q_out_shape, transpose_q_out_data);
-
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
-
-  // broadcast k to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_k_ptr = transpose_k_out_data;
-    float* broadcast_k_ptr = broadcast_k_out_data;
-    int num_elements =
-        transpose_k_out_shape.Dims(2) * transpose_k_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_k_out_shape.Dims(1) / transpose_k_out_shape.Dims(1);
-    for (int i = 0; i < transpose_k_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_k_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_k_ptr, transpose_k_ptr,
-                 num_elements * sizeof(float));
-          broadcast_k_ptr += num_elements;
-        }
-        transpose_k_ptr += num_elements;
-      }
-    }
-  }
-
-  // reshape k for MQA, or transpose q for MHA
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_k_out_tensor->bytes,
-                      reshape_k_or_q_out_tensor->bytes);
-    memcpy(reshape_k_or_q_out_tensor->data.data,
-           transpose_k_out_tensor->data.data, transpose_k_out_tensor->bytes);
-  } else {
-    // permute q2 {0, 1, 3, 2}
-    tflite::TransposeParams transpose_q2_params;
-    transpose_q2_params.perm_count = 4;
-    transpose_q2_params.perm[0] = 0;
-    transpose_q2_params.perm[1] = 1;
-    transpose_q2_params.perm[2] = 3;
-    transpose_q2_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_q2_params, transpose_q_out_shape,
-                             transpose_q_out_data, reshape_k_or_q_out_shape,
-                             reshape_k_or_q_out_data);
-  }
-
-  // mqa FC (q, squeezed_k)
-  // mha BMM(q, k) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(
-        fc_params, transpose_q_out_shape, transpose_q_out_data,
-        reshape_k_or_q_out_shape, reshape_k_or_q_out_data, RuntimeShape(),
-        nullptr, matmul1_out_shape, matmul1_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose q above)
-    reference_ops::BatchMatMul(
-        broadcast_k_out_shape, broadcast_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_k_out_shape, transpose_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  }
-
-  // add matmul_out + mask
-  tflite::ArithmeticParams add_params;
-  SetActivationParams(output_min, output_max, &add_params);
-  reference_ops::BroadcastAdd6DSlow(
-      add_params, attention_mask_shape, attention_mask_data, matmul1_out_shape,
-      matmul1_out_data, add_out_shape, add_out_data);
-
-  // softmax, can do in-place
-  tflite::SoftmaxParams softmax_params;
-  softmax_params.beta = 1.0f;
-  reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
-                         add_out_shape, add_out_data);
-
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
-
-  // broadcast v to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_v_ptr = transpose_v_out_data;
-    float* broadcast_v_ptr = broadcast_v_out_data;
-    int num_elements =
-        transpose_v_out_shape.Dims(2) * transpose_v_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_v_out_shape.Dims(1) / transpose_v_out_shape.Dims(1);
-    for (int i = 0; i < transpose_v_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_v_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_v_ptr, transpose_v_ptr,
-                 num_elements * sizeof(float));
-          broadcast_v_ptr += num_elements;
-        }
-        transpose_v_ptr += num_elements;
-      }
-    }
-  }
-
-  // reshape v for MQA, or add_out (softmax_out)
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_v_out_tensor->bytes,
-                      reshape_v_or_add_out_tensor->bytes);
-    memcpy(reshape_v_or_add_out_tensor->data.data,
-           transpose_v_out_tensor->data.data, transpose_v_out_tensor->bytes);
-  } else {
-    // permute softmax_out {0, 1, 3, 2}
-    tflite::TransposeParams transpose_softmax_out_params;
-    transpose_softmax_out_params.perm_count = 4;
-    transpose_softmax_out_params.perm[0] = 0;
-    transpose_softmax_out_params.perm[1] = 1;
-    transpose_softmax_out_params.perm[2] = 3;
-    transpose_softmax_out_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_softmax_out_params, add_out_shape,
-                             add_out_data, reshape_v_or_add_out_shape,
-                             reshape_v_or_add_out_data);
+  AttentionParams params;
+  params.query = GetTensorData<float>(query_tensor);
+  params.key = GetTensorData<float>(key_tensor);
+  params.value = GetTensorData<float>(value_tensor);
+  params.mask = GetTensorData<float>(attention_mask_tensor);
+  params.output = GetTensorData<float>(output_tensor);
+  params.batch_size = query_tensor->dims->data[0];
+  params.query_len = query_tensor->dims->data[1];
+  params.num_heads = query_tensor->dims->data[2];
+  params.head_dim = query_tensor->dims->data[3];
+  params.kv_len = key_tensor->dims->data[1];
+  params.num_kv_heads = key_tensor->dims->data[2];
+  params.scale = op_data->scale;
+  const TfLiteIntArray* mask_dims = attention_mask_tensor->dims;
+  int stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    params.mask_strides[i] = mask_dims->data[i] == 1 ? 0 : stride;
+    stride *= mask_dims->data[i];
   }
 
-  // mqa FC (softmax_out, squeezed_v)
-  // mha BMM(softmax_out, v) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(fc_params, add_out_shape, add_out_data,
-                                  reshape_v_or_add_out_shape,
-                                  reshape_v_or_add_out_data, RuntimeShape(),
-                                  nullptr, matmul2_out_shape, matmul2_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose add_out above)
-    reference_ops::BatchMatMul(
-        broadcast_v_out_shape, broadcast_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_v_out_shape, transpose_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
+  const int num_tiles =
+      (params.query_len + kQueryTileSize - 1) / kQueryTileSize;
+  const int num_work_items = params.batch_size * params.num_heads * num_tiles;
+  if (num_work_items == 0) return kTfLiteOk;
+
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      std::min(cpu_backend_context->max_num_threads(), num_work_items);
+  std::vector<SDPAWorkerTask> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int end = start + (num_work_items - start) / (thread_count - i);
+    tasks.emplace_back(&params, start, end);
+    start = end;
   }
-
-  // permute out {0, 2, 1, 3}
-  tflite::TransposeParams transpose_out_params;
-  transpose_out_params.perm_count = 4;
-  transpose_out_params.perm[0] = 0;
-  transpose_out_params.perm[1] = 2;
-  transpose_out_params.perm[2] = 1;
-  transpose_out_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_out_params, matmul2_out_shape,
-                           matmul2_out_data, output_shape, output_data);
-
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
   return kTfLiteOk;
 }
 
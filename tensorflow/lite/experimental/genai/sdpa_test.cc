@@ -0,0 +1,153 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <math.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class SDPAOpModel : public SingleOpModel {
+ public:
+  SDPAOpModel(const std::vector<int>& q_shape,
+              const std::vector<int>& kv_shape,
+              const std::vector<int>& mask_shape) {
+    q_ = AddInput({TensorType_FLOAT32, q_shape});
+    k_ = AddInput({TensorType_FLOAT32, kv_shape});
+    v_ = AddInput({TensorType_FLOAT32, kv_shape});
+    mask_ = AddInput({TensorType_FLOAT32, mask_shape});
+    output_ = AddOutput({TensorType_FLOAT32, q_shape});
+    SetCustomOp("SDPA", {}, ops::custom::Register_SDPA);
+    BuildInterpreter({q_shape, kv_shape, kv_shape, mask_shape});
+  }
+
+  void SetInputs(const std::vector<float>& q, const std::vector<float>& k,
+                 const std::vector<float>& v, const std::vector<float>& mask) {
+    PopulateTensor(q_, q);
+    PopulateTensor(k_, k);
+    PopulateTensor(v_, v);
+    PopulateTensor(mask_, mask);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int q_;
+  int k_;
+  int v_;
+  int mask_;
+  int output_;
+};
+
+// Naive attention over (B, T, N, H) tensors with a (1, 1, Tq, Tk) mask.
+std::vector<float> ReferenceAttention(int batch, int q_len, int num_heads,
+                                      int kv_len, int num_kv_heads,
+                                      int head_dim, const std::vector<float>& q,
+                                      const std::vector<float>& k,
+                                      const std::vector<float>& v,
+                                      const std::vector<float>& mask) {
+  const float scale = 1 / sqrt(head_dim);
+  std::vector<float> output(q.size());
+  for (int b = 0; b < batch; ++b) {
+    for (int n = 0; n < num_heads; ++n) {
+      const int kv_head = n / (num_heads / num_kv_heads);
+      for (int i = 0; i < q_len; ++i) {
+        std::vector<float> scores(kv_len);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int j = 0; j < kv_len; ++j) {
+          const float* q_row = &q[((b * q_len + i) * num_heads + n) * head_dim];
+          const float* k_row =
+              &k[((b * kv_len + j) * num_kv_heads + kv_head) * head_dim];
+          float dot = 0;
+          for (int h = 0; h < head_dim; ++h) dot += q_row[h] * k_row[h];
+          scores[j] = dot * scale + mask[i * kv_len + j];
+          max_score = std::max(max_score, scores[j]);
+        }
+        float sum = 0;
+        for (float& score : scores) {
+          score = exp(score - max_score);
+          sum += score;
+        }
+        for (int h = 0; h < head_dim; ++h) {
+          float result = 0;
+          for (int j = 0; j < kv_len; ++j) {
+            result += scores[j] / sum *
+                      v[((b * kv_len + j) * num_kv_heads + kv_head) * head_dim +
+                        h];
+          }
+          output[((b * q_len + i) * num_heads + n) * head_dim + h] = result;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+std::vector<float> MakeData(int size, float step) {
+  std::vector<float> data(size);
+  for (int i = 0; i < size; ++i) data[i] = sin(i * step);
+  return data;
+}
+
+void RunTest(int batch, int q_len, int num_heads, int kv_len,
+             int num_kv_heads, int head_dim) {
+  SDPAOpModel m({batch, q_len, num_heads, head_dim},
+                {batch, kv_len, num_kv_heads, head_dim}, {1, 1, q_len, kv_len});
+  const std::vector<float> q = MakeData(batch * q_len * num_heads * head_dim,
+                                        0.37f);
+  const std::vector<float> k =
+      MakeData(batch * kv_len * num_kv_heads * head_dim, 0.71f);
+  const std::vector<float> v =
+      MakeData(batch * kv_len * num_kv_heads * head_dim, 1.3f);
+  // Causal mask, with the queries at the end of the sequence.
+  std::vector<float> mask(q_len * kv_len);
+  for (int i = 0; i < q_len; ++i) {
+    for (int j = 0; j < kv_len; ++j) {
+      mask[i * kv_len + j] = j > i + kv_len - q_len
+                                 ? -std::numeric_limits<float>::infinity()
+                                 : 0.0f;
+    }
+  }
+  m.SetInputs(q, k, v, mask);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  ReferenceAttention(batch, q_len, num_heads, kv_len,
+                                     num_kv_heads, head_dim, q, k, v, mask),
+                  1e-5)));
+}
+
+TEST(SDPAOpTest, MultiHeadAttention) { RunTest(1, 3, 2, 5, 2, 4); }
+
+TEST(SDPAOpTest, GroupedQueryAttention) { RunTest(2, 4, 4, 6, 2, 8); }
+
+TEST(SDPAOpTest, MultiQueryAttention) { RunTest(1, 1, 4, 9, 1, 8); }
+
+// Spans several query tiles and key/value blocks.
+TEST(SDPAOpTest, LongSequence) { RunTest(1, 40, 2, 300, 1, 16); }
+
+}  // namespace
+}  // namespace tflite
@@ -43,6 +43,26 @@ bool Parse(const char** data, size_t* size, uint32_t* out) {
   return true;
 }
 
+void Serialize(std::string* out, uint64_t value) {
+  for (; value >= kMod; value /= kMod) {
+    out->push_back(value % kMod + kMod);
+  }
+  out->push_back(value);
+}
+
+bool Parse(const char** data, size_t* size, uint64_t* out) {
+  *out = 0;
+  uint64_t mul = 1;
+  for (bool done = false; !done;
+       mul *= kMod, done = !(**data & kMod), ++*data, --*size) {
+    if (*size == 0) {
+      return false;
+    }
+    *out += static_cast<unsigned char>(**data) % kMod * mul;
+  }
+  return true;
+}
+
 // Signed ints are zigzag-encoded as unsigned varints, [..., -2, -1, 0, 1, 2,
 // ...] ->
 // [..., 3, 1, 0, 2, 4, ...].
@@ -74,6 +94,23 @@ bool Parse(const char** data, size_t* size, std::pair<First, Second>* out) {
   return Parse(data, size, &(out->first)) && Parse(data, size, &(out->second));
 }
 
+// Placements are serialized as the concatenation of their fields'
+// serialization.
+void Serialize(std::string* out, const tflite::ArenaTensorPlacement& in) {
+  Serialize(out, in.tensor);
+  Serialize(out, in.first_node);
+  Serialize(out, in.last_node);
+  Serialize(out, in.size);
+  Serialize(out, in.offset);
+}
+
+bool Parse(const char** data, size_t* size, tflite::ArenaTensorPlacement* out) {
+  return Parse(data, size, &out->tensor) &&
+         Parse(data, size, &out->first_node) &&
+         Parse(data, size, &out->last_node) && Parse(data, size, &out->size) &&
+         Parse(data, size, &out->offset);
+}
+
 // Vectors are serialized as the concetation of the serialization of their size
 // and the the serializations of their elements.
 template <class Value>
@@ -119,4 +156,20 @@ bool ParseModelControlDependencies(const char* data, size_t size,
          Parse(&data, &size, out) && (size == 0);
 }
 
+std::string SerializeModelArenaPlacements(const ModelArenaPlacements& in) {
+  std::string out;
+  Serialize(&out, kModelArenaPlacementsMetadataVersion);
+  Serialize(&out, in);
+  return out;
+}
+
+bool ParseModelArenaPlacements(const char* data, size_t size,
+                               ModelArenaPlacements* out) {
+  out->clear();
+  uint32_t version = 0;
+  return Parse(&data, &size, &version) &&
+         (version == kModelArenaPlacementsMetadataVersion) &&
+         Parse(&data, &size, out) && (size == 0);
+}
+
 }  // namespace tflite
@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/memory_planner.h"
 
 namespace tflite {
 
@@ -53,6 +54,29 @@ constexpr char kModelControlDependenciesMetadataKey[] =
 /// serialization.  For deserialization, past versions should remain parseable.
 constexpr uint32_t kModelControlDependenciesMetadataVersion = 1;
 
+/// Arena placements for the model are the collection of the placements of
+/// the non-persistent arena tensors of its subgraphs, see
+/// `Interpreter::GetArenaPlacementsMetadata`.
+using ModelArenaPlacements = std::vector<ArenaPlacements>;
+
+/// Serializes `in` into the returned string. The result is parseable with
+/// ParseModelArenaPlacements.
+std::string SerializeModelArenaPlacements(const ModelArenaPlacements& in);
+
+/// Deserializes `*out` from a character buffer of size `size` at `data`.
+/// Returns true iff successful. When returning false, `*out`'s state is
+/// undefined.
+bool ParseModelArenaPlacements(const char* data, size_t size,
+                               ModelArenaPlacements* out);
+
+/// The key under which to store the serialized arena placements in the
+/// model's metadata.
+constexpr char kModelArenaPlacementsMetadataKey[] = "model_arena_placements";
+
+/// Version of the serialized arena placements, see
+/// kModelControlDependenciesMetadataVersion.
+constexpr uint32_t kModelArenaPlacementsMetadataVersion = 1;
+
 inline constexpr char kModelUseStablehloTensorKey[] = "keep_stablehlo_constant";
 
 }  // namespace tflite
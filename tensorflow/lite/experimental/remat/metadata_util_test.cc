@@ -51,5 +51,36 @@ TEST_F(MetadataSerializerTest, something) {
       "ok");
 }
 
+TEST(ArenaPlacementsSerializerTest, RoundTrip) {
+  constexpr auto kHugeSize = std::numeric_limits<uint64_t>::max();
+  const ModelArenaPlacements in = {
+      {{0, 0, 2, 64, 0}, {3, 1, std::numeric_limits<int32_t>::max(), 8, 64}},
+      {},
+      {{7, -1, 5, kHugeSize, kHugeSize - 1}}};
+  const std::string serialized = SerializeModelArenaPlacements(in);
+  ModelArenaPlacements out = {{{1, 1, 1, 1, 1}}};
+  ASSERT_TRUE(
+      ParseModelArenaPlacements(serialized.data(), serialized.size(), &out));
+  ASSERT_EQ(out.size(), in.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    ASSERT_EQ(out[i].size(), in[i].size());
+    for (size_t j = 0; j < in[i].size(); ++j) {
+      EXPECT_EQ(out[i][j].tensor, in[i][j].tensor);
+      EXPECT_EQ(out[i][j].first_node, in[i][j].first_node);
+      EXPECT_EQ(out[i][j].last_node, in[i][j].last_node);
+      EXPECT_EQ(out[i][j].size, in[i][j].size);
+      EXPECT_EQ(out[i][j].offset, in[i][j].offset);
+    }
+  }
+}
+
+TEST(ArenaPlacementsSerializerTest, RejectsTruncatedData) {
+  const std::string serialized =
+      SerializeModelArenaPlacements({{{0, 0, 2, 1000, 64}}});
+  ModelArenaPlacements out;
+  EXPECT_FALSE(ParseModelArenaPlacements(serialized.data(),
+                                         serialized.size() - 1, &out));
+}
+
 }  // namespace
 }  // namespace tflite
@@ -70,6 +70,14 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the first and last execution plan indices of the nodes that may
+  // run concurrently with the node at execution plan index `index`. Memory
+  // planners keep the tensors used by any of these nodes alive over the whole
+  // range. Defaults to the node alone, for sequential execution.
+  virtual std::pair<size_t, size_t> concurrent_nodes(size_t index) const {
+    return {index, index};
+  }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
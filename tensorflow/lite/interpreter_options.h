@@ -19,8 +19,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <memory>
+#include <utility>
+
 namespace tflite {
 
+class SharedArenaBuffer;
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -80,6 +85,84 @@ class InterpreterOptions {
     return experimental_disable_delegate_clustering_;
   }
 
+  /// Search for a smaller placement of arena tensors when allocating tensors,
+  /// instead of placing them greedily by size. The search runs on every full
+  /// re-plan, e.g. the first `AllocateTensors` and the ones following an input
+  /// resize, and its results are cached process wide so that interpreters for
+  /// the same model only pay for it once. It trades a slower `AllocateTensors`
+  /// for a smaller arena.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetOptimizeArenaPlacement(bool value = true) {
+    experimental_optimize_arena_placement_ = value;
+  }
+
+  /// Returns if the `experimental_optimize_arena_placement_` feature is
+  /// enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetOptimizeArenaPlacement() {
+    return experimental_optimize_arena_placement_;
+  }
+
+  /// Run up to `value` independent nodes of the execution plan at the same
+  /// time, e.g. the branches of a multi-head model. The execution plan is
+  /// ordered into stages of nodes that don't depend on each other, and the
+  /// memory planner keeps the tensors of a stage alive for the whole stage.
+  /// The threads given to the ops of a stage by `SetNumThreads` are divided
+  /// between its nodes. Nodes with variable, resource or variant tensors and
+  /// control flow ops run alone. Subgraphs with dynamic tensors run
+  /// sequentially. Values below 2 disable the feature.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetMaxParallelBranches(int value) {
+    experimental_max_parallel_branches_ = value;
+  }
+
+  /// Returns the maximum number of nodes run at the same time, 1 if the
+  /// feature is disabled.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetMaxParallelBranches() {
+    return experimental_max_parallel_branches_ > 1
+               ? experimental_max_parallel_branches_
+               : 1;
+  }
+
+  /// Keep the arena placements of the last `value` input shape signatures
+  /// seen by `AllocateTensors`, so that alternating between a few input
+  /// shapes, e.g. sequence lengths or image sizes, reuses the placement found
+  /// for each of them instead of searching for one again. Ops are still
+  /// prepared for the new shapes. 0 disables the cache.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetArenaPlacementCacheSize(int value) {
+    experimental_arena_placement_cache_size_ = value;
+  }
+
+  /// Returns the number of input shape signatures whose arena placements are
+  /// kept, 0 if the cache is disabled.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetArenaPlacementCacheSize() {
+    return experimental_arena_placement_cache_size_ > 0
+               ? experimental_arena_placement_cache_size_
+               : 0;
+  }
+
+  /// Place the non-persistent tensors of the primary subgraph in `arena`,
+  /// which other interpreters of the process may share, so that the memory of
+  /// models run one after the other follows the largest of them rather than
+  /// their sum. Running an interpreter overwrites the tensors of the others on
+  /// the same arena, so inputs should be set and outputs read right before and
+  /// after `Invoke`. `Invoke` fails while another interpreter runs on the
+  /// arena, and `AllocateTensors` must not run concurrently with them either.
+  /// Must be set before the first `AllocateTensors`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetSharedArena(std::shared_ptr<SharedArenaBuffer> arena) {
+    experimental_shared_arena_ = std::move(arena);
+  }
+
+  /// Returns the arena shared with other interpreters, if any.
+  /// WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<SharedArenaBuffer>& GetSharedArena() const {
+    return experimental_shared_arena_;
+  }
+
   // If value == true, disable delegate clustering (see above), otherwise,
   // enable it.
   // WARNING: This is an experimental API and subject to change.
@@ -103,12 +186,36 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  /// If set to `true`, the constant tensors of a memory-mapped model are
+  /// streamed from the model file instead of being kept in memory: their
+  /// pages are dropped once `AllocateTensors` has prepared the ops and again
+  /// after the last op reading them in each `Invoke`, and the constants of
+  /// the next op are paged in while the current one runs. This lets models
+  /// larger than the available memory run, at the cost of reading their
+  /// weights from storage on every `Invoke`. Has no effect on models that are
+  /// not memory-mapped.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetStreamConstantTensors(bool value) {
+    experimental_stream_constant_tensors_ = value;
+  }
+
+  /// Returns whether the constant tensors of the model are streamed.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetStreamConstantTensors() const {
+    return experimental_stream_constant_tensors_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  bool experimental_optimize_arena_placement_ = false;
+  int experimental_max_parallel_branches_ = 1;
+  int experimental_arena_placement_cache_size_ = 0;
+  std::shared_ptr<SharedArenaBuffer> experimental_shared_arena_;
+  bool experimental_stream_constant_tensors_ = false;
 };
 
 }  // namespace tflite
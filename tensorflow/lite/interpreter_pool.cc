@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+
+struct InterpreterPool::Instance {
+  // The delegate is declared first so that it outlives the interpreter.
+  Interpreter::TfLiteDelegatePtr delegate{nullptr, [](TfLiteDelegate*) {}};
+  std::unique_ptr<Interpreter> interpreter;
+};
+
+InterpreterPool::Lease::Lease(InterpreterPool* pool,
+                              std::unique_ptr<Instance> instance)
+    : pool_(pool), instance_(std::move(instance)) {}
+
+InterpreterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), instance_(std::move(other.instance_)) {}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(
+    Lease&& other) noexcept {
+  if (this != &other) {
+    if (instance_) pool_->Release(std::move(instance_));
+    pool_ = other.pool_;
+    instance_ = std::move(other.instance_);
+  }
+  return *this;
+}
+
+InterpreterPool::Lease::~Lease() {
+  if (instance_) pool_->Release(std::move(instance_));
+}
+
+Interpreter* InterpreterPool::Lease::interpreter() const {
+  return instance_ ? instance_->interpreter.get() : nullptr;
+}
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options) {
+  std::unique_ptr<InterpreterPool> pool(
+      new InterpreterPool(model, op_resolver, options));
+  if (options.use_xnnpack && !pool->weights_cache_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Failed to create the XNNPACK weights cache.");
+    return nullptr;
+  }
+  Lease lease = pool->Acquire();
+  if (!lease) return nullptr;
+  // The first interpreter packed all the weights. Later interpreters only hit
+  // the cache, so the spare space it keeps for insertions is all it needs.
+  if (pool->weights_cache_ &&
+      !TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(
+          pool->weights_cache_.get())) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Failed to finalize the XNNPACK weights cache.");
+    return nullptr;
+  }
+  return pool;
+}
+
+InterpreterPool::InterpreterPool(const FlatBufferModel& model,
+                                 const OpResolver& op_resolver,
+                                 const Options& options)
+    : model_(model), op_resolver_(op_resolver), options_(options) {
+  if (options_.use_xnnpack) {
+    weights_cache_.reset(TfLiteXNNPackDelegateWeightsCacheCreate());
+  }
+}
+
+InterpreterPool::~InterpreterPool() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<int>(idle_instances_.size()) != num_instances_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool destroyed with leased interpreters.");
+  }
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (idle_instances_.empty() && options_.max_interpreters > 0 &&
+           num_instances_ >= options_.max_interpreters) {
+      instance_released_.wait(lock);
+    }
+    if (!idle_instances_.empty()) {
+      std::unique_ptr<Instance> instance = std::move(idle_instances_.back());
+      idle_instances_.pop_back();
+      return Lease(this, std::move(instance));
+    }
+    ++num_instances_;
+  }
+  std::unique_ptr<Instance> instance = NewInstance();
+  if (!instance) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_instances_;
+    instance_released_.notify_one();
+    return Lease();
+  }
+  return Lease(this, std::move(instance));
+}
+
+int InterpreterPool::num_interpreters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_instances_;
+}
+
+std::unique_ptr<InterpreterPool::Instance> InterpreterPool::NewInstance() {
+  std::lock_guard<std::mutex> lock(build_mutex_);
+  auto instance = std::make_unique<Instance>();
+  InterpreterBuilder builder(model_, op_resolver_);
+  if (builder.SetNumThreads(options_.num_threads) != kTfLiteOk ||
+      builder(&instance->interpreter) != kTfLiteOk || !instance->interpreter) {
+    return nullptr;
+  }
+  if (options_.use_xnnpack) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    xnnpack_options.num_threads = options_.num_threads;
+    xnnpack_options.weights_cache = weights_cache_.get();
+    instance->delegate = Interpreter::TfLiteDelegatePtr(
+        TfLiteXNNPackDelegateCreate(&xnnpack_options),
+        TfLiteXNNPackDelegateDelete);
+    if (!instance->delegate ||
+        instance->interpreter->ModifyGraphWithDelegate(
+            instance->delegate.get()) != kTfLiteOk) {
+      return nullptr;
+    }
+  }
+  if (instance->interpreter->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return instance;
+}
+
+void InterpreterPool::Release(std::unique_ptr<Instance> instance) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_instances_.push_back(std::move(instance));
+  instance_released_.notify_one();
+}
+
+}  // namespace tflite
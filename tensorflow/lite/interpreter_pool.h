@@ -0,0 +1,147 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace tflite {
+
+/// A pool of interpreters of one model, for running it from several threads
+/// at once.
+///
+/// An `Interpreter` is not reentrant, so each concurrent invocation needs its
+/// own. The interpreters of a pool are built lazily and reused, and they only
+/// own their tensors and arenas: they all read the weights from the buffer of
+/// the shared model, and with XNNPACK enabled they share one weights cache,
+/// so that the weights are packed once for the whole pool instead of once per
+/// interpreter.
+///
+/// Usage:
+///
+/// <pre><code>
+/// tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+/// auto pool = tflite::InterpreterPool::Create(
+///     *model, resolver, tflite::InterpreterPool::Options());
+/// // On any thread:
+/// tflite::InterpreterPool::Lease lease = pool->Acquire();
+/// if (!lease) return kTfLiteError;
+/// // Fill the inputs of lease->..., then:
+/// lease->Invoke();
+/// </code></pre>
+///
+/// The op resolver should not apply the default XNNPACK delegate, as the pool
+/// applies its own. `model` and `op_resolver` must outlive the pool, and all
+/// leases must be returned before the pool is destroyed.
+///
+/// WARNING: This is an experimental API and subject to change.
+class InterpreterPool {
+ public:
+  struct Options {
+    /// The number of threads each interpreter runs its ops with.
+    int num_threads = 1;
+    /// Whether the interpreters are delegated to XNNPACK, with one weights
+    /// cache shared by all of them.
+    bool use_xnnpack = true;
+    /// The maximum number of interpreters of the pool, or 0 for no limit.
+    /// `Acquire` waits for a lease to be returned when the limit is reached.
+    int max_interpreters = 0;
+  };
+
+ private:
+  struct Instance;
+
+ public:
+  /// An interpreter of the pool, returned to the pool when the lease is
+  /// destroyed.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    ~Lease();
+
+    /// Returns false if no interpreter could be built.
+    explicit operator bool() const { return instance_ != nullptr; }
+
+    Interpreter* interpreter() const;
+    Interpreter* operator->() const { return interpreter(); }
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, std::unique_ptr<Instance> instance);
+
+    InterpreterPool* pool_ = nullptr;
+    std::unique_ptr<Instance> instance_;
+  };
+
+  /// Creates a pool for `model`, and builds its first interpreter so that
+  /// errors in the model are reported here. Returns nullptr on failure.
+  static std::unique_ptr<InterpreterPool> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options);
+
+  ~InterpreterPool();
+
+  /// Returns an idle interpreter of the pool, building a new one if there is
+  /// none. The lease is empty if the interpreter could not be built.
+  /// Thread-safe.
+  Lease Acquire();
+
+  /// Returns the number of interpreters built by the pool.
+  int num_interpreters() const;
+
+ private:
+  struct WeightsCacheDeleter {
+    void operator()(TfLiteXNNPackDelegateWeightsCache* cache) const {
+      TfLiteXNNPackDelegateWeightsCacheDelete(cache);
+    }
+  };
+
+  InterpreterPool(const FlatBufferModel& model, const OpResolver& op_resolver,
+                  const Options& options);
+
+  // Builds and prepares a new interpreter. Returns nullptr on failure.
+  std::unique_ptr<Instance> NewInstance();
+
+  void Release(std::unique_ptr<Instance> instance);
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  const Options options_;
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache, WeightsCacheDeleter>
+      weights_cache_;
+
+  // Serializes the building of interpreters, which fills the weights cache.
+  std::mutex build_mutex_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable instance_released_;
+  std::vector<std::unique_ptr<Instance>> idle_instances_;
+  // The number of interpreters built or being built.
+  int num_instances_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTERPRETER_POOL_H_
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <cstddef>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+
+namespace tflite {
+namespace {
+
+constexpr size_t kTensorSize = 1 * 8 * 8 * 3;
+
+// multi_add.bin computes out0 = in0 + (in1 + in2) and out1 = (in1 + in2) + in3.
+void InvokeMultiAdd(Interpreter* interpreter, float scale) {
+  for (size_t i = 0; i < interpreter->inputs().size(); ++i) {
+    TfLiteTensor* tensor = interpreter->tensor(interpreter->inputs()[i]);
+    ASSERT_EQ(tensor->bytes, kTensorSize * sizeof(float));
+    for (size_t j = 0; j < kTensorSize; ++j) {
+      tensor->data.f[j] = scale * (i + 1);
+    }
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const TfLiteTensor* out0 = interpreter->tensor(interpreter->outputs()[0]);
+  const TfLiteTensor* out1 = interpreter->tensor(interpreter->outputs()[1]);
+  for (size_t j = 0; j < kTensorSize; ++j) {
+    EXPECT_FLOAT_EQ(out0->data.f[j], 6 * scale);
+    EXPECT_FLOAT_EQ(out1->data.f[j], 9 * scale);
+  }
+}
+
+class InterpreterPoolTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_add.bin");
+    ASSERT_TRUE(model_);
+  }
+
+  InterpreterPool::Options options() const {
+    InterpreterPool::Options options;
+    options.use_xnnpack = GetParam();
+    return options;
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+};
+
+TEST_P(InterpreterPoolTest, ReusesReleasedInterpreters) {
+  auto pool = InterpreterPool::Create(*model_, resolver_, options());
+  ASSERT_TRUE(pool);
+  EXPECT_EQ(pool->num_interpreters(), 1);
+
+  Interpreter* first;
+  {
+    InterpreterPool::Lease lease = pool->Acquire();
+    ASSERT_TRUE(lease);
+    first = lease.interpreter();
+    InvokeMultiAdd(first, 1.0f);
+  }
+  InterpreterPool::Lease lease = pool->Acquire();
+  EXPECT_EQ(lease.interpreter(), first);
+  EXPECT_EQ(pool->num_interpreters(), 1);
+
+  InterpreterPool::Lease other = pool->Acquire();
+  ASSERT_TRUE(other);
+  EXPECT_NE(other.interpreter(), first);
+  EXPECT_EQ(pool->num_interpreters(), 2);
+  InvokeMultiAdd(other.interpreter(), 2.0f);
+}
+
+TEST_P(InterpreterPoolTest, RunsConcurrentInvocations) {
+  InterpreterPool::Options pool_options = options();
+  pool_options.max_interpreters = 2;
+  auto pool = InterpreterPool::Create(*model_, resolver_, pool_options);
+  ASSERT_TRUE(pool);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, t] {
+      for (int i = 0; i < 10; ++i) {
+        InterpreterPool::Lease lease = pool->Acquire();
+        ASSERT_TRUE(lease);
+        InvokeMultiAdd(lease.interpreter(), t + i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(pool->num_interpreters(), 2);
+}
+
+INSTANTIATE_TEST_SUITE_P(InterpreterPoolTest, InterpreterPoolTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace tflite
@@ -310,6 +310,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // TF_LITE_ENSURE_EQ(context, input->type, params->in_data_type);
   // TF_LITE_ENSURE_EQ(context, output->type, params->out_data_type);
 
+  // Values computed during Prepare, such as shapes, are cast immediately, so
+  // that the ops consuming them can size their outputs. Constant inputs are
+  // left to ShouldCacheOutput(), as they may be large.
+  if (input->allocation_type == kTfLitePersistentRo) {
+    SetTensorToPersistentRo(output);
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, output,
+                                            TfLiteIntArrayCopy(input->dims)));
+    return EvalImpl(context, input, output, NumElements(input));
+  }
+
   if (ShouldCacheOutput(context, input)) {
     output->allocation_type = kTfLiteArenaRwPersistent;
   }
@@ -327,6 +338,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
+  if (output->allocation_type == kTfLitePersistentRo) {
+    // Output is computed in Prepare.
+    return kTfLiteOk;
+  }
   const int num_elements = NumElements(input);
   TF_LITE_ENSURE_EQ(context, num_elements, NumElements(output));
 
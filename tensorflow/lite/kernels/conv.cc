@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -1190,6 +1191,70 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Runs a 1x1 convolution with block-sparse weights as a fully connected layer
+// over all the pixels of the input. Other convolutions can't use sparse
+// weights.
+TfLiteStatus EvalSparse(TfLiteContext* context, TfLiteConvParams* params,
+                        OpData* data, const TfLiteTensor* input,
+                        const TfLiteTensor* filter, const TfLiteTensor* bias,
+                        TfLiteTensor* output) {
+  optimized_ops::SparseWeightBlocks blocks;
+  if (SizeOfDimension(filter, 1) != 1 || SizeOfDimension(filter, 2) != 1 ||
+      params->stride_height != 1 || params->stride_width != 1 ||
+      data->groups != 1 ||
+      !optimized_ops::GetSparseWeightBlocks(*filter->sparsity, &blocks)) {
+    TF_LITE_KERNEL_LOG(context,
+                       "Sparse weights are only supported for 1x1 "
+                       "convolutions with a stride of 1 and no groups.");
+    return kTfLiteError;
+  }
+  const int output_depth = SizeOfDimension(filter, 0);
+  const int input_depth = SizeOfDimension(filter, 3);
+  const int batches = NumElements(input) / input_depth;
+  FullyConnectedParams op_params;
+  switch (input->type) {
+    case kTfLiteFloat32: {
+      TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteFloat32);
+      TF_LITE_ENSURE(context, optimized_ops::VerifySparseWeightBlocks(
+                                  blocks, output_depth, input_depth,
+                                  filter->bytes / sizeof(float)));
+      CalculateActivationRange(params->activation,
+                               &op_params.float_activation_min,
+                               &op_params.float_activation_max);
+      optimized_ops::FullyConnectedSparseWeightBlock(
+          blocks, op_params, batches, input_depth, output_depth,
+          GetTensorData<float>(input), GetTensorData<float>(filter),
+          /*per_channel_multiplier=*/nullptr, /*per_channel_shift=*/nullptr,
+          GetTensorData<float>(bias), GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
+      return kTfLiteOk;
+    }
+    case kTfLiteInt8: {
+      TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteInt8);
+      TF_LITE_ENSURE(context, optimized_ops::VerifySparseWeightBlocks(
+                                  blocks, output_depth, input_depth,
+                                  filter->bytes));
+      op_params.input_offset = -input->params.zero_point;
+      op_params.output_offset = output->params.zero_point;
+      op_params.quantized_activation_min = data->output_activation_min;
+      op_params.quantized_activation_max = data->output_activation_max;
+      optimized_ops::FullyConnectedSparseWeightBlock(
+          blocks, op_params, batches, input_depth, output_depth,
+          GetTensorData<int8_t>(input), GetTensorData<int8_t>(filter),
+          data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), GetTensorData<int32_t>(bias),
+          GetTensorData<int8_t>(output),
+          CpuBackendContext::GetFromContext(context));
+      return kTfLiteOk;
+    }
+    default:
+      TF_LITE_KERNEL_LOG(context,
+                         "Sparse weights are not supported for type %s.",
+                         TfLiteTypeGetName(input->type));
+      return kTfLiteError;
+  }
+}
+
 template <KernelType kernel_type, TfLiteType input_type>
 TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -1203,6 +1268,9 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 1, &filter));
   bool has_bias = node->inputs->size == 3;
   const TfLiteTensor* bias = has_bias ? GetInput(context, node, 2) : nullptr;
+  if (filter->sparsity != nullptr) {
+    return EvalSparse(context, params, data, input, filter, bias, output);
+  }
   TfLiteTensor* im2col =
       data->need_im2col
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
@@ -883,6 +883,76 @@ TEST_P(ConvolutionOpTest, SimpleTestFloatWithDilation) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({5, 5, 5, 5, 5, 5, 5, 5, 5}));
 }
 
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           int num_threads) {
+    input_ = AddInput(input);
+    filter_ = AddConstSparseInput(filter, filter_data);
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, /*stride_w=*/1,
+                                     /*stride_h=*/1)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                   registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(ConvolutionOpTest, SparsePointwiseFloat32) {
+  const std::vector<float> filter_data = {
+      1, 2, 3, 4, 1,  0,  0,  1,   // out channel 0
+      5, 6, 7, 8, 0,  0,  0,  0,   // out channel 1
+      1, 1, 1, 1, 0,  0,  0,  0,   // out channel 2
+      2, 2, 2, 2, 0,  0,  0,  0,   // out channel 3
+      0, 0, 0, 0, 1,  -1, 1,  -1,  // out channel 4
+      0, 0, 0, 0, 2,  0,  -2, 0,   // out channel 5
+      0, 0, 0, 0, 1,  2,  3,  4,   // out channel 6
+      0, 0, 0, 0, -1, -1, -1, -1,  // out channel 7
+  };
+  TensorData filter = {TensorType_FLOAT32, {8, 1, 1, 8}};
+  filter.traversal_order = {0, 1, 2, 3, 4, 5};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {0, 3};
+  filter.block_size = {4, 4};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseConvolutionOpModel m(GetRegistration(),
+                               {TensorType_FLOAT32, {1, 1, 2, 8}}, filter,
+                               filter_data, num_threads);
+    m.SetInput({
+        1,  2, 3, 4, 5,  6, 7, 8,  // pixel 0
+        -1, 0, 1, 0, -1, 0, 1, 0,  // pixel 1
+    });
+    m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                   44, 72, 13, 24, 3, 2, 77, -18,  // pixel 0
+                                   2, 4, 3, 4, 5, 2, 9, 8,         // pixel 1
+                               }));
+  }
+}
+
 class QuantizedConvolutionOpModel : public BaseConvolutionOpModel<uint8_t> {
  public:
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 
 #include "pthreadpool.h"  // from @pthreadpool
@@ -26,6 +28,7 @@ limitations under the License.
 #include "public/gemmlowp.h"
 #include "ruy/context.h"  // from @ruy
 #include "ruy/path.h"  // from @ruy
+#include "ruy/thread_pool.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
@@ -81,6 +84,23 @@ bool CpuBackendContext::CpuInfo::Avx512() {
          cpuinfo_has_x86_avx512dq() && cpuinfo_has_x86_avx512cd() &&
          cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl();
 }
+
+int CpuBackendContext::CpuInfo::NumFastestCores() {
+  if (!EnsureInitialized()) return 0;
+  uint64_t max_frequency = 0;
+  int num_fastest_cores = 0;
+  for (uint32_t i = 0; i < cpuinfo_get_clusters_count(); ++i) {
+    const cpuinfo_cluster* cluster = cpuinfo_get_cluster(i);
+    if (cluster->frequency > max_frequency) {
+      max_frequency = cluster->frequency;
+      num_fastest_cores = cluster->core_count;
+    } else if (cluster->frequency == max_frequency) {
+      num_fastest_cores += cluster->core_count;
+    }
+  }
+  // Frequencies are unknown on some platforms.
+  return max_frequency > 0 ? num_fastest_cores : 0;
+}
 #else
 
 CpuBackendContext::CpuInfo::~CpuInfo() {}
@@ -98,6 +118,8 @@ bool CpuBackendContext::CpuInfo::Avx2Fma() { return false; }
 bool CpuBackendContext::CpuInfo::Avx() { return false; }
 
 bool CpuBackendContext::CpuInfo::Avx512() { return false; }
+
+int CpuBackendContext::CpuInfo::NumFastestCores() { return 0; }
 #endif  // TFLITE_HAVE_CPUINFO
 
 CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
@@ -140,13 +162,37 @@ CpuBackendContext::CpuBackendContext()
 CpuBackendContext::~CpuBackendContext() {}
 
 void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
-  const int target_num_threads =
+  requested_num_threads_ =
       max_num_threads > -1 ? max_num_threads : kDefaultNumThreadpoolThreads;
+  int target_num_threads = requested_num_threads_;
+  if (limit_threads_to_fastest_cores_) {
+    const int num_fastest_cores = cpuinfo_.NumFastestCores();
+    if (num_fastest_cores > 0) {
+      target_num_threads = std::min(target_num_threads, num_fastest_cores);
+    }
+  }
   max_num_threads_ = target_num_threads;
   ruy_context_->set_max_num_threads(target_num_threads);
   gemmlowp_context_->set_max_num_threads(target_num_threads);
 }
 
+int CpuBackendContext::ThreadCountForWork(int64_t work,
+                                          int64_t min_work_per_thread) const {
+  if (min_work_per_thread <= 0) return max_num_threads_;
+  const int64_t thread_count = work / min_work_per_thread;
+  return static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(thread_count, max_num_threads_)));
+}
+
+void CpuBackendContext::SetLimitThreadsToFastestCores(bool flag) {
+  limit_threads_to_fastest_cores_ = flag;
+  SetMaxNumThreads(requested_num_threads_);
+}
+
+void CpuBackendContext::SetWorkerSpinMilliseconds(float milliseconds) {
+  ruy_context_->mutable_thread_pool()->set_spin_milliseconds(milliseconds);
+}
+
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
 pthreadpool_t CpuBackendContext::get_xnnpack_threadpool() {
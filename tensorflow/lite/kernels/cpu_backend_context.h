@@ -21,6 +21,7 @@ limitations under the License.
 #define TFLITE_X86_PLATFORM
 #endif
 
+#include <cstdint>
 #include <memory>
 
 #include "public/gemmlowp.h"
@@ -50,6 +51,27 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   int max_num_threads() const { return max_num_threads_; }
 
+  // Returns how many threads an op should split `work` units of it into, e.g.
+  // FLOPs or output elements, so that each thread gets at least
+  // `min_work_per_thread` of them: small ops then run on fewer threads than
+  // max_num_threads(), which would cost more to wake up than they save.
+  int ThreadCountForWork(int64_t work, int64_t min_work_per_thread) const;
+
+  // Caps the number of threads to the cores of the fastest cluster on
+  // heterogeneous (e.g. big.LITTLE) CPUs, so that multithreaded ops are not
+  // paced by their tasks on the slow cores. Has no effect when the cores can
+  // not be told apart.
+  void SetLimitThreadsToFastestCores(bool flag);
+
+  bool limit_threads_to_fastest_cores() const {
+    return limit_threads_to_fastest_cores_;
+  }
+
+  // Sets how long the ruy worker threads busy-wait for new work before they
+  // sleep. Busy-waiting lowers the latency of back-to-back multithreaded ops
+  // at the cost of power; 0 makes the workers sleep right away.
+  void SetWorkerSpinMilliseconds(float milliseconds);
+
   void SetUseCaching(bool flag);
 
   bool use_caching() const { return use_caching_; }
@@ -76,6 +98,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
     bool Avx2Fma();
     bool Avx512();
 
+    // Returns the number of cores with the highest frequency, or 0 if this
+    // can not be determined.
+    int NumFastestCores();
+
    private:
     enum class InitStatus {
       kNotYetAttempted,
@@ -111,6 +137,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // This value also gets propagated to back-ends, where it plays the same
   // information-only role.
   int max_num_threads_;
+  // The number of threads requested by SetMaxNumThreads, before it was capped
+  // to the fastest cores.
+  int requested_num_threads_;
+  bool limit_threads_to_fastest_cores_ = false;
   // For matrix muliplications with constants parameters (i.e. weights), we can
   // sometimes provide speedups by caching the "prepacked" data, for some
   // additional memory cost. This flag permits the user to route all
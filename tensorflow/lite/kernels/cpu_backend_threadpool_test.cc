@@ -89,6 +89,15 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+TEST(CpuBackendThreadpoolTest, ThreadCountForWork) {
+  CpuBackendContext context;
+  context.SetMaxNumThreads(4);
+  EXPECT_EQ(context.ThreadCountForWork(0, 1024), 1);
+  EXPECT_EQ(context.ThreadCountForWork(1023, 1024), 1);
+  EXPECT_EQ(context.ThreadCountForWork(3 * 1024, 1024), 3);
+  EXPECT_EQ(context.ThreadCountForWork(100 * 1024, 1024), 4);
+}
+
 }  // namespace
 
 }  // namespace tflite
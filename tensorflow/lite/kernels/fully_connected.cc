@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -173,6 +174,8 @@ constexpr int kQuantizedInputTensor = 0;
 constexpr int kScalingFactorsTensor = 1;
 constexpr int kAccumulatorTensor = 2;
 constexpr int kInputOffsetsTensor = 3;
+// Only used by the per-group 4bit kernel, which has no row sums.
+constexpr int kGroupInputTensor = 4;
 
 inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                const TfLiteTensor* input,
@@ -186,6 +189,11 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
   const bool is_shuffled =
       is_quantized && (params->weights_format ==
                        kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8);
+  if (params->weights_format ==
+      kTfLiteFullyConnectedWeightsFormatPacked4x32Int4) {
+    TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteInt4);
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+  }
 
   // optional bias tensor.
   const bool is_optional_bias_float = !bias || (bias->type == kTfLiteFloat32);
@@ -266,9 +274,32 @@ TfLiteStatus UpdateOutputSize(TfLiteContext* context,
   return context->ResizeTensor(context, output, output_size_array);
 }
 
+// Returns the number of groups of columns per row of a per-group quantized
+// 4bit filter, whose scales are laid out as (num_units, num_groups), or 1 if
+// the filter has a scale per tensor or per row.
+int GetNumFilterGroups(const TfLiteTensor* filter) {
+  if (filter->type != kTfLiteInt4 ||
+      filter->quantization.type != kTfLiteAffineQuantization) {
+    return 1;
+  }
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  if (!affine_quantization || !affine_quantization->scale ||
+      affine_quantization->quantized_dimension != 0) {
+    return 1;
+  }
+  const int num_units = filter->dims->data[0];
+  const int num_scales = affine_quantization->scale->size;
+  if (num_scales <= num_units || num_scales % num_units != 0) {
+    return 1;
+  }
+  return num_scales / num_units;
+}
+
 TfLiteStatus PrepareImpl4Bit(TfLiteContext* context, TfLiteNode* node,
                              int lhs_width, int rhs_width, int depth,
-                             int batch_size, int cols, int output_depth) {
+                             int batch_size, int cols, int output_depth,
+                             int group_size) {
   const int units = output_depth;
   const int lhs_layout_cols =
       (cols + (optimized_4bit::FilterDepth - 1)) & ~(depth - 1);
@@ -342,6 +373,24 @@ TfLiteStatus PrepareImpl4Bit(TfLiteContext* context, TfLiteNode* node,
                                                      input_offsets_size));
   }
 
+  if (group_size > 0) {
+    // The columns of the input that every group of the filter applies to.
+    TfLiteTensor* group_input;
+    TF_LITE_ENSURE_OK(
+        context,
+        GetTemporarySafe(context, node, kGroupInputTensor, &group_input));
+    group_input->type = kTfLiteFloat32;
+    group_input->allocation_type = kTfLiteArenaRw;
+    const int group_input_dims[2] = {batch_size, group_size};
+    if (!TfLiteIntArrayEqualsArray(group_input->dims, 2, group_input_dims)) {
+      TfLiteIntArray* group_input_size = TfLiteIntArrayCreate(2);
+      group_input_size->data[0] = group_input_dims[0];
+      group_input_size->data[1] = group_input_dims[1];
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, group_input,
+                                                       group_input_size));
+    }
+  }
+
   const TfLiteTensor* input;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
   TfLiteTensor* output;
@@ -362,8 +411,10 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
   TF_LITE_ENSURE(context, node->inputs->size == 2 || node->inputs->size == 3);
   // Shuffled formats need a workspace to store the shuffled input activations.
   const int expected_outputs_count =
-      params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault ? 1
-                                                                          : 2;
+      params->weights_format ==
+              kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8
+          ? 2
+          : 1;
   TF_LITE_ENSURE_EQ(context, node->outputs->size, expected_outputs_count);
 
   const TfLiteTensor* input;
@@ -511,13 +562,29 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         filter->type == kTfLiteInt4));
   const bool is_sparse = filter->sparsity != nullptr;
   if (is_hybrid) {
+    const int num_groups = GetNumFilterGroups(filter);
+    const int group_size =
+        num_groups > 1 && batch_size ? input_size / batch_size / num_groups : 0;
+    // Groups must start at a block of the packed filter.
+    const bool groups_supported =
+        num_groups == 1 ||
+        (group_size * num_groups * batch_size == input_size &&
+         group_size % optimized_4bit::FilterDepth == 0);
     // Use optimized implementation for 4bit
     if (filter->type == kTfLiteInt4 && kernel_type == kGenericOptimized &&
         IsConstantTensor(filter) && batch_size &&
         ((input_size / batch_size) % 2 == 0) &&
         num_units >= optimized_4bit::FilterWidth &&
-        (input_size / batch_size) >= optimized_4bit::FilterDepth) {
+        (input_size / batch_size) >= optimized_4bit::FilterDepth &&
+        groups_supported) {
       const int cols = input_size / batch_size;
+      // Prepacked filters have the size of their packed layout.
+      if (params->weights_format ==
+          kTfLiteFullyConnectedWeightsFormatPacked4x32Int4) {
+        TF_LITE_ENSURE(context,
+                       num_units % optimized_4bit::FilterWidth == 0 &&
+                           cols % optimized_4bit::FilterDepth == 0);
+      }
       if (!data->op_data_4bit) {
         data->op_data_4bit = std::make_unique<optimized_4bit::OpData4Bit>();
       }
@@ -525,6 +592,8 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteOk;
       }
       data->op_data_4bit->batch_size = batch_size;
+      data->op_data_4bit->group_size = group_size;
+      data->op_data_4bit->num_groups = num_groups;
       for (int packed_rows = optimized_4bit::GetMaxSupportedRows();
            packed_rows > 0; packed_rows /= 2) {
         if (batch_size >= packed_rows) {
@@ -535,7 +604,22 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
       return PrepareImpl4Bit(context, node, optimized_4bit::FilterWidth,
                              data->op_data_4bit->rows_right,
                              optimized_4bit::FilterDepth, batch_size, cols,
-                             num_units);
+                             num_units, group_size);
+    }
+    if (params->weights_format ==
+        kTfLiteFullyConnectedWeightsFormatPacked4x32Int4) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Prepacked 4bit filters are only supported by the "
+                         "optimized 4bit kernel.");
+      return kTfLiteError;
+    }
+    if (num_groups > 1) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Per-group quantized filters are only supported by "
+                         "the optimized 4bit kernel, with groups of a "
+                         "multiple of %d columns.",
+                         optimized_4bit::FilterDepth);
+      return kTfLiteError;
     }
     TfLiteIntArrayFree(node->temporaries);
     data->compute_row_sums = true;
@@ -965,20 +1049,60 @@ TfLiteStatus EvalHybridDense4Bit(
   const int rhs_layout_cols = lhs_layout_cols;
   const int dst_layout_rows = rhs_layout_rows;
   const int dst_layout_cols = lhs_layout_rows;
+  const int group_size = data->op_data_4bit->group_size;
   if (data->op_data_4bit->needs_prepack) {
     const int weight_size = lhs_layout_rows * lhs_layout_cols / 2;
-    const int required_size =
-        optimized_4bit::kDefaultAlignmentPadding + weight_size;
-    data->op_data_4bit->AllocatePackedRegion(required_size);
     const int8_t* weight_ptr = GetTensorData<int8_t>(filter);
-    optimized_4bit::api::Prepack(data->op_data_4bit->prepacked_cache,
-                                 weight_ptr, lhs_layout_rows, lhs_layout_cols,
-                                 output_depth, cols, lhs_width, depth);
+    const bool is_prepacked =
+        params->weights_format ==
+        kTfLiteFullyConnectedWeightsFormatPacked4x32Int4;
+    // Filters prepacked by the converter are used from the model file, or
+    // copied if their buffer isn't aligned for the kernels.
+    const bool in_place =
+        is_prepacked && reinterpret_cast<uintptr_t>(weight_ptr) %
+                                optimized_4bit::kPrepackedFilterAlignment ==
+                            0;
+    if (in_place) {
+      data->op_data_4bit->prepacked_cache =
+          reinterpret_cast<uint8_t*>(const_cast<int8_t*>(weight_ptr));
+    } else {
+      const int required_size =
+          optimized_4bit::kDefaultAlignmentPadding + weight_size;
+      data->op_data_4bit->AllocatePackedRegion(required_size);
+    }
+    if (is_prepacked) {
+      if (!in_place) {
+        memcpy(data->op_data_4bit->prepacked_cache, weight_ptr, weight_size);
+      }
+    } else if (group_size > 0) {
+      optimized_4bit::api::PrepackPerGroup(
+          data->op_data_4bit->prepacked_cache, weight_ptr, lhs_layout_rows,
+          output_depth, cols, group_size, lhs_width, depth);
+    } else {
+      optimized_4bit::api::Prepack(data->op_data_4bit->prepacked_cache,
+                                   weight_ptr, lhs_layout_rows,
+                                   lhs_layout_cols, output_depth, cols,
+                                   lhs_width, depth);
+    }
+    if (group_size > 0) {
+      const int num_groups = data->op_data_4bit->num_groups;
+      const float* scales =
+          reinterpret_cast<TfLiteAffineQuantization*>(
+              filter->quantization.params)
+              ->scale->data;
+      std::vector<float>& group_scales = data->op_data_4bit->group_scales;
+      group_scales.assign(num_groups * lhs_layout_rows, 0.0f);
+      for (int o = 0; o < output_depth; ++o) {
+        for (int g = 0; g < num_groups; ++g) {
+          group_scales[g * lhs_layout_rows + o] = scales[o * num_groups + g];
+        }
+      }
+    }
     data->op_data_4bit->needs_prepack = false;
 #ifdef MADV_PAGEOUT
-    // After prepacking, we will never use the weights from the model file. Mark
-    // them with MADV_PAGEOUT so the kernel can reclaim the pages, decreasing
-    // the resident memory size.
+    // After prepacking, we will never use the weights from the model file,
+    // unless they are used in place. Mark them with MADV_PAGEOUT so the kernel
+    // can reclaim the pages, decreasing the resident memory size.
     //
     // This is Linux specific. There is no effect on other platforms (e.g. on
     // Windows, but possibly other POSIX platforms!). It requires a minimum
@@ -996,10 +1120,58 @@ TfLiteStatus EvalHybridDense4Bit(
         ((reinterpret_cast<uintptr_t>(weight_ptr) + pagesize - 1) / pagesize) *
         pagesize);
     const auto rounding_size = up_aligned_ptr - weight_ptr;
-    madvise(up_aligned_ptr, weight_size - rounding_size, MADV_PAGEOUT);
+    if (!in_place) {
+      madvise(up_aligned_ptr, weight_size - rounding_size, MADV_PAGEOUT);
+    }
 #endif
   }
 
+  if (group_size > 0) {
+    // Accumulate the groups one after the other, each of them being a filter
+    // with a scale per row applied to the matching columns of the input.
+    TfLiteTensor* group_input;
+    TF_LITE_ENSURE_OK(
+        context,
+        GetTemporarySafe(context, node, kGroupInputTensor, &group_input));
+    float* group_input_ptr = GetTensorData<float>(group_input);
+    const float* input_ptr = GetTensorData<float>(input);
+    float* output_ptr = GetTensorData<float>(output);
+    const float* bias_ptr =
+        bias != nullptr ? GetTensorData<float>(bias) : nullptr;
+    int32_t* dst = GetTensorData<int32_t>(accum_scratch);
+    for (int g = 0; g < data->op_data_4bit->num_groups; ++g) {
+      for (int b = 0; b < batch_size; ++b) {
+        memcpy(group_input_ptr + b * group_size,
+               input_ptr + b * cols + g * group_size,
+               group_size * sizeof(float));
+      }
+      float* group_scales =
+          data->op_data_4bit->group_scales.data() + g * lhs_layout_rows;
+      optimized_4bit::api::BatchQuantizeFloats4Bit(
+          group_input_ptr, batch_size, group_size, quant_data,
+          scaling_factors_ptr, rhs_width, depth, input_offset_ptr);
+      if (g == 0) {
+        optimized_4bit::api::AssignBiasAndComputeOffsets(
+            input_offset_ptr, scaling_factors_ptr, group_scales, bias_ptr,
+            output_ptr, output_depth, batch_size);
+      } else {
+        optimized_4bit::api::AccumulateOffsets(
+            input_offset_ptr, scaling_factors_ptr, group_scales, output_ptr,
+            output_depth, batch_size);
+      }
+      const uint8_t* lhs = data->op_data_4bit->prepacked_cache +
+                           g * lhs_layout_rows * group_size / 2;
+      optimized_4bit::api::RunAndUnpack(
+          rhs_width, lhs, quant_data, dst, output_depth, batch_size,
+          lhs_layout_rows, group_size, rhs_layout_rows, group_size,
+          dst_layout_rows, dst_layout_cols, output_ptr, scaling_factors_ptr,
+          group_scales);
+    }
+    tensor_utils::ApplyActivationToVector(output_ptr, batch_size * output_depth,
+                                          params->activation, output_ptr);
+    return kTfLiteOk;
+  }
+
   std::vector<float> filter_scales(lhs_layout_rows, filter->params.scale);
   auto* filter_params =
       reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
@@ -1282,6 +1454,51 @@ bool VerifySparsity(const RuntimeShape& weights_shape,
   return true;
 }
 
+// Runs the block-sparse kernel on float or int8 tensors with `filter` encoded
+// as described by `blocks`.
+template <typename T, typename BiasT>
+TfLiteStatus EvalSparseWeightBlocksImpl(
+    TfLiteContext* context, const optimized_ops::SparseWeightBlocks& blocks,
+    const FullyConnectedParams& op_params, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const int32_t* per_channel_multiplier,
+    const int32_t* per_channel_shift, const TfLiteTensor* bias,
+    TfLiteTensor* output) {
+  const RuntimeShape filter_shape = GetTensorShape(filter);
+  const RuntimeShape output_shape = GetTensorShape(output);
+  const int filter_dims_count = filter_shape.DimensionsCount();
+  const int output_depth = filter_shape.Dims(0);
+  const int input_depth = filter_shape.Dims(filter_dims_count - 1);
+  if (!optimized_ops::VerifySparseWeightBlocks(
+          blocks, output_depth, input_depth, filter->bytes / sizeof(T))) {
+    TF_LITE_KERNEL_LOG(context, "Invalid block-sparse weights.");
+    return kTfLiteError;
+  }
+  const int batches = FlatSizeSkipDim(output_shape,
+                                      output_shape.DimensionsCount() - 1);
+  optimized_ops::FullyConnectedSparseWeightBlock(
+      blocks, op_params, batches, input_depth, output_depth,
+      GetTensorData<T>(input), GetTensorData<T>(filter),
+      per_channel_multiplier, per_channel_shift, GetTensorData<BiasT>(bias),
+      GetTensorData<T>(output), CpuBackendContext::GetFromContext(context));
+  return kTfLiteOk;
+}
+
+TfLiteStatus EvalSparseWeightBlocks(
+    TfLiteContext* context, const optimized_ops::SparseWeightBlocks& blocks,
+    const FullyConnectedParams& op_params, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const int32_t* per_channel_multiplier,
+    const int32_t* per_channel_shift, const TfLiteTensor* bias,
+    TfLiteTensor* output) {
+  if (input->type == kTfLiteFloat32) {
+    return EvalSparseWeightBlocksImpl<float, float>(
+        context, blocks, op_params, input, filter, per_channel_multiplier,
+        per_channel_shift, bias, output);
+  }
+  return EvalSparseWeightBlocksImpl<int8_t, int32_t>(
+      context, blocks, op_params, input, filter, per_channel_multiplier,
+      per_channel_shift, bias, output);
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            TfLiteFullyConnectedParams* params, OpData* data,
@@ -1379,6 +1596,15 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 GetTensorData<int32_t>(bias), output_shape,
                 GetTensorData<int8_t>(output),
                 CpuBackendContext::GetFromContext(context));
+          } else if (optimized_ops::SparseWeightBlocks blocks;
+                     optimized_ops::GetSparseWeightBlocks(sparsity, &blocks)) {
+            TF_LITE_ENSURE_STATUS(EvalSparseWeightBlocks(
+                context, blocks, op_params, input, filter,
+                is_per_channel ? data->per_channel_output_multiplier.data()
+                               : nullptr,
+                is_per_channel ? data->per_channel_output_shift.data()
+                               : nullptr,
+                bias, output));
           } else {
             TF_LITE_KERNEL_LOG(
                 context, "Unsupported sparse fully-connected weight format.");
@@ -1570,6 +1796,13 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (optimized_ops::SparseWeightBlocks blocks;
+                 optimized_ops::GetSparseWeightBlocks(sparsity, &blocks)) {
+        // Block sparse with any other block size, e.g. 4x4 or 8x1.
+        TF_LITE_ENSURE_STATUS(EvalSparseWeightBlocks(
+            context, blocks, op_params, input, filter,
+            /*per_channel_multiplier=*/nullptr,
+            /*per_channel_shift=*/nullptr, bias, output));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -1650,7 +1883,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     case kTfLiteInt4:
-      if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
+      if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault ||
+          params->weights_format ==
+              kTfLiteFullyConnectedWeightsFormatPacked4x32Int4) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
       } else {
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <random>
@@ -21,6 +22,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/lite/kernels/fully_connected.h"
+#include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -32,7 +34,9 @@ class FullyConnected4BitOpModel : public SingleOpModel {
       int units, int batches, const TensorData& input,
       const TensorData& weights, const TensorData& output,
       std::vector<int8_t> weights_initializer, TfLiteRegistration* registration,
-      ActivationFunctionType activation_func = ActivationFunctionType_RELU)
+      ActivationFunctionType activation_func = ActivationFunctionType_RELU,
+      FullyConnectedOptionsWeightsFormat weights_format =
+          FullyConnectedOptionsWeightsFormat_DEFAULT)
       : batches_(batches), units_(units) {
     // Calculate input_size_ from batch and input shape.
     int total_input_size = 1;
@@ -51,12 +55,13 @@ class FullyConnected4BitOpModel : public SingleOpModel {
         weight_data[i / 2] |= (val << 4);
       }
     }
+    if (weights_format == FullyConnectedOptionsWeightsFormat_PACKED4x32INT4) {
+      weight_data = Prepack(weights, weight_data);
+    }
     weights_ =
         AddConstInput<int8_t>(weights, weight_data.data(), weight_data.size());
     bias_ = AddInput({TensorType_FLOAT32, {units_}});
     output_ = AddOutput(output);
-    FullyConnectedOptionsWeightsFormat weights_format =
-        FullyConnectedOptionsWeightsFormat_DEFAULT;
     SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
                  BuiltinOptions_FullyConnectedOptions,
                  CreateFullyConnectedOptions(builder_, activation_func,
@@ -65,7 +70,36 @@ class FullyConnected4BitOpModel : public SingleOpModel {
     resolver_ = std::make_unique<SingleOpResolver>(
         BuiltinOperator_FULLY_CONNECTED, registration);
     BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
-    SetUnitScale();
+    if (!weights.per_channel_quantization) {
+      SetUnitScale();
+    }
+  }
+
+  // Packs the filter the way the converter does for the PACKED4x32INT4 format.
+  std::vector<int8_t> Prepack(const TensorData& weights,
+                              const std::vector<int8_t>& weight_data) {
+    const int rows = weights.shape[0];
+    const int cols = weights.shape[1];
+    const int num_groups =
+        weights.per_channel_quantization
+            ? weights.per_channel_quantization_scales.size() / rows
+            : 1;
+    optimized_4bit::OpData4Bit packed;
+    packed.AllocatePackedRegion(optimized_4bit::kDefaultAlignmentPadding +
+                                weight_data.size());
+    if (num_groups > 1) {
+      optimized_4bit::api::PrepackPerGroup(
+          packed.prepacked_cache, weight_data.data(), rows, rows, cols,
+          cols / num_groups, optimized_4bit::FilterWidth,
+          optimized_4bit::FilterDepth);
+    } else {
+      optimized_4bit::api::Prepack(packed.prepacked_cache, weight_data.data(),
+                                   rows, cols, rows, cols,
+                                   optimized_4bit::FilterWidth,
+                                   optimized_4bit::FilterDepth);
+    }
+    return std::vector<int8_t>(packed.prepacked_cache,
+                               packed.prepacked_cache + weight_data.size());
   }
 
   void SetUnitScale() {
@@ -250,4 +284,150 @@ INSTANTIATE_TEST_SUITE_P(Hybrid4BitFullyConnectedVsReferenceOpTests,
                              std::make_tuple(4, 1, 48),
                              std::make_tuple(4, 1, 120),
                          }));
+std::uniform_real_distribution<float> scale_dist(0.5f, 1.5f);
+std::uniform_int_distribution<int32_t> input_dist(-127, 127);
+
+class Hybrid4BitPerGroupFullyConnectedOpTests
+    : public ::testing::TestWithParam<::testing::tuple<int, int, int, int>> {};
+
+TEST_P(Hybrid4BitPerGroupFullyConnectedOpTests, TestHybridInt4PerGroup) {
+  auto params = GetParam();
+  int units = std::get<0>(params);
+  int batches = std::get<1>(params);
+  int cols = std::get<2>(params);
+  int group_size = std::get<3>(params);
+  int num_groups = cols / group_size;
+  std::vector<int8_t> weight_data(units * cols, 0);
+  std::vector<float> scales(units * num_groups);
+  std::vector<float> input_data(batches * cols, 0);
+  std::vector<float> bias_data(units, 0);
+  for (int i = 0; i < units * cols; ++i) {
+    weight_data[i] = int_dist(random_engine);
+  }
+  for (int i = 0; i < units * num_groups; ++i) {
+    scales[i] = scale_dist(random_engine);
+  }
+  // Each group of each batch holds a value of magnitude 1, so that the
+  // inputs are quantized exactly.
+  for (int i = 0; i < batches * cols; ++i) {
+    input_data[i] =
+        i % group_size == 0 ? 1.0f : input_dist(random_engine) / 127.0f;
+  }
+  for (int i = 0; i < units; ++i) {
+    bias_data[i] = real_dist(random_engine);
+  }
+  FullyConnected4BitOpModel test(
+      units, batches,
+      /*input=*/{TensorType_FLOAT32, {batches, cols}},
+      /*weights=*/
+      {TensorType_INT4,
+       {units, cols},
+       0.0,
+       0.0,
+       0.0,
+       0,
+       /*per_channel_quantization=*/true,
+       scales,
+       std::vector<int64_t>(scales.size(), 0),
+       /*channel_index=*/0},
+      /*output=*/{TensorType_FLOAT32, {units, batches}}, weight_data,
+      ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT(),
+      ActivationFunctionType_RELU);
+  test.SetBias(bias_data);
+  test.SetInput(input_data);
+  ASSERT_EQ(test.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected_data(batches * units);
+  for (int b = 0; b < batches; ++b) {
+    for (int o = 0; o < units; ++o) {
+      float sum = bias_data[o];
+      for (int c = 0; c < cols; ++c) {
+        sum += weight_data[o * cols + c] *
+               scales[o * num_groups + c / group_size] *
+               input_data[b * cols + c];
+      }
+      expected_data[b * units + o] = std::max(sum, 0.0f);
+    }
+  }
+  EXPECT_THAT(test.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                    expected_data, /*max_abs_error=*/1e-3f)));
+}
+
+INSTANTIATE_TEST_SUITE_P(Hybrid4BitPerGroupFullyConnectedOpTests,
+                         Hybrid4BitPerGroupFullyConnectedOpTests,
+                         ::testing::ValuesIn({
+                             std::make_tuple(4, 1, 64, 32),
+                             std::make_tuple(5, 1, 128, 32),
+                             std::make_tuple(5, 4, 128, 64),
+                             std::make_tuple(5, 6, 256, 128),
+                             std::make_tuple(8, 3, 256, 32),
+                         }));
+
+class Hybrid4BitPrepackedFullyConnectedOpTests
+    : public ::testing::TestWithParam<::testing::tuple<int, int, int, int>> {};
+
+TEST_P(Hybrid4BitPrepackedFullyConnectedOpTests, TestHybridInt4Prepacked) {
+  auto params = GetParam();
+  int units = std::get<0>(params);
+  int batches = std::get<1>(params);
+  int cols = std::get<2>(params);
+  int num_groups = std::get<3>(params);
+  std::vector<int8_t> weight_data(units * cols, 0);
+  std::vector<float> scales(units * num_groups);
+  std::vector<float> input_data(batches * cols, 0);
+  std::vector<float> bias_data(units, 0);
+  for (int i = 0; i < units * cols; ++i) {
+    weight_data[i] = int_dist(random_engine);
+  }
+  for (int i = 0; i < units * num_groups; ++i) {
+    scales[i] = scale_dist(random_engine);
+  }
+  for (int i = 0; i < batches * cols; ++i) {
+    input_data[i] = real_dist(random_engine);
+  }
+  for (int i = 0; i < units; ++i) {
+    bias_data[i] = real_dist(random_engine);
+  }
+  const TensorData weights = {TensorType_INT4,
+                              {units, cols},
+                              0.0,
+                              0.0,
+                              0.0,
+                              0,
+                              /*per_channel_quantization=*/true,
+                              scales,
+                              std::vector<int64_t>(scales.size(), 0),
+                              /*channel_index=*/0};
+  FullyConnected4BitOpModel test(
+      units, batches,
+      /*input=*/{TensorType_FLOAT32, {batches, cols}}, weights,
+      /*output=*/{TensorType_FLOAT32, {units, batches}}, weight_data,
+      ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT(),
+      ActivationFunctionType_RELU,
+      FullyConnectedOptionsWeightsFormat_PACKED4x32INT4);
+  test.SetBias(bias_data);
+  test.SetInput(input_data);
+  ASSERT_EQ(test.Invoke(), kTfLiteOk);
+
+  FullyConnected4BitOpModel expected(
+      units, batches,
+      /*input=*/{TensorType_FLOAT32, {batches, cols}}, weights,
+      /*output=*/{TensorType_FLOAT32, {units, batches}}, weight_data,
+      ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT(),
+      ActivationFunctionType_RELU);
+  expected.SetBias(bias_data);
+  expected.SetInput(input_data);
+  ASSERT_EQ(expected.Invoke(), kTfLiteOk);
+  EXPECT_THAT(test.GetOutput(), ElementsAreArray(expected.GetOutput()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Hybrid4BitPrepackedFullyConnectedOpTests,
+                         Hybrid4BitPrepackedFullyConnectedOpTests,
+                         ::testing::ValuesIn({
+                             std::make_tuple(4, 1, 32, 1),
+                             std::make_tuple(8, 4, 128, 1),
+                             std::make_tuple(8, 3, 128, 2),
+                             std::make_tuple(12, 6, 256, 4),
+                         }));
+
 }  // namespace tflite
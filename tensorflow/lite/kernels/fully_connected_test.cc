@@ -2016,6 +2016,85 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple4x4TestMultiThreaded) {
+  std::initializer_list<float> weight_data = {
+      1, 2, 3, 4, 1,  0,  0,  1,   // u = 0
+      5, 6, 7, 8, 0,  0,  0,  0,   // u = 1
+      1, 1, 1, 1, 0,  0,  0,  0,   // u = 2
+      2, 2, 2, 2, 0,  0,  0,  0,   // u = 3
+      0, 0, 0, 0, 1,  -1, 1,  -1,  // u = 4
+      0, 0, 0, 0, 2,  0,  -2, 0,   // u = 5
+      0, 0, 0, 0, 1,  2,  3,  4,   // u = 6
+      0, 0, 0, 0, -1, -1, -1, -1,  // u = 7
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {8, 8};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/8, /*batches=*/2,
+        /*input=*/{TensorType_FLOAT32, {2, 8}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+
+    m.SetInput({
+        1,  2, 3, 4, 5,  6, 7, 8,  // b = 0
+        -1, 0, 1, 0, -1, 0, 1, 0,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+    EXPECT_THAT(m.GetOutput(),
+                ElementsAre(44, 72, 13, 24, 3, 2, 77, 0,  // b = 0
+                            2, 4, 3, 4, 5, 2, 9, 8        // b = 1
+                            ));
+  }
+}
+
+TEST_P(SparseFullyConnectedOpTest, Simple8x1Test) {
+  std::initializer_list<float> weight_data = {
+      1,  0, 2,   // u = 0
+      0,  0, 0,   // u = 1
+      3,  0, -2,  // u = 2
+      1,  0, 1,   // u = 3
+      0,  0, 0,   // u = 4
+      2,  0, 1,   // u = 5
+      -1, 0, 0,   // u = 6
+      0,  0, 0,   // u = 7
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {8, 3};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {8};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/8, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 3}},
+                                       weight, weight_data);
+  m.SetBias({1, 1, 1, 1, 1, 1, 1, 1});
+
+  m.SetInput({
+      1, 2,  3,  // b = 0
+      3, -2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(8, 1, 0, 5, 1, 6, 0, 1,  // b = 0
+                                         6, 1, 8, 5, 1, 8, 0, 1   // b = 1
+                                         ));
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
@@ -2293,6 +2372,46 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestNoBias) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(10, 0, 22, 0, 0, 18));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple4x4Test) {
+  std::vector<float> weight_data = {
+      1, 2, 3, 4, 1,  0,  0,  1,   // u = 0
+      5, 6, 7, 8, 0,  0,  0,  0,   // u = 1
+      1, 1, 1, 1, 0,  0,  0,  0,   // u = 2
+      2, 2, 2, 2, 0,  0,  0,  0,   // u = 3
+      0, 0, 0, 0, 1,  -1, 1,  -1,  // u = 4
+      0, 0, 0, 0, 2,  0,  -2, 0,   // u = 5
+      0, 0, 0, 0, 1,  2,  3,  4,   // u = 6
+      0, 0, 0, 0, -1, -1, -1, -1,  // u = 7
+  };
+  TensorData weight = {TensorType_INT8, {8, 8}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(),
+        /*units=*/8, /*batches=*/2,
+        /*input=*/{TensorType_INT8, {2, 8}, 0, 0, 1}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, 0, 0, 1},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+
+    m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+    m.SetInput({
+        1,  2, 3, 4, 5,  6, 7, 8,  // b = 0
+        -1, 0, 1, 0, -1, 0, 1, 0,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+    EXPECT_THAT(m.GetOutput(),
+                ElementsAre(44, 72, 13, 24, 3, 2, 77, 0,  // b = 0
+                            2, 4, 3, 4, 5, 2, 9, 8        // b = 1
+                            ));
+  }
+}
+
 TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestScaledInputOutput) {
   std::initializer_list<float> weight_data = {
       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
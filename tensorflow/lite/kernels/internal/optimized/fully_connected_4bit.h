@@ -22,7 +22,9 @@ limitations under the License.
 #endif
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #if defined(FC_4BIT_SSE) && defined(__SSSE3__)
 #include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected.h"
@@ -39,6 +41,8 @@ namespace optimized_4bit {
 constexpr int FilterWidth = 4;
 constexpr int FilterDepth = 32;
 constexpr int kDefaultAlignmentPadding = 63;
+// Alignment the kernels need to read a prepacked filter in place.
+constexpr int kPrepackedFilterAlignment = 16;
 
 struct Deleter {
   explicit Deleter(size_t size = 0) : size(size) {}
@@ -62,6 +66,14 @@ struct OpData4Bit {
   uint8_t* prepacked_cache = nullptr;
   std::unique_ptr<uint8_t[], Deleter> prepacked_cache_buffer;
   size_t prepacked_cache_buffer_size = 0;
+  // Per-group quantization: every row of the filter is split into groups of
+  // `group_size` consecutive columns with a scale each, and every group is
+  // prepacked as a separate (rows, group_size) filter. group_size is 0 when
+  // the filter has a scale per tensor or per row.
+  int group_size = 0;
+  int num_groups = 1;
+  // Scales of the filter as (num_groups, layout rows).
+  std::vector<float> group_scales;
 
   void AllocatePackedRegion(size_t required_size) {
 #ifdef TFLITE_MMAP_DISABLED
@@ -145,6 +157,45 @@ inline void RunAndUnpack(int rhs_width, const uint8_t* lhs, const int8_t* rhs,
       dst_layout_cols, output_ptr, scaling_factors, filter_scales);
 }
 
+/* Add input offset * filter_scale to output_ptr.
+ * Same as AssignBiasAndComputeOffsets without bias, but accumulating into
+ * output_ptr, for the groups after the first one of a per-group filter.
+ */
+inline void AccumulateOffsets(const int32_t* input_offsets,
+                              const float* batch_scales,
+                              const float* filter_scales, float* output_ptr,
+                              int output_depth, int batch_size) {
+  for (int b = 0; b < batch_size; ++b) {
+    const float val = *input_offsets++ * *batch_scales++;
+    const float* filter_scales_ptr = filter_scales;
+    for (int i = 0; i < output_depth; i++) {
+      *output_ptr++ += val * *filter_scales_ptr++;
+    }
+  }
+}
+
+/* Prepack each group of columns of a per-group quantized lhs matrix.
+ * Group g of tensor, i.e. columns [g * group_size, (g + 1) * group_size),
+ * is prepacked as a (layout_rows, group_size) matrix at
+ * dest + g * layout_rows * group_size / 2. group_size must be a multiple of
+ * depth, so that the groups need no padding.
+ */
+inline void PrepackPerGroup(uint8_t* dest, const int8_t* tensor,
+                            int layout_rows, int src_rows, int src_cols,
+                            int group_size, int width, int depth) {
+  const int num_groups = src_cols / group_size;
+  std::vector<int8_t> group(src_rows * group_size / 2);
+  for (int g = 0; g < num_groups; ++g) {
+    for (int r = 0; r < src_rows; ++r) {
+      memcpy(group.data() + r * group_size / 2,
+             tensor + (r * src_cols + g * group_size) / 2, group_size / 2);
+    }
+    optimized_4bit::Prepack(dest + g * layout_rows * group_size / 2,
+                            group.data(), layout_rows, group_size, src_rows,
+                            group_size, width, depth);
+  }
+}
+
 }  // namespace api
 }  // namespace optimized_4bit
 }  // namespace tflite
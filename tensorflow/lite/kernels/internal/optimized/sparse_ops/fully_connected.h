@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
@@ -263,6 +265,243 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+// Block structure of sparse weights of shape [rows, cols] stored as blocks of
+// block_rows x block_cols values. Row blocks are dense, the blocks of every
+// row block are stored as CSR, and the values of every block are stored
+// row-major.
+struct SparseWeightBlocks {
+  int block_rows;
+  int block_cols;
+  int num_row_blocks;
+  // Offsets of the blocks of every row block, num_row_blocks + 1 values.
+  const int* segments;
+  // Block column of every block.
+  const int* indices;
+  int num_indices;
+};
+
+// Extracts the block structure of `sparsity`. The first dimension of the
+// weights must be dense, the last one CSR, and the dimensions in between dense
+// of size 1 (e.g. 1x1 convolution filters). Blocks may only span the first and
+// last dimensions. Returns false for any other encoding.
+inline bool GetSparseWeightBlocks(const TfLiteSparsity& sparsity,
+                                  SparseWeightBlocks* blocks) {
+  const int num_blocked_dims =
+      sparsity.block_map == nullptr ? 0 : sparsity.block_map->size;
+  const int dims_count = sparsity.dim_metadata_size - num_blocked_dims;
+  if (dims_count < 2 || sparsity.traversal_order == nullptr ||
+      sparsity.traversal_order->size != sparsity.dim_metadata_size) {
+    return false;
+  }
+  for (int i = 0; i < sparsity.traversal_order->size; ++i) {
+    if (sparsity.traversal_order->data[i] != i) return false;
+  }
+  const TfLiteDimensionMetadata* dim_metadata = sparsity.dim_metadata;
+  if (dim_metadata[0].format != kTfLiteDimDense) return false;
+  for (int i = 1; i < dims_count - 1; ++i) {
+    if (dim_metadata[i].format != kTfLiteDimDense ||
+        dim_metadata[i].dense_size != 1) {
+      return false;
+    }
+  }
+  const TfLiteDimensionMetadata& csr = dim_metadata[dims_count - 1];
+  if (csr.format != kTfLiteDimSparseCSR || csr.array_segments == nullptr ||
+      csr.array_indices == nullptr) {
+    return false;
+  }
+  blocks->block_rows = 1;
+  blocks->block_cols = 1;
+  for (int i = 0; i < num_blocked_dims; ++i) {
+    const TfLiteDimensionMetadata& block = dim_metadata[dims_count + i];
+    if (block.format != kTfLiteDimDense || block.dense_size <= 0) return false;
+    if (sparsity.block_map->data[i] == 0) {
+      blocks->block_rows = block.dense_size;
+    } else if (sparsity.block_map->data[i] == dims_count - 1) {
+      blocks->block_cols = block.dense_size;
+    } else {
+      return false;
+    }
+  }
+  blocks->num_row_blocks = dim_metadata[0].dense_size;
+  blocks->segments = csr.array_segments->data;
+  blocks->indices = csr.array_indices->data;
+  blocks->num_indices = csr.array_indices->size;
+  return csr.array_segments->size == blocks->num_row_blocks + 1;
+}
+
+// Checks that `blocks` describes weights of shape [rows, cols] made of
+// `num_values` values.
+inline bool VerifySparseWeightBlocks(const SparseWeightBlocks& blocks,
+                                     int rows, int cols, int num_values) {
+  if (rows != blocks.num_row_blocks * blocks.block_rows ||
+      cols % blocks.block_cols != 0) {
+    return false;
+  }
+  const int num_col_blocks = cols / blocks.block_cols;
+  if (blocks.segments[0] != 0) return false;
+  for (int i = 0; i < blocks.num_row_blocks; ++i) {
+    if (blocks.segments[i + 1] < blocks.segments[i]) return false;
+  }
+  const int num_blocks = blocks.segments[blocks.num_row_blocks];
+  if (num_blocks > blocks.num_indices ||
+      static_cast<int64_t>(num_blocks) * blocks.block_rows *
+              blocks.block_cols >
+          num_values) {
+    return false;
+  }
+  for (int i = 0; i < num_blocks; ++i) {
+    if (blocks.indices[i] < 0 || blocks.indices[i] >= num_col_blocks) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Computes the outputs of row blocks [row_block_start, row_block_end) for all
+// the batches, reading every block once for all the batches. Quantized
+// weights must be symmetric; `per_channel_multiplier` and `per_channel_shift`
+// are null for float and per-tensor quantized weights.
+template <typename T, typename BiasT>
+inline void FullyConnectedSparseWeightBlockImpl(
+    const SparseWeightBlocks& blocks, const FullyConnectedParams& params,
+    int batches, int input_depth, int output_depth, const T* input_data,
+    const T* weights_data, const int32_t* per_channel_multiplier,
+    const int32_t* per_channel_shift, const BiasT* bias_data, T* output_data,
+    int row_block_start, int row_block_end) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  using AccT = std::conditional_t<std::is_floating_point_v<T>, T, int32_t>;
+  const int block_rows = blocks.block_rows;
+  const int block_cols = blocks.block_cols;
+  const int block_size = block_rows * block_cols;
+  const AccT input_offset =
+      std::is_floating_point_v<T> ? 0 : params.input_offset;
+  std::vector<AccT> acc(block_rows);
+  for (int row_block = row_block_start; row_block < row_block_end;
+       ++row_block) {
+    const int row_start = row_block * block_rows;
+    for (int b = 0; b < batches; ++b) {
+      for (int r = 0; r < block_rows; ++r) {
+        acc[r] = bias_data ? bias_data[row_start + r] : 0;
+      }
+      const T* input = input_data + b * input_depth;
+      const T* block = weights_data + blocks.segments[row_block] * block_size;
+      for (int i = blocks.segments[row_block];
+           i < blocks.segments[row_block + 1]; ++i, block += block_size) {
+        const T* input_block = input + blocks.indices[i] * block_cols;
+        for (int r = 0; r < block_rows; ++r) {
+          const T* weights = block + r * block_cols;
+          AccT sum = 0;
+          for (int c = 0; c < block_cols; ++c) {
+            sum += weights[c] * (input_block[c] + input_offset);
+          }
+          acc[r] += sum;
+        }
+      }
+      T* output = output_data + b * output_depth + row_start;
+      for (int r = 0; r < block_rows; ++r) {
+        if constexpr (std::is_floating_point_v<T>) {
+          output[r] = ActivationFunctionWithMinMax(
+              acc[r], params.float_activation_min, params.float_activation_max);
+        } else {
+          const int row = row_start + r;
+          int32_t value = MultiplyByQuantizedMultiplier(
+              acc[r],
+              per_channel_multiplier ? per_channel_multiplier[row]
+                                     : params.output_multiplier,
+              per_channel_shift ? per_channel_shift[row] : params.output_shift);
+          value += params.output_offset;
+          output[r] = static_cast<T>(ActivationFunctionWithMinMax(
+              value, params.quantized_activation_min,
+              params.quantized_activation_max));
+        }
+      }
+    }
+  }
+}
+
+template <typename T, typename BiasT>
+struct FullyConnectedSparseWeightBlockTask : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeightBlockTask(
+      const SparseWeightBlocks& blocks, const FullyConnectedParams& params,
+      int batches, int input_depth, int output_depth, const T* input_data,
+      const T* weights_data, const int32_t* per_channel_multiplier,
+      const int32_t* per_channel_shift, const BiasT* bias_data, T* output_data,
+      int row_block_start, int row_block_end)
+      : blocks(blocks),
+        params(params),
+        batches(batches),
+        input_depth(input_depth),
+        output_depth(output_depth),
+        input_data(input_data),
+        weights_data(weights_data),
+        per_channel_multiplier(per_channel_multiplier),
+        per_channel_shift(per_channel_shift),
+        bias_data(bias_data),
+        output_data(output_data),
+        row_block_start(row_block_start),
+        row_block_end(row_block_end) {}
+
+  void Run() override {
+    FullyConnectedSparseWeightBlockImpl(
+        blocks, params, batches, input_depth, output_depth, input_data,
+        weights_data, per_channel_multiplier, per_channel_shift, bias_data,
+        output_data, row_block_start, row_block_end);
+  }
+
+ private:
+  const SparseWeightBlocks& blocks;
+  const FullyConnectedParams& params;
+  int batches;
+  int input_depth;
+  int output_depth;
+  const T* input_data;
+  const T* weights_data;
+  const int32_t* per_channel_multiplier;
+  const int32_t* per_channel_shift;
+  const BiasT* bias_data;
+  T* output_data;
+  int row_block_start;
+  int row_block_end;
+};
+
+// Block-sparse fully connected layer for any block shape, on float or int8
+// data. Unlike the 1x4 kernel, the workload is sliced along the row blocks of
+// the weights so that a single batch, the common case for inference, is split
+// between threads too. The input is [batches, input_depth] and the output
+// [batches, output_depth].
+template <typename T, typename BiasT>
+inline void FullyConnectedSparseWeightBlock(
+    const SparseWeightBlocks& blocks, const FullyConnectedParams& params,
+    int batches, int input_depth, int output_depth, const T* input_data,
+    const T* weights_data, const int32_t* per_channel_multiplier,
+    const int32_t* per_channel_shift, const BiasT* bias_data, T* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int thread_count =
+      std::max(1, std::min(blocks.num_row_blocks, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedSparseWeightBlockImpl(
+        blocks, params, batches, input_depth, output_depth, input_data,
+        weights_data, per_channel_multiplier, per_channel_shift, bias_data,
+        output_data, 0, blocks.num_row_blocks);
+  }
+  std::vector<FullyConnectedSparseWeightBlockTask<T, BiasT>> tasks;
+  tasks.reserve(thread_count);
+  int row_block_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int row_block_end = row_block_start + blocks.num_row_blocks / thread_count;
+    if (i < blocks.num_row_blocks % thread_count) row_block_end++;
+    tasks.emplace_back(blocks, params, batches, input_depth, output_depth,
+                       input_data, weights_data, per_channel_multiplier,
+                       per_channel_shift, bias_data, output_data,
+                       row_block_start, row_block_end);
+    row_block_start = row_block_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
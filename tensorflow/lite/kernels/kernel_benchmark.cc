@@ -0,0 +1,363 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Micro-benchmarks of single ops over representative shapes, types, thread
+// counts and execution paths: the builtin kernels, which run their matrix
+// multiplications on ruy or on Eigen and gemmlowp depending on the build, and
+// the XNNPACK delegate. Run with
+//
+//   bazel run -c opt //tensorflow/lite/kernels:kernel_benchmark -- \
+//     --benchmark_format=json --benchmark_out=results.json
+//
+// and compare the results of two builds with the `compare.py` tool of Google
+// Benchmark to find which kernel regressed.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+// The kernels an op runs on.
+enum class Path {
+  kBuiltin = 0,
+  kXnnpack = 1,
+};
+
+// The element type of the inputs and outputs of an op.
+enum class Type {
+  kFloat32 = 0,
+  kInt8 = 1,
+};
+
+// The scale of the quantized activations and weights, which span [-1, 1).
+constexpr float kQuantizedScale = 1.0f / 128;
+
+std::string PathLabel(Path path) {
+  if (path == Path::kXnnpack) return "xnnpack";
+#ifdef TFLITE_WITH_RUY
+  return "builtin/ruy";
+#else
+  return "builtin/eigen+gemmlowp";
+#endif
+}
+
+class BenchmarkOpModel : public SingleOpModel {
+ public:
+  BenchmarkOpModel(Path path, Type type) : path_(path), type_(type) {}
+
+  ~BenchmarkOpModel() {
+    // The interpreter must be destroyed before the delegate it runs on.
+    interpreter_.reset();
+  }
+
+  flatbuffers::FlatBufferBuilder& builder() { return builder_; }
+
+  // Returns the description of a tensor of the type of the op, quantized
+  // with `scale` if it is an integer tensor.
+  TensorData Tensor(std::vector<int> shape, float scale = kQuantizedScale,
+                    int32_t zero_point = 0) const {
+    if (type_ == Type::kInt8) {
+      return TensorData(TensorType_INT8, std::move(shape), 0, 0, scale,
+                        zero_point);
+    }
+    return TensorData(TensorType_FLOAT32, std::move(shape));
+  }
+
+  // Adds constant weights of the type of the op.
+  int AddWeights(const std::vector<int>& shape) {
+    const int size = NumElements(shape);
+    if (type_ == Type::kInt8) {
+      std::vector<int8_t> data(size);
+      for (int i = 0; i < size; ++i) data[i] = i % 255 - 127;
+      return AddConstInput(Tensor(shape), data);
+    }
+    std::vector<float> data(size);
+    for (int i = 0; i < size; ++i) data[i] = (i % 255 - 127) * kQuantizedScale;
+    return AddConstInput(Tensor(shape), data);
+  }
+
+  // Adds a zero bias of `size` for weights quantized like AddWeights.
+  int AddBias(int size) {
+    if (type_ == Type::kInt8) {
+      return AddConstInput(
+          TensorData(TensorType_INT32, {size}, 0, 0,
+                     kQuantizedScale * kQuantizedScale),
+          std::vector<int32_t>(size, 0));
+    }
+    return AddConstInput(TensorData(TensorType_FLOAT32, {size}),
+                         std::vector<float>(size, 0.0f));
+  }
+
+  // Builds the interpreter on `num_threads` threads and fills the inputs.
+  void Build(std::vector<std::vector<int>> input_shapes, int num_threads) {
+    if (path_ == Path::kXnnpack) {
+      TfLiteXNNPackDelegateOptions options =
+          TfLiteXNNPackDelegateOptionsDefault();
+      options.num_threads = num_threads;
+      xnnpack_delegate_.reset(TfLiteXNNPackDelegateCreate(&options));
+      SetDelegate(xnnpack_delegate_.get());
+    } else {
+      SetBypassDefaultDelegates();
+    }
+    BuildInterpreter(std::move(input_shapes), num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
+    for (int index : interpreter_->inputs()) {
+      TfLiteTensor* input = interpreter_->tensor(index);
+      if (input->allocation_type == kTfLiteMmapRo) continue;
+      if (input->type == kTfLiteInt8) {
+        int8_t* data = GetTensorData<int8_t>(input);
+        for (size_t i = 0; i < input->bytes; ++i) data[i] = i % 251 - 125;
+      } else if (input->type == kTfLiteFloat32) {
+        float* data = GetTensorData<float>(input);
+        const size_t size = input->bytes / sizeof(float);
+        for (size_t i = 0; i < size; ++i) data[i] = (i % 251 - 125) / 128.0f;
+      }
+    }
+  }
+
+  // Runs the op for the iterations of `state`, reporting `flops` per run.
+  void Run(benchmark::State& state, double flops) {
+    if (path_ == Path::kXnnpack && CountOpsExecutedByCpuKernel() != 0) {
+      state.SkipWithError("The op is not supported by XNNPACK");
+      return;
+    }
+    for (auto _ : state) {
+      if (Invoke() != kTfLiteOk) {
+        state.SkipWithError("Invoke failed");
+        return;
+      }
+    }
+    state.SetLabel(PathLabel(path_));
+    state.counters["FLOPS"] = benchmark::Counter(
+        flops, benchmark::Counter::kIsIterationInvariantRate);
+  }
+
+ private:
+  static int NumElements(const std::vector<int>& shape) {
+    int size = 1;
+    for (int dim : shape) size *= dim;
+    return size;
+  }
+
+  const Path path_;
+  const Type type_;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate_{nullptr, TfLiteXNNPackDelegateDelete};
+};
+
+// The trailing arguments of all benchmarks.
+Path GetPath(const benchmark::State& state, int first) {
+  return static_cast<Path>(state.range(first));
+}
+Type GetType(const benchmark::State& state, int first) {
+  return static_cast<Type>(state.range(first + 1));
+}
+int GetNumThreads(const benchmark::State& state, int first) {
+  return state.range(first + 2);
+}
+
+// Runs the benchmark for each of `shapes` on each path, type and number of
+// threads.
+void Sweep(benchmark::internal::Benchmark* b,
+           const std::vector<std::vector<int64_t>>& shapes,
+           std::vector<std::string> arg_names,
+           const std::vector<Type>& types = {Type::kFloat32, Type::kInt8},
+           const std::vector<Path>& paths = {Path::kBuiltin, Path::kXnnpack}) {
+  arg_names.insert(arg_names.end(), {"path", "type", "threads"});
+  b->ArgNames(arg_names);
+  for (const std::vector<int64_t>& shape : shapes) {
+    for (Path path : paths) {
+      for (Type type : types) {
+        for (int64_t num_threads : {1, 4}) {
+          std::vector<int64_t> args = shape;
+          args.insert(args.end(), {static_cast<int64_t>(path),
+                                   static_cast<int64_t>(type), num_threads});
+          b->Args(args);
+        }
+      }
+    }
+  }
+  b->UseRealTime();
+}
+
+void BM_FullyConnected(benchmark::State& state) {
+  const int batch = state.range(0);
+  const int input_depth = state.range(1);
+  const int output_depth = state.range(2);
+  BenchmarkOpModel m(GetPath(state, 3), GetType(state, 3));
+  m.AddInput(m.Tensor({batch, input_depth}));
+  m.AddWeights({output_depth, input_depth});
+  m.AddBias(output_depth);
+  m.AddOutput(m.Tensor({batch, output_depth}, 1.0f / 16));
+  m.SetBuiltinOp(
+      BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+      CreateFullyConnectedOptions(m.builder(), ActivationFunctionType_NONE)
+          .Union());
+  m.Build({{batch, input_depth}}, GetNumThreads(state, 3));
+  m.Run(state, 2.0 * batch * input_depth * output_depth);
+}
+BENCHMARK(BM_FullyConnected)->Apply([](benchmark::internal::Benchmark* b) {
+  // Single token decoding and batched layers of transformers and MLPs.
+  Sweep(b, {{1, 1024, 1024}, {1, 2048, 8192}, {64, 512, 512}, {256, 768, 3072}},
+        {"batch", "input_depth", "output_depth"});
+});
+
+void BM_Conv2D(benchmark::State& state) {
+  const int size = state.range(0);
+  const int input_depth = state.range(1);
+  const int output_depth = state.range(2);
+  const int kernel_size = state.range(3);
+  BenchmarkOpModel m(GetPath(state, 4), GetType(state, 4));
+  m.AddInput(m.Tensor({1, size, size, input_depth}));
+  m.AddWeights({output_depth, kernel_size, kernel_size, input_depth});
+  m.AddBias(output_depth);
+  m.AddOutput(m.Tensor({1, size, size, output_depth}, 1.0f / 16));
+  m.SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(m.builder(), Padding_SAME, /*stride_w=*/1,
+                                     /*stride_h=*/1)
+                     .Union());
+  m.Build({{1, size, size, input_depth}}, GetNumThreads(state, 4));
+  m.Run(state, 2.0 * size * size * output_depth * kernel_size * kernel_size *
+                   input_depth);
+}
+BENCHMARK(BM_Conv2D)->Apply([](benchmark::internal::Benchmark* b) {
+  // A stem, 3x3 and pointwise layers of mobile vision models.
+  Sweep(b,
+        {{112, 3, 32, 3},
+         {56, 64, 64, 3},
+         {28, 128, 128, 1},
+         {7, 512, 1024, 1}},
+        {"size", "input_depth", "output_depth", "kernel"});
+});
+
+void BM_DepthwiseConv2D(benchmark::State& state) {
+  const int size = state.range(0);
+  const int depth = state.range(1);
+  const int kernel_size = state.range(2);
+  BenchmarkOpModel m(GetPath(state, 3), GetType(state, 3));
+  m.AddInput(m.Tensor({1, size, size, depth}));
+  m.AddWeights({1, kernel_size, kernel_size, depth});
+  m.AddBias(depth);
+  m.AddOutput(m.Tensor({1, size, size, depth}, 1.0f / 16));
+  m.SetBuiltinOp(
+      BuiltinOperator_DEPTHWISE_CONV_2D, BuiltinOptions_DepthwiseConv2DOptions,
+      CreateDepthwiseConv2DOptions(m.builder(), Padding_SAME, /*stride_w=*/1,
+                                   /*stride_h=*/1, /*depth_multiplier=*/1)
+          .Union());
+  m.Build({{1, size, size, depth}}, GetNumThreads(state, 3));
+  m.Run(state, 2.0 * size * size * depth * kernel_size * kernel_size);
+}
+BENCHMARK(BM_DepthwiseConv2D)->Apply([](benchmark::internal::Benchmark* b) {
+  Sweep(b, {{112, 32, 3}, {56, 128, 3}, {14, 512, 3}, {14, 256, 5}},
+        {"size", "depth", "kernel"});
+});
+
+void BM_BatchMatMul(benchmark::State& state) {
+  const int batch = state.range(0);
+  const int rows = state.range(1);
+  const int depth = state.range(2);
+  const int cols = state.range(3);
+  BenchmarkOpModel m(GetPath(state, 4), GetType(state, 4));
+  m.AddInput(m.Tensor({batch, rows, depth}));
+  m.AddInput(m.Tensor({batch, depth, cols}));
+  m.AddOutput(m.Tensor({batch, rows, cols}, 1.0f / 16));
+  m.SetBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(m.builder()).Union());
+  m.Build({{batch, rows, depth}, {batch, depth, cols}},
+          GetNumThreads(state, 4));
+  m.Run(state, 2.0 * batch * rows * depth * cols);
+}
+BENCHMARK(BM_BatchMatMul)->Apply([](benchmark::internal::Benchmark* b) {
+  // The attention scores and values of transformer heads.
+  Sweep(b, {{12, 128, 64, 128}, {12, 128, 128, 64}, {32, 1, 128, 1024}},
+        {"batch", "rows", "depth", "cols"});
+});
+
+void BM_Add(benchmark::State& state) {
+  const int size = state.range(0);
+  BenchmarkOpModel m(GetPath(state, 1), GetType(state, 1));
+  m.AddInput(m.Tensor({1, size}));
+  m.AddInput(m.Tensor({1, size}));
+  m.AddOutput(m.Tensor({1, size}, 1.0f / 64));
+  m.SetBuiltinOp(BuiltinOperator_ADD, BuiltinOptions_AddOptions,
+                 CreateAddOptions(m.builder()).Union());
+  m.Build({{1, size}, {1, size}}, GetNumThreads(state, 1));
+  m.Run(state, size);
+}
+BENCHMARK(BM_Add)->Apply([](benchmark::internal::Benchmark* b) {
+  Sweep(b, {{1024}, {64 * 1024}, {1024 * 1024}}, {"size"});
+});
+
+void BM_Softmax(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  BenchmarkOpModel m(GetPath(state, 2), GetType(state, 2));
+  m.AddInput(m.Tensor({rows, cols}));
+  // Quantized softmax outputs [0, 1).
+  m.AddOutput(m.Tensor({rows, cols}, 1.0f / 256, -128));
+  m.SetBuiltinOp(BuiltinOperator_SOFTMAX, BuiltinOptions_SoftmaxOptions,
+                 CreateSoftmaxOptions(m.builder(), /*beta=*/1.0f).Union());
+  m.Build({{rows, cols}}, GetNumThreads(state, 2));
+  m.Run(state, 3.0 * rows * cols);
+}
+BENCHMARK(BM_Softmax)->Apply([](benchmark::internal::Benchmark* b) {
+  // Classifier logits and attention scores.
+  Sweep(b, {{1, 1000}, {1, 32000}, {1536, 128}}, {"rows", "cols"});
+});
+
+void BM_ScaledDotProductAttention(benchmark::State& state) {
+  const int q_len = state.range(0);
+  const int kv_len = state.range(1);
+  const int num_heads = state.range(2);
+  const int head_dim = state.range(3);
+  BenchmarkOpModel m(GetPath(state, 4), GetType(state, 4));
+  const std::vector<int> q_shape = {1, q_len, num_heads, head_dim};
+  const std::vector<int> kv_shape = {1, kv_len, num_heads, head_dim};
+  const std::vector<int> mask_shape = {1, 1, q_len, kv_len};
+  m.AddInput(m.Tensor(q_shape));
+  m.AddInput(m.Tensor(kv_shape));
+  m.AddInput(m.Tensor(kv_shape));
+  m.AddInput(m.Tensor(mask_shape));
+  m.AddOutput(m.Tensor(q_shape));
+  m.SetCustomOp("SDPA", {}, ops::custom::Register_SDPA);
+  m.Build({q_shape, kv_shape, kv_shape, mask_shape}, GetNumThreads(state, 4));
+  m.Run(state, 4.0 * q_len * kv_len * num_heads * head_dim);
+}
+BENCHMARK(BM_ScaledDotProductAttention)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      // Prefill and decoding steps of a language model. XNNPACK does not run
+      // this custom op, nor does it take quantized inputs.
+      Sweep(b, {{128, 128, 8, 64}, {1, 1024, 8, 64}, {1, 1024, 32, 128}},
+            {"q_len", "kv_len", "num_heads", "head_dim"}, {Type::kFloat32},
+            {Path::kBuiltin});
+    });
+
+}  // namespace
+}  // namespace tflite
+
+BENCHMARK_MAIN();
@@ -200,9 +200,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   CpuBackendContext* cpu_backend_context =
       CpuBackendContext::GetFromContext(context);
-  const int thread_count = cpu_backend_context->max_num_threads();
   TfLiteStatus status = kTfLiteOk;
   const int output_size = NumElements(output_tensor);
+  // Each output element is a copy, so small outputs aren't worth splitting.
+  const int kMinElementsPerThread = 16384;
+  const int thread_count = cpu_backend_context->ThreadCountForWork(
+      output_size, kMinElementsPerThread);
 #define TF_LITE_MIRROR_PAD(type)                                           \
   EvalData<type> eval_data;                                                \
   eval_data.input_data = GetTensorData<type>(input_tensor);                \
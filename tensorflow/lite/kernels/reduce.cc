@@ -722,9 +722,9 @@ void ReduceAllDims(const T* input_data, const int* input_dims,
   // Fetch backend context and number of threads.
   CpuBackendContext* cpu_backend_context =
       CpuBackendContext::GetFromContext(context);
-  int thread_count = cpu_backend_context->max_num_threads();
   const int kMinElementsPerThread = 1024;
-  if (num_elems / thread_count < kMinElementsPerThread) thread_count = 1;
+  const int thread_count = cpu_backend_context->ThreadCountForWork(
+      num_elems, kMinElementsPerThread);
 
   if (thread_count == 1) {
     output_data[0] = num_elems > 0 ? input_data[0] : init_value;
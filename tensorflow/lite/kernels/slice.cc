@@ -117,6 +117,11 @@ bool ShapeHasRank(const TfLiteIntArray* shape) {
   return true;
 }
 
+template <KernelType kernel_type>
+TfLiteStatus EvalImpl(TfLiteContext* context, const TfLiteTensor* input,
+                      const TfLiteTensor* begin, const TfLiteTensor* size,
+                      TfLiteTensor* output);
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -143,6 +148,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_MSG(context, NumDimensions(input) <= kMaxDim,
                      "Slice op only supports 1D-5D input arrays.");
 
+  // Slices of shapes computed during Prepare, such as the dimensions taken
+  // from the output of Shape, are computed now too, so that the ops consuming
+  // them can size their outputs without waiting for Eval.
+  if (input->type != kTfLiteString && IsConstantOrPersistentTensor(input) &&
+      IsConstantOrPersistentTensor(begin) &&
+      IsConstantOrPersistentTensor(size)) {
+    SetTensorToPersistentRo(output);
+    TF_LITE_ENSURE_OK(context,
+                      ResizeOutputShape(context, input, begin, size, output));
+    return EvalImpl<kReference>(context, input, begin, size, output);
+  }
+
   // If the shape of output is fully specified then resize even if
   // the input shape is not staticly defined.
   if (!HasUnspecifiedDimension(output) && ShapeHasRank(output->dims)) {
@@ -161,22 +178,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 }
 
 template <KernelType kernel_type>
-TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-  const TfLiteTensor* input;
-  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
-  const TfLiteTensor* begin;
-  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kBeginTensor, &begin));
-  const TfLiteTensor* size;
-  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kSizeTensor, &size));
-  TfLiteTensor* output;
-  TF_LITE_ENSURE_OK(context,
-                    GetOutputSafe(context, node, kOutputTensor, &output));
-
-  if (IsDynamicTensor(output)) {
-    TF_LITE_ENSURE_OK(context,
-                      ResizeOutputShape(context, input, begin, size, output));
-  }
-
+TfLiteStatus EvalImpl(TfLiteContext* context, const TfLiteTensor* input,
+                      const TfLiteTensor* begin, const TfLiteTensor* size,
+                      TfLiteTensor* output) {
   std::vector<int> begins;
   begins.reserve(kMaxDim);
   std::vector<int> sizes;
@@ -263,6 +267,30 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+template <KernelType kernel_type>
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kInputTensor, &input));
+  const TfLiteTensor* begin;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kBeginTensor, &begin));
+  const TfLiteTensor* size;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kSizeTensor, &size));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  if (IsConstantOrPersistentTensor(output)) {
+    // Output is computed in Prepare.
+    return kTfLiteOk;
+  }
+  if (IsDynamicTensor(output)) {
+    TF_LITE_ENSURE_OK(context,
+                      ResizeOutputShape(context, input, begin, size, output));
+  }
+
+  return EvalImpl<kernel_type>(context, input, begin, size, output);
+}
+
 }  // namespace slice
 
 TfLiteRegistration* Register_SLICE_REF() {
@@ -88,6 +88,46 @@ class SliceOpModel : public SingleOpModel {
   int output_;
 };
 
+class ConstInputSliceOpModel : public SingleOpModel {
+ public:
+  ConstInputSliceOpModel(std::initializer_list<int> input_shape,
+                         std::initializer_list<int32_t> input_data,
+                         std::initializer_list<int32_t> begin_data,
+                         std::initializer_list<int32_t> size_data) {
+    const int rank = input_shape.size();
+    input_ = AddConstInput(TensorType_INT32, input_data, input_shape);
+    begin_ = AddConstInput(TensorType_INT32, begin_data, {rank});
+    size_ = AddConstInput(TensorType_INT32, size_data, {rank});
+    output_ = AddOutput(TensorType_INT32);
+    SetBuiltinOp(BuiltinOperator_SLICE, BuiltinOptions_SliceOptions,
+                 CreateSliceOptions(builder_).Union());
+    BuildInterpreter({input_shape, {rank}, {rank}});
+  }
+
+  std::vector<int32_t> GetOutput() { return ExtractVector<int32_t>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+  const TfLiteTensor* GetOutputTensor() {
+    return interpreter_->tensor(output_);
+  }
+
+ private:
+  int input_;
+  int begin_;
+  int size_;
+  int output_;
+};
+
+// Slices of values known during Prepare, e.g. a dimension taken from the output
+// of Shape, are computed in Prepare so that the ops consuming them are sized
+// before Eval.
+TEST(ConstInputSliceOpTest, SliceIsComputedInPrepare) {
+  ConstInputSliceOpModel m({3}, {2, 128, 64}, {1}, {1});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({128}));
+  EXPECT_EQ(m.GetOutputTensor()->allocation_type, kTfLitePersistentRo);
+}
+
 class SliceOpTest : public ::testing::TestWithParam<TestType> {};
 
 TEST_P(SliceOpTest, In1D) {
@@ -76,11 +76,26 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       output_dims->data[out_idx++] = input_dims->data[in_idx];
     }
   }
+  // Squeezed shapes computed during Prepare are propagated immediately, so
+  // that the ops consuming them can size their outputs.
+  if (op_context.input->type != kTfLiteString &&
+      IsConstantOrPersistentTensor(op_context.input)) {
+    SetTensorToPersistentRo(op_context.output);
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(
+                                   context, op_context.output, output_dims));
+    memcpy(op_context.output->data.data, op_context.input->data.data,
+           op_context.input->bytes);
+    return kTfLiteOk;
+  }
   return context->ResizeTensor(context, op_context.output, output_dims);
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   SqueezeContext op_context(context, node);
+  if (IsConstantOrPersistentTensor(op_context.output)) {
+    // Output is computed in Prepare.
+    return kTfLiteOk;
+  }
   if (op_context.input->type == kTfLiteString) {
     const int input_flat_size = GetTensorShape(op_context.input).FlatSize();
     const int output_flat_size = GetTensorShape(op_context.output).FlatSize();
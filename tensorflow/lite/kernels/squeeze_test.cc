@@ -68,6 +68,31 @@ class SqueezeOpModel : public BaseSqueezeOpModel {
   std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
 };
 
+class ConstInputSqueezeOpModel : public SingleOpModel {
+ public:
+  ConstInputSqueezeOpModel(std::initializer_list<int> input_shape,
+                           std::initializer_list<int32_t> input_data,
+                           std::initializer_list<int> axis) {
+    input_ = AddConstInput(TensorType_INT32, input_data, input_shape);
+    output_ = AddOutput(TensorType_INT32);
+    SetBuiltinOp(
+        BuiltinOperator_SQUEEZE, BuiltinOptions_SqueezeOptions,
+        CreateSqueezeOptions(builder_, builder_.CreateVector<int>(axis))
+            .Union());
+    BuildInterpreter({input_shape});
+  }
+
+  std::vector<int32_t> GetOutput() { return ExtractVector<int32_t>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+  const TfLiteTensor* GetOutputTensor() {
+    return interpreter_->tensor(output_);
+  }
+
+ private:
+  int input_;
+  int output_;
+};
+
 template <typename T>
 class SqueezeOpTest : public ::testing::Test {};
 
@@ -151,6 +176,16 @@ TYPED_TEST(SqueezeOpTest, SqueezeAllDims) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({3}));
 }
 
+// Squeezed dimensions, e.g. taken from the output of Shape, are known after
+// Prepare.
+TEST(SqueezeOpTest, SqueezeConstantInputInPrepare) {
+  ConstInputSqueezeOpModel m({1}, {24}, {0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), IsEmpty());
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({24}));
+  EXPECT_EQ(m.GetOutputTensor()->allocation_type, kTfLitePersistentRo);
+}
+
 TEST(SqueezeOpTest, SqueezeAllString) {
   std::initializer_list<std::string> data = {"a", "b"};
   SqueezeOpModel<std::string> m({GetTensorType<std::string>(), {1, 2, 1}},
@@ -15,12 +15,26 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 
 namespace tflite {
 
+// Position of a tensor in the non-persistent arena. `first_node` and
+// `last_node` are the execution plan indices the tensor is allocated before
+// and deallocated after.
+struct ArenaTensorPlacement {
+  int32_t tensor;
+  int32_t first_node;
+  int32_t last_node;
+  uint64_t size;
+  uint64_t offset;
+};
+
+using ArenaPlacements = std::vector<ArenaTensorPlacement>;
+
 // A MemoryPlanner is responsible for planning and executing a number of
 // memory-related operations that are necessary in TF Lite.
 class MemoryPlanner {
@@ -69,6 +83,18 @@ class MemoryPlanner {
   // Returns a map of allocation information. It's only used for debugging.
   virtual void GetAllocInfo(size_t *arena_size,
                             size_t *arena_persist_size) const = 0;
+
+  // Fills `placements` with the placement of every tensor owning memory in
+  // the non-persistent arena. Returns false if the planner doesn't support
+  // reusing placements.
+  virtual bool GetArenaPlacements(ArenaPlacements *placements) const {
+    return false;
+  }
+
+  // Places the non-persistent arena tensors at the given offsets, rather than
+  // searching for a placement, when the tensors have the sizes and lifetimes
+  // they were recorded with by `GetArenaPlacements`.
+  virtual void SetArenaPlacements(const ArenaPlacements &placements) {}
 };
 
 }  // namespace tflite
@@ -20,6 +20,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -40,6 +41,11 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+size_t GetPageSize() {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
@@ -129,6 +135,35 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+void MMAPAllocation::AdviseWillNeed(const void* ptr, size_t bytes) const {
+  if (!valid()) return;
+  const uintptr_t mapping_begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t mapping_end = mapping_begin + mmapped_buffer_size();
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  uintptr_t end = begin + bytes;
+  if (begin < mapping_begin || end > mapping_end || begin >= end) return;
+  // Round out to the pages the bytes are on.
+  begin &= ~(GetPageSize() - 1);
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
+
+void MMAPAllocation::AdviseDontNeed(const void* ptr, size_t bytes) const {
+  if (!valid()) return;
+  const uintptr_t mapping_begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t mapping_end = mapping_begin + mmapped_buffer_size();
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  uintptr_t end = begin + bytes;
+  if (begin < mapping_begin || end > mapping_end) return;
+  // Round in to the pages holding nothing but these bytes, which may share
+  // their first and last pages with other tensors still in use. The last page
+  // of the mapping holds nothing past its end.
+  const size_t page_size = GetPageSize();
+  begin = (begin + page_size - 1) & ~(page_size - 1);
+  if (end != mapping_end) end &= ~(page_size - 1);
+  if (begin >= end) return;
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
@@ -45,6 +45,10 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+void MMAPAllocation::AdviseWillNeed(const void* ptr, size_t bytes) const {}
+
+void MMAPAllocation::AdviseDontNeed(const void* ptr, size_t bytes) const {}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
@@ -21,7 +21,9 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -187,6 +189,36 @@ void ResizableAlignedBuffer::Release() {
   data_size_ = 0;
 }
 
+bool SharedArenaBuffer::Resize(const SimpleMemoryArena* arena,
+                               size_t new_size) {
+  if (!buffer_.Resize(new_size)) return false;
+  for (SimpleMemoryArena* other : arenas_) {
+    if (other != arena && other->shared_buffer_moved_) {
+      other->shared_buffer_moved_();
+    }
+  }
+  return true;
+}
+
+SimpleMemoryArena::SimpleMemoryArena(
+    size_t arena_alignment, int subgraph_index,
+    std::shared_ptr<SharedArenaBuffer> shared_buffer)
+    : committed_(false),
+      high_water_mark_(0),
+      underlying_buffer_(arena_alignment, subgraph_index),
+      active_allocs_(),
+      shared_buffer_(std::move(shared_buffer)) {
+  if (shared_buffer_) shared_buffer_->arenas_.push_back(this);
+}
+
+SimpleMemoryArena::~SimpleMemoryArena() {
+  if (shared_buffer_) {
+    auto& arenas = shared_buffer_->arenas_;
+    arenas.erase(std::remove(arenas.begin(), arenas.end(), this),
+                 arenas.end());
+  }
+}
+
 void SimpleMemoryArena::PurgeAfter(int32_t node) {
   for (int i = 0; i < active_allocs_.size(); ++i) {
     if (active_allocs_[i].first_node > node) {
@@ -234,7 +266,7 @@ TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
     ArenaAllocWithUsageInterval* new_alloc) {
-  TF_LITE_ENSURE(context, alignment <= underlying_buffer_.GetAlignment());
+  TF_LITE_ENSURE(context, alignment <= buffer().GetAlignment());
   new_alloc->tensor = tensor;
   new_alloc->first_node = first_node;
   new_alloc->last_node = last_node;
@@ -284,11 +316,34 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    size_t offset, size_t size, int32_t tensor, int32_t first_node,
+    int32_t last_node, ArenaAllocWithUsageInterval* new_alloc) {
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+  new_alloc->offset = offset;
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  auto insertion_it = std::upper_bound(active_allocs_.begin(),
+                                       active_allocs_.end(), *new_alloc);
+  active_allocs_.insert(insertion_it, *new_alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
   // based, they will remain valid in the new memory block.
-  *arena_reallocated = underlying_buffer_.Resize(high_water_mark_);
+  if (shared_buffer_) {
+    *arena_reallocated = shared_buffer_->Resize(this, high_water_mark_);
+  } else {
+    *arena_reallocated = underlying_buffer_.Resize(high_water_mark_);
+  }
   committed_ = true;
   return kTfLiteOk;
 }
@@ -298,12 +353,11 @@ TfLiteStatus SimpleMemoryArena::ResolveAlloc(
     char** output_ptr) {
   TF_LITE_ENSURE(context, committed_);
   TF_LITE_ENSURE(context, output_ptr != nullptr);
-  TF_LITE_ENSURE(context,
-                 underlying_buffer_.GetSize() >= (alloc.offset + alloc.size));
+  TF_LITE_ENSURE(context, buffer().GetSize() >= (alloc.offset + alloc.size));
   if (alloc.size == 0) {
     *output_ptr = nullptr;
   } else {
-    *output_ptr = underlying_buffer_.GetPtr() + alloc.offset;
+    *output_ptr = buffer().GetPtr() + alloc.offset;
   }
   return kTfLiteOk;
 }
@@ -317,7 +371,8 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
 
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
-  underlying_buffer_.Release();
+  // The shared buffer is still used by the other arenas.
+  if (!shared_buffer_) underlying_buffer_.Release();
   return kTfLiteOk;
 }
 
@@ -329,7 +384,7 @@ TFLITE_ATTRIBUTE_WEAK void DumpArenaInfo(
 
 void SimpleMemoryArena::DumpDebugInfo(
     const std::string& name, const std::vector<int>& execution_plan) const {
-  tflite::DumpArenaInfo(name, execution_plan, underlying_buffer_.GetSize(),
+  tflite::DumpArenaInfo(name, execution_plan, buffer().GetSize(),
                         active_allocs_);
 }
 
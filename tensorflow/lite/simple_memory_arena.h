@@ -15,8 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SIMPLE_MEMORY_ARENA_H_
 #define TENSORFLOW_LITE_SIMPLE_MEMORY_ARENA_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -100,6 +103,44 @@ class ResizableAlignedBuffer {
   int subgraph_index_;
 };
 
+class SimpleMemoryArena;
+
+// A buffer that the arenas of several interpreters place their tensors in, so
+// that interpreters which are never used at the same time keep one buffer of
+// the size of the largest of them rather than one each. The buffer only grows,
+// keeping its contents, and the other arenas are told when growing it moves
+// it so that their tensors can follow.
+//
+// Running an interpreter overwrites the tensors of the others, so the inputs
+// of an interpreter should be set and its outputs read right around its
+// `Invoke`. TryLock() and Unlock() bracket the uses of the buffer, so that
+// concurrent ones fail instead of corrupting each other.
+class SharedArenaBuffer {
+ public:
+  explicit SharedArenaBuffer(size_t alignment)
+      : buffer_(alignment, /*subgraph_index=*/0) {}
+
+  SharedArenaBuffer(const SharedArenaBuffer&) = delete;
+  SharedArenaBuffer& operator=(const SharedArenaBuffer&) = delete;
+
+  // Marks the buffer in use. Returns false if it already is.
+  bool TryLock() { return !in_use_.exchange(true, std::memory_order_acquire); }
+  void Unlock() { in_use_.store(false, std::memory_order_release); }
+
+  size_t GetSize() const { return buffer_.GetSize(); }
+
+ private:
+  friend class SimpleMemoryArena;
+
+  // Grows the buffer for `arena`, and calls the moved callbacks of the other
+  // arenas if that moved it. Returns whether it moved.
+  bool Resize(const SimpleMemoryArena* arena, size_t new_size);
+
+  ResizableAlignedBuffer buffer_;
+  std::vector<SimpleMemoryArena*> arenas_;
+  std::atomic<bool> in_use_ = false;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
@@ -107,11 +148,18 @@ class ResizableAlignedBuffer {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
-  explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0)
-      : committed_(false),
-        high_water_mark_(0),
-        underlying_buffer_(arena_alignment, subgraph_index),
-        active_allocs_() {}
+  // If `shared_buffer` is set, the arena places its allocations in it instead
+  // of in a buffer of its own.
+  explicit SimpleMemoryArena(
+      size_t arena_alignment, int subgraph_index = 0,
+      std::shared_ptr<SharedArenaBuffer> shared_buffer = nullptr);
+  ~SimpleMemoryArena();
+
+  // Sets the function called after another arena moved the shared buffer, at
+  // which point the pointers resolved from this arena are stale.
+  void SetSharedBufferMovedCallback(std::function<void()> callback) {
+    shared_buffer_moved_ = std::move(callback);
+  }
 
   // Delete all allocs. This should be called when allocating the first node of
   // a subgraph.
@@ -142,6 +190,13 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Same as `Allocate`, but places the tensor at `offset` instead of searching
+  // for a gap. The caller guarantees that it doesn't overlap the allocations
+  // whose usage interval intersects [first_node, last_node].
+  TfLiteStatus AllocateAt(size_t offset, size_t size, int32_t tensor,
+                          int32_t first_node, int32_t last_node,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -158,10 +213,14 @@ class SimpleMemoryArena {
   // again until Commit() is called & tensor allocations are resolved.
   TfLiteStatus ReleaseBuffer();
 
-  size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
+  size_t GetBufferSize() const { return buffer().GetSize(); }
+
+  // Returns the number of bytes the current plan needs, i.e. the size the
+  // underlying buffer will have after the next Commit().
+  size_t RequiredBufferSize() const { return high_water_mark_; }
 
   std::intptr_t BasePointer() const {
-    return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
+    return reinterpret_cast<std::intptr_t>(buffer().GetPtr());
   }
 
   // Dumps the memory allocation information of this memory arena (which could
@@ -182,10 +241,18 @@ class SimpleMemoryArena {
                      const std::vector<int>& execution_plan) const;
 
  private:
+  friend class SharedArenaBuffer;
+
+  const ResizableAlignedBuffer& buffer() const {
+    return shared_buffer_ ? shared_buffer_->buffer_ : underlying_buffer_;
+  }
+
   bool committed_;
   size_t high_water_mark_;
   ResizableAlignedBuffer underlying_buffer_;
   std::vector<ArenaAllocWithUsageInterval> active_allocs_;
+  std::shared_ptr<SharedArenaBuffer> shared_buffer_;
+  std::function<void()> shared_buffer_moved_;
 };
 
 }  // namespace tflite
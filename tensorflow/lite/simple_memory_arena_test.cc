@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/simple_memory_arena.h"
 
+#include <memory>
+
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/c/common.h"
 
@@ -370,5 +372,52 @@ TEST_P(BufferAndPlanClearingTest, TestClearBufferAndClearPlan) {
 INSTANTIATE_TEST_SUITE_P(BufferAndPlanClearingTest, BufferAndPlanClearingTest,
                          ::testing::Values(true, false));
 
+TEST(SimpleMemoryArenaTest, SharedBufferFollowsLargestArena) {
+  TfLiteContext context;
+  auto shared_buffer = std::make_shared<SharedArenaBuffer>(64);
+  SimpleMemoryArena small_arena(64, 0, shared_buffer);
+  SimpleMemoryArena large_arena(64, 0, shared_buffer);
+  int small_arena_moves = 0;
+  small_arena.SetSharedBufferMovedCallback([&] { ++small_arena_moves; });
+  ArenaAllocWithUsageInterval small_alloc, large_alloc;
+
+  ASSERT_EQ(small_arena.Allocate(&context, 32, 1024, 0, 0, 1, &small_alloc),
+            kTfLiteOk);
+  bool reallocated = false;
+  ASSERT_EQ(small_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_TRUE(reallocated);
+  char* small_ptr = nullptr;
+  ASSERT_EQ(small_arena.ResolveAlloc(&context, small_alloc, &small_ptr),
+            kTfLiteOk);
+  small_ptr[0] = 42;
+
+  ASSERT_EQ(large_arena.Allocate(&context, 32, 1 << 20, 0, 0, 1, &large_alloc),
+            kTfLiteOk);
+  ASSERT_EQ(large_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(shared_buffer->GetSize(), 1 << 20);
+  EXPECT_EQ(small_arena.BasePointer(), large_arena.BasePointer());
+  EXPECT_EQ(small_arena_moves, reallocated ? 1 : 0);
+
+  // Growing the buffer keeps the contents of the other arena.
+  ASSERT_EQ(small_arena.ResolveAlloc(&context, small_alloc, &small_ptr),
+            kTfLiteOk);
+  EXPECT_EQ(small_ptr[0], 42);
+
+  // The smaller arena neither shrinks nor releases the shared buffer.
+  ASSERT_EQ(small_arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_FALSE(reallocated);
+  ASSERT_EQ(small_arena.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_EQ(shared_buffer->GetSize(), 1 << 20);
+  EXPECT_NE(large_arena.BasePointer(), 0);
+}
+
+TEST(SimpleMemoryArenaTest, SharedBufferCanOnlyBeLockedOnce) {
+  SharedArenaBuffer shared_buffer(64);
+  EXPECT_TRUE(shared_buffer.TryLock());
+  EXPECT_FALSE(shared_buffer.TryLock());
+  shared_buffer.Unlock();
+  EXPECT_TRUE(shared_buffer.TryLock());
+}
+
 }  // namespace
 }  // namespace tflite
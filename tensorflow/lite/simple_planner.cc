@@ -149,7 +149,8 @@ TfLiteStatus SimplePlanner::PlanAllocations() {
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(
+          allocate(graph_info_->concurrent_nodes(i).first, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -160,7 +161,8 @@ TfLiteStatus SimplePlanner::PlanAllocations() {
       if (tensor_index != kTfLiteOptionalTensor) {
         refcounts[tensor_index]--;
         if (refcounts[tensor_index] == 0) {
-          TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+          TF_LITE_ENSURE_STATUS(deallocate(
+              graph_info_->concurrent_nodes(i).second, tensor_index));
         }
       }
     }
@@ -180,11 +182,13 @@ TfLiteStatus SimplePlanner::ExecuteAllocations(int first_node, int last_node) {
   for (size_t i = first_node;
        i <= static_cast<size_t>(last_node) && i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    const std::pair<size_t, size_t> concurrent_nodes =
+        graph_info_->concurrent_nodes(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
-      dealloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = concurrent_nodes.first;
+      dealloc_node_[tensor_index] = concurrent_nodes.second;
     }
   }
 
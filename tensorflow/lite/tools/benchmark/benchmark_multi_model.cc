@@ -0,0 +1,448 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/memory_usage_monitor.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr int kDefaultSamplingIntervalMs = 500;
+
+// Records the regular runs of a model.
+class RunRecorder : public BenchmarkListener {
+ public:
+  void set_origin_us(int64_t origin_us) { origin_us_ = origin_us; }
+
+  void OnSingleRunStart(RunType run_type) override {
+    is_regular_run_ = run_type == REGULAR;
+    run_start_us_ = profiling::time::NowMicros();
+  }
+
+  void OnSingleRunEnd() override {
+    if (!is_regular_run_) return;
+    const int64_t run_end_us = profiling::time::NowMicros();
+    runs_.push_back({run_start_us_ - origin_us_, run_end_us - run_start_us_});
+  }
+
+  const std::vector<RunRecord>& runs() const { return runs_; }
+
+ private:
+  int64_t origin_us_ = 0;
+  int64_t run_start_us_ = 0;
+  bool is_regular_run_ = false;
+  std::vector<RunRecord> runs_;
+};
+
+struct TimelineSample {
+  int64_t time_us;
+  int64_t mem_footprint_kb;
+  // NaN if the temperature isn't available.
+  float temperature_celsius;
+};
+
+// Returns the highest temperature reported by the thermal zones of the
+// device, or NaN if there are none.
+float GetMaxTemperatureCelsius() {
+  float max_temperature = std::numeric_limits<float>::quiet_NaN();
+#if defined(__linux__)
+  for (int zone = 0;; ++zone) {
+    const std::string path =
+        "/sys/class/thermal/thermal_zone" + std::to_string(zone) + "/temp";
+    FILE* fp = fopen(path.c_str(), "r");
+    if (fp == nullptr) break;
+    long long millidegrees;  // NOLINT(runtime/int)
+    if (fscanf(fp, "%lld", &millidegrees) == 1) {
+      const float temperature = millidegrees / 1000.0f;
+      if (std::isnan(max_temperature) || temperature > max_temperature) {
+        max_temperature = temperature;
+      }
+    }
+    fclose(fp);
+  }
+#endif  // __linux__
+  return max_temperature;
+}
+
+// Keeps every sample taken by a MemoryUsageMonitor, along with the
+// temperature of the device at that time.
+class TimelineSampler : public profiling::memory::MemoryUsageMonitor::Sampler {
+ public:
+  explicit TimelineSampler(int64_t origin_us) : origin_us_(origin_us) {}
+
+  profiling::memory::MemoryUsage GetMemoryUsage() override {
+    const auto mem_usage = Sampler::GetMemoryUsage();
+    const int64_t now_us = profiling::time::NowMicros();
+    samples_.push_back({now_us - origin_us_,
+                        mem_usage.mem_footprint_kb,
+                        GetMaxTemperatureCelsius()});
+    return mem_usage;
+  }
+
+  // Only safe to call once the monitor is stopped.
+  const std::vector<TimelineSample>& samples() const { return samples_; }
+
+ private:
+  const int64_t origin_us_;
+  std::vector<TimelineSample> samples_;
+};
+
+// Pins the calling thread, and the threads it creates afterwards such as the
+// thread pool of an interpreter, to the CPUs in 'cpu_mask'.
+bool SetCurrentThreadAffinity(uint64_t cpu_mask) {
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu = 0; cpu < 64; ++cpu) {
+    if (cpu_mask & (uint64_t{1} << cpu)) CPU_SET(cpu, &cpu_set);
+  }
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else   // !__linux__
+  return false;
+#endif  // __linux__
+}
+
+// Parses a comma-separated list of per-model values of flag 'name'. An empty
+// list leaves 'values' empty, otherwise there must be one value per model.
+template <typename T>
+TfLiteStatus ParsePerModelValues(const BenchmarkParams& params,
+                                 const std::string& name, size_t num_models,
+                                 std::vector<T>* values) {
+  const std::string& list = params.Get<std::string>(name);
+  if (list.empty()) return kTfLiteOk;
+  if (!util::SplitAndParse(list, ',', values) ||
+      values->size() != num_models) {
+    TFLITE_LOG(ERROR) << "--" << name << " must hold one value per model in "
+                      << "--graphs, got '" << list << "'.";
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+int64_t GetLatencyPercentileUs(const std::vector<RunRecord>& runs,
+                               float percentile) {
+  if (runs.empty()) return -1;
+  std::vector<int64_t> durations;
+  durations.reserve(runs.size());
+  for (const RunRecord& run : runs) durations.push_back(run.duration_us);
+  // Nearest-rank percentile.
+  const int rank = std::ceil(percentile / 100.0 * durations.size());
+  const int index =
+      std::min<int>(std::max(rank - 1, 0), durations.size() - 1);
+  std::nth_element(durations.begin(), durations.begin() + index,
+                   durations.end());
+  return durations[index];
+}
+
+int64_t FindThrottlingOnsetUs(const std::vector<RunRecord>& runs,
+                              int64_t window_us, float threshold) {
+  if (runs.empty() || window_us <= 0) return -1;
+  int64_t first_start_us = runs[0].start_us;
+  int64_t last_start_us = runs[0].start_us;
+  for (const RunRecord& run : runs) {
+    first_start_us = std::min(first_start_us, run.start_us);
+    last_start_us = std::max(last_start_us, run.start_us);
+  }
+  const int num_windows = (last_start_us - first_start_us) / window_us + 1;
+  std::vector<int64_t> sums(num_windows, 0);
+  std::vector<int> counts(num_windows, 0);
+  for (const RunRecord& run : runs) {
+    const int window = (run.start_us - first_start_us) / window_us;
+    sums[window] += run.duration_us;
+    ++counts[window];
+  }
+  // Windows without any run started in them are skipped. The baseline is the
+  // first window, i.e. the one with the first run.
+  std::vector<int> windows;
+  for (int window = 0; window < num_windows; ++window) {
+    if (counts[window] > 0) windows.push_back(window);
+  }
+  auto average = [&](int window) {
+    return static_cast<double>(sums[window]) / counts[window];
+  };
+  const double limit = average(windows[0]) * (1.0 + threshold);
+  for (size_t i = 1; i + 1 < windows.size(); ++i) {
+    if (average(windows[i]) > limit && average(windows[i + 1]) > limit) {
+      return first_start_us + windows[i] * window_us;
+    }
+  }
+  return -1;
+}
+
+struct BenchmarkMultiModel::Model {
+  std::string graph;
+  std::unique_ptr<BenchmarkModel> benchmark;
+  RunRecorder recorder;
+  uint64_t cpu_mask = 0;
+  TfLiteStatus status = kTfLiteOk;
+};
+
+BenchmarkMultiModel::BenchmarkMultiModel(ModelFactory create_model)
+    : params_(DefaultParams()), create_model_(std::move(create_model)) {}
+
+BenchmarkMultiModel::~BenchmarkMultiModel() = default;
+
+BenchmarkParams BenchmarkMultiModel::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("model_run_frequencies",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("model_num_threads", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("model_cpu_masks", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("timeline_sampling_interval_ms",
+                  BenchmarkParam::Create<int32_t>(kDefaultSamplingIntervalMs));
+  params.AddParam("throttling_window_secs",
+                  BenchmarkParam::Create<float>(1.0f));
+  params.AddParam("throttling_threshold", BenchmarkParam::Create<float>(0.15f));
+  return params;
+}
+
+std::vector<Flag> BenchmarkMultiModel::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "A comma-separated list of model files to benchmark concurrently."),
+      CreateFlag<std::string>(
+          "model_run_frequencies", &params_,
+          "A comma-separated list of the number of runs per second of every "
+          "model, i.e. the arrival rates of their requests. Overrides "
+          "--run_frequency."),
+      CreateFlag<std::string>(
+          "model_num_threads", &params_,
+          "A comma-separated list of the number of threads of every model. "
+          "Overrides --num_threads."),
+      CreateFlag<std::string>(
+          "model_cpu_masks", &params_,
+          "A comma-separated list of the CPUs every model runs on, as bit "
+          "masks, e.g. '0x0f,0xf0'. 0 leaves the affinity unchanged. Only "
+          "supported on Linux and Android."),
+      CreateFlag<int32_t>(
+          "timeline_sampling_interval_ms", &params_,
+          "The interval in millisecond between two samples of the memory "
+          "footprint and the temperature of the device."),
+      CreateFlag<float>(
+          "throttling_window_secs", &params_,
+          "The length of the windows over which latencies are averaged to "
+          "detect thermal throttling."),
+      CreateFlag<float>(
+          "throttling_threshold", &params_,
+          "The relative increase of the average latency of a model over its "
+          "first window that is reported as the onset of throttling.")};
+}
+
+TfLiteStatus BenchmarkMultiModel::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkMultiModel::CreateModels(int argc, char** argv) {
+  std::vector<std::string> graphs;
+  if (!util::SplitAndParse(params_.Get<std::string>("graphs"), ',', &graphs) ||
+      graphs.empty()) {
+    TFLITE_LOG(ERROR) << "Please specify the models to benchmark with --graphs";
+    return kTfLiteError;
+  }
+  const int num_models = graphs.size();
+  std::vector<float> run_frequencies;
+  std::vector<int32_t> num_threads;
+  std::vector<std::string> cpu_masks;
+  TF_LITE_ENSURE_STATUS(ParsePerModelValues(params_, "model_run_frequencies",
+                                            num_models, &run_frequencies));
+  TF_LITE_ENSURE_STATUS(ParsePerModelValues(params_, "model_num_threads",
+                                            num_models, &num_threads));
+  TF_LITE_ENSURE_STATUS(ParsePerModelValues(params_, "model_cpu_masks",
+                                            num_models, &cpu_masks));
+
+  for (int i = 0; i < num_models; ++i) {
+    auto model = std::make_unique<Model>();
+    model->graph = graphs[i];
+    model->benchmark = create_model_();
+    // Flags::Parse removes the flags it consumes, so every model parses its
+    // own copy of the arguments.
+    std::vector<char*> model_argv(argv, argv + argc);
+    int model_argc = argc;
+    TF_LITE_ENSURE_STATUS(
+        model->benchmark->ParseFlags(&model_argc, model_argv.data()));
+
+    BenchmarkParams* model_params = model->benchmark->mutable_params();
+    if (!model_params->HasParam("graph")) {
+      TFLITE_LOG(ERROR) << "The benchmark doesn't take a --graph.";
+      return kTfLiteError;
+    }
+    model_params->Set<std::string>("graph", graphs[i]);
+    if (!run_frequencies.empty()) {
+      model_params->Set<float>("run_frequency", run_frequencies[i]);
+    }
+    if (!num_threads.empty()) {
+      model_params->Set<int32_t>("num_threads", num_threads[i]);
+    }
+    if (!cpu_masks.empty()) {
+      char* end = nullptr;
+      model->cpu_mask = std::strtoull(cpu_masks[i].c_str(), &end, 0);
+      if (end == cpu_masks[i].c_str() || *end != '\0') {
+        TFLITE_LOG(ERROR) << "Invalid CPU mask '" << cpu_masks[i] << "'.";
+        return kTfLiteError;
+      }
+    }
+    model->benchmark->AddListener(&model->recorder);
+    models_.push_back(std::move(model));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkMultiModel::RunModels() {
+  const int64_t origin_us = profiling::time::NowMicros();
+  auto sampler = std::make_unique<TimelineSampler>(origin_us);
+  const TimelineSampler* timeline = sampler.get();
+  profiling::memory::MemoryUsageMonitor monitor(
+      params_.Get<int32_t>("timeline_sampling_interval_ms"),
+      std::move(sampler));
+  monitor.Start();
+
+  std::vector<std::thread> threads;
+  threads.reserve(models_.size());
+  for (auto& model : models_) {
+    model->recorder.set_origin_us(origin_us);
+    threads.emplace_back([model = model.get()]() {
+      if (model->cpu_mask != 0 && !SetCurrentThreadAffinity(model->cpu_mask)) {
+        TFLITE_LOG(WARN) << "Failed to set the CPU affinity of "
+                         << model->graph;
+      }
+      model->status = model->benchmark->Run();
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  monitor.Stop();
+
+  TFLITE_LOG(INFO) << "\n==============Summary of Concurrent Runs of All "
+                      "Models==============";
+  TfLiteStatus status = kTfLiteOk;
+  int64_t total_runs = 0;
+  int64_t first_start_us = std::numeric_limits<int64_t>::max();
+  int64_t last_end_us = 0;
+  const int64_t window_us =
+      params_.Get<float>("throttling_window_secs") * 1e6f;
+  const float threshold = params_.Get<float>("throttling_threshold");
+  for (const auto& model : models_) {
+    const std::vector<RunRecord>& runs = model->recorder.runs();
+    std::stringstream stream;
+    stream << model->graph << ": ";
+    if (model->status != kTfLiteOk) {
+      stream << "failed!";
+      status = model->status;
+    } else if (runs.empty()) {
+      stream << "no runs.";
+    } else {
+      int64_t sum_us = 0;
+      int64_t model_end_us = 0;
+      for (const RunRecord& run : runs) {
+        sum_us += run.duration_us;
+        model_end_us = std::max(model_end_us, run.start_us + run.duration_us);
+      }
+      const int64_t model_span_us = model_end_us - runs.front().start_us;
+      stream << "count=" << runs.size() << " avg=" << sum_us / runs.size()
+             << " p50=" << GetLatencyPercentileUs(runs, 50)
+             << " p90=" << GetLatencyPercentileUs(runs, 90)
+             << " p99=" << GetLatencyPercentileUs(runs, 99)
+             << " max=" << GetLatencyPercentileUs(runs, 100) << " (us)"
+             << " throughput=" << std::setprecision(4)
+             << runs.size() * 1e6 / std::max<int64_t>(model_span_us, 1)
+             << " runs/s";
+      const int64_t onset_us =
+          FindThrottlingOnsetUs(runs, window_us, threshold);
+      if (onset_us >= 0) {
+        stream << " throttling from " << onset_us / 1e6 << "s";
+      }
+      total_runs += runs.size();
+      first_start_us = std::min(first_start_us, runs.front().start_us);
+      last_end_us = std::max(last_end_us, model_end_us);
+    }
+    TFLITE_LOG(INFO) << stream.str();
+  }
+  if (total_runs > 0) {
+    const int64_t span_us = std::max<int64_t>(last_end_us - first_start_us, 1);
+    TFLITE_LOG(INFO) << "Aggregate throughput: " << total_runs * 1e6 / span_us
+                     << " runs/s over " << span_us / 1e6 << "s";
+  }
+
+  const float peak_mem_mb = monitor.GetPeakMemUsageInMB();
+  if (peak_mem_mb > 0) {
+    TFLITE_LOG(INFO) << "Overall peak memory footprint (MB): " << peak_mem_mb;
+    TFLITE_LOG(INFO) << "Peak memory footprint (MB) and temperature over time:";
+    for (const TimelineSample& sample : timeline->samples()) {
+      std::stringstream stream;
+      stream << "  " << std::fixed << std::setprecision(1)
+             << sample.time_us / 1e6 << "s: "
+             << sample.mem_footprint_kb / 1024.0 << " MB";
+      if (!std::isnan(sample.temperature_celsius)) {
+        stream << ", " << sample.temperature_celsius << " C";
+      }
+      TFLITE_LOG(INFO) << stream.str();
+    }
+  }
+  return status;
+}
+
+TfLiteStatus BenchmarkMultiModel::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first, leaving
+  // the single-model flags to every model.
+  if (TfLiteStatus status = ParseFlags(&argc, argv); status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for multi-model runs: "
+                      << status;
+    return status;
+  }
+  TF_LITE_ENSURE_STATUS(CreateModels(argc, argv));
+  return RunModels();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// A single regular (i.e. non-warmup) inference of a model.
+struct RunRecord {
+  // Start of the run, relative to the start of the concurrent runs.
+  int64_t start_us;
+  int64_t duration_us;
+};
+
+// Returns the duration below which `percentile` percent of `runs` are.
+int64_t GetLatencyPercentileUs(const std::vector<RunRecord>& runs,
+                               float percentile);
+
+// Returns the start of the first `window_us`-long window, after the first one,
+// where the average latency of `runs` exceeds the average of the first window
+// by more than `threshold` (e.g. 0.15 for 15%) in this window and the next
+// one. This is how thermal throttling of the CPU shows up in the latencies of
+// a fixed workload. Returns -1 if no window qualifies.
+int64_t FindThrottlingOnsetUs(const std::vector<RunRecord>& runs,
+                              int64_t window_us, float threshold);
+
+// Benchmarks several models running concurrently in the same process, the way
+// an app pipeline runs them, as opposed to BenchmarkModel which runs one model
+// at a time.
+//
+// Every model is benchmarked by its own BenchmarkModel on its own thread, with
+// its own arrival rate (--model_run_frequencies), number of threads
+// (--model_num_threads) and CPU affinity (--model_cpu_masks). The flags of the
+// single-model benchmark apply to all the models.
+//
+// Reports the latency distribution of every model, the aggregate throughput,
+// the onset of thermal throttling, and the peak memory footprint over time.
+class BenchmarkMultiModel {
+ public:
+  using ModelFactory = std::function<std::unique_ptr<BenchmarkModel>()>;
+
+  explicit BenchmarkMultiModel(ModelFactory create_model);
+  virtual ~BenchmarkMultiModel();
+
+  TfLiteStatus Run(int argc, char** argv);
+
+ protected:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  virtual std::vector<Flag> GetFlags();
+
+  // Creates and configures one benchmark per model in --graphs, parsing the
+  // single-model flags out of a copy of 'argv' for each of them.
+  TfLiteStatus CreateModels(int argc, char** argv);
+  TfLiteStatus RunModels();
+
+  BenchmarkParams params_;
+  ModelFactory create_model_;
+
+  struct Model;
+  std::vector<std::unique_ptr<Model>> models_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+class FakeBenchmarkModel : public BenchmarkModel {
+ public:
+  explicit FakeBenchmarkModel(std::atomic<int>* num_runs)
+      : BenchmarkModel(DefaultParams()), num_runs_(num_runs) {
+    params_.AddParam("graph", BenchmarkParam::Create<std::string>(""));
+  }
+
+  TfLiteStatus Init() override {
+    return params_.Get<std::string>("graph").empty() ? kTfLiteError
+                                                      : kTfLiteOk;
+  }
+
+ protected:
+  uint64_t ComputeInputBytes() override { return 0; }
+  TfLiteStatus RunImpl() override {
+    util::SleepForSeconds(0.001);
+    ++*num_runs_;
+    return kTfLiteOk;
+  }
+
+ private:
+  std::atomic<int>* num_runs_;
+};
+
+// Returns runs of 'durations_us' microseconds, one every 100ms.
+std::vector<RunRecord> RunsEvery100Ms(
+    const std::vector<int64_t>& durations_us) {
+  std::vector<RunRecord> runs;
+  for (size_t i = 0; i < durations_us.size(); ++i) {
+    runs.push_back({i * 100000, durations_us[i]});
+  }
+  return runs;
+}
+
+TEST(BenchmarkMultiModelTest, LatencyPercentiles) {
+  std::vector<int64_t> durations_us;
+  for (int i = 100; i > 0; --i) durations_us.push_back(i);
+  const std::vector<RunRecord> runs = RunsEvery100Ms(durations_us);
+
+  EXPECT_EQ(GetLatencyPercentileUs(runs, 0), 1);
+  EXPECT_EQ(GetLatencyPercentileUs(runs, 50), 50);
+  EXPECT_EQ(GetLatencyPercentileUs(runs, 99), 99);
+  EXPECT_EQ(GetLatencyPercentileUs(runs, 100), 100);
+  EXPECT_EQ(GetLatencyPercentileUs({}, 50), -1);
+}
+
+TEST(BenchmarkMultiModelTest, FindsThrottlingOnset) {
+  // 1s windows of 10 runs: 2 at 1000us, then 3 at 1300us.
+  std::vector<int64_t> durations_us(20, 1000);
+  durations_us.resize(50, 1300);
+  const std::vector<RunRecord> runs = RunsEvery100Ms(durations_us);
+
+  EXPECT_EQ(FindThrottlingOnsetUs(runs, /*window_us=*/1000000,
+                                  /*threshold=*/0.15f),
+            2000000);
+  EXPECT_EQ(FindThrottlingOnsetUs(runs, /*window_us=*/1000000,
+                                  /*threshold=*/0.5f),
+            -1);
+}
+
+TEST(BenchmarkMultiModelTest, IgnoresSingleSlowWindow) {
+  std::vector<int64_t> durations_us(30, 1000);
+  for (int i = 10; i < 20; ++i) durations_us[i] = 2000;
+  const std::vector<RunRecord> runs = RunsEvery100Ms(durations_us);
+
+  EXPECT_EQ(FindThrottlingOnsetUs(runs, /*window_us=*/1000000,
+                                  /*threshold=*/0.15f),
+            -1);
+}
+
+TEST(BenchmarkMultiModelTest, RunsAllModels) {
+  std::atomic<int> num_runs(0);
+  BenchmarkMultiModel benchmark([&num_runs]() {
+    return std::make_unique<FakeBenchmarkModel>(&num_runs);
+  });
+  std::vector<std::string> args = {
+      "benchmark",         "--graphs=a.tflite,b.tflite",
+      "--num_runs=5",      "--min_secs=0",
+      "--warmup_runs=0",   "--warmup_min_secs=0",
+      "--model_num_threads=1,2"};
+  std::vector<char*> argv;
+  for (std::string& arg : args) argv.push_back(arg.data());
+
+  EXPECT_EQ(benchmark.Run(argv.size(), argv.data()), kTfLiteOk);
+  EXPECT_EQ(num_runs, 10);
+}
+
+TEST(BenchmarkMultiModelTest, NeedsOneValuePerModel) {
+  std::atomic<int> num_runs(0);
+  BenchmarkMultiModel benchmark([&num_runs]() {
+    return std::make_unique<FakeBenchmarkModel>(&num_runs);
+  });
+  std::vector<std::string> args = {"benchmark", "--graphs=a.tflite,b.tflite",
+                                   "--model_run_frequencies=10"};
+  std::vector<char*> argv;
+  for (std::string& arg : args) argv.push_back(arg.data());
+
+  EXPECT_EQ(benchmark.Run(argv.size(), argv.data()), kTfLiteError);
+  EXPECT_EQ(num_runs, 0);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -46,6 +46,8 @@ class GpuDelegateProvider : public DelegateProvider {
     default_params_.AddParam("gpu_inference_for_sustained_speed",
                              ToolParam::Create<bool>(false));
     default_params_.AddParam("gpu_backend", ToolParam::Create<std::string>(""));
+    default_params_.AddParam("gpu_pipeline_invocations",
+                             ToolParam::Create<bool>(false));
 #endif
 #if defined(REAL_IPHONE_DEVICE)
     default_params_.AddParam("gpu_wait_type",
@@ -86,6 +88,12 @@ std::vector<Flag> GpuDelegateProvider::CreateFlags(ToolParams* params) const {
         "gpu_backend", params,
         "Force the GPU delegate to use a particular backend for execution, and "
         "fail if unsuccessful. Should be one of: cl, gl"),
+    CreateFlag<bool>("gpu_pipeline_invocations", params,
+                     "Whether to run the GPU partitions of an invocation "
+                     "concurrently with the CPU nodes of the next one, whose "
+                     "partition outputs then lag by one invocation. This is "
+                     "supported with the cl backend. By default, it's "
+                     "disabled."),
 #endif
 #if defined(REAL_IPHONE_DEVICE)
     CreateFlag<std::string>(
@@ -110,6 +118,8 @@ void GpuDelegateProvider::LogParams(const ToolParams& params,
   LOG_TOOL_PARAM(params, bool, "gpu_inference_for_sustained_speed",
                  "Prefer maximizing the throughput in gpu", verbose);
   LOG_TOOL_PARAM(params, std::string, "gpu_backend", "GPU backend", verbose);
+  LOG_TOOL_PARAM(params, bool, "gpu_pipeline_invocations",
+                 "Pipeline invocations in gpu", verbose);
 #endif
 #if defined(REAL_IPHONE_DEVICE)
   LOG_TOOL_PARAM(params, std::string, "gpu_wait_type", "GPU delegate wait type",
@@ -146,6 +156,10 @@ TfLiteDelegatePtr GpuDelegateProvider::CreateTfLiteDelegate(
         gpu_opts.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY;
       }
     }
+    if (params.Get<bool>("gpu_pipeline_invocations")) {
+      gpu_opts.experimental_flags |=
+          TFLITE_GPU_EXPERIMENTAL_FLAGS_PIPELINE_INVOCATIONS;
+    }
     gpu_opts.max_delegated_partitions =
         params.Get<int>("max_delegated_partitions");
 #ifdef TFLITE_DEBUG_DELEGATE
@@ -110,6 +110,8 @@ FullyConnectedOptionsWeightsFormatToSchema(
       return FullyConnectedOptionsWeightsFormat_DEFAULT;
     case kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8:
       return FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8;
+    case kTfLiteFullyConnectedWeightsFormatPacked4x32Int4:
+      return FullyConnectedOptionsWeightsFormat_PACKED4x32INT4;
   }
 }
 
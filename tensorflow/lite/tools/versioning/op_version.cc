@@ -173,6 +173,12 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
           reinterpret_cast<TfLiteFullyConnectedParams*>(op_sig.builtin_data);
       TFLITE_DCHECK(fully_connected_params != nullptr);
 
+      // Prepacked 4 bit weights are supported at version 13.
+      if (fully_connected_params->weights_format ==
+          kTfLiteFullyConnectedWeightsFormatPacked4x32Int4) {
+        return 13;
+      }
+
       if (op_sig.inputs.at(0).type == kTfLiteFloat32 &&
           op_sig.inputs.at(1).type == kTfLiteInt8 &&
           op_sig.outputs.at(0).type == kTfLiteFloat32 &&
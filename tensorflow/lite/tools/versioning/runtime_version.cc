@@ -133,6 +133,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
            {{BuiltinOperator_FULLY_CONNECTED, 10}, "2.11.0"},
            {{BuiltinOperator_FULLY_CONNECTED, 11}, "2.15.0"},
            {{BuiltinOperator_FULLY_CONNECTED, 12}, "2.17.0"},
+           {{BuiltinOperator_FULLY_CONNECTED, 13}, "2.18.0"},
            {{BuiltinOperator_GATHER, 1}, "1.6.0"},
            {{BuiltinOperator_GATHER, 2}, "1.14.0"},
            {{BuiltinOperator_GATHER, 3}, "1.15.0"},
@@ -218,6 +218,7 @@ def TFE_DeleteConfigKeyValue(arg0: object, arg1: str) -> None: ...
 def TFE_DeleteContext(arg0: object) -> None: ...
 def TFE_DeleteContextOptions(arg0: TFE_ContextOptions) -> None: ...
 def TFE_DeleteExecutor(arg0: TFE_Executor) -> None: ...
+def TFE_DlpackDevice(arg0: object) -> tuple: ...
 def TFE_EnableCollectiveOps(arg0: object, arg1: bytes) -> None: ...
 def TFE_ExecutorClearError(arg0: TFE_Executor) -> None: ...
 def TFE_ExecutorIsAsync(arg0: TFE_Executor) -> bool: ...
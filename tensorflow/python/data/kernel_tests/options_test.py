@@ -145,6 +145,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.autotune.enabled = True
     options.autotune.cpu_budget = 10
     options.autotune.ram_budget = 20
+    options.autotune.cache_path = "/tmp/autotune"
     options.deterministic = True
     options.experimental_external_state_policy = (
         options_lib.ExternalStatePolicy.FAIL)
@@ -156,6 +157,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.filter_parallelization = True
     options.experimental_optimization.inject_prefetch = False
     options.experimental_optimization.map_and_batch_fusion = True
+    options.experimental_optimization.map_and_batch_vectorization = True
     options.experimental_optimization.map_and_filter_fusion = True
     options.experimental_optimization.map_fusion = True
     options.experimental_optimization.map_parallelization = True
@@ -169,6 +171,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.framework_type = ["TFDS", "TfGrain"]
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.private_threadpool_numa_aware = True
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
@@ -38,6 +38,10 @@ from tensorflow.python.saved_model import nested_structure_coder
 # snapshot is not ready yet.
 _RETRY_INTERVAL_SEC = 5
 
+# Number of records each distributed snapshot chunk reads ahead of its
+# consumer, so that reading from remote storage overlaps with the pipeline.
+_CHUNK_READ_AHEAD = 8
+
 
 def _load(  # pylint: disable=unused-private-name
     path: str,
@@ -134,7 +138,8 @@ def _load_distributed_snapshot(
       lambda chunk_file: _SnapshotChunkDataset(  # pylint:disable=g-long-lambda
           chunk_file,
           element_spec=_parse_element_spec(metadata.element_spec),
-          compression=metadata.compression))
+          compression=metadata.compression,
+          read_ahead=_CHUNK_READ_AHEAD))
   return reader_func(dataset)
 
 
@@ -209,12 +214,18 @@ class _LoadDataset(dataset_ops.DatasetSource):
 class _SnapshotChunkDataset(dataset_ops.DatasetSource):
   """A dataset for one chunk file from a tf.data distributed snapshot."""
 
-  def __init__(self, chunk_file: str, element_spec: Any, compression: str):
+  def __init__(
+      self,
+      chunk_file: str,
+      element_spec: Any,
+      compression: str,
+      read_ahead: int = 0):
     self._chunk_file = chunk_file
     self._element_spec = element_spec
     variant_tensor = ged_ops.snapshot_chunk_dataset(
         chunk_file,
         compression=compression,
+        read_ahead=read_ahead,
         **self._flat_structure)
     super().__init__(variant_tensor)
 
@@ -45,12 +45,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  BAYESIAN: Fits a Gaussian process to the estimated performance of the
+  configurations evaluated so far and tunes all the parameters jointly, within
+  the CPU and RAM budgets, using fewer evaluations than HILL_CLIMB.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  BAYESIAN = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +69,11 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.BAYESIAN:
+      return model_pb2.AutotuneAlgorithm.BAYESIAN
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED`, and `BAYESIAN`. Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +87,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.BAYESIAN:
+      return cls.BAYESIAN
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `BAYESIAN`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")
@@ -241,6 +250,19 @@ class AutotuneOptions(options_lib.OptionsBase):
       ),
   )
 
+  cache_path = options_lib.create_option(
+      name="cache_path",
+      ty=str,
+      docstring=(
+          "When autotuning is enabled (through `autotune`), a directory where"
+          " the tuned parameter values are saved, keyed by a fingerprint of"
+          " the dataset graph and of the host. A later run of the same input"
+          " pipeline on the same kind of host starts from the saved values"
+          " instead of tuning from scratch. If None, the values are not"
+          " saved."
+      ),
+  )
+
   def _to_proto(self):
     pb = dataset_options_pb2.AutotuneOptions()
     if self.enabled is not None:
@@ -254,6 +276,8 @@ class AutotuneOptions(options_lib.OptionsBase):
           self.autotune_algorithm)
     if self.initial_parallelism is not None:
       pb.initial_parallelism = self.initial_parallelism
+    if self.cache_path is not None:
+      pb.cache_path = self.cache_path
     return pb
 
   def _from_proto(self, pb):
@@ -268,6 +292,8 @@ class AutotuneOptions(options_lib.OptionsBase):
           pb.autotune_algorithm)
     if pb.WhichOneof("optional_initial_parallelism") is not None:
       self.initial_parallelism = pb.initial_parallelism
+    if pb.WhichOneof("optional_cache_path") is not None:
+      self.cache_path = pb.cache_path
 
   def _set_mutable(self, mutable):
     """Change the mutability value to `mutable` on this options and children."""
@@ -377,6 +403,15 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to fuse map and batch transformations. If None, defaults to "
       "True.")
 
+  map_and_batch_vectorization = options_lib.create_option(
+      name="map_and_batch_vectorization",
+      ty=bool,
+      docstring=
+      "Whether to batch the input of a map transformation followed by a batch "
+      "transformation, so that an element-wise map function is invoked once "
+      "per batch. Only takes effect on maps of scalars without captured "
+      "inputs. If None, defaults to False.")
+
   map_and_filter_fusion = options_lib.create_option(
       name="map_and_filter_fusion",
       ty=bool,
@@ -429,6 +464,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.seq_interleave_prefetch = self.seq_interleave_prefetch
     if self.map_and_batch_fusion is not None:
       pb.map_and_batch_fusion = self.map_and_batch_fusion
+    if self.map_and_batch_vectorization is not None:
+      pb.map_and_batch_vectorization = self.map_and_batch_vectorization
     if self.map_and_filter_fusion is not None:
       pb.map_and_filter_fusion = self.map_and_filter_fusion
     if self.map_fusion is not None:
@@ -456,6 +493,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.seq_interleave_prefetch = pb.seq_interleave_prefetch
     if pb.WhichOneof("optional_map_and_batch_fusion") is not None:
       self.map_and_batch_fusion = pb.map_and_batch_fusion
+    if pb.WhichOneof("optional_map_and_batch_vectorization") is not None:
+      self.map_and_batch_vectorization = pb.map_and_batch_vectorization
     if pb.WhichOneof("optional_map_and_filter_fusion") is not None:
       self.map_and_filter_fusion = pb.map_and_filter_fusion
     if pb.WhichOneof("optional_map_fusion") is not None:
@@ -505,12 +544,26 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  private_threadpool_numa_aware = options_lib.create_option(
+      name="private_threadpool_numa_aware",
+      ty=bool,
+      docstring=
+      "If true, the threads of the private threadpool (see "
+      "`private_threadpool_size`) are split into one pool per NUMA node, with "
+      "their threads pinned to that node. Input processing is scheduled on "
+      "the pool of the NUMA node of the thread consuming the dataset, so that "
+      "it doesn't compete with compute threads on other nodes and its output "
+      "is produced near the memory it is consumed from. Has no effect on hosts "
+      "with a single NUMA node. If None, defaults to False.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.private_threadpool_numa_aware is not None:
+      pb.private_threadpool_numa_aware = self.private_threadpool_numa_aware
     return pb
 
   def _from_proto(self, pb):
@@ -518,6 +571,8 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_private_threadpool_numa_aware") is not None:
+      self.private_threadpool_numa_aware = pb.private_threadpool_numa_aware
 
 
 @tf_export("data.Options")
@@ -53,11 +53,23 @@ def from_dlpack(dlcapsule):
     # `a` uses the memory shared by dlpack
     ```
 
+  Objects implementing the DLPack protocol, such as NumPy arrays, can be
+  passed directly:
+
+    ```python
+    a = tf.experimental.dlpack.from_dlpack(np.ones([2, 3]))
+    ```
+
+  Host memory that is not aligned as TensorFlow kernels require is copied.
+
   Args:
-    dlcapsule: A PyCapsule named as dltensor
+    dlcapsule: A PyCapsule named as dltensor, or an object with a `__dlpack__`
+      method.
 
   Returns:
     A Tensorflow eager tensor
   """
+  if hasattr(dlcapsule, "__dlpack__"):
+    dlcapsule = dlcapsule.__dlpack__()
   context.context().ensure_initialized()
   return pywrap_tfe.TFE_FromDlpackCapsule(dlcapsule, context.context()._handle)  # pylint: disable=protected-access
@@ -110,6 +110,19 @@ class DLPackTest(parameterized.TestCase, test.TestCase):
     self.assertRaisesRegex(Exception, ".* is not supported by dlpack",
                            UnsupportedQint16)
 
+  def testDLPackProtocol(self):
+    np_array = np.arange(6, dtype=np.float32).reshape(2, 3)
+    tf_tensor = dlpack.from_dlpack(np_array)
+    self.assertAllEqual(np_array, tf_tensor)
+
+    with ops.device("CPU:0"):
+      cpu_tensor = constant_op.constant(np_array)
+    self.assertEqual(cpu_tensor.__dlpack_device__(), (1, 0))  # kDLCPU
+    tf_tensor2 = dlpack.from_dlpack(cpu_tensor)
+    self.assertAllEqual(np_array, tf_tensor2)
+    if hasattr(np, "from_dlpack"):
+      self.assertAllEqual(np_array, np.from_dlpack(cpu_tensor))
+
   def testMustPassTensorArgumentToDLPack(self):
     with self.assertRaisesRegex(
         errors.InvalidArgumentError,
@@ -1253,6 +1253,8 @@ class Context:
     rewriter_bool("disable_model_pruning")
     rewriter_toggle("scoped_allocator_optimization")
     rewriter_toggle("pin_to_host_optimization")
+    rewriter_toggle("horizontal_fusion")
+    rewriter_toggle("decode_image_fusion")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
     rewriter_toggle("use_plugin_optimizers")
@@ -2030,6 +2032,8 @@ class Context:
     rewriter_bool("disable_model_pruning")
     rewriter_toggle("scoped_allocator_optimization")
     rewriter_toggle("pin_to_host_optimization")
+    rewriter_toggle("horizontal_fusion")
+    rewriter_toggle("decode_image_fusion")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
     rewriter_toggle("use_plugin_optimizers")
@@ -60,6 +60,7 @@ TFTRT_PROFILE_STRATEGY = "_tftrt_profile_strategy"
 TFTRT_USE_CALIBRATION = "_tftrt_use_calibration"
 TFTRT_USE_IMPLICIT_BATCH = "_tftrt_use_implicit_batch"
 TIME_MAJOR = "time_major"
+XLA_BATCH_BUCKETS = "_XlaBatchBuckets"
 XLA_COMPILE = "_XlaMustCompile"
 XLA_COMPILE_OPTIONAL = "_XlaCompile"
 XLA_SCOPE = "_XlaScope"
@@ -78,6 +79,7 @@ POLYMORPHIC_FUNCTION_ALLOWLIST = frozenset({
     TF_DATA_FUNCTION,
     TIME_MAJOR,
     OUTPUTS_ON_OP_DEVICE,
+    XLA_BATCH_BUCKETS,
 })
 
 TRACING_COMPILATION_ALLOWLIST = frozenset().union(
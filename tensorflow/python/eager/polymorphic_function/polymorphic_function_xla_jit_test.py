@@ -417,6 +417,87 @@ class FunctionTest(xla_test.XLATestCase):
 
       self.assertAllGreater(g(array_ops.zeros([7])), 0.)
 
+  def _skipUnlessBatchBucketsSupported(self):
+    # XlaLaunch only pads batches on CPU and GPU, not on XLA devices.
+    if 'tpu' in self.device.lower() or 'xla' in self.device.lower():
+      self.skipTest('Batch buckets are not supported on XLA devices')
+
+  def _batchBucketsFunctions(self, buckets):
+    """Returns a function and its padded version reporting their batch size."""
+
+    def fn(x, y):
+      # The shape of `x` reveals the size of the padded batch. It is not
+      # batch-shaped as long as no bucket is 2.
+      return x * 2.0 + y, array_ops.shape(x)
+
+    signature = [
+        tensor.TensorSpec(shape=[None, 3], dtype=dtypes.float32),
+        tensor.TensorSpec(shape=[None, 3], dtype=dtypes.float32),
+    ]
+    xla_func = polymorphic_function.function(
+        fn, input_signature=signature, jit_compile=True)
+    padded_func = polymorphic_function.function(
+        fn,
+        input_signature=signature,
+        jit_compile=True,
+        experimental_attributes={'_XlaBatchBuckets': buckets})
+    return xla_func, padded_func
+
+  def testBatchBucketsPadToSmallestBucket(self):
+    self._skipUnlessBatchBucketsSupported()
+    with ops.device('device:{}:0'.format(self.device)):
+      xla_func, padded_func = self._batchBucketsFunctions([8, 4])
+      for batch_size, bucket in [(1, 4), (3, 4), (4, 4), (5, 8), (8, 8)]:
+        x = random_ops.random_normal([batch_size, 3])
+        y = random_ops.random_normal([batch_size, 3])
+        result, shape = padded_func(x, y)
+        self.assertAllEqual([bucket, 3], shape)
+        # The outputs are sliced back to the batch of the inputs.
+        self.assertAllClose(xla_func(x, y)[0], result)
+
+  def testBatchBucketsDefaultToPowersOfTwo(self):
+    self._skipUnlessBatchBucketsSupported()
+    with ops.device('device:{}:0'.format(self.device)):
+      xla_func, padded_func = self._batchBucketsFunctions([])
+      for batch_size, bucket in [(1, 1), (3, 4), (5, 8), (9, 16)]:
+        x = random_ops.random_normal([batch_size, 3])
+        y = random_ops.random_normal([batch_size, 3])
+        result, shape = padded_func(x, y)
+        self.assertAllEqual([bucket, 3], shape)
+        self.assertAllClose(xla_func(x, y)[0], result)
+
+  def testBatchBucketsLeaveBatchesLargerThanEveryBucket(self):
+    self._skipUnlessBatchBucketsSupported()
+    with ops.device('device:{}:0'.format(self.device)):
+      xla_func, padded_func = self._batchBucketsFunctions([4, 8])
+      x = random_ops.random_normal([11, 3])
+      y = random_ops.random_normal([11, 3])
+      result, shape = padded_func(x, y)
+      self.assertAllEqual([11, 3], shape)
+      self.assertAllClose(xla_func(x, y)[0], result)
+
+  def testBatchBucketsLeaveInputsOfDifferentBatchesUnpadded(self):
+    self._skipUnlessBatchBucketsSupported()
+    with ops.device('device:{}:0'.format(self.device)):
+
+      @polymorphic_function.function(
+          input_signature=[
+              tensor.TensorSpec(shape=[None, 3], dtype=dtypes.float32),
+              tensor.TensorSpec(shape=[None], dtype=dtypes.float32),
+          ],
+          jit_compile=True,
+          experimental_attributes={'_XlaBatchBuckets': [4, 8]})
+      def f(x, y):
+        return (math_ops.reduce_sum(x, axis=1), math_ops.reduce_sum(y),
+                array_ops.shape(x))
+
+      x = random_ops.random_normal([3, 3])
+      y = random_ops.random_normal([5])
+      x_sum, y_sum, shape = f(x, y)
+      self.assertAllEqual([3, 3], shape)
+      self.assertAllClose(math_ops.reduce_sum(x, axis=1), x_sum)
+      self.assertAllClose(math_ops.reduce_sum(y), y_sum)
+
   def testNestedWhileLoopWithUnmodifiedCarriedShape(self):
     with ops.device('device:{}:0'.format(self.device)):
       signature = [tensor.TensorSpec(shape=[None], dtype=dtypes.float32)]
@@ -392,20 +392,44 @@ TFE_TensorHandle* ConvertToEagerTensorUncached(TFE_Context* ctx,
   return handle.release();
 }
 
+namespace {
+
+// Python and NumPy real scalars are immutable and hashable, so the handles
+// they are converted to can be reused for equal values of the same type.
+bool IsCacheableScalar(PyObject* value) {
+  return PyArray_IsPythonNumber(value) || PyArray_IsScalar(value, Integer) ||
+         PyArray_IsScalar(value, Bool) || PyArray_IsScalar(value, Floating);
+}
+
+// Non-finite floats are not cached: NaNs never compare equal, so their cache
+// entries could never be hit.
+bool IsNonFiniteFloat(PyObject* value) {
+  if (PyFloat_Check(value)) return !std::isfinite(PyFloat_AS_DOUBLE(value));
+  if (PyArray_IsScalar(value, Floating)) {
+    const double d = PyFloat_AsDouble(value);
+    if (d == -1.0 && PyErr_Occurred()) {
+      PyErr_Clear();
+      return true;
+    }
+    return !std::isfinite(d);
+  }
+  return false;
+}
+
+}  // namespace
+
 TFE_TensorHandle* ConvertToEagerTensor(TFE_Context* ctx, PyObject* value,
                                        DataType dtype,
                                        const char* device_name) {
-  // Reduce the overhead of allocation/transfer-to-device for scalars by
-  // caching the corresponding handles. Note that currently only Python
-  // scalars are cached.
-  // TODO(slebedev): also cache singleton NumPy arrays and scalars?
-  if (PyArray_IsPythonNumber(value)) {
+  // Reduce the overhead of allocation/transfer-to-device for scalars, e.g.
+  // constants fed repeatedly, by caching the corresponding handles.
+  if (IsCacheableScalar(value)) {
     auto* cache = TFE_TensorHandleCache::Get();
     TFE_TensorHandle* handle = cache->Lookup(value, dtype, ctx, device_name);
     if (handle != nullptr) return handle;
     handle = ConvertToEagerTensorUncached(ctx, value, dtype, device_name);
     if (handle == nullptr) return nullptr;
-    if (!PyFloat_Check(value) || std::isfinite(PyFloat_AS_DOUBLE(value))) {
+    if (!IsNonFiniteFloat(value)) {
       cache->Insert(value, dtype, ctx, device_name, handle);
     }
     return handle;
@@ -279,6 +279,10 @@ PyObject* TFE_Py_TapeGradient(PyObject* tape, PyObject* target,
 // directive.
 PyObject* TFE_Py_FastPathExecute_C(PyObject* args);
 
+// Clears the attrs that TFE_Py_FastPathExecute_C converted for repeated calls,
+// e.g. before their context is destroyed.
+void TFE_Py_ClearFastPathAttrsCache();
+
 // Record the gradient for a given op.
 PyObject* TFE_Py_RecordGradient(PyObject* op_name, PyObject* inputs,
                                 PyObject* attrs, PyObject* results,
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <atomic>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -133,6 +134,89 @@ void ReturnOp(TFE_Context* ctx, TFE_Op* op) {
   }
 }
 
+// Returns true if `value` is an immutable attr value that converts the same
+// way whenever it is identical to another, so that its conversion can be
+// reused.
+bool IsCacheableAttrValue(PyObject* value) {
+  if (value == Py_None || PyBool_Check(value) || PyLong_CheckExact(value) ||
+      PyUnicode_CheckExact(value) || PyBytes_CheckExact(value)) {
+    return true;
+  }
+  if (PyFloat_CheckExact(value)) {
+    return !std::isnan(PyFloat_AS_DOUBLE(value));
+  }
+  if (PyTuple_CheckExact(value)) {
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(value); ++i) {
+      if (!IsCacheableAttrValue(PyTuple_GET_ITEM(value, i))) return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Unlike Python equality, requires equal types (1 != True != 1.0) and tells
+// 0.0 and -0.0 apart.
+bool AttrValuesAreIdentical(PyObject* a, PyObject* b) {
+  if (Py_TYPE(a) != Py_TYPE(b)) return false;
+  if (PyTuple_CheckExact(a)) {
+    if (PyTuple_GET_SIZE(a) != PyTuple_GET_SIZE(b)) return false;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(a); ++i) {
+      if (!AttrValuesAreIdentical(PyTuple_GET_ITEM(a, i),
+                                  PyTuple_GET_ITEM(b, i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (PyFloat_CheckExact(a)) {
+    const double a_value = PyFloat_AS_DOUBLE(a);
+    const double b_value = PyFloat_AS_DOUBLE(b);
+    return std::memcmp(&a_value, &b_value, sizeof(double)) == 0;
+  }
+  return PyObject_RichCompareBool(a, b, Py_EQ) > 0;
+}
+
+// The op and the non-inferred attrs, i.e. the `(name, value, ...)` tuple, of a
+// fast path call.
+struct FastPathAttrsKey {
+  TFE_Context* ctx;
+  std::string op_name;
+  // Owned by the FastPathAttrsRecord of the key when in the cache.
+  PyObject* attrs;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const FastPathAttrsKey& key) {
+    return H::combine(std::move(h), key.ctx, key.op_name,
+                      PyObject_Hash(key.attrs));
+  }
+
+  bool operator==(const FastPathAttrsKey& other) const {
+    return ctx == other.ctx && op_name == other.op_name &&
+           AttrValuesAreIdentical(attrs, other.attrs);
+  }
+};
+
+// The non-inferred attrs of a fast path call, converted for the op.
+struct FastPathAttrsRecord {
+  tensorflow::Safe_PyObjectPtr attrs;
+  // An op that only holds the converted attrs, to add them to others.
+  std::unique_ptr<TFE_Op, OpDeleter> op;
+  tensorflow::gtl::FlatMap<string, int64_t> attr_list_sizes;
+};
+
+// Repeated fast path calls of an op with the same attrs reuse their
+// conversion from Python. Not guarded by a mutex because it is only used while
+// the GIL is held.
+absl::flat_hash_map<FastPathAttrsKey, std::unique_ptr<FastPathAttrsRecord>>*
+GetFastPathAttrsCache() {
+  static auto* cache = new absl::flat_hash_map<
+      FastPathAttrsKey, std::unique_ptr<FastPathAttrsRecord>>();
+  return cache;
+}
+
+// Bounds the cache for programs running ops with many different attrs.
+constexpr size_t kMaxFastPathAttrsRecords = 1024;
+
 TF_Status* ReleaseThreadLocalStatus() {
   if (thread_local_tf_status == nullptr) {
     return nullptr;
@@ -3678,6 +3762,8 @@ bool RunCallbacks(
 
 }  // namespace
 
+void TFE_Py_ClearFastPathAttrsCache() { GetFastPathAttrsCache()->clear(); }
+
 PyObject* TFE_Py_FastPathExecute_C(PyObject* args) {
   tsl::profiler::TraceMe activity("TFE_Py_FastPathExecute_C",
                                   tsl::profiler::TraceMeLevel::kInfo);
@@ -3789,10 +3875,26 @@ PyObject* TFE_Py_FastPathExecute_C(PyObject* args) {
   // to be expected by the TFE_Execute run.
   tensorflow::gtl::FlatMap<string, int64_t> attr_list_sizes;
 
+  const int attrs_start =
+      FAST_PATH_EXECUTE_ARG_INPUT_START + op_def->input_arg_size();
+  tensorflow::Safe_PyObjectPtr py_attrs(
+      PyTuple_GetSlice(args, attrs_start, args_size));
+  if (py_attrs == nullptr) return nullptr;
+  const bool cache_attrs = IsCacheableAttrValue(py_attrs.get());
+  auto* attrs_cache = GetFastPathAttrsCache();
+  bool attrs_are_cached = false;
+  if (cache_attrs) {
+    auto it = attrs_cache->find(FastPathAttrsKey{ctx, op_name, py_attrs.get()});
+    if (it != attrs_cache->end()) {
+      TFE_OpAddAttrs(op, TFE_OpGetAttrs(it->second->op.get()));
+      attr_list_sizes = it->second->attr_list_sizes;
+      attrs_are_cached = true;
+    }
+  }
+
   // Set non-inferred attrs, including setting defaults if the attr is passed in
   // as None.
-  for (int i = FAST_PATH_EXECUTE_ARG_INPUT_START + op_def->input_arg_size();
-       i < args_size; i += 2) {
+  for (int i = attrs_start; !attrs_are_cached && i < args_size; i += 2) {
     PyObject* py_attr_name = PyTuple_GET_ITEM(args, i);
     const char* attr_name = TFE_GetPythonString(py_attr_name);
     PyObject* py_attr_value = PyTuple_GET_ITEM(args, i + 1);
@@ -3819,6 +3921,25 @@ PyObject* TFE_Py_FastPathExecute_C(PyObject* args) {
     }
   }
 
+  if (cache_attrs && !attrs_are_cached) {
+    // Records the attrs before the inferred ones are added to the op.
+    auto record = std::make_unique<FastPathAttrsRecord>();
+    record->op.reset(TFE_NewOp(ctx, op_name, status));
+    if (TF_GetCode(status) != TF_OK) {
+      // Only the caching failed.
+      TF_SetStatus(status, TF_OK, "");
+    } else {
+      TFE_OpAddAttrs(record->op.get(), TFE_OpGetAttrs(op));
+      record->attr_list_sizes = attr_list_sizes;
+      FastPathAttrsKey key{ctx, op_name, py_attrs.get()};
+      record->attrs = std::move(py_attrs);
+      if (attrs_cache->size() >= kMaxFastPathAttrsRecords) {
+        attrs_cache->clear();
+      }
+      attrs_cache->emplace(std::move(key), std::move(record));
+    }
+  }
+
   // Flat attrs and inputs as required by the record_gradient call. The attrs
   // here only contain inferred attrs (non-inferred attrs are added directly
   // from the input args).
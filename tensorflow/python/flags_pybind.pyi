@@ -19,6 +19,7 @@ class Flag:
     def value(self) -> bool: ...
 
 class Flags:
+    deduplicate_partitioned_embedding_ids: Flag
     enable_aggressive_constant_replication: Flag
     enable_colocation_key_propagation_in_while_op_lowering: Flag
     enable_nested_function_shape_inference: Flag
@@ -239,6 +239,13 @@ def set_optimizer_experimental_options(options):
       - scoped_allocator_optimization: Try to allocate some independent Op
         outputs contiguously in order to merge or eliminate downstream Ops.
       - pin_to_host_optimization: Force small ops onto the CPU.
+      - horizontal_fusion: Fuse the independent ops of the same batchable type
+        and attributes, e.g. StringToHashBucketFast or the sparse segment
+        reductions of embedding lookups, placed on the same device into a
+        single op.
+      - decode_image_fusion: Fuse the decoding, cropping and resizing of JPEG
+        images into a single op, which decodes them at a reduced scale when
+        they are resized to a smaller size.
       - implementation_selector: Enable the swap of kernel implementations based
         on the device placement.
       - auto_mixed_precision: Change certain float32 ops to float16 on Volta
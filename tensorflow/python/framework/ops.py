@@ -360,6 +360,28 @@ class _EagerTensorBase(
 
     return np.array(a, dtype=dtype)
 
+  def __dlpack__(self, stream=None, max_version=None):
+    """Returns a DLPack capsule sharing the memory of this tensor.
+
+    Implements the DLPack protocol, so that e.g. `np.from_dlpack(t)` views the
+    contents of a CPU tensor without a copy. The memory is ready when this
+    returns, so `stream` is ignored, and the capsule is always of the
+    unversioned kind, which consumers asking for `max_version` accept.
+
+    Args:
+      stream: Ignored.
+      max_version: Ignored.
+
+    Returns:
+      A PyCapsule named "dltensor", which can be consumed only once.
+    """
+    del stream, max_version
+    return pywrap_tfe.TFE_ToDlpackCapsule(self)
+
+  def __dlpack_device__(self) -> tuple[int, int]:
+    """Returns the DLPack `(device_type, device_id)` of this tensor's memory."""
+    return pywrap_tfe.TFE_DlpackDevice(self)
+
   def __hash__(self) -> int:
     # EagerTensors are never hashable.
     raise TypeError("Tensor is unhashable. "
@@ -0,0 +1,188 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =============================================================================
+"""Predicts the step time and peak memory of a graph on simulated devices.
+
+The predictions come from a virtual cluster, which runs the graph through the
+VirtualScheduler with the AnalyticalCostEstimator instead of executing it. They
+can be calibrated against the step time measured on the local machine.
+"""
+
+import collections
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.core.protobuf import meta_graph_pb2
+from tensorflow.python.grappler import cluster as gcluster
+from tensorflow.python.grappler import item as gitem
+from tensorflow.python.grappler import tf_optimizer
+
+
+class Prediction(
+    collections.namedtuple("Prediction", [
+        "batch_size", "placement", "rewriter_config", "run_time",
+        "peak_memory"
+    ])):
+  """The predicted cost of running one configuration of a graph.
+
+  Attributes:
+    batch_size: the batch size fed to the placeholders, or None if the graph
+      was left unchanged.
+    placement: the device all the nodes were placed on, or None if the
+      placement of the graph was kept.
+    rewriter_config: the RewriterConfig the graph was optimized with, or None
+      if it was not optimized.
+    run_time: the predicted step time in seconds.
+    peak_memory: a dict from device name to its predicted peak memory usage in
+      bytes.
+  """
+  __slots__ = ()
+
+
+def SetBatchSize(metagraph, batch_size):
+  """Returns a copy of `metagraph` whose placeholders are fed `batch_size`.
+
+  The first dimension of every placeholder with a shape of rank 1 or more is
+  set to `batch_size`, which is how the batch dimension of serving graphs is
+  laid out.
+
+  Args:
+    metagraph: a MetaGraphDef protobuf.
+    batch_size: the size of the batch dimension.
+
+  Returns:
+    A MetaGraphDef protobuf.
+  """
+  if batch_size <= 0:
+    raise ValueError(f"Invalid batch size: {batch_size}.")
+  batched = meta_graph_pb2.MetaGraphDef()
+  batched.CopyFrom(metagraph)
+  for node in batched.graph_def.node:
+    if node.op not in ("Placeholder", "PlaceholderV2"):
+      continue
+    shape = node.attr["shape"].shape
+    if shape.unknown_rank or not shape.dim:
+      continue
+    shape.dim[0].size = batch_size
+  for signature in batched.signature_def.values():
+    for tensor_info in signature.inputs.values():
+      shape = tensor_info.tensor_shape
+      if not shape.unknown_rank and shape.dim:
+        shape.dim[0].size = batch_size
+  return batched
+
+
+def SetPlacement(metagraph, device):
+  """Returns a copy of `metagraph` with all its nodes placed on `device`."""
+  placed = meta_graph_pb2.MetaGraphDef()
+  placed.CopyFrom(metagraph)
+  for node in placed.graph_def.node:
+    node.device = device
+  return placed
+
+
+def PredictCost(metagraph, cluster):
+  """Predicts the step time and peak memory of `metagraph` on `cluster`.
+
+  Args:
+    metagraph: a MetaGraphDef protobuf. Its fetch nodes are in the "train_op"
+      collection or in the outputs of its signatures.
+    cluster: a virtual Cluster.
+
+  Returns:
+    A tuple of the predicted step time in seconds and a dict from device name
+    to its predicted peak memory usage in bytes.
+  """
+  item = gitem.Item(metagraph)
+  _, run_time, _ = cluster.MeasureCosts(item)
+  peak_memory = {
+      device: usage[0]
+      for device, usage in cluster.DeterminePeakMemoryUsage(item).items()
+  }
+  return run_time, peak_memory
+
+
+def Calibrate(metagraph):
+  """Returns the ratio of the measured to the predicted step time.
+
+  The graph is run on the local machine, and its step time is compared to the
+  one predicted on a virtual cluster with the same devices. Predictions for
+  other batch sizes or devices can be scaled by the ratio to account for the
+  costs the analytical model leaves out.
+
+  Args:
+    metagraph: a MetaGraphDef protobuf whose placeholders have fully defined
+      shapes.
+
+  Returns:
+    The calibration ratio, or 1 if no step time could be predicted.
+  """
+  with gcluster.Provision() as local_cluster:
+    devices = local_cluster.ListDevices()
+    _, measured_run_time, _ = local_cluster.MeasureCosts(gitem.Item(metagraph))
+  with gcluster.Provision(devices=devices) as virtual_cluster:
+    predicted_run_time, _ = PredictCost(metagraph, virtual_cluster)
+  if predicted_run_time <= 0:
+    return 1.0
+  return measured_run_time / predicted_run_time
+
+
+def PredictStepTimes(metagraph,
+                     devices,
+                     batch_sizes=None,
+                     placements=None,
+                     rewriter_configs=None,
+                     calibration=1.0):
+  """Predicts the cost of `metagraph` for every combination of the configs.
+
+  Args:
+    metagraph: a MetaGraphDef protobuf.
+    devices: a list of NamedDevice protobufs describing the simulated hardware.
+    batch_sizes: a list of batch sizes to feed the placeholders with, or None
+      to keep their shapes.
+    placements: a list of device names to place all the nodes on, or None to
+      keep the placement of the graph.
+    rewriter_configs: a list of RewriterConfig protobufs to optimize the graph
+      with before predicting its cost, or None to predict the cost of the graph
+      as is.
+    calibration: the ratio the predicted step times are scaled by, as returned
+      by `Calibrate`.
+
+  Returns:
+    A list of Prediction, one per combination of the configurations.
+  """
+  predictions = []
+  with gcluster.Provision(devices=devices) as cluster:
+    for batch_size in batch_sizes or [None]:
+      batched = metagraph
+      if batch_size is not None:
+        batched = SetBatchSize(metagraph, batch_size)
+      for placement in placements or [None]:
+        placed = batched
+        if placement is not None:
+          placed = SetPlacement(batched, placement)
+        for rewriter_config in rewriter_configs or [None]:
+          optimized = placed
+          if rewriter_config is not None:
+            config = config_pb2.ConfigProto()
+            config.graph_options.rewrite_options.CopyFrom(rewriter_config)
+            optimized = meta_graph_pb2.MetaGraphDef()
+            optimized.CopyFrom(placed)
+            optimized.graph_def.CopyFrom(
+                tf_optimizer.OptimizeGraph(
+                    config, placed, verbose=False, cluster=cluster))
+          run_time, peak_memory = PredictCost(optimized, cluster)
+          predictions.append(
+              Prediction(batch_size, placement, rewriter_config,
+                         run_time * calibration, peak_memory))
+  return predictions
@@ -0,0 +1,96 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the step time predictor."""
+
+from tensorflow.core.protobuf import device_properties_pb2
+from tensorflow.core.protobuf import rewriter_config_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import meta_graph
+from tensorflow.python.framework import ops
+from tensorflow.python.grappler import step_time_predictor
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import random_ops
+from tensorflow.python.platform import test
+
+
+class StepTimePredictorTest(test.TestCase):
+
+  def _BuildMetaGraph(self):
+    with ops.Graph().as_default() as g:
+      x = array_ops.placeholder(dtypes.float32, shape=[None, 256], name='x')
+      w = random_ops.random_uniform([256, 256], name='w')
+      y = math_ops.matmul(x, w, name='y')
+      train_op = ops.get_collection_ref(ops.GraphKeys.TRAIN_OP)
+      train_op.append(y)
+      return meta_graph.create_meta_graph_def(graph=g)
+
+  def _Devices(self):
+    device_properties = device_properties_pb2.DeviceProperties(
+        type='GPU',
+        frequency=1000,
+        num_cores=60,
+        memory_size=1 << 34,
+        bandwidth=900000000,
+        environment={'architecture': '7'})
+    return [
+        device_properties_pb2.NamedDevice(
+            properties=device_properties,
+            name='/job:localhost/replica:0/task:0/device:GPU:0')
+    ]
+
+  def testSetBatchSize(self):
+    mg = step_time_predictor.SetBatchSize(self._BuildMetaGraph(), 8)
+    for node in mg.graph_def.node:
+      if node.name == 'x':
+        self.assertEqual([8, 256],
+                         [dim.size for dim in node.attr['shape'].shape.dim])
+
+  def testStepTimeGrowsWithBatchSize(self):
+    predictions = step_time_predictor.PredictStepTimes(
+        self._BuildMetaGraph(), self._Devices(), batch_sizes=[1, 1024])
+    self.assertEqual([1, 1024], [p.batch_size for p in predictions])
+    self.assertLess(0, predictions[0].run_time)
+    self.assertLess(predictions[0].run_time, predictions[1].run_time)
+    self.assertLess(
+        max(predictions[0].peak_memory.values()),
+        max(predictions[1].peak_memory.values()))
+
+  def testCalibrationScalesStepTimes(self):
+    mg = self._BuildMetaGraph()
+    predictions = step_time_predictor.PredictStepTimes(
+        mg, self._Devices(), batch_sizes=[64])
+    calibrated = step_time_predictor.PredictStepTimes(
+        mg, self._Devices(), batch_sizes=[64], calibration=2.0)
+    self.assertAllClose(2 * predictions[0].run_time, calibrated[0].run_time)
+
+  def testSweepsRewriterConfigs(self):
+    rewriter_configs = [
+        rewriter_config_pb2.RewriterConfig(),
+        rewriter_config_pb2.RewriterConfig(
+            constant_folding=rewriter_config_pb2.RewriterConfig.OFF)
+    ]
+    predictions = step_time_predictor.PredictStepTimes(
+        self._BuildMetaGraph(),
+        self._Devices(),
+        batch_sizes=[2, 4],
+        rewriter_configs=rewriter_configs)
+    self.assertEqual(4, len(predictions))
+    for prediction in predictions:
+      self.assertLess(0, prediction.run_time)
+
+
+if __name__ == '__main__':
+  test.main()
@@ -0,0 +1,181 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =============================================================================
+"""A tool to predict step times over batch sizes, placements and rewrites."""
+
+import argparse
+import sys
+
+from absl import app
+
+from google.protobuf import message
+from google.protobuf import text_format
+from tensorflow.core.framework import graph_pb2
+from tensorflow.core.protobuf import device_properties_pb2
+from tensorflow.core.protobuf import meta_graph_pb2
+from tensorflow.core.protobuf import rewriter_config_pb2
+from tensorflow.core.protobuf import saved_model_pb2
+from tensorflow.python.framework import importer
+from tensorflow.python.framework import ops
+from tensorflow.python.grappler import step_time_predictor
+from tensorflow.python.platform import gfile
+from tensorflow.python.training import saver
+
+
+def get_metagraph():
+  """Constructs and returns a MetaGraphDef from the input file."""
+  with gfile.GFile(FLAGS.input) as input_file:
+    input_data = input_file.read()
+    try:
+      saved_model = saved_model_pb2.SavedModel()
+      text_format.Merge(input_data, saved_model)
+      meta_graph = saved_model.meta_graphs[0]
+    except text_format.ParseError:
+      try:
+        saved_model.ParseFromString(input_data)
+        meta_graph = saved_model.meta_graphs[0]
+      except message.DecodeError:
+        try:
+          meta_graph = meta_graph_pb2.MetaGraphDef()
+          text_format.Merge(input_data, meta_graph)
+        except text_format.ParseError:
+          try:
+            meta_graph.ParseFromString(input_data)
+          except message.DecodeError:
+            try:
+              graph_def = graph_pb2.GraphDef()
+              text_format.Merge(input_data, graph_def)
+            except text_format.ParseError:
+              try:
+                graph_def.ParseFromString(input_data)
+              except message.DecodeError:
+                raise ValueError(f"Invalid input file: {FLAGS.input}.")
+            importer.import_graph_def(graph_def, name="")
+            graph = ops.get_default_graph()
+            meta_graph = saver.export_meta_graph(
+                graph_def=graph.as_graph_def(), graph=graph)
+  if FLAGS.fetch is not None:
+    fetch_collection = meta_graph_pb2.CollectionDef()
+    for fetch in FLAGS.fetch.split(","):
+      fetch_collection.node_list.value.append(fetch)
+    meta_graph.collection_def["train_op"].CopyFrom(fetch_collection)
+  return meta_graph
+
+
+def get_devices():
+  """Parses the simulated devices from the device flags."""
+  devices = []
+  for device_text in FLAGS.device:
+    device = device_properties_pb2.NamedDevice()
+    text_format.Merge(device_text, device)
+    devices.append(device)
+  return devices
+
+
+def main(_):
+  metagraph = get_metagraph()
+  devices = get_devices()
+  if not devices:
+    raise ValueError("At least one device must be given with --device.")
+  batch_sizes = None
+  if FLAGS.batch_sizes is not None:
+    batch_sizes = [int(size) for size in FLAGS.batch_sizes.split(",")]
+  placements = None
+  if FLAGS.placements is not None:
+    placements = FLAGS.placements.split(",")
+  rewriter_configs = None
+  if FLAGS.rewriter_config:
+    rewriter_configs = []
+    for config_text in FLAGS.rewriter_config:
+      rewriter_config = rewriter_config_pb2.RewriterConfig()
+      text_format.Merge(config_text, rewriter_config)
+      rewriter_configs.append(rewriter_config)
+
+  calibration = 1.0
+  if FLAGS.calibration_batch_size is not None:
+    calibration = step_time_predictor.Calibrate(
+        step_time_predictor.SetBatchSize(metagraph,
+                                         FLAGS.calibration_batch_size))
+    print(f"Calibration ratio (measured/predicted): {calibration:.3f}")
+
+  predictions = step_time_predictor.PredictStepTimes(
+      metagraph, devices, batch_sizes, placements, rewriter_configs,
+      calibration)
+  print("batch_size\tplacement\trewriter_config\tstep_time_us\t"
+        "peak_memory_bytes")
+  for prediction in predictions:
+    rewriter_config = "default"
+    if prediction.rewriter_config is not None:
+      rewriter_config = text_format.MessageToString(
+          prediction.rewriter_config, as_one_line=True)
+    peak_memory = ",".join(
+        f"{device}={usage}"
+        for device, usage in sorted(prediction.peak_memory.items()))
+    print(f"{prediction.batch_size}\t{prediction.placement}\t"
+          f"{rewriter_config}\t{prediction.run_time * 1e6:.1f}\t{peak_memory}")
+
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      "--input",
+      type=str,
+      default=None,
+      help="Input file path. Accept SavedModel, MetaGraphDef, and GraphDef in "
+      "either binary or text format.")
+  parser.add_argument(
+      "--fetch",
+      type=str,
+      default=None,
+      help="The names of the fetch node delimited by comma.")
+  parser.add_argument(
+      "--device",
+      type=str,
+      action="append",
+      default=[],
+      help="A simulated device, described as a NamedDevice protocol buffer. "
+      "Can be repeated to simulate several devices. Usage example: "
+      "--device=\"name: '/job:localhost/replica:0/task:0/device:GPU:0' "
+      "properties { type: 'GPU' frequency: 1000 num_cores: 60 memory_size: "
+      "17179869184 bandwidth: 900000000 environment { key: 'architecture' "
+      "value: '7' } }\"")
+  parser.add_argument(
+      "--batch_sizes",
+      type=str,
+      default=None,
+      help="The batch sizes fed to the placeholders delimited by comma. By "
+      "default the shapes of the placeholders are kept.")
+  parser.add_argument(
+      "--placements",
+      type=str,
+      default=None,
+      help="The devices to place all the nodes on delimited by comma. By "
+      "default the placement of the graph is kept.")
+  parser.add_argument(
+      "--rewriter_config",
+      type=str,
+      action="append",
+      default=None,
+      help="Configuration for the grappler optimizers, described as a "
+      "RewriterConfig protocol buffer. Can be repeated to compare several "
+      "configurations. By default the graph is not optimized.")
+  parser.add_argument(
+      "--calibration_batch_size",
+      type=int,
+      default=None,
+      help="If set, the graph is run on the local machine with this batch "
+      "size, and the predictions are scaled by the ratio of the measured to "
+      "the predicted step time.")
+  FLAGS, unparsed = parser.parse_known_args()
+  app.run(main=main, argv=[sys.argv[0]] + unparsed)
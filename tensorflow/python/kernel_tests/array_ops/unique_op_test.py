@@ -45,6 +45,20 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testInt64Large(self):
+    # Large enough to be uniquified on several threads on CPU.
+    x = np.random.randint(-50000, high=50000, size=300000)
+    y, idx, count = gen_array_ops.unique_with_counts(x, out_idx=dtypes.int64)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+
+    np_y, np_first, np_idx, np_count = np.unique(
+        x, return_index=True, return_inverse=True, return_counts=True)
+    # The unique elements are in the order of their first occurrence.
+    order = np.argsort(np_first)
+    self.assertAllEqual(tf_y, np_y[order])
+    self.assertAllEqual(tf_count, np_count[order])
+    self.assertAllEqual(tf_idx, np.argsort(order)[np_idx])
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
@@ -276,6 +276,30 @@ class DecodeCSVOpTest(test.TestCase):
     }
     self._test(args, expected_err_re="Expect 3 fields but have 2 in record 0")
 
+  def testLargeBatch(self):
+    num_records = 10000
+    args = {
+        "records": ['%d,"a""%d",%d.5' % (i, i, i) for i in range(num_records)],
+        "record_defaults": [[0], [""], [0.0]],
+    }
+
+    expected_out = [
+        list(range(num_records)),
+        [b'a"%d' % i for i in range(num_records)],
+        [i + 0.5 for i in range(num_records)],
+    ]
+
+    self._test(args, expected_out)
+
+  def testLargeBatchReportsFirstBadRecord(self):
+    records = ["%d" % i for i in range(10000)]
+    records[6000] = "x"
+    records[9000] = "y"
+    args = {"records": records, "record_defaults": [[0]]}
+
+    self._test(
+        args, expected_err_re="Field 0 in record 6000 is not a valid int32: x")
+
   def testWrongSelectColsLen(self):
     args = {
         "records": ["1,2,3", "4,5,6"],
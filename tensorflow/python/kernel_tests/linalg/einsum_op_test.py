@@ -235,6 +235,18 @@ class EinsumOpTest(test.TestCase):
           ((4, 3), (None, 3)))
     check('...ij,...jk->...ik', ((3, 1, 2, 3), None), ((1, 7, 3, 4), None))
 
+  def testChangingShapes(self):
+    # The kernel caches the plan of each input shapes it runs on.
+    for _ in range(2):
+      self._check('...ij,...jk->...ik', (2, 3), (3, 4))
+      self._check('...ij,...jk->...ik', (5, 2, 3), (1, 3, 4))
+      self._check('...ij,...jk->...ik', (2, 1, 3, 3), (4, 3, 2))
+    with self.assertRaises((ValueError, errors.InvalidArgumentError)):
+      _ = self.evaluate(
+          gen_linalg_ops.einsum([array_ops.ones([2, 3]),
+                                 array_ops.ones([4, 4])],
+                                '...ij,...jk->...ik'))
+
   def testOutputRepeatedLabels(self):
     # This is the reverse operation of generalized traces, to be used for
     # computing symbolic gradients of einsum. Note: this operation is not
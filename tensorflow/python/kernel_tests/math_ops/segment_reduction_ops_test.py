@@ -714,6 +714,31 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
                 # and may therefore vary dynamically.
                 self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testValuesLarge(self):
+    # Large enough inputs to be reduced on several threads on CPU.
+    ops_list = [(np.add, None, math_ops.sparse_segment_sum),
+                (self._mean_cum_op, self._mean_reduce_op,
+                 math_ops.sparse_segment_mean),
+                (self._mean_cum_op, self._sqrt_n_reduce_op,
+                 math_ops.sparse_segment_sqrt_n)]
+    n = 1000
+    num_indices = 8192
+    for dtype in [dtypes_lib.float32, dtypes_lib.bfloat16]:
+      for segment_indices in [
+          np.sort(np.random.randint(0, 2000, num_indices)),
+          np.arange(0, 2 * num_indices, 2),
+      ]:
+        with self.cached_session():
+          tf_indices, np_indices, tf_x, np_x = self._sparse_input(
+              [n, 32], num_indices, dtype=dtype)
+          for np_op1, np_op2, tf_op in ops_list:
+            np_ans = self._sparseSegmentReduce(np_x, np_indices,
+                                               segment_indices, np_op1, np_op2)
+            s = tf_op(data=tf_x, indices=tf_indices,
+                      segment_ids=segment_indices)
+            tf_ans = self.evaluate(s)
+            self.assertAllCloseAccordingToType(np_ans, tf_ans)
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
@@ -183,6 +183,17 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float16)
     self._testMediumTopK(dtypes.bfloat16.as_numpy_dtype)
 
+  def testHugeRowTopK(self):
+    # Rows with many more columns than the rows are split over the threads.
+    b = 2
+    n = 200000
+    for k in [1, 10, 1000]:
+      # Lots of repeated integers, whose ties are broken by their index.
+      inputs = np.random.randint(0, 1000, size=(b, n)).astype(np.int32)
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
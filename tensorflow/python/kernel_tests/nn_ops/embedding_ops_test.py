@@ -20,6 +20,7 @@ import math
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.core.config import flags
 from tensorflow.python.compat import compat as forward_compat
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
@@ -530,6 +531,54 @@ class EmbeddingLookupTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-3)
 
+  @test_util.run_deprecated_v1
+  def testDeduplicatePartitionedIds(self):
+    vocab_size = 9
+    num_shards = 3
+    flag = flags.config().deduplicate_partitioned_embedding_ids
+    self.addCleanup(flag.reset, flag.value())
+    for deduplicate in [False, True]:
+      flag.reset(deduplicate)
+      # Without and with duplicate ids.
+      for id_vals in [[0, 4, 8, 3], [4, 0, 4, 8, 4, 0]]:
+        for partition_strategy in ["mod", "div"]:
+          with self.cached_session():
+            ids = constant_op.constant(id_vals, dtype=dtypes.int32)
+            x, params, feed_dict = _EmbeddingParams(
+                num_shards, vocab_size, shape=[2])
+            y = embedding_ops.embedding_lookup(
+                x, ids, partition_strategy=partition_strategy)
+            grads = gradients.gradients(math_ops.reduce_sum(y), x)
+            tf_result, tf_grads = self.evaluate(
+                [y, [ops.convert_to_tensor(g) for g in grads]],
+                feed_dict=feed_dict)
+
+            np_result, _, _ = _EmbeddingResult(
+                params,
+                np.array(id_vals),
+                num_shards,
+                vocab_size,
+                partition_strategy=partition_strategy)
+            self.assertAllEqual(np_result, tf_result)
+
+            # Every lookup of an id adds one to each value of its row.
+            np_grads = [np.zeros_like(params[_PName(i) + ":0"])
+                        for i in range(num_shards)]
+            for i in id_vals:
+              if partition_strategy == "mod":
+                np_grads[i % num_shards][i // num_shards, :] += 1
+              else:
+                np_grads[i // num_shards][i % num_shards, :] += 1
+            for np_grad, tf_grad in zip(np_grads, tf_grads):
+              self.assertAllEqual(np_grad, tf_grad)
+
+            x_init_value = [params[_PName(i) + ":0"] for i in range(num_shards)]
+            err = gradient_checker.compute_gradient_error(
+                x, [v.shape for v in x_init_value],
+                y, [len(id_vals), 2],
+                x_init_value=x_init_value)
+          self.assertLess(err, 1e-4)
+
   def testConstructionNonSharded(self):
     with ops.Graph().as_default():
       p = variables.Variable(
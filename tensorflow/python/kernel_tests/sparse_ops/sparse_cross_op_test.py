@@ -14,6 +14,8 @@
 # ==============================================================================
 """Tests for sparse_cross_op."""
 
+import random
+
 import numpy
 
 from tensorflow.python.client import session
@@ -28,6 +30,29 @@ from tensorflow.python.ops import sparse_ops
 from tensorflow.python.platform import test
 
 
+def _random_multivalent_columns(seed):
+  """Returns three feature columns with 1-2 random features per batch row.
+
+  The middle column holds strings, the others int64 values.
+
+  Args:
+    seed: seed of the pseudo random generator.
+
+  Returns:
+    A list of three columns, each a list of three batch rows.
+  """
+  rng = random.Random(seed)
+  columns = [[], [], []]
+  for _ in range(3):
+    for column_ix, rows in enumerate(columns):
+      count = rng.randint(1, 2)
+      if column_ix == 1:
+        rows.append(['feature-%d' % rng.randint(0, 999) for _ in range(count)])
+      else:
+        rows.append([rng.randint(-2**40, 2**40) for _ in range(count)])
+  return columns
+
+
 class BaseSparseCrossOpTest(test.TestCase):
 
   def _sparse_tensor(self, data, batch_size=-1):
@@ -381,6 +406,27 @@ class SparseCrossOpTest(test.TestCase):
     with self.cached_session():
       self._assert_sparse_tensor_equals(expected_out, self.evaluate(op))
 
+  @test_util.run_deprecated_v1
+  def test_hashed_multivalent_fingerprints(self):
+    """Tests crosses of multivalent rows against fixed fingerprints."""
+    op = sparse_ops.sparse_cross_hashed([
+        self._sparse_tensor(column)
+        for column in _random_multivalent_columns(seed=10)
+    ])
+    # Check actual hashed output, in cross order, to prevent unintentional
+    # hashing changes.
+    expected_out = self._sparse_tensor([
+        [3428028259028566431, 500214586663018357],
+        [6836985782064946721, 4357486302067636196],
+        [
+            5224169917613078686, 4052826426858411777, 3288083134204564970,
+            3578847633752671341, 7225307958587906043, 8303772779431806390,
+            8157341851685540726, 8399817664299976358
+        ],
+    ])
+    with self.cached_session():
+      self._assert_sparse_tensor_equals(expected_out, self.evaluate(op))
+
   @test_util.run_deprecated_v1
   def test_hashed__has_no_collision(self):
     """Tests that fingerprint concatenation has no collisions."""
@@ -941,6 +987,57 @@ class SparseCrossHashedOpTest(BaseSparseCrossOpTest):
     with self.cached_session():
       self._assert_sparse_tensor_equals(expected_out, self.evaluate(out))
 
+  def _multivalent_cross(self, strong_hash):
+    sp_inps = [
+        self._sparse_tensor(column)
+        for column in _random_multivalent_columns(seed=10)
+    ]
+    inds, vals, shapes = gen_sparse_ops.sparse_cross_hashed(
+        indices=[sp_inp.indices for sp_inp in sp_inps],
+        values=[sp_inp.values for sp_inp in sp_inps],
+        shapes=[sp_inp.dense_shape for sp_inp in sp_inps],
+        dense_inputs=[],
+        num_buckets=0,
+        salt=[137, 173],
+        strong_hash=strong_hash)
+    return sparse_tensor.SparseTensor(inds, vals, shapes)
+
+  @test_util.run_deprecated_v1
+  def test_hashed_multivalent_fingerprints(self):
+    """Tests crosses of multivalent rows against fixed fingerprints."""
+    out = self._multivalent_cross(strong_hash=False)
+    # Check actual hashed output, in cross order, to prevent unintentional
+    # hashing changes.
+    expected_out = self._sparse_tensor([
+        [6572126587202404254, 9209531303729064854],
+        [285186671869643781, 3754509591612674659],
+        [
+            2739956316243777688, 7070262496231889724, 7984022240744840309,
+            5629694252520054047, 5097374563621294105, 7982055995020608600,
+            3751555049397833520, 5225026379421063426
+        ],
+    ])
+    with self.cached_session():
+      self._assert_sparse_tensor_equals(expected_out, self.evaluate(out))
+
+  @test_util.run_deprecated_v1
+  def test_strong_hashed_multivalent_fingerprints(self):
+    """Tests strongly hashed crosses of multivalent rows."""
+    out = self._multivalent_cross(strong_hash=True)
+    # Check actual hashed output, in cross order, to prevent unintentional
+    # hashing changes.
+    expected_out = self._sparse_tensor([
+        [4699352298810744151, 8815416683132522220],
+        [5707505795350318363, 3712903402556084943],
+        [
+            1114157423465970689, 4347658653369781255, 5285186240558033866,
+            5953783478358756248, 1685886497842883023, 3575479717157402824,
+            2483395788040460583, 428751305027259403
+        ],
+    ])
+    with self.cached_session():
+      self._assert_sparse_tensor_equals(expected_out, self.evaluate(out))
+
   @test_util.run_deprecated_v1
   def test_hashed_has_no_collision(self):
     """Tests that fingerprint concatenation has no collisions."""
@@ -41,8 +41,11 @@ def all_reduce(t,
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `hierarchical`, `fp16`, `bf16`, and `nccl`. `hierarchical` reduces within
+      each task before reducing across tasks, for groups spanning several tasks
+      with the same number of devices each. `fp16` and `bf16` transfer float32
+      values on CPU in a 16-bit type, at the cost of precision.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -117,8 +120,11 @@ def all_reduce_v2(t,
     final_op: string naming the unary Op to be applied to each fully reduced
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `hierarchical`, `fp16`, `bf16`, and `nccl`. `hierarchical` reduces within
+      each task before reducing across tasks, for groups spanning several tasks
+      with the same number of devices each. `fp16` and `bf16` transfer float32
+      values on CPU in a 16-bit type, at the cost of precision.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -14,6 +14,7 @@
 # ==============================================================================
 """Operations for embeddings."""
 
+from tensorflow.core.config import flags
 from tensorflow.python.compat import compat
 from tensorflow.python.framework import composite_tensor
 from tensorflow.python.framework import constant_op
@@ -159,6 +160,13 @@ def _embedding_lookup_and_transform(params,
       #   We must flatten in this case because transform_fn expects a flat
       #   tensor of embeddings.
       flat_ids = array_ops.reshape(ids, [-1])
+      deduplicate_ids = (
+          np > 1 and
+          flags.config().deduplicate_partitioned_embedding_ids.value())
+      if deduplicate_ids:
+        # Only look up each id once, as hot ids usually repeat within a
+        # batch and each lookup may fetch the row from a remote partition.
+        flat_ids, unique_idx = array_ops.unique(flat_ids)
       original_indices = math_ops.range(array_ops.size(flat_ids))
 
       # Create p_assignments and set new_ids depending on the strategy.
@@ -225,8 +233,15 @@ def _embedding_lookup_and_transform(params,
               result = transform_fn(_clip(result, pids, max_norm))
         partitioned_result.append(result)
       # Stitch these back together
-      ret = data_flow_ops.parallel_dynamic_stitch(
-          pindices, partitioned_result, name=name)
+      if deduplicate_ids:
+        ret = array_ops.gather(
+            data_flow_ops.parallel_dynamic_stitch(pindices,
+                                                  partitioned_result),
+            unique_idx,
+            name=name)
+      else:
+        ret = data_flow_ops.parallel_dynamic_stitch(
+            pindices, partitioned_result, name=name)
 
       # Determine the static element shape.
       if transform_fn is None:
@@ -26,6 +26,7 @@ from tensorflow.python.framework import tensor
 from tensorflow.python.framework import tensor_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import check_ops
+from tensorflow.python.ops import control_flow_util
 from tensorflow.python.ops import gen_ragged_math_ops
 from tensorflow.python.ops import map_fn
 from tensorflow.python.ops import math_ops
@@ -474,6 +475,55 @@ _RAGGED_REDUCE_ANY_EXAMPLE = """
 """
 
 
+# The reductions of the RaggedSegmentReduce op, which reduces the rows of
+# ragged dimension 1 in parallel from the row splits, rather than with the
+# UnsortedSegment ops from the segment ids.
+_RAGGED_SEGMENT_REDUCTIONS = {
+    math_ops.unsorted_segment_sum: 'sum',
+    math_ops.unsorted_segment_min: 'min',
+    math_ops.unsorted_segment_max: 'max',
+}
+
+_RAGGED_SEGMENT_REDUCE_DTYPES = frozenset([
+    dtypes.float32, dtypes.float64, dtypes.int32, dtypes.uint8, dtypes.int16,
+    dtypes.int8, dtypes.int64, dtypes.bfloat16, dtypes.uint16, dtypes.float16,
+    dtypes.uint32, dtypes.uint64
+])
+
+
+def _ragged_segment_reduce(unsorted_segment_op, rt_input, separator):
+  """Returns the RaggedSegmentReduce reduction of axis 1, or None."""
+  reduction = _RAGGED_SEGMENT_REDUCTIONS.get(unsorted_segment_op)
+  values = rt_input.values
+  # The op only has a CPU kernel, which XLA can't compile.
+  if (reduction is None or separator is not None or
+      ragged_tensor.is_ragged(values) or
+      values.dtype not in _RAGGED_SEGMENT_REDUCE_DTYPES or
+      control_flow_util.GraphOrParentsInXlaContext(ops.get_default_graph())):
+    return None
+  return gen_ragged_math_ops.ragged_segment_reduce(
+      values, rt_input.row_splits, reduction=reduction)
+
+
+@ops.RegisterGradient('RaggedSegmentReduce')
+def _ragged_segment_reduce_grad(op, grad):
+  """Gradient for RaggedSegmentReduce, as for the UnsortedSegment ops."""
+  data, row_splits = op.inputs
+  segment_ids = segment_id_ops.row_splits_to_segment_ids(row_splits)
+  if op.get_attr('reduction') == b'sum':
+    return array_ops.gather(grad, segment_ids), None
+  # The gradient of each row is divided evenly among its selected elements.
+  is_selected = math_ops.equal(
+      data, array_ops.gather(op.outputs[0], segment_ids))
+  num_selected = math_ops.unsorted_segment_sum(
+      math_ops.cast(is_selected, grad.dtype), segment_ids,
+      array_ops.shape(row_splits, out_type=row_splits.dtype)[0] - 1)
+  gathered_grads = array_ops.gather(
+      math_ops.divide(grad, num_selected), segment_ids)
+  zeros = array_ops.zeros_like(gathered_grads)
+  return array_ops.where_v2(is_selected, gathered_grads, zeros), None
+
+
 def ragged_reduce_aggregate(reduce_op,
                             unsorted_segment_op,
                             rt_input,
@@ -593,11 +643,14 @@ def ragged_reduce_aggregate(reduce_op,
       return result
     elif axis == 1:
       # out[i_0, i_1, i_2, ..., i_N] = sum_{j} rt_input[i_0, j, i_2, ..., i_N]
-      num_segments = array_ops.shape(rt_input.row_splits)[0] - 1
-      segment_ids = segment_id_ops.row_splits_to_segment_ids(
-          rt_input.row_splits)
-      result = _ragged_segment_aggregate(unsorted_segment_op, rt_input.values,
-                                         segment_ids, num_segments, separator)
+      result = _ragged_segment_reduce(unsorted_segment_op, rt_input, separator)
+      if result is None:
+        num_segments = array_ops.shape(rt_input.row_splits)[0] - 1
+        segment_ids = segment_id_ops.row_splits_to_segment_ids(
+            rt_input.row_splits)
+        result = _ragged_segment_aggregate(unsorted_segment_op,
+                                           rt_input.values, segment_ids,
+                                           num_segments, separator)
       if keepdims:
         result = array_ops.expand_dims(result, axis=1)
       return result
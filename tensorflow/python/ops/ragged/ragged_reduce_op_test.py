@@ -17,6 +17,7 @@
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
@@ -24,6 +25,7 @@ from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.ops.ragged import ragged_math_ops
+from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.platform import googletest
 
 _MAX_INT32 = dtypes.int32.max
@@ -694,6 +696,21 @@ class RaggedReduceOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     reduced = ragged_math_ops.reduce_std(tensor, axis=1)
     self.assertAllEqual(reduced, expected)
 
+  @parameterized.parameters(
+      (ragged_math_ops.reduce_sum, [1, 1, 1, 1, 1]),
+      # The gradient is divided among the maxima or minima of each row.
+      (ragged_math_ops.reduce_max, [0, 0.5, 0.5, 0, 1]),
+      (ragged_math_ops.reduce_min, [1, 0, 0, 1, 0]),
+  )
+  def testReduceGradient(self, ragged_reduce_op, expected):
+    values = constant_op.constant([1.0, 3.0, 3.0, 2.0, 5.0])
+    with backprop.GradientTape() as tape:
+      tape.watch(values)
+      rt_input = ragged_tensor.RaggedTensor.from_row_splits(
+          values, [0, 3, 3, 5])
+      reduced = ragged_reduce_op(rt_input, axis=1)
+    self.assertAllEqual(tape.gradient(reduced, values), expected)
+
   def testErrors(self):
     rt_input = ragged_factory_ops.constant([[1, 2, 3], [4, 5]])
     axis = array_ops.placeholder_with_default(constant_op.constant([0]), None)
@@ -421,6 +421,7 @@ static std::unordered_map<string, string> TF_GetDeviceDetails(int index) {
 
 static py::object TFE_ClearScalarCache() {
   tensorflow::TFE_TensorHandleCache::Get()->Clear();
+  TFE_Py_ClearFastPathAttrsCache();
   return py::none();
 }
 
@@ -1853,6 +1854,27 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
     return capsule;
   });
 
+  m.def("TFE_DlpackDevice", [](py::handle& o) {
+    PyObject* eager_tensor_pyobject_ptr = o.ptr();
+    tensorflow::Safe_TF_StatusPtr status =
+        tensorflow::make_safe(TF_NewStatus());
+
+    if (!EagerTensor_CheckExact(eager_tensor_pyobject_ptr)) {
+      status->status = tensorflow::errors::InvalidArgument(
+          "The argument to `TFE_DlpackDevice` must be a TF tensor, not Python "
+          "object");
+      tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
+    }
+
+    TFE_TensorHandle* thandle = EagerTensor_Handle(eager_tensor_pyobject_ptr);
+    int device_type = 0;
+    int device_id = 0;
+    tensorflow::TFE_HandleDLPackDevice(thandle, &device_type, &device_id,
+                                       status.get());
+    tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
+    return py::make_tuple(device_type, device_id);
+  });
+
   m.def("TFE_FromDlpackCapsule", [](const py::capsule& pycapsule,
                                     const py::handle& context) {
     tensorflow::Safe_TF_StatusPtr status =
@@ -508,6 +508,7 @@ int64_t BFCAllocator::LargestFreeChunk() {
 double BFCAllocator::GetFragmentation() {
   int64_t bytes_available = *stats_.pool_bytes - stats_.bytes_in_use;
   DCHECK_GE(bytes_available, 0);
+  if (bytes_available <= 0) return 0.0;
   return static_cast<double>(bytes_available - LargestFreeChunk()) /
          bytes_available;
 }
@@ -1189,6 +1190,9 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   }
 
   mas->set_fragmentation_metric(GetFragmentation());
+  mas->set_pool_bytes(*stats_.pool_bytes);
+  mas->set_largest_free_chunk_bytes(LargestFreeChunk());
+  mas->set_num_regions(region_manager_.regions().size());
 
 #ifdef TENSORFLOW_MEM_DEBUG
   // Record the recent size history
@@ -1207,7 +1211,9 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
@@ -133,6 +133,10 @@ class ServingDeviceSelector {
   // Struct of all tracked device states, which will be passed to Policy.
   struct DeviceStates {
     absl::Span<const DeviceState> states;
+    // Estimated time in nanoseconds until each device becomes idle, for
+    // selectors that track program execution time. Either empty or of the
+    // same size as `states`.
+    absl::Span<const int64_t> estimated_time_till_idle_ns;
   };
 
   // Policy used to select a device.
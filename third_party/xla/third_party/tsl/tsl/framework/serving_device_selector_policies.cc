@@ -15,8 +15,10 @@ limitations under the License.
 #include "tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tsl {
@@ -28,4 +30,24 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+int LeastExpectedCompletionTimePolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int first_device =
+      ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
+  const absl::Span<const int64_t> estimates =
+      device_states.estimated_time_till_idle_ns;
+  if (estimates.size() != num_devices) return first_device;
+
+  int selected_device = first_device;
+  for (int i = 1; i < num_devices; ++i) {
+    const int device = (first_device + i) % num_devices;
+    if (estimates[device] < estimates[selected_device]) {
+      selected_device = device;
+    }
+  }
+  return selected_device;
+}
+
 }  // namespace tsl
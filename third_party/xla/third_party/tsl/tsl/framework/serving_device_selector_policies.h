@@ -23,6 +23,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLeastExpectedCompletionTime,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +38,22 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device expected to finish its queued programs first, i.e. the
+// one with the smallest estimated time till idle. Ties, e.g. all devices being
+// idle, are broken round-robin. Falls back to round-robin if the selector
+// doesn't estimate the time till idle.
+class LeastExpectedCompletionTimePolicy : public ServingDeviceSelector::Policy {
+ public:
+  LeastExpectedCompletionTimePolicy() : ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// Maximum number of streams reading ahead at the same time.
+constexpr int kNumReadaheadThreads = 16;
+
+thread::ThreadPool* ReadaheadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "readahead", kNumReadaheadThreads);
+  return pool;
+}
+
+}  // namespace
+
+ReadaheadInputStream::ReadaheadInputStream(InputStreamInterface* input_stream,
+                                           size_t buffer_bytes,
+                                           int num_buffers,
+                                           bool owns_input_stream)
+    : input_stream_(input_stream),
+      buffer_bytes_(std::max<size_t>(buffer_bytes, 1)),
+      num_buffers_(std::max(num_buffers, 1)),
+      owns_input_stream_(owns_input_stream),
+      position_(input_stream->Tell()) {
+  mutex_lock l(mu_);
+  MaybeScheduleReadsLocked();
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  CancelReads();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+void ReadaheadInputStream::MaybeScheduleReadsLocked() {
+  if (read_in_flight_ || cancelled_ || end_of_reads_ ||
+      buffers_.size() >= num_buffers_) {
+    return;
+  }
+  read_in_flight_ = true;
+  ReadaheadThreadPool()->Schedule([this] { ReadLoop(); });
+}
+
+void ReadaheadInputStream::ReadLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      if (cancelled_ || end_of_reads_ || buffers_.size() >= num_buffers_) {
+        read_in_flight_ = false;
+        cv_.notify_all();
+        return;
+      }
+    }
+    Buffer buffer;
+    buffer.status = input_stream_->ReadNBytes(buffer_bytes_, &buffer.data);
+    mutex_lock l(mu_);
+    if (cancelled_) continue;
+    end_of_reads_ = !buffer.status.ok();
+    buffers_.push_back(std::move(buffer));
+    cv_.notify_all();
+  }
+}
+
+void ReadaheadInputStream::CancelReads() {
+  mutex_lock l(mu_);
+  cancelled_ = true;
+  while (read_in_flight_) {
+    cv_.wait(l);
+  }
+  buffers_.clear();
+}
+
+void ReadaheadInputStream::NextBuffer() {
+  mutex_lock l(mu_);
+  // The reads never end without a buffer, whose status is then returned
+  // instead of reading the next one.
+  MaybeScheduleReadsLocked();
+  while (buffers_.empty()) {
+    cv_.wait(l);
+  }
+  buf_ = std::move(buffers_.front().data);
+  status_ = std::move(buffers_.front().status);
+  pos_ = 0;
+  buffers_.pop_front();
+  MaybeScheduleReadsLocked();
+}
+
+Status ReadaheadInputStream::Consume(int64_t bytes, tstring* result) {
+  while (bytes > 0) {
+    if (pos_ == buf_.size()) {
+      if (!status_.ok()) {
+        return status_;
+      }
+      NextBuffer();
+      continue;
+    }
+    const size_t n = std::min<size_t>(bytes, buf_.size() - pos_);
+    if (result != nullptr) {
+      result->append(buf_.data() + pos_, n);
+    }
+    pos_ += n;
+    position_ += n;
+    bytes -= n;
+  }
+  return OkStatus();
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  return Consume(bytes_to_skip, nullptr);
+}
+
+int64_t ReadaheadInputStream::Tell() const { return position_; }
+
+Status ReadaheadInputStream::Reset() {
+  CancelReads();
+  buf_.clear();
+  pos_ = 0;
+  status_ = OkStatus();
+  Status s = input_stream_->Reset();
+  position_ = input_stream_->Tell();
+  mutex_lock l(mu_);
+  cancelled_ = false;
+  end_of_reads_ = false;
+  if (!s.ok()) {
+    status_ = s;
+    return s;
+  }
+  MaybeScheduleReadsLocked();
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tsl {
+namespace io {
+
+// Prefetches the data of an InputStreamInterface on a background thread, so
+// that reading the next buffer overlaps with the consumption of the current
+// one.
+//
+// Up to `num_buffers` reads of `buffer_bytes` are kept ahead of the consumer,
+// which only waits when it catches up with the reads. Reads must be mostly
+// sequential: Reset() cancels the pending reads, and skipping still reads the
+// skipped bytes.
+//
+// A single instance of ReadaheadInputStream is NOT safe for concurrent use by
+// multiple threads, and the underlying stream must not be used directly while
+// it is wrapped.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of input_stream unless owns_input_stream is set
+  // to true. input_stream must outlive *this then.
+  ReadaheadInputStream(InputStreamInterface* input_stream, size_t buffer_bytes,
+                       int num_buffers, bool owns_input_stream = false);
+
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // A read of the underlying stream.
+  struct Buffer {
+    tstring data;
+    // The status of the read, which ends the reads unless it is OK.
+    Status status;
+  };
+
+  // Consumes the next `bytes` bytes, appending them to `result` if it is not
+  // null.
+  Status Consume(int64_t bytes, tstring* result);
+
+  // Makes `buf_` the next read buffer, waiting for it if needed.
+  void NextBuffer();
+
+  // Schedules the background reads if more buffers can be read ahead.
+  void MaybeScheduleReadsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads buffers until `num_buffers_` are pending, the reads end or they
+  // are cancelled.
+  void ReadLoop();
+
+  // Cancels the background reads and waits for the one in flight.
+  void CancelReads();
+
+  InputStreamInterface* input_stream_;
+  const size_t buffer_bytes_;
+  const size_t num_buffers_;
+  const bool owns_input_stream_;
+
+  // The buffer being consumed, which the consumer owns.
+  tstring buf_;
+  size_t pos_ = 0;  // current position in buf_.
+  // The status of the read of buf_, returned once buf_ is consumed.
+  Status status_;
+  int64_t position_;  // position in the underlying stream.
+
+  mutex mu_;
+  condition_variable cv_;
+  std::deque<Buffer> buffers_ TF_GUARDED_BY(mu_);
+  bool read_in_flight_ TF_GUARDED_BY(mu_) = false;
+  bool end_of_reads_ TF_GUARDED_BY(mu_) = false;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
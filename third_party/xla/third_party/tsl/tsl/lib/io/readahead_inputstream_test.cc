@@ -0,0 +1,171 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/random_inputstream.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() {
+  return {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 65536};
+}
+
+static std::vector<int> NumBuffers() { return {1, 2, 4}; }
+
+TEST(ReadaheadInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      RandomAccessInputStream input_stream(file.get());
+      tstring read;
+      ReadaheadInputStream in(&input_stream, buf_size, num_buffers);
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "3456");
+      EXPECT_EQ(7, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "789");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST(ReadaheadInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      RandomAccessInputStream input_stream(file.get());
+      tstring read;
+      ReadaheadInputStream in(&input_stream, buf_size, num_buffers);
+      TF_ASSERT_OK(in.SkipNBytes(3));
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "34");
+      TF_ASSERT_OK(in.SkipNBytes(2));
+      EXPECT_EQ(7, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "");
+    }
+  }
+}
+
+TEST(ReadaheadInputStream, Reset) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      tstring read;
+      ReadaheadInputStream in(new RandomAccessInputStream(file.get()),
+                              buf_size, num_buffers,
+                              /*owns_input_stream=*/true);
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "0123");
+      TF_ASSERT_OK(in.Reset());
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(6, &read));
+      EXPECT_EQ(read, "012345");
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(10, &read)));
+      EXPECT_EQ(read, "6789");
+      TF_ASSERT_OK(in.Reset());
+      TF_ASSERT_OK(in.ReadNBytes(10, &read));
+      EXPECT_EQ(read, "0123456789");
+    }
+  }
+}
+
+TEST(ReadaheadInputStream, ReadsLargeFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string contents;
+  for (int i = 0; i < 100000; ++i) {
+    contents += static_cast<char>('a' + i % 26);
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  RandomAccessInputStream input_stream(file.get());
+  ReadaheadInputStream in(&input_stream, 1000, 4);
+  string read_contents;
+  tstring read;
+  Status s;
+  while ((s = in.ReadNBytes(777, &read)).ok()) {
+    read_contents.append(read.data(), read.size());
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(s));
+  read_contents.append(read.data(), read.size());
+  EXPECT_EQ(read_contents, contents);
+  EXPECT_EQ(contents.size(), in.Tell());
+}
+
+TEST(ReadaheadInputStream, DestroysWhileReading) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, string(100000, 'x')));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (int i = 0; i < 10; ++i) {
+    ReadaheadInputStream in(new RandomAccessInputStream(file.get()), 100, 16,
+                            /*owns_input_stream=*/true);
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
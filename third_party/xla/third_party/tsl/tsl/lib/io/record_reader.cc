@@ -21,6 +21,7 @@ limitations under the License.
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/readahead_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
@@ -59,7 +60,16 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.readahead_buffers > 0) {
+    const int64_t buffer_bytes =
+        options.buffer_size > 0
+            ? options.buffer_size
+            : RecordReaderOptions::kDefaultReadaheadBufferBytes;
+    input_stream_.reset(new ReadaheadInputStream(input_stream_.release(),
+                                                 buffer_bytes,
+                                                 options.readahead_buffers,
+                                                 true));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -46,6 +46,13 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If readahead_buffers is non-zero, up to that many reads of buffer_size
+  // bytes (or kDefaultReadaheadBufferBytes if buffer_size is zero) are
+  // prefetched on a background thread, overlapping the reads with the parsing
+  // of the records. As with buffer_size, all reads must then be sequential.
+  static constexpr int64_t kDefaultReadaheadBufferBytes = 256 << 10;
+  int readahead_buffers = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
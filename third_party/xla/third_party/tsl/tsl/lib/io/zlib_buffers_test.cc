@@ -110,6 +110,58 @@ TEST(ZlibBuffers, Gzip) {
   TestAllCombinations(CompressionOptions::GZIP(), CompressionOptions::GZIP());
 }
 
+void TestParallelCompression(CompressionOptions options) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  options.compression_threads = 4;
+  for (auto file_size : NumCopies()) {
+    string data = GenTestString(file_size);
+    for (int block_size : {100, 1000, 100000}) {
+      for (bool with_flush : {false, true}) {
+        std::unique_ptr<WritableFile> file_writer;
+        TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+        options.input_buffer_size = block_size;
+        ParallelZlibOutputBuffer out(file_writer.get(), options);
+        TF_ASSERT_OK(out.Init());
+        // Writes the data in uneven pieces, which straddle the blocks.
+        for (size_t pos = 0; pos < data.size(); pos += 777) {
+          TF_ASSERT_OK(out.Append(StringPiece(data).substr(pos, 777)));
+          if (with_flush) {
+            TF_ASSERT_OK(out.Flush());
+          }
+        }
+        TF_ASSERT_OK(out.Close());
+        TF_ASSERT_OK(file_writer->Flush());
+        TF_ASSERT_OK(file_writer->Close());
+
+        std::unique_ptr<RandomAccessFile> file_reader;
+        TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+        std::unique_ptr<RandomAccessInputStream> input_stream(
+            new RandomAccessInputStream(file_reader.get()));
+        ZlibInputStream in(input_stream.get(), 1000, 1000, options);
+        tstring result;
+        TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+        EXPECT_EQ(result, data);
+        // Reading past the end verifies the checksum in the trailer, if any.
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+      }
+    }
+  }
+}
+
+TEST(ZlibBuffers, ParallelDefaultOptions) {
+  TestParallelCompression(CompressionOptions::DEFAULT());
+}
+
+TEST(ZlibBuffers, ParallelRawDeflate) {
+  TestParallelCompression(CompressionOptions::RAW());
+}
+
+TEST(ZlibBuffers, ParallelGzip) {
+  TestParallelCompression(CompressionOptions::GZIP());
+}
+
 void TestMultipleWrites(uint8 input_buf_size, uint8 output_buf_size,
                         int num_writes, bool with_flush = false) {
   Env* env = Env::Default();
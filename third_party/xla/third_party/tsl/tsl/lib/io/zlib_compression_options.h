@@ -111,6 +111,14 @@ class ZlibCompressionOptions {
   // for a simpler decoder for special applications.
   int8 compression_strategy;
 
+  // The number of threads compressing the output. With more than one thread,
+  // `ParallelZlibOutputBuffer` compresses blocks of `input_buffer_size` bytes
+  // concurrently into a single stream, each block primed with the end of the
+  // previous one.
+  //
+  // This option is ignored for `ZlibInputStream`.
+  int compression_threads = 1;
+
   // When this is set to true and we are unable to find the header to correctly
   // decompress a file, we return an error when `ReadNBytes` is called instead
   // of CHECK-failing. Defaults to false (i.e. CHECK-failing).
@@ -15,10 +15,56 @@ limitations under the License.
 
 #include "tsl/lib/io/zlib_outputbuffer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 #include "tsl/platform/errors.h"
 
 namespace tsl {
 namespace io {
+namespace {
+
+// The size of the deflate window, which bounds the dictionary of the blocks of
+// ParallelZlibOutputBuffer.
+constexpr size_t kMaxDictionaryBytes = 32 * 1024;
+
+// The maximum number of bytes of the sync flush marker ending each block.
+constexpr size_t kFlushMarkerBytes = 16;
+
+bool IsGzip(const ZlibCompressionOptions& options) {
+  return options.window_bits > MAX_WBITS;
+}
+
+bool IsRaw(const ZlibCompressionOptions& options) {
+  return options.window_bits < 0;
+}
+
+// Returns the base two logarithm of the deflate window of `options`.
+int WindowBits(const ZlibCompressionOptions& options) {
+  int window_bits = options.window_bits;
+  if (IsRaw(options)) {
+    window_bits = -window_bits;
+  } else if (IsGzip(options)) {
+    window_bits -= 16;
+  }
+  // Like deflateInit2(), which uses a window of 512 bytes instead of 256.
+  return std::max(window_bits, 9);
+}
+
+void AppendBigEndian32(uint32 value, std::string* output) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    output->push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+void AppendLittleEndian32(uint32 value, std::string* output) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    output->push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+}  // namespace
 
 ZlibOutputBuffer::ZlibOutputBuffer(
     WritableFile* file,
@@ -242,5 +288,255 @@ absl::Status ZlibOutputBuffer::Tell(int64_t* position) {
   return file_->Tell(position);
 }
 
+struct ParallelZlibOutputBuffer::Block {
+  std::string input;
+  std::string dictionary;
+  bool last;
+
+  // Set by Deflate().
+  size_t input_size = 0;
+  std::string output;
+  uint32 checksum;
+  absl::Status status;
+  bool compressed = false;  // Guarded by the mutex of the buffer.
+};
+
+ParallelZlibOutputBuffer::ParallelZlibOutputBuffer(
+    WritableFile* file, const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      zlib_options_(zlib_options),
+      block_size_(std::max<int64_t>(1, zlib_options.input_buffer_size)),
+      checksum_(IsGzip(zlib_options) ? crc32(0L, Z_NULL, 0)
+                                     : adler32(0L, Z_NULL, 0)) {}
+
+ParallelZlibOutputBuffer::~ParallelZlibOutputBuffer() {
+  if (thread_pool_ != nullptr && !closed_) {
+    LOG(WARNING) << "ParallelZlibOutputBuffer::Close() not called. Possible "
+                    "data loss";
+  }
+  // Waits for the blocks that are still being compressed.
+  thread_pool_.reset();
+}
+
+absl::Status ParallelZlibOutputBuffer::Init() {
+  if (zlib_options_.compression_threads < 1) {
+    return errors::InvalidArgument(
+        "compression_threads should be at least 1, got ",
+        zlib_options_.compression_threads);
+  }
+  if (zlib_options_.compression_method != Z_DEFLATED) {
+    return errors::InvalidArgument("Only Z_DEFLATED is supported, got ",
+                                   zlib_options_.compression_method);
+  }
+  std::string header;
+  if (IsGzip(zlib_options_)) {
+    // A gzip header without file name, modification time or comment, and an
+    // unknown operating system, like the one written by deflate().
+    header = {'\x1f', '\x8b', Z_DEFLATED, 0, 0, 0, 0, 0, 0, '\xff'};
+  } else if (!IsRaw(zlib_options_)) {
+    const int level = zlib_options_.compression_level == Z_DEFAULT_COMPRESSION
+                          ? 6
+                          : zlib_options_.compression_level;
+    int level_flags = 3;
+    if (zlib_options_.compression_strategy >= Z_HUFFMAN_ONLY || level < 2) {
+      level_flags = 0;
+    } else if (level < 6) {
+      level_flags = 1;
+    } else if (level == 6) {
+      level_flags = 2;
+    }
+    uint32 zlib_header =
+        (Z_DEFLATED + ((WindowBits(zlib_options_) - 8) << 4)) << 8;
+    zlib_header |= level_flags << 6;
+    zlib_header += 31 - zlib_header % 31;
+    header = {static_cast<char>(zlib_header >> 8),
+              static_cast<char>(zlib_header & 0xff)};
+  }
+  if (!header.empty()) {
+    TF_RETURN_IF_ERROR(file_->Append(header));
+  }
+  thread_pool_ = std::make_unique<thread::ThreadPool>(
+      Env::Default(), "parallel_zlib", zlib_options_.compression_threads);
+  input_.reserve(block_size_);
+  return absl::OkStatus();
+}
+
+absl::Status ParallelZlibOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append() called after Close().");
+  }
+  while (!data.empty()) {
+    const size_t bytes_to_add =
+        std::min(data.size(), block_size_ - input_.size());
+    input_.append(data.data(), bytes_to_add);
+    data.remove_prefix(bytes_to_add);
+    if (input_.size() == block_size_) {
+      TF_RETURN_IF_ERROR(CompressCurrentBlock(/*last=*/false));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParallelZlibOutputBuffer::CompressCurrentBlock(bool last) {
+  auto block = std::make_unique<Block>();
+  block->input = std::move(input_);
+  block->dictionary = std::move(dictionary_);
+  block->last = last;
+  // The dictionary of the next block is the end of the input so far.
+  if (block->input.size() >= kMaxDictionaryBytes) {
+    dictionary_.assign(block->input.end() - kMaxDictionaryBytes,
+                       block->input.end());
+  } else {
+    dictionary_ = block->dictionary;
+    dictionary_.append(block->input);
+    if (dictionary_.size() > kMaxDictionaryBytes) {
+      dictionary_.erase(0, dictionary_.size() - kMaxDictionaryBytes);
+    }
+  }
+  input_.clear();
+  input_.reserve(block_size_);
+
+  Block* const block_to_compress = block.get();
+  blocks_.push_back(std::move(block));
+  thread_pool_->Schedule([this, block_to_compress]() {
+    Deflate(block_to_compress);
+    mutex_lock l(mu_);
+    block_to_compress->compressed = true;
+    block_compressed_.notify_all();
+  });
+  // Keeps every thread busy while the oldest blocks are written.
+  return WriteBlocks(2 * zlib_options_.compression_threads);
+}
+
+absl::Status ParallelZlibOutputBuffer::WriteBlocks(size_t max_pending_blocks) {
+  while (!blocks_.empty()) {
+    Block* const block = blocks_.front().get();
+    {
+      mutex_lock l(mu_);
+      if (!block->compressed && blocks_.size() <= max_pending_blocks) {
+        break;
+      }
+      while (!block->compressed) {
+        block_compressed_.wait(l);
+      }
+    }
+    TF_RETURN_IF_ERROR(block->status);
+    TF_RETURN_IF_ERROR(file_->Append(block->output));
+    if (IsGzip(zlib_options_)) {
+      checksum_ = crc32_combine(checksum_, block->checksum, block->input_size);
+    } else {
+      checksum_ =
+          adler32_combine(checksum_, block->checksum, block->input_size);
+    }
+    input_bytes_ += block->input_size;
+    blocks_.pop_front();
+  }
+  return absl::OkStatus();
+}
+
+void ParallelZlibOutputBuffer::Deflate(Block* block) const {
+  block->input_size = block->input.size();
+  const Bytef* input = reinterpret_cast<const Bytef*>(block->input.data());
+  if (IsGzip(zlib_options_)) {
+    block->checksum = crc32(crc32(0L, Z_NULL, 0), input, block->input_size);
+  } else {
+    block->checksum =
+        adler32(adler32(0L, Z_NULL, 0), input, block->input_size);
+  }
+
+  // Each block is a part of a raw deflate stream, which is wrapped by the
+  // header and trailer of the buffer.
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  int status = deflateInit2(&stream, zlib_options_.compression_level,
+                            zlib_options_.compression_method,
+                            -WindowBits(zlib_options_),
+                            zlib_options_.mem_level,
+                            zlib_options_.compression_strategy);
+  if (status != Z_OK) {
+    block->status =
+        errors::InvalidArgument("deflateInit failed with status ", status);
+    return;
+  }
+  if (!block->dictionary.empty()) {
+    deflateSetDictionary(
+        &stream, reinterpret_cast<const Bytef*>(block->dictionary.data()),
+        block->dictionary.size());
+  }
+  stream.next_in = const_cast<Bytef*>(input);
+  stream.avail_in = block->input_size;
+  block->output.resize(deflateBound(&stream, block->input_size) +
+                       kFlushMarkerBytes);
+  const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+  size_t output_size = 0;
+  do {
+    if (output_size == block->output.size()) {
+      block->output.resize(2 * block->output.size());
+    }
+    stream.next_out = reinterpret_cast<Bytef*>(&block->output[output_size]);
+    stream.avail_out = block->output.size() - output_size;
+    status = deflate(&stream, flush);
+    output_size = block->output.size() - stream.avail_out;
+  } while ((status == Z_OK || status == Z_BUF_ERROR) && stream.avail_out == 0);
+  if (status != (flush == Z_FINISH ? Z_STREAM_END : Z_OK)) {
+    std::string error_string =
+        strings::StrCat("deflate() failed with error ", status);
+    if (stream.msg != nullptr) {
+      strings::StrAppend(&error_string, ": ", stream.msg);
+    }
+    block->status = errors::DataLoss(error_string);
+  }
+  deflateEnd(&stream);
+  block->output.resize(output_size);
+  // Frees the input, which may be much larger than the output.
+  std::string().swap(block->input);
+  std::string().swap(block->dictionary);
+}
+
+absl::Status ParallelZlibOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush() called after Close().");
+  }
+  if (!input_.empty()) {
+    TF_RETURN_IF_ERROR(CompressCurrentBlock(/*last=*/false));
+  }
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Flush();
+}
+
+absl::Status ParallelZlibOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+absl::Status ParallelZlibOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+absl::Status ParallelZlibOutputBuffer::Close() {
+  if (closed_) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(CompressCurrentBlock(/*last=*/true));
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  std::string trailer;
+  if (IsGzip(zlib_options_)) {
+    AppendLittleEndian32(checksum_, &trailer);
+    AppendLittleEndian32(static_cast<uint32>(input_bytes_), &trailer);
+  } else if (!IsRaw(zlib_options_)) {
+    AppendBigEndian32(checksum_, &trailer);
+  }
+  if (!trailer.empty()) {
+    TF_RETURN_IF_ERROR(file_->Append(trailer));
+  }
+  closed_ = true;
+  thread_pool_.reset();
+  return absl::OkStatus();
+}
+
+absl::Status ParallelZlibOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
 }  // namespace io
 }  // namespace tsl
@@ -18,14 +18,18 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -153,6 +157,92 @@ class ZlibOutputBuffer : public WritableFile {
   void operator=(const ZlibOutputBuffer&) = delete;
 };
 
+// Writes compressed output to file like ZlibOutputBuffer, but compresses
+// blocks of the input concurrently on `zlib_options.compression_threads`
+// threads.
+//
+// Each block of `zlib_options.input_buffer_size` bytes is deflated on its own,
+// with the last 32KB of the input before it as dictionary, and ends at a byte
+// boundary with a sync flush. The blocks are written to file in order, so the
+// output is a single zlib, gzip or raw deflate stream, which is read like the
+// one of ZlibOutputBuffer. The blocks cost a few bytes each, and don't
+// reference the data before their dictionary, so the output is slightly
+// larger.
+//
+// A given instance of a ParallelZlibOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ParallelZlibOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`.
+  ParallelZlibOutputBuffer(WritableFile* file,
+                           const ZlibCompressionOptions& zlib_options);
+
+  ~ParallelZlibOutputBuffer() override;
+
+  // Writes the header of the stream and starts the compression threads. This
+  // call is required before any other operation on the buffer.
+  absl::Status Init();
+
+  // Adds `data` to the current block, which is compressed in the background
+  // once it is full.
+  absl::Status Append(StringPiece data) override;
+
+  // Compresses the current block and writes all the blocks to file.
+  absl::Status Flush() override;
+
+  // Compresses the current block as the last one, and writes all the blocks
+  // and the trailer of the stream to file. This must be called before the
+  // destructor to avoid any data loss.
+  absl::Status Close() override;
+
+  // Returns the name of the underlying file.
+  absl::Status Name(StringPiece* result) const override;
+
+  // Flushes the buffer and syncs the file.
+  absl::Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  absl::Status Tell(int64_t* position) override;
+
+ private:
+  struct Block;
+
+  // Starts compressing the current block, and writes the blocks that are
+  // compressed.
+  absl::Status CompressCurrentBlock(bool last);
+
+  // Writes the compressed blocks to file, in order, waiting for the oldest
+  // blocks to be compressed until at most `max_pending_blocks` remain.
+  absl::Status WriteBlocks(size_t max_pending_blocks);
+
+  // Deflates the input of `block` into its output.
+  void Deflate(Block* block) const;
+
+  WritableFile* file_;  // Not owned
+  ZlibCompressionOptions const zlib_options_;
+  const size_t block_size_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // The input of the current block, and the dictionary it is compressed with.
+  std::string input_;
+  std::string dictionary_;
+
+  // The blocks being compressed or waiting to be written, in order. Blocks are
+  // marked as compressed under `mu_`.
+  std::deque<std::unique_ptr<Block>> blocks_;
+  mutex mu_;
+  condition_variable block_compressed_;
+
+  // The checksum and size of the input of the blocks written so far.
+  uint32 checksum_;
+  uint64 input_bytes_ = 0;
+  bool closed_ = false;
+
+  ParallelZlibOutputBuffer(const ParallelZlibOutputBuffer&) = delete;
+  void operator=(const ParallelZlibOutputBuffer&) = delete;
+};
+
 }  // namespace io
 }  // namespace tsl
 
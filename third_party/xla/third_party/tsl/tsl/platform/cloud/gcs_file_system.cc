@@ -45,6 +45,7 @@ limitations under the License.
 #include "tsl/platform/cloud/file_block_cache.h"
 #include "tsl/platform/cloud/google_auth_provider.h"
 #include "tsl/platform/cloud/ram_file_block_cache.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/time_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -72,6 +73,11 @@ constexpr char kGcsUploadUriBase[] =
 constexpr char kStorageHost[] = "storage.googleapis.com.";
 constexpr char kBucketMetadataLocationKey[] = "location";
 constexpr size_t kReadAppendableFileBufferSize = 1024 * 1024;  // In bytes.
+// The maximum number of source objects of a compose request.
+constexpr size_t kMaxComposeSources = 32;
+// The initial readahead of buffered files, which grows up to their buffer size
+// while they are read sequentially.
+constexpr size_t kMinReadaheadBytes = 4 * 1024 * 1024;
 constexpr int kGetChildrenDefaultPageSize = 1000;
 // The HTTP response code "308 Resume Incomplete".
 constexpr uint64 HTTP_CODE_RESUME_INCOMPLETE = 308;
@@ -340,6 +346,10 @@ class GcsRandomAccessFile : public RandomAccessFile {
 };
 
 /// A GCS-based implementation of a random access file with a read buffer.
+///
+/// The buffer is refilled with a readahead which starts at kMinReadaheadBytes,
+/// and doubles up to the buffer size with each sequential refill, so that
+/// random reads don't load whole buffers.
 class BufferedGcsRandomAccessFile : public RandomAccessFile {
  public:
   using ReadFn =
@@ -352,8 +362,10 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
       : filename_(filename),
         read_fn_(std::move(read_fn)),
         buffer_size_(buffer_size),
+        min_readahead_(std::min<uint64>(buffer_size, kMinReadaheadBytes)),
         buffer_start_(0),
-        buffer_end_is_past_eof_(false) {}
+        buffer_end_is_past_eof_(false),
+        readahead_(min_readahead_) {}
 
   Status Name(StringPiece* result) const override {
     *result = filename_;
@@ -380,7 +392,7 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
       bool consumed_buffer_to_eof =
           offset + copy_size >= buffer_end && buffer_end_is_past_eof_;
       if (copy_size < n && !consumed_buffer_to_eof) {
-        Status status = FillBuffer(offset + copy_size);
+        Status status = FillBuffer(offset + copy_size, n - copy_size);
         if (!status.ok() && !absl::IsOutOfRange(status)) {
           // Empty the buffer to avoid caching bad reads.
           buffer_.resize(0);
@@ -403,13 +415,21 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   }
 
  private:
-  Status FillBuffer(uint64 start) const
+  // Fills the buffer with at least `min_size` bytes from `start`, unless the
+  // end of the file is reached.
+  Status FillBuffer(uint64 start, size_t min_size) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(buffer_mutex_) {
+    if (!buffer_.empty() && start == buffer_start_ + buffer_.size()) {
+      readahead_ = std::min(2 * readahead_, buffer_size_);
+    } else {
+      readahead_ = min_readahead_;
+    }
+    const uint64 size = std::max<uint64>(readahead_, min_size);
     buffer_start_ = start;
-    buffer_.resize(buffer_size_);
+    buffer_.resize(size);
     StringPiece str_piece;
-    Status status = read_fn_(filename_, buffer_start_, buffer_size_, &str_piece,
-                             &(buffer_[0]));
+    Status status =
+        read_fn_(filename_, buffer_start_, size, &str_piece, &(buffer_[0]));
     buffer_end_is_past_eof_ = absl::IsOutOfRange(status);
     buffer_.resize(str_piece.size());
     return status;
@@ -421,9 +441,12 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // The implementation of the read operation (provided by the GCSFileSystem).
   const ReadFn read_fn_;
 
-  // Size of buffer that we read from GCS each time we send a request.
+  // Maximum size of buffer that we read from GCS each time we send a request.
   const uint64 buffer_size_;
 
+  // Size of the first buffer that we read from GCS.
+  const uint64 min_readahead_;
+
   // Mutex for buffering operations that can be accessed from multiple threads.
   // The following members are mutable in order to provide a const Read.
   mutable mutex buffer_mutex_;
@@ -433,6 +456,9 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
 
   mutable bool buffer_end_is_past_eof_ TF_GUARDED_BY(buffer_mutex_);
 
+  // Size of the next buffer that we read from GCS.
+  mutable uint64 readahead_ TF_GUARDED_BY(buffer_mutex_);
+
   mutable string buffer_ TF_GUARDED_BY(buffer_mutex_);
 };
 
@@ -465,6 +491,13 @@ typedef std::function<Status(const string& fname, const string& bucket,
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
 /// tmp file and copies it to GCS on flush/close.
+///
+/// With a non-null `upload_thread_pool`, large files are written with parallel
+/// composite uploads: each time `upload_part_bytes` are appended, the tmp file
+/// is uploaded in the background to a temporary object, and a new tmp file is
+/// started. On flush/close, the last tmp file is uploaded and all the parts
+/// are composed into the object. At most `max_upload_parts_in_flight` parts of
+/// the file are uploaded at once, which bounds the size of its tmp files.
 class GcsWritableFile : public WritableFile {
  public:
   GcsWritableFile(const string& bucket, const string& object,
@@ -474,7 +507,9 @@ class GcsWritableFile : public WritableFile {
                   RetryConfig retry_config, bool compose_append,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
-                  GenerationGetter generation_getter)
+                  GenerationGetter generation_getter, uint64 upload_part_bytes,
+                  int max_upload_parts_in_flight,
+                  thread::ThreadPool* upload_thread_pool)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
@@ -487,7 +522,10 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        upload_part_bytes_(upload_part_bytes),
+        max_upload_parts_in_flight_(max_upload_parts_in_flight),
+        upload_thread_pool_(upload_thread_pool) {
     // TODO: to make it safer, outfile_ should be constructed from an FD
     VLOG(3) << "GcsWritableFile: " << GetGcsPath();
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
@@ -508,7 +546,9 @@ class GcsWritableFile : public WritableFile {
                   RetryConfig retry_config, bool compose_append,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
-                  GenerationGetter generation_getter)
+                  GenerationGetter generation_getter, uint64 upload_part_bytes,
+                  int max_upload_parts_in_flight,
+                  thread::ThreadPool* upload_thread_pool)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
@@ -521,7 +561,10 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        upload_part_bytes_(upload_part_bytes),
+        max_upload_parts_in_flight_(max_upload_parts_in_flight),
+        upload_thread_pool_(upload_thread_pool) {
     VLOG(3) << "GcsWritableFile: " << GetGcsPath() << "with existing file "
             << tmp_content_filename;
     tmp_content_filename_ = tmp_content_filename;
@@ -531,6 +574,12 @@ class GcsWritableFile : public WritableFile {
 
   ~GcsWritableFile() override {
     Close().IgnoreError();
+    WaitForUploadParts();
+    // The tmp files of the parts are deleted once they are uploaded, so only
+    // those of the failed uploads remain.
+    for (const auto& part : upload_parts_) {
+      if (!part->status.ok()) std::remove(part->tmp_content_filename.c_str());
+    }
     std::remove(tmp_content_filename_.c_str());
   }
 
@@ -543,6 +592,13 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (upload_thread_pool_ != nullptr) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+      if (file_size >= upload_part_bytes_) {
+        return StartUploadPart(file_size);
+      }
+    }
     return OkStatus();
   }
 
@@ -552,6 +608,7 @@ class GcsWritableFile : public WritableFile {
       Status sync_status = Sync();
       if (sync_status.ok()) {
         outfile_.close();
+        sync_status = DeleteUploadParts();
       }
       return sync_status;
     }
@@ -586,23 +643,24 @@ class GcsWritableFile : public WritableFile {
     if (*position == -1) {
       return errors::Internal("tellp on the internal temporary file failed");
     }
+    *position += upload_parts_bytes_;
     return OkStatus();
   }
 
  private:
   /// Copies the current version of the file to GCS.
   ///
-  /// This SyncImpl() uploads the object to GCS.
-  /// In case of a failure, it resumes failed uploads as recommended by the GCS
-  /// resumable API documentation. When the whole upload needs to be
-  /// restarted, Sync() returns UNAVAILABLE and relies on RetryingFileSystem.
+  /// This SyncImpl() uploads the object to GCS, or composes it from its parts
+  /// with parallel composite uploads.
   Status SyncImpl() {
     outfile_.flush();
     if (!outfile_.good()) {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
-    UploadSessionHandle session_handle;
+    if (!upload_parts_.empty()) {
+      return SyncUploadParts();
+    }
     uint64 start_offset = 0;
     string object_to_upload = object_;
     bool should_compose = false;
@@ -616,17 +674,38 @@ class GcsWritableFile : public WritableFile {
                             io::Basename(object_), ".", start_offset_);
       }
     }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    TF_RETURN_IF_ERROR(UploadFile(tmp_content_filename_, start_offset,
+                                  file_size, object_to_upload));
+    if (should_compose) {
+      TF_RETURN_IF_ERROR(AppendObject(object_to_upload));
+    }
+    start_offset_ = file_size;
+    return OkStatus();
+  }
+
+  /// Uploads the bytes of tmp_content_filename from start_offset to file_size
+  /// to object_to_upload.
+  ///
+  /// In case of a failure, it resumes failed uploads as recommended by the GCS
+  /// resumable API documentation. When the whole upload needs to be
+  /// restarted, returns UNAVAILABLE and relies on RetryingFileSystem.
+  Status UploadFile(const string& tmp_content_filename, uint64 start_offset,
+                    uint64 file_size, const string& object_to_upload) {
+    UploadSessionHandle session_handle;
     TF_RETURN_IF_ERROR(CreateNewUploadSession(start_offset, object_to_upload,
-                                              &session_handle));
+                                              file_size, &session_handle));
     uint64 already_uploaded = 0;
     bool first_attempt = true;
     const Status upload_status = RetryingUtils::CallWithRetries(
         [&first_attempt, &already_uploaded, &session_handle, &start_offset,
-         this]() {
+         &file_size, &tmp_content_filename, this]() {
           if (session_handle.resumable && !first_attempt) {
             bool completed;
             TF_RETURN_IF_ERROR(RequestUploadSessionStatus(
-                session_handle.session_uri, &completed, &already_uploaded));
+                session_handle.session_uri, file_size, &completed,
+                &already_uploaded));
             LOG(INFO) << "### RequestUploadSessionStatus: completed = "
                       << completed
                       << ", already_uploaded = " << already_uploaded
@@ -641,8 +720,9 @@ class GcsWritableFile : public WritableFile {
             }
           }
           first_attempt = false;
-          return UploadToSession(session_handle.session_uri, start_offset,
-                                 already_uploaded);
+          return UploadToSession(session_handle.session_uri,
+                                 tmp_content_filename, start_offset,
+                                 already_uploaded, file_size);
         },
         retry_config_);
     if (absl::IsNotFound(upload_status)) {
@@ -652,13 +732,135 @@ class GcsWritableFile : public WritableFile {
           strings::StrCat("Upload to gs://", bucket_, "/", object_,
                           " failed, caused by: ", upload_status.message()));
     }
-    if (upload_status.ok()) {
-      if (should_compose) {
-        TF_RETURN_IF_ERROR(AppendObject(object_to_upload));
+    return upload_status;
+  }
+
+  /// Returns the name of a temporary object of a parallel composite upload.
+  string GetUploadPartObject(StringPiece kind, size_t index) const {
+    return strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                           io::Basename(object_), ".", kind, index);
+  }
+
+  /// Starts the background upload of the current tmp file, of `size` bytes,
+  /// as the next part of the object, and continues writing to a new tmp file.
+  Status StartUploadPart(uint64 size) {
+    outfile_.close();
+    if (outfile_.fail()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    auto part = std::make_unique<UploadPart>();
+    part->tmp_content_filename = tmp_content_filename_;
+    part->object = GetUploadPartObject("part", upload_parts_.size());
+    part->size = size;
+    UploadPart* const part_to_upload = part.get();
+    {
+      mutex_lock l(upload_parts_mu_);
+      while (upload_parts_in_flight_ >= max_upload_parts_in_flight_) {
+        upload_parts_cv_.wait(l);
       }
-      TF_RETURN_IF_ERROR(GetCurrentFileSize(&start_offset_));
+      ++upload_parts_in_flight_;
+      upload_parts_.push_back(std::move(part));
     }
-    return upload_status;
+    upload_parts_bytes_ += size;
+    upload_thread_pool_->Schedule([this, part_to_upload]() {
+      Status status =
+          UploadFile(part_to_upload->tmp_content_filename, 0,
+                     part_to_upload->size, part_to_upload->object);
+      if (status.ok()) {
+        std::remove(part_to_upload->tmp_content_filename.c_str());
+      }
+      mutex_lock l(upload_parts_mu_);
+      part_to_upload->status = std::move(status);
+      --upload_parts_in_flight_;
+      upload_parts_cv_.notify_all();
+    });
+
+    TF_RETURN_IF_ERROR(GetTmpFilename(&tmp_content_filename_));
+    outfile_.open(tmp_content_filename_,
+                  std::ofstream::binary | std::ofstream::app);
+    return CheckWritable();
+  }
+
+  /// Waits for the background uploads of the parts to finish.
+  void WaitForUploadParts() {
+    mutex_lock l(upload_parts_mu_);
+    while (upload_parts_in_flight_ > 0) {
+      upload_parts_cv_.wait(l);
+    }
+  }
+
+  /// Uploads the current tmp file as the last part of the object, and composes
+  /// all the parts into the object.
+  ///
+  /// The parts stay in GCS until the file is closed, since later syncs compose
+  /// them again with the data appended in between.
+  Status SyncUploadParts() {
+    WaitForUploadParts();
+    std::vector<string> sources;
+    for (const auto& part : upload_parts_) {
+      // Retries the parts whose background upload failed.
+      if (!part->status.ok()) {
+        part->status = UploadFile(part->tmp_content_filename, 0, part->size,
+                                  part->object);
+        TF_RETURN_IF_ERROR(part->status);
+        std::remove(part->tmp_content_filename.c_str());
+      }
+      sources.push_back(part->object);
+    }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    const string last_part = GetUploadPartObject("part", upload_parts_.size());
+    if (file_size > 0) {
+      TF_RETURN_IF_ERROR(
+          UploadFile(tmp_content_filename_, 0, file_size, last_part));
+      sources.push_back(last_part);
+    }
+
+    // GCS composes at most kMaxComposeSources objects at once, so the parts
+    // are first composed into intermediate objects when there are more.
+    std::vector<string> temporary_objects;
+    while (sources.size() > kMaxComposeSources) {
+      std::vector<string> composed;
+      for (size_t i = 0; i < sources.size(); i += kMaxComposeSources) {
+        const size_t end = std::min(sources.size(), i + kMaxComposeSources);
+        if (end - i == 1) {
+          composed.push_back(sources[i]);
+          continue;
+        }
+        const string intermediate =
+            GetUploadPartObject("compose", temporary_objects.size());
+        TF_RETURN_IF_ERROR(ComposeObject(
+            std::vector<string>(sources.begin() + i, sources.begin() + end),
+            intermediate));
+        temporary_objects.push_back(intermediate);
+        composed.push_back(intermediate);
+      }
+      sources = std::move(composed);
+    }
+    TF_RETURN_IF_ERROR(ComposeObject(sources, object_));
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+
+    if (file_size > 0) {
+      temporary_objects.push_back(last_part);
+    }
+    for (const string& object : temporary_objects) {
+      TF_RETURN_IF_ERROR(DeleteObject(object));
+    }
+    return OkStatus();
+  }
+
+  /// Deletes the temporary objects of the parts of the object.
+  Status DeleteUploadParts() {
+    WaitForUploadParts();
+    for (const auto& part : upload_parts_) {
+      if (part->status.ok()) {
+        TF_RETURN_IF_ERROR(DeleteObject(part->object));
+      }
+    }
+    upload_parts_.clear();
+    return OkStatus();
   }
 
   Status CheckWritable() const {
@@ -681,10 +883,8 @@ class GcsWritableFile : public WritableFile {
 
   /// Initiates a new resumable upload session.
   Status CreateNewUploadSession(uint64 start_offset,
-                                std::string object_to_upload,
+                                std::string object_to_upload, uint64 file_size,
                                 UploadSessionHandle* session_handle) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
     return session_creator_(start_offset, object_to_upload, bucket_, file_size,
                             GetGcsPath(), session_handle);
   }
@@ -722,9 +922,44 @@ class GcsWritableFile : public WritableFile {
         },
         retry_config_));
 
+    return DeleteObject(append_object);
+  }
+
+  /// Composes the `sources` objects, in order, into `destination`.
+  Status ComposeObject(const std::vector<string>& sources,
+                       const string& destination) {
+    VLOG(3) << "ComposeObject: " << sources.size() << " objects to "
+            << GetGcsPathWithObject(destination);
+    string request_body = "{'sourceObjects': [";
+    for (size_t i = 0; i < sources.size(); ++i) {
+      strings::StrAppend(&request_body, i > 0 ? "," : "", "{'name': '",
+                         sources[i], "'}");
+    }
+    strings::StrAppend(&request_body, "]}");
+    return RetryingUtils::CallWithRetries(
+        [&destination, &request_body, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(destination),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return OkStatus();
+        },
+        retry_config_);
+  }
+
+  /// Deletes a temporary object of the file.
+  Status DeleteObject(const string& object) {
+    const string object_path = GetGcsPathWithObject(object);
     return RetryingUtils::DeleteWithRetries(
-        [&append_object_path, this]() {
-          return filesystem_->DeleteFile(append_object_path, nullptr);
+        [&object_path, this]() {
+          return filesystem_->DeleteFile(object_path, nullptr);
         },
         retry_config_);
   }
@@ -734,22 +969,20 @@ class GcsWritableFile : public WritableFile {
   /// If the upload has already succeeded, sets 'completed' to true.
   /// Otherwise sets 'completed' to false and 'uploaded' to the currently
   /// uploaded size in bytes.
-  Status RequestUploadSessionStatus(const string& session_uri, bool* completed,
-                                    uint64* uploaded) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+  Status RequestUploadSessionStatus(const string& session_uri, uint64 file_size,
+                                    bool* completed, uint64* uploaded) {
     return status_poller_(session_uri, file_size, GetGcsPath(), completed,
                           uploaded);
   }
 
   /// Uploads data to object.
-  Status UploadToSession(const string& session_uri, uint64 start_offset,
-                         uint64 already_uploaded) {
-    uint64 file_size;
-    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+  Status UploadToSession(const string& session_uri,
+                         const string& tmp_content_filename,
+                         uint64 start_offset, uint64 already_uploaded,
+                         uint64 file_size) {
     Status status =
         object_uploader_(session_uri, start_offset, already_uploaded,
-                         tmp_content_filename_, file_size, GetGcsPath());
+                         tmp_content_filename, file_size, GetGcsPath());
     if (status.ok()) {
       // Erase the file from the file cache on every successful write.
       // Note: Only local cache, this does nothing on distributed cache. The
@@ -781,6 +1014,24 @@ class GcsWritableFile : public WritableFile {
   const ObjectUploader object_uploader_;
   const StatusPoller status_poller_;
   const GenerationGetter generation_getter_;
+
+  // A part of a parallel composite upload. Its status is set by the
+  // background upload, under upload_parts_mu_.
+  struct UploadPart {
+    string tmp_content_filename;
+    string object;
+    uint64 size;
+    Status status;
+  };
+  const uint64 upload_part_bytes_;
+  const int max_upload_parts_in_flight_;
+  thread::ThreadPool* const upload_thread_pool_;  // Not owned.
+  std::vector<std::unique_ptr<UploadPart>> upload_parts_;
+  // The total size of the parts, which precede the current tmp file.
+  uint64 upload_parts_bytes_ = 0;
+  mutex upload_parts_mu_;
+  condition_variable upload_parts_cv_;
+  int upload_parts_in_flight_ TF_GUARDED_BY(upload_parts_mu_) = 0;
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -849,6 +1100,14 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadParallelism, strings::safe_strtou64, &value)) {
+    read_parallelism_ = std::max<int>(1, value);
+  }
+
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    parallel_upload_part_bytes_ = value * 1024 * 1024;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
@@ -1091,6 +1350,43 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
   return file_block_cache;
 }
 
+void GcsFileSystem::SetReadParallelism(int read_parallelism,
+                                       size_t min_read_chunk_bytes) {
+  read_parallelism_ = std::max(1, read_parallelism);
+  min_read_chunk_bytes_ = std::max<size_t>(1, min_read_chunk_bytes);
+}
+
+thread::ThreadPool* GcsFileSystem::GetReadThreadPool() {
+  mutex_lock l(read_thread_pool_mu_);
+  if (read_thread_pool_ == nullptr) {
+    // Several files are usually read at once, e.g. by the parallel readers of
+    // tf.data, so the pool runs the requests of a few reads concurrently.
+    read_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_read", 4 * read_parallelism_);
+  }
+  return read_thread_pool_.get();
+}
+
+void GcsFileSystem::SetParallelUpload(uint64 part_bytes,
+                                      int max_parts_in_flight) {
+  parallel_upload_part_bytes_ = part_bytes;
+  max_upload_parts_in_flight_ = std::max(1, max_parts_in_flight);
+}
+
+thread::ThreadPool* GcsFileSystem::GetUploadThreadPool() {
+  // Parallel composite uploads replace the whole object on each sync, so they
+  // aren't used by the compose append mode, which only uploads new data.
+  if (parallel_upload_part_bytes_ == 0 || compose_append_) {
+    return nullptr;
+  }
+  mutex_lock l(upload_thread_pool_mu_);
+  if (upload_thread_pool_ == nullptr) {
+    upload_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_write", 4 * max_upload_parts_in_flight_);
+  }
+  return upload_thread_pool_.get();
+}
+
 // A helper function to actually read the data from GCS.
 Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
                                         size_t n, char* buffer,
@@ -1100,6 +1396,58 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
 
+  const size_t num_chunks =
+      std::min<size_t>(read_parallelism_, n / min_read_chunk_bytes_);
+  if (num_chunks <= 1) {
+    return LoadRangeFromGCS(fname, bucket, object, offset, n, buffer,
+                            bytes_transferred);
+  }
+
+  // A single HTTP stream is far slower than the network, so the range is
+  // split into chunks requested concurrently, the first one on this thread.
+  std::vector<Status> statuses(num_chunks);
+  std::vector<size_t> chunk_bytes_transferred(num_chunks, 0);
+  auto chunk_begin = [n, num_chunks](size_t chunk) {
+    return n / num_chunks * chunk;
+  };
+  auto load_chunk = [&, this](size_t chunk) {
+    const size_t begin = chunk_begin(chunk);
+    const size_t end = chunk + 1 == num_chunks ? n : chunk_begin(chunk + 1);
+    statuses[chunk] =
+        LoadRangeFromGCS(fname, bucket, object, offset + begin, end - begin,
+                         buffer + begin, &chunk_bytes_transferred[chunk]);
+  };
+  BlockingCounter counter(num_chunks - 1);
+  thread::ThreadPool* pool = GetReadThreadPool();
+  for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+    pool->Schedule([&load_chunk, &counter, chunk]() {
+      load_chunk(chunk);
+      counter.DecrementCount();
+    });
+  }
+  load_chunk(0);
+  counter.Wait();
+
+  // The data ends with the first chunk that was cut short by the end of the
+  // file.
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    TF_RETURN_IF_ERROR(statuses[chunk]);
+  }
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    *bytes_transferred += chunk_bytes_transferred[chunk];
+    const size_t end = chunk + 1 == num_chunks ? n : chunk_begin(chunk + 1);
+    if (chunk_begin(chunk) + chunk_bytes_transferred[chunk] < end) break;
+  }
+  return OkStatus();
+}
+
+Status GcsFileSystem::LoadRangeFromGCS(const string& fname,
+                                       const string& bucket,
+                                       const string& object, size_t offset,
+                                       size_t n, char* buffer,
+                                       size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+
   profiler::TraceMe activity(
       [fname]() { return absl::StrCat("LoadBufferFromGCS ", fname); });
 
@@ -1351,7 +1699,8 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter, parallel_upload_part_bytes_,
+      max_upload_parts_in_flight_, GetUploadThreadPool()));
   return OkStatus();
 }
 
@@ -1431,7 +1780,8 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
       bucket, object, this, old_content_filename, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter, parallel_upload_part_bytes_,
+      max_upload_parts_in_flight_, GetUploadThreadPool()));
   return OkStatus();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/retrying_file_system.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -62,6 +64,18 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of concurrent
+// range requests a block read is split into.
+constexpr char kReadParallelism[] = "GCS_READ_PARALLELISM";
+constexpr int kDefaultReadParallelism = 4;
+// The minimum size of each of the range requests of a block read.
+constexpr size_t kDefaultMinReadChunkBytes = 8 * 1024 * 1024;
+// The environment variable that enables parallel composite uploads of written
+// files, with parts of the given size (MB).
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+constexpr uint64 kDefaultParallelUploadPartBytes = 0;
+// The maximum number of concurrent part uploads of a written file.
+constexpr int kDefaultMaxUploadPartsInFlight = 4;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -284,6 +298,27 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Sets how block reads are split into concurrent range requests.
+  ///
+  /// A read is split into up to `read_parallelism` requests of at least
+  /// `min_read_chunk_bytes`, so that large reads aren't bound by the bandwidth
+  /// of a single HTTP stream. A `read_parallelism` of 1 disables the split.
+  /// Must be called before any file is read.
+  void SetReadParallelism(int read_parallelism, size_t min_read_chunk_bytes);
+  int read_parallelism() const { return read_parallelism_; }
+
+  /// \brief Sets how written files are uploaded in parallel.
+  ///
+  /// Once `part_bytes` are written to a file, they are uploaded in the
+  /// background as a temporary object, with at most `max_parts_in_flight`
+  /// concurrent uploads per file, and the parts are composed into the object
+  /// on flush. A `part_bytes` of 0 disables parallel composite uploads. Must be
+  /// called before any file is written.
+  void SetParallelUpload(uint64 part_bytes, int max_parts_in_flight);
+  uint64 parallel_upload_part_bytes() const {
+    return parallel_upload_part_bytes_;
+  }
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -407,6 +442,18 @@ class GcsFileSystem : public FileSystem {
   // Clear all the caches related to the file with name `filename`.
   void ClearFileCaches(const string& fname);
 
+  // Loads a range of a file with a single HTTP request.
+  Status LoadRangeFromGCS(const string& fname, const string& bucket,
+                          const string& object, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
+  // Returns the thread pool running the concurrent range requests of reads.
+  thread::ThreadPool* GetReadThreadPool();
+
+  // Returns the thread pool uploading the parts of written files, or null if
+  // parallel composite uploads are disabled.
+  thread::ThreadPool* GetUploadThreadPool();
+
   mutex mu_;
   std::unique_ptr<AuthProvider> auth_provider_ TF_GUARDED_BY(mu_);
   std::shared_ptr<HttpRequest::Factory> http_request_factory_;
@@ -415,6 +462,22 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of concurrent range requests of a read, and the
+  // minimum size of each of them.
+  int read_parallelism_ = kDefaultReadParallelism;
+  size_t min_read_chunk_bytes_ = kDefaultMinReadChunkBytes;
+  mutex read_thread_pool_mu_;
+  std::unique_ptr<thread::ThreadPool> read_thread_pool_
+      TF_GUARDED_BY(read_thread_pool_mu_);
+
+  // The size of the parts of parallel composite uploads, and the maximum
+  // number of concurrent part uploads of a file.
+  uint64 parallel_upload_part_bytes_ = kDefaultParallelUploadPartBytes;
+  int max_upload_parts_in_flight_ = kDefaultMaxUploadPartsInFlight;
+  mutex upload_thread_pool_mu_;
+  std::unique_ptr<thread::ThreadPool> upload_thread_pool_
+      TF_GUARDED_BY(upload_thread_pool_mu_);
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
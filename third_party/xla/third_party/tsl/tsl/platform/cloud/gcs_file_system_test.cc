@@ -16,10 +16,12 @@ limitations under the License.
 #include "tsl/platform/cloud/gcs_file_system.h"
 
 #include <fstream>
+#include <set>
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/cloud/http_request_fake.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
@@ -59,6 +61,85 @@ class FakeZoneProvider : public ZoneProvider {
   }
 };
 
+// Serves the range reads of a single object, from any thread, and records
+// their ranges.
+class RangeHttpRequestFactory : public HttpRequest::Factory {
+ public:
+  explicit RangeHttpRequestFactory(const string& content)
+      : content_(content) {}
+
+  HttpRequest* Create() override { return new Request(this); }
+
+  std::vector<std::pair<uint64, uint64>> ranges() {
+    mutex_lock l(mu_);
+    return ranges_;
+  }
+
+ private:
+  class Request : public HttpRequest {
+   public:
+    explicit Request(RangeHttpRequestFactory* factory) : factory_(factory) {}
+
+    void SetUri(const string& uri) override {}
+    void SetRange(uint64 start, uint64 end) override {
+      start_ = start;
+      end_ = end;
+    }
+    void AddHeader(const string& name, const string& value) override {}
+    void AddResolveOverride(const string& hostname, int64_t port,
+                            const string& ip_addr) override {}
+    void AddAuthBearerHeader(const string& auth_token) override {}
+    void SetRequestStats(RequestStats* stats) override {}
+    void SetDeleteRequest() override {}
+    Status SetPutFromFile(const string& body_filepath, size_t offset) override {
+      return errors::Unimplemented("Only reads are supported");
+    }
+    void SetPutEmptyBody() override {}
+    void SetPostFromBuffer(const char* buffer, size_t size) override {}
+    void SetPostEmptyBody() override {}
+    void SetResultBuffer(std::vector<char>* out_buffer) override {}
+    void SetResultBufferDirect(char* buffer, size_t size) override {
+      buffer_ = buffer;
+      size_ = size;
+    }
+    size_t GetResultBufferDirectBytesTransferred() override {
+      return bytes_transferred_;
+    }
+    string GetResponseHeader(const string& name) const override { return ""; }
+    uint64 GetResponseCode() const override { return 200; }
+    Status Send() override {
+      factory_->RecordRange(start_, end_);
+      const string& content = factory_->content_;
+      if (start_ < content.size()) {
+        bytes_transferred_ = std::min<size_t>(
+            {size_, end_ - start_ + 1, content.size() - start_});
+        memcpy(buffer_, content.data() + start_, bytes_transferred_);
+      }
+      return OkStatus();
+    }
+    string EscapeString(const string& str) override { return str; }
+    void SetTimeouts(uint32 connection, uint32 inactivity,
+                     uint32 total) override {}
+
+   private:
+    RangeHttpRequestFactory* const factory_;
+    uint64 start_ = 0;
+    uint64 end_ = 0;
+    char* buffer_ = nullptr;
+    size_t size_ = 0;
+    size_t bytes_transferred_ = 0;
+  };
+
+  void RecordRange(uint64 start, uint64 end) {
+    mutex_lock l(mu_);
+    ranges_.emplace_back(start, end);
+  }
+
+  const string content_;
+  mutex mu_;
+  std::vector<std::pair<uint64, uint64>> ranges_ TF_GUARDED_BY(mu_);
+};
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_NoBlockCache) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -997,6 +1078,107 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelCompositeUpload) {
+  std::vector<HttpRequest*> requests(
+      {// The first two parts are uploaded while the file is written.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com./upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 4\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location0"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location0\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-3/4\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: abcd\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com./upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part1\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 4\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location1"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location1\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-3/4\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: efgh\n",
+                           ""),
+       // The last part is uploaded on close, and the parts are composed.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com./upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpcompose%2Fwriteable.part2\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 2\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location2"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location2\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-1/2\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: ij\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com./storage/v1/b/bucket/o/"
+           "path%2Fwriteable/compose\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n"
+           "Header content-type: application/json\n"
+           "Post body: {'sourceObjects': ["
+           "{'name': 'path/.tmpcompose/writeable.part0'},"
+           "{'name': 'path/.tmpcompose/writeable.part1'},"
+           "{'name': 'path/.tmpcompose/writeable.part2'}]}\n",
+           ""),
+       // The temporary objects are deleted.
+       new FakeHttpRequest("Uri: https://www.googleapis.com./storage/v1/b/"
+                           "bucket/o/path%2F.tmpcompose%2Fwriteable.part2\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com./storage/v1/b/"
+                           "bucket/o/path%2F.tmpcompose%2Fwriteable.part0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com./storage/v1/b/"
+                           "bucket/o/path%2F.tmpcompose%2Fwriteable.part1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // A single part in flight makes the order of the requests deterministic.
+  fs.SetParallelUpload(4, 1);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &file));
+  TF_EXPECT_OK(file->Append("abcd"));
+  TF_EXPECT_OK(file->Append("efgh"));
+  TF_EXPECT_OK(file->Append("ij"));
+  int64_t pos;
+  TF_EXPECT_OK(file->Tell(&pos));
+  EXPECT_EQ(10, pos);
+  TF_EXPECT_OK(file->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -4081,5 +4263,69 @@ TEST(GcsFileSystemTest, AppendModeDefault) {
   EXPECT_EQ(false, fs1.compose_append());
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_ParallelReads) {
+  string content(90, 'a');
+  for (size_t i = 0; i < content.size(); ++i) content[i] = 'a' + i % 26;
+  auto* factory = new RangeHttpRequestFactory(content);
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(factory),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 100 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetReadParallelism(4, 10);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+  char scratch[100];
+  StringPiece result;
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(0, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ(content, result);
+
+  // The chunks are requested in any order.
+  std::vector<std::pair<uint64, uint64>> ranges = factory->ranges();
+  EXPECT_EQ(std::set<std::pair<uint64, uint64>>(ranges.begin(), ranges.end()),
+            (std::set<std::pair<uint64, uint64>>(
+                {{0, 24}, {25, 49}, {50, 74}, {75, 99}})));
+}
+
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_AdaptiveReadahead) {
+  constexpr uint64 kMB = 1024 * 1024;
+  string content(12 * kMB, 'a');
+  auto* factory = new RangeHttpRequestFactory(content);
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(factory),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider),
+      16 * kMB /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+      0 /* stat cache max age */, 0 /* stat cache max entries */,
+      0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetReadParallelism(1, kMB);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+  std::vector<char> scratch(kMB);
+  StringPiece result;
+  // Sequential reads double the readahead.
+  for (int i = 0; i < 5; ++i) {
+    TF_EXPECT_OK(file->Read(i * kMB, kMB, &result, scratch.data()));
+  }
+  // A random read resets it.
+  TF_EXPECT_OK(file->Read(kMB, kMB, &result, scratch.data()));
+  EXPECT_EQ(factory->ranges(),
+            (std::vector<std::pair<uint64, uint64>>({{0, 4 * kMB - 1},
+                                                     {4 * kMB, 12 * kMB - 1},
+                                                     {kMB, 5 * kMB - 1}})));
+}
+
 }  // namespace
 }  // namespace tsl
@@ -18,22 +18,37 @@ limitations under the License.
 #include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <strings.h>
 #include <sys/mman.h>
 
 #if defined(__linux__)
 #include <sys/sendfile.h>
 #endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define TSL_POSIX_IO_URING 1
+#endif
+#endif
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/default/posix_file_system.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_system_helper.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/protobuf/error_codes.pb.h"
@@ -45,6 +60,186 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(TSL_POSIX_IO_URING)
+// Name of the environment variable which makes the batched reads of local
+// files go through io_uring.
+constexpr char kPosixIoUringEnvVar[] = "TF_POSIX_IO_URING";
+// Maximum number of reads in flight in the io_uring of the process.
+constexpr unsigned kIoUringEntries = 256;
+
+// An io_uring shared by all the local files of the process, through which
+// batches of reads are submitted with a single system call. The completions
+// are reaped by a background thread.
+class IoUring {
+ public:
+  // A read of `iov` at `offset` of `fd`. `res` is set as by preadv(), or to
+  // minus the errno of a failed read.
+  struct Read {
+    int fd;
+    uint64 offset;
+    struct iovec iov;
+    int res = 0;
+    BlockingCounter* counter = nullptr;
+  };
+
+  // Returns the io_uring of the process, or null if io_uring is disabled or
+  // not supported by the kernel.
+  static IoUring* Get() {
+    static IoUring* ring = []() -> IoUring* {
+      const char* enabled = getenv(kPosixIoUringEnvVar);
+      if (enabled == nullptr ||
+          (strcmp(enabled, "1") != 0 && strcasecmp(enabled, "true") != 0)) {
+        return nullptr;
+      }
+      IoUring* ring = new IoUring;
+      if (!ring->Init(kIoUringEntries)) {
+        LOG(WARNING) << "io_uring is not supported, falling back to pread(): "
+                     << strerror(errno);
+        delete ring;
+        return nullptr;
+      }
+      return ring;
+    }();
+    return ring;
+  }
+
+  // Performs the `num_reads` reads, returning once they all completed.
+  void ReadAll(Read* reads, size_t num_reads) {
+    BlockingCounter counter(num_reads);
+    {
+      mutex_lock l(mu_);
+      size_t i = 0;
+      while (i < num_reads) {
+        while (in_flight_ == entries_) {
+          cv_.wait(l);
+        }
+        // The kernel consumes all the entries before io_uring_enter()
+        // returns, so the submission queue is always empty here.
+        const unsigned tail = *sq_tail_;
+        unsigned count = 0;
+        for (; i < num_reads && in_flight_ < entries_; ++i) {
+          reads[i].counter = &counter;
+          const unsigned index = (tail + count) & sq_mask_;
+          struct io_uring_sqe* sqe = &sqes_[index];
+          memset(sqe, 0, sizeof(*sqe));
+          sqe->opcode = IORING_OP_READV;
+          sqe->fd = reads[i].fd;
+          sqe->off = reads[i].offset;
+          sqe->addr = reinterpret_cast<uint64>(&reads[i].iov);
+          sqe->len = 1;
+          sqe->user_data = reinterpret_cast<uint64>(&reads[i]);
+          sq_array_[index] = index;
+          ++count;
+          ++in_flight_;
+        }
+        __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+        while (count > 0) {
+          const long submitted =  // NOLINT(runtime/int)
+              syscall(__NR_io_uring_enter, ring_fd_, count, 0, 0, nullptr, 0);
+          if (submitted >= 0) {
+            count -= submitted;
+          } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            // The entries can't be taken back from the submission queue.
+            LOG(FATAL) << "io_uring_enter() failed: " << strerror(errno);
+          }
+        }
+      }
+    }
+    counter.Wait();
+  }
+
+ private:
+  bool Init(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd_ < 0) return false;
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_size = cq_size = std::max(sq_size, cq_size);
+    }
+    char* sq = static_cast<char*>(mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                       IORING_OFF_SQ_RING));
+    char* cq = single_mmap ? sq
+                           : static_cast<char*>(mmap(
+                                 nullptr, cq_size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                 IORING_OFF_CQ_RING));
+    void* sqes = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe),
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+      // The mappings are released with the file descriptor.
+      close(ring_fd_);
+      return false;
+    }
+    entries_ = std::min(params.sq_entries, params.cq_entries);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    // The ring lives as long as the process.
+    Env::Default()->StartThread(ThreadOptions(), "io_uring_reaper",
+                                [this]() { ReapLoop(); });
+    return true;
+  }
+
+  // Waits for completions and signals the reads they complete.
+  void ReapLoop() {
+    std::vector<Read*> reads;
+    while (true) {
+      if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0) < 0 &&
+          errno != EINTR) {
+        LOG(FATAL) << "io_uring_enter() failed: " << strerror(errno);
+      }
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      reads.clear();
+      for (; head != tail; ++head) {
+        const struct io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+        Read* read = reinterpret_cast<Read*>(cqe->user_data);
+        read->res = cqe->res;
+        reads.push_back(read);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (reads.empty()) continue;
+      {
+        mutex_lock l(mu_);
+        in_flight_ -= reads.size();
+      }
+      cv_.notify_all();
+      for (Read* read : reads) {
+        read->counter->DecrementCount();
+      }
+    }
+  }
+
+  int ring_fd_ = -1;
+  unsigned entries_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  struct io_uring_sqe* sqes_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  condition_variable cv_;
+  unsigned in_flight_ TF_GUARDED_BY(mu_) = 0;
+};
+#endif  // TSL_POSIX_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -97,6 +292,44 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+#if defined(TSL_POSIX_IO_URING)
+  void ReadBatch(absl::Span<ReadRequest> requests) const override {
+    IoUring* ring = IoUring::Get();
+    if (ring == nullptr || requests.size() < 2) {
+      RandomAccessFile::ReadBatch(requests);
+      return;
+    }
+    std::vector<IoUring::Read> reads(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      reads[i].fd = fd_;
+      reads[i].offset = requests[i].offset;
+      reads[i].iov.iov_base = requests[i].scratch;
+      // Larger reads are completed by Read() below.
+      reads[i].iov.iov_len = std::min<size_t>(requests[i].n, INT32_MAX);
+    }
+    ring->ReadAll(reads.data(), reads.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      ReadRequest& request = requests[i];
+      const int res = reads[i].res;
+      if (res == 0 && request.n > 0) {
+        request.result = StringPiece(request.scratch, 0);
+        request.status = absl::Status(absl::StatusCode::kOutOfRange,
+                                      "Read less bytes than requested");
+      } else if (res < 0 && res != -EINTR && res != -EAGAIN) {
+        request.result = StringPiece(request.scratch, 0);
+        request.status = IOError(filename_, -res);
+      } else {
+        // Short reads and interrupted reads are completed with pread().
+        const size_t done = std::max(res, 0);
+        StringPiece rest;
+        request.status = Read(request.offset + done, request.n - done, &rest,
+                              request.scratch + done);
+        request.result = StringPiece(request.scratch, done + rest.size());
+      }
+    }
+  }
+#endif  // TSL_POSIX_IO_URING
+
 #if defined(TF_CORD_SUPPORT)
   absl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tsl/platform/cord.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_statistics.h"
@@ -771,6 +772,31 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief A read of `n` bytes at `offset` for ReadBatch().
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    /// Set as by Read(offset, n, &result, scratch).
+    StringPiece result;
+    tsl::Status status;
+  };
+
+  /// \brief Performs each of the `requests` as by Read().
+  ///
+  /// File systems which can keep many reads in flight override this to issue
+  /// the reads together, which helps random access workloads bound by the
+  /// number of I/O operations per second. The default implementation reads
+  /// them one after the other.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadBatch(absl::Span<ReadRequest> requests) const {
+    for (ReadRequest& request : requests) {
+      request.status = Read(request.offset, request.n, &request.result,
+                            request.scratch);
+    }
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
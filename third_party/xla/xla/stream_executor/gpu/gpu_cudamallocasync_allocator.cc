@@ -107,14 +107,17 @@ std::atomic<int> GpuCudaMallocAsyncAllocator::number_instantiated_(0);
 
 GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
     tsl::PlatformDeviceId platform_device_id, size_t pool_size,
-    bool reserve_memory, bool compute_stats)
+    bool reserve_memory, bool compute_stats,
+    std::optional<size_t> release_threshold)
     : name_(absl::StrCat("gpu_async_", platform_device_id.value())),
-      reserve_memory_(reserve_memory) {
+      reserve_memory_(reserve_memory),
+      pool_size_(pool_size) {
   ++number_instantiated_;
 
   // Stop clang from complaining about unused private fields when
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED is not defined.
   (void)reserve_memory_;
+  (void)pool_size_;
 
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   stream_exec_ = GPUMachineManager()
@@ -180,9 +183,10 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
   VLOG(1) << Name() << " CudaMallocAsync initialized on platform: "
           << platform_device_id.value() << " with pool size of: " << pool_size
           << " this ptr: " << this;
-  uint64_t pool_size_64 = pool_size;
+  uint64_t release_threshold_64 = release_threshold.value_or(pool_size);
+  VLOG(1) << Name() << " release threshold: " << release_threshold_64;
   if (auto status = cuMemPoolSetAttribute(
-          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &pool_size_64))
+          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &release_threshold_64))
     LOG(FATAL) <<  // Crash OK.
         "Failed to set CUDA pool attribute: " << GetCudaErrorMessage(status);
 
@@ -399,8 +403,37 @@ size_t GpuCudaMallocAsyncAllocator::AllocatedSize(const void* ptr) const {
 
 std::optional<tsl::AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
   if (!stats_) return std::nullopt;
-  tsl::mutex_lock l(lock_);
-  return *stats_;
+  tsl::AllocatorStats stats;
+  {
+    tsl::mutex_lock l(lock_);
+    stats = *stats_;
+  }
+  GetPoolStats(stats);
+  return stats;
+}
+
+void GpuCudaMallocAsyncAllocator::GetPoolStats(
+    tsl::AllocatorStats& stats) const {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED && CUDA_VERSION >= 11030
+  if (pool_ == nullptr) return;
+  cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  cuuint64_t reserved_current;
+  cuuint64_t reserved_high;
+  if (auto result = cuMemPoolGetAttribute(
+          pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT, &reserved_current)) {
+    VLOG(1) << "Failed to get CUDA pool attribute: "
+            << GetCudaErrorMessage(result);
+    return;
+  }
+  if (auto result = cuMemPoolGetAttribute(
+          pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH, &reserved_high)) {
+    VLOG(1) << "Failed to get CUDA pool attribute: "
+            << GetCudaErrorMessage(result);
+    return;
+  }
+  stats.pool_bytes = static_cast<int64_t>(reserved_current);
+  stats.peak_pool_bytes = static_cast<int64_t>(reserved_high);
+#endif
 }
 
 bool GpuCudaMallocAsyncAllocator::ClearStats() {
@@ -409,6 +442,18 @@ bool GpuCudaMallocAsyncAllocator::ClearStats() {
   stats_->num_allocs = 0;
   stats_->peak_bytes_in_use = stats_->bytes_in_use;
   stats_->largest_alloc_size = 0;
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED && CUDA_VERSION >= 11030
+  if (pool_ != nullptr) {
+    // Resets the high watermark of the pool to its current reservation.
+    cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    cuuint64_t zero = 0;
+    if (auto result = cuMemPoolSetAttribute(
+            pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH, &zero)) {
+      VLOG(1) << "Failed to reset CUDA pool attribute: "
+              << GetCudaErrorMessage(result);
+    }
+  }
+#endif
   return true;
 }
 
@@ -421,12 +466,7 @@ void GpuCudaMallocAsyncAllocator::SetStreamAndPreallocateMemory(void* stream) {
         "Trying to set the stream twice. This isn't supported. ";
   }
 
-  uint64_t pool_size_64 = 0;
-  if (auto status = cuMemPoolGetAttribute(
-          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &pool_size_64)) {
-    LOG(FATAL) <<  // Crash OK.
-        "Failed to get CUDA pool attribute: " << GetCudaErrorMessage(status);
-  }
+  const uint64_t pool_size_64 = pool_size_;
   cuda_stream_ = new_cuda_stream;
   int64_t prealloc_size = 0;
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED_PREALLOC=-1 is a special value that
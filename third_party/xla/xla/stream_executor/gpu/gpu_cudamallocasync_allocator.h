@@ -64,12 +64,19 @@ namespace stream_executor {
 // Here, the pool_size isn't the absolute max as for [Gpu]BFCAllocator.
 // The pool can grow above that up to the total GPU memory.  But the
 // driver can return the excess memory to other processes.
+//
+// `release_threshold` overrides how much of the freed memory the pool keeps
+// (pool_size by default), e.g. to return memory to other processes or CUDA
+// libraries sharing the GPU at each synchronization. The memory held by the
+// pool is reported as `pool_bytes` in the stats.
 class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  public:
   explicit GpuCudaMallocAsyncAllocator(tsl::PlatformDeviceId platform_device_id,
                                        size_t pool_size,
                                        bool reserve_memory = false,
-                                       bool compute_stats = true);
+                                       bool compute_stats = true,
+                                       std::optional<size_t> release_threshold =
+                                           std::nullopt);
   ~GpuCudaMallocAsyncAllocator() override;
   std::string Name() override { return name_; }
   void* AllocateRaw(size_t alignment,
@@ -97,6 +104,9 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  private:
   void PrintAllocatorStatisticsNoLock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Sets the pool memory held by the driver in `stats`.
+  void GetPoolStats(tsl::AllocatorStats& stats) const;
+
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   StreamExecutor* stream_exec_;  // Not owned.
 
@@ -121,6 +131,9 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   bool reserve_memory_;
 
+  // Number of bytes preallocated when `reserve_memory_` is set.
+  size_t pool_size_;
+
   GpuCudaMallocAsyncAllocator(const GpuCudaMallocAsyncAllocator&) = delete;
   void operator=(const GpuCudaMallocAsyncAllocator&) = delete;
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/tsl/distributed_runtime/coordination/coordination_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <map>
@@ -108,7 +109,7 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
       std::function<DeviceInfo(const DeviceInfo& devices)>
           post_aggregate_device_fn) override;
 
-  void LogConnectStatusLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+  void LogConnectStatusLocked() const TF_SHARED_LOCKS_REQUIRED(state_mu_);
 
   absl::Status RegisterTask(const CoordinatedTask& task,
                             uint64_t incarnation) override;
@@ -252,9 +253,16 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   const std::string shutdown_barrier_id_ =
       absl::StrCat("Shutdown::", std::to_string(service_incarnation_));
 
+  // Heartbeats only update the heartbeat times of tasks, so they only hold
+  // `state_mu_` shared, and heartbeats of all tasks can be handled
+  // concurrently.
   mutex state_mu_;
   absl::flat_hash_map<std::string, std::unique_ptr<TaskState>> cluster_state_
       TF_GUARDED_BY(state_mu_);
+  // Set when a task connects, so that the health check thread logs the number
+  // of tasks still to connect. Logging it on each connection would make
+  // connecting all tasks quadratic in their number.
+  std::atomic<bool> connect_status_changed_ = false;
   DeviceInfo cluster_devices_ TF_GUARDED_BY(state_mu_);
 
   mutex kv_mu_;
@@ -395,9 +403,13 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
             }
           }
           // Heartbeat check.
-          absl::Status status = absl::OkStatus();
           {
-            mutex_lock l(state_mu_);
+            // The scan only holds the lock shared, so that it doesn't block
+            // the heartbeats of large clusters.
+            tf_shared_lock l(state_mu_);
+            if (connect_status_changed_.exchange(false)) {
+              LogConnectStatusLocked();
+            }
             for (const auto& [task_name, task_state] : cluster_state_) {
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
@@ -410,15 +422,35 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
                        << " stale?=" << is_stale;
               if (is_stale) {
                 stale_task_names.push_back(task_name);
-                status = MakeCoordinationError(errors::Unavailable(
-                    "Task ", task_name,
-                    " heartbeat timeout. This indicates that the remote task "
-                    "has failed, got preempted, or crashed unexpectedly. Check "
-                    "the task logs for an earlier error to debug further."));
-                SetTaskError(task_name, status);
               }
             }
           }
+          if (!stale_task_names.empty()) {
+            mutex_lock l(state_mu_);
+            // Tasks may have sent a heartbeat or reconnected since the scan.
+            stale_task_names.erase(
+                std::remove_if(
+                    stale_task_names.begin(), stale_task_names.end(),
+                    [&](absl::string_view stale_task_name) {
+                      TaskState* task_state =
+                          cluster_state_.find(stale_task_name)->second.get();
+                      return task_state->GetState() !=
+                                 CoordinatedTaskState::TASKSTATE_CONNECTED ||
+                             task_state->TimeSinceLastHeartbeatMs() <=
+                                 heartbeat_timeout_ms_;
+                    }),
+                stale_task_names.end());
+            for (const auto& stale_task_name : stale_task_names) {
+              const absl::Status status = MakeCoordinationError(
+                  errors::Unavailable(
+                      "Task ", stale_task_name,
+                      " heartbeat timeout. This indicates that the remote task "
+                      "has failed, got preempted, or crashed unexpectedly. "
+                      "Check the task logs for an earlier error to debug "
+                      "further."));
+              SetTaskError(stale_task_name, status);
+            }
+          }
           // Propagate heartbeat timeout errors to other connected tasks.
           if (!stale_task_names.empty()) {
             if (!has_service_to_client_connection) {
@@ -586,7 +618,7 @@ absl::Status CoordinationServiceStandaloneImpl::RegisterTask(
       LOG(INFO) << task_name
                 << " has connected to coordination service. Incarnation: "
                 << incarnation;
-      LogConnectStatusLocked();
+      connect_status_changed_ = true;
       return absl::OkStatus();
     } else if (task_state == CoordinatedTaskState::TASKSTATE_CONNECTED) {
       // This may happen if the service processes the initial RegisterTask(),
@@ -599,7 +631,7 @@ absl::Status CoordinationServiceStandaloneImpl::RegisterTask(
         LOG(INFO) << task_name
                   << " has connected to coordination service with the same "
                   << "incarnation again: " << incarnation;
-        LogConnectStatusLocked();
+        connect_status_changed_ = true;
         return absl::OkStatus();
       } else {
         error_message =
@@ -751,29 +783,30 @@ absl::Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string task_name = GetTaskName(task);
   absl::Status s = absl::OkStatus();
   {
-    mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    tf_shared_lock l(state_mu_);
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected heartbeat request from task: ", task_name,
           ". This usually implies an earlier error that caused coordination "
           "service to shut down before the workers disconnect. Check the task "
           "leader's logs for an earlier error to debug the root cause."));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -1040,12 +1073,12 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   // Check if caller task is participating in the barrier. If not, update
   // `barriers_` to cause subsequent calls from the same task and other tasks
   // that have already called this instance of the barrier to fail.
-  const std::string source_task_name = GetTaskName(task);
-
+  // Compares the tasks without formatting their names, as this is done for
+  // each of the tasks at each of their calls.
   bool among_participating_tasks =
       std::find_if(participating_tasks.begin(), participating_tasks.end(),
-                   [&](const CoordinatedTask& task) {
-                     return GetTaskName(task) == source_task_name;
+                   [&](const CoordinatedTask& participating_task) {
+                     return CoordinatedTaskEqual()(participating_task, task);
                    }) != participating_tasks.end();
 
   if (!participating_tasks.empty() && !among_participating_tasks) {